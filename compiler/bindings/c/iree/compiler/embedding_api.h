@@ -159,6 +159,27 @@ IREE_EMBED_EXPORTED void ireeCompilerSessionGetFlags(
     iree_compiler_session_t *session, bool nonDefaultOnly,
     void (*onFlag)(const char *flag, size_t length, void *), void *userData);
 
+// Sets the maximum total size in bytes of compiled artifacts the session
+// retains for reuse. When an invocation parses a source that is byte-identical
+// to one previously compiled in the session with the same flags and phases
+// the standard pipeline is skipped and ireeCompilerInvocationOutputVMBytecode
+// emits the retained artifact. Other outputs are unavailable for such
+// invocations. Least recently used artifacts are evicted once the capacity is
+// exceeded. A capacity of 0 (the default) disables the cache and releases all
+// retained artifacts.
+// Available since: 1.5
+IREE_EMBED_EXPORTED void
+ireeCompilerSessionSetArtifactCacheCapacity(iree_compiler_session_t *session,
+                                            size_t capacity);
+
+// Gets the number of invocations served from and missing the session artifact
+// cache. Either output may be NULL.
+// Available since: 1.5
+IREE_EMBED_EXPORTED void
+ireeCompilerSessionGetArtifactCacheStatistics(iree_compiler_session_t *session,
+                                              size_t *hitCount,
+                                              size_t *missCount);
+
 //===----------------------------------------------------------------------===//
 // Run management.
 // Runs execute against a session and represent a discrete invocation of the
@@ -211,6 +211,28 @@ void ireeCompilerSessionGetFlags(
                                        userData);
 }
 
+void ireeCompilerSessionSetArtifactCacheCapacity(
+    iree_compiler_session_t *session, size_t capacity) {
+  assertLoaded();
+  if (__ireeCompilerSessionSetArtifactCacheCapacity) {
+    __ireeCompilerSessionSetArtifactCacheCapacity(session, capacity);
+  }
+}
+
+void ireeCompilerSessionGetArtifactCacheStatistics(
+    iree_compiler_session_t *session, size_t *hitCount, size_t *missCount) {
+  assertLoaded();
+  if (__ireeCompilerSessionGetArtifactCacheStatistics) {
+    __ireeCompilerSessionGetArtifactCacheStatistics(session, hitCount,
+                                                    missCount);
+    return;
+  }
+  if (hitCount)
+    *hitCount = 0;
+  if (missCount)
+    *missCount = 0;
+}
+
 iree_compiler_invocation_t *
 ireeCompilerInvocationCreate(iree_compiler_session_t *session) {
   return __ireeCompilerInvocationCreate(session);
@@ -37,6 +37,9 @@ IREE_EMBED_EXPORTED int ireeCompilerRunLldMain(int argc, char **argv);
 /// Runs the IREE reducer main function.
 IREE_EMBED_EXPORTED int ireeReduceRunMain(int argc, char **argv);
 
+/// Runs the IREE dispatch autotuner main function.
+IREE_EMBED_EXPORTED int ireeTuneRunMain(int argc, char **argv);
+
 #ifdef __cplusplus
 }
 #endif
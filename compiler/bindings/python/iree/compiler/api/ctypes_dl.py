@@ -9,7 +9,7 @@
 from ctypes import *
 from enum import IntEnum
 from pathlib import Path
-from typing import Any, Sequence
+from typing import Any, Sequence, Tuple
 
 import ctypes
 import logging
@@ -100,6 +100,16 @@ def _init_dylib():
         c_void_p,
         [c_void_p, c_int, c_void_p],
     )
+    _setsig(
+        _dylib.ireeCompilerSessionSetArtifactCacheCapacity,
+        None,
+        [c_void_p, c_size_t],
+    )
+    _setsig(
+        _dylib.ireeCompilerSessionGetArtifactCacheStatistics,
+        None,
+        [c_void_p, POINTER(c_size_t), POINTER(c_size_t)],
+    )
     # From mlir_interop.h.
     _setsig(
         _dylib.ireeCompilerSessionStealContext,
@@ -264,6 +274,26 @@ class Session:
             _dylib.ireeCompilerSessionSetFlags(self._session_p, len(argv), argv)
         )
 
+    def set_artifact_cache_capacity(self, capacity: int):
+        """Sets the total size in bytes of compiled artifacts to retain.
+
+        Invocations compiling a byte-identical source with the same flags reuse
+        the retained VM bytecode instead of running the pipeline. A capacity of
+        0 disables the cache.
+        """
+        assert self._session_p, "Session is closed"
+        _dylib.ireeCompilerSessionSetArtifactCacheCapacity(self._session_p, capacity)
+
+    def get_artifact_cache_statistics(self) -> Tuple[int, int]:
+        """Returns the (hit_count, miss_count) of the artifact cache."""
+        assert self._session_p, "Session is closed"
+        hit_count = c_size_t()
+        miss_count = c_size_t()
+        _dylib.ireeCompilerSessionGetArtifactCacheStatistics(
+            self._session_p, byref(hit_count), byref(miss_count)
+        )
+        return hit_count.value, miss_count.value
+
 
 class Output:
     """Wraps an iree_compiler_output_t."""
@@ -198,6 +198,35 @@ else:
             inv.output_vm_bytecode(out)
             out.close()
 
+        def testArtifactCache(self):
+            session = Session()
+            session.set_flags("--iree-hal-target-backends=vmvx")
+            session.set_artifact_cache_capacity(1 << 20)
+
+            def compile_module():
+                inv = session.invocation()
+                source = Source.wrap_buffer(
+                    session,
+                    b"""
+                    builtin.module {
+                        func.func @main(%arg0: i32) -> (i32) {
+                            return %arg0 : i32
+                        }
+                    }
+                    """,
+                )
+                inv.parse_source(source)
+                inv.execute()
+                out = Output.open_membuffer()
+                inv.output_vm_bytecode(out)
+                return bytes(out.map_memory())
+
+            first = compile_module()
+            self.assertEqual(session.get_artifact_cache_statistics(), (0, 1))
+            second = compile_module()
+            self.assertEqual(session.get_artifact_cache_statistics(), (1, 1))
+            self.assertEqual(first, second)
+
     class DlOutputTest(unittest.TestCase):
         def testOpenMembuffer(self):
             out = Output.open_membuffer()
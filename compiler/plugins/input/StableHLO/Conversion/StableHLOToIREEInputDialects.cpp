@@ -29,6 +29,7 @@
 #include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
 #include "mlir/IR/BuiltinTypes.h"
 #include "mlir/IR/MLIRContext.h"
 #include "mlir/IR/PatternMatch.h"
@@ -110,22 +111,23 @@ struct ConcatenateOpConversion final
 
 /// Creates coefficients based on DFT definition, see
 /// https://en.wikipedia.org/wiki/Discrete_Fourier_transform.
-Value getDFTMatmulCoeff(OpBuilder b, Location loc, RankedTensorType matrixType,
-                        bool isRealPart) {
+/// The real coefficients occupy the first half of the columns of |matrixType|
+/// and the imaginary coefficients the second half so that both parts of the
+/// transform are computed by a single matmul.
+Value getDFTMatmulCoeff(OpBuilder b, Location loc,
+                        RankedTensorType matrixType) {
   // scale = 2 * pi / N
   double scale = 2 * M_PI / matrixType.getDimSize(0);
 
   SmallVector<Attribute> values;
   assert(matrixType.getRank() == 2 && "expected 2D matrix");
+  int64_t fftLength = matrixType.getDimSize(1) / 2;
   for (auto i : llvm::seq<unsigned>(0, matrixType.getDimSize(0))) {
-    for (auto j : llvm::seq<unsigned>(0, matrixType.getDimSize(1))) {
-      double v = scale * i * j;
-      if (isRealPart) {
-        v = cos(v);
-      } else {
-        v = -sin(v);
-      }
-      values.push_back(b.getF32FloatAttr(v));
+    for (auto j : llvm::seq<unsigned>(0, fftLength)) {
+      values.push_back(b.getF32FloatAttr(cos(scale * i * j)));
+    }
+    for (auto j : llvm::seq<unsigned>(0, fftLength)) {
+      values.push_back(b.getF32FloatAttr(-sin(scale * i * j)));
     }
   }
   return b.create<arith::ConstantOp>(
@@ -183,20 +185,29 @@ struct FftOpConversion final : OpConversionPattern<mlir::stablehlo::FftOp> {
 
     Location loc = op.getLoc();
     auto matrixType =
-        RankedTensorType::get({n, fftLength}, inputType.getElementType());
+        RankedTensorType::get({n, 2 * fftLength}, inputType.getElementType());
     auto resultType = RankedTensorType::get(
         llvm::cast<RankedTensorType>(op.getType()).getShape(),
         inputType.getElementType());
-
-    Value realMatrix =
-        getDFTMatmulCoeff(rewriter, loc, matrixType, /*isRealPart=*/true);
-    Value real = createLinalgMatmulOnTensors(rewriter, loc, resultType,
-                                             adaptor.getOperand(), realMatrix);
-
-    Value imagMatrix =
-        getDFTMatmulCoeff(rewriter, loc, matrixType, /*isRealPart=*/false);
-    Value imag = createLinalgMatmulOnTensors(rewriter, loc, resultType,
-                                             adaptor.getOperand(), imagMatrix);
+    SmallVector<int64_t> matmulShape(resultType.getShape());
+    matmulShape.back() = 2 * fftLength;
+    auto matmulType =
+        RankedTensorType::get(matmulShape, inputType.getElementType());
+
+    // Compute the real and imaginary parts with one matmul against the
+    // concatenated coefficients and split the result.
+    Value coeffMatrix = getDFTMatmulCoeff(rewriter, loc, matrixType);
+    Value matmul = createLinalgMatmulOnTensors(
+        rewriter, loc, matmulType, adaptor.getOperand(), coeffMatrix);
+    SmallVector<OpFoldResult> offsets(rank, rewriter.getIndexAttr(0));
+    SmallVector<OpFoldResult> sizes =
+        getAsIndexOpFoldResult(rewriter.getContext(), resultType.getShape());
+    SmallVector<OpFoldResult> strides(rank, rewriter.getIndexAttr(1));
+    Value real = rewriter.create<tensor::ExtractSliceOp>(
+        loc, resultType, matmul, offsets, sizes, strides);
+    offsets.back() = rewriter.getIndexAttr(fftLength);
+    Value imag = rewriter.create<tensor::ExtractSliceOp>(
+        loc, resultType, matmul, offsets, sizes, strides);
 
     // Pack the results back to mlir::stablehlo::ComplexOp.
     rewriter.replaceOpWithNewOp<mlir::stablehlo::ComplexOp>(op, op.getType(),
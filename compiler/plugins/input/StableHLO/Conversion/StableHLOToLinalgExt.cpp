@@ -293,6 +293,14 @@ struct ScatterOpConversion final
 // FftOp
 //===----------------------------------------------------------------------===//
 
+// Batched real FFTs of at most this length with at least
+// kMinDftMatmulBatchSize rows are left to be lowered as a single DFT matmul.
+// The radix-2 lowering below emits one iree_linalg_ext.fft stage per log2(N)
+// and each stage becomes its own dispatch, which for many short transforms is
+// dominated by dispatch overhead and memory traffic between stages.
+constexpr int64_t kMaxDftMatmulFftLength = 1024;
+constexpr int64_t kMinDftMatmulBatchSize = 64;
+
 struct FftOpConversion final : OpConversionPattern<mlir::stablehlo::FftOp> {
   using OpConversionPattern::OpConversionPattern;
 
@@ -383,6 +391,12 @@ struct FftOpConversion final : OpConversionPattern<mlir::stablehlo::FftOp> {
       return rewriter.notifyMatchFailure(
           op, "expected FFT length to be a power of two");
     }
+    if (op.getFftType() == mlir::stablehlo::FftType::RFFT &&
+        operandType.getRank() == 2 && fftLength <= kMaxDftMatmulFftLength &&
+        operandType.getDimSize(0) >= kMinDftMatmulBatchSize) {
+      return rewriter.notifyMatchFailure(
+          op, "batched short RFFT is lowered as a DFT matmul");
+    }
 
     ImplicitLocOpBuilder b(op.getLoc(), rewriter);
     // Skip else getBitReversalOrder produces invalid dense elements attr.
@@ -140,3 +140,23 @@ func.func @select_conversion(%arg0: tensor<i1>, %arg1: tensor<?xui16>, %arg2: te
   %0 = arith.select %extracted, %arg1, %arg2 : tensor<?xui16>
   return %0 : tensor<?xui16>
 }
+
+// -----
+
+// Real and imaginary parts of a DFT are computed by a single matmul against
+// the concatenated coefficients.
+// CHECK-LABEL: @rfft_dft_matmul
+func.func @rfft_dft_matmul(%input: tensor<128x16xf32>) -> (tensor<128x9xf32>, tensor<128x9xf32>) {
+  %0 = "stablehlo.fft"(%input) {
+    fft_length = array<i64: 16>, fft_type = #stablehlo<fft_type RFFT>
+  } : (tensor<128x16xf32>) -> tensor<128x9xcomplex<f32>>
+  %1 = "stablehlo.real"(%0) : (tensor<128x9xcomplex<f32>>) -> tensor<128x9xf32>
+  %2 = "stablehlo.imag"(%0) : (tensor<128x9xcomplex<f32>>) -> tensor<128x9xf32>
+  return %1, %2 : tensor<128x9xf32>, tensor<128x9xf32>
+}
+// CHECK:        %[[COEFF:.+]] = arith.constant dense<{{.+}}> : tensor<16x18xf32>
+// CHECK:        %[[MATMUL:.+]] = linalg.matmul
+// CHECK-SAME:     ins(%{{.+}}, %[[COEFF]] : tensor<128x16xf32>, tensor<16x18xf32>)
+// CHECK-NOT:    linalg.matmul
+// CHECK-DAG:    tensor.extract_slice %[[MATMUL]][0, 0] [128, 9] [1, 1]
+// CHECK-DAG:    tensor.extract_slice %[[MATMUL]][0, 9] [128, 9] [1, 1]
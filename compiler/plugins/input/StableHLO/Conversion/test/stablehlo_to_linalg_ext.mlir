@@ -664,3 +664,16 @@ func.func @prefix(%arg0: tensor<7x5xi32>, %arg1: tensor<i32>) -> tensor<7x5xi32>
 // CHECK:         iree_linalg_ext.yield %[[ADD]]
 // CHECK:       } -> tensor<7x5xi32>, tensor<7xi32>
 // CHECK:       return %[[SCAN]]#0 : tensor<7x5xi32>
+
+// -----
+
+// Batched short real FFTs are left to be lowered as a single DFT matmul.
+// CHECK-LABEL: func.func @rfft_2d_batched
+func.func @rfft_2d_batched(%input: tensor<128x512xf32>) -> tensor<128x257xcomplex<f32>> {
+  %0 = "stablehlo.fft"(%input) {
+    fft_length = array<i64: 512>, fft_type = #stablehlo<fft_type RFFT>
+  } : (tensor<128x512xf32>) -> tensor<128x257xcomplex<f32>>
+  return %0 : tensor<128x257xcomplex<f32>>
+}
+// CHECK-NOT:    iree_linalg_ext.fft
+// CHECK:        stablehlo.fft
@@ -148,6 +148,12 @@ public:
       MLIRContext *context, StringRef deviceID, DictionaryAttr deviceConfigAttr,
       SmallVectorImpl<IREE::HAL::ExecutableTargetAttr> &executableTargetAttrs)
       const override {
+    // Specialized variants come first so that they are tried before falling
+    // back to the unconditional default variant at runtime.
+    for (const LLVMTarget &variantTarget : defaultOptions_.targetVariants) {
+      executableTargetAttrs.push_back(
+          getExecutableTarget(context, variantTarget));
+    }
     executableTargetAttrs.push_back(
         getExecutableTarget(context, defaultOptions_.target));
   }
@@ -70,6 +70,9 @@ LLVMTarget::create(std::string_view triple, std::string_view cpu,
   target.cpu = cpu;
   target.cpuFeatures = cpuFeatures;
   status = resolveCPUAndCPUFeatures(triple, target.cpu, target.cpuFeatures);
+  if (cpu == "host") {
+    resolveHostCacheSizes(target.l2CacheSize, target.l3CacheSize);
+  }
   return target;
 }
 
@@ -95,6 +98,9 @@ void LLVMTarget::print(llvm::raw_ostream &os) const {
      << ", cpuFeatures=" << cpuFeatures << "\n"
      << "  dataLayout=" << dataLayout << "\n"
      << "  vectorWidthInBytes=" << vectorWidthInBytes << "\n"
+     << "  numThreads=" << numThreads << "\n"
+     << "  l2CacheSize=" << l2CacheSize << "\n"
+     << "  l3CacheSize=" << l3CacheSize << "\n"
      << "  linkEmbedded=" << linkEmbedded << "\n"
      << "  debugSymbols=" << debugSymbols << "\n"
      << "  sanitizer=" << static_cast<int>(sanitizerKind) << "\n"
@@ -114,6 +120,7 @@ void LLVMTarget::print(llvm::raw_ostream &os) const {
      << "  }\n"
      << "  ukernels=" << ukernels << "\n"
      << "  linkUkernelBitcode=" << linkUkernelBitcode << "\n"
+     << "  selectOnCPUFeatures=" << selectOnCPUFeatures << "\n"
      << "}\n";
 }
 
@@ -139,6 +146,15 @@ void LLVMTarget::storeToConfigAttrs(MLIRContext *context,
   if (vectorWidthInBytes != DEFAULT_VECTOR_WIDTH_IN_BYTES) {
     addInt64("native_vector_size", vectorWidthInBytes);
   }
+  if (numThreads != DEFAULT_NUM_THREADS) {
+    addInt64("num_threads", numThreads);
+  }
+  if (l2CacheSize != DEFAULT_CACHE_SIZE) {
+    addInt64("l2_cache_size", l2CacheSize);
+  }
+  if (l3CacheSize != DEFAULT_CACHE_SIZE) {
+    addInt64("l3_cache_size", l3CacheSize);
+  }
   if (linkEmbedded != DEFAULT_LINK_EMBEDDED) {
     addBool("link_embedded", linkEmbedded);
   }
@@ -191,6 +207,8 @@ void LLVMTarget::storeToConfigAttrs(MLIRContext *context,
     addString("ukernels", ukernels);
   if (linkUkernelBitcode != DEFAULT_LINK_UKERNEL_BITCODE)
     addBool("link_ukernel_bitcode", linkUkernelBitcode);
+  if (selectOnCPUFeatures != DEFAULT_SELECT_ON_CPU_FEATURES)
+    addBool("select_on_cpu_features", selectOnCPUFeatures);
 }
 
 std::optional<LLVMTarget>
@@ -281,6 +299,9 @@ LLVMTarget::loadFromConfigAttr(Location loc, DictionaryAttr config,
   target.dataLayout = getString("data_layout", DEFAULT_DATA_LAYOUT, false);
   target.vectorWidthInBytes =
       getInt64("native_vector_size", DEFAULT_VECTOR_WIDTH_IN_BYTES);
+  target.numThreads = getInt64("num_threads", DEFAULT_NUM_THREADS);
+  target.l2CacheSize = getInt64("l2_cache_size", DEFAULT_CACHE_SIZE);
+  target.l3CacheSize = getInt64("l3_cache_size", DEFAULT_CACHE_SIZE);
 
   target.debugSymbols = getBool("debug_symbols", DEFAULT_DEBUG_SYMBOLS);
   target.linkStatic = getBool("link_static", DEFAULT_LINK_STATIC);
@@ -328,6 +349,8 @@ LLVMTarget::loadFromConfigAttr(Location loc, DictionaryAttr config,
   target.ukernels = getString("ukernels", target.ukernels, false);
   target.linkUkernelBitcode =
       getBool("link_ukernel_bitcode", target.linkUkernelBitcode);
+  target.selectOnCPUFeatures =
+      getBool("select_on_cpu_features", DEFAULT_SELECT_ON_CPU_FEATURES);
 
   if (hasFailures) {
     return {};
@@ -522,6 +545,17 @@ void LLVMCPUTargetCLOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::cat(category),
       llvm::cl::desc("LLVM target machine CPU features; use 'host' for your "
                      "host native CPU."));
+  binder.opt<std::string>(
+      "iree-llvmcpu-target-cpu-variants", targetCPUVariants,
+      llvm::cl::cat(category),
+      llvm::cl::desc(
+          "Semicolon-separated list of additional LLVM target machine CPUs to "
+          "compile specialized executable variants for, most specialized "
+          "first. Each entry is a CPU name optionally followed by ':' and its "
+          "CPU features (e.g. 'znver4;haswell' or 'generic:+dotprod,+i8mm'). "
+          "The first variant whose CPU features are all supported by the "
+          "device CPU is selected at runtime and the variant for "
+          "--iree-llvmcpu-target-cpu is used if none are."));
   binder.opt<bool>(
       "iree-llvmcpu-link-embedded", linkEmbedded, llvm::cl::cat(category),
       llvm::cl::desc("Links binaries into a platform-agnostic ELF to be "
@@ -581,6 +615,24 @@ void LLVMCPUTargetCLOptions::bindOptions(OptionsBinder &binder) {
                        targetVectorWidthInBytes, llvm::cl::cat(category),
                        llvm::cl::desc("Overrides the native vector register "
                                       "width (in bytes) of the target."));
+  binder.opt<unsigned>(
+      "iree-llvmcpu-target-num-threads", targetNumThreads,
+      llvm::cl::cat(category),
+      llvm::cl::desc("Number of threads the executables are expected to run "
+                     "on. When set, small workloads are distributed such "
+                     "that all threads are occupied."));
+  binder.opt<unsigned>(
+      "iree-llvmcpu-target-l2-cache-size", targetL2CacheSize,
+      llvm::cl::cat(category),
+      llvm::cl::desc("Overrides the per-core L2 cache size (in bytes) of the "
+                     "target. Detected from the host when the target CPU is "
+                     "`host`."));
+  binder.opt<unsigned>(
+      "iree-llvmcpu-target-l3-cache-size", targetL3CacheSize,
+      llvm::cl::cat(category),
+      llvm::cl::desc("Overrides the shared L3 cache size (in bytes) of the "
+                     "target. Detected from the host when the target CPU is "
+                     "`host`."));
   binder.opt<std::string>(
       "iree-llvmcpu-enable-ukernels", enableUkernels, llvm::cl::cat(category),
       llvm::cl::desc("Enables ukernels in the llvmcpu backend. May be "
@@ -618,7 +670,33 @@ LLVMTargetOptions LLVMCPUTargetCLOptions::getTargetOptions() {
   } else {
     llvm::errs() << "The target CPU is not properly defined.\n";
   }
-  LLVMTarget &target = targetOptions.target;
+  applyTargetOptions(targetOptions.target);
+
+  // Specialized variants share all options with the default target except for
+  // the CPU and its features.
+  SmallVector<StringRef> variantStrings;
+  StringRef(targetCPUVariants)
+      .split(variantStrings, ';', /*MaxSplit=*/-1, /*KeepEmpty=*/false);
+  for (StringRef variantString : variantStrings) {
+    auto [variantCPU, variantCPUFeatures] = variantString.trim().split(':');
+    std::optional<LLVMTarget> maybeVariantTarget =
+        LLVMTarget::create(targetTriple, variantCPU.str(),
+                           variantCPUFeatures.str(), linkEmbedded, status);
+    (void)status; // Ignored for the same reason as the default target above.
+    if (!maybeVariantTarget) {
+      llvm::errs() << "The target CPU variant '" << variantString
+                   << "' is not properly defined.\n";
+      continue;
+    }
+    applyTargetOptions(*maybeVariantTarget);
+    maybeVariantTarget->selectOnCPUFeatures = true;
+    targetOptions.targetVariants.push_back(*maybeVariantTarget);
+  }
+
+  return targetOptions;
+}
+
+void LLVMCPUTargetCLOptions::applyTargetOptions(LLVMTarget &target) {
   target.linkStatic = linkStatic;
   target.staticLibraryOutput = staticLibraryOutputPath;
   target.debugSymbols = debugSymbols;
@@ -631,11 +709,17 @@ LLVMTargetOptions LLVMCPUTargetCLOptions::getTargetOptions() {
   target.llvmTargetOptions.FloatABIType = targetFloatABI;
   target.dataLayout = targetDataLayout;
   target.vectorWidthInBytes = targetVectorWidthInBytes;
+  target.numThreads = targetNumThreads;
+  if (targetL2CacheSize != LLVMTarget::DEFAULT_CACHE_SIZE) {
+    target.l2CacheSize = targetL2CacheSize;
+  }
+  if (targetL3CacheSize != LLVMTarget::DEFAULT_CACHE_SIZE) {
+    target.l3CacheSize = targetL3CacheSize;
+  }
   target.ukernels = enableUkernels;
   target.linkUkernelBitcode = linkUKernelBitcode;
 
   target.populateDefaultsFromTargetMachine();
-  return targetOptions;
 }
 
 } // namespace mlir::iree_compiler::IREE::HAL
@@ -8,6 +8,7 @@
 #define IREE_COMPILER_PLUGINS_TARGET_LLVMCPU_LLVMTARGETOPTIONS_H_
 
 #include <string_view>
+#include <vector>
 
 #include "compiler/plugins/target/LLVMCPU/ResolveCPUAndCPUFeatures.h"
 #include "iree/compiler/Utils/OptionUtils.h"
@@ -33,6 +34,8 @@ enum class SanitizerKind {
 struct LLVMTarget {
   static constexpr const char *DEFAULT_DATA_LAYOUT = "";
   static constexpr int64_t DEFAULT_VECTOR_WIDTH_IN_BYTES = 0;
+  static constexpr int64_t DEFAULT_NUM_THREADS = 0;
+  static constexpr int64_t DEFAULT_CACHE_SIZE = 0;
   static constexpr bool DEFAULT_LINK_EMBEDDED = true;
   static constexpr bool DEFAULT_DEBUG_SYMBOLS = true;
   static constexpr SanitizerKind DEFAULT_SANITIZER_KIND = SanitizerKind::kNone;
@@ -45,6 +48,7 @@ struct LLVMTarget {
       llvm::FloatABI::ABIType::Hard;
   static constexpr const char *DEFAULT_ENABLE_UKERNELS = "default";
   static constexpr bool DEFAULT_LINK_UKERNEL_BITCODE = true;
+  static constexpr bool DEFAULT_SELECT_ON_CPU_FEATURES = false;
 
   // Default initialize all fields.
   LLVMTarget();
@@ -55,6 +59,9 @@ struct LLVMTarget {
     cpuFeatures = other.cpuFeatures;
     dataLayout = other.dataLayout;
     vectorWidthInBytes = other.vectorWidthInBytes;
+    numThreads = other.numThreads;
+    l2CacheSize = other.l2CacheSize;
+    l3CacheSize = other.l3CacheSize;
     linkEmbedded = other.linkEmbedded;
     ukernels = other.ukernels;
     linkUkernelBitcode = other.linkUkernelBitcode;
@@ -88,6 +95,13 @@ struct LLVMTarget {
   std::string dataLayout = DEFAULT_DATA_LAYOUT;
   // Overrides the vector width (in bytes) of the target.
   int64_t vectorWidthInBytes = DEFAULT_VECTOR_WIDTH_IN_BYTES;
+  // Number of threads the executables are expected to run on or 0 if unknown.
+  // Used to distribute small workloads such that all threads are occupied.
+  int64_t numThreads = DEFAULT_NUM_THREADS;
+  // Sizes (in bytes) of the per-core L2 and the shared L3 caches or 0 if
+  // unknown. Used to keep the tiles processed by each workgroup cache-resident.
+  int64_t l2CacheSize = DEFAULT_CACHE_SIZE;
+  int64_t l3CacheSize = DEFAULT_CACHE_SIZE;
 
   llvm::PipelineTuningOptions pipelineTuningOptions;
   // Optimization level to be used by the LLVM optimizer (middle-end).
@@ -128,6 +142,11 @@ struct LLVMTarget {
   // Link built-in ukernel bitcode libraries into generated executables.
   bool linkUkernelBitcode = DEFAULT_LINK_UKERNEL_BITCODE;
 
+  // True if this target is a specialization of a more generic target and
+  // variants produced for it should only be selected at runtime when the
+  // device CPU supports all of its CPU features.
+  bool selectOnCPUFeatures = DEFAULT_SELECT_ON_CPU_FEATURES;
+
 private:
   void populateDefaultsFromTargetMachine();
 
@@ -148,6 +167,12 @@ struct LLVMTargetOptions {
   // Default target machine configuration.
   LLVMTarget target;
 
+  // Specialized target machine configurations that executables are compiled
+  // for in addition to the default target, most specialized first. Each is
+  // selected at runtime only if the device CPU supports its CPU features and
+  // otherwise the default target is used.
+  std::vector<LLVMTarget> targetVariants;
+
   // Tool to use for native platform linking (like ld on Unix or link.exe on
   // Windows). Acts as a prefix to the command line and can contain additional
   // arguments.
@@ -181,6 +206,7 @@ struct LLVMCPUTargetCLOptions {
   std::string targetCPU;
   std::string loggingUnspecifiedTargetCPU;
   std::string targetCPUFeatures;
+  std::string targetCPUVariants;
   bool linkEmbedded = LLVMTarget::DEFAULT_LINK_EMBEDDED;
   bool linkStatic = LLVMTarget::DEFAULT_LINK_STATIC;
   std::string staticLibraryOutputPath;
@@ -194,12 +220,19 @@ struct LLVMCPUTargetCLOptions {
   llvm::FloatABI::ABIType targetFloatABI = LLVMTarget::DEFAULT_FLOAT_ABI;
   std::string targetDataLayout = LLVMTarget::DEFAULT_DATA_LAYOUT;
   unsigned targetVectorWidthInBytes = LLVMTarget::DEFAULT_VECTOR_WIDTH_IN_BYTES;
+  unsigned targetNumThreads = LLVMTarget::DEFAULT_NUM_THREADS;
+  unsigned targetL2CacheSize = LLVMTarget::DEFAULT_CACHE_SIZE;
+  unsigned targetL3CacheSize = LLVMTarget::DEFAULT_CACHE_SIZE;
   std::string enableUkernels = LLVMTarget::DEFAULT_ENABLE_UKERNELS;
   bool linkUKernelBitcode = LLVMTarget::DEFAULT_LINK_UKERNEL_BITCODE;
   bool listTargets; // Ignored - used with llvm::cl::ValueDisallowed.
 
   void bindOptions(OptionsBinder &binder);
   LLVMTargetOptions getTargetOptions();
+
+private:
+  // Applies the target-independent flags to |target|.
+  void applyTargetOptions(LLVMTarget &target);
 };
 
 } // namespace mlir::iree_compiler::IREE::HAL
@@ -12,6 +12,10 @@
 #include "llvm/TargetParser/Triple.h"
 #include "llvm/TargetParser/X86TargetParser.h"
 
+#if defined(__linux__)
+#include <unistd.h>
+#endif // __linux__
+
 namespace mlir::iree_compiler::IREE::HAL {
 
 namespace {
@@ -170,6 +174,23 @@ resolveCPUAndCPUFeatures(std::string_view triple_str, std::string &cpu,
   return combine(combine(status1, status2), status3);
 }
 
+void resolveHostCacheSizes(int64_t &l2CacheSize, int64_t &l3CacheSize) {
+#if defined(_SC_LEVEL2_CACHE_SIZE) && defined(_SC_LEVEL3_CACHE_SIZE)
+  if (l2CacheSize <= 0) {
+    long size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (size > 0) {
+      l2CacheSize = size;
+    }
+  }
+  if (l3CacheSize <= 0) {
+    long size = sysconf(_SC_LEVEL3_CACHE_SIZE);
+    if (size > 0) {
+      l3CacheSize = size;
+    }
+  }
+#endif // _SC_LEVEL2_CACHE_SIZE && _SC_LEVEL3_CACHE_SIZE
+}
+
 std::string getMessage(ResolveCPUAndCPUFeaturesStatus status,
                        std::string_view triple_str) {
   switch (status) {
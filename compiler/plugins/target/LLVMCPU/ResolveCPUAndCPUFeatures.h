@@ -7,6 +7,7 @@
 #ifndef IREE_COMPILER_PLUGINS_TARGET_LLVMCPU_RESOLVECPUANDCPUFEATURES_H_
 #define IREE_COMPILER_PLUGINS_TARGET_LLVMCPU_RESOLVECPUANDCPUFEATURES_H_
 
+#include <cstdint>
 #include <string>
 #include <string_view>
 
@@ -26,6 +27,10 @@ ResolveCPUAndCPUFeaturesStatus
 resolveCPUAndCPUFeatures(std::string_view triple, std::string &cpu,
                          std::string &cpuFeatures);
 
+// Populates the `l2CacheSize` and `l3CacheSize` (in bytes) of the host CPU if
+// they are not already set and can be queried on the host platform.
+void resolveHostCacheSizes(int64_t &l2CacheSize, int64_t &l3CacheSize);
+
 std::string getMessage(ResolveCPUAndCPUFeaturesStatus status,
                        std::string_view triple);
 
@@ -39,6 +39,8 @@
 #include <cstdio>
 #include <cstdlib>
 #include <limits>
+#include <list>
+#include <mutex>
 
 #include "iree/compiler/API/Internal/Diagnostics.h"
 #include "iree/compiler/ConstEval/Passes.h"
@@ -53,6 +55,8 @@
 #include "iree/compiler/Utils/TracingUtils.h"
 #include "iree/compiler/embedding_api.h"
 #include "iree/compiler/mlir_interop.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Allocator.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/ManagedStatic.h"
@@ -64,6 +68,7 @@
 #include "llvm/Support/SourceMgr.h"
 #include "llvm/Support/ThreadPool.h"
 #include "llvm/Support/ToolOutputFile.h"
+#include "llvm/Support/xxhash.h"
 #include "mlir/Bytecode/BytecodeWriter.h"
 #include "mlir/CAPI/IR.h"
 #include "mlir/CAPI/Wrap.h"
@@ -87,7 +92,7 @@
 #endif
 
 #define IREE_COMPILER_API_MAJOR 1
-#define IREE_COMPILER_API_MINOR 4
+#define IREE_COMPILER_API_MINOR 5
 
 namespace mlir::iree_compiler::embed {
 namespace {
@@ -307,6 +312,77 @@ void GlobalInit::initializeContext(MLIRContext &context) {
   }
 }
 
+// Cache of compiled artifacts keyed by a hash of the source and of the
+// session configuration used to compile it. Shared by all invocations in a
+// session and evicted in least-recently-used order once the total size of the
+// cached artifacts exceeds the capacity. A capacity of 0 disables caching.
+class ArtifactCache {
+public:
+  using Key = std::pair<uint64_t, uint64_t>;
+
+  bool isEnabled() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return capacity > 0;
+  }
+
+  void setCapacity(size_t newCapacity) {
+    std::lock_guard<std::mutex> lock(mutex);
+    capacity = newCapacity;
+    evict();
+  }
+
+  void getStatistics(size_t *outHitCount, size_t *outMissCount) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (outHitCount)
+      *outHitCount = hitCount;
+    if (outMissCount)
+      *outMissCount = missCount;
+  }
+
+  // Returns the artifact cached for |key| or nullptr if not cached.
+  std::shared_ptr<const std::string> lookup(Key key) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it == index.end()) {
+      ++missCount;
+      return nullptr;
+    }
+    ++hitCount;
+    entries.splice(entries.begin(), entries, it->second);
+    return it->second->second;
+  }
+
+  void insert(Key key, std::string artifact) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (artifact.size() > capacity || index.count(key))
+      return;
+    size += artifact.size();
+    entries.emplace_front(
+        key, std::make_shared<const std::string>(std::move(artifact)));
+    index[key] = entries.begin();
+    evict();
+  }
+
+private:
+  void evict() {
+    while (size > capacity) {
+      auto &entry = entries.back();
+      size -= entry.second->size();
+      index.erase(entry.first);
+      entries.pop_back();
+    }
+  }
+
+  std::mutex mutex;
+  size_t capacity = 0;
+  size_t size = 0;
+  size_t hitCount = 0;
+  size_t missCount = 0;
+  // Most recently used first.
+  std::list<std::pair<Key, std::shared_ptr<const std::string>>> entries;
+  llvm::DenseMap<Key, decltype(entries)::iterator> index;
+};
+
 struct Session {
   Session(GlobalInit &globalInit);
 
@@ -387,6 +463,9 @@ struct Session {
   bool pluginsActivated = false;
   LogicalResult pluginActivationStatus{failure()};
 
+  // Artifacts produced by prior invocations; disabled until a capacity is set.
+  ArtifactCache artifactCache;
+
   BindingOptions bindingOptions;
   InputDialectOptions inputOptions;
   PreprocessingOptions preprocessingOptions;
@@ -691,6 +770,7 @@ struct Invocation {
   void dumpCompilationPhase(IREEVMPipelinePhase phase,
                             OpPassManager &passManager);
   bool runTextualPassPipeline(const char *textPassPipeline);
+  bool lookupCachedArtifact();
   Error *outputIR(Output &output);
   Error *outputIRBytecode(Output &output, int bytecodeVersion);
   Error *outputVMBytecode(Output &output);
@@ -710,6 +790,15 @@ struct Invocation {
   Operation *parsedModule = nullptr;
   bool parsedModuleIsOwned = false;
 
+  // Artifact cache state. The source hash is only known when the invocation
+  // parsed the source itself. When the pipeline was skipped because the
+  // session had a matching artifact the parsed module remains uncompiled and
+  // only the cached artifact may be output.
+  std::optional<uint64_t> sourceHash;
+  std::string sourceName;
+  std::optional<ArtifactCache::Key> artifactCacheKey;
+  std::shared_ptr<const std::string> cachedArtifact;
+
   // Run options.
   std::string compileToPhaseName{"end"};
   std::string compileFromPhaseName{"start"};
@@ -848,6 +937,11 @@ bool Invocation::parseSource(Source &source) {
   // Transfer to the instance.
   parsedModule = ownedModule.release();
   parsedModuleIsOwned = true;
+
+  const llvm::MemoryBuffer *buffer = source.getMemoryBuffer();
+  sourceHash =
+      llvm::xxh3_64bits(llvm::arrayRefFromStringRef(buffer->getBuffer()));
+  sourceName = buffer->getBufferIdentifier().str();
   return true;
 }
 
@@ -869,7 +963,7 @@ bool Invocation::importModule(Operation *inputModule, bool steal) {
 }
 
 Operation *Invocation::exportModule() {
-  if (!parsedModuleIsOwned)
+  if (!parsedModuleIsOwned || cachedArtifact)
     return nullptr;
   parsedModuleIsOwned = false;
   return parsedModule;
@@ -945,6 +1039,9 @@ bool Invocation::runPipeline(enum iree_compiler_pipeline_t pipeline) {
     if (!getCompilationPhase(compileFrom, compileTo)) {
       return false;
     }
+    if (lookupCachedArtifact()) {
+      return true;
+    }
 
     // TODO: move to someplace centralized; erroring here is not great.
     // InlineStatic (currently) only supports the `vmvx-inline` backend.
@@ -1013,7 +1110,34 @@ bool Invocation::runPipeline(enum iree_compiler_pipeline_t pipeline) {
   return true;
 }
 
+bool Invocation::lookupCachedArtifact() {
+  if (!sourceHash || !dumpCompilationPhasesTo.empty() ||
+      !session.artifactCache.isEnabled()) {
+    return false;
+  }
+
+  // Everything besides the source that influences the compiler output.
+  std::string config;
+  llvm::raw_string_ostream os(config);
+  os << sourceName << '\n' << compileFromPhaseName << '\n'
+     << compileToPhaseName << '\n';
+  for (auto &flag : session.binder.printArguments(/*nonDefaultOnly=*/false)) {
+    os << flag << '\n';
+  }
+  os.flush();
+
+  artifactCacheKey = {*sourceHash,
+                      llvm::xxh3_64bits(llvm::arrayRefFromStringRef(config))};
+  cachedArtifact = session.artifactCache.lookup(*artifactCacheKey);
+  return cachedArtifact != nullptr;
+}
+
 bool Invocation::runTextualPassPipeline(const char *textPassPipeline) {
+  if (cachedArtifact) {
+    parsedModule->emitError()
+        << "cannot run passes on an invocation served from the artifact cache";
+    return false;
+  }
   auto passManager = createPassManager();
   if (failed(mlir::parsePassPipeline(textPassPipeline, *passManager,
                                      llvm::errs())))
@@ -1024,12 +1148,23 @@ bool Invocation::runTextualPassPipeline(const char *textPassPipeline) {
   return true;
 }
 
+// Returns an error for outputs unavailable when the pipeline was skipped due
+// to an artifact cache hit.
+static Error *createCachedArtifactError() {
+  return new Error("only VM bytecode can be output from an invocation served "
+                   "from the artifact cache");
+}
+
 Error *Invocation::outputIR(Output &output) {
+  if (cachedArtifact)
+    return createCachedArtifactError();
   (*output.outputStream) << *parsedModule;
   return output.getWriteError();
 }
 
 Error *Invocation::outputIRBytecode(Output &output, int bytecodeVersion) {
+  if (cachedArtifact)
+    return createCachedArtifactError();
   mlir::BytecodeWriterConfig config;
   if (bytecodeVersion >= 0)
     config.setDesiredBytecodeVersion(bytecodeVersion);
@@ -1041,28 +1176,49 @@ Error *Invocation::outputIRBytecode(Output &output, int bytecodeVersion) {
 }
 
 Error *Invocation::outputVMBytecode(Output &output) {
+  if (cachedArtifact) {
+    output.outputStream->write(cachedArtifact->data(), cachedArtifact->size());
+    output.outputStream->flush();
+    return output.getWriteError();
+  }
+
+  // When the artifact may be cached it is translated into memory first so
+  // that it can be retained by the session.
+  std::string artifact;
+  std::optional<llvm::raw_string_ostream> artifactStream;
+  if (artifactCacheKey) {
+    artifactStream.emplace(artifact);
+  }
+  llvm::raw_ostream &os =
+      artifactStream ? *artifactStream : *output.outputStream;
+
   auto vmModule = llvm::dyn_cast<IREE::VM::ModuleOp>(*parsedModule);
   auto builtinModule = llvm::dyn_cast<mlir::ModuleOp>(*parsedModule);
   LogicalResult result = failure();
   if (vmModule) {
     result = translateModuleToBytecode(vmModule, session.vmTargetOptions,
-                                       session.bytecodeTargetOptions,
-                                       *output.outputStream);
+                                       session.bytecodeTargetOptions, os);
   } else if (builtinModule) {
     result = translateModuleToBytecode(builtinModule, session.vmTargetOptions,
-                                       session.bytecodeTargetOptions,
-                                       *output.outputStream);
+                                       session.bytecodeTargetOptions, os);
   } else {
     parsedModule->emitError() << "expected a vm.module or builtin.module";
   }
   if (failed(result)) {
     return new Error("failed to generate bytecode");
   }
+  if (artifactStream) {
+    artifactStream->flush();
+    output.outputStream->write(artifact.data(), artifact.size());
+    session.artifactCache.insert(*artifactCacheKey, std::move(artifact));
+  }
   output.outputStream->flush();
   return output.getWriteError();
 }
 
 Error *Invocation::outputVMCSource(Output &output) {
+  if (cachedArtifact)
+    return createCachedArtifactError();
 #ifndef IREE_HAVE_C_OUTPUT_FORMAT
   return new Error("VM C source output not enabled");
 #else
@@ -1088,6 +1244,8 @@ Error *Invocation::outputVMCSource(Output &output) {
 }
 
 Error *Invocation::outputHALExecutable(Output &output) {
+  if (cachedArtifact)
+    return createCachedArtifactError();
   // Extract the serialized binary representation from the executable.
   auto &block = parsedModule->getRegion(0).front();
   auto executableOp = *(block.getOps<IREE::HAL::ExecutableOp>().begin());
@@ -1350,6 +1508,16 @@ void ireeCompilerSessionGetFlags(
   unwrap(session)->getFlags(nonDefaultOnly, onFlag, userData);
 }
 
+void ireeCompilerSessionSetArtifactCacheCapacity(
+    iree_compiler_session_t *session, size_t capacity) {
+  unwrap(session)->artifactCache.setCapacity(capacity);
+}
+
+void ireeCompilerSessionGetArtifactCacheStatistics(
+    iree_compiler_session_t *session, size_t *hitCount, size_t *missCount) {
+  unwrap(session)->artifactCache.getStatistics(hitCount, missCount);
+}
+
 iree_compiler_invocation_t *
 ireeCompilerInvocationCreate(iree_compiler_session_t *session) {
   return wrap(new Invocation(*unwrap(session)));
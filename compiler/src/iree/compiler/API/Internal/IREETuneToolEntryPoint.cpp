@@ -0,0 +1,162 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Tuner/iree_tune_lib.h"
+#include "iree/compiler/tool_entry_points_api.h"
+
+#include "iree/compiler/Tools/init_dialects.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/InitLLVM.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Support/LogicalResult.h"
+
+using namespace mlir;
+using namespace llvm;
+using namespace mlir::iree_compiler;
+using namespace mlir::iree_compiler::Tuner;
+
+// Returns the path of |toolName| if specified explicitly, found next to the
+// running tool or found on the PATH.
+static std::string findTool(StringRef toolPath, StringRef toolName,
+                            StringRef argv0) {
+  if (!toolPath.empty()) {
+    return toolPath.str();
+  }
+  SmallString<256> toolDir(argv0);
+  sys::path::remove_filename(toolDir);
+  if (auto path = sys::findProgramByName(toolName, {StringRef(toolDir)})) {
+    return *path;
+  }
+  if (auto path = sys::findProgramByName(toolName)) {
+    return *path;
+  }
+  return toolName.str();
+}
+
+static LogicalResult ireeTuneMainFromCL(int argc, char **argv,
+                                        MLIRContext &context) {
+  cl::OptionCategory ireeTuneCategory("iree-tune options");
+
+  cl::list<std::string> inputFilenames(
+      cl::Positional, cl::OneOrMore,
+      cl::desc("<executable benchmark files>"), cl::cat(ireeTuneCategory));
+
+  cl::opt<std::string> outputFilename(
+      "o", cl::desc("Output filename for the tuning spec library."),
+      cl::value_desc("filename"), cl::init("tuning_spec.mlir"),
+      cl::cat(ireeTuneCategory));
+
+  cl::opt<std::string> workDir(
+      "work-dir",
+      cl::desc("Directory for candidate sources, modules and benchmark "
+               "results. A temporary directory is created if not specified."),
+      cl::init(""), cl::cat(ireeTuneCategory));
+
+  cl::opt<std::string> device(
+      "device", cl::desc("Device to benchmark on (e.g. `hip`, `local-task`)."),
+      cl::Required, cl::cat(ireeTuneCategory));
+
+  cl::opt<std::string> compileToolPath(
+      "iree-compile", cl::desc("Path of the iree-compile tool."),
+      cl::init(""), cl::cat(ireeTuneCategory));
+
+  cl::opt<std::string> benchmarkToolPath(
+      "iree-benchmark-module",
+      cl::desc("Path of the iree-benchmark-module tool."), cl::init(""),
+      cl::cat(ireeTuneCategory));
+
+  cl::list<std::string> compileFlags(
+      "Xiree-compile",
+      cl::desc("Flag passed to iree-compile. Must include the target flags "
+               "used to produce the executable benchmarks."),
+      cl::cat(ireeTuneCategory));
+
+  cl::list<std::string> benchmarkFlags(
+      "Xiree-benchmark-module",
+      cl::desc("Flag passed to iree-benchmark-module."),
+      cl::cat(ireeTuneCategory));
+
+  cl::opt<int64_t> benchmarkRepetitions(
+      "benchmark-repetitions",
+      cl::desc("Number of benchmark repetitions per configuration."),
+      cl::init(3), cl::cat(ireeTuneCategory));
+
+  cl::opt<int64_t> maxDispatches(
+      "max-dispatches",
+      cl::desc("Number of dispatches to tune, slowest first."), cl::init(8),
+      cl::cat(ireeTuneCategory));
+
+  cl::opt<int64_t> maxCandidates(
+      "max-candidates",
+      cl::desc("Number of candidate configurations evaluated per dispatch."),
+      cl::init(32), cl::cat(ireeTuneCategory));
+
+  cl::HideUnrelatedOptions(ireeTuneCategory);
+
+  InitLLVM y(argc, argv);
+
+  cl::ParseCommandLineOptions(
+      argc, argv,
+      "IREE dispatch autotuner.\n\n"
+      "Tunes the executable benchmarks produced by "
+      "--iree-hal-dump-executable-benchmarks-to= and writes a tuning spec "
+      "library for use with --iree-codegen-tuning-spec-path=.\n");
+
+  TunerConfig config;
+  config.outputPath = outputFilename;
+  config.device = device;
+  config.compileToolPath = findTool(compileToolPath, "iree-compile", argv[0]);
+  config.benchmarkToolPath =
+      findTool(benchmarkToolPath, "iree-benchmark-module", argv[0]);
+  config.compileFlags.assign(compileFlags.begin(), compileFlags.end());
+  config.benchmarkFlags.assign(benchmarkFlags.begin(), benchmarkFlags.end());
+  config.benchmarkRepetitions = benchmarkRepetitions;
+  config.maxDispatches = maxDispatches;
+  config.maxCandidates = maxCandidates;
+
+  if (workDir.empty()) {
+    SmallString<256> tempDir;
+    if (auto error = sys::fs::createUniqueDirectory("iree-tune", tempDir)) {
+      llvm::errs() << "failed to create work directory: " << error.message()
+                   << "\n";
+      return failure();
+    }
+    config.workDir = std::string(tempDir);
+  } else {
+    if (auto error = sys::fs::create_directories(workDir)) {
+      llvm::errs() << "failed to create work directory " << workDir << ": "
+                   << error.message() << "\n";
+      return failure();
+    }
+    config.workDir = workDir;
+  }
+  llvm::outs() << "using work directory " << config.workDir << "\n";
+
+  SmallVector<std::string> inputPaths(inputFilenames.begin(),
+                                      inputFilenames.end());
+  return runTuner(context, inputPaths, config);
+}
+
+int ireeTuneRunMain(int argc, char **argv) {
+  llvm::setBugReportMsg(
+      "Please report issues to https://github.com/iree-org/iree/issues and "
+      "include the crash backtrace.\n");
+
+  mlir::DialectRegistry registry;
+  mlir::iree_compiler::registerAllDialects(registry);
+
+  MLIRContext context(registry);
+  context.loadAllAvailableDialects();
+
+  if (ireeTuneMainFromCL(argc, argv, context).failed()) {
+    return 1;
+  }
+
+  return 0;
+}
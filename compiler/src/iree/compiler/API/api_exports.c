@@ -70,7 +70,9 @@ extern void ireeCompilerRunMain();
 extern void ireeCompilerSessionBorrowContext();
 extern void ireeCompilerSessionCreate();
 extern void ireeCompilerSessionDestroy();
+extern void ireeCompilerSessionGetArtifactCacheStatistics();
 extern void ireeCompilerSessionGetFlags();
+extern void ireeCompilerSessionSetArtifactCacheCapacity();
 extern void ireeCompilerSessionSetFlags();
 extern void ireeCompilerSessionStealContext();
 extern void ireeCompilerSetupGlobalCL();
@@ -100,6 +102,7 @@ extern void ireeMlirLspServerRunMain();
 extern void ireeOptRunMain();
 extern void ireeReduceRunMain();
 extern void ireeRegisterTransformExtensions();
+extern void ireeTuneRunMain();
 extern void mlirAffineAddExprGet();
 extern void mlirAffineBinaryOpExprGetLHS();
 extern void mlirAffineBinaryOpExprGetRHS();
@@ -932,7 +935,9 @@ uintptr_t __iree_compiler_hidden_force_extern() {
   x += (uintptr_t)&ireeCompilerSessionBorrowContext;
   x += (uintptr_t)&ireeCompilerSessionCreate;
   x += (uintptr_t)&ireeCompilerSessionDestroy;
+  x += (uintptr_t)&ireeCompilerSessionGetArtifactCacheStatistics;
   x += (uintptr_t)&ireeCompilerSessionGetFlags;
+  x += (uintptr_t)&ireeCompilerSessionSetArtifactCacheCapacity;
   x += (uintptr_t)&ireeCompilerSessionSetFlags;
   x += (uintptr_t)&ireeCompilerSessionStealContext;
   x += (uintptr_t)&ireeCompilerSetupGlobalCL;
@@ -962,6 +967,7 @@ uintptr_t __iree_compiler_hidden_force_extern() {
   x += (uintptr_t)&ireeOptRunMain;
   x += (uintptr_t)&ireeReduceRunMain;
   x += (uintptr_t)&ireeRegisterTransformExtensions;
+  x += (uintptr_t)&ireeTuneRunMain;
   x += (uintptr_t)&mlirAffineAddExprGet;
   x += (uintptr_t)&mlirAffineBinaryOpExprGetLHS;
   x += (uintptr_t)&mlirAffineBinaryOpExprGetRHS;
@@ -24,6 +24,12 @@ enum class InvocationModel {
   Sync,
   // Exposes one wait fence for all inputs and one signal fence for all outputs.
   CoarseFences,
+  // Exposes one wait fence per tensor input (or output storage buffer) and one
+  // signal fence per tensor output. Results are returned before they are ready
+  // and callers can pass a result's signal fence as the wait fence of an input
+  // to a subsequent invocation to pipeline calls without host waits. Imports
+  // use CoarseFences.
+  FineFences,
 };
 
 struct InvocationOptions : public PassPipelineOptions<InvocationOptions> {
@@ -37,7 +43,10 @@ struct InvocationOptions : public PassPipelineOptions<InvocationOptions> {
                      "Fully synchronous behavior with no fences."),
           clEnumValN(IREE::ABI::InvocationModel::CoarseFences, "coarse-fences",
                      "Exposes one wait fence for all inputs and one signal "
-                     "fence for all outputs.")),
+                     "fence for all outputs."),
+          clEnumValN(IREE::ABI::InvocationModel::FineFences, "fine-fences",
+                     "Exposes one wait fence per input and one signal fence "
+                     "per output.")),
   };
 };
 
@@ -9,6 +9,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "mlir/Dialect/Affine/Utils.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
@@ -30,6 +31,8 @@ getInvocationModel(Operation *op, IREE::ABI::InvocationModel defaultModel) {
     return defaultModel;
   } else if (modelAttr == "coarse-fences") {
     return IREE::ABI::InvocationModel::CoarseFences;
+  } else if (modelAttr == "fine-fences") {
+    return IREE::ABI::InvocationModel::FineFences;
   } else {
     return IREE::ABI::InvocationModel::Sync;
   }
@@ -47,6 +50,7 @@ static Type mapToABIType(Type type) {
 // by this pass.
 static bool isABIAttr(NamedAttribute attr) {
   return attr.getName() == "iree.abi.affinity" ||
+         attr.getName() == "iree.abi.donate" ||
          attr.getName() == "iree.abi.encoding" ||
          attr.getName() == "iree.abi.model" ||
          attr.getName() == "iree.abi.output";
@@ -300,6 +304,13 @@ static LogicalResult wrapImportFunc(IREE::ABI::InvocationModel invocationModel,
                                     mlir::ModuleOp moduleOp,
                                     FunctionOpInterface importOp,
                                     SymbolTable &symbolTable) {
+  // Imports only support a single wait and signal fence today. Fine-grained
+  // fences are an export-side concept that lets callers pipeline invocations
+  // and callees implementing imports can still use the coarse form.
+  if (invocationModel == IREE::ABI::InvocationModel::FineFences) {
+    invocationModel = IREE::ABI::InvocationModel::CoarseFences;
+  }
+
   // Replace all existing calls to the import to instead call the wrapper.
   auto publicName = importOp.getName().str();
   auto privateName = "_" + publicName;
@@ -414,6 +425,7 @@ formatSourceDeclaration(IREE::ABI::InvocationModel invocationModel,
     os << "sync ";
     break;
   case IREE::ABI::InvocationModel::CoarseFences:
+  case IREE::ABI::InvocationModel::FineFences:
     os << "async ";
     break;
   }
@@ -451,6 +463,34 @@ formatSourceDeclaration(IREE::ABI::InvocationModel invocationModel,
   return StringAttr::get(exportOp.getContext(), decl);
 }
 
+// Returns the indices of |exportOp| arguments that are covered by wait fences:
+// tensors and the storage buffers that results are aliased into.
+static SmallVector<unsigned>
+getFencedArgIndices(FunctionOpInterface exportOp) {
+  SmallVector<unsigned> argIndices;
+  for (auto [argIndex, argType] :
+       llvm::enumerate(exportOp.getArgumentTypes())) {
+    if (llvm::isa<TensorType>(argType) ||
+        exportOp.getArgAttr(argIndex, "iree.abi.output")) {
+      argIndices.push_back(argIndex);
+    }
+  }
+  return argIndices;
+}
+
+// Returns the indices of |exportOp| results that are covered by signal fences.
+static SmallVector<unsigned>
+getFencedResultIndices(FunctionOpInterface exportOp) {
+  SmallVector<unsigned> resultIndices;
+  for (auto [resultIndex, resultType] :
+       llvm::enumerate(exportOp.getResultTypes())) {
+    if (llvm::isa<TensorType>(resultType)) {
+      resultIndices.push_back(resultIndex);
+    }
+  }
+  return resultIndices;
+}
+
 // Populates attributes on |wrapperOp| to support runtime reflection.
 // These are attached to the exported function and can be queried at runtime
 // with iree_vm_function_lookup_attr_by_name.
@@ -478,6 +518,20 @@ static void populateReflectionAttrs(IREE::ABI::InvocationModel invocationModel,
     attrs.emplace_back(StringAttr::get(context, "iree.abi.model"),
                        StringAttr::get(context, "coarse-fences"));
     break;
+  case IREE::ABI::InvocationModel::FineFences:
+    attrs.emplace_back(StringAttr::get(context, "iree.abi.model"),
+                       StringAttr::get(context, "fine-fences"));
+    // Callers need to know how the trailing fences are split between waits and
+    // signals as it can't be derived from the VM calling convention.
+    attrs.emplace_back(
+        StringAttr::get(context, "iree.abi.wait_fences"),
+        StringAttr::get(context,
+                        std::to_string(getFencedArgIndices(exportOp).size())));
+    attrs.emplace_back(
+        StringAttr::get(context, "iree.abi.signal_fences"),
+        StringAttr::get(context, std::to_string(
+                                     getFencedResultIndices(exportOp).size())));
+    break;
   }
 
   // If not provided by the user add the source declaration as the MLIR type.
@@ -522,6 +576,8 @@ createExportWrapperFunc(IREE::ABI::InvocationModel invocationModel,
   for (auto oldType : exportOp.getArgumentTypes()) {
     inputTypes.push_back(mapToABIType(oldType));
   }
+  auto fencedArgIndices = getFencedArgIndices(exportOp);
+  auto fencedResultIndices = getFencedResultIndices(exportOp);
   auto fenceType = IREE::HAL::FenceType::get(exportOp.getContext());
   switch (invocationModel) {
   default:
@@ -533,6 +589,18 @@ createExportWrapperFunc(IREE::ABI::InvocationModel invocationModel,
     argAttrDict.push_back(nullptr);  // wait
     argAttrDict.push_back(nullptr);  // signal
     break;
+  case IREE::ABI::InvocationModel::FineFences:
+    // One wait fence per fenced argument followed by one signal fence per
+    // fenced result, each in the order of the arguments/results they cover.
+    for (size_t i = 0; i < fencedArgIndices.size(); ++i) {
+      inputTypes.push_back(fenceType); // wait
+      argAttrDict.push_back(nullptr);
+    }
+    for (size_t i = 0; i < fencedResultIndices.size(); ++i) {
+      inputTypes.push_back(fenceType); // signal
+      argAttrDict.push_back(nullptr);
+    }
+    break;
   }
   SmallVector<Type> resultTypes;
   for (auto oldType : exportOp.getResultTypes()) {
@@ -585,21 +653,72 @@ createExportWrapperFunc(IREE::ABI::InvocationModel invocationModel,
     resultStorages[outputAttr.getInt()] = storageArg;
   }
 
+  // Donated tensor arguments have their storage reused for a result. This
+  // allows stateful values such as caches to be updated in-place across calls
+  // without the caller needing to pass a separate output buffer: the result is
+  // aliased into the buffer backing the donated argument.
+  for (unsigned i = 0; i < exportOp.getNumArguments(); ++i) {
+    auto donateAttr =
+        exportOp.getArgAttrOfType<IntegerAttr>(i, "iree.abi.donate");
+    if (!donateAttr) {
+      continue;
+    }
+    int64_t resultIndex = donateAttr.getInt();
+    if (!llvm::isa<TensorType>(exportOp.getArgumentTypes()[i]) ||
+        resultIndex < 0 ||
+        resultIndex >= static_cast<int64_t>(resultTypes.size()) ||
+        !llvm::isa<TensorType>(exportOp.getResultTypes()[resultIndex])) {
+      exportOp.emitError() << "donated argument " << i
+                           << " must be a tensor donated to a tensor result";
+      return {};
+    }
+    if (resultStorages[resultIndex]) {
+      exportOp.emitError() << "result " << resultIndex
+                           << " has multiple storage arguments";
+      return {};
+    }
+    resultStorages[resultIndex] = entryBlock->getArgument(i);
+  }
+
   // Build a map of each I/O argument to the fence that covers them.
-  // TODO(benvanik): actually support a map; for now we just handle the 1:M
-  // coarse mode where all inputs are covered by a single wait fence and all
-  // outputs are covered by a single signal fence.
-  Value waitFence;
+  // In the coarse mode all inputs are covered by a single wait fence and all
+  // outputs are covered by a single signal fence. In the fine mode each input
+  // and output has its own fence so that callers can chain individual results
+  // into subsequent invocations without waiting on unrelated work.
+  SmallVector<Value> argWaitFences(exportOp.getNumArguments());
+  SmallVector<Value> resultSignalFences(resultTypes.size());
   Value signalFence;
   switch (invocationModel) {
   default:
   case IREE::ABI::InvocationModel::Sync:
     break;
-  case IREE::ABI::InvocationModel::CoarseFences:
-    waitFence = entryBlock->getArgument(entryBlock->getNumArguments() - 2);
+  case IREE::ABI::InvocationModel::CoarseFences: {
+    Value waitFence =
+        entryBlock->getArgument(entryBlock->getNumArguments() - 2);
     signalFence = entryBlock->getArgument(entryBlock->getNumArguments() - 1);
+    for (auto argIndex : fencedArgIndices) {
+      argWaitFences[argIndex] = waitFence;
+    }
+    for (auto resultIndex : fencedResultIndices) {
+      resultSignalFences[resultIndex] = signalFence;
+    }
     break;
   }
+  case IREE::ABI::InvocationModel::FineFences: {
+    auto fenceArgs =
+        entryBlock->getArguments().drop_front(exportOp.getNumArguments());
+    for (auto [argIndex, fence] :
+         llvm::zip_first(fencedArgIndices, fenceArgs)) {
+      argWaitFences[argIndex] = fence;
+    }
+    fenceArgs = fenceArgs.drop_front(fencedArgIndices.size());
+    for (auto [resultIndex, fence] :
+         llvm::zip_equal(fencedResultIndices, fenceArgs)) {
+      resultSignalFences[resultIndex] = fence;
+    }
+    break;
+  }
+  }
 
   // Marshal arguments.
   auto oldExportType = cast<FunctionType>(exportOp.getFunctionType());
@@ -614,7 +733,8 @@ createExportWrapperFunc(IREE::ABI::InvocationModel invocationModel,
                                        exportOp.getArgAttrDict(argIndex));
       auto tensorImportOp = entryBuilder.create<IREE::HAL::TensorImportOp>(
           arg.getLoc(), oldType, arg,
-          fallback(encodingAttr, TypeAttr::get(oldType)), waitFence, argName,
+          fallback(encodingAttr, TypeAttr::get(oldType)),
+          argWaitFences[argIndex], argName,
           fallback(exportOp.getArgAttr(argIndex, "iree.abi.affinity"),
                    defaultAffinityAttr));
       arguments.push_back(tensorImportOp.getTarget());
@@ -631,41 +751,49 @@ createExportWrapperFunc(IREE::ABI::InvocationModel invocationModel,
   // Alias results to storage buffers if provided.
   for (unsigned resultIndex = 0; resultIndex < asyncResults.size();
        ++resultIndex) {
-    if (!resultStorages[resultIndex]) {
+    auto storage = resultStorages[resultIndex];
+    if (!storage) {
       continue;
     }
     auto source = asyncResults[resultIndex];
     auto sourceDims = IREE::Util::buildDynamicDimsForValue(
         exportOp.getLoc(), source, entryBuilder);
+    auto storageWaitFence =
+        argWaitFences[cast<BlockArgument>(storage).getArgNumber()];
     auto aliasOp = entryBuilder.create<IREE::HAL::TensorAliasOp>(
-        exportOp.getLoc(), source.getType(), source, sourceDims,
-        resultStorages[resultIndex], waitFence,
+        exportOp.getLoc(), source.getType(), source, sourceDims, storage,
+        storageWaitFence,
         fallback(exportOp.getResultAttr(resultIndex, "iree.abi.affinity"),
                  defaultAffinityAttr));
     asyncResults[resultIndex] = cast<OpResult>(aliasOp.getResult());
   }
 
-  // Insert a barrier if requested - all tensors will be calculated and the
-  // fence will be signaled. Note that even if there are no tensor results we
-  // need to signal the fence.
-  if (signalFence) {
+  // Insert barriers if requested - all tensors covered by a fence will be
+  // calculated and the fence will be signaled. Results sharing a fence are
+  // joined into a single barrier. Note that even if there are no tensor
+  // results we need to signal the coarse fence.
+  llvm::MapVector<Value, SmallVector<unsigned>> fenceResultIndices;
+  for (auto resultIndex : fencedResultIndices) {
+    fenceResultIndices[resultSignalFences[resultIndex]].push_back(resultIndex);
+  }
+  for (auto &[fence, resultIndices] : fenceResultIndices) {
     SmallVector<Value> asyncTensors;
-    for (auto result : asyncResults) {
-      if (llvm::isa<TensorType>(result.getType())) {
-        asyncTensors.push_back(result);
-      }
+    for (auto resultIndex : resultIndices) {
+      asyncTensors.push_back(asyncResults[resultIndex]);
     }
-    if (asyncTensors.empty()) {
-      // TODO(benvanik): maybe use a global timeline? global stores may not
-      // have completed by now in cases where the user wants to loop back.
-      entryBuilder.create<IREE::HAL::FenceSignalOp>(exportOp.getLoc(),
-                                                    signalFence);
-    } else {
-      auto barrierOp = entryBuilder.create<IREE::HAL::TensorBarrierOp>(
-          exportOp.getLoc(), asyncTensors, signalFence);
-      asyncResults = llvm::to_vector(barrierOp.getResults());
+    auto barrierOp = entryBuilder.create<IREE::HAL::TensorBarrierOp>(
+        exportOp.getLoc(), asyncTensors, fence);
+    for (auto [resultIndex, readyTensor] :
+         llvm::zip_equal(resultIndices, barrierOp.getResults())) {
+      asyncResults[resultIndex] = readyTensor;
     }
   }
+  if (signalFence && fencedResultIndices.empty()) {
+    // TODO(benvanik): maybe use a global timeline? global stores may not
+    // have completed by now in cases where the user wants to loop back.
+    entryBuilder.create<IREE::HAL::FenceSignalOp>(exportOp.getLoc(),
+                                                  signalFence);
+  }
 
   // Marshal results.
   SmallVector<Value> results;
@@ -811,7 +939,10 @@ private:
                      "Fully synchronous behavior with no fences."),
           clEnumValN(IREE::ABI::InvocationModel::CoarseFences, "coarse-fences",
                      "Exposes one wait fence for all inputs and one signal "
-                     "fence for all outputs.")),
+                     "fence for all outputs."),
+          clEnumValN(IREE::ABI::InvocationModel::FineFences, "fine-fences",
+                     "Exposes one wait fence per input and one signal fence "
+                     "per output.")),
   };
 };
 
@@ -123,6 +123,29 @@ util.func public @outputStorage(%arg0: tensor<?x8x8x3xf32>, %ret1: !hal.buffer {
 
 // -----
 
+// Tests donating an argument's storage to a function result so that stateful
+// values can be updated in-place across calls.
+
+// CHECK-LABEL: util.func public @donateArg
+//  CHECK-SAME:   (%[[ARG0:[a-z0-9]+]]: !hal.buffer_view, %[[ARG1:[a-z0-9]+]]: !hal.buffer_view)
+//  CHECK-SAME: -> !hal.buffer_view
+//  CHECK-NEXT:   %[[ARG0_TENSOR:.+]] = hal.tensor.import %[[ARG0]] "input0" : !hal.buffer_view -> tensor<4x8xf32>
+//  CHECK-NEXT:   %[[ARG1_TENSOR:.+]] = hal.tensor.import %[[ARG1]] "input1" : !hal.buffer_view -> tensor<1x8xf32>
+//  CHECK-NEXT:   %[[RET_TENSOR:.+]] = util.call @_donateArg(%[[ARG0_TENSOR]], %[[ARG1_TENSOR]])
+//  CHECK-NEXT:   %[[RET_ALIAS:.+]] = hal.tensor.alias %[[RET_TENSOR]] : tensor<4x8xf32> to %[[ARG0]] : !hal.buffer_view
+//  CHECK-NEXT:   %[[RET_VIEW:.+]] = hal.tensor.export %[[RET_ALIAS]] "output0" : tensor<4x8xf32> -> !hal.buffer_view
+//  CHECK-NEXT:   util.return %[[RET_VIEW]] : !hal.buffer_view
+//  CHECK-NEXT: }
+
+// CHECK-LABEL: util.func private @_donateArg(
+util.func public @donateArg(%cache: tensor<4x8xf32> {iree.abi.donate = 0 : index}, %update: tensor<1x8xf32>) -> tensor<4x8xf32> {
+  %c2 = arith.constant 2 : index
+  %0 = tensor.insert_slice %update into %cache[%c2, 0] [1, 8] [1, 1] : tensor<1x8xf32> into tensor<4x8xf32>
+  util.return %0 : tensor<4x8xf32>
+}
+
+// -----
+
 // Tests that functions already wrapped (iree.abi.stub present) are ignored.
 
 // CHECK-LABEL: util.func public @wrappedAlready
@@ -0,0 +1,76 @@
+// RUN: iree-opt --pass-pipeline='builtin.module(iree-abi-wrap-entry-points{invocation-model=fine-fences})' --split-input-file %s | FileCheck %s
+
+// Tests that each tensor argument and result gets its own fence so that
+// results can be chained into subsequent invocations independently.
+
+// CHECK-LABEL: util.func public @asyncEntry(
+//  CHECK-SAME:   %[[ARG0:.+]]: !hal.buffer_view, %[[ARG1:.+]]: !hal.buffer_view,
+//  CHECK-SAME:   %[[WAIT0:.+]]: !hal.fence, %[[WAIT1:.+]]: !hal.fence,
+//  CHECK-SAME:   %[[SIGNAL0:.+]]: !hal.fence, %[[SIGNAL1:.+]]: !hal.fence
+//  CHECK-SAME: -> (
+//  CHECK-SAME:   !hal.buffer_view, !hal.buffer_view
+//  CHECK-SAME: ) attributes {
+//  CHECK-SAME:   iree.abi.stub
+//  CHECK-SAME:   iree.reflection =
+//  CHECK-SAME:       iree.abi.declaration = "async func @asyncEntry
+//  CHECK-SAME:       iree.abi.model = "fine-fences"
+//  CHECK-SAME:       iree.abi.signal_fences = "2"
+//  CHECK-SAME:       iree.abi.wait_fences = "2"
+//  CHECK-SAME: } {
+//  CHECK-NEXT:   %[[ARG0_TENSOR:.+]] = hal.tensor.import wait(%[[WAIT0]]) => %[[ARG0]] "input0" : !hal.buffer_view -> tensor<4xf32>
+//  CHECK-NEXT:   %[[ARG1_TENSOR:.+]] = hal.tensor.import wait(%[[WAIT1]]) => %[[ARG1]] "input1" : !hal.buffer_view -> tensor<4xf32>
+//  CHECK-NEXT:   %[[RESULT_TENSORS:.+]]:2 = util.call @_asyncEntry(%[[ARG0_TENSOR]], %[[ARG1_TENSOR]])
+//  CHECK-NEXT:   %[[READY_TENSOR0:.+]] = hal.tensor.barrier join(%[[RESULT_TENSORS]]#0 : tensor<4xf32>) => %[[SIGNAL0]] : !hal.fence
+//  CHECK-NEXT:   %[[READY_TENSOR1:.+]] = hal.tensor.barrier join(%[[RESULT_TENSORS]]#1 : tensor<4xf32>) => %[[SIGNAL1]] : !hal.fence
+//  CHECK-NEXT:   %[[RET0_VIEW:.+]] = hal.tensor.export %[[READY_TENSOR0]] "output0" : tensor<4xf32> -> !hal.buffer_view
+//  CHECK-NEXT:   %[[RET1_VIEW:.+]] = hal.tensor.export %[[READY_TENSOR1]] "output1" : tensor<4xf32> -> !hal.buffer_view
+//  CHECK-NEXT:   util.return %[[RET0_VIEW]], %[[RET1_VIEW]] : !hal.buffer_view, !hal.buffer_view
+//  CHECK-NEXT: }
+
+// CHECK-LABEL: util.func private @_asyncEntry(
+util.func public @asyncEntry(%arg0: tensor<4xf32>, %arg1: tensor<4xf32>) -> (tensor<4xf32>, tensor<4xf32>) {
+  %0 = arith.addf %arg0, %arg1 : tensor<4xf32>
+  %1 = arith.addf %0, %arg0 : tensor<4xf32>
+  util.return %0, %1 : tensor<4xf32>, tensor<4xf32>
+}
+
+// -----
+
+// Tests that primitive arguments and results are not fenced.
+
+// CHECK-LABEL: util.func public @mixedEntry
+//  CHECK-SAME: (%[[ARG0:.+]]: i32, %[[ARG1:.+]]: !hal.buffer_view, %[[WAIT1:.+]]: !hal.fence, %[[SIGNAL1:.+]]: !hal.fence) -> (i32, !hal.buffer_view)
+//  CHECK-SAME:       iree.abi.signal_fences = "1"
+//  CHECK-SAME:       iree.abi.wait_fences = "1"
+//  CHECK-NEXT:   %[[ARG1_TENSOR:.+]] = hal.tensor.import wait(%[[WAIT1]]) => %[[ARG1]] "input1"
+//  CHECK-NEXT:   %[[RESULTS:.+]]:2 = util.call @_mixedEntry(%[[ARG0]], %[[ARG1_TENSOR]])
+//  CHECK-NEXT:   %[[READY_TENSOR1:.+]] = hal.tensor.barrier join(%[[RESULTS]]#1 : tensor<4xf32>) => %[[SIGNAL1]] : !hal.fence
+//  CHECK-NEXT:   %[[RET1_VIEW:.+]] = hal.tensor.export %[[READY_TENSOR1]] "output1"
+//  CHECK-NEXT:   util.return %[[RESULTS]]#0, %[[RET1_VIEW]]
+
+// CHECK-LABEL: util.func private @_mixedEntry(
+util.func public @mixedEntry(%arg0: i32, %arg1: tensor<4xf32>) -> (i32, tensor<4xf32>) {
+  %0 = arith.addi %arg0, %arg0 : i32
+  %1 = arith.addf %arg1, %arg1 : tensor<4xf32>
+  util.return %0, %1 : i32, tensor<4xf32>
+}
+
+// -----
+
+// Tests that output storage buffers are covered by their own wait fences.
+
+// CHECK-LABEL: util.func public @outputStorage
+//  CHECK-SAME: (%[[ARG0:.+]]: !hal.buffer_view, %[[RET0:.+]]: !hal.buffer,
+//  CHECK-SAME:  %[[WAIT0:.+]]: !hal.fence, %[[RET0_WAIT:.+]]: !hal.fence, %[[SIGNAL0:.+]]: !hal.fence)
+//       CHECK:   hal.tensor.import wait(%[[WAIT0]]) => %[[ARG0]]
+//       CHECK:   %[[RESULT_TENSOR:.+]] = util.call @_outputStorage
+//  CHECK-NEXT:   %[[RESULT_ALIAS:.+]] = hal.tensor.alias wait(%[[RET0_WAIT]]) => %[[RESULT_TENSOR]] : tensor<4xf32> to %[[RET0]] : !hal.buffer
+//  CHECK-NEXT:   %[[READY_RESULT:.+]] = hal.tensor.barrier join(%[[RESULT_ALIAS]] : tensor<4xf32>) => %[[SIGNAL0]] : !hal.fence
+//  CHECK-NEXT:   %[[EXPORT0:.+]] = hal.tensor.export %[[READY_RESULT]] "output0"
+//  CHECK-NEXT:   util.return %[[EXPORT0]]
+
+// CHECK-LABEL: util.func private @_outputStorage(
+util.func public @outputStorage(%arg0: tensor<4xf32>, %ret0: !hal.buffer {iree.abi.output = 0 : index}) -> tensor<4xf32> {
+  %0 = arith.addf %arg0, %arg0 : tensor<4xf32>
+  util.return %0 : tensor<4xf32>
+}
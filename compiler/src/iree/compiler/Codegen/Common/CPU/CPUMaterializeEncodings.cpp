@@ -81,6 +81,50 @@ enumerateMatmulTileRiscv32(IREE::HAL::ExecutableTargetAttr target) {
   return {};
 }
 
+// Enumerate tile sizes to choose from on riscv64.
+// For narrow-{M,N} cases, this only enumerates on narrow M. The narrow-N cases
+// are handled by transposition in chooseMatmulTile.
+static SmallVector<TileMxNxK>
+enumerateMatmulTileRiscv64(TypeRange elementTypes,
+                           IREE::HAL::ExecutableTargetAttr target) {
+  // Only the vector extension gets data-tiling.
+  if (!hasFeature(target, "+v")) {
+    return {};
+  }
+
+  // The ukernels are vector-length-agnostic, but the tile size is a
+  // compile-time constant. Size N0 to fill an LMUL=2 group of 32-bit elements
+  // at the minimum VLEN guaranteed by the target features.
+  int64_t vlen = 128;
+  if (hasFeature(target, "+zvl512b")) {
+    vlen = 512;
+  } else if (hasFeature(target, "+zvl256b")) {
+    vlen = 256;
+  }
+  int64_t n0 = vlen / 16;
+
+  assert(elementTypes.size() == 3);
+  Type lhs = elementTypes[0];
+  Type rhs = elementTypes[1];
+  Type out = elementTypes[2];
+
+  bool isF32 = lhs.isF32() && rhs.isF32() && out.isF32();
+  bool isF16 = lhs.isF16() && rhs.isF16() && (out.isF16() || out.isF32()) &&
+               hasFeature(target, "+zvfh");
+  bool isI8 = lhs.isSignlessInteger(8) && rhs.isSignlessInteger(8) &&
+              out.isSignlessInteger(32);
+  if (isF32 || isF16 || isI8) {
+    return {
+        TileMxNxK{8, n0, 1}, // Aim to use vfmacc/vfwmacc/vwmacc.
+        TileMxNxK{4, n0, 1}, // Truncation of the above.
+        TileMxNxK{2, n0, 1}, // Truncation of the above.
+        TileMxNxK{1, n0, 1}, // Truncation of the above.
+    };
+  }
+  // Fallback - no architecture-optimized tile size for this case.
+  return {};
+}
+
 // Enumerate tile sizes to choose from on arm64.
 // For narrow-{M,N} cases, this only enumerates on narrow M. The narrow-N cases
 // are handled by transposition in chooseMatmulTile.
@@ -184,6 +228,18 @@ enumerateMatmulTileX86_64(TypeRange elementTypes,
   Type out = elementTypes[2];
 
   if (out.isF32() || out.isF16() || out.isBF16()) {
+    if (lhs.isBF16() && rhs.isBF16() && out.isF32() &&
+        hasFeature(target, "+amx-bf16")) {
+      // A 16x16x32 tile is exactly one AMX tile per operand. Narrow-M cases
+      // don't fill AMX tiles and fall back to the AVX-512 tiles.
+      return {
+          TileMxNxK{16, 16, 32}, // Aim to use TDPBF16PS.
+          TileMxNxK{8, 16, 2},   // Aim to use VDPBF16PS (zmm).
+          TileMxNxK{4, 16, 2},   // Truncation of the above.
+          TileMxNxK{2, 16, 2},   // Truncation of the above.
+          TileMxNxK{1, 16, 2},   // Truncation of the above.
+      };
+    }
     if (lhs.isBF16() && rhs.isBF16() && (out.isBF16() || out.isF32())) {
       if (hasFeature(target, "+avx512bf16")) {
         return {
@@ -232,9 +288,35 @@ enumerateMatmulTileX86_64(TypeRange elementTypes,
     }
   }
 
+  if (lhs.isSignlessInteger(8) && rhs.isSignlessInteger(4) &&
+      out.isSignlessInteger(32)) {
+    if (hasFeature(target, "+avx512vnni")) {
+      // Same tile size as i8 x i8 with VPDPWSSD, the s4 RHS values being
+      // sign-extended to s16 in registers.
+      return {
+          TileMxNxK{16, 16, 2}, // Aim to use VPDPWSSD (zmm).
+          TileMxNxK{8, 16, 2},  // Truncation of the above.
+          TileMxNxK{4, 16, 2},  // Truncation of the above.
+          TileMxNxK{2, 16, 2},  // Truncation of the above.
+          TileMxNxK{1, 16, 2},  // Truncation of the above.
+      };
+    }
+  }
+
   if (out.isSignlessInteger(32) &&
       ((lhs.isSignlessInteger(8) && rhs.isSignlessInteger(8)) ||
        (lhs.isSignlessInteger(16) && rhs.isSignlessInteger(16)))) {
+    if (lhs.isSignlessInteger(8) && hasFeature(target, "+amx-int8")) {
+      // A 16x16x64 tile is exactly one AMX tile per operand. Narrow-M cases
+      // don't fill AMX tiles and fall back to the AVX-512 tiles.
+      return {
+          TileMxNxK{16, 16, 64}, // Aim to use TDPBSSD.
+          TileMxNxK{8, 16, 2},   // Aim to use VPDPWSSD (zmm).
+          TileMxNxK{4, 16, 2},   // Truncation of the above.
+          TileMxNxK{2, 16, 2},   // Truncation of the above.
+          TileMxNxK{1, 16, 2},   // Truncation of the above.
+      };
+    }
     if (hasFeature(target, "+avx512vnni")) {
       // This is the same tile size as with VPMADDWD as the only difference
       // is that VPDPWSSD accumulates. VPDPBUSD would call for {16, 16, 4} but
@@ -418,6 +500,9 @@ enumerateMatmulTileMxNxK(IREE::Encoding::EncodingAttr encoding,
   if (isRISCV32(target)) {
     return enumerateMatmulTileRiscv32(target);
   }
+  if (isRISCV64(target)) {
+    return enumerateMatmulTileRiscv64(elementTypes, target);
+  }
   return {};
 }
 
@@ -578,12 +663,13 @@ struct CPUMaterializeHostEncodingPass
       // HACK: this pass is run on the host _but shouldn't be_. Because it's
       // run on the host and IREE is a compiler capable of multi-targeting there
       // may be multiple executable targets at any point in the host program.
-      // This pass can't handle that and assumes it's been checked earlier by
-      // spooky action at a distance. This needs to be fixed.
-      if (executableTargets->size() != 1) {
-        funcOp.emitOpError() << "has multiple executable targets and CPU data "
-                                "tiling isn't built to support that";
-        return signalPassFailure();
+      // Functions used by more than one target, or by a non-CPU target, keep
+      // their encodings and are left to a later materialization (usually to
+      // nop). Tensors crossing into and out of materialized functions are in
+      // the plain layout so each device packs the values it consumes.
+      if (executableTargets->size() != 1 ||
+          executableTargets->front().getBackend() != "llvm-cpu") {
+        continue;
       }
 
       // Materialize encodings within the function.
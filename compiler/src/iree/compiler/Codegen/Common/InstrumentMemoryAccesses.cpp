@@ -7,10 +7,12 @@
 #include "iree/compiler/Codegen/Common/Passes.h"
 #include "iree/compiler/Codegen/Transforms/Transforms.h"
 #include "iree/compiler/Codegen/Utils/Utils.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/ADT/TypeSwitch.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/MemRef/IR/MemRef.h"
 #include "mlir/Dialect/Vector/IR/VectorOps.h"
+#include "mlir/Interfaces/ViewLikeInterface.h"
 #include "mlir/Pass/Pass.h"
 
 namespace mlir::iree_compiler {
@@ -20,8 +22,97 @@ namespace mlir::iree_compiler {
 
 namespace {
 
+// Counters tracked per binding in summary mode. The order matches
+// iree_instrument_dispatch_memory_summary_t.
+enum SummaryCounter : int64_t {
+  kLoadCount = 0,
+  kLoadBytes,
+  kStoreCount,
+  kStoreBytes,
+  kStrideHistogram,
+};
+// Matches IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_COUNT.
+static constexpr int64_t kStrideBucketCount = 5;
+static constexpr int64_t kSummaryCountersPerBinding =
+    kStrideHistogram + kStrideBucketCount;
+// Matches IREE_INSTRUMENT_DISPATCH_MEMORY_SUMMARY_BINDING_OTHER.
+static constexpr uint8_t kOtherBinding = 0xFF;
+
+// A memory access that will be accounted for in the summary.
+struct MemoryAccess {
+  Operation *op;
+  Value base;
+  ValueRange indices;
+  Type valueType;
+  bool isLoad;
+};
+
+static int64_t getAccessByteSize(Type type) {
+  if (auto vectorType = llvm::dyn_cast<VectorType>(type)) {
+    return llvm::divideCeil(vectorType.getNumElements() *
+                                vectorType.getElementTypeBitWidth(),
+                            8);
+  }
+  return llvm::divideCeil(type.getIntOrFloatBitWidth(), 8);
+}
+
+// Returns the ordinal of the binding |memref| is derived from or
+// kOtherBinding if it does not originate from a binding.
+static uint8_t getSourceBinding(Value memref) {
+  while (memref) {
+    Operation *definingOp = memref.getDefiningOp();
+    if (!definingOp) {
+      break;
+    }
+    if (auto subspanOp =
+            dyn_cast<IREE::HAL::InterfaceBindingSubspanOp>(definingOp)) {
+      uint64_t binding = subspanOp.getBinding().getZExtValue();
+      return binding < kOtherBinding ? static_cast<uint8_t>(binding)
+                                     : kOtherBinding;
+    } else if (auto metadataOp =
+                   dyn_cast<memref::ExtractStridedMetadataOp>(definingOp)) {
+      memref = metadataOp.getSource();
+    } else if (auto assumeOp =
+                   dyn_cast<memref::AssumeAlignmentOp>(definingOp)) {
+      memref = assumeOp.getMemref();
+    } else if (auto viewOp = dyn_cast<ViewLikeOpInterface>(definingOp)) {
+      memref = viewOp.getViewSource();
+    } else {
+      break;
+    }
+  }
+  return kOtherBinding;
+}
+
+// Returns the byte address of the element at |indices| in |memref| as an i64.
+static Value getAccessAddress(OpBuilder &builder, Location loc, Value memref,
+                              ValueRange indices) {
+  auto memrefType = llvm::cast<MemRefType>(memref.getType());
+  auto metadataOp =
+      builder.create<memref::ExtractStridedMetadataOp>(loc, memref);
+  Value linearIndex = metadataOp.getOffset();
+  for (auto [index, stride] :
+       llvm::zip_equal(indices, metadataOp.getStrides())) {
+    linearIndex = builder.create<arith::AddIOp>(
+        loc, linearIndex, builder.create<arith::MulIOp>(loc, index, stride));
+  }
+  Value bitWidth = builder.create<arith::ConstantIndexOp>(
+      loc, memrefType.getElementTypeBitWidth());
+  Value byteOffset = builder.create<arith::DivUIOp>(
+      loc, builder.create<arith::MulIOp>(loc, linearIndex, bitWidth),
+      builder.create<arith::ConstantIndexOp>(loc, 8));
+  Value basePtr = builder.create<memref::ExtractAlignedPointerAsIndexOp>(
+      loc, metadataOp.getBaseBuffer());
+  Value address = builder.create<arith::AddIOp>(loc, basePtr, byteOffset);
+  return builder.create<arith::IndexCastUIOp>(loc, builder.getI64Type(),
+                                              address);
+}
+
 struct InstrumentMemoryAccessesPass
     : impl::InstrumentMemoryAccessesPassBase<InstrumentMemoryAccessesPass> {
+  using impl::InstrumentMemoryAccessesPassBase<
+      InstrumentMemoryAccessesPass>::InstrumentMemoryAccessesPassBase;
+
   void runOnOperation() override {
     // Lookup the root instrumentation op. If not present it means the dispatch
     // is not instrumented and we can skip it.
@@ -35,6 +126,11 @@ struct InstrumentMemoryAccessesPass
       return;
     }
 
+    if (summary) {
+      summarizeAccesses(instrumentOp);
+      return;
+    }
+
     auto buffer = instrumentOp.getBuffer();
     auto workgroupKey = instrumentOp.getWorkgroupKey();
     getOperation()->walk([&](Operation *op) {
@@ -82,6 +178,164 @@ struct InstrumentMemoryAccessesPass
           .Default([&](Operation *) {});
     });
   }
+
+  // Accumulates the accesses in a per-workgroup counter table and emits one
+  // hal.instrument.memory.summary op per accessed binding when returning.
+  void summarizeAccesses(IREE::HAL::InstrumentWorkgroupOp instrumentOp) {
+    SmallVector<MemoryAccess> accesses;
+    getOperation()->walk([&](Operation *op) {
+      TypeSwitch<Operation *>(op)
+          .Case<memref::LoadOp>([&](auto loadOp) {
+            accesses.push_back({loadOp, loadOp.getMemRef(),
+                                loadOp.getIndices(), loadOp.getType(),
+                                /*isLoad=*/true});
+          })
+          .Case<memref::StoreOp>([&](auto storeOp) {
+            accesses.push_back({storeOp, storeOp.getMemRef(),
+                                storeOp.getIndices(),
+                                storeOp.getValueToStore().getType(),
+                                /*isLoad=*/false});
+          })
+          .Case<vector::LoadOp>([&](auto loadOp) {
+            accesses.push_back({loadOp, loadOp.getBase(), loadOp.getIndices(),
+                                loadOp.getVectorType(), /*isLoad=*/true});
+          })
+          .Case<vector::StoreOp>([&](auto storeOp) {
+            accesses.push_back({storeOp, storeOp.getBase(),
+                                storeOp.getIndices(), storeOp.getVectorType(),
+                                /*isLoad=*/false});
+          })
+          .Default([&](Operation *) {});
+    });
+    if (accesses.empty()) {
+      return;
+    }
+
+    // Assign each accessed binding a slot in the counter table in the order
+    // they are first accessed. The table is followed by the address of the
+    // last access made by each access site used to bucket strides.
+    llvm::MapVector<uint8_t, int64_t> bindingSlots;
+    SmallVector<int64_t> accessSlots;
+    for (auto &access : accesses) {
+      uint8_t binding = getSourceBinding(access.base);
+      auto it = bindingSlots.insert({binding, bindingSlots.size()}).first;
+      accessSlots.push_back(it->second);
+    }
+    int64_t lastAddressBase = bindingSlots.size() * kSummaryCountersPerBinding;
+    int64_t counterCount = lastAddressBase + accesses.size();
+
+    auto loc = instrumentOp.getLoc();
+    auto i64Type = IntegerType::get(&getContext(), 64);
+    Block &entryBlock = getOperation().getFunctionBody().front();
+    OpBuilder builder = OpBuilder::atBlockBegin(&entryBlock);
+    Value counters = builder.create<memref::AllocaOp>(
+        loc, MemRefType::get({counterCount}, i64Type));
+    auto getSlot = [&](OpBuilder &builder, Location loc, int64_t slot) {
+      return builder.create<arith::ConstantIndexOp>(loc, slot).getResult();
+    };
+    Value zero = builder.create<arith::ConstantIntOp>(loc, 0, i64Type);
+    Value noAddress = builder.create<arith::ConstantIntOp>(
+        loc, std::numeric_limits<int64_t>::min(), i64Type);
+    for (int64_t i = 0; i < counterCount; ++i) {
+      builder.create<memref::StoreOp>(loc, i < lastAddressBase ? zero
+                                                               : noAddress,
+                                      counters,
+                                      getSlot(builder, loc, i));
+    }
+
+    auto addToCounter = [&](OpBuilder &builder, Location loc, Value slot,
+                            Value amount) {
+      Value value = builder.create<memref::LoadOp>(loc, counters, slot);
+      value = builder.create<arith::AddIOp>(loc, value, amount);
+      builder.create<memref::StoreOp>(loc, value, counters, slot);
+    };
+    for (auto [accessIndex, access] : llvm::enumerate(accesses)) {
+      OpBuilder builder(access.op);
+      Location loc = access.op->getLoc();
+      int64_t counterBase =
+          accessSlots[accessIndex] * kSummaryCountersPerBinding;
+      int64_t accessSize = getAccessByteSize(access.valueType);
+      auto i64Constant = [&](int64_t value) -> Value {
+        return builder.create<arith::ConstantIntOp>(loc, value, i64Type);
+      };
+
+      int64_t countSlot =
+          counterBase + (access.isLoad ? kLoadCount : kStoreCount);
+      int64_t bytesSlot =
+          counterBase + (access.isLoad ? kLoadBytes : kStoreBytes);
+      addToCounter(builder, loc, getSlot(builder, loc, countSlot),
+                   i64Constant(1));
+      addToCounter(builder, loc, getSlot(builder, loc, bytesSlot),
+                   i64Constant(accessSize));
+
+      // Bucket the stride from the previous access made by this site. The
+      // first access of each site has no stride and is not counted.
+      Value address =
+          getAccessAddress(builder, loc, access.base, access.indices);
+      Value lastAddressSlot =
+          getSlot(builder, loc, lastAddressBase + accessIndex);
+      Value lastAddress =
+          builder.create<memref::LoadOp>(loc, counters, lastAddressSlot);
+      Value hasLastAddress = builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::ne, lastAddress, noAddress);
+      Value stride = builder.create<arith::SubIOp>(loc, address, lastAddress);
+      Value absStride = builder.create<arith::SelectOp>(
+          loc,
+          builder.create<arith::CmpIOp>(loc, arith::CmpIPredicate::slt, stride,
+                                        zero),
+          builder.create<arith::SubIOp>(loc, zero, stride), stride);
+      auto selectBucket = [&](arith::CmpIPredicate predicate, Value lhs,
+                              int64_t rhs, int64_t bucket, Value otherwise) {
+        Value condition = builder.create<arith::CmpIOp>(loc, predicate, lhs,
+                                                        i64Constant(rhs));
+        return builder
+            .create<arith::SelectOp>(loc, condition, i64Constant(bucket),
+                                     otherwise)
+            .getResult();
+      };
+      Value bucket = i64Constant(4);
+      bucket = selectBucket(arith::CmpIPredicate::ule, absStride, 4096, 3,
+                            bucket);
+      bucket = selectBucket(arith::CmpIPredicate::ule, absStride, 64, 2,
+                            bucket);
+      bucket = selectBucket(arith::CmpIPredicate::eq, stride, accessSize, 1,
+                            bucket);
+      bucket = selectBucket(arith::CmpIPredicate::eq, stride, 0, 0, bucket);
+      Value bucketSlot = builder.create<arith::AddIOp>(
+          loc, getSlot(builder, loc, counterBase + kStrideHistogram),
+          builder.create<arith::IndexCastOp>(loc, builder.getIndexType(),
+                                             bucket));
+      addToCounter(
+          builder, loc, bucketSlot,
+          builder.create<arith::ExtUIOp>(loc, i64Type, hasLastAddress));
+      builder.create<memref::StoreOp>(loc, address, counters, lastAddressSlot);
+    }
+
+    // Emit the summaries on every exit from the function.
+    SmallVector<Operation *> returnOps;
+    for (Block &block : getOperation().getFunctionBody()) {
+      Operation *terminator = block.getTerminator();
+      if (terminator->hasTrait<OpTrait::ReturnLike>()) {
+        returnOps.push_back(terminator);
+      }
+    }
+    for (Operation *returnOp : returnOps) {
+      OpBuilder builder(returnOp);
+      Location loc = returnOp->getLoc();
+      for (auto [binding, slot] : bindingSlots) {
+        SmallVector<Value> values;
+        for (int64_t i = 0; i < kSummaryCountersPerBinding; ++i) {
+          values.push_back(builder.create<memref::LoadOp>(
+              loc, counters,
+              getSlot(builder, loc,
+                            slot * kSummaryCountersPerBinding + i)));
+        }
+        builder.create<IREE::HAL::InstrumentMemorySummaryOp>(
+            loc, instrumentOp.getBuffer(), instrumentOp.getWorkgroupKey(),
+            builder.getI8IntegerAttr(binding), values);
+      }
+    }
+  }
 };
 
 } // namespace
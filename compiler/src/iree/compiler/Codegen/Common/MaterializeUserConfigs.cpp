@@ -8,6 +8,7 @@
 #include "iree/compiler/Codegen/Common/UserConfig.h"
 #include "iree/compiler/Codegen/Dialect/Codegen/IR/IREECodegenAttrs.h"
 #include "iree/compiler/Codegen/Dialect/Codegen/IR/IREECodegenDialect.h"
+#include "llvm/Support/FileSystem.h"
 #include "mlir/Dialect/Transform/Transforms/TransformInterpreterUtils.h"
 
 #define DEBUG_TYPE "iree-codegen-materialize-user-configs"
@@ -26,6 +27,16 @@ llvm::cl::opt<std::string> clCodegenTransformDialectLibraryFileName(
         "this will default to `__kernel_config`."),
     llvm::cl::init(""));
 
+llvm::cl::opt<std::string> clCodegenTuningSpecPath(
+    "iree-codegen-tuning-spec-path",
+    llvm::cl::desc(
+        "File path to a tuning spec library as produced by iree-tune. The "
+        "`__kernel_config` sequence of the library is applied to each "
+        "executable function before any other user configuration. The spec "
+        "is ignored if the file does not exist such that the same flags can "
+        "be used before and after tuning."),
+    llvm::cl::init(""));
+
 #define GEN_PASS_DEF_MATERIALIZEUSERCONFIGSPASS
 #include "iree/compiler/Codegen/Common/Passes.h.inc"
 
@@ -116,6 +127,29 @@ struct MaterializeUserConfigsPass final
       }
 
       LDBG("MaterializeUserConfigsPass on function: " << funcOp);
+
+      // Apply the tuning spec first so that an explicitly specified transform
+      // library can still override what it selects.
+      if (!clCodegenTuningSpecPath.empty() &&
+          llvm::sys::fs::exists(clCodegenTuningSpecPath)) {
+        auto dialect =
+            context->getOrLoadDialect<IREE::Codegen::IREECodegenDialect>();
+        auto maybeTuningSpec =
+            dialect->getOrLoadTransformLibraryModule(clCodegenTuningSpecPath);
+        if (failed(maybeTuningSpec)) {
+          funcOp.emitError() << "failed to load tuning spec: "
+                             << clCodegenTuningSpecPath;
+          return signalPassFailure();
+        }
+        auto runResult = runTransformConfigurationStrategy(
+            funcOp, kDefaultTransformSequenceName, *maybeTuningSpec);
+        if (runResult != StrategyRunResult::Success) {
+          funcOp.emitError() << "tuning spec `" << clCodegenTuningSpecPath
+                             << "` failed to apply";
+          return signalPassFailure();
+        }
+      }
+
       std::optional<ModuleOp> transformLibrary = std::nullopt;
       if (hasTransformLibrary) {
         auto dialect =
@@ -4,9 +4,16 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <limits>
+
 #include "iree/compiler/Codegen/Common/Passes.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Math/IR/Math.h"
 #include "mlir/Dialect/Math/Transforms/Approximation.h"
 #include "mlir/Dialect/Math/Transforms/Passes.h"
+#include "mlir/IR/ImplicitLocOpBuilder.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
@@ -20,16 +27,203 @@ static llvm::cl::opt<bool> clNativeMathPrecision(
         "Skip polynomial lowering for math op natively available on GPU"),
     llvm::cl::init(false));
 
+namespace {
+enum class MathAccuracy { Precise, Medium, Fast };
+} // namespace
+
+/// Command line to select the accuracy of the polynomial approximations.
+/// Functions may override it with an `iree_codegen.math_accuracy` attribute
+/// holding one of the same values.
+static llvm::cl::opt<MathAccuracy> clMathAccuracy(
+    "iree-codegen-math-accuracy",
+    llvm::cl::desc("Accuracy of the polynomial approximations of math ops:"),
+    llvm::cl::values(
+        clEnumValN(MathAccuracy::Precise, "precise",
+                   "Approximations accurate to a few ULP (default)."),
+        clEnumValN(MathAccuracy::Medium, "medium",
+                   "Lower-degree exp and tanh with a maximum relative error "
+                   "of exp of ~4e-6 (~40 ULP)."),
+        clEnumValN(MathAccuracy::Fast, "fast",
+                   "Lowest-degree exp and tanh with a maximum relative error "
+                   "of exp of ~6e-5 (~700 ULP).")),
+    llvm::cl::init(MathAccuracy::Precise));
+
 #define GEN_PASS_DEF_POLYNOMIALAPPROXIMATIONPASS
 #include "iree/compiler/Codegen/Common/Passes.h.inc"
 
 namespace {
 
+static Value getConstant(ImplicitLocOpBuilder &b, Type type,
+                         TypedAttr attr) {
+  if (auto shapedType = dyn_cast<ShapedType>(type)) {
+    attr = SplatElementsAttr::get(shapedType, attr);
+  }
+  return b.create<arith::ConstantOp>(attr);
+}
+
+static Value getF32Constant(ImplicitLocOpBuilder &b, Type type, float value) {
+  return getConstant(b, type, b.getF32FloatAttr(value));
+}
+
+/// Computes exp(|x|) for f32 values by range reduction: exp(x) = 2^n * exp(r)
+/// with n = round(x / ln(2)) and r in [-ln(2)/2, ln(2)/2], where exp(r) is
+/// evaluated with a truncated Taylor polynomial of |degree|. Lowering the
+/// degree trades accuracy for fewer FMAs; all operations are elementwise and
+/// branch-free so they vectorize directly.
+static Value buildExp(ImplicitLocOpBuilder &b, Value x, int degree) {
+  Type type = x.getType();
+  Type i32Type = b.getI32Type();
+  if (auto shapedType = dyn_cast<ShapedType>(type)) {
+    i32Type = shapedType.clone(i32Type);
+  }
+  auto cst = [&](float value) { return getF32Constant(b, type, value); };
+
+  // Clamp the input to the range where 2^n is a normal float. Results outside
+  // of the range are fixed up by the caller.
+  Value clamped = b.create<arith::MinimumFOp>(
+      b.create<arith::MaximumFOp>(x, cst(-87.0f)), cst(88.0f));
+
+  // n = floor(x * log2(e) + 0.5) and r = x - n * ln(2) with ln(2) split into
+  // high and low parts (Cody-Waite) to keep r exact.
+  Value n = b.create<math::FloorOp>(b.create<math::FmaOp>(
+      clamped, cst(1.44269504088896341f), cst(0.5f)));
+  Value r = b.create<math::FmaOp>(n, cst(-0.693359375f), clamped);
+  r = b.create<math::FmaOp>(n, cst(2.12194440e-4f), r);
+
+  // exp(r) ~= sum(r^i / i!) evaluated with Horner's scheme.
+  float coefficient = 1.0f;
+  for (int i = 2; i <= degree; ++i) {
+    coefficient /= i;
+  }
+  Value p = cst(coefficient);
+  for (int i = degree; i > 0; --i) {
+    coefficient *= i;
+    p = b.create<math::FmaOp>(p, r, cst(coefficient));
+  }
+
+  // 2^n is constructed directly in the exponent bits.
+  auto i32Cst = [&](int32_t value) {
+    return getConstant(b, i32Type, b.getI32IntegerAttr(value));
+  };
+  Value exponent = b.create<arith::ShLIOp>(
+      b.create<arith::AddIOp>(b.create<arith::FPToSIOp>(i32Type, n),
+                              i32Cst(127)),
+      i32Cst(23));
+  Value scale = b.create<arith::BitcastOp>(type, exponent);
+  Value result = b.create<arith::MulFOp>(p, scale);
+
+  // Overflow to +inf and underflow to 0 outside of the clamped range.
+  // NaN inputs fail both comparisons and propagate through the clamp.
+  Value overflow =
+      b.create<arith::CmpFOp>(arith::CmpFPredicate::OGT, x, cst(88.7228394f));
+  Value underflow =
+      b.create<arith::CmpFOp>(arith::CmpFPredicate::OLT, x, cst(-87.3365479f));
+  result = b.create<arith::SelectOp>(
+      overflow, cst(std::numeric_limits<float>::infinity()), result);
+  return b.create<arith::SelectOp>(underflow, cst(0.0f), result);
+}
+
+/// Returns true if |type| is f32 or a vector of f32.
+static bool isF32OrVectorOfF32(Type type) {
+  if (auto vectorType = dyn_cast<VectorType>(type)) {
+    type = vectorType.getElementType();
+  }
+  return type.isF32();
+}
+
+/// Expands math.exp to the range-reduced polynomial of |degree|.
+struct ExpApproximation final : OpRewritePattern<math::ExpOp> {
+  ExpApproximation(MLIRContext *context, int degree)
+      : OpRewritePattern(context, /*benefit=*/2), degree(degree) {}
+  LogicalResult matchAndRewrite(math::ExpOp op,
+                                PatternRewriter &rewriter) const override {
+    if (!isF32OrVectorOfF32(op.getType())) {
+      return rewriter.notifyMatchFailure(op, "unsupported type");
+    }
+    ImplicitLocOpBuilder b(op.getLoc(), rewriter);
+    rewriter.replaceOp(op, buildExp(b, op.getOperand(), degree));
+    return success();
+  }
+  int degree;
+};
+
+/// Expands math.tanh as sign(x) * (1 - 2 / (exp(2|x|) + 1)) using the
+/// range-reduced exp polynomial of |degree|. The absolute error is bounded by
+/// that of exp; the relative error grows for inputs close to 0 where tanh(x)
+/// is returned as x.
+struct TanhApproximation final : OpRewritePattern<math::TanhOp> {
+  TanhApproximation(MLIRContext *context, int degree)
+      : OpRewritePattern(context, /*benefit=*/2), degree(degree) {}
+  LogicalResult matchAndRewrite(math::TanhOp op,
+                                PatternRewriter &rewriter) const override {
+    if (!isF32OrVectorOfF32(op.getType())) {
+      return rewriter.notifyMatchFailure(op, "unsupported type");
+    }
+    ImplicitLocOpBuilder b(op.getLoc(), rewriter);
+    Type type = op.getType();
+    auto cst = [&](float value) { return getF32Constant(b, type, value); };
+    Value x = op.getOperand();
+    Value absX = b.create<math::AbsFOp>(x);
+    Value exp2X = buildExp(b, b.create<arith::AddFOp>(absX, absX), degree);
+    Value absTanh = b.create<arith::SubFOp>(
+        cst(1.0f), b.create<arith::DivFOp>(
+                       cst(2.0f), b.create<arith::AddFOp>(exp2X, cst(1.0f))));
+    Value tanh = b.create<math::CopySignOp>(absTanh, x);
+    // tanh(x) = x - x^3/3 + ... so x is exact to f32 precision below ~4e-4.
+    Value isTiny =
+        b.create<arith::CmpFOp>(arith::CmpFPredicate::OLT, absX, cst(4e-4f));
+    rewriter.replaceOpWithNewOp<arith::SelectOp>(op, isTiny, x, tanh);
+    return success();
+  }
+  int degree;
+};
+
+/// Returns the accuracy requested for |op| by its enclosing function or the
+/// global flag.
+static MathAccuracy getMathAccuracy(Operation *op) {
+  auto funcOp = dyn_cast<FunctionOpInterface>(op);
+  if (!funcOp) {
+    funcOp = op->getParentOfType<FunctionOpInterface>();
+  }
+  auto attr = funcOp ? funcOp->getAttrOfType<StringAttr>(
+                           "iree_codegen.math_accuracy")
+                     : StringAttr();
+  if (!attr) {
+    return clMathAccuracy;
+  }
+  return llvm::StringSwitch<MathAccuracy>(attr.getValue())
+      .Case("fast", MathAccuracy::Fast)
+      .Case("medium", MathAccuracy::Medium)
+      .Default(MathAccuracy::Precise);
+}
+
 /// math dialect elementry functions -> polynomial form.
 class PolynomialApproximationPass final
     : public impl::PolynomialApproximationPassBase<
           PolynomialApproximationPass> {
   void runOnOperation() override {
+    // Functions may each request a different accuracy so patterns are applied
+    // per function. Other ops (such as modules without functions) use the
+    // global accuracy.
+    SmallVector<Operation *> roots;
+    getOperation()->walk<WalkOrder::PreOrder>([&](Operation *op) {
+      if (isa<FunctionOpInterface>(op)) {
+        roots.push_back(op);
+        return WalkResult::skip();
+      }
+      return WalkResult::advance();
+    });
+    if (roots.empty()) {
+      roots.push_back(getOperation());
+    }
+    for (Operation *root : roots) {
+      if (failed(approximate(root, getMathAccuracy(root)))) {
+        return signalPassFailure();
+      }
+    }
+  }
+
+  LogicalResult approximate(Operation *root, MathAccuracy accuracy) {
     RewritePatternSet mathPatterns(&getContext());
     populateExpandTanPattern(mathPatterns);
     populateExpandSinhPattern(mathPatterns);
@@ -43,14 +237,18 @@ class PolynomialApproximationPass final
     if (clNativeMathPrecision) {
       mathPatterns.add<math::ErfPolynomialApproximation>(&getContext());
     } else {
+      // Lower-accuracy tiers take precedence over the upstream patterns for
+      // the ops they cover and all others use the upstream approximations.
+      if (accuracy != MathAccuracy::Precise) {
+        int degree = accuracy == MathAccuracy::Fast ? 4 : 5;
+        mathPatterns.add<ExpApproximation, TanhApproximation>(&getContext(),
+                                                              degree);
+      }
       populateExpandExp2FPattern(mathPatterns);
       populateMathPolynomialApproximationPatterns(mathPatterns);
       populateExpandRoundEvenPattern(mathPatterns);
     }
-    if (failed(applyPatternsAndFoldGreedily(getOperation(),
-                                            std::move(mathPatterns)))) {
-      return signalPassFailure();
-    }
+    return applyPatternsAndFoldGreedily(root, std::move(mathPatterns));
   }
 };
 
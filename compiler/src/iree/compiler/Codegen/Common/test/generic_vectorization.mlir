@@ -506,3 +506,17 @@ func.func @depthwise_conv_fold_away_masking(%arg0: tensor<1x68x120x96xf32>, %arg
 // CHECK-MASK:     vector.fma
 // CHECK-MASK-NOT: vector.create_mask
 // CHECK-MASK-NOT: vector.constant_mask
+
+// -----
+
+func.func @dynamic_fill_with_assumed_range_infer_vector_size(%arg0: index) -> tensor<?xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = util.assume.int %arg0<umin = 16, umax = 64, udiv = 16> : index
+  %1 = tensor.empty(%0) : tensor<?xf32>
+  %2 = linalg.fill ins(%cst : f32) outs(%1 : tensor<?xf32>) -> tensor<?xf32>
+  return %2 : tensor<?xf32>
+}
+
+// CHECK-MASK-LABEL: func.func @dynamic_fill_with_assumed_range_infer_vector_size
+// CHECK-MASK:         %[[MASK:.+]] = vector.create_mask %{{.+}} : vector<64xi1>
+// CHECK-MASK:         vector.mask %[[MASK]] { vector.transfer_write {{.+}} : vector<64xf32>, tensor<?xf32> }
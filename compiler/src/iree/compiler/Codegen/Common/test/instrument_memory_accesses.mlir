@@ -0,0 +1,35 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-codegen-instrument-memory-accesses))" %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(func.func(iree-codegen-instrument-memory-accesses{summary=true}))" %s | FileCheck %s --check-prefix=SUMMARY
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+// CHECK-LABEL: func.func @copy
+// SUMMARY-LABEL: func.func @copy
+func.func @copy(%buffer: memref<67112960xi8>, %i: index) {
+  %c0 = arith.constant 0 : index
+  %dispatch_id = arith.constant 3 : i32
+  %key = hal.instrument.workgroup[%buffer : memref<67112960xi8>] dispatch(%dispatch_id) : index
+  %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) alignment(64) offset(%c0) : memref<128xf32>
+  %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) alignment(64) offset(%c0) : memref<128xf32>
+  %value = vector.load %0[%i] : memref<128xf32>, vector<4xf32>
+  vector.store %value, %1[%i] : memref<128xf32>, vector<4xf32>
+  return
+}
+
+// CHECK: %[[VALUE:.+]] = vector.load
+// CHECK: %[[LOADED:.+]] = hal.instrument.memory.load
+// CHECK: hal.instrument.memory.store
+// CHECK: vector.store
+
+// SUMMARY: %[[COUNTERS:.+]] = memref.alloca() : memref<20xi64>
+// SUMMARY-NOT: hal.instrument.memory.load
+// SUMMARY-NOT: hal.instrument.memory.store
+// SUMMARY: memref.extract_aligned_pointer_as_index
+// SUMMARY: vector.load
+// SUMMARY: memref.extract_aligned_pointer_as_index
+// SUMMARY: vector.store
+// SUMMARY: hal.instrument.memory.summary[%{{.+}} : memref<67112960xi8> for %{{.+}}] binding(0) counters({{(%[^,]+, ){8}}}%{{[^)]+}})
+// SUMMARY: hal.instrument.memory.summary[%{{.+}} : memref<67112960xi8> for %{{.+}}] binding(1) counters
+// SUMMARY: return
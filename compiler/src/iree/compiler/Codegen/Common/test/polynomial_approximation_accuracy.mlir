@@ -0,0 +1,66 @@
+// RUN: iree-opt --iree-codegen-polynomial-approximation --split-input-file %s | FileCheck %s --check-prefix=PRECISE
+// RUN: iree-opt --iree-codegen-polynomial-approximation --iree-codegen-math-accuracy=medium --split-input-file %s | FileCheck %s --check-prefix=MEDIUM
+// RUN: iree-opt --iree-codegen-polynomial-approximation --iree-codegen-math-accuracy=fast --split-input-file %s | FileCheck %s --check-prefix=FAST
+
+// Medium and fast evaluate exp(r) with Taylor polynomials of degree 5 and 4
+// after range reduction: one FMA for n, two for r and one per degree.
+
+// PRECISE-LABEL: @exp_vector
+//   PRECISE-NOT:   math.exp
+// MEDIUM-LABEL: @exp_vector
+// MEDIUM-COUNT-8:   math.fma {{.*}} : vector<4xf32>
+//   MEDIUM-NOT:   math.fma
+//       MEDIUM:   arith.shli {{.*}} : vector<4xi32>
+//       MEDIUM:   arith.bitcast {{.*}} : vector<4xi32> to vector<4xf32>
+//   MEDIUM-NOT:   math.exp
+// FAST-LABEL: @exp_vector
+// FAST-COUNT-7:   math.fma {{.*}} : vector<4xf32>
+//   FAST-NOT:   math.fma
+//   FAST-NOT:   math.exp
+func.func @exp_vector(%arg0: vector<4xf32>) -> vector<4xf32> {
+  %0 = math.exp %arg0 : vector<4xf32>
+  return %0 : vector<4xf32>
+}
+
+// -----
+
+// PRECISE-LABEL: @tanh_scalar
+//   PRECISE-NOT:   math.tanh
+//   PRECISE-NOT:   math.copysign
+// FAST-LABEL: @tanh_scalar
+//       FAST:   math.absf
+// FAST-COUNT-7:   math.fma {{.*}} : f32
+//       FAST:   arith.divf
+//       FAST:   math.copysign
+//   FAST-NOT:   math.tanh
+func.func @tanh_scalar(%arg0: f32) -> f32 {
+  %0 = math.tanh %arg0 : f32
+  return %0 : f32
+}
+
+// -----
+
+// The function attribute overrides the global accuracy.
+
+// PRECISE-LABEL: @exp_function_override
+// PRECISE-COUNT-7:   math.fma
+//   PRECISE-NOT:   math.fma
+// MEDIUM-LABEL: @exp_function_override
+// MEDIUM-COUNT-7:   math.fma
+//   MEDIUM-NOT:   math.fma
+func.func @exp_function_override(%arg0: f32) -> f32 attributes {iree_codegen.math_accuracy = "fast"} {
+  %0 = math.exp %arg0 : f32
+  return %0 : f32
+}
+
+// -----
+
+// Only f32 has reduced-accuracy approximations.
+
+// FAST-LABEL: @exp_f64
+//   FAST-NOT:   math.fma
+//       FAST:   math.exp {{.*}} : f64
+func.func @exp_f64(%arg0: f64) -> f64 {
+  %0 = math.exp %arg0 : f64
+  return %0 : f64
+}
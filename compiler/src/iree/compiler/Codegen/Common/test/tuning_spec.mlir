@@ -0,0 +1,31 @@
+// Tuning spec used by materialize_tuning_spec.mlir. This has the same form as
+// the specs produced by iree-tune.
+
+module attributes {transform.with_named_sequence} {
+  transform.named_sequence @apply_op_config(%op: !transform.any_op {transform.readonly},
+                                            %config: !transform.any_param {transform.readonly}) {
+    transform.annotate %op "compilation_info" = %config : !transform.any_op, !transform.any_param
+    transform.yield
+  }
+
+  transform.named_sequence @match_matmul_128x512x256(%op: !transform.any_op {transform.readonly}) -> (!transform.any_op, !transform.any_param) {
+    transform.match.operation_name %op ["linalg.matmul"] : !transform.any_op
+    %operand0 = transform.get_operand %op[0] : (!transform.any_op) -> !transform.any_value
+    transform.iree.match.cast_compatible_type %operand0 = tensor<128x256xf32> : !transform.any_value
+    %operand1 = transform.get_operand %op[1] : (!transform.any_op) -> !transform.any_value
+    transform.iree.match.cast_compatible_type %operand1 = tensor<256x512xf32> : !transform.any_value
+    %operand2 = transform.get_operand %op[2] : (!transform.any_op) -> !transform.any_value
+    transform.iree.match.cast_compatible_type %operand2 = tensor<128x512xf32> : !transform.any_value
+    %config = transform.param.constant #iree_codegen.compilation_info<
+        lowering_config = #iree_codegen.lowering_config<tile_sizes = [[32, 128, 0], [8, 32, 0], [0, 0, 16], [0, 0, 0]]>,
+        translation_info = #iree_codegen.translation_info<pipeline = CPUDoubleTilingExpert>> -> !transform.any_param
+    transform.yield %op, %config : !transform.any_op, !transform.any_param
+  }
+
+  transform.named_sequence @__kernel_config(%func: !transform.any_op {transform.consumed}) -> !transform.any_op {
+    %res = transform.foreach_match in %func
+        @match_matmul_128x512x256 -> @apply_op_config
+      : (!transform.any_op) -> !transform.any_op
+    transform.yield %res : !transform.any_op
+  }
+}
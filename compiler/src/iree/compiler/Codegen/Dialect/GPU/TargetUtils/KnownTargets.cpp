@@ -49,6 +49,7 @@ struct WgpDetails {
   std::optional<int32_t> maxLoadInstructionBits;
   std::optional<int32_t> simdsPerWgp;
   std::optional<int32_t> vgprSpaceBits;
+  std::optional<int32_t> prefetchStages;
 };
 
 // Chip level feature/limit details
@@ -113,7 +114,7 @@ TargetAttr createTargetAttr(const TargetDetails &details, StringRef arch,
       wgp->maxThreadSize, wgp->maxWorkgroupMemoryBytes,
       DenseI32ArrayAttr::get(context, wgp->maxWorkgroupCounts),
       wgp->maxLoadInstructionBits, wgp->simdsPerWgp, wgp->vgprSpaceBits,
-      DictionaryAttr{});
+      wgp->prefetchStages, DictionaryAttr{});
 
   TargetChipAttr targetChip;
   if (details.chip)
@@ -166,7 +167,8 @@ const WgpDetails *getCDNA3WgpDetails() {
                                       {0x7fffffff, 0x7fffffff, 0x7fffffff},
                                       /*maxLoadInstructionBits=*/128,
                                       /*simdsPerWgp=*/4,
-                                      /*vgprSpaceBits=*/512 * 32};
+                                      /*vgprSpaceBits=*/512 * 32,
+                                      /*prefetchStages=*/3};
   return &cdna3Wgp;
 }
 
@@ -558,6 +560,57 @@ StringRef normalizeNVIDIAGPUTarget(StringRef target) {
       .Default("");
 }
 
+//===----------------------------------------------------------------------===//
+// Known Intel target details
+//===----------------------------------------------------------------------===//
+
+const WgpDetails *getXeWgpDetails() {
+  ComputeBitwidths computeBitwdiths =
+      ComputeBitwidths::Int64 | ComputeBitwidths::Int32 |
+      ComputeBitwidths::Int16 | ComputeBitwidths::Int8 |
+      ComputeBitwidths::FP32 | ComputeBitwidths::FP16;
+  // Mesa ANV exposes VK_KHR_cooperative_matrix on Xe-HPG/Xe-LPG with an
+  // 8x8x16 fp16 shape, which does not have a matching MMAIntrinsic yet. So
+  // cooperative matrix is not advertised here for now.
+  // clang-format off
+  static const WgpDetails xeWgp = {
+      computeBitwdiths,   allStorageBits,     allSubgroupOps,
+      allDotProductOps,   /*mmaCount=*/0,     /*mmaOps=*/nullptr,
+      {16, 32},           {1024, 1024, 1024}, 1024,
+      64 * 1024,
+      // Note: These values have not been checked and may be higher
+      {0xffff, 0xffff, 0xffff}};
+  // clang-format on
+  return &xeWgp;
+}
+
+std::optional<TargetDetails> getIntelGPUTargetDetails(StringRef target) {
+  const WgpDetails *xeWgp = getXeWgpDetails();
+
+  // Chip details are the number of Xe-cores of each product.
+  static const ChipDetails arcA770Chip = {32};
+  static const ChipDetails arcA750Chip = {28};
+  static const ChipDetails arcA580Chip = {24};
+  static const ChipDetails arcA380Chip = {8};
+
+  return llvm::StringSwitch<std::optional<TargetDetails>>(target.lower())
+      .Case("arc-a770", TargetDetails{xeWgp, &arcA770Chip})
+      .Case("arc-a750", TargetDetails{xeWgp, &arcA750Chip})
+      .Case("arc-a580", TargetDetails{xeWgp, &arcA580Chip})
+      .Case("arc-a380", TargetDetails{xeWgp, &arcA380Chip})
+      .Cases("xe-hpg", "xe-lpg", TargetDetails{xeWgp, nullptr})
+      .Default(std::nullopt);
+}
+
+StringRef normalizeIntelGPUTarget(StringRef target) {
+  if (target.starts_with("xe-"))
+    return target;
+
+  return llvm::StringSwitch<StringRef>(target.lower())
+      .Cases("arc-a770", "arc-a750", "arc-a580", "arc-a380", "xe-hpg")
+      .Default("");
+}
+
 //===----------------------------------------------------------------------===//
 // Known Qualcomm target details
 //===----------------------------------------------------------------------===//
@@ -717,6 +770,10 @@ TargetAttr getVulkanTargetDetails(llvm::StringRef target,
     return createTargetAttr(*details, normalizeNVIDIAGPUTarget(target),
                             /*features=*/"spirv:v1.6,cap:Shader", context);
   }
+  if (std::optional<TargetDetails> details = getIntelGPUTargetDetails(target)) {
+    return createTargetAttr(*details, normalizeIntelGPUTarget(target),
+                            /*features=*/"spirv:v1.6,cap:Shader", context);
+  }
   if (std::optional<TargetDetails> details =
           getQualcommGPUTargetDetails(target)) {
     return createTargetAttr(*details, target,
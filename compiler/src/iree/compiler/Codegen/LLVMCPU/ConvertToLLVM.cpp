@@ -672,6 +672,50 @@ struct ConvertHALInstrumentMemoryStoreOp
   }
 };
 
+struct ConvertHALInstrumentMemorySummaryOp
+    : public ConvertOpToLLVMWithABIPattern<
+          IREE::HAL::InstrumentMemorySummaryOp> {
+  using ConvertOpToLLVMWithABIPattern::ConvertOpToLLVMWithABIPattern;
+  LogicalResult
+  matchAndRewrite(IREE::HAL::InstrumentMemorySummaryOp instrumentOp,
+                  IREE::HAL::InstrumentMemorySummaryOpAdaptor operands,
+                  ConversionPatternRewriter &rewriter) const override {
+    auto loc = instrumentOp.getLoc();
+    auto dataLayout =
+        getTypeConverter()->getDataLayoutAnalysis()->getAbove(instrumentOp);
+    auto i64Type = rewriter.getI64Type();
+
+    // Header followed by the counters in the order of
+    // iree_instrument_dispatch_memory_summary_t.
+    SmallVector<Type> entryFieldTypes(1 + operands.getCounters().size(),
+                                      i64Type);
+    auto entryType =
+        LLVM::LLVMStructType::getLiteral(getContext(), entryFieldTypes);
+
+    // 8 bit tag
+    // 8 bit binding ordinal
+    // 8 bit reserved
+    // 40 bit workgroup offset
+    uint8_t binding = instrumentOp.getBinding();
+    Value header = rewriter.create<LLVM::OrOp>(
+        loc, operands.getWorkgroupKey(),
+        rewriter.create<LLVM::ConstantOp>(
+            loc, i64Type,
+            (static_cast<int64_t>(binding) << 8) |
+                IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_SUMMARY));
+
+    SmallVector<Value> entryValues;
+    entryValues.push_back(header);
+    llvm::append_range(entryValues, operands.getCounters());
+    appendInstrumentationEntry(loc, instrumentOp.getBuffer(),
+                               operands.getBuffer(), entryType, entryValues,
+                               dataLayout, rewriter);
+
+    rewriter.eraseOp(instrumentOp);
+    return success();
+  }
+};
+
 /// Helper method to get information about extra operands that need to be
 /// appended to a function defn/call operation.
 static SmallVector<StringRef> getExtraFields(Operation *forOp) {
@@ -1071,7 +1115,8 @@ void ConvertToLLVMPass::runOnOperation() {
     ConvertHALInstrumentWorkgroupOp,
     ConvertHALInstrumentValueOp,
     ConvertHALInstrumentMemoryLoadOp,
-    ConvertHALInstrumentMemoryStoreOp
+    ConvertHALInstrumentMemoryStoreOp,
+    ConvertHALInstrumentMemorySummaryOp
   >(abi, typeConverter);
   // clang-format on
 
@@ -420,11 +420,34 @@ getMinTilingSizesForEachDim(mlir::FunctionOpInterface entryPointFn,
   return minTileSizes;
 }
 
+/// Returns the number of threads the executables of |targetAttr| are expected
+/// to run on. Targets may declare it with a `num_threads` configuration entry
+/// and fall back to the `iree-llvmcpu-number-of-threads` flag otherwise.
+static int64_t
+getNumberOfRuntimeThreads(IREE::HAL::ExecutableTargetAttr targetAttr) {
+  if (auto numThreads = getConfigIntegerAttr(targetAttr, "num_threads")) {
+    if (numThreads->getInt() > 0) {
+      return numThreads->getInt();
+    }
+  }
+  return clNumberOfRuntimeThreads;
+}
+
+/// Returns true if the target declares the number of runtime threads. Only
+/// then are small workloads split further to occupy all of the threads as
+/// the flag default is only a rough guess.
+static bool
+hasDeclaredNumberOfThreads(IREE::HAL::ExecutableTargetAttr targetAttr) {
+  auto numThreads = getConfigIntegerAttr(targetAttr, "num_threads");
+  return numThreads && numThreads->getInt() > 0;
+}
+
 // Reduces the number of workgroups in cases where we are dividing the work too
 // much. Over-provision the number of workgroups to twice the number of
 // threads.
 static void reduceDistributionWorkgroups(
     ArrayRef<int64_t> workload, SmallVectorImpl<int64_t> &distributedTileSizes,
+    int64_t numThreads,
     std::optional<ArrayRef<int64_t>> maxTileSizes = std::nullopt,
     std::optional<ArrayRef<int64_t>> vectorSizeHints = std::nullopt) {
   assert(workload.size() == distributedTileSizes.size());
@@ -437,7 +460,7 @@ static void reduceDistributionWorkgroups(
         llvm::divideCeil(value, distributedTileSizes[idx]);
   }
 
-  int64_t numWorkgroupsLimit = 2 * clNumberOfRuntimeThreads;
+  int64_t numWorkgroupsLimit = 2 * numThreads;
   int64_t numWorkgroups =
       std::accumulate(numWorkgroupsPerDim.begin(), numWorkgroupsPerDim.end(),
                       1LL, std::multiplies<int64_t>{});
@@ -497,12 +520,54 @@ static void reduceDistributionWorkgroups(
   }
 }
 
+// Increases the number of workgroups in cases where the workload is too small
+// to occupy all threads, e.g. matmuls with a batch size of one. The largest
+// tile sizes are halved as long as they stay multiples of the vector size
+// hints. This may go below the minimum tile sizes as idle threads cost more
+// than smaller inner tiles for such workloads.
+static void increaseDistributionWorkgroups(
+    ArrayRef<int64_t> workload, SmallVectorImpl<int64_t> &distributedTileSizes,
+    ArrayRef<int64_t> vectorSizeHints, int64_t numThreads) {
+  auto getNumWorkgroups = [&]() {
+    int64_t numWorkgroups = 1;
+    for (auto i : llvm::seq<size_t>(0, workload.size())) {
+      if (distributedTileSizes[i] == 0 || ShapedType::isDynamic(workload[i])) {
+        continue;
+      }
+      numWorkgroups *= llvm::divideCeil(workload[i], distributedTileSizes[i]);
+    }
+    return numWorkgroups;
+  };
+
+  while (getNumWorkgroups() < numThreads) {
+    std::optional<unsigned> splitDim;
+    for (auto i : llvm::seq<unsigned>(0, workload.size())) {
+      int64_t currSize = distributedTileSizes[i];
+      if (currSize <= 1 || ShapedType::isDynamic(workload[i])) {
+        continue;
+      }
+      int64_t newSize = currSize / 2;
+      if (vectorSizeHints[i] > 1 && newSize % vectorSizeHints[i] != 0) {
+        continue;
+      }
+      if (!splitDim || currSize > distributedTileSizes[*splitDim]) {
+        splitDim = i;
+      }
+    }
+    if (!splitDim) {
+      break;
+    }
+    distributedTileSizes[*splitDim] /= 2;
+  }
+}
+
 /// Returns the default tile sizes to use for the loops that are distributed.
 static SmallVector<int64_t>
 getDefaultDistributionTileSizes(ArrayRef<int64_t> lbs, ArrayRef<int64_t> ubs,
                                 ArrayRef<int64_t> minTileSizes,
                                 ArrayRef<int64_t> maxTileSizes,
-                                ArrayRef<int64_t> vectorSizeHints) {
+                                ArrayRef<int64_t> vectorSizeHints,
+                                int64_t numThreads, bool saturateThreads) {
   assert(lbs.size() == ubs.size() && lbs.size() == minTileSizes.size() &&
          lbs.size() == maxTileSizes.size() &&
          "expected all vectors to be of equal size");
@@ -527,8 +592,7 @@ getDefaultDistributionTileSizes(ArrayRef<int64_t> lbs, ArrayRef<int64_t> ubs,
     assert(lbs[i] <= ubs[i]);
     workload[i] = ubs[i] - lbs[i];
     int64_t candidateTileSize = 1;
-    int64_t targetSize =
-        std::min(workload[i] / clNumberOfRuntimeThreads, maxTileSizes[i]);
+    int64_t targetSize = std::min(workload[i] / numThreads, maxTileSizes[i]);
     int64_t vectorSize = vectorSizeHints[i];
     if (vectorSize > 1) {
       // Pick the factor of dim which is closest to the target tile size and
@@ -551,8 +615,12 @@ getDefaultDistributionTileSizes(ArrayRef<int64_t> lbs, ArrayRef<int64_t> ubs,
         std::min<int64_t>(candidateTileSize, maxTileSizes[i]);
   }
 
-  reduceDistributionWorkgroups(workload, distributedTileSizes, maxTileSizes,
-                               vectorSizeHints);
+  reduceDistributionWorkgroups(workload, distributedTileSizes, numThreads,
+                               maxTileSizes, vectorSizeHints);
+  if (saturateThreads) {
+    increaseDistributionWorkgroups(workload, distributedTileSizes,
+                                   vectorSizeHints, numThreads);
+  }
 
   return distributedTileSizes;
 }
@@ -875,9 +943,11 @@ getDefaultDistributedLevelTileSizes(Operation *op,
   LLVM_DEBUG(KD_DBGS() << "Adjusted vector size hints: "
                        << adjustedVectorSizeHints << "\n");
 
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(op);
   SmallVector<int64_t> distributedTileSizes = getDefaultDistributionTileSizes(
       lbs, ubs, adjustedMinTileSizes, adjustedMaxTileSizes,
-      adjustedVectorSizeHints);
+      adjustedVectorSizeHints, getNumberOfRuntimeThreads(targetAttr),
+      hasDeclaredNumberOfThreads(targetAttr));
 
   LLVM_DEBUG(KD_DBGS() << "Distributed tile sizes before fixups: "
                        << distributedTileSizes << "\n");
@@ -896,6 +966,113 @@ getDefaultDistributedLevelTileSizes(Operation *op,
   return distributedTileSizes;
 }
 
+/// Returns the number of bytes of cache that the tile processed by each
+/// workgroup should fit in, or std::nullopt if the target does not declare its
+/// cache sizes. Half of the per-core L2 cache is used to leave room for other
+/// data; the shared L3 cache is split across the runtime threads.
+static std::optional<int64_t>
+getWorkgroupCacheBudget(IREE::HAL::ExecutableTargetAttr targetAttr) {
+  std::optional<int64_t> budget;
+  if (auto l2CacheSize = getConfigIntegerAttr(targetAttr, "l2_cache_size")) {
+    if (l2CacheSize->getInt() > 0) {
+      budget = l2CacheSize->getInt() / 2;
+    }
+  }
+  if (auto l3CacheSize = getConfigIntegerAttr(targetAttr, "l3_cache_size")) {
+    if (l3CacheSize->getInt() > 0) {
+      int64_t perThreadSize =
+          l3CacheSize->getInt() / getNumberOfRuntimeThreads(targetAttr);
+      budget = budget ? std::min(*budget, perThreadSize) : perThreadSize;
+    }
+  }
+  return budget;
+}
+
+/// Returns the number of bytes of all operands accessed by a tile of `op` with
+/// `tileSizes`, where 0 means the full loop range. Returns std::nullopt if the
+/// footprint is not static.
+static std::optional<int64_t>
+getTileFootprintInBytes(linalg::LinalgOp op, ArrayRef<int64_t> tileSizes) {
+  SmallVector<int64_t> loopRanges = op.getStaticLoopRanges();
+  SmallVector<int64_t> sizes(loopRanges.size());
+  for (auto i : llvm::seq<size_t>(0, loopRanges.size())) {
+    if (ShapedType::isDynamic(loopRanges[i])) {
+      return std::nullopt;
+    }
+    sizes[i] = tileSizes[i] ? std::min(tileSizes[i], loopRanges[i])
+                            : loopRanges[i];
+  }
+
+  int64_t footprint = 0;
+  for (OpOperand &operand : op->getOpOperands()) {
+    auto shapedType = dyn_cast<ShapedType>(operand.get().getType());
+    if (!shapedType) {
+      continue;
+    }
+    Type elementType = shapedType.getElementType();
+    if (!elementType.isIntOrFloat()) {
+      return std::nullopt;
+    }
+    int64_t numElements = 1;
+    AffineMap map = op.getMatchingIndexingMap(&operand);
+    for (auto [index, expr] : llvm::enumerate(map.getResults())) {
+      if (auto dimExpr = dyn_cast<AffineDimExpr>(expr)) {
+        numElements *= sizes[dimExpr.getPosition()];
+        continue;
+      }
+      int64_t dimSize = shapedType.getDimSize(index);
+      if (ShapedType::isDynamic(dimSize)) {
+        return std::nullopt;
+      }
+      numElements *= dimSize;
+    }
+    footprint += numElements *
+                 llvm::divideCeil(elementType.getIntOrFloatBitWidth(), 8);
+  }
+  return footprint;
+}
+
+/// Limits the distribution tile sizes of `op` such that the operands accessed
+/// by each workgroup fit in the cache budget of the target. This matters for
+/// dispatches that access their tiles more than once, e.g. fused reductions
+/// like softmax, and for large elementwise dispatches with many operands. The
+/// largest tile size is halved while it stays at least `minTileSizes` so that
+/// the inner tiling levels are unaffected.
+static void limitDistributionTileSizesToCache(
+    linalg::LinalgOp op, SmallVectorImpl<int64_t> &distTileSizes,
+    ArrayRef<int64_t> minTileSizes) {
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(op);
+  std::optional<int64_t> budget = getWorkgroupCacheBudget(targetAttr);
+  if (!budget) {
+    return;
+  }
+
+  while (true) {
+    std::optional<int64_t> footprint =
+        getTileFootprintInBytes(op, distTileSizes);
+    if (!footprint || *footprint <= *budget) {
+      break;
+    }
+    std::optional<unsigned> splitDim;
+    for (auto i : llvm::seq<unsigned>(0, distTileSizes.size())) {
+      int64_t currSize = distTileSizes[i];
+      if (currSize <= 1 || currSize % 2 != 0 ||
+          currSize / 2 < minTileSizes[i]) {
+        continue;
+      }
+      if (!splitDim || currSize > distTileSizes[*splitDim]) {
+        splitDim = i;
+      }
+    }
+    if (!splitDim) {
+      break;
+    }
+    distTileSizes[*splitDim] /= 2;
+  }
+  LLVM_DEBUG(KD_DBGS() << "Distribution tile sizes limited to the cache: "
+                       << distTileSizes << "\n");
+}
+
 /// Splits the tile sizes in `parallelSizes` into `reductionSizes` for the
 /// reduction loops.
 static void splitParallelAndReductionTiles(
@@ -1747,8 +1924,14 @@ static LogicalResult setRootConfig(mlir::FunctionOpInterface entryPointFn,
       /*subgroupSize=*/{}, pipelineConfig);
 }
 
-static LogicalResult setRootConfig(mlir::FunctionOpInterface entryPointFn,
-                                   IREE::LinalgExt::AttentionOp attnOp) {
+/// Sets the lowering configuration for dispatch region with an
+/// iree_linalg_ext.attention or iree_linalg_ext.online_attention root op.
+/// The latter is produced by splitting the key/value sequence of attention
+/// ops and is configured the same way.
+template <typename AttentionOpTy>
+static LogicalResult
+setAttentionRootConfig(mlir::FunctionOpInterface entryPointFn,
+                       AttentionOpTy attnOp) {
   FailureOr<IREE::LinalgExt::AttentionOpDetail> maybeOpInfo =
       IREE::LinalgExt::AttentionOpDetail::get(
           attnOp.getQueryMap(), attnOp.getKeyMap(), attnOp.getValueMap(),
@@ -1839,6 +2022,16 @@ static LogicalResult setRootConfig(mlir::FunctionOpInterface entryPointFn,
       DispatchLoweringPassPipeline::CPULinalgExtTileAndVectorize);
 }
 
+static LogicalResult setRootConfig(mlir::FunctionOpInterface entryPointFn,
+                                   IREE::LinalgExt::AttentionOp attnOp) {
+  return setAttentionRootConfig(entryPointFn, attnOp);
+}
+
+static LogicalResult setRootConfig(mlir::FunctionOpInterface entryPointFn,
+                                   IREE::LinalgExt::OnlineAttentionOp attnOp) {
+  return setAttentionRootConfig(entryPointFn, attnOp);
+}
+
 /// Sets the lowering configuration for dispatch region for linalg_ext.fft
 /// root op.
 static LogicalResult setRootConfig(mlir::FunctionOpInterface entryPointFn,
@@ -1899,6 +2092,37 @@ setWinogradRootConfig(mlir::FunctionOpInterface entryPointFn,
       DispatchLoweringPassPipeline::CPULinalgExtTileAndVectorize);
 }
 
+/// Returns the scalable flags for the vector tile sizes `vecTileSizes` of `op`
+/// when targeting scalable vectors (e.g. Arm SVE), or an all-false list
+/// otherwise. Only the innermost loop is made scalable, and only when it is
+/// vectorized with a power-of-two size greater than one: 2-D scalable vectors
+/// are only supported with SME and are dropped by 2d-scalable-to-1d-scalable.
+static SmallVector<bool>
+getScalableVectorTileFlags(linalg::LinalgOp op,
+                           ArrayRef<int64_t> vecTileSizes) {
+  SmallVector<bool> scalableFlags(vecTileSizes.size(), false);
+  auto targetAttr = IREE::HAL::ExecutableTargetAttr::lookup(op);
+  if (!clEnableScalableVectorization || !isAArch64(targetAttr) ||
+      !hasAnySVEFeature(targetAttr) || vecTileSizes.empty()) {
+    return scalableFlags;
+  }
+  // Scalable vectorization relies on masking to handle the remainder.
+  if (getVectorPreProcStrategy(op) != VectorPreProcStrategy::Masking) {
+    return scalableFlags;
+  }
+  // Propagating scalable flags to fused tensor.pack consumers is not
+  // supported yet, see setLoweringConfigForComputeOps.
+  auto funcOp = op->getParentOfType<FunctionOpInterface>();
+  if (funcOp && !funcOp.getFunctionBody().getOps<tensor::PackOp>().empty()) {
+    return scalableFlags;
+  }
+  int64_t innerSize = vecTileSizes.back();
+  if (innerSize > 1 && llvm::isPowerOf2_64(innerSize)) {
+    scalableFlags.back() = true;
+  }
+  return scalableFlags;
+}
+
 static void setVectorTileSizes(linalg::LinalgOp op,
                                ArrayRef<int64_t> distTileSizes,
                                ArrayRef<int64_t> minTileSizes,
@@ -1953,22 +2177,27 @@ setDefaultGenericOpRootConfig(mlir::FunctionOpInterface entryPointFn,
   LLVM_DEBUG(KD_DBGS() << "Final tile sizes for distribution: " << distTileSizes
                        << "\n");
 
+  SmallVector<int64_t> minTileSizes = getMinTilingSizesForEachDim(
+      entryPointFn, genericOp, linalgOpInfo, targetMLTransInfo);
+  limitDistributionTileSizesToCache(genericOp, distTileSizes, minTileSizes);
+
   auto vecPreProcStrategy = getVectorPreProcStrategy(genericOp);
   LLVM_DEBUG(KD_DBGS() << "Vectorization pre-processing strategy "
                        << vecPreProcStrategy << "\n");
 
   // Set the next level tile sizes.
   SmallVector<int64_t> vecTileSizes;
-  setVectorTileSizes(genericOp, distTileSizes,
-                     getMinTilingSizesForEachDim(entryPointFn, genericOp,
-                                                 linalgOpInfo,
-                                                 targetMLTransInfo),
+  setVectorTileSizes(genericOp, distTileSizes, minTileSizes,
                      distConfig.maxTileSizes, vecPreProcStrategy, vecTileSizes);
   limitVectorTileSizes(genericOp, vecTileSizes);
   SmallVector<int64_t> parallelTileSizes = vecTileSizes;
   SmallVector<int64_t> reductionTileSizes;
+  SmallVector<bool> parallelScalableFlags =
+      getScalableVectorTileFlags(genericOp, vecTileSizes);
+  SmallVector<bool> reductionScalableFlags;
   splitParallelAndReductionTiles(genericOp, parallelTileSizes,
-                                 reductionTileSizes);
+                                 reductionTileSizes, &parallelScalableFlags,
+                                 &reductionScalableFlags);
   setVectorSizesForDynamicShapes(genericOp, vecPreProcStrategy,
                                  parallelTileSizes, reductionTileSizes);
 
@@ -1981,6 +2210,10 @@ setDefaultGenericOpRootConfig(mlir::FunctionOpInterface entryPointFn,
                                  reductionTileSizes};
   // No need for tiling inner parallel dims.
   tileSizes.emplace_back(numLoops, 0);
+  SmallVector<bool> noScalableFlags(numLoops, false);
+  ScalableTileFlagsListType scalableTileFlags = {
+      noScalableFlags, parallelScalableFlags, reductionScalableFlags,
+      noScalableFlags};
 
   // For non-tensor based ops use the Buffer ops pipeline.
   DispatchLoweringPassPipeline passPipeline;
@@ -1995,8 +2228,8 @@ setDefaultGenericOpRootConfig(mlir::FunctionOpInterface entryPointFn,
   }
 
   return setOpConfigAndEntryPointFnTranslation(
-      entryPointFn, genericOp, tileSizes, passPipeline, /*workgroupSize=*/{},
-      /*subgroupSize=*/{}, pipelineConfig);
+      entryPointFn, genericOp, tileSizes, scalableTileFlags, passPipeline,
+      /*workgroupSize=*/{}, /*subgroupSize=*/{}, pipelineConfig);
 }
 
 /// Utility to return the transpose vector `sizes` for X86. Empty `sizes` on
@@ -2207,6 +2440,9 @@ static LogicalResult setElementwiseGenericOpRootConfig(
     distTileSizes[currDim] = newSize;
   }
 
+  limitDistributionTileSizesToCache(genericOp, distTileSizes,
+                                    distConfig.minTileSizes);
+
   auto vecPreProcStrategy = getVectorPreProcStrategy(genericOp);
   LLVM_DEBUG(KD_DBGS() << "Vector pre-processing strategy: "
                        << vecPreProcStrategy << "\n");
@@ -2225,9 +2461,15 @@ static LogicalResult setElementwiseGenericOpRootConfig(
   // further tiling inner parallel dims, so the 4-th list is also zeros.
   SmallVector<int64_t> zeros(numLoops, 0);
   TileSizesListType tileSizes = {distTileSizes, vecTileSizes, zeros, zeros};
+  SmallVector<bool> noScalableFlags(numLoops, false);
+  ScalableTileFlagsListType scalableTileFlags = {
+      noScalableFlags, getScalableVectorTileFlags(genericOp, vecTileSizes),
+      noScalableFlags, noScalableFlags};
 
   LLVM_DEBUG(KD_DBGS() << "Final tile sizes for element-wise op: " << tileSizes
                        << "\n");
+  LLVM_DEBUG(KD_DBGS() << "Final tile scalable flags for element-wise op: "
+                       << scalableTileFlags << "\n");
 
   DispatchLoweringPassPipeline passPipeline;
   DictionaryAttr pipelineConfig;
@@ -2242,8 +2484,8 @@ static LogicalResult setElementwiseGenericOpRootConfig(
   }
 
   return setOpConfigAndEntryPointFnTranslation(
-      entryPointFn, genericOp, tileSizes, passPipeline, /*workgroupSize=*/{},
-      /*subgroupSize=*/{}, pipelineConfig);
+      entryPointFn, genericOp, tileSizes, scalableTileFlags, passPipeline,
+      /*workgroupSize=*/{}, /*subgroupSize=*/{}, pipelineConfig);
 }
 
 /// Sets the lowering configuration for a generic op to use
@@ -2534,7 +2776,8 @@ setRootConfigImpl(mlir::FunctionOpInterface entryPointFn, Operation *op,
           return setDefaultCustomOpLoweringConfig(entryPointFn, op,
                                                   initCPULaunchConfig);
         })
-        .Case<IREE::LinalgExt::AttentionOp, IREE::LinalgExt::FftOp,
+        .Case<IREE::LinalgExt::AttentionOp,
+              IREE::LinalgExt::OnlineAttentionOp, IREE::LinalgExt::FftOp,
               tensor::PackOp, tensor::PadOp, tensor::UnPackOp, linalg::Mmt4DOp,
               linalg::BatchMmt4DOp>(
             [&](auto op) { return setRootConfig(entryPointFn, op); })
@@ -3057,6 +3300,113 @@ lowerUsingDefaultPipeline(mlir::FunctionOpInterface entryPointFn) {
   return setTranslationInfo(entryPointFn, translationInfo);
 }
 
+/// Adjusts the lowering configs of a dispatch whose root contraction consumes
+/// the result of another contraction through elementwise ops, e.g. the
+/// GEMM -> activation -> GEMM chain of an MLP. Each workgroup computes the rows
+/// of the intermediate result it needs exactly once: the parallel dims of the
+/// root that do not index the intermediate are not distributed, and the
+/// distributed ones are limited so the workgroup tile stays in cache. The
+/// producer contraction is not fused into the vector-level loops of the root
+/// (see LLVMCPUTileAndFuse), so it gets its own tile sizes derived from the
+/// ones of the root.
+static LogicalResult
+setChainedContractionLoweringConfig(mlir::FunctionOpInterface entryPointFn,
+                                    Operation *rootOperation) {
+  auto rootOp = dyn_cast<linalg::LinalgOp>(rootOperation);
+  if (!rootOp) {
+    return success();
+  }
+  OpOperand *chainedOperand = nullptr;
+  linalg::LinalgOp producerOp =
+      getChainedContractionProducer(rootOp, &chainedOperand);
+  auto rootLoweringConfig =
+      getLoweringConfig<IREE::Codegen::LoweringConfigAttr>(rootOp);
+  if (!producerOp || !rootLoweringConfig) {
+    return success();
+  }
+  TilingConfig tilingConfig(rootLoweringConfig);
+  if (tilingConfig.getNumTilingLevels() < 3) {
+    return success();
+  }
+  AffineMap chainedMap = rootOp.getMatchingIndexingMap(chainedOperand);
+  AffineMap producerMap =
+      producerOp.getIndexingMapMatchingResult(producerOp->getResult(0));
+  if (!chainedMap.isProjectedPermutation() ||
+      !producerMap.isProjectedPermutation()) {
+    return success();
+  }
+  LLVM_DEBUG(KD_DBGS() << "Chained contraction producer: " << producerOp
+                       << "\n");
+
+  // Update the distribution tile sizes of the root.
+  TileSizesListType rootTileSizes = rootLoweringConfig.getTileSizeVals();
+  ScalableTileFlagsListType rootScalableFlags =
+      rootLoweringConfig.getScalableTileFlagVals();
+  unsigned distLevel = tilingConfig.getDistributionLevel();
+  unsigned vecParallelLevel = tilingConfig.getVectorCommonParallelLevel();
+  unsigned vecReductionLevel = tilingConfig.getVectorReductionLevel();
+  SmallVector<int64_t> &distTileSizes = rootTileSizes[distLevel];
+  SmallVector<unsigned> rootParallelDims;
+  rootOp.getParallelDims(rootParallelDims);
+  for (unsigned dim : rootParallelDims) {
+    if (!chainedMap.isFunctionOfDim(dim)) {
+      distTileSizes[dim] = 0;
+    }
+  }
+  limitDistributionTileSizesToCache(rootOp, distTileSizes,
+                                    rootTileSizes[vecParallelLevel]);
+  // Cache-level tile sizes follow the distribution tile sizes.
+  if (tilingConfig.getNumTilingLevels() == 6) {
+    unsigned cacheParallelLevel = tilingConfig.getCacheParallelLevel();
+    for (unsigned dim : rootParallelDims) {
+      rootTileSizes[cacheParallelLevel][dim] = distTileSizes[dim];
+    }
+  }
+  MLIRContext *ctx = entryPointFn.getContext();
+  setLoweringConfig(rootOp, IREE::Codegen::LoweringConfigAttr::get(
+                                ctx, rootTileSizes, rootScalableFlags));
+
+  // Derive the tile sizes of the producer. Its result is indexed the same way
+  // as the chained operand of the root, since the elementwise ops in between
+  // have identity indexing maps. The dims of the intermediate reduced by the
+  // root are produced in chunks of the vector reduction tile size of the root.
+  unsigned producerNumLoops = producerOp.getNumLoops();
+  TileSizesListType producerTileSizes(
+      rootTileSizes.size(), SmallVector<int64_t>(producerNumLoops, 0));
+  ScalableTileFlagsListType producerScalableFlags(
+      rootTileSizes.size(), SmallVector<bool>(producerNumLoops, false));
+  int64_t rootReductionTileSize = 0;
+  for (int64_t size : rootTileSizes[vecReductionLevel]) {
+    rootReductionTileSize = std::max(rootReductionTileSize, size);
+  }
+  SmallVector<utils::IteratorType> rootIterTypes =
+      rootOp.getIteratorTypesArray();
+  for (auto [rootExpr, producerExpr] :
+       llvm::zip_equal(chainedMap.getResults(), producerMap.getResults())) {
+    unsigned rootDim = cast<AffineDimExpr>(rootExpr).getPosition();
+    unsigned producerDim = cast<AffineDimExpr>(producerExpr).getPosition();
+    if (linalg::isReductionIterator(rootIterTypes[rootDim])) {
+      producerTileSizes[vecParallelLevel][producerDim] =
+          rootTileSizes[vecReductionLevel][rootDim];
+      continue;
+    }
+    producerTileSizes[distLevel][producerDim] = distTileSizes[rootDim];
+    producerTileSizes[vecParallelLevel][producerDim] =
+        rootTileSizes[vecParallelLevel][rootDim];
+  }
+  SmallVector<unsigned> producerReductionDims;
+  producerOp.getReductionDims(producerReductionDims);
+  for (unsigned dim : producerReductionDims) {
+    producerTileSizes[vecReductionLevel][dim] = rootReductionTileSize;
+  }
+  LLVM_DEBUG(KD_DBGS() << "Chained contraction producer tile sizes: "
+                       << producerTileSizes << "\n");
+  setLoweringConfig(producerOp,
+                    IREE::Codegen::LoweringConfigAttr::get(
+                        ctx, producerTileSizes, producerScalableFlags));
+  return success();
+}
+
 /// Sets the translation information to use for a dispatch region.
 static LogicalResult
 setTranslationInfoAndRootConfig(mlir::FunctionOpInterface entryPointFn,
@@ -3108,6 +3458,10 @@ setTranslationInfoAndRootConfig(mlir::FunctionOpInterface entryPointFn,
                                               rootOperation))) {
       return failure();
     }
+    if (failed(setChainedContractionLoweringConfig(entryPointFn,
+                                                   rootOperation))) {
+      return failure();
+    }
   }
 
   return success();
@@ -0,0 +1,271 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/LLVMCPU/Passes.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Func/IR/FuncOps.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::iree_compiler {
+
+#define GEN_PASS_DEF_LLVMCPUBATCHIMPORTCALLSPASS
+#include "iree/compiler/Codegen/LLVMCPU/Passes.h.inc"
+
+namespace {
+
+// Name of the attribute on external function declarations specifying the
+// import implementing the batched calling convention for the function.
+static constexpr StringLiteral kImportBatchAttrName = "hal.import.batch";
+
+// Returns true if |value| has the same value on every iteration of |forOp|.
+static bool isLoopInvariant(Value value, scf::ForOp forOp) {
+  return forOp.isDefinedOutsideOfLoop(value) ||
+         matchPattern(value, m_Constant());
+}
+
+// Returns true if |value| is an affine function `a + iv * b` of the induction
+// variable of |forOp| with loop-invariant `a` and `b`.
+static bool isLinearInInductionVar(Value value, scf::ForOp forOp) {
+  if (value == forOp.getInductionVar() || isLoopInvariant(value, forOp)) {
+    return true;
+  }
+  Operation *definingOp = value.getDefiningOp();
+  if (!definingOp) {
+    return false;
+  }
+  return TypeSwitch<Operation *, bool>(definingOp)
+      .Case<arith::AddIOp, arith::SubIOp>([&](auto op) {
+        return isLinearInInductionVar(op.getLhs(), forOp) &&
+               isLinearInInductionVar(op.getRhs(), forOp);
+      })
+      .Case<arith::MulIOp>([&](arith::MulIOp op) {
+        if (isLoopInvariant(op.getLhs(), forOp)) {
+          return isLinearInInductionVar(op.getRhs(), forOp);
+        }
+        return isLoopInvariant(op.getRhs(), forOp) &&
+               isLinearInInductionVar(op.getLhs(), forOp);
+      })
+      .Case<arith::IndexCastOp>([&](arith::IndexCastOp op) {
+        return isLinearInInductionVar(op.getIn(), forOp);
+      })
+      .Case<affine::AffineApplyOp>([&](affine::AffineApplyOp op) {
+        // Pure affine expressions are linear in their dimensions so long as
+        // they don't divide and the symbols they multiply by don't vary.
+        AffineExpr expr = op.getAffineMap().getResult(0);
+        if (!expr.isPureAffine()) {
+          return false;
+        }
+        bool hasDivision = false;
+        expr.walk([&](AffineExpr subExpr) {
+          hasDivision |= subExpr.getKind() == AffineExprKind::Mod ||
+                         subExpr.getKind() == AffineExprKind::FloorDiv ||
+                         subExpr.getKind() == AffineExprKind::CeilDiv;
+        });
+        if (hasDivision) {
+          return false;
+        }
+        return llvm::all_of(op.getDimOperands(),
+                            [&](Value operand) {
+                              return isLinearInInductionVar(operand, forOp);
+                            }) &&
+               llvm::all_of(op.getSymbolOperands(), [&](Value operand) {
+                 return isLoopInvariant(operand, forOp);
+               });
+      })
+      .Default([](Operation *) { return false; });
+}
+
+// Returns the external function declaration with a batched import if |forOp|
+// only performs a call to it once per iteration and can be batched.
+static func::FuncOp matchBatchableLoop(scf::ForOp forOp,
+                                       func::CallOp &outCallOp) {
+  if (forOp.getNumResults() != 0) {
+    return {};
+  }
+
+  // The loop body must contain a single call and otherwise only side-effect
+  // free ops feeding it.
+  func::CallOp callOp;
+  for (Operation &op : forOp.getBody()->without_terminator()) {
+    if (auto nestedCallOp = dyn_cast<func::CallOp>(op)) {
+      if (callOp) {
+        return {};
+      }
+      callOp = nestedCallOp;
+      continue;
+    }
+    if (op.getNumRegions() != 0 || !isPure(&op)) {
+      return {};
+    }
+  }
+  if (!callOp || callOp.getNumResults() != 0) {
+    return {};
+  }
+  auto calleeOp = SymbolTable::lookupNearestSymbolFrom<func::FuncOp>(
+      callOp, callOp.getCalleeAttr());
+  if (!calleeOp || !calleeOp.isExternal() ||
+      !calleeOp->hasAttrOfType<StringAttr>(kImportBatchAttrName)) {
+    return {};
+  }
+
+  // Each argument must be loop-invariant or, for integers, step by a fixed
+  // amount each iteration.
+  for (Value operand : callOp.getOperands()) {
+    if (isLoopInvariant(operand, forOp)) {
+      continue;
+    }
+    if (!operand.getType().isIntOrIndex() ||
+        !isLinearInInductionVar(operand, forOp)) {
+      return {};
+    }
+  }
+
+  outCallOp = callOp;
+  return calleeOp;
+}
+
+// Returns the declaration of the batched import of |calleeOp|, inserting it
+// if needed. The batched form takes the iteration count, the arguments of the
+// first iteration, and a per-argument stride.
+static FailureOr<func::FuncOp> getOrInsertBatchedDecl(func::FuncOp calleeOp) {
+  auto batchNameAttr =
+      calleeOp->getAttrOfType<StringAttr>(kImportBatchAttrName);
+  Builder builder(calleeOp.getContext());
+  Type indexType = builder.getIndexType();
+  SmallVector<Type> inputTypes;
+  inputTypes.push_back(indexType);
+  llvm::append_range(inputTypes, calleeOp.getArgumentTypes());
+  inputTypes.append(calleeOp.getNumArguments(), indexType);
+  auto batchedType = builder.getFunctionType(inputTypes, TypeRange{});
+
+  auto moduleOp = calleeOp->getParentOfType<ModuleOp>();
+  if (auto existingOp =
+          moduleOp.lookupSymbol<func::FuncOp>(batchNameAttr.getValue())) {
+    if (existingOp.getFunctionType() != batchedType) {
+      return calleeOp.emitOpError()
+             << "batched import " << batchNameAttr
+             << " is already declared with an incompatible signature";
+    }
+    return existingOp;
+  }
+
+  OpBuilder moduleBuilder(calleeOp);
+  moduleBuilder.setInsertionPointAfter(calleeOp);
+  auto batchedOp = moduleBuilder.create<func::FuncOp>(
+      calleeOp.getLoc(), batchNameAttr.getValue(), batchedType);
+  batchedOp.setPrivate();
+  for (NamedAttribute attr : calleeOp->getDiscardableAttrs()) {
+    if (attr.getName() == kImportBatchAttrName ||
+        attr.getName() == "hal.import.name") {
+      continue;
+    }
+    batchedOp->setAttr(attr.getName(), attr.getValue());
+  }
+  return batchedOp;
+}
+
+// Replaces |forOp| with a single call to the batched import of |calleeOp|.
+static LogicalResult batchLoop(scf::ForOp forOp, func::CallOp callOp,
+                               func::FuncOp calleeOp) {
+  FailureOr<func::FuncOp> batchedOp = getOrInsertBatchedDecl(calleeOp);
+  if (failed(batchedOp)) {
+    return failure();
+  }
+
+  OpBuilder builder(forOp);
+  Location loc = callOp.getLoc();
+  Value lowerBound = forOp.getLowerBound();
+  Value upperBound = forOp.getUpperBound();
+  Value step = forOp.getStep();
+  Type indexType = builder.getIndexType();
+
+  // count = max(ub - lb, 0) ceildiv step
+  Value zero = builder.create<arith::ConstantOp>(
+      loc, builder.getZeroAttr(lowerBound.getType()));
+  Value distance = builder.create<arith::SubIOp>(loc, upperBound, lowerBound);
+  distance = builder.create<arith::MaxSIOp>(loc, distance, zero);
+  Value count = builder.create<arith::CeilDivSIOp>(loc, distance, step);
+  if (!count.getType().isIndex()) {
+    count = builder.create<arith::IndexCastOp>(loc, indexType, count);
+  }
+
+  // Materialize the arguments of the first two iterations; their difference is
+  // the per-iteration stride of each argument.
+  auto cloneBodyAt = [&](Value inductionVar) -> SmallVector<Value> {
+    IRMapping mapping;
+    mapping.map(forOp.getInductionVar(), inductionVar);
+    for (Operation &op : forOp.getBody()->without_terminator()) {
+      if (&op != callOp.getOperation()) {
+        builder.clone(op, mapping);
+      }
+    }
+    return llvm::map_to_vector(callOp.getOperands(), [&](Value operand) {
+      return mapping.lookupOrDefault(operand);
+    });
+  };
+  SmallVector<Value> firstArgs = cloneBodyAt(lowerBound);
+  Value secondIV = builder.create<arith::AddIOp>(loc, lowerBound, step);
+  SmallVector<Value> secondArgs = cloneBodyAt(secondIV);
+
+  SmallVector<Value> operands;
+  operands.push_back(count);
+  llvm::append_range(operands, firstArgs);
+  Value zeroStride = builder.create<arith::ConstantIndexOp>(loc, 0);
+  for (auto [operand, first, second] :
+       llvm::zip_equal(callOp.getOperands(), firstArgs, secondArgs)) {
+    if (isLoopInvariant(operand, forOp)) {
+      operands.push_back(zeroStride);
+      continue;
+    }
+    Value stride = builder.create<arith::SubIOp>(loc, second, first);
+    if (!stride.getType().isIndex()) {
+      stride = builder.create<arith::IndexCastOp>(loc, indexType, stride);
+    }
+    operands.push_back(stride);
+  }
+
+  builder.create<func::CallOp>(loc, *batchedOp, operands);
+  forOp.erase();
+  return success();
+}
+
+struct LLVMCPUBatchImportCallsPass
+    : public impl::LLVMCPUBatchImportCallsPassBase<
+          LLVMCPUBatchImportCallsPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, func::FuncDialect>();
+  }
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+
+    // Gather the loops first as batching erases them. Loops containing other
+    // loops are never batchable so the gathered loops never nest.
+    SmallVector<std::tuple<scf::ForOp, func::CallOp, func::FuncOp>>
+        batchableLoops;
+    moduleOp.walk([&](scf::ForOp forOp) {
+      func::CallOp callOp;
+      if (auto calleeOp = matchBatchableLoop(forOp, callOp)) {
+        batchableLoops.emplace_back(forOp, callOp, calleeOp);
+      }
+    });
+
+    for (auto [forOp, callOp, calleeOp] : batchableLoops) {
+      if (failed(batchLoop(forOp, callOp, calleeOp))) {
+        return signalPassFailure();
+      }
+    }
+  }
+};
+
+} // namespace
+} // namespace mlir::iree_compiler
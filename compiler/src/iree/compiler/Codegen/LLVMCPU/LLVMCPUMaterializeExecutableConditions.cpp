@@ -0,0 +1,107 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Codegen/LLVMCPU/Passes.h"
+#include "iree/compiler/Codegen/Utils/Utils.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/ADT/StringSet.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::iree_compiler {
+
+#define GEN_PASS_DEF_LLVMCPUMATERIALIZEEXECUTABLECONDITIONSPASS
+#include "iree/compiler/Codegen/LLVMCPU/Passes.h.inc"
+
+namespace {
+
+// Returns the CPU features of |targetAttr| that can be queried at runtime with
+// `hal.device.query "hal.cpu" :: "<feature>"`, in the order they are specified
+// in the target. Features unknown to the runtime are dropped: they either
+// cannot be detected (and the variant author is asserting their presence) or
+// are not hardware features at all (such as +reserve-x18 on arm64).
+SmallVector<StringRef>
+getQueryableCpuFeatures(IREE::HAL::ExecutableTargetAttr targetAttr) {
+  std::optional<StringRef> cpuFeatures = getCpuFeatures(targetAttr);
+  std::optional<llvm::Triple> targetTriple = getTargetTriple(targetAttr);
+  if (!cpuFeatures || !targetTriple) {
+    return {};
+  }
+
+  // Map llvm feature-names to those known by the runtime iree_cpu_data.
+  // This must match iree_cpu_lookup_data_by_key() on the runtime side.
+  llvm::StringSet<> knownFeatures;
+  std::string targetArchUppercase =
+      StringRef(getIreeArchNameForTargetTriple(targetTriple.value())).upper();
+#define IREE_CPU_FEATURE_BIT(arch, field_index, bit_pos, bit_name, llvm_name)  \
+  if (targetArchUppercase == #arch) {                                          \
+    knownFeatures.insert(llvm_name);                                           \
+  }
+#include "iree/schemas/cpu_feature_bits.inl"
+#undef IREE_CPU_FEATURE_BIT
+
+  SmallVector<StringRef> cpuFeatureStrings;
+  cpuFeatures->split(cpuFeatureStrings, ',', /*MaxSplit=*/-1,
+                     /*KeepEmpty=*/false);
+  llvm::SetVector<StringRef> queryableFeatures;
+  for (StringRef featureString : cpuFeatureStrings) {
+    // Only enabled features (+avx512f) impose requirements on the device.
+    if (!featureString.consume_front("+")) {
+      continue;
+    }
+    if (knownFeatures.contains(featureString)) {
+      queryableFeatures.insert(featureString);
+    }
+  }
+  return queryableFeatures.takeVector();
+}
+
+struct LLVMCPUMaterializeExecutableConditionsPass final
+    : impl::LLVMCPUMaterializeExecutableConditionsPassBase<
+          LLVMCPUMaterializeExecutableConditionsPass> {
+  void runOnOperation() override {
+    IREE::HAL::ExecutableVariantOp variantOp = getOperation();
+    IREE::HAL::ExecutableTargetAttr targetAttr = variantOp.getTarget();
+    if (targetAttr.getBackend().getValue() != "llvm-cpu") {
+      return;
+    }
+
+    // Only variants produced as specializations of a more generic variant are
+    // conditional: the generic variant must remain unconditional so that there
+    // is always a variant to fall back to. Variants that already have a
+    // condition are left as-is.
+    std::optional<BoolAttr> selectAttr =
+        getConfigBoolAttr(targetAttr, "select_on_cpu_features");
+    if (!selectAttr || !selectAttr->getValue() || variantOp.getConditionOp()) {
+      return;
+    }
+    SmallVector<StringRef> features = getQueryableCpuFeatures(targetAttr);
+    if (features.empty()) {
+      return;
+    }
+
+    // Build the hal.executable.condition op inside the variant that queries
+    // each required feature of the device CPU. Queries that fail (such as when
+    // the device is not a CPU) default to false and reject the variant.
+    OpBuilder builder(variantOp);
+    Value device = variantOp.createConditionOp(builder);
+    Location loc = device.getLoc();
+    IntegerType boolType = builder.getI1Type();
+    TypedAttr falseAttr = builder.getIntegerAttr(boolType, 0);
+    Value result = builder.create<arith::ConstantIntOp>(loc, true, 1);
+    for (StringRef feature : features) {
+      auto queryOp = builder.create<IREE::HAL::DeviceQueryOp>(
+          loc, boolType, boolType, device, builder.getStringAttr("hal.cpu"),
+          builder.getStringAttr(feature), falseAttr);
+      result = builder.create<arith::AndIOp>(loc, result, queryOp.getValue());
+    }
+    builder.create<IREE::HAL::ReturnOp>(loc, result);
+  }
+};
+
+} // namespace
+} // namespace mlir::iree_compiler
@@ -100,9 +100,12 @@ struct LLVMCPUTileAndFusePass
   void runOnOperation() override;
 };
 
+/// Tiles `rootOp` and greedily fuses its producers, except for the producers
+/// in `unfusableOps`.
 LogicalResult applyTileAndFuse(RewriterBase &rewriter, Operation *rootOp,
                                DominanceInfo &dominanceInfo,
-                               scf::SCFTilingOptions options) {
+                               scf::SCFTilingOptions options,
+                               ArrayRef<Operation *> unfusableOps = {}) {
   llvm::SmallDenseSet<Operation *> origTiledAndFusedOps;
   collectTiledAndFusedOps(rootOp, origTiledAndFusedOps);
   auto isIgnoredUser = [&](Operation *user,
@@ -183,7 +186,9 @@ LogicalResult applyTileAndFuse(RewriterBase &rewriter, Operation *rootOp,
     // Traverse the slices in BFS fashion.
     tensor::ExtractSliceOp candidateSliceOp = candidates.front();
     candidates.pop_front();
-    if (candidateSliceOp.getSource().getDefiningOp<tensor::PadOp>()) {
+    if (candidateSliceOp.getSource().getDefiningOp<tensor::PadOp>() ||
+        llvm::is_contained(unfusableOps,
+                           candidateSliceOp.getSource().getDefiningOp())) {
       continue;
     }
 
@@ -249,42 +254,83 @@ void LLVMCPUTileAndFusePass::runOnOperation() {
   LLVM_DEBUG(llvm::dbgs() << "consumerOp: " << consumerOp << "\n");
   LLVM_DEBUG(llvm::dbgs() << "tilingLevel: " << tilingLevel << "\n");
 
-  // If `consumerOp` has its own lowering config, we prefer using it. Otherwise,
+  // If `op` has its own lowering config, we prefer using it. Otherwise,
   // fallback to find a lowering_config from other operations.
-  SmallVector<int64_t> tileSizes;
-  SmallVector<bool> tileScalableFlags;
-  if (auto loweringConfig =
-          getLoweringConfig<IREE::Codegen::LoweringConfigAttr>(consumerOp)) {
-    tileSizes = loweringConfig.getTileSizeVals(tilingLevel);
-    tileScalableFlags = loweringConfig.getScalableTileFlagVals(tilingLevel);
-  } else {
-    FailureOr<IREE::Codegen::LoweringConfigAttr> maybeLoweringConfig =
-        getFirstLoweringConfig<IREE::Codegen::LoweringConfigAttr>(
-            getComputeOps(funcOp));
-    if (failed(maybeLoweringConfig)) {
-      LLVM_DEBUG(llvm::dbgs()
-                 << "can't find lowering_config, skip TileAndFuse");
-      return;
+  auto getTilingOptions =
+      [&](TilingInterface op) -> std::optional<scf::SCFTilingOptions> {
+    SmallVector<int64_t> tileSizes;
+    SmallVector<bool> tileScalableFlags;
+    if (auto loweringConfig =
+            getLoweringConfig<IREE::Codegen::LoweringConfigAttr>(op)) {
+      tileSizes = loweringConfig.getTileSizeVals(tilingLevel);
+      tileScalableFlags = loweringConfig.getScalableTileFlagVals(tilingLevel);
+    } else {
+      FailureOr<IREE::Codegen::LoweringConfigAttr> maybeLoweringConfig =
+          getFirstLoweringConfig<IREE::Codegen::LoweringConfigAttr>(
+              getComputeOps(funcOp));
+      if (failed(maybeLoweringConfig)) {
+        LLVM_DEBUG(llvm::dbgs()
+                   << "can't find lowering_config, skip TileAndFuse");
+        return std::nullopt;
+      }
+      tileSizes = maybeLoweringConfig.value().getTileSizeVals(tilingLevel);
+      tileScalableFlags =
+          maybeLoweringConfig.value().getScalableTileFlagVals(tilingLevel);
+    }
+
+    if (llvm::all_of(tileSizes, [&](int64_t size) { return size == 0; })) {
+      LLVM_DEBUG(llvm::dbgs() << "----- skip, all zeros -----\n");
+      return std::nullopt;
+    }
+
+    scf::SCFTilingOptions options{};
+    setSCFTileSizes(options, op, std::move(tileSizes),
+                    std::move(tileScalableFlags));
+    return options;
+  };
+
+  // The contraction that produces the input of a chained contraction (e.g.
+  // GEMM -> activation -> GEMM) is not fused into the tiled loops of the
+  // consumer, as that would recompute it for every tile of the consumer.
+  // Instead the intermediate result is kept at the workgroup tile level and
+  // the producer is tiled separately with its own lowering config.
+  SmallVector<Operation *> unfusableOps;
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(consumerOp.getOperation())) {
+    OpOperand *chainedOperand = nullptr;
+    if (linalg::LinalgOp producerOp =
+            getChainedContractionProducer(linalgOp, &chainedOperand)) {
+      unfusableOps.push_back(producerOp);
     }
-    tileSizes = maybeLoweringConfig.value().getTileSizeVals(tilingLevel);
-    tileScalableFlags =
-        maybeLoweringConfig.value().getScalableTileFlagVals(tilingLevel);
   }
 
-  if (llvm::all_of(tileSizes, [&](int64_t size) { return size == 0; })) {
-    LLVM_DEBUG(llvm::dbgs() << "----- skip, all zeros -----\n");
+  std::optional<scf::SCFTilingOptions> options = getTilingOptions(consumerOp);
+  if (!options && unfusableOps.empty()) {
     return;
   }
 
-  scf::SCFTilingOptions options{};
-  setSCFTileSizes(options, consumerOp, std::move(tileSizes),
-                  std::move(tileScalableFlags));
-
   IRRewriter rewriter(context);
-  DominanceInfo dominanceInfo(funcOp);
-  if (failed(applyTileAndFuse(rewriter, consumerOp, dominanceInfo, options))) {
-    LLVM_DEBUG(llvm::dbgs() << "----- tile and fuse failed -----\n");
-    return signalPassFailure();
+  if (options) {
+    DominanceInfo dominanceInfo(funcOp);
+    if (failed(applyTileAndFuse(rewriter, consumerOp, dominanceInfo, *options,
+                                unfusableOps))) {
+      LLVM_DEBUG(llvm::dbgs() << "----- tile and fuse failed -----\n");
+      return signalPassFailure();
+    }
+  }
+
+  for (Operation *op : unfusableOps) {
+    auto producerOp = cast<TilingInterface>(op);
+    std::optional<scf::SCFTilingOptions> producerOptions =
+        getTilingOptions(producerOp);
+    if (!producerOptions) {
+      continue;
+    }
+    DominanceInfo dominanceInfo(funcOp);
+    if (failed(applyTileAndFuse(rewriter, producerOp, dominanceInfo,
+                                *producerOptions))) {
+      LLVM_DEBUG(llvm::dbgs() << "----- tile and fuse failed -----\n");
+      return signalPassFailure();
+    }
   }
 
   RewritePatternSet patterns =
@@ -81,11 +81,24 @@ static llvm::cl::opt<bool> clInstrumentMemoryAccesses{
                    "instrumentation is enabled."),
     llvm::cl::init(false)};
 
+static llvm::cl::opt<bool> clInstrumentMemoryAccessesSummary{
+    "iree-llvmcpu-instrument-memory-accesses-summary",
+    llvm::cl::desc("Instruments memory accesses in dispatches when dispatch "
+                   "instrumentation is enabled with per-workgroup summaries "
+                   "of the bytes accessed and access strides per binding."),
+    llvm::cl::init(false)};
+
 static llvm::cl::opt<bool> clUseSoftmaxInterFusion(
     "iree-llvmcpu-use-decompose-softmax-fuse",
     llvm::cl::desc("Enables inter-pass fusion for the DecomposeSoftmax pass."),
     llvm::cl::init(true));
 
+static llvm::cl::opt<bool> clUseIgemmConvolution(
+    "iree-llvmcpu-use-igemm-conv",
+    llvm::cl::desc("Lowers convolutions as an implicit GEMM (im2col producer "
+                   "fused into the contraction) instead of decomposing them."),
+    llvm::cl::init(false));
+
 static llvm::cl::opt<bool> clEnableVectorContractCustomKernels(
     "iree-llvmcpu-enable-vector-contract-custom-kernels",
     llvm::cl::desc("Enables vector contract custom kernels for "
@@ -423,6 +436,9 @@ void addMultiTilingExpertPassPipeline(OpPassManager &funcPassManager,
 
   {
     funcPassManager.addPass(createTensorToVectorVectorizePadPass());
+    // Tiled im2col producers of IGEMM convolutions become gathers that are
+    // vectorized along with the contraction.
+    funcPassManager.addPass(IREE::LinalgExt::createDecomposeIm2colPass());
     if (pipelineOpt.decomposePackUnPackOps) {
       funcPassManager.addPass(createDecomposePackUnPackOpsPass());
       funcPassManager.addPass(createConfigTrackingCanonicalizerPass());
@@ -674,6 +690,9 @@ static void addLowerToLLVMPasses(OpPassManager &modulePassManager,
   // Lower `ukernel.*` ops to function calls
   modulePassManager.addPass(createLowerUKernelOpsToCallsPass());
 
+  // Call imports once per loop instead of once per iteration when supported.
+  modulePassManager.addPass(createLLVMCPUBatchImportCallsPass());
+
   FunctionLikeNest(modulePassManager)
       // LinalgExt -> SCF
       .addPass(IREE::LinalgExt::createLinalgExtToLoopsPass)
@@ -752,8 +771,12 @@ static void addLowerToLLVMPasses(OpPassManager &modulePassManager,
       .addPass(createEmulateNarrowTypePass)
       .addPass(createCanonicalizerPass)
       .addPass(createCSEPass)
-      .addPredicatedPass(clInstrumentMemoryAccesses,
-                         createInstrumentMemoryAccessesPass);
+      .addPredicatedPass(
+          clInstrumentMemoryAccesses || clInstrumentMemoryAccessesSummary, [] {
+            InstrumentMemoryAccessesPassOptions options;
+            options.summary = clInstrumentMemoryAccessesSummary;
+            return createInstrumentMemoryAccessesPass(options);
+          });
 
   if (enableAArch64SME) {
     FunctionLikeNest(modulePassManager).addPass([&] {
@@ -791,6 +814,13 @@ void buildLLVMCPUCodegenConfigurationPassPipelineImpl(
       // TODO: Remove the following pass the plumb support for
       // #hal.descriptor_type memory space through the stack.
       .addPass(createEraseHALDescriptorTypeFromMemRefPass);
+  if (clUseIgemmConvolution) {
+    // Rewrite convolutions into an im2col producer and a contraction before
+    // strategy selection so the contraction is configured like a matmul and
+    // the im2col is tiled and fused into it instead of being materialized.
+    FunctionLikeNest(modulePassManager)
+        .addPass(createConvolutionToIGEMMPass);
+  }
 
   modulePassManager.addPass(createLLVMCPUSelectLoweringStrategyPass());
   LLVM_DEBUG({
@@ -836,6 +866,11 @@ void buildLLVMCPUCodegenPassPipeline(OpPassManager &variantPassManager,
 // hal.executable ops.
 void buildLLVMCPULinkingPassPipeline(OpPassManager &modulePassManager,
                                      std::optional<std::string> target) {
+  // Materialize the CPU feature requirements of specialized variants into
+  // device queries so that the runtime can select among them.
+  modulePassManager.addNestedPass<IREE::HAL::ExecutableOp>()
+      .addNestedPass<IREE::HAL::ExecutableVariantOp>(
+          createLLVMCPUMaterializeExecutableConditionsPass());
   // Link together executables. This may produce some IR duplication.
   LLVMCPULinkExecutablesPassOptions linkOptions;
   linkOptions.target = target.value_or("");
@@ -0,0 +1,101 @@
+// RUN: iree-opt --pass-pipeline="builtin.module(iree-llvmcpu-batch-import-calls)" --split-input-file %s | FileCheck %s
+
+// Tests that a loop calling an import once per iteration is replaced by a
+// single call to its batched import with per-argument strides.
+
+// CHECK-DAG: #[[$MAP:.+]] = affine_map<(d0)[s0] -> (d0 * 2 + s0)>
+
+func.func private @scale_element(%buffer: memref<f32>, %offset: index, %value: f32) attributes {
+  hal.import.batch = "scale_element_batch",
+  hal.import.fields = ["processor_id"],
+  llvm.bareptr = true
+}
+
+// CHECK: func.func private @scale_element_batch(index, memref<f32>, index, f32, index, index, index)
+// CHECK-SAME: hal.import.fields = ["processor_id"]
+// CHECK-SAME: llvm.bareptr = true
+// CHECK-NOT: hal.import.batch
+
+// CHECK-LABEL: @batch_loop
+//  CHECK-SAME: (%[[BUFFER:.+]]: memref<f32>, %[[BASE:.+]]: index, %[[VALUE:.+]]: f32, %[[UB:.+]]: index)
+func.func @batch_loop(%buffer: memref<f32>, %base: index, %value: f32, %ub: index) {
+  %c0 = arith.constant 0 : index
+  %c4 = arith.constant 4 : index
+  //  CHECK-NOT: scf.for
+  //      CHECK: %[[DISTANCE:.+]] = arith.subi %[[UB]], %{{.+}} : index
+  //      CHECK: %[[CLAMPED:.+]] = arith.maxsi %[[DISTANCE]], %{{.+}} : index
+  //      CHECK: %[[COUNT:.+]] = arith.ceildivsi %[[CLAMPED]], %{{.+}} : index
+  //      CHECK: %[[FIRST:.+]] = affine.apply #[[$MAP]](%{{.+}})[%[[BASE]]]
+  //      CHECK: %[[NEXT_IV:.+]] = arith.addi
+  //      CHECK: %[[SECOND:.+]] = affine.apply #[[$MAP]](%[[NEXT_IV]])[%[[BASE]]]
+  //      CHECK: %[[ZERO:.+]] = arith.constant 0 : index
+  //      CHECK: %[[STRIDE:.+]] = arith.subi %[[SECOND]], %[[FIRST]] : index
+  //      CHECK: call @scale_element_batch(%[[COUNT]], %[[BUFFER]], %[[FIRST]], %[[VALUE]], %[[ZERO]], %[[STRIDE]], %[[ZERO]])
+  //  CHECK-NOT: scf.for
+  scf.for %i = %c0 to %ub step %c4 {
+    %offset = affine.apply affine_map<(d0)[s0] -> (d0 * 2 + s0)>(%i)[%base]
+    func.call @scale_element(%buffer, %offset, %value) : (memref<f32>, index, f32) -> ()
+  }
+  return
+}
+
+// -----
+
+// Tests that loops with other side effects are left as-is.
+
+func.func private @scale_element(%buffer: memref<f32>, %value: f32) attributes {
+  hal.import.batch = "scale_element_batch"
+}
+
+// CHECK-LABEL: @side_effecting_loop
+func.func @side_effecting_loop(%buffer: memref<f32>, %values: memref<?xf32>, %ub: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  // CHECK: scf.for
+  // CHECK:   memref.load
+  // CHECK:   call @scale_element(
+  scf.for %i = %c0 to %ub step %c1 {
+    %value = memref.load %values[%i] : memref<?xf32>
+    func.call @scale_element(%buffer, %value) : (memref<f32>, f32) -> ()
+  }
+  return
+}
+
+// -----
+
+// Tests that arguments that don't step by a fixed amount are not batched.
+
+func.func private @scale_element(%buffer: memref<f32>, %offset: index) attributes {
+  hal.import.batch = "scale_element_batch"
+}
+
+// CHECK-LABEL: @nonlinear_argument
+func.func @nonlinear_argument(%buffer: memref<f32>, %ub: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  // CHECK: scf.for
+  // CHECK:   call @scale_element(
+  scf.for %i = %c0 to %ub step %c1 {
+    %offset = affine.apply affine_map<(d0) -> (d0 floordiv 4)>(%i)
+    func.call @scale_element(%buffer, %offset) : (memref<f32>, index) -> ()
+  }
+  return
+}
+
+// -----
+
+// Tests that imports without a batched form are not batched.
+
+func.func private @scale_element(%buffer: memref<f32>, %offset: index)
+
+// CHECK-LABEL: @unbatched_import
+func.func @unbatched_import(%buffer: memref<f32>, %ub: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  // CHECK: scf.for
+  // CHECK:   call @scale_element(
+  scf.for %i = %c0 to %ub step %c1 {
+    func.call @scale_element(%buffer, %i) : (memref<f32>, index) -> ()
+  }
+  return
+}
@@ -0,0 +1,39 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(hal.executable(hal.executable.variant(iree-llvmcpu-materialize-executable-conditions)))' %s | FileCheck %s
+
+// Tests that specialized variants query each of their CPU features known to
+// the runtime and that features unknown to the runtime or disabled are
+// ignored.
+
+hal.executable private @executable {
+  // CHECK-LABEL: hal.executable.variant public @specialized
+  //  CHECK-NEXT:   hal.executable.condition(%[[DEVICE:.+]]: !hal.device) -> i1 {
+  //   CHECK-DAG:     %[[TRUE:.+]] = arith.constant true
+  //   CHECK-DAG:     %{{.+}}, %[[AVX2:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.cpu" :: "avx2") : i1, i1 = false
+  //       CHECK:     %[[AND0:.+]] = arith.andi %[[TRUE]], %[[AVX2]] : i1
+  //       CHECK:     %{{.+}}, %[[FMA:.+]] = hal.device.query<%[[DEVICE]] : !hal.device> key("hal.cpu" :: "fma") : i1, i1 = false
+  //       CHECK:     %[[AND1:.+]] = arith.andi %[[AND0]], %[[FMA]] : i1
+  //   CHECK-NOT:     "avx512f"
+  //   CHECK-NOT:     "cx16"
+  //       CHECK:     hal.return %[[AND1]] : i1
+  //  CHECK-NEXT:   }
+  hal.executable.variant public @specialized target(<"llvm-cpu", "embedded-elf-x86_64", {
+    cpu = "haswell",
+    cpu_features = "+avx2,+cx16,+fma,-avx512f",
+    select_on_cpu_features = true,
+    target_triple = "x86_64-unknown-unknown-eabi-elf"
+  }>) {
+    builtin.module {}
+  }
+
+  // The generic variant is unconditional so that it can always be used as a
+  // fallback.
+  // CHECK-LABEL: hal.executable.variant public @generic
+  //   CHECK-NOT:   hal.executable.condition
+  hal.executable.variant public @generic target(<"llvm-cpu", "embedded-elf-x86_64", {
+    cpu = "haswell",
+    cpu_features = "+avx2,+fma",
+    target_triple = "x86_64-unknown-unknown-eabi-elf"
+  }>) {
+    builtin.module {}
+  }
+}
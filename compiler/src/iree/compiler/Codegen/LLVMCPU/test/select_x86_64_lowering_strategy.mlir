@@ -30,6 +30,37 @@ func.func @matvec_static() attributes {hal.executable.target = #executable_targe
 
 // -----
 
+// Small workloads are split further when the target declares the number of
+// threads to keep all of them busy.
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {cpu_features = "+avx512f", data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128", native_vector_size = 16 : index, num_threads = 16 : i64, target_triple = "x86_64-unknown-linux-gnu"}>
+func.func @matvec_static_num_threads() attributes {hal.executable.target = #executable_target_embedded_elf_x86_64_} {
+  %cst = arith.constant 0.000000e+00 : f32
+  %c0 = arith.constant 0 : index
+  %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<128x384xf32>>
+  %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<384xf32>>
+  %2 = hal.interface.binding.subspan layout(#pipeline_layout) binding(2) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<128xf32>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [128, 384], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<128x384xf32>> -> tensor<128x384xf32>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0], sizes = [384], strides = [1] : !flow.dispatch.tensor<readonly:tensor<384xf32>> -> tensor<384xf32>
+  %5 = tensor.empty() : tensor<128xf32>
+  %6 = linalg.fill ins(%cst : f32) outs(%5 : tensor<128xf32>) -> tensor<128xf32>
+  %7 = linalg.matvec ins(%3, %4 : tensor<128x384xf32>, tensor<384xf32>) outs(%6 : tensor<128xf32>) -> tensor<128xf32>
+  flow.dispatch.tensor.store %7, %2, offsets = [0], sizes = [128], strides = [1] : tensor<128xf32> -> !flow.dispatch.tensor<writeonly:tensor<128xf32>>
+  return
+}
+
+//   CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[16, 0], [16, 0],
+//       CHECK: func.func @matvec_static_num_threads()
+//       CHECK: linalg.matvec
+//  CHECK-SAME:     lowering_config = #[[CONFIG]]
+
+// -----
+
 #pipeline_layout = #hal.pipeline.layout<constants = 3, bindings = [
   #hal.pipeline.binding<storage_buffer>,
   #hal.pipeline.binding<storage_buffer>,
@@ -203,6 +234,39 @@ func.func @add4D() attributes {hal.executable.target = #executable_target_embedd
 
 // -----
 
+// The distribution tiles are limited to half of the declared L2 cache size.
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128", l2_cache_size = 1048576 : i64, native_vector_size = 16 : index, target_triple = "x86_64-unknown-linux-gnu"}>
+#map = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+func.func @add4D_l2_cache() attributes {hal.executable.target = #executable_target_embedded_elf_x86_64_} {
+  %c0 = arith.constant 0 : index
+  %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<2x256x256x256xf32>>
+  %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<2x256x256x256xf32>>
+  %2 = hal.interface.binding.subspan layout(#pipeline_layout) binding(2) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<2x256x256x256xf32>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0, 0], sizes = [2, 256, 256, 256], strides = [1, 1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<2x256x256x256xf32>> -> tensor<2x256x256x256xf32>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0, 0, 0, 0], sizes = [2, 256, 256, 256], strides = [1, 1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<2x256x256x256xf32>> -> tensor<2x256x256x256xf32>
+  %5 = tensor.empty() : tensor<2x256x256x256xf32>
+  %6 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel", "parallel", "parallel"]} ins(%3, %4 : tensor<2x256x256x256xf32>, tensor<2x256x256x256xf32>) outs(%5 : tensor<2x256x256x256xf32>) {
+  ^bb0(%in: f32, %in_0: f32, %out: f32):
+    %7 = arith.addf %in, %in_0 : f32
+    linalg.yield %7 : f32
+  } -> tensor<2x256x256x256xf32>
+  flow.dispatch.tensor.store %6, %2, offsets = [0, 0, 0, 0], sizes = [2, 256, 256, 256], strides = [1, 1, 1, 1] : tensor<2x256x256x256xf32> -> !flow.dispatch.tensor<writeonly:tensor<2x256x256x256xf32>>
+  return
+}
+
+//  CHECK-DAG: #[[CONFIG:.+]] = #iree_codegen.lowering_config<tile_sizes = {{\[}}[0, 16, 32, 32], [1, 1, 1, 4], [0, 0, 0, 0], [0, 0, 0, 0]]>
+//      CHECK: func.func @add4D_l2_cache()
+//      CHECK: linalg.generic
+// CHECK-SAME:     lowering_config = #[[CONFIG]]
+
+// -----
+
 #pipeline_layout = #hal.pipeline.layout<bindings = [
   #hal.pipeline.binding<storage_buffer>,
   #hal.pipeline.binding<storage_buffer>
@@ -2032,3 +2096,51 @@ func.func @complex_view_as_real() attributes {hal.executable.target = #executabl
 //      CHECK: func.func @complex_view_as_real()
 //      CHECK:   linalg.generic
 // CHECK-SAME:       lowering_config = #[[CONFIG]]
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+#executable_target_embedded_elf_x86_64_ = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {data_layout = "e-m:e-p270:32:32-p271:32:32-p272:64:64-i64:64-f80:128-n8:16:32:64-S128", l2_cache_size = 1048576 : i64, native_vector_size = 16 : index, target_triple = "x86_64-unknown-linux-gnu"}>
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @chained_matmul_relu() attributes {hal.executable.target = #executable_target_embedded_elf_x86_64_} {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<1024x512xf32>>
+  %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<512x256xf32>>
+  %2 = hal.interface.binding.subspan layout(#pipeline_layout) binding(2) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<256x128xf32>>
+  %3 = hal.interface.binding.subspan layout(#pipeline_layout) binding(3) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<1024x128xf32>>
+  %4 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [1024, 512], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<1024x512xf32>> -> tensor<1024x512xf32>
+  %5 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [512, 256], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<512x256xf32>> -> tensor<512x256xf32>
+  %6 = flow.dispatch.tensor.load %2, offsets = [0, 0], sizes = [256, 128], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<256x128xf32>> -> tensor<256x128xf32>
+  %7 = tensor.empty() : tensor<1024x256xf32>
+  %8 = linalg.fill ins(%cst : f32) outs(%7 : tensor<1024x256xf32>) -> tensor<1024x256xf32>
+  %9 = linalg.matmul ins(%4, %5 : tensor<1024x512xf32>, tensor<512x256xf32>) outs(%8 : tensor<1024x256xf32>) -> tensor<1024x256xf32>
+  %10 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%9 : tensor<1024x256xf32>) outs(%7 : tensor<1024x256xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %15 = arith.maximumf %in, %cst : f32
+    linalg.yield %15 : f32
+  } -> tensor<1024x256xf32>
+  %11 = tensor.empty() : tensor<1024x128xf32>
+  %12 = linalg.fill ins(%cst : f32) outs(%11 : tensor<1024x128xf32>) -> tensor<1024x128xf32>
+  %13 = linalg.matmul ins(%10, %6 : tensor<1024x256xf32>, tensor<256x128xf32>) outs(%12 : tensor<1024x128xf32>) -> tensor<1024x128xf32>
+  flow.dispatch.tensor.store %13, %3, offsets = [0, 0], sizes = [1024, 128], strides = [1, 1] : tensor<1024x128xf32> -> !flow.dispatch.tensor<writeonly:tensor<1024x128xf32>>
+  return
+}
+
+// The N dimension of the second matmul is not distributed so that each row
+// block of the intermediate result is computed once, and the first matmul
+// gets its own config.
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<CPUDoubleTilingExpert
+//  CHECK-DAG: #iree_codegen.lowering_config<tile_sizes = {{\[}}[{{[1-9][0-9]*}}, 0, 0]
+//  CHECK-DAG: #iree_codegen.lowering_config<tile_sizes = {{\[}}[{{[1-9][0-9]*}}, 0, 0]
+//      CHECK: func.func @chained_matmul_relu()
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+//      CHECK:   linalg.matmul
+// CHECK-SAME:       lowering_config
+//      CHECK:   linalg.matmul
+// CHECK-SAME:       lowering_config
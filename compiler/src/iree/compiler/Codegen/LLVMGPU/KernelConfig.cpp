@@ -614,6 +614,21 @@ setMatmulVectorDistributionConfig(IREE::GPU::TargetAttr target,
                           targetSubgroupSize, transposedLhs, transposedRhs,
                           /*canUpcastAcc=*/true);
   }
+  if (!schedule && (problem.aType != getElementTypeOrSelf(lhs) ||
+                    problem.bType != getElementTypeOrSelf(rhs))) {
+    // Sub-byte/integer weights extended by a fused producer (e.g. i4 -> f16
+    // dequantization) rarely have an intrinsic on their storage type. Fall
+    // back to an intrinsic on the extended type; the producer is fused into
+    // the consumer tile so the weights are still read in their narrow type
+    // and extended right before they feed the MMA.
+    LDBG("Retrying with extended operand element types");
+    problem.aType = getElementTypeOrSelf(lhs);
+    problem.bType = getElementTypeOrSelf(rhs);
+    schedule =
+        deduceMMASchedule(problem, intrinsics, seeds, maxSharedMemoryBytes,
+                          targetSubgroupSize, transposedLhs, transposedRhs,
+                          /*canUpcastAcc=*/true);
+  }
 
   // Only batch_matmul is supported in the LLVMGPUPadAndVectorDistribute
   // pipeline.
@@ -722,10 +737,31 @@ setMatmulVectorDistributionConfig(IREE::GPU::TargetAttr target,
       targetSubgroupSize, pipelineConfig);
 }
 
+/// Returns the static iteration domain bounds of an attention-like op. All
+/// loops are indexed by either the query or the value.
+template <typename AttentionOpTy>
+static SmallVector<int64_t> getAttentionStaticLoopRanges(AttentionOpTy op) {
+  SmallVector<int64_t> bounds(op.getIterationDomainRank(),
+                              ShapedType::kDynamic);
+  auto fillSizes = [&](Value operand, AffineMap map) {
+    ArrayRef<int64_t> shape = cast<ShapedType>(operand.getType()).getShape();
+    for (auto [size, expr] : llvm::zip_equal(shape, map.getResults())) {
+      bounds[cast<AffineDimExpr>(expr).getPosition()] = size;
+    }
+  };
+  fillSizes(op.getQuery(), op.getQueryMap());
+  fillSizes(op.getValue(), op.getValueMap());
+  return bounds;
+}
+
+/// Sets the vector distribution config of an attention or online_attention
+/// op. The latter is the partial attention of a key/value sequence split and
+/// is configured like an attention op with an extra batch dimension.
+template <typename AttentionOpTy>
 static LogicalResult
 setAttentionVectorDistributionConfig(IREE::GPU::TargetAttr target,
                                      mlir::FunctionOpInterface entryPoint,
-                                     IREE::LinalgExt::AttentionOp op) {
+                                     AttentionOpTy op) {
   if (target.getWgp().getMma().empty())
     return failure();
 
@@ -733,12 +769,7 @@ setAttentionVectorDistributionConfig(IREE::GPU::TargetAttr target,
 
   // Get iteration domain bounds.
   OpBuilder b(op);
-  FailureOr<SmallVector<int64_t>> maybeBounds = op.getStaticLoopRanges();
-  if (failed(maybeBounds)) {
-    return failure();
-  }
-
-  ArrayRef<int64_t> bounds = maybeBounds.value();
+  SmallVector<int64_t> bounds = getAttentionStaticLoopRanges(op);
 
   auto opInfo =
       IREE::LinalgExt::AttentionOpDetail::get(
@@ -873,7 +904,7 @@ setAttentionVectorDistributionConfig(IREE::GPU::TargetAttr target,
   std::array<int64_t, 3> workgroupSize{flatWorkgroupSize, 1, 1};
 
   SmallVector<int64_t> workgroupTileSizes(opInfo.getDomainRank(), 0);
-  SmallVector<int64_t> reductionTileSizes(op.getNumLoops(), 0);
+  SmallVector<int64_t> reductionTileSizes(opInfo.getDomainRank(), 0);
   // Tile all batch dimensions with unit size.
   for (int64_t batch : opInfo.getBatchDims()) {
     workgroupTileSizes[batch] = 1;
@@ -1018,6 +1049,10 @@ setVectorDistributionConfig(IREE::GPU::TargetAttr target,
     LDBG("VectorDistribution: trying to find a suitable attention config");
     return setAttentionVectorDistributionConfig(target, entryPoint, attnOp);
   }
+  if (auto attnOp = dyn_cast<IREE::LinalgExt::OnlineAttentionOp>(computeOp)) {
+    LDBG("VectorDistribution: trying to find a suitable attention config");
+    return setAttentionVectorDistributionConfig(target, entryPoint, attnOp);
+  }
 
   LDBG("VectorDistribution: failed to find a suitable config");
   return failure();
@@ -2123,6 +2158,18 @@ static LogicalResult setRootConfig(IREE::GPU::TargetAttr target,
       return success();
     }
   }
+  // Chained contractions formed into a single dispatch keep the intermediate
+  // result on chip: the tile and fuse pipeline promotes the fused producer
+  // operand to shared memory instead of round tripping through global memory.
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(computeOp)) {
+    OpOperand *chainedOperand = nullptr;
+    if (getChainedContractionProducer(linalgOp, &chainedOperand) &&
+        succeeded(IREE::GPU::setTileAndFuseLoweringConfig(target, entryPointFn,
+                                                          computeOp))) {
+      LDBG("Chained contraction config");
+      return success();
+    }
+  }
   if (succeeded(setVectorDistributionConfig(target, entryPointFn, computeOp))) {
     return success();
   }
@@ -6,6 +6,7 @@
 
 #include "iree/compiler/Codegen/LLVMGPU/Passes.h"
 #include "iree/compiler/Codegen/LLVMGPU/Utils/LLVMGPUUtils.h"
+#include "iree/compiler/Codegen/Utils/GPUUtils.h"
 #include "llvm/ADT/SmallVector.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/Dialect/SCF/Transforms/Transforms.h"
@@ -22,15 +23,30 @@ namespace {
 struct LLVMGPUPrefetchSharedMemoryPass final
     : impl::LLVMGPUPrefetchSharedMemoryPassBase<
           LLVMGPUPrefetchSharedMemoryPass> {
+  using impl::LLVMGPUPrefetchSharedMemoryPassBase<
+      LLVMGPUPrefetchSharedMemoryPass>::LLVMGPUPrefetchSharedMemoryPassBase;
+
   void runOnOperation() override {
     FunctionOpInterface funcOp = getOperation();
     IRRewriter rewriter(funcOp.getContext());
 
+    int64_t stages = numStages;
+    if (stages <= 0) {
+      stages = 2;
+      if (IREE::GPU::TargetAttr target = getGPUTargetAttr(funcOp)) {
+        if (std::optional<int32_t> targetStages =
+                target.getWgp().getPrefetchStages()) {
+          stages = *targetStages;
+        }
+      }
+    }
+
     SmallVector<scf::ForOp> loops;
     funcOp.walk([&loops](scf::ForOp forOp) { loops.push_back(forOp); });
 
     for (scf::ForOp forOp : loops) {
-      FailureOr<scf::ForOp> newLoop = prefetchSharedMemoryCopy(rewriter, forOp);
+      FailureOr<scf::ForOp> newLoop =
+          prefetchSharedMemoryCopy(rewriter, forOp, stages);
       // The only possible failure is the analysis failure, which does not cause
       // the pass to fail. Therefore we discard any failures at this point.
       (void)newLoop;
@@ -371,6 +371,19 @@ void addBarrier(mlir::FunctionOpInterface funcOp, Operation *alloc,
   }
   if (!needBarrier)
     return;
+  // Reuse a barrier already placed right before the alloc, such as the one
+  // inserted for a previous alloc sunk to the same point or the barriers
+  // synchronizing multi-stage pipelines.
+  Operation *prevOp = alloc->getPrevNode();
+  while (isa_and_nonnull<memref::AllocOp, memref::ViewOp,
+                         arith::ConstantOp>(prevOp)) {
+    prevOp = prevOp->getPrevNode();
+  }
+  if (isa_and_nonnull<gpu::BarrierOp>(prevOp) &&
+      (!hasAsyncCopies ||
+       isa_and_nonnull<nvgpu::DeviceAsyncWaitOp>(prevOp->getPrevNode()))) {
+    return;
+  }
   OpBuilder builder(alloc);
   // TODO: make it a option if needed.
   if (hasAsyncCopies) {
@@ -393,23 +406,41 @@ void packSharedMemoryAlloc(mlir::FunctionOpInterface funcOp) {
   });
   // First sink the alloc as low as possible in the CFG.
   sinkOpsInCFG(allocs, dominators);
-  SmallVector<AliasGroup> aliasGroups;
-  analyseAllocsForPacking(funcOp, allocs, aliasGroups);
-  // If there is 1 or less alias group there is nothing to do.
-  if (aliasGroups.size() <= 1)
+  // Offsets are aligned to allow 128-bit vector accesses on every buffer.
+  FailureOr<SmallVector<PackedAlloc>> packedAllocs =
+      computePackedAllocOffsets(funcOp, allocs, /*alignment=*/16);
+  if (failed(packedAllocs))
+    return;
+  auto overlapsInMemory = [](const PackedAlloc &lhs, const PackedAlloc &rhs) {
+    return lhs.offset < rhs.offset + rhs.size &&
+           rhs.offset < lhs.offset + lhs.size;
+  };
+  // If no allocations reuse memory there is nothing to do.
+  bool hasReuse = false;
+  for (auto [i, lhs] : llvm::enumerate(*packedAllocs)) {
+    for (const PackedAlloc &rhs : ArrayRef(*packedAllocs).drop_front(i + 1)) {
+      hasReuse |= overlapsInMemory(lhs, rhs);
+    }
+  }
+  if (!hasReuse)
     return;
 
-  // Pack all the allocations into one i8 alloc.
   // We may need to add extra barriers to make sure we are done writting or
-  // reading from the previous alias group before starting a new one.
-  for (size_t i = 0; i < aliasGroups.size(); i++) {
-    for (Operation *alloc : aliasGroups[i]) {
-      addBarrier(funcOp, alloc, aliasGroups[i]);
+  // reading from the allocations whose memory is reused before starting to use
+  // it. Allocations that do not overlap in memory never need to be separated.
+  for (const PackedAlloc &packed : *packedAllocs) {
+    AliasGroup disjointAllocs;
+    for (const PackedAlloc &other : *packedAllocs) {
+      if (&other == &packed || !overlapsInMemory(packed, other)) {
+        disjointAllocs.push_back(other.alloc);
+      }
     }
+    addBarrier(funcOp, packed.alloc, disjointAllocs);
   }
 
+  // Pack all the allocations into one i8 alloc.
   OpBuilder builder(funcOp.getContext());
-  packAllocs(builder, funcOp, aliasGroups);
+  packAllocs(builder, funcOp, *packedAllocs);
 }
 
 } // namespace mlir::iree_compiler
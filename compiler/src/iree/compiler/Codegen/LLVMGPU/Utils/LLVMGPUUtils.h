@@ -25,24 +25,29 @@ void doLayoutAnalysisAndDistribution(RewriterBase &rewriter,
 /// Function to reorder transposes and elementwise ops.
 void reorderTranspose(RewriterBase &rewriter, mlir::FunctionOpInterface funcOp);
 
-/// Look for allocs in shared memory space with overlapping liveness,
-/// group them, and then pack all the allocations in each group into one i8
-/// alloc.
+/// Pack all allocs in shared memory space into one i8 alloc where allocs whose
+/// liveness does not overlap anywhere in the function share memory.
 ///
-/// Also adds barriers to make sure we are done writing/reading
-/// from the previous alias group before starting a new one.
+/// Also adds barriers to make sure we are done writing/reading from an alloc
+/// before another alloc starts reusing its memory. Existing barriers right
+/// before the reusing alloc are reused instead of adding new ones.
 void packSharedMemoryAlloc(mlir::FunctionOpInterface funcOp);
 
 // Add patterns to distribute contractions to MFMA ops.
 void populateAMDGPUDistributionPatterns(RewritePatternSet &patterns);
 
-// Prefetches data written to shared memory for the next iteration. Returns the
-// new loop on success or failure when the `forOp` is not supported.
+// Prefetches data written to shared memory for the next iteration. With more
+// than 2 `numStages`, the global memory reads of the following iterations are
+// issued ahead and kept in registers such that `numStages` iterations are in
+// flight. Returns the new loop on success or failure when the `forOp` is not
+// supported.
 FailureOr<scf::ForOp> prefetchSharedMemoryCopy(RewriterBase &rewriter,
-                                               scf::ForOp forOp);
+                                               scf::ForOp forOp,
+                                               int64_t numStages = 2);
 
 /// Insert barriers and wait operations if there are allocs of a different alias
-/// group before the given alloc.
+/// group before the given alloc. Nothing is inserted if the alloc is already
+/// preceded by a barrier.
 void addBarrier(mlir::FunctionOpInterface funcOp, Operation *alloc,
                 ArrayRef<Operation *> aliasGroup, bool hasAsyncCopies = true);
 
@@ -9,6 +9,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
 #include "llvm/ADT/APInt.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/SmallVectorExtras.h"
 #include "llvm/Support/Debug.h"
@@ -49,16 +50,21 @@ std::optional<int64_t> getConstantIndex(Value value) {
 class LoopPrefetcher {
 public:
   /// Creates an instance that plans the given scf.for |op| to be ready for
-  /// prefetching. Returns failure if unable to support the given |op|.
-  static FailureOr<LoopPrefetcher> get(scf::ForOp op) {
+  /// prefetching with |numStages| stages. Returns failure if unable to support
+  /// the given |op|.
+  static FailureOr<LoopPrefetcher> get(scf::ForOp op, int64_t numStages) {
     if (!op.getOps<scf::ForOp>().empty()) {
       LDBG("Loop prefetcher does not support nested loops yet");
       return failure();
     }
+    if (numStages < 2) {
+      LDBG("Loop prefetcher requires at least 2 stages");
+      return failure();
+    }
 
     LoopPrefetcher prefetcher;
-    prefetcher.mapping = SmallVector<IRMapping>(4);
     prefetcher.forOp = op;
+    prefetcher.numStages = numStages;
     prefetcher.lb = prefetcher.ub = prefetcher.step = 0;
 
     if (failed(prefetcher.initializeLoopInfo())) {
@@ -80,20 +86,34 @@ public:
     Value zero = rewriter.create<arith::ConstantIndexOp>(loc, lb);
     // Directly write in the prologue and use the shared memory to communicate
     // data instead of the loop carried values. Read (0)
-    emitRead(mapping[0], rewriter, zero);
+    IRMapping mapping;
+    emitRead(mapping, rewriter, zero);
     // Write(0)
-    emitWrite(mapping[0], rewriter, zero);
+    emitWrite(mapping, rewriter, zero);
+
+    // Read (1) to Read (numStages - 2) are kept in registers and carried
+    // through the main loop until they are written to shared memory.
+    for (int64_t stage = 1; stage < numStages - 1; ++stage) {
+      Value iv =
+          rewriter.create<arith::ConstantIndexOp>(loc, lb + stage * step);
+      IRMapping stageMapping;
+      emitRead(stageMapping, rewriter, iv);
+      for (Value value : carriedReads) {
+        prologueReads.push_back(stageMapping.lookup(value));
+      }
+    }
   }
 
   /// Emits the main pipelined loop structure.
   scf::ForOp createKernelLoop(RewriterBase &rewriter) {
     Location loc = forOp.getLoc();
-    int64_t newUpperBound = ub - step;
+    int64_t newUpperBound = ub - (numStages - 1) * step;
     auto newUb = rewriter.create<arith::ConstantIndexOp>(loc, newUpperBound);
 
     // Keep original iter args and then add some for what's being loaded to
     // registers.
     auto iterArgs = llvm::to_vector_of<Value>(forOp.getInitArgs());
+    llvm::append_range(iterArgs, prologueReads);
     auto newForOp = rewriter.create<scf::ForOp>(
         loc, forOp.getLowerBound(), newUb, forOp.getStep(), iterArgs);
 
@@ -112,20 +132,45 @@ public:
     Value indVar = newForOp.getInductionVar();
     Value increment = rewriter.create<arith::ConstantIndexOp>(loc, step);
     Value iPlusOne = rewriter.create<arith::AddIOp>(loc, indVar, increment);
+    Value iPlusDistance = iPlusOne;
+    if (numStages > 2) {
+      Value distance =
+          rewriter.create<arith::ConstantIndexOp>(loc, (numStages - 1) * step);
+      iPlusDistance = rewriter.create<arith::AddIOp>(loc, indVar, distance);
+    }
 
-    for (int i = 0; i < 3; ++i) {
-      for (auto [idx, arg] : llvm::enumerate(forOp.getRegionIterArgs())) {
-        mapping[i].map(arg, newForOp.getRegionIterArgs()[idx]);
-      }
+    unsigned numIterArgs = forOp.getNumRegionIterArgs();
+    ValueRange newIterArgs = newForOp.getRegionIterArgs();
+    IRMapping readMapping, computeMapping;
+    for (auto [idx, arg] : llvm::enumerate(forOp.getRegionIterArgs())) {
+      readMapping.map(arg, newIterArgs[idx]);
+      computeMapping.map(arg, newIterArgs[idx]);
     }
 
-    emitRead(mapping[1], rewriter, iPlusOne);
+    emitRead(readMapping, rewriter, iPlusDistance);
     emitBarrier(loc, rewriter);
-    emitCompute(mapping[0], rewriter, indVar);
+    SmallVector<Value> results = emitCompute(computeMapping, rewriter, indVar);
     emitBarrier(loc, rewriter);
-    emitWrite(mapping[1], rewriter, iPlusOne);
-    updateYield(mapping[0], rewriter);
-    return;
+    if (numStages == 2) {
+      emitWrite(readMapping, rewriter, iPlusOne);
+    } else {
+      // The data of the next iteration is in the first group of carried reads.
+      IRMapping writeMapping;
+      for (auto [idx, value] : llvm::enumerate(carriedReads)) {
+        writeMapping.map(value, newIterArgs[numIterArgs + idx]);
+      }
+      emitWrite(writeMapping, rewriter, iPlusOne);
+    }
+
+    // Shift the carried reads by one iteration and append the new reads.
+    if (numStages > 2) {
+      llvm::append_range(
+          results, newIterArgs.drop_front(numIterArgs + carriedReads.size()));
+      for (Value value : carriedReads) {
+        results.push_back(readMapping.lookup(value));
+      }
+    }
+    rewriter.create<scf::YieldOp>(loc, results);
   }
 
   // Emits the epilogue after the main pipelined loop and returns the final
@@ -133,16 +178,40 @@ public:
   SmallVector<Value> emitEpilogue(RewriterBase &rewriter, scf::ForOp newForOp) {
     rewriter.setInsertionPointAfter(newForOp);
     Location loc = forOp.getLoc();
-    Value nMinusOne =
-        rewriter.create<arith::ConstantIndexOp>(loc, ub - 1 * step);
+    unsigned numIterArgs = forOp.getNumRegionIterArgs();
+    size_t numCarried = carriedReads.size();
+
+    // The last numStages - 1 iterations are left. The first of them is already
+    // in shared memory and the others are in the carried reads.
+    SmallVector<Value> results =
+        llvm::to_vector(newForOp.getResults().take_front(numIterArgs));
+    for (int64_t stage = 0; stage < numStages - 1; ++stage) {
+      int64_t iteration = ub - (numStages - 1 - stage) * step;
+      Value iv = rewriter.create<arith::ConstantIndexOp>(loc, iteration);
+
+      // Map iter_args to results of the previous iteration.
+      IRMapping computeMapping;
+      for (unsigned i = 0; i != numIterArgs; ++i) {
+        computeMapping.map(forOp.getRegionIterArg(i), results[i]);
+      }
 
-    // Map iter_args to results of newForOp.
-    for (unsigned i = 0, e = forOp->getNumResults(); i != e; ++i) {
-      mapping[0].map(forOp.getRegionIterArg(i), newForOp.getResult(i));
-    }
+      emitBarrier(loc, rewriter);
+      results = emitCompute(computeMapping, rewriter, iv);
+      if (stage == numStages - 2) {
+        break;
+      }
 
-    emitBarrier(loc, rewriter);
-    return emitCompute(mapping[0], rewriter, nMinusOne);
+      emitBarrier(loc, rewriter);
+      IRMapping writeMapping;
+      for (auto [idx, value] : llvm::enumerate(carriedReads)) {
+        writeMapping.map(value, newForOp.getResult(numIterArgs +
+                                                   stage * numCarried + idx));
+      }
+      Value nextIv =
+          rewriter.create<arith::ConstantIndexOp>(loc, iteration + step);
+      emitWrite(writeMapping, rewriter, nextIv);
+    }
+    return results;
   }
 
 private:
@@ -157,8 +226,11 @@ private:
     ub = *ubCst;
     step = *stepCst;
 
-    int64_t numIters = llvm::divideCeil(ub - lb, step);
-    if (numIters <= 2)
+    if ((ub - lb) % step != 0)
+      return failure();
+
+    int64_t numIters = (ub - lb) / step;
+    if (numIters <= numStages)
       return failure();
 
     return success();
@@ -234,6 +306,21 @@ private:
       }
     }
 
+    // Collect the values read in the read stage and written in the write stage.
+    // These are carried in registers between the stages.
+    llvm::SetVector<Value> writtenReads;
+    for (Operation *op : writeStage) {
+      op->walk([&](Operation *nested) {
+        for (Value operand : nested->getOperands()) {
+          auto read = operand.getDefiningOp<vector::TransferReadOp>();
+          if (read && readDependencies.contains(read)) {
+            writtenReads.insert(operand);
+          }
+        }
+      });
+    }
+    carriedReads = writtenReads.takeVector();
+
     LLVM_DEBUG({
       // Stages cannot have overlapping operations.
       llvm::dbgs() << "--- Read Stage ---\n";
@@ -336,7 +423,7 @@ private:
         // On yield, return the operands of the yield converted.
         results =
             llvm::map_to_vector<4>(yieldOp.getOperands(), [&](Value operand) {
-              return mapping.lookup(operand);
+              return mapping.lookupOrDefault(operand);
             });
         break;
       }
@@ -358,25 +445,11 @@ private:
     return results;
   }
 
-  void updateYield(IRMapping &mapping, RewriterBase &rewriter) {
-    for (Operation *op : computeStage) {
-      if (auto yield = dyn_cast<scf::YieldOp>(op)) {
-        cloneAndUpdateOperands(rewriter, yield, [&](OpOperand *newOperand) {
-          if (mapping.contains(newOperand->get())) {
-            newOperand->set(mapping.lookup(newOperand->get()));
-          }
-        });
-
-        break;
-      }
-    }
-  }
-
 private:
-  // Mapping for each pipelined stage.
-  SmallVector<IRMapping, 4> mapping;
   // The original scf.for loop to prefetch shared memory copy from.
   scf::ForOp forOp;
+  // Number of iterations in flight, including the one being computed.
+  int64_t numStages;
   // Original static loop range and step.
   int64_t lb, ub, step;
 
@@ -384,15 +457,22 @@ private:
   SmallVector<Operation *> readStage;
   SmallVector<Operation *> writeStage;
   SmallVector<Operation *> computeStage;
+
+  // Results of read stage ops that are used by the write stage. Iterations
+  // read ahead of the one written to shared memory keep these in registers.
+  SmallVector<Value> carriedReads;
+  // Carried reads of the iterations read in the prologue.
+  SmallVector<Value> prologueReads;
 };
 
 } // namespace
 
 FailureOr<scf::ForOp> prefetchSharedMemoryCopy(RewriterBase &rewriter,
-                                               scf::ForOp forOp) {
+                                               scf::ForOp forOp,
+                                               int64_t numStages) {
   rewriter.setInsertionPoint(forOp);
 
-  auto prefetcherOr = LoopPrefetcher::get(forOp);
+  auto prefetcherOr = LoopPrefetcher::get(forOp, numStages);
   if (failed(prefetcherOr))
     return failure();
   LoopPrefetcher &prefetcher = *prefetcherOr;
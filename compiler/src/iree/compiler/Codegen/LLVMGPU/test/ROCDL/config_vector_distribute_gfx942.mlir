@@ -403,3 +403,56 @@ func.func @attention_large_head_dim_shared_mem() {
 // CHECK-SAME:                           subgroup_n_count = 1
 // CHECK-SAME:                           reduction =  [0, 0, 16, 0]
 // CHECK-SAME:                           workgroup =  [32, 0, 0, 32]
+
+// -----
+
+// CHECK:      #iree_codegen.translation_info<pipeline = LLVMGPUVectorDistribute
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d1)>
+#map2 = affine_map<(d0, d1, d2) -> (d0, d2)>
+#map3 = affine_map<(d0, d1, d2) -> (d2, d1)>
+#map4 = affine_map<(d0, d1, d2) -> (d0, d1)>
+func.func @dequant_i4_matmul() {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<1024x4096xf16>>
+  %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<4096x1024xi4>>
+  %2 = hal.interface.binding.subspan layout(#pipeline_layout) binding(2) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<1024xf16>>
+  %3 = hal.interface.binding.subspan layout(#pipeline_layout) binding(3) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<1024x1024xf32>>
+  %4 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [1024, 4096], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<1024x4096xf16>> -> tensor<1024x4096xf16>
+  %5 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [4096, 1024], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<4096x1024xi4>> -> tensor<4096x1024xi4>
+  %6 = flow.dispatch.tensor.load %2, offsets = [0], sizes = [1024], strides = [1] : !flow.dispatch.tensor<readonly:tensor<1024xf16>> -> tensor<1024xf16>
+  %7 = tensor.empty() : tensor<4096x1024xf16>
+  %8 = linalg.generic {indexing_maps = [#map, #map1, #map], iterator_types = ["parallel", "parallel"]} ins(%5, %6 : tensor<4096x1024xi4>, tensor<1024xf16>) outs(%7 : tensor<4096x1024xf16>) {
+  ^bb0(%in: i4, %in_0: f16, %out: f16):
+    %13 = arith.extui %in : i4 to i32
+    %14 = arith.uitofp %13 : i32 to f16
+    %15 = arith.mulf %14, %in_0 : f16
+    linalg.yield %15 : f16
+  } -> tensor<4096x1024xf16>
+  %9 = tensor.empty() : tensor<1024x1024xf32>
+  %10 = linalg.fill ins(%cst : f32) outs(%9 : tensor<1024x1024xf32>) -> tensor<1024x1024xf32>
+  %11 = linalg.generic {indexing_maps = [#map2, #map3, #map4], iterator_types = ["parallel", "parallel", "reduction"]} ins(%4, %8 : tensor<1024x4096xf16>, tensor<4096x1024xf16>) outs(%10 : tensor<1024x1024xf32>) {
+  ^bb0(%in: f16, %in_0: f16, %out: f32):
+    %13 = arith.extf %in : f16 to f32
+    %14 = arith.extf %in_0 : f16 to f32
+    %15 = arith.mulf %13, %14 : f32
+    %16 = arith.addf %15, %out : f32
+    linalg.yield %16 : f32
+  } -> tensor<1024x1024xf32>
+  flow.dispatch.tensor.store %11, %3, offsets = [0, 0], sizes = [1024, 1024], strides = [1, 1] : tensor<1024x1024xf32> -> !flow.dispatch.tensor<writeonly:tensor<1024x1024xf32>>
+  return
+}
+
+// Dequantized sub-byte weights use an intrinsic on the extended f16 type.
+
+// CHECK-LABEL: func.func @dequant_i4_matmul()
+// CHECK:         linalg.generic {{.*}}lowering_config =  #iree_gpu.lowering_config
+// CHECK-SAME:                           mma_kind = #iree_gpu.mma_layout<MFMA_F32_16x16x16_F16>
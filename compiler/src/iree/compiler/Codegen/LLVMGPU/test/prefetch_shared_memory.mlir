@@ -1,4 +1,5 @@
 // RUN: iree-opt -pass-pipeline="builtin.module(func.func(iree-llvmgpu-prefetch-shared-memory),cse,canonicalize)" %s | FileCheck %s
+// RUN: iree-opt -pass-pipeline="builtin.module(func.func(iree-llvmgpu-prefetch-shared-memory{num-stages=3}),cse,canonicalize)" %s | FileCheck %s --check-prefix=STAGES3
 
 // CHECK-LABEL: @prefetch_add
 // CHECK-SAME: (%[[GLOBAL:.*]]: memref<128xf32>)
@@ -40,6 +41,39 @@ func.func @prefetch_add(%arg0: memref<128xf32>) {
   return
 }
 
+// With 3 stages the global memory read of the iteration after next is issued
+// in the loop and carried in registers until it is written to shared memory.
+
+// STAGES3-LABEL: @prefetch_add
+// STAGES3-SAME: (%[[GLOBAL:.*]]: memref<128xf32>)
+// STAGES3-DAG: %[[CST:.*]] = arith.constant dense<0.000000e+00> : vector<1xf32>
+// STAGES3-DAG: %[[C126:.*]] = arith.constant 126 : index
+// STAGES3-DAG: %[[C2:.*]] = arith.constant 2 : index
+// STAGES3-DAG: %[[C1:.*]] = arith.constant 1 : index
+// STAGES3-DAG: %[[C0:.*]] = arith.constant 0 : index
+// STAGES3-DAG: %[[SHARED:.*]] = memref.alloc() : memref<1xf32, #gpu.address_space<workgroup>>
+// STAGES3: %[[PRO_READ0:.*]] = vector.transfer_read %[[GLOBAL]][%[[C0]]]
+// STAGES3: vector.transfer_write %[[PRO_READ0]], %[[SHARED]]
+// STAGES3: %[[PRO_READ1:.*]] = vector.transfer_read %[[GLOBAL]][%[[C1]]]
+// STAGES3: %[[OUT:.*]]:2 = scf.for %[[IV:.*]] = %[[C0]] to %[[C126]] step %[[C1]] iter_args(%[[ARG:.*]] = %[[CST]], %[[NEXT:.*]] = %[[PRO_READ1]])
+// STAGES3:   %[[IVPLUS2:.*]] = arith.addi %[[IV]], %[[C2]]
+// STAGES3:   %[[KER_READ:.*]] = vector.transfer_read %[[GLOBAL]][%[[IVPLUS2]]]
+// STAGES3:   gpu.barrier
+// STAGES3:   %[[COMPUTE_READ:.*]] = vector.transfer_read %[[SHARED]][%[[C0]]]
+// STAGES3:   %[[COMPUTE:.*]] = arith.addf %[[COMPUTE_READ]], %[[ARG]]
+// STAGES3:   gpu.barrier
+// STAGES3:   vector.transfer_write %[[NEXT]], %[[SHARED]]
+// STAGES3:   scf.yield %[[COMPUTE]], %[[KER_READ]]
+// STAGES3: gpu.barrier
+// STAGES3: %[[EPI_READ0:.*]] = vector.transfer_read %[[SHARED]][%[[C0]]]
+// STAGES3: %[[EPI_COMPUTE0:.*]] = arith.addf %[[EPI_READ0]], %[[OUT]]#0
+// STAGES3: gpu.barrier
+// STAGES3: vector.transfer_write %[[OUT]]#1, %[[SHARED]]
+// STAGES3: gpu.barrier
+// STAGES3: %[[EPI_READ1:.*]] = vector.transfer_read %[[SHARED]][%[[C0]]]
+// STAGES3: %[[EPI_COMPUTE1:.*]] = arith.addf %[[EPI_READ1]], %[[EPI_COMPUTE0]]
+// STAGES3: vector.transfer_write %[[EPI_COMPUTE1]], %[[GLOBAL]][%[[C0]]]
+
 // CHECK-LABEL: @prefetch_multi_scf_return
 // CHECK-SAME: (%[[GLOBAL:.*]]: memref<128xf32>)
 func.func @prefetch_multi_scf_return(%arg0: memref<128xf32>) -> (vector<1xf32>, vector<1xf32>) {
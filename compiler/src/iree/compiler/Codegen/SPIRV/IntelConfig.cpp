@@ -0,0 +1,90 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//===- IntelConfig.h - Intel CodeGen Configurations -----------------------===//
+//
+// This file contains CodeGen configurations for Intel GPUs.
+//
+//===----------------------------------------------------------------------===//
+
+#include "iree/compiler/Codegen/SPIRV/KernelConfig.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+
+#define DEBUG_TYPE "iree-spirv-intel-config"
+
+namespace mlir::iree_compiler::detail {
+
+constexpr unsigned IntelSimtSoftwarePipelineDepth = 2;
+constexpr unsigned IntelSimtSoftwarePipelineStoreStage = 0;
+
+constexpr unsigned IntelCoopMatrixSoftwarePipelineDepth = 2;
+constexpr unsigned IntelCoopMatrixSoftwarePipelineStoreStage = 0;
+
+constexpr unsigned IntelNumSubgroupsPerWorkgroup = 4;
+// The number of tiles along M and N dimensions per workgroup.
+constexpr unsigned IntelNumMNTilesPerSubgroup = 4;
+
+static LogicalResult setIntelMatmulConfig(linalg::LinalgOp op,
+                                          IREE::GPU::TargetAttr target) {
+  if (succeeded(setCooperativeMatrixConfig(
+          target, op, IntelNumSubgroupsPerWorkgroup, IntelNumMNTilesPerSubgroup,
+          IntelCoopMatrixSoftwarePipelineDepth,
+          IntelCoopMatrixSoftwarePipelineStoreStage)))
+    return success();
+
+  const int subgroupSize = target.getPreferredSubgroupSize();
+  const std::array<int64_t, 2> workgroupXY = {subgroupSize, 8};
+  std::array<int64_t, 3> threadMNK;
+  auto inputType =
+      llvm::cast<ShapedType>(op.getDpsInputOperand(0)->get().getType());
+  if (IREE::Util::getTypeBitWidth(inputType.getElementType()) == 16) {
+    threadMNK = {8, 8, 32};
+  } else {
+    threadMNK = {4, 4, 16};
+  }
+  return setMatmulOpConfig(target, op, workgroupXY, threadMNK,
+                           /*enablePromotion=*/true,
+                           IntelSimtSoftwarePipelineDepth,
+                           IntelSimtSoftwarePipelineStoreStage);
+}
+
+// Xe-HPG architecture:
+//
+// Each Xe-core contains 16 Xe Vector Engines (XVE) and 16 Xe Matrix Extension
+// (XMX) engines sharing a 192KB L1 cache/shared local memory.
+//
+// * 8 hardware threads per XVE, each with 128 32-bit registers of SIMD8 width
+// * Max 64KB shared local memory per workgroup
+// * Subgroup size of 8, 16, or 32 with 16 preferred by drivers
+
+LogicalResult setIntelCodeGenConfig(IREE::GPU::TargetAttr target,
+                                    Operation *rootOp) {
+  int subgroupSize = target.getPreferredSubgroupSize();
+
+  if (auto linalgOp = dyn_cast<linalg::LinalgOp>(rootOp)) {
+    if (isMatmulOrBatchMatmul(linalgOp))
+      return setIntelMatmulConfig(linalgOp, target);
+  }
+
+  if (auto convOp = dyn_cast<linalg::ConvolutionOpInterface>(rootOp)) {
+    // Use the result type in case of larger bitwidth for accumulators.
+    auto type = cast<ShapedType>(convOp->getResult(0).getType());
+    const int bitwidth = type.getElementTypeBitWidth();
+    if (bitwidth > 32)
+      return failure();
+    const int multipler = 32 / bitwidth;
+    bool hasPaddedInput = convOp.image().getDefiningOp<tensor::PadOp>();
+    const int bestTilingFactor = (hasPaddedInput ? 8 : 16) * multipler;
+    return setConvOpConfig(cast<linalg::LinalgOp>(rootOp), subgroupSize,
+                           bestTilingFactor);
+  }
+
+  return failure();
+}
+
+} // namespace mlir::iree_compiler::detail
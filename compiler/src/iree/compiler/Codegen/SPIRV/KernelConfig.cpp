@@ -1182,14 +1182,24 @@ static LogicalResult setReductionConfig(IREE::GPU::TargetAttr target,
   // workgroup processes all elements in reduction dimensions. Need to make sure
   // the workgroup size we use can divide the total reduction size, and it's
   // also within hardware limitations.
+  //
+  // Pick the largest multiple of the subgroup size dividing the reduction
+  // instead of the greatest common divisor with the limit--the latter
+  // degenerates to a single subgroup for non-power-of-two reductions like
+  // vocabulary sizes, serializing most of the reduction in each thread.
+  auto getLargestGroupSizeDividing = [&](int64_t size, int64_t limit) {
+    for (int64_t candidate = limit - limit % subgroupSize;
+         candidate > subgroupSize; candidate -= subgroupSize) {
+      if (size % candidate == 0)
+        return candidate;
+    }
+    return int64_t(subgroupSize);
+  };
   const int64_t maxWorkgroupSize =
       target.getWgp().getMaxThreadCountPerWorkgroup();
   int64_t groupSize = reductionSize / vectorSize;
-  if (groupSize > maxWorkgroupSize) {
-    groupSize = GreatestCommonDivisor(APInt(64, uint64_t(groupSize)),
-                                      APInt(64, uint64_t(maxWorkgroupSize)))
-                    .getZExtValue();
-  }
+  if (groupSize > maxWorkgroupSize)
+    groupSize = getLargestGroupSizeDividing(groupSize, maxWorkgroupSize);
 
   // Then we need to strike a balance--
   // 1) parallel dimensions are distributed to workgroups. If there are many
@@ -1222,8 +1232,14 @@ static LogicalResult setReductionConfig(IREE::GPU::TargetAttr target,
   // First, do warp reductions along multiple subgroups.
   // Second, reduce results from multiple subgroups using single warp reduce.
   // The final warp reduce requires subgroup count <= subgroup size to work.
-  if ((groupSize / subgroupSize) > subgroupSize)
-    return failure();
+  // This commonly happens on mobile GPUs with small subgroups (e.g., Mali with
+  // 16 lanes) for reductions over 4K+ elements. Instead of falling back to a
+  // serial reduction per row, cap the subgroup count and let each thread loop
+  // over more vectors before the subgroup reductions.
+  if ((groupSize / subgroupSize) > subgroupSize) {
+    groupSize =
+        getLargestGroupSizeDividing(groupSize, subgroupSize * subgroupSize);
+  }
 
   std::array<int64_t, 3> workgroupSize = {groupSize, 1, 1};
 
@@ -1510,6 +1526,9 @@ static LogicalResult setSPIRVOpConfig(IREE::GPU::TargetAttr target,
     return success();
   if (target.isARM() && succeeded(detail::setMaliCodeGenConfig(target, rootOp)))
     return success();
+  if (target.isIntel() &&
+      succeeded(detail::setIntelCodeGenConfig(target, rootOp)))
+    return success();
   if (target.isNVIDIA() &&
       succeeded(detail::setNVIDIACodeGenConfig(target, rootOp)))
     return success();
@@ -11,6 +11,9 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <limits>
+#include <optional>
+
 #include "iree/compiler/Codegen/Dialect/GPU/IR/IREEGPUAttrs.h"
 #include "iree/compiler/Codegen/SPIRV/Passes.h"
 #include "iree/compiler/Codegen/Utils/GPUUtils.h"
@@ -19,6 +22,9 @@
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Debug.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/DataFlow/IntegerRangeAnalysis.h"
+#include "mlir/Analysis/DataFlowFramework.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Arith/Transforms/Passes.h"
 #include "mlir/Dialect/Arith/Transforms/WideIntEmulationConverter.h"
@@ -143,6 +149,146 @@ struct FlattenElementwisePattern final : RewritePattern {
   }
 };
 
+//===----------------------------------------------------------------------===//
+// i64 narrowing
+//===----------------------------------------------------------------------===//
+
+// Returns the known signed range of `value` if it is an i64 scalar or vector
+// and has been analyzed.
+static std::optional<ConstantIntRanges> getI64Range(DataFlowSolver &solver,
+                                                    Value value) {
+  if (!getElementTypeOrSelf(value.getType()).isInteger(64))
+    return std::nullopt;
+  auto *lattice =
+      solver.lookupState<dataflow::IntegerValueRangeLattice>(value);
+  if (!lattice || lattice->getValue().isUninitialized())
+    return std::nullopt;
+  return lattice->getValue().getValue();
+}
+
+// Returns true if `value` is known to be representable as a signed i32. If
+// `nonNegative` is set the value must also be known non-negative so that
+// unsigned semantics are preserved.
+static bool fitsInI32(DataFlowSolver &solver, Value value, bool nonNegative) {
+  std::optional<ConstantIntRanges> range = getI64Range(solver, value);
+  if (!range)
+    return false;
+  int64_t minValue = nonNegative ? 0 : std::numeric_limits<int32_t>::min();
+  return range->smin().getSExtValue() >= minValue &&
+         range->smax().getSExtValue() <= std::numeric_limits<int32_t>::max();
+}
+
+static bool isUnsignedOp(Operation *op) {
+  if (auto cmpOp = dyn_cast<arith::CmpIOp>(op)) {
+    switch (cmpOp.getPredicate()) {
+    case arith::CmpIPredicate::ult:
+    case arith::CmpIPredicate::ule:
+    case arith::CmpIPredicate::ugt:
+    case arith::CmpIPredicate::uge:
+      return true;
+    default:
+      return false;
+    }
+  }
+  return isa<arith::DivUIOp, arith::RemUIOp, arith::MinUIOp, arith::MaxUIOp>(
+      op);
+}
+
+// Returns true if all i64 operands and results of `op` are proven to fit in
+// i32 such that computing it in i32 and sign extending gives the same result.
+static bool canNarrowToI32(DataFlowSolver &solver, Operation *op) {
+  if (!isa<arith::AddIOp, arith::SubIOp, arith::MulIOp, arith::DivSIOp,
+           arith::DivUIOp, arith::RemSIOp, arith::RemUIOp, arith::MinSIOp,
+           arith::MaxSIOp, arith::MinUIOp, arith::MaxUIOp, arith::AndIOp,
+           arith::OrIOp, arith::XOrIOp, arith::CmpIOp>(op))
+    return false;
+  bool nonNegative = isUnsignedOp(op);
+  if (llvm::any_of(op->getOperands(), [&](Value operand) {
+        return !fitsInI32(solver, operand, nonNegative);
+      }))
+    return false;
+  // Comparison results are i1; everything else produces an i64 that must
+  // also fit to rule out overflow in the narrowed computation.
+  if (isa<arith::CmpIOp>(op))
+    return true;
+  return llvm::all_of(op->getResults(), [&](Value result) {
+    return fitsInI32(solver, result, /*nonNegative=*/false);
+  });
+}
+
+// Returns `type` with its i64 element type replaced by i32.
+static Type getNarrowedType(Type type) {
+  auto i32Type = IntegerType::get(type.getContext(), 32);
+  if (auto vectorType = dyn_cast<VectorType>(type))
+    return vectorType.clone(i32Type);
+  return i32Type;
+}
+
+// Demotes i64 arithmetic that integer range analysis proves to fit in i32 so
+// that it never needs to be emulated. Each narrowed op is rewritten as
+//
+//   %a32 = arith.trunci %a : i64 to i32
+//   %b32 = arith.trunci %b : i64 to i32
+//   %r32 = arith.addi %a32, %b32 : i32
+//   %r = arith.extsi %r32 : i32 to i64
+//
+// with the extsi/trunci pairs between narrowed ops folded away afterwards.
+// Index computations in gathers and embeddings are typically i64 in the input
+// program but bounded by tensor sizes, so most of them disappear.
+static LogicalResult narrowI64Arithmetic(FunctionOpInterface funcOp) {
+  DataFlowSolver solver;
+  solver.load<dataflow::DeadCodeAnalysis>();
+  solver.load<dataflow::IntegerRangeAnalysis>();
+  if (failed(solver.initializeAndRun(funcOp)))
+    return failure();
+
+  SmallVector<Operation *> candidates;
+  funcOp.walk([&](Operation *op) {
+    if (canNarrowToI32(solver, op))
+      candidates.push_back(op);
+  });
+  if (candidates.empty())
+    return success();
+
+  IRRewriter rewriter(funcOp.getContext());
+  for (Operation *op : candidates) {
+    Location loc = op->getLoc();
+    rewriter.setInsertionPoint(op);
+    SmallVector<Value> operands;
+    for (Value operand : op->getOperands()) {
+      operands.push_back(rewriter.create<arith::TruncIOp>(
+          loc, getNarrowedType(operand.getType()), operand));
+    }
+    SmallVector<Type> resultTypes;
+    for (Type resultType : op->getResultTypes()) {
+      resultTypes.push_back(getElementTypeOrSelf(resultType).isInteger(64)
+                                ? getNarrowedType(resultType)
+                                : resultType);
+    }
+    // Overflow flags remain valid as the narrowed computation cannot overflow.
+    Operation *newOp = rewriter.create(loc, op->getName().getIdentifier(),
+                                       operands, resultTypes, op->getAttrs());
+    SmallVector<Value> replacements;
+    for (auto [oldResult, newResult] :
+         llvm::zip_equal(op->getResults(), newOp->getResults())) {
+      if (oldResult.getType() == newResult.getType()) {
+        replacements.push_back(newResult);
+        continue;
+      }
+      replacements.push_back(rewriter.create<arith::ExtSIOp>(
+          loc, oldResult.getType(), newResult));
+    }
+    rewriter.replaceOp(op, replacements);
+  }
+  LLVM_DEBUG(llvm::dbgs() << "WideIntegerEmulation: narrowed "
+                          << candidates.size() << " i64 ops to i32\n");
+
+  RewritePatternSet patterns(funcOp.getContext());
+  arith::TruncIOp::getCanonicalizationPatterns(patterns, funcOp.getContext());
+  arith::ExtSIOp::getCanonicalizationPatterns(patterns, funcOp.getContext());
+  return applyPatternsAndFoldGreedily(funcOp, std::move(patterns));
+}
+
 //===----------------------------------------------------------------------===//
 // Helper functions
 //===----------------------------------------------------------------------===//
@@ -181,6 +327,10 @@ struct SPIRVEmulateI64Pass final
 
     MLIRContext *ctx = &getContext();
 
+    // Avoid emulating i64 ops whose values are known to fit in i32.
+    if (failed(narrowI64Arithmetic(op)))
+      return signalPassFailure();
+
     // Run the main emulation pass.
     {
       ConversionTarget target(*ctx);
@@ -0,0 +1,55 @@
+// RUN: iree-opt --split-input-file --iree-gpu-test-target=xe-hpg --pass-pipeline='builtin.module(iree-spirv-select-lowering-strategy-pass)' %s | FileCheck %s
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+func.func @matmul_f16_1024x2048x512() {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.000000e+00 : f16
+  %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<1024x512xf16>>
+  %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<512x2048xf16>>
+  %2 = hal.interface.binding.subspan layout(#pipeline_layout) binding(2) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<1024x2048xf16>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [1024, 512], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<1024x512xf16>> -> tensor<1024x512xf16>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [512, 2048], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<512x2048xf16>> -> tensor<512x2048xf16>
+  %5 = tensor.empty() : tensor<1024x2048xf16>
+  %6 = linalg.fill ins(%cst : f16) outs(%5 : tensor<1024x2048xf16>) -> tensor<1024x2048xf16>
+  %7 = linalg.matmul ins(%3, %4 : tensor<1024x512xf16>, tensor<512x2048xf16>) outs(%6 : tensor<1024x2048xf16>) -> tensor<1024x2048xf16>
+  flow.dispatch.tensor.store %7, %2, offsets = [0, 0], sizes = [1024, 2048], strides = [1, 1] : tensor<1024x2048xf16> -> !flow.dispatch.tensor<writeonly:tensor<1024x2048xf16>>
+  return
+}
+
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<pipeline = SPIRVMatmulPromoteVectorize workgroup_size = [{{.+}}], {pipeline_depth = 2 : i64, store_stage = 0 : i64}>
+//      CHECK: func.func @matmul_f16_1024x2048x512()
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+//      CHECK:   linalg.matmul
+// CHECK-SAME:     lowering_config = #iree_codegen.lowering_config
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+func.func @batch_matmul_f32_16x1024x1024x512() {
+  %c0 = arith.constant 0 : index
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<16x1024x512xf32>>
+  %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<16x512x1024xf32>>
+  %2 = hal.interface.binding.subspan layout(#pipeline_layout) binding(2) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<16x1024x1024xf32>>
+  %3 = flow.dispatch.tensor.load %0, offsets = [0, 0, 0], sizes = [16, 1024, 512], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<16x1024x512xf32>> -> tensor<16x1024x512xf32>
+  %4 = flow.dispatch.tensor.load %1, offsets = [0, 0, 0], sizes = [16, 512, 1024], strides = [1, 1, 1] : !flow.dispatch.tensor<readonly:tensor<16x512x1024xf32>> -> tensor<16x512x1024xf32>
+  %5 = tensor.empty() : tensor<16x1024x1024xf32>
+  %6 = linalg.fill ins(%cst : f32) outs(%5 : tensor<16x1024x1024xf32>) -> tensor<16x1024x1024xf32>
+  %7 = linalg.batch_matmul ins(%3, %4 : tensor<16x1024x512xf32>, tensor<16x512x1024xf32>) outs(%6 : tensor<16x1024x1024xf32>) -> tensor<16x1024x1024xf32>
+  flow.dispatch.tensor.store %7, %2, offsets = [0, 0, 0], sizes = [16, 1024, 1024], strides = [1, 1, 1] : tensor<16x1024x1024xf32> -> !flow.dispatch.tensor<writeonly:tensor<16x1024x1024xf32>>
+  return
+}
+
+//  CHECK-DAG: #[[TRANSLATION:.+]] = #iree_codegen.translation_info<pipeline = SPIRVMatmulPromoteVectorize workgroup_size = [{{.+}}], {pipeline_depth = 2 : i64, store_stage = 0 : i64}>
+//      CHECK: func.func @batch_matmul_f32_16x1024x1024x512()
+// CHECK-SAME:     translation_info = #[[TRANSLATION]]
+//      CHECK:   linalg.batch_matmul
+// CHECK-SAME:     lowering_config = #iree_codegen.lowering_config
@@ -127,3 +127,40 @@ func.func @no_emulation() attributes {hal.executable.target = #executable_target
 //       CHECK:   {{%.+}}           = arith.addi {{%.+}} : i64
 //       CHECK:   memref.store {{%.+}}, [[REF_I64_1]][{{%.+}}] : memref<8xi64, #spirv.storage_class<StorageBuffer>>
 //       CHECK:   return
+
+// -----
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+#executable_target_vulkan_spirv_fb = #hal.executable.target<"vulkan-spirv", "vulkan-spirv-fb", {
+  iree.gpu.target = #iree_gpu.target<arch = "", features = "spirv:v1.6,cap:Shader", wgp = <
+    compute = fp32|int32, storage = b32, subgroup = none, dot = none, mma = [],
+    subgroup_size_choices = [32], max_workgroup_sizes = [1024, 1024, 1024],
+    max_thread_count_per_workgroup = 1024, max_workgroup_memory_bytes = 65536,
+    max_workgroup_counts = [65535, 65535, 65535]>>
+}>
+func.func @narrow_to_i32() attributes {hal.executable.target = #executable_target_vulkan_spirv_fb} {
+  %c0 = arith.constant 0 : index
+  %c7_i64 = arith.constant 7 : i64
+  %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) : memref<8xi8, #spirv.storage_class<StorageBuffer>>
+  %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) : memref<8xi32, #spirv.storage_class<StorageBuffer>>
+  %2 = memref.load %0[%c0] : memref<8xi8, #spirv.storage_class<StorageBuffer>>
+  %3 = arith.extui %2 : i8 to i64
+  %4 = arith.muli %3, %3 : i64
+  %5 = arith.addi %4, %c7_i64 : i64
+  %6 = arith.trunci %5 : i64 to i32
+  memref.store %6, %1[%c0] : memref<8xi32, #spirv.storage_class<StorageBuffer>>
+  return
+}
+
+// Check that i64 ops proven to fit in i32 are narrowed instead of emulated.
+//
+// CHECK-LABEL: func.func @narrow_to_i32
+//   CHECK-NOT:   i64
+//   CHECK-NOT:   vector<2xi32>
+//       CHECK:   arith.muli {{%.+}}, {{%.+}} : i32
+//       CHECK:   arith.addi {{%.+}}, {{%.+}} : i32
+//   CHECK-NOT:   i64
+//       CHECK:   return
@@ -1107,6 +1107,34 @@ void populateRemoveDeadMemAllocPatterns(RewritePatternSet &patterns) {
   patterns.insert<RemoveDeadInterfaceBindings>(patterns.getContext());
 }
 
+/// Inserts into |liveOps| every operation where |alloc| or any view derived
+/// from it is live. Views are followed transitively so that accesses through
+/// subviews, reshapes and casts of the allocation extend its liveness.
+static void getAllocLiveness(Liveness &liveness, Operation *alloc,
+                             llvm::DenseSet<Operation *> &liveOps) {
+  SmallVector<Value> worklist = {alloc->getResult(0)};
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+    Liveness::OperationListT liveInfo = liveness.resolveLiveness(value);
+    liveOps.insert(liveInfo.begin(), liveInfo.end());
+    for (Operation *user : value.getUsers()) {
+      if (isa<ViewLikeOpInterface, arith::SelectOp>(user)) {
+        worklist.append(user->result_begin(), user->result_end());
+      }
+    }
+  }
+}
+
+/// Returns true if the liveness sets |lhs| and |rhs| intersect.
+static bool livenessOverlaps(const llvm::DenseSet<Operation *> &lhs,
+                             const llvm::DenseSet<Operation *> &rhs) {
+  const llvm::DenseSet<Operation *> &smaller =
+      lhs.size() < rhs.size() ? lhs : rhs;
+  const llvm::DenseSet<Operation *> &larger =
+      lhs.size() < rhs.size() ? rhs : lhs;
+  return llvm::any_of(smaller, [&](Operation *op) { return larger.count(op); });
+}
+
 void analyseAllocsForPacking(mlir::FunctionOpInterface funcOp,
                              ArrayRef<Operation *> allocs,
                              SmallVector<AliasGroup> &aliasGroups) {
@@ -1124,35 +1152,24 @@ void analyseAllocsForPacking(mlir::FunctionOpInterface funcOp,
   Liveness liveness(funcOp);
   SmallVector<AllocGroup> groups;
   for (Operation *alloc : allocs) {
+    llvm::DenseSet<Operation *> allocLiveness;
+    getAllocLiveness(liveness, alloc, allocLiveness);
     SmallVector<size_t> aliasGroups;
     for (size_t i : llvm::seq<size_t>(0, groups.size())) {
-      AllocGroup &group = groups[i];
-      for (Operation *user : alloc->getUsers()) {
-        // Skip the whole analysis if any user is a subview.
-        // TODO: This could be extended if needed by recursively merging
-        // liveness.
-        if (isa<memref::SubViewOp>(user))
-          return;
-        if (group.liveness.count(user)) {
-          aliasGroups.push_back(i);
-          break;
-        }
+      if (livenessOverlaps(groups[i].liveness, allocLiveness)) {
+        aliasGroups.push_back(i);
       }
     }
     if (aliasGroups.empty()) {
       // If we didn't find any alias group create a new one.
       AllocGroup &newGroup = groups.emplace_back();
       newGroup.allocs.push_back(alloc);
-      Liveness::OperationListT liveInfo =
-          liveness.resolveLiveness(alloc->getResult(0));
-      newGroup.liveness.insert(liveInfo.begin(), liveInfo.end());
+      newGroup.liveness = std::move(allocLiveness);
     } else {
       // Merge the alloc into the first alias group it interfers with.
       AllocGroup &mergeGroup = groups[aliasGroups[0]];
       mergeGroup.allocs.push_back(alloc);
-      Liveness::OperationListT liveInfo =
-          liveness.resolveLiveness(alloc->getResult(0));
-      mergeGroup.liveness.insert(liveInfo.begin(), liveInfo.end());
+      mergeGroup.liveness.insert(allocLiveness.begin(), allocLiveness.end());
       // Then merge all the other alias groups into the first group.
       for (size_t i = 1, e = aliasGroups.size(); i < e; i++) {
         AllocGroup &group = groups[aliasGroups[i]];
@@ -1227,6 +1244,92 @@ void packAllocs(OpBuilder &builder, mlir::FunctionOpInterface funcOp,
   }
 }
 
+FailureOr<SmallVector<PackedAlloc>>
+computePackedAllocOffsets(mlir::FunctionOpInterface funcOp,
+                          ArrayRef<Operation *> allocs, int64_t alignment) {
+  for (Operation *alloc : allocs) {
+    if (!cast<memref::AllocOp>(alloc).getType().hasStaticShape()) {
+      return failure();
+    }
+  }
+  DataLayout dataLayout = DataLayout::closest(funcOp);
+  Liveness liveness(funcOp);
+  SmallVector<llvm::DenseSet<Operation *>> allocLiveness(allocs.size());
+  for (auto [alloc, liveOps] : llvm::zip_equal(allocs, allocLiveness)) {
+    getAllocLiveness(liveness, alloc, liveOps);
+  }
+
+  // Place the largest allocations first, breaking ties by program order to
+  // keep the packing deterministic.
+  SmallVector<size_t> order =
+      llvm::to_vector(llvm::seq<size_t>(0, allocs.size()));
+  SmallVector<int64_t> sizes =
+      llvm::map_to_vector(allocs, [&](Operation *alloc) {
+        return getAllocSize(alloc, dataLayout);
+      });
+  llvm::stable_sort(order, [&](size_t lhs, size_t rhs) {
+    return sizes[lhs] > sizes[rhs];
+  });
+
+  // Each allocation is placed at the lowest aligned offset that does not
+  // overlap the memory of an already placed allocation it interferes with.
+  SmallVector<int64_t> offsets(allocs.size(), -1);
+  for (size_t i : order) {
+    SmallVector<std::pair<int64_t, int64_t>> occupied;
+    for (size_t j : llvm::seq<size_t>(0, allocs.size())) {
+      if (offsets[j] >= 0 &&
+          livenessOverlaps(allocLiveness[i], allocLiveness[j])) {
+        occupied.emplace_back(offsets[j], offsets[j] + sizes[j]);
+      }
+    }
+    llvm::sort(occupied);
+    int64_t offset = 0;
+    for (auto [begin, end] : occupied) {
+      if (offset + sizes[i] <= begin) {
+        break;
+      }
+      offset = std::max(offset, llvm::alignTo(end, alignment));
+    }
+    offsets[i] = offset;
+  }
+
+  SmallVector<PackedAlloc> packedAllocs;
+  for (auto [alloc, offset, size] : llvm::zip_equal(allocs, offsets, sizes)) {
+    packedAllocs.push_back({alloc, offset, size});
+  }
+  return packedAllocs;
+}
+
+void packAllocs(OpBuilder &builder, mlir::FunctionOpInterface funcOp,
+                ArrayRef<PackedAlloc> packedAllocs) {
+  if (packedAllocs.empty())
+    return;
+  builder.setInsertionPointToStart(&(*funcOp.getFunctionBody().begin()));
+  int64_t packedSize = 0;
+  for (const PackedAlloc &packedAlloc : packedAllocs) {
+    packedSize = std::max(packedSize, packedAlloc.offset + packedAlloc.size);
+  }
+  Attribute memorySpace =
+      llvm::cast<MemRefType>(packedAllocs[0].alloc->getResultTypes()[0])
+          .getMemorySpace();
+  MemRefType allocType = MemRefType::get({packedSize}, builder.getI8Type(),
+                                         AffineMap(), memorySpace);
+  Value packedAlloc =
+      builder.create<memref::AllocOp>(funcOp.getLoc(), allocType);
+  for (const PackedAlloc &packed : packedAllocs) {
+    Operation *alloc = packed.alloc;
+    Location loc = alloc->getLoc();
+    builder.setInsertionPoint(alloc);
+    Value offsetValue =
+        builder.create<arith::ConstantIndexOp>(loc, packed.offset);
+    Value newAlloc = builder.create<memref::ViewOp>(
+        packedAlloc.getLoc(), alloc->getResultTypes()[0], packedAlloc,
+        offsetValue, ArrayRef<Value>({}));
+    alloc->replaceAllUsesWith(ArrayRef<Value>({newAlloc}));
+    alloc->erase();
+  }
+}
+
 LogicalResult tileLinalgOpsWithFilter(mlir::FunctionOpInterface funcOp,
                                       scf::SCFTilingOptions options,
                                       LinalgTransformationFilter filter) {
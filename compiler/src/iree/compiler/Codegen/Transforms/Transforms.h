@@ -128,6 +128,29 @@ void analyseAllocsForPacking(mlir::FunctionOpInterface funcOp,
 void packAllocs(OpBuilder &builder, mlir::FunctionOpInterface funcOp,
                 ArrayRef<AliasGroup> aliasGroups);
 
+/// Allocation placed at a byte offset of a packed allocation.
+struct PackedAlloc {
+  Operation *alloc;
+  int64_t offset;
+  int64_t size;
+};
+
+/// Assigns byte offsets to the given statically shaped allocs such that allocs
+/// with overlapping liveranges never overlap in memory. Liveness is computed
+/// across all blocks and regions of the function and includes all views of the
+/// allocs. Unlike `analyseAllocsForPacking`, allocs are not merged
+/// transitively: the largest allocs are placed first, each at the lowest
+/// `alignment`-aligned offset not used by an alloc it interferes with. Returns
+/// failure if any alloc has a dynamic shape.
+FailureOr<SmallVector<PackedAlloc>>
+computePackedAllocOffsets(mlir::FunctionOpInterface funcOp,
+                          ArrayRef<Operation *> allocs, int64_t alignment);
+
+/// Pack allocations into a unique large i8 allocation at the given offsets and
+/// use memref.view to separate the individual allocations.
+void packAllocs(OpBuilder &builder, mlir::FunctionOpInterface funcOp,
+                ArrayRef<PackedAlloc> packedAllocs);
+
 /// Lower the workgroup count region for the default code-generation path in
 /// IREE. Given the list `workgroupCount` (fastest varying dimension innermost)
 /// as computed within the `entryPointFn`, clones a backward slice of the
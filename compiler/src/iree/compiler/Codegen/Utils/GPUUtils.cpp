@@ -996,6 +996,8 @@ IREE::GPU::TargetAttr getCLGPUTarget(MLIRContext *context) {
       backend = "vulkan";
     else if (StringRef(clTestTarget).starts_with("valhall"))
       backend = "vulkan";
+    else if (StringRef(clTestTarget).starts_with("xe-"))
+      backend = "vulkan";
   }
   auto [arch, features] = StringRef(archAndFeatures).split(':');
   // Use the target specified in the command line for testing purposes.
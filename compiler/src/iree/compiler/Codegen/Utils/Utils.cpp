@@ -248,6 +248,11 @@ bool isRISCV32(IREE::HAL::ExecutableTargetAttr targetAttr) {
   return triple && triple.value().isRISCV32();
 }
 
+bool isRISCV64(IREE::HAL::ExecutableTargetAttr targetAttr) {
+  std::optional<llvm::Triple> triple = getTargetTriple(targetAttr);
+  return triple && triple.value().isRISCV64();
+}
+
 bool isReadOnly(Value v) {
   Operation *definingOp = v.getDefiningOp();
   if (!definingOp)
@@ -1459,6 +1464,41 @@ bool hasFusedLeadingOp(linalg::LinalgOp rootOp) {
   return llvm::any_of(backwardSlice, llvm::IsaPred<linalg::LinalgOp>);
 }
 
+linalg::LinalgOp getChainedContractionProducer(linalg::LinalgOp rootOp,
+                                               OpOperand **chainedOperand) {
+  if (!linalg::isaContractionOpInterface(rootOp)) {
+    return nullptr;
+  }
+  for (OpOperand *operand : rootOp.getDpsInputOperands()) {
+    Value value = operand->get();
+    while (auto producer = value.getDefiningOp<linalg::LinalgOp>()) {
+      if (linalg::isaContractionOpInterface(producer)) {
+        *chainedOperand = operand;
+        return producer;
+      }
+      if (!linalg::isElementwise(producer)) {
+        break;
+      }
+      // Follow the only input produced by a compute op with an identity
+      // indexing map.
+      SmallVector<Value> candidates;
+      for (OpOperand *input : producer.getDpsInputOperands()) {
+        auto inputProducer = input->get().getDefiningOp<linalg::LinalgOp>();
+        if (!inputProducer || isa<linalg::FillOp>(inputProducer) ||
+            !producer.getMatchingIndexingMap(input).isIdentity()) {
+          continue;
+        }
+        candidates.push_back(input->get());
+      }
+      if (candidates.size() != 1) {
+        break;
+      }
+      value = candidates.front();
+    }
+  }
+  return nullptr;
+}
+
 std::optional<vector::VscaleRange>
 getDefaultVscaleRange(IREE::HAL::ExecutableTargetAttr targetAttr) {
   if (isAArch64(targetAttr)) {
@@ -88,6 +88,7 @@ bool isX86_64(IREE::HAL::ExecutableTargetAttr targetAttr);
 bool isAArch64(IREE::HAL::ExecutableTargetAttr targetAttr);
 bool isRISCV(IREE::HAL::ExecutableTargetAttr targetAttr);
 bool isRISCV32(IREE::HAL::ExecutableTargetAttr targetAttr);
+bool isRISCV64(IREE::HAL::ExecutableTargetAttr targetAttr);
 
 /// Checks if a tensor value is generated from a read-only object, like
 /// and interface binding with read-only attribute or from an `arith.constant`
@@ -234,6 +235,14 @@ void sinkOpsInCFG(const SmallVector<Operation *> &allocs,
 // the inputs.
 bool hasFusedLeadingOp(linalg::LinalgOp rootOp);
 
+/// Returns the contraction that produces an input of the contraction `rootOp`
+/// through a chain of elementwise ops within the same dispatch, e.g. the first
+/// GEMM of a GEMM -> activation -> GEMM chain. Returns a null op if there is
+/// none. On success `chainedOperand` is set to the input of `rootOp` fed by
+/// the chain.
+linalg::LinalgOp getChainedContractionProducer(linalg::LinalgOp rootOp,
+                                               OpOperand **chainedOperand);
+
 std::optional<vector::VscaleRange>
 getDefaultVscaleRange(IREE::HAL::ExecutableTargetAttr targetAttr);
 
@@ -13,9 +13,15 @@
 #include "iree/compiler/Pipelines/Pipelines.h"
 #include "iree/compiler/Utils/PassUtils.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/StringExtras.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 #include "llvm/Support/Timer.h"
 #include "llvm/Support/raw_ostream.h"
+#include "mlir/AsmParser/AsmParser.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinAttributes.h"
@@ -45,6 +51,15 @@ static llvm::cl::opt<bool> clEnableDebug(
         "don't want to run a debug compiler)."),
     llvm::cl::init(false));
 
+static llvm::cl::opt<std::string> clJitCacheDir(
+    "iree-consteval-jit-cache-dir",
+    llvm::cl::desc(
+        "Directory used to cache the results of evaluated initializers across "
+        "compiler invocations. Entries are keyed on the initializer IR, its "
+        "input values and the JIT target device but not the compiler version: "
+        "the directory should be cleared when the compiler is updated."),
+    llvm::cl::init(""));
+
 namespace {
 
 static bool isDebugEnabled() {
@@ -64,6 +79,28 @@ emitDebugWarning(Location loc,
   }
 }
 
+// Digests all bytes written to the stream without retaining them.
+class md5_ostream : public llvm::raw_ostream {
+public:
+  md5_ostream() { SetUnbuffered(); }
+
+  llvm::MD5::MD5Result result() {
+    llvm::MD5::MD5Result digest;
+    hasher.final(digest);
+    return digest;
+  }
+
+private:
+  void write_impl(const char *ptr, size_t size) override {
+    hasher.update(
+        ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(ptr), size));
+    pos += size;
+  }
+  uint64_t current_pos() const override { return pos; }
+  llvm::MD5 hasher;
+  uint64_t pos = 0;
+};
+
 // These options structs are not copy-constructable so we have to allocate them
 // shared.
 // TODO: See if we can make them copyable?
@@ -407,6 +444,12 @@ struct JitFunctionDesc {
   std::string name;
   llvm::SmallVector<ArgumentBinding> argumentBindings;
   llvm::SmallVector<ResultBinding> resultBindings;
+  // Digest of the function IR and all objects it references. Combined with
+  // the argument values to form the key of cached results.
+  std::string irDigest;
+  // Set when the results were loaded from the cache and the function does not
+  // need to be invoked.
+  bool isCached = false;
 };
 
 // Clones all object-like symbols used within the function.
@@ -598,10 +641,36 @@ private:
     termBuilder.create<IREE::Util::ReturnOp>(funcOp.getLoc(), returns);
     funcOp.setType(termBuilder.getFunctionType(argumentTypes, returnTypes));
 
+    if (!clJitCacheDir.empty()) {
+      desc.irDigest = computeIRDigest(funcOp);
+    }
     jitFunctions.push_back(std::move(desc));
     return success();
   }
 
+  // Returns a digest of |funcOp| and all object-like symbols it references.
+  // The function name is uniqued based on the number of initializers imported
+  // so it is excluded to keep the digest stable as the program changes.
+  std::string computeIRDigest(IREE::Util::FuncOp funcOp) {
+    md5_ostream os;
+    OpPrintingFlags flags;
+    flags.printGenericOpForm();
+    auto nameAttr = funcOp.getSymNameAttr();
+    funcOp.setSymName("jit_eval");
+    funcOp->print(os, flags);
+    funcOp.setSymNameAttr(nameAttr);
+    if (auto uses = SymbolTable::getSymbolUses(funcOp)) {
+      for (auto use : *uses) {
+        if (auto *objectOp = targetSymbolTable.lookup(
+                use.getSymbolRef().getRootReference())) {
+          objectOp->print(os, flags);
+        }
+      }
+    }
+    os.flush();
+    return os.result().digest().str().str();
+  }
+
   ModuleOp targetModuleOp;
   SymbolTable sourceSymbolTable;
   SymbolTable targetSymbolTable;
@@ -611,6 +680,128 @@ private:
   InitializationAnalysis initializationAnalysis;
 };
 
+//===----------------------------------------------------------------------===//
+// Result cache
+//===----------------------------------------------------------------------===//
+
+// Bumped whenever the key derivation or the entry format changes.
+static constexpr StringLiteral kCacheFormatVersion = "1";
+
+// Returns the value an argument will be bound to or nullptr if the value is
+// not yet known (it is produced by an initializer that has not been run).
+static Attribute getArgumentValue(ArgumentBinding &arg) {
+  switch (arg.getType()) {
+  case ArgumentBinding::Type::ElementsAttr:
+    return arg.getElementsAttr();
+  case ArgumentBinding::Type::GlobalOp:
+    return arg.getGlobalOp().getGlobalInitialValue();
+  }
+  return {};
+}
+
+// Returns the key of the cache entry for |jitFunction| given the current
+// values of its arguments or nullopt if any value is unknown or can't be
+// hashed.
+static std::optional<std::string>
+computeCacheKey(JitFunctionDesc &jitFunction, StringRef targetDevice) {
+  md5_ostream os;
+  os << kCacheFormatVersion << '\0' << targetDevice << '\0'
+     << jitFunction.irDigest << '\0';
+  for (ArgumentBinding &arg : jitFunction.argumentBindings) {
+    Attribute value = getArgumentValue(arg);
+    if (!value) {
+      return std::nullopt;
+    }
+    if (auto typedValue = dyn_cast<TypedAttr>(value)) {
+      os << typedValue.getType() << '\0';
+    }
+    if (auto serializableAttr =
+            dyn_cast<IREE::Util::SerializableAttrInterface>(value)) {
+      if (failed(serializableAttr.serializeToStream(
+              jitFunction.loc, llvm::endianness::little, os))) {
+        return std::nullopt;
+      }
+    } else if (isa<IntegerAttr, FloatAttr>(value)) {
+      os << value;
+    } else {
+      return std::nullopt;
+    }
+    os << '\0';
+  }
+  os.flush();
+  return os.result().digest().str().str();
+}
+
+static SmallString<256> getCacheEntryPath(StringRef key) {
+  SmallString<256> path(clJitCacheDir);
+  llvm::sys::path::append(path, key + ".mlir");
+  return path;
+}
+
+// Prints |attr| so that it can be parsed back with mlir::parseAttribute.
+// Dense elements are printed as hex to keep large entries fast to parse.
+static void printCacheEntryAttr(TypedAttr attr, llvm::raw_ostream &os) {
+  if (auto denseAttr = dyn_cast<DenseElementsAttr>(attr)) {
+    ArrayRef<char> rawData = denseAttr.getRawData();
+    os << "dense<\"0x"
+       << llvm::toHex(StringRef(rawData.data(), rawData.size()))
+       << "\"> : " << denseAttr.getType();
+    return;
+  }
+  attr.print(os);
+}
+
+// Loads the cached results of |jitFunction| into |results|. Fails if there is
+// no entry or the entry does not match the function results.
+static LogicalResult loadCacheEntry(JitFunctionDesc &jitFunction,
+                                    StringRef key, MLIRContext *context,
+                                    SmallVectorImpl<TypedAttr> &results) {
+  auto fileOr = llvm::MemoryBuffer::getFile(getCacheEntryPath(key));
+  if (!fileOr) {
+    return failure();
+  }
+  SmallVector<StringRef> lines;
+  (*fileOr)->getBuffer().split(lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  if (lines.size() != jitFunction.resultBindings.size()) {
+    return failure();
+  }
+  for (auto [line, resultBinding] :
+       llvm::zip_equal(lines, jitFunction.resultBindings)) {
+    auto attr = dyn_cast_if_present<TypedAttr>(parseAttribute(line, context));
+    if (!attr ||
+        attr.getType() != resultBinding.getGlobalOp().getGlobalType()) {
+      return failure();
+    }
+    results.push_back(attr);
+  }
+  return success();
+}
+
+// Stores |results| as the cache entry for |key|. Failures are not fatal as the
+// results have already been computed.
+static void storeCacheEntry(Location loc, StringRef key,
+                            ArrayRef<TypedAttr> results) {
+  auto emitStoreWarning = [&](const Twine &message) {
+    emitDebugWarning(loc, [&](InFlightDiagnostic &diagnostic) {
+      diagnostic << "failed to store consteval cache entry: " << message;
+    });
+  };
+  if (std::error_code ec = llvm::sys::fs::create_directories(clJitCacheDir)) {
+    return emitStoreWarning(ec.message());
+  }
+  if (llvm::Error error = llvm::writeToOutput(
+          getCacheEntryPath(key), [&](llvm::raw_ostream &os) {
+            for (TypedAttr attr : results) {
+              printCacheEntryAttr(attr, os);
+              os << "\n";
+            }
+            return llvm::Error::success();
+          })) {
+    emitStoreWarning(llvm::toString(std::move(error)));
+  }
+}
+
 class JitGlobalsPass final : public impl::JitGlobalsPassBase<JitGlobalsPass> {
 public:
   JitGlobalsPass() : JitGlobalsPass(JitGlobalsPassOptions{}) {}
@@ -706,6 +897,18 @@ public:
                    ModuleOp module, llvm::TimerGroup &tg) {
     // Process each function through the runtime.
     for (JitFunctionDesc &jitFunction : jitFunctions) {
+      if (jitFunction.isCached)
+        continue;
+
+      // Arguments produced by earlier functions are known now so the key can
+      // be derived and the cache checked before invoking.
+      std::optional<std::string> cacheKey;
+      if (!clJitCacheDir.empty()) {
+        cacheKey = computeCacheKey(jitFunction, requestedTargetDevice);
+        if (cacheKey && succeeded(loadCachedResults(jitFunction, *cacheKey)))
+          continue;
+      }
+
       std::optional<llvm::Timer> invokeTimer;
       if (debugEnabled) {
         std::string timerName("Invoke ");
@@ -747,6 +950,7 @@ public:
       }
 
       // Process results.
+      SmallVector<TypedAttr> results;
       for (auto it : llvm::enumerate(jitFunction.resultBindings)) {
         ResultBinding &resultBinding = it.value();
         switch (resultBinding.getType()) {
@@ -757,10 +961,14 @@ public:
                   resultBinding.getGlobalOp().getGlobalType(), attr)))
             return failure();
           resultBinding.getGlobalOp().setGlobalInitialValue(attr);
+          results.push_back(attr);
           break;
         }
         }
       }
+      if (cacheKey) {
+        storeCacheEntry(jitFunction.loc, *cacheKey, results);
+      }
 
       if (debugEnabled) {
         invokeTimer->stopTimer();
@@ -770,6 +978,36 @@ public:
     return success();
   }
 
+  // Assigns the cached results of |jitFunction| to its globals, if present.
+  LogicalResult loadCachedResults(JitFunctionDesc &jitFunction,
+                                  StringRef cacheKey) {
+    SmallVector<TypedAttr> results;
+    if (failed(loadCacheEntry(jitFunction, cacheKey, &getContext(), results)))
+      return failure();
+    for (auto [resultBinding, attr] :
+         llvm::zip_equal(jitFunction.resultBindings, results)) {
+      resultBinding.getGlobalOp().setGlobalInitialValue(attr);
+    }
+    jitFunction.isCached = true;
+    if (debugEnabled) {
+      llvm::dbgs() << "::: Loaded " << jitFunction.name << " from cache\n";
+    }
+    return success();
+  }
+
+  // Loads cached results for functions in program order until the first one
+  // that misses. Later functions may depend on the results of the one that
+  // missed and are checked again after it has been invoked. Returns true if
+  // all functions were satisfied from the cache.
+  bool loadCachedFunctions(llvm::SmallVector<JitFunctionDesc> &jitFunctions) {
+    for (JitFunctionDesc &jitFunction : jitFunctions) {
+      auto cacheKey = computeCacheKey(jitFunction, requestedTargetDevice);
+      if (!cacheKey || failed(loadCachedResults(jitFunction, *cacheKey)))
+        return false;
+    }
+    return true;
+  }
+
   void runOnOperation() override {
     llvm::TimerGroup tg("iree-consteval-jit", "Consteval Jit");
     auto outerModule = getOperation();
@@ -832,6 +1070,16 @@ public:
       return;
     }
 
+    // Skip compilation entirely if all results are available from the cache.
+    if (!clJitCacheDir.empty() &&
+        loadCachedFunctions(programBuilder.getJitFunctions())) {
+      programBuilder.getTargetModule()->erase();
+      for (auto deadOp : deadInitOps) {
+        deadOp.erase();
+      }
+      return;
+    }
+
     std::optional<llvm::Timer> compileTimer;
     if (debugEnabled) {
       llvm::dbgs() << "::: COMPILING JIT (" << requestedTargetDevice
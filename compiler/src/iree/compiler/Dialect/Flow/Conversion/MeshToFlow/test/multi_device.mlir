@@ -0,0 +1,61 @@
+// RUN: iree-opt --split-input-file --iree-convert-mesh-to-multi-device="devices=dev_a,dev_b" --verify-diagnostics %s | FileCheck %s
+
+// CHECK-NOT: mesh.mesh
+mesh.mesh @mesh_1d(shape = 2)
+
+// CHECK-LABEL: @all_reduce_sum
+// CHECK-SAME: (%[[ARG0:[a-z0-9]+]]: tensor<4xf32> {iree.abi.affinity = #hal.device.promise<@dev_a>},
+// CHECK-SAME:  %[[ARG1:[a-z0-9]+]]: tensor<4xf32> {iree.abi.affinity = #hal.device.promise<@dev_b>})
+// CHECK-SAME: -> (tensor<4xf32> {iree.abi.affinity = #hal.device.promise<@dev_a>},
+// CHECK-SAME:     tensor<4xf32> {iree.abi.affinity = #hal.device.promise<@dev_b>})
+util.func public @all_reduce_sum(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+  //      CHECK: %[[ARG1_ON_A:.+]] = flow.tensor.transfer %[[ARG1]] : tensor<4xf32> to #hal.device.promise<@dev_a>
+  //      CHECK: %[[SUM_A:.+]] = arith.addf %[[ARG0]], %[[ARG1_ON_A]] : tensor<4xf32>
+  //      CHECK: %[[ARG0_ON_B:.+]] = flow.tensor.transfer %[[ARG0]] : tensor<4xf32> to #hal.device.promise<@dev_b>
+  //      CHECK: %[[SUM_B:.+]] = arith.addf %[[ARG0_ON_B]], %[[ARG1]] : tensor<4xf32>
+  %0 = mesh.all_reduce %arg0 on @mesh_1d mesh_axes = [0]
+      : tensor<4xf32> -> tensor<4xf32>
+  // CHECK: util.return %[[SUM_A]], %[[SUM_B]]
+  util.return %0 : tensor<4xf32>
+}
+
+// -----
+
+mesh.mesh @mesh_1d(shape = 2)
+
+// CHECK-LABEL: @all_gather
+// CHECK-SAME: (%[[ARG0:[a-z0-9]+]]: tensor<2x3xi32> {{.+}}, %[[ARG1:[a-z0-9]+]]: tensor<2x3xi32>
+util.func public @all_gather(%arg0: tensor<2x3xi32>) -> tensor<4x3xi32> {
+  //      CHECK: %[[ARG1_ON_A:.+]] = flow.tensor.transfer %[[ARG1]] : tensor<2x3xi32> to #hal.device.promise<@dev_a>
+  //      CHECK: %[[GATHER_A:.+]] = tensor.concat dim(0) %[[ARG0]], %[[ARG1_ON_A]]
+  //      CHECK: %[[ARG0_ON_B:.+]] = flow.tensor.transfer %[[ARG0]] : tensor<2x3xi32> to #hal.device.promise<@dev_b>
+  //      CHECK: %[[GATHER_B:.+]] = tensor.concat dim(0) %[[ARG0_ON_B]], %[[ARG1]]
+  %0 = mesh.all_gather %arg0 on @mesh_1d mesh_axes = [0] gather_axis = 0
+      : tensor<2x3xi32> -> tensor<4x3xi32>
+  // CHECK: util.return %[[GATHER_A]], %[[GATHER_B]]
+  util.return %0 : tensor<4x3xi32>
+}
+
+// -----
+
+mesh.mesh @mesh_1d(shape = 2)
+
+// CHECK-LABEL: @process_linear_index
+util.func public @process_linear_index() -> index {
+  //  CHECK-DAG: %[[C0:.+]] = arith.constant 0 : index
+  //  CHECK-DAG: %[[C1:.+]] = arith.constant 1 : index
+  %0 = mesh.process_linear_index on @mesh_1d : index
+  // CHECK: util.return %[[C0]], %[[C1]] : index, index
+  util.return %0 : index
+}
+
+// -----
+
+// expected-error @+1 {{has 4 processes but 2 devices were provided}}
+mesh.mesh @mesh_2d(shape = 2x2)
+
+util.func public @device_count_mismatch(%arg0: tensor<4xf32>) -> tensor<4xf32> {
+  %0 = mesh.all_reduce %arg0 on @mesh_2d mesh_axes = [0]
+      : tensor<4xf32> -> tensor<4xf32>
+  util.return %0 : tensor<4xf32>
+}
@@ -0,0 +1,470 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Mesh/IR/MeshOps.h"
+#include "mlir/Dialect/Mesh/Transforms/Simplifications.h"
+#include "mlir/Dialect/Mesh/Transforms/Transforms.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+namespace mlir::iree_compiler::IREE::Flow {
+
+#define GEN_PASS_DEF_CONVERTMESHTOMULTIDEVICEPASS
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h.inc"
+
+namespace {
+
+// Placement of the processes of a mesh onto devices in linear process order.
+struct MeshPlacement {
+  mesh::MeshOp meshOp;
+  SmallVector<Attribute> affinities;
+
+  int64_t getProcessCount() const { return affinities.size(); }
+
+  // Returns the multi-index of |process| in the mesh.
+  SmallVector<int64_t> getMultiIndex(int64_t process) const {
+    ArrayRef<int64_t> shape = meshOp.getShape();
+    SmallVector<int64_t> index(shape.size());
+    for (int64_t axis = shape.size() - 1; axis >= 0; --axis) {
+      index[axis] = process % shape[axis];
+      process /= shape[axis];
+    }
+    return index;
+  }
+
+  // Returns the processes in the collective group of |process| along
+  // |meshAxes| ordered by their index within the group. The order matches the
+  // ranks assigned to the group channel by ConvertMeshToFlowPass.
+  SmallVector<int64_t> getGroup(int64_t process,
+                                ArrayRef<mesh::MeshAxis> meshAxes) const {
+    ArrayRef<int64_t> shape = meshOp.getShape();
+    int64_t rank = shape.size();
+    SmallVector<int64_t> index = getMultiIndex(process);
+    SmallVector<std::pair<int64_t, int64_t>> members;
+    for (int64_t other = 0; other < getProcessCount(); ++other) {
+      SmallVector<int64_t> otherIndex = getMultiIndex(other);
+      bool isMember = true;
+      for (int64_t axis = 0; axis < rank; ++axis) {
+        if (!llvm::is_contained(meshAxes, axis) &&
+            index[axis] != otherIndex[axis]) {
+          isMember = false;
+          break;
+        }
+      }
+      if (!isMember) {
+        continue;
+      }
+      int64_t groupIndex = 0;
+      for (mesh::MeshAxis axis : meshAxes) {
+        groupIndex = groupIndex * shape[axis] + otherIndex[axis];
+      }
+      members.emplace_back(groupIndex, other);
+    }
+    llvm::sort(members);
+    return llvm::map_to_vector(members, [](auto member) {
+      return member.second;
+    });
+  }
+};
+
+} // namespace
+
+// Returns the elementwise combination of |lhs| and |rhs| under |kind| or
+// nullptr if the reduction is not supported.
+static Value buildCombine(OpBuilder &builder, Location loc,
+                          mesh::ReductionKind kind, Value lhs, Value rhs) {
+  bool isFloat = isa<FloatType>(getElementTypeOrSelf(lhs.getType()));
+  switch (kind) {
+  case mesh::ReductionKind::Sum:
+    return isFloat ? builder.create<arith::AddFOp>(loc, lhs, rhs).getResult()
+                   : builder.create<arith::AddIOp>(loc, lhs, rhs).getResult();
+  case mesh::ReductionKind::Product:
+    return isFloat ? builder.create<arith::MulFOp>(loc, lhs, rhs).getResult()
+                   : builder.create<arith::MulIOp>(loc, lhs, rhs).getResult();
+  case mesh::ReductionKind::Max:
+    return isFloat
+               ? builder.create<arith::MaximumFOp>(loc, lhs, rhs).getResult()
+               : builder.create<arith::MaxSIOp>(loc, lhs, rhs).getResult();
+  case mesh::ReductionKind::Min:
+    return isFloat
+               ? builder.create<arith::MinimumFOp>(loc, lhs, rhs).getResult()
+               : builder.create<arith::MinSIOp>(loc, lhs, rhs).getResult();
+  default:
+    return nullptr;
+  }
+}
+
+// Returns chunk |chunkIndex| of |chunkCount| equal chunks of |value| along
+// |axis|.
+static Value buildChunk(OpBuilder &builder, Location loc, Value value,
+                        int64_t axis, int64_t chunkCount, int64_t chunkIndex) {
+  if (chunkCount == 1) {
+    return value;
+  }
+  auto type = cast<RankedTensorType>(value.getType());
+  int64_t chunkSize = type.getDimSize(axis) / chunkCount;
+  SmallVector<OpFoldResult> offsets(type.getRank(), builder.getIndexAttr(0));
+  SmallVector<OpFoldResult> sizes =
+      getAsIndexOpFoldResult(builder.getContext(), type.getShape());
+  SmallVector<OpFoldResult> strides(type.getRank(), builder.getIndexAttr(1));
+  offsets[axis] = builder.getIndexAttr(chunkIndex * chunkSize);
+  sizes[axis] = builder.getIndexAttr(chunkSize);
+  return builder.create<tensor::ExtractSliceOp>(loc, value, offsets, sizes,
+                                                strides);
+}
+
+// Returns |value| of |source| transferred to the device of |target|.
+static Value buildTransfer(OpBuilder &builder, Location loc,
+                           const MeshPlacement &placement, Value value,
+                           int64_t source, int64_t target) {
+  if (source == target) {
+    return value;
+  }
+  return builder.create<IREE::Flow::TensorTransferOp>(
+      loc, value, placement.affinities[target]);
+}
+
+// Lowers the collective |op| given the values of its operand on each process
+// in |operands|. The results for each process are appended to |results|.
+//
+// Collectives are built from direct exchanges between the devices of a group:
+// each process transfers the chunks it contributes to the other members and
+// combines what it receives locally. All transfers are queue-ordered copies
+// that only depend on their producers so they may overlap with unrelated
+// compute on either device. Every member combines the contributions in group
+// order so that all replicas of a reduction produce identical results.
+static LogicalResult lowerCollective(Operation *op,
+                                     const MeshPlacement &placement,
+                                     ArrayRef<Value> operands,
+                                     SmallVectorImpl<Value> &results,
+                                     OpBuilder &builder) {
+  Location loc = op->getLoc();
+  auto operandType = dyn_cast<RankedTensorType>(operands.front().getType());
+  auto resultType = dyn_cast<RankedTensorType>(op->getResult(0).getType());
+  if (!operandType || !resultType || !operandType.hasStaticShape() ||
+      !resultType.hasStaticShape() ||
+      operandType.getElementType() != resultType.getElementType()) {
+    return op->emitOpError()
+           << "multi-device lowering requires statically shaped operands and "
+              "results of the same element type";
+  }
+
+  for (int64_t process = 0; process < placement.getProcessCount();
+       ++process) {
+    Value result;
+    LogicalResult status =
+        TypeSwitch<Operation *, LogicalResult>(op)
+            .Case<mesh::AllReduceOp>([&](auto reduceOp) {
+              for (int64_t member :
+                   placement.getGroup(process, reduceOp.getMeshAxes())) {
+                Value value = buildTransfer(builder, loc, placement,
+                                            operands[member], member, process);
+                result = result ? buildCombine(builder, loc,
+                                               reduceOp.getReduction(), result,
+                                               value)
+                                : value;
+                if (!result) {
+                  return failure();
+                }
+              }
+              return success();
+            })
+            .Case<mesh::AllGatherOp>([&](auto gatherOp) {
+              SmallVector<int64_t> group =
+                  placement.getGroup(process, gatherOp.getMeshAxes());
+              SmallVector<Value> values;
+              for (int64_t member : group) {
+                values.push_back(buildTransfer(builder, loc, placement,
+                                               operands[member], member,
+                                               process));
+              }
+              result = values.size() == 1
+                           ? values.front()
+                           : builder.create<tensor::ConcatOp>(
+                                     loc,
+                                     gatherOp.getGatherAxis().getSExtValue(),
+                                     values)
+                                 .getResult();
+              return success();
+            })
+            .Case<mesh::ReduceScatterOp>([&](auto scatterOp) {
+              SmallVector<int64_t> group =
+                  placement.getGroup(process, scatterOp.getMeshAxes());
+              int64_t chunkIndex = llvm::find(group, process) - group.begin();
+              for (int64_t member : group) {
+                Value chunk = buildChunk(
+                    builder, loc, operands[member],
+                    scatterOp.getScatterAxis().getSExtValue(), group.size(),
+                    chunkIndex);
+                Value value = buildTransfer(builder, loc, placement, chunk,
+                                            member, process);
+                result = result ? buildCombine(builder, loc,
+                                               scatterOp.getReduction(), result,
+                                               value)
+                                : value;
+                if (!result) {
+                  return failure();
+                }
+              }
+              return success();
+            })
+            .Case<mesh::AllToAllOp>([&](auto allToAllOp) {
+              SmallVector<int64_t> group =
+                  placement.getGroup(process, allToAllOp.getMeshAxes());
+              int64_t chunkIndex = llvm::find(group, process) - group.begin();
+              SmallVector<Value> values;
+              for (int64_t member : group) {
+                Value chunk = buildChunk(
+                    builder, loc, operands[member],
+                    allToAllOp.getSplitAxis().getSExtValue(), group.size(),
+                    chunkIndex);
+                values.push_back(buildTransfer(builder, loc, placement, chunk,
+                                               member, process));
+              }
+              result = values.size() == 1
+                           ? values.front()
+                           : builder.create<tensor::ConcatOp>(
+                                     loc,
+                                     allToAllOp.getConcatAxis().getSExtValue(),
+                                     values)
+                                 .getResult();
+              return success();
+            })
+            .Default([](Operation *) { return failure(); });
+    if (failed(status)) {
+      return op->emitOpError() << "unsupported in multi-device lowering";
+    }
+    results.push_back(result);
+  }
+  return success();
+}
+
+// Returns |attrs| with the `iree.abi.affinity` of |affinity| added.
+static DictionaryAttr addAffinity(DictionaryAttr attrs, Attribute affinity) {
+  NamedAttrList attrList(attrs);
+  attrList.set("iree.abi.affinity", affinity);
+  return attrList.getDictionary(affinity.getContext());
+}
+
+// Rewrites |funcOp| to run each process of |placement| on its own device.
+// Each argument and result is expanded into one value per process in linear
+// process order and the body is replicated per process with collectives
+// lowered to transfers between the devices.
+static LogicalResult unrollFunction(FunctionOpInterface funcOp,
+                                    const MeshPlacement &placement) {
+  Region &body = funcOp.getFunctionBody();
+  if (!body.hasOneBlock()) {
+    return funcOp.emitOpError()
+           << "multi-device lowering requires a single-block function";
+  }
+  if (!funcOp.isPublic()) {
+    return funcOp.emitOpError()
+           << "multi-device lowering requires mesh ops to be in public "
+              "functions; inline private functions first";
+  }
+  if (auto utilFuncOp = dyn_cast<IREE::Util::FuncOp>(funcOp.getOperation())) {
+    if (utilFuncOp.hasAnyTiedOperands()) {
+      return funcOp.emitOpError()
+             << "multi-device lowering does not support tied results";
+    }
+  }
+  Block &oldBlock = body.front();
+  WalkResult walkResult = funcOp.walk([&](Operation *op) {
+    if (isa<IREE::Util::GlobalStoreOpInterface>(op)) {
+      op->emitOpError() << "global stores cannot be replicated per device";
+      return WalkResult::interrupt();
+    }
+    if (op->getDialect() == placement.meshOp->getDialect() &&
+        op->getBlock() != &oldBlock) {
+      op->emitOpError() << "multi-device lowering requires mesh ops to be at "
+                           "the top level of the function";
+      return WalkResult::interrupt();
+    }
+    return WalkResult::advance();
+  });
+  if (walkResult.wasInterrupted()) {
+    return failure();
+  }
+
+  int64_t processCount = placement.getProcessCount();
+  auto oldType = cast<FunctionType>(funcOp.getFunctionType());
+  SmallVector<Type> newInputs;
+  SmallVector<Location> newInputLocs;
+  SmallVector<DictionaryAttr> newArgAttrs;
+  for (auto [i, type] : llvm::enumerate(oldType.getInputs())) {
+    for (Attribute affinity : placement.affinities) {
+      newInputs.push_back(type);
+      newInputLocs.push_back(oldBlock.getArgument(i).getLoc());
+      newArgAttrs.push_back(addAffinity(funcOp.getArgAttrDict(i), affinity));
+    }
+  }
+  SmallVector<Type> newResults;
+  SmallVector<DictionaryAttr> newResultAttrs;
+  for (auto [i, type] : llvm::enumerate(oldType.getResults())) {
+    for (Attribute affinity : placement.affinities) {
+      newResults.push_back(type);
+      newResultAttrs.push_back(
+          addAffinity(funcOp.getResultAttrDict(i), affinity));
+    }
+  }
+
+  OpBuilder builder(funcOp.getContext());
+  Block *newBlock =
+      builder.createBlock(&body, body.begin(), newInputs, newInputLocs);
+  SmallVector<IRMapping> mappings(processCount);
+  for (BlockArgument arg : oldBlock.getArguments()) {
+    for (int64_t process = 0; process < processCount; ++process) {
+      mappings[process].map(
+          arg, newBlock->getArgument(arg.getArgNumber() * processCount +
+                                     process));
+    }
+  }
+
+  // Ops are replicated one at a time so that the values of all processes are
+  // available when a collective combines them.
+  for (Operation &op : oldBlock.without_terminator()) {
+    if (auto indexOp = dyn_cast<mesh::ProcessLinearIndexOp>(op)) {
+      for (int64_t process = 0; process < processCount; ++process) {
+        mappings[process].map(indexOp.getResult(),
+                              builder.create<arith::ConstantIndexOp>(
+                                  indexOp.getLoc(), process));
+      }
+      continue;
+    }
+    if (op.getDialect() == placement.meshOp->getDialect()) {
+      if (op.getNumOperands() != 1 || op.getNumResults() != 1) {
+        return op.emitOpError() << "unsupported in multi-device lowering";
+      }
+      SmallVector<Value> operands;
+      for (int64_t process = 0; process < processCount; ++process) {
+        operands.push_back(mappings[process].lookup(op.getOperand(0)));
+      }
+      SmallVector<Value> results;
+      if (failed(lowerCollective(&op, placement, operands, results, builder))) {
+        return failure();
+      }
+      for (int64_t process = 0; process < processCount; ++process) {
+        mappings[process].map(op.getResult(0), results[process]);
+      }
+      continue;
+    }
+    for (int64_t process = 0; process < processCount; ++process) {
+      builder.clone(op, mappings[process]);
+    }
+  }
+
+  Operation *oldTerminator = oldBlock.getTerminator();
+  SmallVector<Value> newOperands;
+  for (Value operand : oldTerminator->getOperands()) {
+    for (int64_t process = 0; process < processCount; ++process) {
+      newOperands.push_back(mappings[process].lookup(operand));
+    }
+  }
+  OperationState terminatorState(oldTerminator->getLoc(),
+                                 oldTerminator->getName());
+  terminatorState.addOperands(newOperands);
+  terminatorState.addAttributes(oldTerminator->getAttrs());
+  builder.create(terminatorState);
+
+  oldBlock.dropAllDefinedValueUses();
+  oldBlock.erase();
+  funcOp.setType(
+      FunctionType::get(funcOp.getContext(), newInputs, newResults));
+  funcOp.setAllArgAttrs(newArgAttrs);
+  funcOp.setAllResultAttrs(newResultAttrs);
+  return success();
+}
+
+namespace {
+
+struct ConvertMeshToMultiDevicePass
+    : public IREE::Flow::impl::ConvertMeshToMultiDevicePassBase<
+          ConvertMeshToMultiDevicePass> {
+  using IREE::Flow::impl::ConvertMeshToMultiDevicePassBase<
+      ConvertMeshToMultiDevicePass>::ConvertMeshToMultiDevicePassBase;
+
+  void runOnOperation() override {
+    ModuleOp moduleOp = getOperation();
+    if (devices.empty()) {
+      return;
+    }
+    SmallVector<mesh::MeshOp> meshOps =
+        llvm::to_vector(moduleOp.getOps<mesh::MeshOp>());
+    if (meshOps.empty()) {
+      return;
+    }
+    if (meshOps.size() > 1) {
+      moduleOp.emitError()
+          << "multi-device lowering supports a single mesh per module";
+      return signalPassFailure();
+    }
+    mesh::MeshOp meshOp = meshOps.front();
+    if (ShapedType::isDynamicShape(meshOp.getShape())) {
+      meshOp.emitOpError() << "multi-device lowering requires a static mesh";
+      return signalPassFailure();
+    }
+    int64_t processCount = ShapedType::getNumElements(meshOp.getShape());
+    if (processCount != static_cast<int64_t>(devices.size())) {
+      meshOp.emitOpError() << "has " << processCount << " processes but "
+                           << devices.size() << " devices were provided";
+      return signalPassFailure();
+    }
+
+    MeshPlacement placement;
+    placement.meshOp = meshOp;
+    for (const std::string &device : devices) {
+      placement.affinities.push_back(IREE::HAL::DevicePromiseAttr::get(
+          &getContext(), StringAttr::get(&getContext(), device),
+          /*queueMask=*/-1));
+    }
+
+    // Fold mesh shape queries and lower multi-indices to linear indices so
+    // that only collectives and linear indices remain.
+    SymbolTableCollection symbolTableCollection;
+    RewritePatternSet patterns(&getContext());
+    mesh::populateFoldingPatterns(patterns, symbolTableCollection);
+    mesh::populateProcessMultiIndexOpLoweringPatterns(patterns,
+                                                      symbolTableCollection);
+    if (failed(applyPatternsAndFoldGreedily(moduleOp, std::move(patterns)))) {
+      return signalPassFailure();
+    }
+
+    for (auto funcOp : moduleOp.getOps<FunctionOpInterface>()) {
+      if (funcOp.isExternal()) {
+        continue;
+      }
+      WalkResult walkResult = funcOp.walk([&](Operation *op) {
+        return op->getDialect() == meshOp->getDialect()
+                   ? WalkResult::interrupt()
+                   : WalkResult::advance();
+      });
+      if (!walkResult.wasInterrupted()) {
+        continue;
+      }
+      if (failed(unrollFunction(funcOp, placement))) {
+        return signalPassFailure();
+      }
+    }
+
+    meshOp.erase();
+  }
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::IREE::Flow
@@ -0,0 +1,370 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-flow-multi-version-dispatches"
+
+namespace mlir::iree_compiler::IREE::Flow {
+
+#define GEN_PASS_DEF_MULTIVERSIONDISPATCHESPASS
+#include "iree/compiler/Dialect/Flow/Transforms/Passes.h.inc"
+
+namespace {
+
+// A set of dispatch operands specialized jointly. Each version assigns one
+// assumption to each of the operands.
+struct VersionSet {
+  // Indices of the specialized operands in the dispatch arguments.
+  SmallVector<unsigned> operandIndices;
+  // Assumptions of each version with one entry per specialized operand.
+  SmallVector<SmallVector<IREE::Util::IntAssumptionAttr>> versions;
+};
+
+} // namespace
+
+static bool isExactAssumption(IREE::Util::IntAssumptionAttr assumption) {
+  return assumption.getUmin() && assumption.getUmin() == assumption.getUmax();
+}
+
+static bool isEmptyAssumption(IREE::Util::IntAssumptionAttr assumption) {
+  return !assumption.getUmin() && !assumption.getUmax() &&
+         (!assumption.getUdiv() || *assumption.getUdiv() <= 1);
+}
+
+// Returns the versions declared by the util.assume.int op producing index
+// operands of |dispatchOp|. Each row of the assumption op is a permutation of
+// values its operands take together so only operands produced by the same
+// op are specialized.
+static VersionSet getHintedVersions(IREE::Flow::DispatchOp dispatchOp) {
+  VersionSet versionSet;
+  IREE::Util::AssumeIntOp assumeOp;
+  SmallVector<unsigned> resultIndices;
+  for (auto [index, argument] : llvm::enumerate(dispatchOp.getArguments())) {
+    if (!argument.getType().isIntOrIndex()) {
+      continue;
+    }
+    auto result = dyn_cast<OpResult>(argument);
+    if (!result) {
+      continue;
+    }
+    auto producerOp = dyn_cast<IREE::Util::AssumeIntOp>(result.getOwner());
+    if (!producerOp || (assumeOp && producerOp != assumeOp)) {
+      continue;
+    }
+    assumeOp = producerOp;
+    versionSet.operandIndices.push_back(index);
+    resultIndices.push_back(result.getResultNumber());
+  }
+  if (!assumeOp) {
+    return versionSet;
+  }
+
+  // Rows with a single assumption broadcast to the rank of the op.
+  size_t rank = 1;
+  for (unsigned resultIndex : resultIndices) {
+    rank = std::max(rank, assumeOp.getOperandAssumptions(resultIndex).size());
+  }
+  for (size_t row = 0; row < rank; ++row) {
+    SmallVector<IREE::Util::IntAssumptionAttr> version;
+    for (unsigned resultIndex : resultIndices) {
+      auto assumptions = assumeOp.getOperandAssumptions(resultIndex);
+      version.push_back(assumptions.size() == 1 ? assumptions.front()
+                                                : assumptions[row]);
+    }
+    if (llvm::all_of(version, isEmptyAssumption) ||
+        llvm::is_contained(versionSet.versions, version)) {
+      continue;
+    }
+    versionSet.versions.push_back(std::move(version));
+  }
+  return versionSet;
+}
+
+// Returns one version per value in |buckets| if |dispatchOp| has a single
+// dynamic index operand.
+static VersionSet getBucketVersions(IREE::Flow::DispatchOp dispatchOp,
+                                    ArrayRef<int64_t> buckets) {
+  VersionSet versionSet;
+  if (buckets.empty()) {
+    return versionSet;
+  }
+  for (auto [index, argument] : llvm::enumerate(dispatchOp.getArguments())) {
+    if (argument.getType().isIndex() &&
+        !matchPattern(argument, m_Constant())) {
+      versionSet.operandIndices.push_back(index);
+    }
+  }
+  if (versionSet.operandIndices.size() != 1) {
+    versionSet.operandIndices.clear();
+    return versionSet;
+  }
+  auto *context = dispatchOp.getContext();
+  for (int64_t bucket : buckets) {
+    auto assumption = IREE::Util::IntAssumptionAttr::get(
+        context, static_cast<uint64_t>(bucket), static_cast<uint64_t>(bucket),
+        std::nullopt);
+    SmallVector<IREE::Util::IntAssumptionAttr> version = {assumption};
+    if (!llvm::is_contained(versionSet.versions, version)) {
+      versionSet.versions.push_back(std::move(version));
+    }
+  }
+  return versionSet;
+}
+
+// Returns an i1 value that is true when |operands| satisfy |assumptions|.
+static Value buildVersionCondition(
+    Location loc, ValueRange operands,
+    ArrayRef<IREE::Util::IntAssumptionAttr> assumptions, OpBuilder &builder) {
+  Value condition;
+  auto appendCondition = [&](Value value) {
+    condition = condition
+                    ? builder.create<arith::AndIOp>(loc, condition, value)
+                    : value;
+  };
+  for (size_t i = 0; i < operands.size(); ++i) {
+    Value operand = operands[i];
+    auto assumption = assumptions[i];
+    auto getConstant = [&](uint64_t value) -> Value {
+      return builder.create<arith::ConstantOp>(
+          loc, builder.getIntegerAttr(operand.getType(),
+                                      static_cast<int64_t>(value)));
+    };
+    if (isExactAssumption(assumption)) {
+      appendCondition(builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::eq, operand,
+          getConstant(*assumption.getUmin())));
+      continue;
+    }
+    if (assumption.getUmin()) {
+      appendCondition(builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::uge, operand,
+          getConstant(*assumption.getUmin())));
+    }
+    if (assumption.getUmax()) {
+      appendCondition(builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::ule, operand,
+          getConstant(*assumption.getUmax())));
+    }
+    if (assumption.getUdiv() && *assumption.getUdiv() > 1) {
+      Value remainder = builder.create<arith::RemUIOp>(
+          loc, operand, getConstant(*assumption.getUdiv()));
+      appendCondition(builder.create<arith::CmpIOp>(
+          loc, arith::CmpIPredicate::eq, remainder, getConstant(0)));
+    }
+  }
+  return condition;
+}
+
+// Clones |executableOp| with the arguments of the |exportOp| function at
+// |operandIndices| specialized to |assumptions| and returns the entry point of
+// the clone. Exact assumptions are replaced with constants and the others are
+// asserted with util.assume.int so that codegen can specialize each version.
+static SymbolRefAttr
+createVersionExecutable(IREE::Flow::ExecutableOp executableOp,
+                        IREE::Flow::ExecutableExportOp exportOp,
+                        ArrayRef<unsigned> operandIndices,
+                        ArrayRef<IREE::Util::IntAssumptionAttr> assumptions,
+                        unsigned versionIndex, SymbolTable &moduleSymbolTable) {
+  OpBuilder moduleBuilder(executableOp);
+  moduleBuilder.setInsertionPointAfter(executableOp);
+  auto versionExecutableOp =
+      cast<IREE::Flow::ExecutableOp>(moduleBuilder.clone(*executableOp));
+  versionExecutableOp.setSymName(
+      (executableOp.getSymName() + "_version" + std::to_string(versionIndex))
+          .str());
+  moduleSymbolTable.insert(versionExecutableOp);
+  auto entryPoint =
+      SymbolRefAttr::get(versionExecutableOp.getSymNameAttr(),
+                         {FlatSymbolRefAttr::get(exportOp.getSymNameAttr())});
+
+  auto funcOp =
+      versionExecutableOp.getInnerModule().lookupSymbol<FunctionOpInterface>(
+          exportOp.getFunctionRef());
+  if (!funcOp || funcOp.isExternal()) {
+    return entryPoint;
+  }
+
+  auto funcBuilder = OpBuilder::atBlockBegin(&funcOp.front());
+  SmallVector<Value> assumedArgs;
+  SmallVector<ArrayAttr> assumedRows;
+  for (auto [operandIndex, assumption] :
+       llvm::zip_equal(operandIndices, assumptions)) {
+    Value arg = funcOp.getArgument(operandIndex);
+    if (isExactAssumption(assumption)) {
+      Value constant = funcBuilder.create<arith::ConstantOp>(
+          arg.getLoc(), funcBuilder.getIntegerAttr(
+                            arg.getType(),
+                            static_cast<int64_t>(*assumption.getUmin())));
+      // Workload ordinals are identities that would hide the constant from
+      // folding; codegen only needs them for values that remain dynamic.
+      for (auto *user : llvm::to_vector(arg.getUsers())) {
+        if (auto ordinalOp =
+                dyn_cast<IREE::Flow::DispatchWorkloadOrdinalOp>(user)) {
+          ordinalOp.getResult().replaceAllUsesWith(constant);
+          ordinalOp.erase();
+        }
+      }
+      arg.replaceAllUsesWith(constant);
+    } else {
+      assumedArgs.push_back(arg);
+      assumedRows.push_back(funcBuilder.getArrayAttr({assumption}));
+    }
+  }
+  if (!assumedArgs.empty()) {
+    auto assumeOp = funcBuilder.create<IREE::Util::AssumeIntOp>(
+        funcOp.getLoc(), assumedArgs, assumedRows);
+    for (auto [arg, result] :
+         llvm::zip_equal(assumedArgs, assumeOp.getResults())) {
+      arg.replaceAllUsesExcept(result, assumeOp);
+    }
+  }
+  return entryPoint;
+}
+
+// Replaces |dispatchOp| with a chain of scf.if ops selecting the first version
+// whose assumptions hold for the dispatch operands and falling back to the
+// original dispatch.
+static void
+replaceWithVersionSelection(IREE::Flow::DispatchOp dispatchOp,
+                            const VersionSet &versionSet,
+                            ArrayRef<SymbolRefAttr> versionEntryPoints) {
+  Location loc = dispatchOp.getLoc();
+  SmallVector<Value> operands;
+  for (unsigned operandIndex : versionSet.operandIndices) {
+    operands.push_back(dispatchOp.getArguments()[operandIndex]);
+  }
+
+  OpBuilder builder(dispatchOp);
+  scf::IfOp outerIfOp;
+  for (auto [versionIndex, entryPoint] : llvm::enumerate(versionEntryPoints)) {
+    Value condition = buildVersionCondition(
+        loc, operands, versionSet.versions[versionIndex], builder);
+    auto ifOp = builder.create<scf::IfOp>(loc, dispatchOp.getResultTypes(),
+                                          condition,
+                                          /*withElseRegion=*/true);
+    if (outerIfOp) {
+      builder.create<scf::YieldOp>(loc, ifOp.getResults());
+    } else {
+      outerIfOp = ifOp;
+    }
+
+    builder.setInsertionPointToStart(ifOp.thenBlock());
+    auto versionDispatchOp =
+        cast<IREE::Flow::DispatchOp>(builder.clone(*dispatchOp));
+    versionDispatchOp.setEntryPointsAttr(builder.getArrayAttr({entryPoint}));
+    builder.create<scf::YieldOp>(loc, versionDispatchOp.getResults());
+    builder.setInsertionPointToStart(ifOp.elseBlock());
+  }
+  auto fallbackDispatchOp = builder.clone(*dispatchOp);
+  builder.create<scf::YieldOp>(loc, fallbackDispatchOp->getResults());
+
+  // Reassociate the dynamic dimensions of the results that are not visible
+  // through the scf.if.
+  builder.setInsertionPointAfter(outerIfOp);
+  SmallVector<Value> results;
+  for (auto [index, result] : llvm::enumerate(outerIfOp.getResults())) {
+    ValueRange dims = dispatchOp.getResultDynamicDims(index);
+    if (dims.empty()) {
+      results.push_back(result);
+      continue;
+    }
+    results.push_back(
+        builder.create<IREE::Flow::TensorTieShapeOp>(loc, result, dims));
+  }
+  dispatchOp->replaceAllUsesWith(results);
+  dispatchOp.erase();
+}
+
+namespace {
+
+struct MultiVersionDispatchesPass
+    : public IREE::Flow::impl::MultiVersionDispatchesPassBase<
+          MultiVersionDispatchesPass> {
+  using IREE::Flow::impl::MultiVersionDispatchesPassBase<
+      MultiVersionDispatchesPass>::MultiVersionDispatchesPassBase;
+
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+    SymbolTable moduleSymbolTable(moduleOp);
+    SmallVector<int64_t> bucketValues(buckets.begin(), buckets.end());
+
+    SmallVector<IREE::Flow::DispatchOp> dispatchOps;
+    for (auto funcOp : moduleOp.getOps<FunctionOpInterface>()) {
+      funcOp.walk([&](IREE::Flow::DispatchOp dispatchOp) {
+        dispatchOps.push_back(dispatchOp);
+      });
+    }
+
+    // Versions are cached per export and assumptions such that dispatch sites
+    // sharing both share the specialized executables.
+    DenseMap<std::pair<Operation *, ArrayAttr>, SymbolRefAttr> versionCache;
+    for (auto dispatchOp : dispatchOps) {
+      // scf.if ops without results can't be built with explicit yields and
+      // dispatches without results are not worth specializing.
+      if (dispatchOp.getEntryPoints().size() != 1 ||
+          dispatchOp.getNumResults() == 0) {
+        continue;
+      }
+      VersionSet versionSet = getHintedVersions(dispatchOp);
+      if (versionSet.versions.empty()) {
+        versionSet = getBucketVersions(dispatchOp, bucketValues);
+      }
+      if (versionSet.versions.empty()) {
+        continue;
+      }
+      if (static_cast<int64_t>(versionSet.versions.size()) > maxVersions) {
+        versionSet.versions.resize(maxVersions);
+      }
+
+      auto entryPoint = *dispatchOp.getEntryPointRefs().begin();
+      auto exportOp =
+          SymbolTable::lookupNearestSymbolFrom<IREE::Flow::ExecutableExportOp>(
+              dispatchOp, entryPoint);
+      if (!exportOp) {
+        continue;
+      }
+      auto executableOp = exportOp->getParentOfType<IREE::Flow::ExecutableOp>();
+
+      Builder builder(&getContext());
+      auto operandIndicesAttr = builder.getIndexArrayAttr(
+          llvm::to_vector_of<int64_t>(versionSet.operandIndices));
+      SmallVector<SymbolRefAttr> versionEntryPoints;
+      for (auto [versionIndex, version] :
+           llvm::enumerate(versionSet.versions)) {
+        SmallVector<Attribute> key = {operandIndicesAttr};
+        llvm::append_range(key, version);
+        SymbolRefAttr &versionEntryPoint =
+            versionCache[{exportOp.getOperation(), builder.getArrayAttr(key)}];
+        if (!versionEntryPoint) {
+          versionEntryPoint = createVersionExecutable(
+              executableOp, exportOp, versionSet.operandIndices, version,
+              versionIndex, moduleSymbolTable);
+        }
+        versionEntryPoints.push_back(versionEntryPoint);
+      }
+
+      LLVM_DEBUG(llvm::dbgs() << "multi-versioning " << entryPoint << " with "
+                              << versionEntryPoints.size() << " versions\n");
+      replaceWithVersionSelection(dispatchOp, versionSet, versionEntryPoints);
+    }
+  }
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::IREE::Flow
@@ -63,6 +63,14 @@ static llvm::cl::opt<std::string> clDumpDispatchGraphOutputFile(
     llvm::cl::desc("Output file name for a dispatch graph dump."),
     llvm::cl::init("dispatch.dot"));
 
+static llvm::cl::list<int64_t> clDispatchShapeBuckets(
+    "iree-flow-dispatch-shape-buckets",
+    llvm::cl::desc(
+        "Values to specialize dispatches with a single dynamic dimension on. "
+        "Each value produces a specialized executable selected at runtime when "
+        "the dimension matches; `util.assume.int` hints take precedence."),
+    llvm::cl::CommaSeparated);
+
 static llvm::cl::opt<bool> clZeroFillEmptyTensors(
     "iree-flow-zero-fill-empty-tensors",
     llvm::cl::desc(
@@ -132,6 +140,15 @@ void buildFlowTransformPassPipeline(OpPassManager &passManager,
   // runtime profiling/tracing.
   passManager.addPass(IREE::Flow::createAnnotateDispatchesPass());
 
+  // Specialize dispatches on declared dynamic dimension values. This runs
+  // after annotation so that versions inherit the executable names and before
+  // deduplication so that versions shared across dispatch sites are merged.
+  MultiVersionDispatchesPassOptions multiVersionOptions;
+  multiVersionOptions.buckets.assign(clDispatchShapeBuckets.begin(),
+                                     clDispatchShapeBuckets.end());
+  passManager.addPass(
+      IREE::Flow::createMultiVersionDispatchesPass(multiVersionOptions));
+
   // Trace/break dispatches by ordinal in the specified region. There is a
   // similar version of the pass run both before and after deduplication
   // depending on if the target is specified by ordinal or by symbol.
@@ -0,0 +1,109 @@
+// RUN: iree-opt --split-input-file --iree-flow-multi-version-dispatches %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-flow-multi-version-dispatches="buckets=128,256" %s | FileCheck %s --check-prefix=BUCKETS
+
+// Tests that each row of the assumptions on a dynamic dimension produces a
+// specialized executable selected at the dispatch site.
+
+// CHECK-LABEL: flow.executable private @ex {
+//       CHECK:   func.func @dispatch(%[[ARG0:.+]]: !flow.dispatch.tensor<readonly:tensor<?x4xf32>>, %[[ARG1:.+]]: index
+//       CHECK:     %[[DIM:.+]] = flow.dispatch.workload.ordinal %[[ARG1]], 0
+//       CHECK:     flow.dispatch.tie_shape %[[ARG0]], %[[DIM]]
+
+// CHECK-LABEL: flow.executable private @ex_version1
+//       CHECK:   func.func @dispatch(%[[ARG0:.+]]: !flow.dispatch.tensor<readonly:tensor<?x4xf32>>, %{{.+}}: index
+//       CHECK:     %[[ASSUMED:.+]] = util.assume.int %{{.+}}<umin = 512, umax = 4096, udiv = 64> : index
+//       CHECK:     %[[DIM:.+]] = flow.dispatch.workload.ordinal %[[ASSUMED]], 0
+//       CHECK:     flow.dispatch.tie_shape %[[ARG0]], %[[DIM]]
+
+// CHECK-LABEL: flow.executable private @ex_version0
+//       CHECK:   func.func @dispatch(%[[ARG0:.+]]: !flow.dispatch.tensor<readonly:tensor<?x4xf32>>, %{{.+}}: index
+//       CHECK:     %[[C128:.+]] = arith.constant 128 : index
+//   CHECK-NOT:     flow.dispatch.workload.ordinal
+//       CHECK:     flow.dispatch.tie_shape %[[ARG0]], %[[C128]]
+
+flow.executable private @ex {
+  flow.executable.export public @dispatch workgroups(%arg0: index) -> (index, index, index) {
+    %x, %y, %z = flow.dispatch.workgroup_count_from_slice %arg0
+    flow.return %x, %y, %z : index, index, index
+  }
+  builtin.module {
+    func.func @dispatch(%arg0: !flow.dispatch.tensor<readonly:tensor<?x4xf32>>, %arg1: index, %arg2: !flow.dispatch.tensor<writeonly:tensor<?x4xf32>>) {
+      %dim = flow.dispatch.workload.ordinal %arg1, 0 : index
+      %input = flow.dispatch.tie_shape %arg0, %dim : !flow.dispatch.tensor<readonly:tensor<?x4xf32>>{%dim}
+      %output = flow.dispatch.tie_shape %arg2, %dim : !flow.dispatch.tensor<writeonly:tensor<?x4xf32>>{%dim}
+      %value = flow.dispatch.tensor.load %input, offsets = [0, 0], sizes = [%dim, 4], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<?x4xf32>>{%dim} -> tensor<?x4xf32>
+      flow.dispatch.tensor.store %value, %output, offsets = [0, 0], sizes = [%dim, 4], strides = [1, 1] : tensor<?x4xf32> -> !flow.dispatch.tensor<writeonly:tensor<?x4xf32>>{%dim}
+      return
+    }
+  }
+}
+
+// CHECK-LABEL: util.func public @hinted
+//  CHECK-SAME: (%[[INPUT:.+]]: tensor<?x4xf32>, %[[DIM_ARG:.+]]: index)
+util.func public @hinted(%input: tensor<?x4xf32>, %dim_arg: index) -> tensor<?x4xf32> {
+  // CHECK: %[[DIM:.+]] = util.assume.int
+  %dim = util.assume.int %dim_arg[<umin = 128, umax = 128>, <umin = 512, umax = 4096, udiv = 64>] : index
+  //      CHECK: %[[IS_V0:.+]] = arith.cmpi eq, %[[DIM]], %c128
+  //      CHECK: %[[RESULT:.+]] = scf.if %[[IS_V0]] -> (tensor<?x4xf32>) {
+  // CHECK-NEXT:   %[[V0:.+]] = flow.dispatch @ex_version0::@dispatch[%[[DIM]]](%[[INPUT]], %[[DIM]])
+  // CHECK-NEXT:   scf.yield %[[V0]]
+  // CHECK-NEXT: } else {
+  //      CHECK:   %[[GE:.+]] = arith.cmpi uge, %[[DIM]], %c512
+  //      CHECK:   %[[LE:.+]] = arith.cmpi ule, %[[DIM]], %c4096
+  //      CHECK:   %[[RANGE:.+]] = arith.andi %[[GE]], %[[LE]]
+  //      CHECK:   %[[REM:.+]] = arith.remui %[[DIM]], %c64
+  //      CHECK:   %[[DIV:.+]] = arith.cmpi eq, %[[REM]], %c0
+  //      CHECK:   %[[IS_V1:.+]] = arith.andi %[[RANGE]], %[[DIV]]
+  //      CHECK:   %[[INNER:.+]] = scf.if %[[IS_V1]] -> (tensor<?x4xf32>) {
+  // CHECK-NEXT:     %[[V1:.+]] = flow.dispatch @ex_version1::@dispatch[%[[DIM]]](%[[INPUT]], %[[DIM]])
+  // CHECK-NEXT:     scf.yield %[[V1]]
+  // CHECK-NEXT:   } else {
+  // CHECK-NEXT:     %[[FALLBACK:.+]] = flow.dispatch @ex::@dispatch[%[[DIM]]](%[[INPUT]], %[[DIM]])
+  // CHECK-NEXT:     scf.yield %[[FALLBACK]]
+  // CHECK-NEXT:   }
+  // CHECK-NEXT:   scf.yield %[[INNER]]
+  // CHECK-NEXT: }
+  //      CHECK: %[[TIED:.+]] = flow.tensor.tie_shape %[[RESULT]] : tensor<?x4xf32>{%[[DIM]]}
+  %0 = flow.dispatch @ex::@dispatch[%dim](%input, %dim) : (tensor<?x4xf32>{%dim}, index) -> tensor<?x4xf32>{%dim}
+  // CHECK: util.return %[[TIED]]
+  util.return %0 : tensor<?x4xf32>
+}
+
+// -----
+
+// Dispatches without hints are only specialized when buckets are specified.
+
+// CHECK-LABEL: util.func public @unhinted
+//   CHECK-NOT:   scf.if
+//       CHECK:   flow.dispatch @ex2::@dispatch
+
+// BUCKETS-LABEL: util.func public @unhinted
+//  BUCKETS-SAME: (%[[INPUT:.+]]: tensor<?x4xf32>, %[[DIM:.+]]: index)
+//       BUCKETS:   arith.cmpi eq, %[[DIM]], %c128
+//       BUCKETS:   scf.if
+//       BUCKETS:     flow.dispatch @ex2_version0::@dispatch
+//       BUCKETS:     arith.cmpi eq, %[[DIM]], %c256
+//       BUCKETS:     scf.if
+//       BUCKETS:       flow.dispatch @ex2_version1::@dispatch
+//       BUCKETS:       flow.dispatch @ex2::@dispatch
+flow.executable private @ex2 {
+  flow.executable.export public @dispatch workgroups(%arg0: index) -> (index, index, index) {
+    %x, %y, %z = flow.dispatch.workgroup_count_from_slice %arg0
+    flow.return %x, %y, %z : index, index, index
+  }
+  builtin.module {
+    func.func @dispatch(%arg0: !flow.dispatch.tensor<readonly:tensor<?x4xf32>>, %arg1: index, %arg2: !flow.dispatch.tensor<writeonly:tensor<?x4xf32>>) {
+      %dim = flow.dispatch.workload.ordinal %arg1, 0 : index
+      %input = flow.dispatch.tie_shape %arg0, %dim : !flow.dispatch.tensor<readonly:tensor<?x4xf32>>{%dim}
+      %output = flow.dispatch.tie_shape %arg2, %dim : !flow.dispatch.tensor<writeonly:tensor<?x4xf32>>{%dim}
+      %value = flow.dispatch.tensor.load %input, offsets = [0, 0], sizes = [%dim, 4], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<?x4xf32>>{%dim} -> tensor<?x4xf32>
+      flow.dispatch.tensor.store %value, %output, offsets = [0, 0], sizes = [%dim, 4], strides = [1, 1] : tensor<?x4xf32> -> !flow.dispatch.tensor<writeonly:tensor<?x4xf32>>{%dim}
+      return
+    }
+  }
+}
+
+util.func public @unhinted(%input: tensor<?x4xf32>, %dim: index) -> tensor<?x4xf32> {
+  %0 = flow.dispatch @ex2::@dispatch[%dim](%input, %dim) : (tensor<?x4xf32>{%dim}, index) -> tensor<?x4xf32>{%dim}
+  util.return %0 : tensor<?x4xf32>
+}
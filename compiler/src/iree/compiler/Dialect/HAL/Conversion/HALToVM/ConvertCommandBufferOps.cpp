@@ -10,6 +10,7 @@
 #include "iree/compiler/Dialect/VM/IR/VMOps.h"
 #include "llvm/ADT/STLExtras.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
 #include "mlir/Transforms/DialectConversion.h"
 
 namespace mlir::iree_compiler {
@@ -320,21 +321,73 @@ private:
   mutable IREE::VM::ImportOp importOp;
 };
 
+// Maximum number of dispatches recorded with a single batched call.
+static constexpr size_t kMaxDispatchBatchSize = 64;
+// Maximum total number of constants or bindings in a single batched call.
+// Variadic segment sizes are encoded as int16_t.
+static constexpr size_t kMaxDispatchBatchOperands = 4096;
+
+// Returns the run of dispatches starting at |op| that record into the same
+// command buffer with the same executable. Only ops without side effects may
+// be interleaved between the dispatches so that the batch can be recorded at
+// the position of the last dispatch in the run.
+static SmallVector<IREE::HAL::CommandBufferDispatchOp>
+gatherDispatchBatch(IREE::HAL::CommandBufferDispatchOp op) {
+  SmallVector<IREE::HAL::CommandBufferDispatchOp> batch = {op};
+  size_t constantCount = op.getConstants().size();
+  size_t bindingCount = op.getBindingBuffers().size();
+  for (Operation *nextOp = op->getNextNode();
+       nextOp && batch.size() < kMaxDispatchBatchSize;
+       nextOp = nextOp->getNextNode()) {
+    auto dispatchOp = dyn_cast<IREE::HAL::CommandBufferDispatchOp>(nextOp);
+    if (!dispatchOp) {
+      if (nextOp->getNumRegions() > 0 || !isMemoryEffectFree(nextOp)) {
+        break;
+      }
+      continue;
+    }
+    if (dispatchOp.getCommandBuffer() != op.getCommandBuffer() ||
+        dispatchOp.getExecutable() != op.getExecutable()) {
+      break;
+    }
+    constantCount += dispatchOp.getConstants().size();
+    bindingCount += dispatchOp.getBindingBuffers().size();
+    if (constantCount > kMaxDispatchBatchOperands ||
+        bindingCount > kMaxDispatchBatchOperands) {
+      break;
+    }
+    batch.push_back(dispatchOp);
+  }
+  return batch;
+}
+
+// Converts a dispatch to a call of the dispatch import. Runs of dispatches
+// against the same command buffer and executable are instead recorded with a
+// single call to the batched dispatch import to amortize the cost of crossing
+// the import boundary.
 class CommandBufferDispatchOpConversion
     : public OpConversionPattern<IREE::HAL::CommandBufferDispatchOp> {
 public:
   CommandBufferDispatchOpConversion(MLIRContext *context,
                                     SymbolTable &importSymbols,
                                     TypeConverter &typeConverter,
-                                    StringRef importName)
+                                    StringRef importName,
+                                    StringRef batchImportName)
       : OpConversionPattern(typeConverter, context) {
     importOp = importSymbols.lookup<IREE::VM::ImportOp>(importName);
     assert(importOp);
+    batchImportOp = importSymbols.lookup<IREE::VM::ImportOp>(batchImportName);
+    assert(batchImportOp);
   }
 
   LogicalResult
   matchAndRewrite(IREE::HAL::CommandBufferDispatchOp op, OpAdaptor adaptor,
                   ConversionPatternRewriter &rewriter) const override {
+    auto batch = gatherDispatchBatch(op);
+    if (batch.size() > 1) {
+      return rewriteBatch(batch, rewriter);
+    }
+
     auto importType = importOp.getFunctionType();
 
     auto i32Type = rewriter.getI32Type();
@@ -393,7 +446,110 @@ public:
   }
 
 private:
+  LogicalResult
+  rewriteBatch(ArrayRef<IREE::HAL::CommandBufferDispatchOp> batch,
+               ConversionPatternRewriter &rewriter) const {
+    // Remap all operands up-front so that we can bail before changing the IR.
+    SmallVector<SmallVector<Value>> batchOperands;
+    batchOperands.reserve(batch.size());
+    for (auto dispatchOp : batch) {
+      SmallVector<Value> operands;
+      if (failed(rewriter.getRemappedValues(dispatchOp->getOperands(),
+                                            operands))) {
+        return rewriter.notifyMatchFailure(dispatchOp,
+                                           "failed to remap dispatch operands");
+      }
+      batchOperands.push_back(std::move(operands));
+    }
+
+    // All operands of the batch dominate the last dispatch in the run.
+    OpBuilder::InsertionGuard guard(rewriter);
+    rewriter.setInsertionPoint(batch.back());
+    auto loc = rewriter.getFusedLoc(llvm::map_to_vector(
+        batch, [](IREE::HAL::CommandBufferDispatchOp dispatchOp) {
+          return dispatchOp.getLoc();
+        }));
+
+    auto i32Type = rewriter.getI32Type();
+    auto i64Type = rewriter.getI64Type();
+    Value zeroI32 = rewriter.create<IREE::VM::ConstI32ZeroOp>(loc);
+
+    SmallVector<Value> constantOperands;
+    SmallVector<Value> bindingOperands;
+    SmallVector<Value> dispatchOperands;
+    for (auto [dispatchOp, operands] : llvm::zip_equal(batch, batchOperands)) {
+      IREE::HAL::CommandBufferDispatchOp::Adaptor adaptor(operands,
+                                                          dispatchOp);
+      llvm::append_range(constantOperands, adaptor.getConstants());
+      for (auto [bindingBufferOrSlot, bindingOffset, bindingLength] :
+           llvm::zip_equal(adaptor.getBindingBuffers(),
+                           adaptor.getBindingOffsets(),
+                           adaptor.getBindingLengths())) {
+        bindingOperands.push_back(zeroI32);
+        auto [bindingBufferSlot, bindingBuffer] =
+            splitBufferSlot(loc, bindingBufferOrSlot, rewriter);
+        bindingOperands.push_back(bindingBufferSlot);
+        bindingOperands.push_back(bindingBuffer);
+        bindingOperands.push_back(
+            castToImportType(bindingOffset, i64Type, rewriter));
+        bindingOperands.push_back(
+            castToImportType(bindingLength, i64Type, rewriter));
+      }
+      auto flags =
+          adaptor.getFlagsAttr()
+              ? rewriter
+                    .create<IREE::VM::ConstI64Op>(
+                        loc, adaptor.getFlagsAttr().getInt())
+                    .getResult()
+              : rewriter.create<IREE::VM::ConstI64ZeroOp>(loc).getResult();
+      dispatchOperands.append({
+          castToImportType(adaptor.getEntryPoint(), i32Type, rewriter),
+          castToImportType(adaptor.getWorkgroupX(), i32Type, rewriter),
+          castToImportType(adaptor.getWorkgroupY(), i32Type, rewriter),
+          castToImportType(adaptor.getWorkgroupZ(), i32Type, rewriter),
+          rewriter
+              .create<IREE::VM::ConstI32Op>(
+                  loc, static_cast<int32_t>(adaptor.getConstants().size()))
+              .getResult(),
+          rewriter
+              .create<IREE::VM::ConstI32Op>(
+                  loc,
+                  static_cast<int32_t>(adaptor.getBindingBuffers().size()))
+              .getResult(),
+          flags,
+      });
+    }
+
+    IREE::HAL::CommandBufferDispatchOp::Adaptor firstAdaptor(
+        batchOperands.front(), batch.front());
+    SmallVector<Value> callOperands = {
+        firstAdaptor.getCommandBuffer(),
+        firstAdaptor.getExecutable(),
+    };
+    SmallVector<int16_t, 5> segmentSizes = {
+        /*command_buffer=*/-1,
+        /*executable=*/-1,
+        /*constants=*/static_cast<int16_t>(constantOperands.size()),
+        /*bindings=*/static_cast<int16_t>(bindingOperands.size() / 5),
+        /*dispatches=*/static_cast<int16_t>(batch.size()),
+    };
+    llvm::append_range(callOperands, constantOperands);
+    llvm::append_range(callOperands, bindingOperands);
+    llvm::append_range(callOperands, dispatchOperands);
+
+    auto importType = batchImportOp.getFunctionType();
+    auto callOp = rewriter.create<IREE::VM::CallVariadicOp>(
+        loc, SymbolRefAttr::get(batchImportOp), importType.getResults(),
+        segmentSizes, importType.getInputs(), callOperands);
+    copyImportAttrs(batchImportOp, callOp);
+    for (auto dispatchOp : batch) {
+      rewriter.eraseOp(dispatchOp);
+    }
+    return success();
+  }
+
   mutable IREE::VM::ImportOp importOp;
+  mutable IREE::VM::ImportOp batchImportOp;
 };
 
 class CommandBufferDispatchIndirectOpConversion
@@ -508,7 +664,8 @@ void populateHALCommandBufferToVMPatterns(MLIRContext *context,
   patterns.insert<CommandBufferCollectiveOpConversion>(
       context, importSymbols, typeConverter, "hal.command_buffer.collective");
   patterns.insert<CommandBufferDispatchOpConversion>(
-      context, importSymbols, typeConverter, "hal.command_buffer.dispatch");
+      context, importSymbols, typeConverter, "hal.command_buffer.dispatch",
+      "hal.command_buffer.dispatch.batch");
   patterns.insert<CommandBufferDispatchIndirectOpConversion>(
       context, importSymbols, typeConverter,
       "hal.command_buffer.dispatch.indirect");
@@ -343,6 +343,61 @@ util.func public @command_buffer_dispatch(
 
 // -----
 
+// CHECK-LABEL: @command_buffer_dispatch_batch
+//  CHECK-SAME: (%[[CMD:.+]]: !vm.ref<!hal.command_buffer>,
+//  CHECK-SAME:  %[[EXECUTABLE:.+]]: !vm.ref<!hal.executable>,
+//  CHECK-SAME:  %[[BUFFER:.+]]: !vm.ref<!hal.buffer>)
+util.func public @command_buffer_dispatch_batch(
+  %cmd: !hal.command_buffer,
+  %executable: !hal.executable,
+  %buffer: !hal.buffer
+) {
+  // CHECK-DAG: %[[C0:.+]] = vm.const.i32.zero
+  // CHECK-DAG: %[[C1:.+]] = vm.const.i32 1
+  // CHECK-DAG: %[[ORDINAL0:.+]] = vm.const.i32 10
+  %ordinal0 = arith.constant 10 : index
+  // CHECK-DAG: %[[ORDINAL1:.+]] = vm.const.i32 11
+  %ordinal1 = arith.constant 11 : index
+  // CHECK-DAG: %[[X:.+]] = vm.const.i32 100
+  %x = arith.constant 100 : index
+  // CHECK-DAG: %[[Y1:.+]] = vm.const.i32 2
+  // CHECK-DAG: %[[CONSTANT0:.+]] = vm.const.i32 31
+  %constant0 = arith.constant 31 : i32
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c4096 = arith.constant 4096 : index
+  // CHECK-DAG: %[[FLAGS:.+]] = vm.const.i64.zero
+  // CHECK-NOT: vm.call.variadic @hal.command_buffer.dispatch(
+  // CHECK: vm.call.variadic @hal.command_buffer.dispatch.batch
+  // CHECK-SAME: %[[CMD]], %[[EXECUTABLE]],
+  // CHECK-SAME: [%[[CONSTANT0]]],
+  // CHECK-SAME: [(%[[C0]], %[[C0]], %[[BUFFER]], %{{.+}}, %c4096),
+  // CHECK-SAME:  (%[[C0]], %[[C0]], %[[BUFFER]], %{{.+}}, %c4096)],
+  // CHECK-SAME: [(%[[ORDINAL0]], %[[X]], %[[C1]], %[[C1]], %[[C1]], %[[C1]], %[[FLAGS]]),
+  // CHECK-SAME:  (%[[ORDINAL1]], %[[X]], %[[Y1]], %[[C1]], %[[C0]], %[[C1]], %[[FLAGS]])]
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer>
+      target(%executable : !hal.executable)[%ordinal0]
+      workgroups([%x, %c1, %c1])
+      constants([%constant0])
+      bindings([
+        (%buffer : !hal.buffer)[%c0, %c4096]
+      ])
+      flags(None)
+  // Pure ops between dispatches do not split the batch.
+  %y1 = arith.constant 2 : index
+  hal.command_buffer.dispatch<%cmd : !hal.command_buffer>
+      target(%executable : !hal.executable)[%ordinal1]
+      workgroups([%x, %y1, %c1])
+      bindings([
+        (%buffer : !hal.buffer)[%c0, %c4096]
+      ])
+      flags(None)
+  // CHECK-NOT: vm.call.variadic @hal.command_buffer.dispatch
+  util.return
+}
+
+// -----
+
 // CHECK-LABEL: vm.func private @command_buffer_dispatch
 //  CHECK-SAME: (%[[CMD:[a-z0-9]+]]: !vm.ref<!hal.command_buffer>,
 //  CHECK-SAME:  %[[EXECUTABLE:[a-z0-9]+]]: !vm.ref<!hal.executable>,
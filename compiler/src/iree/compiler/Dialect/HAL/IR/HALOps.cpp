@@ -2102,6 +2102,23 @@ void InterfaceWorkgroupSizeOp::getAsmResultNames(
                                            getResult(), setNameFn);
 }
 
+//===----------------------------------------------------------------------===//
+// hal.instrument.memory.summary
+//===----------------------------------------------------------------------===//
+
+LogicalResult InstrumentMemorySummaryOp::verify() {
+  InstrumentMemorySummaryOp op = *this;
+  // Matches iree_instrument_dispatch_memory_summary_t: load count/bytes, store
+  // count/bytes, and IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_COUNT buckets.
+  constexpr size_t kCounterCount = 4 + 5;
+  if (op.getCounters().size() != kCounterCount) {
+    return op.emitOpError("expected ")
+           << kCounterCount << " counters but got "
+           << op.getCounters().size();
+  }
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 // hal.fence.*
 //===----------------------------------------------------------------------===//
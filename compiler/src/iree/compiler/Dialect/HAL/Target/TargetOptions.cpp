@@ -93,6 +93,23 @@ void TargetOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Path to write translated and serialized executable binaries into."),
       llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-hal-executable-cache-path", executableCachePath,
+      llvm::cl::desc(
+          "Directory used to cache serialized executable binaries keyed by "
+          "their translated IR, target, and debug level. Entries do not "
+          "capture compiler flags or version and the directory should be "
+          "cleared when either changes."),
+      llvm::cl::cat(halTargetOptionsCategory));
+
+  binder.opt<std::string>(
+      "iree-compile-report", compileReportPath,
+      llvm::cl::desc(
+          "Path to write a JSON report of each executable's selected lowering "
+          "pipeline, tile sizes, estimated cost, translation and "
+          "serialization time, and binary size to (- for stdout)."),
+      llvm::cl::cat(halTargetOptionsCategory));
 }
 
 } // namespace mlir::iree_compiler::IREE::HAL
@@ -76,6 +76,13 @@ struct TargetOptions {
   // A path to write translated and serialized executable binaries into.
   std::string executableBinariesPath;
 
+  // A directory used to cache serialized executable binaries across compiler
+  // invocations. Disabled if empty.
+  std::string executableCachePath;
+
+  // A path to write the per-executable compile report JSON to.
+  std::string compileReportPath;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<TargetOptions>;
 };
@@ -0,0 +1,266 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <optional>
+
+#include "iree/compiler/Codegen/Dialect/Codegen/IR/IREECodegenAttrs.h"
+#include "iree/compiler/Dialect/Flow/IR/FlowTypes.h"
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/Support/JSON.h"
+#include "mlir/Dialect/Linalg/IR/LinalgInterfaces.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+#include "mlir/Support/FileUtilities.h"
+
+namespace mlir::iree_compiler::IREE::HAL {
+
+#define GEN_PASS_DEF_CAPTURECOMPILEREPORTPASS
+#define GEN_PASS_DEF_DUMPCOMPILEREPORTPASS
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h.inc"
+
+// Dictionary attribute on hal.executable ops accumulating report entries as
+// the executable moves through the pipeline.
+static const char kCompileReportAttrName[] = "hal.compile_report";
+
+void setCompileReportEntry(IREE::HAL::ExecutableOp executableOp,
+                           StringRef key, Attribute value) {
+  auto reportAttr =
+      executableOp->getAttrOfType<DictionaryAttr>(kCompileReportAttrName);
+  if (!reportAttr) {
+    return;
+  }
+  NamedAttrList attrs(reportAttr);
+  attrs.set(key, value);
+  executableOp->setAttr(kCompileReportAttrName,
+                        attrs.getDictionary(executableOp.getContext()));
+}
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// --iree-hal-capture-compile-report
+//===----------------------------------------------------------------------===//
+
+// Returns the total static byte size of |type| or nullopt if dynamic.
+static std::optional<int64_t> getStaticByteSize(Type type) {
+  if (auto dispatchTensorType =
+          dyn_cast<IREE::Flow::DispatchTensorType>(type)) {
+    type = dispatchTensorType.getBoundType();
+  }
+  auto shapedType = dyn_cast<ShapedType>(type);
+  if (!shapedType || !shapedType.hasStaticShape() ||
+      !shapedType.getElementType().isIntOrFloat()) {
+    return std::nullopt;
+  }
+  int64_t elementBits = shapedType.getElementTypeBitWidth();
+  return shapedType.getNumElements() * ((elementBits + 7) / 8);
+}
+
+// Returns an estimate of the operations performed by |funcOp| counted as one
+// operation per payload op per iteration, or nullopt if any loop is dynamic.
+static std::optional<int64_t> estimateFlops(FunctionOpInterface funcOp) {
+  int64_t totalFlops = 0;
+  bool isDynamic = false;
+  funcOp.walk([&](linalg::LinalgOp linalgOp) {
+    int64_t iterationCount = 1;
+    for (int64_t range : linalgOp.getStaticLoopRanges()) {
+      if (ShapedType::isDynamic(range)) {
+        isDynamic = true;
+        return WalkResult::interrupt();
+      }
+      iterationCount *= range;
+    }
+    int64_t payloadOpCount = std::max<int64_t>(
+        1, linalgOp.getBlock()->getOperations().size() - 1);
+    totalFlops += iterationCount * payloadOpCount;
+    return WalkResult::advance();
+  });
+  if (isDynamic) {
+    return std::nullopt;
+  }
+  return totalFlops;
+}
+
+// Returns the number of bytes bound to |funcOp| through its interface bindings
+// or nullopt if any binding is dynamically shaped.
+static std::optional<int64_t> estimateBytes(FunctionOpInterface funcOp) {
+  int64_t totalBytes = 0;
+  bool isDynamic = false;
+  funcOp.walk([&](IREE::HAL::InterfaceBindingSubspanOp subspanOp) {
+    auto byteSize = getStaticByteSize(subspanOp.getType());
+    if (!byteSize) {
+      isDynamic = true;
+      return WalkResult::interrupt();
+    }
+    totalBytes += *byteSize;
+    return WalkResult::advance();
+  });
+  if (isDynamic) {
+    return std::nullopt;
+  }
+  return totalBytes;
+}
+
+// Returns a dictionary describing how |exportOp| is configured for
+// translation. Fields that are not known are omitted.
+static DictionaryAttr
+captureExportReport(IREE::HAL::ExecutableVariantOp variantOp,
+                    IREE::HAL::ExecutableExportOp exportOp,
+                    SymbolTable &symbolTable) {
+  Builder builder(exportOp.getContext());
+  NamedAttrList attrs;
+  attrs.set("variant", variantOp.getSymNameAttr());
+  attrs.set("export", exportOp.getSymNameAttr());
+  auto funcOp = symbolTable.lookup<FunctionOpInterface>(exportOp.getSymName());
+  if (!funcOp) {
+    return attrs.getDictionary(exportOp.getContext());
+  }
+  if (auto translationInfo = getTranslationInfo(funcOp)) {
+    attrs.set("pipeline",
+              builder.getStringAttr(IREE::Codegen::stringifyEnum(
+                  translationInfo.getDispatchLoweringPassPipeline())));
+  }
+  funcOp.walk([&](Operation *op) {
+    auto loweringConfig = getLoweringConfig(op);
+    if (!loweringConfig) {
+      return WalkResult::advance();
+    }
+    attrs.set("workgroup_tile_sizes",
+              builder.getDenseI64ArrayAttr(
+                  loweringConfig.getWorkgroupTileSizes()));
+    return WalkResult::interrupt();
+  });
+  if (auto flops = estimateFlops(funcOp)) {
+    attrs.set("flops", builder.getI64IntegerAttr(*flops));
+  }
+  if (auto bytes = estimateBytes(funcOp)) {
+    attrs.set("bytes", builder.getI64IntegerAttr(*bytes));
+  }
+  return attrs.getDictionary(exportOp.getContext());
+}
+
+struct CaptureCompileReportPass
+    : public IREE::HAL::impl::CaptureCompileReportPassBase<
+          CaptureCompileReportPass> {
+  void runOnOperation() override {
+    auto executableOp = getOperation();
+    SmallVector<Attribute> exportAttrs;
+    for (auto variantOp :
+         executableOp.getOps<IREE::HAL::ExecutableVariantOp>()) {
+      if (variantOp.isExternal()) {
+        continue;
+      }
+      SymbolTable symbolTable(variantOp.getInnerModule());
+      for (auto exportOp : variantOp.getExportOps()) {
+        exportAttrs.push_back(
+            captureExportReport(variantOp, exportOp, symbolTable));
+      }
+    }
+    Builder builder(executableOp.getContext());
+    NamedAttrList attrs;
+    attrs.set("exports", builder.getArrayAttr(exportAttrs));
+    executableOp->setAttr(kCompileReportAttrName,
+                          attrs.getDictionary(executableOp.getContext()));
+  }
+};
+
+//===----------------------------------------------------------------------===//
+// --iree-hal-dump-compile-report
+//===----------------------------------------------------------------------===//
+
+// Writes |attr| as a JSON value. Only the attribute kinds produced by the
+// capture passes are supported.
+static void writeJSONValue(llvm::json::OStream &json, Attribute attr) {
+  if (auto stringAttr = dyn_cast<StringAttr>(attr)) {
+    json.value(stringAttr.getValue());
+  } else if (auto integerAttr = dyn_cast<IntegerAttr>(attr)) {
+    json.value(integerAttr.getInt());
+  } else if (auto arrayAttr = dyn_cast<DenseI64ArrayAttr>(attr)) {
+    json.array([&] {
+      for (int64_t value : arrayAttr.asArrayRef()) {
+        json.value(value);
+      }
+    });
+  } else if (auto arrayAttr = dyn_cast<ArrayAttr>(attr)) {
+    json.array([&] {
+      for (auto elementAttr : arrayAttr) {
+        writeJSONValue(json, elementAttr);
+      }
+    });
+  } else if (auto dictionaryAttr = dyn_cast<DictionaryAttr>(attr)) {
+    json.object([&] {
+      for (auto namedAttr : dictionaryAttr) {
+        json.attributeBegin(namedAttr.getName().getValue());
+        writeJSONValue(json, namedAttr.getValue());
+        json.attributeEnd();
+      }
+    });
+  } else {
+    std::string str;
+    llvm::raw_string_ostream os(str);
+    attr.print(os);
+    json.value(os.str());
+  }
+}
+
+struct DumpCompileReportPass
+    : public IREE::HAL::impl::DumpCompileReportPassBase<DumpCompileReportPass> {
+  using IREE::HAL::impl::DumpCompileReportPassBase<
+      DumpCompileReportPass>::DumpCompileReportPassBase;
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+
+    // Gather and strip the reports so they don't leak into the output.
+    SmallVector<std::pair<IREE::HAL::ExecutableOp, DictionaryAttr>> reports;
+    for (auto executableOp : moduleOp.getOps<IREE::HAL::ExecutableOp>()) {
+      auto reportAttr =
+          executableOp->getAttrOfType<DictionaryAttr>(kCompileReportAttrName);
+      if (!reportAttr) {
+        continue;
+      }
+      executableOp->removeAttr(kCompileReportAttrName);
+      reports.push_back({executableOp, reportAttr});
+    }
+    if (path.empty()) {
+      return;
+    }
+
+    std::string error;
+    auto file = mlir::openOutputFile(path, &error);
+    if (!file) {
+      moduleOp.emitError() << "while writing compile report to " << path
+                           << ": " << error;
+      return signalPassFailure();
+    }
+    llvm::json::OStream json(file->os(), /*IndentSize=*/2);
+    json.object([&] {
+      json.attribute("module", moduleOp.getName().value_or("module"));
+      json.attributeArray("executables", [&] {
+        for (auto [executableOp, reportAttr] : reports) {
+          json.object([&] {
+            json.attribute("name", executableOp.getName());
+            for (auto namedAttr : reportAttr) {
+              json.attributeBegin(namedAttr.getName().getValue());
+              writeJSONValue(json, namedAttr.getValue());
+              json.attributeEnd();
+            }
+          });
+        }
+      });
+    });
+    file->os() << "\n";
+    file->keep();
+  }
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::IREE::HAL
@@ -0,0 +1,169 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "llvm/ADT/MapVector.h"
+#include "llvm/Support/xxhash.h"
+#include "mlir/IR/AttrTypeSubElements.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/Pass/Pass.h"
+
+namespace mlir::iree_compiler::IREE::HAL {
+
+#define GEN_PASS_DEF_DEDUPLICATEEXECUTABLESPASS
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h.inc"
+
+namespace {
+
+// Serialized contents of a single hal.executable.binary op.
+struct BinaryContents {
+  StringAttr name;
+  StringAttr format;
+  StringAttr mimeType;
+  SmallVector<char> data;
+
+  bool operator==(const BinaryContents &other) const {
+    return name == other.name && format == other.format &&
+           mimeType == other.mimeType && data == other.data;
+  }
+};
+
+// Serialized contents of all binaries within a hal.executable op.
+struct ExecutableContents {
+  IREE::HAL::ExecutableOp executableOp;
+  SmallVector<BinaryContents> binaries;
+};
+
+// Serializes all binaries in |executableOp| into |contents|.
+// Returns failure if the executable contains anything other than binaries (it
+// has not been serialized) or any binary cannot be serialized.
+static LogicalResult gatherContents(IREE::HAL::ExecutableOp executableOp,
+                                    ExecutableContents &contents) {
+  contents.executableOp = executableOp;
+  for (auto &op : executableOp.getBody().front()) {
+    if (isa<IREE::HAL::ExecutableEndOp>(op))
+      continue;
+    auto binaryOp = dyn_cast<IREE::HAL::ExecutableBinaryOp>(op);
+    if (!binaryOp)
+      return failure();
+    BinaryContents binary;
+    binary.name = binaryOp.getSymNameAttr();
+    binary.format = binaryOp.getFormatAttr();
+    binary.mimeType = binaryOp.getMimeTypeAttr();
+    auto dataAttr =
+        cast<IREE::Util::SerializableAttrInterface>(binaryOp.getData());
+    if (failed(dataAttr.serializeToVector(binaryOp.getLoc(),
+                                          llvm::endianness::little,
+                                          binary.data))) {
+      return failure();
+    }
+    contents.binaries.push_back(std::move(binary));
+  }
+  return success(!contents.binaries.empty());
+}
+
+static uint64_t hashContents(const ExecutableContents &contents) {
+  llvm::hash_code hash(contents.binaries.size());
+  for (auto &binary : contents.binaries) {
+    hash = llvm::hash_combine(
+        hash, binary.name, binary.format, binary.mimeType,
+        llvm::xxh3_64bits(ArrayRef<uint8_t>(
+            reinterpret_cast<const uint8_t *>(binary.data.data()),
+            binary.data.size())));
+  }
+  return hash_value(hash);
+}
+
+// Replaces the root reference of all symbol references to executables in
+// |replacements| with the executable they are a duplicate of. Binaries are
+// compared by name so nested references remain valid.
+static void
+replaceSymbolRefs(mlir::ModuleOp moduleOp,
+                  const DenseMap<StringAttr, StringAttr> &replacements) {
+  AttrTypeReplacer replacer;
+  replacer.addReplacement([&](SymbolRefAttr oldAttr) {
+    auto it = replacements.find(oldAttr.getRootReference());
+    if (it == replacements.end())
+      return std::make_pair(oldAttr, WalkResult::skip());
+    return std::make_pair(
+        SymbolRefAttr::get(it->second, oldAttr.getNestedReferences()),
+        WalkResult::skip());
+  });
+  moduleOp.walk([&](Operation *op) {
+    if (isa<IREE::HAL::ExecutableOp>(op))
+      return WalkResult::skip();
+    replacer.replaceElementsIn(op);
+    return WalkResult::advance();
+  });
+}
+
+//===----------------------------------------------------------------------===//
+// --iree-hal-deduplicate-executables
+//===----------------------------------------------------------------------===//
+
+struct DeduplicateExecutablesPass
+    : public IREE::HAL::impl::DeduplicateExecutablesPassBase<
+          DeduplicateExecutablesPass> {
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+
+    // Bucket all private serialized executables by the hash of their contents.
+    // Executables that have not been serialized (or are public and may be
+    // referenced externally) are left as-is.
+    llvm::MapVector<uint64_t, SmallVector<ExecutableContents>> bucketMap;
+    for (auto executableOp : moduleOp.getOps<IREE::HAL::ExecutableOp>()) {
+      if (!executableOp.isPrivate())
+        continue;
+      ExecutableContents contents;
+      if (failed(gatherContents(executableOp, contents)))
+        continue;
+      bucketMap[hashContents(contents)].push_back(std::move(contents));
+    }
+
+    // For each executable find the first executable in its bucket with
+    // identical binaries and record the replacement. Hash collisions are
+    // resolved by comparing the full contents.
+    SmallVector<IREE::HAL::ExecutableOp> deadOps;
+    DenseMap<StringAttr, StringAttr> replacements;
+    for (auto &[hash, bucket] : bucketMap) {
+      (void)hash;
+      for (size_t i = 1; i < bucket.size(); ++i) {
+        for (size_t j = 0; j < i; ++j) {
+          if (replacements.contains(
+                  bucket[j].executableOp.getSymNameAttr()) ||
+              bucket[i].binaries != bucket[j].binaries) {
+            continue;
+          }
+          auto duplicateOp = bucket[i].executableOp;
+          auto referenceOp = bucket[j].executableOp;
+          replacements[duplicateOp.getSymNameAttr()] =
+              referenceOp.getSymNameAttr();
+          referenceOp->setLoc(FusedLoc::get(
+              &getContext(), {referenceOp.getLoc(), duplicateOp.getLoc()}));
+          deadOps.push_back(duplicateOp);
+          break;
+        }
+      }
+    }
+    if (replacements.empty())
+      return;
+
+    // Redirect all references to the duplicates and drop them. We could rely
+    // on SymbolDCE for the removal but dead executables in IR dumps are
+    // confusing.
+    replaceSymbolRefs(moduleOp, replacements);
+    for (auto deadOp : deadOps)
+      deadOp.erase();
+  }
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::IREE::HAL
@@ -219,70 +219,24 @@ static IREE::Util::GlobalOp appendGlobalBuffer(
   return globalOp;
 }
 
-// Appends a function calling the given |exportOp| with |dispatchParams|.
-// This will add a global value for the resources required.
-//
-// Expects the runner to pass an i32 value indicating the number of dispatches
-// to be made in one submission.
-static void appendDispatchBenchmark(IREE::Stream::AffinityAttr affinityAttr,
-                                    IREE::HAL::ExecutableOp executableOp,
-                                    IREE::HAL::ExecutableVariantOp variantOp,
-                                    IREE::HAL::ExecutableExportOp exportOp,
-                                    DispatchParams dispatchParams,
-                                    OpBuilder &moduleBuilder) {
-  auto loc = FusedLoc::get(executableOp.getContext(), dispatchParams.locs);
-
-  std::string baseName = (executableOp.getName() + "_" + variantOp.getName() +
-                          "_" + exportOp.getName())
-                             .str();
-  if (!dispatchParams.workload.empty()) {
-    baseName += "_" + std::to_string(dispatchParams.workload[0]);
-    for (size_t i = 1; i < dispatchParams.workload.size(); ++i) {
-      baseName += "x" + std::to_string(dispatchParams.workload[i]);
-    }
-  }
-
-  // Add a global variable holding an initialized buffer for the dispatch IO.
-  auto bufferGlobalOp = appendGlobalBuffer(loc, baseName, dispatchParams,
-                                           affinityAttr, moduleBuilder);
-
-  // Create an exported benchmark function that runs the dispatches.
-  auto funcType =
-      moduleBuilder.getFunctionType({moduleBuilder.getI32Type()}, {});
-  auto funcOp =
-      moduleBuilder.create<IREE::Util::FuncOp>(loc, baseName, funcType);
-  funcOp.setVisibility(SymbolTable::Visibility::Public);
-
-  // Mark the function as being a dispatch benchmark.
-  // This tells iree-benchmark-module to pass in the arguments we need.
-  funcOp->setAttr("iree.abi.stub", moduleBuilder.getUnitAttr());
-  funcOp->setAttr(
-      "iree.reflection",
-      moduleBuilder.getDictionaryAttr({
-          moduleBuilder.getNamedAttr("iree.benchmark",
-                                     moduleBuilder.getStringAttr("dispatch")),
-      }));
-
-  // Build the function that runs the dispatches.
-  auto *entryBlock = funcOp.addEntryBlock();
-  OpBuilder funcBuilder = OpBuilder::atBlockBegin(entryBlock);
-  IndexSet indexSet(loc, funcBuilder);
-  auto batchSizeArg = funcBuilder.create<arith::IndexCastOp>(
-      loc, funcBuilder.getIndexType(), entryBlock->getArgument(0));
-
-  // Resolve device for this particular benchmark.
-  auto [device, queueAffinity] =
-      getDeviceAndQueueAffinity(loc, affinityAttr, funcBuilder);
-
-  // Create and begin command buffer.
-  // TODO(benvanik): reuse the command buffer (initialize once and store).
-  auto commandBufferModes =
-      IREE::HAL::CommandBufferModeBitfield::OneShot |
-      IREE::HAL::CommandBufferModeBitfield::AllowInlineExecution;
+// Records a command buffer with |batchSize| dispatches of |exportOp| with
+// |dispatchParams| separated by execution barriers.
+static Value recordDispatchCommandBuffer(
+    Location loc, Value device, Value queueAffinity, Value batchSize,
+    IREE::HAL::ExecutableOp executableOp,
+    IREE::HAL::ExecutableVariantOp variantOp,
+    IREE::HAL::ExecutableExportOp exportOp,
+    const DispatchParams &dispatchParams,
+    IREE::Util::GlobalOp bufferGlobalOp, OpBuilder &builder) {
+  IndexSet indexSet(loc, builder);
+
+  // The command buffer is replayed by every invocation of the benchmark so it
+  // must not be one-shot.
+  auto commandBufferModes = IREE::HAL::CommandBufferModeBitfield::None;
   auto commandBuffer =
-      funcBuilder
+      builder
           .create<IREE::HAL::CommandBufferCreateOp>(
-              loc, funcBuilder.getType<IREE::HAL::CommandBufferType>(), device,
+              loc, builder.getType<IREE::HAL::CommandBufferType>(), device,
               commandBufferModes, IREE::HAL::CommandCategoryBitfield::Dispatch,
               queueAffinity,
               /*binding_capacity=*/Value{})
@@ -294,14 +248,14 @@ static void appendDispatchBenchmark(IREE::Stream::AffinityAttr affinityAttr,
   if (int64_t pushConstantCount = layoutAttr.getConstants()) {
     constantValues.reserve(pushConstantCount);
     for (int64_t i = 0; i < pushConstantCount; ++i) {
-      constantValues.push_back(funcBuilder.create<arith::ConstantOp>(
+      constantValues.push_back(builder.create<arith::ConstantOp>(
           loc, dispatchParams.uniformOperands[i]));
     }
   }
 
   // Binding values.
   Value buffer =
-      bufferGlobalOp.createLoadOp(loc, funcBuilder).getLoadedGlobalValue();
+      bufferGlobalOp.createLoadOp(loc, builder).getLoadedGlobalValue();
   SmallVector<BindingValue> bindingValues;
   int64_t bufferOffset = 0;
   for (auto binding : dispatchParams.bindings) {
@@ -326,22 +280,22 @@ static void appendDispatchBenchmark(IREE::Stream::AffinityAttr affinityAttr,
   auto workload = llvm::map_to_vector(
       dispatchParams.workload, [&](unsigned dim) { return indexSet.get(dim); });
   auto workgroupCountOp =
-      funcBuilder.create<IREE::HAL::ExecutableCalculateWorkgroupsOp>(
-          loc, funcBuilder.getIndexType(), funcBuilder.getIndexType(),
-          funcBuilder.getIndexType(), device, exportRefAttr, workload);
+      builder.create<IREE::HAL::ExecutableCalculateWorkgroupsOp>(
+          loc, builder.getIndexType(), builder.getIndexType(),
+          builder.getIndexType(), device, exportRefAttr, workload);
 
   // Get the executable/entry point ordinal used to dispatch.
-  Value executable = funcBuilder.create<IREE::HAL::ExecutableLookupOp>(
-      loc, funcBuilder.getType<IREE::HAL::ExecutableType>(), device,
+  Value executable = builder.create<IREE::HAL::ExecutableLookupOp>(
+      loc, builder.getType<IREE::HAL::ExecutableType>(), device,
       exportRefAttr.getRootReference().getValue());
-  Value ordinal = funcBuilder.create<IREE::HAL::ExecutableExportOrdinalOp>(
-      loc, funcBuilder.getIndexType(), exportRefAttr);
+  Value ordinal = builder.create<IREE::HAL::ExecutableExportOrdinalOp>(
+      loc, builder.getIndexType(), exportRefAttr);
 
   // Loop around dispatches based on batch size.
   // Note that we insert a barrier between each dispatch - we could make this
   // optional so that concurrent utilization is measured.
-  funcBuilder.create<scf::ForOp>(
-      loc, indexSet.get(0), batchSizeArg, indexSet.get(1), ValueRange{},
+  builder.create<scf::ForOp>(
+      loc, indexSet.get(0), batchSize, indexSet.get(1), ValueRange{},
       [&](OpBuilder &forBuilder, Location loc, Value iv, ValueRange iters) {
         // Dispatch.
         forBuilder.create<IREE::HAL::CommandBufferDispatchOp>(
@@ -361,28 +315,114 @@ static void appendDispatchBenchmark(IREE::Stream::AffinityAttr affinityAttr,
         forBuilder.create<scf::YieldOp>(loc);
       });
 
-  funcBuilder.create<IREE::HAL::CommandBufferFinalizeOp>(loc, commandBuffer);
+  builder.create<IREE::HAL::CommandBufferFinalizeOp>(loc, commandBuffer);
+  return commandBuffer;
+}
+
+// Appends a function calling the given |exportOp| with |dispatchParams|.
+// This will add global values for the resources required.
+//
+// Uses the coarse-fences ABI and expects the runner to pass an i32 value
+// indicating the number of dispatches to be made in one submission along with
+// the fences to wait on and signal:
+//   (i32, !hal.fence, !hal.fence) -> ()
+// The command buffer is recorded on the first invocation for a given batch
+// size and replayed afterward so that only submission and execution are
+// measured. Nothing is waited on within the function such that the runner can
+// pipeline invocations.
+static void appendDispatchBenchmark(IREE::Stream::AffinityAttr affinityAttr,
+                                    IREE::HAL::ExecutableOp executableOp,
+                                    IREE::HAL::ExecutableVariantOp variantOp,
+                                    IREE::HAL::ExecutableExportOp exportOp,
+                                    DispatchParams dispatchParams,
+                                    OpBuilder &moduleBuilder) {
+  auto loc = FusedLoc::get(executableOp.getContext(), dispatchParams.locs);
+
+  std::string baseName = (executableOp.getName() + "_" + variantOp.getName() +
+                          "_" + exportOp.getName())
+                             .str();
+  if (!dispatchParams.workload.empty()) {
+    baseName += "_" + std::to_string(dispatchParams.workload[0]);
+    for (size_t i = 1; i < dispatchParams.workload.size(); ++i) {
+      baseName += "x" + std::to_string(dispatchParams.workload[i]);
+    }
+  }
 
-  // We begin executing immediately and then wait on a fence.
-  // TODO(benvanik): add fences to ABI so the benchmark tool can pipeline.
-  Value waitFence = funcBuilder.create<IREE::Util::NullOp>(
-      loc, funcBuilder.getType<IREE::HAL::FenceType>());
-  Value signalFence = funcBuilder.create<IREE::HAL::FenceCreateOp>(
-      loc, funcBuilder.getType<IREE::HAL::FenceType>(), device,
-      IREE::HAL::FenceFlagBitfield::None);
+  // Add a global variable holding an initialized buffer for the dispatch IO.
+  auto bufferGlobalOp = appendGlobalBuffer(loc, baseName, dispatchParams,
+                                           affinityAttr, moduleBuilder);
+
+  // Add global variables holding the recorded command buffer and the batch
+  // size it was recorded with. The initial batch size of 0 never matches a
+  // requested size and forces recording on the first invocation.
+  auto commandBufferGlobalOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+      loc, (baseName + "_command_buffer").str(),
+      /*isMutable=*/true,
+      IREE::HAL::CommandBufferType::get(moduleBuilder.getContext()));
+  commandBufferGlobalOp.setPrivate();
+  auto batchSizeGlobalOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+      loc, (baseName + "_batch_size").str(),
+      /*isMutable=*/true, moduleBuilder.getIndexType(),
+      std::optional<TypedAttr>{moduleBuilder.getIndexAttr(0)});
+  batchSizeGlobalOp.setPrivate();
 
-  // Queue execution.
+  // Create an exported benchmark function that runs the dispatches.
+  auto fenceType = moduleBuilder.getType<IREE::HAL::FenceType>();
+  auto funcType = moduleBuilder.getFunctionType(
+      {moduleBuilder.getI32Type(), fenceType, fenceType}, {});
+  auto funcOp =
+      moduleBuilder.create<IREE::Util::FuncOp>(loc, baseName, funcType);
+  funcOp.setVisibility(SymbolTable::Visibility::Public);
+
+  // Mark the function as being a dispatch benchmark.
+  // This tells iree-benchmark-module to pass in the arguments we need.
+  funcOp->setAttr("iree.abi.stub", moduleBuilder.getUnitAttr());
+  funcOp->setAttr(
+      "iree.reflection",
+      moduleBuilder.getDictionaryAttr({
+          moduleBuilder.getNamedAttr("iree.abi.model",
+                                     moduleBuilder.getStringAttr(
+                                         "coarse-fences")),
+          moduleBuilder.getNamedAttr("iree.benchmark",
+                                     moduleBuilder.getStringAttr("dispatch")),
+      }));
+
+  // Build the function that runs the dispatches.
+  auto *entryBlock = funcOp.addEntryBlock();
+  OpBuilder funcBuilder = OpBuilder::atBlockBegin(entryBlock);
+  auto batchSizeArg = funcBuilder.create<arith::IndexCastOp>(
+      loc, funcBuilder.getIndexType(), entryBlock->getArgument(0));
+  Value waitFence = entryBlock->getArgument(1);
+  Value signalFence = entryBlock->getArgument(2);
+
+  // Resolve device for this particular benchmark.
+  Value device, queueAffinity;
+  std::tie(device, queueAffinity) =
+      getDeviceAndQueueAffinity(loc, affinityAttr, funcBuilder);
+
+  // Record the command buffer if this is the first invocation with the
+  // requested batch size.
+  Value recordedBatchSize =
+      batchSizeGlobalOp.createLoadOp(loc, funcBuilder).getLoadedGlobalValue();
+  Value needsRecording = funcBuilder.create<arith::CmpIOp>(
+      loc, arith::CmpIPredicate::ne, recordedBatchSize, batchSizeArg);
+  funcBuilder.create<scf::IfOp>(
+      loc, needsRecording, [&](OpBuilder &thenBuilder, Location loc) {
+        Value commandBuffer = recordDispatchCommandBuffer(
+            loc, device, queueAffinity, batchSizeArg, executableOp, variantOp,
+            exportOp, dispatchParams, bufferGlobalOp, thenBuilder);
+        commandBufferGlobalOp.createStoreOp(loc, commandBuffer, thenBuilder);
+        batchSizeGlobalOp.createStoreOp(loc, batchSizeArg, thenBuilder);
+        thenBuilder.create<scf::YieldOp>(loc);
+      });
+  Value commandBuffer = commandBufferGlobalOp.createLoadOp(loc, funcBuilder)
+                            .getLoadedGlobalValue();
+
+  // Queue execution. The runner waits on the signal fence.
   funcBuilder.create<IREE::HAL::DeviceQueueExecuteOp>(
       loc, device, queueAffinity, waitFence, signalFence,
       ValueRange{commandBuffer});
 
-  // Block until it completes.
-  Value timeoutMillis = funcBuilder.create<arith::ConstantIntOp>(loc, -1, 32);
-  auto fenceOp = funcBuilder.create<IREE::HAL::FenceAwaitOp>(
-      loc, funcBuilder.getI32Type(), timeoutMillis, signalFence);
-  funcBuilder.create<IREE::Util::StatusCheckOkOp>(
-      loc, fenceOp.getStatus(), "failed to wait on timepoint");
-
   funcBuilder.create<IREE::Util::ReturnOp>(loc);
 }
 
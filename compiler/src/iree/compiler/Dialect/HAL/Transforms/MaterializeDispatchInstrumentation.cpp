@@ -18,6 +18,7 @@
 #include "iree/schemas/instruments/dispatch.h"
 #include "iree/schemas/instruments/dispatch_def_builder.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/BuiltinTypes.h"
@@ -153,6 +154,18 @@ struct MaterializeDispatchInstrumentationPass
       initializerBuilder.create<IREE::Util::ReturnOp>(loc);
     }
 
+    // When sampling only every Nth submission is instrumented and all others
+    // dispatch uninstrumented clones of the exports so that they pay no
+    // instrumentation cost. The host-side counter cycles through
+    // [0, sampleRate) and a submission is sampled when it is 0.
+    IREE::Util::GlobalOp sampleCounterOp;
+    if (sampleRate > 1) {
+      sampleCounterOp = moduleBuilder.create<IREE::Util::GlobalOp>(
+          loc, "__dispatch_instrumentation_sample_counter",
+          /*isMutable=*/true, i32Type,
+          std::optional<TypedAttr>{moduleBuilder.getI32IntegerAttr(0)});
+    }
+
     FlatbufferBuilder metadataBuilder;
 
     // Update all executable export signatures to include the instrumentation
@@ -162,12 +175,15 @@ struct MaterializeDispatchInstrumentationPass
     SmallVector<iree_instruments_DispatchFunctionDef_ref_t>
         dispatchFunctionRefs;
     DenseMap<SymbolRefAttr, uint32_t> instrumentedExports;
+    DenseMap<SymbolRefAttr, SymbolRefAttr> uninstrumentedExports;
+    DenseMap<Operation *, StringAttr> clonedFuncNames;
     auto bindingType = moduleBuilder.getType<IREE::Stream::BindingType>();
     auto alignmentKey = moduleBuilder.getStringAttr("stream.alignment");
     auto alignment64 = moduleBuilder.getIndexAttr(64);
     for (auto executableOp : moduleOp.getOps<IREE::Stream::ExecutableOp>()) {
-      for (auto exportOp :
-           executableOp.getOps<IREE::Stream::ExecutableExportOp>()) {
+      auto exportOps = llvm::to_vector(
+          executableOp.getOps<IREE::Stream::ExecutableExportOp>());
+      for (auto exportOp : exportOps) {
         auto funcOp = exportOp.lookupFunctionRef();
         if (!funcOp)
           continue;
@@ -176,9 +192,33 @@ struct MaterializeDispatchInstrumentationPass
         auto originalSource = getOpStr(funcOp);
 
         // Mark as instrumented.
-        instrumentedExports[SymbolRefAttr::get(
-            executableOp.getNameAttr(), {SymbolRefAttr::get(exportOp)})] =
-            instrumentedExports.size();
+        auto exportRefAttr = SymbolRefAttr::get(executableOp.getNameAttr(),
+                                                {SymbolRefAttr::get(exportOp)});
+        instrumentedExports[exportRefAttr] = instrumentedExports.size();
+
+        // Clone the export and its function prior to instrumentation for use
+        // by unsampled submissions.
+        if (sampleCounterOp) {
+          OpBuilder cloneBuilder(&getContext());
+          auto &clonedFuncName = clonedFuncNames[funcOp.getOperation()];
+          if (!clonedFuncName) {
+            cloneBuilder.setInsertionPointAfter(funcOp.getOperation());
+            auto *clonedFuncOp = cloneBuilder.clone(*funcOp.getOperation());
+            clonedFuncName = StringAttr::get(
+                &getContext(), funcOp.getName() + "_uninstrumented");
+            SymbolTable::setSymbolName(clonedFuncOp, clonedFuncName);
+          }
+          cloneBuilder.setInsertionPointAfter(exportOp);
+          auto clonedExportOp = cast<IREE::Stream::ExecutableExportOp>(
+              cloneBuilder.clone(*exportOp));
+          clonedExportOp.setSymName(
+              (exportOp.getSymName() + "_uninstrumented").str());
+          clonedExportOp.setFunctionRefAttr(
+              FlatSymbolRefAttr::get(clonedFuncName));
+          uninstrumentedExports[exportRefAttr] =
+              SymbolRefAttr::get(executableOp.getNameAttr(),
+                                 {SymbolRefAttr::get(clonedExportOp)});
+        }
 
         // Update function signature to add the ringbuffer and dispatch ID.
         SmallVector<Type> argTypes(funcOp.getArgumentTypes());
@@ -225,69 +265,76 @@ struct MaterializeDispatchInstrumentationPass
     // instrumentation buffer.
     SmallVector<iree_instruments_DispatchSiteDef_ref_t> dispatchSiteRefs;
     uint32_t dispatchSiteCount = 0;
+    SmallVector<IREE::Stream::CmdExecuteOp> executeOps;
     for (auto funcOp : moduleOp.getOps<mlir::FunctionOpInterface>()) {
       funcOp.walk([&](IREE::Stream::CmdExecuteOp executeOp) {
-        auto parentBuilder = OpBuilder(executeOp);
-
-        // Load the ringbuffer and capture it for use within the execute region.
-        auto loadedValue =
-            globalOp.createLoadOp(loc, parentBuilder).getLoadedGlobalValue();
-        Value zero = parentBuilder.create<arith::ConstantIndexOp>(loc, 0);
-        Value bufferSize =
-            parentBuilder.create<arith::ConstantOp>(loc, bufferSizeAttr);
-        executeOp.getResourceOperandsMutable().append(loadedValue);
-        executeOp.getResourceOperandSizesMutable().append(bufferSize);
-        auto bufferArg =
-            executeOp.getBody().addArgument(loadedValue.getType(), loc);
-
-        // Walk dispatches and pass them the ringbuffer and their unique ID.
-        executeOp.walk([&](IREE::Stream::CmdDispatchOp dispatchOp) {
-          // NOTE: we just choose the first instrumented export for attribution
-          // as that's good enough for all current use cases. If we start
-          // specializing really early we may want to fix that.
-          std::optional<uint32_t> functionId;
-          for (auto entryPointAttr : dispatchOp.getEntryPointRefs()) {
-            auto it = instrumentedExports.find(entryPointAttr);
-            if (it != instrumentedExports.end()) {
-              // Found the first instrumented export.
-              functionId = it->second;
-              break;
-            }
+        executeOps.push_back(executeOp);
+      });
+    }
+    for (auto executeOp : executeOps) {
+      if (sampleCounterOp) {
+        sampleExecuteOp(executeOp, sampleCounterOp, uninstrumentedExports);
+      }
+      auto parentBuilder = OpBuilder(executeOp);
+
+      // Load the ringbuffer and capture it for use within the execute region.
+      auto loadedValue =
+          globalOp.createLoadOp(loc, parentBuilder).getLoadedGlobalValue();
+      Value zero = parentBuilder.create<arith::ConstantIndexOp>(loc, 0);
+      Value bufferSize =
+          parentBuilder.create<arith::ConstantOp>(loc, bufferSizeAttr);
+      executeOp.getResourceOperandsMutable().append(loadedValue);
+      executeOp.getResourceOperandSizesMutable().append(bufferSize);
+      auto bufferArg =
+          executeOp.getBody().addArgument(loadedValue.getType(), loc);
+
+      // Walk dispatches and pass them the ringbuffer and their unique ID.
+      executeOp.walk([&](IREE::Stream::CmdDispatchOp dispatchOp) {
+        // NOTE: we just choose the first instrumented export for attribution
+        // as that's good enough for all current use cases. If we start
+        // specializing really early we may want to fix that.
+        std::optional<uint32_t> functionId;
+        for (auto entryPointAttr : dispatchOp.getEntryPointRefs()) {
+          auto it = instrumentedExports.find(entryPointAttr);
+          if (it != instrumentedExports.end()) {
+            // Found the first instrumented export.
+            functionId = it->second;
+            break;
           }
-          if (!functionId)
-            return; // not instrumented
-
-          // Append dispatch site ID to correlate this op with where it lives in
-          // the program and what is being dispatched. Note that multiple
-          // dispatch ops may reference the same dispatch function after
-          // deduplication.
-          uint32_t dispatchSiteId = dispatchSiteCount++;
-          dispatchOp.getUniformOperandsMutable().append(
-              parentBuilder
-                  .create<arith::ConstantIntOp>(loc, dispatchSiteId, 32)
-                  .getResult());
-
-          // Record dispatch site to the host-side metadata.
-          iree_instruments_DispatchSiteDef_start(metadataBuilder);
-          // TODO(benvanik): source loc to identify the site.
-          iree_instruments_DispatchSiteDef_function_add(metadataBuilder,
-                                                        *functionId);
-          dispatchSiteRefs.push_back(
-              iree_instruments_DispatchSiteDef_end(metadataBuilder));
-
-          // Append ringbuffer for storing the instrumentation data.
-          dispatchOp.getResourcesMutable().append(bufferArg);
-          dispatchOp.getResourceOffsetsMutable().append(zero);
-          dispatchOp.getResourceLengthsMutable().append(bufferSize);
-          dispatchOp.getResourceSizesMutable().append(bufferSize);
-          SmallVector<Attribute> accesses(
-              dispatchOp.getResourceAccesses().getValue());
-          accesses.push_back(IREE::Stream::ResourceAccessBitfieldAttr::get(
-              &getContext(), IREE::Stream::ResourceAccessBitfield::Read |
-                                 IREE::Stream::ResourceAccessBitfield::Write));
-          dispatchOp.setResourceAccessesAttr(
-              parentBuilder.getArrayAttr(accesses));
-        });
+        }
+        if (!functionId)
+          return; // not instrumented
+
+        // Append dispatch site ID to correlate this op with where it lives in
+        // the program and what is being dispatched. Note that multiple
+        // dispatch ops may reference the same dispatch function after
+        // deduplication.
+        uint32_t dispatchSiteId = dispatchSiteCount++;
+        dispatchOp.getUniformOperandsMutable().append(
+            parentBuilder
+                .create<arith::ConstantIntOp>(loc, dispatchSiteId, 32)
+                .getResult());
+
+        // Record dispatch site to the host-side metadata.
+        iree_instruments_DispatchSiteDef_start(metadataBuilder);
+        // TODO(benvanik): source loc to identify the site.
+        iree_instruments_DispatchSiteDef_function_add(metadataBuilder,
+                                                      *functionId);
+        dispatchSiteRefs.push_back(
+            iree_instruments_DispatchSiteDef_end(metadataBuilder));
+
+        // Append ringbuffer for storing the instrumentation data.
+        dispatchOp.getResourcesMutable().append(bufferArg);
+        dispatchOp.getResourceOffsetsMutable().append(zero);
+        dispatchOp.getResourceLengthsMutable().append(bufferSize);
+        dispatchOp.getResourceSizesMutable().append(bufferSize);
+        SmallVector<Attribute> accesses(
+            dispatchOp.getResourceAccesses().getValue());
+        accesses.push_back(IREE::Stream::ResourceAccessBitfieldAttr::get(
+            &getContext(), IREE::Stream::ResourceAccessBitfield::Read |
+                               IREE::Stream::ResourceAccessBitfield::Write));
+        dispatchOp.setResourceAccessesAttr(
+            parentBuilder.getArrayAttr(accesses));
       });
     }
 
@@ -361,6 +408,51 @@ struct MaterializeDispatchInstrumentationPass
       queryBuilder.create<IREE::Util::ReturnOp>(loc);
     }
   }
+
+  // Wraps |executeOp| in an scf.if that selects between it (to be
+  // instrumented) when the sample counter is 0 and a clone dispatching the
+  // uninstrumented exports otherwise. The counter is advanced on each
+  // submission.
+  void sampleExecuteOp(
+      IREE::Stream::CmdExecuteOp executeOp,
+      IREE::Util::GlobalOp sampleCounterOp,
+      const DenseMap<SymbolRefAttr, SymbolRefAttr> &uninstrumentedExports) {
+    auto loc = executeOp.getLoc();
+    OpBuilder builder(executeOp);
+    Value counter =
+        sampleCounterOp.createLoadOp(loc, builder).getLoadedGlobalValue();
+    Value nextCounter = builder.create<arith::RemUIOp>(
+        loc,
+        builder.create<arith::AddIOp>(
+            loc, counter, builder.create<arith::ConstantIntOp>(loc, 1, 32)),
+        builder.create<arith::ConstantIntOp>(loc, sampleRate, 32));
+    sampleCounterOp.createStoreOp(loc, nextCounter, builder);
+    Value isSampled = builder.create<arith::CmpIOp>(
+        loc, arith::CmpIPredicate::eq, counter,
+        builder.create<arith::ConstantIntOp>(loc, 0, 32));
+
+    auto ifOp = builder.create<scf::IfOp>(loc, executeOp->getResultTypes(),
+                                          isSampled, /*addThenBlock=*/true,
+                                          /*addElseBlock=*/true);
+    executeOp->replaceAllUsesWith(ifOp.getResults());
+    executeOp->moveBefore(ifOp.thenBlock(), ifOp.thenBlock()->end());
+    auto thenBuilder = OpBuilder::atBlockEnd(ifOp.thenBlock());
+    thenBuilder.create<scf::YieldOp>(loc, executeOp->getResults());
+
+    auto elseBuilder = OpBuilder::atBlockEnd(ifOp.elseBlock());
+    auto uninstrumentedOp = elseBuilder.clone(*executeOp);
+    elseBuilder.create<scf::YieldOp>(loc, uninstrumentedOp->getResults());
+    uninstrumentedOp->walk([&](IREE::Stream::CmdDispatchOp dispatchOp) {
+      SmallVector<Attribute> entryPointAttrs;
+      for (auto entryPointAttr : dispatchOp.getEntryPointRefs()) {
+        auto it = uninstrumentedExports.find(entryPointAttr);
+        entryPointAttrs.push_back(it != uninstrumentedExports.end()
+                                      ? it->second
+                                      : entryPointAttr);
+      }
+      dispatchOp.setEntryPointsAttr(builder.getArrayAttr(entryPointAttrs));
+    });
+  }
 };
 
 } // namespace
@@ -12,6 +12,7 @@
 #include "iree/compiler/Dialect/HAL/IR/HALOps.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
 #include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Utils/EquivalenceUtils.h"
 #include "iree/compiler/Utils/StringUtils.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
@@ -513,9 +514,12 @@ static void replaceMemoizeOpWithLookup(IREE::HAL::DeviceMemoizeOp memoizeOp,
 // the |memoizeOp| with a lookup function that can be used to get the
 // appropriate per-device results. If the op cannot be memoized then it is
 // replaced with an inline call to the outlined apply function.
-static void memoizeRegionOp(IREE::HAL::DeviceMemoizeOp memoizeOp,
-                            DeviceAnalysis &deviceAnalysis,
-                            SymbolTable &moduleSymbolTable) {
+//
+// Returns the lookup function if the op was memoized and otherwise nullptr.
+static IREE::Util::FuncOp
+memoizeRegionOp(IREE::HAL::DeviceMemoizeOp memoizeOp,
+                DeviceAnalysis &deviceAnalysis,
+                SymbolTable &moduleSymbolTable) {
   // Outline the memoize region to a function.
   auto memoizeAnalysis = computeMemoizeAnalysis(memoizeOp);
   auto parentFuncOp = memoizeOp->getParentOfType<FunctionOpInterface>();
@@ -532,7 +536,7 @@ static void memoizeRegionOp(IREE::HAL::DeviceMemoizeOp memoizeOp,
       memoizeOp.dump();
     });
     replaceMemoizeOpWithApply(memoizeOp, memoizeAnalysis, applyFuncOp);
-    return;
+    return {};
   }
 
   // To memoize we must be able to figure out which devices the op is being
@@ -546,7 +550,7 @@ static void memoizeRegionOp(IREE::HAL::DeviceMemoizeOp memoizeOp,
       memoizeOp.dump();
     });
     replaceMemoizeOpWithApply(memoizeOp, memoizeAnalysis, applyFuncOp);
-    return;
+    return {};
   }
 
   // Create globals storing the memoized results for each device and an
@@ -566,6 +570,85 @@ static void memoizeRegionOp(IREE::HAL::DeviceMemoizeOp memoizeOp,
 
   // Replace the memoize op with a call to the lookup function.
   replaceMemoizeOpWithLookup(memoizeOp, memoizeAnalysis, lookupFuncOp);
+  return lookupFuncOp;
+}
+
+// A memoize op that may be memoized at initialization time and its analysis.
+struct MemoizeCandidate {
+  IREE::HAL::DeviceMemoizeOp memoizeOp;
+  MemoizeAnalysis memoizeAnalysis;
+  // Device globals the op may be memoized for.
+  SmallVector<IREE::Util::GlobalOpInterface> deviceGlobals;
+  // All values captured by the region in first-use order.
+  SetVector<Value> capturedValues;
+};
+
+// Returns a candidate for |memoizeOp| if it can be memoized at initialization
+// time and may be shared with other equivalent ops.
+static std::optional<MemoizeCandidate>
+tryGetMemoizeCandidate(IREE::HAL::DeviceMemoizeOp memoizeOp,
+                       DeviceAnalysis &deviceAnalysis) {
+  MemoizeCandidate candidate;
+  candidate.memoizeOp = memoizeOp;
+  candidate.memoizeAnalysis = computeMemoizeAnalysis(memoizeOp);
+  if (!candidate.memoizeAnalysis.canRunAtInitializationTime()) {
+    return std::nullopt;
+  }
+  auto deviceGlobals =
+      deviceAnalysis.lookupDeviceGlobals(memoizeOp.getDevice());
+  if (!deviceGlobals) {
+    return std::nullopt;
+  }
+  candidate.deviceGlobals = std::move(deviceGlobals).value();
+  mlir::getUsedValuesDefinedAbove(memoizeOp.getBody(),
+                                  candidate.capturedValues);
+  return candidate;
+}
+
+// Returns true if |lhs| and |rhs| produce the same results when memoized: both
+// are memoized for the same devices and queues, capture the same constants and
+// immutable globals, and have structurally equivalent bodies.
+static bool isEquivalentMemoizeCandidate(const MemoizeCandidate &lhs,
+                                         const MemoizeCandidate &rhs,
+                                         OperationEquivalenceCache &cache) {
+  auto lhsOp = lhs.memoizeOp;
+  auto rhsOp = rhs.memoizeOp;
+  if (lhsOp.getResultTypes() != rhsOp.getResultTypes() ||
+      lhs.memoizeAnalysis.queueAffinity != rhs.memoizeAnalysis.queueAffinity ||
+      lhs.deviceGlobals != rhs.deviceGlobals ||
+      lhs.capturedValues.size() != rhs.capturedValues.size()) {
+    return false;
+  }
+
+  // Captured values must correspond in first-use order. Device and affinity
+  // are substituted during memoization and everything else must be produced
+  // by an equivalent constant or immutable global load op.
+  auto mapping = cache.acquireMapping();
+  for (auto [lhsValue, rhsValue] :
+       llvm::zip_equal(lhs.capturedValues, rhs.capturedValues)) {
+    bool lhsIsDevice = lhsValue == lhsOp.getDevice();
+    bool lhsIsAffinity = lhsValue == lhsOp.getQueueAffinity();
+    if (lhsIsDevice != (rhsValue == rhsOp.getDevice()) ||
+        lhsIsAffinity != (rhsValue == rhsOp.getQueueAffinity())) {
+      return false;
+    }
+    if (!lhsIsDevice && !lhsIsAffinity) {
+      auto *lhsDefiningOp = lhsValue.getDefiningOp();
+      auto *rhsDefiningOp = rhsValue.getDefiningOp();
+      if (!lhsDefiningOp || !rhsDefiningOp ||
+          !OperationEquivalence::isEquivalentTo(
+              lhsDefiningOp, rhsDefiningOp,
+              OperationEquivalence::exactValueMatch,
+              /*markEquivalent=*/nullptr,
+              OperationEquivalence::Flags::IgnoreLocations)) {
+        return false;
+      }
+    }
+    mapping->map(lhsValue, rhsValue);
+  }
+
+  return isStructurallyEquivalentTo(cache, lhsOp.getBody(), rhsOp.getBody(),
+                                    *mapping);
 }
 
 struct OutlineMemoizeRegionsPass
@@ -587,11 +670,54 @@ struct OutlineMemoizeRegionsPass
       memoizeOps.push_back(memoizeOp);
     });
 
+    // Group memoize ops that would produce the same results so that each
+    // unique region is outlined and memoized once and shared by all sites.
+    // Repeated layers commonly record identical command buffers that differ
+    // only in the resources bound indirectly when they are executed. All
+    // analysis happens prior to outlining as the equivalence cache requires
+    // the IR to remain unchanged.
+    OperationEquivalenceCache equivalenceCache(moduleOp.getContext());
+    SmallVector<MemoizeCandidate> candidates; // unique regions only
+    DenseMap<Operation *, size_t> leaderIndices;
+    for (auto memoizeOp : memoizeOps) {
+      auto candidate = tryGetMemoizeCandidate(memoizeOp, deviceAnalysis);
+      if (!candidate) {
+        continue;
+      }
+      for (auto [leaderIndex, leader] : llvm::enumerate(candidates)) {
+        if (isEquivalentMemoizeCandidate(leader, *candidate,
+                                         equivalenceCache)) {
+          leaderIndices[memoizeOp] = leaderIndex;
+          break;
+        }
+      }
+      if (!leaderIndices.contains(memoizeOp)) {
+        leaderIndices[memoizeOp] = candidates.size();
+        candidates.push_back(std::move(candidate).value());
+      }
+    }
+
     // Try to outline all memoize ops. Some may fail analysis and be inlined.
+    // Ops equivalent to one already memoized reuse its lookup function.
     auto &moduleSymbolTable =
         deviceAnalysis.getExplorer().getSymbolTables().getSymbolTable(moduleOp);
+    DenseMap<size_t, IREE::Util::FuncOp> leaderLookupFuncOps;
     for (auto memoizeOp : memoizeOps) {
-      memoizeRegionOp(memoizeOp, deviceAnalysis, moduleSymbolTable);
+      auto leaderIt = leaderIndices.find(memoizeOp);
+      if (leaderIt == leaderIndices.end()) {
+        memoizeRegionOp(memoizeOp, deviceAnalysis, moduleSymbolTable);
+        continue;
+      }
+      auto lookupFuncOp = leaderLookupFuncOps.lookup(leaderIt->second);
+      if (lookupFuncOp) {
+        LLVM_DEBUG(llvm::dbgs() << "reusing memoized region @"
+                                << lookupFuncOp.getName() << "\n");
+        auto memoizeAnalysis = computeMemoizeAnalysis(memoizeOp);
+        replaceMemoizeOpWithLookup(memoizeOp, memoizeAnalysis, lookupFuncOp);
+        continue;
+      }
+      leaderLookupFuncOps[leaderIt->second] =
+          memoizeRegionOp(memoizeOp, deviceAnalysis, moduleSymbolTable);
     }
   }
 };
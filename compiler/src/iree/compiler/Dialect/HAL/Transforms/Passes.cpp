@@ -64,6 +64,14 @@ static llvm::cl::opt<llvm::cl::PowerOf2ByteSize> clInstrumentDispatchBufferSize{
     llvm::cl::init(llvm::cl::PowerOf2ByteSize(0)),
 };
 
+static llvm::cl::opt<unsigned> clInstrumentDispatchSampleRate{
+    "iree-hal-instrument-dispatches-sample-rate",
+    llvm::cl::desc("Instruments only every Nth command buffer submission when "
+                   "dispatch instrumentation is enabled. Unsampled "
+                   "submissions run uninstrumented executables."),
+    llvm::cl::init(1),
+};
+
 static llvm::cl::list<std::string> clSubstituteExecutableSource{
     "iree-hal-substitute-executable-source",
     llvm::cl::desc(
@@ -255,7 +263,7 @@ void buildHALConfigurationPassPipeline(OpPassManager &passManager,
   // more easily mutate the stream dispatch ops and exports.
   if (auto bufferSize = clInstrumentDispatchBufferSize.getValue()) {
     passManager.addPass(IREE::HAL::createMaterializeDispatchInstrumentationPass(
-        {bufferSize.value}));
+        {bufferSize.value, clInstrumentDispatchSampleRate}));
   }
 
   // Each executable needs a hal.interface to specify how the host and
@@ -375,6 +383,13 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
                                     clSubstituteExecutableConfiguration,
                                     clSubstituteExecutableConfigurationsFrom);
 
+    // Capture the configuration of each executable for the compile report
+    // before translation rewrites it.
+    if (!targetOptions.compileReportPath.empty()) {
+      passManager.addNestedPass<IREE::HAL::ExecutableOp>(
+          IREE::HAL::createCaptureCompileReportPass());
+    }
+
     // Dump standalone hal.executable benchmark modules.
     // Today this only works for executables that have static dispatch
     // parameters and is only useful for basic microbenchmarking. We do this
@@ -548,7 +563,12 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
         IREE::HAL::createSerializeExecutablesPass(
             {&targetRegistry, targetOptions.debugLevel,
              targetOptions.executableIntermediatesPath,
-             targetOptions.executableBinariesPath}));
+             targetOptions.executableBinariesPath,
+           targetOptions.executableCachePath}));
+
+    // Merge executables that lowered to identical binaries even though their
+    // source IR differed.
+    passManager.addPass(IREE::HAL::createDeduplicateExecutablesPass());
 
     // NOTE: symbol DCE will destroy executable target contents, so only run
     // it if we serialized things.
@@ -556,6 +576,12 @@ void buildHALTransformPassPipeline(OpPassManager &passManager,
     passManager.addPass(mlir::createSymbolDCEPass());
   }
 
+  // Write out the compile report with everything captured along the way.
+  if (!targetOptions.compileReportPath.empty()) {
+    passManager.addPass(IREE::HAL::createDumpCompileReportPass(
+        {targetOptions.compileReportPath}));
+  }
+
   //----------------------------------------------------------------------------
   // Whole-program optimization
   //----------------------------------------------------------------------------
@@ -110,6 +110,11 @@ void buildHALTransformPassPipeline(
 // line tool.
 std::unique_ptr<Pass> createPreprocessExecutablesPass(std::string command = "");
 
+// Sets |key| to |value| in the compile report being captured on |executableOp|
+// by the capture-compile-report pass. No-op if no report is being captured.
+void setCompileReportEntry(IREE::HAL::ExecutableOp executableOp,
+                           StringRef key, Attribute value);
+
 //===----------------------------------------------------------------------===//
 // Register all Passes
 //===----------------------------------------------------------------------===//
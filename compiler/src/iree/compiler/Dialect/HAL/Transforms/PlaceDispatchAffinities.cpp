@@ -0,0 +1,369 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <algorithm>
+#include <optional>
+
+#include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
+#include "iree/compiler/Dialect/HAL/Analysis/DeviceAnalysis.h"
+#include "iree/compiler/Dialect/HAL/IR/HALDialect.h"
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
+#include "iree/compiler/Dialect/Stream/Analysis/Affinity.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/LinalgInterfaces.h"
+#include "mlir/IR/Attributes.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-hal-place-dispatch-affinities"
+
+namespace mlir::iree_compiler::IREE::HAL {
+
+#define GEN_PASS_DEF_PLACEDISPATCHAFFINITIESPASS
+#include "iree/compiler/Dialect/HAL/Transforms/Passes.h.inc"
+
+namespace {
+
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+
+// Coarse per-device characteristics in microseconds. These are intentionally
+// order-of-magnitude values: the placement only needs to distinguish between
+// dispatches dominated by launch latency and those dominated by throughput.
+struct DeviceCostModel {
+  // Fixed cost of submitting and completing a single dispatch.
+  double launchOverhead = 0.0;
+  // Sustained floating-point operations per microsecond.
+  double flopsPerUs = 1.0;
+  // Sustained memory bytes accessed per microsecond.
+  double bytesPerUs = 1.0;
+};
+
+// Host CPU devices launch quickly but have limited throughput.
+static const DeviceCostModel kHostDeviceCostModel = {
+    /*launchOverhead=*/1.0,
+    /*flopsPerUs=*/5.0e4,
+    /*bytesPerUs=*/2.0e4,
+};
+
+// Accelerators have high throughput but pay for submission and completion.
+static const DeviceCostModel kAcceleratorDeviceCostModel = {
+    /*launchOverhead=*/10.0,
+    /*flopsPerUs=*/1.0e7,
+    /*bytesPerUs=*/5.0e5,
+};
+
+// Fixed latency and bandwidth of moving a resource between devices.
+static const double kTransferLatency = 10.0;
+static const double kTransferBytesPerUs = 1.0e4;
+
+// Returns true if all executable targets of |deviceSet| run on the host CPU.
+static bool isHostDevice(const DeviceSet &deviceSet) {
+  auto executableTargets = deviceSet.getExecutableTargets();
+  if (!executableTargets || executableTargets->empty()) {
+    return false;
+  }
+  return llvm::all_of(*executableTargets, [](auto executableTargetAttr) {
+    auto backend = executableTargetAttr.getBackend().getValue();
+    return backend == "llvm-cpu" || backend == "vmvx";
+  });
+}
+
+// Returns the total static byte size of |type| or nullopt if dynamic.
+static std::optional<int64_t> getStaticByteSize(Type type) {
+  auto shapedType = dyn_cast<ShapedType>(type);
+  if (!shapedType || !shapedType.hasStaticShape() ||
+      !shapedType.getElementType().isIntOrFloat()) {
+    return std::nullopt;
+  }
+  int64_t elementBits = shapedType.getElementTypeBitWidth();
+  return shapedType.getNumElements() * ((elementBits + 7) / 8);
+}
+
+// Returns an estimate of the floating-point operations performed by the
+// function implementing |dispatchOp| or nullopt if it cannot be estimated.
+static std::optional<int64_t>
+estimateDispatchFlops(IREE::Flow::DispatchOp dispatchOp) {
+  int64_t totalFlops = 0;
+  for (auto entryPointRef : dispatchOp.getEntryPointRefs()) {
+    auto exportOp =
+        SymbolTable::lookupNearestSymbolFrom<IREE::Flow::ExecutableExportOp>(
+            dispatchOp, entryPointRef);
+    if (!exportOp) {
+      return std::nullopt;
+    }
+    auto executableOp = exportOp->getParentOfType<IREE::Flow::ExecutableOp>();
+    auto innerModuleOp = executableOp.getInnerModule();
+    if (!innerModuleOp) {
+      return std::nullopt;
+    }
+    auto funcOp = innerModuleOp.lookupSymbol<FunctionOpInterface>(
+        exportOp.getFunctionRef());
+    if (!funcOp) {
+      return std::nullopt;
+    }
+    // Each linalg op performs one operation per payload op per iteration.
+    bool isDynamic = false;
+    funcOp.walk([&](linalg::LinalgOp linalgOp) {
+      int64_t iterationCount = 1;
+      for (int64_t range : linalgOp.getStaticLoopRanges()) {
+        if (ShapedType::isDynamic(range)) {
+          isDynamic = true;
+          return WalkResult::interrupt();
+        }
+        iterationCount *= range;
+      }
+      int64_t payloadOpCount = std::max<int64_t>(
+          1, linalgOp.getBlock()->getOperations().size() - 1);
+      totalFlops += iterationCount * payloadOpCount;
+      return WalkResult::advance();
+    });
+    if (isDynamic) {
+      return std::nullopt;
+    }
+  }
+  return totalFlops;
+}
+
+// Returns true if |dispatchOp| is a scalar dispatch: one that launches a single
+// workgroup and only operates on tensors with at most one element. These are
+// formed by dispatch creation around scalar computations (index math, etc) and
+// perform too little work to amortize a device launch.
+static bool isScalarDispatch(IREE::Flow::DispatchOp dispatchOp) {
+  auto isScalarType = [](Type type) {
+    auto shapedType = dyn_cast<ShapedType>(type);
+    return !shapedType ||
+           (shapedType.hasStaticShape() && shapedType.getNumElements() <= 1);
+  };
+  if (!llvm::all_of(dispatchOp.getArguments().getTypes(), isScalarType) ||
+      !llvm::all_of(dispatchOp.getResultTypes(), isScalarType)) {
+    return false;
+  }
+  for (auto entryPointRef : dispatchOp.getEntryPointRefs()) {
+    auto exportOp =
+        SymbolTable::lookupNearestSymbolFrom<IREE::Flow::ExecutableExportOp>(
+            dispatchOp, entryPointRef);
+    if (!exportOp || exportOp.getWorkgroupCount().empty()) {
+      return false;
+    }
+    auto returnOp = cast<IREE::Flow::ReturnOp>(
+        exportOp.getWorkgroupCount().front().getTerminator());
+    if (!llvm::all_of(returnOp.getOperands(), [](Value value) {
+          return matchPattern(value, m_One());
+        })) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the cost of moving |byteSize| bytes between two devices.
+static double getTransferCost(int64_t byteSize) {
+  return kTransferLatency + byteSize / kTransferBytesPerUs;
+}
+
+//===----------------------------------------------------------------------===//
+// --iree-hal-place-dispatch-affinities
+//===----------------------------------------------------------------------===//
+
+struct PlacementCandidate {
+  IREE::Stream::AffinityAttr affinityAttr;
+  DeviceCostModel costModel;
+  bool isHost = false;
+};
+
+struct PlaceDispatchAffinitiesPass
+    : public IREE::HAL::impl::PlaceDispatchAffinitiesPassBase<
+          PlaceDispatchAffinitiesPass> {
+  using IREE::HAL::impl::PlaceDispatchAffinitiesPassBase<
+      PlaceDispatchAffinitiesPass>::PlaceDispatchAffinitiesPassBase;
+  void runOnOperation() override {
+    auto moduleOp = getOperation();
+
+    // Gather one candidate affinity per device. Placement is only meaningful
+    // when there is more than one device to choose from.
+    DeviceAnalysis deviceAnalysis(moduleOp);
+    if (failed(deviceAnalysis.run())) {
+      return signalPassFailure();
+    }
+    SmallVector<PlacementCandidate> candidates;
+    for (auto deviceGlobalOp : deviceAnalysis.getDeviceGlobals()) {
+      auto deviceSet = deviceAnalysis.lookupDeviceTargets(deviceGlobalOp);
+      if (!deviceSet) {
+        continue;
+      }
+      PlacementCandidate candidate;
+      candidate.affinityAttr = IREE::HAL::DeviceAffinityAttr::get(
+          &getContext(), FlatSymbolRefAttr::get(deviceGlobalOp.getGlobalName()),
+          /*queue_mask=*/-1ll);
+      candidate.isHost = isHostDevice(*deviceSet);
+      candidate.costModel = candidate.isHost ? kHostDeviceCostModel
+                                             : kAcceleratorDeviceCostModel;
+      candidates.push_back(candidate);
+    }
+    if (candidates.size() < 2) {
+      return;
+    }
+
+    // The first host device (if any) receives scalar dispatches.
+    const PlacementCandidate *hostCandidate = nullptr;
+    if (scalarDispatchesOnHost) {
+      auto it = llvm::find_if(
+          candidates, [](const PlacementCandidate &c) { return c.isHost; });
+      if (it != candidates.end()) {
+        hostCandidate = &*it;
+      }
+    }
+
+    IREE::Stream::AffinityAnalysis affinityAnalysis(moduleOp);
+    if (failed(affinityAnalysis.run())) {
+      return signalPassFailure();
+    }
+
+    // Affinities chosen for dispatch results so that consumers placed later in
+    // program order see where their operands will live.
+    DenseMap<Value, IREE::Stream::AffinityAttr> placedAffinities;
+    auto lookupOperandAffinity =
+        [&](Value value) -> IREE::Stream::AffinityAttr {
+      auto it = placedAffinities.find(value);
+      if (it != placedAffinities.end()) {
+        return it->second;
+      }
+      return affinityAnalysis.lookupResourceAffinity(value);
+    };
+
+    // Returns the affinity a non-placed |user| of a dispatch result requires.
+    auto lookupUserAffinity =
+        [&](OpOperand &use) -> IREE::Stream::AffinityAttr {
+      auto *user = use.getOwner();
+      if (isa<IREE::Util::ReturnOp>(user)) {
+        auto funcOp = user->getParentOfType<FunctionOpInterface>();
+        if (auto affinityAttr =
+                funcOp.getResultAttrOfType<IREE::Stream::AffinityAttr>(
+                    use.getOperandNumber(), "stream.affinity")) {
+          return affinityAttr;
+        }
+        return IREE::Stream::AffinityAttr::lookupOrDefault(funcOp);
+      }
+      if (auto affinityAttr = affinityAnalysis.lookupExecutionAffinity(user)) {
+        return affinityAttr;
+      }
+      return IREE::Stream::AffinityAttr::lookupOrDefault(user);
+    };
+
+    moduleOp.walk([&](IREE::Flow::DispatchOp dispatchOp) {
+      // Respect user-specified placement on the op or any parent scope.
+      if (IREE::Stream::AffinityAttr::lookup(dispatchOp)) {
+        return;
+      }
+
+      // Scalar dispatches go to the host regardless of where their operands
+      // live: transferring a scalar is cheaper than a device launch and the
+      // synchronization it requires.
+      if (hostCandidate && isScalarDispatch(dispatchOp)) {
+        dispatchOp->setAttr("stream.affinity", hostCandidate->affinityAttr);
+        for (auto result : dispatchOp.getResults()) {
+          placedAffinities[result] = hostCandidate->affinityAttr;
+        }
+        return;
+      }
+      if (!placeByCost) {
+        return;
+      }
+
+      // Estimate the work performed. If any part of it is dynamic we can't
+      // make a meaningful decision and leave the dispatch unplaced.
+      auto flops = estimateDispatchFlops(dispatchOp);
+      if (!flops) {
+        return;
+      }
+      SmallVector<std::pair<Value, int64_t>> operandBytes;
+      SmallVector<std::pair<Value, int64_t>> resultBytes;
+      int64_t totalBytes = 0;
+      for (auto operand : dispatchOp.getArguments()) {
+        if (!isa<ShapedType>(operand.getType())) {
+          continue;
+        }
+        auto byteSize = getStaticByteSize(operand.getType());
+        if (!byteSize) {
+          return;
+        }
+        operandBytes.push_back({operand, *byteSize});
+        totalBytes += *byteSize;
+      }
+      for (auto result : dispatchOp.getResults()) {
+        if (!isa<ShapedType>(result.getType())) {
+          continue;
+        }
+        auto byteSize = getStaticByteSize(result.getType());
+        if (!byteSize) {
+          return;
+        }
+        resultBytes.push_back({result, *byteSize});
+        totalBytes += *byteSize;
+      }
+
+      // Score each candidate. Ties favor the current affinity of the dispatch
+      // (as analyzed) followed by device declaration order.
+      auto currentAffinityAttr =
+          affinityAnalysis.lookupExecutionAffinity(dispatchOp);
+      const PlacementCandidate *bestCandidate = nullptr;
+      double bestCost = 0.0;
+      for (auto &candidate : candidates) {
+        const auto &costModel = candidate.costModel;
+        double cost = costModel.launchOverhead +
+                      std::max(*flops / costModel.flopsPerUs,
+                               totalBytes / costModel.bytesPerUs);
+        for (auto [operand, byteSize] : operandBytes) {
+          auto operandAffinityAttr = lookupOperandAffinity(operand);
+          if (operandAffinityAttr &&
+              operandAffinityAttr != candidate.affinityAttr) {
+            cost += getTransferCost(byteSize);
+          }
+        }
+        for (auto [result, byteSize] : resultBytes) {
+          DenseSet<IREE::Stream::AffinityAttr> userAffinities;
+          for (auto &use : result.getUses()) {
+            // Dispatch consumers account for their own transfers when placed.
+            if (isa<IREE::Flow::DispatchOp>(use.getOwner())) {
+              continue;
+            }
+            auto userAffinityAttr = lookupUserAffinity(use);
+            if (userAffinityAttr &&
+                userAffinityAttr != candidate.affinityAttr &&
+                userAffinities.insert(userAffinityAttr).second) {
+              cost += getTransferCost(byteSize);
+            }
+          }
+        }
+        LLVM_DEBUG(llvm::dbgs() << "  " << dispatchOp.getEntryPointName()
+                                << " on " << candidate.affinityAttr
+                                << ": cost " << cost << "\n");
+        bool isCurrent = candidate.affinityAttr == currentAffinityAttr;
+        if (!bestCandidate || cost < bestCost ||
+            (cost == bestCost && isCurrent)) {
+          bestCandidate = &candidate;
+          bestCost = cost;
+        }
+      }
+
+      dispatchOp->setAttr("stream.affinity", bestCandidate->affinityAttr);
+      for (auto result : dispatchOp.getResults()) {
+        placedAffinities[result] = bestCandidate->affinityAttr;
+      }
+    });
+  }
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::IREE::HAL
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <chrono>
 #include <memory>
 #include <utility>
 
@@ -13,8 +14,13 @@
 #include "iree/compiler/Dialect/HAL/Target/TargetRegistry.h"
 #include "iree/compiler/Dialect/HAL/Transforms/Passes.h"
 #include "iree/compiler/Utils/TracingUtils.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "llvm/ADT/StringSet.h"
 #include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/IR/Attributes.h"
 #include "mlir/IR/Builders.h"
 #include "mlir/IR/Diagnostics.h"
@@ -29,6 +35,148 @@ namespace mlir::iree_compiler::IREE::HAL {
 
 namespace {
 
+//===----------------------------------------------------------------------===//
+// Serialized binary cache
+//===----------------------------------------------------------------------===//
+
+// Bumped whenever the key derivation or the entry format changes.
+static constexpr StringLiteral kCacheFormatVersion = "1";
+
+// Digests all bytes written to the stream without retaining them.
+class md5_ostream : public llvm::raw_ostream {
+public:
+  md5_ostream() { SetUnbuffered(); }
+
+  llvm::MD5::MD5Result result() {
+    llvm::MD5::MD5Result digest;
+    hasher.final(digest);
+    return digest;
+  }
+
+private:
+  void write_impl(const char *ptr, size_t size) override {
+    hasher.update(
+        ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(ptr), size));
+    pos += size;
+  }
+  uint64_t current_pos() const override { return pos; }
+  llvm::MD5 hasher;
+  uint64_t pos = 0;
+};
+
+// Returns the cache key of |variantOp| when serialized by |target|. Locations
+// are only included when they can end up in the serialized binary.
+static std::string computeCacheKey(IREE::HAL::ExecutableVariantOp variantOp,
+                                   StringRef target, int debugLevel) {
+  md5_ostream os;
+  os << kCacheFormatVersion << '\0' << target << '\0' << debugLevel << '\0';
+  OpPrintingFlags flags;
+  flags.printGenericOpForm();
+  if (debugLevel > 0) {
+    flags.enableDebugInfo();
+  }
+  variantOp->print(os, flags);
+  os.flush();
+  return os.result().digest().str().str();
+}
+
+static SmallString<256> getCacheEntryPath(StringRef cachePath, StringRef key) {
+  SmallString<256> path(cachePath);
+  llvm::sys::path::append(path, key + ".bin");
+  return path;
+}
+
+// Cache entries contain one record per hal.executable.binary:
+//   <sym_name>\n<format>\n<mime_type>\n<data size>\n<data bytes>
+// Attributes are stored as plain strings and the data as raw bytes.
+static LogicalResult
+storeCacheEntry(StringRef cachePath, StringRef key,
+                ArrayRef<IREE::HAL::ExecutableBinaryOp> binaryOps) {
+  if (llvm::sys::fs::create_directories(cachePath)) {
+    return failure();
+  }
+  SmallVector<SmallVector<char>> binaryDatas;
+  for (auto binaryOp : binaryOps) {
+    auto serializableAttr =
+        dyn_cast<IREE::Util::SerializableAttrInterface>(binaryOp.getData());
+    if (!serializableAttr ||
+        failed(serializableAttr.serializeToVector(
+            binaryOp.getLoc(), llvm::endianness::little,
+            binaryDatas.emplace_back()))) {
+      return failure();
+    }
+  }
+  llvm::Error error = llvm::writeToOutput(
+      getCacheEntryPath(cachePath, key), [&](llvm::raw_ostream &os) {
+        for (auto [binaryOp, binaryData] :
+             llvm::zip_equal(binaryOps, binaryDatas)) {
+          os << binaryOp.getSymName() << "\n"
+             << binaryOp.getFormat() << "\n"
+             << binaryOp.getMimeType().value_or("") << "\n"
+             << binaryData.size() << "\n";
+          os.write(binaryData.data(), binaryData.size());
+        }
+        return llvm::Error::success();
+      });
+  if (error) {
+    llvm::consumeError(std::move(error));
+    return failure();
+  }
+  return success();
+}
+
+// Recreates the hal.executable.binary ops stored in the cache entry for |key|
+// at the insertion point of |executableBuilder|. Fails without modifying the
+// IR if there is no entry or it is malformed.
+static LogicalResult loadCacheEntry(StringRef cachePath, StringRef key,
+                                    Location loc,
+                                    OpBuilder &executableBuilder) {
+  auto fileOr = llvm::MemoryBuffer::getFile(getCacheEntryPath(cachePath, key),
+                                            /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!fileOr) {
+    return failure();
+  }
+  struct BinaryRecord {
+    StringRef symName;
+    StringRef format;
+    StringRef mimeType;
+    StringRef data;
+  };
+  SmallVector<BinaryRecord> records;
+  StringRef buffer = (*fileOr)->getBuffer();
+  while (!buffer.empty()) {
+    BinaryRecord record;
+    StringRef dataSize;
+    std::tie(record.symName, buffer) = buffer.split('\n');
+    std::tie(record.format, buffer) = buffer.split('\n');
+    std::tie(record.mimeType, buffer) = buffer.split('\n');
+    std::tie(dataSize, buffer) = buffer.split('\n');
+    size_t size = 0;
+    if (record.symName.empty() || dataSize.getAsInteger(10, size) ||
+        size > buffer.size()) {
+      return failure();
+    }
+    record.data = buffer.take_front(size);
+    buffer = buffer.drop_front(size);
+    records.push_back(record);
+  }
+  if (records.empty()) {
+    return failure();
+  }
+  for (auto &record : records) {
+    auto binaryOp = executableBuilder.create<IREE::HAL::ExecutableBinaryOp>(
+        loc, record.symName, record.format,
+        std::vector<uint8_t>(record.data.bytes_begin(),
+                             record.data.bytes_end()));
+    if (!record.mimeType.empty()) {
+      binaryOp.setMimeTypeAttr(
+          executableBuilder.getStringAttr(record.mimeType));
+    }
+  }
+  return success();
+}
+
 //===----------------------------------------------------------------------===//
 // --iree-hal-serialize-target-executables
 //===----------------------------------------------------------------------===//
@@ -81,15 +229,49 @@ struct SerializeTargetExecutablesPass
       if (variantOp.getTarget().getBackend().getValue() != target)
         continue;
       OpBuilder executableBuilder(variantOp);
+
+      // Reuse binaries from a prior compilation if the variant is unchanged.
+      // Dumping intermediates or binaries requires running serialization so
+      // the cache is bypassed in that case.
+      std::optional<std::string> cacheKey;
+      if (!cachePath.empty() && dumpIntermediatesPath.empty() &&
+          dumpBinariesPath.empty()) {
+        cacheKey = computeCacheKey(variantOp, target, debugLevel);
+        if (succeeded(loadCacheEntry(cachePath, *cacheKey, variantOp.getLoc(),
+                                     executableBuilder))) {
+          variantOp.erase();
+          continue;
+        }
+      }
+
       // Ask the target backend to serialize the executable. Note that it
       // may create one or more hal.executable.binary ops in the case of
       // multi-architecture binaries.
+      Operation *prevOp = variantOp->getPrevNode();
       if (failed(targetBackend->serializeExecutable(
               serializationOptions, variantOp, executableBuilder))) {
         variantOp.emitError()
             << "failed to serialize executable for target backend " << target;
         return signalPassFailure();
       }
+
+      // Binaries are inserted immediately before the variant.
+      if (cacheKey) {
+        SmallVector<IREE::HAL::ExecutableBinaryOp> binaryOps;
+        for (Operation &op : llvm::make_range(
+                 prevOp ? std::next(prevOp->getIterator())
+                        : executableOp.getBlock().begin(),
+                 variantOp->getIterator())) {
+          if (auto binaryOp = dyn_cast<IREE::HAL::ExecutableBinaryOp>(op)) {
+            binaryOps.push_back(binaryOp);
+          }
+        }
+        if (failed(storeCacheEntry(cachePath, *cacheKey, binaryOps))) {
+          variantOp.emitWarning()
+              << "failed to store serialized executable in cache '"
+              << cachePath << "'";
+        }
+      }
       variantOp.erase();
     }
   }
@@ -110,15 +292,32 @@ struct SerializeExecutablesPass
     for (const auto &targetName : gatherExecutableTargetNames(executableOp)) {
       passManager.addPass(IREE::HAL::createSerializeTargetExecutablesPass(
           {targetRegistry, targetName, debugLevel, dumpIntermediatesPath,
-           dumpBinariesPath}));
+           dumpBinariesPath, cachePath}));
     }
 
     IREE_COMPILER_TRACE_MESSAGE_DYNAMIC(INFO, executableOp.getSymName().str());
 
+    auto startTime = std::chrono::steady_clock::now();
     if (failed(runPipeline(passManager, executableOp))) {
       executableOp.emitError() << "failed to serialize executables";
       return signalPassFailure();
     }
+    auto elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime);
+
+    int64_t binarySize = 0;
+    for (auto binaryOp : executableOp.getOps<IREE::HAL::ExecutableBinaryOp>()) {
+      if (auto serializableAttr =
+              dyn_cast<IREE::Util::SerializableAttrInterface>(
+                  binaryOp.getData())) {
+        binarySize += serializableAttr.getStorageSize();
+      }
+    }
+    Builder builder(&getContext());
+    setCompileReportEntry(executableOp, "serialization_time_us",
+                          builder.getI64IntegerAttr(elapsedTime.count()));
+    setCompileReportEntry(executableOp, "binary_size",
+                          builder.getI64IntegerAttr(binarySize));
   }
 };
 
@@ -4,6 +4,7 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <chrono>
 #include <memory>
 #include <utility>
 
@@ -105,10 +106,16 @@ struct TranslateExecutablesPass
 
     IREE_COMPILER_TRACE_MESSAGE_DYNAMIC(INFO, executableOp.getSymName().str());
 
+    auto startTime = std::chrono::steady_clock::now();
     if (failed(runPipeline(passManager, executableOp))) {
       llvm::errs() << "failed to translate executables\n";
       return signalPassFailure();
     }
+    auto elapsedTime = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - startTime);
+    setCompileReportEntry(
+        executableOp, "translation_time_us",
+        Builder(&getContext()).getI64IntegerAttr(elapsedTime.count()));
   }
 };
 
@@ -0,0 +1,45 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(hal.executable(iree-hal-capture-compile-report))' %s | FileCheck %s
+
+#executable_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64">
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>,
+  #hal.pipeline.binding<storage_buffer>
+]>
+#config = #iree_codegen.lowering_config<tile_sizes = [[64, 64, 0], [8, 32, 0], [0, 0, 16]]>
+#translation = #iree_codegen.translation_info<pipeline = CPUDoubleTilingExpert>
+
+// CHECK: hal.executable private @ex
+// CHECK-SAME: hal.compile_report = {exports = [{
+// CHECK-SAME: bytes = 387584 : i64
+// CHECK-SAME: export = "matmul"
+// CHECK-SAME: flops = 6488064 : i64
+// CHECK-SAME: pipeline = "CPUDoubleTilingExpert"
+// CHECK-SAME: variant = "variant"
+// CHECK-SAME: workgroup_tile_sizes = array<i64: 64, 64, 0>
+// CHECK-SAME: }]}
+hal.executable private @ex {
+  hal.executable.variant public @variant target(#executable_target) {
+    hal.executable.export public @matmul ordinal(0) layout(#pipeline_layout) {
+    ^bb0(%device: !hal.device):
+      %c1 = arith.constant 1 : index
+      hal.return %c1, %c1, %c1 : index, index, index
+    }
+    builtin.module {
+      func.func @matmul() attributes {translation_info = #translation} {
+        %c0 = arith.constant 0 : index
+        %cst = arith.constant 0.000000e+00 : f32
+        %0 = hal.interface.binding.subspan layout(#pipeline_layout) binding(0) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<128x49xf32>>
+        %1 = hal.interface.binding.subspan layout(#pipeline_layout) binding(1) alignment(64) offset(%c0) : !flow.dispatch.tensor<readonly:tensor<49x512xf32>>
+        %2 = hal.interface.binding.subspan layout(#pipeline_layout) binding(2) alignment(64) offset(%c0) : !flow.dispatch.tensor<writeonly:tensor<128x512xf32>>
+        %3 = flow.dispatch.tensor.load %0, offsets = [0, 0], sizes = [128, 49], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<128x49xf32>> -> tensor<128x49xf32>
+        %4 = flow.dispatch.tensor.load %1, offsets = [0, 0], sizes = [49, 512], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<49x512xf32>> -> tensor<49x512xf32>
+        %5 = tensor.empty() : tensor<128x512xf32>
+        %6 = linalg.fill ins(%cst : f32) outs(%5 : tensor<128x512xf32>) -> tensor<128x512xf32>
+        %7 = linalg.matmul {lowering_config = #config} ins(%3, %4 : tensor<128x49xf32>, tensor<49x512xf32>) outs(%6 : tensor<128x512xf32>) -> tensor<128x512xf32>
+        flow.dispatch.tensor.store %7, %2, offsets = [0, 0], sizes = [128, 512], strides = [1, 1] : tensor<128x512xf32> -> !flow.dispatch.tensor<writeonly:tensor<128x512xf32>>
+        return
+      }
+    }
+  }
+}
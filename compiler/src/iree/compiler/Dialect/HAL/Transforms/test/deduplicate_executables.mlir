@@ -0,0 +1,67 @@
+// RUN: iree-opt --split-input-file --iree-hal-deduplicate-executables %s | FileCheck %s
+
+// Tests that executables with identical binaries are merged and references to
+// the duplicates are redirected.
+
+// CHECK: hal.executable private @exe_a
+hal.executable private @exe_a {
+  hal.executable.binary public @binary attributes {data = dense<123> : vector<64xi8>, format = "format", mime_type = "application/x-elf"}
+}
+// CHECK-NOT: hal.executable private @exe_b
+hal.executable private @exe_b {
+  hal.executable.binary public @binary attributes {data = dense<123> : vector<64xi8>, format = "format", mime_type = "application/x-elf"}
+}
+// Should not be merged as the data differs.
+// CHECK: hal.executable private @exe_c
+hal.executable private @exe_c {
+  hal.executable.binary public @binary attributes {data = dense<124> : vector<64xi8>, format = "format", mime_type = "application/x-elf"}
+}
+// Should not be merged as the format differs.
+// CHECK: hal.executable private @exe_d
+hal.executable private @exe_d {
+  hal.executable.binary public @binary attributes {data = dense<123> : vector<64xi8>, format = "other", mime_type = "application/x-elf"}
+}
+// Should not be merged as it's public.
+// CHECK: hal.executable public @exe_e
+hal.executable public @exe_e {
+  hal.executable.binary public @binary attributes {data = dense<123> : vector<64xi8>, format = "format", mime_type = "application/x-elf"}
+}
+
+// CHECK-LABEL: util.func private @user
+util.func private @user(%cond: i1) {
+  // CHECK: util.optimization_barrier {
+  // CHECK-SAME: ref_a = @exe_a::@binary
+  // CHECK-SAME: ref_b = @exe_a::@binary
+  // CHECK-SAME: ref_c = @exe_c::@binary
+  // CHECK-SAME: ref_d = @exe_d
+  // CHECK-SAME: ref_e = @exe_e::@binary
+  util.optimization_barrier {
+    ref_a = @exe_a::@binary,
+    ref_b = @exe_b::@binary,
+    ref_c = @exe_c::@binary,
+    ref_d = @exe_d,
+    ref_e = @exe_e::@binary
+  } %cond : i1
+  util.return
+}
+
+// -----
+
+// Tests that executables that have not been serialized are left as-is.
+
+#pipeline_layout = #hal.pipeline.layout<bindings = [
+  #hal.pipeline.binding<storage_buffer>
+]>
+
+// CHECK: hal.executable private @source_a
+hal.executable private @source_a {
+  hal.executable.variant public @variant target(<"backend", "format">) {
+    hal.executable.export public @export layout(#pipeline_layout)
+  }
+}
+// CHECK: hal.executable private @source_b
+hal.executable private @source_b {
+  hal.executable.variant public @variant target(<"backend", "format">) {
+    hal.executable.export public @export layout(#pipeline_layout)
+  }
+}
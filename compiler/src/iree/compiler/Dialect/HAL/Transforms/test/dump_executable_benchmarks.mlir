@@ -63,12 +63,22 @@ hal.executable private @ex0 {
 // CHECK: %[[BUFFER:.+]] = hal.allocator.allocate<%{{.+}} : !hal.allocator> affinity(%{{.+}}) type("DeviceVisible|DeviceLocal") usage("{{.+}}Dispatch{{.+}}") : !hal.buffer{%c768}
 // CHECK-NEXT: util.global.store %[[BUFFER]], @ex0_embedded_elf_x86_64_dispatch0_512_buffer : !hal.buffer
 
-// CHECK: util.func public @ex0_embedded_elf_x86_64_dispatch0_512(%arg0: i32)
-// CHECK-SAME: attributes {iree.abi.stub, iree.reflection = {iree.benchmark = "dispatch"}} {
+// Recorded command buffer cached across invocations:
+// CHECK: util.global private mutable @ex0_embedded_elf_x86_64_dispatch0_512_command_buffer : !hal.command_buffer
+// CHECK: util.global private mutable @ex0_embedded_elf_x86_64_dispatch0_512_batch_size = 0 : index
+
+// CHECK: util.func public @ex0_embedded_elf_x86_64_dispatch0_512(%arg0: i32, %[[WAIT_FENCE:.+]]: !hal.fence, %[[SIGNAL_FENCE:.+]]: !hal.fence)
+// CHECK-SAME: attributes {iree.abi.stub, iree.reflection = {iree.abi.model = "coarse-fences", iree.benchmark = "dispatch"}} {
 // CHECK: %[[BATCH_SIZE:.+]] = arith.index_cast %arg0 : i32 to index
 
-// Create command buffer:
+// Only record when the batch size changes:
+// CHECK: %[[RECORDED_BATCH_SIZE:.+]] = util.global.load @ex0_embedded_elf_x86_64_dispatch0_512_batch_size
+// CHECK: %[[NEEDS_RECORDING:.+]] = arith.cmpi ne, %[[RECORDED_BATCH_SIZE]], %[[BATCH_SIZE]]
+// CHECK: scf.if %[[NEEDS_RECORDING]] {
+
+// Create a reusable command buffer:
 // CHECK: %[[CMD:.+]] = hal.command_buffer.create
+// CHECK-SAME: mode("None")
 
 // CHECK: %[[BUFFER:.+]] = util.global.load @ex0_embedded_elf_x86_64_dispatch0_512_buffer
 
@@ -97,21 +107,32 @@ hal.executable private @ex0 {
 // CHECK-NEXT: hal.command_buffer.execution_barrier
 // CHECK-NEXT: }
 
-// Submit and wait for dispatches to complete:
+// Finalize and cache the command buffer:
 // CHECK: hal.command_buffer.finalize<%[[CMD]] : !hal.command_buffer>
-// CHECK: hal.fence.await
+// CHECK: util.global.store %[[CMD]], @ex0_embedded_elf_x86_64_dispatch0_512_command_buffer
+// CHECK: util.global.store %[[BATCH_SIZE]], @ex0_embedded_elf_x86_64_dispatch0_512_batch_size
+// CHECK: }
+
+// Submit the cached command buffer without waiting:
+// CHECK: %[[CACHED_CMD:.+]] = util.global.load @ex0_embedded_elf_x86_64_dispatch0_512_command_buffer
+// CHECK: hal.device.queue.execute
+// CHECK-SAME: wait(%[[WAIT_FENCE]])
+// CHECK-SAME: signal(%[[SIGNAL_FENCE]])
+// CHECK-SAME: commands([%[[CACHED_CMD]]])
+// CHECK-NOT: hal.fence.await
+// CHECK: util.return
 
 // ===========================================================================
 // @dispatch1 benchmark logic (note two deduplicated dispatches):
 // ===========================================================================
 
 // CHECK: util.global private mutable @ex0_embedded_elf_x86_64_dispatch1_512x1_buffer : !hal.buffer
-// CHECK: util.func public @ex0_embedded_elf_x86_64_dispatch1_512x1(%arg0: i32)
+// CHECK: util.func public @ex0_embedded_elf_x86_64_dispatch1_512x1(%arg0: i32,
 // CHECK:   %[[ORDINAL_1A:.+]] = hal.executable.export.ordinal target(@ex0::@embedded_elf_x86_64::@dispatch1) : index
 // CHECK:   hal.command_buffer.dispatch<%{{.+}} : !hal.command_buffer> target({{.+}})[%[[ORDINAL_1A]]]
 
 // CHECK: util.global private mutable @ex0_embedded_elf_x86_64_dispatch1_128x32_buffer : !hal.buffer
-// CHECK: util.func public @ex0_embedded_elf_x86_64_dispatch1_128x32(%arg0: i32)
+// CHECK: util.func public @ex0_embedded_elf_x86_64_dispatch1_128x32(%arg0: i32,
 // CHECK:   %[[ORDINAL_1B:.+]] = hal.executable.export.ordinal target(@ex0::@embedded_elf_x86_64::@dispatch1) : index
 // CHECK:   hal.command_buffer.dispatch<%{{.+}} : !hal.command_buffer> target({{.+}})[%[[ORDINAL_1B]]]
 
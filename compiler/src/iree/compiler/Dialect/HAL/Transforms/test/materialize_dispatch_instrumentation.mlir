@@ -1,4 +1,9 @@
 // RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-hal-materialize-dispatch-instrumentation{buffer-size=64mib})' %s | FileCheck %s
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(iree-hal-materialize-dispatch-instrumentation{buffer-size=64mib sample-rate=4})' %s | FileCheck %s --check-prefix=SAMPLE
+
+// Sampling adds a host-side counter selecting which submissions are
+// instrumented:
+// SAMPLE: util.global {{.*}}mutable @__dispatch_instrumentation_sample_counter = 0 : i32
 
 module attributes {hal.device.targets = [
   #hal.device.target<"local", [
@@ -33,6 +38,12 @@ module attributes {hal.device.targets = [
       // Dispatches get the instrumentation buffer and a unique dispatch site ID:
       // CHECK: func.func @dispatch
       // CHECK-SAME: (%arg0: !stream.binding {stream.alignment = 64 : index}, %arg1: !stream.binding {stream.alignment = 64 : index}, %[[INSTR_BINDING:.+]]: !stream.binding {stream.alignment = 64 : index}, %[[SITE_ID:.+]]: i32)
+      // Unsampled submissions use a clone of the original function:
+      // SAMPLE: func.func @dispatch(%{{.+}}: !stream.binding {{.+}}, %{{.+}}: !stream.binding {{.+}}, %{{.+}}: !stream.binding {{.+}}, %{{.+}}: i32)
+      // SAMPLE: hal.instrument.workgroup
+      // SAMPLE: func.func @dispatch_uninstrumented(%{{.+}}: !stream.binding {{.+}}, %{{.+}}: !stream.binding {{.+}}) {
+      // SAMPLE-NOT: hal.instrument.workgroup
+      // SAMPLE: return
       func.func @dispatch(%arg0: !stream.binding {stream.alignment = 64 : index}, %arg1: !stream.binding {stream.alignment = 64 : index}) {
         // Default instrumentation just adds the workgroup marker.
         // Subsequent dispatch instruments will use the workgroup key.
@@ -64,6 +75,19 @@ module attributes {hal.device.targets = [
     // CHECK: %[[EXECUTE_BUFFER:.+]] = util.global.load @__dispatch_instrumentation
     // CHECK: stream.cmd.execute
     // CHECK-SAME: %[[EXECUTE_BUFFER]] as %[[CAPTURE_BUFFER:.+]]: !stream.resource<external>{%[[DEFAULT_SIZE]]})
+    // SAMPLE: %[[COUNTER:.+]] = util.global.load @__dispatch_instrumentation_sample_counter
+    // SAMPLE: %[[NEXT:.+]] = arith.remui
+    // SAMPLE: util.global.store %[[NEXT]], @__dispatch_instrumentation_sample_counter
+    // SAMPLE: %[[SAMPLED:.+]] = arith.cmpi eq, %[[COUNTER]], %c0_i32
+    // SAMPLE: %[[TIMEPOINT:.+]] = scf.if %[[SAMPLED]] -> (!stream.timepoint) {
+    // SAMPLE:   util.global.load @__dispatch_instrumentation :
+    // SAMPLE:   stream.cmd.execute
+    // SAMPLE:     stream.cmd.dispatch @executable::@dispatch {
+    // SAMPLE: } else {
+    // SAMPLE:   stream.cmd.execute
+    // SAMPLE:     stream.cmd.dispatch @executable::@dispatch_uninstrumented {
+    // SAMPLE: }
+    // SAMPLE: stream.timepoint.await %[[TIMEPOINT]]
     %timepoint = stream.cmd.execute with(%arg0 as %arg0_capture: !stream.resource<external>{%c128}, %ret0 as %ret0_capture: !stream.resource<external>{%c128}) {
       // CHECK: stream.cmd.dispatch @executable::@dispatch
       stream.cmd.dispatch @executable::@dispatch {
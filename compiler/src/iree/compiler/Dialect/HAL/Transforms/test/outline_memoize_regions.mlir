@@ -242,3 +242,54 @@ util.func public @memoize_command_buffer() -> !hal.command_buffer {
   // CHECK: util.return %[[CMD]]
   util.return %result : !hal.command_buffer
 }
+
+// -----
+
+// Tests that structurally equivalent memoize regions share a single memoized
+// result and regions that differ get their own.
+
+util.global private @device = #hal.device.target<"local"> : !hal.device
+
+// CHECK: util.func private @__memoize_equivalent_a_memoize_apply
+// CHECK: util.global private @__memoize_equivalent_a_memoize_result_0_device
+// CHECK: util.func private @__memoize_equivalent_a_memoize_lookup
+// CHECK-NOT: @__memoize_equivalent_b_memoize_apply
+
+// CHECK-LABEL: util.func public @memoize_equivalent_a
+util.func public @memoize_equivalent_a() -> index {
+  %device = util.global.load immutable @device : !hal.device
+  %affinity = arith.constant -1 : i64
+  // CHECK: util.call @__memoize_equivalent_a_memoize_lookup
+  %result = hal.device.memoize<%device : !hal.device> affinity(%affinity) -> index {
+    %c4 = arith.constant 4 : index
+    hal.return %c4 : index
+  }
+  util.return %result : index
+}
+
+// CHECK: util.func private @__memoize_different_memoize_apply
+// CHECK: util.func private @__memoize_different_memoize_lookup
+
+// CHECK-LABEL: util.func public @memoize_different
+util.func public @memoize_different() -> index {
+  %device = util.global.load immutable @device : !hal.device
+  %affinity = arith.constant -1 : i64
+  // CHECK: util.call @__memoize_different_memoize_lookup
+  %result = hal.device.memoize<%device : !hal.device> affinity(%affinity) -> index {
+    %c5 = arith.constant 5 : index
+    hal.return %c5 : index
+  }
+  util.return %result : index
+}
+
+// CHECK-LABEL: util.func public @memoize_equivalent_b
+util.func public @memoize_equivalent_b() -> index {
+  %device = util.global.load immutable @device : !hal.device
+  %affinity = arith.constant -1 : i64
+  // CHECK: util.call @__memoize_equivalent_a_memoize_lookup
+  %result = hal.device.memoize<%device : !hal.device> affinity(%affinity) -> index {
+    %c4 = arith.constant 4 : index
+    hal.return %c4 : index
+  }
+  util.return %result : index
+}
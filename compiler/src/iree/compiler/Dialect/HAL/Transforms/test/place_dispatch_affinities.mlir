@@ -0,0 +1,150 @@
+// RUN: iree-opt --split-input-file --iree-hal-place-dispatch-affinities %s | FileCheck %s
+// RUN: iree-opt --split-input-file --iree-hal-place-dispatch-affinities="place-by-cost=false scalar-dispatches-on-host=true" %s | FileCheck %s --check-prefix=SCALAR
+
+// Tests that small dispatches consuming and producing host resources are
+// placed on the host device while large ones stay on the accelerator.
+
+#cpu_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64">
+#gpu_target = #hal.executable.target<"vulkan-spirv", "vulkan-spirv-fb">
+module attributes {stream.affinity.default = #hal.device.affinity<@device_gpu>} {
+
+util.global private @device_cpu = #hal.device.target<"local", [#cpu_target]> : !hal.device
+util.global private @device_gpu = #hal.device.target<"vulkan", [#gpu_target]> : !hal.device
+
+flow.executable private @ex {
+  flow.executable.export public @tiny
+  flow.executable.export public @matmul
+  builtin.module {
+    func.func @tiny(%arg0: !flow.dispatch.tensor<readonly:tensor<4xf32>>, %arg1: !flow.dispatch.tensor<writeonly:tensor<4xf32>>) {
+      %0 = flow.dispatch.tensor.load %arg0, offsets = [0], sizes = [4], strides = [1] : !flow.dispatch.tensor<readonly:tensor<4xf32>> -> tensor<4xf32>
+      %1 = tensor.empty() : tensor<4xf32>
+      %2 = linalg.generic {indexing_maps = [affine_map<(d0) -> (d0)>, affine_map<(d0) -> (d0)>], iterator_types = ["parallel"]} ins(%0 : tensor<4xf32>) outs(%1 : tensor<4xf32>) {
+      ^bb0(%in: f32, %out: f32):
+        %3 = arith.addf %in, %in : f32
+        linalg.yield %3 : f32
+      } -> tensor<4xf32>
+      flow.dispatch.tensor.store %2, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xf32> -> !flow.dispatch.tensor<writeonly:tensor<4xf32>>
+      return
+    }
+    func.func @matmul(%arg0: !flow.dispatch.tensor<readonly:tensor<512x512xf32>>, %arg1: !flow.dispatch.tensor<readonly:tensor<512x512xf32>>, %arg2: !flow.dispatch.tensor<writeonly:tensor<512x512xf32>>) {
+      %cst = arith.constant 0.000000e+00 : f32
+      %0 = flow.dispatch.tensor.load %arg0, offsets = [0, 0], sizes = [512, 512], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<512x512xf32>> -> tensor<512x512xf32>
+      %1 = flow.dispatch.tensor.load %arg1, offsets = [0, 0], sizes = [512, 512], strides = [1, 1] : !flow.dispatch.tensor<readonly:tensor<512x512xf32>> -> tensor<512x512xf32>
+      %2 = tensor.empty() : tensor<512x512xf32>
+      %3 = linalg.fill ins(%cst : f32) outs(%2 : tensor<512x512xf32>) -> tensor<512x512xf32>
+      %4 = linalg.matmul ins(%0, %1 : tensor<512x512xf32>, tensor<512x512xf32>) outs(%3 : tensor<512x512xf32>) -> tensor<512x512xf32>
+      flow.dispatch.tensor.store %4, %arg2, offsets = [0, 0], sizes = [512, 512], strides = [1, 1] : tensor<512x512xf32> -> !flow.dispatch.tensor<writeonly:tensor<512x512xf32>>
+      return
+    }
+  }
+}
+
+// CHECK-LABEL: @hostTiny
+util.func public @hostTiny(%view: !hal.buffer_view) -> !hal.buffer_view {
+  %input = hal.tensor.import on(#hal.device.affinity<@device_cpu>) %view "input" : !hal.buffer_view -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@tiny
+  // CHECK-SAME: stream.affinity = #hal.device.affinity<@device_cpu>
+  %result = flow.dispatch @ex::@tiny(%input) : (tensor<4xf32>) -> tensor<4xf32>
+  %output = hal.tensor.export on(#hal.device.affinity<@device_cpu>) %result "output" : tensor<4xf32> -> !hal.buffer_view
+  util.return %output : !hal.buffer_view
+}
+
+// CHECK-LABEL: @deviceTiny
+util.func public @deviceTiny(%view: !hal.buffer_view) -> !hal.buffer_view {
+  %input = hal.tensor.import on(#hal.device.affinity<@device_gpu>) %view "input" : !hal.buffer_view -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@tiny
+  // CHECK-SAME: stream.affinity = #hal.device.affinity<@device_gpu>
+  %result = flow.dispatch @ex::@tiny(%input) : (tensor<4xf32>) -> tensor<4xf32>
+  %output = hal.tensor.export on(#hal.device.affinity<@device_gpu>) %result "output" : tensor<4xf32> -> !hal.buffer_view
+  util.return %output : !hal.buffer_view
+}
+
+// CHECK-LABEL: @hostMatmul
+util.func public @hostMatmul(%lhs_view: !hal.buffer_view, %rhs_view: !hal.buffer_view) -> !hal.buffer_view {
+  %lhs = hal.tensor.import on(#hal.device.affinity<@device_cpu>) %lhs_view "lhs" : !hal.buffer_view -> tensor<512x512xf32>
+  %rhs = hal.tensor.import on(#hal.device.affinity<@device_cpu>) %rhs_view "rhs" : !hal.buffer_view -> tensor<512x512xf32>
+  // The matmul is worth transferring its operands and result.
+  // CHECK: flow.dispatch @ex::@matmul
+  // CHECK-SAME: stream.affinity = #hal.device.affinity<@device_gpu>
+  %result = flow.dispatch @ex::@matmul(%lhs, %rhs) : (tensor<512x512xf32>, tensor<512x512xf32>) -> tensor<512x512xf32>
+  %output = hal.tensor.export on(#hal.device.affinity<@device_cpu>) %result "output" : tensor<512x512xf32> -> !hal.buffer_view
+  util.return %output : !hal.buffer_view
+}
+
+// CHECK-LABEL: @hostChain
+util.func public @hostChain(%view: !hal.buffer_view) -> !hal.buffer_view {
+  %input = hal.tensor.import on(#hal.device.affinity<@device_cpu>) %view "input" : !hal.buffer_view -> tensor<4xf32>
+  // Both dispatches stay together on the host as placing either on the
+  // accelerator would require transfers that cost more than the dispatch.
+  // CHECK: %[[FIRST:.+]] = flow.dispatch @ex::@tiny
+  // CHECK-SAME: stream.affinity = #hal.device.affinity<@device_cpu>
+  %first = flow.dispatch @ex::@tiny(%input) : (tensor<4xf32>) -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@tiny(%[[FIRST]])
+  // CHECK-SAME: stream.affinity = #hal.device.affinity<@device_cpu>
+  %second = flow.dispatch @ex::@tiny(%first) : (tensor<4xf32>) -> tensor<4xf32>
+  %output = hal.tensor.export on(#hal.device.affinity<@device_cpu>) %second "output" : tensor<4xf32> -> !hal.buffer_view
+  util.return %output : !hal.buffer_view
+}
+
+// CHECK-LABEL: @explicitAffinity
+util.func public @explicitAffinity(%view: !hal.buffer_view) -> !hal.buffer_view {
+  %input = hal.tensor.import on(#hal.device.affinity<@device_cpu>) %view "input" : !hal.buffer_view -> tensor<4xf32>
+  // CHECK: flow.dispatch @ex::@tiny
+  // CHECK-SAME: stream.affinity = #hal.device.affinity<@device_gpu>
+  %result = flow.dispatch @ex::@tiny(%input) {stream.affinity = #hal.device.affinity<@device_gpu>} : (tensor<4xf32>) -> tensor<4xf32>
+  %output = hal.tensor.export on(#hal.device.affinity<@device_cpu>) %result "output" : tensor<4xf32> -> !hal.buffer_view
+  util.return %output : !hal.buffer_view
+}
+
+}
+
+// -----
+
+// Tests that scalar dispatches are placed on the host device when requested
+// even if their operands live on the accelerator. Non-scalar dispatches are
+// left unplaced when cost-based placement is disabled.
+
+#cpu_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64">
+#gpu_target = #hal.executable.target<"vulkan-spirv", "vulkan-spirv-fb">
+module attributes {stream.affinity.default = #hal.device.affinity<@device_gpu>} {
+
+util.global private @device_cpu = #hal.device.target<"local", [#cpu_target]> : !hal.device
+util.global private @device_gpu = #hal.device.target<"vulkan", [#gpu_target]> : !hal.device
+
+flow.executable private @ex {
+  flow.executable.export public @scalar workgroups() -> (index, index, index) {
+    %c1 = arith.constant 1 : index
+    flow.return %c1, %c1, %c1 : index, index, index
+  }
+  flow.executable.export public @vector workgroups() -> (index, index, index) {
+    %c1 = arith.constant 1 : index
+    flow.return %c1, %c1, %c1 : index, index, index
+  }
+  builtin.module {
+    func.func @scalar(%arg0: !flow.dispatch.tensor<readonly:tensor<i32>>, %arg1: !flow.dispatch.tensor<writeonly:tensor<i32>>) {
+      %0 = flow.dispatch.tensor.load %arg0, offsets = [], sizes = [], strides = [] : !flow.dispatch.tensor<readonly:tensor<i32>> -> tensor<i32>
+      flow.dispatch.tensor.store %0, %arg1, offsets = [], sizes = [], strides = [] : tensor<i32> -> !flow.dispatch.tensor<writeonly:tensor<i32>>
+      return
+    }
+    func.func @vector(%arg0: !flow.dispatch.tensor<readonly:tensor<4xi32>>, %arg1: !flow.dispatch.tensor<writeonly:tensor<4xi32>>) {
+      %0 = flow.dispatch.tensor.load %arg0, offsets = [0], sizes = [4], strides = [1] : !flow.dispatch.tensor<readonly:tensor<4xi32>> -> tensor<4xi32>
+      flow.dispatch.tensor.store %0, %arg1, offsets = [0], sizes = [4], strides = [1] : tensor<4xi32> -> !flow.dispatch.tensor<writeonly:tensor<4xi32>>
+      return
+    }
+  }
+}
+
+// SCALAR-LABEL: @scalarOnHost
+util.func public @scalarOnHost(%view: !hal.buffer_view, %vector: tensor<4xi32>) -> (!hal.buffer_view, tensor<4xi32>) {
+  %input = hal.tensor.import on(#hal.device.affinity<@device_gpu>) %view "input" : !hal.buffer_view -> tensor<i32>
+  // SCALAR: flow.dispatch @ex::@scalar
+  // SCALAR-SAME: stream.affinity = #hal.device.affinity<@device_cpu>
+  %result = flow.dispatch @ex::@scalar(%input) : (tensor<i32>) -> tensor<i32>
+  // SCALAR: flow.dispatch @ex::@vector
+  // SCALAR-NOT: stream.affinity
+  %vector_result = flow.dispatch @ex::@vector(%vector) : (tensor<4xi32>) -> tensor<4xi32>
+  %output = hal.tensor.export on(#hal.device.affinity<@device_gpu>) %result "output" : tensor<i32> -> !hal.buffer_view
+  util.return %output, %vector_result : !hal.buffer_view, tensor<4xi32>
+}
+
+}
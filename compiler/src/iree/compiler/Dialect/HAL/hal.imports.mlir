@@ -307,6 +307,23 @@ vm.import private @command_buffer.dispatch(
   %bindings : tuple<i32, i32, !vm.ref<!hal.buffer>, i64, i64>...
 )
 
+// Dispatches a batch of execution requests using the same executable.
+// Each dispatch consumes the next |constant_count| constants and
+// |binding_count| bindings from the shared segments in order.
+vm.import private @command_buffer.dispatch.batch(
+  %command_buffer : !vm.ref<!hal.command_buffer>,
+  %executable : !vm.ref<!hal.executable>,
+  %constants : i32 ...,
+  // <reserved, slot, buffer, offset, length>
+  %bindings : tuple<i32, i32, !vm.ref<!hal.buffer>, i64, i64>...,
+  // <entry_point, workgroup_x, workgroup_y, workgroup_z,
+  //  constant_count, binding_count, flags>
+  %dispatches : tuple<i32, i32, i32, i32, i32, i32, i64>...
+)
+attributes {
+  minimum_version = 6 : i32  // batched dispatch
+}
+
 // Dispatches an execution request with the dispatch parameters loaded from the
 // given buffer.
 vm.import private @command_buffer.dispatch.indirect(
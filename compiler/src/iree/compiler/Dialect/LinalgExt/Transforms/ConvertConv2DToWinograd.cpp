@@ -35,10 +35,6 @@ static bool hasAllOneValues(DenseIntElementsAttr attr) {
   return llvm::all_of(attr, [](APInt element) { return element.isOne(); });
 }
 
-// TODO: Make this a user-settable parameter once we have support
-// for more tile sizes
-static constexpr int64_t outputTileSize = 6;
-
 template <typename T>
 static bool hasValidStridesAndDilations(Operation *op) {
   auto convOp = dyn_cast<T>(op);
@@ -157,9 +153,10 @@ class ConvertConvToWinograd final : public OpRewritePattern<ConvOp> {
 public:
   using OpRewritePattern<ConvOp>::OpRewritePattern;
   ConvertConvToWinograd<ConvOp>(MLIRContext *context, bool replaceAllConvs,
+                                int64_t outputTileSize,
                                 PatternBenefit benefit = 1)
       : OpRewritePattern<ConvOp>(context, benefit),
-        replaceAllConvs(replaceAllConvs) {}
+        replaceAllConvs(replaceAllConvs), outputTileSize(outputTileSize) {}
 
   LogicalResult matchAndRewrite(ConvOp convOp,
                                 PatternRewriter &rewriter) const override {
@@ -339,6 +336,7 @@ public:
 
 private:
   bool replaceAllConvs;
+  int64_t outputTileSize;
 };
 
 /// The ConvertConv2DToWinograd pass will only transform convs that have been
@@ -416,10 +414,16 @@ struct ConvertConv2DToWinogradPass final
   }
   void runOnOperation() override {
     MLIRContext *context = &getContext();
+    if (!Winograd::isSupportedOutputTileSize(outputTileSize)) {
+      getOperation()->emitError()
+          << "unsupported Winograd output tile size " << outputTileSize
+          << "; expected 4 or 6";
+      return signalPassFailure();
+    }
     RewritePatternSet patterns(&getContext());
     patterns.insert<ConvertConvToWinograd<linalg::Conv2DNhwcHwcfOp>,
                     ConvertConvToWinograd<linalg::Conv2DNchwFchwOp>>(
-        context, /*replaceAllConvs=*/replaceAllConvs);
+        context, /*replaceAllConvs=*/replaceAllConvs, outputTileSize);
     if (failed(applyPatternsAndFoldGreedily(getOperation(),
                                             std::move(patterns)))) {
       return signalPassFailure();
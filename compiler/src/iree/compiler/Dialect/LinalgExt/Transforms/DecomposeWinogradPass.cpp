@@ -129,6 +129,13 @@ struct DecomposeWinogradFilterTransform
     ArrayRef<int64_t> kernelDims = transformOp.getKernelDimensions();
     llvm::SmallSetVector<int64_t, 2> kernelDimsSet(kernelDims.begin(),
                                                    kernelDims.end());
+    const Winograd::TransformConstants *constants =
+        Winograd::getTransformConstants(transformOp.getOutputTileSize(),
+                                        kernelSize);
+    if (!constants) {
+      return rewriter.notifyMatchFailure(transformOp,
+                                         "unsupported Winograd tile size");
+    }
     Type elementType = transformOp.getOutputType().getElementType();
     Value zeroF32 = rewriter.create<arith::ConstantOp>(
         loc, rewriter.getZeroAttr(elementType));
@@ -136,11 +143,9 @@ struct DecomposeWinogradFilterTransform
     /// and G [G] constant matrices that convert the filter
     /// tile from the original domain to the Winograd domain.
     Value GT = IREE::LinalgExt::createValueFrom2DConstant(
-        IREE::LinalgExt::Winograd::GT_6x6_3x3, kernelSize, inputTileSize, loc,
-        rewriter);
+        constants->GT, kernelSize, inputTileSize, loc, rewriter);
     Value G = IREE::LinalgExt::createValueFrom2DConstant(
-        IREE::LinalgExt::Winograd::G_6x6_3x3, inputTileSize, kernelSize, loc,
-        rewriter);
+        constants->G, inputTileSize, kernelSize, loc, rewriter);
 
     // Create matmul(input, GT)
     SmallVector<int64_t> initShape(kernelDims.size(), inputTileSize);
@@ -210,12 +215,17 @@ struct DecomposeWinogradInputTransform
     /// tile from the original domain to the Winograd domain.
     Location loc = transformOp.getLoc();
     const int64_t inputTileSize = transformOp.getInputTileSize();
+    const Winograd::TransformConstants *constants =
+        Winograd::getTransformConstants(transformOp.getOutputTileSize(),
+                                        transformOp.getKernelSize());
+    if (!constants) {
+      return rewriter.notifyMatchFailure(transformOp,
+                                         "unsupported Winograd tile size");
+    }
     Value BT = IREE::LinalgExt::createValueFrom2DConstant(
-        IREE::LinalgExt::Winograd::BT_6x6_3x3, inputTileSize, inputTileSize,
-        loc, rewriter);
+        constants->BT, inputTileSize, inputTileSize, loc, rewriter);
     Value B = IREE::LinalgExt::createValueFrom2DConstant(
-        IREE::LinalgExt::Winograd::B_6x6_3x3, inputTileSize, inputTileSize, loc,
-        rewriter);
+        constants->B, inputTileSize, inputTileSize, loc, rewriter);
 
     // Pad the input slice.
     Value dynamicSlice = transformOp.getInput();
@@ -297,12 +307,17 @@ struct DecomposeWinogradOutputTransform
     /// The two values below are the transpose(A) [AT]
     /// and A [A] constant matrices that convert the output
     /// tile from the Winograd domain to the original domain.
+    const Winograd::TransformConstants *constants =
+        Winograd::getTransformConstants(outputTileSize,
+                                        transformOp.getKernelSize());
+    if (!constants) {
+      return rewriter.notifyMatchFailure(transformOp,
+                                         "unsupported Winograd tile size");
+    }
     Value AT = IREE::LinalgExt::createValueFrom2DConstant(
-        IREE::LinalgExt::Winograd::AT_6x6_3x3, outputTileSize, inputTileSize,
-        loc, rewriter);
+        constants->AT, outputTileSize, inputTileSize, loc, rewriter);
     Value A = IREE::LinalgExt::createValueFrom2DConstant(
-        IREE::LinalgExt::Winograd::A_6x6_3x3, inputTileSize, outputTileSize,
-        loc, rewriter);
+        constants->A, inputTileSize, outputTileSize, loc, rewriter);
     Value zeroF32 = rewriter.create<arith::ConstantOp>(
         loc, rewriter.getZeroAttr(elementType));
     SmallVector<int64_t> scratchShape = {inputTileSize, outputTileSize};
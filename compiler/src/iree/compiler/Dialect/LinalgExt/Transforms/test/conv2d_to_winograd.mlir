@@ -1,5 +1,6 @@
 // RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-linalg-ext-convert-conv2d-to-winograd{replace-all-convs}))" -mlir-elide-elementsattrs-if-larger=4 %s | FileCheck %s --check-prefixes=CHECK-ALL,CHECK
 // RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-linalg-ext-convert-conv2d-to-winograd))" -mlir-elide-elementsattrs-if-larger=4 %s | FileCheck %s --check-prefixes=CHECK-ALL,CHECK-ANNOTATED
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-linalg-ext-convert-conv2d-to-winograd{replace-all-convs output-tile-size=4}))" -mlir-elide-elementsattrs-if-larger=4 %s | FileCheck %s --check-prefix=CHECK-F4
 
 util.func public @conv_16433136(%arg0: tensor<1x16x16x4xf32>, %arg1: tensor<3x3x4x16xf32>, %arg2: tensor<1x14x14x16xf32>) -> tensor<1x14x14x16xf32> {
   %0 = linalg.conv_2d_nhwc_hwcf
@@ -43,6 +44,17 @@ util.func public @conv_16433136(%arg0: tensor<1x16x16x4xf32>, %arg1: tensor<3x3x
 // CHECK:        util.return %[[EXTRACTED_SLICE]] : tensor<1x14x14x16xf32>
 // CHECK:      }
 
+// CHECK-F4-LABEL: util.func public @conv_16433136(
+// CHECK-F4:         iree_linalg_ext.winograd.filter_transform output_tile_size(4) kernel_size(3)
+// CHECK-F4-SAME:      -> tensor<6x6x4x16xf32>
+// CHECK-F4:         iree_linalg_ext.winograd.input_transform output_tile_size(4) kernel_size(3)
+// CHECK-F4-SAME:      -> tensor<6x6x1x4x4x4xf32>
+// CHECK-F4:         linalg.batch_matmul
+// CHECK-F4-SAME:      outs(%{{.+}} : tensor<36x16x16xf32>)
+// CHECK-F4:         iree_linalg_ext.winograd.output_transform output_tile_size(4) kernel_size(3)
+// CHECK-F4-SAME:      -> tensor<1x16x16x16xf32>
+// CHECK-F4:         tensor.extract_slice %{{.+}}[0, 0, 0, 0] [1, 14, 14, 16] [1, 1, 1, 1]
+
 // -----
 
 util.func public @conv_16433136_nchw_fchw(%arg0: tensor<1x4x16x16xf32>, %arg1: tensor<16x4x3x3xf32>, %arg2: tensor<1x16x14x14xf32>) -> tensor<1x16x14x14xf32> {
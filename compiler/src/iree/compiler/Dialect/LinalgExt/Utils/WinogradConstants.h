@@ -7,11 +7,75 @@
 #ifndef IREE_COMPILER_DIALECT_LINALGEXT_UTILS_WINOGRAD_CONSTANTS_H_
 #define IREE_COMPILER_DIALECT_LINALGEXT_UTILS_WINOGRAD_CONSTANTS_H_
 
+#include <cstdint>
+
 namespace mlir::iree_compiler::IREE::LinalgExt::Winograd {
 
 // This file contains the Winograd constant matrices for different
 // output tile sizes
 
+//===----------------------------------------------------------------------===//
+// Output tile size = 4, Kernel size = 3
+//===----------------------------------------------------------------------===//
+// These constants were obtained from this paper:
+//
+// Lavin, A. and Gray, S. (2016) Fast Algorithms for Convolutional Neural
+// Networks. https://arxiv.org/abs/1509.09308
+//
+
+// clang-format off
+
+const float BT_4x4_3x3[] = {
+  4.0f,  0.0f, -5.0f,  0.0f, 1.0f, 0.0f,
+  0.0f, -4.0f, -4.0f,  1.0f, 1.0f, 0.0f,
+  0.0f,  4.0f, -4.0f, -1.0f, 1.0f, 0.0f,
+  0.0f, -2.0f, -1.0f,  2.0f, 1.0f, 0.0f,
+  0.0f,  2.0f, -1.0f, -2.0f, 1.0f, 0.0f,
+  0.0f,  4.0f,  0.0f, -5.0f, 0.0f, 1.0f
+};
+
+const float B_4x4_3x3[] = {
+   4.0f,  0.0f,  0.0f,  0.0f,  0.0f,  0.0f,
+   0.0f, -4.0f,  4.0f, -2.0f,  2.0f,  4.0f,
+  -5.0f, -4.0f, -4.0f, -1.0f, -1.0f,  0.0f,
+   0.0f,  1.0f, -1.0f,  2.0f, -2.0f, -5.0f,
+   1.0f,  1.0f,  1.0f,  1.0f,  1.0f,  0.0f,
+   0.0f,  0.0f,  0.0f,  0.0f,  0.0f,  1.0f
+};
+
+const float GT_4x4_3x3[] = {
+  1.0f/4.0f, -1.0f/6.0f, -1.0f/6.0f, 1.0f/24.0f,  1.0f/24.0f, 0.0f,
+       0.0f, -1.0f/6.0f,  1.0f/6.0f, 1.0f/12.0f, -1.0f/12.0f, 0.0f,
+       0.0f, -1.0f/6.0f, -1.0f/6.0f,  1.0f/6.0f,   1.0f/6.0f, 1.0f
+};
+
+const float G_4x4_3x3[] = {
+   1.0f/4.0f,        0.0f,       0.0f,
+  -1.0f/6.0f,  -1.0f/6.0f, -1.0f/6.0f,
+  -1.0f/6.0f,   1.0f/6.0f, -1.0f/6.0f,
+  1.0f/24.0f,  1.0f/12.0f,  1.0f/6.0f,
+  1.0f/24.0f, -1.0f/12.0f,  1.0f/6.0f,
+        0.0f,        0.0f,       1.0f
+};
+
+const float AT_4x4_3x3[] = {
+  1.0f, 1.0f,  1.0f, 1.0f,  1.0f, 0.0f,
+  0.0f, 1.0f, -1.0f, 2.0f, -2.0f, 0.0f,
+  0.0f, 1.0f,  1.0f, 4.0f,  4.0f, 0.0f,
+  0.0f, 1.0f, -1.0f, 8.0f, -8.0f, 1.0f
+};
+
+const float A_4x4_3x3[] = {
+  1.0f,  0.0f, 0.0f,  0.0f,
+  1.0f,  1.0f, 1.0f,  1.0f,
+  1.0f, -1.0f, 1.0f, -1.0f,
+  1.0f,  2.0f, 4.0f,  8.0f,
+  1.0f, -2.0f, 4.0f, -8.0f,
+  0.0f,  0.0f, 0.0f,  1.0f
+};
+
+// clang-format on
+
 //===----------------------------------------------------------------------===//
 // Output tile size = 6, Kernel size = 3
 //===----------------------------------------------------------------------===//
@@ -84,6 +148,49 @@ const float A_6x6_3x3[] = {
 
 // clang-format on
 
+//===----------------------------------------------------------------------===//
+// Constant lookup
+//===----------------------------------------------------------------------===//
+
+// The transform matrices for one Winograd configuration. Input tiles are
+// (outputTileSize + kernelSize - 1) square.
+struct TransformConstants {
+  const float *BT;
+  const float *B;
+  const float *GT;
+  const float *G;
+  const float *AT;
+  const float *A;
+};
+
+// Returns the transform matrices for F(outputTileSize, kernelSize) or nullptr
+// if the configuration is not supported.
+inline const TransformConstants *getTransformConstants(int64_t outputTileSize,
+                                                       int64_t kernelSize) {
+  static const TransformConstants kF4x4_3x3 = {
+      BT_4x4_3x3, B_4x4_3x3, GT_4x4_3x3, G_4x4_3x3, AT_4x4_3x3, A_4x4_3x3,
+  };
+  static const TransformConstants kF6x6_3x3 = {
+      BT_6x6_3x3, B_6x6_3x3, GT_6x6_3x3, G_6x6_3x3, AT_6x6_3x3, A_6x6_3x3,
+  };
+  if (kernelSize != 3) {
+    return nullptr;
+  }
+  switch (outputTileSize) {
+  case 4:
+    return &kF4x4_3x3;
+  case 6:
+    return &kF6x6_3x3;
+  default:
+    return nullptr;
+  }
+}
+
+// Returns true if F(outputTileSize, 3x3) Winograd transforms are supported.
+inline bool isSupportedOutputTileSize(int64_t outputTileSize) {
+  return getTransformConstants(outputTileSize, /*kernelSize=*/3) != nullptr;
+}
+
 } // namespace mlir::iree_compiler::IREE::LinalgExt::Winograd
 
 #endif // IREE_COMPILER_DIALECT_LINALGEXT_UTILS_WINOGRAD_CONSTANTS_H_
@@ -6,9 +6,11 @@
 
 #include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Debug.h"
 #include "mlir/IR/AsmState.h"
+#include "mlir/IR/Matchers.h"
 #include "mlir/IR/PatternMatch.h"
 
 #define DEBUG_TYPE "iree-stream-partitioning"
@@ -167,16 +169,67 @@ void PartitionSet::topologicalSort() {
 }
 
 PartitionSet partitionStreamableOps(IREE::Stream::PartitioningConfigAttr config,
-                                    Block *block) {
-  // Only one algorithm today.
-  return partitionStreamableOpsReference(config, block);
+                                    Block *block,
+                                    PartitioningAlgorithm algorithm) {
+  switch (algorithm) {
+  case PartitioningAlgorithm::Multilevel:
+    return partitionStreamableOpsMultilevel(config, block);
+  default:
+    return partitionStreamableOpsReference(config, block);
+  }
 }
 
 PartitionSet
 partitionRegionConcurrency(IREE::Stream::PartitioningConfigAttr config,
-                           Block *block) {
-  // Only one algorithm today.
-  return partitionRegionConcurrencyReference(config, block);
+                           Block *block, PartitioningAlgorithm algorithm) {
+  switch (algorithm) {
+  case PartitioningAlgorithm::Multilevel:
+    return partitionRegionConcurrencyMultilevel(config, block);
+  default:
+    return partitionRegionConcurrencyReference(config, block);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+
+// Caps estimates so that sums over large graphs cannot overflow.
+static constexpr int64_t kMaxPartitioningCost = 1ll << 40;
+
+int64_t estimatePartitioningValueSize(Value value) {
+  if (!isa<IREE::Stream::ResourceType>(value.getType()))
+    return 1;
+  Block *block = value.getParentBlock();
+  Value sizeValue = IREE::Util::SizeAwareTypeInterface::findSizeValue(
+      value, block, block->end());
+  APInt size;
+  if (!sizeValue || !matchPattern(sizeValue, m_ConstantInt(&size)))
+    return 1;
+  return std::clamp<int64_t>(size.getSExtValue(), 1, kMaxPartitioningCost);
+}
+
+int64_t estimatePartitioningOpCost(Operation *op) {
+  if (auto dispatchOp = dyn_cast<IREE::Stream::AsyncDispatchOp>(op)) {
+    // Dispatches are weighed by their total workload (usually the number of
+    // elements produced). Dynamic dimensions are treated as unit size.
+    int64_t cost = 1;
+    for (auto workload : dispatchOp.getWorkload()) {
+      APInt dim;
+      if (matchPattern(workload, m_ConstantInt(&dim)) &&
+          dim.getSExtValue() > 0) {
+        cost = std::min(cost * dim.getSExtValue(), kMaxPartitioningCost);
+      }
+    }
+    return cost;
+  }
+  // Other streamable ops are dominated by the data they move.
+  int64_t cost = 1;
+  for (auto result : op->getResults()) {
+    cost = std::min(cost + estimatePartitioningValueSize(result),
+                    kMaxPartitioningCost);
+  }
+  return cost;
 }
 
 } // namespace mlir::iree_compiler::IREE::Stream
@@ -99,15 +99,40 @@ struct PartitionSet {
 //   https://tel.archives-ouvertes.fr/tel-01956979/document
 //
 
+// Selects the algorithm used by partitionStreamableOps and
+// partitionRegionConcurrency.
+enum class PartitioningAlgorithm {
+  // Greedy correctness-only clustering. See partitionStreamableOpsReference.
+  Reference = 0,
+  // Cost-driven multilevel refinement. See partitionStreamableOpsMultilevel.
+  Multilevel = 1,
+};
+
 // Partitions the ops in |block| such that all streamable ops are in one or more
 // partitions (with >1 implying duplication). Partitions may contain
 // non-streamable ops if it is safe to do so (such as std arithmetic). Not all
 // ops in the block will be covered by a partition.
-PartitionSet partitionStreamableOps(IREE::Stream::PartitioningConfigAttr config,
-                                    Block *block);
-PartitionSet
-partitionRegionConcurrency(IREE::Stream::PartitioningConfigAttr config,
-                           Block *block);
+PartitionSet partitionStreamableOps(
+    IREE::Stream::PartitioningConfigAttr config, Block *block,
+    PartitioningAlgorithm algorithm = PartitioningAlgorithm::Reference);
+PartitionSet partitionRegionConcurrency(
+    IREE::Stream::PartitioningConfigAttr config, Block *block,
+    PartitioningAlgorithm algorithm = PartitioningAlgorithm::Reference);
+
+//===----------------------------------------------------------------------===//
+// Cost model
+//===----------------------------------------------------------------------===//
+//
+// Target-independent estimates used to weigh partitioning decisions. Costs are
+// relative and only meaningful when compared against each other: dispatches
+// are weighed by their static workload and data movement by the number of
+// bytes moved. Unknown quantities are treated as unit cost.
+
+// Returns the estimated relative execution cost of |op|.
+int64_t estimatePartitioningOpCost(Operation *op);
+
+// Returns the estimated size in bytes of the resource |value| or 1 if unknown.
+int64_t estimatePartitioningValueSize(Value value);
 
 //===----------------------------------------------------------------------===//
 // Reference partitioning
@@ -121,9 +146,33 @@ partitionStreamableOpsReference(IREE::Stream::PartitioningConfigAttr config,
 
 // Similarly poor algorithm to partitionStreamableOpsReference but for use
 // within partitioned streams to produce waves of concurrently executable work.
+// When |balanceCost| is set each op is placed into the legal wave with the
+// lowest estimated cost instead of the first/last as selected by the favor.
 PartitionSet
 partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
-                                    Block *block);
+                                    Block *block, bool balanceCost = false);
+
+//===----------------------------------------------------------------------===//
+// Multilevel partitioning
+//===----------------------------------------------------------------------===//
+
+// Multilevel acyclic partitioning in the style of dagP: the reference
+// partitioning is used as the initial (finest legal) partitioning and is then
+// coarsened one level at a time by contracting the heaviest edge of the
+// partition graph (the pair of partitions exchanging the most bytes). Edges are
+// only contracted when doing so keeps the partition graph acyclic, the
+// affinities compatible, and does not move work across side-effecting host
+// ops. Once no edges remain the lightest independent partitions are merged so
+// that the remaining submissions are as few and as evenly sized as possible.
+PartitionSet
+partitionStreamableOpsMultilevel(IREE::Stream::PartitioningConfigAttr config,
+                                 Block *block);
+
+// Forms waves as with partitionRegionConcurrencyReference but balances the
+// estimated cost of the work across the waves each op may legally join.
+PartitionSet
+partitionRegionConcurrencyMultilevel(IREE::Stream::PartitioningConfigAttr config,
+                                     Block *block);
 
 } // namespace mlir::iree_compiler::IREE::Stream
 
@@ -0,0 +1,368 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Interfaces/SideEffectInterfaces.h"
+
+#define DEBUG_TYPE "iree-stream-partitioning"
+
+namespace mlir::iree_compiler::IREE::Stream {
+
+namespace {
+
+// A node in the partition graph. Nodes start as the partitions produced by the
+// reference algorithm and are contracted into each other as levels coarsen.
+struct PartitionNode {
+  // False once the node has been contracted into another.
+  bool live = true;
+  // Affinity compatible with all ops in the node.
+  IREE::Stream::AffinityAttr affinity;
+  // All ops covered by the node in block order of their original partitions.
+  SetVector<Operation *> ops;
+  // Index of the span of the block between side-effecting host ops that all
+  // ops of the node lie in. Work is never moved across such ops.
+  int epoch = -1;
+  // Total estimated cost of all ops in the node.
+  int64_t cost = 0;
+};
+
+// Dependencies between the live nodes of the partition graph.
+struct PartitionEdges {
+  // Nodes producing values directly consumed by each node.
+  SmallVector<llvm::BitVector> directPreds;
+  // Nodes each node depends on through ops that are not in any node.
+  SmallVector<llvm::BitVector> indirectPreds;
+  // All nodes each node transitively depends on.
+  SmallVector<llvm::BitVector> ancestors;
+  // Estimated bytes flowing from node i into node j, keyed by (i, j).
+  DenseMap<std::pair<unsigned, unsigned>, int64_t> weights;
+};
+
+class PartitionGraph {
+public:
+  PartitionGraph(Block *block, PartitionSet &partitionSet) : block(block) {
+    computeEpochs();
+    nodes.resize(partitionSet.size());
+    for (auto [node, partition] :
+         llvm::zip_equal(nodes, partitionSet.partitions)) {
+      node.affinity = partition.affinity;
+      node.ops = partition.ops;
+      node.epoch = -1;
+      for (auto *op : node.ops) {
+        int opEpoch = opEpochs.lookup(op);
+        if (node.epoch == -1) {
+          node.epoch = opEpoch;
+        } else if (node.epoch != opEpoch) {
+          node.epoch = -2; // spans a host op; never merged
+        }
+        node.cost += estimatePartitioningOpCost(op);
+      }
+    }
+  }
+
+  // Contracts the pair of adjacent nodes exchanging the most data that can be
+  // legally merged. Returns false if no such pair exists.
+  bool contractHeaviestEdge() {
+    auto edges = computeEdges();
+    int64_t bestWeight = 0;
+    std::optional<std::pair<unsigned, unsigned>> bestPair;
+    for (auto [pair, weight] : edges.weights) {
+      if (weight <= bestWeight || !canMerge(edges, pair.first, pair.second)) {
+        continue;
+      }
+      bestWeight = weight;
+      bestPair = pair;
+    }
+    if (!bestPair)
+      return false;
+    LLVM_DEBUG(llvm::dbgs() << "Contracting edge " << bestPair->first << " -> "
+                            << bestPair->second << " (" << bestWeight
+                            << " bytes)\n");
+    merge(bestPair->first, bestPair->second);
+    return true;
+  }
+
+  // Merges the two lightest independent nodes that can be legally merged.
+  // Returns false if no such pair exists.
+  bool mergeLightestIndependent() {
+    auto edges = computeEdges();
+    int64_t bestCost = INT64_MAX;
+    std::optional<std::pair<unsigned, unsigned>> bestPair;
+    for (unsigned i = 0; i < nodes.size(); ++i) {
+      if (!nodes[i].live)
+        continue;
+      for (unsigned j = i + 1; j < nodes.size(); ++j) {
+        if (!nodes[j].live || edges.ancestors[i].test(j) ||
+            edges.ancestors[j].test(i)) {
+          continue;
+        }
+        int64_t cost = nodes[i].cost + nodes[j].cost;
+        if (cost >= bestCost || !canMerge(edges, i, j))
+          continue;
+        bestCost = cost;
+        bestPair = std::make_pair(i, j);
+      }
+    }
+    if (!bestPair)
+      return false;
+    LLVM_DEBUG(llvm::dbgs() << "Merging independent " << bestPair->first
+                            << " and " << bestPair->second << " (cost "
+                            << bestCost << ")\n");
+    merge(bestPair->first, bestPair->second);
+    return true;
+  }
+
+  // Returns the partition set covering all live nodes.
+  PartitionSet buildPartitionSet() {
+    // Ops cloned into multiple nodes only escape to users outside of any
+    // partition and only from the first node containing them.
+    DenseMap<Operation *, unsigned> opMemberships;
+    for (auto &node : nodes) {
+      for (auto *op : node.ops) {
+        ++opMemberships[op];
+      }
+    }
+    DenseSet<Operation *> clonedEscapingOps;
+
+    PartitionSet partitionSet;
+    for (auto &node : nodes) {
+      if (!node.live)
+        continue;
+      Partition partition;
+      partition.affinity = node.affinity;
+      SetVector<Value> producedValues;
+      for (auto *op : node.ops) {
+        for (auto operand : op->getOperands()) {
+          partition.ins.insert(operand);
+        }
+        bool isCloned = opMemberships.lookup(op) > 1;
+        if (isCloned && clonedEscapingOps.contains(op)) {
+          producedValues.insert(op->result_begin(), op->result_end());
+          continue;
+        }
+        for (auto result : op->getResults()) {
+          producedValues.insert(result);
+          for (auto *user : result.getUsers()) {
+            bool escapes =
+                isCloned ? !isa<IREE::Stream::StreamableOpInterface>(user)
+                         : !node.ops.contains(user);
+            if (escapes) {
+              partition.outs.insert(result);
+              if (isCloned)
+                clonedEscapingOps.insert(op);
+              break;
+            }
+          }
+        }
+      }
+      partition.ins.set_subtract(producedValues);
+      partition.ops = std::move(node.ops);
+      partitionSet.partitions.push_back(std::move(partition));
+    }
+    partitionSet.topologicalSort();
+    return partitionSet;
+  }
+
+private:
+  // Assigns each op in the block the index of the span between side-effecting
+  // host ops it lies in. This mirrors the flushes of the reference algorithm.
+  void computeEpochs() {
+    int epoch = 0;
+    for (auto &op : *block) {
+      opEpochs[&op] = epoch;
+      if (op.hasTrait<OpTrait::ConstantLike>() ||
+          isa<IREE::Util::GlobalStoreOpInterface>(op) ||
+          isa<IREE::Stream::StreamableOpInterface>(op)) {
+        continue;
+      }
+      if (!mlir::wouldOpBeTriviallyDead(&op)) {
+        ++epoch;
+      }
+    }
+  }
+
+  PartitionEdges computeEdges() {
+    unsigned nodeCount = nodes.size();
+    PartitionEdges edges;
+    edges.directPreds.resize(nodeCount, llvm::BitVector(nodeCount));
+    edges.indirectPreds.resize(nodeCount, llvm::BitVector(nodeCount));
+    edges.ancestors.resize(nodeCount, llvm::BitVector(nodeCount));
+
+    DenseMap<Operation *, unsigned> opNodes;
+    for (auto [ordinal, node] : llvm::enumerate(nodes)) {
+      if (!node.live)
+        continue;
+      for (auto *op : node.ops) {
+        opNodes.try_emplace(op, ordinal);
+      }
+    }
+
+    // Walk the block in order to find which nodes each value transitively
+    // depends on when produced by an op outside of any node.
+    DenseMap<Value, llvm::BitVector> valueDeps;
+    auto getValueDeps = [&](Value value) -> llvm::BitVector {
+      auto it = opNodes.find(value.getDefiningOp());
+      if (it != opNodes.end()) {
+        llvm::BitVector deps(nodeCount);
+        deps.set(it->second);
+        return deps;
+      }
+      auto depIt = valueDeps.find(value);
+      return depIt != valueDeps.end() ? depIt->second
+                                      : llvm::BitVector(nodeCount);
+    };
+    for (auto &op : *block) {
+      auto nodeIt = opNodes.find(&op);
+      if (nodeIt != opNodes.end()) {
+        unsigned ordinal = nodeIt->second;
+        for (auto operand : op.getOperands()) {
+          auto *definingOp = operand.getDefiningOp();
+          if (nodes[ordinal].ops.contains(definingOp))
+            continue; // produced locally (possibly by a clone)
+          auto producerIt = opNodes.find(definingOp);
+          if (producerIt != opNodes.end()) {
+            edges.directPreds[ordinal].set(producerIt->second);
+            edges.weights[{producerIt->second, ordinal}] +=
+                estimatePartitioningValueSize(operand);
+          } else {
+            edges.indirectPreds[ordinal] |= getValueDeps(operand);
+          }
+        }
+        continue;
+      }
+      // Values used anywhere within the op (including nested regions) are
+      // required before any of its results are available.
+      llvm::BitVector deps(nodeCount);
+      op.walk([&](Operation *nestedOp) {
+        for (auto operand : nestedOp->getOperands()) {
+          deps |= getValueDeps(operand);
+        }
+      });
+      for (auto result : op.getResults()) {
+        valueDeps[result] = deps;
+      }
+    }
+
+    // Contraction may leave predecessors with higher ordinals than their
+    // successors so ancestors are computed depth-first. The graph is acyclic.
+    llvm::BitVector visited(nodeCount);
+    std::function<void(unsigned)> computeAncestors = [&](unsigned i) {
+      if (visited.test(i))
+        return;
+      visited.set(i);
+      llvm::BitVector preds = edges.directPreds[i];
+      preds |= edges.indirectPreds[i];
+      edges.ancestors[i] |= preds;
+      for (auto pred : preds.set_bits()) {
+        computeAncestors(pred);
+        edges.ancestors[i] |= edges.ancestors[pred];
+      }
+    };
+    for (unsigned i = 0; i < nodeCount; ++i) {
+      if (nodes[i].live)
+        computeAncestors(i);
+    }
+    return edges;
+  }
+
+  // Returns true if node |a| and node |b| can be merged without creating a
+  // cycle, mixing incompatible affinities, or moving work across host ops.
+  bool canMerge(PartitionEdges &edges, unsigned a, unsigned b) {
+    auto &nodeA = nodes[a];
+    auto &nodeB = nodes[b];
+    if (a == b || !nodeA.live || !nodeB.live)
+      return false;
+    if (nodeA.epoch < 0 || nodeA.epoch != nodeB.epoch)
+      return false;
+    if (!IREE::Stream::AffinityAttr::canExecuteTogether(nodeA.affinity,
+                                                        nodeB.affinity)) {
+      return false;
+    }
+    // Ensure that |from| only reaches |to| directly: any path through another
+    // node or a host op would become a cycle once merged.
+    auto reachesOnlyDirectly = [&](unsigned from, unsigned to) {
+      if (edges.indirectPreds[to].test(from))
+        return false;
+      for (auto pred : edges.directPreds[to].set_bits()) {
+        if (pred != from && edges.ancestors[pred].test(from))
+          return false;
+      }
+      for (auto pred : edges.indirectPreds[to].set_bits()) {
+        if (edges.ancestors[pred].test(from))
+          return false;
+      }
+      return true;
+    };
+    if (edges.ancestors[b].test(a))
+      return reachesOnlyDirectly(a, b);
+    if (edges.ancestors[a].test(b))
+      return reachesOnlyDirectly(b, a);
+    return true;
+  }
+
+  // Merges node |b| into node |a|, keeping whichever ordinal is lower so that
+  // ordinals remain topologically ordered.
+  void merge(unsigned a, unsigned b) {
+    if (b < a)
+      std::swap(a, b);
+    auto &nodeA = nodes[a];
+    auto &nodeB = nodes[b];
+    nodeA.affinity = nodeA.affinity ? nodeA.affinity.joinAND(nodeB.affinity)
+                                    : nodeB.affinity;
+    nodeA.ops.insert(nodeB.ops.begin(), nodeB.ops.end());
+    nodeA.cost += nodeB.cost;
+    nodeB.live = false;
+    nodeB.ops.clear();
+  }
+
+  Block *block;
+  DenseMap<Operation *, int> opEpochs;
+  SmallVector<PartitionNode> nodes;
+};
+
+} // namespace
+
+PartitionSet
+partitionStreamableOpsMultilevel(IREE::Stream::PartitioningConfigAttr config,
+                                 Block *block) {
+  // The reference partitioning is the finest legal partitioning we start
+  // coarsening from.
+  PartitionSet partitionSet = partitionStreamableOpsReference(config, block);
+  if (partitionSet.size() <= 1 ||
+      config.getFavor().getValue() == IREE::Stream::Favor::Debug) {
+    return partitionSet;
+  }
+
+  // Ensure predecessors have lower ordinals than their successors.
+  partitionSet.topologicalSort();
+  PartitionGraph graph(block, partitionSet);
+
+  // Contract the heaviest edges first: each contraction removes a submission
+  // and keeps the data exchanged between the two partitions inside of a single
+  // execution region where it can be transient.
+  while (graph.contractHeaviestEdge()) {
+  }
+
+  // Merge what independent work remains starting with the lightest partitions
+  // so that the final submissions are balanced.
+  while (graph.mergeLightestIndependent()) {
+  }
+
+  return graph.buildPartitionSet();
+}
+
+PartitionSet
+partitionRegionConcurrencyMultilevel(IREE::Stream::PartitioningConfigAttr config,
+                                     Block *block) {
+  return partitionRegionConcurrencyReference(config, block,
+                                             /*balanceCost=*/true);
+}
+
+} // namespace mlir::iree_compiler::IREE::Stream
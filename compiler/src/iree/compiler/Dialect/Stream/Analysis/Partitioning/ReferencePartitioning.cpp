@@ -6,6 +6,7 @@
 
 #include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 #include "iree/compiler/Dialect/Stream/Analysis/ResourceHazards.h"
+#include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
 #include "llvm/ADT/BitVector.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallPtrSet.h"
@@ -352,7 +353,7 @@ partitionStreamableOpsReference(IREE::Stream::PartitioningConfigAttr config,
 // dividing the block to identify both serial and concurrent regions.
 PartitionSet
 partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
-                                    Block *block) {
+                                    Block *block, bool balanceCost) {
   PartitionSet waveSet;
 
   auto favor = config.getFavor().getValue();
@@ -365,6 +366,11 @@ partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
     unsigned ordinal;
     // Ops present in the wave; ops may be present in multiple waves.
     SetVector<Operation *> ops;
+    // True if any op in the wave is not a collective. Collectives prefer to be
+    // placed into such waves so that communication overlaps with compute.
+    bool hasNonCollectiveOps = false;
+    // Total estimated cost of all ops in the wave (only when balancing).
+    int64_t cost = 0;
   };
   SmallVector<std::unique_ptr<PartitionBuilder>> builders;
 
@@ -502,10 +508,43 @@ partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
     int firstCandidateOrdinal = favor == IREE::Stream::Favor::MaxConcurrency
                                     ? candidates.find_first()
                                     : candidates.find_last();
+
+    // When balancing pick the cheapest of the legal waves so that concurrently
+    // executing work is spread evenly. Ties keep the favored wave.
+    int64_t opCost = balanceCost ? estimatePartitioningOpCost(&op) : 0;
+    if (balanceCost && firstCandidateOrdinal != -1) {
+      for (auto ordinal : candidates.set_bits()) {
+        if (builders[ordinal]->cost < builders[firstCandidateOrdinal]->cost) {
+          firstCandidateOrdinal = ordinal;
+        }
+      }
+    }
+
+    // Collectives are issued on a dedicated communication queue by devices
+    // that support it and can only overlap with work in their own wave. When
+    // favoring concurrency all collectives would otherwise end up grouped in
+    // a wave with no compute to hide their latency behind.
+    bool isCollective = isa<IREE::Stream::AsyncCollectiveOp>(op);
+    if (isCollective) {
+      int overlapOrdinal = -1;
+      for (auto ordinal : candidates.set_bits()) {
+        if (!builders[ordinal]->hasNonCollectiveOps)
+          continue;
+        overlapOrdinal = ordinal;
+        if (favor == IREE::Stream::Favor::MaxConcurrency)
+          break;
+      }
+      if (overlapOrdinal != -1) {
+        firstCandidateOrdinal = overlapOrdinal;
+      }
+    }
+
     if (firstCandidateOrdinal != -1) {
       LLVM_DEBUG(llvm::dbgs() << "Moving to last candidate wave "
                               << firstCandidateOrdinal << " (continue)\n");
       builders[firstCandidateOrdinal]->ops.insert(&op);
+      builders[firstCandidateOrdinal]->hasNonCollectiveOps |= !isCollective;
+      builders[firstCandidateOrdinal]->cost += opCost;
       opInfo.membership.set(firstCandidateOrdinal);
       opInfo.hazards.set(0, firstCandidateOrdinal);
       opInfo.hazards.reset(firstCandidateOrdinal);
@@ -520,6 +559,8 @@ partitionRegionConcurrencyReference(IREE::Stream::PartitioningConfigAttr config,
     auto builder = std::make_unique<PartitionBuilder>();
     builder->ordinal = builders.size();
     builder->ops.insert(&op);
+    builder->hasNonCollectiveOps = !isCollective;
+    builder->cost = opCost;
     LLVM_DEBUG(llvm::dbgs() << "Created wave " << builder->ordinal << "\n");
     builders.push_back(std::move(builder));
   }
@@ -57,6 +57,9 @@ struct UsageInfo {
   // stream.timepoint.await ops indicating host/device synchronization.
   SmallVector<IREE::Stream::TimepointAwaitOp> awaitOps;
 
+  // Public functions that may be invoked by applications.
+  SmallVector<mlir::FunctionOpInterface> publicFuncOps;
+
   void analyze(mlir::ModuleOp moduleOp) {
     SymbolTable symbolTable(moduleOp);
     for (auto globalOp : moduleOp.getOps<IREE::Util::GlobalOp>()) {
@@ -68,6 +71,10 @@ struct UsageInfo {
       executableOps[executableOp.getName()] = executableOp;
     }
     for (auto funcOp : moduleOp.getOps<mlir::FunctionOpInterface>()) {
+      if (!isa<IREE::Util::InitializerOpInterface>(*funcOp) &&
+          funcOp.isPublic() && !funcOp.isExternal()) {
+        publicFuncOps.push_back(funcOp);
+      }
       funcOp.walk([&](Operation *op) {
         TypeSwitch<Operation *>(op)
             .Case<IREE::Util::BufferConstantOp>(
@@ -95,6 +102,50 @@ struct UsageInfo {
   }
 };
 
+// Static estimate of the transient memory live at once during an invocation.
+struct TransientPeak {
+  int64_t size = 0;
+  // True if there were allocations of dynamic size that were not included.
+  bool sizeDynamic = false;
+};
+
+// Estimates the peak transient memory of a single invocation of |funcOp| by
+// walking its allocations and deallocations in program order. Control flow is
+// not modeled (all paths are treated as one sequence) and allocations made by
+// callees are not included.
+static TransientPeak estimateTransientPeak(mlir::FunctionOpInterface funcOp) {
+  TransientPeak peak;
+  DenseMap<Value, int64_t> liveAllocaSizes;
+  int64_t liveSize = 0;
+  funcOp.walk([&](Operation *op) {
+    if (auto allocaOp = dyn_cast<IREE::Stream::ResourceAllocaOp>(op)) {
+      APInt allocaSize;
+      if (!matchPattern(allocaOp.getStorageSize(),
+                        m_ConstantInt(&allocaSize))) {
+        peak.sizeDynamic = true;
+        return;
+      }
+      liveAllocaSizes[allocaOp.getResult()] = allocaSize.getSExtValue();
+      liveSize += allocaSize.getSExtValue();
+      peak.size = std::max(peak.size, liveSize);
+    } else if (auto deallocaOp =
+                   dyn_cast<IREE::Stream::ResourceDeallocaOp>(op)) {
+      auto it = liveAllocaSizes.find(deallocaOp.getOperand());
+      if (it != liveAllocaSizes.end()) {
+        liveSize -= it->second;
+        liveAllocaSizes.erase(it);
+        return;
+      }
+      APInt deallocaSize;
+      if (matchPattern(deallocaOp.getOperandSize(),
+                       m_ConstantInt(&deallocaSize))) {
+        liveSize = std::max<int64_t>(0, liveSize - deallocaSize.getSExtValue());
+      }
+    }
+  });
+  return peak;
+}
+
 // TODO(benvanik): StaticSize helper or something for the dynamic bit.
 struct Statistics {
   // Globals:
@@ -112,6 +163,12 @@ struct Statistics {
   size_t submissionCount = 0;
   int64_t transientSize = 0;
   bool transientSizeDynamic = false;
+  // Sum of the packing lower bounds of static allocations (or their actual
+  // size when no bound was recorded).
+  int64_t transientLowerBound = 0;
+  // Largest estimated transient peak of any single public function invocation.
+  int64_t transientPeak = 0;
+  bool transientPeakDynamic = false;
   // TODO(benvanik): add fill/copy sizes (when possible).
   size_t fillCount = 0;
   size_t copyCount = 0;
@@ -157,10 +214,19 @@ struct Statistics {
       APInt allocaSize;
       if (matchPattern(allocaOp.getStorageSize(), m_ConstantInt(&allocaSize))) {
         transientSize += allocaSize.getSExtValue();
+        auto lowerBoundAttr =
+            allocaOp->getAttrOfType<IntegerAttr>("stream.packing_lower_bound");
+        transientLowerBound += lowerBoundAttr ? lowerBoundAttr.getInt()
+                                              : allocaSize.getSExtValue();
       } else {
         transientSizeDynamic = true;
       }
     }
+    for (auto funcOp : usageInfo.publicFuncOps) {
+      auto peak = estimateTransientPeak(funcOp);
+      transientPeak = std::max(transientPeak, peak.size);
+      transientPeakDynamic |= peak.sizeDynamic;
+    }
     for (auto executeOp : usageInfo.executeOps) {
       executeOp.walk([&](Operation *op) {
         TypeSwitch<Operation *>(op)
@@ -243,6 +309,13 @@ static void prettyPrintStatistics(const UsageInfo &usageInfo,
   os << llvm::formatv(
       "{0}{1} B ({2:F2} MiB)\n", stats.transientSizeDynamic ? "minimum " : "",
       stats.transientSize, stats.transientSize / (1 * 1024 * 1024.0f));
+  os << llvm::formatv("//              lower bound {0} B ({1:F2} MiB)\n",
+                      stats.transientLowerBound,
+                      stats.transientLowerBound / (1 * 1024 * 1024.0f));
+  os << llvm::formatv(
+      "//              peak per invocation {0}{1} B ({2:F2} MiB)\n",
+      stats.transientPeakDynamic ? "minimum " : "", stats.transientPeak,
+      stats.transientPeak / (1 * 1024 * 1024.0f));
 
   os << llvm::formatv("//   DMA Fills: {0}\n", stats.fillCount);
   os << llvm::formatv("//  DMA Copies: {0}\n", stats.copyCount);
@@ -273,6 +346,19 @@ static void prettyPrintGlobalInfo(const UsageInfo &usageInfo, bool verbose,
   os << "//\n";
 }
 
+static void prettyPrintTransientInfo(const UsageInfo &usageInfo, bool verbose,
+                                     llvm::raw_fd_ostream &os) {
+  prettyPrintSectionHeader("Transient Memory (static, per-invocation)", os);
+  os << "//\n";
+  for (auto funcOp : usageInfo.publicFuncOps) {
+    auto peak = estimateTransientPeak(funcOp);
+    os << llvm::formatv("// @{0}: peak {1}{2} B ({3:F2} MiB)\n",
+                        funcOp.getName(), peak.sizeDynamic ? "minimum " : "",
+                        peak.size, peak.size / (1 * 1024 * 1024.0f));
+  }
+  os << "//\n";
+}
+
 static void prettyPrintSyncInfo(const UsageInfo &usageInfo, bool verbose,
                                 llvm::raw_fd_ostream &os) {
   prettyPrintSectionHeader("Synchronization", os);
@@ -388,6 +474,7 @@ static void prettyPrintUsageInfo(const UsageInfo &usageInfo, bool verbose,
                                  llvm::raw_fd_ostream &os) {
   prettyPrintStatistics(usageInfo, os);
   prettyPrintGlobalInfo(usageInfo, verbose, os);
+  prettyPrintTransientInfo(usageInfo, verbose, os);
   prettyPrintSyncInfo(usageInfo, verbose, os);
   prettyPrintAllStreamInfo(usageInfo, verbose, os);
   prettyPrintAllExecutableInfo(usageInfo, verbose, os);
@@ -402,7 +489,7 @@ static void dumpAggregateCSVTable(const UsageInfo &usageInfo,
   Statistics stats;
   stats.analyze(usageInfo);
 
-  os << R"("Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Async Calls","Executables")";
+  os << R"("Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Transient Lower Bound","Transient Peak","Fills","Copies","Dispatches","Async Calls","Executables")";
   os << "\n";
 
   // Globals:
@@ -414,9 +501,11 @@ static void dumpAggregateCSVTable(const UsageInfo &usageInfo,
   os << llvm::formatv("{0},", stats.awaitCount);
 
   // Execution:
-  os << llvm::formatv("{0},{1},{2},{3},{4},{5},", stats.submissionCount,
-                      stats.transientSize, stats.fillCount, stats.copyCount,
-                      stats.dispatchCount, stats.callCount);
+  os << llvm::formatv("{0},{1},{2},{3},{4},{5},{6},{7},",
+                      stats.submissionCount, stats.transientSize,
+                      stats.transientLowerBound, stats.transientPeak,
+                      stats.fillCount, stats.copyCount, stats.dispatchCount,
+                      stats.callCount);
 
   // Executables:
   os << llvm::formatv("{0}", stats.executableCount);
@@ -537,6 +626,9 @@ static void dumpAggregateJSONStructure(const UsageInfo &usageInfo,
   os << "  \"execution\": {\n";
   os << llvm::formatv(kvPair, "submission-count", stats.submissionCount);
   os << llvm::formatv(kvPair, "transient-memory-size", stats.transientSize);
+  os << llvm::formatv(kvPair, "transient-memory-lower-bound",
+                      stats.transientLowerBound);
+  os << llvm::formatv(kvPair, "transient-memory-peak", stats.transientPeak);
   os << llvm::formatv(kvPair, "fill-count", stats.fillCount);
   os << llvm::formatv(kvPair, "copy-count", stats.copyCount);
   os << llvm::formatv(kvPair, "dispatch-count", stats.dispatchCount);
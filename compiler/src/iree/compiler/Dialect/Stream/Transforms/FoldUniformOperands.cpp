@@ -252,6 +252,169 @@ inlineUniformConstants(mlir::FunctionOpInterface funcOp,
       [&](BlockArgument arg) { return deadArgMap.test(arg.getArgNumber()); });
 }
 
+// Returns the bit width used to track offsets of values of |type|.
+static unsigned getOffsetBitWidth(Type type) {
+  return type.isIndex() ? IndexType::kInternalStorageBitWidth
+                        : type.getIntOrFloatBitWidth();
+}
+
+// Decomposes |value| into a root value plus a constant offset by walking
+// through constant additions/subtractions and truncating casts. The root is
+// null if the value is itself a constant. As truncation distributes over
+// addition |value| is equal to root + offset modulo its bit width.
+static std::pair<Value, APInt> decomposeOffsetValue(Value value) {
+  APInt intValue;
+  if (matchPattern(value, m_ConstantInt(&intValue))) {
+    return {nullptr, intValue};
+  }
+  unsigned bitWidth = getOffsetBitWidth(value.getType());
+  auto identity = std::make_pair(value, APInt(bitWidth, 0));
+  Operation *op = value.getDefiningOp();
+  if (!op) {
+    return identity;
+  }
+  if (auto addOp = dyn_cast<arith::AddIOp>(op)) {
+    if (matchPattern(addOp.getRhs(), m_ConstantInt(&intValue))) {
+      auto [root, offset] = decomposeOffsetValue(addOp.getLhs());
+      return {root, offset + intValue};
+    } else if (matchPattern(addOp.getLhs(), m_ConstantInt(&intValue))) {
+      auto [root, offset] = decomposeOffsetValue(addOp.getRhs());
+      return {root, offset + intValue};
+    }
+  } else if (auto subOp = dyn_cast<arith::SubIOp>(op)) {
+    if (matchPattern(subOp.getRhs(), m_ConstantInt(&intValue))) {
+      auto [root, offset] = decomposeOffsetValue(subOp.getLhs());
+      return {root, offset - intValue};
+    }
+  } else if (isa<arith::IndexCastOp, arith::IndexCastUIOp, arith::TruncIOp>(
+                 op)) {
+    Value source = op->getOperand(0);
+    if (getOffsetBitWidth(source.getType()) >= bitWidth) {
+      auto [root, offset] = decomposeOffsetValue(source);
+      return {root, offset.trunc(bitWidth)};
+    }
+  }
+  return identity;
+}
+
+// Derives operands that are a uniform constant offset from another operand at
+// all dispatch sites from that operand within the executable. These are
+// commonly resource offsets sharing a base and dimensions related by a fixed
+// amount.
+//
+// Example:
+//   stream.cmd.dispatch @foo(%a, %a + 256 : index, index)
+//   stream.cmd.dispatch @foo(%b, %b + 256 : index, index)
+// ->
+//   stream.cmd.dispatch @foo(%a : index)
+//   stream.cmd.dispatch @foo(%b : index)
+// + %arg1 = %arg0 + 256 in the executable
+static void
+deriveOffsetOperands(mlir::FunctionOpInterface funcOp,
+                     SmallVector<IREE::Stream::CmdDispatchOp> &dispatchOps) {
+  auto &entryBlock = funcOp.front();
+  auto anyDispatchOp = dispatchOps.front();
+  auto operandTypes =
+      llvm::to_vector(anyDispatchOp.getUniformOperands().getTypes());
+  unsigned operandCount = operandTypes.size();
+
+  // Decompose each operand at each dispatch site into a root and offset.
+  SmallVector<SmallVector<std::pair<Value, APInt>>> siteOffsets;
+  for (auto dispatchOp : dispatchOps) {
+    auto &offsets = siteOffsets.emplace_back();
+    for (auto [value, type] :
+         llvm::zip_equal(dispatchOp.getUniformOperands(), operandTypes)) {
+      offsets.push_back(type.isIntOrIndex()
+                            ? decomposeOffsetValue(value)
+                            : std::make_pair(value, APInt()));
+    }
+  }
+
+  // Find for each operand the first underived operand of the same type that it
+  // is offset from by the same amount at all sites.
+  SmallVector<std::pair<unsigned, APInt>> derivations(operandCount);
+  llvm::BitVector derivedOperandMap(operandCount);
+  for (unsigned idx = 0; idx < operandCount; ++idx) {
+    if (!operandTypes[idx].isIntOrIndex())
+      continue;
+    for (unsigned baseIdx = 0; baseIdx < idx; ++baseIdx) {
+      if (derivedOperandMap.test(baseIdx) ||
+          operandTypes[baseIdx] != operandTypes[idx]) {
+        continue;
+      }
+      std::optional<APInt> uniformDelta;
+      for (auto &offsets : siteOffsets) {
+        auto &[baseRoot, baseOffset] = offsets[baseIdx];
+        auto &[root, offset] = offsets[idx];
+        if (root != baseRoot) {
+          uniformDelta.reset();
+          break;
+        }
+        APInt delta = offset - baseOffset;
+        if (uniformDelta.has_value() && uniformDelta.value() != delta) {
+          uniformDelta.reset();
+          break;
+        }
+        uniformDelta = delta;
+      }
+      if (uniformDelta.has_value()) {
+        derivations[idx] = {baseIdx, uniformDelta.value()};
+        derivedOperandMap.set(idx);
+        break;
+      }
+    }
+  }
+  if (derivedOperandMap.none()) {
+    // No-op.
+    return;
+  }
+
+  LLVM_DEBUG({
+    llvm::dbgs() << "deriveOffsetOperands for " << funcOp.getName() << "\n";
+    for (auto idx : derivedOperandMap.set_bits()) {
+      llvm::dbgs() << "  operand " << idx << " = operand "
+                   << derivations[idx].first << " + "
+                   << derivations[idx].second << "\n";
+    }
+  });
+
+  auto operandToArgMap =
+      IREE::Stream::CmdDispatchOp::makeOperandToArgMap(funcOp);
+
+  // Replace uses of the derived arguments with the offset base arguments.
+  llvm::BitVector deadArgMap(funcOp.getNumArguments());
+  auto builder = OpBuilder::atBlockBegin(&entryBlock);
+  for (auto idx : derivedOperandMap.set_bits()) {
+    auto &[baseIdx, delta] = derivations[idx];
+    unsigned argIdx = operandToArgMap[idx];
+    auto arg = entryBlock.getArgument(argIdx);
+    deadArgMap.set(argIdx);
+    Value derivedValue = entryBlock.getArgument(operandToArgMap[baseIdx]);
+    if (!delta.isZero()) {
+      auto deltaOp = builder.create<arith::ConstantOp>(
+          arg.getLoc(), builder.getIntegerAttr(arg.getType(), delta));
+      derivedValue =
+          builder.create<arith::AddIOp>(arg.getLoc(), derivedValue, deltaOp);
+    }
+    arg.replaceAllUsesWith(derivedValue);
+  }
+
+  // Update each dispatch site to remove the derived operands.
+  SmallVector<unsigned> deadOperands;
+  for (auto idx : derivedOperandMap.set_bits())
+    deadOperands.push_back(idx);
+  for (auto dispatchOp : dispatchOps) {
+    for (auto idx : llvm::reverse(deadOperands)) {
+      dispatchOp.getUniformOperandsMutable().erase(idx);
+    }
+  }
+
+  // Fixup function signature.
+  funcOp.setType(funcOp.getTypeWithoutArgsAndResults(deadArgMap, {}));
+  entryBlock.eraseArguments(
+      [&](BlockArgument arg) { return deadArgMap.test(arg.getArgNumber()); });
+}
+
 //===----------------------------------------------------------------------===//
 // --iree-stream-specialize-dispatches
 //===----------------------------------------------------------------------===//
@@ -293,6 +456,10 @@ struct FoldUniformOperandsPass
 
         // Inline constants that have the same value at all sites.
         inlineUniformConstants(funcOp, dispatchOps);
+
+        // Derive operands that are a fixed offset from another operand at all
+        // sites. Runs last so that the remaining operands are all varying.
+        deriveOffsetOperands(funcOp, dispatchOps);
       }
     }
   }
@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include <list>
+#include <numeric>
 
 #include "iree/compiler/Dialect/Stream/IR/StreamDialect.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
@@ -34,32 +35,39 @@ namespace {
 
 using Slice = IREE::Stream::ResourcePackOp::Slice;
 
-// Packs a set of statically-sized slices by greedy strip packing.
+// Returns the static byte size of |slice| aligned to |rangeAlignment|.
+static int64_t getAlignedStaticSize(const Slice &slice,
+                                    int64_t rangeAlignment) {
+  int64_t staticSize =
+      cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
+  return IREE::Util::align(staticSize, rangeAlignment);
+}
+
+// Static placement of a set of slices produced by one of the strategies below.
+struct StaticPlan {
+  // Offset of each slice relative to the pack base in slice order.
+  SmallVector<int64_t> offsets;
+  // Total number of bytes covered by all reservations (unaligned).
+  int64_t highwaterMark = 0;
+};
+
+// Plans a set of statically-sized slices by greedy strip packing, placing
+// each slice in the smallest gap that fits among the previously placed slices
+// with overlapping lifetimes. Slices are placed in the order given by |order|.
 //
 // This is the same algorithm used in tflite here:
 // https://github.com/tensorflow/tensorflow/blob/master/tensorflow/lite/simple_memory_arena.cc
-// It's not fantastic and can end up with a significant amount of wastage.
-// They do the packing at runtime and as such care more about performance than
-// we do while doing the packing here offline. For this initial version I
-// wanted to ensure we matched apples/apples their implementation.
+// It's not fantastic and can end up with a significant amount of wastage
+// depending on the placement order - see SlicePackingStrategy.
 //
-// We should use a set of heuristics and pick the smallest one. There are also
-// some really great papers that have approximations (as all of these are -
-// 2D strip packing is NP-hard) such as
+// There are some really great papers that have approximations (as all of these
+// are - 2D strip packing is NP-hard) such as
 // https://www.sciencedirect.com/science/article/pii/S0925772113001016 that
 // someone with a brain able to parse mathy papers can try implementing.
-//
-// Slice packed offset SSA values will be updated and start at the given
-// |baseOffset|. Returns |baseOffset| + the total size of the allocation
-// aligned to the requirements of |resourceConfig|.
-static Value
-packStaticSlicesGreedily(IREE::Stream::ResourcePackOp packOp, Value baseOffset,
-                         MutableArrayRef<Slice> slices,
-                         IREE::Stream::ResourceConfigAttr resourceConfig,
-                         IndexSet &indexSet, OpBuilder &builder) {
-  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
-  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
-
+static StaticPlan planStaticSlicesGreedily(ArrayRef<Slice> slices,
+                                           ArrayRef<size_t> order,
+                                           int64_t offsetAlignment,
+                                           int64_t rangeAlignment) {
   struct Reservation {
     const Slice *slice = nullptr;
     int64_t staticOffset = 0;
@@ -67,14 +75,14 @@ packStaticSlicesGreedily(IREE::Stream::ResourcePackOp packOp, Value baseOffset,
   };
   static constexpr int64_t UNASSIGNED = INT64_MAX;
 
+  StaticPlan plan;
+  plan.offsets.resize(slices.size(), 0);
   std::list<Reservation> reservations;
-  int64_t highwaterMark = 0;
-  for (auto &slice : slices) {
+  for (size_t sliceIndex : order) {
+    const Slice &slice = slices[sliceIndex];
     int64_t bestOffset = UNASSIGNED;
     int64_t bestOffsetFit = UNASSIGNED;
-    int64_t staticSize =
-        cast<arith::ConstantIndexOp>(slice.dynamicSize.getDefiningOp()).value();
-    int64_t alignedSize = IREE::Util::align(staticSize, rangeAlignment);
+    int64_t alignedSize = getAlignedStaticSize(slice, rangeAlignment);
 
     // Iterate through reservations (sorted by ascending offset) and identify
     // gaps in which the slice will fit. To reduce wastage we want to find the
@@ -113,15 +121,110 @@ packStaticSlicesGreedily(IREE::Stream::ResourcePackOp packOp, Value baseOffset,
       ++insertionIt;
     }
     reservations.insert(insertionIt, reservation);
-    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
-        packOp.getLoc(), baseOffset, indexSet.get(bestOffset)));
+    plan.offsets[sliceIndex] = bestOffset;
 
     // Update highwater mark indicating how much memory needs to be allocated
     // for the entire slab.
-    highwaterMark = std::max(highwaterMark, bestOffset + alignedSize);
+    plan.highwaterMark = std::max(plan.highwaterMark, bestOffset + alignedSize);
   }
+  return plan;
+}
+
+// Returns the minimum number of bytes any static packing of |slices| could
+// use: the largest total size of slices live at the same time. Alignment
+// padding between slices is ignored and the bound may not be achievable.
+static int64_t computeStaticSliceLowerBound(ArrayRef<Slice> slices,
+                                            int64_t rangeAlignment) {
+  // Sweep over lifetime boundaries; intervals are inclusive and all slices
+  // starting at a time are live before any ending at it are released.
+  SmallVector<std::pair<int64_t, int64_t>> events;
+  events.reserve(slices.size() * 2);
+  for (auto &slice : slices) {
+    int64_t alignedSize = getAlignedStaticSize(slice, rangeAlignment);
+    events.push_back({slice.lifetimeStart, alignedSize});
+    events.push_back({slice.lifetimeEnd + 1, -alignedSize});
+  }
+  llvm::sort(events, [](const auto &lhs, const auto &rhs) {
+    if (lhs.first != rhs.first)
+      return lhs.first < rhs.first;
+    return lhs.second < rhs.second; // releases first
+  });
+  int64_t liveSize = 0;
+  int64_t maxLiveSize = 0;
+  for (auto [time, delta] : events) {
+    liveSize += delta;
+    maxLiveSize = std::max(maxLiveSize, liveSize);
+  }
+  return maxLiveSize;
+}
 
-  highwaterMark = IREE::Util::align(highwaterMark, rangeAlignment);
+// Packs a set of statically-sized slices using |strategy|.
+//
+// Slice packed offset SSA values will be updated and start at the given
+// |baseOffset|. Returns |baseOffset| + the total size of the allocation
+// aligned to the requirements of |resourceConfig|.
+static Value packStaticSlices(IREE::Stream::ResourcePackOp packOp,
+                              Value baseOffset, MutableArrayRef<Slice> slices,
+                              IREE::Stream::ResourceConfigAttr resourceConfig,
+                              IREE::Stream::SlicePackingStrategy strategy,
+                              IndexSet &indexSet, OpBuilder &builder) {
+  int64_t offsetAlignment = resourceConfig.getMinBufferOffsetAlignment();
+  int64_t rangeAlignment = resourceConfig.getMinBufferRangeAlignment();
+
+  // Slices arrive in ascending lifetime order.
+  SmallVector<size_t> lifetimeOrder(slices.size());
+  std::iota(lifetimeOrder.begin(), lifetimeOrder.end(), 0);
+  auto planInLifetimeOrder = [&]() {
+    return planStaticSlicesGreedily(slices, lifetimeOrder, offsetAlignment,
+                                    rangeAlignment);
+  };
+
+  // Largest slices first so that smaller ones fill the gaps between them;
+  // ties are broken by lifetime so the result is deterministic.
+  auto planInSizeOrder = [&]() {
+    SmallVector<size_t> sizeOrder = lifetimeOrder;
+    std::stable_sort(sizeOrder.begin(), sizeOrder.end(),
+                     [&](size_t lhs, size_t rhs) {
+                       return getAlignedStaticSize(slices[lhs],
+                                                   rangeAlignment) >
+                              getAlignedStaticSize(slices[rhs], rangeAlignment);
+                     });
+    return planStaticSlicesGreedily(slices, sizeOrder, offsetAlignment,
+                                    rangeAlignment);
+  };
+
+  StaticPlan plan;
+  switch (strategy) {
+  case IREE::Stream::SlicePackingStrategy::Greedy:
+    plan = planInLifetimeOrder();
+    break;
+  case IREE::Stream::SlicePackingStrategy::GreedyBySize:
+    plan = planInSizeOrder();
+    break;
+  case IREE::Stream::SlicePackingStrategy::Best: {
+    plan = planInLifetimeOrder();
+    StaticPlan sizePlan = planInSizeOrder();
+    if (sizePlan.highwaterMark < plan.highwaterMark) {
+      plan = std::move(sizePlan);
+    }
+    break;
+  }
+  }
+
+  LLVM_DEBUG({
+    llvm::dbgs() << "[LayoutSlices] packed " << slices.size()
+                 << " static slices into " << plan.highwaterMark
+                 << " bytes (lower bound "
+                 << computeStaticSliceLowerBound(slices, rangeAlignment)
+                 << " bytes)\n";
+  });
+
+  for (auto [slice, offset] : llvm::zip_equal(slices, plan.offsets)) {
+    slice.packedOffset.replaceAllUsesWith(builder.createOrFold<arith::AddIOp>(
+        packOp.getLoc(), baseOffset, indexSet.get(offset)));
+  }
+
+  int64_t highwaterMark = IREE::Util::align(plan.highwaterMark, rangeAlignment);
   return builder.createOrFold<arith::AddIOp>(packOp.getLoc(), baseOffset,
                                              indexSet.get(highwaterMark));
 }
@@ -220,6 +323,8 @@ packDynamicSlicesConservatively(IREE::Stream::ResourcePackOp packOp,
 
 struct LayoutSlicesPass
     : public IREE::Stream::impl::LayoutSlicesPassBase<LayoutSlicesPass> {
+  using IREE::Stream::impl::LayoutSlicesPassBase<
+      LayoutSlicesPass>::LayoutSlicesPassBase;
   void runOnOperation() override {
     auto parentOp = getOperation();
     if (!parentOp.getCallableRegion() ||
@@ -227,9 +332,6 @@ struct LayoutSlicesPass
       return;
     }
 
-    // NOTE: we could try several algorithms and compute which packs best. For
-    // now we just pack greedily as it's fast and what most existing ML
-    // frameworks do.
     parentOp.walk([&](IREE::Stream::ResourcePackOp packOp) {
       // Derive resource constraints based on pack affinity.
       auto resourceConfig = IREE::Stream::ResourceConfigAttr::lookup(packOp);
@@ -257,13 +359,25 @@ struct LayoutSlicesPass
       // compile time.
       auto offset = packOp.getOffset() ? packOp.getOffset() : indexSet.get(0);
       if (!staticSlices.empty()) {
-        offset = packStaticSlicesGreedily(packOp, offset, staticSlices,
-                                          resourceConfig, indexSet, builder);
-
-        // TODO(benvanik): make this an option; it can be useful for debugging
-        // this code.
-        // offset = packSlicesWithNoAliasing(packOp, offset, staticSlices,
-        //                                   resourceConfig, indexSet, builder);
+        offset = packStaticSlices(packOp, offset, staticSlices,
+                                  resourceConfig, packingStrategy, indexSet,
+                                  builder);
+
+        // Record the best achievable size on the allocations so that
+        // statistics can report how close the packing came. Only fully static
+        // packs have a meaningful bound.
+        if (dynamicSlices.empty() && !packOp.getOffset()) {
+          int64_t lowerBound = IREE::Util::align(
+              computeStaticSliceLowerBound(
+                  staticSlices, resourceConfig.getMinBufferRangeAlignment()),
+              resourceConfig.getMinBufferRangeAlignment());
+          auto lowerBoundAttr = builder.getIndexAttr(lowerBound);
+          for (auto *user : packOp.getTotalLength().getUsers()) {
+            if (isa<IREE::Stream::ResourceAllocaOp>(user)) {
+              user->setAttr("stream.packing_lower_bound", lowerBoundAttr);
+            }
+          }
+        }
       }
 
       // Next pack all dynamic slices. Depending on the analysis information
@@ -12,7 +12,11 @@
 #include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Utils/IntegerSet.h"
+#include "llvm/ADT/BitVector.h"
+#include "llvm/ADT/MapVector.h"
 #include "llvm/Support/Debug.h"
+#include "llvm/Support/MD5.h"
+#include "llvm/Support/raw_ostream.h"
 #include "mlir/Dialect/SCF/IR/SCF.h"
 #include "mlir/IR/AsmState.h"
 #include "mlir/IR/Attributes.h"
@@ -221,8 +225,9 @@ computePackingMap(ArrayRef<ConstantSlice> slices,
   //
   // Here it's all descriptor sets and mapped pages but same thing pretty
   // much, and passes earlier on may duplicate constants in the pool if it
-  // means they can improve locality at runtime. This pass doesn't dedupe and
-  // just sticks to packing for that reason.
+  // means they can improve locality at runtime. This function doesn't dedupe
+  // and just sticks to packing for that reason - callers may fold identical
+  // immutable values beforehand with deduplicateConstantSlices.
 
   // Build a list of resources and spans (append to current or spill to new).
   auto storageBuffers =
@@ -236,6 +241,111 @@ computePackingMap(ArrayRef<ConstantSlice> slices,
   return storageBuffers;
 }
 
+// Digests all bytes written to the stream without retaining them.
+class md5_ostream : public llvm::raw_ostream {
+public:
+  md5_ostream() { SetUnbuffered(); }
+
+  llvm::MD5::MD5Result result() {
+    llvm::MD5::MD5Result digest;
+    hasher.final(digest);
+    return digest;
+  }
+
+private:
+  void write_impl(const char *ptr, size_t size) override {
+    hasher.update(
+        ArrayRef<uint8_t>(reinterpret_cast<const uint8_t *>(ptr), size));
+    pos += size;
+  }
+  uint64_t current_pos() const override { return pos; }
+  llvm::MD5 hasher;
+  uint64_t pos = 0;
+};
+
+// Returns a digest of the serialized contents of |value| or nullopt if the
+// value cannot be serialized.
+static std::optional<std::pair<uint64_t, uint64_t>>
+digestConstantValue(Location loc, Attribute value) {
+  auto serializableAttr =
+      dyn_cast<IREE::Util::SerializableAttrInterface>(value);
+  if (!serializableAttr)
+    return std::nullopt;
+  md5_ostream os;
+  if (failed(serializableAttr.serializeToStream(
+          loc, llvm::endianness::little, os))) {
+    return std::nullopt;
+  }
+  os.flush();
+  return os.result().words();
+}
+
+// Returns true if |lhs| and |rhs| are known to be the same index value.
+static bool isSameResultSize(Value lhs, Value rhs) {
+  if (lhs == rhs)
+    return true;
+  APInt lhsValue, rhsValue;
+  return matchPattern(lhs, m_ConstantInt(&lhsValue)) &&
+         matchPattern(rhs, m_ConstantInt(&rhsValue)) && lhsValue == rhsValue;
+}
+
+// Folds slices in |slices| with contents identical to a prior slice into that
+// prior slice and returns the remaining unique slices in their original order.
+// Only valid for immutable resources as the folded slices will alias.
+//
+// Values are compared by their serialized bytes and not their attributes so
+// that the same data with different element types or attribute kinds (as is
+// common with weights imported multiple times) is stored once. Only slices
+// with matching storage sizes are serialized.
+static SmallVector<ConstantSlice>
+deduplicateConstantSlices(ArrayRef<ConstantSlice> slices) {
+  llvm::MapVector<uint64_t, SmallVector<unsigned>> sizeBuckets;
+  for (auto [i, slice] : llvm::enumerate(slices)) {
+    sizeBuckets[slice.getStorageSize()].push_back(i);
+  }
+
+  llvm::BitVector isDuplicate(slices.size());
+  for (auto &[storageSize, sliceIndices] : sizeBuckets) {
+    if (sliceIndices.size() < 2 || storageSize == 0)
+      continue;
+    DenseMap<Attribute, unsigned> attrLeaders;
+    DenseMap<std::pair<uint64_t, uint64_t>, unsigned> digestLeaders;
+    for (unsigned i : sliceIndices) {
+      auto slice = slices[i];
+      std::optional<unsigned> leaderIndex;
+      auto attrIt = attrLeaders.find(slice.value);
+      if (attrIt != attrLeaders.end()) {
+        leaderIndex = attrIt->second;
+      } else {
+        unsigned attrLeaderIndex = i;
+        if (auto digest =
+                digestConstantValue(slice.result.getLoc(), slice.value)) {
+          attrLeaderIndex = digestLeaders.try_emplace(*digest, i).first->second;
+          if (attrLeaderIndex != i)
+            leaderIndex = attrLeaderIndex;
+        }
+        attrLeaders[slice.value] = attrLeaderIndex;
+      }
+      if (!leaderIndex)
+        continue;
+      const auto &leader = slices[*leaderIndex];
+      if (!isSameResultSize(slice.resultSize, leader.resultSize))
+        continue;
+      LLVM_DEBUG(llvm::dbgs() << "deduplicating constant slice " << i
+                              << " into " << *leaderIndex << "\n");
+      slice.result.replaceAllUsesWith(leader.result);
+      isDuplicate.set(i);
+    }
+  }
+
+  SmallVector<ConstantSlice> uniqueSlices;
+  for (auto [i, slice] : llvm::enumerate(slices)) {
+    if (!isDuplicate.test(i))
+      uniqueSlices.push_back(slice);
+  }
+  return uniqueSlices;
+}
+
 //===----------------------------------------------------------------------===//
 // Upload materialization
 //===----------------------------------------------------------------------===//
@@ -459,6 +569,18 @@ static Value generateSerializedUpload(
     IREE::Stream::ResourceConfigAttr resourceConfig,
     ArrayRef<ConstantSlice> slices, IntegerSet<int64_t> &i64Set,
     IndexSet &indexSet, OpBuilder &builder) {
+  auto anyResult = slices.front().result;
+  auto resourceType =
+      llvm::cast<IREE::Stream::ResourceType>(anyResult.getType());
+
+  // Immutable values with identical contents can share storage. Variables
+  // need unique storage as they may be independently mutated.
+  SmallVector<ConstantSlice> uniqueSlices;
+  if (resourceType.getLifetime() == IREE::Stream::Lifetime::Constant) {
+    uniqueSlices = deduplicateConstantSlices(slices);
+    slices = uniqueSlices;
+  }
+
   // Perform the packing of dense values to compute the storage resources we
   // will need and where each value will be placed.
   auto storageResources =
@@ -469,10 +591,6 @@ static Value generateSerializedUpload(
   // TODO(benvanik): should be able to have a single buffer constant and
   // subrange it so that we don't need so many files.
 
-  auto anyResult = slices.front().result;
-  auto resourceType =
-      llvm::cast<IREE::Stream::ResourceType>(anyResult.getType());
-
   // Emit rodata storage for the constant values.
   // As our upload paths may vary this ensures that we are only emitting
   // them once regardless of how many strategies we emit IR for.
@@ -190,9 +190,17 @@ void buildStreamAsyncPassPipeline(OpPassManager &passManager,
 
   FunctionLikeNest(passManager)
       // Combine async work into execution regions.
-      .addPass(IREE::Stream::createScheduleExecutionPass)
+      .addPass([&]() {
+        return IREE::Stream::createScheduleExecutionPass(
+            ScheduleExecutionPassOptions{
+                transformOptions.partitioningAlgorithm});
+      })
       // Group concurrently executable work into waves.
-      .addPass(IREE::Stream::createScheduleConcurrencyPass);
+      .addPass([&]() {
+        return IREE::Stream::createScheduleConcurrencyPass(
+            ScheduleConcurrencyPassOptions{
+                transformOptions.partitioningAlgorithm});
+      });
 
   // Materialize timepoints across the entire module. This simplifies scheduling
   // of the timeline as we can shake the IR and see what timepoints we still
@@ -232,7 +240,10 @@ void buildStreamCmdPassPipeline(OpPassManager &passManager,
       // Layout packed slices to emit the arithmetic required for all resource
       // offsets. This enables us to propagate the subviews across the program
       // below.
-      .addPass(IREE::Stream::createLayoutSlicesPass);
+      .addPass([&]() {
+        return IREE::Stream::createLayoutSlicesPass(LayoutSlicesPassOptions{
+            transformOptions.slicePackingStrategy});
+      });
 
   // Propagate subviews throughout the program to unify resource storage access.
   // After propagation many resource SSA values can be deduped or folded by the
@@ -7,6 +7,7 @@
 #ifndef IREE_COMPILER_DIALECT_STREAM_TRANSFORMS_PASSES_H_
 #define IREE_COMPILER_DIALECT_STREAM_TRANSFORMS_PASSES_H_
 
+#include "iree/compiler/Dialect/Stream/Analysis/Partitioning.h"
 #include "iree/compiler/Dialect/Stream/IR/StreamOps.h"
 #include "llvm/ADT/StringMap.h"
 #include "mlir/IR/BuiltinOps.h"
@@ -39,6 +40,16 @@ enum class DumpOutputFormat {
   JSON = 4,
 };
 
+// Defines the placement order used when packing statically-sized slices.
+enum class SlicePackingStrategy {
+  // Place slices in ascending lifetime order.
+  Greedy = 0,
+  // Place slices in descending size order (the TFLite greedy-by-size planner).
+  GreedyBySize = 1,
+  // Try all strategies and keep the one with the smallest allocation.
+  Best = 2,
+};
+
 struct TransformOptions : public PassPipelineOptions<TransformOptions> {
   // TODO(benvanik): options for async/sync overrides.
 
@@ -50,6 +61,34 @@ struct TransformOptions : public PassPipelineOptions<TransformOptions> {
       llvm::cl::init(true),
   };
 
+  Option<PartitioningAlgorithm> partitioningAlgorithm{
+      *this,
+      "partitioning-algorithm",
+      llvm::cl::desc("Algorithm used to partition execution regions and their "
+                     "concurrent waves."),
+      llvm::cl::init(PartitioningAlgorithm::Reference),
+      llvm::cl::values(
+          clEnumValN(IREE::Stream::PartitioningAlgorithm::Reference,
+                     "reference", "Greedy correctness-only clustering."),
+          clEnumValN(IREE::Stream::PartitioningAlgorithm::Multilevel,
+                     "multilevel", "Cost-driven multilevel partitioning.")),
+  };
+
+  Option<SlicePackingStrategy> slicePackingStrategy{
+      *this,
+      "slice-packing-strategy",
+      llvm::cl::desc("Strategy used to pack statically-sized transient "
+                     "slices into allocations."),
+      llvm::cl::init(SlicePackingStrategy::Greedy),
+      llvm::cl::values(
+          clEnumValN(IREE::Stream::SlicePackingStrategy::Greedy, "greedy",
+                     "Best-fit in lifetime order."),
+          clEnumValN(IREE::Stream::SlicePackingStrategy::GreedyBySize,
+                     "greedy-by-size", "Best-fit in decreasing size order."),
+          clEnumValN(IREE::Stream::SlicePackingStrategy::Best, "best",
+                     "Smallest result of all strategies.")),
+  };
+
   Option<DumpOutputFormat> dumpStatisticsFormat{
       *this,
       "dump-statistics-format",
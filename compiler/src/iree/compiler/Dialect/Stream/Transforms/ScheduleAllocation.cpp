@@ -625,8 +625,10 @@ applyAsyncCollectiveOp(IREE::Stream::AsyncCollectiveOp asyncOp,
   SmallVector<Value> newResourceLengths;
   SmallVector<Attribute> newResourceAccesses;
 
-  // TODO(#11249): support in-place collectives by a r/w resource? it may be
-  // fine to leave them separate as then we get unique invalidation ranges.
+  // NOTE: in-place collectives (see makeCollectivesInPlace) have the source
+  // and target map to the same resource range. We keep them as separate
+  // read/write resources so that the collective kind still determines which is
+  // the send and recv buffer.
 
   auto sourceRange = scope.lookupResourceRange(asyncOp.getSource());
   auto sourceOffset = scope.add(asyncOp.getLoc(), sourceRange.offset,
@@ -1384,10 +1386,90 @@ static bool isExecutedOnce(Operation *op) {
 
 // Performs allocation for all results and local region transients of the given
 // |executeOp| region. IR will be inserted around the op in its parent block.
+// Returns true if |value| covers the entirety of a resource of |size| when
+// accessed from |offset| for |length|.
+static bool isFullResourceRange(Value size, Value offset, Value length) {
+  return matchPattern(offset, m_Zero()) && length == size;
+}
+
+// Rewrites collectives in the |executeOp| region to run in-place when their
+// source is produced locally and its last use is the collective. Instead of
+// allocating a new target and having the collective copy into it the result
+// is tied to the source so that send and recv alias.
+//
+// Example:
+//   %0 = stream.async.dispatch ...
+//   %1 = stream.async.alloca : !stream.resource<transient>{%sz}
+//   %2 = stream.async.collective<all_reduce ...> %0[...], %1[...]
+// ->
+//   %0 = stream.async.dispatch ...
+//   %2 = stream.async.collective<all_reduce ...> %0[...], %0[...]
+//
+// Only all-reduce is handled today as it is elementwise and its send and recv
+// ranges are identical. This must run prior to analyzing the region as it
+// changes which values alias.
+static void makeCollectivesInPlace(IREE::Stream::AsyncExecuteOp executeOp) {
+  auto collectiveOps = llvm::to_vector(
+      executeOp.getBody().getOps<IREE::Stream::AsyncCollectiveOp>());
+  for (auto collectiveOp : collectiveOps) {
+    if (collectiveOp.getOp().getKind() !=
+        IREE::Stream::CollectiveKind::AllReduce) {
+      continue;
+    }
+
+    // The target must be a fresh allocation only used by the collective.
+    auto allocaOp =
+        collectiveOp.getTarget().getDefiningOp<IREE::Stream::AsyncAllocaOp>();
+    if (!allocaOp || !allocaOp.getResult().hasOneUse()) {
+      continue;
+    }
+
+    // The source must be produced within the region (so no one outside can
+    // observe it being overwritten) and the collective must be its last use.
+    auto source = collectiveOp.getSource();
+    auto *sourceOp = source.getDefiningOp();
+    if (!sourceOp || sourceOp->getBlock() != collectiveOp->getBlock() ||
+        !source.hasOneUse() ||
+        source.getType() != collectiveOp.getTarget().getType()) {
+      continue;
+    }
+
+    // Both must cover their entire resources with the same size so that the
+    // result can take over the source storage as-is.
+    if (collectiveOp.getSourceSize() != collectiveOp.getTargetSize() ||
+        !isFullResourceRange(collectiveOp.getSourceSize(),
+                             collectiveOp.getSourceOffset(),
+                             collectiveOp.getSourceLength()) ||
+        !isFullResourceRange(collectiveOp.getTargetSize(),
+                             collectiveOp.getTargetOffset(),
+                             collectiveOp.getTargetLength())) {
+      continue;
+    }
+
+    LLVM_DEBUG({
+      llvm::dbgs() << "  + making collective in-place: ";
+      collectiveOp.print(llvm::dbgs(),
+                         OpPrintingFlags().elideLargeElementsAttrs());
+      llvm::dbgs() << "\n";
+    });
+    collectiveOp.getTargetMutable().assign(source);
+    collectiveOp.getTargetOffsetMutable().assign(
+        collectiveOp.getSourceOffset());
+    collectiveOp.getTargetEndMutable().assign(collectiveOp.getSourceEnd());
+    collectiveOp.getTargetLengthMutable().assign(
+        collectiveOp.getSourceLength());
+    allocaOp.erase();
+  }
+}
+
 static LogicalResult
 allocateExecutionRegion(IREE::Stream::AsyncExecuteOp executeOp) {
   LLVM_DEBUG(llvm::dbgs() << "[[ Allocating execution region ]]\n");
 
+  // Collectives that can run in-place change the aliasing of the region and
+  // must be handled before we analyze it.
+  makeCollectivesInPlace(executeOp);
+
   AllocationScope scope(executeOp);
 
   OpBuilder externalBuilder(executeOp);
@@ -1412,10 +1494,6 @@ allocateExecutionRegion(IREE::Stream::AsyncExecuteOp executeOp) {
   llvm::append_range(newOperandSizes, executeOp.getResourceOperandSizes());
   SmallVector<Value> joinTimepoints;
 
-  // TODO(#11249): pre-scan region for collectives and handle in-place behavior
-  // where send aliases recv. We probably want to do this early in case both
-  // values are produced locally and escape the region.
-
   // First find all constants and pull them out into a dedicated constant upload
   // op. We'll then capture the result and use that to initialize variables and
   // constants within the region. Note that this removes ops from the region and
@@ -180,6 +180,8 @@ struct WavePartitionBuilder {
 struct ScheduleConcurrencyPass
     : public IREE::Stream::impl::ScheduleConcurrencyPassBase<
           ScheduleConcurrencyPass> {
+  using IREE::Stream::impl::ScheduleConcurrencyPassBase<
+      ScheduleConcurrencyPass>::ScheduleConcurrencyPassBase;
   void runOnOperation() override {
     auto parentOp = getOperation();
     if (!parentOp.getCallableRegion() ||
@@ -204,7 +206,8 @@ struct ScheduleConcurrencyPass
 
     // Compute a set of partitions covering all of the streamable ops in the
     // execution region.
-    auto waveSet = partitionRegionConcurrency(configAttr, block);
+    auto waveSet =
+        partitionRegionConcurrency(configAttr, block, partitioningAlgorithm);
     if (waveSet.empty())
       return success();
     if (failed(waveSet.verify(parentOp.getLoc())))
@@ -218,11 +218,12 @@ static SmallVector<Block *, 8> sortBlocksInDominanceOrder(Region &region) {
 }
 
 LogicalResult processRegion(Location loc, MLIRContext *context, Region &region,
-                            const PartitioningConfigAttr &configAttr) {
+                            const PartitioningConfigAttr &configAttr,
+                            PartitioningAlgorithm algorithm) {
   for (auto *block : sortBlocksInDominanceOrder(region)) {
     // Compute a set of partitions covering all of the streamable ops in the
     // block.
-    auto partitionSet = partitionStreamableOps(configAttr, block);
+    auto partitionSet = partitionStreamableOps(configAttr, block, algorithm);
     if (partitionSet.empty())
       continue;
     if (failed(partitionSet.verify(loc))) {
@@ -301,8 +302,10 @@ LogicalResult processRegion(Location loc, MLIRContext *context, Region &region,
     for (auto &op : *block) {
       if (isa<scf::SCFDialect>(op.getDialect())) {
         for (auto &subregion : op.getRegions()) {
-          if (failed(processRegion(loc, context, subregion, configAttr)))
+          if (failed(processRegion(loc, context, subregion, configAttr,
+                                   algorithm))) {
             return failure();
+          }
         }
       }
     }
@@ -318,6 +321,8 @@ LogicalResult processRegion(Location loc, MLIRContext *context, Region &region,
 struct ScheduleExecutionPass
     : public IREE::Stream::impl::ScheduleExecutionPassBase<
           ScheduleExecutionPass> {
+  using IREE::Stream::impl::ScheduleExecutionPassBase<
+      ScheduleExecutionPass>::ScheduleExecutionPassBase;
   void runOnOperation() override {
     auto *context = &getContext();
     auto parentOp = getOperation();
@@ -335,8 +340,10 @@ struct ScheduleExecutionPass
     // order so that we are sure if we replace values that dominate other blocks
     // they see the correct values.
     auto &region = *parentOp.getCallableRegion();
-    if (failed(processRegion(parentOp.getLoc(), context, region, configAttr)))
+    if (failed(processRegion(parentOp.getLoc(), context, region, configAttr,
+                             partitioningAlgorithm))) {
       return signalPassFailure();
+    }
 
     // Cleanup the dead ops.
     // TODO(benvanik): less work here - maybe no patterns to just force folding?
@@ -5,16 +5,21 @@
 // CHECK-PRETTY:   Constants: 1, estimated storage of 192 B
 // CHECK-PRETTY:   Variables: 0, (TBD)
 // CHECK-PRETTY:  D->H Syncs: 2
-// CHECK-PRETTY: Submissions: 2, using cumulative 0 B
+// CHECK-PRETTY: Submissions: 2, using cumulative 224 B
+// CHECK-PRETTY:              lower bound 224 B
+// CHECK-PRETTY:              peak per invocation 192 B
 // CHECK-PRETTY:   DMA Fills: 0
 // CHECK-PRETTY:  DMA Copies: 1
 // CHECK-PRETTY: Collectives: 0
 // CHECK-PRETTY:  Dispatches: 3
 // CHECK-PRETTY: Executables: 2, 33% reuse
+// CHECK-PRETTY: Transient Memory (static, per-invocation)
+// CHECK-PRETTY: @func_a: peak 0 B
+// CHECK-PRETTY: @func_b: peak 192 B
 
 // CHECK-CSV: ; Aggregate Statistics
-// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Fills","Copies","Dispatches","Async Calls","Executables"
-// CHECK-CSV: 1,192,0,0,2,2,0,0,1,3,0,2
+// CHECK-CSV: "Constants","Constant Size","Variables","Variable Size","Awaits","Submissions","Transient Size","Transient Lower Bound","Transient Peak","Fills","Copies","Dispatches","Async Calls","Executables"
+// CHECK-CSV: 1,192,0,0,2,2,224,224,192,0,1,3,0,2
 // CHECK-CSV: ; Execution
 // CHECK-CSV: "Depth","Command","Symbol","Length","Invocations","Workload","Operands","Resources"
 // CHECK-CSV: 0,"copy",,16,,,,
@@ -146,3 +151,18 @@ util.func public @func_a() -> (tensor<4xi32>, tensor<4xi32>) {
   %7 = stream.tensor.export %6 : tensor<4xi32> in !stream.resource<external>{%c16} -> tensor<4xi32>
   util.return %5, %7 : tensor<4xi32>, tensor<4xi32>
 }
+
+// Transient allocations are estimated in program order: the peak is reached
+// when %0 and %2 are live and %0 is released before %4 is allocated.
+util.func public @func_b(%arg0: !stream.timepoint) -> !stream.timepoint {
+  %c32 = arith.constant 32 : index
+  %c64 = arith.constant 64 : index
+  %c128 = arith.constant 128 : index
+  %0, %1 = stream.resource.alloca uninitialized await(%arg0) => !stream.resource<transient>{%c128} => !stream.timepoint
+  %2, %3 = stream.resource.alloca uninitialized await(%1) => !stream.resource<transient>{%c64} => !stream.timepoint
+  %4 = stream.resource.dealloca await(%3) => %0 : !stream.resource<transient>{%c128} => !stream.timepoint
+  %5, %6 = stream.resource.alloca uninitialized await(%4) => !stream.resource<transient>{%c32} => !stream.timepoint
+  %7 = stream.resource.dealloca await(%6) => %5 : !stream.resource<transient>{%c32} => !stream.timepoint
+  %8 = stream.resource.dealloca await(%7) => %2 : !stream.resource<transient>{%c64} => !stream.timepoint
+  util.return %8 : !stream.timepoint
+}
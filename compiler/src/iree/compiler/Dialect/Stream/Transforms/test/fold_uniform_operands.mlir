@@ -95,3 +95,86 @@ util.func public @inlineConstantOperands(%a: i32) {
   } => !stream.timepoint
   util.return
 }
+
+// -----
+
+// Tests that operands that are a uniform offset from another operand at all
+// dispatch sites are derived from that operand in the dispatch regions.
+//
+// In this test %a1 is always %a0 + 256, %p1 is always %p0 + 128 (even though
+// both are constants that differ per site), and %q1 is always %q0 + 16 after
+// truncation. %b1 is offset from %b0 by divergent amounts and is kept.
+
+// CHECK-LABEL: @deriveOffsetOperandsEx
+stream.executable private @deriveOffsetOperandsEx {
+  stream.executable.export public @dispatch
+  builtin.module  {
+    // CHECK:  util.func public @dispatch(%[[BINDING:.+]]: !stream.binding, %[[A0:.+]]: index, %[[P0:.+]]: i32, %[[Q0:.+]]: i32, %[[B0:.+]]: index, %[[B1:.+]]: index)
+     util.func public @dispatch(%binding: !stream.binding, %a0: index, %a1: index, %p0: i32, %p1: i32, %q0: i32, %q1: i32, %b0: index, %b1: index) {
+      // CHECK: %[[C256:.+]] = arith.constant 256 : index
+      // CHECK-NEXT: %[[A1:.+]] = arith.addi %[[A0]], %[[C256]] : index
+      // CHECK-NEXT: %[[C128:.+]] = arith.constant 128 : i32
+      // CHECK-NEXT: %[[P1:.+]] = arith.addi %[[P0]], %[[C128]] : i32
+      // CHECK-NEXT: %[[C16:.+]] = arith.constant 16 : i32
+      // CHECK-NEXT: %[[Q1:.+]] = arith.addi %[[Q0]], %[[C16]] : i32
+      // CHECK-NEXT: util.optimization_barrier %[[BINDING]] : !stream.binding
+      util.optimization_barrier %binding : !stream.binding
+      // CHECK-NEXT: util.optimization_barrier %[[A0]] : index
+      util.optimization_barrier %a0 : index
+      // CHECK-NEXT: util.optimization_barrier %[[A1]] : index
+      util.optimization_barrier %a1 : index
+      // CHECK-NEXT: util.optimization_barrier %[[P0]] : i32
+      util.optimization_barrier %p0 : i32
+      // CHECK-NEXT: util.optimization_barrier %[[P1]] : i32
+      util.optimization_barrier %p1 : i32
+      // CHECK-NEXT: util.optimization_barrier %[[Q0]] : i32
+      util.optimization_barrier %q0 : i32
+      // CHECK-NEXT: util.optimization_barrier %[[Q1]] : i32
+      util.optimization_barrier %q1 : i32
+      // CHECK-NEXT: util.optimization_barrier %[[B0]] : index
+      util.optimization_barrier %b0 : index
+      // CHECK-NEXT: util.optimization_barrier %[[B1]] : index
+      util.optimization_barrier %b1 : index
+      util.return
+    }
+  }
+}
+// CHECK:  util.func public @deriveOffsetOperands(%[[A:.+]]: index, %[[Z:.+]]: index, %[[B:.+]]: index)
+util.func public @deriveOffsetOperands(%a: index, %z: index, %b: index) {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c2 = arith.constant 2 : index
+  %c16 = arith.constant 16 : index
+  %c20 = arith.constant 20 : index
+  %c256 = arith.constant 256 : index
+  %c0_i32 = arith.constant 0 : i32
+  %c128_i32 = arith.constant 128 : i32
+  %c512_i32 = arith.constant 512 : i32
+  %c640_i32 = arith.constant 640 : i32
+  %a256 = arith.addi %a, %c256 : index
+  %z256 = arith.addi %c256, %z : index
+  // CHECK: %[[AI:.+]] = arith.index_castui %[[A]] : index to i32
+  %ai = arith.index_castui %a : index to i32
+  %a16 = arith.addi %a, %c16 : index
+  %aj = arith.index_castui %a16 : index to i32
+  // CHECK: %[[ZI:.+]] = arith.index_castui %[[Z]] : index to i32
+  %zi = arith.index_castui %z : index to i32
+  %z16 = arith.addi %z, %c16 : index
+  %zj = arith.index_castui %z16 : index to i32
+  // CHECK: %[[B1:.+]] = arith.addi %[[B]], %c1
+  %b1 = arith.addi %b, %c1 : index
+  // CHECK: %[[B2:.+]] = arith.addi %[[B]], %c2
+  %b2 = arith.addi %b, %c2 : index
+  %alloc = stream.resource.alloc uninitialized : !stream.resource<transient>{%c20}
+  %result_timepoint = stream.cmd.execute with(%alloc as %capture: !stream.resource<transient>{%c20}) {
+    // CHECK: stream.cmd.dispatch {{.+}}(%[[A]], %c0_i32, %[[AI]], %[[B]], %[[B1]] : index, i32, i32, index, index)
+    stream.cmd.dispatch @deriveOffsetOperandsEx::@dispatch[%c1, %c1, %c1](%a, %a256, %c0_i32, %c128_i32, %ai, %aj, %b, %b1 : index, index, i32, i32, i32, i32, index, index) {
+      rw %capture[%c0 for %c20] : !stream.resource<transient>{%c20}
+    }
+    // CHECK: stream.cmd.dispatch {{.+}}(%[[Z]], %c512_i32, %[[ZI]], %[[B]], %[[B2]] : index, i32, i32, index, index)
+    stream.cmd.dispatch @deriveOffsetOperandsEx::@dispatch[%c1, %c1, %c1](%z, %z256, %c512_i32, %c640_i32, %zi, %zj, %b, %b2 : index, index, i32, i32, i32, i32, index, index) {
+      rw %capture[%c0 for %c20] : !stream.resource<transient>{%c20}
+    }
+  } => !stream.timepoint
+  util.return
+}
@@ -0,0 +1,53 @@
+// RUN: iree-opt --split-input-file --pass-pipeline='builtin.module(util.func(iree-stream-layout-slices{slice-packing-strategy=greedy-by-size}, cse))' %s | FileCheck %s
+
+#layoutBySizeConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// Packing in lifetime order would place [1, 2] above [0, 2] for 64 bytes; by
+// placing the largest slice first the small ones fit around it.
+
+// CHECK-LABEL: @layoutStaticBySize
+util.func public @layoutStaticBySize() -> (index, index, index, index)
+    attributes {stream.resources = #layoutBySizeConfig} {
+  %c16 = arith.constant 16 : index
+  %c32 = arith.constant 32 : index
+  %t:4 = stream.resource.pack slices({
+    [0, 0] = %c16,  // +0 (no overlap with [1, 2])
+    [0, 2] = %c16,  // +32 (after [1, 2])
+    [1, 2] = %c32,  // +0 (placed first)
+  }) : index
+  // CHECK: util.return %c48
+  // CHECK-SAME: %c0, %c32, %c0
+  util.return %t#0, %t#1, %t#2, %t#3 : index, index, index, index
+}
+
+// -----
+
+#layoutLowerBoundConfig = #stream.resource_config<{
+  max_allocation_size = 1073741824,
+  min_buffer_offset_alignment = 16,
+  max_buffer_range = 1073741824,
+  min_buffer_range_alignment = 16,
+  index_bits = 32
+}>
+
+// CHECK-LABEL: @layoutLowerBound
+util.func public @layoutLowerBound() -> !stream.resource<transient>
+    attributes {stream.resources = #layoutLowerBoundConfig} {
+  %c16 = arith.constant 16 : index
+  %c32 = arith.constant 32 : index
+  %t:4 = stream.resource.pack slices({
+    [0, 0] = %c16,
+    [0, 2] = %c16,
+    [1, 2] = %c32,
+  }) : index
+  // CHECK: stream.resource.alloca
+  // CHECK-SAME: stream.packing_lower_bound = 48 : index
+  %resource, %timepoint = stream.resource.alloca uninitialized : !stream.resource<transient>{%t#0} => !stream.timepoint
+  util.return %resource : !stream.resource<transient>
+}
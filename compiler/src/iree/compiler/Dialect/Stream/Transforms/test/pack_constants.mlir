@@ -137,3 +137,36 @@ util.func public @splitResourceConstants() -> (!stream.resource<constant>, !stre
   // CHECK: util.return %[[RES0]], %[[RES1]], %[[IF1]]#0
   util.return %0#0, %0#1, %0#2 : !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
 }
+
+// -----
+
+// Tests that immutable constants with identical serialized contents share
+// storage even if their attributes differ.
+
+// CHECK: #composite_of_128b = #util.composite<128xi8, [
+// CHECK-NEXT:   dense<[1, 2]> : tensor<2xi32>,
+// CHECK-NEXT:   dense<0> : vector<56xi8>,
+// CHECK-NEXT:   dense<3> : tensor<1xi32>,
+// CHECK-NEXT:   dense<0> : vector<60xi8>,
+// CHECK-NEXT: ]>
+
+// CHECK-LABEL: @dedupeResourceConstants
+util.func public @dedupeResourceConstants() -> (!stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint) {
+  %c4 = arith.constant 4 : index
+  %c8 = arith.constant 8 : index
+
+  // CHECK: %[[RODATA:.+]] = util.buffer.constant {alignment = 64 : index} : !util.buffer = #composite_of_128b
+  // CHECK: %[[IF:.+]]:2 = scf.if
+  // CHECK: %[[RES0:.+]] = stream.resource.subview %[[IF]]#1[%c0] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c8}
+  // CHECK: %[[RES2:.+]] = stream.resource.subview %[[IF]]#1[%c64] : !stream.resource<constant>{%c128} -> !stream.resource<constant>{%c4}
+  // CHECK-NOT: stream.resource.subview
+  %0:5 = stream.resource.constants :
+    !stream.resource<constant>{%c8} = dense<[1, 2]> : tensor<2xi32>,
+    !stream.resource<constant>{%c8} = dense<[1, 2]> : tensor<2xi32>,
+    !stream.resource<constant>{%c4} = dense<3> : tensor<1xi32>,
+    !stream.resource<constant>{%c8} = dense<[1, 0, 2, 0]> : tensor<4xi16>
+    => !stream.timepoint
+
+  // CHECK: util.return %[[RES0]], %[[RES0]], %[[RES2]], %[[RES0]], %[[IF]]#0
+  util.return %0#0, %0#1, %0#2, %0#3, %0#4 : !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.resource<constant>, !stream.timepoint
+}
@@ -479,7 +479,37 @@ util.func public @applyConcurrentAsyncCopyOp(%source: !stream.resource<external>
 
 // -----
 
-// TODO(#11249): add a test for in-place collectives (send == recv).
+// Tests that an all-reduce whose source is produced locally and not used
+// afterward runs in-place instead of reducing into a new allocation.
+
+// CHECK-LABEL: @applyAsyncCollectiveOpInPlace
+// CHECK-SAME: (%[[CHANNEL:.+]]: !stream.channel, %[[SIZE:.+]]: index, %[[COUNT:.+]]: index)
+util.func public @applyAsyncCollectiveOpInPlace(%channel: !stream.channel, %size: index, %count: index) {
+  %c0 = arith.constant 0 : index
+  %c254_i32 = arith.constant 254 : i32
+  // CHECK: %[[RESULT:.+]], %[[RESULT_TIMEPOINT:.+]] = stream.resource.alloca uninitialized : !stream.resource<transient>{%[[SIZE]]}
+  // CHECK-NOT: stream.resource.alloca
+  // CHECK: stream.cmd.execute
+  // CHECK-SAME: with(%[[RESULT]] as %[[CAPTURE:.+]]: !stream.resource<transient>{%[[SIZE]]})
+  %result, %result_timepoint = stream.async.execute with() -> !stream.resource<transient>{%size} {
+    // CHECK: stream.cmd.fill %c254_i32, %[[CAPTURE]]
+    %send = stream.async.splat %c254_i32 : i32 -> !stream.resource<transient>{%size}
+    %recv = stream.async.alloca : !stream.resource<transient>{%size}
+    // CHECK: stream.cmd.collective<all_reduce with sum : f32>[%[[COUNT]]]
+    %0 = stream.async.collective<all_reduce with sum : f32>[%count] channel(%channel)
+        // CHECK-NEXT: ro %[[CAPTURE]][%c0 for %[[SIZE]]] : !stream.resource<transient>{%[[SIZE]]}
+        %send[%c0 to %size for %size],
+        // CHECK-NEXT: wo %[[CAPTURE]][%c0 for %[[SIZE]]] : !stream.resource<transient>{%[[SIZE]]}
+        %recv[%c0 to %size for %size] :
+        !stream.resource<transient>{%size} -> %recv as !stream.resource<transient>{%size}
+    stream.yield %0 : !stream.resource<transient>{%size}
+  } => !stream.timepoint
+  // CHECK: util.optimization_barrier %[[RESULT]]
+  util.optimization_barrier %result : !stream.resource<transient>
+  util.return
+}
+
+// -----
 
 // CHECK-LABEL: @applyAsyncCollectiveOpOutOfPlace
 // CHECK-SAME: (%[[CHANNEL:.+]]: !stream.channel,
@@ -186,3 +186,54 @@ util.func public @groupCollectiveOps(%channel: !stream.channel, %send0: !stream.
   util.optimization_barrier %result#1 : !stream.resource<transient>
   util.return
 }
+
+// -----
+
+// Tests that collectives are placed into waves with independent compute work
+// they can overlap with instead of being grouped together when favoring
+// concurrency.
+
+// CHECK-LABEL: @overlapCollectivesWithCompute
+util.func public @overlapCollectivesWithCompute(%channel: !stream.channel, %arg0: !stream.resource<external>, %arg1: !stream.resource<external>, %size: index, %count: index)
+    attributes {stream.partitioning = #stream.partitioning_config<"max-concurrency">} {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  // CHECK: stream.async.execute
+  %result:2, %result_timepoint = stream.async.execute
+      with(%arg0 as %captured0: !stream.resource<external>{%size},
+           %arg1 as %captured1: !stream.resource<external>{%size}) ->
+           (!stream.resource<transient>{%size}, !stream.resource<transient>{%size}) {
+
+    // CHECK: stream.async.dispatch @ex::@dispatch_0a
+    %0 = stream.async.dispatch @ex::@dispatch_0a[%c1, %c1, %c1](%captured0[%c0 to %size for %size]) : (!stream.resource<external>{%size}) -> !stream.resource<transient>{%size}
+    %recv0 = stream.async.alloca : !stream.resource<transient>{%size}
+
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.collective<all_reduce with sum : f32>
+    %1 = stream.async.collective<all_reduce with sum : f32>[%count] channel(%channel)
+        %0[%c0 to %size for %size],
+        %recv0[%c0 to %size for %size] :
+        !stream.resource<transient>{%size} -> %recv0 as !stream.resource<transient>{%size}
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_1a
+    // CHECK-NEXT: stream.yield
+    %2 = stream.async.dispatch @ex::@dispatch_1a[%c1, %c1, %c1](%captured1[%c0 to %size for %size]) : (!stream.resource<external>{%size}) -> !stream.resource<transient>{%size}
+    %recv1 = stream.async.alloca : !stream.resource<transient>{%size}
+
+    // CHECK: stream.async.collective<all_reduce with sum : f32>
+    %3 = stream.async.collective<all_reduce with sum : f32>[%count] channel(%channel)
+        %2[%c0 to %size for %size],
+        %recv1[%c0 to %size for %size] :
+        !stream.resource<transient>{%size} -> %recv1 as !stream.resource<transient>{%size}
+
+    // CHECK: stream.async.concurrent
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_0b
+    // CHECK-NEXT: stream.async.dispatch @ex::@dispatch_1b
+    %4 = stream.async.dispatch @ex::@dispatch_0b[%c1, %c1, %c1](%1[%c0 to %size for %size]) : (!stream.resource<transient>{%size}) -> !stream.resource<transient>{%size}
+    %5 = stream.async.dispatch @ex::@dispatch_1b[%c1, %c1, %c1](%3[%c0 to %size for %size]) : (!stream.resource<transient>{%size}) -> !stream.resource<transient>{%size}
+
+    stream.yield %4, %5 : !stream.resource<transient>{%size}, !stream.resource<transient>{%size}
+  } => !stream.timepoint
+  util.optimization_barrier %result#0 : !stream.resource<transient>
+  util.optimization_barrier %result#1 : !stream.resource<transient>
+  util.return
+}
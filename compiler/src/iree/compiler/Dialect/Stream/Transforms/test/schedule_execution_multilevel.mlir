@@ -0,0 +1,32 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-stream-schedule-execution{partitioning-algorithm=multilevel}))" %s | FileCheck %s
+
+// Tests that dependent work on the same device is kept in a single execution
+// region by the multilevel partitioner.
+
+// CHECK-LABEL: @multilevelPartitioning
+// CHECK-SAME: (%[[ARG0:.+]]: !stream.resource<external>, %[[ARG1:.+]]: !stream.resource<external>)
+util.func public @multilevelPartitioning(%arg0: !stream.resource<external>, %arg1: !stream.resource<external>) -> !stream.resource<external> {
+  %c0 = arith.constant 0 : index
+  %c1 = arith.constant 1 : index
+  %c20 = arith.constant 20 : index
+  %c80 = arith.constant 80 : index
+  %c1280 = arith.constant 1280 : index
+  %c255_i32 = arith.constant 255 : i32
+  // CHECK: %[[RESULT:.+]], %[[TIMEPOINT:.+]] = stream.async.execute
+  // CHECK: stream.async.splat
+  %2 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c1280}
+  // CHECK: stream.async.dispatch @ex::@dispatch_0
+  %3 = stream.async.dispatch @ex::@dispatch_0[%c1, %c1, %c1](%2[%c0 to %c1280 for %c1280], %arg1[%c0 to %c80 for %c80]) : (!stream.resource<transient>{%c1280}, !stream.resource<external>{%c80}) -> %2{%c1280}
+  // CHECK: stream.async.splat
+  %4 = stream.async.splat %c255_i32 : i32 -> !stream.resource<transient>{%c20}
+  // CHECK: stream.async.dispatch @ex::@dispatch_1
+  %5 = stream.async.dispatch @ex::@dispatch_1[%c1, %c1, %c1](%arg0[%c0 to %c20 for %c20], %4[%c0 to %c20 for %c20]) : (!stream.resource<external>{%c20}, !stream.resource<transient>{%c20}) -> %4{%c20}
+  // CHECK: %[[DISPATCH2:.+]] = stream.async.dispatch @ex::@dispatch_2
+  %6 = stream.async.dispatch @ex::@dispatch_2[%c1, %c1, %c1](%3[%c0 to %c1280 for %c1280], %5[%c0 to %c20 for %c20]) : (!stream.resource<transient>{%c1280}, !stream.resource<transient>{%c20}) -> !stream.resource<external>{%c20}
+  // CHECK-NEXT: stream.yield %[[DISPATCH2]]
+  // CHECK-NEXT: } => !stream.timepoint
+  // CHECK-NOT: stream.async.execute
+  // CHECK: %[[READY:.+]] = stream.timepoint.await %[[TIMEPOINT]] => %[[RESULT]]
+  // CHECK-NEXT: util.return %[[READY]]
+  util.return %6 : !stream.resource<external>
+}
@@ -307,8 +307,9 @@ void ConstExprAnalysis::dump() const { print(llvm::dbgs()); }
 //===----------------------------------------------------------------------===//
 
 ConstExprHoistingPolicy::ConstExprHoistingPolicy(
-    const ConstExprAnalysis &analysis, int64_t threshold)
+    const ConstExprAnalysis &analysis, int64_t threshold, int64_t budget)
     : analysis(analysis), constExprMaxSizeIncreaseThreshold(threshold),
+      constExprTotalSizeIncreaseBudget(budget),
       decisions(analysis.allocedConstInfos.size()) {
   for (auto &it : analysis.allocedConstInfos) {
     decisions[it.get()] = {};
@@ -396,8 +397,11 @@ void ConstExprHoistingPolicy::initialize() {
   }
 }
 
-static bool doesHoistingIncreaseSizeSignificantly(
-    const ConstExprAnalysis::ConstValueInfo *info, int64_t threshold) {
+// Returns the number of bytes by which hoisting |info| into a global increases
+// the stored size of the program over that of its roots. Values with dynamic
+// shapes can lead to an unbounded increase and return INT64_MAX.
+static int64_t
+getHoistedSizeIncrease(const ConstExprAnalysis::ConstValueInfo *info) {
   int64_t inSize = 0;
   for (Value root : info->roots) {
     // TODO: Are there any other types we care about here?
@@ -422,7 +426,7 @@ static bool doesHoistingIncreaseSizeSignificantly(
       if (ShapedType::isDynamic(dim)) {
         // Dynamic values can lead to an unbounded increase in size, treat this
         // as a significant increase.
-        return true;
+        return std::numeric_limits<int64_t>::max();
       }
       elementCount *= dim;
     }
@@ -430,7 +434,12 @@ static bool doesHoistingIncreaseSizeSignificantly(
         getRoundedPhysicalStorageSize(elementCount, type.getElementType());
   }
 
-  return outSize > inSize + threshold;
+  return std::max<int64_t>(outSize - inSize, 0);
+}
+
+static bool doesHoistingIncreaseSizeSignificantly(
+    const ConstExprAnalysis::ConstValueInfo *info, int64_t threshold) {
+  return getHoistedSizeIncrease(info) > threshold;
 }
 
 void ConstExprHoistingPolicy::makeInvariantDecision(
@@ -493,7 +502,28 @@ void ConstExprHoistingPolicy::makeDecision(
   }
 
   // Otherwise, we can conditionally enable hoisting (based on cost model, etc).
-  // TODO: Implement further conditions.
+  // Values that grow the program (broadcasts, dequantization, etc) are
+  // recomputed on each use instead of hoisted once the budget is exhausted so
+  // that the hoisted globals do not exceed the memory available on the device.
+  // Values that do not grow the program are always hoisted as they are free
+  // to keep resident once their roots are no longer needed.
+  // TODO: Weigh the size increase against the cost of recomputing the value.
+  if (constExprTotalSizeIncreaseBudget > 0) {
+    int64_t sizeIncrease = getHoistedSizeIncrease(info);
+    if (sizeIncrease > constExprTotalSizeIncreaseBudget - totalSizeIncrease) {
+      LLVM_DEBUG({
+        llvm::dbgs() << "[ConstExprHoistPolicy] over budget by "
+                     << (sizeIncrease - (constExprTotalSizeIncreaseBudget -
+                                         totalSizeIncrease))
+                     << " bytes: ";
+        info->constValue.print(llvm::dbgs(), analysis.getAsmState());
+        llvm::dbgs() << "\n";
+      });
+      decision->disableHoist();
+      return;
+    }
+    totalSizeIncrease += sizeIncrease;
+  }
   decision->enableHoist();
 }
 
@@ -218,7 +218,11 @@ public:
 
   const ConstExprAnalysis &getAnalysis() const { return analysis; }
 
-  ConstExprHoistingPolicy(const ConstExprAnalysis &analysis, int64_t threshold);
+  // |threshold| is the maximum size increase in bytes of any single hoisted
+  // value and |budget| is the maximum total size increase in bytes of all
+  // hoisted values (or 0 for unlimited).
+  ConstExprHoistingPolicy(const ConstExprAnalysis &analysis, int64_t threshold,
+                          int64_t budget = 0);
   void initialize();
   Decision *getDecision(const ConstExprAnalysis::ConstValueInfo *info) {
     return &decisions[info];
@@ -244,6 +248,10 @@ private:
   const ConstExprAnalysis &analysis;
 
   int64_t constExprMaxSizeIncreaseThreshold;
+  int64_t constExprTotalSizeIncreaseBudget;
+
+  // Total size increase in bytes of all values enabled for hoisting so far.
+  int64_t totalSizeIncrease = 0;
 
   // Map of ConstValueInfo * to decision structs. All are allocated at
   // initialization and then the structure is not changed.
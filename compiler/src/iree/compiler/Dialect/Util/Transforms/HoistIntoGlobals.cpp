@@ -61,12 +61,14 @@ public:
   HoistIntoGlobalsPass(const ExprHoistingOptions &options)
       : registerDependentDialectsFn(options.registerDependentDialectsFn) {
     this->maxSizeIncreaseThreshold.setValue(options.maxSizeIncreaseThreshold);
+    this->memoryBudget.setValue(options.memoryBudget);
   }
 
   void runOnOperation() override {
     SymbolTable moduleSymbols(getOperation());
     const auto &constExprs = getAnalysis<ConstExprAnalysis>();
-    ConstExprHoistingPolicy policy(constExprs, this->maxSizeIncreaseThreshold);
+    ConstExprHoistingPolicy policy(constExprs, this->maxSizeIncreaseThreshold,
+                                   this->memoryBudget);
     policy.initialize();
 
     // Print analysis dot graph if requested.
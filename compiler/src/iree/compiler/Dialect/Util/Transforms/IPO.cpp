@@ -43,6 +43,15 @@ static const int kUnassigned = -1;
 // calls so that global folding works better. We could make an op interface
 // for allowing ops to control this maybe? Timepoint joins should be sunk into
 // callees for example.
+//
+// NOTE: loads of immutable globals that are uniform across all call sites (or
+// all return sites) are already sunk into callees (or hoisted into callers) by
+// treating the global symbol as a uniform constant below. Packing globals that
+// are always loaded together into a single aggregate global would not reduce
+// the work at runtime: VM globals are flat slots without aggregate types and
+// each element would still need its own access. Parameters that are packed
+// together at the stream level already share a single resource global once
+// subranges are propagated and co-stored globals are fused.
 struct FuncAnalysis {
   // Function under analysis.
   IREE::Util::FuncOp funcOp;
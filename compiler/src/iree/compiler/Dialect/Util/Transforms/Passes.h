@@ -48,6 +48,10 @@ struct ExprHoistingOptions {
   // Threshold for controlling the maximum allowed increase in the stored size
   // of a single global as a result of hoisting.
   int64_t maxSizeIncreaseThreshold = 2147483647;
+
+  // Budget for the maximum total increase in the stored size of all globals as
+  // a result of hoisting, or 0 for unlimited.
+  int64_t memoryBudget = 0;
 };
 std::unique_ptr<OperationPass<mlir::ModuleOp>>
 createHoistIntoGlobalsPass(const ExprHoistingOptions &options);
@@ -0,0 +1,45 @@
+// RUN: iree-opt --split-input-file --iree-util-hoist-into-globals="max-size-increase-threshold=64 memory-budget=96" --allow-unregistered-dialect %s | FileCheck %s
+
+// The memory-budget option limits the total size increase of all hoisted
+// constant expressions. Each expression here increases the size by 64 bytes
+// and only the first fits within the 96 byte budget. The second is left in
+// place to be recomputed.
+
+// CHECK-LABEL: @hoist_within_memory_budget
+module @hoist_within_memory_budget {
+  // CHECK: util.global private @[[HOISTED:.+]] : tensor<128xi8>
+  // CHECK-NOT: util.global private
+  // CHECK: util.func public @main
+  util.func public @main() -> (tensor<128xi8>, tensor<128xi8>) {
+    %0 = arith.constant dense<0> : tensor<32xi8>
+    %1 = arith.constant dense<1> : tensor<32xi8>
+    // CHECK: %[[LOAD:.+]] = util.global.load immutable @[[HOISTED]]
+    %2 = "iree_unregistered.const_expr"(%0, %1)
+        : (tensor<32xi8>, tensor<32xi8>) -> tensor<128xi8>
+    // CHECK: %[[RECOMPUTED:.+]] = "iree_unregistered.const_expr"
+    %3 = "iree_unregistered.const_expr"(%1, %0)
+        : (tensor<32xi8>, tensor<32xi8>) -> tensor<128xi8>
+    // CHECK: util.return %[[LOAD]], %[[RECOMPUTED]]
+    util.return %2, %3 : tensor<128xi8>, tensor<128xi8>
+  }
+}
+
+// -----
+
+// Expressions that do not increase the size of the program do not count
+// against the budget.
+
+// CHECK-LABEL: @hoist_no_size_increase_outside_memory_budget
+module @hoist_no_size_increase_outside_memory_budget {
+  // CHECK-COUNT-3: util.global private
+  util.func public @main() -> (tensor<64xi8>, tensor<64xi8>, tensor<64xi8>) {
+    %0 = arith.constant dense<0> : tensor<64xi8>
+    %1 = "iree_unregistered.const_expr"(%0)
+        : (tensor<64xi8>) -> tensor<64xi8>
+    %2 = "iree_unregistered.const_expr"(%0)
+        : (tensor<64xi8>) -> tensor<64xi8>
+    %3 = "iree_unregistered.const_expr"(%0)
+        : (tensor<64xi8>) -> tensor<64xi8>
+    util.return %1, %2, %3 : tensor<64xi8>, tensor<64xi8>, tensor<64xi8>
+  }
+}
@@ -220,6 +220,11 @@ LogicalResult RegisterAllocation::recalculate(IREE::VM::FuncOp funcOp) {
            << "failed to caclculate required liveness information";
   }
 
+  // Reset the register windows so that recalculating after the function has
+  // been modified (e.g., after dead values were removed) shrinks the frame
+  // instead of retaining the high-water mark of the previous allocation.
+  maxI32RegisterOrdinal_ = -1;
+  maxRefRegisterOrdinal_ = -1;
   scratchI32RegisterCount_ = 0;
   scratchRefRegisterCount_ = 0;
 
@@ -660,6 +660,84 @@ fuseRootsWithConsumers(MLIRContext *context, ArrayRef<Operation *> roots,
   }
 }
 
+/// Returns true if the producer of `operand` can be fused into `attentionOp`.
+/// Only elementwise producers of the query, key, value or mask (such as rotary
+/// position embeddings or dequantization) are fused. These are recomputed for
+/// each tile of the attention op that reads them, which is cheaper than a
+/// round trip through memory when the attention is memory bound (as is the
+/// case when decoding).
+///
+/// This includes gather-like producers: a paged KV cache is expressed as a
+/// `linalg.generic` that looks up each row of the key/value through a block
+/// table with `tensor.extract`. Fusing the gather means each attention tile
+/// reads its pages directly from the cache and the dense key/value is never
+/// materialized.
+static bool isFusableWithAttention(OpOperand &operand,
+                                   IREE::LinalgExt::AttentionOp attentionOp) {
+  if (!attentionOp.isDpsInput(&operand)) {
+    return false;
+  }
+  auto producer = operand.get().getDefiningOp<linalg::LinalgOp>();
+  if (!producer || producer.getNumLoops() != producer.getNumParallelLoops()) {
+    return false;
+  }
+  AffineMap producerIndexingMap = producer.getIndexingMapMatchingResult(
+      llvm::cast<OpResult>(operand.get()));
+  return producerIndexingMap.isPermutation();
+}
+
+/// Collects into `chainedOps` the ops of a GEMM -> elementwise -> GEMM chain
+/// that ends in the contraction `root`: the contraction producing one of the
+/// inputs of `root` and the single-use elementwise ops in between (such as
+/// bias additions and activations of an MLP). Fusing these into the dispatch
+/// of `root` means the intermediate result is only ever materialized per tile
+/// of `root` instead of being written to memory.
+static void
+collectChainedContractionOps(Operation *root,
+                             llvm::SmallPtrSetImpl<Operation *> &chainedOps) {
+  auto rootOp = dyn_cast<linalg::LinalgOp>(root);
+  if (!rootOp || !linalg::isaContractionOpInterface(rootOp)) {
+    return;
+  }
+  for (OpOperand *operand : rootOp.getDpsInputOperands()) {
+    SmallVector<Operation *> chain;
+    Value value = operand->get();
+    while (value.hasOneUse()) {
+      auto producer = value.getDefiningOp<linalg::LinalgOp>();
+      if (!producer || producer.getNumDpsInits() != 1 ||
+          IREE::LinalgExt::isBitExtendOp(producer)) {
+        break;
+      }
+      if (linalg::isaContractionOpInterface(producer)) {
+        chainedOps.insert(chain.begin(), chain.end());
+        chainedOps.insert(producer);
+        break;
+      }
+      if (!linalg::isElementwise(producer) ||
+          !producer.getIndexingMapMatchingResult(cast<OpResult>(value))
+               .isIdentity()) {
+        break;
+      }
+      // Follow the only input that is produced by another Linalg op. Other
+      // inputs, like broadcasted biases, are left to the default heuristics.
+      SmallVector<Value> candidates;
+      for (OpOperand *input : producer.getDpsInputOperands()) {
+        auto inputProducer = input->get().getDefiningOp<linalg::LinalgOp>();
+        if (!inputProducer || isa<linalg::FillOp>(inputProducer) ||
+            !producer.getMatchingIndexingMap(input).isIdentity()) {
+          continue;
+        }
+        candidates.push_back(input->get());
+      }
+      if (candidates.size() != 1) {
+        break;
+      }
+      chain.push_back(producer);
+      value = candidates.front();
+    }
+  }
+}
+
 /// Method to check if the consumer of a use can be fused with its producer.
 static bool
 isFusableWithProducer(OpOperand &operand,
@@ -680,9 +758,11 @@ isFusableWithProducer(OpOperand &operand,
     return true;
   }
 
-  // Don't fuse attention with it's producer
-  if (isa<IREE::LinalgExt::AttentionOp>(consumer)) {
-    return false;
+  // Attention is only fused with elementwise producers of its inputs and only
+  // when explicitly enabled.
+  if (auto attentionOp = dyn_cast<IREE::LinalgExt::AttentionOp>(consumer)) {
+    return options.fuseAttentionWithProducers &&
+           isFusableWithAttention(operand, attentionOp);
   }
 
   if (isPackLikeOp(consumer)) {
@@ -731,6 +811,10 @@ fuseRootsWithProducers(MLIRContext *context, Operation *root, unsigned groupNum,
   SmallVector<Operation *> worklist;
   worklist.push_back(root);
   llvm::SmallBitVector rootOuterParallelLoops = getOuterParallelLoops(root);
+  llvm::SmallPtrSet<Operation *, 4> chainedOps;
+  if (options.fuseChainedMatmuls) {
+    collectChainedContractionOps(root, chainedOps);
+  }
   while (!worklist.empty()) {
     Operation *candidate = worklist.pop_back_val();
     for (OpOperand &operand : candidate->getOpOperands()) {
@@ -748,7 +832,8 @@ fuseRootsWithProducers(MLIRContext *context, Operation *root, unsigned groupNum,
       if (!fusableUse || fusableUse.value()->getOwner() != candidate)
         continue;
 
-      if (!isFusableWithProducer(operand, rootOuterParallelLoops, options)) {
+      if (!chainedOps.contains(producer) &&
+          !isFusableWithProducer(operand, rootOuterParallelLoops, options)) {
         continue;
       }
 
@@ -946,8 +1031,9 @@ void FormDispatchRegionsPass::runOnOperation() {
   mlir::FunctionOpInterface funcOp = getOperation();
   DominanceInfo const &dominanceInfo = getAnalysis<DominanceInfo>();
   TensorDimTrackingRewriter rewriter(funcOp);
-  FormDispatchRegionsPassOptions options{aggressiveFusion, fusePadWithConsumers,
-                                         fusePadWithProducers};
+  FormDispatchRegionsPassOptions options{
+      aggressiveFusion, fusePadWithConsumers, fusePadWithProducers,
+      fuseAttentionWithProducers, fuseChainedMatmuls};
   if (failed(createFusionGroups(rewriter, funcOp, dominanceInfo, options))) {
     funcOp->emitOpError("failed to create fusion groups");
     return signalPassFailure();
@@ -0,0 +1,230 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/DispatchCreation/FusionUtils.h"
+#include "iree/compiler/DispatchCreation/Passes.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/IR/LinalgInterfaces.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Dominance.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Pass/Pass.h"
+
+#define DEBUG_TYPE "iree-dispatch-creation-fuse-horizontal-generic-ops"
+
+namespace mlir::iree_compiler::DispatchCreation {
+
+#define GEN_PASS_DEF_FUSEHORIZONTALGENERICOPSPASS
+#include "iree/compiler/DispatchCreation/Passes.h.inc"
+
+namespace {
+
+struct FuseHorizontalGenericOpsPass final
+    : public impl::FuseHorizontalGenericOpsPassBase<
+          FuseHorizontalGenericOpsPass> {
+  using Base::Base;
+  void runOnOperation() override;
+};
+
+} // namespace
+
+/// Returns true if `op` is a compute op that dispatch region formation would
+/// fuse with a producer or consumer. Fills are excluded as they are cloned
+/// into whichever dispatch consumes them.
+static bool isFusableComputeOp(Operation *op) {
+  return isa_and_nonnull<linalg::LinalgOp>(op) && !isa<linalg::FillOp>(op);
+}
+
+/// Returns true if `genericOp` can be horizontally fused with other generic
+/// ops. Only ops that would otherwise form a dispatch on their own are
+/// candidates: ops with compute producers or consumers in the same block are
+/// left alone so that producer/consumer fusion is not pessimized.
+static bool isHorizontalFusionCandidate(linalg::GenericOp genericOp) {
+  if (!genericOp.hasPureTensorSemantics()) {
+    return false;
+  }
+  if (linalg::isaContractionOpInterface(genericOp) ||
+      linalg::isaConvolutionOpInterface(genericOp)) {
+    return false;
+  }
+  if (llvm::any_of(genericOp.getStaticLoopRanges(), ShapedType::isDynamic)) {
+    return false;
+  }
+  Block *block = genericOp->getBlock();
+  for (Value operand : genericOp->getOperands()) {
+    Operation *producerOp = operand.getDefiningOp();
+    if (producerOp && producerOp->getBlock() == block &&
+        isFusableComputeOp(producerOp)) {
+      return false;
+    }
+  }
+  for (Operation *userOp : genericOp->getUsers()) {
+    if (userOp->getBlock() == block && isFusableComputeOp(userOp)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+/// Returns true if `lhs` and `rhs` have the same iteration space and can share
+/// a single loop nest.
+static bool haveSameIterationSpace(linalg::GenericOp lhs,
+                                   linalg::GenericOp rhs) {
+  return lhs.getIteratorTypesArray() == rhs.getIteratorTypesArray() &&
+         lhs.getStaticLoopRanges() == rhs.getStaticLoopRanges();
+}
+
+/// Fuses the independent generic ops in `fusionGroup` into a single generic op
+/// with the concatenation of their operands and results. For example
+/// ```
+/// %0 = linalg.generic {...} ins(%a : tensor<8x16xf32>) outs(%e0) {...}
+/// %1 = linalg.generic {...} ins(%b : tensor<8x16xf16>) outs(%e1) {...}
+/// ```
+///
+/// is rewritten to
+///
+/// ```
+/// %01:2 = linalg.generic {...}
+///     ins(%a, %b : tensor<8x16xf32>, tensor<8x16xf16>) outs(%e0, %e1) {
+///   <body of %0>
+///   <body of %1>
+///   linalg.yield <yield of %0>, <yield of %1>
+/// }
+/// ```
+///
+/// All ops share the same iteration space and the resulting op is tiled and
+/// distributed as one, producing one dispatch instead of one per op.
+static LogicalResult
+fuseGroup(RewriterBase &rewriter, ArrayRef<linalg::GenericOp> fusionGroup,
+          DominanceInfo &dominanceInfo) {
+  linalg::GenericOp seedOp = fusionGroup.front();
+  OpBuilder::InsertionGuard g(rewriter);
+  rewriter.setInsertionPoint(seedOp);
+  if (failed(moveOperandDefs(rewriter, fusionGroup, seedOp, dominanceInfo))) {
+    return seedOp.emitOpError("failed to re-order operand definitions");
+  }
+
+  SmallVector<Value> inputs;
+  SmallVector<Value> inits;
+  SmallVector<AffineMap> inputMaps;
+  SmallVector<AffineMap> initMaps;
+  SmallVector<Type> resultTypes;
+  SmallVector<Location> locs;
+  for (auto genericOp : fusionGroup) {
+    for (OpOperand *operand : genericOp.getDpsInputOperands()) {
+      inputs.push_back(operand->get());
+      inputMaps.push_back(genericOp.getMatchingIndexingMap(operand));
+    }
+    for (OpOperand &operand : genericOp.getDpsInitsMutable()) {
+      inits.push_back(operand.get());
+      initMaps.push_back(genericOp.getMatchingIndexingMap(&operand));
+    }
+    llvm::append_range(resultTypes, genericOp->getResultTypes());
+    locs.push_back(genericOp.getLoc());
+  }
+  SmallVector<AffineMap> indexingMaps = std::move(inputMaps);
+  llvm::append_range(indexingMaps, initMaps);
+
+  auto fusedOp = rewriter.create<linalg::GenericOp>(
+      rewriter.getFusedLoc(locs), resultTypes, inputs, inits, indexingMaps,
+      seedOp.getIteratorTypesArray(),
+      [&](OpBuilder &builder, Location loc, ValueRange blockArgs) {
+        ValueRange inputArgs = blockArgs.take_front(inputs.size());
+        ValueRange initArgs = blockArgs.drop_front(inputs.size());
+        SmallVector<Value> yieldedValues;
+        for (auto genericOp : fusionGroup) {
+          Block *body = genericOp.getBody();
+          int64_t numInputs = genericOp.getNumDpsInputs();
+          int64_t numInits = genericOp.getNumDpsInits();
+          IRMapping mapping;
+          mapping.map(body->getArguments().take_front(numInputs),
+                      inputArgs.take_front(numInputs));
+          mapping.map(body->getArguments().drop_front(numInputs),
+                      initArgs.take_front(numInits));
+          inputArgs = inputArgs.drop_front(numInputs);
+          initArgs = initArgs.drop_front(numInits);
+          for (Operation &op : body->without_terminator()) {
+            builder.clone(op, mapping);
+          }
+          for (Value yieldedValue : body->getTerminator()->getOperands()) {
+            yieldedValues.push_back(mapping.lookupOrDefault(yieldedValue));
+          }
+        }
+        builder.create<linalg::YieldOp>(loc, yieldedValues);
+      });
+
+  ValueRange fusedResults = fusedOp->getResults();
+  for (auto genericOp : fusionGroup) {
+    rewriter.replaceOp(genericOp,
+                       fusedResults.take_front(genericOp->getNumResults()));
+    fusedResults = fusedResults.drop_front(genericOp->getNumResults());
+  }
+  return success();
+}
+
+void FuseHorizontalGenericOpsPass::runOnOperation() {
+  DominanceInfo dominanceInfo(getOperation());
+
+  // Greedily group candidates in program order. Each group is seeded by the
+  // first ungrouped candidate and extended with later candidates in the same
+  // block that share the iteration space and do not depend on the group.
+  SmallVector<SmallVector<linalg::GenericOp>> fusionGroups;
+  llvm::SmallDenseSet<Operation *> groupedOperations;
+  getOperation()->walk([&](Block *block) {
+    SmallVector<linalg::GenericOp> candidates;
+    for (auto genericOp : block->getOps<linalg::GenericOp>()) {
+      if (isHorizontalFusionCandidate(genericOp)) {
+        candidates.push_back(genericOp);
+      }
+    }
+    for (auto [seedIndex, seedOp] : llvm::enumerate(candidates)) {
+      if (groupedOperations.contains(seedOp)) {
+        continue;
+      }
+      llvm::SetVector<Operation *> allOps;
+      allOps.insert(seedOp);
+      SmallVector<linalg::GenericOp> fusionGroup = {seedOp};
+      for (auto candidateOp : ArrayRef(candidates).drop_front(seedIndex + 1)) {
+        if (fusionGroup.size() >= fusionLimit) {
+          break;
+        }
+        if (groupedOperations.contains(candidateOp) ||
+            !haveSameIterationSpace(seedOp, candidateOp) ||
+            !isHorizontalToGroup(candidateOp, allOps, dominanceInfo, seedOp)) {
+          continue;
+        }
+        allOps.insert(candidateOp);
+        fusionGroup.push_back(candidateOp);
+      }
+      if (fusionGroup.size() < 2) {
+        continue;
+      }
+      LLVM_DEBUG(llvm::dbgs() << "horizontally fusing " << fusionGroup.size()
+                              << " generic ops at " << seedOp.getLoc()
+                              << "\n");
+      groupedOperations.insert(allOps.begin(), allOps.end());
+      fusionGroups.push_back(std::move(fusionGroup));
+    }
+  });
+  if (fusionGroups.empty()) {
+    return;
+  }
+
+  IRRewriter rewriter(&getContext());
+  for (auto &fusionGroup : fusionGroups) {
+    ++numFusionGroups;
+    numFusedOps += fusionGroup.size();
+    if (failed(fuseGroup(rewriter, fusionGroup, dominanceInfo))) {
+      return signalPassFailure();
+    }
+  }
+}
+
+} // namespace mlir::iree_compiler::DispatchCreation
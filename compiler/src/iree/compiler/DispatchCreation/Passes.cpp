@@ -55,6 +55,20 @@ static llvm::cl::opt<int> clPadFactor(
                    "iree-dispatch-creation-experimental-data-tiling."),
     llvm::cl::init(32));
 
+static llvm::cl::opt<bool> clEnableFuseAttentionWithProducers(
+    "iree-dispatch-creation-enable-fuse-attention-with-producers",
+    llvm::cl::desc("Enable fusing elementwise producers of the query, key and "
+                   "value (such as rotary position embeddings) into attention "
+                   "dispatches."),
+    llvm::cl::init(false));
+
+static llvm::cl::opt<bool> clEnableFuseChainedMatmuls(
+    "iree-dispatch-creation-enable-fuse-chained-matmuls",
+    llvm::cl::desc("Enable fusing chains of contractions with elementwise ops "
+                   "in between (e.g. GEMM -> activation -> GEMM in MLPs) into "
+                   "a single dispatch."),
+    llvm::cl::init(false));
+
 static llvm::cl::opt<bool> clEnablePadHandling(
     "iree-flow-enable-pad-handling",
     llvm::cl::desc("Enable native handling of tensor.pad operations."),
@@ -66,6 +80,12 @@ static llvm::cl::opt<bool> clEnableFuseHorizontalContractions(
         "Enables horizontal fusion of contractions with one common operand"),
     llvm::cl::init(false));
 
+static llvm::cl::opt<bool> clEnableFuseHorizontalGenericOps(
+    "iree-dispatch-creation-enable-fuse-horizontal-generic-ops",
+    llvm::cl::desc("Enables horizontal fusion of independent generic ops with "
+                   "the same iteration space into one dispatch"),
+    llvm::cl::init(false));
+
 static llvm::cl::opt<bool> clCollapseReductionDims(
     "iree-dispatch-creation-collapse-reduction-dims",
     llvm::cl::desc("Enable collapsing of reduction dims"),
@@ -200,6 +220,16 @@ void addDispatchRegionCreationPreprocessingPasses(OpPassManager &passManager) {
       //        - help with dispatch region formation.
       //        - move reduction iterators to be innermost.
       .addPass(DispatchCreation::createTransposeGenericOpsPass);
+
+  // 7. Horizontally fuse independent generic ops that would otherwise each
+  //    form their own small dispatch. This runs after transposition so that
+  //    ops normalized to the same iteration space can be grouped.
+  if (clEnableFuseHorizontalGenericOps) {
+    FunctionLikeNest(passManager)
+        .addPass(createFuseHorizontalGenericOpsPass)
+        .addPass(IREE::Flow::createCanonicalizerPass)
+        .addPass(mlir::createCSEPass);
+  }
 }
 
 // Pipeline to first create `flow.dispatch.region` ops and then lower to
@@ -227,7 +257,9 @@ static void addDispatchRegionCreationPasses(OpPassManager &passManager) {
             FormDispatchRegionsPassOptions{
                 clEnableAggressiveFusion,
                 clEnableFusePaddingIntoLinalgConsumerOps,
-                clEnableFusePaddingIntoLinalgProducerOps});
+                clEnableFusePaddingIntoLinalgProducerOps,
+                clEnableFuseAttentionWithProducers,
+                clEnableFuseChainedMatmuls});
       })
       // Clone all producers into the dispatch region to perpare for being
       // isolated from above. This enables running additional transformations
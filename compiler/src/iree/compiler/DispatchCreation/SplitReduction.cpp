@@ -10,11 +10,19 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include "iree/compiler/Dialect/LinalgExt/IR/LinalgExtOps.h"
 #include "iree/compiler/Dialect/LinalgExt/Transforms/Passes.h"
+#include "iree/compiler/Dialect/LinalgExt/Utils/IndexingUtils.h"
 #include "iree/compiler/DispatchCreation/Passes.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Arith/Utils/Utils.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/StaticValueUtils.h"
+#include "mlir/IR/IRMapping.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
 namespace mlir::iree_compiler::DispatchCreation {
@@ -32,6 +40,743 @@ static llvm::cl::list<int64_t> topkSplitReductionRatio(
     llvm::cl::desc("comma separated list of split ratios"),
     llvm::cl::CommaSeparated);
 
+static llvm::cl::opt<bool> topkAutoSplitReduction(
+    "iree-dispatch-creation-topk-auto-split-reduction",
+    llvm::cl::desc("Automatically splits large top-k reductions into a "
+                   "parallel partial top-k followed by a merge when no "
+                   "explicit split ratios are provided"),
+    llvm::cl::init(true));
+
+// Top-k reductions smaller than this are left as a single serial reduction.
+static constexpr int64_t kTopkAutoSplitMinReductionSize = 8192;
+// Minimum number of elements each parallel partial top-k reduces over. Below
+// this the merge step dominates.
+static constexpr int64_t kTopkAutoSplitMinChunkSize = 1024;
+// Maximum number of parallel partial top-k reductions.
+static constexpr int64_t kTopkAutoSplitMaxRatio = 128;
+
+// Returns a split ratio for |topkOp| that divides its reduction dimension into
+// enough parallel partial reductions to fill a device or 0 if the op should
+// not be split.
+static int64_t getAutoTopkSplitRatio(IREE::LinalgExt::TopkOp topkOp) {
+  int64_t dim = topkOp.getDimension();
+  ShapedType inputType = topkOp.getInputType();
+  ShapedType outputType = cast<ShapedType>(topkOp.outputValues().getType());
+  if (inputType.isDynamicDim(dim) || outputType.isDynamicDim(dim)) {
+    return 0;
+  }
+  int64_t reductionSize = inputType.getDimSize(dim);
+  int64_t k = outputType.getDimSize(dim);
+  if (reductionSize < kTopkAutoSplitMinReductionSize) {
+    return 0;
+  }
+  // Each chunk must produce k results and should be large enough that the
+  // merge of ratio * k candidates stays cheap relative to the first phase.
+  int64_t minChunkSize = std::max(kTopkAutoSplitMinChunkSize, k * 8);
+  int64_t maxRatio =
+      std::min(kTopkAutoSplitMaxRatio, reductionSize / minChunkSize);
+  for (int64_t ratio = maxRatio; ratio > 1; --ratio) {
+    if (reductionSize % ratio == 0) {
+      return ratio;
+    }
+  }
+  return 0;
+}
+
+static llvm::cl::opt<bool> scanAutoSplitReduction(
+    "iree-dispatch-creation-scan-auto-split-reduction",
+    llvm::cl::desc("Automatically splits long inclusive scans into a chunked "
+                   "scan, a scan of the chunk totals and a combine so that the "
+                   "scan dimension can be distributed"),
+    llvm::cl::init(true));
+
+// Scans shorter than this are left as a single serial scan.
+static constexpr int64_t kScanAutoSplitMinSize = 4096;
+// Minimum number of elements scanned serially within each chunk.
+static constexpr int64_t kScanAutoSplitMinChunkSize = 512;
+// Maximum number of chunks the scan dimension is split into.
+static constexpr int64_t kScanAutoSplitMaxRatio = 64;
+
+// Returns the number of chunks to split the scan dimension of |scanOp| into or
+// 0 if the op should not be split.
+static int64_t getAutoScanSplitRatio(IREE::LinalgExt::ScanOp scanOp) {
+  // Only inclusive scans are handled: exclusive scans have an accumulator that
+  // does not include the last element and would need an identity value.
+  if (!scanOp.getInclusive() || scanOp.getInputs().size() != 1 ||
+      scanOp.getOutputs().size() != 2 || !scanOp.hasPureTensorSemantics()) {
+    return 0;
+  }
+  ShapedType inputType = scanOp.getOperandType();
+  if (!inputType.hasStaticShape() ||
+      getElementTypeOrSelf(scanOp.getOutput().getType()) !=
+          inputType.getElementType()) {
+    return 0;
+  }
+  int64_t scanSize = inputType.getDimSize(scanOp.getDimension());
+  if (scanSize < kScanAutoSplitMinSize) {
+    return 0;
+  }
+  int64_t maxRatio = std::min(kScanAutoSplitMaxRatio,
+                              scanSize / kScanAutoSplitMinChunkSize);
+  for (int64_t ratio = maxRatio; ratio > 1; --ratio) {
+    if (scanSize % ratio == 0) {
+      return ratio;
+    }
+  }
+  return 0;
+}
+
+// Splits the scan dimension of |scanOp| of size N into |ratio| chunks of size
+// C and computes the scan in three phases that each parallelize across chunks:
+//   1. an inclusive scan within each chunk (also producing chunk totals);
+//   2. an inclusive scan of the totals of all but the last chunk;
+//   3. a combine of the prefix of all preceding chunks into chunks 1..ratio-1.
+// The combiner region is assumed to be associative, which is already required
+// for the scan to be tiled.
+static LogicalResult splitScanReduction(RewriterBase &rewriter,
+                                        IREE::LinalgExt::ScanOp scanOp,
+                                        int64_t ratio) {
+  Location loc = scanOp.getLoc();
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(scanOp);
+
+  Value input = scanOp.getInput();
+  auto inputType = cast<RankedTensorType>(input.getType());
+  Type elementType = inputType.getElementType();
+  int64_t rank = inputType.getRank();
+  int64_t dim = scanOp.getDimension();
+  int64_t chunkSize = inputType.getDimSize(dim) / ratio;
+
+  // [..., N, ...] -> [..., ratio, C, ...]
+  SmallVector<int64_t> expandedShape(inputType.getShape());
+  expandedShape[dim] = ratio;
+  expandedShape.insert(expandedShape.begin() + dim + 1, chunkSize);
+  SmallVector<ReassociationIndices> reassociation;
+  for (int64_t i = 0; i < rank; ++i) {
+    if (i < dim) {
+      reassociation.push_back({i});
+    } else if (i == dim) {
+      reassociation.push_back({i, i + 1});
+    } else {
+      reassociation.push_back({i + 1});
+    }
+  }
+  auto expandedType = RankedTensorType::get(expandedShape, elementType);
+  Value expandedInput = rewriter.create<tensor::ExpandShapeOp>(
+      loc, expandedType, input, reassociation);
+
+  // Phase 1: scan within each chunk. The accumulator holds the chunk totals.
+  SmallVector<int64_t> totalsShape(inputType.getShape());
+  totalsShape[dim] = ratio;
+  auto cloneScan = [&](Value scanInput, ArrayRef<int64_t> shape,
+                       ArrayRef<int64_t> accShape, int64_t scanDim) {
+    Value outputInit =
+        rewriter.create<tensor::EmptyOp>(loc, shape, elementType);
+    Value accInit =
+        rewriter.create<tensor::EmptyOp>(loc, accShape, elementType);
+    auto newScanOp = rewriter.create<IREE::LinalgExt::ScanOp>(
+        loc, TypeRange{outputInit.getType(), accInit.getType()},
+        ValueRange{scanInput}, ValueRange{outputInit, accInit},
+        rewriter.getI64IntegerAttr(scanDim), rewriter.getBoolAttr(true));
+    rewriter.cloneRegionBefore(scanOp.getRegion(), newScanOp.getRegion(),
+                               newScanOp.getRegion().end());
+    return newScanOp;
+  };
+  auto chunkScanOp = cloneScan(expandedInput, expandedShape, totalsShape,
+                               /*scanDim=*/dim + 1);
+  Value chunkScan = chunkScanOp.getResult(0);
+  Value chunkTotals = chunkScanOp.getResult(1);
+
+  // Phase 2: inclusive scan of the totals of chunks 0..ratio-2 giving the
+  // prefix that must be combined into chunks 1..ratio-1.
+  SmallVector<OpFoldResult> zeroOffsets(rank, rewriter.getIndexAttr(0));
+  SmallVector<OpFoldResult> unitStrides(rank, rewriter.getIndexAttr(1));
+  SmallVector<int64_t> prefixShape = totalsShape;
+  prefixShape[dim] = ratio - 1;
+  Value leadingTotals = rewriter.create<tensor::ExtractSliceOp>(
+      loc, chunkTotals, zeroOffsets,
+      getAsIndexOpFoldResult(rewriter.getContext(), prefixShape), unitStrides);
+  SmallVector<int64_t> prefixAccShape = prefixShape;
+  prefixAccShape.erase(prefixAccShape.begin() + dim);
+  Value prefix =
+      cloneScan(leadingTotals, prefixShape, prefixAccShape, dim).getResult(0);
+
+  // Phase 3: combine the prefix into chunks 1..ratio-1.
+  SmallVector<OpFoldResult> expandedOffsets(rank + 1,
+                                            rewriter.getIndexAttr(0));
+  expandedOffsets[dim] = rewriter.getIndexAttr(1);
+  SmallVector<OpFoldResult> expandedStrides(rank + 1,
+                                            rewriter.getIndexAttr(1));
+  SmallVector<int64_t> trailingShape = expandedShape;
+  trailingShape[dim] = ratio - 1;
+  Value trailingChunks = rewriter.create<tensor::ExtractSliceOp>(
+      loc, chunkScan, expandedOffsets,
+      getAsIndexOpFoldResult(rewriter.getContext(), trailingShape),
+      expandedStrides);
+  SmallVector<AffineExpr> prefixExprs;
+  for (int64_t i = 0; i < rank + 1; ++i) {
+    if (i != dim + 1) {
+      prefixExprs.push_back(rewriter.getAffineDimExpr(i));
+    }
+  }
+  auto identityMap = rewriter.getMultiDimIdentityMap(rank + 1);
+  SmallVector<AffineMap> indexingMaps = {
+      AffineMap::get(rank + 1, 0, prefixExprs, rewriter.getContext()),
+      identityMap, identityMap};
+  SmallVector<utils::IteratorType> iteratorTypes(
+      rank + 1, utils::IteratorType::parallel);
+  Value combineInit =
+      rewriter.create<tensor::EmptyOp>(loc, trailingShape, elementType);
+  Block &combinerBlock = scanOp.getRegion().front();
+  auto combineOp = rewriter.create<linalg::GenericOp>(
+      loc, combineInit.getType(), ValueRange{prefix, trailingChunks},
+      ValueRange{combineInit}, indexingMaps, iteratorTypes,
+      [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        IRMapping mapping;
+        mapping.map(combinerBlock.getArgument(0), args[0]);
+        mapping.map(combinerBlock.getArgument(1), args[1]);
+        for (auto &op : combinerBlock.without_terminator()) {
+          b.clone(op, mapping);
+        }
+        b.create<linalg::YieldOp>(
+            nestedLoc, mapping.lookupOrDefault(
+                           combinerBlock.getTerminator()->getOperand(0)));
+      });
+  Value combined = rewriter.create<tensor::InsertSliceOp>(
+      loc, combineOp.getResult(0), chunkScan, expandedOffsets,
+      getAsIndexOpFoldResult(rewriter.getContext(), trailingShape),
+      expandedStrides);
+  Value result = rewriter.create<tensor::CollapseShapeOp>(
+      loc, inputType, combined, reassociation);
+
+  // The accumulator result is the last element along the scan dimension.
+  Value accumulator;
+  if (!scanOp.getResult(1).use_empty()) {
+    SmallVector<OpFoldResult> lastOffsets(rank, rewriter.getIndexAttr(0));
+    lastOffsets[dim] = rewriter.getIndexAttr(inputType.getDimSize(dim) - 1);
+    SmallVector<OpFoldResult> lastSizes =
+        getAsIndexOpFoldResult(rewriter.getContext(), inputType.getShape());
+    lastSizes[dim] = rewriter.getIndexAttr(1);
+    auto accType = cast<RankedTensorType>(scanOp.getResult(1).getType());
+    accumulator = rewriter.create<tensor::ExtractSliceOp>(
+        loc, accType, result, lastOffsets, lastSizes, unitStrides);
+  }
+
+  rewriter.replaceAllUsesWith(scanOp.getResult(0), result);
+  if (accumulator) {
+    rewriter.replaceAllUsesWith(scanOp.getResult(1), accumulator);
+  }
+  rewriter.eraseOp(scanOp);
+  return success();
+}
+
+static llvm::cl::opt<bool> attentionAutoSplitKV(
+    "iree-dispatch-creation-attention-auto-split-kv",
+    llvm::cl::desc("Automatically splits the key/value sequence of attention "
+                   "ops with few queries and a long key/value sequence (e.g. "
+                   "decode) into parallel partial attentions followed by a "
+                   "merge of their partial results"),
+    llvm::cl::init(true));
+
+// Attention ops with a shorter key/value sequence are left as-is.
+static constexpr int64_t kAttentionSplitKVMinKVLength = 4096;
+// Minimum ratio of key/value sequence length to the number of queries. Below
+// this the query dimension already provides enough parallelism.
+static constexpr int64_t kAttentionSplitKVMinKVToQueryRatio = 256;
+// Minimum key/value sequence length processed by each partial attention.
+static constexpr int64_t kAttentionSplitKVMinChunkSize = 512;
+// Maximum number of partial attentions.
+static constexpr int64_t kAttentionSplitKVMaxRatio = 64;
+
+// Returns the number of partitions to split the key/value sequence (K2) of
+// |attnOp| into or 0 if the op should not be split.
+static int64_t
+getAutoAttentionSplitKVRatio(IREE::LinalgExt::AttentionOp attnOp) {
+  if (!attnOp.hasPureTensorSemantics() || attnOp->getNumResults() != 1) {
+    return 0;
+  }
+  FailureOr<IREE::LinalgExt::AttentionOpDetail> opInfo =
+      IREE::LinalgExt::AttentionOpDetail::get(
+          attnOp.getQueryMap(), attnOp.getKeyMap(), attnOp.getValueMap(),
+          attnOp.getOutputMap());
+  if (failed(opInfo) || opInfo->getK2Dims().size() != 1) {
+    return 0;
+  }
+  FailureOr<SmallVector<int64_t>> bounds = attnOp.getStaticLoopRanges();
+  if (failed(bounds)) {
+    return 0;
+  }
+  int64_t kvLength = (*bounds)[opInfo->getK2Dims().front()];
+  if (ShapedType::isDynamic(kvLength) ||
+      kvLength < kAttentionSplitKVMinKVLength) {
+    return 0;
+  }
+  int64_t numQueries = 1;
+  for (int64_t dim : opInfo->getMDims()) {
+    if (ShapedType::isDynamic((*bounds)[dim])) {
+      return 0;
+    }
+    numQueries *= (*bounds)[dim];
+  }
+  if (numQueries * kAttentionSplitKVMinKVToQueryRatio > kvLength) {
+    return 0;
+  }
+  int64_t maxRatio = std::min(kAttentionSplitKVMaxRatio,
+                              kvLength / kAttentionSplitKVMinChunkSize);
+  for (int64_t ratio = maxRatio; ratio > 1; --ratio) {
+    if (kvLength % ratio == 0) {
+      return ratio;
+    }
+  }
+  return 0;
+}
+
+// Splits the key/value sequence (K2) dimension of |attnOp| into |ratio|
+// partitions (flash-decoding). A new outer parallel dimension S indexes the
+// partitions of K, V and the mask so that each partition is computed by an
+// online_attention producing its unnormalized result along with its running
+// max and sum:
+//   acc[s], max[s], sum[s] = online_attention(Q, K[s], V[s])
+// A second op merges the partial results with the same online softmax update
+// used within a partition:
+//   m = max_s(max[s])
+//   O = sum_s(acc[s] * exp2(max[s] - m)) / sum_s(sum[s] * exp2(max[s] - m))
+// S becomes a batch dimension of the online_attention so it is distributed
+// like any other batch dimension by codegen.
+static LogicalResult splitAttentionKV(RewriterBase &rewriter,
+                                      IREE::LinalgExt::AttentionOp attnOp,
+                                      int64_t ratio) {
+  Location loc = attnOp.getLoc();
+  MLIRContext *context = rewriter.getContext();
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(attnOp);
+
+  auto opInfo = IREE::LinalgExt::AttentionOpDetail::get(
+                    attnOp.getQueryMap(), attnOp.getKeyMap(),
+                    attnOp.getValueMap(), attnOp.getOutputMap())
+                    .value();
+  int64_t k2Dim = opInfo.getK2Dims().front();
+  int64_t domainRank = opInfo.getDomainRank();
+  AffineExpr splitExpr = rewriter.getAffineDimExpr(0);
+  AffineExpr k2Expr = rewriter.getAffineDimExpr(k2Dim + 1);
+
+  // Operands indexed by K2 are expanded [..., K2, ...] -> [..., S, K2/S, ...]
+  // with S indexed by the new leading loop dimension.
+  auto splitOperand = [&](Value operand,
+                          AffineMap map) -> std::pair<Value, AffineMap> {
+    AffineMap shiftedMap = map.shiftDims(1);
+    std::optional<unsigned> pos = shiftedMap.getResultPosition(k2Expr);
+    if (!pos) {
+      return {operand, shiftedMap};
+    }
+    auto type = cast<RankedTensorType>(operand.getType());
+    SmallVector<int64_t> expandedShape(type.getShape());
+    expandedShape[*pos] = ratio;
+    expandedShape.insert(expandedShape.begin() + *pos + 1,
+                         type.getDimSize(*pos) / ratio);
+    SmallVector<ReassociationIndices> reassociation;
+    for (int64_t i = 0, e = type.getRank(); i < e; ++i) {
+      if (i < *pos) {
+        reassociation.push_back({i});
+      } else if (i == *pos) {
+        reassociation.push_back({i, i + 1});
+      } else {
+        reassociation.push_back({i + 1});
+      }
+    }
+    Value expanded = rewriter.create<tensor::ExpandShapeOp>(
+        loc, RankedTensorType::get(expandedShape, type.getElementType()),
+        operand, reassociation);
+    SmallVector<AffineExpr> exprs(shiftedMap.getResults());
+    exprs.insert(exprs.begin() + *pos, splitExpr);
+    return {expanded, AffineMap::get(domainRank + 1, 0, exprs, context)};
+  };
+  auto [key, keyMap] = splitOperand(attnOp.getKey(), attnOp.getKeyMap());
+  auto [value, valueMap] =
+      splitOperand(attnOp.getValue(), attnOp.getValueMap());
+  Value mask;
+  AffineMap maskMap;
+  if (attnOp.getMask()) {
+    std::tie(mask, maskMap) =
+        splitOperand(attnOp.getMask(), *attnOp.getMaskMap());
+  }
+
+  // The partial results are indexed by S followed by the output dimensions.
+  // The max and sum drop the N dimensions of the output.
+  AffineMap outputMap = attnOp.getOutputMap();
+  SmallVector<OpFoldResult> outputSizes =
+      tensor::getMixedSizes(rewriter, loc, attnOp.getOutput());
+  llvm::SmallDenseSet<int64_t> nDims(opInfo.getNDims().begin(),
+                                     opInfo.getNDims().end());
+  SmallVector<int64_t> rowPositions;
+  for (auto [i, expr] : llvm::enumerate(outputMap.getResults())) {
+    if (!nDims.contains(cast<AffineDimExpr>(expr).getPosition())) {
+      rowPositions.push_back(i);
+    }
+  }
+  SmallVector<AffineExpr> accExprs = {splitExpr};
+  llvm::append_range(accExprs, outputMap.shiftDims(1).getResults());
+  SmallVector<AffineExpr> rowExprs = {splitExpr};
+  SmallVector<OpFoldResult> accSizes = {rewriter.getIndexAttr(ratio)};
+  llvm::append_range(accSizes, outputSizes);
+  SmallVector<OpFoldResult> rowSizes = {rewriter.getIndexAttr(ratio)};
+  for (int64_t pos : rowPositions) {
+    rowExprs.push_back(accExprs[pos + 1]);
+    rowSizes.push_back(outputSizes[pos]);
+  }
+  AffineMap accMap = AffineMap::get(domainRank + 1, 0, accExprs, context);
+  AffineMap rowMap = AffineMap::get(domainRank + 1, 0, rowExprs, context);
+
+  Type f32Type = rewriter.getF32Type();
+  Value zero = arith::getIdentityValue(arith::AtomicRMWKind::addf, f32Type,
+                                       rewriter, loc);
+  Value lowest =
+      arith::getIdentityValue(arith::AtomicRMWKind::maximumf, f32Type,
+                              rewriter, loc, /*useOnlyFiniteValue=*/true);
+  auto createFill = [&](ArrayRef<OpFoldResult> sizes, Value fillValue) {
+    Value empty = rewriter.create<tensor::EmptyOp>(loc, sizes, f32Type);
+    return rewriter.create<linalg::FillOp>(loc, fillValue, empty).getResult(0);
+  };
+  Value accInit = createFill(accSizes, zero);
+  Value maxInit = createFill(rowSizes, lowest);
+  Value sumInit = createFill(rowSizes, zero);
+
+  SmallVector<AffineMap> indexingMaps = {
+      attnOp.getQueryMap().shiftDims(1), keyMap, valueMap,
+      attnOp.getScaleMap().shiftDims(1)};
+  if (mask) {
+    indexingMaps.push_back(maskMap);
+  }
+  llvm::append_range(indexingMaps, ArrayRef<AffineMap>{accMap, rowMap, rowMap});
+  auto onlineAttnOp = rewriter.create<IREE::LinalgExt::OnlineAttentionOp>(
+      loc, TypeRange{accInit.getType(), maxInit.getType(), sumInit.getType()},
+      attnOp.getQuery(), key, value, attnOp.getScale(), mask, accInit,
+      maxInit, sumInit, rewriter.getAffineMapArrayAttr(indexingMaps),
+      attnOp.getDecompositionConfigAttr());
+  rewriter.cloneRegionBefore(attnOp.getRegion(), onlineAttnOp.getRegion(),
+                             onlineAttnOp.getRegion().begin());
+  onlineAttnOp->setDiscardableAttrs(attnOp->getDiscardableAttrDictionary());
+
+  // Merge the partitions with an online softmax update over S. The running
+  // max and sum are kept per output element which is redundant along N but
+  // keeps the merge a single reduction that the normalization fuses into.
+  int64_t outputRank = outputSizes.size();
+  AffineExpr mergeSplitExpr = rewriter.getAffineDimExpr(outputRank);
+  SmallVector<AffineExpr> mergeAccExprs = {mergeSplitExpr};
+  SmallVector<AffineExpr> mergeRowExprs = {mergeSplitExpr};
+  for (int64_t i = 0; i < outputRank; ++i) {
+    mergeAccExprs.push_back(rewriter.getAffineDimExpr(i));
+  }
+  for (int64_t pos : rowPositions) {
+    mergeRowExprs.push_back(rewriter.getAffineDimExpr(pos));
+  }
+  AffineMap mergeRowMap =
+      AffineMap::get(outputRank + 1, 0, mergeRowExprs, context);
+  AffineMap mergeOutputMap =
+      rewriter.getMultiDimIdentityMap(outputRank + 1).getMajorSubMap(
+          outputRank);
+  SmallVector<AffineMap> mergeMaps = {
+      AffineMap::get(outputRank + 1, 0, mergeAccExprs, context),
+      mergeRowMap,
+      mergeRowMap,
+      mergeOutputMap,
+      mergeOutputMap,
+      mergeOutputMap};
+  SmallVector<utils::IteratorType> mergeIterators(
+      outputRank, utils::IteratorType::parallel);
+  mergeIterators.push_back(utils::IteratorType::reduction);
+  SmallVector<Value> mergeInits = {createFill(outputSizes, zero),
+                                   createFill(outputSizes, lowest),
+                                   createFill(outputSizes, zero)};
+  auto mergeOp = rewriter.create<linalg::GenericOp>(
+      loc, TypeRange(ValueRange(mergeInits)), onlineAttnOp.getResults(),
+      mergeInits, mergeMaps, mergeIterators,
+      [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        Value partAcc = args[0], partMax = args[1], partSum = args[2];
+        Value acc = args[3], runMax = args[4], sum = args[5];
+        Value newMax = b.create<arith::MaximumFOp>(nestedLoc, runMax, partMax);
+        Value oldScale = b.create<math::Exp2Op>(
+            nestedLoc, b.create<arith::SubFOp>(nestedLoc, runMax, newMax));
+        Value partScale = b.create<math::Exp2Op>(
+            nestedLoc, b.create<arith::SubFOp>(nestedLoc, partMax, newMax));
+        Value newAcc = b.create<arith::AddFOp>(
+            nestedLoc, b.create<arith::MulFOp>(nestedLoc, acc, oldScale),
+            b.create<arith::MulFOp>(nestedLoc, partAcc, partScale));
+        Value newSum = b.create<arith::AddFOp>(
+            nestedLoc, b.create<arith::MulFOp>(nestedLoc, sum, oldScale),
+            b.create<arith::MulFOp>(nestedLoc, partSum, partScale));
+        b.create<linalg::YieldOp>(nestedLoc,
+                                  ValueRange{newAcc, newMax, newSum});
+      });
+
+  // Normalize: O = acc / sum.
+  AffineMap identityMap = rewriter.getMultiDimIdentityMap(outputRank);
+  SmallVector<utils::IteratorType> parallelIterators(
+      outputRank, utils::IteratorType::parallel);
+  Value output = attnOp.getOutput();
+  auto normalizeOp = rewriter.create<linalg::GenericOp>(
+      loc, output.getType(),
+      ValueRange{mergeOp.getResult(0), mergeOp.getResult(2)}, output,
+      SmallVector<AffineMap>(3, identityMap), parallelIterators,
+      [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        Value result = b.create<arith::DivFOp>(nestedLoc, args[0], args[1]);
+        result = convertScalarToDtype(b, nestedLoc, result, args[2].getType(),
+                                      /*isUnsignedCast=*/false);
+        b.create<linalg::YieldOp>(nestedLoc, result);
+      });
+
+  rewriter.replaceOp(attnOp, normalizeOp.getResults());
+  return success();
+}
+
+static llvm::cl::opt<bool> argReductionAutoSplitReduction(
+    "iree-dispatch-creation-arg-reduction-auto-split-reduction",
+    llvm::cl::desc("Automatically splits long arg-reductions (such as argmax "
+                   "or argmin) that produce too few results to fill a device "
+                   "into parallel partial arg-reductions followed by a "
+                   "combine of their value/index pairs"),
+    llvm::cl::init(true));
+
+// Arg-reductions over fewer elements are left as a single serial reduction.
+static constexpr int64_t kArgReductionAutoSplitMinReductionSize = 8192;
+// Minimum ratio of the reduction size to the number of results. Below this
+// the parallel dimensions already provide enough parallelism.
+static constexpr int64_t kArgReductionAutoSplitMinReductionToParallelRatio =
+    256;
+// Minimum number of elements each partial arg-reduction reduces over.
+static constexpr int64_t kArgReductionAutoSplitMinChunkSize = 1024;
+// Maximum number of partial arg-reductions.
+static constexpr int64_t kArgReductionAutoSplitMaxRatio = 128;
+
+// Returns the value derived from |value| through integer casts.
+static Value stripIntegerCasts(Value value) {
+  while (Operation *definingOp = value.getDefiningOp()) {
+    if (!isa<arith::IndexCastOp, arith::IndexCastUIOp, arith::ExtSIOp,
+             arith::ExtUIOp, arith::TruncIOp>(definingOp)) {
+      break;
+    }
+    value = definingOp->getOperand(0);
+  }
+  return value;
+}
+
+// Returns the reduction dimension of |genericOp| if it is an arg-reduction:
+// a single reduction of one input into a value and the index along the
+// reduction dimension at which it was found. The index must be selected
+// between the running index and the position of the current element.
+static std::optional<int64_t> matchArgReduction(linalg::GenericOp genericOp) {
+  if (!genericOp.hasPureTensorSemantics() ||
+      genericOp.getNumDpsInputs() != 1 || genericOp.getNumDpsInits() != 2 ||
+      genericOp.getNumReductionLoops() != 1) {
+    return std::nullopt;
+  }
+  SmallVector<unsigned> reductionDims;
+  genericOp.getReductionDims(reductionDims);
+  int64_t reductionDim = reductionDims.front();
+
+  // The input is indexed by all loops in order and the results by all but the
+  // reduction loop.
+  AffineMap inputMap =
+      genericOp.getMatchingIndexingMap(genericOp.getDpsInputOperand(0));
+  if (!inputMap.isIdentity()) {
+    return std::nullopt;
+  }
+  AffineMap resultMap = inputMap.dropResult(reductionDim);
+  for (OpOperand &initOperand : genericOp.getDpsInitsMutable()) {
+    if (genericOp.getMatchingIndexingMap(&initOperand) != resultMap ||
+        !initOperand.get().getDefiningOp<linalg::FillOp>()) {
+      return std::nullopt;
+    }
+  }
+
+  Block *body = genericOp.getBody();
+  auto yieldOp = cast<linalg::YieldOp>(body->getTerminator());
+  auto selectOp = yieldOp.getOperand(1).getDefiningOp<arith::SelectOp>();
+  if (!selectOp) {
+    return std::nullopt;
+  }
+  auto isReductionIndex = [&](Value value) {
+    auto indexOp = stripIntegerCasts(value).getDefiningOp<linalg::IndexOp>();
+    return indexOp && indexOp.getDim() == reductionDim;
+  };
+  Value runningIndex = body->getArgument(2);
+  if (!(selectOp.getTrueValue() == runningIndex &&
+        isReductionIndex(selectOp.getFalseValue())) &&
+      !(selectOp.getFalseValue() == runningIndex &&
+        isReductionIndex(selectOp.getTrueValue()))) {
+    return std::nullopt;
+  }
+  return reductionDim;
+}
+
+// Returns the number of partial arg-reductions to split |genericOp| into or 0
+// if the op should not be split.
+static int64_t getAutoArgReductionSplitRatio(linalg::GenericOp genericOp,
+                                             int64_t reductionDim) {
+  auto inputType =
+      cast<RankedTensorType>(genericOp.getDpsInputs().front().getType());
+  if (!inputType.hasStaticShape()) {
+    return 0;
+  }
+  int64_t reductionSize = inputType.getDimSize(reductionDim);
+  int64_t parallelSize = inputType.getNumElements() / reductionSize;
+  if (reductionSize < kArgReductionAutoSplitMinReductionSize ||
+      parallelSize * kArgReductionAutoSplitMinReductionToParallelRatio >
+          reductionSize) {
+    return 0;
+  }
+  int64_t maxRatio =
+      std::min(kArgReductionAutoSplitMaxRatio,
+               reductionSize / kArgReductionAutoSplitMinChunkSize);
+  for (int64_t ratio = maxRatio; ratio > 1; --ratio) {
+    if (reductionSize % ratio == 0) {
+      return ratio;
+    }
+  }
+  return 0;
+}
+
+// Splits the reduction dimension of the arg-reduction |genericOp| of size N
+// into |ratio| chunks of size C and reduces in two phases:
+//   1. a partial arg-reduction of each chunk producing the value and global
+//      index of the selected element in each chunk;
+//   2. a combine of the partial value/index pairs with the original region
+//      where the position of the current element is the partial index.
+// Chunks are combined in order so ties resolve the same as the serial
+// reduction.
+static LogicalResult splitArgReduction(RewriterBase &rewriter,
+                                       linalg::GenericOp genericOp,
+                                       int64_t reductionDim, int64_t ratio) {
+  Location loc = genericOp.getLoc();
+  OpBuilder::InsertionGuard guard(rewriter);
+  rewriter.setInsertionPoint(genericOp);
+
+  Value input = genericOp.getDpsInputs().front();
+  auto inputType = cast<RankedTensorType>(input.getType());
+  int64_t rank = inputType.getRank();
+  int64_t chunkSize = inputType.getDimSize(reductionDim) / ratio;
+
+  // [..., N, ...] -> [..., ratio, C, ...]
+  SmallVector<int64_t> expandedShape(inputType.getShape());
+  expandedShape[reductionDim] = ratio;
+  expandedShape.insert(expandedShape.begin() + reductionDim + 1, chunkSize);
+  SmallVector<ReassociationIndices> reassociation;
+  for (int64_t i = 0; i < rank; ++i) {
+    if (i < reductionDim) {
+      reassociation.push_back({i});
+    } else if (i == reductionDim) {
+      reassociation.push_back({i, i + 1});
+    } else {
+      reassociation.push_back({i + 1});
+    }
+  }
+  Value expandedInput = rewriter.create<tensor::ExpandShapeOp>(
+      loc, RankedTensorType::get(expandedShape, inputType.getElementType()),
+      input, reassociation);
+
+  // Clones the body of |genericOp| into a new region with |args| replacing
+  // the block arguments and |getIndex| materializing each linalg.index.
+  Block *body = genericOp.getBody();
+  auto cloneBody = [&](OpBuilder &b, Location nestedLoc, ValueRange args,
+                       function_ref<Value(OpBuilder &, int64_t)> getIndex) {
+    IRMapping mapping;
+    mapping.map(body->getArguments(), args);
+    for (Operation &op : body->without_terminator()) {
+      if (auto indexOp = dyn_cast<linalg::IndexOp>(op)) {
+        mapping.map(indexOp.getResult(), getIndex(b, indexOp.getDim()));
+        continue;
+      }
+      b.clone(op, mapping);
+    }
+    b.create<linalg::YieldOp>(
+        nestedLoc, llvm::map_to_vector(body->getTerminator()->getOperands(),
+                                       [&](Value value) {
+                                         return mapping.lookupOrDefault(value);
+                                       }));
+  };
+
+  // Phase 1: partial arg-reductions with the chunk index as a new parallel
+  // dimension in place of the reduction dimension.
+  SmallVector<int64_t> partialShape(expandedShape);
+  partialShape.erase(partialShape.begin() + reductionDim + 1);
+  SmallVector<Value> partialInits;
+  for (Value init : genericOp.getDpsInits()) {
+    auto fillOp = init.getDefiningOp<linalg::FillOp>();
+    Value empty = rewriter.create<tensor::EmptyOp>(
+        loc, partialShape, getElementTypeOrSelf(init.getType()));
+    partialInits.push_back(
+        rewriter.create<linalg::FillOp>(loc, fillOp.value(), empty)
+            .getResult(0));
+  }
+  AffineMap expandedMap = rewriter.getMultiDimIdentityMap(rank + 1);
+  AffineMap partialMap = expandedMap.dropResult(reductionDim + 1);
+  SmallVector<utils::IteratorType> partialIterators(
+      rank + 1, utils::IteratorType::parallel);
+  partialIterators[reductionDim + 1] = utils::IteratorType::reduction;
+  auto partialOp = rewriter.create<linalg::GenericOp>(
+      loc, TypeRange(ValueRange(partialInits)), expandedInput, partialInits,
+      SmallVector<AffineMap>{expandedMap, partialMap, partialMap},
+      partialIterators, [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        cloneBody(b, nestedLoc, args, [&](OpBuilder &ib, int64_t dim) -> Value {
+          if (dim < reductionDim) {
+            return ib.create<linalg::IndexOp>(nestedLoc, dim);
+          } else if (dim > reductionDim) {
+            return ib.create<linalg::IndexOp>(nestedLoc, dim + 1);
+          }
+          // Global position = chunk * C + position within the chunk.
+          Value chunk = ib.create<linalg::IndexOp>(nestedLoc, reductionDim);
+          Value offset = ib.create<linalg::IndexOp>(nestedLoc, dim + 1);
+          Value chunkStart = ib.create<arith::MulIOp>(
+              nestedLoc, chunk,
+              ib.create<arith::ConstantIndexOp>(nestedLoc, chunkSize));
+          return ib.create<arith::AddIOp>(nestedLoc, chunkStart, offset);
+        });
+      });
+  partialOp->setDiscardableAttrs(genericOp->getDiscardableAttrDictionary());
+
+  // Phase 2: combine the partial results over the chunks, which become the
+  // innermost reduction dimension.
+  SmallVector<AffineExpr> chunkExprs;
+  for (int64_t i = 0; i < rank - 1; ++i) {
+    chunkExprs.push_back(rewriter.getAffineDimExpr(i));
+  }
+  chunkExprs.insert(chunkExprs.begin() + reductionDim,
+                    rewriter.getAffineDimExpr(rank - 1));
+  AffineMap chunkMap =
+      AffineMap::get(rank, 0, chunkExprs, rewriter.getContext());
+  AffineMap combinedMap =
+      rewriter.getMultiDimIdentityMap(rank).getMajorSubMap(rank - 1);
+  SmallVector<utils::IteratorType> combineIterators(
+      rank - 1, utils::IteratorType::parallel);
+  combineIterators.push_back(utils::IteratorType::reduction);
+  auto combineOp = rewriter.create<linalg::GenericOp>(
+      loc, genericOp.getResultTypes(), partialOp.getResults(),
+      genericOp.getDpsInits(),
+      SmallVector<AffineMap>{chunkMap, chunkMap, combinedMap, combinedMap},
+      combineIterators,
+      [&](OpBuilder &b, Location nestedLoc, ValueRange args) {
+        // The original region takes (value, running value, running index).
+        Value partialIndex = args[1];
+        cloneBody(b, nestedLoc, {args[0], args[2], args[3]},
+                  [&](OpBuilder &ib, int64_t dim) -> Value {
+                    if (dim < reductionDim) {
+                      return ib.create<linalg::IndexOp>(nestedLoc, dim);
+                    } else if (dim > reductionDim) {
+                      return ib.create<linalg::IndexOp>(nestedLoc, dim - 1);
+                    }
+                    if (partialIndex.getType().isIndex()) {
+                      return partialIndex;
+                    }
+                    return ib.create<arith::IndexCastOp>(
+                        nestedLoc, ib.getIndexType(), partialIndex);
+                  });
+      });
+  combineOp->setDiscardableAttrs(genericOp->getDiscardableAttrDictionary());
+
+  rewriter.replaceOp(genericOp, combineOp.getResults());
+  return success();
+}
+
 static LogicalResult splitReductionOnMatmul(
     RewriterBase &rewriter, linalg::MatmulOp op,
     linalg::ControlSplitReductionFn controlSplitReductionFn) {
@@ -55,7 +800,9 @@ struct SplitReductionPass final
     : public impl::SplitReductionPassBase<SplitReductionPass> {
   void runOnOperation() override {
     if (splitReductionRatio.getValue() <= 1 &&
-        topkSplitReductionRatio.empty()) {
+        topkSplitReductionRatio.empty() && !topkAutoSplitReduction &&
+        !scanAutoSplitReduction && !attentionAutoSplitKV &&
+        !argReductionAutoSplitReduction) {
       return;
     }
 
@@ -91,7 +838,63 @@ struct SplitReductionPass final
     funcOp->walk(
         [&](IREE::LinalgExt::TopkOp op) { topkCandidates.push_back(op); });
     for (auto op : topkCandidates) {
-      (void)splitReduction(rewriter, op, topkSplitReductionControlFn);
+      if (!topkSplitReductionRatio.empty()) {
+        (void)splitReduction(rewriter, op, topkSplitReductionControlFn);
+        continue;
+      }
+      if (!topkAutoSplitReduction) {
+        continue;
+      }
+      // Only a single level of splitting is performed automatically: the
+      // partial results are small enough that a serial merge is cheap.
+      int64_t autoRatio = getAutoTopkSplitRatio(op);
+      if (autoRatio <= 1) {
+        continue;
+      }
+      (void)splitReduction(rewriter, op,
+                           [&](int64_t splitReductionDepth) -> int64_t {
+                             return splitReductionDepth == 0 ? autoRatio : -1;
+                           });
+    }
+
+    if (scanAutoSplitReduction) {
+      SmallVector<IREE::LinalgExt::ScanOp> scanCandidates;
+      funcOp->walk(
+          [&](IREE::LinalgExt::ScanOp op) { scanCandidates.push_back(op); });
+      for (auto op : scanCandidates) {
+        int64_t ratio = getAutoScanSplitRatio(op);
+        if (ratio > 1) {
+          (void)splitScanReduction(rewriter, op, ratio);
+        }
+      }
+    }
+
+    if (attentionAutoSplitKV) {
+      SmallVector<IREE::LinalgExt::AttentionOp> attentionCandidates;
+      funcOp->walk([&](IREE::LinalgExt::AttentionOp op) {
+        attentionCandidates.push_back(op);
+      });
+      for (auto op : attentionCandidates) {
+        int64_t ratio = getAutoAttentionSplitKVRatio(op);
+        if (ratio > 1) {
+          (void)splitAttentionKV(rewriter, op, ratio);
+        }
+      }
+    }
+
+    if (argReductionAutoSplitReduction) {
+      SmallVector<std::pair<linalg::GenericOp, int64_t>> argReductionCandidates;
+      funcOp->walk([&](linalg::GenericOp op) {
+        if (std::optional<int64_t> reductionDim = matchArgReduction(op)) {
+          argReductionCandidates.emplace_back(op, *reductionDim);
+        }
+      });
+      for (auto [op, reductionDim] : argReductionCandidates) {
+        int64_t ratio = getAutoArgReductionSplitRatio(op, reductionDim);
+        if (ratio > 1) {
+          (void)splitArgReduction(rewriter, op, reductionDim, ratio);
+        }
+      }
     }
   }
 };
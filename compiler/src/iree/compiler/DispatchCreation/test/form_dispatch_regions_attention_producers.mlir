@@ -0,0 +1,104 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-dispatch-creation-form-dispatch-regions{fuse-attention-with-producers=true}))" %s | FileCheck %s
+
+#map = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+#map1 = affine_map<(d0, d1, d2) -> (d2)>
+util.func public @attention_rope_query(%q: tensor<4x1x64xf16>, %k: tensor<4x128x64xf16>, %v: tensor<4x128x64xf16>, %scale: f16, %freq: tensor<64xf16>) -> tensor<4x1x64xf16> {
+  %empty = tensor.empty() : tensor<4x1x64xf16>
+  %rope = linalg.generic {indexing_maps = [#map, #map1, #map], iterator_types = ["parallel", "parallel", "parallel"]} ins(%q, %freq : tensor<4x1x64xf16>, tensor<64xf16>) outs(%empty : tensor<4x1x64xf16>) {
+  ^bb0(%in: f16, %in_0: f16, %out: f16):
+    %0 = math.cos %in_0 : f16
+    %1 = arith.mulf %in, %0 : f16
+    linalg.yield %1 : f16
+  } -> tensor<4x1x64xf16>
+  %attn = iree_linalg_ext.attention {indexing_maps = [affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d4)>, affine_map<(d0, d1, d2, d3, d4) -> ()>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d4)>]} ins(%rope, %k, %v, %scale : tensor<4x1x64xf16>, tensor<4x128x64xf16>, tensor<4x128x64xf16>, f16) outs(%empty : tensor<4x1x64xf16>) {
+  ^bb0(%score: f16):
+    iree_linalg_ext.yield %score : f16
+  } -> tensor<4x1x64xf16>
+  util.return %attn : tensor<4x1x64xf16>
+}
+// CHECK-LABEL: util.func public @attention_rope_query
+//       CHECK:   %[[DISPATCH:.+]] = flow.dispatch.region
+//       CHECK:     %[[ROPE:.+]] = linalg.generic
+//       CHECK:       math.cos
+//       CHECK:     %[[ATTN:.+]] = iree_linalg_ext.attention
+//  CHECK-SAME:         ins(%[[ROPE]],
+//       CHECK:     flow.return %[[ATTN]]
+//   CHECK-NOT:   flow.dispatch.region
+//       CHECK:   util.return %[[DISPATCH]]
+
+// -----
+
+// Producers with multiple uses (such as a key that is also written into the
+// KV cache) are not fused.
+
+#map = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+util.func public @attention_multi_use_key(%q: tensor<4x1x64xf16>, %k: tensor<4x128x64xf16>, %v: tensor<4x128x64xf16>, %scale: f16) -> (tensor<4x1x64xf16>, tensor<4x128x64xf16>) {
+  %empty = tensor.empty() : tensor<4x1x64xf16>
+  %kempty = tensor.empty() : tensor<4x128x64xf16>
+  %kscaled = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel", "parallel"]} ins(%k : tensor<4x128x64xf16>) outs(%kempty : tensor<4x128x64xf16>) {
+  ^bb0(%in: f16, %out: f16):
+    %0 = arith.mulf %in, %in : f16
+    linalg.yield %0 : f16
+  } -> tensor<4x128x64xf16>
+  %attn = iree_linalg_ext.attention {indexing_maps = [affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d4)>, affine_map<(d0, d1, d2, d3, d4) -> ()>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d4)>]} ins(%q, %kscaled, %v, %scale : tensor<4x1x64xf16>, tensor<4x128x64xf16>, tensor<4x128x64xf16>, f16) outs(%empty : tensor<4x1x64xf16>) {
+  ^bb0(%score: f16):
+    iree_linalg_ext.yield %score : f16
+  } -> tensor<4x1x64xf16>
+  util.return %attn, %kscaled : tensor<4x1x64xf16>, tensor<4x128x64xf16>
+}
+// CHECK-LABEL: util.func public @attention_multi_use_key
+//       CHECK:   %[[KDISPATCH:.+]] = flow.dispatch.region
+//  CHECK-NEXT:     linalg.generic
+//       CHECK:   %[[DISPATCH:.+]] = flow.dispatch.region
+//  CHECK-NEXT:     %[[ATTN:.+]] = iree_linalg_ext.attention
+//  CHECK-SAME:         ins(%{{.+}}, %[[KDISPATCH]],
+//       CHECK:   util.return %[[DISPATCH]], %[[KDISPATCH]]
+
+// -----
+
+// Paged key/value caches are read through a block table with gather-like
+// generics. These are fused so that pages are read directly by the attention
+// dispatch instead of materializing the dense key/value.
+
+#map = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+util.func public @attention_paged_kv(%q: tensor<4x1x64xf16>, %k_cache: tensor<32x16x4x64xf16>, %v_cache: tensor<32x16x4x64xf16>, %block_table: tensor<8xindex>, %scale: f16) -> tensor<4x1x64xf16> {
+  %c16 = arith.constant 16 : index
+  %empty = tensor.empty() : tensor<4x1x64xf16>
+  %kv_empty = tensor.empty() : tensor<4x128x64xf16>
+  %k = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel", "parallel"]} outs(%kv_empty : tensor<4x128x64xf16>) {
+  ^bb0(%out: f16):
+    %h = linalg.index 0 : index
+    %s = linalg.index 1 : index
+    %d = linalg.index 2 : index
+    %block = arith.divui %s, %c16 : index
+    %slot = arith.remui %s, %c16 : index
+    %page = tensor.extract %block_table[%block] : tensor<8xindex>
+    %0 = tensor.extract %k_cache[%page, %slot, %h, %d] : tensor<32x16x4x64xf16>
+    linalg.yield %0 : f16
+  } -> tensor<4x128x64xf16>
+  %v = linalg.generic {indexing_maps = [#map], iterator_types = ["parallel", "parallel", "parallel"]} outs(%kv_empty : tensor<4x128x64xf16>) {
+  ^bb0(%out: f16):
+    %h = linalg.index 0 : index
+    %s = linalg.index 1 : index
+    %d = linalg.index 2 : index
+    %block = arith.divui %s, %c16 : index
+    %slot = arith.remui %s, %c16 : index
+    %page = tensor.extract %block_table[%block] : tensor<8xindex>
+    %0 = tensor.extract %v_cache[%page, %slot, %h, %d] : tensor<32x16x4x64xf16>
+    linalg.yield %0 : f16
+  } -> tensor<4x128x64xf16>
+  %attn = iree_linalg_ext.attention {indexing_maps = [affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d4)>, affine_map<(d0, d1, d2, d3, d4) -> ()>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d4)>]} ins(%q, %k, %v, %scale : tensor<4x1x64xf16>, tensor<4x128x64xf16>, tensor<4x128x64xf16>, f16) outs(%empty : tensor<4x1x64xf16>) {
+  ^bb0(%score: f16):
+    iree_linalg_ext.yield %score : f16
+  } -> tensor<4x1x64xf16>
+  util.return %attn : tensor<4x1x64xf16>
+}
+// CHECK-LABEL: util.func public @attention_paged_kv
+//       CHECK:   %[[DISPATCH:.+]] = flow.dispatch.region
+//   CHECK-DAG:     %[[K:.+]] = linalg.generic
+//   CHECK-DAG:     %[[V:.+]] = linalg.generic
+//       CHECK:     %[[ATTN:.+]] = iree_linalg_ext.attention
+//  CHECK-SAME:         ins(%{{.+}}, %[[K]], %[[V]],
+//       CHECK:     flow.return %[[ATTN]]
+//   CHECK-NOT:   flow.dispatch.region
+//       CHECK:   util.return %[[DISPATCH]]
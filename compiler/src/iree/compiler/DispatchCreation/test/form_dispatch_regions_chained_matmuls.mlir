@@ -0,0 +1,54 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-dispatch-creation-form-dispatch-regions{fuse-chained-matmuls=true}))" %s | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+util.func public @mlp(%x: tensor<128x512xf16>, %w0: tensor<512x2048xf16>, %w1: tensor<2048x512xf16>) -> tensor<128x512xf32> {
+  %cst = arith.constant 0.0 : f32
+  %empty0 = tensor.empty() : tensor<128x2048xf32>
+  %fill0 = linalg.fill ins(%cst : f32) outs(%empty0 : tensor<128x2048xf32>) -> tensor<128x2048xf32>
+  %mm0 = linalg.matmul ins(%x, %w0 : tensor<128x512xf16>, tensor<512x2048xf16>) outs(%fill0 : tensor<128x2048xf32>) -> tensor<128x2048xf32>
+  %empty1 = tensor.empty() : tensor<128x2048xf16>
+  %act = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%mm0 : tensor<128x2048xf32>) outs(%empty1 : tensor<128x2048xf16>) {
+  ^bb0(%in: f32, %out: f16):
+    %0 = arith.maximumf %in, %cst : f32
+    %1 = arith.truncf %0 : f32 to f16
+    linalg.yield %1 : f16
+  } -> tensor<128x2048xf16>
+  %empty2 = tensor.empty() : tensor<128x512xf32>
+  %fill1 = linalg.fill ins(%cst : f32) outs(%empty2 : tensor<128x512xf32>) -> tensor<128x512xf32>
+  %mm1 = linalg.matmul ins(%act, %w1 : tensor<128x2048xf16>, tensor<2048x512xf16>) outs(%fill1 : tensor<128x512xf32>) -> tensor<128x512xf32>
+  util.return %mm1 : tensor<128x512xf32>
+}
+// CHECK-LABEL: util.func public @mlp
+//       CHECK:   %[[DISPATCH:.+]] = flow.dispatch.region
+//       CHECK:     %[[MM0:.+]] = linalg.matmul
+//       CHECK:     %[[ACT:.+]] = linalg.generic
+//  CHECK-SAME:         ins(%[[MM0]] :
+//       CHECK:     %[[MM1:.+]] = linalg.matmul
+//  CHECK-SAME:         ins(%[[ACT]],
+//       CHECK:     flow.return %[[MM1]]
+//   CHECK-NOT:   flow.dispatch.region
+//       CHECK:   util.return %[[DISPATCH]]
+
+// -----
+
+// The intermediate result is also returned, so the first matmul stays in its
+// own dispatch.
+
+util.func public @chained_matmul_multi_use(%x: tensor<128x512xf32>, %w0: tensor<512x256xf32>, %w1: tensor<256x64xf32>) -> (tensor<128x64xf32>, tensor<128x256xf32>) {
+  %cst = arith.constant 0.0 : f32
+  %empty0 = tensor.empty() : tensor<128x256xf32>
+  %fill0 = linalg.fill ins(%cst : f32) outs(%empty0 : tensor<128x256xf32>) -> tensor<128x256xf32>
+  %mm0 = linalg.matmul ins(%x, %w0 : tensor<128x512xf32>, tensor<512x256xf32>) outs(%fill0 : tensor<128x256xf32>) -> tensor<128x256xf32>
+  %empty1 = tensor.empty() : tensor<128x64xf32>
+  %fill1 = linalg.fill ins(%cst : f32) outs(%empty1 : tensor<128x64xf32>) -> tensor<128x64xf32>
+  %mm1 = linalg.matmul ins(%mm0, %w1 : tensor<128x256xf32>, tensor<256x64xf32>) outs(%fill1 : tensor<128x64xf32>) -> tensor<128x64xf32>
+  util.return %mm1, %mm0 : tensor<128x64xf32>, tensor<128x256xf32>
+}
+// CHECK-LABEL: util.func public @chained_matmul_multi_use
+//       CHECK:   %[[DISPATCH0:.+]] = flow.dispatch.region
+//  CHECK-NEXT:     %[[MM0:.+]] = linalg.matmul
+//       CHECK:     flow.return %[[MM0]]
+//       CHECK:   %[[DISPATCH1:.+]] = flow.dispatch.region
+//  CHECK-NEXT:     %[[MM1:.+]] = linalg.matmul
+//  CHECK-SAME:         ins(%[[DISPATCH0]],
+//       CHECK:   util.return %[[DISPATCH1]], %[[DISPATCH0]]
@@ -0,0 +1,100 @@
+// RUN: iree-opt --pass-pipeline="builtin.module(util.func(iree-dispatch-creation-fuse-horizontal-generic-ops))" --split-input-file %s | FileCheck %s
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+util.func public @fuse_independent_elementwise(%arg0: tensor<8x16xf32>, %arg1: tensor<8x16xf16>, %arg2: tensor<8x16xf32>) -> (tensor<8x16xf32>, tensor<8x16xf32>, tensor<8x16xf32>) {
+  %0 = tensor.empty() : tensor<8x16xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : tensor<8x16xf32>) outs(%0 : tensor<8x16xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %4 = math.exp %in : f32
+    linalg.yield %4 : f32
+  } -> tensor<8x16xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg1 : tensor<8x16xf16>) outs(%0 : tensor<8x16xf32>) {
+  ^bb0(%in: f16, %out: f32):
+    %4 = arith.extf %in : f16 to f32
+    linalg.yield %4 : f32
+  } -> tensor<8x16xf32>
+  %3 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0, %arg2 : tensor<8x16xf32>, tensor<8x16xf32>) outs(%0 : tensor<8x16xf32>) {
+  ^bb0(%in: f32, %in_0: f32, %out: f32):
+    %4 = arith.addf %in, %in_0 : f32
+    linalg.yield %4 : f32
+  } -> tensor<8x16xf32>
+  util.return %1, %2, %3 : tensor<8x16xf32>, tensor<8x16xf32>, tensor<8x16xf32>
+}
+// CHECK-LABEL: util.func public @fuse_independent_elementwise
+//  CHECK-SAME:     %[[ARG0:[a-zA-Z0-9]+]]: tensor<8x16xf32>
+//  CHECK-SAME:     %[[ARG1:[a-zA-Z0-9]+]]: tensor<8x16xf16>
+//  CHECK-SAME:     %[[ARG2:[a-zA-Z0-9]+]]: tensor<8x16xf32>
+//       CHECK:   %[[FUSED:.+]]:3 = linalg.generic
+//  CHECK-SAME:       ins(%[[ARG0]], %[[ARG1]], %[[ARG0]], %[[ARG2]] :
+//  CHECK-NEXT:   ^bb0(%[[IN0:.+]]: f32, %[[IN1:.+]]: f16, %[[IN2:.+]]: f32, %[[IN3:.+]]: f32, %{{.+}}: f32, %{{.+}}: f32, %{{.+}}: f32):
+//   CHECK-DAG:     %[[EXP:.+]] = math.exp %[[IN0]]
+//   CHECK-DAG:     %[[EXT:.+]] = arith.extf %[[IN1]]
+//   CHECK-DAG:     %[[ADD:.+]] = arith.addf %[[IN2]], %[[IN3]]
+//       CHECK:     linalg.yield %[[EXP]], %[[EXT]], %[[ADD]]
+//   CHECK-NOT:   linalg.generic
+//       CHECK:   util.return %[[FUSED]]#0, %[[FUSED]]#1, %[[FUSED]]#2
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+#map1 = affine_map<(d0, d1) -> (d0)>
+util.func public @fuse_independent_reductions(%arg0: tensor<8x16xf32>, %arg1: tensor<8x16xf32>) -> (tensor<8xf32>, tensor<8xf32>) {
+  %cst = arith.constant 0.000000e+00 : f32
+  %0 = tensor.empty() : tensor<8xf32>
+  %1 = linalg.fill ins(%cst : f32) outs(%0 : tensor<8xf32>) -> tensor<8xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map1], iterator_types = ["parallel", "reduction"]} ins(%arg0 : tensor<8x16xf32>) outs(%1 : tensor<8xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %4 = arith.addf %in, %out : f32
+    linalg.yield %4 : f32
+  } -> tensor<8xf32>
+  %3 = linalg.generic {indexing_maps = [#map, #map1], iterator_types = ["parallel", "reduction"]} ins(%arg1 : tensor<8x16xf32>) outs(%1 : tensor<8xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %4 = arith.maximumf %in, %out : f32
+    linalg.yield %4 : f32
+  } -> tensor<8xf32>
+  util.return %2, %3 : tensor<8xf32>, tensor<8xf32>
+}
+// CHECK-LABEL: util.func public @fuse_independent_reductions
+//       CHECK:   %[[FILL:.+]] = linalg.fill
+//       CHECK:   %[[FUSED:.+]]:2 = linalg.generic
+//  CHECK-SAME:       iterator_types = ["parallel", "reduction"]
+//  CHECK-SAME:       outs(%[[FILL]], %[[FILL]] :
+//       CHECK:     arith.addf
+//       CHECK:     arith.maximumf
+//   CHECK-NOT:   linalg.generic
+//       CHECK:   util.return %[[FUSED]]#0, %[[FUSED]]#1
+
+// -----
+
+// Ops with a different iteration space or with compute producers/consumers
+// are not fused.
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+util.func public @no_fuse(%arg0: tensor<8x16xf32>, %arg1: tensor<16x8xf32>) -> (tensor<8x16xf32>, tensor<16x8xf32>, tensor<8x16xf32>) {
+  %0 = tensor.empty() : tensor<8x16xf32>
+  %1 = tensor.empty() : tensor<16x8xf32>
+  %2 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg0 : tensor<8x16xf32>) outs(%0 : tensor<8x16xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %5 = math.exp %in : f32
+    linalg.yield %5 : f32
+  } -> tensor<8x16xf32>
+  %3 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%arg1 : tensor<16x8xf32>) outs(%1 : tensor<16x8xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %5 = math.exp %in : f32
+    linalg.yield %5 : f32
+  } -> tensor<16x8xf32>
+  %4 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%2 : tensor<8x16xf32>) outs(%0 : tensor<8x16xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %5 = math.log %in : f32
+    linalg.yield %5 : f32
+  } -> tensor<8x16xf32>
+  util.return %2, %3, %4 : tensor<8x16xf32>, tensor<16x8xf32>, tensor<8x16xf32>
+}
+// CHECK-LABEL: util.func public @no_fuse
+//       CHECK:   %[[EXP0:.+]] = linalg.generic
+//  CHECK-SAME:       tensor<8x16xf32>
+//       CHECK:   %[[EXP1:.+]] = linalg.generic
+//  CHECK-SAME:       tensor<16x8xf32>
+//       CHECK:   %[[LOG:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[EXP0]] :
+//       CHECK:   util.return %[[EXP0]], %[[EXP1]], %[[LOG]]
@@ -15,3 +15,164 @@ util.func public @matmul(%arg0: tensor<100x200xf32>, %arg1: tensor<200x300xf32>,
 // CHECK:       util.func public @matmul
 // CHECK:         linalg.generic
 // CHECK-SAME:      {compilation_info = #[[INFO]]}
+
+// Large top-k reductions are split into parallel partial top-k ops and a
+// merge even without explicit split ratios.
+util.func public @topk_auto_split(%arg0: tensor<131072xf32>, %arg1: tensor<40xf32>, %arg2: tensor<40xi32>) -> (tensor<40xf32>, tensor<40xi32>) {
+  %0:2 = iree_linalg_ext.topk
+      dimension(0)
+      ins(%arg0 : tensor<131072xf32>)
+      outs(%arg1, %arg2 : tensor<40xf32>, tensor<40xi32>) {
+  ^bb0(%lhs: f32, %rhs: f32):
+    %1 = arith.cmpf ogt, %lhs, %rhs : f32
+    iree_linalg_ext.yield %1 : i1
+  } -> tensor<40xf32>, tensor<40xi32>
+  util.return %0#0, %0#1 : tensor<40xf32>, tensor<40xi32>
+}
+// CHECK-LABEL: util.func public @topk_auto_split
+// CHECK:         %[[EXPANDED:.+]] = tensor.expand_shape %{{.+}} {{\[}}[0, 1]] output_shape [128, 1024]
+// CHECK:         %[[PARTIAL:.+]]:2 = iree_linalg_ext.topk dimension(1) ins(%[[EXPANDED]] : tensor<128x1024xf32>)
+// CHECK-SAME:      -> tensor<128x40xf32>, tensor<128x40xi32>
+// CHECK:         tensor.collapse_shape %[[PARTIAL]]#0 {{\[}}[0, 1]] : tensor<128x40xf32> into tensor<5120xf32>
+// CHECK:         iree_linalg_ext.topk dimension(0) ins(%{{.+}}, %{{.+}} : tensor<5120xf32>, tensor<5120xi32>)
+// CHECK-SAME:      -> tensor<40xf32>, tensor<40xi32>
+
+// Small top-k reductions are left alone.
+util.func public @topk_no_auto_split(%arg0: tensor<4096xf32>, %arg1: tensor<40xf32>, %arg2: tensor<40xi32>) -> (tensor<40xf32>, tensor<40xi32>) {
+  %0:2 = iree_linalg_ext.topk
+      dimension(0)
+      ins(%arg0 : tensor<4096xf32>)
+      outs(%arg1, %arg2 : tensor<40xf32>, tensor<40xi32>) {
+  ^bb0(%lhs: f32, %rhs: f32):
+    %1 = arith.cmpf ogt, %lhs, %rhs : f32
+    iree_linalg_ext.yield %1 : i1
+  } -> tensor<40xf32>, tensor<40xi32>
+  util.return %0#0, %0#1 : tensor<40xf32>, tensor<40xi32>
+}
+// CHECK-LABEL: util.func public @topk_no_auto_split
+// CHECK-NOT:     tensor.expand_shape
+// CHECK:         iree_linalg_ext.topk dimension(0) ins(%{{.+}} : tensor<4096xf32>)
+// CHECK-NOT:     iree_linalg_ext.topk
+
+// Long inclusive scans are split into a chunked scan, a scan of the chunk
+// totals and a combine of the running prefix into the trailing chunks.
+util.func public @scan_auto_split(%arg0: tensor<8192xf32>, %arg1: tensor<8192xf32>, %arg2: tensor<f32>) -> (tensor<8192xf32>, tensor<f32>) {
+  %0:2 = iree_linalg_ext.scan dimension(0) inclusive(true)
+      ins(%arg0 : tensor<8192xf32>)
+      outs(%arg1, %arg2 : tensor<8192xf32>, tensor<f32>) {
+  ^bb0(%lhs: f32, %rhs: f32):
+    %1 = arith.addf %lhs, %rhs : f32
+    iree_linalg_ext.yield %1 : f32
+  } -> tensor<8192xf32>, tensor<f32>
+  util.return %0#0, %0#1 : tensor<8192xf32>, tensor<f32>
+}
+// CHECK-LABEL: util.func public @scan_auto_split
+// CHECK-SAME:    %[[ARG0:[a-zA-Z0-9_]+]]
+// CHECK:         %[[EXPANDED:.+]] = tensor.expand_shape %[[ARG0]] {{\[}}[0, 1]] output_shape [16, 512]
+// CHECK:         %[[CHUNKS:.+]]:2 = iree_linalg_ext.scan dimension(1) inclusive(true) ins(%[[EXPANDED]] : tensor<16x512xf32>)
+// CHECK:         %[[TOTALS:.+]] = tensor.extract_slice %[[CHUNKS]]#1[0] [15] [1] : tensor<16xf32> to tensor<15xf32>
+// CHECK:         %[[PREFIX:.+]]:2 = iree_linalg_ext.scan dimension(0) inclusive(true) ins(%[[TOTALS]] : tensor<15xf32>)
+// CHECK:         %[[TRAILING:.+]] = tensor.extract_slice %[[CHUNKS]]#0[1, 0] [15, 512] [1, 1]
+// CHECK:         %[[COMBINED:.+]] = linalg.generic
+// CHECK-SAME:      ins(%[[PREFIX]]#0, %[[TRAILING]] : tensor<15xf32>, tensor<15x512xf32>)
+// CHECK:           arith.addf
+// CHECK:         %[[INSERTED:.+]] = tensor.insert_slice %[[COMBINED]] into %[[CHUNKS]]#0[1, 0] [15, 512] [1, 1]
+// CHECK:         %[[RESULT:.+]] = tensor.collapse_shape %[[INSERTED]] {{\[}}[0, 1]] : tensor<16x512xf32> into tensor<8192xf32>
+// CHECK:         %[[ACC:.+]] = tensor.extract_slice %[[RESULT]][8191] [1] [1] : tensor<8192xf32> to tensor<f32>
+// CHECK:         util.return %[[RESULT]], %[[ACC]]
+
+// Attention with a single query and a long key/value sequence is split along
+// the key/value sequence into partial online attentions and a merge.
+util.func public @attention_decode_split_kv(%q: tensor<32x1x128xf16>, %k: tensor<32x8192x128xf16>, %v: tensor<32x8192x128xf16>, %scale: f16) -> tensor<32x1x128xf16> {
+  %empty = tensor.empty() : tensor<32x1x128xf16>
+  %0 = iree_linalg_ext.attention {indexing_maps = [affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d4)>, affine_map<(d0, d1, d2, d3, d4) -> ()>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d4)>]} ins(%q, %k, %v, %scale : tensor<32x1x128xf16>, tensor<32x8192x128xf16>, tensor<32x8192x128xf16>, f16) outs(%empty : tensor<32x1x128xf16>) {
+  ^bb0(%score: f32):
+    iree_linalg_ext.yield %score : f32
+  } -> tensor<32x1x128xf16>
+  util.return %0 : tensor<32x1x128xf16>
+}
+// CHECK-DAG:   #[[$KV_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d1, d0, d4, d3)>
+// CHECK-DAG:   #[[$ACC_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d2, d5)>
+// CHECK-DAG:   #[[$ROW_MAP:.+]] = affine_map<(d0, d1, d2, d3, d4, d5) -> (d0, d1, d2)>
+// CHECK-LABEL: util.func public @attention_decode_split_kv
+// CHECK-SAME:    %[[Q:[a-zA-Z0-9_]+]]
+// CHECK-SAME:    %[[K:[a-zA-Z0-9_]+]]
+// CHECK-SAME:    %[[V:[a-zA-Z0-9_]+]]
+// CHECK:         %[[EXP_K:.+]] = tensor.expand_shape %[[K]] {{\[}}[0], [1, 2], [3]] output_shape [32, 16, 512, 128]
+// CHECK:         %[[EXP_V:.+]] = tensor.expand_shape %[[V]] {{\[}}[0], [1, 2], [3]] output_shape [32, 16, 512, 128]
+// CHECK:         %[[PARTIAL:.+]]:3 = iree_linalg_ext.online_attention
+// CHECK-SAME:      #[[$KV_MAP]], #[[$KV_MAP]], {{.+}}, #[[$ACC_MAP]], #[[$ROW_MAP]], #[[$ROW_MAP]]
+// CHECK-SAME:      ins(%[[Q]], %[[EXP_K]], %[[EXP_V]]
+// CHECK-SAME:      -> tensor<16x32x1x128xf32>, tensor<16x32x1xf32>, tensor<16x32x1xf32>
+// CHECK:         %[[MERGE:.+]]:3 = linalg.generic
+// CHECK-SAME:      iterator_types = ["parallel", "parallel", "parallel", "reduction"]
+// CHECK-SAME:      ins(%[[PARTIAL]]#0, %[[PARTIAL]]#1, %[[PARTIAL]]#2
+// CHECK:           math.exp2
+// CHECK:           math.exp2
+// CHECK:         %[[RESULT:.+]] = linalg.generic
+// CHECK-SAME:      ins(%[[MERGE]]#0, %[[MERGE]]#2
+// CHECK:           arith.divf
+// CHECK:           arith.truncf
+// CHECK:         util.return %[[RESULT]]
+
+// Attention with many queries already has enough parallelism.
+util.func public @attention_prefill_no_split(%q: tensor<32x1024x128xf16>, %k: tensor<32x8192x128xf16>, %v: tensor<32x8192x128xf16>, %scale: f16) -> tensor<32x1024x128xf16> {
+  %empty = tensor.empty() : tensor<32x1024x128xf16>
+  %0 = iree_linalg_ext.attention {indexing_maps = [affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d2)>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d3, d4)>, affine_map<(d0, d1, d2, d3, d4) -> ()>, affine_map<(d0, d1, d2, d3, d4) -> (d0, d1, d4)>]} ins(%q, %k, %v, %scale : tensor<32x1024x128xf16>, tensor<32x8192x128xf16>, tensor<32x8192x128xf16>, f16) outs(%empty : tensor<32x1024x128xf16>) {
+  ^bb0(%score: f32):
+    iree_linalg_ext.yield %score : f32
+  } -> tensor<32x1024x128xf16>
+  util.return %0 : tensor<32x1024x128xf16>
+}
+// CHECK-LABEL: util.func public @attention_prefill_no_split
+// CHECK-NOT:     iree_linalg_ext.online_attention
+// CHECK:         iree_linalg_ext.attention
+
+util.func public @argmax_split(%input: tensor<1x32768xf32>) -> (tensor<1xf32>, tensor<1xi64>) {
+  %c0_i64 = arith.constant 0 : i64
+  %cst = arith.constant 0xFF800000 : f32
+  %0 = tensor.empty() : tensor<1xi64>
+  %1 = linalg.fill ins(%c0_i64 : i64) outs(%0 : tensor<1xi64>) -> tensor<1xi64>
+  %2 = tensor.empty() : tensor<1xf32>
+  %3 = linalg.fill ins(%cst : f32) outs(%2 : tensor<1xf32>) -> tensor<1xf32>
+  %4:2 = linalg.generic {indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>, affine_map<(d0, d1) -> (d0)>, affine_map<(d0, d1) -> (d0)>], iterator_types = ["parallel", "reduction"]} ins(%input : tensor<1x32768xf32>) outs(%3, %1 : tensor<1xf32>, tensor<1xi64>) {
+  ^bb0(%in: f32, %out: f32, %out_0: i64):
+    %5 = linalg.index 1 : index
+    %6 = arith.index_cast %5 : index to i64
+    %7 = arith.maximumf %in, %out : f32
+    %8 = arith.cmpf ogt, %in, %out : f32
+    %9 = arith.select %8, %6, %out_0 : i64
+    linalg.yield %7, %9 : f32, i64
+  } -> (tensor<1xf32>, tensor<1xi64>)
+  util.return %4#0, %4#1 : tensor<1xf32>, tensor<1xi64>
+}
+// CHECK-DAG:   #[[$ARG_IN_MAP:.+]] = affine_map<(d0, d1, d2) -> (d0, d1, d2)>
+// CHECK-DAG:   #[[$ARG_PARTIAL_MAP:.+]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+// CHECK-DAG:   #[[$ARG_CHUNK_MAP:.+]] = affine_map<(d0, d1) -> (d0, d1)>
+// CHECK-DAG:   #[[$ARG_OUT_MAP:.+]] = affine_map<(d0, d1) -> (d0)>
+// CHECK-LABEL: util.func public @argmax_split
+// CHECK-SAME:    %[[INPUT:[a-zA-Z0-9_]+]]
+// CHECK-DAG:     %[[C1024:.+]] = arith.constant 1024 : index
+// CHECK:         %[[EXPANDED:.+]] = tensor.expand_shape %[[INPUT]] {{\[}}[0], [1, 2]] output_shape [1, 32, 1024]
+// CHECK:         %[[PARTIAL_VAL_INIT:.+]] = linalg.fill {{.+}} -> tensor<1x32xf32>
+// CHECK:         %[[PARTIAL_IDX_INIT:.+]] = linalg.fill {{.+}} -> tensor<1x32xi64>
+// CHECK:         %[[PARTIAL:.+]]:2 = linalg.generic
+// CHECK-SAME:      indexing_maps = [#[[$ARG_IN_MAP]], #[[$ARG_PARTIAL_MAP]], #[[$ARG_PARTIAL_MAP]]]
+// CHECK-SAME:      iterator_types = ["parallel", "parallel", "reduction"]
+// CHECK-SAME:      ins(%[[EXPANDED]] : tensor<1x32x1024xf32>)
+// CHECK-SAME:      outs(%[[PARTIAL_VAL_INIT]], %[[PARTIAL_IDX_INIT]] :
+// CHECK:           %[[CHUNK:.+]] = linalg.index 1 : index
+// CHECK:           %[[OFFSET:.+]] = linalg.index 2 : index
+// CHECK:           %[[START:.+]] = arith.muli %[[CHUNK]], %[[C1024]] : index
+// CHECK:           %[[POS:.+]] = arith.addi %[[START]], %[[OFFSET]] : index
+// CHECK:           arith.index_cast %[[POS]] : index to i64
+// CHECK:         %[[RESULT:.+]]:2 = linalg.generic
+// CHECK-SAME:      indexing_maps = [#[[$ARG_CHUNK_MAP]], #[[$ARG_CHUNK_MAP]], #[[$ARG_OUT_MAP]], #[[$ARG_OUT_MAP]]]
+// CHECK-SAME:      iterator_types = ["parallel", "reduction"]
+// CHECK-SAME:      ins(%[[PARTIAL]]#0, %[[PARTIAL]]#1 : tensor<1x32xf32>, tensor<1x32xi64>)
+// CHECK:           ^bb0(%{{.+}}: f32, %[[PARTIAL_IDX:.+]]: i64, %{{.+}}: f32, %{{.+}}: i64):
+// CHECK:             %[[IDX:.+]] = arith.index_cast %[[PARTIAL_IDX]] : i64 to index
+// CHECK:             arith.index_cast %[[IDX]] : index to i64
+// CHECK:             arith.maximumf
+// CHECK:             arith.select
+// CHECK:         util.return %[[RESULT]]#0, %[[RESULT]]#1
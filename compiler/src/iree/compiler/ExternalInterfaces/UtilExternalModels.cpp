@@ -12,12 +12,15 @@
 #include "iree/compiler/Dialect/Encoding/IR/EncodingOps.h"
 #include "iree/compiler/Dialect/LinalgExt/IR/LinalgExtDialect.h"
 #include "iree/compiler/Dialect/LinalgExt/IR/LinalgExtOps.h"
+#include "iree/compiler/Dialect/Util/IR/UtilDialect.h"
+#include "iree/compiler/Dialect/Util/IR/UtilOps.h"
 #include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/MLProgram/IR/MLProgram.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/IR/Matchers.h"
+#include "mlir/Interfaces/ValueBoundsOpInterface.h"
 
 namespace mlir::iree_compiler {
 
@@ -331,6 +334,32 @@ struct HoistableLinalgOpInterface
   bool isOperandHoistable(Operation *, OpOperand *) const { return true; }
 };
 
+//===----------------------------------------------------------------------===//
+// ValueBoundsOpInterface
+//===----------------------------------------------------------------------===//
+
+/// Exposes the ranges memorialized by `util.assume.int` to the value bounds
+/// analysis so that dynamic sizes with known upper bounds (e.g. from symbolic
+/// shape ranges bound in the input program) can be used to derive static
+/// tile and vector sizes.
+struct AssumeIntValueBoundsOpInterface
+    : public ValueBoundsOpInterface::ExternalModel<
+          AssumeIntValueBoundsOpInterface, IREE::Util::AssumeIntOp> {
+  void populateBoundsForIndexValue(Operation *op, Value value,
+                                   ValueBoundsConstraintSet &cstr) const {
+    auto assumeOp = cast<IREE::Util::AssumeIntOp>(op);
+    unsigned resultNumber = cast<OpResult>(value).getResultNumber();
+    cstr.bound(value) == assumeOp.getOperand(resultNumber);
+    auto [umin, umax] = assumeOp.getUnionedUnsignedRange(resultNumber);
+    if (umin) {
+      cstr.bound(value) >= static_cast<int64_t>(*umin);
+    }
+    if (umax) {
+      cstr.bound(value) <= static_cast<int64_t>(*umax);
+    }
+  }
+};
+
 /// Helper structures that iterates over all Op types in `OpTys` and registers
 /// the associated Hoistable___OpInterface.
 template <typename... Ops>
@@ -399,6 +428,12 @@ void registerUtilExternalModels(DialectRegistry &registry) {
             *context);
       });
 
+  registry.addExtension(
+      +[](MLIRContext *context, IREE::Util::UtilDialect *dialect) {
+        IREE::Util::AssumeIntOp::attachInterface<
+            AssumeIntValueBoundsOpInterface>(*context);
+      });
+
   registry.addExtension(+[](MLIRContext *context,
                             IREE::GPU::IREEGPUDialect *dialect) {
     IREE::GPU::MultiMmaOp::attachInterface<MultiMmaOpTiedOpInterface>(*context);
@@ -0,0 +1,165 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/GlobalOptimization/Passes.h"
+#include "iree/compiler/GlobalOptimization/Utils.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringSwitch.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/IR/LinalgInterfaces.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+namespace mlir::iree_compiler::GlobalOptimization {
+
+#define GEN_PASS_DEF_AUTOCASTCONTRACTIONSPASS
+#include "iree/compiler/GlobalOptimization/Passes.h.inc"
+
+/// Name of the attribute used to override the policy for a single op. The
+/// value is a float type; `f32` keeps the op in full precision.
+static constexpr StringLiteral kAutocastAttrName = "iree.autocast";
+
+/// Returns the float type named |name| if it is a supported autocast target.
+static FloatType parseTargetType(MLIRContext *context, StringRef name) {
+  Builder builder(context);
+  return llvm::StringSwitch<FloatType>(name)
+      .Case("f32", builder.getF32Type())
+      .Case("f16", builder.getF16Type())
+      .Case("bf16", builder.getBF16Type())
+      .Case("f8E4M3FN", builder.getFloat8E4M3FNType())
+      .Case("f8E5M2", builder.getFloat8E5M2Type())
+      .Case("f8E4M3FNUZ", builder.getFloat8E4M3FNUZType())
+      .Case("f8E5M2FNUZ", builder.getFloat8E5M2FNUZType())
+      .Default(nullptr);
+}
+
+/// Returns true if all values of the constant |value| are finite in
+/// |targetType|. Inputs that are not constant are assumed to be in range.
+static bool isRepresentableIn(Value value, FloatType targetType) {
+  DenseFPElementsAttr elementsAttr;
+  if (!matchPattern(value, m_Constant(&elementsAttr))) {
+    return true;
+  }
+  for (APFloat element : elementsAttr.getValues<APFloat>()) {
+    bool losesInfo = false;
+    APFloat::opStatus status =
+        element.convert(targetType.getFloatSemantics(),
+                        APFloat::rmNearestTiesToEven, &losesInfo);
+    if ((status & APFloat::opOverflow) || !element.isFinite()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+namespace {
+
+/// Per-op precision policy. Target types are keyed by op name (e.g.
+/// `linalg.batch_matmul`) or by op class (`matmul`, `conv` or `all`).
+struct AutocastPolicy {
+  llvm::StringMap<FloatType> targetTypes;
+
+  /// Returns the type the inputs of |linalgOp| should be cast to or null if
+  /// the op has no policy.
+  FloatType lookup(linalg::LinalgOp linalgOp) const {
+    if (auto typeAttr = linalgOp->getAttrOfType<TypeAttr>(kAutocastAttrName)) {
+      return dyn_cast<FloatType>(typeAttr.getValue());
+    }
+    StringRef opClass =
+        isa<linalg::ContractionOpInterface>(linalgOp.getOperation())
+            ? "matmul"
+            : "conv";
+    for (StringRef key :
+         {linalgOp->getName().getStringRef(), opClass, StringRef("all")}) {
+      auto it = targetTypes.find(key);
+      if (it != targetTypes.end()) {
+        return it->second;
+      }
+    }
+    return nullptr;
+  }
+};
+
+/// Casts the f32 inputs of matmul-like and convolution ops to the type
+/// selected by the policy. Accumulation stays in f32.
+struct AutocastContractionPattern
+    : public OpInterfaceRewritePattern<linalg::LinalgOp> {
+  AutocastContractionPattern(MLIRContext *context,
+                             const AutocastPolicy &policy)
+      : OpInterfaceRewritePattern<linalg::LinalgOp>(context), policy(policy) {}
+
+  LogicalResult matchAndRewrite(linalg::LinalgOp linalgOp,
+                                PatternRewriter &rewriter) const override {
+    if (!isa<linalg::ContractionOpInterface, linalg::ConvolutionOpInterface>(
+            linalgOp.getOperation())) {
+      return failure();
+    }
+    if (!llvm::all_of(linalgOp->getOperands(), [&](Value operand) {
+          auto operandType = dyn_cast<RankedTensorType>(operand.getType());
+          return operandType && operandType.getElementType().isF32();
+        })) {
+      return failure();
+    }
+
+    FloatType targetType = policy.lookup(linalgOp);
+    if (!targetType || targetType.getWidth() >= 32) {
+      return rewriter.notifyMatchFailure(linalgOp, "kept in full precision");
+    }
+
+    // Constant inputs, typically weights, that would overflow the target type
+    // are too sensitive to be cast.
+    for (OpOperand *input : linalgOp.getDpsInputOperands()) {
+      if (!isRepresentableIn(input->get(), targetType)) {
+        return rewriter.notifyMatchFailure(linalgOp,
+                                           "constant input out of range");
+      }
+    }
+    return demoteContractionInputs(rewriter, linalgOp, targetType);
+  }
+
+private:
+  const AutocastPolicy &policy;
+};
+
+class AutocastContractionsPass
+    : public impl::AutocastContractionsPassBase<AutocastContractionsPass> {
+public:
+  using impl::AutocastContractionsPassBase<
+      AutocastContractionsPass>::AutocastContractionsPassBase;
+
+  LogicalResult initialize(MLIRContext *context) override {
+    for (const std::string &spec : policySpecs) {
+      auto [key, typeName] = StringRef(spec).split('=');
+      FloatType type = parseTargetType(context, typeName.trim());
+      if (key.trim().empty() || !type) {
+        return emitError(UnknownLoc::get(context))
+               << "invalid autocast policy `" << spec
+               << "`; expected `<op name|matmul|conv|all>=<float type>`";
+      }
+      policy.targetTypes[key.trim()] = type;
+    }
+    return success();
+  }
+
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.insert<AutocastContractionPattern>(context, policy);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns)))) {
+      return signalPassFailure();
+    }
+  }
+
+private:
+  AutocastPolicy policy;
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::GlobalOptimization
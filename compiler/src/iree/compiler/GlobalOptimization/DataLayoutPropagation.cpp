@@ -5,6 +5,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include "iree/compiler/GlobalOptimization/Passes.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Transforms/Transforms.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
@@ -16,6 +17,47 @@ namespace mlir::iree_compiler::GlobalOptimization {
 
 namespace {
 
+// Returns true if |unpackOp| and |packOp| use the same tiled layout, so that
+// pack(unpack(x)) folds to x once the ops in between are moved out of the way.
+static bool isSameTiledLayout(tensor::UnPackOp unpackOp,
+                              tensor::PackOp packOp) {
+  return unpackOp.getInnerDimsPos() == packOp.getInnerDimsPos() &&
+         unpackOp.getOuterDimsPerm() == packOp.getOuterDimsPerm() &&
+         unpackOp.getStaticInnerTiles() == packOp.getStaticInnerTiles() &&
+         !ShapedType::isDynamicShape(packOp.getStaticInnerTiles());
+}
+
+// Returns true if |op| is an elementwise generic op with identity indexing
+// maps, i.e. one that can compute directly on the tiled layout.
+static bool isIdentityElementwiseOp(Operation *op) {
+  auto genericOp = dyn_cast_if_present<linalg::GenericOp>(op);
+  if (!genericOp || !linalg::isElementwise(genericOp)) {
+    return false;
+  }
+  return llvm::all_of(genericOp.getIndexingMapsArray(),
+                      [](AffineMap map) { return map.isIdentity(); });
+}
+
+// Returns true if moving the layout change across the elementwise
+// |genericOp| turns an unpack -> |genericOp| -> pack sequence into a pair of
+// pack/unpack ops that cancel out. This is the case between consecutive
+// data-tiled contractions, where the intermediate would otherwise be unpacked
+// to the plain layout only to be packed again.
+static bool isPackUnpackRoundTrip(linalg::GenericOp genericOp) {
+  if (!isIdentityElementwiseOp(genericOp) || genericOp->getNumResults() != 1 ||
+      !genericOp->hasOneUse()) {
+    return false;
+  }
+  auto packOp = dyn_cast<tensor::PackOp>(*genericOp->user_begin());
+  if (!packOp) {
+    return false;
+  }
+  return llvm::any_of(genericOp.getDpsInputs(), [&](Value input) {
+    auto unpackOp = input.getDefiningOp<tensor::UnPackOp>();
+    return unpackOp && isSameTiledLayout(unpackOp, packOp);
+  });
+}
+
 struct DataLayoutPropagationPass
     : public impl::DataLayoutPropagationPassBase<DataLayoutPropagationPass> {
   void runOnOperation() override {
@@ -28,13 +70,23 @@ struct DataLayoutPropagationPass
           Operation *producer = opOperand->get().getDefiningOp();
           Operation *consumer = opOperand->getOwner();
           if (isa<tensor::PackOp>(consumer)) {
+            if (auto genericOp =
+                    dyn_cast_if_present<linalg::GenericOp>(producer)) {
+              return isPackUnpackRoundTrip(genericOp);
+            }
             return isa<tensor::CollapseShapeOp>(producer);
           }
           if (isa<tensor::UnPackOp>(producer)) {
+            if (auto genericOp = dyn_cast<linalg::GenericOp>(consumer)) {
+              return isPackUnpackRoundTrip(genericOp);
+            }
             return isa<tensor::ExpandShapeOp>(consumer);
           }
           return false;
         });
+    // Fold the pack(unpack) pairs exposed by the propagation.
+    tensor::PackOp::getCanonicalizationPatterns(patterns, context);
+    tensor::UnPackOp::getCanonicalizationPatterns(patterns, context);
     if (failed(applyPatternsAndFoldGreedily(funcOp, std::move(patterns)))) {
       funcOp.emitOpError("folding patterns failed");
       return signalPassFailure();
@@ -0,0 +1,336 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/GlobalOptimization/Passes.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Linalg/IR/LinalgInterfaces.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+namespace mlir::iree_compiler::GlobalOptimization {
+
+#define GEN_PASS_DEF_HOISTMATMULSCALESPASS
+#include "iree/compiler/GlobalOptimization/Passes.h.inc"
+
+namespace {
+
+/// A matmul operand computed as `extf(quantized) [* scale]` from an 8-bit
+/// float tensor.
+struct DequantizedOperand {
+  Value quantized;
+  // Scale tensor or captured scalar. Null if the operand is not scaled.
+  Value scale;
+  // Map from the matmul result dimensions to the scale tensor dimensions.
+  // Null for scalar scales.
+  AffineMap scaleMap;
+};
+
+} // namespace
+
+static bool isFP8Type(Type type) {
+  auto floatType = dyn_cast<FloatType>(getElementTypeOrSelf(type));
+  return floatType && floatType.getWidth() == 8;
+}
+
+/// Returns the map from the result dimensions of |matmulOp| to the dimensions
+/// of a scale tensor accessed with |scaleMap| in the iteration space of
+/// |matmulOp|. Fails if the scale varies along a reduction dimension, e.g. for
+/// per-block scales along K, as such scales cannot be applied to the result.
+static FailureOr<AffineMap> getScaleMapInResultSpace(linalg::LinalgOp matmulOp,
+                                                     AffineMap scaleMap) {
+  AffineMap resultMap =
+      matmulOp.getMatchingIndexingMap(matmulOp.getDpsInitOperand(0));
+  SmallVector<AffineExpr> exprs;
+  for (AffineExpr expr : scaleMap.getResults()) {
+    if (isa<AffineConstantExpr>(expr)) {
+      exprs.push_back(expr);
+      continue;
+    }
+    auto dimExpr = dyn_cast<AffineDimExpr>(expr);
+    if (!dimExpr) {
+      return failure();
+    }
+    std::optional<unsigned> resultPos = resultMap.getResultPosition(dimExpr);
+    if (!resultPos) {
+      return failure();
+    }
+    exprs.push_back(getAffineDimExpr(*resultPos, matmulOp.getContext()));
+  }
+  return AffineMap::get(resultMap.getNumResults(), /*symbolCount=*/0, exprs,
+                        matmulOp.getContext());
+}
+
+/// Matches |operand| of |matmulOp| against an elementwise dequantization of an
+/// 8-bit float tensor with an optional scale that does not vary along the
+/// reduction dimensions of |matmulOp|.
+static std::optional<DequantizedOperand>
+matchDequantizedOperand(linalg::LinalgOp matmulOp, OpOperand *operand) {
+  auto dequantOp = operand->get().getDefiningOp<linalg::GenericOp>();
+  if (!dequantOp || dequantOp.getNumDpsInits() != 1 ||
+      dequantOp.getNumParallelLoops() != dequantOp.getNumLoops() ||
+      !dequantOp.getMatchingIndexingMap(dequantOp.getDpsInitOperand(0))
+           .isIdentity()) {
+    return std::nullopt;
+  }
+
+  auto yieldOp = cast<linalg::YieldOp>(dequantOp.getBody()->getTerminator());
+  Value dequantized = yieldOp.getOperand(0);
+  Value scale;
+  if (auto mulOp = dequantized.getDefiningOp<arith::MulFOp>()) {
+    dequantized = mulOp.getLhs();
+    scale = mulOp.getRhs();
+    if (!dequantized.getDefiningOp<arith::ExtFOp>()) {
+      std::swap(dequantized, scale);
+    }
+  }
+  auto extOp = dequantized.getDefiningOp<arith::ExtFOp>();
+  if (!extOp) {
+    return std::nullopt;
+  }
+  auto quantizedArg = dyn_cast<BlockArgument>(extOp.getIn());
+  if (!quantizedArg || quantizedArg.getOwner() != dequantOp.getBody()) {
+    return std::nullopt;
+  }
+  OpOperand *quantizedOperand = dequantOp.getMatchingOpOperand(quantizedArg);
+  if (!dequantOp.isDpsInput(quantizedOperand) ||
+      !isFP8Type(quantizedOperand->get().getType()) ||
+      !dequantOp.getMatchingIndexingMap(quantizedOperand).isIdentity()) {
+    return std::nullopt;
+  }
+
+  DequantizedOperand result;
+  result.quantized = quantizedOperand->get();
+  if (!scale) {
+    return result;
+  }
+
+  // Scalars defined above the dequantization are used as-is.
+  if (scale.getParentRegion()->isProperAncestor(&dequantOp.getRegion())) {
+    result.scale = scale;
+    return result;
+  }
+
+  auto scaleArg = dyn_cast<BlockArgument>(scale);
+  if (!scaleArg || scaleArg.getOwner() != dequantOp.getBody() ||
+      scaleArg == quantizedArg) {
+    return std::nullopt;
+  }
+  OpOperand *scaleOperand = dequantOp.getMatchingOpOperand(scaleArg);
+  if (!dequantOp.isDpsInput(scaleOperand)) {
+    return std::nullopt;
+  }
+  AffineMap scaleMap = dequantOp.getMatchingIndexingMap(scaleOperand)
+                           .compose(matmulOp.getMatchingIndexingMap(operand));
+  SmallVector<utils::IteratorType> iteratorTypes =
+      matmulOp.getIteratorTypesArray();
+  for (AffineExpr expr : scaleMap.getResults()) {
+    auto dimExpr = dyn_cast<AffineDimExpr>(expr);
+    if (dimExpr && iteratorTypes[dimExpr.getPosition()] !=
+                       utils::IteratorType::parallel) {
+      return std::nullopt;
+    }
+  }
+  FailureOr<AffineMap> resultScaleMap =
+      getScaleMapInResultSpace(matmulOp, scaleMap);
+  if (failed(resultScaleMap)) {
+    return std::nullopt;
+  }
+  result.scale = scaleOperand->get();
+  result.scaleMap = *resultScaleMap;
+  return result;
+}
+
+/// Returns true if the body of |linalgOp| computes `out + ext(a) * ext(b)`
+/// where the extensions are optional.
+static bool hasMatmulBody(linalg::LinalgOp linalgOp) {
+  Block *body = linalgOp.getBlock();
+  auto yieldOp = cast<linalg::YieldOp>(body->getTerminator());
+  auto addOp = yieldOp->getOperand(0).getDefiningOp<arith::AddFOp>();
+  if (!addOp) {
+    return false;
+  }
+  Value outArg = body->getArgument(2);
+  if (addOp.getLhs() != outArg && addOp.getRhs() != outArg) {
+    return false;
+  }
+  Value product = addOp.getLhs() == outArg ? addOp.getRhs() : addOp.getLhs();
+  auto mulOp = product.getDefiningOp<arith::MulFOp>();
+  if (!mulOp) {
+    return false;
+  }
+  auto getInputArgNumber = [&](Value value) -> std::optional<unsigned> {
+    if (auto extOp = value.getDefiningOp<arith::ExtFOp>()) {
+      value = extOp.getIn();
+    }
+    auto arg = dyn_cast<BlockArgument>(value);
+    if (!arg || arg.getOwner() != body || arg.getArgNumber() > 1) {
+      return std::nullopt;
+    }
+    return arg.getArgNumber();
+  };
+  std::optional<unsigned> lhsArg = getInputArgNumber(mulOp.getLhs());
+  std::optional<unsigned> rhsArg = getInputArgNumber(mulOp.getRhs());
+  return lhsArg && rhsArg && *lhsArg != *rhsArg;
+}
+
+/// Converts the float |value| to |type| by extension or truncation.
+static Value convertFloat(OpBuilder &builder, Location loc, Value value,
+                          FloatType type) {
+  auto valueType = cast<FloatType>(value.getType());
+  if (valueType.getWidth() < type.getWidth()) {
+    return builder.create<arith::ExtFOp>(loc, type, value);
+  }
+  if (valueType.getWidth() > type.getWidth()) {
+    return builder.create<arith::TruncFOp>(loc, type, value);
+  }
+  return value;
+}
+
+namespace {
+
+/// Rewrites a matmul of two scaled 8-bit float tensors
+///
+///   matmul(extf(A) * sa, extf(B) * sb)
+///
+/// into a matmul of the 8-bit float tensors followed by the scaling of the
+/// result
+///
+///   matmul(extf(A), extf(B)) * sa * sb
+///
+/// so that the contraction can be lowered to FP8 MMA intrinsics. This is only
+/// valid for scales that are constant along the reduction dimensions, i.e.
+/// per-tensor, per-row and per-column scales.
+struct HoistMatmulScalesPattern
+    : public OpInterfaceRewritePattern<linalg::LinalgOp> {
+  using OpInterfaceRewritePattern<linalg::LinalgOp>::OpInterfaceRewritePattern;
+
+  LogicalResult matchAndRewrite(linalg::LinalgOp linalgOp,
+                                PatternRewriter &rewriter) const override {
+    if (!linalg::isaContractionOpInterface(linalgOp) ||
+        linalgOp.getNumDpsInputs() != 2 || linalgOp.getNumDpsInits() != 1 ||
+        !linalgOp.hasPureTensorSemantics() || !hasMatmulBody(linalgOp)) {
+      return failure();
+    }
+
+    // The scales can only be applied to the result if the accumulation starts
+    // from zero.
+    OpOperand *initOperand = linalgOp.getDpsInitOperand(0);
+    auto fillOp = initOperand->get().getDefiningOp<linalg::FillOp>();
+    if (!fillOp || !matchPattern(fillOp.value(), m_AnyZeroFloat())) {
+      return failure();
+    }
+    auto resultType = cast<RankedTensorType>(initOperand->get().getType());
+    auto accType = dyn_cast<FloatType>(resultType.getElementType());
+    if (!accType || accType.getWidth() <= 8) {
+      return failure();
+    }
+
+    SmallVector<DequantizedOperand> operands;
+    for (OpOperand *operand : linalgOp.getDpsInputOperands()) {
+      std::optional<DequantizedOperand> dequantized =
+          matchDequantizedOperand(linalgOp, operand);
+      if (!dequantized) {
+        return failure();
+      }
+      // Conversions between different float types of the same width are not
+      // supported by arith.extf/arith.truncf.
+      if (dequantized->scale) {
+        auto scaleType =
+            cast<FloatType>(getElementTypeOrSelf(dequantized->scale));
+        if (scaleType != accType &&
+            scaleType.getWidth() == accType.getWidth()) {
+          return failure();
+        }
+      }
+      operands.push_back(*dequantized);
+    }
+
+    Location loc = linalgOp.getLoc();
+    Value matmul =
+        rewriter
+            .create<linalg::GenericOp>(
+                loc, TypeRange{resultType},
+                ValueRange{operands[0].quantized, operands[1].quantized},
+                ValueRange{initOperand->get()},
+                linalgOp.getIndexingMapsArray(),
+                linalgOp.getIteratorTypesArray(),
+                [&](OpBuilder &b, Location loc, ValueRange args) {
+                  Value lhs = b.create<arith::ExtFOp>(loc, accType, args[0]);
+                  Value rhs = b.create<arith::ExtFOp>(loc, accType, args[1]);
+                  Value mul = b.create<arith::MulFOp>(loc, lhs, rhs);
+                  Value add = b.create<arith::AddFOp>(loc, args[2], mul);
+                  b.create<linalg::YieldOp>(loc, add);
+                })
+            ->getResult(0);
+
+    if (llvm::none_of(operands, [](const DequantizedOperand &operand) {
+          return operand.scale;
+        })) {
+      rewriter.replaceOp(linalgOp, matmul);
+      return success();
+    }
+
+    // Apply the scales to the result of the matmul. Scale tensors are inputs
+    // of the scaling op and scalar scales are captured in its body.
+    int64_t rank = resultType.getRank();
+    AffineMap identityMap = rewriter.getMultiDimIdentityMap(rank);
+    SmallVector<Value> inputs = {matmul};
+    SmallVector<AffineMap> maps = {identityMap};
+    for (const DequantizedOperand &operand : operands) {
+      if (operand.scaleMap) {
+        inputs.push_back(operand.scale);
+        maps.push_back(operand.scaleMap);
+      }
+    }
+    maps.push_back(identityMap);
+    SmallVector<utils::IteratorType> iteratorTypes(
+        rank, utils::IteratorType::parallel);
+    Value empty = rewriter.create<tensor::EmptyOp>(
+        loc, tensor::getMixedSizes(rewriter, loc, initOperand->get()),
+        accType);
+    auto scaleOp = rewriter.create<linalg::GenericOp>(
+        loc, TypeRange{resultType}, inputs, ValueRange{empty}, maps,
+        iteratorTypes, [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value result = args[0];
+          unsigned argIndex = 1;
+          for (const DequantizedOperand &operand : operands) {
+            if (!operand.scale) {
+              continue;
+            }
+            Value scale = operand.scaleMap ? args[argIndex++] : operand.scale;
+            result = b.create<arith::MulFOp>(
+                loc, result, convertFloat(b, loc, scale, accType));
+          }
+          b.create<linalg::YieldOp>(loc, result);
+        });
+    rewriter.replaceOp(linalgOp, scaleOp->getResults());
+    return success();
+  }
+};
+
+struct HoistMatmulScalesPass
+    : public impl::HoistMatmulScalesPassBase<HoistMatmulScalesPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    tensor::TensorDialect>();
+  }
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    RewritePatternSet patterns(context);
+    patterns.insert<HoistMatmulScalesPattern>(context);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns)))) {
+      return signalPassFailure();
+    }
+  }
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::GlobalOptimization
@@ -62,6 +62,15 @@ public:
     deviceAnalysis.gatherAllExecutableTargets(executableTargets);
     OpPassManager passManager(moduleOp.getOperationName());
     if (executableTargets.size() != 1) {
+      // With multiple targets the encodings are resolved per function based on
+      // the affinity of the resources it uses: functions that only run on a
+      // CPU device get that device's data-tiled layout and everything else
+      // drops its encodings.
+      if (llvm::any_of(executableTargets, [](auto executableTarget) {
+            return executableTarget.getBackend() == "llvm-cpu";
+          })) {
+        passManager.addPass(createCPUMaterializeHostEncodingPass());
+      }
       addNopPipeline(passManager);
       if (failed(runPipeline(passManager, moduleOp))) {
         return signalPassFailure();
@@ -24,6 +24,17 @@ static llvm::cl::opt<bool> clEnableQuantizedMatmulReassociation(
     llvm::cl::desc(
         "Enables reassociation of quantized matmul ops (experimental)."),
     llvm::cl::init(false));
+static llvm::cl::opt<bool> clEnableHoistMatmulScales(
+    "iree-global-opt-enable-hoist-matmul-scales",
+    llvm::cl::desc("Enables hoisting per-tensor and per-channel scales of FP8 "
+                   "matmul operands onto the matmul result (experimental)."),
+    llvm::cl::init(false));
+static llvm::cl::opt<bool> clEnableCalibratedQuantization(
+    "iree-global-opt-enable-calibrated-quantization",
+    llvm::cl::desc("Enables quantizing f32 matmuls to i8 based on the "
+                   "`iree.calibration.range` annotations of their operands "
+                   "(experimental)."),
+    llvm::cl::init(false));
 static llvm::cl::opt<bool> clEnableFuseSiluHorizontalMatmul(
     "iree-global-opt-enable-fuse-silu-horizontal-matmul",
     llvm::cl::desc(
@@ -58,6 +69,14 @@ static llvm::cl::opt<DemotionOption> clDemoteContractionInputsToBF16Strategy(
         clEnumValN(DemotionOption::None, "none", "Demote no contraction ops.")),
     llvm::cl::init(DemotionOption::None));
 
+static llvm::cl::list<std::string> clAutocastPolicy(
+    "iree-global-opt-autocast-policy",
+    llvm::cl::desc("Casts the inputs of f32 contraction ops to lower precision "
+                   "types following the given comma-separated "
+                   "`<op name|matmul|conv|all>=<type>` policy entries "
+                   "(experimental)."),
+    llvm::cl::CommaSeparated);
+
 static llvm::cl::opt<int> clPadFactor(
     "iree-global-opt-pad-factor",
     llvm::cl::desc("provides padding size hints that will be attached to "
@@ -69,6 +88,7 @@ void buildGlobalOptExprHoistingPassPipeline(
   IREE::Util::ExprHoistingOptions options;
   options.maxSizeIncreaseThreshold =
       transformOptions.options.constExprMaxSizeIncreaseThreshold;
+  options.memoryBudget = transformOptions.options.constExprMemoryBudget;
   options.registerDependentDialectsFn = [](DialectRegistry &registry) {
     registry.insert<IREE::Flow::FlowDialect>();
   };
@@ -93,6 +113,19 @@ void buildGlobalOptimizationPassPipeline(
         importParametersOptions));
   }
 
+  // Externalize large constants before anything else touches them. Passes
+  // after this only see parameter references and the constant data is
+  // released from the context once written to the archive.
+  if (!transformOptions.options.parameterExternalizePath.empty()) {
+    IREE::IO::Parameters::ExportParametersPassOptions exportParametersOptions;
+    exportParametersOptions.scopePath =
+        transformOptions.options.parameterExternalizePath;
+    exportParametersOptions.minimumSize =
+        transformOptions.options.parameterExternalizeMinimumSize;
+    mainPassManager.addPass(IREE::IO::Parameters::createExportParametersPass(
+        exportParametersOptions));
+  }
+
   // Preprocessing passes to get the program into a canonical state.
   FunctionLikeNest(mainPassManager)
       .addPredicatedPass(transformOptions.options.stripAssertions,
@@ -137,10 +170,20 @@ void buildGlobalOptimizationPassPipeline(
   FunctionLikeNest(mainPassManager)
       .addPredicatedPass(clEnableFuseSiluHorizontalMatmul,
                          createFuseSiluHorizontalMatmulPass)
+      .addPredicatedPass(clEnableHoistMatmulScales, createHoistMatmulScalesPass)
+      .addPredicatedPass(clEnableCalibratedQuantization,
+                         createQuantizeCalibratedContractionsPass)
       .addPass([&]() {
         return createDemoteContractionInputsToBF16Pass(
             clDemoteContractionInputsToBF16Strategy);
       })
+      .addPredicatedPass(!clAutocastPolicy.empty(),
+                         [&]() {
+                           AutocastContractionsPassOptions options;
+                           options.policySpecs.assign(clAutocastPolicy.begin(),
+                                                      clAutocastPolicy.end());
+                           return createAutocastContractionsPass(options);
+                         })
       .addPredicatedPass(clEnableQuantizedMatmulReassociation,
                          createFuseDequantizationMatmulPass)
       .addPass(IREE::Flow::createCanonicalizerPass)
@@ -231,6 +274,10 @@ void buildGlobalOptimizationPassPipeline(
   // constants that aren't exported and skip it for larger parameters, but this
   // is a sensible place for the common case of wanting const-eval in the final
   // artifact + archive.
+  // When data tiling is enabled and weights are imported this also bakes the
+  // pack ops into the archive: the hoisted globals hold the packed
+  // target-specific layout, which is recorded in the entry metadata and
+  // verified when the archive is imported again.
   if (!transformOptions.options.parameterExportPath.empty()) {
     IREE::IO::Parameters::ExportParametersPassOptions exportParametersOptions;
     exportParametersOptions.scopePath =
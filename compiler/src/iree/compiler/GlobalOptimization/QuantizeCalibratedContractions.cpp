@@ -0,0 +1,249 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cmath>
+#include <limits>
+
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
+#include "iree/compiler/GlobalOptimization/Passes.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Math/IR/Math.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/IR/Matchers.h"
+#include "mlir/IR/PatternMatch.h"
+#include "mlir/Transforms/GreedyPatternRewriteDriver.h"
+
+namespace mlir::iree_compiler::GlobalOptimization {
+
+#define GEN_PASS_DEF_QUANTIZECALIBRATEDCONTRACTIONSPASS
+#include "iree/compiler/GlobalOptimization/Passes.h.inc"
+
+/// Name of the `array<f32: min, max>` attribute carrying the calibrated range
+/// of a value. It is attached to the single-result op defining the value or to
+/// the function argument.
+static constexpr StringLiteral kCalibrationRangeAttrName =
+    "iree.calibration.range";
+
+/// Largest magnitude representable by the symmetric signed 8-bit encoding.
+static constexpr float kQuantizedMax = 127.0f;
+
+namespace {
+
+struct FloatRange {
+  float min;
+  float max;
+};
+
+} // namespace
+
+static std::optional<FloatRange> getRangeFromAttr(DenseF32ArrayAttr attr) {
+  if (!attr || attr.size() != 2 || attr[0] > attr[1]) {
+    return std::nullopt;
+  }
+  return FloatRange{attr[0], attr[1]};
+}
+
+static std::optional<FloatRange> getRangeFromElements(Attribute attr) {
+  auto elementsAttr = dyn_cast_if_present<DenseFPElementsAttr>(attr);
+  if (!elementsAttr || elementsAttr.empty()) {
+    return std::nullopt;
+  }
+  FloatRange range = {std::numeric_limits<float>::max(),
+                      std::numeric_limits<float>::lowest()};
+  for (APFloat value : elementsAttr.getValues<APFloat>()) {
+    float f = value.convertToFloat();
+    range.min = std::min(range.min, f);
+    range.max = std::max(range.max, f);
+  }
+  return range;
+}
+
+/// Returns the range of |value| as recorded by calibration or, for constants
+/// and immutable globals, as computed from their contents.
+static std::optional<FloatRange>
+getCalibratedRange(Value value, SymbolTableCollection &symbolTables) {
+  if (auto arg = dyn_cast<BlockArgument>(value)) {
+    auto funcOp =
+        dyn_cast<FunctionOpInterface>(arg.getOwner()->getParentOp());
+    if (!funcOp || !arg.getOwner()->isEntryBlock()) {
+      return std::nullopt;
+    }
+    return getRangeFromAttr(funcOp.getArgAttrOfType<DenseF32ArrayAttr>(
+        arg.getArgNumber(), kCalibrationRangeAttrName));
+  }
+
+  Operation *op = value.getDefiningOp();
+  if (op->getNumResults() == 1) {
+    if (auto range = getRangeFromAttr(
+            op->getAttrOfType<DenseF32ArrayAttr>(kCalibrationRangeAttrName))) {
+      return range;
+    }
+  }
+  Attribute constantAttr;
+  if (matchPattern(value, m_Constant(&constantAttr))) {
+    return getRangeFromElements(constantAttr);
+  }
+  if (auto loadOp = dyn_cast<IREE::Util::GlobalLoadOpInterface>(op)) {
+    auto globalOp = IREE::Util::lookupGlobalOp(loadOp, loadOp.getGlobalAttr(),
+                                               symbolTables);
+    if (globalOp && !globalOp.isGlobalMutable()) {
+      return getRangeFromElements(globalOp.getGlobalInitialValue());
+    }
+  }
+  return std::nullopt;
+}
+
+/// Returns the scale of the symmetric signed 8-bit quantization of |range|.
+static std::optional<float> getSymmetricScale(FloatRange range) {
+  float absMax = std::max(std::abs(range.min), std::abs(range.max));
+  if (absMax == 0.0f || !std::isfinite(absMax)) {
+    return std::nullopt;
+  }
+  return absMax / kQuantizedMax;
+}
+
+/// Quantizes the f32 tensor |value| to i8 as
+/// `clamp(roundeven(value / scale), -127, 127)`.
+static Value quantize(OpBuilder &builder, Location loc, Value value,
+                      float scale) {
+  auto type = cast<RankedTensorType>(value.getType());
+  Type i8Type = builder.getI8Type();
+  Value empty = builder.create<tensor::EmptyOp>(
+      loc, tensor::getMixedSizes(builder, loc, value), i8Type);
+  AffineMap identityMap = builder.getMultiDimIdentityMap(type.getRank());
+  SmallVector<utils::IteratorType> iteratorTypes(type.getRank(),
+                                                 utils::IteratorType::parallel);
+  Value invScale = builder.create<arith::ConstantOp>(
+      loc, builder.getF32FloatAttr(1.0f / scale));
+  Value minValue = builder.create<arith::ConstantOp>(
+      loc, builder.getF32FloatAttr(-kQuantizedMax));
+  Value maxValue = builder.create<arith::ConstantOp>(
+      loc, builder.getF32FloatAttr(kQuantizedMax));
+  return builder
+      .create<linalg::GenericOp>(
+          loc, empty.getType(), ValueRange{value}, ValueRange{empty},
+          ArrayRef<AffineMap>{identityMap, identityMap}, iteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            Value scaled = b.create<arith::MulFOp>(loc, args[0], invScale);
+            Value rounded = b.create<math::RoundEvenOp>(loc, scaled);
+            Value clamped = b.create<arith::MinimumFOp>(
+                loc, b.create<arith::MaximumFOp>(loc, rounded, minValue),
+                maxValue);
+            Value result = b.create<arith::FPToSIOp>(loc, i8Type, clamped);
+            b.create<linalg::YieldOp>(loc, result);
+          })
+      .getResult(0);
+}
+
+namespace {
+
+/// Rewrites an f32 matmul whose operands have calibrated ranges into an
+/// i8 x i8 -> i32 matmul of the symmetrically quantized operands followed by
+/// the dequantization of the result:
+///
+///   out + sitofp(matmul(quant(A, sa), quant(B, sb))) * sa * sb
+///
+/// Consumers requantize the f32 result against their own calibrated range.
+struct QuantizeCalibratedMatmulPattern
+    : public OpRewritePattern<linalg::MatmulOp> {
+  QuantizeCalibratedMatmulPattern(MLIRContext *context,
+                                  SymbolTableCollection &symbolTables)
+      : OpRewritePattern<linalg::MatmulOp>(context),
+        symbolTables(symbolTables) {}
+
+  LogicalResult matchAndRewrite(linalg::MatmulOp matmulOp,
+                                PatternRewriter &rewriter) const override {
+    if (!matmulOp.hasPureTensorSemantics()) {
+      return failure();
+    }
+    Value lhs = matmulOp.getDpsInputOperand(0)->get();
+    Value rhs = matmulOp.getDpsInputOperand(1)->get();
+    Value init = matmulOp.getDpsInitOperand(0)->get();
+    auto isF32Tensor = [](Value value) {
+      return getElementTypeOrSelf(value.getType()).isF32();
+    };
+    if (!isF32Tensor(lhs) || !isF32Tensor(rhs) || !isF32Tensor(init)) {
+      return rewriter.notifyMatchFailure(matmulOp, "not an f32 matmul");
+    }
+
+    std::optional<FloatRange> lhsRange = getCalibratedRange(lhs, symbolTables);
+    std::optional<FloatRange> rhsRange = getCalibratedRange(rhs, symbolTables);
+    if (!lhsRange || !rhsRange) {
+      return rewriter.notifyMatchFailure(matmulOp, "operands not calibrated");
+    }
+    std::optional<float> lhsScale = getSymmetricScale(*lhsRange);
+    std::optional<float> rhsScale = getSymmetricScale(*rhsRange);
+    if (!lhsScale || !rhsScale) {
+      return rewriter.notifyMatchFailure(matmulOp, "degenerate range");
+    }
+
+    Location loc = matmulOp.getLoc();
+    Value quantizedLhs = quantize(rewriter, loc, lhs, *lhsScale);
+    Value quantizedRhs = quantize(rewriter, loc, rhs, *rhsScale);
+
+    Type i32Type = rewriter.getI32Type();
+    Value accEmpty = rewriter.create<tensor::EmptyOp>(
+        loc, tensor::getMixedSizes(rewriter, loc, init), i32Type);
+    Value zero = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getIntegerAttr(i32Type, 0));
+    Value acc =
+        rewriter.create<linalg::FillOp>(loc, zero, accEmpty).getResult(0);
+    Value quantizedMatmul =
+        rewriter
+            .create<linalg::MatmulOp>(loc, acc.getType(),
+                                      ValueRange{quantizedLhs, quantizedRhs},
+                                      ValueRange{acc})
+            .getResult(0);
+
+    // Dequantize and accumulate into the original init.
+    auto resultType = cast<RankedTensorType>(init.getType());
+    AffineMap identityMap =
+        rewriter.getMultiDimIdentityMap(resultType.getRank());
+    SmallVector<utils::IteratorType> iteratorTypes(
+        resultType.getRank(), utils::IteratorType::parallel);
+    Value scale = rewriter.create<arith::ConstantOp>(
+        loc, rewriter.getF32FloatAttr(*lhsScale * *rhsScale));
+    auto dequantOp = rewriter.create<linalg::GenericOp>(
+        loc, resultType, ValueRange{quantizedMatmul}, ValueRange{init},
+        ArrayRef<AffineMap>{identityMap, identityMap}, iteratorTypes,
+        [&](OpBuilder &b, Location loc, ValueRange args) {
+          Value value =
+              b.create<arith::SIToFPOp>(loc, b.getF32Type(), args[0]);
+          Value scaled = b.create<arith::MulFOp>(loc, value, scale);
+          Value result = b.create<arith::AddFOp>(loc, args[1], scaled);
+          b.create<linalg::YieldOp>(loc, result);
+        });
+    rewriter.replaceOp(matmulOp, dequantOp->getResults());
+    return success();
+  }
+
+private:
+  SymbolTableCollection &symbolTables;
+};
+
+struct QuantizeCalibratedContractionsPass
+    : public impl::QuantizeCalibratedContractionsPassBase<
+          QuantizeCalibratedContractionsPass> {
+  void getDependentDialects(DialectRegistry &registry) const override {
+    registry.insert<arith::ArithDialect, linalg::LinalgDialect,
+                    math::MathDialect, tensor::TensorDialect>();
+  }
+  void runOnOperation() override {
+    MLIRContext *context = &getContext();
+    SymbolTableCollection symbolTables;
+    RewritePatternSet patterns(context);
+    patterns.insert<QuantizeCalibratedMatmulPattern>(context, symbolTables);
+    if (failed(applyPatternsAndFoldGreedily(getOperation(),
+                                            std::move(patterns)))) {
+      return signalPassFailure();
+    }
+  }
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::GlobalOptimization
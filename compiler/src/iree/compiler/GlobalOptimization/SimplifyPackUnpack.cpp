@@ -5,7 +5,9 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include "iree/compiler/GlobalOptimization/Passes.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
 #include "mlir/Dialect/Tensor/Transforms/Transforms.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
 #include "mlir/Pass/Pass.h"
 #include "mlir/Transforms/GreedyPatternRewriteDriver.h"
 
@@ -15,6 +17,59 @@ namespace mlir::iree_compiler::GlobalOptimization {
 #include "iree/compiler/GlobalOptimization/Passes.h.inc"
 
 namespace {
+
+// Folds a tensor.pack that does not move any data into a tensor.expand_shape.
+// This is the case when all inner tiles are unit except for one on the
+// innermost source dimension, such as the LHS of a narrow (M0=1) matmul with
+// a 1xK0 tile. The packed layout is then identical to the row-major source and
+// mmt4d can read the source directly without a separate pack dispatch.
+struct FoldRowMajorPackToExpandShape
+    : public OpRewritePattern<tensor::PackOp> {
+  using OpRewritePattern::OpRewritePattern;
+  LogicalResult matchAndRewrite(tensor::PackOp packOp,
+                                PatternRewriter &rewriter) const override {
+    RankedTensorType sourceType = packOp.getSourceType();
+    int64_t sourceRank = sourceType.getRank();
+    if (sourceRank == 0) {
+      return rewriter.notifyMatchFailure(packOp, "rank-0 source");
+    }
+    ArrayRef<int64_t> outerDimsPerm = packOp.getOuterDimsPerm();
+    if (!outerDimsPerm.empty() && !isIdentityPermutation(outerDimsPerm)) {
+      return rewriter.notifyMatchFailure(packOp, "outer dims are permuted");
+    }
+    ArrayRef<int64_t> innerDimsPos = packOp.getInnerDimsPos();
+    SmallVector<int64_t> innerTiles(packOp.getStaticInnerTiles());
+    for (auto [i, tile] : llvm::enumerate(innerTiles)) {
+      if (tile == 1) {
+        continue;
+      }
+      // Only the innermost dimension may be tiled, evenly, and the tile must
+      // be the innermost dimension of the result.
+      int64_t dimSize = sourceType.getDimSize(sourceRank - 1);
+      if (ShapedType::isDynamic(tile) || i != innerTiles.size() - 1 ||
+          innerDimsPos[i] != sourceRank - 1 || ShapedType::isDynamic(dimSize) ||
+          dimSize % tile != 0) {
+        return rewriter.notifyMatchFailure(packOp, "pack moves data");
+      }
+    }
+
+    // All leading dimensions map directly to their outer dimension and all
+    // unit inner tiles are folded into the innermost dimension group.
+    SmallVector<ReassociationIndices> reassociation;
+    for (int64_t dim = 0; dim < sourceRank - 1; ++dim) {
+      reassociation.push_back({dim});
+    }
+    ReassociationIndices &innermostGroup = reassociation.emplace_back();
+    int64_t destRank = packOp.getDestType().getRank();
+    for (int64_t dim = sourceRank - 1; dim < destRank; ++dim) {
+      innermostGroup.push_back(dim);
+    }
+    rewriter.replaceOpWithNewOp<tensor::ExpandShapeOp>(
+        packOp, packOp.getDestType(), packOp.getSource(), reassociation);
+    return success();
+  }
+};
+
 struct SimplifyPackUnpackPass
     : public impl::SimplifyPackUnpackPassBase<SimplifyPackUnpackPass> {
 
@@ -26,6 +81,7 @@ void SimplifyPackUnpackPass::runOnOperation() {
   MLIRContext *context = &getContext();
   RewritePatternSet patterns(context);
   tensor::populateSimplifyPackAndUnpackPatterns(patterns);
+  patterns.insert<FoldRowMajorPackToExpandShape>(context);
   if (failed(
           applyPatternsAndFoldGreedily(getOperation(), std::move(patterns)))) {
     return signalPassFailure();
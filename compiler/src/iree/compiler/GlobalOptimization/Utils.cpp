@@ -8,6 +8,8 @@
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "iree/compiler/Dialect/Flow/Transforms/RegionOpUtils.h"
 
+#include "llvm/ADT/TypeSwitch.h"
+#include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
 #include "mlir/Dialect/Linalg/Utils/Utils.h"
 #include "mlir/Dialect/Tensor/IR/Tensor.h"
@@ -184,4 +186,55 @@ Value sumReduceDimensionSubset(ImplicitLocOpBuilder &rewriter, Value val,
       .getResult(0);
 }
 
+/// Returns `input` truncated elementwise to `targetType`.
+static Value createTruncation(RewriterBase &rewriter, Location loc, Value input,
+                              FloatType targetType) {
+  auto inputType = cast<RankedTensorType>(input.getType());
+  auto truncatedType = RankedTensorType::get(
+      inputType.getShape(), targetType, inputType.getEncoding());
+  SmallVector<AffineMap> maps(
+      2, rewriter.getMultiDimIdentityMap(inputType.getRank()));
+  SmallVector<utils::IteratorType> iteratorTypes(inputType.getRank(),
+                                                 utils::IteratorType::parallel);
+  SmallVector<OpFoldResult> mixedSizes =
+      tensor::getMixedSizes(rewriter, loc, input);
+  Value empty = rewriter.create<tensor::EmptyOp>(loc, mixedSizes, targetType);
+  return rewriter
+      .create<linalg::GenericOp>(
+          loc, TypeRange{truncatedType}, ValueRange{input}, ValueRange{empty},
+          maps, iteratorTypes,
+          [&](OpBuilder &b, Location loc, ValueRange args) {
+            Value result = b.create<arith::TruncFOp>(loc, targetType, args[0]);
+            b.create<linalg::YieldOp>(loc, result);
+          })
+      ->getResult(0);
+}
+
+LogicalResult demoteContractionInputs(RewriterBase &rewriter,
+                                      linalg::LinalgOp linalgOp,
+                                      FloatType targetType) {
+  auto replaceOpInputs = [&](auto namedOp) {
+    Location loc = linalgOp.getLoc();
+    SmallVector<Value> demotedInputs;
+    for (OpOperand *inputOperand : linalgOp.getDpsInputOperands()) {
+      demotedInputs.push_back(
+          createTruncation(rewriter, loc, inputOperand->get(), targetType));
+    }
+    rewriter.replaceOpWithNewOp<decltype(namedOp)>(
+        linalgOp, demotedInputs, linalgOp.getDpsInits(),
+        linalg::getPrunedAttributeList(namedOp));
+    return success();
+  };
+  return TypeSwitch<Operation *, LogicalResult>(linalgOp.getOperation())
+      .Case<linalg::MatmulOp, linalg::MatvecOp, linalg::VecmatOp,
+            linalg::BatchMatmulOp, linalg::BatchMatvecOp,
+            linalg::BatchVecmatOp, linalg::MatmulTransposeAOp,
+            linalg::MatmulTransposeBOp, linalg::BatchMatmulTransposeAOp,
+            linalg::BatchMatmulTransposeBOp, linalg::Conv2DOp,
+            linalg::Conv2DNchwFchwOp, linalg::Conv2DNhwcHwcfOp,
+            linalg::Conv2DNhwcFhwcOp, linalg::Conv2DNgchwFgchwOp,
+            linalg::Conv2DNgchwGfchwOp>(replaceOpInputs)
+      .Default([](Operation *) { return failure(); });
+}
+
 } // namespace mlir::iree_compiler::GlobalOptimization
@@ -11,6 +11,7 @@
 #include "iree/compiler/Dialect/Encoding/IR/EncodingOps.h"
 #include "iree/compiler/Dialect/Flow/IR/FlowOps.h"
 #include "iree/compiler/Dialect/Flow/Transforms/RegionOpUtils.h"
+#include "mlir/Dialect/Linalg/IR/LinalgInterfaces.h"
 
 namespace mlir {
 class Type;
@@ -59,6 +60,14 @@ wrapConsecutiveOpsInDispatchRegion(RewriterBase &rewriter,
 Value sumReduceDimensionSubset(ImplicitLocOpBuilder &rewriter, Value val,
                                Type accETy, ArrayRef<bool> is_reduction);
 
+/// Replaces the named matmul-like or convolution `linalgOp` with the same op
+/// taking its inputs truncated to `targetType`. The accumulator and result
+/// keep their element type. Fails without modifying the IR if the op is not
+/// one of the supported named ops.
+LogicalResult demoteContractionInputs(RewriterBase &rewriter,
+                                      linalg::LinalgOp linalgOp,
+                                      FloatType targetType);
+
 } // namespace mlir::iree_compiler::GlobalOptimization
 
 #endif // IREE_COMPILER_GLOBALOPTIMIZATION_UTILS_H_
@@ -0,0 +1,90 @@
+// RUN: iree-opt --split-input-file --iree-global-opt-autocast-contractions="policy=matmul=f16,linalg.batch_matmul=bf16" %s | FileCheck %s
+
+util.func public @matmul(%arg0 : tensor<100x250xf32>, %arg1 : tensor<250x500xf32>,
+    %arg2 : tensor<100x500xf32>) -> tensor<100x500xf32> {
+  %0 = linalg.matmul ins(%arg0, %arg1 : tensor<100x250xf32>, tensor<250x500xf32>)
+      outs(%arg2 : tensor<100x500xf32>) -> tensor<100x500xf32>
+  util.return %0 : tensor<100x500xf32>
+}
+// CHECK-LABEL: @matmul
+//  CHECK-SAME:   %[[ARG0:.+]]: tensor<100x250xf32>, %[[ARG1:.+]]: tensor<250x500xf32>, %[[ARG2:.+]]: tensor<100x500xf32>
+//       CHECK:   %[[DEMOTED0:.+]] = linalg.generic
+//  CHECK-SAME:     ins(%[[ARG0]] : tensor<100x250xf32>)
+//       CHECK:     arith.truncf {{.*}} : f32 to f16
+//       CHECK:   %[[DEMOTED1:.+]] = linalg.generic
+//  CHECK-SAME:     ins(%[[ARG1]] : tensor<250x500xf32>)
+//       CHECK:     arith.truncf {{.*}} : f32 to f16
+//       CHECK:   linalg.matmul
+//  CHECK-SAME:     ins(%[[DEMOTED0]], %[[DEMOTED1]] : tensor<100x250xf16>, tensor<250x500xf16>)
+//  CHECK-SAME:     outs(%[[ARG2]] : tensor<100x500xf32>)
+
+// -----
+
+util.func public @batch_matmul(%arg0 : tensor<4x100x250xf32>, %arg1 : tensor<4x250x500xf32>,
+    %arg2 : tensor<4x100x500xf32>) -> tensor<4x100x500xf32> {
+  %0 = linalg.batch_matmul ins(%arg0, %arg1 : tensor<4x100x250xf32>, tensor<4x250x500xf32>)
+      outs(%arg2 : tensor<4x100x500xf32>) -> tensor<4x100x500xf32>
+  util.return %0 : tensor<4x100x500xf32>
+}
+// CHECK-LABEL: @batch_matmul
+//       CHECK:   linalg.batch_matmul
+//  CHECK-SAME:     ins(%{{.+}}, %{{.+}} : tensor<4x100x250xbf16>, tensor<4x250x500xbf16>)
+//  CHECK-SAME:     outs(%{{.+}} : tensor<4x100x500xf32>)
+
+// -----
+
+util.func public @conv_without_policy(%arg0 : tensor<1x16x16x8xf32>, %arg1 : tensor<3x3x8x4xf32>,
+    %arg2 : tensor<1x14x14x4xf32>) -> tensor<1x14x14x4xf32> {
+  %0 = linalg.conv_2d_nhwc_hwcf
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%arg0, %arg1 : tensor<1x16x16x8xf32>, tensor<3x3x8x4xf32>)
+      outs(%arg2 : tensor<1x14x14x4xf32>) -> tensor<1x14x14x4xf32>
+  util.return %0 : tensor<1x14x14x4xf32>
+}
+// CHECK-LABEL: @conv_without_policy
+//   CHECK-NOT:   arith.truncf
+//       CHECK:   linalg.conv_2d_nhwc_hwcf
+//  CHECK-SAME:     ins(%{{.+}}, %{{.+}} : tensor<1x16x16x8xf32>, tensor<3x3x8x4xf32>)
+
+// -----
+
+util.func public @conv_with_override(%arg0 : tensor<1x16x16x8xf32>, %arg1 : tensor<3x3x8x4xf32>,
+    %arg2 : tensor<1x14x14x4xf32>) -> tensor<1x14x14x4xf32> {
+  %0 = linalg.conv_2d_nhwc_hwcf
+      {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>, iree.autocast = f16}
+      ins(%arg0, %arg1 : tensor<1x16x16x8xf32>, tensor<3x3x8x4xf32>)
+      outs(%arg2 : tensor<1x14x14x4xf32>) -> tensor<1x14x14x4xf32>
+  util.return %0 : tensor<1x14x14x4xf32>
+}
+// CHECK-LABEL: @conv_with_override
+//       CHECK:   linalg.conv_2d_nhwc_hwcf
+//  CHECK-SAME:     ins(%{{.+}}, %{{.+}} : tensor<1x16x16x8xf16>, tensor<3x3x8x4xf16>)
+//  CHECK-SAME:     outs(%{{.+}} : tensor<1x14x14x4xf32>)
+
+// -----
+
+util.func public @matmul_kept_in_f32(%arg0 : tensor<100x250xf32>, %arg1 : tensor<250x500xf32>,
+    %arg2 : tensor<100x500xf32>) -> tensor<100x500xf32> {
+  %0 = linalg.matmul {iree.autocast = f32}
+      ins(%arg0, %arg1 : tensor<100x250xf32>, tensor<250x500xf32>)
+      outs(%arg2 : tensor<100x500xf32>) -> tensor<100x500xf32>
+  util.return %0 : tensor<100x500xf32>
+}
+// CHECK-LABEL: @matmul_kept_in_f32
+//   CHECK-NOT:   arith.truncf
+//       CHECK:   linalg.matmul
+//  CHECK-SAME:     ins(%{{.+}}, %{{.+}} : tensor<100x250xf32>, tensor<250x500xf32>)
+
+// -----
+
+util.func public @matmul_out_of_range_weights(%arg0 : tensor<2x2xf32>,
+    %arg1 : tensor<2x2xf32>) -> tensor<2x2xf32> {
+  %weights = arith.constant dense<[[1.0, 2.0], [1.0e+05, 3.0]]> : tensor<2x2xf32>
+  %0 = linalg.matmul ins(%arg0, %weights : tensor<2x2xf32>, tensor<2x2xf32>)
+      outs(%arg1 : tensor<2x2xf32>) -> tensor<2x2xf32>
+  util.return %0 : tensor<2x2xf32>
+}
+// CHECK-LABEL: @matmul_out_of_range_weights
+//   CHECK-NOT:   arith.truncf
+//       CHECK:   linalg.matmul
+//  CHECK-SAME:     ins(%{{.+}}, %{{.+}} : tensor<2x2xf32>, tensor<2x2xf32>)
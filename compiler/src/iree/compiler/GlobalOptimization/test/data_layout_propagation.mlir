@@ -33,3 +33,49 @@ func.func @push_down_unpack_through_expand(%5: tensor<?x32x8x8xf32>, %dim: index
 // CHECK:         %[[EMPTY:.+]] = tensor.empty(%[[DIM]]) : tensor<?x256x256xf32>
 // CHECK:         %[[UNPACK:.+]] = tensor.unpack %[[EXPANDED:.+]] outer_dims_perm = [0, 1, 2] inner_dims_pos = [1, 2] inner_tiles = [8, 8] into %[[EMPTY]] : tensor<?x32x32x8x8xf32> -> tensor<?x256x256xf32>
 // CHECK:         return %[[UNPACK]] : tensor<?x256x256xf32>
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @fold_unpack_elementwise_pack(%arg0: tensor<4x8x16x1xf32>, %arg1: tensor<4x8x16x1xf32>) -> tensor<4x8x16x1xf32> {
+  %0 = tensor.empty() : tensor<64x8xf32>
+  %unpack = tensor.unpack %arg0 inner_dims_pos = [0, 1] inner_tiles = [16, 1] into %0 : tensor<4x8x16x1xf32> -> tensor<64x8xf32>
+  %unpack_0 = tensor.unpack %arg1 inner_dims_pos = [0, 1] inner_tiles = [16, 1] into %0 : tensor<4x8x16x1xf32> -> tensor<64x8xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map, #map], iterator_types = ["parallel", "parallel"]} ins(%unpack, %unpack_0 : tensor<64x8xf32>, tensor<64x8xf32>) outs(%0 : tensor<64x8xf32>) {
+  ^bb0(%in: f32, %in_1: f32, %out: f32):
+    %2 = arith.addf %in, %in_1 : f32
+    linalg.yield %2 : f32
+  } -> tensor<64x8xf32>
+  %3 = tensor.empty() : tensor<4x8x16x1xf32>
+  %pack = tensor.pack %1 inner_dims_pos = [0, 1] inner_tiles = [16, 1] into %3 : tensor<64x8xf32> -> tensor<4x8x16x1xf32>
+  func.return %pack : tensor<4x8x16x1xf32>
+}
+// CHECK-LABEL: func.func @fold_unpack_elementwise_pack
+// CHECK-SAME:      %[[ARG0:[a-zA-Z0-9]+]]
+// CHECK-SAME:      %[[ARG1:[a-zA-Z0-9]+]]
+// CHECK-NOT:     tensor.unpack
+// CHECK:         %[[GENERIC:.+]] = linalg.generic
+// CHECK-SAME:        ins(%[[ARG0]], %[[ARG1]] : tensor<4x8x16x1xf32>, tensor<4x8x16x1xf32>)
+// CHECK-NOT:     tensor.pack
+// CHECK:         return %[[GENERIC]] : tensor<4x8x16x1xf32>
+
+// -----
+
+#map = affine_map<(d0, d1) -> (d0, d1)>
+func.func @no_propagation_for_different_layouts(%arg0: tensor<4x8x16x1xf32>) -> tensor<8x8x8x1xf32> {
+  %0 = tensor.empty() : tensor<64x8xf32>
+  %unpack = tensor.unpack %arg0 inner_dims_pos = [0, 1] inner_tiles = [16, 1] into %0 : tensor<4x8x16x1xf32> -> tensor<64x8xf32>
+  %1 = linalg.generic {indexing_maps = [#map, #map], iterator_types = ["parallel", "parallel"]} ins(%unpack : tensor<64x8xf32>) outs(%0 : tensor<64x8xf32>) {
+  ^bb0(%in: f32, %out: f32):
+    %2 = arith.negf %in : f32
+    linalg.yield %2 : f32
+  } -> tensor<64x8xf32>
+  %3 = tensor.empty() : tensor<8x8x8x1xf32>
+  %pack = tensor.pack %1 inner_dims_pos = [0, 1] inner_tiles = [8, 1] into %3 : tensor<64x8xf32> -> tensor<8x8x8x1xf32>
+  func.return %pack : tensor<8x8x8x1xf32>
+}
+// CHECK-LABEL: func.func @no_propagation_for_different_layouts
+// CHECK:         %[[UNPACK:.+]] = tensor.unpack
+// CHECK:         %[[GENERIC:.+]] = linalg.generic
+// CHECK-SAME:        ins(%[[UNPACK]] : tensor<64x8xf32>)
+// CHECK:         tensor.pack %[[GENERIC]]
@@ -0,0 +1,179 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-global-opt-hoist-matmul-scales))" %s | FileCheck %s
+
+util.func public @per_tensor_scaled_matmul(%lhs: tensor<16x64xf8E4M3FNUZ>, %lhs_scale: tensor<f32>, %rhs: tensor<64x32xf8E4M3FNUZ>, %rhs_scale: tensor<f32>) -> tensor<16x32xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %empty = tensor.empty() : tensor<16x32xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<16x32xf32>) -> tensor<16x32xf32>
+  %lhs_empty = tensor.empty() : tensor<16x64xf32>
+  %lhs_dequant = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                       affine_map<(d0, d1) -> ()>,
+                       affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%lhs, %lhs_scale : tensor<16x64xf8E4M3FNUZ>, tensor<f32>) outs(%lhs_empty : tensor<16x64xf32>) {
+  ^bb0(%in: f8E4M3FNUZ, %scale: f32, %out: f32):
+    %0 = arith.extf %in : f8E4M3FNUZ to f32
+    %1 = arith.mulf %0, %scale : f32
+    linalg.yield %1 : f32
+  } -> tensor<16x64xf32>
+  %rhs_empty = tensor.empty() : tensor<64x32xf32>
+  %rhs_dequant = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                       affine_map<(d0, d1) -> ()>,
+                       affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%rhs, %rhs_scale : tensor<64x32xf8E4M3FNUZ>, tensor<f32>) outs(%rhs_empty : tensor<64x32xf32>) {
+  ^bb0(%in: f8E4M3FNUZ, %scale: f32, %out: f32):
+    %0 = arith.extf %in : f8E4M3FNUZ to f32
+    %1 = arith.mulf %scale, %0 : f32
+    linalg.yield %1 : f32
+  } -> tensor<64x32xf32>
+  %matmul = linalg.matmul ins(%lhs_dequant, %rhs_dequant : tensor<16x64xf32>, tensor<64x32xf32>) outs(%fill : tensor<16x32xf32>) -> tensor<16x32xf32>
+  util.return %matmul : tensor<16x32xf32>
+}
+//   CHECK-DAG: #[[LHS_MAP:.+]] = affine_map<(d0, d1, d2) -> (d0, d2)>
+//   CHECK-DAG: #[[RHS_MAP:.+]] = affine_map<(d0, d1, d2) -> (d2, d1)>
+//   CHECK-DAG: #[[OUT_MAP:.+]] = affine_map<(d0, d1, d2) -> (d0, d1)>
+//   CHECK-DAG: #[[ID_MAP:.+]] = affine_map<(d0, d1) -> (d0, d1)>
+//   CHECK-DAG: #[[SCALAR_MAP:.+]] = affine_map<(d0, d1) -> ()>
+// CHECK-LABEL: util.func public @per_tensor_scaled_matmul
+//  CHECK-SAME:     %[[LHS:[a-zA-Z0-9_]+]]: tensor<16x64xf8E4M3FNUZ>
+//  CHECK-SAME:     %[[LHS_SCALE:[a-zA-Z0-9_]+]]: tensor<f32>
+//  CHECK-SAME:     %[[RHS:[a-zA-Z0-9_]+]]: tensor<64x32xf8E4M3FNUZ>
+//  CHECK-SAME:     %[[RHS_SCALE:[a-zA-Z0-9_]+]]: tensor<f32>
+//       CHECK:   %[[FILL:.+]] = linalg.fill
+//       CHECK:   %[[MATMUL:.+]] = linalg.generic
+//  CHECK-SAME:       indexing_maps = [#[[LHS_MAP]], #[[RHS_MAP]], #[[OUT_MAP]]]
+//  CHECK-SAME:       iterator_types = ["parallel", "parallel", "reduction"]
+//  CHECK-SAME:       ins(%[[LHS]], %[[RHS]] : tensor<16x64xf8E4M3FNUZ>, tensor<64x32xf8E4M3FNUZ>)
+//  CHECK-SAME:       outs(%[[FILL]] : tensor<16x32xf32>)
+//       CHECK:     %[[A:.+]] = arith.extf %{{.+}} : f8E4M3FNUZ to f32
+//       CHECK:     %[[B:.+]] = arith.extf %{{.+}} : f8E4M3FNUZ to f32
+//       CHECK:     %[[MUL:.+]] = arith.mulf %[[A]], %[[B]]
+//       CHECK:     %[[ADD:.+]] = arith.addf %{{.+}}, %[[MUL]]
+//       CHECK:     linalg.yield %[[ADD]]
+//       CHECK:   %[[SCALED:.+]] = linalg.generic
+//  CHECK-SAME:       indexing_maps = [#[[ID_MAP]], #[[SCALAR_MAP]], #[[SCALAR_MAP]], #[[ID_MAP]]]
+//  CHECK-SAME:       ins(%[[MATMUL]], %[[LHS_SCALE]], %[[RHS_SCALE]] : tensor<16x32xf32>, tensor<f32>, tensor<f32>)
+//       CHECK:   ^bb0(%[[IN:.+]]: f32, %[[SA:.+]]: f32, %[[SB:.+]]: f32, %{{.+}}: f32):
+//       CHECK:     %[[S0:.+]] = arith.mulf %[[IN]], %[[SA]]
+//       CHECK:     %[[S1:.+]] = arith.mulf %[[S0]], %[[SB]]
+//       CHECK:     linalg.yield %[[S1]]
+//       CHECK:   util.return %[[SCALED]]
+
+// -----
+
+util.func public @per_channel_scaled_matmul(%lhs: tensor<16x64xf8E4M3FNUZ>, %lhs_scale: f16, %rhs: tensor<64x32xf8E4M3FNUZ>, %rhs_scale: tensor<32xf16>) -> tensor<16x32xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %empty = tensor.empty() : tensor<16x32xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<16x32xf32>) -> tensor<16x32xf32>
+  %lhs_empty = tensor.empty() : tensor<16x64xf16>
+  %lhs_dequant = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                       affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%lhs : tensor<16x64xf8E4M3FNUZ>) outs(%lhs_empty : tensor<16x64xf16>) {
+  ^bb0(%in: f8E4M3FNUZ, %out: f16):
+    %0 = arith.extf %in : f8E4M3FNUZ to f16
+    %1 = arith.mulf %0, %lhs_scale : f16
+    linalg.yield %1 : f16
+  } -> tensor<16x64xf16>
+  %rhs_empty = tensor.empty() : tensor<64x32xf16>
+  %rhs_dequant = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                       affine_map<(d0, d1) -> (d1)>,
+                       affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%rhs, %rhs_scale : tensor<64x32xf8E4M3FNUZ>, tensor<32xf16>) outs(%rhs_empty : tensor<64x32xf16>) {
+  ^bb0(%in: f8E4M3FNUZ, %scale: f16, %out: f16):
+    %0 = arith.extf %in : f8E4M3FNUZ to f16
+    %1 = arith.mulf %0, %scale : f16
+    linalg.yield %1 : f16
+  } -> tensor<64x32xf16>
+  %matmul = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d2)>,
+                       affine_map<(d0, d1, d2) -> (d2, d1)>,
+                       affine_map<(d0, d1, d2) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel", "reduction"]}
+      ins(%lhs_dequant, %rhs_dequant : tensor<16x64xf16>, tensor<64x32xf16>) outs(%fill : tensor<16x32xf32>) {
+  ^bb0(%a: f16, %b: f16, %out: f32):
+    %0 = arith.extf %a : f16 to f32
+    %1 = arith.extf %b : f16 to f32
+    %2 = arith.mulf %0, %1 : f32
+    %3 = arith.addf %out, %2 : f32
+    linalg.yield %3 : f32
+  } -> tensor<16x32xf32>
+  util.return %matmul : tensor<16x32xf32>
+}
+//   CHECK-DAG: #[[ID_MAP:.+]] = affine_map<(d0, d1) -> (d0, d1)>
+//   CHECK-DAG: #[[COL_MAP:.+]] = affine_map<(d0, d1) -> (d1)>
+// CHECK-LABEL: util.func public @per_channel_scaled_matmul
+//  CHECK-SAME:     %[[LHS:[a-zA-Z0-9_]+]]: tensor<16x64xf8E4M3FNUZ>
+//  CHECK-SAME:     %[[LHS_SCALE:[a-zA-Z0-9_]+]]: f16
+//  CHECK-SAME:     %[[RHS:[a-zA-Z0-9_]+]]: tensor<64x32xf8E4M3FNUZ>
+//  CHECK-SAME:     %[[RHS_SCALE:[a-zA-Z0-9_]+]]: tensor<32xf16>
+//       CHECK:   %[[MATMUL:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[LHS]], %[[RHS]] : tensor<16x64xf8E4M3FNUZ>, tensor<64x32xf8E4M3FNUZ>)
+//       CHECK:   %[[SCALED:.+]] = linalg.generic
+//  CHECK-SAME:       indexing_maps = [#[[ID_MAP]], #[[COL_MAP]], #[[ID_MAP]]]
+//  CHECK-SAME:       ins(%[[MATMUL]], %[[RHS_SCALE]] : tensor<16x32xf32>, tensor<32xf16>)
+//       CHECK:   ^bb0(%[[IN:.+]]: f32, %[[SB:.+]]: f16, %{{.+}}: f32):
+//       CHECK:     %[[SA_EXT:.+]] = arith.extf %[[LHS_SCALE]] : f16 to f32
+//       CHECK:     %[[S0:.+]] = arith.mulf %[[IN]], %[[SA_EXT]]
+//       CHECK:     %[[SB_EXT:.+]] = arith.extf %[[SB]] : f16 to f32
+//       CHECK:     %[[S1:.+]] = arith.mulf %[[S0]], %[[SB_EXT]]
+//       CHECK:     linalg.yield %[[S1]]
+//       CHECK:   util.return %[[SCALED]]
+
+// -----
+
+// Per-block scales along the reduction dimension cannot be moved onto the
+// result.
+
+util.func public @per_block_scaled_matmul(%lhs: tensor<16x2x32xf8E4M3FNUZ>, %rhs: tensor<2x32x32xf8E4M3FNUZ>, %rhs_scale: tensor<2x32xf32>) -> tensor<16x32xf32> {
+  %cst = arith.constant 0.000000e+00 : f32
+  %empty = tensor.empty() : tensor<16x32xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<16x32xf32>) -> tensor<16x32xf32>
+  %lhs_empty = tensor.empty() : tensor<16x2x32xf32>
+  %lhs_dequant = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d1, d2)>,
+                       affine_map<(d0, d1, d2) -> (d0, d1, d2)>],
+      iterator_types = ["parallel", "parallel", "parallel"]}
+      ins(%lhs : tensor<16x2x32xf8E4M3FNUZ>) outs(%lhs_empty : tensor<16x2x32xf32>) {
+  ^bb0(%in: f8E4M3FNUZ, %out: f32):
+    %0 = arith.extf %in : f8E4M3FNUZ to f32
+    linalg.yield %0 : f32
+  } -> tensor<16x2x32xf32>
+  %rhs_empty = tensor.empty() : tensor<2x32x32xf32>
+  %rhs_dequant = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d1, d2)>,
+                       affine_map<(d0, d1, d2) -> (d0, d2)>,
+                       affine_map<(d0, d1, d2) -> (d0, d1, d2)>],
+      iterator_types = ["parallel", "parallel", "parallel"]}
+      ins(%rhs, %rhs_scale : tensor<2x32x32xf8E4M3FNUZ>, tensor<2x32xf32>) outs(%rhs_empty : tensor<2x32x32xf32>) {
+  ^bb0(%in: f8E4M3FNUZ, %scale: f32, %out: f32):
+    %0 = arith.extf %in : f8E4M3FNUZ to f32
+    %1 = arith.mulf %0, %scale : f32
+    linalg.yield %1 : f32
+  } -> tensor<2x32x32xf32>
+  %matmul = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1, d2, d3) -> (d0, d2, d3)>,
+                       affine_map<(d0, d1, d2, d3) -> (d2, d3, d1)>,
+                       affine_map<(d0, d1, d2, d3) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel", "reduction", "reduction"]}
+      ins(%lhs_dequant, %rhs_dequant : tensor<16x2x32xf32>, tensor<2x32x32xf32>) outs(%fill : tensor<16x32xf32>) {
+  ^bb0(%a: f32, %b: f32, %out: f32):
+    %0 = arith.mulf %a, %b : f32
+    %1 = arith.addf %out, %0 : f32
+    linalg.yield %1 : f32
+  } -> tensor<16x32xf32>
+  util.return %matmul : tensor<16x32xf32>
+}
+// CHECK-LABEL: util.func public @per_block_scaled_matmul
+//       CHECK:   %[[LHS_DEQUANT:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%{{.+}} : tensor<16x2x32xf8E4M3FNUZ>)
+//       CHECK:   %[[RHS_DEQUANT:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%{{.+}}, %{{.+}} : tensor<2x32x32xf8E4M3FNUZ>, tensor<2x32xf32>)
+//       CHECK:   %[[MATMUL:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[LHS_DEQUANT]], %[[RHS_DEQUANT]] : tensor<16x2x32xf32>, tensor<2x32x32xf32>)
+//       CHECK:   util.return %[[MATMUL]]
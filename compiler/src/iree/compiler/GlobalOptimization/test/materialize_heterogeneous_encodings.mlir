@@ -0,0 +1,41 @@
+// RUN: iree-opt --split-input-file --iree-global-opt-materialize-homogeneous-encodings %s | FileCheck %s
+
+// Tests that with multiple device targets the encodings are materialized per
+// function: functions only running on the CPU device are data-tiled while the
+// encodings of other functions are dropped.
+
+#cpu_target = #hal.executable.target<"llvm-cpu", "embedded-elf-x86_64", {target_triple = "x86_64-none-elf", cpu_features = "+avx512f"}>
+#gpu_target = #hal.executable.target<"vulkan-spirv", "vulkan-spirv-fb">
+#encoding = #iree_encoding.encoding<operand_index = 0, op_type = matmul, element_types = [f32, f32, f32], user_indexing_maps = [affine_map<(d0, d1, d2) -> (d0, d2)>, affine_map<(d0, d1, d2) -> (d2, d1)>, affine_map<(d0, d1, d2) -> (d0, d1)>], round_dims_to = array<i64: 16, 16, 16>>
+module attributes {stream.affinity.default = #hal.device.affinity<@device_gpu>} {
+  util.global private @device_cpu = #hal.device.target<"local", [#cpu_target]> : !hal.device
+  util.global private @device_gpu = #hal.device.target<"vulkan", [#gpu_target]> : !hal.device
+
+  util.func public @on_cpu(%arg0: !hal.buffer_view) -> !hal.buffer_view {
+    %0 = hal.tensor.import on(#hal.device.affinity<@device_cpu>) %arg0 "input" : !hal.buffer_view -> tensor<128x256xf32>
+    %1 = iree_encoding.set_encoding %0 : tensor<128x256xf32> -> tensor<128x256xf32, #encoding>
+    %2 = iree_encoding.unset_encoding %1 : tensor<128x256xf32, #encoding> -> tensor<128x256xf32>
+    %3 = hal.tensor.export on(#hal.device.affinity<@device_cpu>) %2 "output" : tensor<128x256xf32> -> !hal.buffer_view
+    util.return %3 : !hal.buffer_view
+  }
+
+  util.func public @on_gpu(%arg0: !hal.buffer_view) -> !hal.buffer_view {
+    %0 = hal.tensor.import on(#hal.device.affinity<@device_gpu>) %arg0 "input" : !hal.buffer_view -> tensor<128x256xf32>
+    %1 = iree_encoding.set_encoding %0 : tensor<128x256xf32> -> tensor<128x256xf32, #encoding>
+    %2 = iree_encoding.unset_encoding %1 : tensor<128x256xf32, #encoding> -> tensor<128x256xf32>
+    %3 = hal.tensor.export on(#hal.device.affinity<@device_gpu>) %2 "output" : tensor<128x256xf32> -> !hal.buffer_view
+    util.return %3 : !hal.buffer_view
+  }
+}
+
+// CHECK-LABEL: util.func public @on_cpu
+// CHECK-NOT:     iree_encoding.set_encoding
+// CHECK:         tensor.pack
+// CHECK:         tensor.unpack
+// CHECK:         util.return
+
+// CHECK-LABEL: util.func public @on_gpu
+// CHECK-NOT:     iree_encoding.set_encoding
+// CHECK-NOT:     tensor.pack
+// CHECK-NOT:     iree_encoding.unset_encoding
+// CHECK:         util.return
@@ -0,0 +1,87 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-global-opt-quantize-calibrated-contractions))" %s | FileCheck %s
+
+util.func public @calibrated_arg_constant_weights(%lhs: tensor<4x2xf32> {iree.calibration.range = array<f32: -63.5, 10.0>}) -> tensor<4x2xf32> {
+  %rhs = arith.constant dense<[[31.75, -1.0], [0.5, -2.0]]> : tensor<2x2xf32>
+  %cst = arith.constant 0.000000e+00 : f32
+  %empty = tensor.empty() : tensor<4x2xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<4x2xf32>) -> tensor<4x2xf32>
+  %matmul = linalg.matmul ins(%lhs, %rhs : tensor<4x2xf32>, tensor<2x2xf32>) outs(%fill : tensor<4x2xf32>) -> tensor<4x2xf32>
+  util.return %matmul : tensor<4x2xf32>
+}
+// CHECK-LABEL: util.func public @calibrated_arg_constant_weights
+//  CHECK-SAME:     %[[LHS:[a-zA-Z0-9_]+]]: tensor<4x2xf32>
+//   CHECK-DAG:   %[[RHS:.+]] = arith.constant dense<{{.+}}> : tensor<2x2xf32>
+//   CHECK-DAG:   %[[LHS_INV_SCALE:.+]] = arith.constant 2.000000e+00 : f32
+//   CHECK-DAG:   %[[RHS_INV_SCALE:.+]] = arith.constant 4.000000e+00 : f32
+//   CHECK-DAG:   %[[MIN:.+]] = arith.constant -1.270000e+02 : f32
+//   CHECK-DAG:   %[[MAX:.+]] = arith.constant 1.270000e+02 : f32
+//   CHECK-DAG:   %[[SCALE:.+]] = arith.constant 1.250000e-01 : f32
+//   CHECK-DAG:   %[[FILL:.+]] = linalg.fill ins(%{{.+}} : f32)
+//       CHECK:   %[[QLHS:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[LHS]] : tensor<4x2xf32>)
+//       CHECK:     %[[SCALED:.+]] = arith.mulf %{{.+}}, %[[LHS_INV_SCALE]]
+//       CHECK:     %[[ROUNDED:.+]] = math.roundeven %[[SCALED]]
+//       CHECK:     %[[LOWER:.+]] = arith.maximumf %[[ROUNDED]], %[[MIN]]
+//       CHECK:     %[[CLAMPED:.+]] = arith.minimumf %[[LOWER]], %[[MAX]]
+//       CHECK:     arith.fptosi %[[CLAMPED]] : f32 to i8
+//       CHECK:   %[[QRHS:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[RHS]] : tensor<2x2xf32>)
+//       CHECK:     arith.mulf %{{.+}}, %[[RHS_INV_SCALE]]
+//       CHECK:   %[[ACC:.+]] = linalg.fill ins(%{{.+}} : i32)
+//       CHECK:   %[[QMATMUL:.+]] = linalg.matmul
+//  CHECK-SAME:       ins(%[[QLHS]], %[[QRHS]] : tensor<4x2xi8>, tensor<2x2xi8>)
+//  CHECK-SAME:       outs(%[[ACC]] : tensor<4x2xi32>)
+//       CHECK:   %[[RESULT:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[QMATMUL]] : tensor<4x2xi32>)
+//  CHECK-SAME:       outs(%[[FILL]] : tensor<4x2xf32>)
+//       CHECK:   ^bb0(%[[IN:.+]]: i32, %[[OUT:.+]]: f32):
+//       CHECK:     %[[FP:.+]] = arith.sitofp %[[IN]] : i32 to f32
+//       CHECK:     %[[MUL:.+]] = arith.mulf %[[FP]], %[[SCALE]]
+//       CHECK:     %[[ADD:.+]] = arith.addf %[[OUT]], %[[MUL]]
+//       CHECK:     linalg.yield %[[ADD]]
+//       CHECK:   util.return %[[RESULT]]
+
+// -----
+
+util.global private @weights = dense<[[31.75, -1.0], [0.5, -2.0]]> : tensor<2x2xf32>
+util.func public @calibrated_producer_global_weights(%arg0: tensor<4x2xf32>, %init: tensor<4x2xf32>) -> tensor<4x2xf32> {
+  %empty = tensor.empty() : tensor<4x2xf32>
+  %lhs = linalg.generic {
+      indexing_maps = [affine_map<(d0, d1) -> (d0, d1)>,
+                       affine_map<(d0, d1) -> (d0, d1)>],
+      iterator_types = ["parallel", "parallel"]}
+      ins(%arg0 : tensor<4x2xf32>) outs(%empty : tensor<4x2xf32>)
+      attrs = {iree.calibration.range = array<f32: -1.0, 63.5>} {
+  ^bb0(%in: f32, %out: f32):
+    %0 = math.tanh %in : f32
+    linalg.yield %0 : f32
+  } -> tensor<4x2xf32>
+  %rhs = util.global.load @weights : tensor<2x2xf32>
+  %matmul = linalg.matmul ins(%lhs, %rhs : tensor<4x2xf32>, tensor<2x2xf32>) outs(%init : tensor<4x2xf32>) -> tensor<4x2xf32>
+  util.return %matmul : tensor<4x2xf32>
+}
+// CHECK-LABEL: util.func public @calibrated_producer_global_weights
+//  CHECK-SAME:     %{{[a-zA-Z0-9_]+}}: tensor<4x2xf32>, %[[INIT:[a-zA-Z0-9_]+]]: tensor<4x2xf32>
+//       CHECK:   %[[LHS:.+]] = linalg.generic
+//       CHECK:     math.tanh
+//       CHECK:   %[[RHS:.+]] = util.global.load @weights
+//       CHECK:   %[[QLHS:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[LHS]] : tensor<4x2xf32>)
+//       CHECK:   %[[QRHS:.+]] = linalg.generic
+//  CHECK-SAME:       ins(%[[RHS]] : tensor<2x2xf32>)
+//       CHECK:   %[[QMATMUL:.+]] = linalg.matmul
+//  CHECK-SAME:       ins(%[[QLHS]], %[[QRHS]] : tensor<4x2xi8>, tensor<2x2xi8>)
+//       CHECK:   linalg.generic
+//  CHECK-SAME:       ins(%[[QMATMUL]] : tensor<4x2xi32>)
+//  CHECK-SAME:       outs(%[[INIT]] : tensor<4x2xf32>)
+
+// -----
+
+util.func public @uncalibrated_matmul(%lhs: tensor<4x2xf32>, %rhs: tensor<2x2xf32>, %init: tensor<4x2xf32>) -> tensor<4x2xf32> {
+  %matmul = linalg.matmul ins(%lhs, %rhs : tensor<4x2xf32>, tensor<2x2xf32>) outs(%init : tensor<4x2xf32>) -> tensor<4x2xf32>
+  util.return %matmul : tensor<4x2xf32>
+}
+// CHECK-LABEL: util.func public @uncalibrated_matmul
+//   CHECK-NOT:   i8
+//       CHECK:   linalg.matmul
+//  CHECK-SAME:       tensor<4x2xf32>, tensor<2x2xf32>
@@ -0,0 +1,43 @@
+// RUN: iree-opt --pass-pipeline="builtin.module(util.func(iree-global-opt-simplify-pack-unpack))" --split-input-file %s | FileCheck %s
+
+// Packing the LHS of a narrow matmul with a 1xK0 tile does not move any data
+// and folds to a reshape.
+
+util.func public @fold_narrow_lhs_pack(%arg0: tensor<?x256xf32>) -> tensor<?x64x1x4xf32> {
+  %c0 = arith.constant 0 : index
+  %dim = tensor.dim %arg0, %c0 : tensor<?x256xf32>
+  %empty = tensor.empty(%dim) : tensor<?x64x1x4xf32>
+  %pack = tensor.pack %arg0 inner_dims_pos = [0, 1] inner_tiles = [1, 4] into %empty : tensor<?x256xf32> -> tensor<?x64x1x4xf32>
+  util.return %pack : tensor<?x64x1x4xf32>
+}
+// CHECK-LABEL: util.func public @fold_narrow_lhs_pack
+//  CHECK-SAME:   %[[ARG0:[a-zA-Z0-9]+]]
+//       CHECK:   %[[EXPAND:.+]] = tensor.expand_shape %[[ARG0]] {{\[}}[0], [1, 2, 3]]
+//  CHECK-SAME:     : tensor<?x256xf32> into tensor<?x64x1x4xf32>
+//       CHECK:   util.return %[[EXPAND]]
+
+// -----
+
+// Packs that need padding cannot be folded.
+
+util.func public @no_fold_padded_pack(%arg0: tensor<1x255xf32>) -> tensor<1x64x1x4xf32> {
+  %cst = arith.constant 0.0 : f32
+  %empty = tensor.empty() : tensor<1x64x1x4xf32>
+  %pack = tensor.pack %arg0 padding_value(%cst : f32) inner_dims_pos = [0, 1] inner_tiles = [1, 4] into %empty : tensor<1x255xf32> -> tensor<1x64x1x4xf32>
+  util.return %pack : tensor<1x64x1x4xf32>
+}
+// CHECK-LABEL: util.func public @no_fold_padded_pack
+//       CHECK:   tensor.pack
+
+// -----
+
+// Packs with non-unit tiles on outer dimensions transpose data and cannot be
+// folded.
+
+util.func public @no_fold_tiled_lhs_pack(%arg0: tensor<16x256xf32>) -> tensor<2x64x8x4xf32> {
+  %empty = tensor.empty() : tensor<2x64x8x4xf32>
+  %pack = tensor.pack %arg0 inner_dims_pos = [0, 1] inner_tiles = [8, 4] into %empty : tensor<16x256xf32> -> tensor<2x64x8x4xf32>
+  util.return %pack : tensor<2x64x8x4xf32>
+}
+// CHECK-LABEL: util.func public @no_fold_tiled_lhs_pack
+//       CHECK:   tensor.pack
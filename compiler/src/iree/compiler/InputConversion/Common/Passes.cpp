@@ -28,6 +28,13 @@ void buildCommonInputConversionPassPipeline(
 
   // TODO: this pass should either live in InputConversion or be run in flow -
   // it's a mistake that it's here.
+  if (!transformOptions.options.meshDevices.empty()) {
+    IREE::Flow::ConvertMeshToMultiDevicePassOptions meshOptions;
+    meshOptions.devices.assign(transformOptions.options.meshDevices.begin(),
+                               transformOptions.options.meshDevices.end());
+    passManager.addPass(
+        IREE::Flow::createConvertMeshToMultiDevicePass(meshOptions));
+  }
   passManager.addPass(IREE::Flow::createConvertMeshToFlowPass());
 
   // ML frontends have very uneven support for user-controlled types _and_ users
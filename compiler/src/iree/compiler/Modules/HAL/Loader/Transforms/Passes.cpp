@@ -102,7 +102,8 @@ void buildHALInlineDynamicTransformPassPipeline(
       IREE::HAL::createSerializeExecutablesPass(
           {&targetRegistry, targetOptions.debugLevel,
            targetOptions.executableIntermediatesPath,
-           targetOptions.executableBinariesPath}));
+           targetOptions.executableBinariesPath,
+           targetOptions.executableCachePath}));
 
   // NOTE: symbol DCE will destroy executable target contents.
   passManager.addPass(mlir::createSymbolDCEPass());
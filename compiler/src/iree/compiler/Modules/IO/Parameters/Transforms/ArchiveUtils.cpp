@@ -28,6 +28,31 @@ LogicalResult handleRuntimeError(Operation *op, iree_status_t status,
   return op->emitError() << failureMessage << "\n" << message;
 }
 
+static constexpr StringLiteral kLayoutMetadataPrefix = "layout=";
+
+std::string getLayoutMetadata(Type type) {
+  std::string metadata;
+  llvm::raw_string_ostream os(metadata);
+  os << kLayoutMetadataPrefix << type;
+  return metadata;
+}
+
+LogicalResult
+verifyLayoutMetadata(Operation *op, Type type,
+                     const iree_io_parameter_index_entry_t *entry) {
+  StringRef metadata(reinterpret_cast<const char *>(entry->metadata.data),
+                     entry->metadata.data_length);
+  if (!metadata.starts_with(kLayoutMetadataPrefix))
+    return success();
+  if (metadata == getLayoutMetadata(type))
+    return success();
+  return op->emitError() << "parameter `"
+                         << StringRef(entry->key.data, entry->key.size)
+                         << "` was stored with layout "
+                         << metadata.drop_front(kLayoutMetadataPrefix.size())
+                         << " but is used as " << type;
+}
+
 FailureOr<ArchiveBuilder> createArchiveBuilder(Operation *op) {
   iree_allocator_t hostAllocator = iree_allocator_system();
   iree_io_parameter_archive_builder_t *builderPtr = NULL;
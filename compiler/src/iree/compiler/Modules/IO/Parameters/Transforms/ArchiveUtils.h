@@ -10,6 +10,7 @@
 #include "llvm/Support/FileOutputBuffer.h"
 #include "mlir/IR/Diagnostics.h"
 #include "mlir/IR/Operation.h"
+#include "mlir/IR/Types.h"
 
 #include "iree/base/api.h"
 #include "iree/io/file_handle.h"
@@ -75,6 +76,18 @@ FailureOr<FileStreamIndex> createParameterIndex(Operation *op,
                                                 ArchiveBuilder builder,
                                                 StringRef archivePath);
 
+// Returns the entry metadata recording the storage layout of a parameter of
+// |type|. Parameters exported after data tiling are stored in their packed
+// target-specific shape and the layout lets importers detect archives
+// produced for a different target or configuration.
+std::string getLayoutMetadata(Type type);
+
+// Verifies that the layout recorded in the metadata of |entry|, if any,
+// matches |type|. Entries without layout metadata are always accepted.
+LogicalResult
+verifyLayoutMetadata(Operation *op, Type type,
+                     const iree_io_parameter_index_entry_t *entry);
+
 } // namespace mlir::iree_compiler::IREE::IO::Parameters
 
 #endif // IREE_COMPILER_MODULES_IO_PARAMETERS_TRANSFORMS_ARCHIVEUTILS_H_
@@ -14,8 +14,10 @@
 #include "llvm/Support/Error.h"
 #include "llvm/Support/FileOutputBuffer.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
+#include "mlir/IR/BuiltinAttributes.h"
 #include "mlir/IR/BuiltinOps.h"
 #include "mlir/IR/Diagnostics.h"
+#include "mlir/IR/DialectResourceBlobManager.h"
 #include "mlir/IR/PatternMatch.h"
 #include "mlir/Support/FileUtilities.h"
 
@@ -39,11 +41,13 @@ addSplatEntry(IREE::Util::GlobalOpInterface globalOp,
   }
 
   StringRef name = globalOp.getGlobalName();
+  std::string metadata = getLayoutMetadata(globalOp.getGlobalType());
   return handleRuntimeError(
       globalOp,
       iree_io_parameter_archive_builder_add_splat_entry(
           builder, iree_make_string_view(name.data(), name.size()),
-          /*metadata=*/iree_const_byte_span_empty(), pattern.data(),
+          iree_make_const_byte_span(metadata.data(), metadata.size()),
+          pattern.data(),
           static_cast<uint8_t>(pattern.size()), storageSize),
       "failed to add splat entry for global");
 }
@@ -54,11 +58,12 @@ addDataEntry(IREE::Util::GlobalOpInterface globalOp,
              int64_t storageSize,
              iree_io_parameter_archive_builder_t *builder) {
   StringRef name = globalOp.getGlobalName();
+  std::string metadata = getLayoutMetadata(globalOp.getGlobalType());
   return handleRuntimeError(
       globalOp,
       iree_io_parameter_archive_builder_add_data_entry(
           builder, iree_make_string_view(name.data(), name.size()),
-          /*metadata=*/iree_const_byte_span_empty(),
+          iree_make_const_byte_span(metadata.data(), metadata.size()),
           /*alignment=*/
           IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT, storageSize),
       "failed to add data entry for global");
@@ -81,6 +86,30 @@ static LogicalResult addEntry(IREE::Util::GlobalOpInterface globalOp,
   return addDataEntry(globalOp, valueAttr, valueAttr.getStorageSize(), builder);
 }
 
+// Drops the data of the exported resource |handles| that are no longer
+// referenced by any attribute in |moduleOp|. Large inline weights are commonly
+// stored as dense_resource blobs owned by the context and they would otherwise
+// stay in memory for the remainder of the compilation even though the program
+// now only references them by parameter.
+static void
+releaseExportedResources(ModuleOp moduleOp,
+                         ArrayRef<DenseResourceElementsHandle> handles) {
+  if (handles.empty())
+    return;
+  llvm::DenseSet<DialectResourceBlobManager::BlobEntry *> referencedResources;
+  moduleOp->walk([&](Operation *op) {
+    op->getAttrDictionary().walk([&](DenseResourceElementsAttr attr) {
+      referencedResources.insert(attr.getRawHandle().getResource());
+    });
+  });
+  for (DenseResourceElementsHandle handle : handles) {
+    auto *resource = handle.getResource();
+    if (resource && !referencedResources.contains(resource)) {
+      resource->setBlob(AsmResourceBlob());
+    }
+  }
+}
+
 struct ExportParametersPass
     : public IREE::IO::Parameters::impl::ExportParametersPassBase<
           ExportParametersPass> {
@@ -137,6 +166,7 @@ struct ExportParametersPass
     auto [file, stream, index] = *std::move(fileStreamIndexOr);
 
     // Serialize parameters to the file.
+    SmallVector<DenseResourceElementsHandle> exportedResources;
     for (auto globalOp : constantGlobalOps) {
       // Lookup the entry in the index corresponding to the global.
       const iree_io_parameter_index_entry_t *entry = nullptr;
@@ -174,6 +204,10 @@ struct ExportParametersPass
       }
 
       // Change the global to reference the parameter.
+      if (auto resourceAttr = dyn_cast<DenseResourceElementsAttr>(
+              globalOp.getGlobalInitialValue())) {
+        exportedResources.push_back(resourceAttr.getRawHandle());
+      }
       globalOp.setGlobalInitialValue(IREE::Flow::NamedParameterAttr::get(
           context, globalOp.getGlobalType(), StringAttr::get(context, scope),
           StringAttr::get(context, name), DictionaryAttr()));
@@ -189,6 +223,9 @@ struct ExportParametersPass
                             });
       return signalPassFailure();
     }
+
+    // The data now lives in the archive and is no longer needed in memory.
+    releaseExportedResources(moduleOp, exportedResources);
   }
 };
 
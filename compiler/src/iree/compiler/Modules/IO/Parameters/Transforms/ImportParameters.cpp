@@ -332,6 +332,13 @@ struct ImportParametersPass
         continue;
       }
 
+      // Parameters exported after data tiling are stored in a packed layout;
+      // refuse to use them with a global expecting a different one.
+      if (failed(verifyLayoutMetadata(globalOp, globalOp.getGlobalType(),
+                                      entry))) {
+        return signalPassFailure();
+      }
+
       // Filter only to globals of types we serialize.
       if (!isTypeSupported(globalOp.getGlobalType())) {
         llvm::errs() << "WARNING: not importing parameter `"
@@ -0,0 +1,34 @@
+// RUN: iree-opt --pass-pipeline="builtin.module(iree-io-export-parameters{path="opt=%t.irpa" minimum-size=0})" %s | FileCheck %s
+// RUN: iree-dump-parameters --parameters=%t.irpa | FileCheck %s --check-prefix=DUMP
+
+// Resources only referenced by exported globals are released while those still
+// referenced elsewhere in the program are kept.
+
+//      CHECK: util.global private @resource_exported = #flow.parameter.named<"opt"::"resource_exported"> : tensor<2xf32>
+//       DUMP: {{[0-9]+}} | {{[0-9]+}} | 8 | `resource_exported`
+util.global private @resource_exported = dense_resource<exported> : tensor<2xf32>
+
+// CHECK-NEXT: util.global private @resource_shared = #flow.parameter.named<"opt"::"resource_shared"> : tensor<2xf32>
+//  DUMP-NEXT: {{[0-9]+}} | {{[0-9]+}} | 8 | `resource_shared`
+util.global private @resource_shared = dense_resource<shared> : tensor<2xf32>
+
+// CHECK: util.func public @use_shared
+util.func public @use_shared() -> tensor<2xf32> {
+  // CHECK: arith.constant dense_resource<shared> : tensor<2xf32>
+  %cst = arith.constant dense_resource<shared> : tensor<2xf32>
+  util.return %cst : tensor<2xf32>
+}
+
+//      CHECK: dialect_resources
+//  CHECK-NOT:   exported
+//      CHECK:   shared: "0x04000000
+//  CHECK-NOT:   exported
+
+{-#
+  dialect_resources: {
+    builtin: {
+      exported: "0x040000000000803F00000040",
+      shared: "0x040000000000404000008040"
+    }
+  }
+#-}
@@ -0,0 +1,9 @@
+// RUN: echo 'util.global private @weight = dense<[[1.0, 2.0], [3.0, 4.0]]> : tensor<2x2xf32>' | \
+// RUN:   iree-opt --pass-pipeline="builtin.module(iree-io-export-parameters{path="opt=%t.irpa" minimum-size=0})" -o /dev/null
+// RUN: iree-opt --pass-pipeline="builtin.module(iree-io-import-parameters{paths="opt=%t.irpa"})" --verify-diagnostics %s
+
+// Parameters record the layout they were exported with (e.g. the packed shape
+// of a data-tiled weight) and must be used with the same layout.
+
+// expected-error @+1 {{parameter `weight` was stored with layout tensor<2x2xf32> but is used as tensor<4xf32>}}
+util.global private @weight = #flow.parameter.named<"opt"::"weight"> : tensor<4xf32>
@@ -84,6 +84,12 @@ void InputDialectOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc("Converts all bf16 ops and values into f32 counterparts "
                      "unconditionally before main global optimizations."),
       llvm::cl::cat(category));
+  binder.list<std::string>(
+      "iree-input-mesh-devices", meshDevices,
+      llvm::cl::desc("Places the processes of the input mesh on the given "
+                     "device globals in linear process order and lowers mesh "
+                     "collectives to transfers between them."),
+      llvm::cl::cat(category));
 }
 
 InputDialectOptions::Type InputDialectOptions::parseInputTypeMnemonic() {
@@ -153,6 +159,11 @@ void GlobalOptimizationOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc("Maximum byte size increase allowed for constant expr "
                      "hoisting policy to allow hoisting."),
       llvm::cl::cat(category));
+  binder.opt<int64_t>(
+      "iree-opt-const-expr-memory-budget", constExprMemoryBudget,
+      llvm::cl::desc("Maximum total byte size increase allowed across all "
+                     "hoisted constant exprs (0 for unlimited)."),
+      llvm::cl::cat(category));
   binder.opt<bool>(
       "iree-opt-numeric-precision-reduction", numericPrecisionReduction,
       llvm::cl::desc(
@@ -177,6 +188,21 @@ void GlobalOptimizationOptions::bindOptions(OptionsBinder &binder) {
                       llvm::cl::desc("Maximum size of parameters to import."),
                       llvm::cl::cat(category));
 
+  binder.opt<std::string>(
+      "iree-opt-externalize-parameters", parameterExternalizePath,
+      llvm::cl::desc(
+          "File path to an archive to externalize constants to with an "
+          "optional `scope=` prefix before global optimization. Keeps large "
+          "inline weights out of compiler memory at the cost of excluding "
+          "them from const-eval."),
+      llvm::cl::cat(category));
+  binder.opt<int64_t>(
+      "iree-opt-externalize-parameter-minimum-size",
+      parameterExternalizeMinimumSize,
+      llvm::cl::desc("Minimum size of constants to externalize to the archive "
+                     "created in `iree-opt-externalize-parameters`."),
+      llvm::cl::cat(category));
+
   binder.opt<std::string>(
       "iree-opt-export-parameters", parameterExportPath,
       llvm::cl::desc("File path to an archive to export parameters to with an "
@@ -246,6 +272,24 @@ void SchedulingOptions::bindOptions(OptionsBinder &binder) {
       llvm::cl::desc(
           "Enables binding fusion and dispatch site specialization."),
       llvm::cl::cat(category));
+
+  binder.opt<bool>(
+      "iree-scheduling-place-affinities", placeAffinities,
+      llvm::cl::desc("Assigns dispatches without an explicit affinity to the "
+                     "device with the lowest estimated cost including launch "
+                     "overhead and transfers when multiple devices are "
+                     "available."),
+      llvm::cl::cat(category));
+
+  binder.opt<bool>(
+      "iree-scheduling-place-scalar-dispatches-on-host",
+      placeScalarDispatchesOnHost,
+      llvm::cl::desc(
+          "Places scalar dispatches (such as index math) on a host CPU device "
+          "when one is available in addition to accelerators. The host device "
+          "should use a synchronous local HAL driver (local-sync) so that the "
+          "dispatches execute inline and avoid accelerator launch overheads."),
+      llvm::cl::cat(category));
 }
 
 } // namespace mlir::iree_compiler
@@ -62,6 +62,11 @@ struct InputDialectOptions {
   // include and which are implicated in blocking downstream optimizations.
   bool optimizeIndexArithmetic = true;
 
+  // Device globals to place mesh processes on in linear process order. When
+  // set the program is lowered to a single multi-device program instead of one
+  // program per mesh process.
+  std::vector<std::string> meshDevices;
+
   void bindOptions(OptionsBinder &binder);
   using FromFlags = OptionsFromFlags<InputDialectOptions>;
 };
@@ -86,6 +91,12 @@ struct GlobalOptimizationOptions {
   // allow hoisting. The threshold is 1MB by default.
   int64_t constExprMaxSizeIncreaseThreshold = 1024 * 1024;
 
+  // Maximum total byte size increase allowed for all hoisted constant exprs,
+  // or 0 for unlimited. Should be set below the memory available on the
+  // target devices to avoid hoisting expanded (dequantized, broadcasted, etc)
+  // copies of large parameters.
+  int64_t constExprMemoryBudget = 0;
+
   // File paths to archives to import parameters from with an optional
   // `scope=` prefix.
   std::vector<std::string> parameterImportPaths;
@@ -95,6 +106,14 @@ struct GlobalOptimizationOptions {
   // Maximum size of parameters to import or 0 to disable automatic import.
   int64_t parameterImportMaximumSize = 0;
 
+  // File path to an archive to externalize inline constants to with an
+  // optional `scope=` prefix. Unlike parameterExportPath this happens before
+  // any global optimization so that large weights are not kept in compiler
+  // memory.
+  std::string parameterExternalizePath;
+  // Minimum size of constants to externalize as parameters.
+  int64_t parameterExternalizeMinimumSize = 0;
+
   // File path to an archive to export parameters to with an optional
   // `scope=` prefix.
   std::string parameterExportPath;
@@ -178,6 +197,10 @@ struct SchedulingOptions {
   std::string dumpStatisticsFile = "";
   // Enables fusing bindings with the same underlying storage.
   bool optimizeBindings = true;
+  // Enables cost-driven placement of dispatches across available devices.
+  bool placeAffinities = false;
+  // Places scalar dispatches on a host CPU device when one is available.
+  bool placeScalarDispatchesOnHost = false;
 
   // TODO(benvanik): favor size/speed/etc for partitioning.
   // TODO(benvanik): execution model to optimize for (unified/discrete memory,
@@ -303,6 +303,15 @@ void buildIREEVMTransformPassPipeline(
       IREE_TRACE_ADD_BEGIN_FRAME_PASS(passManager, "Stream");
       if (hooks.beforePhase)
         hooks.beforePhase(IREEVMPipelinePhase::Stream, passManager);
+      if (schedulingOptions.placeAffinities ||
+          schedulingOptions.placeScalarDispatchesOnHost) {
+        IREE::HAL::PlaceDispatchAffinitiesPassOptions placeOptions;
+        placeOptions.placeByCost = schedulingOptions.placeAffinities;
+        placeOptions.scalarDispatchesOnHost =
+            schedulingOptions.placeScalarDispatchesOnHost;
+        passManager.addPass(
+            IREE::HAL::createPlaceDispatchAffinitiesPass(placeOptions));
+      }
       IREE::Stream::buildStreamTransformPassPipeline(passManager,
                                                      streamOptions);
       if (hooks.afterPhase)
@@ -13,11 +13,15 @@
 #include "iree/compiler/Dialect/HAL/Analysis/DeviceAnalysis.h"
 #include "iree/compiler/Dialect/HAL/IR/HALTypes.h"
 #include "iree/compiler/Dialect/Stream/Analysis/Affinity.h"
+#include "iree/compiler/Dialect/Util/Analysis/IntegerDivisibilityAnalysis.h"
+#include "iree/compiler/Dialect/Util/IR/UtilTypes.h"
 #include "iree/compiler/Preprocessing/Common/Passes.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/SmallVectorExtras.h"
 #include "llvm/Support/MathExtras.h"
+#include "mlir/Analysis/DataFlow/DeadCodeAnalysis.h"
+#include "mlir/Analysis/DataFlowFramework.h"
 #include "mlir/Dialect/Affine/IR/AffineOps.h"
 #include "mlir/Dialect/Arith/IR/Arith.h"
 #include "mlir/Dialect/Linalg/IR/Linalg.h"
@@ -37,6 +41,11 @@ constexpr int64_t kVerySkinnyDimThreshold = 4;
 
 static Value getPaddedValue(RewriterBase &rewriter, Location loc,
                             Value padSource, ArrayRef<OpFoldResult> padding) {
+  if (llvm::all_of(padding, [](OpFoldResult pad) {
+        return isConstantIntValue(pad, 0);
+      })) {
+    return padSource;
+  }
   auto sourceType = cast<RankedTensorType>(padSource.getType());
   ArrayRef<int64_t> sourceShape = sourceType.getShape();
   auto paddedShape =
@@ -310,9 +319,29 @@ padConvOp(RewriterBase &rewriter, linalg::LinalgOp linalgOp,
   rewriter.replaceOp(linalgOp, extracted);
 }
 
+// Returns true if dynamic dimension |dim| of |value| is known to be a multiple
+// of |size| based on the divisibility of its SSA dimension value, e.g. from a
+// `util.assume.int` hint on a dynamic batch or sequence length.
+static bool isDynamicDimMultipleOf(const DataFlowSolver &solver, Value value,
+                                   int64_t dim, int64_t size) {
+  auto shapedType = cast<ShapedType>(value.getType());
+  std::optional<ValueRange> dynamicDims = IREE::Util::findDynamicDims(value);
+  if (!dynamicDims || dynamicDims->size() != shapedType.getNumDynamicDims()) {
+    return false;
+  }
+  Value dimValue = (*dynamicDims)[shapedType.getDynamicDimIndex(dim)];
+  auto *divisibility =
+      solver.lookupState<IREE::Util::IntegerDivisibilityLattice>(dimValue);
+  if (!divisibility || divisibility->getValue().isUninitialized()) {
+    return false;
+  }
+  return divisibility->getValue().getValue().udiv() % size == 0;
+}
+
 static void padContractionLikeOp(
     RewriterBase &rewriter, linalg::LinalgOp linalgOp,
-    ArrayRef<IREE::HAL::ExecutableTargetAttr> executableTargets) {
+    ArrayRef<IREE::HAL::ExecutableTargetAttr> executableTargets,
+    const DataFlowSolver &solver) {
   FailureOr<mlir::linalg::ContractionDimensions> contractionDims =
       mlir::linalg::inferContractionDims(linalgOp);
 
@@ -388,11 +417,19 @@ static void padContractionLikeOp(
         if (!mOperandDimPair)
           return;
         auto [mOperand, mOperandDim] = mOperandDimPair.value();
-        mSizeExpr = rewriter.create<tensor::DimOp>(loc, mOperand, mOperandDim)
-                        .getResult();
         dimsToExpandCandidate.emplace_back(mDim, intrinsic.mSizes[0]);
+        // Known multiples only need to be blocked, not padded.
+        if (isDynamicDimMultipleOf(solver, mOperand, mOperandDim,
+                                   intrinsic.mSizes[0])) {
+          mPadding = zero;
+        } else {
+          mSizeExpr =
+              rewriter.create<tensor::DimOp>(loc, mOperand, mOperandDim)
+                  .getResult();
+        }
       }
-      mPadding = getPadding(mSizeExpr, intrinsic.mSizes[0]);
+      if (!mPadding)
+        mPadding = getPadding(mSizeExpr, intrinsic.mSizes[0]);
     }
 
     if (nSize % intrinsic.nSizes[0] != 0 || ShapedType::isDynamic(nSize)) {
@@ -402,11 +439,19 @@ static void padContractionLikeOp(
         if (!nOperandDimPair)
           return;
         auto [nOperand, nOperandDim] = nOperandDimPair.value();
-        nSizeExpr = rewriter.create<tensor::DimOp>(loc, nOperand, nOperandDim)
-                        .getResult();
         dimsToExpandCandidate.emplace_back(nDim, intrinsic.nSizes[0]);
+        // Known multiples only need to be blocked, not padded.
+        if (isDynamicDimMultipleOf(solver, nOperand, nOperandDim,
+                                   intrinsic.nSizes[0])) {
+          nPadding = zero;
+        } else {
+          nSizeExpr =
+              rewriter.create<tensor::DimOp>(loc, nOperand, nOperandDim)
+                  .getResult();
+        }
       }
-      nPadding = getPadding(nSizeExpr, intrinsic.nSizes[0]);
+      if (!nPadding)
+        nPadding = getPadding(nSizeExpr, intrinsic.nSizes[0]);
     }
 
     if (kSize % intrinsic.kSizes[0] != 0 || ShapedType::isDynamic(kSize)) {
@@ -416,11 +461,19 @@ static void padContractionLikeOp(
         if (!kOperandDimPair)
           return;
         auto [kOperand, kOperandDim] = kOperandDimPair.value();
-        kSizeExpr = rewriter.create<tensor::DimOp>(loc, kOperand, kOperandDim)
-                        .getResult();
         dimsToExpandCandidate.emplace_back(kDim, intrinsic.kSizes[0]);
+        // Known multiples only need to be blocked, not padded.
+        if (isDynamicDimMultipleOf(solver, kOperand, kOperandDim,
+                                   intrinsic.kSizes[0])) {
+          kPadding = zero;
+        } else {
+          kSizeExpr =
+              rewriter.create<tensor::DimOp>(loc, kOperand, kOperandDim)
+                  .getResult();
+        }
       }
-      kPadding = getPadding(kSizeExpr, intrinsic.kSizes[0]);
+      if (!kPadding)
+        kPadding = getPadding(kSizeExpr, intrinsic.kSizes[0]);
     }
 
     if (!mPadding && !nPadding && !kPadding) {
@@ -554,6 +607,14 @@ void PadToIntrinsicsPass::runOnOperation() {
   if (failed(deviceAnalysis.run())) {
     return signalPassFailure();
   }
+  // Divisibility of dynamic dimensions lets us skip padding those that are
+  // already aligned to the intrinsic.
+  DataFlowSolver solver;
+  solver.load<dataflow::DeadCodeAnalysis>();
+  solver.load<IREE::Util::IntegerDivisibilityAnalysis>();
+  if (failed(solver.initializeAndRun(moduleOp))) {
+    return signalPassFailure();
+  }
 
   bool padConvOps = padTargetType == PadTargetType::ConvOp ||
                     padTargetType == PadTargetType::All;
@@ -600,7 +661,7 @@ void PadToIntrinsicsPass::runOnOperation() {
     rewriter.setInsertionPoint(contractOp);
     auto executableTargetAttrs = getRequiredExecutableTargetAttrs(contractOp);
     padContractionLikeOp(rewriter, contractOp,
-                         executableTargetAttrs.getArrayRef());
+                         executableTargetAttrs.getArrayRef(), solver);
   }
 }
 
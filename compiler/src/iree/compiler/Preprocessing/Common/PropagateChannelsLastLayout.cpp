@@ -0,0 +1,332 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Preprocessing/Common/Passes.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "llvm/Support/Debug.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/Dialect/Tensor/IR/Tensor.h"
+#include "mlir/Dialect/Utils/IndexingUtils.h"
+#include "mlir/IR/AffineMap.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/IR/IRMapping.h"
+#include "mlir/IR/PatternMatch.h"
+
+#define DEBUG_TYPE "iree-preprocessing-propagate-channels-last-layout"
+#define DBGS() (llvm::dbgs() << "[" DEBUG_TYPE "]: ")
+#define LDBG(X) LLVM_DEBUG(DBGS() << X << "\n")
+
+namespace mlir::iree_compiler::Preprocessing {
+
+#define GEN_PASS_DEF_PROPAGATECHANNELSLASTLAYOUTPASS
+#include "iree/compiler/Preprocessing/Common/Passes.h.inc" // IWYU pragma: export
+
+namespace {
+
+// Permutations from NCHW to NHWC and back.
+static const int64_t kToChannelsLast[] = {0, 2, 3, 1};
+static const int64_t kToChannelsFirst[] = {0, 3, 1, 2};
+// Permutation from FCHW filters to HWCF filters.
+static const int64_t kFilterToChannelsLast[] = {2, 3, 1, 0};
+
+//===----------------------------------------------------------------------===//
+// Layout assignment
+//===----------------------------------------------------------------------===//
+
+static bool isLayoutCandidate(Value value) {
+  auto tensorType = dyn_cast<RankedTensorType>(value.getType());
+  return tensorType && tensorType.getRank() == 4;
+}
+
+// Returns true if |op| is a channels-first op with a channels-last equivalent.
+static bool isChannelsFirstAnchor(Operation *op) {
+  return isa<linalg::Conv2DNchwFchwOp, linalg::PoolingNchwSumOp,
+             linalg::PoolingNchwMaxOp>(op);
+}
+
+// Returns true if |padOp| can be performed in either layout.
+static bool isLayoutAgnosticPad(tensor::PadOp padOp) {
+  return padOp.getConstantPaddingValue() != nullptr;
+}
+
+// Returns the set of 4-D values in |rootOp| to store channels-last. The set is
+// seeded with the operands of channels-first convolutions and poolings and
+// grown through the ops that can produce or consume either layout: empty
+// tensors, fills, constant pads, and generics where the value is indexed the
+// same way as a result. A value produced by a generic or fill is only in the
+// set together with its tied init.
+static llvm::SetVector<Value> assignChannelsLastValues(Operation *rootOp) {
+  llvm::SetVector<Value> values;
+  SmallVector<Value> worklist;
+  auto insert = [&](Value value) {
+    if (isLayoutCandidate(value) && values.insert(value)) {
+      worklist.push_back(value);
+    }
+  };
+
+  rootOp->walk([&](linalg::LinalgOp linalgOp) {
+    if (isChannelsFirstAnchor(linalgOp)) {
+      insert(linalgOp.getDpsInputs()[0]);
+      insert(linalgOp.getDpsInits()[0]);
+      insert(linalgOp->getResult(0));
+    }
+  });
+
+  while (!worklist.empty()) {
+    Value value = worklist.pop_back_val();
+
+    // Pull the layout up into the producer.
+    if (auto result = dyn_cast<OpResult>(value)) {
+      Operation *definingOp = result.getOwner();
+      if (auto genericOp = dyn_cast<linalg::GenericOp>(definingOp)) {
+        OpOperand *initOperand = genericOp.getTiedOpOperand(result);
+        insert(initOperand->get());
+        AffineMap initMap = genericOp.getMatchingIndexingMap(initOperand);
+        for (OpOperand *inputOperand : genericOp.getDpsInputOperands()) {
+          if (genericOp.getMatchingIndexingMap(inputOperand) == initMap) {
+            insert(inputOperand->get());
+          }
+        }
+      } else if (auto fillOp = dyn_cast<linalg::FillOp>(definingOp)) {
+        insert(fillOp.getDpsInits()[0]);
+      } else if (auto padOp = dyn_cast<tensor::PadOp>(definingOp)) {
+        if (isLayoutAgnosticPad(padOp)) {
+          insert(padOp.getSource());
+        }
+      }
+    }
+
+    // Push the layout down into the consumers.
+    for (OpOperand &use : value.getUses()) {
+      Operation *user = use.getOwner();
+      if (auto genericOp = dyn_cast<linalg::GenericOp>(user)) {
+        AffineMap map = genericOp.getMatchingIndexingMap(&use);
+        for (OpOperand &initOperand : genericOp.getDpsInitsMutable()) {
+          if (genericOp.getMatchingIndexingMap(&initOperand) == map) {
+            insert(initOperand.get());
+            insert(genericOp.getTiedOpResult(&initOperand));
+          }
+        }
+      } else if (auto fillOp = dyn_cast<linalg::FillOp>(user)) {
+        insert(fillOp.getResult(0));
+      } else if (auto padOp = dyn_cast<tensor::PadOp>(user)) {
+        if (isLayoutAgnosticPad(padOp)) {
+          insert(padOp.getResult());
+        }
+      }
+    }
+  }
+  return values;
+}
+
+//===----------------------------------------------------------------------===//
+// Rewriting
+//===----------------------------------------------------------------------===//
+
+static Value createTranspose(OpBuilder &builder, Location loc, Value value,
+                             ArrayRef<int64_t> perm) {
+  SmallVector<OpFoldResult> mixedSizes =
+      tensor::getMixedSizes(builder, loc, value);
+  applyPermutationToVector(mixedSizes, perm);
+  Value empty = builder.create<tensor::EmptyOp>(
+      loc, mixedSizes, getElementTypeOrSelf(value.getType()));
+  return builder.create<linalg::TransposeOp>(loc, value, empty, perm)
+      .getResult()[0];
+}
+
+static AffineMap getChannelsLastMap(AffineMap map) {
+  return AffineMap::get(map.getNumDims(), map.getNumSymbols(),
+                        applyPermutation(map.getResults(), kToChannelsLast),
+                        map.getContext());
+}
+
+template <typename ChannelsLastOpTy, typename ChannelsFirstOpTy>
+static Value createChannelsLastPooling(OpBuilder &builder,
+                                       ChannelsFirstOpTy poolingOp,
+                                       Value input, Value init) {
+  return builder
+      .create<ChannelsLastOpTy>(
+          poolingOp.getLoc(), init.getType(),
+          ValueRange{input, poolingOp.getDpsInputs()[1]}, init,
+          poolingOp.getStrides(), poolingOp.getDilations())
+      .getResult(0);
+}
+
+class PropagateChannelsLastLayoutPass
+    : public iree_compiler::Preprocessing::impl::
+          PropagateChannelsLastLayoutPassBase<PropagateChannelsLastLayoutPass> {
+public:
+  void runOnOperation() override {
+    auto funcOp = getOperation();
+    llvm::SetVector<Value> values = assignChannelsLastValues(funcOp);
+    if (values.empty()) {
+      return;
+    }
+    LDBG("assigned channels-last layout to " << values.size() << " values");
+
+    // Gather the ops producing or consuming channels-last values that can be
+    // rewritten. Producers are visited before their consumers.
+    SmallVector<Operation *> rewriteOps;
+    funcOp.walk([&](Operation *op) {
+      if (isa<linalg::GenericOp>(op)) {
+        if (llvm::any_of(op->getOperands(),
+                         [&](Value v) { return values.contains(v); })) {
+          rewriteOps.push_back(op);
+        }
+      } else if (isa<tensor::EmptyOp, linalg::FillOp>(op) ||
+                 isChannelsFirstAnchor(op)) {
+        if (values.contains(op->getResult(0))) {
+          rewriteOps.push_back(op);
+        }
+      } else if (auto padOp = dyn_cast<tensor::PadOp>(op)) {
+        if (values.contains(padOp.getResult()) && isLayoutAgnosticPad(padOp)) {
+          rewriteOps.push_back(op);
+        }
+      }
+    });
+    llvm::SmallPtrSet<Operation *, 16> rewriteOpSet(rewriteOps.begin(),
+                                                    rewriteOps.end());
+
+    // Returns the value of |operand| in channels-last order. Values produced by
+    // ops that are not rewritten are transposed where they are defined.
+    IRRewriter rewriter(&getContext());
+    DenseMap<Value, Value> channelsLastValues;
+    llvm::SmallPtrSet<OpOperand *, 16> convertedUses;
+    auto getChannelsLast = [&](OpOperand &operand) -> Value {
+      convertedUses.insert(&operand);
+      Value value = operand.get();
+      auto it = channelsLastValues.find(value);
+      if (it != channelsLastValues.end()) {
+        return it->second;
+      }
+      OpBuilder::InsertionGuard guard(rewriter);
+      rewriter.setInsertionPointAfterValue(value);
+      Value transposed =
+          createTranspose(rewriter, value.getLoc(), value, kToChannelsLast);
+      channelsLastValues[value] = transposed;
+      return transposed;
+    };
+
+    for (Operation *op : rewriteOps) {
+      rewriter.setInsertionPoint(op);
+      Location loc = op->getLoc();
+      Value newValue;
+      if (auto emptyOp = dyn_cast<tensor::EmptyOp>(op)) {
+        SmallVector<OpFoldResult> mixedSizes = emptyOp.getMixedSizes();
+        applyPermutationToVector(mixedSizes, kToChannelsLast);
+        newValue = rewriter.create<tensor::EmptyOp>(
+            loc, mixedSizes, emptyOp.getType().getElementType());
+      } else if (auto fillOp = dyn_cast<linalg::FillOp>(op)) {
+        newValue =
+            rewriter
+                .create<linalg::FillOp>(
+                    loc, fillOp.getDpsInputs(),
+                    ValueRange{getChannelsLast(*fillOp.getDpsInitOperand(0))})
+                .getResult(0);
+      } else if (auto padOp = dyn_cast<tensor::PadOp>(op)) {
+        SmallVector<OpFoldResult> low = padOp.getMixedLowPad();
+        SmallVector<OpFoldResult> high = padOp.getMixedHighPad();
+        applyPermutationToVector(low, kToChannelsLast);
+        applyPermutationToVector(high, kToChannelsLast);
+        Value source = getChannelsLast(padOp.getSourceMutable());
+        auto resultType = RankedTensorType::get(
+            applyPermutation(padOp.getResultType().getShape(),
+                             kToChannelsLast),
+            padOp.getResultType().getElementType());
+        newValue = rewriter.create<tensor::PadOp>(
+            loc, resultType, source, low, high,
+            padOp.getConstantPaddingValue(), padOp.getNofold());
+      } else if (auto convOp = dyn_cast<linalg::Conv2DNchwFchwOp>(op)) {
+        Value input = getChannelsLast(*convOp.getDpsInputOperand(0));
+        Value filter = createTranspose(rewriter, loc, convOp.getDpsInputs()[1],
+                                       kFilterToChannelsLast);
+        Value init = getChannelsLast(*convOp.getDpsInitOperand(0));
+        newValue = rewriter
+                       .create<linalg::Conv2DNhwcHwcfOp>(
+                           loc, init.getType(), ValueRange{input, filter},
+                           init, convOp.getStrides(), convOp.getDilations())
+                       .getResult(0);
+      } else if (auto poolingOp = dyn_cast<linalg::PoolingNchwSumOp>(op)) {
+        newValue = createChannelsLastPooling<linalg::PoolingNhwcSumOp>(
+            rewriter, poolingOp,
+            getChannelsLast(*poolingOp.getDpsInputOperand(0)),
+            getChannelsLast(*poolingOp.getDpsInitOperand(0)));
+      } else if (auto poolingOp = dyn_cast<linalg::PoolingNchwMaxOp>(op)) {
+        newValue = createChannelsLastPooling<linalg::PoolingNhwcMaxOp>(
+            rewriter, poolingOp,
+            getChannelsLast(*poolingOp.getDpsInputOperand(0)),
+            getChannelsLast(*poolingOp.getDpsInitOperand(0)));
+      } else {
+        // Generics keep their iteration space and only reorder the indexing
+        // map results of the channels-last operands.
+        auto genericOp = cast<linalg::GenericOp>(op);
+        SmallVector<Value> inputs;
+        SmallVector<Value> inits;
+        SmallVector<AffineMap> indexingMaps;
+        for (OpOperand &operand : genericOp->getOpOperands()) {
+          Value operandValue = operand.get();
+          AffineMap map = genericOp.getMatchingIndexingMap(&operand);
+          if (values.contains(operandValue)) {
+            operandValue = getChannelsLast(operand);
+            map = getChannelsLastMap(map);
+          }
+          if (genericOp.isDpsInput(&operand)) {
+            inputs.push_back(operandValue);
+          } else {
+            inits.push_back(operandValue);
+          }
+          indexingMaps.push_back(map);
+        }
+        auto newOp = rewriter.create<linalg::GenericOp>(
+            loc, ValueRange(inits).getTypes(), inputs, inits, indexingMaps,
+            genericOp.getIteratorTypesArray());
+        newOp->setDiscardableAttrs(genericOp->getDiscardableAttrDictionary());
+        IRMapping mapper;
+        genericOp.getRegion().cloneInto(&newOp.getRegion(), mapper);
+        for (auto [result, newResult] :
+             llvm::zip_equal(genericOp->getResults(), newOp->getResults())) {
+          if (values.contains(result)) {
+            channelsLastValues[result] = newResult;
+          } else {
+            rewriter.replaceAllUsesWith(result, newResult);
+          }
+        }
+        continue;
+      }
+      channelsLastValues[op->getResult(0)] = newValue;
+    }
+
+    // Transpose back to channels-first for any remaining users such as
+    // function returns and ops without channels-last support.
+    auto isConvertedUse = [&](OpOperand &use) {
+      return convertedUses.contains(&use);
+    };
+    for (Value value : values) {
+      Operation *definingOp = value.getDefiningOp();
+      if (!definingOp || !rewriteOpSet.contains(definingOp) ||
+          llvm::all_of(value.getUses(), isConvertedUse)) {
+        continue;
+      }
+      Value channelsLast = channelsLastValues[value];
+      rewriter.setInsertionPointAfterValue(channelsLast);
+      Value channelsFirst = createTranspose(rewriter, value.getLoc(),
+                                            channelsLast, kToChannelsFirst);
+      rewriter.replaceUsesWithIf(value, channelsFirst, [&](OpOperand &use) {
+        return !isConvertedUse(use);
+      });
+    }
+
+    // All uses of the original ops have been replaced.
+    for (Operation *op : llvm::reverse(rewriteOps)) {
+      rewriter.eraseOp(op);
+    }
+  }
+};
+
+} // namespace
+
+} // namespace mlir::iree_compiler::Preprocessing
@@ -171,3 +171,28 @@ func.func @dequant_gemm_dynamic_m(%arg0: tensor<4096x32x128xi4>, %arg1: tensor<4
 
 // CONTRACT:        tensor.pad {{.*}} low[0, 0, 0]
 // CONTRACT:        tensor.expand_shape {{.*}} {{\[}}[0, 1], [2], [3]] output_shape {{.*}} : tensor<?x32x128xf16> into tensor<?x16x32x128xf16>
+
+// -----
+
+// Dynamic dimensions known to be multiples of the intrinsic are only blocked.
+
+//       CHECK: func.func @matmul_dynamic_m_aligned(
+//  CHECK-SAME:    %[[ARG0:.+]]: tensor<?x64xf16>,
+//  CHECK-SAME:    %[[ARG1:.+]]: tensor<64x128xf16>,
+//  CHECK-SAME:    %[[ARG2:.+]]: tensor<?x128xf16>,
+func.func @matmul_dynamic_m_aligned(%arg0: tensor<?x64xf16>, %arg1: tensor<64x128xf16>, %arg2: tensor<?x128xf16>, %arg3: index) -> tensor<?x128xf16> {
+  %m = util.assume.int %arg3<udiv = 16> : index
+  %lhs = flow.tensor.tie_shape %arg0 : tensor<?x64xf16>{%m}
+  %init = flow.tensor.tie_shape %arg2 : tensor<?x128xf16>{%m}
+  %0 = linalg.matmul ins(%lhs, %arg1 : tensor<?x64xf16>, tensor<64x128xf16>)
+      outs(%init : tensor<?x128xf16>) -> tensor<?x128xf16>
+  return %0 : tensor<?x128xf16>
+}
+
+// CHECK-NOT:  tensor.pad
+// CHECK:      %[[EXP_LHS:.+]] = tensor.expand_shape %{{.+}} {{\[}}[0, 1], [2]] output_shape {{.*}} : tensor<?x64xf16> into tensor<?x16x64xf16>
+// CHECK:      %[[EXP_INIT:.+]] = tensor.expand_shape %{{.+}} {{\[}}[0, 1], [2]] output_shape {{.*}} : tensor<?x128xf16> into tensor<?x16x128xf16>
+// CHECK:      %[[MM:.+]] = linalg.generic
+// CHECK-SAME:                    ins(%[[EXP_LHS]], %[[ARG1]]
+// CHECK-SAME:                    outs(%[[EXP_INIT]]
+// CHECK:      tensor.collapse_shape %[[MM]] {{\[}}[0, 1], [2]]
@@ -0,0 +1,89 @@
+// RUN: iree-opt --split-input-file --pass-pipeline="builtin.module(util.func(iree-preprocessing-propagate-channels-last-layout))" %s | FileCheck %s
+
+#map = affine_map<(d0, d1, d2, d3) -> (d0, d1, d2, d3)>
+#map1 = affine_map<(d0, d1, d2, d3) -> (d1)>
+util.func @conv_bias_relu_conv(%input: tensor<1x16x18x18xf32>, %filter0: tensor<32x16x3x3xf32>, %bias: tensor<32xf32>, %filter1: tensor<8x32x3x3xf32>) -> tensor<1x8x14x14xf32> {
+  %cst = arith.constant 0.0 : f32
+  %empty0 = tensor.empty() : tensor<1x32x16x16xf32>
+  %fill0 = linalg.fill ins(%cst : f32) outs(%empty0 : tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32>
+  %conv0 = linalg.conv_2d_nchw_fchw {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%input, %filter0 : tensor<1x16x18x18xf32>, tensor<32x16x3x3xf32>)
+      outs(%fill0 : tensor<1x32x16x16xf32>) -> tensor<1x32x16x16xf32>
+  %bias_relu = linalg.generic {indexing_maps = [#map, #map1, #map], iterator_types = ["parallel", "parallel", "parallel", "parallel"]}
+      ins(%conv0, %bias : tensor<1x32x16x16xf32>, tensor<32xf32>) outs(%empty0 : tensor<1x32x16x16xf32>) {
+  ^bb0(%in: f32, %b: f32, %out: f32):
+    %add = arith.addf %in, %b : f32
+    %relu = arith.maximumf %add, %cst : f32
+    linalg.yield %relu : f32
+  } -> tensor<1x32x16x16xf32>
+  %empty1 = tensor.empty() : tensor<1x8x14x14xf32>
+  %fill1 = linalg.fill ins(%cst : f32) outs(%empty1 : tensor<1x8x14x14xf32>) -> tensor<1x8x14x14xf32>
+  %conv1 = linalg.conv_2d_nchw_fchw {dilations = dense<1> : tensor<2xi64>, strides = dense<1> : tensor<2xi64>}
+      ins(%bias_relu, %filter1 : tensor<1x32x16x16xf32>, tensor<8x32x3x3xf32>)
+      outs(%fill1 : tensor<1x8x14x14xf32>) -> tensor<1x8x14x14xf32>
+  util.return %conv1 : tensor<1x8x14x14xf32>
+}
+
+// Tests that the layout of a conv -> bias/relu -> conv chain is assigned as a
+// whole such that only the function input and result are transposed.
+
+// CHECK-DAG: #[[$NHWC:.+]] = affine_map<(d0, d1, d2, d3) -> (d0, d2, d3, d1)>
+// CHECK-DAG: #[[$CHANNEL:.+]] = affine_map<(d0, d1, d2, d3) -> (d1)>
+// CHECK-LABEL: @conv_bias_relu_conv
+//  CHECK-SAME: (%[[INPUT:.+]]: tensor<1x16x18x18xf32>, %[[FILTER0:.+]]: tensor<32x16x3x3xf32>, %[[BIAS:.+]]: tensor<32xf32>, %[[FILTER1:.+]]: tensor<8x32x3x3xf32>)
+//       CHECK:   %[[INPUT_NHWC:.+]] = linalg.transpose ins(%[[INPUT]] : tensor<1x16x18x18xf32>)
+//  CHECK-SAME:     outs(%{{.+}} : tensor<1x18x18x16xf32>) permutation = [0, 2, 3, 1]
+//       CHECK:   %[[EMPTY0:.+]] = tensor.empty() : tensor<1x16x16x32xf32>
+//       CHECK:   %[[FILL0:.+]] = linalg.fill ins(%{{.+}} : f32) outs(%[[EMPTY0]] : tensor<1x16x16x32xf32>)
+//       CHECK:   %[[FILTER0_HWCF:.+]] = linalg.transpose ins(%[[FILTER0]] : tensor<32x16x3x3xf32>)
+//  CHECK-SAME:     outs(%{{.+}} : tensor<3x3x16x32xf32>) permutation = [2, 3, 1, 0]
+//       CHECK:   %[[CONV0:.+]] = linalg.conv_2d_nhwc_hwcf
+//  CHECK-SAME:     ins(%[[INPUT_NHWC]], %[[FILTER0_HWCF]] : tensor<1x18x18x16xf32>, tensor<3x3x16x32xf32>)
+//  CHECK-SAME:     outs(%[[FILL0]] : tensor<1x16x16x32xf32>)
+//       CHECK:   %[[BIAS_RELU:.+]] = linalg.generic
+//  CHECK-SAME:     indexing_maps = [#[[$NHWC]], #[[$CHANNEL]], #[[$NHWC]]]
+//  CHECK-SAME:     ins(%[[CONV0]], %[[BIAS]] : tensor<1x16x16x32xf32>, tensor<32xf32>)
+//  CHECK-SAME:     outs(%[[EMPTY0]] : tensor<1x16x16x32xf32>)
+//       CHECK:   %[[EMPTY1:.+]] = tensor.empty() : tensor<1x14x14x8xf32>
+//       CHECK:   %[[FILL1:.+]] = linalg.fill ins(%{{.+}} : f32) outs(%[[EMPTY1]] : tensor<1x14x14x8xf32>)
+//       CHECK:   %[[FILTER1_HWCF:.+]] = linalg.transpose ins(%[[FILTER1]] : tensor<8x32x3x3xf32>)
+//  CHECK-SAME:     outs(%{{.+}} : tensor<3x3x32x8xf32>) permutation = [2, 3, 1, 0]
+//       CHECK:   %[[CONV1:.+]] = linalg.conv_2d_nhwc_hwcf
+//  CHECK-SAME:     ins(%[[BIAS_RELU]], %[[FILTER1_HWCF]] : tensor<1x16x16x32xf32>, tensor<3x3x32x8xf32>)
+//  CHECK-SAME:     outs(%[[FILL1]] : tensor<1x14x14x8xf32>)
+//       CHECK:   %[[RESULT:.+]] = linalg.transpose ins(%[[CONV1]] : tensor<1x14x14x8xf32>)
+//  CHECK-SAME:     outs(%{{.+}} : tensor<1x8x14x14xf32>) permutation = [0, 3, 1, 2]
+//       CHECK:   util.return %[[RESULT]]
+
+// -----
+
+util.func @pad_max_pool(%input: tensor<1x8x16x16xf32>) -> tensor<1x8x8x8xf32> {
+  %cst = arith.constant 0xFF800000 : f32
+  %padded = tensor.pad %input low[0, 0, 1, 1] high[0, 0, 1, 1] {
+  ^bb0(%i0: index, %i1: index, %i2: index, %i3: index):
+    tensor.yield %cst : f32
+  } : tensor<1x8x16x16xf32> to tensor<1x8x18x18xf32>
+  %window = tensor.empty() : tensor<3x3xf32>
+  %empty = tensor.empty() : tensor<1x8x8x8xf32>
+  %fill = linalg.fill ins(%cst : f32) outs(%empty : tensor<1x8x8x8xf32>) -> tensor<1x8x8x8xf32>
+  %pool = linalg.pooling_nchw_max {dilations = dense<1> : vector<2xi64>, strides = dense<2> : vector<2xi64>}
+      ins(%padded, %window : tensor<1x8x18x18xf32>, tensor<3x3xf32>)
+      outs(%fill : tensor<1x8x8x8xf32>) -> tensor<1x8x8x8xf32>
+  util.return %pool : tensor<1x8x8x8xf32>
+}
+
+// Tests that constant padding feeding a pooling is performed channels-last.
+
+// CHECK-LABEL: @pad_max_pool
+//  CHECK-SAME: (%[[INPUT:.+]]: tensor<1x8x16x16xf32>)
+//       CHECK:   %[[INPUT_NHWC:.+]] = linalg.transpose ins(%[[INPUT]] : tensor<1x8x16x16xf32>)
+//  CHECK-SAME:     outs(%{{.+}} : tensor<1x16x16x8xf32>) permutation = [0, 2, 3, 1]
+//       CHECK:   %[[PADDED:.+]] = tensor.pad %[[INPUT_NHWC]] low[0, 1, 1, 0] high[0, 1, 1, 0]
+//       CHECK:     : tensor<1x16x16x8xf32> to tensor<1x18x18x8xf32>
+//       CHECK:   %[[WINDOW:.+]] = tensor.empty() : tensor<3x3xf32>
+//       CHECK:   %[[POOL:.+]] = linalg.pooling_nhwc_max
+//  CHECK-SAME:     ins(%[[PADDED]], %[[WINDOW]] : tensor<1x18x18x8xf32>, tensor<3x3xf32>)
+//  CHECK-SAME:     -> tensor<1x8x8x8xf32>
+//       CHECK:   %[[RESULT:.+]] = linalg.transpose ins(%[[POOL]] : tensor<1x8x8x8xf32>)
+//  CHECK-SAME:     permutation = [0, 3, 1, 2]
+//       CHECK:   util.return %[[RESULT]]
@@ -0,0 +1,333 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Tuner/TuningCandidates.h"
+
+#include "iree/compiler/Codegen/Dialect/GPU/IR/IREEGPUAttrs.h"
+#include "iree/compiler/Codegen/Utils/GPUUtils.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SetVector.h"
+#include "mlir/Dialect/Linalg/IR/Linalg.h"
+#include "mlir/IR/Builders.h"
+#include "mlir/IR/BuiltinAttributes.h"
+
+namespace mlir::iree_compiler::Tuner {
+
+// Factors applied to a single tile size per step. Tile sizes only move in
+// powers of two as that is what the default heuristics select.
+static const int64_t kScaleNumerators[] = {2, 1};
+static const int64_t kScaleDenominators[] = {1, 2};
+
+// Returns |size| scaled by |num| / |den| or nullopt if not integral.
+static std::optional<int64_t> scaleTileSize(int64_t size, int64_t num,
+                                            int64_t den) {
+  if ((size * num) % den != 0) {
+    return std::nullopt;
+  }
+  int64_t scaled = size * num / den;
+  if (scaled < 1) {
+    return std::nullopt;
+  }
+  return scaled;
+}
+
+linalg::LinalgOp findTuningRootOp(FunctionOpInterface funcOp) {
+  if (!getTranslationInfo(funcOp)) {
+    return nullptr;
+  }
+  linalg::LinalgOp rootOp;
+  funcOp.walk([&](linalg::LinalgOp linalgOp) {
+    if (!getLoweringConfig(linalgOp)) {
+      return WalkResult::advance();
+    }
+    if (linalg::isaContractionOpInterface(linalgOp) ||
+        linalg::isaConvolutionOpInterface(linalgOp)) {
+      rootOp = linalgOp;
+      return WalkResult::interrupt();
+    }
+    if (!rootOp) {
+      rootOp = linalgOp;
+    }
+    return WalkResult::advance();
+  });
+  return rootOp;
+}
+
+//===----------------------------------------------------------------------===//
+// #iree_codegen.lowering_config
+//===----------------------------------------------------------------------===//
+
+// Appends the configurations reachable from |config| by scaling one
+// distribution (level 0) tile size of a parallel loop. Finer levels must
+// evenly divide the new tile size and scalable tiles are left untouched.
+static void
+appendCodegenNeighbors(linalg::LinalgOp rootOp,
+                       IREE::Codegen::LoweringConfigAttr config,
+                       SmallVectorImpl<Attribute> &neighbors) {
+  MLIRContext *context = rootOp.getContext();
+  auto levels = llvm::to_vector(config.getTilingLevels());
+  if (levels.empty()) {
+    return;
+  }
+  SmallVector<int64_t> loopRanges = rootOp.getStaticLoopRanges();
+  auto iteratorTypes = rootOp.getIteratorTypesArray();
+  ArrayRef<int64_t> distributionSizes = levels[0].getSizes();
+  for (unsigned dim = 0; dim < distributionSizes.size(); ++dim) {
+    int64_t tileSize = distributionSizes[dim];
+    if (tileSize == 0 || dim >= loopRanges.size() ||
+        ShapedType::isDynamic(loopRanges[dim]) ||
+        !linalg::isParallelIterator(iteratorTypes[dim])) {
+      continue;
+    }
+    bool isScalable = llvm::any_of(levels, [&](auto level) {
+      auto scalableFlags = level.getScalableFlags();
+      return dim < scalableFlags.size() && scalableFlags[dim];
+    });
+    if (isScalable) {
+      continue;
+    }
+    for (auto [num, den] : llvm::zip_equal(kScaleNumerators,
+                                           kScaleDenominators)) {
+      auto newTileSize = scaleTileSize(tileSize, num, den);
+      if (!newTileSize || loopRanges[dim] % *newTileSize != 0) {
+        continue;
+      }
+      bool dividesFinerLevels =
+          llvm::all_of(ArrayRef(levels).drop_front(), [&](auto level) {
+            auto sizes = level.getSizes();
+            return dim >= sizes.size() || sizes[dim] == 0 ||
+                   *newTileSize % sizes[dim] == 0;
+          });
+      if (!dividesFinerLevels) {
+        continue;
+      }
+      SmallVector<int64_t> newSizes(distributionSizes);
+      newSizes[dim] = *newTileSize;
+      auto newLevels = levels;
+      newLevels[0] = IREE::Codegen::LoweringConfigTilingLevelAttr::get(
+          context, newSizes, levels[0].getInterchange(),
+          levels[0].getScalableFlags());
+      neighbors.push_back(IREE::Codegen::LoweringConfigAttr::get(
+          context,
+          IREE::Codegen::LoweringConfigTilingLevelsAttr::get(context,
+                                                             newLevels),
+          config.getNativeVectorSize()));
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// #iree_gpu.lowering_config
+//===----------------------------------------------------------------------===//
+
+static SmallVector<int64_t> getTilingLevel(DictionaryAttr attributes,
+                                           StringRef name) {
+  auto arrayAttr = attributes.getAs<ArrayAttr>(name);
+  if (!arrayAttr) {
+    return {};
+  }
+  return llvm::map_to_vector(arrayAttr.getAsRange<IntegerAttr>(),
+                             [](IntegerAttr attr) { return attr.getInt(); });
+}
+
+static void setTilingLevel(MLIRContext *context, NamedAttrList &attrs,
+                           StringRef name, ArrayRef<int64_t> sizes) {
+  attrs.set(name, Builder(context).getI64ArrayAttr(sizes));
+}
+
+// Appends the configurations reachable from |config| by one step:
+//  * scaling the workgroup tile size of a parallel loop along with the
+//    subgroup and thread tile sizes of that loop, keeping the number of
+//    subgroups and threads per workgroup fixed;
+//  * scaling the reduction tile size of a reduction loop;
+//  * swapping the MMA intrinsic for another intrinsic of the target with the
+//    same element types and subgroup size.
+static void appendGPUNeighbors(linalg::LinalgOp rootOp,
+                               IREE::GPU::LoweringConfigAttr config,
+                               SmallVectorImpl<Attribute> &neighbors) {
+  MLIRContext *context = rootOp.getContext();
+  DictionaryAttr attributes = config.getAttributes();
+  SmallVector<int64_t> loopRanges = rootOp.getStaticLoopRanges();
+  auto iteratorTypes = rootOp.getIteratorTypesArray();
+  SmallVector<int64_t> workgroupSizes = getTilingLevel(attributes, "workgroup");
+  SmallVector<int64_t> reductionSizes = getTilingLevel(attributes, "reduction");
+  SmallVector<int64_t> subgroupSizes = getTilingLevel(attributes, "subgroup");
+  SmallVector<int64_t> threadSizes = getTilingLevel(attributes, "thread");
+
+  // Reduction tile sizes of MMA configurations count intrinsics along the
+  // innermost K dimension.
+  IREE::GPU::MmaInterfaceAttr mmaKind = config.getMmaKind();
+  std::optional<linalg::ContractionDimensions> contractionDims;
+  if (mmaKind) {
+    auto maybeContractionDims = linalg::inferContractionDims(rootOp);
+    if (failed(maybeContractionDims) || maybeContractionDims->m.empty() ||
+        maybeContractionDims->n.empty() || maybeContractionDims->k.empty()) {
+      return;
+    }
+    contractionDims = *maybeContractionDims;
+  }
+  auto getElementTileSize = [&](unsigned dim, int64_t tileSize) {
+    if (contractionDims && dim == contractionDims->k.back()) {
+      return tileSize * std::get<2>(mmaKind.getMNKShape());
+    }
+    return tileSize;
+  };
+  auto isStaticDim = [&](unsigned dim) {
+    return dim < loopRanges.size() && !ShapedType::isDynamic(loopRanges[dim]);
+  };
+
+  for (auto [num, den] : llvm::zip_equal(kScaleNumerators,
+                                         kScaleDenominators)) {
+    for (auto [dim, tileSize] : llvm::enumerate(workgroupSizes)) {
+      if (tileSize == 0 || !isStaticDim(dim) ||
+          !linalg::isParallelIterator(iteratorTypes[dim])) {
+        continue;
+      }
+      auto newTileSize = scaleTileSize(tileSize, num, den);
+      if (!newTileSize || loopRanges[dim] % *newTileSize != 0) {
+        continue;
+      }
+      NamedAttrList attrs(attributes);
+      SmallVector<int64_t> newWorkgroupSizes(workgroupSizes);
+      newWorkgroupSizes[dim] = *newTileSize;
+      setTilingLevel(context, attrs, "workgroup", newWorkgroupSizes);
+      bool isValid = true;
+      for (auto [name, sizes] :
+           llvm::zip_equal(std::array<StringRef, 2>{"subgroup", "thread"},
+                           std::array<ArrayRef<int64_t>, 2>{subgroupSizes,
+                                                            threadSizes})) {
+        if (dim >= sizes.size() || sizes[dim] == 0) {
+          continue;
+        }
+        auto newSize = scaleTileSize(sizes[dim], num, den);
+        if (!newSize) {
+          isValid = false;
+          break;
+        }
+        SmallVector<int64_t> newSizes(sizes);
+        newSizes[dim] = *newSize;
+        setTilingLevel(context, attrs, name, newSizes);
+      }
+      if (isValid) {
+        neighbors.push_back(IREE::GPU::LoweringConfigAttr::get(
+            context, attrs.getDictionary(context)));
+      }
+    }
+    for (auto [dim, tileSize] : llvm::enumerate(reductionSizes)) {
+      if (tileSize == 0 || !isStaticDim(dim)) {
+        continue;
+      }
+      auto newTileSize = scaleTileSize(tileSize, num, den);
+      if (!newTileSize ||
+          loopRanges[dim] % getElementTileSize(dim, *newTileSize) != 0) {
+        continue;
+      }
+      NamedAttrList attrs(attributes);
+      SmallVector<int64_t> newReductionSizes(reductionSizes);
+      newReductionSizes[dim] = *newTileSize;
+      setTilingLevel(context, attrs, "reduction", newReductionSizes);
+      neighbors.push_back(IREE::GPU::LoweringConfigAttr::get(
+          context, attrs.getDictionary(context)));
+    }
+  }
+
+  if (!mmaKind) {
+    return;
+  }
+  IREE::GPU::TargetAttr target = getGPUTargetAttr(rootOp);
+  if (!target) {
+    return;
+  }
+  auto [m, n, k] = mmaKind.getMNKShape();
+  unsigned mDim = contractionDims->m.back();
+  unsigned nDim = contractionDims->n.back();
+  unsigned kDim = contractionDims->k.back();
+  if (mDim >= subgroupSizes.size() || nDim >= subgroupSizes.size() ||
+      kDim >= reductionSizes.size()) {
+    return;
+  }
+  for (IREE::GPU::MmaInterfaceAttr newMmaKind : target.getWgp().getMma()) {
+    if (newMmaKind == mmaKind ||
+        newMmaKind.getABCElementTypes() != mmaKind.getABCElementTypes() ||
+        newMmaKind.getSubgroupSize() != mmaKind.getSubgroupSize()) {
+      continue;
+    }
+    // Keep the element tile sizes fixed and recount them in terms of the new
+    // intrinsic.
+    auto [newM, newN, newK] = newMmaKind.getMNKShape();
+    auto newSubgroupM = scaleTileSize(subgroupSizes[mDim], m, newM);
+    auto newSubgroupN = scaleTileSize(subgroupSizes[nDim], n, newN);
+    auto newReductionK = scaleTileSize(reductionSizes[kDim], k, newK);
+    if (!newSubgroupM || !newSubgroupN || !newReductionK) {
+      continue;
+    }
+    NamedAttrList attrs(attributes);
+    SmallVector<int64_t> newSubgroupSizes(subgroupSizes);
+    newSubgroupSizes[mDim] = *newSubgroupM;
+    newSubgroupSizes[nDim] = *newSubgroupN;
+    setTilingLevel(context, attrs, "subgroup", newSubgroupSizes);
+    SmallVector<int64_t> newReductionSizes(reductionSizes);
+    newReductionSizes[kDim] = *newReductionK;
+    setTilingLevel(context, attrs, "reduction", newReductionSizes);
+    attrs.set("mma_kind", newMmaKind);
+    neighbors.push_back(IREE::GPU::LoweringConfigAttr::get(
+        context, attrs.getDictionary(context)));
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Enumeration
+//===----------------------------------------------------------------------===//
+
+static void appendNeighbors(linalg::LinalgOp rootOp, Attribute config,
+                            SmallVectorImpl<Attribute> &neighbors) {
+  if (auto codegenConfig =
+          dyn_cast<IREE::Codegen::LoweringConfigAttr>(config)) {
+    appendCodegenNeighbors(rootOp, codegenConfig, neighbors);
+  } else if (auto gpuConfig = dyn_cast<IREE::GPU::LoweringConfigAttr>(config)) {
+    appendGPUNeighbors(rootOp, gpuConfig, neighbors);
+  }
+}
+
+SmallVector<IREE::Codegen::LoweringConfigAttrInterface>
+enumerateTuningCandidates(linalg::LinalgOp rootOp, int64_t maxCandidates) {
+  auto seedConfig = getLoweringConfig(rootOp);
+  if (!seedConfig) {
+    return {};
+  }
+
+  // Breadth-first so that the candidates closest to the selected
+  // configuration are kept when the count is capped.
+  llvm::SetVector<Attribute> visited;
+  visited.insert(seedConfig);
+  SmallVector<Attribute> frontier = {seedConfig};
+  static const int kMaxSteps = 2;
+  for (int step = 0; step < kMaxSteps; ++step) {
+    SmallVector<Attribute> nextFrontier;
+    for (Attribute config : frontier) {
+      SmallVector<Attribute> neighbors;
+      appendNeighbors(rootOp, config, neighbors);
+      for (Attribute neighbor : neighbors) {
+        if (static_cast<int64_t>(visited.size()) > maxCandidates) {
+          break;
+        }
+        if (visited.insert(neighbor)) {
+          nextFrontier.push_back(neighbor);
+        }
+      }
+    }
+    frontier = std::move(nextFrontier);
+  }
+
+  SmallVector<IREE::Codegen::LoweringConfigAttrInterface> candidates;
+  for (Attribute config : visited.getArrayRef().drop_front()) {
+    candidates.push_back(
+        cast<IREE::Codegen::LoweringConfigAttrInterface>(config));
+  }
+  return candidates;
+}
+
+} // namespace mlir::iree_compiler::Tuner
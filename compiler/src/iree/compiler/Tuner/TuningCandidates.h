@@ -0,0 +1,34 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_TUNER_TUNINGCANDIDATES_H_
+#define IREE_COMPILER_TUNER_TUNINGCANDIDATES_H_
+
+#include "iree/compiler/Codegen/Dialect/Codegen/IR/IREECodegenAttrs.h"
+#include "mlir/Dialect/Linalg/IR/LinalgInterfaces.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+
+namespace mlir::iree_compiler::Tuner {
+
+// Returns the configured linalg op of |funcOp| whose lowering configuration
+// drives the compilation of the function. Contractions and convolutions are
+// preferred over other configured ops. Returns nullptr if the function has not
+// been configured.
+linalg::LinalgOp findTuningRootOp(FunctionOpInterface funcOp);
+
+// Enumerates alternative lowering configurations for |rootOp| derived from the
+// configuration the compiler selected for it. Candidates are reached by up to
+// two steps of halving or doubling tile sizes and, on GPU targets, swapping
+// the MMA intrinsic for a compatible one. Every step preserves the number of
+// workgroup threads such that the translation info of the parent function
+// remains valid. The selected configuration itself is not included and at
+// most |maxCandidates| are returned.
+SmallVector<IREE::Codegen::LoweringConfigAttrInterface>
+enumerateTuningCandidates(linalg::LinalgOp rootOp, int64_t maxCandidates);
+
+} // namespace mlir::iree_compiler::Tuner
+
+#endif // IREE_COMPILER_TUNER_TUNINGCANDIDATES_H_
@@ -0,0 +1,98 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Tuner/TuningSpec.h"
+
+#include "llvm/ADT/STLExtras.h"
+#include "mlir/IR/BuiltinTypes.h"
+#include "mlir/Interfaces/FunctionInterfaces.h"
+
+namespace mlir::iree_compiler::Tuner {
+
+TuningSpecEntry
+getTuningSpecEntry(Operation *rootOp,
+                   IREE::Codegen::LoweringConfigAttrInterface loweringConfig) {
+  TuningSpecEntry entry;
+  entry.opName = rootOp->getName().getStringRef().str();
+  for (OpOperand &operand : rootOp->getOpOperands()) {
+    if (isa<ShapedType>(operand.get().getType())) {
+      entry.operandTypes.push_back(
+          {operand.getOperandNumber(), operand.get().getType()});
+    }
+  }
+  auto funcOp = rootOp->getParentOfType<FunctionOpInterface>();
+  entry.compilationInfo = IREE::Codegen::CompilationInfoAttr::get(
+      rootOp->getContext(), loweringConfig, getTranslationInfo(funcOp));
+  return entry;
+}
+
+// Writes the matcher for |entry| yielding the matched op and its compilation
+// info. Matching on the op name and the exact operand types is sufficient to
+// identify a dispatch root within the executables of a program.
+static void writeMatcher(StringRef matcherName, const TuningSpecEntry &entry,
+                         llvm::raw_ostream &os) {
+  os << "  transform.named_sequence @" << matcherName
+     << "(%op: !transform.any_op {transform.readonly}) -> "
+        "(!transform.any_op, !transform.any_param) {\n";
+  os << "    transform.match.operation_name %op [\"" << entry.opName
+     << "\"] : !transform.any_op\n";
+  for (auto [operandIndex, operandType] : entry.operandTypes) {
+    os << "    %operand" << operandIndex << " = transform.get_operand %op["
+       << operandIndex
+       << "] : (!transform.any_op) -> !transform.any_value\n";
+    os << "    transform.iree.match.cast_compatible_type %operand"
+       << operandIndex << " = " << operandType
+       << " : !transform.any_value\n";
+  }
+  os << "    %config = transform.param.constant " << entry.compilationInfo
+     << " -> !transform.any_param\n";
+  os << "    transform.yield %op, %config : !transform.any_op, "
+        "!transform.any_param\n";
+  os << "  }\n\n";
+}
+
+void writeTuningSpec(ArrayRef<TuningSpecEntry> entries,
+                     llvm::raw_ostream &os) {
+  os << "// Tuning spec generated by iree-tune.\n";
+  os << "// Use with --iree-codegen-tuning-spec-path=<this file>.\n\n";
+  os << "module attributes {transform.with_named_sequence} {\n";
+  os << "  transform.named_sequence @apply_op_config("
+        "%op: !transform.any_op {transform.readonly}, "
+        "%config: !transform.any_param {transform.readonly}) {\n";
+  os << "    transform.annotate %op \"compilation_info\" = %config : "
+        "!transform.any_op, !transform.any_param\n";
+  os << "    transform.yield\n";
+  os << "  }\n\n";
+
+  SmallVector<std::string> matcherNames;
+  for (auto [index, entry] : llvm::enumerate(entries)) {
+    matcherNames.push_back("match_" + std::to_string(index));
+    writeMatcher(matcherNames.back(), entry, os);
+  }
+
+  if (matcherNames.empty()) {
+    os << "  transform.named_sequence @__kernel_config("
+          "%func: !transform.any_op {transform.readonly}) {\n";
+    os << "    transform.yield\n";
+  } else {
+    os << "  transform.named_sequence @__kernel_config("
+          "%func: !transform.any_op {transform.consumed}) -> "
+          "!transform.any_op {\n";
+    os << "    %result = transform.foreach_match in %func\n";
+    llvm::interleave(
+        matcherNames, os,
+        [&](StringRef matcherName) {
+          os << "        @" << matcherName << " -> @apply_op_config";
+        },
+        ",\n");
+    os << "\n      : (!transform.any_op) -> !transform.any_op\n";
+    os << "    transform.yield %result : !transform.any_op\n";
+  }
+  os << "  }\n";
+  os << "}\n";
+}
+
+} // namespace mlir::iree_compiler::Tuner
@@ -0,0 +1,41 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_TUNER_TUNINGSPEC_H_
+#define IREE_COMPILER_TUNER_TUNINGSPEC_H_
+
+#include <string>
+
+#include "iree/compiler/Codegen/Dialect/Codegen/IR/IREECodegenAttrs.h"
+#include "llvm/Support/raw_ostream.h"
+#include "mlir/IR/Operation.h"
+
+namespace mlir::iree_compiler::Tuner {
+
+// A tuned configuration for ops with a particular name and operand types.
+struct TuningSpecEntry {
+  // Name of the matched op (e.g. `linalg.matmul`).
+  std::string opName;
+  // Types of the shaped operands of the matched op by operand index.
+  SmallVector<std::pair<unsigned, Type>> operandTypes;
+  // Configuration to annotate matched ops with.
+  IREE::Codegen::CompilationInfoAttr compilationInfo;
+};
+
+// Returns an entry matching ops like |rootOp| that configures them with
+// |loweringConfig| and the translation info of the parent function.
+TuningSpecEntry
+getTuningSpecEntry(Operation *rootOp,
+                   IREE::Codegen::LoweringConfigAttrInterface loweringConfig);
+
+// Writes a transform dialect library to |os| whose `__kernel_config` sequence
+// annotates ops matching any of |entries| with their compilation info. The
+// result can be passed to `--iree-codegen-tuning-spec-path`.
+void writeTuningSpec(ArrayRef<TuningSpecEntry> entries, llvm::raw_ostream &os);
+
+} // namespace mlir::iree_compiler::Tuner
+
+#endif // IREE_COMPILER_TUNER_TUNINGSPEC_H_
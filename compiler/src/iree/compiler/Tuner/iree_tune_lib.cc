@@ -0,0 +1,303 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/compiler/Tuner/iree_tune_lib.h"
+
+#include <algorithm>
+
+#include "iree/compiler/Dialect/HAL/IR/HALOps.h"
+#include "iree/compiler/Tuner/TuningCandidates.h"
+#include "iree/compiler/Tuner/TuningSpec.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+#include "llvm/Support/ToolOutputFile.h"
+#include "mlir/IR/BuiltinOps.h"
+#include "mlir/IR/SymbolTable.h"
+#include "mlir/Parser/Parser.h"
+#include "mlir/Support/FileUtilities.h"
+
+namespace mlir::iree_compiler::Tuner {
+
+// Candidates must be faster than the selected configuration by at least this
+// fraction to be recorded. This filters out wins within measurement noise.
+static const double kMinImprovement = 0.02;
+
+namespace {
+
+// A configured dispatch function found in one of the benchmark modules.
+struct TuningTarget {
+  // Module containing the dispatch function.
+  ModuleOp moduleOp;
+  // Prefix of the names of the benchmarks of the dispatch function.
+  std::string benchmarkPrefix;
+  // Op whose lowering configuration is tuned.
+  linalg::LinalgOp rootOp;
+  // Time of the configuration selected by the compiler in microseconds.
+  double baselineTime = 0.0;
+};
+
+} // namespace
+
+// Runs |toolPath| with |args| and redirects its output to |logPath|.
+static LogicalResult runTool(StringRef toolPath, ArrayRef<std::string> args,
+                             StringRef logPath) {
+  SmallVector<StringRef> argv = {toolPath};
+  for (const std::string &arg : args) {
+    argv.push_back(arg);
+  }
+  std::optional<StringRef> redirects[] = {std::nullopt, logPath, logPath};
+  std::string errorMessage;
+  int exitCode =
+      llvm::sys::ExecuteAndWait(toolPath, argv, /*Env=*/std::nullopt,
+                                redirects, /*SecondsToWait=*/0,
+                                /*MemoryLimit=*/0, &errorMessage);
+  if (exitCode < 0) {
+    llvm::errs() << "failed to run " << toolPath << ": " << errorMessage
+                 << "\n";
+  }
+  return success(exitCode == 0);
+}
+
+// Returns |time| in |unit| as microseconds.
+static double getTimeInMicroseconds(double time, StringRef unit) {
+  if (unit == "ns") {
+    return time / 1000.0;
+  } else if (unit == "ms") {
+    return time * 1000.0;
+  } else if (unit == "s") {
+    return time * 1000000.0;
+  }
+  return time;
+}
+
+// Parses a google benchmark JSON report and returns the fastest repetition of
+// each benchmark in microseconds.
+static FailureOr<llvm::StringMap<double>>
+parseBenchmarkResults(StringRef resultsPath) {
+  auto buffer = llvm::MemoryBuffer::getFile(resultsPath);
+  if (!buffer) {
+    return failure();
+  }
+  auto json = llvm::json::parse((*buffer)->getBuffer());
+  if (!json) {
+    llvm::errs() << "invalid benchmark results " << resultsPath << ": "
+                 << llvm::toString(json.takeError()) << "\n";
+    return failure();
+  }
+  auto *rootObject = json->getAsObject();
+  auto *benchmarks = rootObject ? rootObject->getArray("benchmarks") : nullptr;
+  if (!benchmarks) {
+    return failure();
+  }
+  llvm::StringMap<double> times;
+  for (const llvm::json::Value &value : *benchmarks) {
+    auto *benchmark = value.getAsObject();
+    if (!benchmark || benchmark->getString("run_type") == "aggregate") {
+      continue;
+    }
+    auto name = benchmark->getString("run_name");
+    if (!name) {
+      name = benchmark->getString("name");
+    }
+    auto realTime = benchmark->getNumber("real_time");
+    if (!name || !realTime) {
+      continue;
+    }
+    double time = getTimeInMicroseconds(
+        *realTime, benchmark->getString("time_unit").value_or("ns"));
+    auto [it, inserted] = times.try_emplace(*name, time);
+    if (!inserted) {
+      it->second = std::min(it->second, time);
+    }
+  }
+  return times;
+}
+
+// Compiles and benchmarks |moduleOp| in the work directory under |name| and
+// returns the fastest time of each benchmark function in microseconds.
+static FailureOr<llvm::StringMap<double>>
+measureModule(ModuleOp moduleOp, StringRef name, const TunerConfig &config) {
+  auto getWorkPath = [&](StringRef extension) {
+    SmallString<256> path(config.workDir);
+    llvm::sys::path::append(path, name + extension);
+    return std::string(path);
+  };
+  std::string sourcePath = getWorkPath(".mlir");
+  std::string modulePath = getWorkPath(".vmfb");
+  std::string resultsPath = getWorkPath(".json");
+  std::string logPath = getWorkPath(".log");
+
+  std::string errorMessage;
+  auto sourceFile = openOutputFile(sourcePath, &errorMessage);
+  if (!sourceFile) {
+    llvm::errs() << errorMessage << "\n";
+    return failure();
+  }
+  moduleOp.print(sourceFile->os());
+  sourceFile->keep();
+  sourceFile.reset();
+
+  SmallVector<std::string> compileArgs = {sourcePath};
+  llvm::append_range(compileArgs, config.compileFlags);
+  compileArgs.push_back("-o");
+  compileArgs.push_back(modulePath);
+  if (failed(runTool(config.compileToolPath, compileArgs, logPath))) {
+    return failure();
+  }
+
+  SmallVector<std::string> benchmarkArgs = {
+      "--module=" + modulePath,
+      "--device=" + config.device,
+      "--benchmark_repetitions=" +
+          std::to_string(config.benchmarkRepetitions),
+      "--benchmark_out_format=json",
+      "--benchmark_out=" + resultsPath,
+  };
+  llvm::append_range(benchmarkArgs, config.benchmarkFlags);
+  if (failed(runTool(config.benchmarkToolPath, benchmarkArgs, logPath))) {
+    return failure();
+  }
+  return parseBenchmarkResults(resultsPath);
+}
+
+// Returns the total time of the benchmarks of the dispatch function with
+// benchmark names starting with |prefix|. Benchmark names are the prefix
+// optionally followed by the workload and google benchmark suffixes.
+static double getDispatchTime(const llvm::StringMap<double> &times,
+                              StringRef prefix) {
+  double totalTime = 0.0;
+  for (const auto &it : times) {
+    StringRef name = it.getKey();
+    if (!name.consume_front(prefix)) {
+      continue;
+    }
+    if (name.empty() || name.front() == '_' || name.front() == '/') {
+      totalTime += it.getValue();
+    }
+  }
+  return totalTime;
+}
+
+LogicalResult runTuner(MLIRContext &context, ArrayRef<std::string> inputPaths,
+                       const TunerConfig &config) {
+  // Gather the configured dispatch functions from all benchmark modules.
+  SmallVector<OwningOpRef<ModuleOp>> modules;
+  SmallVector<TuningTarget> targets;
+  for (const std::string &inputPath : inputPaths) {
+    auto moduleOp = parseSourceFile<ModuleOp>(inputPath, &context);
+    if (!moduleOp) {
+      return failure();
+    }
+    for (auto executableOp : moduleOp->getOps<IREE::HAL::ExecutableOp>()) {
+      for (auto variantOp :
+           executableOp.getOps<IREE::HAL::ExecutableVariantOp>()) {
+        if (variantOp.isExternal()) {
+          continue;
+        }
+        SymbolTable symbolTable(variantOp.getInnerModule());
+        for (auto exportOp : variantOp.getExportOps()) {
+          auto funcOp =
+              symbolTable.lookup<FunctionOpInterface>(exportOp.getSymName());
+          if (!funcOp) {
+            continue;
+          }
+          linalg::LinalgOp rootOp = findTuningRootOp(funcOp);
+          if (!rootOp) {
+            continue;
+          }
+          TuningTarget target;
+          target.moduleOp = *moduleOp;
+          target.benchmarkPrefix =
+              ("BM_" + executableOp.getName() + "_" + variantOp.getName() +
+               "_" + exportOp.getName())
+                  .str();
+          target.rootOp = rootOp;
+          targets.push_back(std::move(target));
+        }
+      }
+    }
+    modules.push_back(std::move(moduleOp));
+  }
+
+  // Measure the configurations selected by the compiler to find the slowest
+  // dispatches.
+  for (auto [moduleIndex, moduleOp] : llvm::enumerate(modules)) {
+    auto times = measureModule(
+        *moduleOp, "baseline" + std::to_string(moduleIndex), config);
+    if (failed(times)) {
+      llvm::errs() << "failed to compile or benchmark "
+                   << inputPaths[moduleIndex] << "; skipping\n";
+      continue;
+    }
+    for (auto &target : targets) {
+      if (target.moduleOp == *moduleOp) {
+        target.baselineTime = getDispatchTime(*times, target.benchmarkPrefix);
+      }
+    }
+  }
+  llvm::erase_if(targets, [](const TuningTarget &target) {
+    return target.baselineTime <= 0.0;
+  });
+  llvm::stable_sort(targets, [](const TuningTarget &a, const TuningTarget &b) {
+    return a.baselineTime > b.baselineTime;
+  });
+  if (static_cast<int64_t>(targets.size()) > config.maxDispatches) {
+    targets.resize(config.maxDispatches);
+  }
+
+  // Evaluate candidates for each dispatch. The benchmark module is updated in
+  // place for each candidate and restored afterward.
+  SmallVector<TuningSpecEntry> entries;
+  for (auto [targetIndex, target] : llvm::enumerate(targets)) {
+    auto selectedConfig = getLoweringConfig(target.rootOp);
+    auto candidates =
+        enumerateTuningCandidates(target.rootOp, config.maxCandidates);
+    llvm::outs() << target.benchmarkPrefix << ": " << target.baselineTime
+                 << " us, " << candidates.size() << " candidates\n";
+    double bestTime = target.baselineTime * (1.0 - kMinImprovement);
+    IREE::Codegen::LoweringConfigAttrInterface bestConfig;
+    for (auto [candidateIndex, candidate] : llvm::enumerate(candidates)) {
+      setLoweringConfig(target.rootOp, candidate);
+      auto times = measureModule(
+          target.moduleOp,
+          "dispatch" + std::to_string(targetIndex) + "_candidate" +
+              std::to_string(candidateIndex),
+          config);
+      setLoweringConfig(target.rootOp, selectedConfig);
+      if (failed(times)) {
+        continue;
+      }
+      double time = getDispatchTime(*times, target.benchmarkPrefix);
+      if (time > 0.0 && time < bestTime) {
+        bestTime = time;
+        bestConfig = candidate;
+      }
+    }
+    if (!bestConfig) {
+      llvm::outs() << "  no faster configuration found\n";
+      continue;
+    }
+    llvm::outs() << "  " << bestTime << " us with " << bestConfig << "\n";
+    entries.push_back(getTuningSpecEntry(target.rootOp, bestConfig));
+  }
+
+  std::string errorMessage;
+  auto outputFile = openOutputFile(config.outputPath, &errorMessage);
+  if (!outputFile) {
+    llvm::errs() << errorMessage << "\n";
+    return failure();
+  }
+  writeTuningSpec(entries, outputFile->os());
+  outputFile->keep();
+  llvm::outs() << "wrote " << entries.size() << " tuned configurations to "
+               << config.outputPath << "\n";
+  return success();
+}
+
+} // namespace mlir::iree_compiler::Tuner
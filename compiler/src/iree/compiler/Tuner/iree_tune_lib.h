@@ -0,0 +1,49 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_COMPILER_TUNER_IREE_TUNE_LIB_H_
+#define IREE_COMPILER_TUNER_IREE_TUNE_LIB_H_
+
+#include <string>
+
+#include "mlir/IR/MLIRContext.h"
+#include "mlir/Support/LLVM.h"
+#include "mlir/Support/LogicalResult.h"
+
+namespace mlir::iree_compiler::Tuner {
+
+struct TunerConfig {
+  // Path of the tuning spec library to write.
+  std::string outputPath;
+  // Directory used for candidate sources, modules and benchmark results.
+  std::string workDir;
+  // Paths of the iree-compile and iree-benchmark-module tools.
+  std::string compileToolPath;
+  std::string benchmarkToolPath;
+  // Device to benchmark on (as passed to `--device=`).
+  std::string device;
+  // Additional flags passed to each tool invocation.
+  SmallVector<std::string> compileFlags;
+  SmallVector<std::string> benchmarkFlags;
+  // Number of benchmark repetitions; the fastest repetition is used.
+  int64_t benchmarkRepetitions = 3;
+  // Number of dispatches to tune, slowest first.
+  int64_t maxDispatches = 8;
+  // Number of candidate configurations evaluated per dispatch.
+  int64_t maxCandidates = 32;
+};
+
+// Tunes the dispatches of the executable benchmark modules in |inputPaths| as
+// produced by `--iree-hal-dump-executable-benchmarks-to=`. Each benchmark is
+// compiled and run with its selected configuration and then with candidate
+// configurations of its root op. The fastest candidates of the slowest
+// dispatches are written as a tuning spec library to |config.outputPath|.
+LogicalResult runTuner(MLIRContext &context, ArrayRef<std::string> inputPaths,
+                       const TunerConfig &config);
+
+} // namespace mlir::iree_compiler::Tuner
+
+#endif // IREE_COMPILER_TUNER_IREE_TUNE_LIB_H_
@@ -0,0 +1,119 @@
+# Copyright 2024 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+"""The fixed set of models benchmarked by the suite.
+
+Sources and inputs match the ones used by the regression suite and the
+integration tests so the suite exercises programs we already track.
+"""
+
+from dataclasses import dataclass, field
+from typing import Optional, Sequence, Tuple
+
+
+@dataclass(frozen=True)
+class Module:
+    """A program compiled once per driver and shared by its benchmarks."""
+
+    name: str
+    source_url: str
+    # Tool converting the fetched source into compiler input, if needed.
+    importer: Optional[str] = None
+    compile_flags: Sequence[str] = ()
+    # (scope, url) pairs of parameter archives passed to the runtime.
+    parameters: Sequence[Tuple[str, str]] = ()
+
+
+@dataclass(frozen=True)
+class Benchmark:
+    """An end-to-end benchmark of a single function of a module."""
+
+    name: str
+    module: Module
+    function: str
+    inputs: Sequence[str] = field(default_factory=tuple)
+
+
+LLAMA2_7B_F16QI4 = Module(
+    name="llama2_7b_f16qi4",
+    source_url="https://sharktank.blob.core.windows.net/sharktank/llama_regression/09152023/llama2_7b_int4_stripped.mlir",
+    compile_flags=(
+        "--iree-input-type=none",
+        "--iree-stream-resource-index-bits=64",
+        "--iree-vm-target-index-bits=64",
+        "--iree-stream-resource-max-allocation-size=3221225472",
+    ),
+)
+
+SDXL_UNET_FP16 = Module(
+    name="sdxl_unet_fp16",
+    source_url="https://sharkpublic.blob.core.windows.net/sharkpublic/sai/sdxl-scheduled-unet/model.mlirbc",
+    compile_flags=(
+        "--iree-opt-const-eval=false",
+        "--iree-global-opt-propagate-transposes=true",
+        "--iree-opt-outer-dim-concat=true",
+    ),
+    parameters=(
+        (
+            "model",
+            "https://sharkpublic.blob.core.windows.net/sharkpublic/sai/sdxl-scheduled-unet/real_weights.irpa",
+        ),
+    ),
+)
+
+RESNET50_INT8 = Module(
+    name="resnet50_int8",
+    source_url="https://storage.googleapis.com/tf_model_garden/vision/resnet50_imagenet/resnet_50_224_int8.tflite",
+    importer="iree-import-tflite",
+    compile_flags=("--iree-input-type=tosa",),
+)
+
+MOBILEBERT_INT8 = Module(
+    name="mobilebert_int8",
+    source_url="https://storage.googleapis.com/iree-model-artifacts/mobilebert-baseline-tf2-quant.tflite",
+    importer="iree-import-tflite",
+    compile_flags=("--iree-input-type=tosa",),
+)
+
+BENCHMARKS = (
+    Benchmark(
+        name="llama2_7b_f16qi4_prefill",
+        module=LLAMA2_7B_F16QI4,
+        function="first_vicuna_forward",
+        inputs=("1x1xi64",),
+    ),
+    Benchmark(
+        name="llama2_7b_f16qi4_decode",
+        module=LLAMA2_7B_F16QI4,
+        function="second_vicuna_forward",
+        inputs=("1x1xi64",) + ("1x32x1x128xf16",) * 64,
+    ),
+    Benchmark(
+        name="sdxl_unet_fp16",
+        module=SDXL_UNET_FP16,
+        function="run_forward",
+        inputs=(
+            "1x4x128x128xf16",
+            "2x64x2048xf16",
+            "2x1280xf16",
+            "2x6xf16",
+            "1xf16",
+            "1xi64",
+        ),
+    ),
+    Benchmark(
+        name="resnet50_int8",
+        module=RESNET50_INT8,
+        function="main",
+        inputs=("1x224x224x3xf32",),
+    ),
+    Benchmark(
+        name="mobilebert_int8",
+        module=MOBILEBERT_INT8,
+        function="main",
+        inputs=("1x384xi32", "1x384xi32", "1x384xi32"),
+    ),
+)
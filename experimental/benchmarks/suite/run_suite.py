@@ -0,0 +1,466 @@
+# Copyright 2024 The IREE Authors
+#
+# Licensed under the Apache License v2.0 with LLVM Exceptions.
+# See https://llvm.org/LICENSE.txt for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+"""Runs the model benchmark suite and compares results against a baseline.
+
+Each module in models.py is compiled once per driver with its executable
+benchmarks dumped alongside it. The suite then runs the end-to-end benchmarks
+of the module and every dumped per-dispatch benchmark and writes all timings
+to a single JSON file. Passing a previous results file as --baseline reports
+the change of each benchmark and fails if any regressed beyond --threshold.
+
+See README.md for usage.
+"""
+
+from dataclasses import dataclass
+from pathlib import Path
+from typing import Dict, List, Optional, Sequence
+import argparse
+import datetime
+import json
+import logging
+import platform
+import subprocess
+import sys
+
+import tabulate
+
+from ireers_tools.artifacts import FetchedArtifact
+
+import models
+
+logger = logging.getLogger(__name__)
+
+TIME_UNIT_TO_MS = {
+    "ns": 1e-6,
+    "us": 1e-3,
+    "ms": 1.0,
+    "s": 1e3,
+}
+
+
+@dataclass(frozen=True)
+class Driver:
+    """A runtime driver and the flags targeting it from the compiler."""
+
+    name: str
+    device: str
+    target_flags: Sequence[str]
+
+
+def get_drivers(args) -> Dict[str, Driver]:
+    return {
+        "local-task": Driver(
+            name="local-task",
+            device="local-task",
+            target_flags=[
+                "--iree-hal-target-backends=llvm-cpu",
+                f"--iree-llvmcpu-target-cpu={args.cpu_target}",
+            ],
+        ),
+        "cuda": Driver(
+            name="cuda",
+            device="cuda",
+            target_flags=[
+                "--iree-hal-target-backends=cuda",
+                f"--iree-cuda-target={args.cuda_target}",
+            ],
+        ),
+        "hip": Driver(
+            name="hip",
+            device="hip",
+            target_flags=[
+                "--iree-hal-target-backends=rocm",
+                f"--iree-hip-target={args.hip_target}",
+            ],
+        ),
+        "vulkan": Driver(
+            name="vulkan",
+            device="vulkan",
+            target_flags=[
+                "--iree-hal-target-backends=vulkan-spirv",
+                f"--iree-vulkan-target={args.vulkan_target}",
+            ],
+        ),
+    }
+
+
+class BenchmarkError(Exception):
+    pass
+
+
+def run_command(args: Sequence[str], cwd: Optional[Path] = None) -> str:
+    logger.info("Exec: %s", " ".join(args))
+    proc = subprocess.run(args, cwd=cwd, capture_output=True, text=True, check=False)
+    if proc.returncode != 0:
+        raise BenchmarkError(
+            f"Command failed with exit code {proc.returncode}: {' '.join(args)}\n"
+            f"Stderr diagnostics:\n{proc.stderr}\n"
+            f"Stdout diagnostics:\n{proc.stdout}\n"
+        )
+    return proc.stdout
+
+
+def fetch(url: str, group: str) -> Path:
+    return FetchedArtifact(group=group, url=url).start().path
+
+
+def compile_module(
+    module: models.Module, driver: Driver, work_dir: Path
+) -> tuple[Path, Path]:
+    """Compiles |module| for |driver| and dumps its executable benchmarks.
+
+    Returns the path of the compiled module and the directory containing the
+    dumped executable benchmark sources.
+    """
+    output_dir = work_dir / module.name / driver.name
+    output_dir.mkdir(parents=True, exist_ok=True)
+    source_path = fetch(module.source_url, group=module.name)
+    if module.importer:
+        imported_path = output_dir / f"{module.name}.mlirbc"
+        run_command([module.importer, str(source_path), "-o", str(imported_path)])
+        source_path = imported_path
+
+    vmfb_path = output_dir / f"{module.name}.vmfb"
+    dispatch_dir = output_dir / "dispatches"
+    run_command(
+        [
+            "iree-compile",
+            str(source_path),
+            "-o",
+            str(vmfb_path),
+            f"--iree-hal-dump-executable-benchmarks-to={dispatch_dir}",
+        ]
+        + list(driver.target_flags)
+        + list(module.compile_flags),
+        cwd=output_dir,
+    )
+    return vmfb_path, dispatch_dir
+
+
+def run_benchmark_module(
+    vmfb_path: Path,
+    driver: Driver,
+    args,
+    extra_args: Sequence[str] = (),
+) -> Dict[str, Dict[str, float]]:
+    """Runs iree-benchmark-module and returns timings keyed by benchmark name."""
+    results_path = vmfb_path.with_suffix(".benchmark.json")
+    run_command(
+        [
+            "iree-benchmark-module",
+            f"--device={driver.device}",
+            f"--module={vmfb_path}",
+            f"--benchmark_repetitions={args.repetitions}",
+            f"--benchmark_min_warmup_time={args.min_warmup_time}",
+            "--benchmark_report_aggregates_only=true",
+            f"--benchmark_out={results_path}",
+            "--benchmark_out_format=json",
+        ]
+        + list(extra_args),
+        cwd=vmfb_path.parent,
+    )
+    with open(results_path) as f:
+        return parse_benchmark_results(json.load(f))
+
+
+def parse_benchmark_results(data) -> Dict[str, Dict[str, float]]:
+    """Extracts the median and stddev of each benchmark in Google Benchmark JSON.
+
+    Benchmarks run without repetitions have no aggregates and report their
+    single run as the median.
+    """
+    results: Dict[str, Dict[str, float]] = {}
+    for entry in data.get("benchmarks", []):
+        name = entry.get("run_name", entry["name"])
+        scale = TIME_UNIT_TO_MS[entry.get("time_unit", "ns")]
+        timings = results.setdefault(name, {})
+        if entry.get("run_type") == "aggregate":
+            if entry["aggregate_name"] in ("median", "stddev"):
+                timings[f"{entry['aggregate_name']}_ms"] = entry["real_time"] * scale
+        else:
+            timings.setdefault("median_ms", entry["real_time"] * scale)
+            timings.setdefault("stddev_ms", 0.0)
+    return results
+
+
+def get_dispatch_name(benchmark_name: str) -> str:
+    """Strips the Google Benchmark decorations from a dispatch benchmark name.
+
+    `BM_module_ex_dispatch_0_..._benchmark/process_time/real_time` becomes
+    `module_ex_dispatch_0_..._benchmark`.
+    """
+    name = benchmark_name.split("/", 1)[0]
+    return name[len("BM_") :] if name.startswith("BM_") else name
+
+
+def run_module_benchmarks(
+    module: models.Module,
+    benchmarks: Sequence[models.Benchmark],
+    driver: Driver,
+    args,
+    results: Dict[str, Dict],
+):
+    """Runs all benchmarks of |module| on |driver| and adds them to |results|.
+
+    Failures are recorded in the results of the benchmarks they affect so the
+    rest of the suite still runs.
+    """
+    try:
+        vmfb_path, dispatch_dir = compile_module(module, driver, args.work_dir)
+    except BenchmarkError as e:
+        logger.error("%s", e)
+        for benchmark in benchmarks:
+            results[f"{benchmark.name}/{driver.name}"] = {
+                "kind": "e2e",
+                "error": "compilation failed",
+            }
+        return
+
+    parameter_args = [
+        f"--parameters={scope}={fetch(url, group=module.name)}"
+        for scope, url in module.parameters
+    ]
+    for benchmark in benchmarks:
+        name = f"{benchmark.name}/{driver.name}"
+        try:
+            timings = run_benchmark_module(
+                vmfb_path,
+                driver,
+                args,
+                parameter_args
+                + [f"--function={benchmark.function}"]
+                + [f"--input={value}" for value in benchmark.inputs],
+            )
+            # Only a single benchmark is registered for the function.
+            results[name] = {"kind": "e2e", **next(iter(timings.values()))}
+        except (BenchmarkError, StopIteration) as e:
+            logger.error("%s", e)
+            results[name] = {"kind": "e2e", "error": "benchmark failed"}
+
+    if not args.dispatch_benchmarks:
+        return
+    for source_path in sorted(dispatch_dir.glob("*_benchmark.mlir")):
+        dispatch_vmfb_path = source_path.with_suffix(".vmfb")
+        try:
+            run_command(
+                [
+                    "iree-compile",
+                    str(source_path),
+                    "-o",
+                    str(dispatch_vmfb_path),
+                    "--iree-hal-benchmark-dispatch-repeat-count="
+                    f"{args.dispatch_batch_size}",
+                ]
+                + list(driver.target_flags),
+                cwd=dispatch_dir,
+            )
+            timings = run_benchmark_module(
+                dispatch_vmfb_path,
+                driver,
+                args,
+                [f"--batch_size={args.dispatch_batch_size}"],
+            )
+        except BenchmarkError as e:
+            logger.error("%s", e)
+            results[f"{module.name}/{driver.name}/{source_path.stem}"] = {
+                "kind": "dispatch",
+                "error": "benchmark failed",
+            }
+            continue
+        for benchmark_name, dispatch_timings in timings.items():
+            dispatch_name = get_dispatch_name(benchmark_name)
+            results[f"{module.name}/{driver.name}/{dispatch_name}"] = {
+                "kind": "dispatch",
+                **dispatch_timings,
+            }
+
+
+def compare_results(
+    results: Dict[str, Dict], baseline: Dict[str, Dict], threshold: float
+) -> List[str]:
+    """Prints the change of each benchmark against |baseline|.
+
+    Returns the names of the benchmarks that regressed by more than
+    |threshold| (a fraction of the baseline time) or that failed to run.
+    """
+    rows = []
+    regressions = []
+    for name in sorted(results.keys() | baseline.keys()):
+        current = results.get(name, {})
+        previous = baseline.get(name, {})
+        current_ms = current.get("median_ms")
+        previous_ms = previous.get("median_ms")
+        if current_ms is None:
+            status = "failed" if current else "missing"
+            if previous_ms is not None:
+                regressions.append(name)
+            rows.append([name, previous_ms, None, None, status])
+            continue
+        if previous_ms is None:
+            rows.append([name, None, current_ms, None, "new"])
+            continue
+        delta = (current_ms - previous_ms) / previous_ms
+        if delta > threshold:
+            status = "regressed"
+            regressions.append(name)
+        elif delta < -threshold:
+            status = "improved"
+        else:
+            status = "unchanged"
+        rows.append([name, previous_ms, current_ms, f"{delta:+.1%}", status])
+    print(
+        tabulate.tabulate(
+            rows,
+            headers=["benchmark", "baseline (ms)", "current (ms)", "change", "status"],
+            floatfmt=".3f",
+        )
+    )
+    return regressions
+
+
+def get_compiler_version() -> str:
+    try:
+        return run_command(["iree-compile", "--version"]).strip()
+    except (BenchmarkError, OSError):
+        return "unknown"
+
+
+def parse_arguments(argv: Sequence[str]):
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument(
+        "--drivers",
+        default="local-task",
+        help="Comma-separated drivers to benchmark: "
+        "local-task, cuda, hip and/or vulkan",
+    )
+    parser.add_argument(
+        "--benchmarks",
+        default="",
+        help="Comma-separated benchmark names to run (default: all)",
+    )
+    parser.add_argument("--cpu-target", default="host", help="LLVMCPU target CPU")
+    parser.add_argument("--cuda-target", default="sm_80", help="CUDA target")
+    parser.add_argument("--hip-target", default="gfx942", help="HIP target")
+    parser.add_argument("--vulkan-target", default="rdna3", help="Vulkan target")
+    parser.add_argument(
+        "--work-dir",
+        type=Path,
+        default=Path.cwd() / "benchmark_suite",
+        help="Directory for compiled modules and intermediate results",
+    )
+    parser.add_argument(
+        "--output",
+        type=Path,
+        default=Path("benchmark_results.json"),
+        help="Path to write the JSON results to",
+    )
+    parser.add_argument(
+        "--baseline",
+        type=Path,
+        default=None,
+        help="Results of a previous run to compare against",
+    )
+    parser.add_argument(
+        "--threshold",
+        type=float,
+        default=0.05,
+        help="Fractional slowdown versus the baseline reported as a regression",
+    )
+    parser.add_argument("--repetitions", type=int, default=5)
+    parser.add_argument("--min-warmup-time", type=float, default=1.0)
+    parser.add_argument(
+        "--dispatch-benchmarks",
+        action=argparse.BooleanOptionalAction,
+        default=True,
+        help="Run the per-dispatch benchmarks of each module",
+    )
+    parser.add_argument(
+        "--dispatch-batch-size",
+        type=int,
+        default=16,
+        help="Times each dispatch benchmark is repeated per invocation",
+    )
+    return parser.parse_args(argv)
+
+
+def main(argv: Sequence[str]) -> int:
+    logging.basicConfig(level=logging.INFO)
+    args = parse_arguments(argv)
+    drivers = get_drivers(args)
+    selected_drivers = [name for name in args.drivers.split(",") if name]
+    for name in selected_drivers:
+        if name not in drivers:
+            raise ValueError(f"Unknown driver '{name}'; expected {list(drivers)}")
+    selected_benchmarks = {name for name in args.benchmarks.split(",") if name}
+    benchmarks = [
+        benchmark
+        for benchmark in models.BENCHMARKS
+        if not selected_benchmarks or benchmark.name in selected_benchmarks
+    ]
+
+    # Group the benchmarks by module so each module is only compiled once.
+    benchmarks_by_module: Dict[models.Module, List[models.Benchmark]] = {}
+    for benchmark in benchmarks:
+        benchmarks_by_module.setdefault(benchmark.module, []).append(benchmark)
+
+    results: Dict[str, Dict] = {}
+    for driver_name in selected_drivers:
+        for module, module_benchmarks in benchmarks_by_module.items():
+            run_module_benchmarks(
+                module, module_benchmarks, drivers[driver_name], args, results
+            )
+
+    output = {
+        "metadata": {
+            "timestamp": datetime.datetime.now(datetime.timezone.utc).isoformat(),
+            "host": platform.node(),
+            "compiler_version": get_compiler_version(),
+            "drivers": selected_drivers,
+            "targets": {
+                name: list(drivers[name].target_flags) for name in selected_drivers
+            },
+        },
+        "benchmarks": results,
+    }
+    args.output.parent.mkdir(parents=True, exist_ok=True)
+    with open(args.output, "w") as f:
+        json.dump(output, f, indent=2, sort_keys=True)
+    logger.info("Wrote results to %s", args.output)
+
+    failures = [name for name, result in results.items() if "error" in result]
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)["benchmarks"]
+        # Only compare against the benchmarks that were requested in this run.
+        # Dispatch benchmarks are named after their module instead.
+        selected_names = {benchmark.name for benchmark in benchmarks} | {
+            module.name for module in benchmarks_by_module
+        }
+        baseline = {
+            name: result
+            for name, result in baseline.items()
+            if name.split("/")[0] in selected_names
+            and name.split("/")[1] in selected_drivers
+        }
+        regressions = compare_results(results, baseline, args.threshold)
+        if regressions:
+            logger.error(
+                "%d benchmarks regressed:\n  %s",
+                len(regressions),
+                "\n  ".join(regressions),
+            )
+            return 1
+    if failures:
+        logger.error(
+            "%d benchmarks failed:\n  %s", len(failures), "\n  ".join(failures)
+        )
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main(sys.argv[1:]))
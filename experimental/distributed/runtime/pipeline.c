@@ -0,0 +1,596 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/distributed/runtime/pipeline.h"
+
+#include <string.h>
+
+#include "iree/modules/hal/types.h"
+
+// Interval at which the host polls the stage timelines while waiting for the
+// run to complete. Bounds the resolution of the recorded schedule.
+#define IREE_DISTRIBUTED_PIPELINE_POLL_INTERVAL_NS (100 * 1000)
+
+//===----------------------------------------------------------------------===//
+// iree_distributed_pipeline_stats_t
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_distributed_pipeline_stats_compute(
+    iree_host_size_t stage_count, iree_host_size_t microbatch_count,
+    iree_time_t start_time, const iree_time_t* ready_times,
+    const iree_time_t* completion_times,
+    iree_distributed_pipeline_stats_t* out_stats) {
+  IREE_ASSERT_ARGUMENT(ready_times);
+  IREE_ASSERT_ARGUMENT(completion_times);
+  IREE_ASSERT_ARGUMENT(out_stats);
+  memset(out_stats, 0, sizeof(*out_stats));
+  if (stage_count == 0 || stage_count > IREE_DISTRIBUTED_PIPELINE_MAX_STAGES) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "stage count %" PRIhsz " out of range (1 to %d)",
+                            stage_count, IREE_DISTRIBUTED_PIPELINE_MAX_STAGES);
+  }
+  if (microbatch_count == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at least one microbatch is required");
+  }
+  out_stats->stage_count = stage_count;
+  out_stats->microbatch_count = microbatch_count;
+
+  iree_time_t end_time = start_time;
+  for (iree_host_size_t i = 0; i < stage_count * microbatch_count; ++i) {
+    end_time = iree_max(end_time, completion_times[i]);
+  }
+  out_stats->total_duration = end_time - start_time;
+
+  // Each stage runs its microbatches in order: a microbatch begins once its
+  // input is ready and the prior microbatch on the stage has completed.
+  iree_duration_t total_busy_duration = 0;
+  for (iree_host_size_t s = 0; s < stage_count; ++s) {
+    iree_duration_t busy_duration = 0;
+    iree_time_t prior_completion_time = start_time;
+    for (iree_host_size_t m = 0; m < microbatch_count; ++m) {
+      iree_host_size_t i = s * microbatch_count + m;
+      iree_time_t begin_time = iree_max(ready_times[i], prior_completion_time);
+      if (completion_times[i] > begin_time) {
+        busy_duration += completion_times[i] - begin_time;
+      }
+      prior_completion_time =
+          iree_max(prior_completion_time, completion_times[i]);
+    }
+    out_stats->stages[s].busy_duration = busy_duration;
+    out_stats->stages[s].utilization =
+        out_stats->total_duration > 0
+            ? (double)busy_duration / (double)out_stats->total_duration
+            : 0.0;
+    total_busy_duration += busy_duration;
+  }
+
+  // The bubble is the idle fraction of all stage time slots of the run.
+  if (out_stats->total_duration > 0) {
+    out_stats->bubble_fraction =
+        1.0 - (double)total_busy_duration /
+                  ((double)out_stats->total_duration * (double)stage_count);
+  }
+  return iree_ok_status();
+}
+
+void iree_distributed_pipeline_stats_fprint(
+    FILE* file, const iree_distributed_pipeline_stats_t* stats) {
+  fprintf(file,
+          "pipeline: %" PRIhsz " stages, %" PRIhsz
+          " microbatches, %.3f ms total, bubble fraction %.3f\n",
+          stats->stage_count, stats->microbatch_count,
+          (double)stats->total_duration / 1000000.0, stats->bubble_fraction);
+  for (iree_host_size_t s = 0; s < stats->stage_count; ++s) {
+    fprintf(file, "  stage %" PRIhsz ": %.3f ms busy, utilization %.3f\n", s,
+            (double)stats->stages[s].busy_duration / 1000000.0,
+            stats->stages[s].utilization);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// iree_distributed_pipeline_t
+//===----------------------------------------------------------------------===//
+
+struct iree_distributed_pipeline_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_host_size_t stage_count;
+  iree_distributed_pipeline_stage_t
+      stages[IREE_DISTRIBUTED_PIPELINE_MAX_STAGES];
+};
+
+iree_status_t iree_distributed_pipeline_create(
+    iree_host_size_t stage_count,
+    const iree_distributed_pipeline_stage_t* stages,
+    iree_allocator_t host_allocator,
+    iree_distributed_pipeline_t** out_pipeline) {
+  IREE_ASSERT_ARGUMENT(!stage_count || stages);
+  IREE_ASSERT_ARGUMENT(out_pipeline);
+  *out_pipeline = NULL;
+  if (stage_count == 0 || stage_count > IREE_DISTRIBUTED_PIPELINE_MAX_STAGES) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "stage count %" PRIhsz " out of range (1 to %d)",
+                            stage_count, IREE_DISTRIBUTED_PIPELINE_MAX_STAGES);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Stages are scheduled purely with fences so each must use the async ABI.
+  for (iree_host_size_t s = 0; s < stage_count; ++s) {
+    iree_vm_function_t function = stages[s].function;
+    iree_string_view_t model = iree_vm_function_lookup_attr_by_name(
+        &function, IREE_SV("iree.abi.model"));
+    if (!iree_string_view_equal(model, IREE_SV("coarse-fences"))) {
+      iree_string_view_t name = iree_vm_function_name(&function);
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "stage %" PRIhsz " function '%.*s' must use the `coarse-fences` ABI "
+          "model (compile with --iree-execution-model=async-external)",
+          s, (int)name.size, name.data);
+    }
+  }
+
+  iree_distributed_pipeline_t* pipeline = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pipeline),
+                                (void**)&pipeline));
+  memset(pipeline, 0, sizeof(*pipeline));
+  iree_atomic_ref_count_init(&pipeline->ref_count);
+  pipeline->host_allocator = host_allocator;
+  pipeline->stage_count = stage_count;
+  for (iree_host_size_t s = 0; s < stage_count; ++s) {
+    pipeline->stages[s] = stages[s];
+    iree_vm_context_retain(stages[s].context);
+    iree_hal_device_retain(stages[s].device);
+  }
+
+  *out_pipeline = pipeline;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_distributed_pipeline_destroy(
+    iree_distributed_pipeline_t* pipeline) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = pipeline->host_allocator;
+  for (iree_host_size_t s = 0; s < pipeline->stage_count; ++s) {
+    iree_hal_device_release(pipeline->stages[s].device);
+    iree_vm_context_release(pipeline->stages[s].context);
+  }
+  iree_allocator_free(host_allocator, pipeline);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_distributed_pipeline_retain(iree_distributed_pipeline_t* pipeline) {
+  if (IREE_LIKELY(pipeline)) {
+    iree_atomic_ref_count_inc(&pipeline->ref_count);
+  }
+}
+
+void iree_distributed_pipeline_release(iree_distributed_pipeline_t* pipeline) {
+  if (IREE_LIKELY(pipeline) &&
+      iree_atomic_ref_count_dec(&pipeline->ref_count) == 1) {
+    iree_distributed_pipeline_destroy(pipeline);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Pipeline runs
+//===----------------------------------------------------------------------===//
+
+// State of a single iree_distributed_pipeline_run.
+typedef struct iree_distributed_pipeline_run_t {
+  iree_distributed_pipeline_t* pipeline;
+  iree_host_size_t microbatch_count;
+  // Signaled to m+1 once the input of microbatch m is available to the stage.
+  iree_hal_semaphore_t* input_semaphores[IREE_DISTRIBUTED_PIPELINE_MAX_STAGES];
+  // Signaled to m+1 once the stage has completed microbatch m.
+  iree_hal_semaphore_t*
+      compute_semaphores[IREE_DISTRIBUTED_PIPELINE_MAX_STAGES];
+  // Inputs and outputs of each stage invocation indexed by
+  // `stage * microbatch_count + microbatch`. Retained until the run completes
+  // so that no buffer is released while queued work may still use it.
+  iree_vm_list_t** stage_inputs;
+  iree_vm_list_t** stage_outputs;
+  // Observed times with the same indexing as the lists above.
+  iree_time_t* ready_times;
+  iree_time_t* completion_times;
+} iree_distributed_pipeline_run_t;
+
+static iree_status_t iree_distributed_pipeline_run_initialize(
+    iree_distributed_pipeline_t* pipeline, iree_host_size_t microbatch_count,
+    iree_distributed_pipeline_run_t* run) {
+  memset(run, 0, sizeof(*run));
+  run->pipeline = pipeline;
+  run->microbatch_count = microbatch_count;
+
+  iree_host_size_t slot_count = pipeline->stage_count * microbatch_count;
+  iree_host_size_t total_size =
+      slot_count * (2 * sizeof(iree_vm_list_t*) + 2 * sizeof(iree_time_t));
+  uint8_t* storage = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(pipeline->host_allocator,
+                                             total_size, (void**)&storage));
+  memset(storage, 0, total_size);
+  run->ready_times = (iree_time_t*)storage;
+  run->completion_times = run->ready_times + slot_count;
+  run->stage_inputs = (iree_vm_list_t**)(run->completion_times + slot_count);
+  run->stage_outputs = run->stage_inputs + slot_count;
+
+  for (iree_host_size_t s = 0; s < pipeline->stage_count; ++s) {
+    iree_hal_device_t* device = pipeline->stages[s].device;
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_create(
+        device, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE,
+        &run->input_semaphores[s]));
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_create(
+        device, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE,
+        &run->compute_semaphores[s]));
+  }
+  return iree_ok_status();
+}
+
+static void iree_distributed_pipeline_run_deinitialize(
+    iree_distributed_pipeline_run_t* run) {
+  iree_distributed_pipeline_t* pipeline = run->pipeline;
+  if (run->ready_times) {
+    iree_host_size_t slot_count =
+        pipeline->stage_count * run->microbatch_count;
+    for (iree_host_size_t i = 0; i < slot_count; ++i) {
+      iree_vm_list_release(run->stage_inputs[i]);
+      iree_vm_list_release(run->stage_outputs[i]);
+    }
+    iree_allocator_free(pipeline->host_allocator, run->ready_times);
+  }
+  for (iree_host_size_t s = 0; s < pipeline->stage_count; ++s) {
+    iree_hal_semaphore_release(run->input_semaphores[s]);
+    iree_hal_semaphore_release(run->compute_semaphores[s]);
+  }
+  memset(run, 0, sizeof(*run));
+}
+
+// Fails all timelines of the run with |status| so that any queued work waiting
+// on them is aborted. Takes ownership of |status|.
+static void iree_distributed_pipeline_run_fail(
+    iree_distributed_pipeline_run_t* run, iree_status_t status) {
+  for (iree_host_size_t s = 0; s < run->pipeline->stage_count; ++s) {
+    if (run->input_semaphores[s]) {
+      iree_hal_semaphore_fail(run->input_semaphores[s],
+                              iree_status_clone(status));
+    }
+    if (run->compute_semaphores[s]) {
+      iree_hal_semaphore_fail(run->compute_semaphores[s],
+                              iree_status_clone(status));
+    }
+  }
+  iree_status_ignore(status);
+}
+
+// Invokes |stage_index| on microbatch |microbatch| once its input is available
+// and the stage has completed the prior microbatch.
+static iree_status_t iree_distributed_pipeline_invoke_stage(
+    iree_distributed_pipeline_run_t* run, iree_host_size_t stage_index,
+    iree_host_size_t microbatch) {
+  iree_distributed_pipeline_t* pipeline = run->pipeline;
+  const iree_distributed_pipeline_stage_t* stage =
+      &pipeline->stages[stage_index];
+  iree_host_size_t slot = stage_index * run->microbatch_count + microbatch;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, stage_index);
+
+  iree_hal_fence_t* wait_fence = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_fence_create(2, pipeline->host_allocator, &wait_fence));
+  iree_status_t status = iree_hal_fence_insert(
+      wait_fence, run->input_semaphores[stage_index], microbatch + 1);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fence_insert(
+        wait_fence, run->compute_semaphores[stage_index], microbatch);
+  }
+  iree_hal_fence_t* signal_fence = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fence_create_at(run->compute_semaphores[stage_index],
+                                      microbatch + 1, pipeline->host_allocator,
+                                      &signal_fence);
+  }
+
+  // (inputs..., wait_fence, signal_fence) per the coarse-fences ABI.
+  iree_vm_list_t* args = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_clone(run->stage_inputs[slot],
+                                pipeline->host_allocator, &args);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t wait_fence_ref = iree_hal_fence_retain_ref(wait_fence);
+    status = iree_vm_list_push_ref_move(args, &wait_fence_ref);
+    iree_vm_ref_release(&wait_fence_ref);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t signal_fence_ref = iree_hal_fence_retain_ref(signal_fence);
+    status = iree_vm_list_push_ref_move(args, &signal_fence_ref);
+    iree_vm_ref_release(&signal_fence_ref);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(iree_vm_make_undefined_type_def(), 8,
+                                 pipeline->host_allocator,
+                                 &run->stage_outputs[slot]);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_invoke(stage->context, stage->function,
+                            IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/NULL,
+                            args, run->stage_outputs[slot],
+                            pipeline->host_allocator);
+  }
+
+  iree_vm_list_release(args);
+  iree_hal_fence_release(signal_fence);
+  iree_hal_fence_release(wait_fence);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Records a copy of |source_buffer| into a new buffer allocated from
+// |target_allocator| in |command_buffer|.
+static iree_status_t iree_distributed_pipeline_record_copy(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_allocator_t* target_allocator,
+    iree_hal_queue_affinity_t queue_affinity, iree_hal_buffer_t* source_buffer,
+    iree_hal_buffer_t** out_target_buffer) {
+  iree_device_size_t length = iree_hal_buffer_byte_length(source_buffer);
+  iree_hal_buffer_params_t params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
+      .queue_affinity = queue_affinity,
+  };
+  iree_hal_buffer_t* target_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      target_allocator, params, length, &target_buffer));
+  iree_status_t status = iree_hal_command_buffer_copy_buffer(
+      command_buffer, iree_hal_make_buffer_ref(source_buffer, 0, length),
+      iree_hal_make_buffer_ref(target_buffer, 0, length),
+      IREE_HAL_COPY_FLAG_NONE);
+  if (iree_status_is_ok(status)) {
+    *out_target_buffer = target_buffer;
+  } else {
+    iree_hal_buffer_release(target_buffer);
+  }
+  return status;
+}
+
+// Records copies of all buffers in |list| into new buffers on the device of
+// |stage| and replaces them in the list. Other values are left as-is.
+static iree_status_t iree_distributed_pipeline_record_transfers(
+    iree_hal_command_buffer_t* command_buffer,
+    const iree_distributed_pipeline_stage_t* stage, iree_vm_list_t* list) {
+  iree_hal_allocator_t* target_allocator =
+      iree_hal_device_allocator(stage->device);
+  for (iree_host_size_t i = 0; i < iree_vm_list_size(list); ++i) {
+    iree_vm_ref_t value = iree_vm_ref_null();
+    IREE_IGNORE_ERROR(iree_vm_list_get_ref_assign(list, i, &value));
+    if (iree_hal_buffer_isa(value)) {
+      iree_hal_buffer_t* target_buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_distributed_pipeline_record_copy(
+          command_buffer, target_allocator, stage->queue_affinity,
+          iree_hal_buffer_deref(value), &target_buffer));
+      iree_status_t status =
+          iree_vm_list_set_buffer_retain(list, i, target_buffer);
+      iree_hal_buffer_release(target_buffer);
+      IREE_RETURN_IF_ERROR(status);
+    } else if (iree_hal_buffer_view_isa(value)) {
+      iree_hal_buffer_view_t* source_view = iree_hal_buffer_view_deref(value);
+      iree_hal_buffer_t* target_buffer = NULL;
+      IREE_RETURN_IF_ERROR(iree_distributed_pipeline_record_copy(
+          command_buffer, target_allocator, stage->queue_affinity,
+          iree_hal_buffer_view_buffer(source_view), &target_buffer));
+      iree_hal_buffer_view_t* target_view = NULL;
+      iree_status_t status = iree_hal_buffer_view_create_like(
+          target_buffer, source_view,
+          iree_hal_allocator_host_allocator(target_allocator), &target_view);
+      iree_hal_buffer_release(target_buffer);
+      if (iree_status_is_ok(status)) {
+        status = iree_vm_list_set_buffer_view_retain(list, i, target_view);
+      }
+      iree_hal_buffer_view_release(target_view);
+      IREE_RETURN_IF_ERROR(status);
+    }
+  }
+  return iree_ok_status();
+}
+
+// Transfers the outputs of microbatch |microbatch| of the stage preceding
+// |stage_index| to the device of |stage_index|. The copies are executed on the
+// consuming device queue once the producing stage signals completion and
+// signal the input timeline of the consuming stage.
+static iree_status_t iree_distributed_pipeline_transfer_to_stage(
+    iree_distributed_pipeline_run_t* run, iree_host_size_t stage_index,
+    iree_host_size_t microbatch) {
+  iree_distributed_pipeline_t* pipeline = run->pipeline;
+  const iree_distributed_pipeline_stage_t* stage =
+      &pipeline->stages[stage_index];
+  iree_host_size_t source_slot =
+      (stage_index - 1) * run->microbatch_count + microbatch;
+  iree_host_size_t target_slot =
+      stage_index * run->microbatch_count + microbatch;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, stage_index);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_list_clone(run->stage_outputs[source_slot],
+                             pipeline->host_allocator,
+                             &run->stage_inputs[target_slot]));
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_command_buffer_create(
+              stage->device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+              IREE_HAL_COMMAND_CATEGORY_TRANSFER, stage->queue_affinity,
+              /*binding_capacity=*/0, &command_buffer));
+  iree_status_t status = iree_hal_command_buffer_begin(command_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_distributed_pipeline_record_transfers(
+        command_buffer, stage, run->stage_inputs[target_slot]);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_end(command_buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    uint64_t wait_value = microbatch + 1;
+    iree_hal_semaphore_list_t wait_semaphores = {
+        .count = 1,
+        .semaphores = &run->compute_semaphores[stage_index - 1],
+        .payload_values = &wait_value,
+    };
+    uint64_t signal_value = microbatch + 1;
+    iree_hal_semaphore_list_t signal_semaphores = {
+        .count = 1,
+        .semaphores = &run->input_semaphores[stage_index],
+        .payload_values = &signal_value,
+    };
+    status = iree_hal_device_queue_execute(
+        stage->device, stage->queue_affinity, wait_semaphores,
+        signal_semaphores, command_buffer,
+        iree_hal_buffer_binding_table_empty());
+  }
+
+  iree_hal_command_buffer_release(command_buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Records the current time for all timepoints reached on |semaphore| since
+// |observed_count| timepoints were last observed.
+static iree_status_t iree_distributed_pipeline_observe_timeline(
+    iree_hal_semaphore_t* semaphore, iree_host_size_t microbatch_count,
+    iree_host_size_t* observed_count, iree_time_t* times) {
+  uint64_t value = 0;
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_query(semaphore, &value));
+  iree_time_t now = iree_time_now();
+  iree_host_size_t reached_count =
+      (iree_host_size_t)iree_min(value, (uint64_t)microbatch_count);
+  for (; *observed_count < reached_count; ++*observed_count) {
+    times[*observed_count] = now;
+  }
+  return iree_ok_status();
+}
+
+// Waits for all stages to complete all microbatches while recording when each
+// input became ready and when each stage completed each microbatch.
+static iree_status_t iree_distributed_pipeline_observe(
+    iree_distributed_pipeline_run_t* run) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_distributed_pipeline_t* pipeline = run->pipeline;
+  iree_host_size_t microbatch_count = run->microbatch_count;
+  iree_host_size_t ready_counts[IREE_DISTRIBUTED_PIPELINE_MAX_STAGES] = {0};
+  iree_host_size_t completed_counts[IREE_DISTRIBUTED_PIPELINE_MAX_STAGES] = {
+      0};
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status)) {
+    iree_host_size_t pending_stage = pipeline->stage_count;
+    for (iree_host_size_t s = 0;
+         s < pipeline->stage_count && iree_status_is_ok(status); ++s) {
+      status = iree_distributed_pipeline_observe_timeline(
+          run->input_semaphores[s], microbatch_count, &ready_counts[s],
+          &run->ready_times[s * microbatch_count]);
+      if (iree_status_is_ok(status)) {
+        status = iree_distributed_pipeline_observe_timeline(
+            run->compute_semaphores[s], microbatch_count, &completed_counts[s],
+            &run->completion_times[s * microbatch_count]);
+      }
+      if (completed_counts[s] < microbatch_count &&
+          pending_stage == pipeline->stage_count) {
+        pending_stage = s;
+      }
+    }
+    if (!iree_status_is_ok(status) || pending_stage == pipeline->stage_count) {
+      break;
+    }
+
+    // Block on the earliest pending stage for a bounded interval so that
+    // progress on all other stages is still observed promptly.
+    status = iree_hal_semaphore_wait(
+        run->compute_semaphores[pending_stage],
+        completed_counts[pending_stage] + 1,
+        iree_make_timeout_ns(IREE_DISTRIBUTED_PIPELINE_POLL_INTERVAL_NS));
+    if (iree_status_is_deadline_exceeded(status)) {
+      status = iree_status_ignore(status);
+    }
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_distributed_pipeline_run(
+    iree_distributed_pipeline_t* pipeline, iree_host_size_t microbatch_count,
+    iree_vm_list_t* const* inputs, iree_vm_list_t** out_outputs,
+    iree_distributed_pipeline_stats_t* out_stats) {
+  IREE_ASSERT_ARGUMENT(pipeline);
+  IREE_ASSERT_ARGUMENT(!microbatch_count || inputs);
+  IREE_ASSERT_ARGUMENT(!microbatch_count || out_outputs);
+  if (microbatch_count == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at least one microbatch is required");
+  }
+  memset(out_outputs, 0, microbatch_count * sizeof(*out_outputs));
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, microbatch_count);
+
+  iree_distributed_pipeline_run_t run;
+  iree_status_t status = iree_distributed_pipeline_run_initialize(
+      pipeline, microbatch_count, &run);
+
+  // The inputs of the first stage are provided by the caller and are all
+  // available immediately.
+  iree_time_t start_time = iree_time_now();
+  if (iree_status_is_ok(status)) {
+    for (iree_host_size_t m = 0; m < microbatch_count; ++m) {
+      run.stage_inputs[m] = inputs[m];
+      iree_vm_list_retain(inputs[m]);
+    }
+    status = iree_hal_semaphore_signal(run.input_semaphores[0],
+                                       (uint64_t)microbatch_count);
+  }
+
+  // Enqueue all microbatches through all stages. Nothing here waits on the
+  // devices: each stage invocation and transfer is ordered by the timelines.
+  for (iree_host_size_t m = 0;
+       m < microbatch_count && iree_status_is_ok(status); ++m) {
+    for (iree_host_size_t s = 0;
+         s < pipeline->stage_count && iree_status_is_ok(status); ++s) {
+      if (s > 0) {
+        status = iree_distributed_pipeline_transfer_to_stage(&run, s, m);
+      }
+      if (iree_status_is_ok(status)) {
+        status = iree_distributed_pipeline_invoke_stage(&run, s, m);
+      }
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_distributed_pipeline_observe(&run);
+  } else if (run.ready_times) {
+    iree_distributed_pipeline_run_fail(&run, iree_status_clone(status));
+  }
+
+  if (iree_status_is_ok(status) && out_stats) {
+    status = iree_distributed_pipeline_stats_compute(
+        pipeline->stage_count, microbatch_count, start_time, run.ready_times,
+        run.completion_times, out_stats);
+  }
+
+  // Hand the outputs of the last stage to the caller.
+  if (iree_status_is_ok(status)) {
+    iree_host_size_t last_slot = (pipeline->stage_count - 1) * microbatch_count;
+    for (iree_host_size_t m = 0; m < microbatch_count; ++m) {
+      out_outputs[m] = run.stage_outputs[last_slot + m];
+      run.stage_outputs[last_slot + m] = NULL;
+    }
+  }
+
+  iree_distributed_pipeline_run_deinitialize(&run);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,131 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_EXPERIMENTAL_DISTRIBUTED_RUNTIME_PIPELINE_H_
+#define IREE_EXPERIMENTAL_DISTRIBUTED_RUNTIME_PIPELINE_H_
+
+#include <stdio.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of stages in a single pipeline.
+#define IREE_DISTRIBUTED_PIPELINE_MAX_STAGES 16
+
+//===----------------------------------------------------------------------===//
+// iree_distributed_pipeline_stats_t
+//===----------------------------------------------------------------------===//
+
+// Statistics of a single pipeline stage accumulated over one run.
+typedef struct iree_distributed_pipeline_stage_stats_t {
+  // Total time the stage was executing a microbatch.
+  iree_duration_t busy_duration;
+  // Fraction of the run duration the stage was busy in [0, 1].
+  double utilization;
+} iree_distributed_pipeline_stage_stats_t;
+
+// Statistics of a single pipeline run.
+typedef struct iree_distributed_pipeline_stats_t {
+  // Number of microbatches that flowed through the pipeline.
+  iree_host_size_t microbatch_count;
+  // Time from the start of the run until the last stage completed the last
+  // microbatch.
+  iree_duration_t total_duration;
+  // Fraction of the stage time slots spent idle in [0, 1]. An ideal pipeline
+  // schedule with S uniform stages and M microbatches has a bubble fraction of
+  // (S - 1) / (M + S - 1).
+  double bubble_fraction;
+  iree_host_size_t stage_count;
+  iree_distributed_pipeline_stage_stats_t
+      stages[IREE_DISTRIBUTED_PIPELINE_MAX_STAGES];
+} iree_distributed_pipeline_stats_t;
+
+// Computes the statistics of a run that began at |start_time| from the times
+// at which each stage observed the input of each microbatch as ready and the
+// times at which it completed the microbatch. Both arrays are indexed by
+// `stage * microbatch_count + microbatch`.
+//
+// Stages execute their microbatches in order so a microbatch begins when both
+// its input is ready and the stage completed the prior microbatch.
+iree_status_t iree_distributed_pipeline_stats_compute(
+    iree_host_size_t stage_count, iree_host_size_t microbatch_count,
+    iree_time_t start_time, const iree_time_t* ready_times,
+    const iree_time_t* completion_times,
+    iree_distributed_pipeline_stats_t* out_stats);
+
+// Prints |stats| to |file| in a human-readable form.
+void iree_distributed_pipeline_stats_fprint(
+    FILE* file, const iree_distributed_pipeline_stats_t* stats);
+
+//===----------------------------------------------------------------------===//
+// iree_distributed_pipeline_t
+//===----------------------------------------------------------------------===//
+
+// A stage of a pipeline pinned to a single HAL device.
+typedef struct iree_distributed_pipeline_stage_t {
+  // Context containing the stage function and a HAL module using |device|.
+  iree_vm_context_t* context;
+  // Function invoked once per microbatch. It must use the `coarse-fences`
+  // ABI model: the stage inputs are followed by a wait and a signal fence.
+  // The outputs of each stage are the inputs of the following stage.
+  iree_vm_function_t function;
+  // Device the stage executes on. Inputs produced by the prior stage are
+  // transferred to this device with queue-ordered copies.
+  iree_hal_device_t* device;
+  // Queue affinity used for the transfers into the stage.
+  iree_hal_queue_affinity_t queue_affinity;
+} iree_distributed_pipeline_stage_t;
+
+// A pipeline-parallel scheduler running microbatches through a sequence of
+// stages pinned to separate HAL devices.
+//
+// All microbatches are enqueued up front: each stage waits on the transfer of
+// its input and on its own prior microbatch and signals a per-stage timeline
+// semaphore with the number of microbatches it completed. Transfers between
+// stages are enqueued on the consuming device and wait on the producing stage
+// so that compute and transfers of different microbatches overlap without any
+// host synchronization. The host only observes the timelines to record the
+// schedule statistics.
+//
+// Buffers produced on one device must be accessible by the queue of the
+// following device (such as devices sharing a driver with peer access or
+// host-local memory).
+typedef struct iree_distributed_pipeline_t iree_distributed_pipeline_t;
+
+// Creates a pipeline of |stage_count| |stages| executed in order.
+// The contexts and devices of the stages are retained by the pipeline.
+iree_status_t iree_distributed_pipeline_create(
+    iree_host_size_t stage_count,
+    const iree_distributed_pipeline_stage_t* stages,
+    iree_allocator_t host_allocator,
+    iree_distributed_pipeline_t** out_pipeline);
+
+// Retains the given |pipeline| for the caller.
+void iree_distributed_pipeline_retain(iree_distributed_pipeline_t* pipeline);
+
+// Releases the given |pipeline| from the caller.
+void iree_distributed_pipeline_release(iree_distributed_pipeline_t* pipeline);
+
+// Runs |microbatch_count| microbatches through the pipeline.
+// |inputs| contains the inputs of the first stage for each microbatch and
+// |out_outputs| receives the outputs of the last stage for each microbatch.
+// The caller must release each output list. Returns once all microbatches
+// have completed and, if provided, populates |out_stats|.
+iree_status_t iree_distributed_pipeline_run(
+    iree_distributed_pipeline_t* pipeline, iree_host_size_t microbatch_count,
+    iree_vm_list_t* const* inputs, iree_vm_list_t** out_outputs,
+    iree_distributed_pipeline_stats_t* out_stats);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_EXPERIMENTAL_DISTRIBUTED_RUNTIME_PIPELINE_H_
@@ -0,0 +1,69 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/distributed/runtime/pipeline.h"
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+using iree::testing::status::StatusIs;
+
+// Two uniform stages taking 10 time units per microbatch with two
+// microbatches: the ideal schedule has a bubble of (S - 1) / (M + S - 1).
+TEST(PipelineStatsTest, UniformSchedule) {
+  const iree_time_t ready_times[] = {0, 0, 10, 20};
+  const iree_time_t completion_times[] = {10, 20, 20, 30};
+  iree_distributed_pipeline_stats_t stats;
+  IREE_ASSERT_OK(iree_distributed_pipeline_stats_compute(
+      /*stage_count=*/2, /*microbatch_count=*/2, /*start_time=*/0, ready_times,
+      completion_times, &stats));
+  EXPECT_EQ(stats.stage_count, 2u);
+  EXPECT_EQ(stats.microbatch_count, 2u);
+  EXPECT_EQ(stats.total_duration, 30);
+  EXPECT_EQ(stats.stages[0].busy_duration, 20);
+  EXPECT_EQ(stats.stages[1].busy_duration, 20);
+  EXPECT_DOUBLE_EQ(stats.stages[0].utilization, 2.0 / 3.0);
+  EXPECT_DOUBLE_EQ(stats.stages[1].utilization, 2.0 / 3.0);
+  EXPECT_DOUBLE_EQ(stats.bubble_fraction, 1.0 / 3.0);
+}
+
+// A slow second stage stalls on its own prior microbatch rather than on its
+// inputs; the time between the input being ready and the stage picking it up
+// must not be counted as busy.
+TEST(PipelineStatsTest, BottleneckStage) {
+  const iree_time_t ready_times[] = {100, 100, 110, 120};
+  const iree_time_t completion_times[] = {110, 120, 140, 170};
+  iree_distributed_pipeline_stats_t stats;
+  IREE_ASSERT_OK(iree_distributed_pipeline_stats_compute(
+      /*stage_count=*/2, /*microbatch_count=*/2, /*start_time=*/100,
+      ready_times, completion_times, &stats));
+  EXPECT_EQ(stats.total_duration, 70);
+  EXPECT_EQ(stats.stages[0].busy_duration, 20);
+  EXPECT_EQ(stats.stages[1].busy_duration, 60);
+  EXPECT_DOUBLE_EQ(stats.stages[0].utilization, 20.0 / 70.0);
+  EXPECT_DOUBLE_EQ(stats.stages[1].utilization, 60.0 / 70.0);
+  EXPECT_DOUBLE_EQ(stats.bubble_fraction, 1.0 - 80.0 / 140.0);
+}
+
+TEST(PipelineStatsTest, InvalidCounts) {
+  const iree_time_t times[] = {0};
+  iree_distributed_pipeline_stats_t stats;
+  EXPECT_THAT(Status(iree_distributed_pipeline_stats_compute(
+                  /*stage_count=*/0, /*microbatch_count=*/1, 0, times, times,
+                  &stats)),
+              StatusIs(StatusCode::kOutOfRange));
+  EXPECT_THAT(Status(iree_distributed_pipeline_stats_compute(
+                  /*stage_count=*/1, /*microbatch_count=*/0, 0, times, times,
+                  &stats)),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace iree
@@ -211,10 +211,27 @@ class FetchedArtifact(ProducedArtifact):
                     download_stream = blob_client.download_blob(max_concurrency=4)
                     local_blob.write(download_stream.readall())
 
+    def download_url_artifact(self: "FetchedArtifact"):
+        """
+        Downloads a plain HTTP(S) artifact unless it was already fetched.
+
+        Unlike Azure blobs there is no remote hash to compare against so an
+        existing non-empty local file is assumed to be up to date.
+        """
+        remote_file_name = self.url.rsplit("/", 1)[-1]
+        if self.path.exists() and self.path.stat().st_size > 0:
+            logger.info(f"  Skipping '{remote_file_name}' download - file exists")
+            return
+        logger.info(f"  Downloading '{remote_file_name}' to '{self.path}'")
+        with tqdm(unit="B", unit_scale=True, miniters=1, desc=remote_file_name) as t:
+            urllib.request.urlretrieve(self.url, self.path, reporthook=show_progress(t))
+
     @staticmethod
     def _callback(self: "FetchedArtifact"):
         if "blob.core.windows.net" in self.url:
             self.download_azure_artifact()
+        elif urllib.parse.urlparse(self.url).scheme in ("http", "https"):
+            self.download_url_artifact()
         else:
             raise NotImplementedError(
                 f"Unsupported fetched artifact URL schema for '{self.url}'"
@@ -14,13 +14,42 @@
 #include "iree/base/api.h"
 #include "iree/base/internal/math.h"
 
+#define IREE_HAL_WEBGPU_INVALID_INDEX \
+  IREE_HAL_WEBGPU_BIND_GROUP_CACHE_INVALID_INDEX
+
+static_assert(IREE_HAL_WEBGPU_BIND_GROUP_CACHE_CAPACITY <
+                  IREE_HAL_WEBGPU_BIND_GROUP_CACHE_INVALID_INDEX,
+              "entry indices must fit in uint16_t");
+static_assert((IREE_HAL_WEBGPU_BIND_GROUP_CACHE_BUCKET_COUNT &
+               (IREE_HAL_WEBGPU_BIND_GROUP_CACHE_BUCKET_COUNT - 1)) == 0,
+              "bucket count must be a power of two");
+
+// Resets |cache| to have all entries unused and linked in the LRU list.
+static void iree_hal_webgpu_bind_group_cache_reset(
+    iree_hal_webgpu_bind_group_cache_t* cache) {
+  memset(cache->entries, 0, sizeof(cache->entries));
+  for (uint16_t i = 0; i < IREE_HAL_WEBGPU_BIND_GROUP_CACHE_BUCKET_COUNT; ++i) {
+    cache->buckets[i] = IREE_HAL_WEBGPU_INVALID_INDEX;
+  }
+  for (uint16_t i = 0; i < IREE_HAL_WEBGPU_BIND_GROUP_CACHE_CAPACITY; ++i) {
+    iree_hal_webgpu_bind_group_cache_entry_t* entry = &cache->entries[i];
+    entry->bucket_next = IREE_HAL_WEBGPU_INVALID_INDEX;
+    entry->lru_prev = i > 0 ? i - 1 : IREE_HAL_WEBGPU_INVALID_INDEX;
+    entry->lru_next = i + 1 < IREE_HAL_WEBGPU_BIND_GROUP_CACHE_CAPACITY
+                          ? i + 1
+                          : IREE_HAL_WEBGPU_INVALID_INDEX;
+  }
+  cache->lru_head = 0;
+  cache->lru_tail = IREE_HAL_WEBGPU_BIND_GROUP_CACHE_CAPACITY - 1;
+}
+
 void iree_hal_webgpu_bind_group_cache_initialize(
     WGPUDevice device, iree_hal_webgpu_bind_group_cache_t* out_cache) {
   IREE_ASSERT_ARGUMENT(out_cache);
   IREE_TRACE_ZONE_BEGIN(z0);
 
   out_cache->device = device;
-  out_cache->entry_count = IREE_HAL_WEBGPU_BIND_GROUP_CACHE_CAPACITY;
+  iree_hal_webgpu_bind_group_cache_reset(out_cache);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -32,7 +61,6 @@ void iree_hal_webgpu_bind_group_cache_deinitialize(
 
   // Trim is the same as deinit today.
   iree_hal_webgpu_bind_group_cache_trim(cache);
-  cache->entry_count = 0;
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -42,74 +70,145 @@ void iree_hal_webgpu_bind_group_cache_trim(
   IREE_ASSERT_ARGUMENT(cache);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  for (iree_host_size_t i = 0; i < cache->entry_count; ++i) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(cache->entries); ++i) {
     iree_hal_webgpu_bind_group_cache_entry_t* entry = &cache->entries[i];
     if (entry->handle) iree_wgpuBindGroupDrop(entry->handle);
   }
-  memset(cache->entries, 0, sizeof(cache->entries));
+  iree_hal_webgpu_bind_group_cache_reset(cache);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// FNV-1a over the bytes of |data| continuing from |hash|.
+static uint32_t iree_hal_webgpu_bind_group_cache_hash_bytes(
+    uint32_t hash, const void* data, iree_host_size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (iree_host_size_t i = 0; i < length; ++i) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+// Moves |index| to the head of the LRU list.
+static void iree_hal_webgpu_bind_group_cache_touch(
+    iree_hal_webgpu_bind_group_cache_t* cache, uint16_t index) {
+  if (cache->lru_head == index) return;
+  iree_hal_webgpu_bind_group_cache_entry_t* entry = &cache->entries[index];
+
+  // Unlink. The entry is not the head so it must have a previous entry.
+  cache->entries[entry->lru_prev].lru_next = entry->lru_next;
+  if (entry->lru_next != IREE_HAL_WEBGPU_INVALID_INDEX) {
+    cache->entries[entry->lru_next].lru_prev = entry->lru_prev;
+  } else {
+    cache->lru_tail = entry->lru_prev;
+  }
+
+  // Link at the head.
+  entry->lru_prev = IREE_HAL_WEBGPU_INVALID_INDEX;
+  entry->lru_next = cache->lru_head;
+  cache->entries[cache->lru_head].lru_prev = index;
+  cache->lru_head = index;
+}
+
+// Returns the head of the hash bucket containing entries with |hash|.
+static uint16_t* iree_hal_webgpu_bind_group_cache_bucket(
+    iree_hal_webgpu_bind_group_cache_t* cache, uint32_t hash) {
+  return &cache
+              ->buckets[hash &
+                        (IREE_HAL_WEBGPU_BIND_GROUP_CACHE_BUCKET_COUNT - 1)];
+}
+
+// Removes |index| from the hash bucket it is linked into.
+static void iree_hal_webgpu_bind_group_cache_unlink_bucket(
+    iree_hal_webgpu_bind_group_cache_t* cache, uint16_t index) {
+  iree_hal_webgpu_bind_group_cache_entry_t* entry = &cache->entries[index];
+  uint16_t* it = iree_hal_webgpu_bind_group_cache_bucket(cache, entry->hash);
+  while (*it != IREE_HAL_WEBGPU_INVALID_INDEX) {
+    if (*it == index) {
+      *it = entry->bucket_next;
+      break;
+    }
+    it = &cache->entries[*it].bucket_next;
+  }
+  entry->bucket_next = IREE_HAL_WEBGPU_INVALID_INDEX;
+}
+
 WGPUBindGroup iree_hal_webgpu_bind_group_cache_acquire(
     iree_hal_webgpu_bind_group_cache_t* cache, WGPUBindGroupLayout group_layout,
     const iree_hal_webgpu_bind_group_binding_t* bindings,
-    iree_hal_webgpu_binding_mask_t binding_mask) {
+    iree_hal_webgpu_binding_mask_t binding_mask,
+    iree_hal_webgpu_binding_mask_t dynamic_mask,
+    uint32_t* out_dynamic_offsets, uint32_t* out_dynamic_offset_count) {
   IREE_ASSERT_ARGUMENT(cache);
   IREE_ASSERT_ARGUMENT(bindings);
+  IREE_ASSERT_ARGUMENT(!dynamic_mask || out_dynamic_offsets);
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // This is not a good algorithm :)
-  // We should probably have a split index and a mechanism to partition it such
-  // that lookups don't need to perform a full scan. This is cheaper than the
-  // cost of creating a new bind group per dispatch (no need to call out to
-  // WebGPU, allocate new objects, track those new objects lifetimes, etc) but
-  // not cheap. Ideally we'd be relying on this for 4-5 bind groups per command
-  // buffer at which point it doesn't matter but the compiler still needs to
-  // improve a bit there.
-
-  // Scan the cache for entries with a matching group layout and binding mask.
-  // These should be the same today but in the future we may want to allow for
-  // subsetting as defined by bind group compatibility.
-  iree_host_size_t insertion_slot = cache->entry_count - 1;
-  for (iree_host_size_t i = 0; i < cache->entry_count; ++i) {
-    iree_hal_webgpu_bind_group_cache_entry_t* entry = &cache->entries[i];
-    if (!entry->handle) {
-      insertion_slot = iree_min(insertion_slot, i);
-      continue;
+  // Build the cache key: only bindings used by the caller are compared and the
+  // offsets of dynamic bindings are split off to be passed when setting the
+  // bind group. This lets all sub-allocations of the same size from a base
+  // buffer share a single bind group. The key is zero-initialized so that it
+  // can be compared (and hashed) with padding bytes included.
+  // NOTE: we could change this to do bit scans over the binding_mask but I
+  // haven't checked to see how expensive those are in WebAssembly. For now we
+  // do a few more loop iterations with the assumption that doing a bit scan
+  // may require hundreds of more instructions.
+  iree_hal_webgpu_bind_group_binding_t
+      key[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT];
+  memset(key, 0, sizeof(key));
+  uint32_t dynamic_offset_count = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(key); ++i) {
+    if (!(binding_mask & (1u << i))) continue;
+    key[i].type = bindings[i].type;
+    key[i].buffer = bindings[i].buffer;
+    key[i].length = bindings[i].length;
+    if (dynamic_mask & (1u << i)) {
+      out_dynamic_offsets[dynamic_offset_count++] =
+          (uint32_t)bindings[i].offset;
+    } else {
+      key[i].offset = bindings[i].offset;
     }
+  }
+  if (out_dynamic_offset_count) {
+    *out_dynamic_offset_count = dynamic_offset_count;
+  }
+  uint32_t hash = 2166136261u;
+  hash = iree_hal_webgpu_bind_group_cache_hash_bytes(hash, &group_layout,
+                                                     sizeof(group_layout));
+  hash = iree_hal_webgpu_bind_group_cache_hash_bytes(hash, &binding_mask,
+                                                     sizeof(binding_mask));
+  hash = iree_hal_webgpu_bind_group_cache_hash_bytes(hash, key, sizeof(key));
+  uint16_t* bucket = iree_hal_webgpu_bind_group_cache_bucket(cache, hash);
+
+  // Scan the bucket for entries with a matching group layout and bindings.
+  // We require an exact layout match today but in the future we may want to
+  // allow for subsetting as defined by bind group compatibility.
+  for (uint16_t i = *bucket; i != IREE_HAL_WEBGPU_INVALID_INDEX;
+       i = cache->entries[i].bucket_next) {
+    iree_hal_webgpu_bind_group_cache_entry_t* entry = &cache->entries[i];
+    if (entry->hash != hash) continue;
     if (entry->group_layout != group_layout) continue;
     if (entry->binding_mask != binding_mask) continue;
-
-    // Found a potential match. Do a full comparison of the bindings.
-    // TODO(benvanik): we only really need to compare the bindings that are
-    // set in the mask, however memcmp over a few hundred bytes is usually
-    // faster than what we'd have to do for that comparison.
-    if (memcmp(bindings, entry->bindings, sizeof(entry->bindings)) == 0) {
-      // Same exact bindings - cache hit!
-      // TODO(benvanik): a real LRU that rearranges this to the front/back.
-      IREE_TRACE_ZONE_END(z0);
-      return entry->handle;
-    }
+    if (memcmp(key, entry->bindings, sizeof(entry->bindings)) != 0) continue;
+    // Same exact bindings - cache hit!
+    iree_hal_webgpu_bind_group_cache_touch(cache, i);
+    IREE_TRACE_ZONE_END(z0);
+    return entry->handle;
   }
 
-  // Evict an existing entry to store this new one or use the last unused slot.
-  iree_hal_webgpu_bind_group_cache_entry_t* entry =
-      &cache->entries[insertion_slot];
+  // Evict the least recently used entry (which may be unused) to store this
+  // new one.
+  uint16_t index = cache->lru_tail;
+  iree_hal_webgpu_bind_group_cache_entry_t* entry = &cache->entries[index];
   if (entry->handle) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "evict");
+    iree_hal_webgpu_bind_group_cache_unlink_bucket(cache, index);
     iree_wgpuBindGroupDrop(entry->handle);
+    entry->handle = NULL;
   } else {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "miss");
   }
-  entry->group_layout = group_layout;
-  entry->binding_mask = binding_mask;
-  memcpy(entry->bindings, bindings, sizeof(entry->bindings));
 
-  // NOTE: we could change this to do bit scans over the binding_mask but I
-  // haven't checked to see how expensive those are in WebAssembly. For now we
-  // do a few more loop iterations with the assumption that doing a bit scan
-  // may require hundreds of more instructions.
   uint32_t binding_count = 0;
   WGPUBindGroupEntry entries[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT];
   for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(entries); ++i) {
@@ -117,13 +216,12 @@ WGPUBindGroup iree_hal_webgpu_bind_group_cache_acquire(
     entries[binding_count] = (WGPUBindGroupEntry){
         .nextInChain = NULL,
         .binding = binding_count,
-        .buffer = bindings[i].buffer,
-        .offset = (uint64_t)bindings[i].offset,
-        .size = bindings[i].length,
+        .buffer = key[i].buffer,
+        .offset = (uint64_t)key[i].offset,
+        .size = key[i].length,
     };
     ++binding_count;
   }
-
   const WGPUBindGroupDescriptor descriptor = {
       .nextInChain = NULL,
       .label = NULL,
@@ -131,8 +229,18 @@ WGPUBindGroup iree_hal_webgpu_bind_group_cache_acquire(
       .entryCount = binding_count,
       .entries = entries,
   };
-  entry->handle = wgpuDeviceCreateBindGroup(cache->device, &descriptor);
+  WGPUBindGroup handle = wgpuDeviceCreateBindGroup(cache->device, &descriptor);
+  if (handle) {
+    entry->group_layout = group_layout;
+    entry->handle = handle;
+    entry->binding_mask = binding_mask;
+    entry->hash = hash;
+    memcpy(entry->bindings, key, sizeof(entry->bindings));
+    entry->bucket_next = *bucket;
+    *bucket = index;
+    iree_hal_webgpu_bind_group_cache_touch(cache, index);
+  }
 
   IREE_TRACE_ZONE_END(z0);
-  return entry->handle;
+  return handle;
 }
@@ -16,16 +16,19 @@
 extern "C" {
 #endif  // __cplusplus
 
-// NOTE: this is probably too small, but this is all a hack anyway.
-// TODO(benvanik): build a real cache - today this is assuming the compiler does
-// a much better job than it currently does as reducing the number of push
-// descriptor sets.
-#define IREE_HAL_WEBGPU_BIND_GROUP_CACHE_CAPACITY 32
+// Maximum number of bind groups retained by the cache. Least recently used
+// bind groups are evicted when full.
+#define IREE_HAL_WEBGPU_BIND_GROUP_CACHE_CAPACITY 64
+
+// Number of hash buckets used for lookups. Must be a power of two.
+#define IREE_HAL_WEBGPU_BIND_GROUP_CACHE_BUCKET_COUNT 128
+
+// Sentinel entry index used to terminate the bucket and LRU lists.
+#define IREE_HAL_WEBGPU_BIND_GROUP_CACHE_INVALID_INDEX UINT16_MAX
 
 // A subset of WGPUBindGroupEntry containing only what we need.
 // WGPUBindGroupEntry is quite large (has sampler and texture information).
 typedef struct iree_hal_webgpu_bind_group_binding_t {
-  // TODO(benvanik): also track whether dynamic.
   WGPUBufferBindingType type;
   WGPUBuffer buffer;
   iree_device_size_t offset;
@@ -37,21 +40,37 @@ typedef struct iree_hal_webgpu_bind_group_cache_entry_t {
   // It's possible to share bind groups with different compatible layouts but
   // we don't do that yet and require an exact match.
   WGPUBindGroupLayout group_layout;
-  // Cached WebGPU bind group containing the bindings.
+  // Cached WebGPU bind group containing the bindings or NULL if unused.
   WGPUBindGroup handle;
   // Each bit indicates a populated binding at the respective ordinal.
   iree_hal_webgpu_binding_mask_t binding_mask;
-  // Each source binding to use for cache equality comparison.
+  // Hash of the group layout, binding mask, and bindings.
+  uint32_t hash;
+  // Next entry in the same hash bucket.
+  uint16_t bucket_next;
+  // Neighboring entries in the LRU list.
+  uint16_t lru_prev;
+  uint16_t lru_next;
+  // Each source binding to use for cache equality comparison. Bindings not in
+  // |binding_mask| are zeroed as are the offsets of dynamic bindings as those
+  // are provided when the bind group is set.
   iree_hal_webgpu_bind_group_binding_t
       bindings[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT];
 } iree_hal_webgpu_bind_group_cache_entry_t;
 
-// Simple cache of WGPUBindGroups.
+// Hashed LRU cache of WGPUBindGroups.
 // Bind groups in WebGPU are immutable and we need to create new ones for each
-// unique set of bindings.
+// unique set of bindings. Bindings declared with dynamic offsets in their group
+// layout are cached without their offsets so that the same bind group can be
+// reused across all sub-allocations of the same size from a base buffer.
 typedef struct iree_hal_webgpu_bind_group_cache_t {
   WGPUDevice device;
-  iree_host_size_t entry_count;
+  // Most and least recently used entries. All entries (including unused ones)
+  // are always in the LRU list so that eviction is just taking the tail.
+  uint16_t lru_head;
+  uint16_t lru_tail;
+  // Head entry index of each hash bucket.
+  uint16_t buckets[IREE_HAL_WEBGPU_BIND_GROUP_CACHE_BUCKET_COUNT];
   iree_hal_webgpu_bind_group_cache_entry_t
       entries[IREE_HAL_WEBGPU_BIND_GROUP_CACHE_CAPACITY];
 } iree_hal_webgpu_bind_group_cache_t;
@@ -72,12 +91,18 @@ void iree_hal_webgpu_bind_group_cache_trim(
 // Acquires a bind group from the cache with the given |bindings|.
 // Each bit of |binding_mask| indicates a binding that is used by the caller;
 // this allows for matching of cached bind groups to match any with only the
-// used bindings needing to match.
+// used bindings needing to match. Each bit of |dynamic_mask| indicates a
+// binding declared with a dynamic offset in |group_layout|: the offsets of
+// those bindings are returned in binding order in |out_dynamic_offsets| (which
+// must have room for IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT values)
+// and must be passed along with the bind group when setting it.
 // Callers may use the returned bind group handle until the cache is trimmed.
 WGPUBindGroup iree_hal_webgpu_bind_group_cache_acquire(
     iree_hal_webgpu_bind_group_cache_t* cache, WGPUBindGroupLayout group_layout,
     const iree_hal_webgpu_bind_group_binding_t* bindings,
-    iree_hal_webgpu_binding_mask_t binding_mask);
+    iree_hal_webgpu_binding_mask_t binding_mask,
+    iree_hal_webgpu_binding_mask_t dynamic_mask,
+    uint32_t* out_dynamic_offsets, uint32_t* out_dynamic_offset_count);
 
 #ifdef __cplusplus
 }  // extern "C"
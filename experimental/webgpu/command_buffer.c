@@ -673,7 +673,8 @@ static iree_status_t iree_hal_webgpu_command_buffer_fill_buffer(
   };
   WGPUBindGroup buffer_group = iree_hal_webgpu_bind_group_cache_acquire(
       command_buffer->bind_group_cache, builtin->buffer_group_layout,
-      &buffer_binding, /*binding_mask=*/1);
+      &buffer_binding, /*binding_mask=*/1, /*dynamic_mask=*/0,
+      /*out_dynamic_offsets=*/NULL, /*out_dynamic_offset_count=*/NULL);
   wgpuComputePassEncoderSetBindGroup(compute_pass, /*groupIndex=*/1,
                                      buffer_group, 0, NULL);
   command_buffer->state.bind_groups[1].handle = NULL;
@@ -792,8 +793,8 @@ static iree_status_t iree_hal_webgpu_command_buffer_push_descriptor_set(
     iree_hal_webgpu_bind_group_binding_t* group_binding =
         &group_bindings[ordinal];
 
-    // TODO(benvanik): lookup binding type from layout. We should also be
-    // tagging whether it's dynamic here.
+    // TODO(benvanik): lookup binding type from layout. Whether the binding
+    // is dynamic is handled by the bind group cache based on the layout.
     group_binding->type = WGPUBufferBindingType_Storage;
 
     group_binding->buffer =
@@ -851,20 +852,18 @@ static iree_status_t iree_hal_webgpu_command_buffer_prepare_dispatch(
     // set the bind group on the device already - we can skip.
     if (command_buffer->state.bind_groups[i].handle) continue;
 
-    // Acquire the bind group to use for the current descriptor set.
+    // Acquire the bind group to use for the current descriptor set. Storage
+    // buffers declared with dynamic offsets are cached by base buffer and the
+    // offsets are provided when setting the bind group.
+    uint32_t dynamic_offsets[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT];
+    uint32_t dynamic_offset_count = 0;
     WGPUBindGroup handle = iree_hal_webgpu_bind_group_cache_acquire(
         command_buffer->bind_group_cache, binding_info->set_layouts[i],
         command_buffer->state.bind_groups[i].bindings,
-        binding_info->set_masks[i]);
-
-    // NOTE: today we don't support dynamic offsets for push descriptor sets.
-    // This will be a larger change we'll need to handle in the compiler. If we
-    // wanted to improve caching we could make all the bindings dynamic and then
-    // always cache the base offsets, however
-    // maxDynamicStorageBuffersPerPipelineLayout is minimally 4 and that's not
-    // a lot of bindings.
-    wgpuComputePassEncoderSetBindGroup(compute_pass, (uint32_t)i, handle, 0,
-                                       NULL);
+        binding_info->set_masks[i], binding_info->dynamic_masks[i],
+        dynamic_offsets, &dynamic_offset_count);
+    wgpuComputePassEncoderSetBindGroup(compute_pass, (uint32_t)i, handle,
+                                       dynamic_offset_count, dynamic_offsets);
     command_buffer->state.bind_groups[i].handle = handle;
     command_buffer->state.bind_groups_empty &= ~(1ull << i);
   }
@@ -970,22 +969,21 @@ static iree_status_t iree_hal_webgpu_command_buffer_prepare_dispatch(
     group_bindings[i].buffer =
         bindings[i].buffer ? iree_hal_webgpu_buffer_handle(bindings[i].buffer)
                            : NULL;
-    group_bindings[i] offset = bindings[i].offset;
-    group_bindings[i] length = bindings[i].length;
+    group_bindings[i].offset = bindings[i].offset;
+    group_bindings[i].length = bindings[i].length;
   }
 
-  // Acquire the bind group to use for the current descriptor set.
+  // Acquire the bind group to use for the current descriptor set. Storage
+  // buffers declared with dynamic offsets are cached by base buffer and the
+  // offsets are provided when setting the bind group.
+  uint32_t dynamic_offsets[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT];
+  uint32_t dynamic_offset_count = 0;
   WGPUBindGroup handle = iree_hal_webgpu_bind_group_cache_acquire(
-      command_buffer->bind_group_cache, binding_info->set_layout,
-      group_bindings, binding_mask);
-
-  // NOTE: today we don't support dynamic offsets for push descriptor sets.
-  // This will be a larger change we'll need to handle in the compiler. If we
-  // wanted to improve caching we could make all the bindings dynamic and then
-  // always cache the base offsets, however
-  // maxDynamicStorageBuffersPerPipelineLayout is minimally 4 and that's not
-  // a lot of bindings.
-  wgpuComputePassEncoderSetBindGroup(compute_pass, 0, handle, 0, NULL);
+      command_buffer->bind_group_cache, binding_info->set_layouts[0],
+      group_bindings, binding_mask, binding_info->dynamic_masks[0],
+      dynamic_offsets, &dynamic_offset_count);
+  wgpuComputePassEncoderSetBindGroup(compute_pass, 0, handle,
+                                     dynamic_offset_count, dynamic_offsets);
 
   *out_compute_pass = compute_pass;
   return iree_ok_status();
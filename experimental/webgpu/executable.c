@@ -160,51 +160,116 @@ static void iree_hal_webgpu_make_entry_name(uint32_t entry_ordinal,
   }
 }
 
-// TODO(benvanik): switch to async compilation using
-// wgpuDeviceCreateComputePipelineAsync. We pack all pipelines into a single
-// executable (usually) and can batch compilation of all of them and only
-// join at the end. Technically we could extend the join point until first use
-// but it's harder to reason about lifetime that way. Today we just compile
-// them all synchronously.
-static iree_status_t iree_hal_webgpu_create_pipeline(
+// An asynchronous pipeline creation request for a single entry point.
+typedef struct iree_hal_webgpu_pipeline_request_t {
+  // Number of requests that have not yet completed, shared by all requests.
+  iree_host_size_t* pending_count;
+  // Entry point receiving the pipeline on success.
+  iree_hal_webgpu_entry_point_t* entry_point;
+  iree_hal_pipeline_layout_t* pipeline_layout;
+  // Result of the request.
+  iree_status_t status;
+  char entry_name[IREE_HAL_WEBGPU_MAX_ENTRY_NAME_LENGTH];
+} iree_hal_webgpu_pipeline_request_t;
+
+static void iree_hal_webgpu_create_pipeline_callback(
+    WGPUCreatePipelineAsyncStatus status, WGPUComputePipeline pipeline,
+    char const* message, void* userdata) {
+  iree_hal_webgpu_pipeline_request_t* request =
+      (iree_hal_webgpu_pipeline_request_t*)userdata;
+  if (status == WGPUCreatePipelineAsyncStatus_Success && pipeline) {
+    request->entry_point->pipeline = pipeline;
+    request->entry_point->layout = request->pipeline_layout;
+    iree_hal_pipeline_layout_retain(request->pipeline_layout);
+  } else {
+    request->status = iree_make_status(
+        IREE_STATUS_INTERNAL,
+        "wgpuDeviceCreateComputePipelineAsync failed for entry point '%s' "
+        "(%d): %s",
+        request->entry_name, (int)status, message ? message : "");
+  }
+  --*request->pending_count;
+}
+
+// Begins asynchronous creation of the pipeline for |entry_ordinal|. The
+// pipeline is stored into the entry point of |request| and the pending count
+// decremented when the device delivers the result.
+static void iree_hal_webgpu_create_pipeline_async(
     WGPUDevice device, WGPUShaderModule shader_module, uint32_t entry_ordinal,
-    iree_hal_pipeline_layout_t* pipeline_layout,
-    iree_hal_webgpu_entry_point_t* out_entry_point) {
-  IREE_ASSERT_ARGUMENT(shader_module);
-  IREE_ASSERT_ARGUMENT(pipeline_layout);
-  IREE_ASSERT_ARGUMENT(out_entry_point);
+    iree_hal_webgpu_pipeline_request_t* request) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  char entry_name[IREE_HAL_WEBGPU_MAX_ENTRY_NAME_LENGTH] = {0};
-  iree_hal_webgpu_make_entry_name(entry_ordinal, entry_name);
+  iree_hal_webgpu_make_entry_name(entry_ordinal, request->entry_name);
 
   const WGPUComputePipelineDescriptor pipeline_descriptor = {
       .nextInChain = NULL,
-      .label = WGPU_DEBUG_LABEL(entry_name),
-      .layout = iree_hal_webgpu_pipeline_layout_handle(pipeline_layout),
+      .label = WGPU_DEBUG_LABEL(request->entry_name),
+      .layout =
+          iree_hal_webgpu_pipeline_layout_handle(request->pipeline_layout),
       .compute =
           {
               .nextInChain = NULL,
               .module = shader_module,
-              .entryPoint = entry_name,
+              .entryPoint = request->entry_name,
           },
   };
 
-  WGPUComputePipeline pipeline =
-      wgpuDeviceCreateComputePipeline(device, &pipeline_descriptor);
-  iree_status_t status = iree_ok_status();
-  if (!pipeline) {
-    status = iree_make_status(IREE_STATUS_INTERNAL,
-                              "wgpuDeviceCreateComputePipeline "
-                              "failed for entry point '%s'",
-                              entry_name);
+  ++*request->pending_count;
+  wgpuDeviceCreateComputePipelineAsync(device, &pipeline_descriptor,
+                                       iree_hal_webgpu_create_pipeline_callback,
+                                       request);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Creates the pipelines for all entry points of |executable_def| in parallel.
+// Pipeline compilation can be expensive (and on the web blocks the thread
+// creating it) so we issue all of them asynchronously and only join at the end
+// such that implementations can compile them concurrently. Technically we
+// could extend the join point until first use but it's harder to reason about
+// lifetime that way.
+static iree_status_t iree_hal_webgpu_create_pipelines(
+    WGPUDevice device, iree_hal_webgpu_ExecutableDef_table_t executable_def,
+    WGPUShaderModule* shader_modules, iree_host_size_t entry_point_count,
+    iree_hal_pipeline_layout_t* const* pipeline_layouts,
+    iree_allocator_t host_allocator,
+    iree_hal_webgpu_entry_point_t* entry_points) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, entry_point_count);
+
+  iree_hal_webgpu_pipeline_request_t* requests = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator,
+                                entry_point_count * sizeof(*requests),
+                                (void**)&requests));
+
+  // Issue all requests.
+  iree_host_size_t pending_count = 0;
+  flatbuffers_uint32_vec_t entry_points_vec =
+      iree_hal_webgpu_ExecutableDef_entry_points_get(executable_def);
+  for (iree_host_size_t i = 0; i < entry_point_count; ++i) {
+    iree_hal_webgpu_pipeline_request_t* request = &requests[i];
+    request->pending_count = &pending_count;
+    request->entry_point = &entry_points[i];
+    request->pipeline_layout = pipeline_layouts[i];
+    request->status = iree_ok_status();
+    uint32_t module_ordinal = flatbuffers_uint32_vec_at(entry_points_vec, i);
+    iree_hal_webgpu_create_pipeline_async(
+        device, shader_modules[module_ordinal], (uint32_t)i, request);
   }
 
-  if (iree_status_is_ok(status)) {
-    out_entry_point->pipeline = pipeline;
-    out_entry_point->layout = pipeline_layout;
-    iree_hal_pipeline_layout_retain(pipeline_layout);
+  // Join. Callbacks may have been issued inline but otherwise are delivered
+  // while processing device events.
+  while (pending_count > 0) {
+    iree_wgpuDeviceProcessEvents(device);
   }
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < entry_point_count; ++i) {
+    status = iree_status_join(status, requests[i].status);
+  }
+  iree_allocator_free(host_allocator, requests);
+
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -278,15 +343,10 @@ iree_status_t iree_hal_webgpu_executable_create(
         iree_hal_hip_ExecutableDef_source_files_get(executable_def));
 
     // Create one pipeline per entry point.
-    flatbuffers_uint32_vec_t entry_points_vec =
-        iree_hal_webgpu_ExecutableDef_entry_points_get(executable_def);
-    for (iree_host_size_t i = 0; i < executable->entry_point_count; i++) {
-      uint32_t module_ordinal = flatbuffers_uint32_vec_at(entry_points_vec, i);
-      status = iree_hal_webgpu_create_pipeline(
-          device, *iree_inline_array_at(shader_modules, module_ordinal), i,
-          executable_params->pipeline_layouts[i], &executable->entry_points[i]);
-      if (!iree_status_is_ok(status)) break;
-    }
+    status = iree_hal_webgpu_create_pipelines(
+        device, executable_def, iree_inline_array_data(shader_modules),
+        executable->entry_point_count, executable_params->pipeline_layouts,
+        host_allocator, executable->entry_points);
   }
 
   for (size_t i = 0; i < shader_module_count; ++i) {
@@ -312,6 +372,8 @@ static void iree_hal_webgpu_executable_destroy(
 
   for (iree_host_size_t i = 0; i < executable->entry_point_count; i++) {
     iree_hal_webgpu_entry_point_t* entry_point = &executable->entry_points[i];
+    // Entry points are only populated if their pipeline was created.
+    if (!entry_point->pipeline) continue;
     iree_hal_pipeline_layout_release(entry_point->layout);
     iree_wgpuComputePipelineDrop(entry_point->pipeline);
   }
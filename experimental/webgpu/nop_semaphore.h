@@ -1,27 +0,0 @@
-// Copyright 2021 The IREE Authors
-//
-// Licensed under the Apache License v2.0 with LLVM Exceptions.
-// See https://llvm.org/LICENSE.txt for license information.
-// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
-
-#ifndef IREE_HAL_DRIVERS_WEBGPU_NOP_SEMAPHORE_H_
-#define IREE_HAL_DRIVERS_WEBGPU_NOP_SEMAPHORE_H_
-
-#include <stdint.h>
-
-#include "iree/base/api.h"
-#include "iree/hal/api.h"
-
-#ifdef __cplusplus
-extern "C" {
-#endif  // __cplusplus
-
-iree_status_t iree_hal_webgpu_nop_semaphore_create(
-    uint64_t initial_value, iree_allocator_t host_allocator,
-    iree_hal_semaphore_t** out_semaphore);
-
-#ifdef __cplusplus
-}  // extern "C"
-#endif  // __cplusplus
-
-#endif  // IREE_HAL_DRIVERS_WEBGPU_NOP_SEMAPHORE_H_
@@ -10,6 +10,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/inline_array.h"
+#include "iree/base/internal/math.h"
 
 //===----------------------------------------------------------------------===//
 // iree_hal_webgpu_descriptor_set_layout_t
@@ -20,6 +21,7 @@ typedef struct iree_hal_webgpu_descriptor_set_layout_t {
   iree_allocator_t host_allocator;
   WGPUBindGroupLayout handle;
   iree_hal_webgpu_binding_mask_t binding_mask;
+  iree_hal_webgpu_binding_mask_t dynamic_mask;
 } iree_hal_webgpu_descriptor_set_layout_t;
 
 extern const iree_hal_descriptor_set_layout_vtable_t
@@ -48,6 +50,8 @@ iree_status_t iree_hal_webgpu_descriptor_set_layout_create(
   iree_inline_array(WGPUBindGroupLayoutEntry, entries, binding_count,
                     host_allocator);
   iree_hal_webgpu_binding_mask_t binding_mask = 0;
+  iree_hal_webgpu_binding_mask_t dynamic_mask = 0;
+  iree_host_size_t dynamic_count = 0;
   for (iree_host_size_t i = 0; i < binding_count; ++i) {
     if (bindings[i].binding >=
         IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT) {
@@ -61,12 +65,19 @@ iree_status_t iree_hal_webgpu_descriptor_set_layout_create(
     }
     binding_mask |= 1u << bindings[i].binding;
 
-    // TODO(benvanik): make all dynamic? this would let us reuse bind groups.
+    // Storage buffers use dynamic offsets (up to the implementation limit) so
+    // that bind groups can be cached independently of the offsets and reused
+    // across all sub-allocations from the same base buffer.
     WGPUBufferBindingType binding_type = WGPUBufferBindingType_Undefined;
     bool has_dynamic_offset = false;
     switch (bindings[i].type) {
       case IREE_HAL_DESCRIPTOR_TYPE_STORAGE_BUFFER:
         binding_type = WGPUBufferBindingType_Storage;
+        if (dynamic_count < IREE_HAL_WEBGPU_MAX_DYNAMIC_STORAGE_BUFFER_COUNT) {
+          has_dynamic_offset = true;
+          dynamic_mask |= 1u << bindings[i].binding;
+          ++dynamic_count;
+        }
         break;
       case IREE_HAL_DESCRIPTOR_TYPE_UNIFORM_BUFFER:
         binding_type = WGPUBufferBindingType_Uniform;
@@ -110,6 +121,7 @@ iree_status_t iree_hal_webgpu_descriptor_set_layout_create(
     descriptor_set_layout->host_allocator = host_allocator;
     descriptor_set_layout->handle = handle;
     descriptor_set_layout->binding_mask = binding_mask;
+    descriptor_set_layout->dynamic_mask = dynamic_mask;
     *out_descriptor_set_layout =
         (iree_hal_descriptor_set_layout_t*)descriptor_set_layout;
   } else {
@@ -146,6 +158,13 @@ iree_hal_webgpu_descriptor_set_layout_binding_mask(
   return iree_hal_webgpu_descriptor_set_layout_cast(layout)->binding_mask;
 }
 
+iree_hal_webgpu_binding_mask_t
+iree_hal_webgpu_descriptor_set_layout_dynamic_mask(
+    iree_hal_descriptor_set_layout_t* layout) {
+  IREE_ASSERT_ARGUMENT(layout);
+  return iree_hal_webgpu_descriptor_set_layout_cast(layout)->dynamic_mask;
+}
+
 const iree_hal_descriptor_set_layout_vtable_t
     iree_hal_webgpu_descriptor_set_layout_vtable = {
         .destroy = iree_hal_webgpu_descriptor_set_layout_destroy,
@@ -196,6 +215,24 @@ iree_status_t iree_hal_webgpu_pipeline_layout_create(
         IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX);
   }
 
+  // Dynamic offset limits apply to the pipeline layout as a whole while each
+  // set layout assigns them independently; layouts spreading more dynamic
+  // storage buffers than the limit across multiple sets are rejected.
+  iree_host_size_t dynamic_count = 0;
+  for (iree_host_size_t i = 0; i < set_layout_count; ++i) {
+    dynamic_count += iree_math_count_ones_u32(
+        iree_hal_webgpu_descriptor_set_layout_dynamic_mask(set_layouts[i]));
+  }
+  if (dynamic_count > IREE_HAL_WEBGPU_MAX_DYNAMIC_STORAGE_BUFFER_COUNT) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "pipeline layout uses %" PRIhsz
+        " storage buffers with dynamic offsets across all sets; at most %d "
+        "are supported",
+        dynamic_count, IREE_HAL_WEBGPU_MAX_DYNAMIC_STORAGE_BUFFER_COUNT);
+  }
+
   // Pad to IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX for push constant emulation.
   iree_host_size_t bind_group_layouts_count =
       constant_count > 0 ? IREE_HAL_WEBGPU_PARAMS_BIND_GROUP_INDEX + 1
@@ -258,6 +295,8 @@ iree_status_t iree_hal_webgpu_pipeline_layout_create(
           iree_hal_webgpu_descriptor_set_layout_handle(set_layouts[i]);
       pipeline_layout->set_binding_info.set_masks[i] =
           iree_hal_webgpu_descriptor_set_layout_binding_mask(set_layouts[i]);
+      pipeline_layout->set_binding_info.dynamic_masks[i] =
+          iree_hal_webgpu_descriptor_set_layout_dynamic_mask(set_layouts[i]);
     }
     // Note: not tracking the empty/padding layout or the staging buffer layout.
 
@@ -28,6 +28,11 @@ extern "C" {
 // that's what our compiler is assuming.
 #define IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT 8
 
+// Maximum number of storage buffer bindings with dynamic offsets across all
+// bind groups of a pipeline layout. This is the minimum
+// maxDynamicStorageBuffersPerPipelineLayout required of all implementations.
+#define IREE_HAL_WEBGPU_MAX_DYNAMIC_STORAGE_BUFFER_COUNT 4
+
 typedef uint32_t iree_hal_webgpu_binding_mask_t;
 static_assert(sizeof(iree_hal_webgpu_binding_mask_t) * 8 >=
                   IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_BINDING_COUNT,
@@ -47,6 +52,11 @@ iree_hal_webgpu_binding_mask_t
 iree_hal_webgpu_descriptor_set_layout_binding_mask(
     iree_hal_descriptor_set_layout_t* layout);
 
+// Returns a mask of the bindings declared with dynamic offsets.
+iree_hal_webgpu_binding_mask_t
+iree_hal_webgpu_descriptor_set_layout_dynamic_mask(
+    iree_hal_descriptor_set_layout_t* layout);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_webgpu_pipeline_layout_t
 //===----------------------------------------------------------------------===//
@@ -56,6 +66,9 @@ typedef struct iree_hal_webgpu_set_binding_info_t {
   WGPUBindGroupLayout set_layouts[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_COUNT];
   iree_hal_webgpu_binding_mask_t
       set_masks[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_COUNT];
+  // Subset of each set mask with bindings declared with dynamic offsets.
+  iree_hal_webgpu_binding_mask_t
+      dynamic_masks[IREE_HAL_WEBGPU_MAX_DESCRIPTOR_SET_COUNT];
 } iree_hal_webgpu_set_binding_info_t;
 
 iree_status_t iree_hal_webgpu_pipeline_layout_create(
@@ -4,6 +4,8 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <emscripten.h>
+
 #include "experimental/webgpu/platform/webgpu.h"
 
 //===----------------------------------------------------------------------===//
@@ -52,3 +54,9 @@ void iree_wgpuQuerySetDrop(WGPUQuerySet querySet) {
 void iree_wgpuShaderModuleDrop(WGPUShaderModule shaderModule) {
   // Not implemented on the web / Emscripten.
 }
+
+void iree_wgpuDeviceProcessEvents(WGPUDevice device) {
+  // Callbacks are delivered by the browser event loop so all we can do is
+  // yield to it. This requires Asyncify.
+  emscripten_sleep(0);
+}
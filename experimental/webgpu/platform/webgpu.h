@@ -54,6 +54,12 @@ void iree_wgpuPipelineLayoutDrop(WGPUPipelineLayout pipelineLayout);
 void iree_wgpuQuerySetDrop(WGPUQuerySet querySet);
 void iree_wgpuShaderModuleDrop(WGPUShaderModule shaderModule);
 
+// Processes pending device events such as queue work done notifications and
+// asynchronous pipeline creation callbacks. Used by blocking host waits to
+// make forward progress: native implementations tick the device while on the
+// web this yields to the browser event loop (and requires Asyncify).
+void iree_wgpuDeviceProcessEvents(WGPUDevice device);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
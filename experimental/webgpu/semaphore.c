@@ -0,0 +1,246 @@
+// Copyright 2021 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "experimental/webgpu/semaphore.h"
+
+#include <stddef.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+
+typedef struct iree_hal_webgpu_semaphore_t {
+  iree_hal_resource_t resource;
+  iree_allocator_t host_allocator;
+
+  // Device whose events are processed while waiting on the host.
+  WGPUDevice device;
+
+  // Guards all fields below. Timepoint callbacks are issued outside of the
+  // lock so that they may signal or wait on other semaphores.
+  iree_slim_mutex_t mutex;
+
+  // Current payload value. Monotonically increasing until failed.
+  uint64_t current_value;
+
+  // Sticky failure status set by iree_hal_semaphore_fail.
+  iree_status_t failure_status;
+
+  // Pending timepoints in registration order.
+  iree_hal_webgpu_timepoint_t* timepoint_head;
+} iree_hal_webgpu_semaphore_t;
+
+extern const iree_hal_semaphore_vtable_t iree_hal_webgpu_semaphore_vtable;
+
+static iree_hal_webgpu_semaphore_t* iree_hal_webgpu_semaphore_cast(
+    iree_hal_semaphore_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value, &iree_hal_webgpu_semaphore_vtable);
+  return (iree_hal_webgpu_semaphore_t*)base_value;
+}
+
+iree_status_t iree_hal_webgpu_semaphore_create(
+    WGPUDevice device, uint64_t initial_value, iree_allocator_t host_allocator,
+    iree_hal_semaphore_t** out_semaphore) {
+  IREE_ASSERT_ARGUMENT(device);
+  IREE_ASSERT_ARGUMENT(out_semaphore);
+  *out_semaphore = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_webgpu_semaphore_t* semaphore = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*semaphore), (void**)&semaphore);
+  if (iree_status_is_ok(status)) {
+    iree_hal_resource_initialize(&iree_hal_webgpu_semaphore_vtable,
+                                 &semaphore->resource);
+    semaphore->host_allocator = host_allocator;
+    semaphore->device = device;
+    iree_slim_mutex_initialize(&semaphore->mutex);
+    semaphore->current_value = initial_value;
+    semaphore->failure_status = iree_ok_status();
+    semaphore->timepoint_head = NULL;
+    *out_semaphore = (iree_hal_semaphore_t*)semaphore;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_webgpu_semaphore_destroy(
+    iree_hal_semaphore_t* base_semaphore) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  iree_allocator_t host_allocator = semaphore->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Submissions retain the semaphores they wait on so there should be no
+  // pending timepoints by the time the last reference is dropped.
+  IREE_ASSERT(!semaphore->timepoint_head);
+  iree_status_ignore(semaphore->failure_status);
+  iree_slim_mutex_deinitialize(&semaphore->mutex);
+  iree_allocator_free(host_allocator, semaphore);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_hal_webgpu_semaphore_isa(iree_hal_semaphore_t* semaphore) {
+  return iree_hal_resource_is(semaphore, &iree_hal_webgpu_semaphore_vtable);
+}
+
+static iree_status_t iree_hal_webgpu_semaphore_query(
+    iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  iree_slim_mutex_lock(&semaphore->mutex);
+  *out_value = semaphore->current_value;
+  iree_status_t status = iree_status_clone(semaphore->failure_status);
+  iree_slim_mutex_unlock(&semaphore->mutex);
+  return status;
+}
+
+// Issues the callbacks of all timepoints in the detached |list| with |status|.
+// Takes ownership of |status|.
+static void iree_hal_webgpu_semaphore_issue_timepoints(
+    iree_hal_webgpu_timepoint_t* list, iree_status_t status) {
+  while (list) {
+    iree_hal_webgpu_timepoint_t* timepoint = list;
+    list = timepoint->next;
+    timepoint->next = NULL;
+    timepoint->fn(timepoint->user_data, iree_status_clone(status));
+  }
+  iree_status_ignore(status);
+}
+
+void iree_hal_webgpu_semaphore_acquire_timepoint(
+    iree_hal_semaphore_t* base_semaphore, uint64_t minimum_value,
+    iree_hal_webgpu_timepoint_fn_t fn, void* user_data,
+    iree_hal_webgpu_timepoint_t* timepoint) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  timepoint->next = NULL;
+  timepoint->minimum_value = minimum_value;
+  timepoint->fn = fn;
+  timepoint->user_data = user_data;
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    iree_status_t status = iree_status_clone(semaphore->failure_status);
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    fn(user_data, status);
+    return;
+  } else if (semaphore->current_value >= minimum_value) {
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    fn(user_data, iree_ok_status());
+    return;
+  }
+  iree_hal_webgpu_timepoint_t** tail = &semaphore->timepoint_head;
+  while (*tail) tail = &(*tail)->next;
+  *tail = timepoint;
+  iree_slim_mutex_unlock(&semaphore->mutex);
+}
+
+static iree_status_t iree_hal_webgpu_semaphore_signal(
+    iree_hal_semaphore_t* base_semaphore, uint64_t new_value) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    // Signaling a failed semaphore is a no-op; the failure is sticky.
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_ok_status();
+  } else if (new_value <= semaphore->current_value) {
+    uint64_t current_value = semaphore->current_value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "semaphore values must be monotonically "
+                            "increasing; current_value=%" PRIu64
+                            ", new_value=%" PRIu64,
+                            current_value, new_value);
+  }
+  semaphore->current_value = new_value;
+
+  // Detach all timepoints that have been reached.
+  iree_hal_webgpu_timepoint_t* ready_head = NULL;
+  iree_hal_webgpu_timepoint_t** ready_tail = &ready_head;
+  iree_hal_webgpu_timepoint_t** it = &semaphore->timepoint_head;
+  while (*it) {
+    iree_hal_webgpu_timepoint_t* timepoint = *it;
+    if (timepoint->minimum_value <= new_value) {
+      *it = timepoint->next;
+      timepoint->next = NULL;
+      *ready_tail = timepoint;
+      ready_tail = &timepoint->next;
+    } else {
+      it = &timepoint->next;
+    }
+  }
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  iree_hal_webgpu_semaphore_issue_timepoints(ready_head, iree_ok_status());
+  return iree_ok_status();
+}
+
+static void iree_hal_webgpu_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
+                                           iree_status_t status) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+
+  iree_slim_mutex_lock(&semaphore->mutex);
+  if (!iree_status_is_ok(semaphore->failure_status)) {
+    // Only the first failure is retained.
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    iree_status_ignore(status);
+    return;
+  }
+  semaphore->failure_status = status;
+  semaphore->current_value = IREE_HAL_SEMAPHORE_FAILURE_VALUE;
+  iree_hal_webgpu_timepoint_t* failed_head = semaphore->timepoint_head;
+  semaphore->timepoint_head = NULL;
+  iree_status_t timepoint_status = iree_status_clone(status);
+  iree_slim_mutex_unlock(&semaphore->mutex);
+
+  iree_hal_webgpu_semaphore_issue_timepoints(failed_head, timepoint_status);
+}
+
+static iree_status_t iree_hal_webgpu_semaphore_wait(
+    iree_hal_semaphore_t* base_semaphore, uint64_t value,
+    iree_timeout_t timeout) {
+  iree_hal_webgpu_semaphore_t* semaphore =
+      iree_hal_webgpu_semaphore_cast(base_semaphore);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Completion notifications are only delivered when the device processes its
+  // events so we pump them until the payload is reached. On the web this
+  // yields to the browser event loop.
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    iree_slim_mutex_lock(&semaphore->mutex);
+    uint64_t current_value = semaphore->current_value;
+    bool has_failed = !iree_status_is_ok(semaphore->failure_status);
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    if (has_failed) {
+      status = iree_status_from_code(IREE_STATUS_ABORTED);
+      break;
+    } else if (current_value >= value) {
+      break;
+    } else if (iree_time_now() >= deadline_ns) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    iree_wgpuDeviceProcessEvents(semaphore->device);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+const iree_hal_semaphore_vtable_t iree_hal_webgpu_semaphore_vtable = {
+    .destroy = iree_hal_webgpu_semaphore_destroy,
+    .query = iree_hal_webgpu_semaphore_query,
+    .signal = iree_hal_webgpu_semaphore_signal,
+    .fail = iree_hal_webgpu_semaphore_fail,
+    .wait = iree_hal_webgpu_semaphore_wait,
+};
@@ -0,0 +1,71 @@
+// Copyright 2021 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_WEBGPU_SEMAPHORE_H_
+#define IREE_HAL_DRIVERS_WEBGPU_SEMAPHORE_H_
+
+#include <stdint.h>
+
+#include "experimental/webgpu/platform/webgpu.h"
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_timepoint_t
+//===----------------------------------------------------------------------===//
+
+// Callback issued when a timepoint is reached or the semaphore fails.
+// |status| is OK when the semaphore reached the timepoint payload value and
+// otherwise a failure status owned by the callee.
+typedef void(IREE_API_PTR* iree_hal_webgpu_timepoint_fn_t)(
+    void* user_data, iree_status_t status);
+
+// A pending callback on a semaphore payload value.
+// Storage is owned by the caller and must remain valid until the callback has
+// been issued.
+typedef struct iree_hal_webgpu_timepoint_t {
+  struct iree_hal_webgpu_timepoint_t* next;
+  uint64_t minimum_value;
+  iree_hal_webgpu_timepoint_fn_t fn;
+  void* user_data;
+} iree_hal_webgpu_timepoint_t;
+
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_semaphore_t
+//===----------------------------------------------------------------------===//
+
+// Creates a timeline semaphore emulated on the host.
+//
+// WebGPU has no semaphores and only notifies the host when all work submitted
+// to a queue has completed (GPUQueue.onSubmittedWorkDone). Device submissions
+// signal their semaphores from that notification and submissions waiting on
+// semaphores not yet signaled are deferred via timepoints until they are.
+// Host waits pump |device| events until the payload is reached so that the
+// notifications are delivered.
+iree_status_t iree_hal_webgpu_semaphore_create(
+    WGPUDevice device, uint64_t initial_value, iree_allocator_t host_allocator,
+    iree_hal_semaphore_t** out_semaphore);
+
+// Returns true if |semaphore| is a WebGPU semaphore.
+bool iree_hal_webgpu_semaphore_isa(iree_hal_semaphore_t* semaphore);
+
+// Registers |timepoint| to have its callback issued once |semaphore| reaches
+// |minimum_value| or fails. If the payload value has already been reached (or
+// the semaphore has already failed) the callback is issued before returning.
+void iree_hal_webgpu_semaphore_acquire_timepoint(
+    iree_hal_semaphore_t* semaphore, uint64_t minimum_value,
+    iree_hal_webgpu_timepoint_fn_t fn, void* user_data,
+    iree_hal_webgpu_timepoint_t* timepoint);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_WEBGPU_SEMAPHORE_H_
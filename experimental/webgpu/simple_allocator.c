@@ -90,6 +90,15 @@ static void iree_hal_webgpu_simple_allocator_query_statistics(
   });
 }
 
+static void iree_hal_webgpu_simple_allocator_reset_capture_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  IREE_STATISTICS({
+    iree_hal_webgpu_simple_allocator_t* allocator =
+        iree_hal_webgpu_simple_allocator_cast(base_allocator);
+    iree_hal_allocator_statistics_reset_capture(&allocator->statistics);
+  });
+}
+
 static iree_hal_buffer_compatibility_t
 iree_hal_webgpu_simple_allocator_query_buffer_compatibility(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
@@ -248,6 +257,8 @@ const iree_hal_allocator_vtable_t iree_hal_webgpu_simple_allocator_vtable = {
     .host_allocator = iree_hal_webgpu_simple_allocator_host_allocator,
     .trim = iree_hal_webgpu_simple_allocator_trim,
     .query_statistics = iree_hal_webgpu_simple_allocator_query_statistics,
+    .reset_capture_statistics =
+        iree_hal_webgpu_simple_allocator_reset_capture_statistics,
     .query_buffer_compatibility =
         iree_hal_webgpu_simple_allocator_query_buffer_compatibility,
     .allocate_buffer = iree_hal_webgpu_simple_allocator_allocate_buffer,
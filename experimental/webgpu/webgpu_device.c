@@ -15,8 +15,8 @@
 #include "experimental/webgpu/command_buffer.h"
 #include "experimental/webgpu/nop_event.h"
 #include "experimental/webgpu/nop_executable_cache.h"
-#include "experimental/webgpu/nop_semaphore.h"
 #include "experimental/webgpu/pipeline_layout.h"
+#include "experimental/webgpu/semaphore.h"
 #include "experimental/webgpu/simple_allocator.h"
 #include "experimental/webgpu/staging_buffer.h"
 #include "iree/base/internal/arena.h"
@@ -309,14 +309,19 @@ static iree_status_t iree_hal_webgpu_device_create_semaphore(
     iree_hal_device_t* base_device, uint64_t initial_value,
     iree_hal_semaphore_flags_t flags, iree_hal_semaphore_t** out_semaphore) {
   iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
-  return iree_hal_webgpu_nop_semaphore_create(
-      initial_value, device->host_allocator, out_semaphore);
+  return iree_hal_webgpu_semaphore_create(
+      device->handle, initial_value, device->host_allocator, out_semaphore);
 }
 
 static iree_hal_semaphore_compatibility_t
 iree_hal_webgpu_device_query_semaphore_compatibility(
     iree_hal_device_t* base_device, iree_hal_semaphore_t* semaphore) {
-  // TODO(benvanik): implement webgpu semaphores.
+  if (iree_hal_webgpu_semaphore_isa(semaphore)) {
+    // Our own semaphores can be waited on and signaled by the queue without
+    // blocking the host.
+    return IREE_HAL_SEMAPHORE_COMPATIBILITY_ALL;
+  }
+  // For now we support waiting on other semaphores only from the host.
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
@@ -392,6 +397,174 @@ static iree_status_t iree_hal_webgpu_device_queue_write(
   return loop_status;
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hal_webgpu_submission_t
+//===----------------------------------------------------------------------===//
+
+// A queue submission deferred until all of its waits have been satisfied and
+// then tracked until the device reports the submitted work as done.
+//
+// WebGPU only has a single queue that executes work in submission order and
+// the only completion notification is GPUQueue.onSubmittedWorkDone so we use
+// it to emulate timeline semaphore signals: once the command buffer has been
+// issued we register a callback that signals (or fails) the semaphores.
+typedef struct iree_hal_webgpu_submission_t {
+  iree_hal_webgpu_device_t* device;
+  iree_hal_command_buffer_t* command_buffer;
+  // Number of waits outstanding plus one for the submission itself.
+  iree_host_size_t pending_wait_count;
+  // Joined failure status of all waits.
+  iree_status_t wait_status;
+  iree_hal_semaphore_list_t wait_semaphore_list;
+  iree_hal_semaphore_list_t signal_semaphore_list;
+  // One timepoint per wait semaphore.
+  iree_hal_webgpu_timepoint_t* timepoints;
+} iree_hal_webgpu_submission_t;
+
+static void iree_hal_webgpu_submission_destroy(
+    iree_hal_webgpu_submission_t* submission) {
+  iree_hal_webgpu_device_t* device = submission->device;
+  iree_allocator_t host_allocator = device->host_allocator;
+  for (iree_host_size_t i = 0; i < submission->wait_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_release(submission->wait_semaphore_list.semaphores[i]);
+  }
+  for (iree_host_size_t i = 0; i < submission->signal_semaphore_list.count;
+       ++i) {
+    iree_hal_semaphore_release(submission->signal_semaphore_list.semaphores[i]);
+  }
+  iree_hal_command_buffer_release(submission->command_buffer);
+  iree_status_ignore(submission->wait_status);
+  iree_allocator_free(host_allocator, submission);
+  iree_hal_device_release((iree_hal_device_t*)device);
+}
+
+// Copies |source| into |target_semaphores| and |target_payload_values| and
+// retains the semaphores.
+static iree_hal_semaphore_list_t iree_hal_webgpu_submission_clone_list(
+    const iree_hal_semaphore_list_t source,
+    iree_hal_semaphore_t** target_semaphores,
+    uint64_t* target_payload_values) {
+  for (iree_host_size_t i = 0; i < source.count; ++i) {
+    target_semaphores[i] = source.semaphores[i];
+    iree_hal_semaphore_retain(target_semaphores[i]);
+    target_payload_values[i] = source.payload_values[i];
+  }
+  iree_hal_semaphore_list_t list = {
+      .count = source.count,
+      .semaphores = target_semaphores,
+      .payload_values = target_payload_values,
+  };
+  return list;
+}
+
+static iree_status_t iree_hal_webgpu_submission_create(
+    iree_hal_webgpu_device_t* device,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_webgpu_submission_t** out_submission) {
+  *out_submission = NULL;
+
+  iree_hal_webgpu_submission_t* submission = NULL;
+  iree_host_size_t semaphore_count =
+      wait_semaphore_list.count + signal_semaphore_list.count;
+  iree_host_size_t total_size =
+      sizeof(*submission) +
+      semaphore_count * (sizeof(iree_hal_semaphore_t*) + sizeof(uint64_t)) +
+      wait_semaphore_list.count * sizeof(iree_hal_webgpu_timepoint_t);
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      device->host_allocator, total_size, (void**)&submission));
+
+  submission->device = device;
+  iree_hal_device_retain((iree_hal_device_t*)device);
+  submission->command_buffer = command_buffer;
+  iree_hal_command_buffer_retain(command_buffer);
+  submission->pending_wait_count = wait_semaphore_list.count + 1;
+  submission->wait_status = iree_ok_status();
+
+  // Timepoints first as they have the largest alignment requirements.
+  uint8_t* ptr = (uint8_t*)submission + sizeof(*submission);
+  submission->timepoints = (iree_hal_webgpu_timepoint_t*)ptr;
+  ptr += wait_semaphore_list.count * sizeof(iree_hal_webgpu_timepoint_t);
+  uint64_t* payload_values = (uint64_t*)ptr;
+  ptr += semaphore_count * sizeof(uint64_t);
+  iree_hal_semaphore_t** semaphores = (iree_hal_semaphore_t**)ptr;
+  submission->wait_semaphore_list = iree_hal_webgpu_submission_clone_list(
+      wait_semaphore_list, semaphores, payload_values);
+  submission->signal_semaphore_list = iree_hal_webgpu_submission_clone_list(
+      signal_semaphore_list, semaphores + wait_semaphore_list.count,
+      payload_values + wait_semaphore_list.count);
+
+  *out_submission = submission;
+  return iree_ok_status();
+}
+
+static void iree_hal_webgpu_submission_work_done(WGPUQueueWorkDoneStatus status,
+                                                 void* userdata) {
+  iree_hal_webgpu_submission_t* submission =
+      (iree_hal_webgpu_submission_t*)userdata;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (status == WGPUQueueWorkDoneStatus_Success) {
+    iree_status_t signal_status =
+        iree_hal_semaphore_list_signal(submission->signal_semaphore_list);
+    if (!iree_status_is_ok(signal_status)) {
+      iree_hal_semaphore_list_fail(submission->signal_semaphore_list,
+                                   signal_status);
+    }
+  } else {
+    iree_hal_semaphore_list_fail(
+        submission->signal_semaphore_list,
+        iree_make_status(IREE_STATUS_INTERNAL,
+                         "queue submission failed with status %d",
+                         (int)status));
+  }
+  iree_hal_webgpu_submission_destroy(submission);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Issues |submission| to the queue once all waits have been satisfied.
+// On failure the signal semaphores are failed and the submission is destroyed.
+static iree_status_t iree_hal_webgpu_submission_issue(
+    iree_hal_webgpu_submission_t* submission) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_t status = submission->wait_status;
+  submission->wait_status = iree_ok_status();
+  if (iree_status_is_ok(status) && submission->command_buffer) {
+    status = iree_hal_webgpu_command_buffer_issue(submission->command_buffer,
+                                                  submission->device->queue);
+  }
+  if (iree_status_is_ok(status)) {
+    wgpuQueueOnSubmittedWorkDone(submission->device->queue,
+                                 iree_hal_webgpu_submission_work_done,
+                                 submission);
+  } else {
+    iree_hal_semaphore_list_fail(submission->signal_semaphore_list,
+                                 iree_status_clone(status));
+    iree_hal_webgpu_submission_destroy(submission);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Marks one wait of |submission| as resolved with |status| and issues the
+// submission if it was the last. Returns the issue status if issued.
+static iree_status_t iree_hal_webgpu_submission_resolve_wait(
+    iree_hal_webgpu_submission_t* submission, iree_status_t status) {
+  submission->wait_status = iree_status_join(submission->wait_status, status);
+  if (--submission->pending_wait_count > 0) return iree_ok_status();
+  return iree_hal_webgpu_submission_issue(submission);
+}
+
+static void iree_hal_webgpu_submission_timepoint_reached(void* user_data,
+                                                         iree_status_t status) {
+  iree_hal_webgpu_submission_t* submission =
+      (iree_hal_webgpu_submission_t*)user_data;
+  // Issue failures are propagated to the signal semaphores.
+  iree_status_ignore(
+      iree_hal_webgpu_submission_resolve_wait(submission, status));
+}
+
 static iree_status_t iree_hal_webgpu_device_queue_execute(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -399,22 +572,51 @@ static iree_status_t iree_hal_webgpu_device_queue_execute(
     iree_hal_command_buffer_t* command_buffer,
     iree_hal_buffer_binding_table_t binding_table) {
   iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
 
-  // TODO(benvanik): this currently assumes we are synchronizing on semaphores
-  // and that any passed in to wait on will already be signaled. This would need
-  // to change a bit to properly support waiting on host-signaled semaphores.
-  // All work is ordered against the WebGPU queues and there's only one queue so
-  // there's really not much to do.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
+  // Semaphores from other devices can only be waited on from the host. All
+  // work is ordered against the single WebGPU queue so there is no need to
+  // wait for our own semaphores: submissions waiting on them are deferred
+  // until they are signaled by prior submissions or the host.
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = wait_semaphore_list.semaphores[i];
+    if (iree_hal_webgpu_semaphore_isa(semaphore)) continue;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_semaphore_wait(semaphore,
+                                    wait_semaphore_list.payload_values[i],
+                                    iree_infinite_timeout()));
+  }
 
-  // TODO(benvanik): propagate errors to semaphores.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_webgpu_command_buffer_issue(command_buffer, device->queue));
+  iree_hal_webgpu_submission_t* submission = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_webgpu_submission_create(device, wait_semaphore_list,
+                                            signal_semaphore_list,
+                                            command_buffer, &submission));
+
+  // Register a timepoint for each wait; those already reached resolve inline.
+  // The submission holds one extra pending wait so that it cannot be issued
+  // before all timepoints have been registered.
+  iree_hal_semaphore_list_t waits = submission->wait_semaphore_list;
+  for (iree_host_size_t i = 0; i < waits.count; ++i) {
+    if (!iree_hal_webgpu_semaphore_isa(waits.semaphores[i])) {
+      // Already waited on above.
+      iree_status_ignore(iree_hal_webgpu_submission_resolve_wait(
+          submission, iree_ok_status()));
+      continue;
+    }
+    iree_hal_webgpu_semaphore_acquire_timepoint(
+        waits.semaphores[i], waits.payload_values[i],
+        iree_hal_webgpu_submission_timepoint_reached, submission,
+        &submission->timepoints[i]);
+  }
 
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
+  // If all waits were already satisfied this issues the submission and
+  // returns any error encountered while doing so.
+  iree_status_t status =
+      iree_hal_webgpu_submission_resolve_wait(submission, iree_ok_status());
 
-  return iree_ok_status();
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_webgpu_device_queue_flush(
@@ -426,9 +628,38 @@ static iree_status_t iree_hal_webgpu_device_queue_flush(
 static iree_status_t iree_hal_webgpu_device_wait_semaphores(
     iree_hal_device_t* base_device, iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout) {
-  return iree_make_status(
-      IREE_STATUS_UNIMPLEMENTED,
-      "iree_hal_webgpu_device_wait_semaphores not yet implemented");
+  iree_hal_webgpu_device_t* device = iree_hal_webgpu_device_cast(base_device);
+  if (wait_mode == IREE_HAL_WAIT_MODE_ALL || semaphore_list.count <= 1) {
+    return iree_hal_semaphore_list_wait(semaphore_list, timeout);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Wait-any: poll until one semaphore reaches its payload value, processing
+  // device events between polls so that queue completions are delivered.
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status)) {
+    bool any_reached = false;
+    for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+      uint64_t current_value = 0;
+      status = iree_hal_semaphore_query(semaphore_list.semaphores[i],
+                                        &current_value);
+      if (!iree_status_is_ok(status)) break;
+      if (current_value >= semaphore_list.payload_values[i]) {
+        any_reached = true;
+        break;
+      }
+    }
+    if (!iree_status_is_ok(status) || any_reached) break;
+    if (iree_time_now() >= deadline_ns) {
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    }
+    iree_wgpuDeviceProcessEvents(device->handle);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_webgpu_device_profiling_begin(
@@ -7,9 +7,11 @@
 #include "./hal.h"
 
 #include <nanobind/nanobind.h>
+#include <nanobind/stl/pair.h>
 #include <nanobind/stl/vector.h>
 
 #include <optional>
+#include <type_traits>
 
 #include "./local_dlpack.h"
 #include "./numpy_interop.h"
@@ -25,6 +27,23 @@ namespace python {
 
 namespace {
 
+static const char kHalDeviceCreateDLPackCapsule[] =
+    R"(Exports a buffer view as a DLPack capsule without copying.
+
+Args:
+  buffer_view: The buffer view to export. The backing buffer is retained
+    until the consumer releases the managed tensor.
+  device_type_code: DLPack `DLDeviceType` of the memory.
+  device_id: DLPack device index of the memory.
+  versioned: Whether to export a DLPack 1.0 `dltensor_versioned` capsule
+    instead of a legacy `dltensor` capsule.
+  wait_fence: Optional HalFence signaled when the buffer contents are
+    available. It is waited on before the capsule is returned.
+
+Returns:
+  PyCapsule.
+)";
+
 static const char kHalDeviceQueueAlloca[] =
     R"(Reserves and returns a device-local queue-ordered transient buffer.
 
@@ -624,49 +643,75 @@ void HalDevice::QueueCopy(HalBuffer& source_buffer, HalBuffer& target_buffer,
       "Copying buffer on queue");
 }
 
-py::object HalDevice::CreateDLPackCapsule(HalBufferView& buffer_view,
-                                          int device_type_code, int device_id) {
-  const size_t kStaticDimLimit = 6;
-  struct ExtDLManagedTensor : public DLManagedTensor {
-    ~ExtDLManagedTensor() {
-      if (retained_buffer) {
-        iree_hal_buffer_release(retained_buffer);
-      }
-      if (dl_tensor.ndim > kStaticDimLimit) {
-        delete[] dim_storage.dynamic_shape;
-      }
+namespace {
+
+// Capsule names defined by the DLPack Python specification for the legacy and
+// versioned (DLPack >= 1.0) managed tensors. Consumers rename the capsule to
+// the "used_" variant when they take ownership of the managed tensor.
+template <typename ManagedTensorT>
+struct DLPackCapsuleTraits;
+template <>
+struct DLPackCapsuleTraits<DLManagedTensor> {
+  static constexpr const char* kName = "dltensor";
+  static constexpr const char* kUsedName = "used_dltensor";
+};
+template <>
+struct DLPackCapsuleTraits<DLManagedTensorVersioned> {
+  static constexpr const char* kName = "dltensor_versioned";
+  static constexpr const char* kUsedName = "used_dltensor_versioned";
+};
+
+// Managed tensor exported from a buffer view. Owns the shape storage and a
+// reference to the backing buffer for the lifetime of the DLTensor.
+template <typename ManagedTensorT>
+struct ExtDLManagedTensor : public ManagedTensorT {
+  static constexpr size_t kStaticDimLimit = 6;
+  ~ExtDLManagedTensor() {
+    if (retained_buffer) {
+      iree_hal_buffer_release(retained_buffer);
     }
-    iree_hal_buffer_t* retained_buffer = nullptr;
-    union {
-      int64_t static_shape[kStaticDimLimit];
-      int64_t* dynamic_shape;
-    } dim_storage;
-  };
-  auto tensor = std::make_unique<ExtDLManagedTensor>();
-  memset(static_cast<DLManagedTensor*>(tensor.get()), 0,
-         sizeof(DLManagedTensor));
-  auto capsule_destructor = +[](PyObject* capsule) {
-    const char* actual_name = PyCapsule_GetName(capsule);
-    if (!actual_name || strcmp(actual_name, "dltensor") != 0) {
-      // Caller consumed the capsule. Do nothing.
-      return;
+    if (this->dl_tensor.ndim > kStaticDimLimit) {
+      delete[] dim_storage.dynamic_shape;
     }
+  }
+  iree_hal_buffer_t* retained_buffer = nullptr;
+  union {
+    int64_t static_shape[kStaticDimLimit];
+    int64_t* dynamic_shape;
+  } dim_storage;
+};
 
-    // Capsule was dropped on the floor before consumed. Release resources.
-    void* capsule_ptr = PyCapsule_GetPointer(capsule, "dltensor");
-    if (!capsule_ptr) {
-      return;
-    }
-    DLManagedTensor* tensor_ptr = static_cast<DLManagedTensor*>(capsule_ptr);
-    tensor_ptr->deleter(tensor_ptr);
-  };
-  auto deleter = +[](struct DLManagedTensor* self) {
-    auto* ext_self = static_cast<ExtDLManagedTensor*>(self);
-    delete ext_self;
-  };
+template <typename ManagedTensorT>
+void DestroyUnconsumedDLPackCapsule(PyObject* capsule) {
+  const char* name = DLPackCapsuleTraits<ManagedTensorT>::kName;
+  const char* actual_name = PyCapsule_GetName(capsule);
+  if (!actual_name || strcmp(actual_name, name) != 0) {
+    // Caller consumed the capsule. Do nothing.
+    return;
+  }
 
-  // Populate the DLManagedTensor.
-  tensor->deleter = deleter;
+  // Capsule was dropped on the floor before consumed. Release resources.
+  void* capsule_ptr = PyCapsule_GetPointer(capsule, name);
+  if (!capsule_ptr) {
+    return;
+  }
+  ManagedTensorT* tensor_ptr = static_cast<ManagedTensorT*>(capsule_ptr);
+  tensor_ptr->deleter(tensor_ptr);
+}
+
+template <typename ManagedTensorT>
+py::object ExportDLPackCapsule(iree_hal_device_t* device,
+                               HalBufferView& buffer_view,
+                               int device_type_code, int device_id) {
+  using ExtTensor = ExtDLManagedTensor<ManagedTensorT>;
+  auto tensor = std::make_unique<ExtTensor>();
+  memset(static_cast<ManagedTensorT*>(tensor.get()), 0,
+         sizeof(ManagedTensorT));
+
+  // Populate the managed tensor.
+  tensor->deleter = +[](ManagedTensorT* self) {
+    delete static_cast<ExtTensor*>(self);
+  };
   auto& dl_tensor = tensor->dl_tensor;
   dl_tensor.device.device_type = static_cast<DLDeviceType>(device_type_code);
   dl_tensor.device.device_id = device_id;
@@ -705,7 +750,7 @@ py::object HalDevice::CreateDLPackCapsule(HalBufferView& buffer_view,
   // Leave strides nullptr to signify dense row-major.
   auto rank = iree_hal_buffer_view_shape_rank(buffer_view.raw_ptr());
   auto* bv_dims = iree_hal_buffer_view_shape_dims(buffer_view.raw_ptr());
-  if (rank > kStaticDimLimit) {
+  if (rank > ExtTensor::kStaticDimLimit) {
     dl_tensor.shape = new int64_t[rank];
     tensor->dim_storage.dynamic_shape = dl_tensor.shape;
   } else {
@@ -720,8 +765,10 @@ py::object HalDevice::CreateDLPackCapsule(HalBufferView& buffer_view,
   iree_hal_buffer_t* buffer =
       iree_hal_buffer_view_buffer(buffer_view.raw_ptr());
   auto offset = iree_hal_buffer_byte_offset(buffer);
+  bool read_only = !iree_all_bits_set(iree_hal_buffer_allowed_access(buffer),
+                                      IREE_HAL_MEMORY_ACCESS_WRITE);
   buffer = iree_hal_buffer_allocated_buffer(buffer);
-  iree_hal_allocator_t* alloc = iree_hal_device_allocator(raw_ptr());
+  iree_hal_allocator_t* alloc = iree_hal_device_allocator(device);
   iree_hal_external_buffer_t external_buffer;
   CheckApiStatus(
       iree_hal_allocator_export_buffer(
@@ -734,9 +781,17 @@ py::object HalDevice::CreateDLPackCapsule(HalBufferView& buffer_view,
       reinterpret_cast<void*>(external_buffer.handle.device_allocation.ptr);
   dl_tensor.byte_offset = offset;
 
+  if constexpr (std::is_same_v<ManagedTensorT, DLManagedTensorVersioned>) {
+    tensor->version.major = DLPACK_MAJOR_VERSION;
+    tensor->version.minor = DLPACK_MINOR_VERSION;
+    if (read_only) tensor->flags |= DLPACK_FLAG_BITMASK_READ_ONLY;
+  }
+
   // Create and return capsule.
-  PyObject* capsule = PyCapsule_New(static_cast<DLManagedTensor*>(tensor.get()),
-                                    "dltensor", capsule_destructor);
+  PyObject* capsule = PyCapsule_New(
+      static_cast<ManagedTensorT*>(tensor.get()),
+      DLPackCapsuleTraits<ManagedTensorT>::kName,
+      &DestroyUnconsumedDLPackCapsule<ManagedTensorT>);
   if (!capsule) {
     throw py::python_error();
   }
@@ -748,34 +803,140 @@ py::object HalDevice::CreateDLPackCapsule(HalBufferView& buffer_view,
   return py::steal<py::object>(capsule);
 }
 
+template <typename ManagedTensorT>
+void ReleaseImportedDLPackTensor(void* user_data,
+                                 struct iree_hal_buffer_t* buffer) {
+  auto* managed_tensor = static_cast<ManagedTensorT*>(user_data);
+  if (managed_tensor->deleter) {
+    managed_tensor->deleter(managed_tensor);
+  }
+}
+
+// Returns true if memory of |memory_device_type| can be imported as a device
+// allocation by a device whose native memory is of |device_type|.
+bool IsDLPackDeviceImportable(DLDeviceType device_type,
+                              DLDeviceType memory_device_type) {
+  if (device_type == memory_device_type) return true;
+  switch (device_type) {
+    case kDLCUDA:
+      // Managed and pinned host memory are addressable by the device.
+      return memory_device_type == kDLCUDAManaged ||
+             memory_device_type == kDLCUDAHost;
+    case kDLROCM:
+      return memory_device_type == kDLROCMHost;
+    case kDLExtDev:
+      // Unknown device: defer to the allocator import checks.
+      return true;
+    default:
+      return false;
+  }
+}
+
+}  // namespace
+
+std::pair<int, int> HalDevice::GetDLPackDevice() {
+  // The HAL does not track the physical device ordinal so all devices report
+  // index 0. Users with multiple devices of the same kind need to create
+  // capsules with the appropriate device_id explicitly.
+  iree_string_view_t id = iree_hal_device_id(raw_ptr());
+  DLDeviceType device_type = kDLExtDev;
+  if (iree_string_view_starts_with(id, IREE_SV("cuda"))) {
+    device_type = kDLCUDA;
+  } else if (iree_string_view_starts_with(id, IREE_SV("hip"))) {
+    device_type = kDLROCM;
+  } else if (iree_string_view_starts_with(id, IREE_SV("local"))) {
+    device_type = kDLCPU;
+  } else if (iree_string_view_starts_with(id, IREE_SV("vulkan"))) {
+    device_type = kDLVulkan;
+  } else if (iree_string_view_starts_with(id, IREE_SV("metal"))) {
+    device_type = kDLMetal;
+  }
+  return std::make_pair(static_cast<int>(device_type), 0);
+}
+
+py::object HalDevice::CreateDLPackCapsule(HalBufferView& buffer_view,
+                                          int device_type_code, int device_id,
+                                          bool versioned,
+                                          py::handle wait_fence) {
+  // Work producing the buffer contents may still be in flight on a device
+  // queue. DLPack consumers expect the memory to be ready (relative to the
+  // stream they requested) so wait on the producing fence before exporting.
+  if (!wait_fence.is_none()) {
+    HalFence* fence = py::cast<HalFence*>(wait_fence);
+    iree_status_t status;
+    {
+      py::gil_scoped_release release;
+      status = iree_hal_fence_wait(fence->raw_ptr(), iree_infinite_timeout());
+    }
+    CheckApiStatus(status, "waiting for dlpack export fence");
+  }
+  if (versioned) {
+    return ExportDLPackCapsule<DLManagedTensorVersioned>(
+        raw_ptr(), buffer_view, device_type_code, device_id);
+  }
+  return ExportDLPackCapsule<DLManagedTensor>(raw_ptr(), buffer_view,
+                                              device_type_code, device_id);
+}
+
 HalBufferView HalDevice::FromDLPackCapsule(py::object input_capsule) {
   struct State {
     ~State() {
-      if (managed_tensor && managed_tensor->deleter) {
-        managed_tensor->deleter(managed_tensor);
+      if (!raw) return;
+      if (versioned) {
+        ReleaseImportedDLPackTensor<DLManagedTensorVersioned>(raw, nullptr);
+      } else {
+        ReleaseImportedDLPackTensor<DLManagedTensor>(raw, nullptr);
       }
     }
     py::object capsule;
+    // Owned managed tensor, reset once ownership is transferred.
     void* raw = nullptr;
-    DLManagedTensor* managed_tensor = nullptr;
+    bool versioned = false;
   } state;
   state.capsule = std::move(input_capsule);
-  state.raw = PyCapsule_GetPointer(state.capsule.ptr(), "dltensor");
-  if (!state.raw) {
+
+  // Accept both versioned (DLPack >= 1.0) and legacy capsules.
+  using VersionedTraits = DLPackCapsuleTraits<DLManagedTensorVersioned>;
+  using LegacyTraits = DLPackCapsuleTraits<DLManagedTensor>;
+  state.versioned =
+      PyCapsule_IsValid(state.capsule.ptr(), VersionedTraits::kName);
+  const char* name =
+      state.versioned ? VersionedTraits::kName : LegacyTraits::kName;
+  const char* used_name =
+      state.versioned ? VersionedTraits::kUsedName : LegacyTraits::kUsedName;
+  void* raw = PyCapsule_GetPointer(state.capsule.ptr(), name);
+  if (!raw) {
     throw py::python_error();
   }
-  state.managed_tensor = static_cast<DLManagedTensor*>(state.raw);
   // Takes ownership.
-  if (PyCapsule_SetName(state.capsule.ptr(), "used_dltensor")) {
+  if (PyCapsule_SetName(state.capsule.ptr(), used_name)) {
     throw py::python_error();
   }
-
-  DLTensor* dlt = &state.managed_tensor->dl_tensor;
+  state.raw = raw;
+
+  DLTensor* dlt = nullptr;
+  uint64_t flags = 0;
+  if (state.versioned) {
+    auto* managed_tensor = static_cast<DLManagedTensorVersioned*>(raw);
+    if (managed_tensor->version.major != DLPACK_MAJOR_VERSION) {
+      throw std::invalid_argument("Unsupported dlpack major version");
+    }
+    dlt = &managed_tensor->dl_tensor;
+    flags = managed_tensor->flags;
+  } else {
+    dlt = &static_cast<DLManagedTensor*>(raw)->dl_tensor;
+  }
 
   // Some validation on what we accept.
   if (dlt->dtype.lanes != 1) {
     throw std::invalid_argument("Unsupported dtype lanes != 1");
   }
+  auto dl_device = GetDLPackDevice();
+  if (!IsDLPackDeviceImportable(static_cast<DLDeviceType>(dl_device.first),
+                                dlt->device.device_type)) {
+    throw std::invalid_argument(
+        "dlpack tensor memory is not accessible by the device");
+  }
 
   iree_hal_element_type_t et;
   switch (dlt->dtype.code) {
@@ -824,12 +985,6 @@ HalBufferView HalDevice::FromDLPackCapsule(py::object input_capsule) {
     }
   }
 
-  // Verify no byte offset. We could technically allow this, but there are all
-  // kinds of bugs and caveats listed, and would like to see how it is used.
-  if (dlt->byte_offset != 0) {
-    throw std::invalid_argument("NYI: dlpack byte_offset != 0");
-  }
-
   // Compute size.
   auto* dims = static_cast<iree_hal_dim_t*>(
       iree_alloca(sizeof(iree_hal_dim_t) * dlt->ndim));
@@ -851,28 +1006,29 @@ HalBufferView HalDevice::FromDLPackCapsule(py::object input_capsule) {
   iree_hal_buffer_params_t params;
   memset(&params, 0, sizeof(params));
   params.usage = IREE_HAL_BUFFER_USAGE_DEFAULT;
-  params.access = IREE_HAL_MEMORY_ACCESS_ANY;
+  params.access = iree_all_bits_set(flags, DLPACK_FLAG_BITMASK_READ_ONLY)
+                      ? IREE_HAL_MEMORY_ACCESS_READ
+                      : IREE_HAL_MEMORY_ACCESS_ANY;
   params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  // The byte offset is folded into the imported pointer: device allocations
+  // are plain device addresses on all drivers that support import, though
+  // the allocator may still reject insufficiently aligned pointers.
   iree_hal_external_buffer_t external_buffer;
   memset(&external_buffer, 0, sizeof(external_buffer));
   external_buffer.type = IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION;
   external_buffer.size = byte_size;
   external_buffer.handle.device_allocation.ptr =
-      reinterpret_cast<uint64_t>(dlt->data);
+      reinterpret_cast<uint64_t>(dlt->data) + dlt->byte_offset;
   iree_hal_buffer_release_callback_t release_callback = {
-      +[](void* user_data, struct iree_hal_buffer_t* buffer) {
-        auto managed_tensor = static_cast<DLManagedTensor*>(user_data);
-        if (managed_tensor->deleter) {
-          managed_tensor->deleter(managed_tensor);
-        }
-      },
+      state.versioned ? &ReleaseImportedDLPackTensor<DLManagedTensorVersioned>
+                      : &ReleaseImportedDLPackTensor<DLManagedTensor>,
       state.raw,
   };
   CheckApiStatus(
       iree_hal_allocator_import_buffer(allocator, params, &external_buffer,
                                        release_callback, &imported_buffer),
       "Could not import external device buffer");
-  state.managed_tensor = nullptr;  // Ownership transferred.
+  state.raw = nullptr;  // Ownership transferred.
 
   // Create Buffer View.
   iree_hal_buffer_view_t* buffer_view;
@@ -1278,8 +1434,10 @@ void SetupHalBindings(nanobind::module_ m) {
            py::arg("signal_semaphores"), kHalDeviceQueueCopy)
       .def("create_dlpack_capsule", &HalDevice::CreateDLPackCapsule,
            py::arg("buffer_view"), py::arg("device_type_code"),
-           py::arg("device_id"))
+           py::arg("device_id"), py::arg("versioned") = false,
+           py::arg("wait_fence") = py::none(), kHalDeviceCreateDLPackCapsule)
       .def("from_dlpack_capsule", &HalDevice::FromDLPackCapsule)
+      .def_prop_ro("dlpack_device", &HalDevice::GetDLPackDevice)
       .def("__repr__", [](HalDevice& self) {
         auto id_sv = iree_hal_device_id(self.raw_ptr());
         return std::string(id_sv.data, id_sv.size);
@@ -7,6 +7,7 @@
 #ifndef IREE_BINDINGS_PYTHON_IREE_RT_HAL_H_
 #define IREE_BINDINGS_PYTHON_IREE_RT_HAL_H_
 
+#include <utility>
 #include <vector>
 
 #include "./binding.h"
@@ -139,7 +140,11 @@ class HalDevice : public ApiRefCounted<HalDevice, iree_hal_device_t> {
                  py::handle wait_semaphores, py::handle signal_semaphores);
   HalBufferView FromDLPackCapsule(py::object capsule);
   py::object CreateDLPackCapsule(HalBufferView& bufferView,
-                                 int device_type_code, int device_id);
+                                 int device_type_code, int device_id,
+                                 bool versioned, py::handle wait_fence);
+  // Returns the (device_type, device_id) DLPack device of memory allocated by
+  // the device as returned by `__dlpack_device__`.
+  std::pair<int, int> GetDLPackDevice();
 };
 
 class HalDriver : public ApiRefCounted<HalDriver, iree_hal_driver_t> {
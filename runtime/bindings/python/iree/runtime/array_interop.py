@@ -23,6 +23,7 @@ from ._binding import (
 __all__ = [
     "asdevicearray",
     "DeviceArray",
+    "from_dlpack",
 ]
 
 _DEVICE_HANDLED_FUNCTIONS = {}
@@ -109,6 +110,31 @@ class DeviceArray(numpy.lib.mixins.NDArrayOperatorsMixin):
         mappable to the host."""
         return self._transfer_to_host(False)
 
+    def __dlpack__(self, *, stream=None, max_version=None, dl_device=None, copy=None):
+        """Exports the array as a DLPack capsule without copying.
+
+        A versioned DLPack 1.0 capsule is returned when the consumer supports
+        it (`max_version` >= 1.0). The device work producing a DeviceArray has
+        completed by the time it is returned to Python (synchronous
+        invocations wait on it and `invoke_async` resolves once its signal
+        fence is reached) so the memory is ready with respect to any consumer
+        `stream`.
+        """
+        if copy:
+            raise BufferError("DeviceArray does not support DLPack export copies")
+        device_type, device_id = self.__dlpack_device__()
+        if dl_device is not None and tuple(dl_device) != (device_type, device_id):
+            raise BufferError(
+                f"DeviceArray cannot be exported to DLPack device {dl_device}"
+            )
+        versioned = max_version is not None and max_version[0] >= 1
+        return self._device.create_dlpack_capsule(
+            self._buffer_view, device_type, device_id, versioned=versioned
+        )
+
+    def __dlpack_device__(self) -> Tuple[int, int]:
+        return self._device.dlpack_device
+
     def _is_mappable(self) -> bool:
         buffer = self._buffer_view.get_buffer()
         if buffer.memory_type() & int(MemoryType.HOST_VISIBLE) != int(
@@ -284,6 +310,39 @@ def asdevicearray(
     )
 
 
+def from_dlpack(
+    device: HalDevice,
+    x,
+    *,
+    stream=None,
+    implicit_host_transfer: bool = False,
+) -> DeviceArray:
+    """Creates a DeviceArray aliasing an object supporting the DLPack protocol.
+
+    The memory of `x` is imported into `device` without copying and stays
+    owned by the producer until the DeviceArray is released, so it must be
+    addressable by the device (e.g. CUDA device, managed or pinned memory for
+    a CUDA device). A DLPack 1.0 versioned capsule is requested, falling back
+    to a legacy capsule for producers that predate it. Read-only tensors are
+    imported with read-only access.
+
+    `stream` is forwarded to the producer per the DLPack protocol and the
+    producer orders its pending work on the tensor before that stream: None
+    selects the legacy default stream on CUDA/ROCm. Work subsequently issued
+    to the device is ordered after it as long as the device queue synchronizes
+    with that stream.
+    """
+    try:
+        capsule = x.__dlpack__(stream=stream, max_version=(1, 0))
+    except TypeError:
+        # Producers predating DLPack 1.0 do not accept max_version.
+        capsule = x.__dlpack__(stream=stream)
+    buffer_view = device.from_dlpack_capsule(capsule)
+    return DeviceArray(
+        device, buffer_view, implicit_host_transfer=implicit_host_transfer
+    )
+
+
 # NOTE: Numpy dtypes are not hashable and exist in a hierarchy that should
 # be queried via isinstance checks. This should be done as a fallback but
 # this is a linear list for quick access to the most common. There may also
@@ -6,6 +6,7 @@
 
 from typing import Dict, Optional
 
+import asyncio
 import json
 import logging
 
@@ -17,6 +18,8 @@ from ._binding import (
     BufferUsage,
     HalBufferView,
     HalDevice,
+    HalDeviceLoopBridge,
+    HalFence,
     InvokeContext,
     MemoryType,
     VmContext,
@@ -88,6 +91,7 @@ class FunctionInvoker:
         "_arg_packer",
         "_ret_descs",
         "_has_inlined_results",
+        "_is_coarse_fences",
     ]
 
     def __init__(
@@ -106,6 +110,9 @@ class FunctionInvoker:
         self._arg_descs = None
         self._ret_descs = None
         self._has_inlined_results = False
+        self._is_coarse_fences = (
+            vm_function.reflection.get("iree.abi.model") == "coarse-fences"
+        )
         self._parse_abi_dict(vm_function)
         self._arg_packer = ArgumentPacker(_invoke_statics, self._arg_descs)
 
@@ -125,6 +132,66 @@ class FunctionInvoker:
 
         ret_list = VmVariantList(len(ret_descs) if ret_descs is not None else 1)
         self._invoke(arg_list, ret_list)
+        return self._unpack_results(inv, ret_list)
+
+    async def invoke_async(
+        self,
+        *args,
+        loop_bridge: Optional[HalDeviceLoopBridge] = None,
+        wait_fence: Optional[HalFence] = None,
+        **kwargs,
+    ):
+        """Invokes the function without blocking the running event loop.
+
+        Functions compiled with the coarse-fences ABI model are passed a wait
+        fence and a signal fence on a new device semaphore. The invocation
+        returns as soon as the work has been scheduled and the results are
+        produced once the signal fence is reached: via `loop_bridge` if given
+        (which must be bound to the running loop) or by waiting on the fence
+        from the default executor otherwise. Passing the `wait_fence` of a
+        prior invocation's results orders the work after it on the device,
+        which allows the inputs of the next request to be prepared while the
+        device is still executing the current one.
+
+        Other functions are invoked on the default executor of the running
+        loop. The GIL is released for the duration of the invocation so that
+        the loop continues to service other tasks.
+        """
+        loop = asyncio.get_running_loop()
+        invoke_context = InvokeContext(self._device)
+        arg_list = self._arg_packer.pack(invoke_context, args, kwargs)
+        inv = Invocation(self._device)
+        ret_descs = self._ret_descs
+        ret_list = VmVariantList(len(ret_descs) if ret_descs is not None else 1)
+
+        if self._is_coarse_fences:
+            semaphore = self._device.create_semaphore(0)
+            signal_fence = HalFence.create_at(semaphore, 1)
+            arg_list.push_ref(wait_fence if wait_fence is not None else HalFence(0))
+            arg_list.push_ref(signal_fence)
+            if loop_bridge is not None:
+                self._invoke(arg_list, ret_list)
+                await loop_bridge.on_semaphore(semaphore, 1, None)
+            else:
+
+                def invoke_and_wait():
+                    self._invoke(arg_list, ret_list)
+                    signal_fence.wait()
+
+                await loop.run_in_executor(None, invoke_and_wait)
+        else:
+
+            def wait_and_invoke():
+                if wait_fence is not None:
+                    wait_fence.wait()
+                self._invoke(arg_list, ret_list)
+
+            await loop.run_in_executor(None, wait_and_invoke)
+
+        return self._unpack_results(inv, ret_list)
+
+    def _unpack_results(self, inv: Invocation, ret_list: VmVariantList):
+        ret_descs = self._ret_descs
 
         # Un-inline the results to align with reflection, as needed.
         reflection_aligned_ret_list = ret_list
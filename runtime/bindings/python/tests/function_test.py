@@ -4,6 +4,7 @@
 # See https://llvm.org/LICENSE.txt for license information.
 # SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+import asyncio
 import json
 import numpy as np
 import unittest
@@ -685,6 +686,39 @@ class FunctionTest(unittest.TestCase):
         result = invoker()
         self.assertEqual("[1, 2]", repr(result))
 
+    def testInvokeAsync(self):
+        def invoke(arg_list, ret_list):
+            ret_list.push_int(3)
+
+        vm_context = MockVmContext(invoke)
+        vm_function = MockVmFunction(reflection={})
+        invoker = FunctionInvoker(vm_context, self.device, vm_function)
+        result = asyncio.run(invoker.invoke_async(1, 2))
+        self.assertEqual("[<VmVariantList(2): [1, 2]>]", vm_context.mock_arg_reprs)
+        self.assertEqual(3, result)
+
+    def testInvokeAsyncCoarseFences(self):
+        def invoke(arg_list, ret_list):
+            self.assertEqual(3, len(arg_list))
+            arg_list.get_as_object(2, rt.HalFence).signal()
+            ret_list.push_int(4)
+
+        vm_context = MockVmContext(invoke)
+        vm_function = MockVmFunction(reflection={"iree.abi.model": "coarse-fences"})
+        invoker = FunctionInvoker(vm_context, self.device, vm_function)
+
+        async def main():
+            loop = asyncio.get_running_loop()
+            bridge = rt.HalDeviceLoopBridge(self.device, loop)
+            try:
+                return await invoker.invoke_async(1, loop_bridge=bridge)
+            finally:
+                bridge.stop()
+
+        self.assertEqual(4, asyncio.run(main()))
+        # Without a bridge the signal fence is waited on from the executor.
+        self.assertEqual(4, asyncio.run(invoker.invoke_async(2)))
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -632,6 +632,33 @@ class DeviceDLPackTest(unittest.TestCase):
             iree.runtime.HalElementType.COMPLEX_64,
         )
 
+    def testImportExportVersioned(self):
+        input_array = np.random.rand(3, 4).astype(np.float32)
+        orig_bv = self.allocator.allocate_buffer_copy(
+            memory_type=iree.runtime.MemoryType.DEVICE_LOCAL,
+            allowed_usage=iree.runtime.BufferUsage.DEFAULT,
+            device=self.device,
+            buffer=input_array,
+            element_type=iree.runtime.HalElementType.FLOAT_32,
+        )
+        capsule = self.device.create_dlpack_capsule(orig_bv, 1, 0, versioned=True)
+        imported_bv = self.device.from_dlpack_capsule(capsule)
+        orig_bv = None
+        gc.collect()
+        self.assertEqual([3, 4], imported_bv.shape)
+        np.testing.assert_array_equal(
+            input_array, imported_bv.map().asarray([3, 4], np.float32)
+        )
+
+    def testDeviceArrayDLPack(self):
+        input_array = np.random.rand(3, 4).astype(np.float32)
+        device_array = iree.runtime.asdevicearray(self.device, input_array)
+        self.assertEqual((1, 0), device_array.__dlpack_device__())
+        imported_array = iree.runtime.from_dlpack(self.device, device_array)
+        device_array = None
+        gc.collect()
+        np.testing.assert_array_equal(input_array, imported_array.to_host())
+
 
 if __name__ == "__main__":
     unittest.main()
@@ -32,6 +32,32 @@ extern "C" {
 TFL_CAPI_EXPORT extern TfLiteStatus TfLiteInterpreterResetVariableTensors(
     TfLiteInterpreter* interpreter);
 
+/// Flags for `TfLiteInterpreterSetCustomAllocationForTensor`.
+typedef enum TfLiteCustomAllocationFlags {
+  kTfLiteCustomAllocationFlagsNone = 0,
+  /// Skips checking whether `allocation.data` points to an aligned buffer.
+  kTfLiteCustomAllocationFlagsSkipAlignCheck = 1,
+} TfLiteCustomAllocationFlags;
+
+/// Assigns a caller-owned buffer to the tensor at `tensor_index` so that the
+/// interpreter reads (inputs) or writes (outputs) it directly instead of
+/// allocating its own storage. Input tensors are indexed first, starting at 0,
+/// followed by output tensors.
+///
+/// The allocation must remain valid and unmodified by the caller until a new
+/// allocation is set or the interpreter is deleted. It must be at least as
+/// large as the tensor and aligned to 64 bytes unless
+/// `kTfLiteCustomAllocationFlagsSkipAlignCheck` is set.
+///
+/// NOTE: `TfLiteInterpreterAllocateTensors` must be called after this and
+/// after any subsequent resize.
+///
+/// WARNING: This is an experimental API and subject to change.
+TFL_CAPI_EXPORT extern TfLiteStatus
+TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags);
+
 #if defined(IREE_BINDINGS_TFLITE_INCLUDE_UNSUPPORTED_APIS)
 
 /// Adds an op registration for a builtin operator.
@@ -429,6 +429,12 @@ typedef struct TfLiteSparsity {
   int dim_metadata_size;
 } TfLiteSparsity;
 
+#else
+
+typedef struct TfLiteTensor TfLiteTensor;
+
+#endif  // IREE_BINDINGS_TFLITE_INCLUDE_UNSUPPORTED_APIS
+
 // Defines a custom memory allocation not owned by the runtime.
 // `data` should be aligned to kDefaultTensorAlignment defined in
 // lite/util.h. (Currently 64 bytes)
@@ -438,12 +444,6 @@ typedef struct TfLiteCustomAllocation {
   size_t bytes;
 } TfLiteCustomAllocation;
 
-#else
-
-typedef struct TfLiteTensor TfLiteTensor;
-
-#endif  // IREE_BINDINGS_TFLITE_INCLUDE_UNSUPPORTED_APIS
-
 // A tensor in the interpreter system which is a wrapper around a buffer of
 // data including a dimensionality (or NULL if not currently defined).
 #ifndef TF_LITE_STATIC_MEMORY
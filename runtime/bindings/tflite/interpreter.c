@@ -542,11 +542,20 @@ static iree_status_t _TfLiteInterpreterAllocateTensors(
         iree_vm_list_push_ref_move(interpreter->input_list, &buffer_ref));
   }
 
+  // Outputs with custom allocations import the caller memory now so that it
+  // stays bound and mapped across invocations. The remaining outputs are
+  // dropped and bound to whatever the invocation returns.
   // TODO(benvanik): preallocate outputs when we support using them.
   // We could stash the buffer views in interpreter->output_list.
-  // For now we just drop them all.
   for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
-    _TfLiteTensorDiscardBuffer(&interpreter->output_tensors[i]);
+    TfLiteTensor* tensor = &interpreter->output_tensors[i];
+    if (tensor->custom_allocation.data) {
+      IREE_RETURN_IF_ERROR(_TfLiteTensorReallocateIfNeeded(
+          tensor, iree_hal_device_allocator(interpreter->device),
+          interpreter->allocator));
+    } else {
+      _TfLiteTensorDiscardBuffer(tensor);
+    }
   }
 
   return iree_ok_status();
@@ -584,7 +593,8 @@ static iree_status_t _TfLiteInterpreterInvoke(TfLiteInterpreter* interpreter) {
   // TODO(#3975): just use buffer view results or at least just refresh outputs.
   IREE_RETURN_IF_ERROR(_TfLiteInterpreterRefreshIOShapes(interpreter));
 
-  // Map the output buffers.
+  // Map the output buffers. Outputs with custom allocations receive a copy of
+  // the results in their existing (already mapped) buffers.
   // NOTE: we could defer the mapping unless requested and ensure state buffers
   // remain where they currently are for the next invocation.
   for (iree_host_size_t i = 0; i < interpreter->model->output_count; ++i) {
@@ -628,3 +638,39 @@ TFL_CAPI_EXPORT extern const TfLiteTensor* TfLiteInterpreterGetOutputTensor(
   }
   return &interpreter->output_tensors[output_index];
 }
+
+//===----------------------------------------------------------------------===//
+// Experimental API
+//===----------------------------------------------------------------------===//
+
+static iree_status_t _TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags) {
+  // Inputs are indexed first followed by the outputs.
+  int32_t input_count = interpreter->model->input_count;
+  int32_t output_count = interpreter->model->output_count;
+  TfLiteTensor* tensor = NULL;
+  if (tensor_index >= 0 && tensor_index < input_count) {
+    tensor = &interpreter->input_tensors[tensor_index];
+  } else if (tensor_index >= input_count &&
+             tensor_index < input_count + output_count) {
+    tensor = &interpreter->output_tensors[tensor_index - input_count];
+  } else {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "tensor_index out of range (0 <= %d < %d)",
+                            tensor_index, input_count + output_count);
+  }
+  return _TfLiteTensorSetCustomAllocation(tensor, allocation, flags);
+}
+
+TFL_CAPI_EXPORT extern TfLiteStatus
+TfLiteInterpreterSetCustomAllocationForTensor(
+    TfLiteInterpreter* interpreter, int tensor_index,
+    const TfLiteCustomAllocation* allocation, int64_t flags) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, tensor_index);
+  iree_status_t status = _TfLiteInterpreterSetCustomAllocationForTensor(
+      interpreter, tensor_index, allocation, flags);
+  IREE_TRACE_ZONE_END(z0);
+  return _TfLiteStatusFromIREEStatus(status);
+}
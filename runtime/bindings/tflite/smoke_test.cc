@@ -30,6 +30,7 @@ limitations under the License.
 // NOTE: we pull in our own copy here in case the tflite API changes upstream.
 #define TFL_COMPILE_LIBRARY 1
 #include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api.h"
+#include "runtime/bindings/tflite/include/tensorflow/lite/c/c_api_experimental.h"
 
 // Test model is available both on the filesystem and here for embedding testing
 // embedding the module directly in a binary.
@@ -214,6 +215,59 @@ TEST(CApiSimple, StaticSmoke) {
   TfLiteInterpreterDelete(interpreter);
 }
 
+// Binds caller memory to the input and output tensors so that no copies are
+// needed to get data in and out of the interpreter.
+TEST(CApiSimple, StaticCustomAllocation) {
+  TfLiteModel* model =
+      TfLiteModelCreate(IREE_BINDINGS_TFLITE_TESTDATA_ADD_STATIC_EMBEDDED_DATA,
+                        IREE_BINDINGS_TFLITE_TESTDATA_ADD_STATIC_EMBEDDED_SIZE);
+  ASSERT_NE(model, nullptr);
+  TfLiteInterpreter* interpreter = TfLiteInterpreterCreate(model, nullptr);
+  ASSERT_NE(interpreter, nullptr);
+  TfLiteModelDelete(model);
+
+  alignas(64) std::array<float, 1 * 8 * 8 * 3> input = {
+      1.f,
+      3.f,
+  };
+  alignas(64) std::array<float, 1 * 8 * 8 * 3> output = {};
+  TfLiteCustomAllocation input_allocation = {input.data(),
+                                             input.size() * sizeof(float)};
+  TfLiteCustomAllocation output_allocation = {output.data(),
+                                              output.size() * sizeof(float)};
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, 0, &input_allocation,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterSetCustomAllocationForTensor(
+                interpreter, 1, &output_allocation,
+                kTfLiteCustomAllocationFlagsNone),
+            kTfLiteOk);
+  ASSERT_EQ(TfLiteInterpreterAllocateTensors(interpreter), kTfLiteOk);
+
+  TfLiteTensor* input_tensor = TfLiteInterpreterGetInputTensor(interpreter, 0);
+  ASSERT_NE(input_tensor, nullptr);
+  EXPECT_EQ(TfLiteTensorData(input_tensor), input.data());
+  const TfLiteTensor* output_tensor =
+      TfLiteInterpreterGetOutputTensor(interpreter, 0);
+  ASSERT_NE(output_tensor, nullptr);
+  EXPECT_EQ(TfLiteTensorData(output_tensor), output.data());
+
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+  EXPECT_EQ(TfLiteTensorData(output_tensor), output.data());
+  EXPECT_EQ(output[0], 2.f);
+  EXPECT_EQ(output[1], 6.f);
+
+  // Updates to the caller memory are visible to the next invocation.
+  input[0] = 5.f;
+  ASSERT_EQ(TfLiteInterpreterInvoke(interpreter), kTfLiteOk);
+  EXPECT_EQ(TfLiteTensorData(output_tensor), output.data());
+  EXPECT_EQ(output[0], 10.f);
+  EXPECT_EQ(output[1], 6.f);
+
+  TfLiteInterpreterDelete(interpreter);
+}
+
 // TODO(#3971): fix cmake data deps.
 // TODO(#3972): plumb through quantization params.
 TEST(CApiSimple, DISABLED_QuantizationParams) {
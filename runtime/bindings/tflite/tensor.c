@@ -102,6 +102,57 @@ static iree_status_t _TfLiteTypeToElementType(
   return iree_ok_status();
 }
 
+iree_status_t _TfLiteTensorSetCustomAllocation(
+    TfLiteTensor* tensor, const TfLiteCustomAllocation* allocation,
+    int64_t flags) {
+  if (!allocation || !allocation->data) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "custom allocation must have data");
+  }
+  if (!(flags & kTfLiteCustomAllocationFlagsSkipAlignCheck) &&
+      !iree_host_size_has_alignment((iree_host_size_t)allocation->data,
+                                    IREE_BINDINGS_TFLITE_TENSOR_ALIGNMENT)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "custom allocation %p is not aligned to %d bytes",
+                            allocation->data,
+                            IREE_BINDINGS_TFLITE_TENSOR_ALIGNMENT);
+  }
+  _TfLiteTensorDiscardBuffer(tensor);
+  tensor->custom_allocation = *allocation;
+  return iree_ok_status();
+}
+
+// Imports the caller-owned custom allocation of |tensor| as its buffer.
+// Only the leading |allocation_size| bytes are used.
+static iree_status_t _TfLiteTensorImportCustomAllocation(
+    TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
+    iree_device_size_t allocation_size) {
+  if (tensor->custom_allocation.bytes < allocation_size) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "custom allocation of %" PRIhsz
+        " bytes is smaller than the tensor (%" PRIdsz " bytes)",
+        (iree_host_size_t)tensor->custom_allocation.bytes, allocation_size);
+  }
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+      .size = allocation_size,
+      .handle.host_allocation.ptr = tensor->custom_allocation.data,
+  };
+  return iree_hal_allocator_import_buffer(
+      buffer_allocator,
+      (iree_hal_buffer_params_t){
+          .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
+                  IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+          .usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                   IREE_HAL_BUFFER_USAGE_TRANSFER |
+                   IREE_HAL_BUFFER_USAGE_MAPPING,
+      },
+      &external_buffer, iree_hal_buffer_release_callback_null(),
+      &tensor->buffer);
+}
+
 iree_status_t _TfLiteTensorReallocateIfNeeded(
     TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
     iree_allocator_t heap_allocator) {
@@ -133,18 +184,28 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
     return iree_ok_status();
   }
 
-  // Allocate the underlying buffer for the tensor.
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_allocator_allocate_buffer(
-              buffer_allocator,
-              (iree_hal_buffer_params_t){
-                  .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
-                          IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
-                  .usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
-                           IREE_HAL_BUFFER_USAGE_TRANSFER |
-                           IREE_HAL_BUFFER_USAGE_MAPPING,
-              },
-              allocation_size, &tensor->buffer));
+  // Drop the old buffer and its mapping before replacing it.
+  _TfLiteTensorDiscardBuffer(tensor);
+
+  if (tensor->custom_allocation.data) {
+    // Use the caller memory directly so that no copies are required.
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, _TfLiteTensorImportCustomAllocation(tensor, buffer_allocator,
+                                                allocation_size));
+  } else {
+    // Allocate the underlying buffer for the tensor.
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_allocator_allocate_buffer(
+                buffer_allocator,
+                (iree_hal_buffer_params_t){
+                    .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
+                            IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+                    .usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                             IREE_HAL_BUFFER_USAGE_TRANSFER |
+                             IREE_HAL_BUFFER_USAGE_MAPPING,
+                },
+                allocation_size, &tensor->buffer));
+  }
 
   // Map the buffer memory immediately. The tflite API doesn't let us know if
   // this is a buffer the user will actually touch or some state buffer that is
@@ -161,9 +222,45 @@ iree_status_t _TfLiteTensorReallocateIfNeeded(
   return iree_ok_status();
 }
 
+// Copies the contents of |buffer| into the imported custom allocation.
+static iree_status_t _TfLiteTensorCopyToCustomAllocation(
+    TfLiteTensor* tensor, iree_hal_buffer_t* buffer) {
+  if (!tensor->buffer) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "TfLiteInterpreterAllocateTensors must be called "
+                            "after setting a custom allocation");
+  }
+  iree_device_size_t byte_length = iree_hal_buffer_byte_length(buffer);
+  if (byte_length != iree_hal_buffer_byte_length(tensor->buffer)) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "result of %" PRIdsz " bytes does not match the custom allocation (%"
+        PRIdsz " bytes)",
+        byte_length, iree_hal_buffer_byte_length(tensor->buffer));
+  }
+  return iree_hal_buffer_map_copy(buffer, 0, tensor->buffer, 0, byte_length);
+}
+
 iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
                                 iree_hal_buffer_t* buffer) {
   IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Nothing to do if the buffer is already bound and mapped.
+  if (buffer && buffer == tensor->buffer) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // Tensors backed by caller memory stay bound to it across invocations.
+  if (tensor->custom_allocation.data) {
+    iree_status_t status = iree_ok_status();
+    if (buffer) {
+      status = _TfLiteTensorCopyToCustomAllocation(tensor, buffer);
+    }
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   _TfLiteTensorDiscardBuffer(tensor);
   if (!buffer) {
     // Just a discard (invalid output/etc).
@@ -196,6 +293,7 @@ void _TfLiteTensorDiscardBuffer(TfLiteTensor* tensor) {
   if (tensor->buffer_mapping.contents.data != NULL) {
     iree_hal_buffer_unmap_range(&tensor->buffer_mapping);
   }
+  memset(&tensor->buffer_mapping, 0, sizeof(tensor->buffer_mapping));
   iree_hal_buffer_release(tensor->buffer);
   tensor->buffer = NULL;
   IREE_TRACE_ZONE_END(z0);
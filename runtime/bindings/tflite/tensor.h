@@ -22,6 +22,9 @@
 // modules may of course have arbitrary shape ranks.
 #define IREE_BINDINGS_TFLITE_MAX_RANK 8
 
+// Required alignment of custom allocations; matches kDefaultTensorAlignment.
+#define IREE_BINDINGS_TFLITE_TENSOR_ALIGNMENT 64
+
 struct TfLiteTensor {
   // Static metadata about the tensor as it was embedded in the module.
   TfLiteType type;
@@ -38,6 +41,11 @@ struct TfLiteTensor {
   iree_hal_buffer_t* buffer;
   // Persistently mapped buffer; invalidated when buffer is resized.
   iree_hal_buffer_mapping_t buffer_mapping;
+
+  // Caller-owned memory set with TfLiteInterpreterSetCustomAllocationForTensor.
+  // When present the buffer is imported from this memory instead of being
+  // allocated and results are written into it.
+  TfLiteCustomAllocation custom_allocation;
 };
 
 // Parses a tfl.io.names value and sets the |tensor| name.
@@ -53,15 +61,24 @@ iree_status_t _TfLiteTensorParseTypeAttr(TfLiteTensor* tensor,
 iree_status_t _TfLiteTensorParseQuantAttr(TfLiteTensor* tensor,
                                           iree_string_view_t attr);
 
+// Sets the caller-owned memory backing the tensor and discards the current
+// buffer. The memory is imported on the next _TfLiteTensorReallocateIfNeeded.
+iree_status_t _TfLiteTensorSetCustomAllocation(
+    TfLiteTensor* tensor, const TfLiteCustomAllocation* allocation,
+    int64_t flags);
+
 // Reallocates and remaps the tensor buffer view if needed.
 // No-op if the buffer view is already allocated and its shape matches the
-// current tensor shape.
+// current tensor shape. Tensors with a custom allocation import it instead.
 iree_status_t _TfLiteTensorReallocateIfNeeded(
     TfLiteTensor* tensor, iree_hal_allocator_t* buffer_allocator,
     iree_allocator_t heap_allocator);
 
 // Binds the given |buffer| to the tensor and maps it.
 // The tensor shape will be overwritten with the buffer view shape.
+// Binding the buffer already bound keeps the existing mapping. Tensors with a
+// custom allocation keep their imported buffer and have the contents of
+// |buffer| copied into it.
 iree_status_t _TfLiteTensorBind(TfLiteTensor* tensor,
                                 iree_hal_buffer_t* buffer);
 
@@ -15,6 +15,22 @@
 // iree_arena_block_pool_t
 //===----------------------------------------------------------------------===//
 
+// NOTE: threading support is optional.
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#define iree_thread_local static
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201102L) && \
+    !__STDC_NO_THREADS__
+#define iree_thread_local _Thread_local
+#elif defined(IREE_COMPILER_MSVC)
+#define iree_thread_local __declspec(thread)
+#else
+#define iree_thread_local
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+// Number of blocks moved between a magazine and the shared pool at a time.
+#define IREE_ARENA_BLOCK_POOL_MAGAZINE_BATCH_SIZE \
+  iree_max(1, IREE_ARENA_BLOCK_POOL_MAGAZINE_CAPACITY / 2)
+
 void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
                                       iree_allocator_t block_allocator,
                                       iree_arena_block_pool_t* out_block_pool) {
@@ -25,7 +41,11 @@ void iree_arena_block_pool_initialize(iree_host_size_t total_block_size,
   out_block_pool->usable_block_size =
       total_block_size - sizeof(iree_arena_block_t);
   out_block_pool->block_allocator = block_allocator;
-  iree_atomic_arena_block_slist_initialize(&out_block_pool->available_slist);
+  iree_slim_mutex_initialize(&out_block_pool->mutex);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(out_block_pool->magazines);
+       ++i) {
+    iree_slim_mutex_initialize(&out_block_pool->magazines[i].mutex);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -36,34 +56,127 @@ void iree_arena_block_pool_deinitialize(iree_arena_block_pool_t* block_pool) {
   // Since all blocks must have been released we can just reuse trim (today) as
   // it doesn't retain any blocks.
   iree_arena_block_pool_trim(block_pool);
-  iree_atomic_arena_block_slist_deinitialize(&block_pool->available_slist);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(block_pool->magazines);
+       ++i) {
+    iree_slim_mutex_deinitialize(&block_pool->magazines[i].mutex);
+  }
+  iree_slim_mutex_deinitialize(&block_pool->mutex);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
-void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-
-  iree_arena_block_t* head = NULL;
-  iree_atomic_arena_block_slist_flush(
-      &block_pool->available_slist,
-      IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &head, NULL);
+// Frees a list of blocks starting at |head| back to the block allocator.
+static void iree_arena_block_pool_free_blocks(
+    iree_arena_block_pool_t* block_pool, iree_arena_block_t* head) {
   while (head) {
-    void* ptr = (uint8_t*)head - block_pool->usable_block_size;
+    void* ptr = iree_arena_block_ptr(block_pool, head);
     head = head->next;
     iree_allocator_free(block_pool->block_allocator, ptr);
+    IREE_STATISTICS(iree_atomic_fetch_sub(&block_pool->block_count, 1,
+                                          iree_memory_order_relaxed));
   }
+}
+
+void iree_arena_block_pool_trim(iree_arena_block_pool_t* block_pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(block_pool->magazines);
+       ++i) {
+    iree_arena_block_magazine_t* magazine = &block_pool->magazines[i];
+    iree_slim_mutex_lock(&magazine->mutex);
+    iree_arena_block_t* head = magazine->head;
+    magazine->head = NULL;
+    magazine->count = 0;
+    iree_slim_mutex_unlock(&magazine->mutex);
+    iree_arena_block_pool_free_blocks(block_pool, head);
+  }
+
+  iree_slim_mutex_lock(&block_pool->mutex);
+  iree_arena_block_t* head = block_pool->available_head;
+  block_pool->available_head = NULL;
+  block_pool->available_count = 0;
+  iree_slim_mutex_unlock(&block_pool->mutex);
+  iree_arena_block_pool_free_blocks(block_pool, head);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns the magazine preferred by the calling thread.
+// Threads are assigned magazines round-robin on first use so that up to
+// IREE_ARENA_BLOCK_POOL_MAGAZINE_COUNT threads (such as executor workers) each
+// have a magazine to themselves. The assignment is shared by all pools.
+static iree_arena_block_magazine_t* iree_arena_block_pool_thread_magazine(
+    iree_arena_block_pool_t* block_pool) {
+  static iree_atomic_int32_t next_thread_ordinal;
+  static iree_thread_local int32_t thread_ordinal = 0;
+  if (IREE_UNLIKELY(thread_ordinal == 0)) {
+    thread_ordinal = iree_atomic_fetch_add(&next_thread_ordinal, 1,
+                                           iree_memory_order_relaxed) +
+                     1;
+  }
+  return &block_pool->magazines[(iree_host_size_t)(thread_ordinal - 1) %
+                                IREE_ARENA_BLOCK_POOL_MAGAZINE_COUNT];
+}
+
+// Takes up to |max_count| blocks from the shared free list.
+// Returns the list of blocks taken in |out_head| and the count as the result.
+static iree_host_size_t iree_arena_block_pool_take_shared(
+    iree_arena_block_pool_t* block_pool, iree_host_size_t max_count,
+    iree_arena_block_t** out_head) {
+  iree_slim_mutex_lock(&block_pool->mutex);
+  iree_arena_block_t* head = block_pool->available_head;
+  iree_arena_block_t* tail = NULL;
+  iree_host_size_t count = 0;
+  for (iree_arena_block_t* block = head; block && count < max_count;
+       block = block->next) {
+    tail = block;
+    ++count;
+  }
+  if (tail) {
+    block_pool->available_head = tail->next;
+    block_pool->available_count -= count;
+    tail->next = NULL;
+  }
+  iree_slim_mutex_unlock(&block_pool->mutex);
+  *out_head = count ? head : NULL;
+  return count;
+}
+
 iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
                                             iree_arena_block_t** out_block,
                                             void** out_ptr) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_arena_block_t* block =
-      iree_atomic_arena_block_slist_pop(&block_pool->available_slist);
+  // Fast path: pop from the magazine of the calling thread.
+  iree_arena_block_magazine_t* magazine =
+      iree_arena_block_pool_thread_magazine(block_pool);
+  iree_slim_mutex_lock(&magazine->mutex);
+  iree_arena_block_t* block = magazine->head;
+  if (block) {
+    magazine->head = block->next;
+    --magazine->count;
+    IREE_STATISTICS(++magazine->hit_count);
+  } else {
+    IREE_STATISTICS(++magazine->miss_count);
+  }
+  iree_slim_mutex_unlock(&magazine->mutex);
+
+  if (!block) {
+    // Magazine empty; refill a batch from the shared pool and keep all but the
+    // first block in the magazine for future acquisitions.
+    iree_host_size_t count = iree_arena_block_pool_take_shared(
+        block_pool, IREE_ARENA_BLOCK_POOL_MAGAZINE_BATCH_SIZE, &block);
+    if (count > 1) {
+      iree_arena_block_t* refill_head = block->next;
+      iree_arena_block_t* refill_tail = refill_head;
+      while (refill_tail->next) refill_tail = refill_tail->next;
+      iree_slim_mutex_lock(&magazine->mutex);
+      refill_tail->next = magazine->head;
+      magazine->head = refill_head;
+      magazine->count += count - 1;
+      iree_slim_mutex_unlock(&magazine->mutex);
+    }
+  }
 
   if (!block) {
     // No blocks available; allocate one now.
@@ -79,6 +192,20 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
                                                 (void**)&block_base));
     block = iree_arena_block_trailer(block_pool, block_base);
     *out_ptr = block_base;
+    IREE_STATISTICS({
+      iree_atomic_fetch_add(&block_pool->allocation_count, 1,
+                            iree_memory_order_relaxed);
+      int64_t block_count = iree_atomic_fetch_add(&block_pool->block_count, 1,
+                                                  iree_memory_order_relaxed) +
+                            1;
+      int64_t peak_block_count = iree_atomic_load(&block_pool->peak_block_count,
+                                                  iree_memory_order_relaxed);
+      while (block_count > peak_block_count &&
+             !iree_atomic_compare_exchange_weak(
+                 &block_pool->peak_block_count, &peak_block_count, block_count,
+                 iree_memory_order_relaxed, iree_memory_order_relaxed)) {
+      }
+    });
   } else {
     *out_ptr = iree_arena_block_ptr(block_pool, block);
   }
@@ -93,12 +220,79 @@ iree_status_t iree_arena_block_pool_acquire(iree_arena_block_pool_t* block_pool,
 void iree_arena_block_pool_release(iree_arena_block_pool_t* block_pool,
                                    iree_arena_block_t* block_head,
                                    iree_arena_block_t* block_tail) {
+  if (!block_head) return;
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_atomic_arena_block_slist_concat(&block_pool->available_slist, block_head,
-                                       block_tail);
+
+  iree_host_size_t release_count = 1;
+  for (iree_arena_block_t* block = block_head; block != block_tail;
+       block = block->next) {
+    ++release_count;
+  }
+
+  // Blocks go to the calling thread's magazine so that they are reused while
+  // still warm. If the magazine overflows everything beyond a single batch is
+  // spilled to the shared pool so that the magazine can absorb future releases
+  // and other threads can acquire the blocks.
+  iree_arena_block_magazine_t* magazine =
+      iree_arena_block_pool_thread_magazine(block_pool);
+  iree_arena_block_t* spill_head = NULL;
+  iree_arena_block_t* spill_tail = NULL;
+  iree_host_size_t spill_count = 0;
+  iree_slim_mutex_lock(&magazine->mutex);
+  block_tail->next = magazine->head;
+  magazine->head = block_head;
+  magazine->count += release_count;
+  if (magazine->count > IREE_ARENA_BLOCK_POOL_MAGAZINE_CAPACITY) {
+    iree_arena_block_t* keep_tail = magazine->head;
+    for (iree_host_size_t i = 1; i < IREE_ARENA_BLOCK_POOL_MAGAZINE_BATCH_SIZE;
+         ++i) {
+      keep_tail = keep_tail->next;
+    }
+    spill_head = keep_tail->next;
+    spill_count = magazine->count - IREE_ARENA_BLOCK_POOL_MAGAZINE_BATCH_SIZE;
+    keep_tail->next = NULL;
+    magazine->count = IREE_ARENA_BLOCK_POOL_MAGAZINE_BATCH_SIZE;
+  }
+  iree_slim_mutex_unlock(&magazine->mutex);
+
+  if (spill_head) {
+    spill_tail = spill_head;
+    while (spill_tail->next) spill_tail = spill_tail->next;
+    iree_slim_mutex_lock(&block_pool->mutex);
+    spill_tail->next = block_pool->available_head;
+    block_pool->available_head = spill_head;
+    block_pool->available_count += spill_count;
+    iree_slim_mutex_unlock(&block_pool->mutex);
+  }
+
   IREE_TRACE_ZONE_END(z0);
 }
 
+void iree_arena_block_pool_query_statistics(
+    const iree_arena_block_pool_t* block_pool,
+    iree_arena_block_pool_statistics_t* out_statistics) {
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  IREE_STATISTICS({
+    iree_arena_block_pool_t* mutable_pool =
+        (iree_arena_block_pool_t*)block_pool;
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(mutable_pool->magazines);
+         ++i) {
+      iree_arena_block_magazine_t* magazine = &mutable_pool->magazines[i];
+      iree_slim_mutex_lock(&magazine->mutex);
+      out_statistics->acquire_count +=
+          magazine->hit_count + magazine->miss_count;
+      out_statistics->magazine_hit_count += magazine->hit_count;
+      iree_slim_mutex_unlock(&magazine->mutex);
+    }
+    out_statistics->allocation_count = (uint64_t)iree_atomic_load(
+        &mutable_pool->allocation_count, iree_memory_order_relaxed);
+    out_statistics->block_count = (iree_host_size_t)iree_atomic_load(
+        &mutable_pool->block_count, iree_memory_order_relaxed);
+    out_statistics->peak_block_count = (iree_host_size_t)iree_atomic_load(
+        &mutable_pool->peak_block_count, iree_memory_order_relaxed);
+  });
+}
+
 //===----------------------------------------------------------------------===//
 // iree_arena_allocator_t
 //===----------------------------------------------------------------------===//
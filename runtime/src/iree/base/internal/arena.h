@@ -11,6 +11,8 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/atomic_slist.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -43,25 +45,88 @@ IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_atomic_arena_block, iree_arena_block_t,
 #define iree_arena_block_trailer(block_pool, ptr) \
   (iree_arena_block_t*)((const uint8_t*)(ptr) + (block_pool)->usable_block_size)
 
-// A simple atomic fixed-size block pool.
+// Number of per-thread block caches (magazines) in each block pool.
+// Threads are assigned magazines round-robin on first use and once there are
+// more threads than magazines they will share.
+#if !defined(IREE_ARENA_BLOCK_POOL_MAGAZINE_COUNT)
+#define IREE_ARENA_BLOCK_POOL_MAGAZINE_COUNT 8
+#endif  // !IREE_ARENA_BLOCK_POOL_MAGAZINE_COUNT
+
+// Maximum number of free blocks retained in each magazine. Blocks are moved
+// between a magazine and the shared pool in batches of half this amount.
+#if !defined(IREE_ARENA_BLOCK_POOL_MAGAZINE_CAPACITY)
+#define IREE_ARENA_BLOCK_POOL_MAGAZINE_CAPACITY 16
+#endif  // !IREE_ARENA_BLOCK_POOL_MAGAZINE_CAPACITY
+
+// A small cache of free blocks preferred by a subset of threads.
+// Padded to avoid false sharing between threads using different magazines.
+typedef struct iree_arena_block_magazine_t {
+  iree_alignas(iree_hardware_destructive_interference_size)
+      iree_slim_mutex_t mutex;
+  // Linked list of free blocks (LIFO).
+  iree_arena_block_t* head;
+  // Number of blocks in |head|.
+  iree_host_size_t count;
+  // Number of acquisitions serviced from the magazine.
+  IREE_STATISTICS(uint64_t hit_count;)
+  // Number of acquisitions that had to go to the shared pool.
+  IREE_STATISTICS(uint64_t miss_count;)
+} iree_arena_block_magazine_t;
+
+// Statistics for a block pool.
+// Only populated when IREE_STATISTICS_ENABLE is set.
+typedef struct iree_arena_block_pool_statistics_t {
+  // Total number of blocks acquired from the pool.
+  uint64_t acquire_count;
+  // Number of acquisitions serviced from the calling thread's magazine without
+  // touching the shared pool. The hit rate is `magazine_hit_count /
+  // acquire_count`.
+  uint64_t magazine_hit_count;
+  // Total number of blocks allocated from the block allocator.
+  uint64_t allocation_count;
+  // Number of blocks currently allocated from the block allocator, including
+  // both acquired blocks and those free in the pool.
+  iree_host_size_t block_count;
+  // Peak value of |block_count| over the lifetime of the pool.
+  iree_host_size_t peak_block_count;
+} iree_arena_block_pool_statistics_t;
+
+// A simple thread-safe fixed-size block pool.
 // Blocks are allocated from the system as required and kept in the pool to
 // satisfy future requests. Blocks are all of a uniform size specified when the
 // pool is created. It's recommended that power-of-two sizes are used for the
 // blocks so that the underlying allocator is more likely to bucket them
 // appropriately.
 //
+// Free blocks are first cached in per-thread magazines so that threads
+// repeatedly acquiring and releasing blocks (executor workers, command buffer
+// recording, etc) do not contend on the shared pool. Magazines exchange blocks
+// with the shared pool in batches when they run empty or overflow.
+//
 // Thread-safe; multiple threads may acquire and release blocks from the pool.
 // The underlying allocator must also be thread-safe.
 typedef struct iree_arena_block_pool_t {
-  // Block size, in bytes. All blocks in the available_slist will have this
-  // byte size which includes the iree_arena_block_t footer.
+  // Block size, in bytes. All blocks in the pool will have this byte size
+  // which includes the iree_arena_block_t footer.
   iree_host_size_t total_block_size;
   // Block size, in bytes, of the usable bytes within a block.
   iree_host_size_t usable_block_size;
   // Allocator used for allocating/freeing each allocation block.
   iree_allocator_t block_allocator;
-  // Linked list of free blocks (LIFO).
-  iree_atomic_arena_block_slist_t available_slist;
+  // Guards the shared free list.
+  iree_slim_mutex_t mutex;
+  // Linked list of free blocks (LIFO) shared by all magazines.
+  iree_arena_block_t* available_head;
+  // Number of blocks in |available_head|.
+  iree_host_size_t available_count;
+  // Total number of blocks allocated from the block allocator.
+  IREE_STATISTICS(iree_atomic_int64_t allocation_count;)
+  // Number of blocks currently allocated from the block allocator.
+  IREE_STATISTICS(iree_atomic_int64_t block_count;)
+  // Peak value of |block_count|.
+  IREE_STATISTICS(iree_atomic_int64_t peak_block_count;)
+  // Per-thread free block caches checked before the shared free list.
+  iree_arena_block_magazine_t magazines[IREE_ARENA_BLOCK_POOL_MAGAZINE_COUNT];
 } iree_arena_block_pool_t;
 
 // Initializes a new block pool in |out_block_pool|.
@@ -96,6 +161,12 @@ void iree_arena_block_pool_release(iree_arena_block_pool_t* block_pool,
                                    iree_arena_block_t* block_head,
                                    iree_arena_block_t* block_tail);
 
+// Queries the current statistics of |block_pool| into |out_statistics|.
+// All values are zero if statistics are disabled.
+void iree_arena_block_pool_query_statistics(
+    const iree_arena_block_pool_t* block_pool,
+    iree_arena_block_pool_statistics_t* out_statistics);
+
 //===----------------------------------------------------------------------===//
 // iree_arena_allocator_t
 //===----------------------------------------------------------------------===//
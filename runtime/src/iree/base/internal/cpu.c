@@ -150,6 +150,16 @@ static void iree_cpu_initialize_from_platform_arm_64(uint64_t* out_fields) {
           .out_field_index = 0,
           .out_field_bits = IREE_CPU_DATA0_ARM_64_BF16,
       },
+      {
+          .sysctl_key = "hw.optional.arm.FEAT_SME",
+          .out_field_index = 0,
+          .out_field_bits = IREE_CPU_DATA0_ARM_64_SME,
+      },
+      {
+          .sysctl_key = "hw.optional.arm.FEAT_SME2",
+          .out_field_index = 0,
+          .out_field_bits = IREE_CPU_DATA0_ARM_64_SME2,
+      },
   };
   for (int i = 0; i < IREE_ARRAYSIZE(features); ++i) {
     const feature_t* f = &features[i];
@@ -177,6 +187,26 @@ static void iree_cpu_initialize_from_platform_arm_64(uint64_t* out_fields) {
 #include <intrin.h>
 #endif
 
+#if defined(IREE_PLATFORM_LINUX)
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Linux keeps the AMX tile data state disabled (XFD-armed) until the process
+// requests it; the first tile instruction otherwise raises SIGILL. The
+// permission is process-wide so a single request covers every worker thread.
+// https://docs.kernel.org/arch/x86/xstate.html
+#define IREE_ARCH_REQ_XCOMP_PERM 0x1023
+#define IREE_XFEATURE_XTILEDATA 18
+
+static bool iree_cpu_request_amx_permission(void) {
+  return syscall(SYS_arch_prctl, IREE_ARCH_REQ_XCOMP_PERM,
+                 IREE_XFEATURE_XTILEDATA) == 0;
+}
+#else
+// Other platforms enable the tile state for all processes along with XCR0.
+static bool iree_cpu_request_amx_permission(void) { return true; }
+#endif  // IREE_PLATFORM_LINUX
+
 typedef struct iree_cpuid_regs_t {
   uint32_t eax;
   uint32_t ebx;
@@ -301,7 +331,8 @@ static void iree_cpu_initialize_from_platform_x86_64(uint64_t* out_fields) {
   }
 
   // Features that depend on AMX TILE state being enabled by the OS.
-  if (iree_all_bits_set(leafD.eax, 0x60000)) {
+  if (iree_all_bits_set(leafD.eax, 0x60000) &&
+      (leaf7_0.edx & (1 << 24)) && iree_cpu_request_amx_permission()) {
     IREE_COPY_BITS(out0, IREE_CPU_DATA0_X86_64_AMXTILE, leaf7_0.edx, 1 << 24);
     IREE_COPY_BITS(out0, IREE_CPU_DATA0_X86_64_AMXINT8, leaf7_0.edx, 1 << 25);
     IREE_COPY_BITS(out0, IREE_CPU_DATA0_X86_64_AMXBF16, leaf7_0.edx, 1 << 22);
@@ -317,13 +348,36 @@ static void iree_cpu_initialize_from_platform_x86_64(uint64_t* out_fields) {
 // that, and as we are OK with requiring a sufficiently recent linux kernel to
 // expose the features that we need, we can just rely on the basic HWCAP way.
 #include <sys/auxv.h>
+#include <sys/syscall.h>
+#include <unistd.h>
 
 #define IREE_HWCAP_ISA_V (1 << ('V' - 'A'))
 
+// Extensions beyond the single-letter ones are only reported by the
+// riscv_hwprobe syscall (Linux 6.4+). As with HWCAP bits we define what we
+// need locally as not all kernel headers have them.
+// https://docs.kernel.org/arch/riscv/hwprobe.html
+#define IREE_NR_RISCV_HWPROBE 258
+#define IREE_RISCV_HWPROBE_KEY_IMA_EXT_0 4
+#define IREE_RISCV_HWPROBE_EXT_ZVFH (1ull << 30)
+
+typedef struct iree_riscv_hwprobe_t {
+  int64_t key;
+  uint64_t value;
+} iree_riscv_hwprobe_t;
+
 static void iree_cpu_initialize_from_platform_riscv_64(uint64_t* out_fields) {
   unsigned long hwcap = getauxval(AT_HWCAP);
   IREE_COPY_BITS(out_fields[0], IREE_CPU_DATA0_RISCV_64_RVV, hwcap,
                  IREE_HWCAP_ISA_V);
+
+  // Older kernels fail the syscall with ENOSYS and we leave the bits cleared.
+  iree_riscv_hwprobe_t probe = {IREE_RISCV_HWPROBE_KEY_IMA_EXT_0, 0};
+  if (syscall(IREE_NR_RISCV_HWPROBE, &probe, 1, 0, NULL, 0) == 0 &&
+      probe.key == IREE_RISCV_HWPROBE_KEY_IMA_EXT_0) {
+    IREE_COPY_BITS(out_fields[0], IREE_CPU_DATA0_RISCV_64_ZVFH, probe.value,
+                   IREE_RISCV_HWPROBE_EXT_ZVFH);
+  }
 }
 
 #else
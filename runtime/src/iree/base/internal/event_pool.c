@@ -10,26 +10,87 @@
 #include <stddef.h>
 #include <string.h>
 
+#include "iree/base/internal/atomic_slist.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/synchronization.h"
 
+// Number of shards used to spread acquire/release traffic across threads.
+// Each thread prefers a single shard and only touches the shared overflow list
+// (and other shards) when its own is empty or full.
+#if !defined(IREE_EVENT_POOL_SHARD_COUNT)
+#define IREE_EVENT_POOL_SHARD_COUNT 16
+#endif  // !IREE_EVENT_POOL_SHARD_COUNT
+
+// NOTE: threading support is optional.
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#define iree_thread_local static
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201102L) && \
+    !__STDC_NO_THREADS__
+#define iree_thread_local _Thread_local
+#elif defined(IREE_COMPILER_MSVC)
+#define iree_thread_local __declspec(thread)
+#else
+#define iree_thread_local
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+// Storage for a pooled event. Entries are preallocated with the pool and either
+// hold an unsignaled event (when in one of the available lists) or are empty
+// (when in the empty list) as the event is owned by whoever acquired it.
+typedef struct iree_event_pool_entry_t {
+  iree_atomic_slist_intrusive_ptr_t slist_next;
+  iree_event_t event;
+} iree_event_pool_entry_t;
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_event_pool_entry, iree_event_pool_entry_t,
+                                offsetof(iree_event_pool_entry_t, slist_next));
+
+// A list of available entries preferred by a subset of threads.
+// Padded to avoid false sharing between threads using different shards.
+typedef struct iree_event_pool_shard_t {
+  iree_alignas(iree_hardware_destructive_interference_size)
+      iree_event_pool_entry_slist_t available_list;
+  // Approximate number of entries in |available_list|.
+  iree_atomic_int32_t available_count;
+} iree_event_pool_shard_t;
+
 struct iree_event_pool_t {
   // Allocator used to create the event pool.
   iree_allocator_t host_allocator;
-  // Guards the pool. Since this pool is used to get operating system-level
-  // event objects that will be signaled and waited on using syscalls it's got
-  // relatively low contention: callers are rate limited by how fast they can
-  // signal and wait on the events they get.
-  iree_slim_mutex_t mutex;
   // Maximum number of events that will be maintained in the pool. More events
   // may be allocated at any time but when they are no longer needed they will
   // be disposed directly.
   iree_host_size_t available_capacity;
-  // Total number of available
-  iree_host_size_t available_count;
-  // Dense left-aligned list of available_count events.
-  iree_event_t available_list[];
+  // Maximum number of entries each shard retains before releases overflow
+  // into |shared_list|.
+  int32_t shard_capacity;
+  // Approximate total number of available events across all lists. Used to
+  // skip searching when the pool has been exhausted.
+  iree_atomic_int32_t available_count;
+  // Available entries that did not fit in the shard of the releasing thread.
+  iree_event_pool_entry_slist_t shared_list;
+  // Entries that currently hold no event. Releases drawing from an empty list
+  // indicate the pool is at capacity.
+  iree_event_pool_entry_slist_t empty_list;
+  // Per-thread-group caches in front of |shared_list|.
+  iree_event_pool_shard_t shards[IREE_EVENT_POOL_SHARD_COUNT];
+  // Storage for all available_capacity entries.
+  iree_event_pool_entry_t entries[];
 };
 
+// Returns the index of the shard preferred by the calling thread.
+// Threads are assigned shards round-robin on first use so that up to
+// IREE_EVENT_POOL_SHARD_COUNT threads (such as executor workers) each have a
+// shard to themselves regardless of which pool they are using.
+static iree_host_size_t iree_event_pool_thread_shard_index(void) {
+  static iree_atomic_int32_t next_thread_ordinal;
+  static iree_thread_local int32_t thread_ordinal = 0;
+  if (IREE_UNLIKELY(thread_ordinal == 0)) {
+    thread_ordinal = iree_atomic_fetch_add(&next_thread_ordinal, 1,
+                                           iree_memory_order_relaxed) +
+                     1;
+  }
+  return (iree_host_size_t)(thread_ordinal - 1) % IREE_EVENT_POOL_SHARD_COUNT;
+}
+
 iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
                                        iree_allocator_t host_allocator,
                                        iree_event_pool_t** out_event_pool) {
@@ -37,24 +98,50 @@ iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
   *out_event_pool = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  if (available_capacity > INT32_MAX) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "event pool capacity %" PRIhsz " exceeds limits",
+                            available_capacity);
+  }
+
   iree_event_pool_t* event_pool = NULL;
   iree_host_size_t total_size =
       sizeof(*event_pool) +
-      available_capacity * sizeof(event_pool->available_list[0]);
+      available_capacity * sizeof(event_pool->entries[0]);
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0,
       iree_allocator_malloc(host_allocator, total_size, (void**)&event_pool));
   event_pool->host_allocator = host_allocator;
   event_pool->available_capacity = available_capacity;
-  event_pool->available_count = 0;
+  event_pool->shard_capacity = (int32_t)iree_max(
+      1, available_capacity / IREE_EVENT_POOL_SHARD_COUNT);
+  iree_atomic_store(&event_pool->available_count, 0,
+                    iree_memory_order_relaxed);
+  iree_event_pool_entry_slist_initialize(&event_pool->shared_list);
+  iree_event_pool_entry_slist_initialize(&event_pool->empty_list);
+  for (iree_host_size_t i = 0; i < IREE_EVENT_POOL_SHARD_COUNT; ++i) {
+    iree_event_pool_shard_t* shard = &event_pool->shards[i];
+    iree_event_pool_entry_slist_initialize(&shard->available_list);
+    iree_atomic_store(&shard->available_count, 0, iree_memory_order_relaxed);
+  }
 
+  // All events start in the shared list and migrate to shards as threads
+  // release them.
   iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < available_capacity; ++i) {
-    status = iree_event_initialize(
-        /*initial_state=*/false,
-        &event_pool->available_list[event_pool->available_count++]);
+  iree_host_size_t initialized_count = 0;
+  for (; initialized_count < available_capacity; ++initialized_count) {
+    iree_event_pool_entry_t* entry = &event_pool->entries[initialized_count];
+    status = iree_event_initialize(/*initial_state=*/false, &entry->event);
     if (!iree_status_is_ok(status)) break;
+    iree_event_pool_entry_slist_push_unsafe(&event_pool->shared_list, entry);
+  }
+  for (iree_host_size_t i = initialized_count; i < available_capacity; ++i) {
+    iree_event_pool_entry_slist_push_unsafe(&event_pool->empty_list,
+                                            &event_pool->entries[i]);
   }
+  iree_atomic_store(&event_pool->available_count, (int32_t)initialized_count,
+                    iree_memory_order_release);
 
   if (iree_status_is_ok(status)) {
     *out_event_pool = event_pool;
@@ -65,20 +152,70 @@ iree_status_t iree_event_pool_allocate(iree_host_size_t available_capacity,
   return status;
 }
 
+// Deinitializes the events of all entries in |list|.
+static void iree_event_pool_deinitialize_list(
+    iree_event_pool_entry_slist_t* list) {
+  iree_event_pool_entry_t* entry = NULL;
+  iree_event_pool_entry_slist_flush(
+      list, IREE_ATOMIC_SLIST_FLUSH_ORDER_APPROXIMATE_LIFO, &entry, NULL);
+  while (entry) {
+    iree_event_pool_entry_t* next = iree_event_pool_entry_slist_get_next(entry);
+    iree_event_deinitialize(&entry->event);
+    entry = next;
+  }
+  iree_event_pool_entry_slist_deinitialize(list);
+}
+
 void iree_event_pool_free(iree_event_pool_t* event_pool) {
   if (!event_pool) return;
   iree_allocator_t host_allocator = event_pool->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  for (iree_host_size_t i = 0; i < event_pool->available_count; ++i) {
-    iree_event_deinitialize(&event_pool->available_list[i]);
+  for (iree_host_size_t i = 0; i < IREE_EVENT_POOL_SHARD_COUNT; ++i) {
+    iree_event_pool_deinitialize_list(&event_pool->shards[i].available_list);
   }
-  iree_slim_mutex_deinitialize(&event_pool->mutex);
+  iree_event_pool_deinitialize_list(&event_pool->shared_list);
+  iree_event_pool_entry_slist_deinitialize(&event_pool->empty_list);
   iree_allocator_free(host_allocator, event_pool);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Pops an available entry from |shard| or returns NULL if it is empty.
+static iree_event_pool_entry_t* iree_event_pool_shard_pop(
+    iree_event_pool_shard_t* shard) {
+  iree_event_pool_entry_t* entry =
+      iree_event_pool_entry_slist_pop(&shard->available_list);
+  if (entry) {
+    iree_atomic_fetch_sub(&shard->available_count, 1,
+                          iree_memory_order_relaxed);
+  }
+  return entry;
+}
+
+// Pops an available entry preferring the shard of the calling thread, then the
+// shared overflow list, and finally the shards of other threads.
+// Returns NULL if the pool has no available events.
+static iree_event_pool_entry_t* iree_event_pool_pop_available(
+    iree_event_pool_t* event_pool, iree_host_size_t shard_index) {
+  iree_event_pool_entry_t* entry =
+      iree_event_pool_shard_pop(&event_pool->shards[shard_index]);
+  if (!entry && iree_atomic_load(&event_pool->available_count,
+                                 iree_memory_order_relaxed) > 0) {
+    entry = iree_event_pool_entry_slist_pop(&event_pool->shared_list);
+    for (iree_host_size_t i = 1; !entry && i < IREE_EVENT_POOL_SHARD_COUNT;
+         ++i) {
+      entry = iree_event_pool_shard_pop(
+          &event_pool->shards[(shard_index + i) % IREE_EVENT_POOL_SHARD_COUNT]);
+    }
+  }
+  if (entry) {
+    iree_atomic_fetch_sub(&event_pool->available_count, 1,
+                          iree_memory_order_relaxed);
+  }
+  return entry;
+}
+
 iree_status_t iree_event_pool_acquire(iree_event_pool_t* event_pool,
                                       iree_host_size_t event_count,
                                       iree_event_t* out_events) {
@@ -88,21 +225,16 @@ iree_status_t iree_event_pool_acquire(iree_event_pool_t* event_pool,
 
   // We'll try to get what we can from the pool and fall back to initializing
   // new events.
-  iree_host_size_t remaining_count = event_count;
-
-  // Try first to grab from the pool.
-  iree_slim_mutex_lock(&event_pool->mutex);
-  iree_host_size_t from_pool_count =
-      iree_min(event_pool->available_count, event_count);
-  if (from_pool_count > 0) {
-    iree_host_size_t pool_base_index =
-        event_pool->available_count - from_pool_count;
-    memcpy(out_events, &event_pool->available_list[pool_base_index],
-           from_pool_count * sizeof(iree_event_t));
-    event_pool->available_count -= from_pool_count;
-    remaining_count -= from_pool_count;
+  iree_host_size_t shard_index = iree_event_pool_thread_shard_index();
+  iree_host_size_t from_pool_count = 0;
+  for (; from_pool_count < event_count; ++from_pool_count) {
+    iree_event_pool_entry_t* entry =
+        iree_event_pool_pop_available(event_pool, shard_index);
+    if (!entry) break;
+    out_events[from_pool_count] = entry->event;
+    iree_event_pool_entry_slist_push(&event_pool->empty_list, entry);
   }
-  iree_slim_mutex_unlock(&event_pool->mutex);
+  iree_host_size_t remaining_count = event_count - from_pool_count;
 
   // Allocate the rest of the events.
   if (remaining_count > 0) {
@@ -132,27 +264,31 @@ void iree_event_pool_release(iree_event_pool_t* event_pool,
   IREE_ASSERT_ARGUMENT(events);
 
   // We'll try to release all we can back to the pool and then deinitialize
-  // the ones that won't fit.
-  iree_host_size_t remaining_count = event_count;
-
-  // Try first to release to the pool.
+  // the ones that won't fit. Events are returned to the shard of the calling
+  // thread until it is full and then overflow into the shared list.
   // Note that we reset the events we add back to the pool so that they are
   // ready to be acquired again.
-  iree_slim_mutex_lock(&event_pool->mutex);
-  iree_host_size_t to_pool_count =
-      iree_min(event_pool->available_capacity - event_pool->available_count,
-               event_count);
-  if (to_pool_count > 0) {
-    iree_host_size_t pool_base_index = event_pool->available_count;
-    for (iree_host_size_t i = 0; i < to_pool_count; ++i) {
-      iree_event_reset(&events[i]);
+  iree_event_pool_shard_t* shard =
+      &event_pool->shards[iree_event_pool_thread_shard_index()];
+  iree_host_size_t to_pool_count = 0;
+  for (; to_pool_count < event_count; ++to_pool_count) {
+    iree_event_pool_entry_t* entry =
+        iree_event_pool_entry_slist_pop(&event_pool->empty_list);
+    if (!entry) break;  // at capacity
+    iree_event_reset(&events[to_pool_count]);
+    entry->event = events[to_pool_count];
+    if (iree_atomic_load(&shard->available_count, iree_memory_order_relaxed) <
+        event_pool->shard_capacity) {
+      iree_atomic_fetch_add(&shard->available_count, 1,
+                            iree_memory_order_relaxed);
+      iree_event_pool_entry_slist_push(&shard->available_list, entry);
+    } else {
+      iree_event_pool_entry_slist_push(&event_pool->shared_list, entry);
     }
-    memcpy(&event_pool->available_list[pool_base_index], events,
-           to_pool_count * sizeof(iree_event_t));
-    event_pool->available_count += to_pool_count;
-    remaining_count -= to_pool_count;
+    iree_atomic_fetch_add(&event_pool->available_count, 1,
+                          iree_memory_order_relaxed);
   }
-  iree_slim_mutex_unlock(&event_pool->mutex);
+  iree_host_size_t remaining_count = event_count - to_pool_count;
 
   // Deallocate the rest of the events. We don't bother resetting them as we are
   // getting rid of them.
@@ -17,6 +17,9 @@ extern "C" {
 // A simple pool of iree_event_ts to recycle.
 //
 // Thread-safe; multiple threads may acquire and release events from the pool.
+// Each thread prefers one of a fixed set of shards so that acquire and release
+// are normally uncontended when many threads (such as executor workers) are
+// using the same pool. Shards overflow into a shared list when full.
 typedef struct iree_event_pool_t iree_event_pool_t;
 
 // Allocates a new event pool with up to |available_capacity| events.
@@ -0,0 +1,97 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/internal/event_pool.h"
+
+#include <thread>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+TEST(EventPool, Lifetime) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(
+      iree_event_pool_allocate(32, iree_allocator_system(), &event_pool));
+  iree_event_pool_free(event_pool);
+}
+
+TEST(EventPool, ZeroCapacity) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(
+      iree_event_pool_allocate(0, iree_allocator_system(), &event_pool));
+  iree_event_t events[4];
+  IREE_ASSERT_OK(
+      iree_event_pool_acquire(event_pool, IREE_ARRAYSIZE(events), events));
+  iree_event_pool_release(event_pool, IREE_ARRAYSIZE(events), events);
+  iree_event_pool_free(event_pool);
+}
+
+// Tests that events are reset when returned to the pool.
+TEST(EventPool, AcquiredEventsAreUnsignaled) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(
+      iree_event_pool_allocate(4, iree_allocator_system(), &event_pool));
+  iree_event_t events[4];
+  IREE_ASSERT_OK(
+      iree_event_pool_acquire(event_pool, IREE_ARRAYSIZE(events), events));
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(events); ++i) {
+    iree_event_set(&events[i]);
+  }
+  iree_event_pool_release(event_pool, IREE_ARRAYSIZE(events), events);
+  IREE_ASSERT_OK(
+      iree_event_pool_acquire(event_pool, IREE_ARRAYSIZE(events), events));
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(events); ++i) {
+    IREE_EXPECT_STATUS_IS(IREE_STATUS_DEADLINE_EXCEEDED,
+                          iree_wait_one(&events[i], IREE_TIME_INFINITE_PAST));
+  }
+  iree_event_pool_release(event_pool, IREE_ARRAYSIZE(events), events);
+  iree_event_pool_free(event_pool);
+}
+
+// Tests acquiring more events than the pool has available and releasing them
+// all back so the pool has to dispose of the overflow.
+TEST(EventPool, ExceedCapacity) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(
+      iree_event_pool_allocate(2, iree_allocator_system(), &event_pool));
+  iree_event_t events[8];
+  IREE_ASSERT_OK(
+      iree_event_pool_acquire(event_pool, IREE_ARRAYSIZE(events), events));
+  iree_event_pool_release(event_pool, IREE_ARRAYSIZE(events), events);
+  IREE_ASSERT_OK(
+      iree_event_pool_acquire(event_pool, IREE_ARRAYSIZE(events), events));
+  iree_event_pool_release(event_pool, IREE_ARRAYSIZE(events), events);
+  iree_event_pool_free(event_pool);
+}
+
+// Tests that events migrate between threads: each thread releases events it
+// acquired and others are able to pick up from the shared list.
+TEST(EventPool, MultiThreaded) {
+  iree_event_pool_t* event_pool = NULL;
+  IREE_ASSERT_OK(
+      iree_event_pool_allocate(64, iree_allocator_system(), &event_pool));
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([event_pool]() {
+      for (int j = 0; j < 1000; ++j) {
+        iree_event_t events[3];
+        IREE_ASSERT_OK(iree_event_pool_acquire(
+            event_pool, IREE_ARRAYSIZE(events), events));
+        iree_event_set(&events[0]);
+        iree_event_pool_release(event_pool, IREE_ARRAYSIZE(events), events);
+      }
+    });
+  }
+  for (auto& thread : threads) thread.join();
+  iree_event_pool_free(event_pool);
+}
+
+}  // namespace
+}  // namespace iree
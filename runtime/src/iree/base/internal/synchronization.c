@@ -116,6 +116,19 @@ static inline iree_status_code_t iree_futex_wait(void* address,
 // over lower priority waiters.
 static inline void iree_futex_wake(void* address, int32_t count);
 
+// Waits like iree_futex_wait but will only be woken by iree_futex_wake_masked
+// calls with a |wake_mask| intersecting |wait_mask| (or any iree_futex_wake).
+// Platforms without wait bitsets treat this as iree_futex_wait.
+static inline iree_status_code_t iree_futex_wait_masked(
+    void* address, uint32_t expected_value, uint32_t wait_mask,
+    iree_time_t deadline_ns);
+
+// Wakes at most |count| threads waiting for |address| to change with a wait
+// mask intersecting |wake_mask|. Platforms without wait bitsets wake all
+// waiters as they are unable to filter.
+static inline void iree_futex_wake_masked(void* address, int32_t count,
+                                          uint32_t wake_mask);
+
 #if defined(IREE_PLATFORM_EMSCRIPTEN)
 
 static inline iree_status_code_t iree_futex_wait(void* address,
@@ -191,8 +204,55 @@ static inline void iree_futex_wake(void* address, int32_t count) {
           NULL, 0);
 }
 
+#define IREE_FUTEX_HAS_MASKED_WAKE 1
+
+static inline iree_status_code_t iree_futex_wait_masked(
+    void* address, uint32_t expected_value, uint32_t wait_mask,
+    iree_time_t deadline_ns) {
+  // FUTEX_WAIT_BITSET takes an absolute timeout so we can pass the deadline
+  // through without converting it to a relative duration (iree_time_now uses
+  // CLOCK_REALTIME).
+  struct timespec deadline = {
+      .tv_sec = (time_t)(deadline_ns / 1000000000ll),
+      .tv_nsec = (long)(deadline_ns % 1000000000ll),
+  };
+  int rc = syscall(
+      SYS_futex, address,
+      FUTEX_WAIT_BITSET | FUTEX_PRIVATE_FLAG | FUTEX_CLOCK_REALTIME,
+      expected_value,
+      deadline_ns == IREE_TIME_INFINITE_FUTURE ? NULL : &deadline, NULL,
+      wait_mask);
+  if (IREE_LIKELY(rc == 0) || errno == EAGAIN || errno == EINTR) {
+    return IREE_STATUS_OK;
+  } else if (errno == ETIMEDOUT) {
+    return IREE_STATUS_DEADLINE_EXCEEDED;
+  }
+  return IREE_STATUS_UNAVAILABLE;
+}
+
+static inline void iree_futex_wake_masked(void* address, int32_t count,
+                                          uint32_t wake_mask) {
+  syscall(SYS_futex, address, FUTEX_WAKE_BITSET | FUTEX_PRIVATE_FLAG, count,
+          NULL, NULL, wake_mask);
+}
+
 #endif  // IREE_PLATFORM_*
 
+#if !defined(IREE_FUTEX_HAS_MASKED_WAKE)
+
+static inline iree_status_code_t iree_futex_wait_masked(
+    void* address, uint32_t expected_value, uint32_t wait_mask,
+    iree_time_t deadline_ns) {
+  return iree_futex_wait(address, expected_value, deadline_ns);
+}
+
+static inline void iree_futex_wake_masked(void* address, int32_t count,
+                                          uint32_t wake_mask) {
+  iree_futex_wake(address, IREE_ALL_WAITERS);
+}
+
+#endif  // !IREE_FUTEX_HAS_MASKED_WAKE
+
 #endif  // IREE_RUNTIME_USE_FUTEX
 
 //==============================================================================
@@ -616,6 +676,17 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
 
 void iree_notification_cancel_wait(iree_notification_t* notification) {}
 
+void iree_notification_post_masked(iree_notification_t* notification,
+                                   uint32_t wake_mask) {}
+
+bool iree_notification_commit_wait_masked(iree_notification_t* notification,
+                                          iree_wait_token_t wait_token,
+                                          uint32_t wait_mask,
+                                          iree_duration_t spin_ns,
+                                          iree_time_t deadline_ns) {
+  return true;
+}
+
 #elif !defined(IREE_RUNTIME_USE_FUTEX)
 
 // Emulation of a lock-free futex-backed notification using pthreads.
@@ -707,6 +778,22 @@ void iree_notification_cancel_wait(iree_notification_t* notification) {
   pthread_mutex_unlock(&notification->mutex);
 }
 
+// Condition variables cannot filter waiters so masked operations degrade to
+// waking all waiters.
+void iree_notification_post_masked(iree_notification_t* notification,
+                                   uint32_t wake_mask) {
+  iree_notification_post(notification, IREE_ALL_WAITERS);
+}
+
+bool iree_notification_commit_wait_masked(iree_notification_t* notification,
+                                          iree_wait_token_t wait_token,
+                                          uint32_t wait_mask,
+                                          iree_duration_t spin_ns,
+                                          iree_time_t deadline_ns) {
+  return iree_notification_commit_wait(notification, wait_token, spin_ns,
+                                       deadline_ns);
+}
+
 #else
 
 // The 64-bit value used to atomically read-modify-write (RMW) the state is
@@ -760,6 +847,18 @@ void iree_notification_post(iree_notification_t* notification, int32_t count) {
   }
 }
 
+void iree_notification_post_masked(iree_notification_t* notification,
+                                   uint32_t wake_mask) {
+  uint64_t previous_value =
+      iree_atomic_fetch_add(&notification->value, IREE_NOTIFICATION_EPOCH_INC,
+                            iree_memory_order_acq_rel);
+  // Ensure we have at least one waiter; wake all of those in the mask.
+  if (IREE_UNLIKELY(previous_value & IREE_NOTIFICATION_WAITER_MASK)) {
+    iree_futex_wake_masked(iree_notification_epoch_address(notification),
+                           IREE_ALL_WAITERS, wake_mask);
+  }
+}
+
 iree_wait_token_t iree_notification_prepare_wait(
     iree_notification_t* notification) {
   uint64_t previous_value =
@@ -782,10 +881,9 @@ static iree_notification_result_t iree_notification_test_wait_condition(
              : IREE_NOTIFICATION_RESULT_UNRESOLVED;
 }
 
-bool iree_notification_commit_wait(iree_notification_t* notification,
-                                   iree_wait_token_t wait_token,
-                                   iree_duration_t spin_ns,
-                                   iree_time_t deadline_ns) {
+static bool iree_notification_commit_wait_internal(
+    iree_notification_t* notification, iree_wait_token_t wait_token,
+    uint32_t wait_mask, iree_duration_t spin_ns, iree_time_t deadline_ns) {
   // Quick check to see if the wait has already succeeded (the epoch advances
   // from when it was captured in iree_notification_prepare_wait).
   iree_notification_result_t result =
@@ -813,8 +911,12 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
   if (deadline_ns != IREE_TIME_INFINITE_PAST) {
     while (result == IREE_NOTIFICATION_RESULT_UNRESOLVED) {
       iree_status_code_t status_code =
-          iree_futex_wait(iree_notification_epoch_address(notification),
-                          wait_token, deadline_ns);
+          wait_mask == IREE_NOTIFICATION_MASK_ALL
+              ? iree_futex_wait(iree_notification_epoch_address(notification),
+                                wait_token, deadline_ns)
+              : iree_futex_wait_masked(
+                    iree_notification_epoch_address(notification), wait_token,
+                    wait_mask, deadline_ns);
       if (status_code != IREE_STATUS_OK) {
         result = IREE_NOTIFICATION_RESULT_REJECTED;
         break;
@@ -834,6 +936,25 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
   return result == IREE_NOTIFICATION_RESULT_RESOLVED;
 }
 
+bool iree_notification_commit_wait(iree_notification_t* notification,
+                                   iree_wait_token_t wait_token,
+                                   iree_duration_t spin_ns,
+                                   iree_time_t deadline_ns) {
+  return iree_notification_commit_wait_internal(notification, wait_token,
+                                                IREE_NOTIFICATION_MASK_ALL,
+                                                spin_ns, deadline_ns);
+}
+
+bool iree_notification_commit_wait_masked(iree_notification_t* notification,
+                                          iree_wait_token_t wait_token,
+                                          uint32_t wait_mask,
+                                          iree_duration_t spin_ns,
+                                          iree_time_t deadline_ns) {
+  return iree_notification_commit_wait_internal(notification, wait_token,
+                                                wait_mask, spin_ns,
+                                                deadline_ns);
+}
+
 void iree_notification_cancel_wait(iree_notification_t* notification) {
   // TODO(benvanik): benchmark under real workloads.
   // iree_memory_order_relaxed would suffice for correctness but the faster
@@ -432,6 +432,45 @@ bool iree_notification_commit_wait(iree_notification_t* notification,
 //   guaranteed.
 void iree_notification_cancel_wait(iree_notification_t* notification);
 
+// Wait mask that matches all posts.
+#define IREE_NOTIFICATION_MASK_ALL 0xFFFFFFFFu
+
+// Defined to 1 if iree_notification_post_masked is able to wake only the
+// waiters whose masks intersect the posted mask in a single operation
+// (FUTEX_WAKE_BITSET). When 0 masked posts fall back to waking all waiters and
+// callers waking a small subset of many waiters may prefer to use one
+// notification per waiter instead.
+#if !IREE_SYNCHRONIZATION_DISABLE_UNSAFE && \
+    defined(IREE_RUNTIME_USE_FUTEX) &&       \
+    (defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX))
+#define IREE_NOTIFICATION_HAS_MASKED_WAKE 1
+#else
+#define IREE_NOTIFICATION_HAS_MASKED_WAKE 0
+#endif  // IREE_RUNTIME_USE_FUTEX && LINUX
+
+// Notifies all waiters that committed with a wait mask intersecting
+// |wake_mask|. Waiters outside of the mask remain blocked in the system wait
+// API. This allows a single notification shared by many waiters to wake an
+// arbitrary subset of them with one system call.
+//
+// Note that the epoch advances for all waiters: waiters that have prepared but
+// not yet committed their wait will not block regardless of their mask and
+// must recheck their conditions.
+//
+// Acts as (at least) a memory_order_release operation on the notification
+// object like iree_notification_post.
+void iree_notification_post_masked(iree_notification_t* notification,
+                                   uint32_t wake_mask);
+
+// Commits a pending wait operation like iree_notification_commit_wait that is
+// only woken by iree_notification_post_masked calls with a wake mask
+// intersecting |wait_mask| (or any iree_notification_post).
+bool iree_notification_commit_wait_masked(iree_notification_t* notification,
+                                          iree_wait_token_t wait_token,
+                                          uint32_t wait_mask,
+                                          iree_duration_t spin_ns,
+                                          iree_time_t deadline_ns);
+
 // Returns true if the condition is true.
 // |arg| is the |condition_arg| passed to the await function.
 // Implementations must ensure they are coherent with their state values.
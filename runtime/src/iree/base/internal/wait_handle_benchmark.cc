@@ -0,0 +1,102 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstddef>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/base/internal/wait_handle.h"
+
+// Benchmarks iree_wait_set_t in the way the task poller uses it: many
+// outstanding unsignaled waits with one becoming signaled per wake.
+//
+// The wait set implementation is selected at compile time; to compare
+// implementations build with e.g. -DIREE_WAIT_API=4 (ppoll) or
+// -DIREE_WAIT_API=5 (epoll) as defined in wait_handle_impl.h.
+
+namespace {
+
+// A wait set with |count| unsignaled events registered.
+class PendingWaitSet {
+ public:
+  explicit PendingWaitSet(int64_t count) : events_(count) {
+    IREE_CHECK_OK(iree_wait_set_allocate(count + 1, iree_allocator_system(),
+                                         &wait_set_));
+    for (iree_event_t& event : events_) {
+      IREE_CHECK_OK(iree_event_initialize(/*initial_state=*/false, &event));
+      IREE_CHECK_OK(iree_wait_set_insert(wait_set_, event));
+    }
+  }
+  ~PendingWaitSet() {
+    iree_wait_set_free(wait_set_);
+    for (iree_event_t& event : events_) {
+      iree_event_deinitialize(&event);
+    }
+  }
+
+  iree_wait_set_t* wait_set() { return wait_set_; }
+
+ private:
+  iree_wait_set_t* wait_set_ = NULL;
+  std::vector<iree_event_t> events_;
+};
+
+//==============================================================================
+// iree_wait_any
+//==============================================================================
+
+// Waits on a set where only the most recently inserted handle is signaled.
+// Cost should be independent of the number of pending handles when the
+// implementation only reports ready handles.
+void BM_WaitAnyOneSignaled(benchmark::State& state) {
+  PendingWaitSet pending(state.range(0));
+  iree_event_t signaled;
+  IREE_CHECK_OK(iree_event_initialize(/*initial_state=*/true, &signaled));
+  IREE_CHECK_OK(iree_wait_set_insert(pending.wait_set(), signaled));
+  for (auto _ : state) {
+    iree_wait_handle_t wake_handle;
+    IREE_CHECK_OK(iree_wait_any(pending.wait_set(), IREE_TIME_INFINITE_PAST,
+                                &wake_handle));
+    benchmark::DoNotOptimize(wake_handle);
+  }
+  iree_event_deinitialize(&signaled);
+}
+BENCHMARK(BM_WaitAnyOneSignaled)->RangeMultiplier(4)->Range(1, 1024);
+
+// Inserts a signaled handle, wakes on it, and erases it as the task poller
+// does for each wait task that completes while others remain outstanding.
+void BM_InsertWaitAnyErase(benchmark::State& state) {
+  PendingWaitSet pending(state.range(0));
+  iree_event_t signaled;
+  IREE_CHECK_OK(iree_event_initialize(/*initial_state=*/true, &signaled));
+  for (auto _ : state) {
+    IREE_CHECK_OK(iree_wait_set_insert(pending.wait_set(), signaled));
+    iree_wait_handle_t wake_handle;
+    IREE_CHECK_OK(iree_wait_any(pending.wait_set(), IREE_TIME_INFINITE_PAST,
+                                &wake_handle));
+    iree_wait_set_erase(pending.wait_set(), wake_handle);
+  }
+  iree_event_deinitialize(&signaled);
+}
+BENCHMARK(BM_InsertWaitAnyErase)->RangeMultiplier(4)->Range(1, 1024);
+
+// Polls a set where no handle is signaled.
+void BM_WaitAnyNoneSignaled(benchmark::State& state) {
+  PendingWaitSet pending(state.range(0));
+  for (auto _ : state) {
+    iree_wait_handle_t wake_handle;
+    iree_status_t status = iree_wait_any(
+        pending.wait_set(), IREE_TIME_INFINITE_PAST, &wake_handle);
+    if (!iree_status_is_deadline_exceeded(status)) {
+      state.SkipWithError("expected the wait to time out");
+    }
+    iree_status_ignore(status);
+  }
+}
+BENCHMARK(BM_WaitAnyNoneSignaled)->RangeMultiplier(4)->Range(1, 1024);
+
+}  // namespace
@@ -9,57 +9,361 @@
 
 #if IREE_WAIT_API == IREE_WAIT_API_EPOLL
 
+#include <errno.h>
+#include <poll.h>
+#include <sys/epoll.h>
+#include <unistd.h>
+
 #include "iree/base/internal/wait_handle_posix.h"
 
+//===----------------------------------------------------------------------===//
+// Platform utilities
+//===----------------------------------------------------------------------===//
+
+// epoll/poll may spuriously wake with an EINTR. We don't do anything with that
+// opportunity (no fancy signal stuff), but we do need to retry the wait and
+// ensure that we do so with an updated timeout based on the deadline.
+//
+// Both only support millisecond timeouts; iree_absolute_deadline_to_timeout_ms
+// rounds up so that we never return before the deadline has elapsed.
+//
+// Documentation: https://man7.org/linux/man-pages/man7/epoll.7.html
+
+static iree_status_t iree_syscall_epoll_wait(int epoll_fd,
+                                             struct epoll_event* events,
+                                             int max_events,
+                                             iree_time_t deadline_ns,
+                                             int* out_signaled_count) {
+  *out_signaled_count = 0;
+  int rv = -1;
+  do {
+    uint32_t timeout_ms = iree_absolute_deadline_to_timeout_ms(deadline_ns);
+    rv = epoll_wait(epoll_fd, events, max_events, (int)timeout_ms);
+  } while (rv < 0 && errno == EINTR);
+  if (rv > 0) {
+    // One or more events set.
+    *out_signaled_count = rv;
+    return iree_ok_status();
+  } else if (IREE_UNLIKELY(rv < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "epoll_wait failure %d", errno);
+  }
+  // rv == 0
+  // Timeout; no events set.
+  return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+}
+
+// Waits for a single |fd| to become readable. Used for one-shot waits where
+// registering with an epoll instance would cost more syscalls than it saves.
+static iree_status_t iree_syscall_poll_one(int fd, iree_time_t deadline_ns) {
+  struct pollfd poll_fd;
+  poll_fd.fd = fd;
+  poll_fd.events = POLLIN | POLLPRI;
+  poll_fd.revents = 0;
+  int rv = -1;
+  do {
+    uint32_t timeout_ms = iree_absolute_deadline_to_timeout_ms(deadline_ns);
+    rv = poll(&poll_fd, 1, (int)timeout_ms);
+  } while (rv < 0 && errno == EINTR);
+  if (IREE_UNLIKELY(rv < 0)) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "poll failure %d", errno);
+  } else if (rv == 0) {
+    return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+  if (poll_fd.revents & POLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "POLLERR on fd");
+  } else if (poll_fd.revents & POLLHUP) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "POLLHUP on fd");
+  } else if (poll_fd.revents & POLLNVAL) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "POLLNVAL on fd");
+  }
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // iree_wait_set_t
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): iree_wait_set_s using an epoll fd.
-// epoll lets us route the wait set operations right to kernel and not need our
-// own duplicate data structure. epoll is great, just not available on mac/ios
-// so we still need poll for that. linux/android/bsd all have epoll, though.
+// epoll lets us route the wait set operations right to the kernel: each unique
+// fd is registered once on insertion and stays registered across waits so a
+// wait costs a single syscall and only reports the fds that are ready instead
+// of rebuilding and scanning the whole handle list as poll requires.
+//
+// Registrations are level-triggered: wait handles are manual-reset and must
+// keep being reported as signaled by each wait until they are reset or erased.
+// Edge-triggered registrations would report each signal only once.
 struct iree_wait_set_t {
-  // NOTE: we could in theory use the epoll handle directly (iree_wait_set_s
-  // then is just a pointer). Then allocate/free just go straight to the system.
-  int reserved;
+  iree_allocator_t allocator;
+
+  // epoll instance holding one registration per unique handle with an fd.
+  // Each registration carries the index of its handle in user_handles.
+  int epoll_fd;
+
+  // Total capacity of the user_handles list.
+  iree_host_size_t handle_capacity;
+
+  // Total number of valid unique user_handles.
+  iree_host_size_t handle_count;
+
+  // User-provided handles with set_internal.dupe_count tracking the number of
+  // additional insertions of the same handle. Handles without an fd (such as
+  // immediate handles) are tracked here so that they can be erased but never
+  // registered with epoll as they will never be signaled.
+  iree_wait_handle_t* user_handles;
 };
 
 iree_status_t iree_wait_set_allocate(iree_host_size_t capacity,
                                      iree_allocator_t allocator,
                                      iree_wait_set_t** out_set) {
-  // TODO(benvanik): epoll_create()
+  IREE_ASSERT_ARGUMENT(out_set);
+
+  // Handle indices are tracked in 16-bit fields of iree_wait_handle_t.
+  if (capacity >= UINT16_MAX) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "wait set capacity of %" PRIhsz " is unreasonably large", capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_host_size_t user_handle_list_size =
+      capacity * iree_sizeof_struct(iree_wait_handle_t);
+  iree_host_size_t total_size =
+      iree_sizeof_struct(iree_wait_set_t) + user_handle_list_size;
+
+  iree_wait_set_t* set = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(allocator, total_size, (void**)&set));
+  set->allocator = allocator;
+  set->handle_capacity = capacity;
+  set->handle_count = 0;
+  set->user_handles =
+      (iree_wait_handle_t*)((uint8_t*)set +
+                            iree_sizeof_struct(iree_wait_set_t));
+
+  set->epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+  if (IREE_UNLIKELY(set->epoll_fd < 0)) {
+    iree_status_t status = iree_make_status(iree_status_code_from_errno(errno),
+                                            "epoll_create1 failure %d", errno);
+    iree_allocator_free(allocator, set);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  *out_set = set;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 void iree_wait_set_free(iree_wait_set_t* set) {
-  // TODO(benvanik): close()
+  if (!set) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // Closing the epoll instance drops all of its registrations.
+  close(set->epoll_fd);
+  iree_allocator_free(set->allocator, set);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+bool iree_wait_set_is_empty(const iree_wait_set_t* set) {
+  return set->handle_count == 0;
+}
+
+// Returns the index of |handle| in the set or handle_count if not found.
+static iree_host_size_t iree_wait_set_find(const iree_wait_set_t* set,
+                                           const iree_wait_handle_t* handle) {
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    if (iree_wait_primitive_compare_identical(&set->user_handles[i], handle)) {
+      return i;
+    }
+  }
+  return set->handle_count;
+}
+
+// Registers |fd| with the epoll instance of |set| routing events to |index|.
+static int iree_wait_set_epoll_ctl(iree_wait_set_t* set, int op, int fd,
+                                   iree_host_size_t index) {
+  struct epoll_event event;
+  memset(&event, 0, sizeof(event));
+  event.events = EPOLLIN | EPOLLPRI;  // implicit EPOLLERR | EPOLLHUP
+  event.data.u32 = (uint32_t)index;
+  return epoll_ctl(set->epoll_fd, op, fd, &event);
 }
 
 iree_status_t iree_wait_set_insert(iree_wait_set_t* set,
                                    iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_ADD)
+  int fd = iree_wait_primitive_get_read_fd(&handle);
+
+  // Most insertions are of unique handles so we optimistically register the
+  // handle and let the kernel tell us if it is a duplicate. Only duplicates
+  // and handles without an fd need to scan the set.
+  if (fd >= 0 && set->handle_count < set->handle_capacity) {
+    if (iree_wait_set_epoll_ctl(set, EPOLL_CTL_ADD, fd, set->handle_count) ==
+        0) {
+      iree_host_size_t index = set->handle_count++;
+      iree_wait_handle_wrap_primitive(handle.type, handle.value,
+                                      &set->user_handles[index]);
+      return iree_ok_status();
+    } else if (errno != EEXIST) {
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "epoll_ctl(EPOLL_CTL_ADD) failure %d", errno);
+    }
+  }
+
+  iree_host_size_t index = iree_wait_set_find(set, &handle);
+  if (index < set->handle_count) {
+    iree_wait_handle_t* user_handle = &set->user_handles[index];
+    if (IREE_UNLIKELY(user_handle->set_internal.dupe_count == UINT16_MAX)) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "wait handle duplicate count reached");
+    }
+    ++user_handle->set_internal.dupe_count;
+    return iree_ok_status();
+  }
+
+  if (set->handle_count + 1 > set->handle_capacity) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait set capacity reached");
+  }
+  index = set->handle_count++;
+  iree_wait_handle_wrap_primitive(handle.type, handle.value,
+                                  &set->user_handles[index]);
+  return iree_ok_status();
 }
 
 void iree_wait_set_erase(iree_wait_set_t* set, iree_wait_handle_t handle) {
-  // TODO(benvanik): epoll_ctl(EPOLL_CTL_DEL)
+  // Find the user handle in the set. If the handle came from an iree_wait_any
+  // wake we can use its index for a quick lookup and otherwise need a linear
+  // scan.
+  iree_host_size_t index = handle.set_internal.index;
+  if (IREE_UNLIKELY(index >= set->handle_count) ||
+      IREE_UNLIKELY(!iree_wait_primitive_compare_identical(
+          &set->user_handles[index], &handle))) {
+    index = iree_wait_set_find(set, &handle);
+    if (index == set->handle_count) return;  // not found
+  }
+
+  // Drop one instance if the handle was inserted multiple times.
+  iree_wait_handle_t* user_handle = &set->user_handles[index];
+  if (user_handle->set_internal.dupe_count > 0) {
+    --user_handle->set_internal.dupe_count;
+    return;
+  }
+
+  // NOTE: the fd may have already been closed (which implicitly removes it
+  // from the epoll instance) so failures are ignored.
+  int fd = iree_wait_primitive_get_read_fd(user_handle);
+  if (fd >= 0) {
+    epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+  }
+
+  // Since we make no guarantees about the order of the list we can just swap
+  // with the last value. The registration of the moved handle must be updated
+  // to route its events to the new index.
+  iree_host_size_t tail_index = set->handle_count - 1;
+  if (tail_index > index) {
+    memcpy(user_handle, &set->user_handles[tail_index], sizeof(*user_handle));
+    int tail_fd = iree_wait_primitive_get_read_fd(user_handle);
+    if (tail_fd >= 0) {
+      iree_wait_set_epoll_ctl(set, EPOLL_CTL_MOD, tail_fd, index);
+    }
+  }
+  --set->handle_count;
 }
 
 void iree_wait_set_clear(iree_wait_set_t* set) {
-  // TODO(benvanik): close and reopen?
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    int fd = iree_wait_primitive_get_read_fd(&set->user_handles[i]);
+    if (fd >= 0) {
+      epoll_ctl(set->epoll_fd, EPOLL_CTL_DEL, fd, NULL);
+    }
+  }
+  set->handle_count = 0;
+}
+
+// Maps an epoll event bitfield result to a status (on failure).
+static iree_status_t iree_wait_set_resolve_epoll_events(uint32_t events) {
+  if (events & EPOLLERR) {
+    return iree_make_status(IREE_STATUS_INTERNAL, "EPOLLERR on fd");
+  } else if (events & EPOLLHUP) {
+    return iree_make_status(IREE_STATUS_CANCELLED, "EPOLLHUP on fd");
+  }
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_all(iree_wait_set_t* set, iree_time_t deadline_ns) {
-  // TODO(benvanik): epoll_wait
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // epoll can only tell us which handles are ready, not wait for all of them.
+  // As handles remain signaled until reset we wait on each one in turn: once
+  // the last wait returns all handles have been signaled. Wait-all is rare
+  // (wait-any is what the task system uses) so the extra syscalls are fine.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < set->handle_count; ++i) {
+    int fd = iree_wait_primitive_get_read_fd(&set->user_handles[i]);
+    if (fd < 0) continue;
+    status = iree_syscall_poll_one(fd, deadline_ns);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 iree_status_t iree_wait_any(iree_wait_set_t* set, iree_time_t deadline_ns,
                             iree_wait_handle_t* out_wake_handle) {
-  // TODO(benvanik): epoll_wait
+  if (out_wake_handle) {
+    memset(out_wake_handle, 0, sizeof(*out_wake_handle));
+  }
+
+  // Make the syscall only when we have at least one valid fd.
+  // Don't use this as a sleep.
+  if (set->handle_count <= 0) {
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // We only need one event: the kernel rotates level-triggered events that it
+  // reports to the back of its ready list so that repeated waits are fair.
+  struct epoll_event event;
+  int signaled_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_syscall_epoll_wait(set->epoll_fd, &event, 1, deadline_ns,
+                                  &signaled_count));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_wait_set_resolve_epoll_events(event.events));
+
+  iree_host_size_t index = event.data.u32;
+  if (out_wake_handle && index < set->handle_count) {
+    memcpy(out_wake_handle, &set->user_handles[index],
+           sizeof(*out_wake_handle));
+    out_wake_handle->set_internal.index = index;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
 }
 
 iree_status_t iree_wait_one(iree_wait_handle_t* handle,
                             iree_time_t deadline_ns) {
-  // TODO(benvanik): just use poll?
+  int fd = iree_wait_primitive_get_read_fd(handle);
+  if (fd == -1) return iree_ok_status();
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // A one-shot wait on a single handle is cheaper with poll than creating,
+  // registering, and destroying an epoll instance.
+  iree_status_t status = iree_syscall_poll_one(fd, deadline_ns);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 #endif  // IREE_WAIT_API == IREE_WAIT_API_EPOLL
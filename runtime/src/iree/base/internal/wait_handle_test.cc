@@ -726,6 +726,49 @@ TEST(WaitSet, WaitAnyErase) {
   iree_event_deinitialize(&ev_set);
 }
 
+// Tests that erasing a handle that moves others within the set still reports
+// the moved handles when they are signaled.
+TEST(WaitSet, EraseReordersHandles) {
+  iree_event_t ev_unset_0, ev_unset_1;
+  iree_event_t ev_set;
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &ev_unset_0));
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/false, &ev_unset_1));
+  IREE_ASSERT_OK(iree_event_initialize(/*initial_state=*/true, &ev_set));
+  iree_wait_set_t* wait_set = NULL;
+  IREE_ASSERT_OK(
+      iree_wait_set_allocate(128, iree_allocator_system(), &wait_set));
+
+  IREE_ASSERT_OK(iree_wait_set_insert(wait_set, ev_unset_0));
+  IREE_ASSERT_OK(iree_wait_set_insert(wait_set, ev_unset_1));
+  IREE_ASSERT_OK(iree_wait_set_insert(wait_set, ev_set));
+
+  // Erasing the head may move the tail (ev_set) into its place.
+  iree_wait_set_erase(wait_set, ev_unset_0);
+
+  // The wake handle should still be ev_set and erasing it should leave only
+  // ev_unset_1 in the set.
+  iree_wait_handle_t wake_handle;
+  IREE_ASSERT_OK(
+      iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+  EXPECT_EQ(0, memcmp(&ev_set.value, &wake_handle.value, sizeof(ev_set.value)));
+  iree_wait_set_erase(wait_set, wake_handle);
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+
+  // Signaling the remaining handle should wake it.
+  iree_event_set(&ev_unset_1);
+  IREE_ASSERT_OK(
+      iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST, &wake_handle));
+  EXPECT_EQ(0, memcmp(&ev_unset_1.value, &wake_handle.value,
+                      sizeof(ev_unset_1.value)));
+
+  iree_wait_set_free(wait_set);
+  iree_event_deinitialize(&ev_unset_0);
+  iree_event_deinitialize(&ev_unset_1);
+  iree_event_deinitialize(&ev_set);
+}
+
 // Tests that an iree_wait_any followed by an iree_wait_set_erase properly
 // chooses the right handle to erase (the tail one).
 TEST(WaitSet, WaitAnyEraseTail) {
@@ -0,0 +1,1395 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Needed to access syscall() on Linux.
+#define _GNU_SOURCE
+
+#include "iree/base/loop_io_uring.h"
+
+#if defined(IREE_PLATFORM_LINUX) && defined(IREE_HAVE_WAIT_TYPE_EVENTFD)
+
+#include <errno.h>
+#include <linux/io_uring.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "iree/base/internal/math.h"
+#include "iree/base/internal/wait_handle.h"
+
+//===----------------------------------------------------------------------===//
+// iree_loop_io_uring_t utilities
+//===----------------------------------------------------------------------===//
+
+// Amount of time that can remain in a wait-until while still retiring.
+// See IREE_LOOP_SYNC_DELAY_SLOP_NS; ring timeouts have the same granularity
+// as other system timers.
+#define IREE_LOOP_IO_URING_DELAY_SLOP_NS (2 /*ms*/ * 1000000)
+
+// Completion user_data of ring operations whose results are not interesting
+// (such as poll and timeout removals).
+#define IREE_LOOP_IO_URING_USER_DATA_IGNORED 0ull
+
+// Wait operation identifier reserved for the ring timeout used to bound
+// blocking waits. Wait operations are assigned identifiers in
+// [1, IREE_LOOP_IO_URING_TIMEOUT_ID).
+#define IREE_LOOP_IO_URING_TIMEOUT_ID UINT32_MAX
+
+// Completion user_data is the identifier of the owning wait operation in the
+// upper 32 bits and the index of the wait source (or timeout generation) in the
+// lower 32 bits. Identifiers are never reused while an operation is pending
+// so completions of retired operations can be detected and dropped.
+static inline uint64_t iree_loop_io_uring_make_user_data(uint32_t id,
+                                                         uint32_t index) {
+  return ((uint64_t)id << 32) | index;
+}
+
+// NOTE: all callbacks should be at offset 0. This allows for easily zipping
+// through the params lists and issuing callbacks.
+static_assert(offsetof(iree_loop_call_params_t, callback) == 0,
+              "callback must be at offset 0");
+static_assert(offsetof(iree_loop_dispatch_params_t, callback) == 0,
+              "callback must be at offset 0");
+static_assert(offsetof(iree_loop_wait_until_params_t, callback) == 0,
+              "callback must be at offset 0");
+static_assert(offsetof(iree_loop_wait_one_params_t, callback) == 0,
+              "callback must be at offset 0");
+static_assert(offsetof(iree_loop_wait_multi_params_t, callback) == 0,
+              "callback must be at offset 0");
+
+static void iree_loop_io_uring_abort_scope(
+    iree_loop_io_uring_t* loop_io_uring, iree_loop_io_uring_scope_t* scope);
+
+//===----------------------------------------------------------------------===//
+// iree_io_uring_t
+//===----------------------------------------------------------------------===//
+
+// A minimal io_uring instance with its submission and completion queues mapped
+// into the process. We only use a handful of operations and avoid depending on
+// liburing so that the runtime has no additional system dependencies.
+//
+// The loop is thread-compatible and we never use SQPOLL so the kernel only
+// reads the submission queue during io_uring_enter. The completion queue is
+// written by the kernel asynchronously and its tail must be read with acquire
+// semantics.
+typedef struct iree_io_uring_t {
+  // Ring file descriptor or -1 if not initialized.
+  int fd;
+
+  // Submission queue head/tail shared with the kernel.
+  uint32_t* sq_head;
+  uint32_t* sq_tail;
+  uint32_t sq_mask;
+  uint32_t sq_entries;
+  // Indirection array mapping submission queue slots to |sqes|.
+  uint32_t* sq_array;
+  // Submission queue entries.
+  struct io_uring_sqe* sqes;
+  // Tail of the submission queue including entries that have been prepared but
+  // not yet published to the kernel.
+  uint32_t sq_local_tail;
+  // Number of prepared entries that have not yet been submitted.
+  uint32_t sq_pending_count;
+
+  // Completion queue head/tail shared with the kernel.
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t cq_mask;
+  // Completion queue entries.
+  struct io_uring_cqe* cqes;
+
+  // Mapped regions. The completion queue ring may alias the submission queue
+  // ring when the kernel supports IORING_FEAT_SINGLE_MMAP.
+  void* sq_ring_ptr;
+  iree_host_size_t sq_ring_size;
+  void* cq_ring_ptr;
+  iree_host_size_t cq_ring_size;
+  iree_host_size_t sqes_size;
+} iree_io_uring_t;
+
+static int iree_syscall_io_uring_setup(uint32_t entries,
+                                       struct io_uring_params* params) {
+  return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int iree_syscall_io_uring_enter(int fd, uint32_t to_submit,
+                                       uint32_t min_complete, uint32_t flags) {
+  return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags,
+                      NULL, 0);
+}
+
+static void iree_io_uring_deinitialize(iree_io_uring_t* ring) {
+  if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring_ptr && ring->cq_ring_ptr != ring->sq_ring_ptr) {
+    munmap(ring->cq_ring_ptr, ring->cq_ring_size);
+  }
+  if (ring->sq_ring_ptr) munmap(ring->sq_ring_ptr, ring->sq_ring_size);
+  if (ring->fd >= 0) close(ring->fd);
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+static iree_status_t iree_io_uring_initialize(uint32_t entries,
+                                              iree_io_uring_t* out_ring) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, entries);
+  memset(out_ring, 0, sizeof(*out_ring));
+  out_ring->fd = -1;
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int fd = iree_syscall_io_uring_setup(entries, &params);
+  if (fd < 0) {
+    int err = errno;
+    IREE_TRACE_ZONE_END(z0);
+    if (err == ENOSYS || err == EPERM || err == EACCES) {
+      // Not built into the kernel or disabled by policy (seccomp filters in
+      // containers, kernel.io_uring_disabled, etc).
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "io_uring is not available (%d)", err);
+    }
+    return iree_make_status(iree_status_code_from_errno(err),
+                            "io_uring_setup failure %d", err);
+  }
+  out_ring->fd = fd;
+
+  out_ring->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  out_ring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    out_ring->sq_ring_size =
+        iree_max(out_ring->sq_ring_size, out_ring->cq_ring_size);
+    out_ring->cq_ring_size = out_ring->sq_ring_size;
+  }
+
+  iree_status_t status = iree_ok_status();
+  void* sq_ring_ptr =
+      mmap(NULL, out_ring->sq_ring_size, PROT_READ | PROT_WRITE,
+           MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQ_RING);
+  if (sq_ring_ptr == MAP_FAILED) {
+    status =
+        iree_make_status(iree_status_code_from_errno(errno),
+                         "io_uring submission ring mmap failure %d", errno);
+  } else {
+    out_ring->sq_ring_ptr = sq_ring_ptr;
+  }
+
+  if (iree_status_is_ok(status)) {
+    if (single_mmap) {
+      out_ring->cq_ring_ptr = out_ring->sq_ring_ptr;
+    } else {
+      void* cq_ring_ptr =
+          mmap(NULL, out_ring->cq_ring_size, PROT_READ | PROT_WRITE,
+               MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_CQ_RING);
+      if (cq_ring_ptr == MAP_FAILED) {
+        status =
+            iree_make_status(iree_status_code_from_errno(errno),
+                             "io_uring completion ring mmap failure %d", errno);
+      } else {
+        out_ring->cq_ring_ptr = cq_ring_ptr;
+      }
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    out_ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    void* sqes = mmap(NULL, out_ring->sqes_size, PROT_READ | PROT_WRITE,
+                      MAP_SHARED | MAP_POPULATE, fd, IORING_OFF_SQES);
+    if (sqes == MAP_FAILED) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "io_uring entries mmap failure %d", errno);
+    } else {
+      out_ring->sqes = (struct io_uring_sqe*)sqes;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    uint8_t* sq_ring = (uint8_t*)out_ring->sq_ring_ptr;
+    out_ring->sq_head = (uint32_t*)(sq_ring + params.sq_off.head);
+    out_ring->sq_tail = (uint32_t*)(sq_ring + params.sq_off.tail);
+    out_ring->sq_mask = *(uint32_t*)(sq_ring + params.sq_off.ring_mask);
+    out_ring->sq_entries = *(uint32_t*)(sq_ring + params.sq_off.ring_entries);
+    out_ring->sq_array = (uint32_t*)(sq_ring + params.sq_off.array);
+    out_ring->sq_local_tail = *out_ring->sq_tail;
+    uint8_t* cq_ring = (uint8_t*)out_ring->cq_ring_ptr;
+    out_ring->cq_head = (uint32_t*)(cq_ring + params.cq_off.head);
+    out_ring->cq_tail = (uint32_t*)(cq_ring + params.cq_off.tail);
+    out_ring->cq_mask = *(uint32_t*)(cq_ring + params.cq_off.ring_mask);
+    out_ring->cqes = (struct io_uring_cqe*)(cq_ring + params.cq_off.cqes);
+  } else {
+    iree_io_uring_deinitialize(out_ring);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Submits all prepared entries to the kernel and, if |min_complete| is
+// non-zero, blocks until at least that many completions are available.
+// Returns OK if the wait was interrupted; callers are expected to check the
+// completion queue and try again.
+static iree_status_t iree_io_uring_enter(iree_io_uring_t* ring,
+                                         uint32_t min_complete) {
+  if (!ring->sq_pending_count && !min_complete) return iree_ok_status();
+
+  // Publish the prepared entries; the kernel reads them during the syscall.
+  __atomic_store_n(ring->sq_tail, ring->sq_local_tail, __ATOMIC_RELEASE);
+
+  uint32_t flags = min_complete ? IORING_ENTER_GETEVENTS : 0;
+  int rv = iree_syscall_io_uring_enter(ring->fd, ring->sq_pending_count,
+                                       min_complete, flags);
+  if (rv < 0) {
+    if (errno == EINTR || errno == EAGAIN || errno == EBUSY) {
+      // Interrupted by a signal or the completion queue is full; the caller
+      // will reap completions and we'll retry the remaining submissions on the
+      // next enter.
+      return iree_ok_status();
+    }
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "io_uring_enter failure %d", errno);
+  }
+  ring->sq_pending_count -= (uint32_t)rv;
+  return iree_ok_status();
+}
+
+// Prepares a new submission queue entry. The entry is zeroed and only
+// submitted to the kernel on the next iree_io_uring_enter. If the submission
+// queue is full the prepared entries are submitted first.
+static iree_status_t iree_io_uring_prepare(iree_io_uring_t* ring,
+                                           struct io_uring_sqe** out_sqe) {
+  uint32_t head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+  if (ring->sq_local_tail - head >= ring->sq_entries) {
+    IREE_RETURN_IF_ERROR(iree_io_uring_enter(ring, /*min_complete=*/0));
+    head = __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    if (ring->sq_local_tail - head >= ring->sq_entries) {
+      return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                              "io_uring submission queue capacity %u exceeded",
+                              ring->sq_entries);
+    }
+  }
+  uint32_t index = ring->sq_local_tail & ring->sq_mask;
+  struct io_uring_sqe* sqe = &ring->sqes[index];
+  memset(sqe, 0, sizeof(*sqe));
+  ring->sq_array[index] = index;
+  ++ring->sq_local_tail;
+  ++ring->sq_pending_count;
+  *out_sqe = sqe;
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_run_ring_t
+//===----------------------------------------------------------------------===//
+
+// Represents an operation in the loop run ringbuffer.
+// Note that the storage may be reallocated at any time and all pointers must be
+// external to the storage in order to remain valid.
+typedef struct iree_loop_run_op_t {
+  union {
+    iree_loop_callback_t callback;  // asserted at offset 0 above
+    union {
+      iree_loop_call_params_t call;
+      iree_loop_dispatch_params_t dispatch;
+    } params;
+  };
+  iree_loop_command_t command;
+  iree_loop_io_uring_scope_t* scope;
+
+  // Set on calls when we are issuing a callback for an operation.
+  // Unlike other pointers in the params this is owned by the ring.
+  iree_status_t status;
+} iree_loop_run_op_t;
+
+// Ringbuffer containing pending ready to run callback operations.
+// This is the same FIFO used by iree_loop_sync_t.
+typedef iree_alignas(iree_max_align_t) struct iree_loop_run_ring_t {
+  // Current storage capacity of |ops|.
+  uint32_t capacity;
+  // Index into |ops| where the next operation to be dequeued is located.
+  uint32_t read_head;
+  // Index into |ops| where the last operation to be enqueued is located.
+  uint32_t write_head;
+  // Ringbuffer storage.
+  iree_loop_run_op_t ops[0];
+} iree_loop_run_ring_t;
+
+static iree_host_size_t iree_loop_run_ring_storage_size(
+    iree_loop_io_uring_options_t options) {
+  return sizeof(iree_loop_run_ring_t) +
+         options.max_queue_depth * sizeof(iree_loop_run_op_t);
+}
+
+static inline uint32_t iree_loop_run_ring_mask(
+    const iree_loop_run_ring_t* run_ring) {
+  return run_ring->capacity - 1;
+}
+
+static iree_host_size_t iree_loop_run_ring_size(
+    const iree_loop_run_ring_t* run_ring) {
+  return run_ring->write_head >= run_ring->read_head
+             ? (run_ring->write_head - run_ring->read_head)
+             : (run_ring->write_head + run_ring->capacity -
+                run_ring->read_head);
+}
+
+static bool iree_loop_run_ring_is_empty(const iree_loop_run_ring_t* run_ring) {
+  return run_ring->read_head == run_ring->write_head;
+}
+
+static bool iree_loop_run_ring_is_full(const iree_loop_run_ring_t* run_ring) {
+  const uint32_t mask = iree_loop_run_ring_mask(run_ring);
+  return ((run_ring->write_head - run_ring->read_head) & mask) == mask;
+}
+
+static void iree_loop_run_ring_initialize(iree_loop_io_uring_options_t options,
+                                          iree_loop_run_ring_t* out_run_ring) {
+  out_run_ring->capacity = (uint32_t)options.max_queue_depth;
+  out_run_ring->read_head = 0;
+  out_run_ring->write_head = 0;
+}
+
+static void iree_loop_run_ring_deinitialize(iree_loop_run_ring_t* run_ring) {
+  // Expected abort to be called.
+  IREE_ASSERT(iree_loop_run_ring_is_empty(run_ring));
+}
+
+static iree_status_t iree_loop_run_ring_enqueue(iree_loop_run_ring_t* run_ring,
+                                                iree_loop_run_op_t op) {
+  if (iree_loop_run_ring_is_full(run_ring)) {
+    return iree_make_status(
+        IREE_STATUS_RESOURCE_EXHAUSTED,
+        "run ringbuffer capacity %u exceeded; reduce the amount of concurrent "
+        "work or use a full loop implementation",
+        run_ring->capacity);
+  }
+
+  // Reserve a slot for the new operation.
+  uint32_t slot = run_ring->write_head;
+  run_ring->write_head =
+      (run_ring->write_head + 1) & iree_loop_run_ring_mask(run_ring);
+
+  // Copy the operation in; the params are on the stack and won't be valid after
+  // the caller returns.
+  run_ring->ops[slot] = op;
+
+  ++op.scope->pending_count;
+
+  IREE_TRACE_PLOT_VALUE_I64("iree_loop_queue_depth",
+                            iree_loop_run_ring_size(run_ring));
+  return iree_ok_status();
+}
+
+static bool iree_loop_run_ring_dequeue(iree_loop_run_ring_t* run_ring,
+                                       iree_loop_run_op_t* out_op) {
+  if (iree_loop_run_ring_is_empty(run_ring)) return false;
+
+  // Acquire the next operation.
+  uint32_t slot = run_ring->read_head;
+  run_ring->read_head =
+      (run_ring->read_head + 1) & iree_loop_run_ring_mask(run_ring);
+
+  // Copy out the parameters; the operation we execute may overwrite them by
+  // enqueuing more work.
+  *out_op = run_ring->ops[slot];
+
+  --out_op->scope->pending_count;
+
+  IREE_TRACE_PLOT_VALUE_I64("iree_loop_queue_depth",
+                            iree_loop_run_ring_size(run_ring));
+  return true;
+}
+
+// Aborts all ops that are part of |scope|.
+// A NULL |scope| indicates all work from all scopes should be aborted.
+static void iree_loop_run_ring_abort_scope(iree_loop_run_ring_t* run_ring,
+                                           iree_loop_io_uring_scope_t* scope) {
+  if (iree_loop_run_ring_is_empty(run_ring)) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Dequeue all ops and re-enqueue any that don't match so that the ring
+  // contains only the remaining ops in their original order.
+  iree_host_size_t count = iree_loop_run_ring_size(run_ring);
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_loop_run_op_t op;
+    if (!iree_loop_run_ring_dequeue(run_ring, &op)) break;
+    if (scope && op.scope != scope) {
+      // Not part of the scope we are aborting; re-enqueue to the ring.
+      iree_status_ignore(iree_loop_run_ring_enqueue(run_ring, op));
+    } else {
+      // Part of the scope to abort.
+      iree_status_ignore(op.status);
+      iree_status_ignore(op.callback.fn(op.callback.user_data, iree_loop_null(),
+                                        iree_make_status(IREE_STATUS_ABORTED)));
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_wait_list_t
+//===----------------------------------------------------------------------===//
+
+// Represents an operation in the loop wait list.
+// Each unresolved wait source of the operation has a one-shot poll armed in the
+// ring. When a poll completes the wait source is replaced with an immediate
+// wait source such that resolution can be checked without any syscalls.
+typedef struct iree_loop_wait_op_t {
+  union {
+    iree_loop_callback_t callback;  // asserted at offset 0 above
+    union {
+      iree_loop_wait_until_params_t wait_until;
+      iree_loop_wait_one_params_t wait_one;
+      iree_loop_wait_multi_params_t wait_multi;
+    } params;
+  };
+  iree_loop_command_t command;
+  iree_loop_io_uring_scope_t* scope;
+  // Identifier used to route ring completions to the operation.
+  uint32_t id;
+  // errno of the first failed poll or 0 if none have failed.
+  int poll_error;
+} iree_loop_wait_op_t;
+
+// Dense list of pending wait operations.
+typedef iree_alignas(iree_max_align_t) struct iree_loop_wait_list_t {
+  // Current storage capacity of |ops|.
+  uint32_t capacity;
+  // Current count of valid |ops|.
+  uint32_t count;
+  // Pending wait operations.
+  iree_loop_wait_op_t ops[0];
+} iree_loop_wait_list_t;
+
+static iree_host_size_t iree_loop_wait_list_storage_size(
+    iree_loop_io_uring_options_t options) {
+  return sizeof(iree_loop_wait_list_t) +
+         options.max_wait_count * sizeof(iree_loop_wait_op_t);
+}
+
+static bool iree_loop_wait_list_is_empty(iree_loop_wait_list_t* wait_list) {
+  return wait_list->count == 0;
+}
+
+static void iree_loop_wait_list_initialize(
+    iree_loop_io_uring_options_t options,
+    iree_loop_wait_list_t* out_wait_list) {
+  out_wait_list->capacity = (uint32_t)options.max_wait_count;
+  out_wait_list->count = 0;
+}
+
+static void iree_loop_wait_list_deinitialize(iree_loop_wait_list_t* wait_list) {
+  // Expected abort to be called.
+  IREE_ASSERT(iree_loop_wait_list_is_empty(wait_list));
+}
+
+// Returns the wait op with the given |id| or NULL if it has retired.
+static iree_loop_wait_op_t* iree_loop_wait_list_find(
+    iree_loop_wait_list_t* wait_list, uint32_t id) {
+  for (iree_host_size_t i = 0; i < wait_list->count; ++i) {
+    if (wait_list->ops[i].id == id) return &wait_list->ops[i];
+  }
+  return NULL;
+}
+
+// Returns the wait source at |index| in |op| or NULL if out of range.
+static iree_wait_source_t* iree_loop_wait_op_wait_source(
+    iree_loop_wait_op_t* op, iree_host_size_t index) {
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      return index == 0 ? &op->params.wait_one.wait_source : NULL;
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+      return index < op->params.wait_multi.count
+                 ? &op->params.wait_multi.wait_sources[index]
+                 : NULL;
+    default:
+      return NULL;
+  }
+}
+
+// Returns the deadline of |op|.
+static iree_time_t iree_loop_wait_op_deadline_ns(
+    const iree_loop_wait_op_t* op) {
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+      return op->params.wait_until.deadline_ns;
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      return op->params.wait_one.deadline_ns;
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+      return op->params.wait_multi.deadline_ns;
+    default:
+      return IREE_TIME_INFINITE_FUTURE;
+  }
+}
+
+static iree_host_size_t iree_loop_wait_op_wait_source_count(
+    const iree_loop_wait_op_t* op) {
+  switch (op->command) {
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      return 1;
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+      return op->params.wait_multi.count;
+    default:
+      return 0;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_io_uring_scope_t
+//===----------------------------------------------------------------------===//
+
+IREE_API_EXPORT void iree_loop_io_uring_scope_initialize(
+    iree_loop_io_uring_t* loop_io_uring, iree_loop_io_uring_error_fn_t error_fn,
+    void* error_user_data, iree_loop_io_uring_scope_t* out_scope) {
+  memset(out_scope, 0, sizeof(*out_scope));
+  out_scope->loop_io_uring = loop_io_uring;
+  out_scope->pending_count = 0;
+  out_scope->error_fn = error_fn;
+  out_scope->error_user_data = error_user_data;
+}
+
+IREE_API_EXPORT void iree_loop_io_uring_scope_deinitialize(
+    iree_loop_io_uring_scope_t* scope) {
+  IREE_ASSERT_ARGUMENT(scope);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (scope->loop_io_uring) {
+    iree_loop_io_uring_abort_scope(scope->loop_io_uring, scope);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_loop_io_uring_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_loop_io_uring_t {
+  iree_allocator_t allocator;
+
+  iree_io_uring_t ring;
+
+  // Identifier assigned to the next wait operation.
+  uint32_t next_wait_id;
+
+  // Generation of the most recently armed ring timeout. Completions of prior
+  // timeouts are ignored.
+  uint32_t timeout_generation;
+  // True if the timeout of |timeout_generation| is armed in the ring.
+  bool timeout_armed;
+  // Deadline of the armed timeout.
+  iree_time_t timeout_deadline_ns;
+  // Timeout duration referenced by the armed timeout entry. Must remain valid
+  // until the entry has been submitted.
+  struct __kernel_timespec timeout_ts;
+
+  iree_loop_run_ring_t* run_ring;
+  iree_loop_wait_list_t* wait_list;
+
+  // Trailing data:
+  // + iree_loop_run_ring_storage_size
+  // + iree_loop_wait_list_storage_size
+} iree_loop_io_uring_t;
+
+IREE_API_EXPORT bool iree_loop_io_uring_is_supported(void) {
+  iree_io_uring_t ring;
+  iree_status_t status = iree_io_uring_initialize(/*entries=*/1, &ring);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    return false;
+  }
+  iree_io_uring_deinitialize(&ring);
+  return true;
+}
+
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_allocate(
+    iree_loop_io_uring_options_t options, iree_allocator_t allocator,
+    iree_loop_io_uring_t** out_loop_io_uring) {
+  IREE_ASSERT_ARGUMENT(out_loop_io_uring);
+
+  // The run queue must be a power of two due to the ringbuffer masking
+  // technique we use.
+  options.max_queue_depth =
+      iree_math_round_up_to_pow2_u32((uint32_t)options.max_queue_depth);
+  if (options.max_queue_depth > UINT16_MAX) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "queue depth exceeds maximum");
+  }
+  if (IREE_UNLIKELY(options.max_wait_count > UINT16_MAX)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait list depth exceeds maximum");
+  }
+
+  // The kernel rounds the submission queue up to a power of two and submission
+  // is flushed whenever it fills so this only needs to cover a typical batch
+  // of polls plus the timeout.
+  if (!options.submission_queue_size) {
+    options.submission_queue_size = iree_max(options.max_wait_count, 8) + 2;
+  }
+  if (options.submission_queue_size > 4096) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "submission queue size exceeds maximum");
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_host_size_t loop_io_uring_size =
+      iree_host_align(sizeof(iree_loop_io_uring_t), iree_max_align_t);
+  const iree_host_size_t run_ring_size = iree_host_align(
+      iree_loop_run_ring_storage_size(options), iree_max_align_t);
+  const iree_host_size_t wait_list_size = iree_host_align(
+      iree_loop_wait_list_storage_size(options), iree_max_align_t);
+  const iree_host_size_t total_storage_size =
+      loop_io_uring_size + run_ring_size + wait_list_size;
+
+  uint8_t* storage = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(allocator, total_storage_size, (void**)&storage));
+  iree_loop_io_uring_t* loop_io_uring = (iree_loop_io_uring_t*)storage;
+  loop_io_uring->allocator = allocator;
+  loop_io_uring->ring.fd = -1;
+  loop_io_uring->next_wait_id = 1;
+  loop_io_uring->run_ring =
+      (iree_loop_run_ring_t*)(storage + loop_io_uring_size);
+  loop_io_uring->wait_list =
+      (iree_loop_wait_list_t*)(storage + loop_io_uring_size + run_ring_size);
+  iree_loop_run_ring_initialize(options, loop_io_uring->run_ring);
+  iree_loop_wait_list_initialize(options, loop_io_uring->wait_list);
+
+  iree_status_t status = iree_io_uring_initialize(
+      (uint32_t)options.submission_queue_size, &loop_io_uring->ring);
+
+  if (iree_status_is_ok(status)) {
+    *out_loop_io_uring = loop_io_uring;
+  } else {
+    iree_loop_io_uring_free(loop_io_uring);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns an fd that can be polled for readability to wait on |wait_handle| or
+// -1 if the handle is not backed by a file descriptor.
+static int iree_loop_io_uring_wait_handle_fd(
+    const iree_wait_handle_t* wait_handle) {
+  switch (wait_handle->type) {
+    case IREE_WAIT_PRIMITIVE_TYPE_EVENT_FD:
+      return wait_handle->value.event.fd;
+#if defined(IREE_HAVE_WAIT_TYPE_SYNC_FILE)
+    case IREE_WAIT_PRIMITIVE_TYPE_SYNC_FILE:
+      return wait_handle->value.sync_file.fd;
+#endif  // IREE_HAVE_WAIT_TYPE_SYNC_FILE
+#if defined(IREE_HAVE_WAIT_TYPE_PIPE)
+    case IREE_WAIT_PRIMITIVE_TYPE_PIPE:
+      return wait_handle->value.pipe.read_fd;
+#endif  // IREE_HAVE_WAIT_TYPE_PIPE
+    default:
+      return -1;
+  }
+}
+
+// Arms a poll on |wait_source| in the ring.
+// If the wait source is not backed by a wait handle it is exported to one and
+// replaced such that we don't need to export it again.
+static iree_status_t iree_loop_io_uring_arm_wait_source(
+    iree_loop_io_uring_t* loop_io_uring, uint32_t id, uint32_t index,
+    iree_wait_source_t* wait_source) {
+  if (iree_wait_source_is_immediate(*wait_source)) {
+    // Task has been neutered and is treated as an immediately resolved wait.
+    return iree_ok_status();
+  } else if (iree_wait_source_is_delay(*wait_source)) {
+    // Delays are handled with wait-until ops that can be factored into the
+    // ring timeout.
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "delays must come from wait-until ops");
+  }
+
+  iree_wait_handle_t* wait_handle = iree_wait_handle_from_source(wait_source);
+  if (!wait_handle) {
+    iree_wait_primitive_t wait_primitive = iree_wait_primitive_immediate();
+    IREE_RETURN_IF_ERROR(iree_wait_source_export(
+        *wait_source, IREE_WAIT_PRIMITIVE_TYPE_ANY, iree_immediate_timeout(),
+        &wait_primitive));
+    IREE_RETURN_IF_ERROR(iree_wait_source_import(wait_primitive, wait_source));
+    wait_handle = iree_wait_handle_from_source(wait_source);
+  }
+  int fd = wait_handle ? iree_loop_io_uring_wait_handle_fd(wait_handle) : -1;
+  if (fd < 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "wait source is not backed by a file descriptor");
+  }
+
+  struct io_uring_sqe* sqe = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_uring_prepare(&loop_io_uring->ring, &sqe));
+  sqe->opcode = IORING_OP_POLL_ADD;
+  sqe->fd = fd;
+  sqe->poll_events = POLLIN;
+  sqe->user_data = iree_loop_io_uring_make_user_data(id, index);
+  return iree_ok_status();
+}
+
+// Removes the armed polls of all unresolved wait sources of |op|.
+// Completions of the removed polls are ignored as |op| is retired.
+static void iree_loop_io_uring_disarm_wait_op(
+    iree_loop_io_uring_t* loop_io_uring, iree_loop_wait_op_t* op) {
+  iree_host_size_t count = iree_loop_wait_op_wait_source_count(op);
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_wait_source_t* wait_source = iree_loop_wait_op_wait_source(op, i);
+    if (iree_wait_source_is_immediate(*wait_source) ||
+        iree_wait_source_is_delay(*wait_source)) {
+      continue;
+    }
+    struct io_uring_sqe* sqe = NULL;
+    iree_status_t status = iree_io_uring_prepare(&loop_io_uring->ring, &sqe);
+    if (iree_status_is_ok(status)) {
+      sqe->opcode = IORING_OP_POLL_REMOVE;
+      sqe->addr = iree_loop_io_uring_make_user_data(op->id, (uint32_t)i);
+      sqe->user_data = IREE_LOOP_IO_URING_USER_DATA_IGNORED;
+    } else {
+      // The poll will remain armed until it fires or the ring is destroyed;
+      // its completion will be ignored.
+      iree_status_ignore(status);
+    }
+  }
+}
+
+static iree_status_t iree_loop_io_uring_insert_wait(
+    iree_loop_io_uring_t* loop_io_uring, iree_loop_wait_op_t op) {
+  iree_loop_wait_list_t* wait_list = loop_io_uring->wait_list;
+  if (wait_list->count + 1 >= wait_list->capacity) {
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "wait list capacity %u reached",
+                            wait_list->capacity);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Assign a unique identifier to the op for routing completions.
+  op.id = loop_io_uring->next_wait_id++;
+  if (loop_io_uring->next_wait_id == IREE_LOOP_IO_URING_TIMEOUT_ID) {
+    loop_io_uring->next_wait_id = 1;
+  }
+  op.poll_error = 0;
+
+  // Store the op prior to arming so that any wait sources we export are
+  // persisted in the list.
+  iree_loop_wait_op_t* stored_op = &wait_list->ops[wait_list->count];
+  *stored_op = op;
+
+  // Polls on wait handles that are already signaled complete inline upon
+  // submission so there's no need to query them here. Immediate timeouts are
+  // the exception as they are resolved before the ring is entered and we
+  // query those up front.
+  const bool is_poll =
+      iree_loop_wait_op_deadline_ns(stored_op) <= iree_time_now();
+  iree_status_t status = iree_ok_status();
+  iree_host_size_t count = iree_loop_wait_op_wait_source_count(stored_op);
+  for (iree_host_size_t i = 0; i < count && iree_status_is_ok(status); ++i) {
+    iree_wait_source_t* wait_source =
+        iree_loop_wait_op_wait_source(stored_op, i);
+    if (is_poll && !iree_wait_source_is_immediate(*wait_source) &&
+        !iree_wait_source_is_delay(*wait_source)) {
+      iree_status_code_t wait_status_code = IREE_STATUS_OK;
+      status = iree_wait_source_query(*wait_source, &wait_status_code);
+      if (iree_status_is_ok(status) && wait_status_code == IREE_STATUS_OK) {
+        *wait_source = iree_wait_source_immediate();
+      }
+    } else {
+      status = iree_loop_io_uring_arm_wait_source(loop_io_uring, stored_op->id,
+                                                  (uint32_t)i, wait_source);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    ++wait_list->count;
+    ++op.scope->pending_count;
+  } else {
+    iree_loop_io_uring_disarm_wait_op(loop_io_uring, stored_op);
+  }
+
+  IREE_TRACE_PLOT_VALUE_I64("iree_loop_wait_depth", wait_list->count);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Retires the wait op at index |i| and enqueues its callback with |status|.
+static iree_status_t iree_loop_io_uring_retire_wait(
+    iree_loop_io_uring_t* loop_io_uring, iree_host_size_t i,
+    iree_status_t status) {
+  iree_loop_wait_list_t* wait_list = loop_io_uring->wait_list;
+
+  // Remove any polls that are still armed.
+  iree_loop_io_uring_disarm_wait_op(loop_io_uring, &wait_list->ops[i]);
+
+  // Since we make no guarantees about the order of the lists we can just swap
+  // with the last value. Note that we need to preserve the callback.
+  iree_loop_io_uring_scope_t* scope = wait_list->ops[i].scope;
+  --scope->pending_count;
+  iree_loop_callback_t callback = wait_list->ops[i].callback;
+  iree_host_size_t tail_index = wait_list->count - 1;
+  if (tail_index > i) {
+    memcpy(&wait_list->ops[i], &wait_list->ops[tail_index],
+           sizeof(*wait_list->ops));
+  }
+  --wait_list->count;
+
+  IREE_TRACE_PLOT_VALUE_I64("iree_loop_wait_depth", wait_list->count);
+
+  // Enqueue the callback on the run ring - this ensures it gets sequenced with
+  // other runnable work and keeps ordering easier to reason about.
+  return iree_loop_run_ring_enqueue(
+      loop_io_uring->run_ring,
+      (iree_loop_run_op_t){
+          .command = IREE_LOOP_COMMAND_CALL,
+          .scope = scope,
+          .params =
+              {
+                  .call =
+                      {
+                          .callback = callback,
+                          .priority = IREE_LOOP_PRIORITY_DEFAULT,
+                      },
+              },
+          .status = status,
+      });
+}
+
+// Processes a single ring completion.
+static void iree_loop_io_uring_handle_completion(
+    iree_loop_io_uring_t* loop_io_uring, uint64_t user_data, int32_t result) {
+  if (user_data == IREE_LOOP_IO_URING_USER_DATA_IGNORED) return;
+  uint32_t id = (uint32_t)(user_data >> 32);
+  uint32_t index = (uint32_t)user_data;
+
+  if (id == IREE_LOOP_IO_URING_TIMEOUT_ID) {
+    // Timeouts only wake the loop; deadlines are checked during the scan.
+    if (index == loop_io_uring->timeout_generation) {
+      loop_io_uring->timeout_armed = false;
+    }
+    return;
+  }
+
+  iree_loop_wait_op_t* op =
+      iree_loop_wait_list_find(loop_io_uring->wait_list, id);
+  if (!op) return;  // retired; completion of a removed poll
+  iree_wait_source_t* wait_source = iree_loop_wait_op_wait_source(op, index);
+  if (!wait_source) return;
+  if (result < 0) {
+    if (!op->poll_error) op->poll_error = -result;
+    return;
+  }
+
+  // Wait handles are signaled when readable. Neuter the wait source such that
+  // the scan sees it as resolved and it is not disarmed on retirement.
+  *wait_source = iree_wait_source_immediate();
+}
+
+// Processes all available ring completions.
+static void iree_loop_io_uring_reap(iree_loop_io_uring_t* loop_io_uring) {
+  iree_io_uring_t* ring = &loop_io_uring->ring;
+  uint32_t head = *ring->cq_head;
+  uint32_t tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+  if (head == tail) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, tail - head);
+  for (; head != tail; ++head) {
+    const struct io_uring_cqe* cqe = &ring->cqes[head & ring->cq_mask];
+    iree_loop_io_uring_handle_completion(loop_io_uring, cqe->user_data,
+                                         cqe->res);
+  }
+  __atomic_store_n(ring->cq_head, head, __ATOMIC_RELEASE);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Queries all unresolved wait sources of |op| without blocking and neuters
+// those that have resolved. Used to resolve races when a deadline is reached
+// before a poll completion has been delivered.
+static iree_status_t iree_loop_io_uring_query_wait_op(iree_loop_wait_op_t* op) {
+  iree_host_size_t count = iree_loop_wait_op_wait_source_count(op);
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_wait_source_t* wait_source = iree_loop_wait_op_wait_source(op, i);
+    if (iree_wait_source_is_immediate(*wait_source)) continue;
+    iree_status_code_t wait_status_code = IREE_STATUS_OK;
+    IREE_RETURN_IF_ERROR(
+        iree_wait_source_query(*wait_source, &wait_status_code));
+    if (wait_status_code == IREE_STATUS_OK) {
+      *wait_source = iree_wait_source_immediate();
+    }
+  }
+  return iree_ok_status();
+}
+
+// Returns true if the wait sources of |op| satisfy its wait command.
+static bool iree_loop_io_uring_is_wait_op_resolved(iree_loop_wait_op_t* op) {
+  iree_host_size_t count = iree_loop_wait_op_wait_source_count(op);
+  iree_host_size_t resolved_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    if (iree_wait_source_is_immediate(*iree_loop_wait_op_wait_source(op, i))) {
+      ++resolved_count;
+    }
+  }
+  if (op->command == IREE_LOOP_COMMAND_WAIT_ALL) {
+    return resolved_count == count;
+  }
+  return resolved_count > 0 || count == 0;
+}
+
+// Returns DEFERRED if unresolved, OK if resolved, and an error otherwise.
+// If resolved (successful or not) the caller must retire the wait.
+static iree_status_t iree_loop_io_uring_scan_wait_op(
+    iree_loop_wait_op_t* op, iree_time_t now_ns,
+    iree_time_t* earliest_deadline_ns) {
+  const iree_time_t deadline_ns = iree_loop_wait_op_deadline_ns(op);
+  if (op->command == IREE_LOOP_COMMAND_WAIT_UNTIL) {
+    if (deadline_ns <= now_ns + IREE_LOOP_IO_URING_DELAY_SLOP_NS) {
+      // Wait deadline reached.
+      return iree_ok_status();
+    }
+    // Still waiting.
+    *earliest_deadline_ns = iree_min(*earliest_deadline_ns, deadline_ns);
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+
+  if (op->poll_error) {
+    return iree_make_status(iree_status_code_from_errno(op->poll_error),
+                            "io_uring poll failure %d", op->poll_error);
+  }
+  if (iree_loop_io_uring_is_wait_op_resolved(op)) return iree_ok_status();
+
+  if (deadline_ns <= now_ns) {
+    // Deadline reached; the poll completions may still be in flight so query
+    // one last time before failing.
+    IREE_RETURN_IF_ERROR(iree_loop_io_uring_query_wait_op(op));
+    return iree_loop_io_uring_is_wait_op_resolved(op)
+               ? iree_ok_status()
+               : iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  }
+
+  // Still waiting.
+  *earliest_deadline_ns = iree_min(*earliest_deadline_ns, deadline_ns);
+  return iree_status_from_code(IREE_STATUS_DEFERRED);
+}
+
+// Scans the wait list and retires all resolved or failed waits.
+// Returns the earliest deadline of the remaining waits in
+// |out_earliest_deadline_ns| or IREE_TIME_INFINITE_PAST if any waits were
+// retired and the run ring should be drained before waiting.
+static iree_status_t iree_loop_io_uring_scan(
+    iree_loop_io_uring_t* loop_io_uring,
+    iree_time_t* out_earliest_deadline_ns) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  *out_earliest_deadline_ns = IREE_TIME_INFINITE_FUTURE;
+
+  iree_loop_wait_list_t* wait_list = loop_io_uring->wait_list;
+  iree_time_t now_ns = iree_time_now();
+  iree_status_t scan_status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < wait_list->count && iree_status_is_ok(scan_status); ++i) {
+    iree_status_t wait_status = iree_loop_io_uring_scan_wait_op(
+        &wait_list->ops[i], now_ns, out_earliest_deadline_ns);
+    if (!iree_status_is_deferred(wait_status)) {
+      // Wait completed/failed - retire it and enqueue the callback.
+      scan_status =
+          iree_loop_io_uring_retire_wait(loop_io_uring, i, wait_status);
+      --i;  // item i removed
+
+      // Don't commit the wait if we woke something; we want the callback to be
+      // issued ASAP and will let the main loop pump again to actually wait if
+      // needed.
+      *out_earliest_deadline_ns = IREE_TIME_INFINITE_PAST;
+    }
+  }
+
+  IREE_TRACE_PLOT_VALUE_I64("iree_loop_wait_depth", wait_list->count);
+  IREE_TRACE_ZONE_END(z0);
+  return scan_status;
+}
+
+// Arms the ring timeout to fire at |deadline_ns|, replacing any prior timeout.
+static iree_status_t iree_loop_io_uring_arm_timeout(
+    iree_loop_io_uring_t* loop_io_uring, iree_time_t deadline_ns) {
+  if (loop_io_uring->timeout_armed) {
+    if (loop_io_uring->timeout_deadline_ns == deadline_ns) {
+      return iree_ok_status();  // reuse
+    }
+    struct io_uring_sqe* sqe = NULL;
+    IREE_RETURN_IF_ERROR(iree_io_uring_prepare(&loop_io_uring->ring, &sqe));
+    sqe->opcode = IORING_OP_TIMEOUT_REMOVE;
+    sqe->addr = iree_loop_io_uring_make_user_data(
+        IREE_LOOP_IO_URING_TIMEOUT_ID, loop_io_uring->timeout_generation);
+    sqe->user_data = IREE_LOOP_IO_URING_USER_DATA_IGNORED;
+    loop_io_uring->timeout_armed = false;
+  }
+  if (deadline_ns == IREE_TIME_INFINITE_FUTURE) return iree_ok_status();
+
+  // Ring timeouts use CLOCK_MONOTONIC while our deadlines are relative to
+  // iree_time_now so we convert to a relative duration.
+  iree_duration_t timeout_ns = deadline_ns - iree_time_now();
+  if (timeout_ns < 0) timeout_ns = 0;
+  loop_io_uring->timeout_ts.tv_sec = timeout_ns / 1000000000ll;
+  loop_io_uring->timeout_ts.tv_nsec = timeout_ns % 1000000000ll;
+
+  struct io_uring_sqe* sqe = NULL;
+  IREE_RETURN_IF_ERROR(iree_io_uring_prepare(&loop_io_uring->ring, &sqe));
+  sqe->opcode = IORING_OP_TIMEOUT;
+  sqe->fd = -1;
+  sqe->addr = (uint64_t)(uintptr_t)&loop_io_uring->timeout_ts;
+  sqe->len = 1;
+  sqe->off = 0;  // pure timer; not satisfied by other completions
+  sqe->user_data = iree_loop_io_uring_make_user_data(
+      IREE_LOOP_IO_URING_TIMEOUT_ID, ++loop_io_uring->timeout_generation);
+  loop_io_uring->timeout_armed = true;
+  loop_io_uring->timeout_deadline_ns = deadline_ns;
+  return iree_ok_status();
+}
+
+// Blocks until a ring completion is available or |deadline_ns| is reached.
+static iree_status_t iree_loop_io_uring_commit(
+    iree_loop_io_uring_t* loop_io_uring, iree_time_t deadline_ns) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0,
+                                   (int64_t)loop_io_uring->wait_list->count);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_loop_io_uring_arm_timeout(loop_io_uring, deadline_ns));
+  iree_status_t status =
+      iree_io_uring_enter(&loop_io_uring->ring, /*min_complete=*/1);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_loop_io_uring_free(
+    iree_loop_io_uring_t* loop_io_uring) {
+  IREE_ASSERT_ARGUMENT(loop_io_uring);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t allocator = loop_io_uring->allocator;
+
+  // Abort all pending operations.
+  // This will issue callbacks for each operation that was aborted directly
+  // with IREE_STATUS_ABORTED.
+  // To ensure we don't enqueue more work while aborting we NULL out the lists.
+  iree_loop_run_ring_t* run_ring = loop_io_uring->run_ring;
+  iree_loop_wait_list_t* wait_list = loop_io_uring->wait_list;
+  iree_loop_io_uring_abort_scope(loop_io_uring, /*scope=*/NULL);
+  loop_io_uring->run_ring = NULL;
+  loop_io_uring->wait_list = NULL;
+
+  // After all operations are cleared we can release the data structures.
+  // Destroying the ring cancels any polls that are still armed.
+  iree_loop_run_ring_deinitialize(run_ring);
+  iree_loop_wait_list_deinitialize(wait_list);
+  iree_io_uring_deinitialize(&loop_io_uring->ring);
+  iree_allocator_free(allocator, loop_io_uring);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Aborts all operations in the loop attributed to |scope|.
+// A NULL |scope| indicates all work from all scopes should be aborted.
+static void iree_loop_io_uring_abort_scope(
+    iree_loop_io_uring_t* loop_io_uring, iree_loop_io_uring_scope_t* scope) {
+  if (!loop_io_uring->wait_list) return;  // shutting down
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Issue the completion callback of each wait op to notify it of the abort.
+  // To prevent enqueuing more work while aborting we pass in a NULL loop.
+  // We can't do anything with the errors so we ignore them.
+  iree_loop_wait_list_t* wait_list = loop_io_uring->wait_list;
+  for (iree_host_size_t i = 0; i < wait_list->count; ++i) {
+    if (scope && wait_list->ops[i].scope != scope) continue;
+
+    iree_loop_io_uring_disarm_wait_op(loop_io_uring, &wait_list->ops[i]);
+    --wait_list->ops[i].scope->pending_count;
+    iree_loop_callback_t callback = wait_list->ops[i].callback;
+    iree_status_ignore(callback.fn(callback.user_data, iree_loop_null(),
+                                   iree_make_status(IREE_STATUS_ABORTED)));
+
+    // Since we make no guarantees about the order of the lists we can just swap
+    // with the last value.
+    iree_host_size_t tail_index = wait_list->count - 1;
+    if (tail_index > i) {
+      memcpy(&wait_list->ops[i], &wait_list->ops[tail_index],
+             sizeof(*wait_list->ops));
+    }
+    --wait_list->count;
+    --i;
+  }
+
+  iree_loop_run_ring_abort_scope(loop_io_uring->run_ring, scope);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Emits |status| to the given |loop| scope and aborts associated operations.
+static void iree_loop_io_uring_emit_error(iree_loop_t loop,
+                                          iree_status_t status) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(
+      z0, iree_status_code_string(iree_status_code(status)));
+
+  iree_loop_io_uring_scope_t* scope = (iree_loop_io_uring_scope_t*)loop.self;
+  iree_loop_io_uring_t* loop_io_uring = scope->loop_io_uring;
+
+  if (scope->error_fn) {
+    scope->error_fn(scope->error_user_data, status);
+  } else {
+    iree_status_ignore(status);
+  }
+
+  iree_loop_io_uring_abort_scope(loop_io_uring, scope);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_loop_io_uring_run_call(iree_loop_t loop,
+                                        const iree_loop_call_params_t params,
+                                        iree_status_t op_status) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status =
+      params.callback.fn(params.callback.user_data, loop, op_status);
+  if (!iree_status_is_ok(status)) {
+    iree_loop_io_uring_emit_error(loop, status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_loop_io_uring_run_dispatch(
+    iree_loop_t loop, const iree_loop_dispatch_params_t params) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // We run all workgroups before issuing the completion callback.
+  // If any workgroup fails we exit early and pass the failing status back to
+  // the completion handler exactly once.
+  iree_status_t workgroup_status = iree_ok_status();
+  for (uint32_t z = 0; z < params.workgroup_count_xyz[2]; ++z) {
+    for (uint32_t y = 0; y < params.workgroup_count_xyz[1]; ++y) {
+      for (uint32_t x = 0; x < params.workgroup_count_xyz[0]; ++x) {
+        workgroup_status =
+            params.workgroup_fn(params.callback.user_data, loop, x, y, z);
+        if (!iree_status_is_ok(workgroup_status)) goto workgroup_failed;
+      }
+    }
+  }
+workgroup_failed:;
+
+  // Fire the completion callback with either success or the first error hit by
+  // a workgroup.
+  iree_status_t status =
+      params.callback.fn(params.callback.user_data, loop, workgroup_status);
+  if (!iree_status_is_ok(status)) {
+    iree_loop_io_uring_emit_error(loop, status);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Drains work from the loop until all work in |scope| has completed.
+// A NULL |scope| indicates all work from all scopes should be drained.
+static iree_status_t iree_loop_io_uring_drain_scope(
+    iree_loop_io_uring_t* loop_io_uring, iree_loop_io_uring_scope_t* scope,
+    iree_time_t deadline_ns) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  do {
+    // If we are draining a particular scope we can bail whenever there's no
+    // more work remaining.
+    if (scope && !scope->pending_count) break;
+
+    // Run an op from the runnable queue.
+    // We only want to run one op at a time before checking our deadline so that
+    // we don't get into infinite loops or exceed the deadline (too much).
+    iree_loop_run_op_t run_op;
+    if (iree_loop_run_ring_dequeue(loop_io_uring->run_ring, &run_op)) {
+      iree_loop_t loop = {
+          .self = run_op.scope,
+          .ctl = iree_loop_io_uring_ctl,
+      };
+      switch (run_op.command) {
+        case IREE_LOOP_COMMAND_CALL:
+          iree_loop_io_uring_run_call(loop, run_op.params.call, run_op.status);
+          break;
+        case IREE_LOOP_COMMAND_DISPATCH:
+          iree_loop_io_uring_run_dispatch(loop, run_op.params.dispatch);
+          break;
+      }
+      continue;  // loop back around only if under the deadline
+    }
+
+    // -- if here then the run ring is currently empty --
+
+    // If there are no pending waits then the drain has completed.
+    if (iree_loop_wait_list_is_empty(loop_io_uring->wait_list)) break;
+
+    // Submit any newly armed polls (which complete inline if already signaled)
+    // and route all available completions to their wait ops.
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_uring_enter(&loop_io_uring->ring, /*min_complete=*/0));
+    iree_loop_io_uring_reap(loop_io_uring);
+
+    // Scan the wait list and retire resolved ops. An infinite-past deadline
+    // indicates that there's work in the run ring and we shouldn't block this
+    // go around the loop.
+    iree_time_t earliest_deadline_ns = IREE_TIME_INFINITE_FUTURE;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_loop_io_uring_scan(loop_io_uring, &earliest_deadline_ns));
+    if (earliest_deadline_ns != IREE_TIME_INFINITE_PAST) {
+      // Block in the ring up until the minimum of the user specified and wait
+      // list derived deadlines.
+      iree_time_t wait_deadline_ns =
+          iree_min(earliest_deadline_ns, deadline_ns);
+      IREE_RETURN_AND_END_ZONE_IF_ERROR(
+          z0, iree_loop_io_uring_commit(loop_io_uring, wait_deadline_ns));
+      iree_loop_io_uring_reap(loop_io_uring);
+    }
+  } while (iree_time_now() < deadline_ns);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_wait_idle(
+    iree_loop_io_uring_t* loop_io_uring, iree_timeout_t timeout) {
+  IREE_ASSERT_ARGUMENT(loop_io_uring);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
+  iree_status_t status = iree_loop_io_uring_drain_scope(
+      loop_io_uring, /*scope=*/NULL, deadline_ns);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Control function for the io_uring loop.
+// |self| must be an iree_loop_io_uring_scope_t.
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr) {
+  IREE_ASSERT_ARGUMENT(self);
+  iree_loop_io_uring_scope_t* scope = (iree_loop_io_uring_scope_t*)self;
+  iree_loop_io_uring_t* loop_io_uring = scope->loop_io_uring;
+
+  if (IREE_UNLIKELY(!loop_io_uring->run_ring)) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "new work cannot be enqueued while the loop is shutting down");
+  }
+
+  // NOTE: we return immediately to make this all (hopefully) tail calls.
+  switch (command) {
+    case IREE_LOOP_COMMAND_CALL:
+      return iree_loop_run_ring_enqueue(
+          loop_io_uring->run_ring,
+          (iree_loop_run_op_t){
+              .command = command,
+              .scope = scope,
+              .params =
+                  {
+                      .call = *(const iree_loop_call_params_t*)params,
+                  },
+          });
+    case IREE_LOOP_COMMAND_DISPATCH:
+      return iree_loop_run_ring_enqueue(
+          loop_io_uring->run_ring,
+          (iree_loop_run_op_t){
+              .command = command,
+              .scope = scope,
+              .params =
+                  {
+                      .dispatch = *(const iree_loop_dispatch_params_t*)params,
+                  },
+          });
+    case IREE_LOOP_COMMAND_WAIT_UNTIL:
+      return iree_loop_io_uring_insert_wait(
+          loop_io_uring,
+          (iree_loop_wait_op_t){
+              .command = command,
+              .scope = scope,
+              .params =
+                  {
+                      .wait_until =
+                          *(const iree_loop_wait_until_params_t*)params,
+                  },
+          });
+    case IREE_LOOP_COMMAND_WAIT_ONE:
+      return iree_loop_io_uring_insert_wait(
+          loop_io_uring,
+          (iree_loop_wait_op_t){
+              .command = command,
+              .scope = scope,
+              .params =
+                  {
+                      .wait_one = *(const iree_loop_wait_one_params_t*)params,
+                  },
+          });
+    case IREE_LOOP_COMMAND_WAIT_ALL:
+    case IREE_LOOP_COMMAND_WAIT_ANY:
+      return iree_loop_io_uring_insert_wait(
+          loop_io_uring,
+          (iree_loop_wait_op_t){
+              .command = command,
+              .scope = scope,
+              .params =
+                  {
+                      .wait_multi =
+                          *(const iree_loop_wait_multi_params_t*)params,
+                  },
+          });
+    case IREE_LOOP_COMMAND_DRAIN:
+      return iree_loop_io_uring_drain_scope(
+          loop_io_uring, scope,
+          ((const iree_loop_drain_params_t*)params)->deadline_ns);
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented loop command");
+  }
+}
+
+#else
+
+IREE_API_EXPORT bool iree_loop_io_uring_is_supported(void) { return false; }
+
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_allocate(
+    iree_loop_io_uring_options_t options, iree_allocator_t allocator,
+    iree_loop_io_uring_t** out_loop_io_uring) {
+  IREE_ASSERT_ARGUMENT(out_loop_io_uring);
+  *out_loop_io_uring = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "io_uring is only available on Linux");
+}
+
+IREE_API_EXPORT void iree_loop_io_uring_free(
+    iree_loop_io_uring_t* loop_io_uring) {}
+
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_wait_idle(
+    iree_loop_io_uring_t* loop_io_uring, iree_timeout_t timeout) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "io_uring is only available on Linux");
+}
+
+IREE_API_EXPORT void iree_loop_io_uring_scope_initialize(
+    iree_loop_io_uring_t* loop_io_uring, iree_loop_io_uring_error_fn_t error_fn,
+    void* error_user_data, iree_loop_io_uring_scope_t* out_scope) {
+  memset(out_scope, 0, sizeof(*out_scope));
+}
+
+IREE_API_EXPORT void iree_loop_io_uring_scope_deinitialize(
+    iree_loop_io_uring_scope_t* scope) {}
+
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr) {
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "io_uring is only available on Linux");
+}
+
+#endif  // IREE_PLATFORM_LINUX && IREE_HAVE_WAIT_TYPE_EVENTFD
@@ -0,0 +1,129 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BASE_LOOP_IO_URING_H_
+#define IREE_BASE_LOOP_IO_URING_H_
+
+#include "iree/base/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_loop_io_uring_t
+//===----------------------------------------------------------------------===//
+
+// Configuration options for the io_uring loop implementation.
+typedef struct iree_loop_io_uring_options_t {
+  // Specifies the maximum operation queue depth in number of operations.
+  // Growth is not currently supported and if the capacity is reached during
+  // execution then IREE_STATUS_RESOURCE_EXHAUSTED will be returned when new
+  // operations are enqueued.
+  iree_host_size_t max_queue_depth;
+
+  // Specifies how many pending waits are allowed at the same time.
+  // Growth is not currently supported and if the capacity is reached during
+  // execution then IREE_STATUS_RESOURCE_EXHAUSTED will be returned when new
+  // waits are enqueued.
+  iree_host_size_t max_wait_count;
+
+  // Number of entries in the kernel submission queue. Rounded up to a power of
+  // two. When 0 a default based on |max_wait_count| is used. Submissions are
+  // flushed early if the queue fills so this only bounds the batching and not
+  // the number of outstanding waits.
+  iree_host_size_t submission_queue_size;
+} iree_loop_io_uring_options_t;
+
+// A loop that waits on wait sources using a Linux io_uring instance.
+//
+// Behaves like iree_loop_sync_t and only performs work when iree_loop_drain is
+// called. Each wait source is armed in the ring once with a poll request when
+// the wait is enqueued instead of being re-registered with the system on every
+// pump of the loop: waking only processes the completions of sources that have
+// resolved and blocking with a deadline is a single syscall regardless of the
+// number of pending waits. Timers are implemented with ring timeouts.
+//
+// Only available on Linux kernels with io_uring support (5.4+). Allocation
+// returns IREE_STATUS_UNAVAILABLE on other platforms or when io_uring has been
+// disabled (such as by seccomp filters or kernel.io_uring_disabled) and
+// callers should fall back to iree_loop_sync_t.
+//
+// Thread-compatible: the loop only performs work when iree_loop_drain is
+// called and must not be used from multiple threads concurrently.
+typedef struct iree_loop_io_uring_t iree_loop_io_uring_t;
+
+// Returns true if io_uring loops can be allocated in the current process.
+IREE_API_EXPORT bool iree_loop_io_uring_is_supported(void);
+
+// Allocates an io_uring loop using |allocator| stored into |out_loop_io_uring|.
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_allocate(
+    iree_loop_io_uring_options_t options, iree_allocator_t allocator,
+    iree_loop_io_uring_t** out_loop_io_uring);
+
+// Frees an io_uring |loop_io_uring|, aborting all pending operations.
+IREE_API_EXPORT void iree_loop_io_uring_free(
+    iree_loop_io_uring_t* loop_io_uring);
+
+// Waits until the loop is idle (all operations in all scopes have retired).
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if |timeout| is reached before the
+// loop is idle.
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_wait_idle(
+    iree_loop_io_uring_t* loop_io_uring, iree_timeout_t timeout);
+
+// Handles scope errors returned from loop callback operations.
+// Ownership of |status| is passed to the handler and must be freed.
+// All operations of the same scope will be aborted.
+typedef void(IREE_API_PTR* iree_loop_io_uring_error_fn_t)(void* user_data,
+                                                          iree_status_t status);
+
+// A scope of execution within a loop.
+// Each scope has a dedicated error handler that is notified when an error
+// propagates from a loop operation scheduled against the scope. When an error
+// arises all other operations in the same scope will be aborted.
+typedef struct iree_loop_io_uring_scope_t {
+  // Target loop for execution.
+  iree_loop_io_uring_t* loop_io_uring;
+
+  // Total number of pending operations in the scope.
+  // When 0 the scope is considered idle.
+  int32_t pending_count;
+
+  // Optional function used to report errors that occur during execution.
+  iree_loop_io_uring_error_fn_t error_fn;
+  void* error_user_data;
+} iree_loop_io_uring_scope_t;
+
+// Initializes a loop scope that runs operations against |loop_io_uring|.
+IREE_API_EXPORT void iree_loop_io_uring_scope_initialize(
+    iree_loop_io_uring_t* loop_io_uring, iree_loop_io_uring_error_fn_t error_fn,
+    void* error_user_data, iree_loop_io_uring_scope_t* out_scope);
+
+// Deinitializes a loop |scope| and aborts any pending operations.
+IREE_API_EXPORT void iree_loop_io_uring_scope_deinitialize(
+    iree_loop_io_uring_scope_t* scope);
+
+IREE_API_EXPORT iree_status_t iree_loop_io_uring_ctl(
+    void* self, iree_loop_command_t command, const void* params,
+    void** inout_ptr);
+
+// Returns a loop that schedules operations against |scope|.
+// The scope must remain valid until all operations scheduled against it have
+// completed.
+static inline iree_loop_t iree_loop_io_uring_scope(
+    iree_loop_io_uring_scope_t* scope) {
+  iree_loop_t loop = {
+      scope,
+      iree_loop_io_uring_ctl,
+  };
+  return loop;
+}
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_BASE_LOOP_IO_URING_H_
@@ -0,0 +1,57 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/loop_io_uring.h"
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+// Contains the test definitions applied to all loop implementations:
+#include "iree/base/loop_test.h"
+
+void AllocateLoop(iree_status_t* out_status, iree_allocator_t allocator,
+                  iree_loop_t* out_loop) {
+  *out_loop = iree_loop_null();
+  if (!iree_loop_io_uring_is_supported()) {
+    GTEST_SKIP() << "io_uring not available on this system";
+  }
+
+  iree_loop_io_uring_options_t options = {0};
+  options.max_queue_depth = 128;
+  options.max_wait_count = 32;
+
+  iree_loop_io_uring_t* loop_io_uring = NULL;
+  IREE_CHECK_OK(
+      iree_loop_io_uring_allocate(options, allocator, &loop_io_uring));
+
+  iree_loop_io_uring_scope_t* scope = NULL;
+  IREE_CHECK_OK(
+      iree_allocator_malloc(allocator, sizeof(*scope), (void**)&scope));
+  iree_loop_io_uring_scope_initialize(
+      loop_io_uring,
+      +[](void* user_data, iree_status_t status) {
+        iree_status_t* status_ptr = (iree_status_t*)user_data;
+        if (iree_status_is_ok(*status_ptr)) {
+          *status_ptr = status;
+        } else {
+          iree_status_ignore(status);
+        }
+      },
+      out_status, scope);
+  *out_loop = iree_loop_io_uring_scope(scope);
+}
+
+void FreeLoop(iree_allocator_t allocator, iree_loop_t loop) {
+  if (!loop.self) return;  // skipped
+  iree_loop_io_uring_scope_t* scope = (iree_loop_io_uring_scope_t*)loop.self;
+  iree_loop_io_uring_t* loop_io_uring = scope->loop_io_uring;
+
+  iree_loop_io_uring_scope_deinitialize(scope);
+  iree_allocator_free(allocator, scope);
+
+  iree_loop_io_uring_free(loop_io_uring);
+}
@@ -634,7 +634,7 @@ static iree_status_t iree_loop_wait_list_scan(
 static iree_status_t iree_loop_wait_list_commit(
     iree_loop_wait_list_t* wait_list, iree_loop_run_ring_t* run_ring,
     iree_time_t deadline_ns) {
-  if (iree_wait_set_is_empty(wait_list->wait_set) == 0) {
+  if (iree_wait_set_is_empty(wait_list->wait_set)) {
     // No wait handles; this is a sleep.
     IREE_TRACE_ZONE_BEGIN_NAMED(z0, "iree_loop_wait_list_commit_sleep");
     iree_status_t status =
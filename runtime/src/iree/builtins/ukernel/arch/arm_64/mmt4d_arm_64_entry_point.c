@@ -7,6 +7,41 @@
 #include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
 #include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64_internal.h"
 
+#ifdef IREE_UK_BUILD_ARM_64_SVE2
+static iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arm_64_sve2(
+    const iree_uk_mmt4d_params_t* params, iree_uk_mmt4d_type_t mmt4d_type) {
+  if (mmt4d_type == iree_uk_mmt4d_type_f32f32f32 && params->K0 == 1) {
+    switch (params->M0) {
+      case 1:
+        return iree_uk_mmt4d_tile_f32f32f32_1x2VLx1_arm_64_sve2;
+      case 2:
+        return iree_uk_mmt4d_tile_f32f32f32_2x2VLx1_arm_64_sve2;
+      case 4:
+        return iree_uk_mmt4d_tile_f32f32f32_4x2VLx1_arm_64_sve2;
+      case 8:
+        return iree_uk_mmt4d_tile_f32f32f32_8x2VLx1_arm_64_sve2;
+      default:
+        return 0;
+    }
+  }
+  if (mmt4d_type == iree_uk_mmt4d_type_s8s8s32 && params->K0 == 4) {
+    switch (params->M0) {
+      case 1:
+        return iree_uk_mmt4d_tile_s8s8s32_1x2VLx4_arm_64_sve2;
+      case 2:
+        return iree_uk_mmt4d_tile_s8s8s32_2x2VLx4_arm_64_sve2;
+      case 4:
+        return iree_uk_mmt4d_tile_s8s8s32_4x2VLx4_arm_64_sve2;
+      case 8:
+        return iree_uk_mmt4d_tile_s8s8s32_8x2VLx4_arm_64_sve2;
+      default:
+        return 0;
+    }
+  }
+  return 0;
+}
+#endif  // IREE_UK_BUILD_ARM_64_SVE2
+
 iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arch(
     const iree_uk_mmt4d_params_t* params) {
   IREE_UK_ATTRIBUTE_UNUSED iree_uk_mmt4d_type_t mmt4d_type =
@@ -64,5 +99,29 @@ iree_uk_mmt4d_tile_func_t iree_uk_mmt4d_select_tile_func_arch(
 
 #include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64_tiles.inl"
 
+  // Vector-length-dependent tiles, enumerated after the fixed-size tiles
+  // above so that they take precedence on equal tile shapes.
+#ifdef IREE_UK_BUILD_ARM_64_SVE2
+  // With 128-bit SVE the SVE2 tiles have the same shapes as the NEON ones,
+  // so only use them on wider implementations.
+  if (iree_uk_cpu_arm_64_sve2(params->cpu_data) &&
+      iree_uk_arm_64_sve2_vl_words() > 4 &&
+      params->N0 == 2 * iree_uk_arm_64_sve2_vl_words()) {
+    iree_uk_mmt4d_tile_func_t sve2_tile_func =
+        iree_uk_mmt4d_select_tile_func_arm_64_sve2(params, mmt4d_type);
+    if (sve2_tile_func) tile_func = sve2_tile_func;
+  }
+#endif
+#ifdef IREE_UK_BUILD_ARM_64_SME
+  if (iree_uk_cpu_arm_64_sme(params->cpu_data) &&
+      params->N0 == iree_uk_arm_64_sme_vl_words() && params->M0 <= params->N0) {
+    if (mmt4d_type == iree_uk_mmt4d_type_f32f32f32 && params->K0 == 1) {
+      tile_func = iree_uk_mmt4d_tile_f32f32f32_VLxVLx1_arm_64_sme;
+    } else if (mmt4d_type == iree_uk_mmt4d_type_s8s8s32 && params->K0 == 4) {
+      tile_func = iree_uk_mmt4d_tile_s8s8s32_VLxVLx4_arm_64_sme;
+    }
+  }
+#endif
+
   return tile_func;
 }
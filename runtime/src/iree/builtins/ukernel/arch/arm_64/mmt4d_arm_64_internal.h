@@ -17,4 +17,31 @@
 
 #undef IREE_UK_MMT4D_TILE
 
+// SVE2 and SME tile functions have vector-length-dependent tile sizes, so
+// they are not enumerated in mmt4d_arm_64_tiles.inl but selected explicitly
+// in mmt4d_arm_64_entry_point.c. "VL" stands for the number of 32-bit lanes
+// in a (streaming, for SME) vector register.
+
+// M0 in {1, 2, 4, 8}, N0 = 2 * VL.
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_1x2VLx1_arm_64_sve2)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_2x2VLx1_arm_64_sve2)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_4x2VLx1_arm_64_sve2)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_8x2VLx1_arm_64_sve2)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_s8s8s32_1x2VLx4_arm_64_sve2)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_s8s8s32_2x2VLx4_arm_64_sve2)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_s8s8s32_4x2VLx4_arm_64_sve2)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_s8s8s32_8x2VLx4_arm_64_sve2)
+
+// Any M0 <= VL, N0 = VL. Accumulates in the ZA array with outer products.
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_f32f32f32_VLxVLx1_arm_64_sme)
+IREE_UK_MMT4D_TILE_FUNC_DECL(iree_uk_mmt4d_tile_s8s8s32_VLxVLx4_arm_64_sme)
+
+// Returns the number of 32-bit lanes in an SVE vector register.
+iree_uk_index_t iree_uk_arm_64_sve2_vl_words(void);
+
+// Returns the number of 32-bit lanes in a streaming SVE vector register,
+// which is also the size of a 32-bit ZA tile. This does not require being in
+// streaming mode.
+iree_uk_index_t iree_uk_arm_64_sme_vl_words(void);
+
 #endif  // IREE_BUILTINS_UKERNEL_ARCH_ARM_64_MMT4D_ARM_64_INTERNAL_H_
@@ -0,0 +1,127 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <arm_sme.h>
+
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
+#include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64_internal.h"
+
+iree_uk_index_t iree_uk_arm_64_sme_vl_words(void) { return svcntsw(); }
+
+// The tile functions below are entered from non-streaming code: they switch
+// to streaming mode and set up fresh ZA state on entry and restore both on
+// exit. That costs some tens of cycles per call, amortized over params->K.
+//
+// Rows of the output tile are accumulated in the 32-bit ZA tiles with one
+// outer product (FMOPA/SMOPA) per K step. Successive K steps rotate through
+// the 4 ZA tiles so that consecutive outer products do not depend on each
+// other, and the 4 partial sums are reduced when storing. Only the first M0
+// rows of the tiles are ever loaded or stored, so M0 may be narrower than VL.
+
+__arm_new("za") __arm_locally_streaming void
+    iree_uk_mmt4d_tile_f32f32f32_VLxVLx1_arm_64_sme(
+        void* IREE_UK_RESTRICT out_tile,
+        const void* IREE_UK_RESTRICT lhs_panel,
+        const void* IREE_UK_RESTRICT rhs_panel,
+        const iree_uk_mmt4d_params_t* params) {
+  const iree_uk_index_t M0 = params->M0;
+  const iree_uk_index_t N0 = params->N0;
+  IREE_UK_ASSERT(N0 == svcntw() && M0 >= 1 && M0 <= N0);
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const svbool_t row_pred = svwhilelt_b32_s64(0, M0);
+  const svbool_t col_pred = svptrue_b32();
+  svzero_za();
+  if (params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE) {
+    for (iree_uk_index_t i = 0; i < M0; ++i) {
+      svld1_hor_za32(0, i, col_pred, out_ptr + i * N0);
+    }
+  }
+  iree_uk_index_t k = 0;
+  for (; k + 4 <= params->K; k += 4) {
+#define IREE_UK_SME_MOPA_F32(tile)                              \
+  svmopa_za32_f32_m(tile, row_pred, col_pred,                   \
+                    svld1_f32(row_pred, lhs_ptr + (tile) * M0), \
+                    svld1_f32(col_pred, rhs_ptr + (tile) * N0));
+    IREE_UK_SME_MOPA_F32(0)
+    IREE_UK_SME_MOPA_F32(1)
+    IREE_UK_SME_MOPA_F32(2)
+    IREE_UK_SME_MOPA_F32(3)
+    lhs_ptr += 4 * M0;
+    rhs_ptr += 4 * N0;
+  }
+  for (; k < params->K; ++k) {
+    IREE_UK_SME_MOPA_F32(0)
+#undef IREE_UK_SME_MOPA_F32
+    lhs_ptr += M0;
+    rhs_ptr += N0;
+  }
+  for (iree_uk_index_t i = 0; i < M0; ++i) {
+    svfloat32_t sum = svread_hor_za32_f32_m(svundef_f32(), col_pred, 0, i);
+    sum = svadd_f32_x(col_pred, sum,
+                      svread_hor_za32_f32_m(svundef_f32(), col_pred, 1, i));
+    sum = svadd_f32_x(col_pred, sum,
+                      svread_hor_za32_f32_m(svundef_f32(), col_pred, 2, i));
+    sum = svadd_f32_x(col_pred, sum,
+                      svread_hor_za32_f32_m(svundef_f32(), col_pred, 3, i));
+    svst1_f32(col_pred, out_ptr + i * N0, sum);
+  }
+}
+
+// SMOPA into 32-bit ZA tiles is a 4-way dot product per element, which
+// matches the M0x4 LHS and N0x4 RHS row-major layouts of K0 = 4 tiles.
+__arm_new("za") __arm_locally_streaming void
+    iree_uk_mmt4d_tile_s8s8s32_VLxVLx4_arm_64_sme(
+        void* IREE_UK_RESTRICT out_tile,
+        const void* IREE_UK_RESTRICT lhs_panel,
+        const void* IREE_UK_RESTRICT rhs_panel,
+        const iree_uk_mmt4d_params_t* params) {
+  const iree_uk_index_t M0 = params->M0;
+  const iree_uk_index_t N0 = params->N0;
+  IREE_UK_ASSERT(N0 == svcntw() && M0 >= 1 && M0 <= N0);
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
+  const svbool_t row_pred8 = svwhilelt_b8_s64(0, 4 * M0);
+  const svbool_t col_pred32 = svptrue_b32();
+  const svbool_t col_pred8 = svptrue_b8();
+  svzero_za();
+  if (params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE) {
+    for (iree_uk_index_t i = 0; i < M0; ++i) {
+      svld1_hor_za32(0, i, col_pred32, out_ptr + i * N0);
+    }
+  }
+  iree_uk_index_t k = 0;
+  for (; k + 4 <= params->K; k += 4) {
+#define IREE_UK_SME_MOPA_S8(tile)                                  \
+  svmopa_za32_s8_m(tile, row_pred8, col_pred8,                     \
+                   svld1_s8(row_pred8, lhs_ptr + (tile) * 4 * M0), \
+                   svld1_s8(col_pred8, rhs_ptr + (tile) * 4 * N0));
+    IREE_UK_SME_MOPA_S8(0)
+    IREE_UK_SME_MOPA_S8(1)
+    IREE_UK_SME_MOPA_S8(2)
+    IREE_UK_SME_MOPA_S8(3)
+    lhs_ptr += 16 * M0;
+    rhs_ptr += 16 * N0;
+  }
+  for (; k < params->K; ++k) {
+    IREE_UK_SME_MOPA_S8(0)
+#undef IREE_UK_SME_MOPA_S8
+    lhs_ptr += 4 * M0;
+    rhs_ptr += 4 * N0;
+  }
+  for (iree_uk_index_t i = 0; i < M0; ++i) {
+    svint32_t sum = svread_hor_za32_s32_m(svundef_s32(), col_pred32, 0, i);
+    sum = svadd_s32_x(col_pred32, sum,
+                      svread_hor_za32_s32_m(svundef_s32(), col_pred32, 1, i));
+    sum = svadd_s32_x(col_pred32, sum,
+                      svread_hor_za32_s32_m(svundef_s32(), col_pred32, 2, i));
+    sum = svadd_s32_x(col_pred32, sum,
+                      svread_hor_za32_s32_m(svundef_s32(), col_pred32, 3, i));
+    svst1_s32(col_pred32, out_ptr + i * N0, sum);
+  }
+}
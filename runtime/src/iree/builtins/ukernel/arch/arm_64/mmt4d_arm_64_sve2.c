@@ -0,0 +1,136 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <arm_sve.h>
+
+#include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
+#include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64_internal.h"
+
+iree_uk_index_t iree_uk_arm_64_sve2_vl_words(void) { return svcntw(); }
+
+// Expands X(0) through X(7). SVE vector types are sizeless and cannot be
+// array elements, so per-row accumulators have to be named individually.
+#define IREE_UK_SVE2_REPEAT_8(X) X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7)
+
+// Same structure as the NEON 8x8x1 kernel in mmt4d_arm_64_base.c, with each
+// row of the tile held in two full-width SVE vectors. The LHS scalars are
+// broadcast-loaded (ld1rw) rather than loaded as vectors and indexed.
+IREE_UK_ATTRIBUTE_ALWAYS_INLINE static inline void
+iree_uk_mmt4d_tile_f32f32f32_1x2VLx1_to_8x2VLx1_arm_64_sve2(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel,
+    const iree_uk_mmt4d_params_t* params, int M0) {
+  IREE_UK_ASSERT(M0 >= 1 && M0 <= 8 && iree_uk_is_po2_u32(M0));
+  IREE_UK_ASSERT(params->N0 == 2 * svcntw());
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const bool accumulate = params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE;
+  const svbool_t pg = svptrue_b32();
+#define IREE_UK_ACC_INIT(i)                              \
+  svfloat32_t acc##i##_0 = svdup_n_f32(0.f);             \
+  svfloat32_t acc##i##_1 = svdup_n_f32(0.f);             \
+  if (M0 > i && accumulate) {                            \
+    acc##i##_0 = svld1_vnum_f32(pg, out_ptr, 2 * i + 0); \
+    acc##i##_1 = svld1_vnum_f32(pg, out_ptr, 2 * i + 1); \
+  }
+  IREE_UK_SVE2_REPEAT_8(IREE_UK_ACC_INIT)
+#undef IREE_UK_ACC_INIT
+  for (int k = 0; k < params->K; ++k) {
+    svfloat32_t rhs_0 = svld1_vnum_f32(pg, rhs_ptr, 0);
+    svfloat32_t rhs_1 = svld1_vnum_f32(pg, rhs_ptr, 1);
+    rhs_ptr += params->N0;
+#define IREE_UK_ACC_FMA(i)                                         \
+  if (M0 > i) {                                                    \
+    acc##i##_0 = svmla_n_f32_x(pg, acc##i##_0, rhs_0, lhs_ptr[i]); \
+    acc##i##_1 = svmla_n_f32_x(pg, acc##i##_1, rhs_1, lhs_ptr[i]); \
+  }
+    IREE_UK_SVE2_REPEAT_8(IREE_UK_ACC_FMA)
+#undef IREE_UK_ACC_FMA
+    lhs_ptr += M0;
+  }
+#define IREE_UK_ACC_STORE(i)                            \
+  if (M0 > i) {                                         \
+    svst1_vnum_f32(pg, out_ptr, 2 * i + 0, acc##i##_0); \
+    svst1_vnum_f32(pg, out_ptr, 2 * i + 1, acc##i##_1); \
+  }
+  IREE_UK_SVE2_REPEAT_8(IREE_UK_ACC_STORE)
+#undef IREE_UK_ACC_STORE
+}
+
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_f32f32f32_1x2VLx1_to_8x2VLx1_arm_64_sve2,
+    iree_uk_mmt4d_tile_f32f32f32_1x2VLx1_arm_64_sve2, 1)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_f32f32f32_1x2VLx1_to_8x2VLx1_arm_64_sve2,
+    iree_uk_mmt4d_tile_f32f32f32_2x2VLx1_arm_64_sve2, 2)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_f32f32f32_1x2VLx1_to_8x2VLx1_arm_64_sve2,
+    iree_uk_mmt4d_tile_f32f32f32_4x2VLx1_arm_64_sve2, 4)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_f32f32f32_1x2VLx1_to_8x2VLx1_arm_64_sve2,
+    iree_uk_mmt4d_tile_f32f32f32_8x2VLx1_arm_64_sve2, 8)
+
+// Same structure as the dotprod 8x8x4 kernel in mmt4d_arm_64_dotprod.c. Each
+// LHS row's 4 bytes are broadcast to all 32-bit lanes so that a plain
+// (non-indexed) SDOT handles any M0.
+IREE_UK_ATTRIBUTE_ALWAYS_INLINE static inline void
+iree_uk_mmt4d_tile_s8s8s32_1x2VLx4_to_8x2VLx4_arm_64_sve2(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel,
+    const iree_uk_mmt4d_params_t* params, int M0) {
+  IREE_UK_ASSERT(M0 >= 1 && M0 <= 8 && iree_uk_is_po2_u32(M0));
+  IREE_UK_ASSERT(params->N0 == 2 * svcntw());
+  const iree_uk_int32_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
+  const bool accumulate = params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE;
+  const svbool_t pg32 = svptrue_b32();
+  const svbool_t pg8 = svptrue_b8();
+#define IREE_UK_ACC_INIT(i)                                \
+  svint32_t acc##i##_0 = svdup_n_s32(0);                   \
+  svint32_t acc##i##_1 = svdup_n_s32(0);                   \
+  if (M0 > i && accumulate) {                              \
+    acc##i##_0 = svld1_vnum_s32(pg32, out_ptr, 2 * i + 0); \
+    acc##i##_1 = svld1_vnum_s32(pg32, out_ptr, 2 * i + 1); \
+  }
+  IREE_UK_SVE2_REPEAT_8(IREE_UK_ACC_INIT)
+#undef IREE_UK_ACC_INIT
+  for (int k = 0; k < params->K; ++k) {
+    svint8_t rhs_0 = svld1_vnum_s8(pg8, rhs_ptr, 0);
+    svint8_t rhs_1 = svld1_vnum_s8(pg8, rhs_ptr, 1);
+    rhs_ptr += 4 * params->N0;
+#define IREE_UK_ACC_DOT(i)                                            \
+  if (M0 > i) {                                                       \
+    svint8_t lhs_##i = svreinterpret_s8_s32(svdup_n_s32(lhs_ptr[i])); \
+    acc##i##_0 = svdot_s32(acc##i##_0, rhs_0, lhs_##i);               \
+    acc##i##_1 = svdot_s32(acc##i##_1, rhs_1, lhs_##i);               \
+  }
+    IREE_UK_SVE2_REPEAT_8(IREE_UK_ACC_DOT)
+#undef IREE_UK_ACC_DOT
+    lhs_ptr += M0;
+  }
+#define IREE_UK_ACC_STORE(i)                              \
+  if (M0 > i) {                                           \
+    svst1_vnum_s32(pg32, out_ptr, 2 * i + 0, acc##i##_0); \
+    svst1_vnum_s32(pg32, out_ptr, 2 * i + 1, acc##i##_1); \
+  }
+  IREE_UK_SVE2_REPEAT_8(IREE_UK_ACC_STORE)
+#undef IREE_UK_ACC_STORE
+}
+
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_s8s8s32_1x2VLx4_to_8x2VLx4_arm_64_sve2,
+    iree_uk_mmt4d_tile_s8s8s32_1x2VLx4_arm_64_sve2, 1)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_s8s8s32_1x2VLx4_to_8x2VLx4_arm_64_sve2,
+    iree_uk_mmt4d_tile_s8s8s32_2x2VLx4_arm_64_sve2, 2)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_s8s8s32_1x2VLx4_to_8x2VLx4_arm_64_sve2,
+    iree_uk_mmt4d_tile_s8s8s32_4x2VLx4_arm_64_sve2, 4)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_s8s8s32_1x2VLx4_to_8x2VLx4_arm_64_sve2,
+    iree_uk_mmt4d_tile_s8s8s32_8x2VLx4_arm_64_sve2, 8)
@@ -5,22 +5,49 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 #include "iree/builtins/ukernel/arch/arm_64/common_arm_64.h"
+#include "iree/builtins/ukernel/arch/arm_64/mmt4d_arm_64_internal.h"
 #include "iree/builtins/ukernel/query_tile_sizes_internal.h"
 
 static iree_uk_matmul_tile_sizes_t
 iree_uk_query_matmul_tile_sizes_arm_64_f32f32f32(
     const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_SME
+  if (iree_uk_cpu_arm_64_sme(params->cpu_data)) {
+    int vl = (int)iree_uk_arm_64_sme_vl_words();
+    return (iree_uk_matmul_tile_sizes_t){.M = vl, .K = 1, .N = vl};
+  }
+#endif
+#ifdef IREE_UK_BUILD_ARM_64_SVE2
+  if (iree_uk_cpu_arm_64_sve2(params->cpu_data) &&
+      iree_uk_arm_64_sve2_vl_words() > 4) {
+    int vl = (int)iree_uk_arm_64_sve2_vl_words();
+    return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 2 * vl};
+  }
+#endif
   return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
 }
 
 static iree_uk_matmul_tile_sizes_t
 iree_uk_query_matmul_tile_sizes_arm_64_i8i8i32(
     const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_ARM_64_SME
+  if (iree_uk_cpu_arm_64_sme(params->cpu_data)) {
+    int vl = (int)iree_uk_arm_64_sme_vl_words();
+    return (iree_uk_matmul_tile_sizes_t){.M = vl, .K = 4, .N = vl};
+  }
+#endif
 #ifdef IREE_UK_BUILD_ARM_64_I8MM
   if (iree_uk_cpu_arm_64_i8mm(params->cpu_data)) {
     return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 8, .N = 8};
   }
 #endif
+#ifdef IREE_UK_BUILD_ARM_64_SVE2
+  if (iree_uk_cpu_arm_64_sve2(params->cpu_data) &&
+      iree_uk_arm_64_sve2_vl_words() > 4) {
+    int vl = (int)iree_uk_arm_64_sve2_vl_words();
+    return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 4, .N = 2 * vl};
+  }
+#endif
 #ifdef IREE_UK_BUILD_ARM_64_DOTPROD
   if (iree_uk_cpu_arm_64_dotprod(params->cpu_data)) {
     return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 4, .N = 8};
@@ -0,0 +1,31 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_MMT4D_RISCV_64_INTERNAL_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_MMT4D_RISCV_64_INTERNAL_H_
+
+#include "iree/builtins/ukernel/mmt4d_internal.h"
+
+#define IREE_UK_MMT4D_TILE(ARCH, LHS, RHS, OUT, M0, K0, SUFFIX) \
+  IREE_UK_MMT4D_TILE_FUNC_DECL(                                 \
+      iree_uk_mmt4d_tile_##LHS##RHS##OUT##_##M0##xVLx##K0##_##ARCH##SUFFIX)
+
+#include "iree/builtins/ukernel/arch/riscv_64/mmt4d_riscv_64_tiles.inl"
+
+#undef IREE_UK_MMT4D_TILE
+
+// Expands X(0) through X(7). RVV vector types are sizeless and cannot be
+// array elements, so per-row accumulators have to be named individually.
+#define IREE_UK_RISCV_64_REPEAT_8(X) \
+  X(0) X(1) X(2) X(3) X(4) X(5) X(6) X(7)
+
+// Returns the number of 32-bit elements in a group of 2 vector registers
+// (VLEN/16), which is the natural N0 for the tile functions above as their
+// accumulators are LMUL=2 vectors of 32-bit elements. Only callable when the
+// CPU supports the V extension.
+iree_uk_index_t iree_uk_riscv_64_v_vlmax_e32m2(void);
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_MMT4D_RISCV_64_INTERNAL_H_
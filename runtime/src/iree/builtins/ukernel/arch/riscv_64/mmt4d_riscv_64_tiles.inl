@@ -0,0 +1,30 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Unlike other architectures, tiles here are not specialized on N0: the tile
+// functions are vector-length-agnostic and handle any N0 (typically VLEN/16,
+// see query_tile_sizes_riscv_64_entry_point.c) by strip-mining with vsetvl.
+// The "VL" in the tile function names stands in for the N0 dimension.
+//
+// Ordering matters when multiple lines have the same types and tile shape and
+// are supported by the CPU. In that case, the last-enumerated line overrides
+// preceding lines. Always go from oldest to shiniest code path.
+IREE_UK_MMT4D_TILE(riscv_64, f32, f32, f32, 1, 1, _v)
+IREE_UK_MMT4D_TILE(riscv_64, f32, f32, f32, 2, 1, _v)
+IREE_UK_MMT4D_TILE(riscv_64, f32, f32, f32, 4, 1, _v)
+IREE_UK_MMT4D_TILE(riscv_64, f32, f32, f32, 8, 1, _v)
+IREE_UK_MMT4D_TILE(riscv_64, f16, f16, f32, 1, 1, _zvfh)
+IREE_UK_MMT4D_TILE(riscv_64, f16, f16, f32, 2, 1, _zvfh)
+IREE_UK_MMT4D_TILE(riscv_64, f16, f16, f32, 4, 1, _zvfh)
+IREE_UK_MMT4D_TILE(riscv_64, f16, f16, f32, 8, 1, _zvfh)
+IREE_UK_MMT4D_TILE(riscv_64, f16, f16, f16, 1, 1, _zvfh)
+IREE_UK_MMT4D_TILE(riscv_64, f16, f16, f16, 2, 1, _zvfh)
+IREE_UK_MMT4D_TILE(riscv_64, f16, f16, f16, 4, 1, _zvfh)
+IREE_UK_MMT4D_TILE(riscv_64, f16, f16, f16, 8, 1, _zvfh)
+IREE_UK_MMT4D_TILE(riscv_64, s8, s8, s32, 1, 1, _v)
+IREE_UK_MMT4D_TILE(riscv_64, s8, s8, s32, 2, 1, _v)
+IREE_UK_MMT4D_TILE(riscv_64, s8, s8, s32, 4, 1, _v)
+IREE_UK_MMT4D_TILE(riscv_64, s8, s8, s32, 8, 1, _v)
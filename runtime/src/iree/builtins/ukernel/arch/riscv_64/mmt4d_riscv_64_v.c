@@ -0,0 +1,128 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <riscv_vector.h>
+
+#include "iree/builtins/ukernel/arch/riscv_64/common_riscv_64.h"
+#include "iree/builtins/ukernel/arch/riscv_64/mmt4d_riscv_64_internal.h"
+
+iree_uk_index_t iree_uk_riscv_64_v_vlmax_e32m2(void) {
+  return __riscv_vsetvlmax_e32m2();
+}
+
+// The tile functions below keep M0 accumulators of LMUL=2 and strip-mine the
+// N0 dimension with vsetvl, so they are correct for any N0 and any VLEN and
+// process a whole tile row per vector instruction when N0 == VLEN/16.
+
+IREE_UK_ATTRIBUTE_ALWAYS_INLINE static inline void
+iree_uk_mmt4d_tile_f32f32f32_1xVLx1_to_8xVLx1_riscv_64_v(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel,
+    const iree_uk_mmt4d_params_t* params, int M0) {
+  IREE_UK_ASSERT(M0 >= 1 && M0 <= 8 && iree_uk_is_po2_u32(M0));
+  float* IREE_UK_RESTRICT out_ptr = out_tile;
+  const float* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const float* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  const iree_uk_index_t N0 = params->N0;
+  const bool accumulate = params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE;
+  for (iree_uk_index_t n = 0; n < N0;) {
+    size_t vl = __riscv_vsetvl_e32m2(N0 - n);
+#define IREE_UK_ACC_INIT(i)                                   \
+  vfloat32m2_t acc##i = __riscv_vfmv_v_f_f32m2(0.0f, vl);     \
+  if (M0 > i && accumulate) {                                 \
+    acc##i = __riscv_vle32_v_f32m2(out_ptr + i * N0 + n, vl); \
+  }
+    IREE_UK_RISCV_64_REPEAT_8(IREE_UK_ACC_INIT)
+#undef IREE_UK_ACC_INIT
+    const float* IREE_UK_RESTRICT lhs_k = lhs_ptr;
+    const float* IREE_UK_RESTRICT rhs_k = rhs_ptr + n;
+    for (iree_uk_index_t k = 0; k < params->K; ++k) {
+      vfloat32m2_t rhs = __riscv_vle32_v_f32m2(rhs_k, vl);
+      rhs_k += N0;
+#define IREE_UK_ACC_FMA(i) \
+  if (M0 > i) acc##i = __riscv_vfmacc_vf_f32m2(acc##i, lhs_k[i], rhs, vl);
+      IREE_UK_RISCV_64_REPEAT_8(IREE_UK_ACC_FMA)
+#undef IREE_UK_ACC_FMA
+      lhs_k += M0;
+    }
+#define IREE_UK_ACC_STORE(i) \
+  if (M0 > i) __riscv_vse32_v_f32m2(out_ptr + i * N0 + n, acc##i, vl);
+    IREE_UK_RISCV_64_REPEAT_8(IREE_UK_ACC_STORE)
+#undef IREE_UK_ACC_STORE
+    n += vl;
+  }
+}
+
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_f32f32f32_1xVLx1_to_8xVLx1_riscv_64_v,
+    iree_uk_mmt4d_tile_f32f32f32_1xVLx1_riscv_64_v, 1)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_f32f32f32_1xVLx1_to_8xVLx1_riscv_64_v,
+    iree_uk_mmt4d_tile_f32f32f32_2xVLx1_riscv_64_v, 2)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_f32f32f32_1xVLx1_to_8xVLx1_riscv_64_v,
+    iree_uk_mmt4d_tile_f32f32f32_4xVLx1_riscv_64_v, 4)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_f32f32f32_1xVLx1_to_8xVLx1_riscv_64_v,
+    iree_uk_mmt4d_tile_f32f32f32_8xVLx1_riscv_64_v, 8)
+
+// The RHS is sign-extended to 16 bits once per K step so that the widening
+// multiply-accumulate (vwmacc) can accumulate directly into 32 bits. The
+// i8 (LMUL=1/2), i16 (LMUL=1) and i32 (LMUL=2) vectors all hold vl elements.
+IREE_UK_ATTRIBUTE_ALWAYS_INLINE static inline void
+iree_uk_mmt4d_tile_s8s8s32_1xVLx1_to_8xVLx1_riscv_64_v(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel,
+    const iree_uk_mmt4d_params_t* params, int M0) {
+  IREE_UK_ASSERT(M0 >= 1 && M0 <= 8 && iree_uk_is_po2_u32(M0));
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+  const iree_uk_index_t N0 = params->N0;
+  const bool accumulate = params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE;
+  for (iree_uk_index_t n = 0; n < N0;) {
+    size_t vl = __riscv_vsetvl_e32m2(N0 - n);
+#define IREE_UK_ACC_INIT(i)                                   \
+  vint32m2_t acc##i = __riscv_vmv_v_x_i32m2(0, vl);           \
+  if (M0 > i && accumulate) {                                 \
+    acc##i = __riscv_vle32_v_i32m2(out_ptr + i * N0 + n, vl); \
+  }
+    IREE_UK_RISCV_64_REPEAT_8(IREE_UK_ACC_INIT)
+#undef IREE_UK_ACC_INIT
+    const iree_uk_int8_t* IREE_UK_RESTRICT lhs_k = lhs_ptr;
+    const iree_uk_int8_t* IREE_UK_RESTRICT rhs_k = rhs_ptr + n;
+    for (iree_uk_index_t k = 0; k < params->K; ++k) {
+      vint16m1_t rhs =
+          __riscv_vsext_vf2_i16m1(__riscv_vle8_v_i8mf2(rhs_k, vl), vl);
+      rhs_k += N0;
+#define IREE_UK_ACC_FMA(i)                                       \
+  if (M0 > i) {                                                  \
+    acc##i = __riscv_vwmacc_vx_i32m2(acc##i, lhs_k[i], rhs, vl); \
+  }
+      IREE_UK_RISCV_64_REPEAT_8(IREE_UK_ACC_FMA)
+#undef IREE_UK_ACC_FMA
+      lhs_k += M0;
+    }
+#define IREE_UK_ACC_STORE(i) \
+  if (M0 > i) __riscv_vse32_v_i32m2(out_ptr + i * N0 + n, acc##i, vl);
+    IREE_UK_RISCV_64_REPEAT_8(IREE_UK_ACC_STORE)
+#undef IREE_UK_ACC_STORE
+    n += vl;
+  }
+}
+
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_s8s8s32_1xVLx1_to_8xVLx1_riscv_64_v,
+    iree_uk_mmt4d_tile_s8s8s32_1xVLx1_riscv_64_v, 1)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_s8s8s32_1xVLx1_to_8xVLx1_riscv_64_v,
+    iree_uk_mmt4d_tile_s8s8s32_2xVLx1_riscv_64_v, 2)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_s8s8s32_1xVLx1_to_8xVLx1_riscv_64_v,
+    iree_uk_mmt4d_tile_s8s8s32_4xVLx1_riscv_64_v, 4)
+IREE_UK_MMT4D_TILE_FUNC_IMPL_FOR_M0(
+    iree_uk_mmt4d_tile_s8s8s32_1xVLx1_to_8xVLx1_riscv_64_v,
+    iree_uk_mmt4d_tile_s8s8s32_8xVLx1_riscv_64_v, 8)
@@ -0,0 +1,35 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/riscv_64/common_riscv_64.h"
+#include "iree/builtins/ukernel/arch/riscv_64/pack_riscv_64_internal.h"
+
+iree_uk_pack_tile_func_t iree_uk_pack_select_tile_func_arch(
+    const iree_uk_pack_params_t* params) {
+#ifdef IREE_UK_BUILD_RISCV_64_V
+  if (!iree_uk_cpu_riscv_64_v(params->cpu_data)) return 0;
+  // As on other architectures, only the element type size matters.
+  iree_uk_pack_type_t pack_type = iree_uk_pack_type(params->flags);
+  int esize = iree_uk_type_size(iree_uk_pack_out_type(pack_type));
+  bool transpose = params->flags & IREE_UK_FLAG_PACK_TRANSPOSE_INNER;
+  if (params->out_size3 == 1) {
+    switch (esize) {
+      case 1:
+        return iree_uk_pack_tile_VLx1_x8_riscv_64_v;
+      case 2:
+        return iree_uk_pack_tile_VLx1_x16_riscv_64_v;
+      case 4:
+        return iree_uk_pack_tile_VLx1_x32_riscv_64_v;
+      default:
+        return 0;
+    }
+  }
+  if (esize == 4 && !transpose) {
+    return iree_uk_pack_tile_VLxVL_x32_riscv_64_v_direct;
+  }
+#endif  // IREE_UK_BUILD_RISCV_64_V
+  return 0;
+}
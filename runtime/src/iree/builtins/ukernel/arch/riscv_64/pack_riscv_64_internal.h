@@ -0,0 +1,22 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_PACK_RISCV_64_INTERNAL_H_
+#define IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_PACK_RISCV_64_INTERNAL_H_
+
+#include "iree/builtins/ukernel/pack_internal.h"
+
+// Tile functions named NxVL handle any tile_size0 (typically VLEN/16 for the
+// RHS, see mmt4d_riscv_64_tiles.inl) and require tile_size1 == N. When
+// tile_size1 == 1 the direct and transposed layouts coincide, so one function
+// serves both.
+IREE_UK_PACK_TILE_FUNC_DECL(iree_uk_pack_tile_VLx1_x8_riscv_64_v)
+IREE_UK_PACK_TILE_FUNC_DECL(iree_uk_pack_tile_VLx1_x16_riscv_64_v)
+IREE_UK_PACK_TILE_FUNC_DECL(iree_uk_pack_tile_VLx1_x32_riscv_64_v)
+// Any tile_size0 and tile_size1, non-transposed. Used for accumulators.
+IREE_UK_PACK_TILE_FUNC_DECL(iree_uk_pack_tile_VLxVL_x32_riscv_64_v_direct)
+
+#endif  // IREE_BUILTINS_UKERNEL_ARCH_RISCV_64_PACK_RISCV_64_INTERNAL_H_
@@ -0,0 +1,71 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <riscv_vector.h>
+
+#include "iree/builtins/ukernel/arch/riscv_64/common_riscv_64.h"
+#include "iree/builtins/ukernel/arch/riscv_64/pack_riscv_64_internal.h"
+
+// Gathers one source column of tile_size0 elements with a strided load per
+// output tile, so each output tile is written with contiguous stores.
+#define IREE_UK_PACK_TILE_VLX1_RISCV_64_V(BITS, CTYPE, LMUL)                \
+  void iree_uk_pack_tile_VLx1_x##BITS##_riscv_64_v(                         \
+      void* IREE_UK_RESTRICT out_tile_ptr,                                  \
+      const void* IREE_UK_RESTRICT in_tile_ptr,                             \
+      iree_uk_index_t outer_size1, iree_uk_index_t out_stride1,             \
+      iree_uk_index_t in_stride0, iree_uk_index_t elem_size,                \
+      iree_uk_index_t tile_size0, iree_uk_index_t tile_size1) {             \
+    IREE_UK_ASSERT(elem_size == sizeof(CTYPE));                             \
+    IREE_UK_ASSERT(tile_size1 == 1);                                        \
+    CTYPE* IREE_UK_RESTRICT out_ptr = out_tile_ptr;                         \
+    const CTYPE* IREE_UK_RESTRICT in_ptr = in_tile_ptr;                     \
+    const iree_uk_index_t in_byte_stride0 = in_stride0 * sizeof(CTYPE);     \
+    for (; outer_size1 > 0; --outer_size1) {                                \
+      for (iree_uk_index_t i = 0; i < tile_size0;) {                        \
+        size_t vl = __riscv_vsetvl_e##BITS##LMUL(tile_size0 - i);           \
+        __riscv_vse##BITS##_v_u##BITS##LMUL(                                \
+            (void*)(out_ptr + i),                                           \
+            __riscv_vlse##BITS##_v_u##BITS##LMUL(                           \
+                (const void*)(in_ptr + i * in_stride0), in_byte_stride0,    \
+                vl),                                                        \
+            vl);                                                            \
+        i += vl;                                                            \
+      }                                                                     \
+      out_ptr += out_stride1;                                               \
+      in_ptr += 1;                                                          \
+    }                                                                       \
+  }
+
+IREE_UK_PACK_TILE_VLX1_RISCV_64_V(8, iree_uk_uint8_t, m1)
+IREE_UK_PACK_TILE_VLX1_RISCV_64_V(16, iree_uk_uint16_t, m1)
+IREE_UK_PACK_TILE_VLX1_RISCV_64_V(32, iree_uk_uint32_t, m2)
+
+void iree_uk_pack_tile_VLxVL_x32_riscv_64_v_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_index_t outer_size1,
+    iree_uk_index_t out_stride1, iree_uk_index_t in_stride0,
+    iree_uk_index_t elem_size, iree_uk_index_t tile_size0,
+    iree_uk_index_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  iree_uk_uint32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_uint32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    iree_uk_uint32_t* IREE_UK_RESTRICT out_row = out_ptr;
+    const iree_uk_uint32_t* IREE_UK_RESTRICT in_row = in_ptr;
+    for (iree_uk_index_t i0 = 0; i0 < tile_size0; ++i0) {
+      for (iree_uk_index_t i1 = 0; i1 < tile_size1;) {
+        size_t vl = __riscv_vsetvl_e32m2(tile_size1 - i1);
+        __riscv_vse32_v_u32m2(out_row + i1,
+                              __riscv_vle32_v_u32m2(in_row + i1, vl), vl);
+        i1 += vl;
+      }
+      out_row += tile_size1;
+      in_row += in_stride0;
+    }
+    out_ptr += out_stride1;
+    in_ptr += tile_size1;
+  }
+}
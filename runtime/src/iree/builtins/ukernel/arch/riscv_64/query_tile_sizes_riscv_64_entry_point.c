@@ -0,0 +1,36 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/riscv_64/common_riscv_64.h"
+#include "iree/builtins/ukernel/arch/riscv_64/mmt4d_riscv_64_internal.h"
+#include "iree/builtins/ukernel/query_tile_sizes_internal.h"
+
+// f32 and i8 matmuls share the same tile shape: the i8 kernels widen into
+// the same LMUL=2 32-bit accumulators as the f32 kernels.
+static iree_uk_matmul_tile_sizes_t iree_uk_query_matmul_tile_sizes_riscv_64(
+    const iree_uk_query_tile_sizes_2d_params_t* params) {
+#ifdef IREE_UK_BUILD_RISCV_64_V
+  if (iree_uk_cpu_riscv_64_v(params->cpu_data)) {
+    return (iree_uk_matmul_tile_sizes_t){
+        .M = 8, .K = 1, .N = (int)iree_uk_riscv_64_v_vlmax_e32m2()};
+  }
+#endif
+  return (iree_uk_matmul_tile_sizes_t){.M = 8, .K = 1, .N = 8};
+}
+
+bool iree_uk_query_matmul_tile_sizes_arch(
+    const iree_uk_query_tile_sizes_2d_params_t* params,
+    iree_uk_matmul_tile_sizes_t* out_matmul_tile_sizes) {
+  iree_uk_uint32_t op = iree_uk_query_tile_sizes_operation(params->flags);
+  if (op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_F32F32F32 ||
+      op == IREE_UK_FLAG_QUERY_TILE_SIZES_OPERATION_MATMUL_I8I8I32) {
+    *out_matmul_tile_sizes = iree_uk_query_matmul_tile_sizes_riscv_64(params);
+    return true;
+  } else {
+    // Shouldn't happen, validated earlier.
+    return false;
+  }
+}
@@ -0,0 +1,37 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <riscv_vector.h>
+
+#include "iree/builtins/ukernel/arch/riscv_64/common_riscv_64.h"
+#include "iree/builtins/ukernel/arch/riscv_64/unpack_riscv_64_internal.h"
+
+void iree_uk_unpack_tile_VLxVL_x32_riscv_64_v_direct(
+    void* IREE_UK_RESTRICT out_tile_ptr,
+    const void* IREE_UK_RESTRICT in_tile_ptr, iree_uk_index_t outer_size1,
+    iree_uk_index_t out_stride0, iree_uk_index_t in_stride1,
+    iree_uk_index_t elem_size, iree_uk_index_t tile_size0,
+    iree_uk_index_t tile_size1) {
+  IREE_UK_ASSERT(elem_size == 4);
+  iree_uk_uint32_t* IREE_UK_RESTRICT out_ptr = out_tile_ptr;
+  const iree_uk_uint32_t* IREE_UK_RESTRICT in_ptr = in_tile_ptr;
+  for (; outer_size1 > 0; --outer_size1) {
+    iree_uk_uint32_t* IREE_UK_RESTRICT out_row = out_ptr;
+    const iree_uk_uint32_t* IREE_UK_RESTRICT in_row = in_ptr;
+    for (iree_uk_index_t i0 = 0; i0 < tile_size0; ++i0) {
+      for (iree_uk_index_t i1 = 0; i1 < tile_size1;) {
+        size_t vl = __riscv_vsetvl_e32m2(tile_size1 - i1);
+        __riscv_vse32_v_u32m2(out_row + i1,
+                              __riscv_vle32_v_u32m2(in_row + i1, vl), vl);
+        i1 += vl;
+      }
+      out_row += out_stride0;
+      in_row += tile_size1;
+    }
+    out_ptr += tile_size1;
+    in_ptr += in_stride1;
+  }
+}
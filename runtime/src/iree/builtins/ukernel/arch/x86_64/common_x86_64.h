@@ -18,6 +18,7 @@
 #define IREE_UK_BUILD_X86_64_AVX512_BASE
 #define IREE_UK_BUILD_X86_64_AVX512_VNNI
 #define IREE_UK_BUILD_X86_64_AVX512_BF16
+#define IREE_UK_BUILD_X86_64_AMX
 #else  // IREE_DEVICE_STANDALONE
 // Compiling with the system toolchain. Include the configured header.
 #include "iree/builtins/ukernel/arch/x86_64/config_x86_64.h"
@@ -52,6 +53,22 @@ static inline bool iree_uk_cpu_x86_64_avx512_bf16(
          iree_uk_all_bits_set(cpu_data[0], IREE_CPU_DATA0_X86_64_AVX512BF16);
 }
 
+// The AMX tile functions also use AVX-512 to relayout the RHS, see
+// mmt4d_x86_64_amx.c.
+static inline bool iree_uk_cpu_x86_64_amx_int8(
+    const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_cpu_x86_64_avx512_base(cpu_data) &&
+         iree_uk_all_bits_set(cpu_data[0], IREE_CPU_DATA0_X86_64_AMXTILE |
+                                               IREE_CPU_DATA0_X86_64_AMXINT8);
+}
+
+static inline bool iree_uk_cpu_x86_64_amx_bf16(
+    const iree_uk_uint64_t* cpu_data) {
+  return iree_uk_cpu_x86_64_avx512_base(cpu_data) &&
+         iree_uk_all_bits_set(cpu_data[0], IREE_CPU_DATA0_X86_64_AMXTILE |
+                                               IREE_CPU_DATA0_X86_64_AMXBF16);
+}
+
 #if defined(__AVX2__)
 
 static inline __m256i iree_uk_avx_loadu_2x128(const void* src0,
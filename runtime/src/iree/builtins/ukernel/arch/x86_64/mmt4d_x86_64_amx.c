@@ -0,0 +1,183 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/builtins/ukernel/arch/x86_64/common_x86_64.h"
+#include "iree/builtins/ukernel/arch/x86_64/mmt4d_x86_64_internal.h"
+
+// AMX tile registers are used as follows, all configured as 16 rows of 64
+// bytes:
+//   0-3: accumulators. Consecutive K steps rotate through them so that the
+//        tile dot-products are independent and their latency is hidden.
+//        They are summed once at the end of the tile function.
+//   4-5: LHS tiles, loaded directly from the LHS panel. With K0 * sizeof(LHS)
+//        == 64 bytes, an M0xK0 LHS tile is exactly the row-major A operand.
+//   6-7: RHS tiles. The B operand has to be in "VNNI" layout, i.e. groups of
+//        4 bytes along K are laid out contiguously for each column, so the
+//        N0xK0 RHS tile is transposed as a 16x16 matrix of 32-bit elements.
+//
+// The tile configuration is per-thread state. The ukernel has no control over
+// which worker thread runs it nor over what else ran on that thread before,
+// so every call loads its configuration and releases the tile state on exit.
+// The cost of that is negligible compared to the K loop and releasing keeps
+// context switches of idle worker threads from saving 8KiB of tile data.
+//
+// The OS permission to use the tile data state (arch_prctl on Linux) is
+// requested by the runtime when it detects the CPU features, see
+// iree_cpu_initialize. The AMX CPU data bits are only set once granted.
+
+// GCC implements _tile_loadconfig and _tile_loadd as inline asm that does not
+// declare reading the memory behind its pointer operands, so stores to the
+// buffers written just before could be reordered or eliminated. This compiler
+// barrier is needed before those intrinsics when the source was written here.
+#if defined(IREE_UK_COMPILER_GCC)
+#define IREE_UK_AMX_MEMORY_BARRIER() __asm__ volatile("" ::: "memory")
+#else
+#define IREE_UK_AMX_MEMORY_BARRIER()
+#endif
+
+typedef struct iree_uk_amx_tile_config_t {
+  iree_uk_uint8_t palette_id;
+  iree_uk_uint8_t start_row;
+  iree_uk_uint8_t reserved[14];
+  iree_uk_uint16_t colsb[16];
+  iree_uk_uint8_t rows[16];
+} iree_uk_amx_tile_config_t;
+
+static inline void iree_uk_amx_load_tile_config_8x16x64b(void) {
+  iree_uk_amx_tile_config_t config;
+  iree_uk_memset(&config, 0, sizeof config);
+  config.palette_id = 1;
+  for (int i = 0; i < 8; ++i) {
+    config.colsb[i] = 64;
+    config.rows[i] = 16;
+  }
+  IREE_UK_AMX_MEMORY_BARRIER();
+  _tile_loadconfig(&config);
+}
+
+// Transposes a row-major 16x16 matrix of 32-bit elements.
+static inline void iree_uk_avx512_transpose_16x16xi32(
+    iree_uk_int32_t* IREE_UK_RESTRICT out_ptr,
+    const void* IREE_UK_RESTRICT in_data) {
+  const iree_uk_int32_t* IREE_UK_RESTRICT in_ptr = in_data;
+  __m512i r[16];
+  __m512i t[16];
+  IREE_UK_UNROLL for (int i = 0; i < 16; ++i) {
+    r[i] = _mm512_loadu_si512(in_ptr + 16 * i);
+  }
+  IREE_UK_UNROLL for (int i = 0; i < 16; i += 2) {
+    t[i + 0] = _mm512_unpacklo_epi32(r[i], r[i + 1]);
+    t[i + 1] = _mm512_unpackhi_epi32(r[i], r[i + 1]);
+  }
+  // Now each 128-bit lane of r[4 * g + j] holds rows 4 * g .. 4 * g + 3 of
+  // column 4 * lane + j.
+  IREE_UK_UNROLL for (int i = 0; i < 16; i += 4) {
+    r[i + 0] = _mm512_unpacklo_epi64(t[i + 0], t[i + 2]);
+    r[i + 1] = _mm512_unpackhi_epi64(t[i + 0], t[i + 2]);
+    r[i + 2] = _mm512_unpacklo_epi64(t[i + 1], t[i + 3]);
+    r[i + 3] = _mm512_unpackhi_epi64(t[i + 1], t[i + 3]);
+  }
+  // Gather the 4 lanes of each output row from the 4 row groups.
+  IREE_UK_UNROLL for (int j = 0; j < 4; ++j) {
+    __m512i lanes02_g01 = _mm512_shuffle_i32x4(r[j], r[4 + j], 0x88);
+    __m512i lanes13_g01 = _mm512_shuffle_i32x4(r[j], r[4 + j], 0xDD);
+    __m512i lanes02_g23 = _mm512_shuffle_i32x4(r[8 + j], r[12 + j], 0x88);
+    __m512i lanes13_g23 = _mm512_shuffle_i32x4(r[8 + j], r[12 + j], 0xDD);
+    _mm512_storeu_si512(out_ptr + 16 * (0 + j),
+                        _mm512_shuffle_i32x4(lanes02_g01, lanes02_g23, 0x88));
+    _mm512_storeu_si512(out_ptr + 16 * (4 + j),
+                        _mm512_shuffle_i32x4(lanes13_g01, lanes13_g23, 0x88));
+    _mm512_storeu_si512(out_ptr + 16 * (8 + j),
+                        _mm512_shuffle_i32x4(lanes02_g01, lanes02_g23, 0xDD));
+    _mm512_storeu_si512(out_ptr + 16 * (12 + j),
+                        _mm512_shuffle_i32x4(lanes13_g01, lanes13_g23, 0xDD));
+  }
+}
+
+// Shared implementation of the 16x16 tile functions, where each K step
+// consumes a 16x64-byte LHS tile and a 16x64-byte RHS tile. The tile
+// dot-product instruction differs by element type and must name its tile
+// registers as immediates, hence the `is_bf16` switch at each use.
+IREE_UK_ATTRIBUTE_ALWAYS_INLINE static inline void
+iree_uk_mmt4d_tile_16x16xK64B_x86_64_amx(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel,
+    const iree_uk_mmt4d_params_t* params, bool is_bf16) {
+  iree_uk_int32_t rhs_vnni[16 * 16] IREE_UK_ATTRIBUTE_ALIGNED(64);
+  iree_uk_int32_t acc[3][16 * 16] IREE_UK_ATTRIBUTE_ALIGNED(64);
+  const iree_uk_int8_t* IREE_UK_RESTRICT lhs_ptr = lhs_panel;
+  const iree_uk_int8_t* IREE_UK_RESTRICT rhs_ptr = rhs_panel;
+
+  iree_uk_amx_load_tile_config_8x16x64b();
+  if (params->flags & IREE_UK_FLAG_MMT4D_ACCUMULATE) {
+    _tile_loadd(0, out_tile, 64);
+  } else {
+    _tile_zero(0);
+  }
+  _tile_zero(1);
+  _tile_zero(2);
+  _tile_zero(3);
+
+#define IREE_UK_AMX_K_STEP(ACC, LHS, RHS)                \
+  _tile_loadd(LHS, lhs_ptr, 64);                         \
+  iree_uk_avx512_transpose_16x16xi32(rhs_vnni, rhs_ptr); \
+  IREE_UK_AMX_MEMORY_BARRIER();                          \
+  _tile_loadd(RHS, rhs_vnni, 64);                        \
+  if (is_bf16) {                                         \
+    _tile_dpbf16ps(ACC, LHS, RHS);                       \
+  } else {                                               \
+    _tile_dpbssd(ACC, LHS, RHS);                         \
+  }                                                      \
+  lhs_ptr += 16 * 64;                                    \
+  rhs_ptr += 16 * 64;
+
+  iree_uk_index_t k = 0;
+  for (; k + 4 <= params->K; k += 4) {
+    IREE_UK_AMX_K_STEP(0, 4, 6)
+    IREE_UK_AMX_K_STEP(1, 5, 7)
+    IREE_UK_AMX_K_STEP(2, 4, 6)
+    IREE_UK_AMX_K_STEP(3, 5, 7)
+  }
+  for (; k < params->K; ++k) {
+    IREE_UK_AMX_K_STEP(0, 4, 6)
+  }
+#undef IREE_UK_AMX_K_STEP
+
+  _tile_stored(0, out_tile, 64);
+  _tile_stored(1, acc[0], 64);
+  _tile_stored(2, acc[1], 64);
+  _tile_stored(3, acc[2], 64);
+  _tile_release();
+
+  iree_uk_int32_t* IREE_UK_RESTRICT out_ptr = out_tile;
+  IREE_UK_UNROLL for (int i = 0; i < 16; ++i) {
+    __m512i sum = _mm512_loadu_si512(out_ptr + 16 * i);
+    IREE_UK_UNROLL for (int j = 0; j < 3; ++j) {
+      __m512i partial = _mm512_loadu_si512(acc[j] + 16 * i);
+      sum = is_bf16 ? _mm512_castps_si512(_mm512_add_ps(
+                          _mm512_castsi512_ps(sum),
+                          _mm512_castsi512_ps(partial)))
+                    : _mm512_add_epi32(sum, partial);
+    }
+    _mm512_storeu_si512(out_ptr + 16 * i, sum);
+  }
+}
+
+void iree_uk_mmt4d_tile_s8s8s32_16x16x64_x86_64_amx_int8(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_16x16xK64B_x86_64_amx(out_tile, lhs_panel, rhs_panel,
+                                           params, /*is_bf16=*/false);
+}
+
+void iree_uk_mmt4d_tile_bf16bf16f32_16x16x32_x86_64_amx_bf16(
+    void* IREE_UK_RESTRICT out_tile, const void* IREE_UK_RESTRICT lhs_panel,
+    const void* IREE_UK_RESTRICT rhs_panel,
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_tile_16x16xK64B_x86_64_amx(out_tile, lhs_panel, rhs_panel,
+                                           params, /*is_bf16=*/true);
+}
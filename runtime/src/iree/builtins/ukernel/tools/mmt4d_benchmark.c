@@ -14,6 +14,7 @@
 #include "iree/builtins/ukernel/mmt4d_internal.h"
 #include "iree/builtins/ukernel/tools/benchmark.h"
 #include "iree/builtins/ukernel/tools/util.h"
+#include "iree/task/testing/concurrent_benchmark.h"
 
 IREE_FLAG(int32_t, m_size, 1,
           "M-dimension of mmt4d ops. The overall number of rows of the "
@@ -28,6 +29,109 @@ IREE_FLAG(
 IREE_FLAG(bool, accumulate, false,
           "Whether the kernel should accumulate into the existing accumulator "
           "tile values, or zero the accumulator tile.");
+IREE_FLAG(int32_t, threads, 0,
+          "Number of threads to run the kernel on concurrently, each pinned to "
+          "its own physical core and with its own buffers. Reports aggregate "
+          "and per-thread throughput. 0 runs on the calling thread only.");
+
+// Allocates and randomly initializes the buffers of |params|.
+static void iree_uk_benchmark_mmt4d_allocate_buffers(
+    iree_uk_mmt4d_params_t* params, iree_uk_random_engine_t* engine) {
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_type(params->flags);
+  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_type);
+  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
+  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(mmt4d_type);
+  iree_uk_index_t lhs_buffer_size =
+      iree_uk_2d_buffer_length(lhs_type, params->M, params->lhs_stride0);
+  iree_uk_index_t rhs_buffer_size =
+      iree_uk_2d_buffer_length(rhs_type, params->N, params->rhs_stride0);
+  iree_uk_index_t out_buffer_size =
+      iree_uk_2d_buffer_length(out_type, params->M, params->out_stride0);
+  void* lhs_buffer = malloc(lhs_buffer_size);
+  void* rhs_buffer = malloc(rhs_buffer_size);
+  void* out_buffer = malloc(out_buffer_size);
+  // It's just about plausible that on some platform, for some number type,
+  // performance might be different on zero buffers vs random buffers. But it
+  // shouldn't matter that we recreate the random engine every time, getting
+  // the same random values again.
+  iree_uk_write_random_buffer(lhs_buffer, lhs_buffer_size, lhs_type, engine);
+  iree_uk_write_random_buffer(rhs_buffer, rhs_buffer_size, rhs_type, engine);
+  iree_uk_write_random_buffer(out_buffer, out_buffer_size, out_type, engine);
+  params->lhs_buffer = lhs_buffer;
+  params->rhs_buffer = rhs_buffer;
+  params->out_buffer = out_buffer;
+}
+
+static void iree_uk_benchmark_mmt4d_free_buffers(
+    iree_uk_mmt4d_params_t* params) {
+  free((void*)params->lhs_buffer);
+  free((void*)params->rhs_buffer);
+  free(params->out_buffer);
+}
+
+// Returns the number of bytes of LHS, RHS and accumulator accessed by one
+// mmt4d with the given |params|.
+static int64_t iree_uk_benchmark_mmt4d_bytes(
+    const iree_uk_mmt4d_params_t* params) {
+  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_type(params->flags);
+  return iree_uk_2d_buffer_length(iree_uk_mmt4d_lhs_type(mmt4d_type),
+                                  params->M, params->lhs_stride0) +
+         iree_uk_2d_buffer_length(iree_uk_mmt4d_rhs_type(mmt4d_type),
+                                  params->N, params->rhs_stride0) +
+         iree_uk_2d_buffer_length(iree_uk_mmt4d_out_type(mmt4d_type),
+                                  params->M, params->out_stride0);
+}
+
+// Runs |iteration_count| mmt4d on the buffers owned by |thread_index|.
+// |user_data| is the array of per-thread params.
+static iree_status_t iree_uk_benchmark_mmt4d_thread(
+    void* user_data, iree_host_size_t thread_index, int64_t iteration_count) {
+  const iree_uk_mmt4d_params_t* params =
+      (const iree_uk_mmt4d_params_t*)user_data + thread_index;
+  for (int64_t i = 0; i < iteration_count; ++i) {
+    iree_uk_mmt4d_p(params);
+  }
+  return iree_ok_status();
+}
+
+// Runs mmt4d concurrently on FLAG_threads threads each with its own copy of
+// the buffers in |params|.
+static iree_status_t iree_uk_benchmark_mmt4d_concurrent(
+    const iree_uk_mmt4d_params_t* params, iree_uk_random_engine_t* engine,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_task_concurrent_benchmark_t concurrent_benchmark;
+  IREE_RETURN_IF_ERROR(iree_task_concurrent_benchmark_initialize(
+      FLAG_threads, benchmark_state->host_allocator, &concurrent_benchmark));
+  iree_host_size_t thread_count = concurrent_benchmark.thread_count;
+  iree_uk_mmt4d_params_t* thread_params =
+      malloc(thread_count * sizeof(thread_params[0]));
+  for (iree_host_size_t i = 0; i < thread_count; ++i) {
+    memcpy(&thread_params[i], params, sizeof(*params));
+    iree_uk_benchmark_mmt4d_allocate_buffers(&thread_params[i], engine);
+  }
+  iree_status_t status = iree_ok_status();
+  int64_t batch_count = 1;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, batch_count)) {
+    status = iree_task_concurrent_benchmark_run(
+        &concurrent_benchmark, iree_uk_benchmark_mmt4d_thread, thread_params,
+        batch_count);
+    batch_count *= 2;
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_task_concurrent_benchmark_report(
+        &concurrent_benchmark, benchmark_state, "FLOP",
+        2 * params->M * params->N * params->K * params->M0 * params->N0 *
+            params->K0,
+        iree_uk_benchmark_mmt4d_bytes(params));
+  }
+  for (iree_host_size_t i = 0; i < thread_count; ++i) {
+    iree_uk_benchmark_mmt4d_free_buffers(&thread_params[i]);
+  }
+  free(thread_params);
+  iree_task_concurrent_benchmark_deinitialize(&concurrent_benchmark);
+  return status;
+}
 
 static iree_status_t iree_uk_benchmark_mmt4d(
     const iree_benchmark_def_t* benchmark_def,
@@ -45,30 +149,12 @@ static iree_status_t iree_uk_benchmark_mmt4d(
   params.lhs_stride0 = params.K * params.M0 * params.K0;
   params.rhs_stride0 = params.K * params.N0 * params.K0;
   params.out_stride0 = params.N * params.M0 * params.N0;
-  iree_uk_mmt4d_type_t mmt4d_type = iree_uk_mmt4d_type(params.flags);
-  iree_uk_type_t lhs_type = iree_uk_mmt4d_lhs_type(mmt4d_type);
-  iree_uk_type_t rhs_type = iree_uk_mmt4d_rhs_type(mmt4d_type);
-  iree_uk_type_t out_type = iree_uk_mmt4d_out_type(mmt4d_type);
-  iree_uk_index_t lhs_buffer_size =
-      iree_uk_2d_buffer_length(lhs_type, params.M, params.lhs_stride0);
-  iree_uk_index_t rhs_buffer_size =
-      iree_uk_2d_buffer_length(rhs_type, params.N, params.rhs_stride0);
-  iree_uk_index_t out_buffer_size =
-      iree_uk_2d_buffer_length(out_type, params.M, params.out_stride0);
-  void* lhs_buffer = malloc(lhs_buffer_size);
-  void* rhs_buffer = malloc(rhs_buffer_size);
-  void* out_buffer = malloc(out_buffer_size);
   iree_uk_random_engine_t* engine = iree_uk_benchmark_random_engine(user_data);
-  // It's just about plausible that on some platform, for some number type,
-  // performance might be different on zero buffers vs random buffers. But it
-  // shouldn't matter that we recreate the random engine every time, getting
-  // the same random values again.
-  iree_uk_write_random_buffer(lhs_buffer, lhs_buffer_size, lhs_type, engine);
-  iree_uk_write_random_buffer(rhs_buffer, rhs_buffer_size, rhs_type, engine);
-  iree_uk_write_random_buffer(out_buffer, out_buffer_size, out_type, engine);
-  params.lhs_buffer = lhs_buffer;
-  params.rhs_buffer = rhs_buffer;
-  params.out_buffer = out_buffer;
+  if (FLAG_threads > 0) {
+    return iree_uk_benchmark_mmt4d_concurrent(&params, engine,
+                                              benchmark_state);
+  }
+  iree_uk_benchmark_mmt4d_allocate_buffers(&params, engine);
   int64_t total_iterations = 0;
   int64_t batch_count = 1;
   while (iree_benchmark_keep_running(benchmark_state, batch_count)) {
@@ -81,9 +167,7 @@ static iree_status_t iree_uk_benchmark_mmt4d(
   iree_benchmark_set_items_processed(
       benchmark_state, total_iterations * 2 * params.M * params.N * params.K *
                            params.M0 * params.N0 * params.K0);
-  free(lhs_buffer);
-  free(rhs_buffer);
-  free(out_buffer);
+  iree_uk_benchmark_mmt4d_free_buffers(&params);
   return iree_ok_status();
 }
 
@@ -151,6 +235,15 @@ int main(int argc, char** argv) {
                                    "dotprod");
   iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_S8S4S32, 4, 8, 16,
                                    "i8mm");
+  // Tile sizes for 256-bit SVE and 512-bit streaming SVE.
+  iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_F32F32F32, 8, 16, 1,
+                                   "sve2");
+  iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_S8S8S32, 8, 16, 4,
+                                   "sve2");
+  iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_F32F32F32, 16, 16, 1,
+                                   "sme");
+  iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_S8S8S32, 16, 16, 4,
+                                   "sme");
 #elif defined(IREE_ARCH_X86_64)
   iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_F32F32F32, 8, 8, 1,
                                    "avx2_fma");
@@ -182,6 +275,12 @@ int main(int argc, char** argv) {
                                    "avx512_vnni");
   iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_S16U4S32, 1, 32, 8,
                                    "avx512_vnni");
+  iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_S8S4S32, 16, 16, 2,
+                                   "avx512_vnni");
+  iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_S8S8S32, 16, 16, 64,
+                                   "amx_int8");
+  iree_uk_benchmark_register_mmt4d(IREE_UK_FLAG_MMT4D_TYPE_BF16BF16F32, 16, 16,
+                                   32, "amx_bf16");
 #else   // defined(IREE_ARCH_ARM_64)
   // Architectures on which we do not have any optimized ukernel code.
   // Benchmark some arbitrary tile shape.
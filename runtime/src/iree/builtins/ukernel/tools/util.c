@@ -270,6 +270,16 @@ void iree_uk_make_cpu_data_for_features(const char* cpu_features,
     out_cpu_data_fields[0] = avx512_base | IREE_CPU_DATA0_X86_64_AVX512BF16;
     return;
   }
+  if (!strcmp(cpu_features, "amx_int8")) {
+    out_cpu_data_fields[0] = avx512_base | IREE_CPU_DATA0_X86_64_AMXTILE |
+                             IREE_CPU_DATA0_X86_64_AMXINT8;
+    return;
+  }
+  if (!strcmp(cpu_features, "amx_bf16")) {
+    out_cpu_data_fields[0] = avx512_base | IREE_CPU_DATA0_X86_64_AMXTILE |
+                             IREE_CPU_DATA0_X86_64_AMXBF16;
+    return;
+  }
 #endif  // defined(IREE_ARCH_X86_64)
 
   // Fall back to interpreting cpu_features as a comma-separated list of LLVM
@@ -67,6 +67,73 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_format(
       statistics->device_bytes_freed,
       (statistics->device_bytes_allocated - statistics->device_bytes_freed)));
 
+  if (statistics->pool_acquire_count > 0) {
+    IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+        builder,
+        "        POOL: %12" PRIdsz "B peak / %12" PRIdsz
+        "B free / %12" PRIu64 " acquired / %12" PRIu64 " reused\n",
+        statistics->pool_bytes_peak, statistics->pool_bytes_free,
+        statistics->pool_acquire_count, statistics->pool_reuse_count));
+  }
+
+#else
+  // No-op when disabled.
+#endif  // IREE_STATISTICS_ENABLE
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_device_size_t iree_hal_allocator_capture_transient_peak(
+    const iree_hal_allocator_capture_t* capture) {
+#if IREE_STATISTICS_ENABLE
+  const iree_hal_allocator_statistics_t* begin = &capture->begin;
+  const iree_hal_allocator_statistics_t* end = &capture->end;
+  iree_device_size_t host_bytes_live =
+      begin->host_bytes_allocated - begin->host_bytes_freed;
+  iree_device_size_t device_bytes_live =
+      begin->device_bytes_allocated - begin->device_bytes_freed;
+  iree_device_size_t host_bytes_transient =
+      end->host_bytes_capture_peak > host_bytes_live
+          ? end->host_bytes_capture_peak - host_bytes_live
+          : 0;
+  iree_device_size_t device_bytes_transient =
+      end->device_bytes_capture_peak > device_bytes_live
+          ? end->device_bytes_capture_peak - device_bytes_live
+          : 0;
+  return host_bytes_transient + device_bytes_transient;
+#else
+  return 0;
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_allocator_capture_format(
+    const iree_hal_allocator_capture_t* capture,
+    iree_string_builder_t* builder) {
+#if IREE_STATISTICS_ENABLE
+  const iree_hal_allocator_statistics_t* begin = &capture->begin;
+  const iree_hal_allocator_statistics_t* end = &capture->end;
+
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder,
+      "  HOST_LOCAL: %12" PRIdsz "B peak / %12" PRIdsz
+      "B allocated / %12" PRIdsz "B freed / %12" PRIdsz "B live before\n",
+      end->host_bytes_capture_peak,
+      end->host_bytes_allocated - begin->host_bytes_allocated,
+      end->host_bytes_freed - begin->host_bytes_freed,
+      begin->host_bytes_allocated - begin->host_bytes_freed));
+
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder,
+      "DEVICE_LOCAL: %12" PRIdsz "B peak / %12" PRIdsz
+      "B allocated / %12" PRIdsz "B freed / %12" PRIdsz "B live before\n",
+      end->device_bytes_capture_peak,
+      end->device_bytes_allocated - begin->device_bytes_allocated,
+      end->device_bytes_freed - begin->device_bytes_freed,
+      begin->device_bytes_allocated - begin->device_bytes_freed));
+
+  IREE_RETURN_IF_ERROR(iree_string_builder_append_format(
+      builder, "   TRANSIENT: %12" PRIdsz "B peak\n",
+      iree_hal_allocator_capture_transient_peak(capture)));
+
 #else
   // No-op when disabled.
 #endif  // IREE_STATISTICS_ENABLE
@@ -108,6 +175,26 @@ IREE_API_EXPORT void iree_hal_allocator_query_statistics(
   });
 }
 
+IREE_API_EXPORT void iree_hal_allocator_begin_capture(
+    iree_hal_allocator_t* IREE_RESTRICT allocator,
+    iree_hal_allocator_capture_t* IREE_RESTRICT out_capture) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  IREE_ASSERT_ARGUMENT(out_capture);
+  memset(out_capture, 0, sizeof(*out_capture));
+  IREE_STATISTICS({
+    _VTABLE_DISPATCH(allocator, reset_capture_statistics)(allocator);
+    iree_hal_allocator_query_statistics(allocator, &out_capture->begin);
+  });
+}
+
+IREE_API_EXPORT void iree_hal_allocator_end_capture(
+    iree_hal_allocator_t* IREE_RESTRICT allocator,
+    iree_hal_allocator_capture_t* IREE_RESTRICT capture) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  IREE_ASSERT_ARGUMENT(capture);
+  iree_hal_allocator_query_statistics(allocator, &capture->end);
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_fprint(
     FILE* file, iree_hal_allocator_t* IREE_RESTRICT allocator) {
 #if IREE_STATISTICS_ENABLE
@@ -140,6 +227,35 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_fprint(
 #endif  // IREE_STATISTICS_ENABLE
 }
 
+IREE_API_EXPORT iree_status_t iree_hal_allocator_capture_fprint(
+    FILE* file, iree_string_view_t name,
+    const iree_hal_allocator_capture_t* capture,
+    iree_allocator_t host_allocator) {
+#if IREE_STATISTICS_ENABLE
+  iree_string_builder_t builder;
+  iree_string_builder_initialize(host_allocator, &builder);
+
+  iree_status_t status = iree_string_builder_append_format(
+      &builder, "[[ iree_hal_allocator_t memory statistics of %.*s ]]\n",
+      (int)name.size, name.data);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_allocator_capture_format(capture, &builder);
+  }
+
+  if (iree_status_is_ok(status)) {
+    fprintf(file, "%.*s", (int)iree_string_builder_size(&builder),
+            iree_string_builder_buffer(&builder));
+  }
+
+  iree_string_builder_deinitialize(&builder);
+  return status;
+#else
+  // No-op.
+  return iree_ok_status();
+#endif  // IREE_STATISTICS_ENABLE
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_allocator_query_memory_heaps(
     iree_hal_allocator_t* IREE_RESTRICT allocator, iree_host_size_t capacity,
     iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
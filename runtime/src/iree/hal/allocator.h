@@ -267,6 +267,18 @@ typedef struct iree_hal_allocator_statistics_t {
   iree_device_size_t device_bytes_peak;
   iree_device_size_t device_bytes_allocated;
   iree_device_size_t device_bytes_freed;
+  // Peak bytes live since the last iree_hal_allocator_begin_capture.
+  // Equivalent to the *_bytes_peak values if no capture has been started.
+  iree_device_size_t host_bytes_capture_peak;
+  iree_device_size_t device_bytes_capture_peak;
+  // Bytes held by pooling allocators (outstanding and cached) at their peak.
+  iree_device_size_t pool_bytes_peak;
+  // Bytes currently cached in pool free lists available for reuse.
+  iree_device_size_t pool_bytes_free;
+  // Total number of allocations served by pooling allocators.
+  uint64_t pool_acquire_count;
+  // Number of pooled allocations that reused a previously freed buffer.
+  uint64_t pool_reuse_count;
   // TODO(benvanik): mapping information (discarded, mapping ranges,
   //                 flushed/invalidated, etc).
 #else
@@ -279,6 +291,30 @@ IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_format(
     const iree_hal_allocator_statistics_t* statistics,
     iree_string_builder_t* builder);
 
+// Allocation statistics captured over an interval of time such as a single
+// invocation of a program function. Used to measure the peak transient memory
+// required by the work performed during the interval (queue-ordered
+// allocations, transient arenas, etc) independent of the long-lived resources
+// that were live before it began.
+typedef struct iree_hal_allocator_capture_t {
+  // Statistics at the time the capture began.
+  iree_hal_allocator_statistics_t begin;
+  // Statistics at the time the capture ended. The *_capture_peak values are
+  // the peaks observed during the capture.
+  iree_hal_allocator_statistics_t end;
+} iree_hal_allocator_capture_t;
+
+// Returns the peak number of bytes allocated during |capture| in addition to
+// those that were live when it began. Host and device bytes are combined.
+IREE_API_EXPORT iree_device_size_t
+iree_hal_allocator_capture_transient_peak(
+    const iree_hal_allocator_capture_t* capture);
+
+// Formats a capture as a pretty-printed multi-line string.
+IREE_API_EXPORT iree_status_t iree_hal_allocator_capture_format(
+    const iree_hal_allocator_capture_t* capture,
+    iree_string_builder_t* builder);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_allocator_t
 //===----------------------------------------------------------------------===//
@@ -310,11 +346,45 @@ IREE_API_EXPORT void iree_hal_allocator_query_statistics(
     iree_hal_allocator_t* IREE_RESTRICT allocator,
     iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics);
 
+// Begins capturing allocation statistics into |out_capture| by resetting the
+// capture peaks of |allocator| to the bytes currently live. Only one capture
+// may be active per allocator at a time; nested or concurrent captures will
+// observe the reset of the most recent one. The process-wide peaks reported by
+// iree_hal_allocator_query_statistics are not affected.
+//
+// Usage:
+//   iree_hal_allocator_capture_t capture;
+//   iree_hal_allocator_begin_capture(allocator, &capture);
+//   ... invoke + wait for completion ...
+//   iree_hal_allocator_end_capture(allocator, &capture);
+//   iree_hal_allocator_capture_transient_peak(&capture);
+//
+// NOTE: statistics may be compiled out in some configurations and the capture
+// will be all zeros.
+IREE_API_EXPORT void iree_hal_allocator_begin_capture(
+    iree_hal_allocator_t* IREE_RESTRICT allocator,
+    iree_hal_allocator_capture_t* IREE_RESTRICT out_capture);
+
+// Ends a capture started with iree_hal_allocator_begin_capture.
+// Work allocating memory that should be attributed to the capture must have
+// completed before calling this.
+IREE_API_EXPORT void iree_hal_allocator_end_capture(
+    iree_hal_allocator_t* IREE_RESTRICT allocator,
+    iree_hal_allocator_capture_t* IREE_RESTRICT capture);
+
 // Prints the current allocation statistics of |allocator| to |file|.
 // No-op if statistics are not enabled (IREE_STATISTICS_ENABLE).
 IREE_API_EXPORT iree_status_t iree_hal_allocator_statistics_fprint(
     FILE* file, iree_hal_allocator_t* IREE_RESTRICT allocator);
 
+// Prints the allocation statistics of |capture| to |file| labeled as |name|
+// (such as the function invoked during the capture).
+// No-op if statistics are not enabled (IREE_STATISTICS_ENABLE).
+IREE_API_EXPORT iree_status_t iree_hal_allocator_capture_fprint(
+    FILE* file, iree_string_view_t name,
+    const iree_hal_allocator_capture_t* capture,
+    iree_allocator_t host_allocator);
+
 // Queries the available memory heaps used for servicing allocation requests.
 // The resulting heaps are sorted in preferred performance order for common
 // execution with the most preferred first.
@@ -456,6 +526,9 @@ typedef struct iree_hal_allocator_vtable_t {
       iree_hal_allocator_t* IREE_RESTRICT allocator,
       iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics);
 
+  void(IREE_API_PTR* reset_capture_statistics)(
+      iree_hal_allocator_t* IREE_RESTRICT allocator);
+
   iree_status_t(IREE_API_PTR* query_memory_heaps)(
       iree_hal_allocator_t* IREE_RESTRICT allocator, iree_host_size_t capacity,
       iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
@@ -507,14 +580,20 @@ static inline void iree_hal_allocator_statistics_record_alloc(
     iree_hal_memory_type_t memory_type, iree_device_size_t allocation_size) {
   if (iree_all_bits_set(memory_type, IREE_HAL_MEMORY_TYPE_HOST_LOCAL)) {
     statistics->host_bytes_allocated += allocation_size;
+    iree_device_size_t host_bytes_live =
+        statistics->host_bytes_allocated - statistics->host_bytes_freed;
     statistics->host_bytes_peak =
-        iree_max(statistics->host_bytes_peak, statistics->host_bytes_allocated -
-                                                  statistics->host_bytes_freed);
+        iree_max(statistics->host_bytes_peak, host_bytes_live);
+    statistics->host_bytes_capture_peak =
+        iree_max(statistics->host_bytes_capture_peak, host_bytes_live);
   } else {
     statistics->device_bytes_allocated += allocation_size;
-    statistics->device_bytes_peak = iree_max(
-        statistics->device_bytes_peak,
-        statistics->device_bytes_allocated - statistics->device_bytes_freed);
+    iree_device_size_t device_bytes_live =
+        statistics->device_bytes_allocated - statistics->device_bytes_freed;
+    statistics->device_bytes_peak =
+        iree_max(statistics->device_bytes_peak, device_bytes_live);
+    statistics->device_bytes_capture_peak =
+        iree_max(statistics->device_bytes_capture_peak, device_bytes_live);
   }
 }
 
@@ -529,9 +608,19 @@ static inline void iree_hal_allocator_statistics_record_free(
   }
 }
 
+// Resets the capture peaks of |statistics| to the bytes currently live.
+static inline void iree_hal_allocator_statistics_reset_capture(
+    iree_hal_allocator_statistics_t* statistics) {
+  statistics->host_bytes_capture_peak =
+      statistics->host_bytes_allocated - statistics->host_bytes_freed;
+  statistics->device_bytes_capture_peak =
+      statistics->device_bytes_allocated - statistics->device_bytes_freed;
+}
+
 #else
 #define iree_hal_allocator_statistics_record_alloc(statistics, ...)
 #define iree_hal_allocator_statistics_record_free(statistics, ...)
+#define iree_hal_allocator_statistics_reset_capture(statistics)
 #endif  // IREE_STATISTICS_ENABLE
 
 #ifdef __cplusplus
@@ -99,6 +99,17 @@ static void iree_hal_heap_allocator_query_statistics(
   });
 }
 
+static void iree_hal_heap_allocator_reset_capture_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  IREE_STATISTICS({
+    iree_hal_heap_allocator_t* allocator =
+        iree_hal_heap_allocator_cast(base_allocator);
+    iree_slim_mutex_lock(&allocator->statistics.mutex);
+    iree_hal_allocator_statistics_reset_capture(&allocator->statistics.base);
+    iree_slim_mutex_unlock(&allocator->statistics.mutex);
+  });
+}
+
 static iree_status_t iree_hal_heap_allocator_query_memory_heaps(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_host_size_t capacity,
@@ -291,6 +302,7 @@ static const iree_hal_allocator_vtable_t iree_hal_heap_allocator_vtable = {
     .host_allocator = iree_hal_heap_allocator_host_allocator,
     .trim = iree_hal_heap_allocator_trim,
     .query_statistics = iree_hal_heap_allocator_query_statistics,
+    .reset_capture_statistics = iree_hal_heap_allocator_reset_capture_statistics,
     .query_memory_heaps = iree_hal_heap_allocator_query_memory_heaps,
     .query_buffer_compatibility =
         iree_hal_heap_allocator_query_buffer_compatibility,
@@ -7,6 +7,7 @@
 #include "iree/hal/buffer_view.h"
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/allocator.h"
 #include "iree/hal/buffer_view_util.h"
 #include "iree/hal/resource.h"
@@ -14,14 +15,61 @@
 struct iree_hal_buffer_view_t {
   iree_atomic_ref_count_t ref_count;
   iree_allocator_t host_allocator;
+  // Pool the buffer view returns to when released or NULL if not pooled.
+  iree_hal_buffer_view_pool_t* pool;
+  // Next buffer view in the pool freelist while the buffer view is released.
+  iree_hal_buffer_view_t* next_free;
   iree_hal_buffer_t* buffer;
   iree_hal_element_type_t element_type;
   iree_hal_encoding_type_t encoding_type;
   iree_device_size_t byte_length;
   iree_host_size_t shape_rank;
+  // Total number of dimensions that can be stored in |shape|.
+  iree_host_size_t shape_capacity;
   iree_hal_dim_t shape[];
 };
 
+// Initializes the buffer view metadata and retains |buffer|.
+// Any previously referenced buffer must be released by the caller.
+static void iree_hal_buffer_view_initialize(
+    iree_hal_buffer_view_t* buffer_view, iree_hal_buffer_t* buffer,
+    iree_host_size_t shape_rank, const iree_hal_dim_t* shape,
+    iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type) {
+  IREE_ASSERT_LE(shape_rank, buffer_view->shape_capacity);
+  buffer_view->buffer = buffer;
+  iree_hal_buffer_retain(buffer_view->buffer);
+  buffer_view->element_type = element_type;
+  buffer_view->encoding_type = encoding_type;
+  buffer_view->byte_length =
+      iree_hal_element_dense_byte_count(buffer_view->element_type);
+  buffer_view->shape_rank = shape_rank;
+  for (iree_host_size_t i = 0; i < shape_rank; ++i) {
+    buffer_view->shape[i] = shape[i];
+    buffer_view->byte_length *= shape[i];
+  }
+}
+
+// Allocates an uninitialized buffer view with storage for |shape_capacity|
+// dimensions.
+static iree_status_t iree_hal_buffer_view_allocate(
+    iree_host_size_t shape_capacity, iree_allocator_t host_allocator,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  // Note that we have the dynamically-sized shape dimensions on the end.
+  iree_hal_buffer_view_t* buffer_view = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator,
+      sizeof(*buffer_view) + sizeof(iree_hal_dim_t) * shape_capacity,
+      (void**)&buffer_view));
+  buffer_view->host_allocator = host_allocator;
+  buffer_view->pool = NULL;
+  buffer_view->next_free = NULL;
+  buffer_view->buffer = NULL;
+  buffer_view->shape_capacity = shape_capacity;
+  *out_buffer_view = buffer_view;
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
     iree_hal_buffer_t* buffer, iree_host_size_t shape_rank,
     const iree_hal_dim_t* shape, iree_hal_element_type_t element_type,
@@ -38,27 +86,13 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create(
 
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Allocate and initialize the iree_hal_buffer_view_t struct.
-  // Note that we have the dynamically-sized shape dimensions on the end.
   iree_hal_buffer_view_t* buffer_view = NULL;
-  iree_status_t status = iree_allocator_malloc(
-      host_allocator,
-      sizeof(*buffer_view) + sizeof(iree_hal_dim_t) * shape_rank,
-      (void**)&buffer_view);
+  iree_status_t status =
+      iree_hal_buffer_view_allocate(shape_rank, host_allocator, &buffer_view);
   if (iree_status_is_ok(status)) {
     iree_atomic_ref_count_init(&buffer_view->ref_count);
-    buffer_view->host_allocator = host_allocator;
-    buffer_view->buffer = buffer;
-    iree_hal_buffer_retain(buffer_view->buffer);
-    buffer_view->element_type = element_type;
-    buffer_view->encoding_type = encoding_type;
-    buffer_view->byte_length =
-        iree_hal_element_dense_byte_count(buffer_view->element_type);
-    buffer_view->shape_rank = shape_rank;
-    for (iree_host_size_t i = 0; i < shape_rank; ++i) {
-      buffer_view->shape[i] = shape[i];
-      buffer_view->byte_length *= shape[i];
-    }
+    iree_hal_buffer_view_initialize(buffer_view, buffer, shape_rank, shape,
+                                    element_type, encoding_type);
     *out_buffer_view = buffer_view;
   }
 
@@ -77,6 +111,39 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create_like(
       out_buffer_view);
 }
 
+IREE_API_EXPORT iree_status_t iree_hal_buffer_view_reset(
+    iree_hal_buffer_view_t* buffer_view, iree_hal_buffer_t* buffer,
+    iree_host_size_t shape_rank, const iree_hal_dim_t* shape,
+    iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type) {
+  IREE_ASSERT_ARGUMENT(buffer_view);
+  IREE_ASSERT_ARGUMENT(buffer);
+  if (IREE_UNLIKELY(iree_atomic_ref_count_load(&buffer_view->ref_count) !=
+                    1)) {
+    return iree_make_status(
+        IREE_STATUS_FAILED_PRECONDITION,
+        "buffer views can only be reset while uniquely referenced");
+  }
+  if (IREE_UNLIKELY(shape_rank > 0 && !shape)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "no shape dimensions specified");
+  }
+  if (IREE_UNLIKELY(shape_rank > buffer_view->shape_capacity)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "buffer view shape storage too small; "
+                            "rank=%" PRIhsz ", capacity=%" PRIhsz,
+                            shape_rank, buffer_view->shape_capacity);
+  }
+
+  // Retain the new buffer before releasing the old one in case they are the
+  // same.
+  iree_hal_buffer_t* previous_buffer = buffer_view->buffer;
+  iree_hal_buffer_view_initialize(buffer_view, buffer, shape_rank, shape,
+                                  element_type, encoding_type);
+  iree_hal_buffer_release(previous_buffer);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT void iree_hal_buffer_view_retain(
     iree_hal_buffer_view_t* buffer_view) {
   if (IREE_LIKELY(buffer_view)) {
@@ -92,12 +159,20 @@ IREE_API_EXPORT void iree_hal_buffer_view_release(
   }
 }
 
+static void iree_hal_buffer_view_pool_recycle(
+    iree_hal_buffer_view_pool_t* pool, iree_hal_buffer_view_t* buffer_view);
+
 IREE_API_EXPORT void iree_hal_buffer_view_destroy(
     iree_hal_buffer_view_t* buffer_view) {
   iree_allocator_t host_allocator = buffer_view->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
   iree_hal_buffer_release(buffer_view->buffer);
-  iree_allocator_free(host_allocator, buffer_view);
+  buffer_view->buffer = NULL;
+  if (buffer_view->pool) {
+    iree_hal_buffer_view_pool_recycle(buffer_view->pool, buffer_view);
+  } else {
+    iree_allocator_free(host_allocator, buffer_view);
+  }
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -240,3 +315,154 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_compute_range(
       buffer_view->encoding_type, indices_count, start_indices, lengths_count,
       lengths, out_start_offset, out_length);
 }
+
+//===----------------------------------------------------------------------===//
+// iree_hal_buffer_view_pool_t
+//===----------------------------------------------------------------------===//
+
+struct iree_hal_buffer_view_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  // Maximum number of released buffer views retained in the freelist.
+  iree_host_size_t max_free_count;
+  iree_slim_mutex_t mutex;
+  // Number of buffer views in the |free_head| list.
+  iree_host_size_t free_count IREE_GUARDED_BY(mutex);
+  // Released buffer views linked by their next_free field.
+  iree_hal_buffer_view_t* free_head IREE_GUARDED_BY(mutex);
+};
+
+IREE_API_EXPORT iree_status_t iree_hal_buffer_view_pool_create(
+    iree_host_size_t max_free_count, iree_allocator_t host_allocator,
+    iree_hal_buffer_view_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_buffer_view_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->max_free_count = max_free_count;
+  iree_slim_mutex_initialize(&pool->mutex);
+  pool->free_count = 0;
+  pool->free_head = NULL;
+  *out_pool = pool;
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_buffer_view_pool_destroy(
+    iree_hal_buffer_view_pool_t* pool) {
+  iree_allocator_t host_allocator = pool->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_buffer_view_pool_trim(pool);
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  iree_allocator_free(host_allocator, pool);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_hal_buffer_view_pool_retain(
+    iree_hal_buffer_view_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_hal_buffer_view_pool_release(
+    iree_hal_buffer_view_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_buffer_view_pool_destroy(pool);
+  }
+}
+
+IREE_API_EXPORT void iree_hal_buffer_view_pool_trim(
+    iree_hal_buffer_view_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_buffer_view_t* free_head = pool->free_head;
+  pool->free_head = NULL;
+  pool->free_count = 0;
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  while (free_head) {
+    iree_hal_buffer_view_t* next_free = free_head->next_free;
+    iree_allocator_free(free_head->host_allocator, free_head);
+    free_head = next_free;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_buffer_view_pool_acquire(
+    iree_hal_buffer_view_pool_t* pool, iree_hal_buffer_t* buffer,
+    iree_host_size_t shape_rank, const iree_hal_dim_t* shape,
+    iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(buffer);
+  IREE_ASSERT_ARGUMENT(out_buffer_view);
+
+  // Shapes that don't fit inline are rare enough to not be worth pooling.
+  if (shape_rank > IREE_HAL_BUFFER_VIEW_POOL_INLINE_RANK) {
+    return iree_hal_buffer_view_create(buffer, shape_rank, shape, element_type,
+                                       encoding_type, pool->host_allocator,
+                                       out_buffer_view);
+  }
+
+  *out_buffer_view = NULL;
+  if (IREE_UNLIKELY(shape_rank > 0 && !shape)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "no shape dimensions specified");
+  }
+
+  iree_slim_mutex_lock(&pool->mutex);
+  iree_hal_buffer_view_t* buffer_view = pool->free_head;
+  if (buffer_view) {
+    pool->free_head = buffer_view->next_free;
+    --pool->free_count;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  if (!buffer_view) {
+    IREE_TRACE_ZONE_BEGIN(z0);
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_buffer_view_allocate(IREE_HAL_BUFFER_VIEW_POOL_INLINE_RANK,
+                                          pool->host_allocator, &buffer_view));
+    IREE_TRACE_ZONE_END(z0);
+  }
+
+  // Outstanding buffer views keep the pool alive so they can return to it.
+  iree_atomic_ref_count_init(&buffer_view->ref_count);
+  buffer_view->pool = pool;
+  iree_hal_buffer_view_pool_retain(pool);
+  buffer_view->next_free = NULL;
+  iree_hal_buffer_view_initialize(buffer_view, buffer, shape_rank, shape,
+                                  element_type, encoding_type);
+  *out_buffer_view = buffer_view;
+  return iree_ok_status();
+}
+
+// Returns the released |buffer_view| to the freelist of |pool| or frees it if
+// the freelist is full. Drops the reference the buffer view held on |pool|.
+static void iree_hal_buffer_view_pool_recycle(
+    iree_hal_buffer_view_pool_t* pool, iree_hal_buffer_view_t* buffer_view) {
+  bool recycled = false;
+  iree_slim_mutex_lock(&pool->mutex);
+  if (pool->free_count < pool->max_free_count) {
+    buffer_view->next_free = pool->free_head;
+    pool->free_head = buffer_view;
+    ++pool->free_count;
+    recycled = true;
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  if (!recycled) {
+    iree_allocator_free(buffer_view->host_allocator, buffer_view);
+  }
+  iree_hal_buffer_view_pool_release(pool);
+}
@@ -211,6 +211,20 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_create_like(
     iree_hal_buffer_t* buffer, iree_hal_buffer_view_t* like_view,
     iree_allocator_t host_allocator, iree_hal_buffer_view_t** out_buffer_view);
 
+// Reinitializes a caller-owned |buffer_view| in-place to reference |buffer|
+// with the given shape and types. This allows applications to reuse the same
+// buffer views across invocations instead of creating new ones each time.
+//
+// The caller must hold the only reference to |buffer_view| and |shape_rank|
+// must not exceed the rank the buffer view was created with (or
+// IREE_HAL_BUFFER_VIEW_POOL_INLINE_RANK for pooled buffer views). The
+// previously referenced buffer is released.
+IREE_API_EXPORT iree_status_t iree_hal_buffer_view_reset(
+    iree_hal_buffer_view_t* buffer_view, iree_hal_buffer_t* buffer,
+    iree_host_size_t shape_rank, const iree_hal_dim_t* shape,
+    iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type);
+
 // Retains the given |buffer_view| for the caller.
 IREE_API_EXPORT void iree_hal_buffer_view_retain(
     iree_hal_buffer_view_t* buffer_view);
@@ -297,6 +311,55 @@ IREE_API_EXPORT iree_status_t iree_hal_buffer_view_compute_range(
     const iree_hal_dim_t* lengths, iree_device_size_t* out_start_offset,
     iree_device_size_t* out_length);
 
+//===----------------------------------------------------------------------===//
+// iree_hal_buffer_view_pool_t
+//===----------------------------------------------------------------------===//
+
+// Maximum shape rank stored inline in pooled buffer views. Buffer views with
+// larger ranks are allocated from the host allocator as normal.
+#define IREE_HAL_BUFFER_VIEW_POOL_INLINE_RANK 8
+
+// A thread-safe freelist of buffer views.
+// Buffer views created from the pool return to it when their last reference
+// is released instead of being freed, avoiding a host allocation per view on
+// paths that create many short-lived views such as function inputs and
+// outputs. Each pooled view has storage for up to
+// IREE_HAL_BUFFER_VIEW_POOL_INLINE_RANK dimensions so views of any rank up to
+// that share the same freelist.
+//
+// Outstanding buffer views retain the pool and it is safe to release the pool
+// while they are still live.
+typedef struct iree_hal_buffer_view_pool_t iree_hal_buffer_view_pool_t;
+
+// Creates a buffer view pool retaining up to |max_free_count| released buffer
+// views for reuse.
+// |out_pool| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_hal_buffer_view_pool_create(
+    iree_host_size_t max_free_count, iree_allocator_t host_allocator,
+    iree_hal_buffer_view_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+IREE_API_EXPORT void iree_hal_buffer_view_pool_retain(
+    iree_hal_buffer_view_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+IREE_API_EXPORT void iree_hal_buffer_view_pool_release(
+    iree_hal_buffer_view_pool_t* pool);
+
+// Frees all buffer views currently in the freelist of |pool|.
+IREE_API_EXPORT void iree_hal_buffer_view_pool_trim(
+    iree_hal_buffer_view_pool_t* pool);
+
+// Creates a buffer view with the given |buffer| reusing a released buffer view
+// from |pool| if available. Behaves as iree_hal_buffer_view_create otherwise.
+// |out_buffer_view| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_hal_buffer_view_pool_acquire(
+    iree_hal_buffer_view_pool_t* pool, iree_hal_buffer_t* buffer,
+    iree_host_size_t shape_rank, const iree_hal_dim_t* shape,
+    iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type,
+    iree_hal_buffer_view_t** out_buffer_view);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_buffer_view_t implementation details
 //===----------------------------------------------------------------------===//
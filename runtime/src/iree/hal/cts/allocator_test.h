@@ -109,6 +109,67 @@ TEST_F(AllocatorTest, AllocateEmptyBuffer) {
   iree_hal_buffer_release(buffer);
 }
 
+// Queue-ordered allocations must not complete until their waits are satisfied
+// and buffers released after their dealloca must be usable by later allocas.
+TEST_F(AllocatorTest, QueueAllocaWithWait) {
+  iree_hal_buffer_params_t params = {0};
+  params.type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL;
+  params.usage = IREE_HAL_BUFFER_USAGE_TRANSFER;
+
+  iree_hal_semaphore_t* wait_semaphore = CreateSemaphore();
+  uint64_t wait_payload_values[] = {1};
+  iree_hal_semaphore_list_t wait_semaphores = {
+      1,
+      &wait_semaphore,
+      wait_payload_values,
+  };
+  iree_hal_semaphore_t* signal_semaphore = CreateSemaphore();
+  uint64_t signal_payload_values[] = {1};
+  iree_hal_semaphore_list_t signal_semaphores = {
+      1,
+      &signal_semaphore,
+      signal_payload_values,
+  };
+
+  // The buffer is returned immediately but the allocation is not signaled
+  // until the wait semaphore reaches its payload value.
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_semaphores, signal_semaphores,
+      IREE_HAL_ALLOCATOR_POOL_DEFAULT, params, kAllocationSize, &buffer));
+  ASSERT_NE(buffer, nullptr);
+  EXPECT_GE(iree_hal_buffer_allocation_size(buffer), kAllocationSize);
+  CheckSemaphoreValue(signal_semaphore, 0);
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(wait_semaphore, 1));
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(signal_semaphore, 1, iree_infinite_timeout()));
+
+  // Deallocate in queue order and then allocate again from the same queue.
+  wait_payload_values[0] = 1;
+  wait_semaphores.semaphores = &signal_semaphore;
+  signal_payload_values[0] = 2;
+  IREE_ASSERT_OK(iree_hal_device_queue_dealloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_semaphores, signal_semaphores,
+      buffer));
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(signal_semaphore, 2, iree_infinite_timeout()));
+  iree_hal_buffer_release(buffer);
+
+  wait_payload_values[0] = 2;
+  signal_payload_values[0] = 3;
+  buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_device_queue_alloca(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, wait_semaphores, signal_semaphores,
+      IREE_HAL_ALLOCATOR_POOL_DEFAULT, params, kAllocationSize, &buffer));
+  IREE_ASSERT_OK(
+      iree_hal_semaphore_wait(signal_semaphore, 3, iree_infinite_timeout()));
+  EXPECT_GE(iree_hal_buffer_allocation_size(buffer), kAllocationSize);
+  iree_hal_buffer_release(buffer);
+
+  iree_hal_semaphore_release(wait_semaphore);
+  iree_hal_semaphore_release(signal_semaphore);
+}
+
 }  // namespace iree::hal::cts
 
 #endif  // IREE_HAL_CTS_ALLOCATOR_TEST_H_
@@ -0,0 +1,349 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures the host-side cost of recording and submitting command buffers on
+// any registered HAL driver. Select the driver with --device= and run once per
+// driver of interest to compare:
+//   iree-hal-command-buffer-benchmark --device=local-task
+//   iree-hal-command-buffer-benchmark --device=cuda
+//
+// Dispatch benchmarks are only registered when an executable is provided as
+// the binding count of each dispatch must match the executable layout:
+//   --executable_format=embedded-elf-x86_64
+//   --executable_file=command_buffer_dispatch_test.so
+//   --binding_count=2
+// Recording cost as a function of binding count can be compared by running
+// with executables declaring different numbers of bindings.
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/internal/flags.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/init.h"
+#include "iree/testing/benchmark.h"
+#include "iree/tooling/device_util.h"
+
+IREE_FLAG(string, executable_format, "",
+          "Format of the executable file being loaded.");
+IREE_FLAG(string, executable_file, "",
+          "Path to the executable file to dispatch. Dispatch benchmarks are\n"
+          "skipped if omitted.");
+IREE_FLAG(int32_t, entry_point, 0, "Entry point ordinal to dispatch.");
+IREE_FLAG(int32_t, binding_count, 2,
+          "Number of bindings declared by the executable entry point.");
+IREE_FLAG(int32_t, buffer_size, 4096, "Size in bytes of each bound buffer.");
+
+// Maximum number of unique buffers bound across all dispatches.
+#define IREE_HAL_BENCHMARK_MAX_BUFFER_COUNT 256
+
+// Maximum number of bindings per dispatch.
+#define IREE_HAL_BENCHMARK_MAX_BINDING_COUNT 64
+
+// Shared state created once in main and used by all benchmarks.
+static struct {
+  iree_hal_device_t* device;
+  iree_hal_executable_t* executable;
+  iree_hal_buffer_t* buffers[IREE_HAL_BENCHMARK_MAX_BUFFER_COUNT];
+} benchmark_globals;
+
+// Parameters of a benchmark instance passed as user_data.
+typedef struct iree_hal_command_buffer_benchmark_params_t {
+  // Number of commands recorded into each command buffer.
+  uint32_t command_count;
+  // Number of unique buffers rotated through bindings. Larger counts stress
+  // resource tracking as fewer lookups hit the recently used caches.
+  uint32_t buffer_count;
+  // Whether each command buffer is submitted and waited on after recording.
+  bool submit;
+} iree_hal_command_buffer_benchmark_params_t;
+
+static const iree_hal_command_buffer_benchmark_params_t
+    iree_hal_command_buffer_benchmark_params[] = {
+        {1, 1, false},      //
+        {16, 1, false},     //
+        {16, 16, false},    //
+        {256, 1, false},    //
+        {256, 256, false},  //
+        {1, 1, true},       //
+        {16, 16, true},     //
+        {256, 256, true},   //
+};
+
+static iree_status_t iree_hal_command_buffer_benchmark_submit(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_semaphore_t* semaphore, uint64_t* semaphore_value) {
+  const uint64_t signal_value = ++(*semaphore_value);
+  iree_hal_semaphore_list_t signal_semaphores = {
+      .count = 1,
+      .semaphores = &semaphore,
+      .payload_values = (uint64_t*)&signal_value,
+  };
+  IREE_RETURN_IF_ERROR(iree_hal_device_queue_execute(
+      benchmark_globals.device, IREE_HAL_QUEUE_AFFINITY_ANY,
+      iree_hal_semaphore_list_empty(), signal_semaphores, command_buffer,
+      iree_hal_buffer_binding_table_empty()));
+  return iree_hal_semaphore_wait(semaphore, signal_value,
+                                 iree_infinite_timeout());
+}
+
+// Records a full barrier as emitted by the compiler between dependent
+// dispatches.
+static iree_status_t iree_hal_command_buffer_benchmark_barrier(
+    iree_hal_command_buffer_t* command_buffer) {
+  return iree_hal_command_buffer_execution_barrier(
+      command_buffer,
+      IREE_HAL_EXECUTION_STAGE_DISPATCH | IREE_HAL_EXECUTION_STAGE_TRANSFER |
+          IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE |
+          IREE_HAL_EXECUTION_STAGE_DISPATCH | IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL);
+}
+
+// Records |params->command_count| fills each followed by a barrier.
+static iree_status_t iree_hal_command_buffer_benchmark_record_fills(
+    const iree_hal_command_buffer_benchmark_params_t* params,
+    iree_hal_command_buffer_t* command_buffer) {
+  const uint32_t pattern = 0xCDCDCDCDu;
+  for (uint32_t i = 0; i < params->command_count; ++i) {
+    iree_hal_buffer_t* buffer =
+        benchmark_globals.buffers[i % params->buffer_count];
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_fill_buffer(
+        command_buffer,
+        iree_hal_make_buffer_ref(buffer, 0, FLAG_buffer_size), &pattern,
+        sizeof(pattern), IREE_HAL_FILL_FLAG_NONE));
+    IREE_RETURN_IF_ERROR(
+        iree_hal_command_buffer_benchmark_barrier(command_buffer));
+  }
+  return iree_ok_status();
+}
+
+// Records |params->command_count| dispatches each followed by a barrier.
+static iree_status_t iree_hal_command_buffer_benchmark_record_dispatches(
+    const iree_hal_command_buffer_benchmark_params_t* params,
+    iree_hal_command_buffer_t* command_buffer) {
+  iree_hal_buffer_ref_t binding_refs[IREE_HAL_BENCHMARK_MAX_BINDING_COUNT];
+  iree_hal_buffer_ref_list_t bindings = {
+      .count = (iree_host_size_t)FLAG_binding_count,
+      .values = binding_refs,
+  };
+  const uint32_t workgroup_count[3] = {1, 1, 1};
+  uint32_t buffer_ordinal = 0;
+  for (uint32_t i = 0; i < params->command_count; ++i) {
+    for (iree_host_size_t j = 0; j < bindings.count; ++j) {
+      binding_refs[j] = iree_hal_make_buffer_ref(
+          benchmark_globals.buffers[buffer_ordinal++ % params->buffer_count], 0,
+          FLAG_buffer_size);
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_dispatch(
+        command_buffer, benchmark_globals.executable, FLAG_entry_point,
+        workgroup_count, iree_const_byte_span_empty(), bindings,
+        IREE_HAL_DISPATCH_FLAG_NONE));
+    IREE_RETURN_IF_ERROR(
+        iree_hal_command_buffer_benchmark_barrier(command_buffer));
+  }
+  return iree_ok_status();
+}
+
+typedef iree_status_t (*iree_hal_command_buffer_benchmark_record_fn_t)(
+    const iree_hal_command_buffer_benchmark_params_t* params,
+    iree_hal_command_buffer_t* command_buffer);
+
+// Measures create/begin/record/end/release (and optionally submit and wait)
+// of one-shot command buffers.
+static iree_status_t iree_hal_command_buffer_benchmark_run(
+    iree_benchmark_state_t* benchmark_state,
+    const iree_hal_command_buffer_benchmark_params_t* params,
+    iree_hal_command_category_t categories,
+    iree_hal_command_buffer_benchmark_record_fn_t record_fn) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  uint64_t semaphore_value = 0ull;
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_create(
+      benchmark_globals.device, semaphore_value, IREE_HAL_SEMAPHORE_FLAG_NONE,
+      &semaphore));
+
+  int64_t iteration_count = 0;
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    ++iteration_count;
+    iree_hal_command_buffer_t* command_buffer = NULL;
+    status = iree_hal_command_buffer_create(
+        benchmark_globals.device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        categories, IREE_HAL_QUEUE_AFFINITY_ANY, /*binding_capacity=*/0,
+        &command_buffer);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_begin(command_buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      status = record_fn(params, command_buffer);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_command_buffer_end(command_buffer);
+    }
+    if (iree_status_is_ok(status) && params->submit) {
+      status = iree_hal_command_buffer_benchmark_submit(
+          command_buffer, semaphore, &semaphore_value);
+    }
+    iree_hal_command_buffer_release(command_buffer);
+  }
+  iree_benchmark_set_items_processed(benchmark_state,
+                                     iteration_count * params->command_count);
+
+  iree_hal_semaphore_release(semaphore);
+  return status;
+}
+
+static iree_status_t iree_hal_command_buffer_benchmark_fill(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  return iree_hal_command_buffer_benchmark_run(
+      benchmark_state,
+      (const iree_hal_command_buffer_benchmark_params_t*)
+          benchmark_def->user_data,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER,
+      iree_hal_command_buffer_benchmark_record_fills);
+}
+
+static iree_status_t iree_hal_command_buffer_benchmark_dispatch(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  return iree_hal_command_buffer_benchmark_run(
+      benchmark_state,
+      (const iree_hal_command_buffer_benchmark_params_t*)
+          benchmark_def->user_data,
+      IREE_HAL_COMMAND_CATEGORY_DISPATCH,
+      iree_hal_command_buffer_benchmark_record_dispatches);
+}
+
+static iree_status_t iree_hal_command_buffer_benchmark_load_executable(
+    iree_allocator_t host_allocator) {
+  iree_file_contents_t* file_contents = NULL;
+  IREE_RETURN_IF_ERROR(iree_file_read_contents(FLAG_executable_file,
+                                               IREE_FILE_READ_FLAG_DEFAULT,
+                                               host_allocator, &file_contents));
+
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  iree_status_t status = iree_hal_executable_cache_create(
+      benchmark_globals.device, iree_make_cstring_view("default"),
+      iree_loop_inline(NULL), &executable_cache);
+  if (iree_status_is_ok(status)) {
+    iree_hal_executable_params_t executable_params;
+    iree_hal_executable_params_initialize(&executable_params);
+    executable_params.caching_mode =
+        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+    executable_params.executable_format =
+        iree_make_cstring_view(FLAG_executable_format);
+    executable_params.executable_data = file_contents->const_buffer;
+    status = iree_hal_executable_cache_prepare_executable(
+        executable_cache, &executable_params, &benchmark_globals.executable);
+  }
+
+  iree_hal_executable_cache_release(executable_cache);
+  iree_file_contents_free(file_contents);
+  return status;
+}
+
+static iree_status_t iree_hal_command_buffer_benchmark_initialize(
+    iree_allocator_t host_allocator) {
+  IREE_RETURN_IF_ERROR(iree_hal_register_all_available_drivers(
+      iree_hal_driver_registry_default()));
+  IREE_RETURN_IF_ERROR(iree_hal_create_device_from_flags(
+      iree_hal_driver_registry_default(), iree_make_cstring_view("local-task"),
+      host_allocator, &benchmark_globals.device));
+
+  iree_hal_buffer_params_t buffer_params = {
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+               IREE_HAL_BUFFER_USAGE_TRANSFER,
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(benchmark_globals.buffers);
+       ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(benchmark_globals.device), buffer_params,
+        FLAG_buffer_size, &benchmark_globals.buffers[i]));
+  }
+
+  if (strlen(FLAG_executable_file) > 0) {
+    if (FLAG_binding_count < 0 ||
+        FLAG_binding_count > IREE_HAL_BENCHMARK_MAX_BINDING_COUNT) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "binding count %d out of range [0, %d]",
+                              FLAG_binding_count,
+                              IREE_HAL_BENCHMARK_MAX_BINDING_COUNT);
+    }
+    IREE_RETURN_IF_ERROR(
+        iree_hal_command_buffer_benchmark_load_executable(host_allocator));
+  }
+
+  return iree_ok_status();
+}
+
+static void iree_hal_command_buffer_benchmark_deinitialize(void) {
+  iree_hal_executable_release(benchmark_globals.executable);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(benchmark_globals.buffers);
+       ++i) {
+    iree_hal_buffer_release(benchmark_globals.buffers[i]);
+  }
+  iree_hal_device_release(benchmark_globals.device);
+}
+
+static void iree_hal_command_buffer_benchmark_register(
+    const char* prefix, iree_benchmark_fn_t run) {
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(iree_hal_command_buffer_benchmark_params); ++i) {
+    const iree_hal_command_buffer_benchmark_params_t* params =
+        &iree_hal_command_buffer_benchmark_params[i];
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_MICROSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = run,
+        .user_data = params,
+    };
+    char name[64];
+    snprintf(name, sizeof(name), "%s_%s_%u_buffers_%u", prefix,
+             params->submit ? "submit" : "record", params->command_count,
+             params->buffer_count);
+    iree_benchmark_register(iree_make_cstring_view(name), &benchmark_def);
+  }
+}
+
+int main(int argc, char** argv) {
+  iree_flags_set_usage(
+      "iree-hal-command-buffer-benchmark",
+      "Benchmarks host-side command buffer recording and submission.\n"
+      "\n"
+      "Example for local-task with the CTS dispatch executable:\n"
+      "  --device=local-task\n"
+      "  --executable_format=embedded-elf-x86_64\n"
+      "  --executable_file=command_buffer_dispatch_test.so\n"
+      "  --binding_count=2\n"
+      "\n");
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_UNDEFINED_OK, &argc, &argv);
+  iree_benchmark_initialize(&argc, argv);
+
+  iree_allocator_t host_allocator = iree_allocator_system();
+  IREE_CHECK_OK(iree_hal_command_buffer_benchmark_initialize(host_allocator));
+
+  iree_hal_command_buffer_benchmark_register(
+      "fill", iree_hal_command_buffer_benchmark_fill);
+  if (benchmark_globals.executable) {
+    iree_hal_command_buffer_benchmark_register(
+        "dispatch", iree_hal_command_buffer_benchmark_dispatch);
+  }
+
+  iree_benchmark_run_specified();
+
+  iree_hal_command_buffer_benchmark_deinitialize();
+  return 0;
+}
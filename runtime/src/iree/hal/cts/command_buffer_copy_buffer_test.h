@@ -273,6 +273,195 @@ TEST_F(CommandBufferCopyBufferTest, CopySubBufferIndirect) {
   iree_hal_buffer_release(host_buffer);
 }
 
+// Tests that a reusable indirect command buffer can be submitted multiple times
+// with different binding tables, including ones where slots alias each other.
+TEST_F(CommandBufferCopyBufferTest, CopyReusableIndirect) {
+  const int kSourceBufferSlot = 0;
+  const int kTargetBufferSlot = 1;
+  const int kBindingSlotCount = 2;
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_DEFAULT,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, IREE_HAL_QUEUE_AFFINITY_ANY,
+      kBindingSlotCount, &command_buffer));
+
+  // Fill the first half of the source and after a barrier copy the first half
+  // of the target to its second half. The commands only have a hazard if the
+  // slots are bound to the same buffer.
+  const iree_device_size_t half_size = kDefaultAllocationSize / 2;
+  const uint8_t fill_val = 0x5A;
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer,
+      iree_hal_make_indirect_buffer_ref(kSourceBufferSlot, 0, half_size),
+      &fill_val, sizeof(fill_val), IREE_HAL_FILL_FLAG_NONE));
+  IREE_ASSERT_OK(iree_hal_command_buffer_execution_barrier(
+      command_buffer,
+      /*source_stage_mask=*/IREE_HAL_EXECUTION_STAGE_TRANSFER |
+          IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      /*target_stage_mask=*/IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE |
+          IREE_HAL_EXECUTION_STAGE_TRANSFER,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, /*memory_barrier_count=*/0,
+      /*memory_barriers=*/NULL,
+      /*buffer_barrier_count=*/0, /*buffer_barriers=*/NULL));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer,
+      iree_hal_make_indirect_buffer_ref(kTargetBufferSlot, 0, half_size),
+      iree_hal_make_indirect_buffer_ref(kTargetBufferSlot, half_size,
+                                        half_size),
+      IREE_HAL_COPY_FLAG_NONE));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  std::vector<uint8_t> source_reference(kDefaultAllocationSize, 0);
+  std::memset(source_reference.data(), fill_val, half_size);
+  std::vector<uint8_t> target_reference(kDefaultAllocationSize, 0);
+
+  // Submit with distinct buffers for each slot a few times.
+  for (int i = 0; i < 3; ++i) {
+    iree_hal_buffer_t* source_buffer = NULL;
+    CreateZeroedDeviceBuffer(kDefaultAllocationSize, &source_buffer);
+    iree_hal_buffer_t* target_buffer = NULL;
+    CreateZeroedDeviceBuffer(kDefaultAllocationSize, &target_buffer);
+    const iree_hal_buffer_binding_t bindings[] = {
+        /*kSourceBufferSlot=*/{source_buffer, 0, IREE_WHOLE_BUFFER},
+        /*kTargetBufferSlot=*/{target_buffer, 0, IREE_WHOLE_BUFFER},
+    };
+    IREE_ASSERT_OK(SubmitCommandBufferAndWait(
+        command_buffer,
+        iree_hal_buffer_binding_table_t{IREE_ARRAYSIZE(bindings), bindings}));
+    std::vector<uint8_t> source_data(kDefaultAllocationSize);
+    IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+        device_, source_buffer, /*source_offset=*/0,
+        /*target_buffer=*/source_data.data(),
+        /*data_length=*/kDefaultAllocationSize,
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    EXPECT_THAT(source_data, ContainerEq(source_reference));
+    std::vector<uint8_t> target_data(kDefaultAllocationSize);
+    IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+        device_, target_buffer, /*source_offset=*/0,
+        /*target_buffer=*/target_data.data(),
+        /*data_length=*/kDefaultAllocationSize,
+        IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+    EXPECT_THAT(target_data, ContainerEq(target_reference));
+    iree_hal_buffer_release(target_buffer);
+    iree_hal_buffer_release(source_buffer);
+  }
+
+  // Submit with both slots bound to the same buffer; the copy must now observe
+  // the results of the fill.
+  iree_hal_buffer_t* shared_buffer = NULL;
+  CreateZeroedDeviceBuffer(kDefaultAllocationSize, &shared_buffer);
+  const iree_hal_buffer_binding_t shared_bindings[] = {
+      /*kSourceBufferSlot=*/{shared_buffer, 0, IREE_WHOLE_BUFFER},
+      /*kTargetBufferSlot=*/{shared_buffer, 0, IREE_WHOLE_BUFFER},
+  };
+  IREE_ASSERT_OK(SubmitCommandBufferAndWait(
+      command_buffer, iree_hal_buffer_binding_table_t{
+                          IREE_ARRAYSIZE(shared_bindings), shared_bindings}));
+  std::vector<uint8_t> shared_data(kDefaultAllocationSize);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, shared_buffer, /*source_offset=*/0,
+      /*target_buffer=*/shared_data.data(),
+      /*data_length=*/kDefaultAllocationSize,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_THAT(shared_data,
+              ContainerEq(std::vector<uint8_t>(kDefaultAllocationSize,
+                                               fill_val)));
+
+  // Must release the command buffer before resources used by it.
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(shared_buffer);
+}
+
+// Tests that commands separated by barriers observe each other's results when
+// they have read-after-write, write-after-read, and write-after-write hazards.
+// Implementations that track hazards to relax barriers must still order these.
+TEST_F(CommandBufferCopyBufferTest, CopyChainWithBarriers) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_command_buffer_create(
+      device_, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+      IREE_HAL_COMMAND_CATEGORY_TRANSFER, IREE_HAL_QUEUE_AFFINITY_ANY,
+      /*binding_capacity=*/0, &command_buffer));
+
+  iree_hal_buffer_params_t device_params = {0};
+  device_params.type =
+      IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE;
+  device_params.usage = IREE_HAL_BUFFER_USAGE_DISPATCH_STORAGE |
+                        IREE_HAL_BUFFER_USAGE_TRANSFER |
+                        IREE_HAL_BUFFER_USAGE_MAPPING;
+  iree_hal_buffer_t* source_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_, device_params, kDefaultAllocationSize,
+      &source_buffer));
+  iree_hal_buffer_t* target_buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+      device_allocator_, device_params, kDefaultAllocationSize,
+      &target_buffer));
+
+  const iree_device_size_t half_size = kDefaultAllocationSize / 2;
+  const iree_device_size_t quarter_size = kDefaultAllocationSize / 4;
+  const uint8_t first_val = 0x11;
+  const uint8_t second_val = 0x22;
+  auto barrier = [&]() {
+    return iree_hal_command_buffer_execution_barrier(
+        command_buffer,
+        /*source_stage_mask=*/IREE_HAL_EXECUTION_STAGE_TRANSFER |
+            IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+        /*target_stage_mask=*/IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE |
+            IREE_HAL_EXECUTION_STAGE_TRANSFER,
+        IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, /*memory_barrier_count=*/0,
+        /*memory_barriers=*/NULL,
+        /*buffer_barrier_count=*/0, /*buffer_barriers=*/NULL);
+  };
+
+  IREE_ASSERT_OK(iree_hal_command_buffer_begin(command_buffer));
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer,
+      iree_hal_make_buffer_ref(source_buffer, 0, kDefaultAllocationSize),
+      &first_val, sizeof(first_val), IREE_HAL_FILL_FLAG_NONE));
+  IREE_ASSERT_OK(barrier());
+  // RAW on source_buffer: both halves must observe the first fill.
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, iree_hal_make_buffer_ref(source_buffer, 0, half_size),
+      iree_hal_make_buffer_ref(target_buffer, 0, half_size),
+      IREE_HAL_COPY_FLAG_NONE));
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer,
+      iree_hal_make_buffer_ref(source_buffer, half_size, half_size),
+      iree_hal_make_buffer_ref(target_buffer, half_size, half_size),
+      IREE_HAL_COPY_FLAG_NONE));
+  IREE_ASSERT_OK(barrier());
+  // WAR on source_buffer: must not clobber the source of the copies above.
+  IREE_ASSERT_OK(iree_hal_command_buffer_fill_buffer(
+      command_buffer,
+      iree_hal_make_buffer_ref(source_buffer, 0, kDefaultAllocationSize),
+      &second_val, sizeof(second_val), IREE_HAL_FILL_FLAG_NONE));
+  IREE_ASSERT_OK(barrier());
+  // RAW on source_buffer and WAW on target_buffer.
+  IREE_ASSERT_OK(iree_hal_command_buffer_copy_buffer(
+      command_buffer, iree_hal_make_buffer_ref(source_buffer, 0, quarter_size),
+      iree_hal_make_buffer_ref(target_buffer, 0, quarter_size),
+      IREE_HAL_COPY_FLAG_NONE));
+  IREE_ASSERT_OK(iree_hal_command_buffer_end(command_buffer));
+
+  IREE_ASSERT_OK(SubmitCommandBufferAndWait(command_buffer));
+
+  std::vector<uint8_t> reference_buffer(kDefaultAllocationSize, first_val);
+  std::memset(reference_buffer.data(), second_val, quarter_size);
+  std::vector<uint8_t> actual_data(kDefaultAllocationSize);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, target_buffer, /*source_offset=*/0,
+      /*target_buffer=*/actual_data.data(),
+      /*data_length=*/kDefaultAllocationSize,
+      IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT, iree_infinite_timeout()));
+  EXPECT_THAT(actual_data, ContainerEq(reference_buffer));
+
+  // Must release the command buffer before resources used by it.
+  iree_hal_command_buffer_release(command_buffer);
+  iree_hal_buffer_release(target_buffer);
+  iree_hal_buffer_release(source_buffer);
+}
+
 }  // namespace iree::hal::cts
 
 #endif  // IREE_HAL_CTS_COMMAND_BUFFER_COPY_BUFFER_TEST_H_
@@ -68,6 +68,48 @@ TEST_F(ExecutableCacheTest, PrepareExecutable) {
   IREE_ASSERT_OK(loop_status);
 }
 
+TEST_F(ExecutableCacheTest, PrepareExecutables) {
+  iree_status_t loop_status = iree_ok_status();
+  iree_hal_executable_cache_t* executable_cache = NULL;
+  IREE_ASSERT_OK(iree_hal_executable_cache_create(
+      device_, iree_make_cstring_view("default"),
+      iree_loop_inline(&loop_status), &executable_cache));
+
+  iree_hal_executable_params_t executable_params[2];
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(executable_params); ++i) {
+    iree_hal_executable_params_initialize(&executable_params[i]);
+    executable_params[i].caching_mode =
+        IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA;
+    executable_params[i].executable_format =
+        iree_make_cstring_view(get_test_executable_format());
+    executable_params[i].executable_data = get_test_executable_data(
+        iree_make_cstring_view("executable_cache_test.bin"));
+  }
+
+  iree_hal_executable_t* executables[2] = {NULL, NULL};
+  IREE_ASSERT_OK(iree_hal_executable_cache_prepare_executables(
+      executable_cache, IREE_ARRAYSIZE(executable_params), executable_params,
+      executables));
+  EXPECT_NE(executables[0], nullptr);
+  EXPECT_NE(executables[1], nullptr);
+
+  iree_hal_executable_release(executables[0]);
+  iree_hal_executable_release(executables[1]);
+
+  // A failure in any executable fails the whole batch.
+  executable_params[1].executable_format = iree_make_cstring_view("FOO?");
+  iree_status_t status = iree_hal_executable_cache_prepare_executables(
+      executable_cache, IREE_ARRAYSIZE(executable_params), executable_params,
+      executables);
+  EXPECT_FALSE(iree_status_is_ok(status));
+  iree_status_ignore(status);
+  EXPECT_EQ(executables[0], nullptr);
+  EXPECT_EQ(executables[1], nullptr);
+
+  iree_hal_executable_cache_release(executable_cache);
+  IREE_ASSERT_OK(loop_status);
+}
+
 }  // namespace iree::hal::cts
 
 #endif  // IREE_HAL_CTS_EXECUTABLE_CACHE_TEST_H_
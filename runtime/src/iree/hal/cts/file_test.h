@@ -132,6 +132,73 @@ TEST_F(FileTest, ReadEntireFile) {
   iree_hal_file_release(file);
 }
 
+// Writes an entire buffer into a file and check the contents match.
+TEST_F(FileTest, WriteEntireFile) {
+  iree_device_size_t file_size = 128;
+  iree_hal_file_t* file = NULL;
+  CreatePatternedMemoryFile(
+      IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE, file_size,
+      0xDEu, &file);
+  iree_hal_buffer_t* buffer = NULL;
+  CreatePatternedDeviceBuffer(file_size, 0xCD, &buffer);
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_ASSERT_OK(iree_hal_semaphore_create(
+      device_, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &semaphore));
+  iree_hal_fence_t* wait_fence = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_create_at(
+      semaphore, 1ull, iree_allocator_system(), &wait_fence));
+  iree_hal_fence_t* signal_fence = NULL;
+  IREE_ASSERT_OK(iree_hal_fence_create_at(
+      semaphore, 2ull, iree_allocator_system(), &signal_fence));
+
+  // NOTE: synchronously executing here so start with the wait signaled.
+  // We should be able to make this async in the future.
+  IREE_ASSERT_OK(iree_hal_fence_signal(wait_fence));
+
+  IREE_ASSERT_OK(iree_hal_device_queue_write(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY,
+      iree_hal_fence_semaphore_list(wait_fence),
+      iree_hal_fence_semaphore_list(signal_fence), /*source_buffer=*/buffer,
+      /*source_offset=*/0, /*target_file=*/file, /*target_offset=*/0,
+      /*length=*/file_size, IREE_HAL_WRITE_FLAG_NONE));
+
+  IREE_ASSERT_OK(iree_hal_fence_wait(signal_fence, iree_infinite_timeout()));
+  iree_hal_fence_release(wait_fence);
+  iree_hal_fence_release(signal_fence);
+  iree_hal_semaphore_release(semaphore);
+
+  // Read the file back into a fresh buffer to check what was written.
+  iree_hal_buffer_t* readback_buffer = NULL;
+  CreatePatternedDeviceBuffer(file_size, 0x00, &readback_buffer);
+  IREE_ASSERT_OK(iree_hal_semaphore_create(
+      device_, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &semaphore));
+  IREE_ASSERT_OK(iree_hal_fence_create_at(
+      semaphore, 1ull, iree_allocator_system(), &signal_fence));
+  IREE_ASSERT_OK(iree_hal_device_queue_read(
+      device_, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+      iree_hal_fence_semaphore_list(signal_fence), /*source_file=*/file,
+      /*source_offset=*/0, /*target_buffer=*/readback_buffer,
+      /*target_offset=*/0, /*length=*/file_size, IREE_HAL_READ_FLAG_NONE));
+  IREE_ASSERT_OK(iree_hal_fence_wait(signal_fence, iree_infinite_timeout()));
+  iree_hal_fence_release(signal_fence);
+  iree_hal_semaphore_release(semaphore);
+
+  std::vector<uint8_t> reference_buffer(file_size);
+  memset(reference_buffer.data(), 0xCDu, file_size);
+  std::vector<uint8_t> actual_data(file_size);
+  IREE_ASSERT_OK(iree_hal_device_transfer_d2h(
+      device_, readback_buffer, /*source_offset=*/0,
+      /*target_buffer=*/actual_data.data(),
+      /*data_length=*/file_size, IREE_HAL_TRANSFER_BUFFER_FLAG_DEFAULT,
+      iree_infinite_timeout()));
+  EXPECT_THAT(actual_data, ContainerEq(reference_buffer));
+
+  iree_hal_buffer_release(readback_buffer);
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
 }  // namespace iree::hal::cts
 
 #endif  // IREE_HAL_CTS_FILE_TEST_H_
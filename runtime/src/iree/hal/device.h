@@ -259,9 +259,11 @@ iree_status_t iree_hal_device_trim(iree_hal_device_t* device);
 //   hal.device.feature :: some-pattern-*
 //   hal.device.architecture :: some-pattern-*
 //   hal.executable.format :: some-pattern-*
+//   hal.device.memory :: free|total (optional; device memory in bytes)
 //
 // Returned values must remain the same for the lifetime of the device as
-// callers may cache them to avoid redundant calls.
+// callers may cache them to avoid redundant calls. The exception is
+// `hal.device.memory :: free` which is sampled on each query.
 IREE_API_EXPORT iree_status_t iree_hal_device_query_i64(
     iree_hal_device_t* device, iree_string_view_t category,
     iree_string_view_t key, int64_t* out_value);
@@ -59,7 +59,9 @@ typedef struct iree_hal_cuda_memory_pooling_params_t {
 typedef struct iree_hal_cuda_device_params_t {
   // Number of queues exposed on the device.
   // Each queue acts as a separate synchronization scope where all work executes
-  // concurrently unless prohibited by semaphores.
+  // concurrently unless prohibited by semaphores. Every queue is backed by its
+  // own CUstream and queue affinity bits are mapped onto the queues modulo the
+  // queue count. At most 64 queues are supported.
   iree_host_size_t queue_count;
 
   // Total size of each block in the device shared block pool.
@@ -86,18 +88,99 @@ typedef struct iree_hal_cuda_device_params_t {
   // from there; be wary of whole-program tracing with this enabled.
   int32_t stream_tracing;
 
+  // Aggregates the GPU execution time of each dispatch by executable export
+  // name for querying with iree_hal_cuda_device_query_dispatch_statistics.
+  // Unlike stream_tracing this is available in builds without IREE tracing and
+  // is intended for production monitoring. Timing uses the same events as
+  // tracing and has similar overheads. Dispatches recorded into graph command
+  // buffers are only timed in builds with IREE device tracing enabled so
+  // IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM should be used.
+  // As with stream_tracing only work issued on the first queue is timed.
+  bool dispatch_statistics;
+
   // Whether to use async allocations even if reported as available by the
   // device. Defaults to true when the device supports it.
   bool async_allocations;
 
   // Parameters for each CUmemoryPool used for queue-ordered allocations.
   iree_hal_cuda_memory_pooling_params_t memory_pools;
+
+  // Maximum size in bytes of the staging buffer used to fuse contiguous small
+  // all-reduce operations on NCCL channels into a single operation. Each
+  // channel lazily allocates one staging buffer of this size on first use.
+  // 0 disables bucketing. Must match on all participants of a channel.
+  iree_device_size_t collective_bucket_size;
 } iree_hal_cuda_device_params_t;
 
 // Initializes |out_params| to default values.
 IREE_API_EXPORT void iree_hal_cuda_device_params_initialize(
     iree_hal_cuda_device_params_t* out_params);
 
+//===----------------------------------------------------------------------===//
+// iree_hal_cuda_device_t
+//===----------------------------------------------------------------------===//
+
+// Aggregated GPU execution time of all dispatches of an executable export.
+typedef struct iree_hal_cuda_dispatch_statistics_t {
+  // Name of the executable export. Valid for the lifetime of the device.
+  iree_string_view_t name;
+  // Total number of completed dispatches.
+  uint64_t count;
+  // Sum, minimum and maximum of the dispatch durations in nanoseconds.
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t max_ns;
+} iree_hal_cuda_dispatch_statistics_t;
+
+// Queries the dispatch statistics collected by |device| since creation or the
+// last reset. Requires the device to have been created with
+// iree_hal_cuda_device_params_t::dispatch_statistics. Up to |capacity|
+// entries are written to |out_statistics| and |out_count| receives the number
+// of unique exports. Returns RESOURCE_EXHAUSTED if |capacity| was too small.
+// |out_dropped_count| is optional and receives the number of dispatches that
+// were not timed because the internal event pool was exhausted.
+//
+// Only dispatches that have completed and been collected are included.
+IREE_API_EXPORT iree_status_t iree_hal_cuda_device_query_dispatch_statistics(
+    iree_hal_device_t* device, iree_host_size_t capacity,
+    iree_hal_cuda_dispatch_statistics_t* out_statistics,
+    iree_host_size_t* out_count, uint64_t* out_dropped_count);
+
+// Resets the dispatch statistics collected by |device|.
+IREE_API_EXPORT iree_status_t
+iree_hal_cuda_device_reset_dispatch_statistics(iree_hal_device_t* device);
+
+// EXPERIMENTAL: allocates a device-local buffer on |device| that reserves
+// |reserved_size| bytes of virtual address space and commits physical memory
+// for only the first |committed_size| bytes. The buffer spans the entire
+// reserved range and its device address never changes but accessing beyond the
+// committed range is undefined. Grow the committed range with
+// iree_hal_cuda_device_queue_grow_buffer. Useful for buffers with a large
+// upper bound but a typically small actual size (such as KV caches).
+//
+// This will be replaced by HAL buffer reserve/commit APIs.
+IREE_API_EXPORT iree_status_t iree_hal_cuda_device_allocate_growable_buffer(
+    iree_hal_device_t* device, iree_hal_buffer_params_t params,
+    iree_device_size_t reserved_size, iree_device_size_t committed_size,
+    iree_hal_buffer_t** out_buffer);
+
+// EXPERIMENTAL: commits physical memory such that at least the first
+// |minimum_committed_size| bytes of the growable |buffer| may be accessed by
+// work ordered after |signal_semaphore_list| is signaled. The contents of the
+// already committed range are unchanged and may be in use by in-flight work.
+// Physical memory is committed before returning and never decommitted until
+// the buffer is destroyed.
+IREE_API_EXPORT iree_status_t iree_hal_cuda_device_queue_grow_buffer(
+    iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer, iree_device_size_t minimum_committed_size);
+
+// EXPERIMENTAL: returns the number of bytes of the growable |buffer| that are
+// backed by physical memory or 0 if the buffer is not growable.
+IREE_API_EXPORT iree_device_size_t
+iree_hal_cuda_buffer_committed_size(iree_hal_buffer_t* buffer);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_cuda_driver_t
 //===----------------------------------------------------------------------===//
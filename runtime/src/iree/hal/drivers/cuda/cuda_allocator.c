@@ -25,6 +25,9 @@ typedef struct iree_hal_cuda_allocator_t {
   // The device that this allocator allocates memory from.
   CUdevice device;
 
+  // The context of |device| used to enable peer access to imported memory.
+  CUcontext context;
+
   // The CUDA stream that allocations should be used in.
   CUstream stream;
 
@@ -43,6 +46,11 @@ typedef struct iree_hal_cuda_allocator_t {
   // Whether host memory can be registered with CU_MEMHOSTREGISTER_READ_ONLY.
   bool supports_read_only_host_register;
 
+  // Whether the device is integrated and shares physical memory with the host
+  // (such as Jetson). Page-locked host memory is then as local to the device as
+  // any other allocation and we can avoid staging copies entirely.
+  bool is_integrated;
+
   IREE_STATISTICS(iree_hal_allocator_statistics_t statistics;)
 } iree_hal_cuda_allocator_t;
 
@@ -56,7 +64,7 @@ static iree_hal_cuda_allocator_t* iree_hal_cuda_allocator_cast(
 
 iree_status_t iree_hal_cuda_allocator_create(
     const iree_hal_cuda_dynamic_symbols_t* cuda_symbols, CUdevice device,
-    CUstream stream, iree_hal_cuda_memory_pools_t* pools,
+    CUcontext context, CUstream stream, iree_hal_cuda_memory_pools_t* pools,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator) {
   IREE_ASSERT_ARGUMENT(cuda_symbols);
   IREE_ASSERT_ARGUMENT(out_allocator);
@@ -97,6 +105,18 @@ iree_status_t iree_hal_cuda_allocator_create(
                                       ? "has READ_ONLY_HOST_REGISTER_SUPPORTED"
                                       : "no READ_ONLY_HOST_REGISTER_SUPPORTED");
 
+  // Integrated devices share memory with the host and we can expose
+  // device-local + host-visible memory backed by page-locked host memory.
+  int is_integrated = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, IREE_CURESULT_TO_STATUS(
+              cuda_symbols,
+              cuDeviceGetAttribute(&is_integrated,
+                                   CU_DEVICE_ATTRIBUTE_INTEGRATED, device),
+              "cuDeviceGetAttribute"));
+  IREE_TRACE_ZONE_APPEND_TEXT(
+      z0, is_integrated ? "INTEGRATED (unified memory)" : "discrete");
+
   iree_hal_cuda_allocator_t* allocator = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_allocator_malloc(host_allocator, sizeof(*allocator),
@@ -105,6 +125,7 @@ iree_status_t iree_hal_cuda_allocator_create(
   iree_hal_resource_initialize(&iree_hal_cuda_allocator_vtable,
                                &allocator->resource);
   allocator->device = device;
+  allocator->context = context;
   allocator->stream = stream;
   allocator->pools = pools;
   allocator->symbols = cuda_symbols;
@@ -113,6 +134,7 @@ iree_status_t iree_hal_cuda_allocator_create(
       supports_concurrent_managed_access != 0;
   allocator->supports_read_only_host_register =
       supports_read_only_host_register != 0;
+  allocator->is_integrated = is_integrated != 0;
   *out_allocator = (iree_hal_allocator_t*)allocator;
 
   IREE_TRACE_ZONE_END(z0);
@@ -157,6 +179,18 @@ static void iree_hal_cuda_allocator_query_statistics(
   });
 }
 
+static void iree_hal_cuda_allocator_reset_capture_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  IREE_STATISTICS({
+    iree_hal_cuda_allocator_t* allocator =
+        iree_hal_cuda_allocator_cast(base_allocator);
+    iree_hal_allocator_statistics_reset_capture(&allocator->statistics);
+    if (allocator->pools) {
+      iree_hal_cuda_memory_pools_reset_capture_statistics(allocator->pools);
+    }
+  });
+}
+
 static iree_status_t iree_hal_cuda_allocator_query_memory_heaps(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_host_size_t capacity,
@@ -169,10 +203,12 @@ static iree_status_t iree_hal_cuda_allocator_query_memory_heaps(
   iree_hal_cuda_allocator_t* allocator =
       iree_hal_cuda_allocator_cast(base_allocator);
 
-  // TODO(benvanik): check CU_DEVICE_ATTRIBUTE_INTEGRATED and return a unified
-  // set of heaps (likely still a cached and uncached, at minimum).
+  // Integrated devices expose device-local | host-visible memory backed by
+  // page-locked host memory even without concurrent managed access.
+  const bool has_unified_heap = allocator->is_integrated ||
+                                allocator->supports_concurrent_managed_access;
   iree_host_size_t count = 3;
-  if (allocator->supports_concurrent_managed_access) {
+  if (has_unified_heap) {
     ++count;  // device-local | host-visible
   }
   if (out_count) *out_count = count;
@@ -198,8 +234,9 @@ static iree_status_t iree_hal_cuda_allocator_query_memory_heaps(
       .min_alignment = min_alignment,
   };
 
-  if (allocator->supports_concurrent_managed_access) {
-    // Device-local managed memory with host mapping support:
+  if (has_unified_heap) {
+    // Device-local managed (or on integrated devices page-locked) memory with
+    // host mapping support:
     heaps[i++] = (iree_hal_allocator_memory_heap_t){
         .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
                 IREE_HAL_MEMORY_TYPE_HOST_VISIBLE |
@@ -271,12 +308,14 @@ iree_hal_cuda_allocator_query_buffer_compatibility(
     }
   }
 
-  // If concurrent managed access is not supported then make device-local +
-  // host-visible allocations fall back to host-local + device-visible
-  // page-locked memory. This will be significantly slower for the device to
-  // access but the compiler only uses this type for readback staging buffers
-  // and it's better to function than function fast.
+  // If concurrent managed access is not supported (and the device does not
+  // share memory with the host) then make device-local + host-visible
+  // allocations fall back to host-local + device-visible page-locked memory.
+  // This will be significantly slower for the device to access but the
+  // compiler only uses this type for readback staging buffers and it's better
+  // to function than function fast.
   if (!allocator->supports_concurrent_managed_access &&
+      !allocator->is_integrated &&
       iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL |
                                           IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
     compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_LOW_PERFORMANCE;
@@ -326,6 +365,14 @@ static void iree_hal_cuda_buffer_free(
       IREE_TRACE_ZONE_APPEND_TEXT(z0, "(ignored; external)");
       break;
     }
+    case IREE_HAL_CUDA_BUFFER_TYPE_PEER: {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "(ignored; peer)");
+      break;
+    }
+    case IREE_HAL_CUDA_BUFFER_TYPE_VIRTUAL: {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "(ignored; virtual)");
+      break;
+    }
   }
   IREE_TRACE_ZONE_END(z0);
 }
@@ -377,8 +424,24 @@ static iree_status_t iree_hal_cuda_allocator_allocate_buffer(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, allocation_size);
   if (iree_all_bits_set(compat_params.type,
                         IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
-    if (iree_all_bits_set(compat_params.type,
+    if (allocator->is_integrated &&
+        iree_all_bits_set(compat_params.type,
                           IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+      // Device local + host visible on integrated devices: page-locked host
+      // memory is device-local and avoids the managed memory migration
+      // machinery (which without concurrent managed access would require
+      // synchronizing the device for every host access).
+      buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_HOST;
+      status = IREE_CURESULT_TO_STATUS(
+          allocator->symbols, cuMemHostAlloc(&host_ptr, allocation_size,
+                                             CU_MEMHOSTALLOC_DEVICEMAP));
+      if (iree_status_is_ok(status)) {
+        status = IREE_CURESULT_TO_STATUS(
+            allocator->symbols,
+            cuMemHostGetDevicePointer(&device_ptr, host_ptr, /*flags=*/0));
+      }
+    } else if (iree_all_bits_set(compat_params.type,
+                                 IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
       // Device local + host visible.
       buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_DEVICE;
       status = IREE_CURESULT_TO_STATUS(
@@ -494,6 +557,83 @@ static void iree_hal_cuda_allocator_deallocate_buffer(
   iree_hal_buffer_destroy(base_buffer);
 }
 
+// Resolves the context owning the device allocation |device_ptr|. If the
+// allocation is owned by a peer device then peer access is enabled from the
+// allocator context and |out_peer_context| receives the owning context. It is
+// NULL if the allocation is local or its owner is unknown (such as memory
+// allocated from pools).
+//
+// Devices without peer access can only copy from and to peer allocations
+// (staged by the driver) and importing them for any other usage fails.
+static iree_status_t iree_hal_cuda_allocator_resolve_peer_context(
+    iree_hal_cuda_allocator_t* allocator, CUdeviceptr device_ptr,
+    iree_hal_buffer_usage_t usage, CUcontext* out_peer_context) {
+  *out_peer_context = NULL;
+
+  CUcontext owner_context = NULL;
+  IREE_CUDA_RETURN_IF_ERROR(
+      allocator->symbols,
+      cuPointerGetAttribute(&owner_context, CU_POINTER_ATTRIBUTE_CONTEXT,
+                            device_ptr),
+      "cuPointerGetAttribute");
+  if (!owner_context || owner_context == allocator->context) {
+    return iree_ok_status();
+  }
+
+  int owner_ordinal = 0;
+  IREE_CUDA_RETURN_IF_ERROR(
+      allocator->symbols,
+      cuPointerGetAttribute(&owner_ordinal,
+                            CU_POINTER_ATTRIBUTE_DEVICE_ORDINAL, device_ptr),
+      "cuPointerGetAttribute");
+  CUdevice owner_device = 0;
+  IREE_CUDA_RETURN_IF_ERROR(allocator->symbols,
+                            cuDeviceGet(&owner_device, owner_ordinal),
+                            "cuDeviceGet");
+  if (owner_device == allocator->device) {
+    // Another context on the same device; plain copies work with UVA.
+    return iree_ok_status();
+  }
+
+  int can_access_peer = 0;
+  IREE_CUDA_RETURN_IF_ERROR(
+      allocator->symbols,
+      cuDeviceCanAccessPeer(&can_access_peer, allocator->device, owner_device),
+      "cuDeviceCanAccessPeer");
+  if (!can_access_peer) {
+    if (iree_any_bit_set(usage, ~IREE_HAL_BUFFER_USAGE_TRANSFER)) {
+      return iree_make_status(
+          IREE_STATUS_UNAVAILABLE,
+          "device allocation is owned by device %d which is not accessible "
+          "as a peer; only transfer usage is supported",
+          owner_ordinal);
+    }
+    *out_peer_context = owner_context;
+    return iree_ok_status();
+  }
+
+  // Enabling peer access is one-way and persists for the lifetime of the
+  // contexts so it is fine if a prior import already enabled it.
+  IREE_CUDA_RETURN_IF_ERROR(allocator->symbols,
+                            cuCtxPushCurrent(allocator->context),
+                            "cuCtxPushCurrent");
+  CUresult result =
+      allocator->symbols->cuCtxEnablePeerAccess(owner_context, /*Flags=*/0);
+  CUcontext popped_context = NULL;
+  iree_status_t status = IREE_CURESULT_TO_STATUS(
+      allocator->symbols, cuCtxPopCurrent(&popped_context), "cuCtxPopCurrent");
+  if (result != CUDA_SUCCESS &&
+      result != CUDA_ERROR_PEER_ACCESS_ALREADY_ENABLED) {
+    status = iree_status_join(
+        status, iree_hal_cuda_result_to_status(allocator->symbols, result,
+                                               __FILE__, __LINE__));
+  }
+  if (iree_status_is_ok(status)) {
+    *out_peer_context = owner_context;
+  }
+  return status;
+}
+
 static iree_status_t iree_hal_cuda_allocator_import_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
@@ -540,10 +680,15 @@ static iree_status_t iree_hal_cuda_allocator_import_buffer(
   iree_hal_cuda_buffer_type_t buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_DEVICE;
   void* host_ptr = NULL;
   CUdeviceptr device_ptr = 0;
+  CUcontext peer_context = NULL;
 
   switch (external_buffer->type) {
     case IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION: {
-      if (iree_all_bits_set(compat_params.type,
+      // Registered host memory is only device-local when the device shares
+      // physical memory with the host. The registration pins the pages and
+      // maps them for the device without copying.
+      if (!allocator->is_integrated &&
+          iree_all_bits_set(compat_params.type,
                             IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
         return iree_make_status(
             IREE_STATUS_INVALID_ARGUMENT,
@@ -571,6 +716,9 @@ static iree_status_t iree_hal_cuda_allocator_import_buffer(
     case IREE_HAL_EXTERNAL_BUFFER_TYPE_DEVICE_ALLOCATION: {
       buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL;
       device_ptr = (CUdeviceptr)external_buffer->handle.device_allocation.ptr;
+      status = iree_hal_cuda_allocator_resolve_peer_context(
+          allocator, device_ptr, compat_params.usage, &peer_context);
+      if (peer_context) buffer_type = IREE_HAL_CUDA_BUFFER_TYPE_PEER;
       break;
     }
     case IREE_HAL_EXTERNAL_BUFFER_TYPE_OPAQUE_FD:
@@ -591,6 +739,9 @@ static iree_status_t iree_hal_cuda_allocator_import_buffer(
         host_ptr, release_callback,
         iree_hal_allocator_host_allocator(base_allocator), &buffer);
   }
+  if (iree_status_is_ok(status) && peer_context) {
+    iree_hal_cuda_buffer_set_peer_context(buffer, peer_context);
+  }
 
   if (iree_status_is_ok(status)) {
     *out_buffer = buffer;
@@ -618,6 +769,7 @@ static iree_status_t iree_hal_cuda_allocator_export_buffer(
       switch (buffer_type) {
         case IREE_HAL_CUDA_BUFFER_TYPE_DEVICE:
         case IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL:
+        case IREE_HAL_CUDA_BUFFER_TYPE_PEER:
           out_external_buffer->flags = requested_flags;
           out_external_buffer->type = requested_type;
           out_external_buffer->handle.device_allocation.ptr =
@@ -642,6 +794,7 @@ static const iree_hal_allocator_vtable_t iree_hal_cuda_allocator_vtable = {
     .host_allocator = iree_hal_cuda_allocator_host_allocator,
     .trim = iree_hal_cuda_allocator_trim,
     .query_statistics = iree_hal_cuda_allocator_query_statistics,
+    .reset_capture_statistics = iree_hal_cuda_allocator_reset_capture_statistics,
     .query_memory_heaps = iree_hal_cuda_allocator_query_memory_heaps,
     .query_buffer_compatibility =
         iree_hal_cuda_allocator_query_buffer_compatibility,
@@ -18,12 +18,14 @@ extern "C" {
 
 // Creates a CUDA memory allocator.
 // |device| and |stream| will be used for management operations.
+// |context| is the context of |device| and is used to enable peer access to
+// device allocations of other devices imported into the allocator.
 // |pools| provides memory pools that may be shared across multiple allocators
 // and the pointer must remain valid for the lifetime of the allocator. Pools
 // may not be supported on all devices and can be NULL.
 iree_status_t iree_hal_cuda_allocator_create(
     const iree_hal_cuda_dynamic_symbols_t* cuda_symbols, CUdevice device,
-    CUstream stream, iree_hal_cuda_memory_pools_t* pools,
+    CUcontext context, CUstream stream, iree_hal_cuda_memory_pools_t* pools,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
 
 #ifdef __cplusplus
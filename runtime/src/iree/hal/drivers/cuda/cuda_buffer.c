@@ -17,6 +17,8 @@ typedef struct iree_hal_cuda_buffer_t {
   iree_hal_cuda_buffer_type_t type;
   void* host_ptr;
   CUdeviceptr device_ptr;
+  // Context owning |device_ptr| when it is a peer allocation.
+  CUcontext peer_context;
   iree_hal_buffer_release_callback_t release_callback;
 } iree_hal_cuda_buffer_t;
 
@@ -63,6 +65,7 @@ iree_status_t iree_hal_cuda_buffer_wrap(
     buffer->type = buffer_type;
     buffer->host_ptr = host_ptr;
     buffer->device_ptr = device_ptr;
+    buffer->peer_context = NULL;
     buffer->release_callback = release_callback;
     *out_buffer = &buffer->base;
   }
@@ -159,6 +162,27 @@ void* iree_hal_cuda_buffer_host_pointer(const iree_hal_buffer_t* base_buffer) {
   return buffer->host_ptr;
 }
 
+CUcontext iree_hal_cuda_buffer_peer_context(
+    const iree_hal_buffer_t* base_buffer) {
+  const iree_hal_cuda_buffer_t* buffer =
+      iree_hal_cuda_buffer_const_cast(base_buffer);
+  return buffer->peer_context;
+}
+
+void iree_hal_cuda_buffer_set_peer_context(iree_hal_buffer_t* base_buffer,
+                                           CUcontext peer_context) {
+  iree_hal_cuda_buffer_t* buffer = iree_hal_cuda_buffer_cast(base_buffer);
+  IREE_ASSERT_EQ(buffer->type, IREE_HAL_CUDA_BUFFER_TYPE_PEER);
+  buffer->peer_context = peer_context;
+}
+
+void* iree_hal_cuda_buffer_release_user_data(
+    const iree_hal_buffer_t* base_buffer) {
+  const iree_hal_cuda_buffer_t* buffer =
+      iree_hal_cuda_buffer_const_cast(base_buffer);
+  return buffer->release_callback.user_data;
+}
+
 void iree_hal_cuda_buffer_drop_release_callback(
     iree_hal_buffer_t* base_buffer) {
   iree_hal_cuda_buffer_t* buffer = iree_hal_cuda_buffer_cast(base_buffer);
@@ -30,6 +30,13 @@ typedef enum iree_hal_cuda_buffer_type_e {
   // Externally registered buffer whose providence is unknown.
   // Must be freed by the user.
   IREE_HAL_CUDA_BUFFER_TYPE_EXTERNAL,
+  // Externally registered device allocation owned by the context of a peer
+  // device. Copies must use cuMemcpyPeerAsync. Must be freed by the user.
+  IREE_HAL_CUDA_BUFFER_TYPE_PEER,
+  // Device local buffer backed by a virtual address range reserved with
+  // cuMemAddressReserve into which physical memory is mapped on demand with
+  // cuMemCreate/cuMemMap. Released with cuMemUnmap/cuMemAddressFree.
+  IREE_HAL_CUDA_BUFFER_TYPE_VIRTUAL,
 } iree_hal_cuda_buffer_type_t;
 
 // Wraps a CUDA allocation in an iree_hal_buffer_t.
@@ -56,6 +63,20 @@ CUdeviceptr iree_hal_cuda_buffer_device_pointer(
 // Returns the CUDA host pointer for the given |buffer|, if available.
 void* iree_hal_cuda_buffer_host_pointer(const iree_hal_buffer_t* buffer);
 
+// Returns the context of the peer device owning the allocation of |buffer|
+// or NULL if the buffer is owned by the context of the allocating device.
+CUcontext iree_hal_cuda_buffer_peer_context(const iree_hal_buffer_t* buffer);
+
+// Sets the |peer_context| owning the allocation of the given |buffer|.
+// Only valid on IREE_HAL_CUDA_BUFFER_TYPE_PEER buffers prior to their use.
+void iree_hal_cuda_buffer_set_peer_context(iree_hal_buffer_t* buffer,
+                                           CUcontext peer_context);
+
+// Returns the user data of the release callback of |buffer|. Buffer types that
+// track additional state with their allocation (such as
+// IREE_HAL_CUDA_BUFFER_TYPE_VIRTUAL) store it here.
+void* iree_hal_cuda_buffer_release_user_data(const iree_hal_buffer_t* buffer);
+
 // Drops the release callback so that when the buffer is destroyed no callback
 // will be made. This is not thread safe but all callers are expected to be
 // holding an allocation and the earliest the buffer could be destroyed is after
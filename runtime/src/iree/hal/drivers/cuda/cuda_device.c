@@ -11,8 +11,10 @@
 #include <string.h>
 
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/event_pool.h"
 #include "iree/base/internal/math.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/drivers/cuda/cuda_allocator.h"
 #include "iree/hal/drivers/cuda/cuda_dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/cuda_status_util.h"
@@ -25,16 +27,21 @@
 #include "iree/hal/drivers/cuda/nop_executable_cache.h"
 #include "iree/hal/drivers/cuda/stream_command_buffer.h"
 #include "iree/hal/drivers/cuda/timepoint_pool.h"
+#include "iree/hal/drivers/cuda/virtual_buffer.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/deferred_work_queue.h"
+#include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
-#include "iree/hal/utils/memory_file.h"
 #include "iree/hal/utils/stream_tracing.h"
 
 //===----------------------------------------------------------------------===//
 // iree_hal_cuda_device_t
 //===----------------------------------------------------------------------===//
 
+// Maximum number of queues (and dispatch streams) per device; one for each bit
+// of iree_hal_queue_affinity_t.
+#define IREE_HAL_CUDA_MAX_QUEUE_COUNT 64
+
 typedef struct iree_hal_cuda_device_t {
   // Abstract resource used for injecting reference counting and vtable;
   // must be at offset 0.
@@ -50,6 +57,10 @@ typedef struct iree_hal_cuda_device_t {
   iree_hal_driver_t* driver;
 
   const iree_hal_cuda_dynamic_symbols_t* cuda_symbols;
+  // NCCL symbols owned by the driver that are loaded when the first collective
+  // channel is created. |nccl_symbols| aliases the loaded symbols and must only
+  // be used by collective operations as those require a channel.
+  iree_hal_cuda_nccl_lazy_dynamic_symbols_t* nccl_lazy_symbols;
   const iree_hal_cuda_nccl_dynamic_symbols_t* nccl_symbols;
 
   // Parameters used to control device behavior.
@@ -57,9 +68,24 @@ typedef struct iree_hal_cuda_device_t {
 
   CUcontext cu_context;
   CUdevice cu_device;
-  // TODO: Support multiple device streams.
-  // The CUstream used to issue device kernels and allocations.
-  CUstream dispatch_cu_stream;
+  // Number of device queues, each backed by its own dispatch stream.
+  iree_host_size_t queue_count;
+  // The CUstreams used to issue device kernels and allocations with one per
+  // queue. Queue affinities are mapped onto these by
+  // iree_hal_cuda_device_select_queue and the first stream is used for any
+  // operation not associated with a particular queue.
+  CUstream* dispatch_cu_streams;
+  // High-priority CUstreams used to issue collective operations with one per
+  // queue. Collectives are ordered against their dispatch stream with events
+  // such that they can overlap with independent dispatches. The streams are
+  // created along with the first collective channel and until then
+  // collectives are issued on the dispatch stream.
+  // Only valid to read once |collective_cu_streams_ready| is set.
+  CUstream* collective_cu_streams;
+  // Guards creation of |collective_cu_streams|.
+  iree_slim_mutex_t collective_mutex;
+  // Non-zero once |collective_cu_streams| have been created.
+  iree_atomic_int32_t collective_cu_streams_ready;
 
   iree_hal_stream_tracing_context_t* tracing_context;
 
@@ -71,11 +97,13 @@ typedef struct iree_hal_cuda_device_t {
   // Timepoint pools, shared by various semaphores.
   iree_hal_cuda_timepoint_pool_t* timepoint_pool;
 
-  // A queue to order device workloads and relase to the GPU when constraints
-  // are met. It buffers submissions and allocations internally before they
-  // are ready. This queue couples with HAL semaphores backed by iree_event_t
-  // and CUevent objects.
-  iree_hal_deferred_work_queue_t* work_queue;
+  // Queues to order device workloads and relase to the GPU when constraints
+  // are met with one per dispatch stream. They buffer submissions and
+  // allocations internally before they are ready. The queues couple with HAL
+  // semaphores backed by iree_event_t and CUevent objects such that waits on
+  // semaphores signaled from another stream are performed on the device with
+  // cuStreamWaitEvent.
+  iree_hal_deferred_work_queue_t** work_queues;
 
   // Device memory pools and allocators.
   bool supports_memory_pools;
@@ -99,6 +127,8 @@ typedef struct iree_hal_cuda_deferred_work_queue_device_interface_t {
   iree_hal_device_t* device;
   CUdevice cu_device;
   CUcontext cu_context;
+  // Index of the device queue this interface issues work for.
+  iree_host_size_t queue_index;
   CUstream dispatch_cu_stream;
   iree_allocator_t host_allocator;
   const iree_hal_cuda_dynamic_symbols_t* cuda_symbols;
@@ -232,13 +262,15 @@ iree_hal_cuda_deferred_work_queue_device_interface_create_stream_command_buffer(
   iree_hal_cuda_deferred_work_queue_device_interface_t* device_interface =
       (iree_hal_cuda_deferred_work_queue_device_interface_t*)(base_device_interface);
   return iree_hal_cuda_device_create_stream_command_buffer(
-      device_interface->device, mode, categories, 0, out);
+      device_interface->device, mode, categories,
+      1ull << device_interface->queue_index, 0, out);
 }
 
 static iree_status_t
 iree_hal_cuda_deferred_work_queue_device_interface_submit_command_buffer(
     iree_hal_deferred_work_queue_device_interface_t* base_device_interface,
-    iree_hal_command_buffer_t* command_buffer) {
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
   iree_hal_cuda_deferred_work_queue_device_interface_t* device_interface =
       (iree_hal_cuda_deferred_work_queue_device_interface_t*)(base_device_interface);
   iree_status_t status = iree_ok_status();
@@ -246,11 +278,8 @@ iree_hal_cuda_deferred_work_queue_device_interface_submit_command_buffer(
     // Stream command buffer so nothing to do but notify it was submitted.
     iree_hal_cuda_stream_notify_submitted_commands(command_buffer);
   } else {
-    CUgraphExec exec =
-        iree_hal_cuda_graph_command_buffer_handle(command_buffer);
-    status = IREE_CURESULT_TO_STATUS(
-        device_interface->cuda_symbols,
-        cuGraphLaunch(exec, device_interface->dispatch_cu_stream));
+    status = iree_hal_cuda_graph_command_buffer_launch(
+        command_buffer, binding_table, device_interface->dispatch_cu_stream);
     if (IREE_LIKELY(iree_status_is_ok(status))) {
       iree_hal_cuda_graph_tracing_notify_submitted_commands(command_buffer);
     }
@@ -371,6 +400,17 @@ static iree_hal_cuda_device_t* iree_hal_cuda_device_cast_unsafe(
   return (iree_hal_cuda_device_t*)base_value;
 }
 
+// Returns the index of the device queue that services |queue_affinity|.
+// Affinity bits are folded onto the available queues so that programs compiled
+// for more queues than the device exposes still run. When multiple bits are set
+// (such as IREE_HAL_QUEUE_AFFINITY_ANY) the lowest is used.
+static iree_host_size_t iree_hal_cuda_device_select_queue(
+    iree_hal_cuda_device_t* device, iree_hal_queue_affinity_t queue_affinity) {
+  if (device->queue_count == 1 || queue_affinity == 0) return 0;
+  return iree_math_count_trailing_zeros_u64(queue_affinity) %
+         device->queue_count;
+}
+
 IREE_API_EXPORT void iree_hal_cuda_device_params_initialize(
     iree_hal_cuda_device_params_t* out_params) {
   memset(out_params, 0, sizeof(*out_params));
@@ -382,6 +422,118 @@ IREE_API_EXPORT void iree_hal_cuda_device_params_initialize(
   out_params->async_allocations = true;
 }
 
+static iree_status_t iree_hal_cuda_device_check_dispatch_statistics(
+    iree_hal_device_t* base_device) {
+  if (!iree_hal_resource_is(base_device, &iree_hal_cuda_device_vtable)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "device is not a CUDA device");
+  }
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  if (!device->params.dispatch_statistics) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "device was not created with dispatch statistics "
+                            "enabled");
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_cuda_device_query_dispatch_statistics(
+    iree_hal_device_t* base_device, iree_host_size_t capacity,
+    iree_hal_cuda_dispatch_statistics_t* out_statistics,
+    iree_host_size_t* out_count, uint64_t* out_dropped_count) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(!capacity || out_statistics);
+  IREE_ASSERT_ARGUMENT(out_count);
+  *out_count = 0;
+  if (out_dropped_count) *out_dropped_count = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_device_check_dispatch_statistics(base_device));
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_stream_tracing_statistics_t* statistics = NULL;
+  if (capacity > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(device->host_allocator,
+                                  capacity * sizeof(*statistics),
+                                  (void**)&statistics));
+  }
+  iree_host_size_t count = 0;
+  iree_status_t status = iree_hal_stream_tracing_context_merge_statistics(
+      device->tracing_context, capacity, statistics, &count, out_dropped_count);
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    out_statistics[i].name = statistics[i].name;
+    out_statistics[i].count = statistics[i].count;
+    out_statistics[i].total_ns = statistics[i].total_ns;
+    out_statistics[i].min_ns = statistics[i].min_ns;
+    out_statistics[i].max_ns = statistics[i].max_ns;
+  }
+  *out_count = count;
+  iree_allocator_free(device->host_allocator, statistics);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_cuda_device_reset_dispatch_statistics(iree_hal_device_t* base_device) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_cuda_device_check_dispatch_statistics(base_device));
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_hal_stream_tracing_context_reset_statistics(device->tracing_context);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_cuda_device_allocate_growable_buffer(
+    iree_hal_device_t* base_device, iree_hal_buffer_params_t params,
+    iree_device_size_t reserved_size, iree_device_size_t committed_size,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  if (!iree_hal_resource_is(base_device, &iree_hal_cuda_device_vtable)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "device is not a CUDA device");
+  }
+  iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  return iree_hal_cuda_virtual_buffer_allocate(
+      device->cuda_symbols, device->cu_context, device->cu_device, params,
+      reserved_size, committed_size, device->host_allocator, out_buffer);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_cuda_device_queue_grow_buffer(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer, iree_device_size_t minimum_committed_size) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(buffer);
+  if (!iree_hal_resource_is(base_device, &iree_hal_cuda_device_vtable)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "device is not a CUDA device");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Mapping new physical memory does not disturb the committed range so it is
+  // safe to commit eagerly on the host while prior work is in-flight. Only
+  // work waiting on the signal may touch the new range so the grow itself is
+  // ordered on the queue with a barrier.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_cuda_virtual_buffer_commit(buffer, minimum_committed_size));
+  iree_status_t status = iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_device_size_t
+iree_hal_cuda_buffer_committed_size(iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  return iree_hal_cuda_virtual_buffer_committed_size(buffer);
+}
+
 static iree_status_t iree_hal_cuda_device_check_params(
     const iree_hal_cuda_device_params_t* params) {
   if (params->arena_block_size < 4096) {
@@ -392,61 +544,98 @@ static iree_status_t iree_hal_cuda_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "at least one queue is required");
   }
+  if (params->queue_count > IREE_HAL_CUDA_MAX_QUEUE_COUNT) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at most %d queues are supported but %" PRIhsz
+                            " were requested",
+                            IREE_HAL_CUDA_MAX_QUEUE_COUNT, params->queue_count);
+  }
   return iree_ok_status();
 }
 
 static iree_status_t iree_hal_cuda_device_create_internal(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
     const iree_hal_cuda_device_params_t* params, CUdevice cu_device,
-    CUstream dispatch_stream, CUcontext context,
+    const CUstream* dispatch_streams, CUcontext context,
     const iree_hal_cuda_dynamic_symbols_t* cuda_symbols,
-    const iree_hal_cuda_nccl_dynamic_symbols_t* nccl_symbols,
+    iree_hal_cuda_nccl_lazy_dynamic_symbols_t* nccl_lazy_symbols,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  const iree_host_size_t queue_count = params->queue_count;
   iree_hal_cuda_device_t* device = NULL;
-  iree_host_size_t total_size = iree_sizeof_struct(*device) + identifier.size;
+  iree_host_size_t streams_offset = iree_sizeof_struct(*device);
+  iree_host_size_t collective_streams_offset =
+      streams_offset + queue_count * sizeof(device->dispatch_cu_streams[0]);
+  iree_host_size_t work_queues_offset =
+      collective_streams_offset +
+      queue_count * sizeof(device->collective_cu_streams[0]);
+  iree_host_size_t identifier_offset =
+      work_queues_offset + queue_count * sizeof(device->work_queues[0]);
+  iree_host_size_t total_size = identifier_offset + identifier.size;
   IREE_RETURN_IF_ERROR(
       iree_allocator_malloc(host_allocator, total_size, (void**)&device));
 
   iree_hal_resource_initialize(&iree_hal_cuda_device_vtable, &device->resource);
-  iree_string_view_append_to_buffer(
-      identifier, &device->identifier,
-      (char*)device + iree_sizeof_struct(*device));
+  iree_slim_mutex_initialize(&device->collective_mutex);
+  iree_string_view_append_to_buffer(identifier, &device->identifier,
+                                    (char*)device + identifier_offset);
   iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
                                    &device->block_pool);
   device->driver = driver;
   iree_hal_driver_retain(device->driver);
   device->cuda_symbols = cuda_symbols;
-  device->nccl_symbols = nccl_symbols;
+  device->nccl_lazy_symbols = nccl_lazy_symbols;
+  device->nccl_symbols = &nccl_lazy_symbols->symbols;
   device->params = *params;
   device->cu_context = context;
   device->cu_device = cu_device;
-  device->dispatch_cu_stream = dispatch_stream;
   device->host_allocator = host_allocator;
 
-  iree_hal_cuda_deferred_work_queue_device_interface_t* device_interface;
-  iree_status_t status = iree_allocator_malloc(
-      host_allocator,
-      sizeof(iree_hal_cuda_deferred_work_queue_device_interface_t),
-      (void**)&device_interface);
+  // The device takes ownership of the dispatch streams.
+  device->queue_count = queue_count;
+  device->dispatch_cu_streams =
+      (CUstream*)((uint8_t*)device + streams_offset);
+  device->collective_cu_streams =
+      (CUstream*)((uint8_t*)device + collective_streams_offset);
+  device->work_queues =
+      (iree_hal_deferred_work_queue_t**)((uint8_t*)device + work_queues_offset);
+  for (iree_host_size_t i = 0; i < queue_count; ++i) {
+    device->dispatch_cu_streams[i] = dispatch_streams[i];
+  }
+  CUstream dispatch_stream = dispatch_streams[0];
+
+  // Each stream gets its own work queue so that waits on one stream do not
+  // block submissions to the others.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < queue_count && iree_status_is_ok(status);
+       ++i) {
+    iree_hal_cuda_deferred_work_queue_device_interface_t* device_interface;
+    status = iree_allocator_malloc(
+        host_allocator,
+        sizeof(iree_hal_cuda_deferred_work_queue_device_interface_t),
+        (void**)&device_interface);
+    if (IREE_UNLIKELY(!iree_status_is_ok(status))) break;
+    device_interface->base.vtable =
+        &iree_hal_cuda_deferred_work_queue_device_interface_vtable;
+    device_interface->cu_context = context;
+    device_interface->cuda_symbols = cuda_symbols;
+    device_interface->cu_device = cu_device;
+    device_interface->device = (iree_hal_device_t*)device;
+    device_interface->queue_index = i;
+    device_interface->dispatch_cu_stream = dispatch_streams[i];
+    device_interface->host_allocator = host_allocator;
+    status = iree_hal_deferred_work_queue_create(
+        (iree_hal_deferred_work_queue_device_interface_t*)device_interface,
+        &device->block_pool, host_allocator, &device->work_queues[i]);
+  }
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
     iree_hal_device_release((iree_hal_device_t*)device);
     return status;
   }
-  device_interface->base.vtable =
-      &iree_hal_cuda_deferred_work_queue_device_interface_vtable;
-  device_interface->cu_context = context;
-  device_interface->cuda_symbols = cuda_symbols;
-  device_interface->cu_device = cu_device;
-  device_interface->device = (iree_hal_device_t*)device;
-  device_interface->dispatch_cu_stream = dispatch_stream;
-  device_interface->host_allocator = host_allocator;
-
-  status = iree_hal_deferred_work_queue_create(
-      (iree_hal_deferred_work_queue_device_interface_t*)device_interface,
-      &device->block_pool, host_allocator, &device->work_queue);
-
-  // Enable tracing for the (currently only) stream - no-op if disabled.
-  if (iree_status_is_ok(status) && device->params.stream_tracing) {
+
+  // Enable tracing and/or dispatch statistics for the default stream - no-op if
+  // disabled.
+  if (iree_status_is_ok(status) &&
+      (device->params.stream_tracing || device->params.dispatch_statistics)) {
     if (device->params.stream_tracing >=
             IREE_HAL_STREAM_TRACING_VERBOSITY_MAX ||
         device->params.stream_tracing < IREE_HAL_STREAM_TRACING_VERBOSITY_OFF) {
@@ -475,10 +664,22 @@ static iree_status_t iree_hal_cuda_device_create_internal(
     tracing_device_interface->host_allocator = host_allocator;
     tracing_device_interface->cuda_symbols = cuda_symbols;
 
+    iree_hal_stream_tracing_mode_t tracing_mode =
+        IREE_HAL_STREAM_TRACING_MODE_NONE;
+    iree_hal_stream_tracing_verbosity_t tracing_verbosity =
+        device->params.stream_tracing;
+    if (device->params.stream_tracing) {
+      tracing_mode |= IREE_HAL_STREAM_TRACING_MODE_TRACY;
+    }
+    if (device->params.dispatch_statistics) {
+      // Dispatch zones are only recorded at fine verbosity.
+      tracing_mode |= IREE_HAL_STREAM_TRACING_MODE_STATISTICS;
+      tracing_verbosity = IREE_HAL_STREAM_TRACING_VERBOSITY_FINE;
+    }
     status = iree_hal_stream_tracing_context_allocate(
         (iree_hal_stream_tracing_device_interface_t*)tracing_device_interface,
-        device->identifier, device->params.stream_tracing, &device->block_pool,
-        host_allocator, &device->tracing_context);
+        device->identifier, tracing_mode, tracing_verbosity,
+        &device->block_pool, host_allocator, &device->tracing_context);
   }
 
   // Memory pool support is conditional.
@@ -502,7 +703,7 @@ static iree_status_t iree_hal_cuda_device_create_internal(
 
   if (iree_status_is_ok(status)) {
     status = iree_hal_cuda_allocator_create(
-        cuda_symbols, cu_device, dispatch_stream,
+        cuda_symbols, cu_device, context, dispatch_stream,
         device->supports_memory_pools ? &device->memory_pools : NULL,
         host_allocator, &device->device_allocator);
   }
@@ -519,11 +720,12 @@ iree_status_t iree_hal_cuda_device_create(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
     const iree_hal_cuda_device_params_t* params,
     const iree_hal_cuda_dynamic_symbols_t* cuda_symbols,
-    const iree_hal_cuda_nccl_dynamic_symbols_t* nccl_symbols, CUdevice device,
+    iree_hal_cuda_nccl_lazy_dynamic_symbols_t* nccl_symbols, CUdevice device,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   IREE_ASSERT_ARGUMENT(driver);
   IREE_ASSERT_ARGUMENT(params);
   IREE_ASSERT_ARGUMENT(cuda_symbols);
+  IREE_ASSERT_ARGUMENT(nccl_symbols);
   IREE_ASSERT_ARGUMENT(out_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -539,20 +741,26 @@ iree_status_t iree_hal_cuda_device_create(
     status = IREE_CURESULT_TO_STATUS(cuda_symbols, cuCtxSetCurrent(context));
   }
 
-  // Create the default dispatch stream for the device.
-  CUstream dispatch_stream = NULL;
-  if (iree_status_is_ok(status)) {
+  // Create one dispatch stream per queue for the device.
+  CUstream dispatch_streams[IREE_HAL_CUDA_MAX_QUEUE_COUNT] = {NULL};
+  for (iree_host_size_t i = 0;
+       i < params->queue_count && iree_status_is_ok(status); ++i) {
     status = IREE_CURESULT_TO_STATUS(
-        cuda_symbols, cuStreamCreate(&dispatch_stream, CU_STREAM_NON_BLOCKING));
+        cuda_symbols,
+        cuStreamCreate(&dispatch_streams[i], CU_STREAM_NON_BLOCKING));
   }
 
   if (iree_status_is_ok(status)) {
     status = iree_hal_cuda_device_create_internal(
-        driver, identifier, params, device, dispatch_stream, context,
+        driver, identifier, params, device, dispatch_streams, context,
         cuda_symbols, nccl_symbols, host_allocator, out_device);
   } else {
     // Release resources we have accquired thus far.
-    if (dispatch_stream) cuda_symbols->cuStreamDestroy(dispatch_stream);
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(dispatch_streams); ++i) {
+      if (dispatch_streams[i]) {
+        cuda_symbols->cuStreamDestroy(dispatch_streams[i]);
+      }
+    }
     if (context) cuda_symbols->cuDevicePrimaryCtxRelease(device);
   }
 
@@ -614,8 +822,12 @@ static void iree_hal_cuda_device_destroy(iree_hal_device_t* base_device) {
   const iree_hal_cuda_dynamic_symbols_t* symbols = device->cuda_symbols;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Destroy the pending workload queue.
-  iree_hal_deferred_work_queue_destroy(device->work_queue);
+  // Destroy the pending workload queues.
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    if (device->work_queues[i]) {
+      iree_hal_deferred_work_queue_destroy(device->work_queues[i]);
+    }
+  }
 
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
@@ -637,11 +849,19 @@ static void iree_hal_cuda_device_destroy(iree_hal_device_t* base_device) {
   }
   if (device->host_event_pool) iree_event_pool_free(device->host_event_pool);
 
-  IREE_CUDA_IGNORE_ERROR(symbols, cuStreamDestroy(device->dispatch_cu_stream));
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    IREE_CUDA_IGNORE_ERROR(symbols,
+                           cuStreamDestroy(device->dispatch_cu_streams[i]));
+    if (device->collective_cu_streams[i]) {
+      IREE_CUDA_IGNORE_ERROR(symbols,
+                             cuStreamDestroy(device->collective_cu_streams[i]));
+    }
+  }
 
   IREE_CUDA_IGNORE_ERROR(symbols, cuDevicePrimaryCtxRelease(device->cu_device));
 
   iree_arena_block_pool_deinitialize(&device->block_pool);
+  iree_slim_mutex_deinitialize(&device->collective_mutex);
 
   // Finally, destroy the device.
   iree_hal_driver_release(device->driver);
@@ -708,6 +928,22 @@ static iree_status_t iree_hal_cuda_device_query_attribute(
   return iree_ok_status();
 }
 
+// Queries the free and total device memory available to the device context.
+static iree_status_t iree_hal_cuda_device_query_memory_info(
+    iree_hal_cuda_device_t* device, size_t* out_free, size_t* out_total) {
+  IREE_CUDA_RETURN_IF_ERROR(device->cuda_symbols,
+                            cuCtxPushCurrent(device->cu_context),
+                            "cuCtxPushCurrent");
+  iree_status_t status = IREE_CURESULT_TO_STATUS(
+      device->cuda_symbols, cuMemGetInfo(out_free, out_total), "cuMemGetInfo");
+  CUcontext popped_context = NULL;
+  status = iree_status_join(
+      status, IREE_CURESULT_TO_STATUS(device->cuda_symbols,
+                                      cuCtxPopCurrent(&popped_context),
+                                      "cuCtxPopCurrent"));
+  return status;
+}
+
 static iree_status_t iree_hal_cuda_device_query_i64(
     iree_hal_device_t* base_device, iree_string_view_t category,
     iree_string_view_t key, int64_t* out_value) {
@@ -725,6 +961,22 @@ static iree_status_t iree_hal_cuda_device_query_i64(
     return iree_ok_status();
   }
 
+  if (iree_string_view_equal(category, IREE_SV("hal.device.memory"))) {
+    size_t free_size = 0;
+    size_t total_size = 0;
+    if (iree_string_view_equal(key, IREE_SV("free"))) {
+      IREE_RETURN_IF_ERROR(iree_hal_cuda_device_query_memory_info(
+          device, &free_size, &total_size));
+      *out_value = (int64_t)free_size;
+      return iree_ok_status();
+    } else if (iree_string_view_equal(key, IREE_SV("total"))) {
+      IREE_RETURN_IF_ERROR(iree_hal_cuda_device_query_memory_info(
+          device, &free_size, &total_size));
+      *out_value = (int64_t)total_size;
+      return iree_ok_status();
+    }
+  }
+
   if (iree_string_view_equal(category, IREE_SV("cuda.device"))) {
     if (iree_string_view_equal(key, IREE_SV("compute_capability_major"))) {
       return iree_hal_cuda_device_query_attribute(
@@ -742,18 +994,86 @@ static iree_status_t iree_hal_cuda_device_query_i64(
       (int)category.size, category.data, (int)key.size, key.data);
 }
 
+// Creates one collective stream per queue if they have not yet been created.
+// These use the highest priority supported by the device so that communication
+// kernels are scheduled ahead of the compute work they overlap with.
+static iree_status_t iree_hal_cuda_device_ensure_collective_streams(
+    iree_hal_cuda_device_t* device) {
+  if (iree_atomic_load(&device->collective_cu_streams_ready,
+                       iree_memory_order_acquire)) {
+    return iree_ok_status();
+  }
+  iree_slim_mutex_lock(&device->collective_mutex);
+  if (iree_atomic_load(&device->collective_cu_streams_ready,
+                       iree_memory_order_relaxed)) {
+    iree_slim_mutex_unlock(&device->collective_mutex);
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_hal_cuda_dynamic_symbols_t* symbols = device->cuda_symbols;
+  iree_status_t status = IREE_CURESULT_TO_STATUS(
+      symbols, cuCtxPushCurrent(device->cu_context), "cuCtxPushCurrent");
+  if (iree_status_is_ok(status)) {
+    int least_priority = 0;
+    int greatest_priority = 0;
+    status = IREE_CURESULT_TO_STATUS(
+        symbols,
+        cuCtxGetStreamPriorityRange(&least_priority, &greatest_priority));
+    for (iree_host_size_t i = 0;
+         i < device->queue_count && iree_status_is_ok(status); ++i) {
+      status = IREE_CURESULT_TO_STATUS(
+          symbols, cuStreamCreateWithPriority(&device->collective_cu_streams[i],
+                                              CU_STREAM_NON_BLOCKING,
+                                              greatest_priority));
+    }
+    if (!iree_status_is_ok(status)) {
+      for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+        if (device->collective_cu_streams[i]) {
+          IREE_CUDA_IGNORE_ERROR(
+              symbols, cuStreamDestroy(device->collective_cu_streams[i]));
+          device->collective_cu_streams[i] = NULL;
+        }
+      }
+    }
+    CUcontext popped_context = NULL;
+    status = iree_status_join(
+        status,
+        IREE_CURESULT_TO_STATUS(symbols, cuCtxPopCurrent(&popped_context),
+                                "cuCtxPopCurrent"));
+  }
+  if (iree_status_is_ok(status)) {
+    iree_atomic_store(&device->collective_cu_streams_ready, 1,
+                      iree_memory_order_release);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  iree_slim_mutex_unlock(&device->collective_mutex);
+  return status;
+}
+
+// Returns the collective stream for |queue_index| or NULL if collectives are
+// to be issued on the dispatch stream.
+static CUstream iree_hal_cuda_device_collective_stream(
+    iree_hal_cuda_device_t* device, iree_host_size_t queue_index) {
+  if (!iree_atomic_load(&device->collective_cu_streams_ready,
+                        iree_memory_order_acquire)) {
+    return NULL;
+  }
+  return device->collective_cu_streams[queue_index];
+}
+
 static iree_status_t iree_hal_cuda_device_create_channel(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
-  if (!device->nccl_symbols || !device->nccl_symbols->dylib) {
-    return iree_make_status(
-        IREE_STATUS_UNAVAILABLE,
-        "NCCL runtime library version %d.%d and greater not available; "
-        "ensure installed and the shared library (nccl.dll/libnccl.so) "
-        "is on your PATH/LD_LIBRARY_PATH.",
-        NCCL_MAJOR, NCCL_MINOR);
-  }
+
+  // Load NCCL if this is the first channel created. This fails if NCCL is
+  // unavailable or incompatible.
+  const iree_hal_cuda_nccl_dynamic_symbols_t* nccl_symbols = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_nccl_lazy_dynamic_symbols_resolve(
+      device->nccl_lazy_symbols, &nccl_symbols));
+  IREE_RETURN_IF_ERROR(iree_hal_cuda_device_ensure_collective_streams(device));
 
   // Today we only allow a single logical device per channel.
   // We could multiplex channels but it'd be better to surface that to the
@@ -793,7 +1113,7 @@ static iree_status_t iree_hal_cuda_device_create_channel(
     if (params.rank == 0) {
       // Bootstrap NCCL to get the root ID.
       IREE_RETURN_IF_ERROR(
-          iree_hal_cuda_nccl_get_unique_id(device->nccl_symbols, &id),
+          iree_hal_cuda_nccl_get_unique_id(nccl_symbols, &id),
           "bootstrapping NCCL root");
     }
     // Exchange NCCL ID with all participants.
@@ -822,20 +1142,30 @@ static iree_status_t iree_hal_cuda_device_create_channel(
   // context of the device mapped to the queue_affinity. For now since this
   // implementation only supports one device we pass in the only one we have.
   return iree_hal_cuda_nccl_channel_create(
-      device->cuda_symbols, device->nccl_symbols, &id, params.rank,
-      params.count, device->host_allocator, out_channel);
+      device->cuda_symbols, nccl_symbols, &id, params.rank,
+      params.count, device->params.collective_bucket_size,
+      device->host_allocator, out_channel);
 }
 
 iree_status_t iree_hal_cuda_device_create_stream_command_buffer(
     iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
-    iree_host_size_t binding_capacity,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
+  iree_host_size_t queue_index =
+      iree_hal_cuda_device_select_queue(device, queue_affinity);
+  // Stream tracing records its events on the default stream and can only
+  // time work issued there.
+  iree_hal_stream_tracing_context_t* tracing_context =
+      queue_index == 0 ? device->tracing_context : NULL;
   return iree_hal_cuda_stream_command_buffer_create(
       iree_hal_device_allocator(base_device), device->cuda_symbols,
-      device->nccl_symbols, device->tracing_context, mode, command_categories,
-      binding_capacity, device->dispatch_cu_stream, &device->block_pool,
+      device->nccl_symbols, tracing_context, mode, command_categories,
+      binding_capacity, device->cu_context,
+      device->dispatch_cu_streams[queue_index],
+      iree_hal_cuda_device_collective_stream(device, queue_index),
+      &device->block_pool,
       device->host_allocator, out_command_buffer);
 }
 
@@ -848,21 +1178,11 @@ static iree_status_t iree_hal_cuda_device_create_command_buffer(
 
   switch (device->params.command_buffer_mode) {
     case IREE_HAL_CUDA_COMMAND_BUFFER_MODE_GRAPH: {
-      // TODO(indirect-cmd): when we can record indirect graphs we won't need
-      // to use deferred command buffers - this is here to emulate indirect
-      // command buffers.
-      if (binding_capacity > 0) {
-        return iree_hal_deferred_command_buffer_create(
-            iree_hal_device_allocator(base_device), mode, command_categories,
-            binding_capacity, &device->block_pool,
-            iree_hal_device_host_allocator(base_device), out_command_buffer);
-      } else {
-        return iree_hal_cuda_graph_command_buffer_create(
-            iree_hal_device_allocator(base_device), device->cuda_symbols,
-            device->tracing_context, device->cu_context, mode,
-            command_categories, queue_affinity, binding_capacity,
-            &device->block_pool, device->host_allocator, out_command_buffer);
-      }
+      return iree_hal_cuda_graph_command_buffer_create(
+          iree_hal_device_allocator(base_device), device->cuda_symbols,
+          device->tracing_context, device->cu_context, mode, command_categories,
+          queue_affinity, binding_capacity, &device->block_pool,
+          device->host_allocator, out_command_buffer);
     }
     case IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM: {
       return iree_hal_deferred_command_buffer_create(
@@ -897,14 +1217,8 @@ static iree_status_t iree_hal_cuda_device_import_file(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
     iree_hal_external_file_flags_t flags, iree_hal_file_t** out_file) {
-  if (iree_io_file_handle_type(handle) !=
-      IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    return iree_make_status(
-        IREE_STATUS_UNAVAILABLE,
-        "implementation does not support the external file type");
-  }
-  return iree_hal_memory_file_wrap(
-      queue_affinity, access, handle, iree_hal_device_allocator(base_device),
+  return iree_hal_file_from_handle(
+      iree_hal_device_allocator(base_device), queue_affinity, access, handle,
       iree_hal_device_host_allocator(base_device), out_file);
 }
 
@@ -914,7 +1228,8 @@ static iree_status_t iree_hal_cuda_device_create_semaphore(
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
   return iree_hal_cuda_event_semaphore_create(
       initial_value, device->cuda_symbols, device->timepoint_pool,
-      device->work_queue, device->host_allocator, out_semaphore);
+      device->queue_count, device->work_queues, device->host_allocator,
+      out_semaphore);
 }
 
 static iree_hal_semaphore_compatibility_t
@@ -924,8 +1239,6 @@ iree_hal_cuda_device_query_semaphore_compatibility(
   return IREE_HAL_SEMAPHORE_COMPATIBILITY_HOST_ONLY;
 }
 
-// TODO: implement multiple streams; today we only have one and queue_affinity
-//       is ignored.
 // TODO: implement proper semaphores in CUDA to ensure ordering and avoid
 //       the barrier here.
 static iree_status_t iree_hal_cuda_device_queue_alloca(
@@ -950,9 +1263,19 @@ static iree_status_t iree_hal_cuda_device_queue_alloca(
   iree_status_t status = iree_ok_status();
   if (device->supports_memory_pools &&
       !iree_all_bits_set(params.type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    CUstream stream =
+        device->dispatch_cu_streams[iree_hal_cuda_device_select_queue(
+            device, queue_affinity)];
     status = iree_hal_cuda_memory_pools_alloca(
-        &device->memory_pools, device->dispatch_cu_stream, pool, params,
-        allocation_size, out_buffer);
+        &device->memory_pools, stream, pool, params, allocation_size,
+        out_buffer);
+    if (iree_status_is_ok(status) && device->queue_count > 1) {
+      // The signal below happens on the host and carries no device-side
+      // dependency; with multiple streams the buffer may be used from a stream
+      // that is not ordered after the allocation so wait for it here.
+      status = IREE_CURESULT_TO_STATUS(device->cuda_symbols,
+                                       cuStreamSynchronize(stream));
+    }
   } else {
     status = iree_hal_allocator_allocate_buffer(
         iree_hal_device_allocator(base_device), params, allocation_size,
@@ -968,8 +1291,6 @@ static iree_status_t iree_hal_cuda_device_queue_alloca(
   return status;
 }
 
-// TODO: implement multiple streams; today we only have one and queue_affinity
-//       is ignored.
 // TODO: implement proper semaphores in CUDA to ensure ordering and avoid
 //       the barrier here.
 static iree_status_t iree_hal_cuda_device_queue_dealloca(
@@ -990,7 +1311,10 @@ static iree_status_t iree_hal_cuda_device_queue_dealloca(
   iree_status_t status = iree_ok_status();
   if (device->supports_memory_pools) {
     status = iree_hal_cuda_memory_pools_dealloca(
-        &device->memory_pools, device->dispatch_cu_stream, buffer);
+        &device->memory_pools,
+        device->dispatch_cu_streams[iree_hal_cuda_device_select_queue(
+            device, queue_affinity)],
+        buffer);
   }
 
   // Only signal if not returning a synchronous error - synchronous failure
@@ -1058,14 +1382,17 @@ static iree_status_t iree_hal_cuda_device_queue_execute(
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_deferred_work_queue_t* work_queue =
+      device->work_queues[iree_hal_cuda_device_select_queue(device,
+                                                            queue_affinity)];
   iree_status_t status = iree_hal_deferred_work_queue_enqueue(
-      device->work_queue, iree_hal_cuda_device_collect_tracing_context,
+      work_queue, iree_hal_cuda_device_collect_tracing_context,
       device->tracing_context, wait_semaphore_list, signal_semaphore_list,
       command_buffer ? 1 : 0, command_buffer ? &command_buffer : NULL,
       &binding_table);
   if (iree_status_is_ok(status)) {
     // Try to advance the deferred work queue.
-    status = iree_hal_deferred_work_queue_issue(device->work_queue);
+    status = iree_hal_deferred_work_queue_issue(work_queue);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -1076,8 +1403,13 @@ static iree_status_t iree_hal_cuda_device_queue_flush(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity) {
   iree_hal_cuda_device_t* device = iree_hal_cuda_device_cast(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
-  // Try to advance the deferred work queue.
-  iree_status_t status = iree_hal_deferred_work_queue_issue(device->work_queue);
+  // Try to advance the deferred work queues. Queues not selected by the
+  // affinity have nothing from this caller to flush but are cheap to check.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < device->queue_count && iree_status_is_ok(status); ++i) {
+    status = iree_hal_deferred_work_queue_issue(device->work_queues[i]);
+  }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -8,6 +8,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/cuda/api.h"
 #include "iree/hal/drivers/cuda/cuda_device.h"
@@ -33,9 +34,14 @@ typedef struct iree_hal_cuda_driver_t {
   // Identifier used for registering the driver in the IREE driver registry.
   iree_string_view_t identifier;
   // CUDA driver API dynamic symbols to interact with the CUDA system.
+  // Only the core symbols are resolved when the driver is created and the
+  // device symbols are resolved when the first device is created.
   iree_hal_cuda_dynamic_symbols_t cuda_symbols;
+  // Guards resolving the device symbols in |cuda_symbols|.
+  iree_slim_mutex_t device_symbols_mutex;
   // NCCL API dynamic symbols to use collectives (multi-gpu/multi-node).
-  iree_hal_cuda_nccl_dynamic_symbols_t nccl_symbols;
+  // Loaded when the first collective channel is created.
+  iree_hal_cuda_nccl_lazy_dynamic_symbols_t nccl_symbols;
 
   // The default parameters for creating devices using this driver.
   iree_hal_cuda_device_params_t device_params;
@@ -75,19 +81,16 @@ static iree_status_t iree_hal_cuda_driver_create_internal(
       identifier, &driver->identifier,
       (char*)driver + iree_sizeof_struct(*driver));
   driver->default_device_index = options->default_device_index;
+  iree_slim_mutex_initialize(&driver->device_symbols_mutex);
+
+  // NCCL is only loaded if the user tries to create a channel. Any failure to
+  // find a compatible version is reported at that time.
+  iree_hal_cuda_nccl_lazy_dynamic_symbols_initialize(
+      host_allocator, &driver->cuda_symbols, &driver->nccl_symbols);
 
   iree_status_t status = iree_hal_cuda_dynamic_symbols_initialize(
       host_allocator, &driver->cuda_symbols);
 
-  if (iree_status_is_ok(status)) {
-    // Try to dynamically load NCCL. This will fail if NCCL is unavailable or
-    // incompatible. We only fail on unavailability when the user tries to
-    // create a channel and otherwise defer reporting.
-    status = iree_hal_cuda_nccl_dynamic_symbols_initialize(
-        host_allocator, &driver->cuda_symbols, &driver->nccl_symbols);
-    if (iree_status_is_unavailable(status)) status = iree_status_ignore(status);
-  }
-
   memcpy(&driver->device_params, device_params, sizeof(driver->device_params));
 
   if (iree_status_is_ok(status)) {
@@ -122,8 +125,9 @@ static void iree_hal_cuda_driver_destroy(iree_hal_driver_t* base_driver) {
   iree_allocator_t host_allocator = driver->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_cuda_nccl_dynamic_symbols_deinitialize(&driver->nccl_symbols);
+  iree_hal_cuda_nccl_lazy_dynamic_symbols_deinitialize(&driver->nccl_symbols);
   iree_hal_cuda_dynamic_symbols_deinitialize(&driver->cuda_symbols);
+  iree_slim_mutex_deinitialize(&driver->device_symbols_mutex);
   iree_allocator_free(host_allocator, driver);
 
   IREE_TRACE_ZONE_END(z0);
@@ -431,30 +435,36 @@ static iree_status_t iree_hal_cuda_driver_dump_device_info(
   return iree_ok_status();
 }
 
+// Selects the default device without populating the device info of all
+// devices as each query may require the driver to initialize the device.
 static iree_status_t iree_hal_cuda_driver_select_default_device(
-    iree_hal_driver_t* base_driver, iree_hal_cuda_dynamic_symbols_t* syms,
-    int default_device_index, iree_allocator_t host_allocator,
+    iree_hal_cuda_driver_t* driver, int default_device_index,
     CUdevice* out_device) {
-  iree_hal_device_info_t* device_infos = NULL;
-  iree_host_size_t device_count = 0;
-  IREE_RETURN_IF_ERROR(iree_hal_cuda_driver_query_available_devices(
-      base_driver, host_allocator, &device_count, &device_infos));
-
-  iree_status_t status = iree_ok_status();
+  int device_count = 0;
+  IREE_CUDA_RETURN_IF_ERROR(&driver->cuda_symbols,
+                            cuDeviceGetCount(&device_count),
+                            "cuDeviceGetCount");
   if (device_count == 0) {
-    status = iree_make_status(IREE_STATUS_UNAVAILABLE,
-                              "no compatible CUDA devices were found");
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "no compatible CUDA devices were found");
   } else if (default_device_index >= device_count) {
-    status = iree_make_status(IREE_STATUS_NOT_FOUND,
-                              "default device %d not found (of %" PRIhsz
-                              " enumerated)",
-                              default_device_index, device_count);
-  } else {
-    *out_device = IREE_DEVICE_ID_TO_CUDEVICE(
-        device_infos[default_device_index].device_id);
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "default device %d not found (of %d enumerated)",
+                            default_device_index, device_count);
   }
-  iree_allocator_free(host_allocator, device_infos);
+  IREE_CUDA_RETURN_IF_ERROR(&driver->cuda_symbols,
+                            cuDeviceGet(out_device, default_device_index),
+                            "cuDeviceGet");
+  return iree_ok_status();
+}
 
+// Resolves the non-core CUDA symbols if they have not yet been resolved.
+static iree_status_t iree_hal_cuda_driver_resolve_device_symbols(
+    iree_hal_cuda_driver_t* driver) {
+  iree_slim_mutex_lock(&driver->device_symbols_mutex);
+  iree_status_t status = iree_hal_cuda_dynamic_symbols_resolve_device_symbols(
+      &driver->cuda_symbols);
+  iree_slim_mutex_unlock(&driver->device_symbols_mutex);
   return status;
 }
 
@@ -470,6 +480,8 @@ static iree_status_t iree_hal_cuda_driver_create_device_by_id(
 
   // Ensure CUDA is initialized before querying it.
   IREE_RETURN_AND_END_ZONE_IF_ERROR(z0, iree_hal_cuda_init(driver));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_cuda_driver_resolve_device_symbols(driver));
 
   // Use either the specified device (enumerated earlier) or whatever default
   // one was specified when the driver was created.
@@ -477,8 +489,7 @@ static iree_status_t iree_hal_cuda_driver_create_device_by_id(
   if (device_id == IREE_HAL_DEVICE_ID_DEFAULT) {
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
         z0, iree_hal_cuda_driver_select_default_device(
-                base_driver, &driver->cuda_symbols,
-                driver->default_device_index, host_allocator, &device));
+                driver, driver->default_device_index, &device));
   } else {
     device = IREE_DEVICE_ID_TO_CUDEVICE(device_id);
   }
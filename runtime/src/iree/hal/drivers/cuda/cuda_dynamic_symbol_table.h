@@ -4,11 +4,17 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+// Core symbols (IREE_CU_CORE_PFN_DECL) are resolved when the driver is created
+// and are limited to those required to initialize CUDA and enumerate devices.
+// All other symbols (IREE_CU_PFN_DECL) are only used by devices and are
+// resolved when the first device is created so that processes that only query
+// devices or never use CUDA do not pay for resolving the full table.
+//
 // cuGetErrorName, cuGetErrorString should be loaded first in case there are
 // errors loading the other symbols.
-IREE_CU_PFN_DECL(cuGetErrorName, CUresult, const char**)
-IREE_CU_PFN_DECL(cuGetErrorString, CUresult, const char**)
-IREE_CU_PFN_DECL(cuDriverGetVersion, int*)
+IREE_CU_CORE_PFN_DECL(cuGetErrorName, CUresult, const char**)
+IREE_CU_CORE_PFN_DECL(cuGetErrorString, CUresult, const char**)
+IREE_CU_CORE_PFN_DECL(cuDriverGetVersion, int*)
 IREE_CU_PFN_DECL(cuCtxCreate, CUcontext*, unsigned int, CUdevice)
 IREE_CU_PFN_DECL(cuCtxDestroy, CUcontext)
 IREE_CU_PFN_DECL(cuDevicePrimaryCtxRetain, CUcontext*, CUdevice)
@@ -16,18 +22,22 @@ IREE_CU_PFN_DECL(cuDevicePrimaryCtxRelease, CUdevice)
 IREE_CU_PFN_DECL(cuCtxSetCurrent, CUcontext)
 IREE_CU_PFN_DECL(cuCtxPushCurrent, CUcontext)
 IREE_CU_PFN_DECL(cuCtxPopCurrent, CUcontext*)
-IREE_CU_PFN_DECL(cuDeviceGet, CUdevice*, int)
-IREE_CU_PFN_DECL(cuDeviceGetCount, int*)
-IREE_CU_PFN_DECL(cuDeviceGetName, char*, int, CUdevice)
-IREE_CU_PFN_DECL(cuDeviceGetAttribute, int*, CUdevice_attribute, CUdevice)
-IREE_CU_PFN_DECL(cuDeviceGetUuid, CUuuid*, CUdevice)
+IREE_CU_PFN_DECL(cuCtxGetStreamPriorityRange, int*, int*)
+IREE_CU_PFN_DECL(cuCtxEnablePeerAccess, CUcontext, unsigned int)
+IREE_CU_CORE_PFN_DECL(cuDeviceGet, CUdevice*, int)
+IREE_CU_CORE_PFN_DECL(cuDeviceGetCount, int*)
+IREE_CU_CORE_PFN_DECL(cuDeviceGetName, char*, int, CUdevice)
+IREE_CU_CORE_PFN_DECL(cuDeviceGetAttribute, int*, CUdevice_attribute,
+                      CUdevice)
+IREE_CU_CORE_PFN_DECL(cuDeviceGetUuid, CUuuid*, CUdevice)
+IREE_CU_PFN_DECL(cuDeviceCanAccessPeer, int*, CUdevice, CUdevice)
 IREE_CU_PFN_DECL(cuEventCreate, CUevent*, unsigned int)
 IREE_CU_PFN_DECL(cuEventDestroy, CUevent)
 IREE_CU_PFN_DECL(cuEventElapsedTime, float*, CUevent, CUevent)
 IREE_CU_PFN_DECL(cuEventQuery, CUevent)
 IREE_CU_PFN_DECL(cuEventRecord, CUevent, CUstream)
 IREE_CU_PFN_DECL(cuEventSynchronize, CUevent)
-IREE_CU_PFN_DECL(cuGetProcAddress, const char*, void**, int, cuuint64_t)
+IREE_CU_CORE_PFN_DECL(cuGetProcAddress, const char*, void**, int, cuuint64_t)
 IREE_CU_PFN_DECL(cuGraphAddEmptyNode, CUgraphNode*, CUgraph, const CUgraphNode*,
                  size_t)
 IREE_CU_PFN_DECL(cuGraphAddEventRecordNode, CUgraphNode*, CUgraph,
@@ -42,16 +52,19 @@ IREE_CU_PFN_DECL(cuGraphAddKernelNode, CUgraphNode*, CUgraph,
 IREE_CU_PFN_DECL(cuGraphCreate, CUgraph*, unsigned int)
 IREE_CU_PFN_DECL(cuGraphDestroy, CUgraph)
 IREE_CU_PFN_DECL(cuGraphExecDestroy, CUgraphExec)
+IREE_CU_PFN_DECL(cuGraphExecUpdate, CUgraphExec, CUgraph, CUgraphNode*,
+                 CUgraphExecUpdateResult*)
 IREE_CU_PFN_DECL(cuGraphGetNodes, CUgraph, CUgraphNode*, size_t*)
 IREE_CU_PFN_DECL(cuGraphInstantiate, CUgraphExec*, CUgraph, CUgraphNode*, char*,
                  size_t)
 IREE_CU_PFN_DECL(cuGraphLaunch, CUgraphExec, CUstream)
-IREE_CU_PFN_DECL(cuInit, unsigned int)
+IREE_CU_CORE_PFN_DECL(cuInit, unsigned int)
 IREE_CU_PFN_DECL(cuMemAllocManaged, CUdeviceptr*, size_t, unsigned int)
 IREE_CU_PFN_DECL(cuMemPrefetchAsync, CUdeviceptr, size_t, CUdevice, CUstream)
 IREE_CU_PFN_DECL(cuMemAlloc, CUdeviceptr*, size_t)
 IREE_CU_PFN_DECL(cuMemFree, CUdeviceptr)
 IREE_CU_PFN_DECL(cuMemFreeHost, void*)
+IREE_CU_PFN_DECL(cuMemGetInfo, size_t*, size_t*)
 IREE_CU_PFN_DECL(cuMemHostAlloc, void**, size_t, unsigned int)
 IREE_CU_PFN_DECL(cuMemHostRegister, void*, size_t, unsigned int)
 IREE_CU_PFN_DECL(cuMemHostUnregister, void*)
@@ -68,11 +81,25 @@ IREE_CU_PFN_DECL(cuMemPoolTrimTo, CUmemoryPool, size_t)
 IREE_CU_PFN_DECL(cuMemAllocFromPoolAsync, CUdeviceptr*, size_t, CUmemoryPool,
                  CUstream)
 IREE_CU_PFN_DECL(cuMemFreeAsync, CUdeviceptr dptr, CUstream hStream)
+IREE_CU_PFN_DECL(cuMemAddressReserve, CUdeviceptr*, size_t, size_t, CUdeviceptr,
+                 unsigned long long)
+IREE_CU_PFN_DECL(cuMemAddressFree, CUdeviceptr, size_t)
+IREE_CU_PFN_DECL(cuMemCreate, CUmemGenericAllocationHandle*, size_t,
+                 const CUmemAllocationProp*, unsigned long long)
+IREE_CU_PFN_DECL(cuMemRelease, CUmemGenericAllocationHandle)
+IREE_CU_PFN_DECL(cuMemMap, CUdeviceptr, size_t, size_t,
+                 CUmemGenericAllocationHandle, unsigned long long)
+IREE_CU_PFN_DECL(cuMemUnmap, CUdeviceptr, size_t)
+IREE_CU_PFN_DECL(cuMemSetAccess, CUdeviceptr, size_t, const CUmemAccessDesc*,
+                 size_t)
+IREE_CU_PFN_DECL(cuMemGetAllocationGranularity, size_t*,
+                 const CUmemAllocationProp*, CUmemAllocationGranularity_flags)
 IREE_CU_PFN_DECL(cuModuleGetFunction, CUfunction*, CUmodule, const char*)
 IREE_CU_PFN_DECL(cuModuleLoadDataEx, CUmodule*, const void*, unsigned int,
                  CUjit_option*, void**)
 IREE_CU_PFN_DECL(cuModuleUnload, CUmodule)
 IREE_CU_PFN_DECL(cuStreamCreate, CUstream*, unsigned int)
+IREE_CU_PFN_DECL(cuStreamCreateWithPriority, CUstream*, unsigned int, int)
 IREE_CU_PFN_DECL(cuStreamDestroy, CUstream)
 IREE_CU_PFN_DECL(cuStreamSynchronize, CUstream)
 IREE_CU_PFN_DECL(cuStreamWaitEvent, CUstream, CUevent, unsigned int)
@@ -84,6 +111,10 @@ IREE_CU_PFN_DECL(cuMemsetD8Async, unsigned long long, unsigned char, size_t,
                  CUstream)
 IREE_CU_PFN_DECL(cuMemcpyAsync, CUdeviceptr, CUdeviceptr, size_t, CUstream)
 IREE_CU_PFN_DECL(cuMemcpyHtoDAsync, CUdeviceptr, const void*, size_t, CUstream)
+IREE_CU_PFN_DECL(cuMemcpyPeerAsync, CUdeviceptr, CUcontext, CUdeviceptr,
+                 CUcontext, size_t, CUstream)
+IREE_CU_PFN_DECL(cuPointerGetAttribute, void*, CUpointer_attribute,
+                 CUdeviceptr)
 IREE_CU_PFN_DECL(cuFuncSetAttribute, CUfunction, CUfunction_attribute, int)
 IREE_CU_PFN_DECL(cuLaunchKernel, CUfunction, unsigned int, unsigned int,
                  unsigned int, unsigned int, unsigned int, unsigned int,
@@ -24,16 +24,8 @@ static const char* iree_hal_cuda_dylib_names[] = {
 // 1000 * major + 10 * minor
 #define IREE_CUDA_DRIVER_API_VERSION 11030
 
-// Load CUDA entry points.
-static iree_status_t iree_hal_cuda_dynamic_symbols_resolve_all(
-    iree_hal_cuda_dynamic_symbols_t* syms) {
-  // Since cuGetProcAddress is in the symbol table, it will be loaded again
-  // through cuGetProcAddress. cuGetProcAddress_v2 is added in CUDA 12.0 and has
-  // a new function signature. If IREE_CUDA_DRIVER_API_VERSION is increased to
-  // >=12.0, then make sure we are using the correct signature.
-  IREE_RETURN_IF_ERROR(iree_dynamic_library_lookup_symbol(
-      syms->dylib, "cuGetProcAddress", (void**)&syms->cuGetProcAddress));
-#define IREE_CU_PFN_DECL(cuda_symbol_name, ...)                         \
+// Resolves |cuda_symbol_name| into |syms| using cuGetProcAddress.
+#define IREE_CU_RESOLVE_SYMBOL(syms, cuda_symbol_name)                  \
   {                                                                     \
     static const char* name = #cuda_symbol_name;                        \
     IREE_CUDA_RETURN_IF_ERROR(                                          \
@@ -43,8 +35,34 @@ static iree_status_t iree_hal_cuda_dynamic_symbols_resolve_all(
                          CU_GET_PROC_ADDRESS_DEFAULT),                  \
         "when resolving " #cuda_symbol_name " using cuGetProcAddress"); \
   }
+
+// Load the core CUDA entry points required to initialize and query devices.
+static iree_status_t iree_hal_cuda_dynamic_symbols_resolve_core(
+    iree_hal_cuda_dynamic_symbols_t* syms) {
+  // Since cuGetProcAddress is in the symbol table, it will be loaded again
+  // through cuGetProcAddress. cuGetProcAddress_v2 is added in CUDA 12.0 and has
+  // a new function signature. If IREE_CUDA_DRIVER_API_VERSION is increased to
+  // >=12.0, then make sure we are using the correct signature.
+  IREE_RETURN_IF_ERROR(iree_dynamic_library_lookup_symbol(
+      syms->dylib, "cuGetProcAddress", (void**)&syms->cuGetProcAddress));
+#define IREE_CU_PFN_DECL(cuda_symbol_name, ...)
+#define IREE_CU_CORE_PFN_DECL(cuda_symbol_name, ...) \
+  IREE_CU_RESOLVE_SYMBOL(syms, cuda_symbol_name)
 #include "iree/hal/drivers/cuda/cuda_dynamic_symbol_table.h"  // IWYU pragma: keep
 #undef IREE_CU_PFN_DECL
+#undef IREE_CU_CORE_PFN_DECL
+  return iree_ok_status();
+}
+
+// Load the remaining CUDA entry points used by devices.
+static iree_status_t iree_hal_cuda_dynamic_symbols_resolve_device(
+    iree_hal_cuda_dynamic_symbols_t* syms) {
+#define IREE_CU_PFN_DECL(cuda_symbol_name, ...) \
+  IREE_CU_RESOLVE_SYMBOL(syms, cuda_symbol_name)
+#define IREE_CU_CORE_PFN_DECL(cuda_symbol_name, ...)
+#include "iree/hal/drivers/cuda/cuda_dynamic_symbol_table.h"  // IWYU pragma: keep
+#undef IREE_CU_PFN_DECL
+#undef IREE_CU_CORE_PFN_DECL
   return iree_ok_status();
 }
 
@@ -66,7 +84,7 @@ iree_status_t iree_hal_cuda_dynamic_symbols_initialize(
         "ensure installed and in dynamic library search path");
   }
   if (iree_status_is_ok(status)) {
-    status = iree_hal_cuda_dynamic_symbols_resolve_all(out_syms);
+    status = iree_hal_cuda_dynamic_symbols_resolve_core(out_syms);
   }
   if (!iree_status_is_ok(status)) {
     iree_hal_cuda_dynamic_symbols_deinitialize(out_syms);
@@ -85,3 +103,16 @@ void iree_hal_cuda_dynamic_symbols_deinitialize(
 
   IREE_TRACE_ZONE_END(z0);
 }
+
+iree_status_t iree_hal_cuda_dynamic_symbols_resolve_device_symbols(
+    iree_hal_cuda_dynamic_symbols_t* syms) {
+  IREE_ASSERT_ARGUMENT(syms);
+  if (syms->device_symbols_resolved) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_hal_cuda_dynamic_symbols_resolve_device(syms);
+  syms->device_symbols_resolved = iree_status_is_ok(status);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
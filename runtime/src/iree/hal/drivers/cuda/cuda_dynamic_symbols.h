@@ -19,17 +19,27 @@ extern "C" {
 // API. We load all the symbols in `cuda_dynamic_symbol_table.h` and fail if any
 // of the symbol is not available. The functions signatures are matching the
 // declarations in `cuda.h`.
+//
+// Only the core symbols required to initialize CUDA and enumerate devices are
+// resolved on initialization. The remaining symbols must be resolved with
+// iree_hal_cuda_dynamic_symbols_resolve_device_symbols before creating devices.
 
 // CUDA driver API dynamic symbols.
 typedef struct iree_hal_cuda_dynamic_symbols_t {
   // The dynamic library handle.
   iree_dynamic_library_t* dylib;
 
+  // True once the non-core device symbols have been resolved.
+  bool device_symbols_resolved;
+
   // Concrete CUDA symbols defined by including the `dynamic_symbol_tables.h`.
 #define IREE_CU_PFN_DECL(cudaSymbolName, ...) \
   CUresult (*cudaSymbolName)(__VA_ARGS__);
+#define IREE_CU_CORE_PFN_DECL(cudaSymbolName, ...) \
+  CUresult (*cudaSymbolName)(__VA_ARGS__);
 #include "iree/hal/drivers/cuda/cuda_dynamic_symbol_table.h"  // IWYU pragma: export
 #undef IREE_CU_PFN_DECL
+#undef IREE_CU_CORE_PFN_DECL
 } iree_hal_cuda_dynamic_symbols_t;
 
 // Initializes |out_syms| in-place with dynamically loaded CUDA symbols.
@@ -38,6 +48,13 @@ typedef struct iree_hal_cuda_dynamic_symbols_t {
 iree_status_t iree_hal_cuda_dynamic_symbols_initialize(
     iree_allocator_t host_allocator, iree_hal_cuda_dynamic_symbols_t* out_syms);
 
+// Resolves all symbols not resolved by iree_hal_cuda_dynamic_symbols_initialize
+// as required by devices. No-op if the symbols have already been resolved.
+// Not thread-safe: callers must ensure exclusive access to |syms| until
+// resolution has completed.
+iree_status_t iree_hal_cuda_dynamic_symbols_resolve_device_symbols(
+    iree_hal_cuda_dynamic_symbols_t* syms);
+
 // Deinitializes |syms| by unloading the backing library. All function pointers
 // will be invalidated. They _may_ still work if there are other reasons the
 // library remains loaded so be careful.
@@ -10,6 +10,7 @@
 #include "iree/hal/drivers/cuda/cuda_dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/nccl_dynamic_symbols.h"
 #include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
 
 namespace iree {
 namespace hal {
@@ -40,6 +41,14 @@ TEST(DynamicSymbolsTest, CreateFromSystemLoader) {
     CUDA_CHECK_ERRORS(symbols.cuDeviceGet(&device, /*ordinal=*/0));
   }
 
+  // Device symbols are only resolved on request.
+  EXPECT_EQ(nullptr, symbols.cuStreamCreate);
+  IREE_ASSERT_OK(
+      iree_hal_cuda_dynamic_symbols_resolve_device_symbols(&symbols));
+  EXPECT_NE(nullptr, symbols.cuStreamCreate);
+  IREE_ASSERT_OK(
+      iree_hal_cuda_dynamic_symbols_resolve_device_symbols(&symbols));
+
   iree_hal_cuda_dynamic_symbols_deinitialize(&symbols);
 }
 
@@ -75,6 +84,40 @@ TEST(NCCLDynamicSymbolsTest, CreateFromSystemLoader) {
   iree_hal_cuda_dynamic_symbols_deinitialize(&cuda_symbols);
 }
 
+TEST(NCCLDynamicSymbolsTest, LazilyLoaded) {
+  iree_hal_cuda_dynamic_symbols_t cuda_symbols;
+  iree_status_t status = iree_hal_cuda_dynamic_symbols_initialize(
+      iree_allocator_system(), &cuda_symbols);
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_ignore(status);
+    GTEST_SKIP() << "CUDA symbols cannot be loaded, skipping test.";
+  }
+
+  iree_hal_cuda_nccl_lazy_dynamic_symbols_t lazy_symbols;
+  iree_hal_cuda_nccl_lazy_dynamic_symbols_initialize(
+      iree_allocator_system(), &cuda_symbols, &lazy_symbols);
+  EXPECT_EQ(nullptr, lazy_symbols.symbols.dylib);
+
+  const iree_hal_cuda_nccl_dynamic_symbols_t* nccl_symbols = NULL;
+  status = iree_hal_cuda_nccl_lazy_dynamic_symbols_resolve(&lazy_symbols,
+                                                           &nccl_symbols);
+  if (iree_status_is_ok(status)) {
+    ASSERT_EQ(&lazy_symbols.symbols, nccl_symbols);
+    const iree_hal_cuda_nccl_dynamic_symbols_t* resolved_symbols = NULL;
+    IREE_ASSERT_OK(iree_hal_cuda_nccl_lazy_dynamic_symbols_resolve(
+        &lazy_symbols, &resolved_symbols));
+    EXPECT_EQ(nccl_symbols, resolved_symbols);
+  } else {
+    EXPECT_TRUE(iree_status_is_unavailable(status));
+    EXPECT_EQ(nullptr, nccl_symbols);
+    iree_status_ignore(status);
+  }
+
+  iree_hal_cuda_nccl_lazy_dynamic_symbols_deinitialize(&lazy_symbols);
+  iree_hal_cuda_dynamic_symbols_deinitialize(&cuda_symbols);
+}
+
 }  // namespace
 }  // namespace cuda
 }  // namespace hal
@@ -10,11 +10,13 @@
 #include <stdint.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/drivers/cuda/cuda_buffer.h"
 #include "iree/hal/drivers/cuda/cuda_dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/cuda_status_util.h"
 #include "iree/hal/drivers/cuda/native_executable.h"
 #include "iree/hal/utils/collective_batch.h"
+#include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/resource_set.h"
 #include "iree/hal/utils/stream_tracing.h"
 
@@ -22,6 +24,17 @@
 // barriers.
 #define IREE_HAL_CUDA_MAX_CONCURRENT_GRAPH_NODE_COUNT 32
 
+// Internal flags controlling how a graph command buffer is materialized.
+enum iree_hal_cuda_graph_command_buffer_flag_bits_e {
+  IREE_HAL_CUDA_GRAPH_COMMAND_BUFFER_FLAG_NONE = 0u,
+  // The graph is only used to update the executable graph of an indirect
+  // command buffer with cuGraphExecUpdate: it is not instantiated on end() and
+  // host data passed to update_buffer is referenced instead of copied as it is
+  // owned by the indirect command buffer recording and outlives all launches.
+  IREE_HAL_CUDA_GRAPH_COMMAND_BUFFER_FLAG_TRANSIENT = 1u << 0,
+};
+typedef uint32_t iree_hal_cuda_graph_command_buffer_flags_t;
+
 // Command buffer implementation that directly records into CUDA graphs.
 // The command buffer records the commands on the calling thread without
 // additional threading indirection.
@@ -29,6 +42,9 @@ typedef struct iree_hal_cuda_graph_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
   const iree_hal_cuda_dynamic_symbols_t* symbols;
+  iree_hal_allocator_t* device_allocator;
+  iree_arena_block_pool_t* block_pool;
+  iree_hal_cuda_graph_command_buffer_flags_t flags;
 
   // Per-stream CUDA tracing context.
   iree_hal_stream_tracing_context_t* tracing_context;
@@ -57,6 +73,19 @@ typedef struct iree_hal_cuda_graph_command_buffer_t {
 
   // Iteratively constructed batch of collective operations.
   iree_hal_collective_batch_t collective_batch;
+
+  // Recording of an indirect command buffer (binding_capacity > 0).
+  // Commands referencing binding table slots cannot be turned into graph nodes
+  // until the binding table is provided at submission time. The recording is
+  // replayed into a transient graph on each launch and that graph is used to
+  // update |cu_graph_exec| in place so that only the first launch pays for
+  // instantiation.
+  iree_hal_command_buffer_t* deferred_command_buffer;
+
+  // Guards updates to |cu_graph_exec| of indirect command buffers so that
+  // concurrent submissions of the same command buffer launch the parameters
+  // they resolved.
+  iree_slim_mutex_t launch_mutex;
 } iree_hal_cuda_graph_command_buffer_t;
 
 static const iree_hal_command_buffer_vtable_t
@@ -158,25 +187,19 @@ static void iree_cuda_graph_command_buffer_trace_zone_end(
 #define IREE_CUDA_GRAPH_COMMAND_BUFFER_TRACE_ZONE_END(command_buffer, verbosity)
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 
-iree_status_t iree_hal_cuda_graph_command_buffer_create(
+static iree_status_t iree_hal_cuda_graph_command_buffer_create_internal(
     iree_hal_allocator_t* device_allocator,
     const iree_hal_cuda_dynamic_symbols_t* cuda_symbols,
     iree_hal_stream_tracing_context_t* tracing_context, CUcontext context,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_cuda_graph_command_buffer_flags_t flags,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(block_pool);
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
-
-  if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
-  }
-
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_cuda_graph_command_buffer_t* command_buffer = NULL;
@@ -194,15 +217,20 @@ iree_status_t iree_hal_cuda_graph_command_buffer_create(
       &iree_hal_cuda_graph_command_buffer_vtable, &command_buffer->base);
   command_buffer->host_allocator = host_allocator;
   command_buffer->symbols = cuda_symbols;
+  command_buffer->device_allocator = device_allocator;
+  command_buffer->block_pool = block_pool;
+  command_buffer->flags = flags;
   command_buffer->tracing_context = tracing_context;
-  command_buffer->tracing_event_list.head = NULL;
-  command_buffer->tracing_event_list.tail = NULL;
+  iree_hal_stream_tracing_context_event_list_initialize(
+      &command_buffer->tracing_event_list);
   iree_arena_initialize(block_pool, &command_buffer->arena);
   command_buffer->cu_context = context;
   command_buffer->cu_graph = NULL;
   command_buffer->cu_graph_exec = NULL;
   command_buffer->cu_barrier_node = NULL;
   command_buffer->graph_node_count = 0;
+  command_buffer->deferred_command_buffer = NULL;
+  iree_slim_mutex_initialize(&command_buffer->launch_mutex);
 
   iree_status_t status =
       iree_hal_resource_set_allocate(block_pool, &command_buffer->resource_set);
@@ -213,6 +241,12 @@ iree_status_t iree_hal_cuda_graph_command_buffer_create(
                                          &command_buffer->collective_batch);
   }
 
+  if (iree_status_is_ok(status) && binding_capacity > 0) {
+    status = iree_hal_deferred_command_buffer_create(
+        device_allocator, mode, command_categories, binding_capacity,
+        block_pool, host_allocator, &command_buffer->deferred_command_buffer);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_command_buffer = &command_buffer->base;
   } else {
@@ -223,6 +257,22 @@ iree_status_t iree_hal_cuda_graph_command_buffer_create(
   return status;
 }
 
+iree_status_t iree_hal_cuda_graph_command_buffer_create(
+    iree_hal_allocator_t* device_allocator,
+    const iree_hal_cuda_dynamic_symbols_t* cuda_symbols,
+    iree_hal_stream_tracing_context_t* tracing_context, CUcontext context,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  return iree_hal_cuda_graph_command_buffer_create_internal(
+      device_allocator, cuda_symbols, tracing_context, context, mode,
+      command_categories, queue_affinity, binding_capacity,
+      IREE_HAL_CUDA_GRAPH_COMMAND_BUFFER_FLAG_NONE, block_pool, host_allocator,
+      out_command_buffer);
+}
+
 static void iree_hal_cuda_graph_command_buffer_destroy(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
@@ -249,6 +299,9 @@ static void iree_hal_cuda_graph_command_buffer_destroy(
   command_buffer->cu_barrier_node = NULL;
   command_buffer->graph_node_count = 0;
 
+  iree_hal_command_buffer_release(command_buffer->deferred_command_buffer);
+  iree_slim_mutex_deinitialize(&command_buffer->launch_mutex);
+
   iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
   iree_hal_resource_set_free(command_buffer->resource_set);
   iree_arena_deinitialize(&command_buffer->arena);
@@ -282,6 +335,105 @@ void iree_hal_cuda_graph_tracing_notify_submitted_commands(
                                            &command_buffer->tracing_event_list);
 }
 
+// Updates the executable graph of |command_buffer| to match |cu_graph|.
+// The first call instantiates the executable graph and subsequent calls update
+// node parameters in place. If the update is rejected (e.g. resolved bindings
+// changed memory types) the executable graph is instantiated again.
+static iree_status_t iree_hal_cuda_graph_command_buffer_update_exec(
+    iree_hal_cuda_graph_command_buffer_t* command_buffer, CUgraph cu_graph) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (command_buffer->cu_graph_exec != NULL) {
+    CUgraphNode error_node = NULL;
+    CUgraphExecUpdateResult update_result = CU_GRAPH_EXEC_UPDATE_SUCCESS;
+    CUresult result = command_buffer->symbols->cuGraphExecUpdate(
+        command_buffer->cu_graph_exec, cu_graph, &error_node, &update_result);
+    if (IREE_LIKELY(result == CUDA_SUCCESS)) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
+    }
+    IREE_CUDA_IGNORE_ERROR(command_buffer->symbols,
+                           cuGraphExecDestroy(command_buffer->cu_graph_exec));
+    command_buffer->cu_graph_exec = NULL;
+  }
+
+  CUgraphNode error_node = NULL;
+  IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, command_buffer->symbols,
+      cuGraphInstantiate(&command_buffer->cu_graph_exec, cu_graph, &error_node,
+                         /*logBuffer=*/NULL,
+                         /*bufferSize=*/0),
+      "cuGraphInstantiate");
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_cuda_graph_command_buffer_launch(
+    iree_hal_command_buffer_t* base_command_buffer,
+    iree_hal_buffer_binding_table_t binding_table, CUstream stream) {
+  iree_hal_cuda_graph_command_buffer_t* command_buffer =
+      iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+
+  // Direct command buffers were fully instantiated when recording ended.
+  if (!command_buffer->deferred_command_buffer) {
+    IREE_CUDA_RETURN_IF_ERROR(
+        command_buffer->symbols,
+        cuGraphLaunch(command_buffer->cu_graph_exec, stream), "cuGraphLaunch");
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Resolve the binding table by replaying the recording into a transient
+  // graph. Constructing the graph is cheap compared to instantiating it and
+  // the topology is identical across submissions so the executable graph can
+  // be updated in place. Validation is required as the bindings were not known
+  // at the time the commands were recorded.
+  iree_hal_command_buffer_mode_t mode =
+      iree_hal_command_buffer_mode(base_command_buffer) |
+      IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT;
+  if (iree_hal_buffer_binding_table_is_empty(binding_table)) {
+    mode |= IREE_HAL_COMMAND_BUFFER_MODE_UNVALIDATED;
+  }
+  iree_hal_command_buffer_t* transient_command_buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_hal_cuda_graph_command_buffer_create_internal(
+          command_buffer->device_allocator, command_buffer->symbols,
+          /*tracing_context=*/NULL, command_buffer->cu_context, mode,
+          iree_hal_command_buffer_allowed_categories(base_command_buffer),
+          base_command_buffer->queue_affinity, /*binding_capacity=*/0,
+          IREE_HAL_CUDA_GRAPH_COMMAND_BUFFER_FLAG_TRANSIENT,
+          command_buffer->block_pool, command_buffer->host_allocator,
+          &transient_command_buffer));
+  iree_status_t status = iree_hal_deferred_command_buffer_apply(
+      command_buffer->deferred_command_buffer, transient_command_buffer,
+      binding_table);
+
+  // Node parameters are captured by the executable graph during the update so
+  // the transient graph can be dropped as soon as the launch is issued. Any
+  // buffers it references are kept live by the submission.
+  if (iree_status_is_ok(status)) {
+    iree_slim_mutex_lock(&command_buffer->launch_mutex);
+    status = iree_hal_cuda_graph_command_buffer_update_exec(
+        command_buffer,
+        iree_hal_cuda_graph_command_buffer_cast(transient_command_buffer)
+            ->cu_graph);
+    if (iree_status_is_ok(status)) {
+      status = IREE_CURESULT_TO_STATUS(
+          command_buffer->symbols,
+          cuGraphLaunch(command_buffer->cu_graph_exec, stream),
+          "cuGraphLaunch");
+    }
+    iree_slim_mutex_unlock(&command_buffer->launch_mutex);
+  }
+
+  iree_hal_command_buffer_release(transient_command_buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Flushes any pending batched collective operations.
 // Must be called before any other non-collective nodes are added to the graph
 // or a barrier is encountered.
@@ -327,6 +479,10 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_begin(
+        command_buffer->deferred_command_buffer);
+  }
 
   if (command_buffer->cu_graph != NULL) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
@@ -348,6 +504,9 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_end(command_buffer->deferred_command_buffer);
+  }
 
   // Flush any pending collective batches.
   IREE_RETURN_IF_ERROR(
@@ -360,6 +519,14 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end(
   command_buffer->cu_barrier_node = NULL;
   command_buffer->graph_node_count = 0;
 
+  iree_hal_resource_set_freeze(command_buffer->resource_set);
+
+  // Transient graphs are retained for updating an existing executable graph.
+  if (command_buffer->flags &
+      IREE_HAL_CUDA_GRAPH_COMMAND_BUFFER_FLAG_TRANSIENT) {
+    return iree_ok_status();
+  }
+
   // Compile the graph.
   CUgraphNode error_node = NULL;
   iree_status_t status = IREE_CURESULT_TO_STATUS(
@@ -375,9 +542,7 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end(
     command_buffer->cu_graph = NULL;
   }
 
-  iree_hal_resource_set_freeze(command_buffer->resource_set);
-
-  return iree_ok_status();
+  return status;
 }
 
 static iree_status_t iree_hal_cuda_graph_command_buffer_begin_debug_group(
@@ -386,6 +551,10 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_begin_debug_group(
     const iree_hal_label_location_t* location) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_begin_debug_group(
+        command_buffer->deferred_command_buffer, label, label_color, location);
+  }
 
   (void)command_buffer;
   IREE_CUDA_GRAPH_COMMAND_BUFFER_TRACE_ZONE_BEGIN_EXTERNAL(
@@ -401,6 +570,10 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_end_debug_group(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_end_debug_group(
+        command_buffer->deferred_command_buffer);
+  }
   (void)command_buffer;
   IREE_CUDA_GRAPH_COMMAND_BUFFER_TRACE_ZONE_END(
       command_buffer, IREE_HAL_STREAM_TRACING_VERBOSITY_COARSE);
@@ -446,6 +619,12 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_execution_barrier(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_execution_barrier(
+        command_buffer->deferred_command_buffer, source_stage_mask,
+        target_stage_mask, flags, memory_barrier_count, memory_barriers,
+        buffer_barrier_count, buffer_barriers);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_status_t status =
@@ -517,6 +696,11 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_fill_buffer(
     iree_host_size_t pattern_length, iree_hal_fill_flags_t flags) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_fill_buffer(
+        command_buffer->deferred_command_buffer, target_ref, pattern,
+        pattern_length, flags);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_CUDA_GRAPH_COMMAND_BUFFER_TRACE_ZONE_BEGIN(
       command_buffer, IREE_HAL_STREAM_TRACING_VERBOSITY_FINE);
@@ -570,6 +754,11 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_update_buffer(
     iree_hal_update_flags_t flags) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_update_buffer(
+        command_buffer->deferred_command_buffer, source_buffer, source_offset,
+        target_ref, flags);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_CUDA_GRAPH_COMMAND_BUFFER_TRACE_ZONE_BEGIN(
       command_buffer, IREE_HAL_STREAM_TRACING_VERBOSITY_FINE);
@@ -582,13 +771,18 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_update_buffer(
   // memory at the time the method is called in case the caller wants to reuse
   // the memory. Because CUDA memcpys are async if we didn't copy it's possible
   // for the reused memory to change before the stream reaches the copy
-  // operation and get the wrong data.
-  uint8_t* storage = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_arena_allocate(&command_buffer->arena, target_ref.length,
-                              (void**)&storage));
-  memcpy(storage, (const uint8_t*)source_buffer + source_offset,
-         target_ref.length);
+  // operation and get the wrong data. Transient graphs are replayed from a
+  // recording that already owns a copy for the lifetime of all launches.
+  const uint8_t* storage = (const uint8_t*)source_buffer + source_offset;
+  if (!(command_buffer->flags &
+        IREE_HAL_CUDA_GRAPH_COMMAND_BUFFER_FLAG_TRANSIENT)) {
+    uint8_t* storage_copy = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_allocate(&command_buffer->arena, target_ref.length,
+                                (void**)&storage_copy));
+    memcpy(storage_copy, storage, target_ref.length);
+    storage = storage_copy;
+  }
 
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_resource_set_insert(command_buffer->resource_set, 1,
@@ -635,6 +829,10 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_copy_buffer(
     iree_hal_copy_flags_t flags) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_copy_buffer(
+        command_buffer->deferred_command_buffer, source_ref, target_ref, flags);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_CUDA_GRAPH_COMMAND_BUFFER_TRACE_ZONE_BEGIN(
       command_buffer, IREE_HAL_STREAM_TRACING_VERBOSITY_FINE);
@@ -696,6 +894,11 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_collective(
     iree_hal_buffer_ref_t recv_ref, iree_device_size_t element_count) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_collective(
+        command_buffer->deferred_command_buffer, channel, op, param, send_ref,
+        recv_ref, element_count);
+  }
   iree_hal_buffer_binding_t send_binding = {
       .buffer = send_ref.buffer,
       .offset = send_ref.offset,
@@ -718,6 +921,11 @@ static iree_status_t iree_hal_cuda_graph_command_buffer_dispatch(
     iree_hal_buffer_ref_list_t bindings, iree_hal_dispatch_flags_t flags) {
   iree_hal_cuda_graph_command_buffer_t* command_buffer =
       iree_hal_cuda_graph_command_buffer_cast(base_command_buffer);
+  if (command_buffer->deferred_command_buffer) {
+    return iree_hal_command_buffer_dispatch(
+        command_buffer->deferred_command_buffer, executable, entry_point,
+        workgroup_count, constants, bindings, flags);
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
 
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
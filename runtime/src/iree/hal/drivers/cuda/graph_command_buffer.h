@@ -22,6 +22,12 @@ typedef struct iree_hal_stream_tracing_context_t
 
 // Creates a command buffer that records into a CUDA graph.
 //
+// Command buffers with a |binding_capacity| record their commands and resolve
+// the binding table provided at submission time with
+// iree_hal_cuda_graph_command_buffer_launch. The executable graph is
+// instantiated on the first launch and updated in place on subsequent launches
+// so that reusable indirect command buffers avoid graph instantiation costs.
+//
 // |block_pool| will be used by the graph command buffer to retain copies of
 // input data until reset. It must remain live for the lifetime of the command
 // buffers that use it.
@@ -40,9 +46,17 @@ bool iree_hal_cuda_graph_command_buffer_isa(
     iree_hal_command_buffer_t* command_buffer);
 
 // Returns the native CUDA graph associated to the command buffer.
+// Indirect command buffers have no executable graph until first launched.
 CUgraphExec iree_hal_cuda_graph_command_buffer_handle(
     iree_hal_command_buffer_t* command_buffer);
 
+// Launches |command_buffer| on |stream| with |binding_table| used to resolve
+// any indirect buffer references. Safe to call concurrently from multiple
+// queues with the same command buffer.
+iree_status_t iree_hal_cuda_graph_command_buffer_launch(
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table, CUstream stream);
+
 // This is to be called after the given |command_buffer| has been submitted
 // in order to notify the tracing system that there are events to collect.
 void iree_hal_cuda_graph_tracing_notify_submitted_commands(
@@ -38,6 +38,15 @@ typedef struct iree_hal_cuda_nccl_channel_t {
   // Communicator handle.
   ncclComm_t comm;
 
+  // Maximum size in bytes of a bucket of fused all-reduce operations.
+  // 0 if bucketing is disabled.
+  iree_device_size_t bucket_size;
+  // Device staging buffer of |bucket_size| bytes allocated on first use.
+  // Buckets are issued in stream order and the same staging buffer is reused
+  // by each; as with the communicator itself the channel must not be used
+  // concurrently from multiple streams.
+  CUdeviceptr staging_buffer;
+
   // Hash of the unique ID used to create the communicator.
   // This is consistent with the hashes NCCL itself uses for logging but is not
   // guaranteed to be unique - only use for informational purposes.
@@ -95,7 +104,8 @@ iree_status_t iree_hal_cuda_nccl_channel_create(
     const iree_hal_cuda_dynamic_symbols_t* cuda_symbols,
     const iree_hal_cuda_nccl_dynamic_symbols_t* nccl_symbols,
     const iree_hal_cuda_nccl_id_t* id, int rank, int count,
-    iree_allocator_t host_allocator, iree_hal_channel_t** out_channel) {
+    iree_device_size_t bucket_size, iree_allocator_t host_allocator,
+    iree_hal_channel_t** out_channel) {
   IREE_ASSERT_ARGUMENT(cuda_symbols);
   IREE_ASSERT_ARGUMENT(nccl_symbols);
   IREE_ASSERT_ARGUMENT(id);
@@ -107,6 +117,7 @@ iree_status_t iree_hal_cuda_nccl_channel_create(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, id_hash);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, rank);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, count);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, bucket_size);
 
   ncclComm_t comm = NULL;
   ncclConfig_t config = NCCL_CONFIG_INITIALIZER;
@@ -132,6 +143,8 @@ iree_status_t iree_hal_cuda_nccl_channel_create(
   channel->rank = rank;
   channel->count = count;
   channel->comm = comm;
+  channel->bucket_size = bucket_size;
+  channel->staging_buffer = 0;
   IREE_TRACE(channel->id_hash = id_hash);
   *out_channel = (iree_hal_channel_t*)channel;
 
@@ -167,6 +180,11 @@ static void iree_hal_cuda_nccl_channel_destroy(
 
   IREE_NCCL_IGNORE_ERROR(channel->nccl_symbols, ncclCommDestroy(channel->comm));
 
+  if (channel->staging_buffer) {
+    IREE_CUDA_IGNORE_ERROR(channel->cuda_symbols,
+                           cuMemFree(channel->staging_buffer));
+  }
+
   iree_hal_channel_release(channel->parent_channel);
   iree_allocator_free(host_allocator, channel);
 
@@ -221,6 +239,8 @@ static iree_status_t iree_hal_cuda_nccl_channel_split(
     split_channel->rank = split_rank;
     split_channel->count = split_count;
     split_channel->comm = split_comm;
+    split_channel->bucket_size = channel->bucket_size;
+    split_channel->staging_buffer = 0;
     *out_split_channel = (iree_hal_channel_t*)split_channel;
   }
 
@@ -539,6 +559,96 @@ static iree_status_t iree_hal_cuda_nccl_submit_batch_entry(
   return iree_ok_status();
 }
 
+// Returns the device pointer of the range referenced by |binding|.
+static CUdeviceptr iree_hal_cuda_nccl_binding_device_pointer(
+    iree_hal_buffer_binding_t binding) {
+  return iree_hal_cuda_buffer_device_pointer(
+             iree_hal_buffer_allocated_buffer(binding.buffer)) +
+         iree_hal_buffer_byte_offset(binding.buffer) + binding.offset;
+}
+
+// Returns the bucket size of the channel used by |entry|.
+static iree_device_size_t iree_hal_cuda_nccl_entry_bucket_size(
+    const iree_hal_collective_batch_entry_t* entry) {
+  return iree_hal_cuda_nccl_channel_cast(entry->channel)->bucket_size;
+}
+
+// Issues all entries in |bucket| as a single all-reduce by packing their
+// inputs into the channel staging buffer, reducing the staging buffer in-place,
+// and unpacking the results.
+static iree_status_t iree_hal_cuda_nccl_submit_bucket(
+    const iree_hal_collective_batch_t* batch,
+    const iree_hal_collective_bucket_t* bucket, CUstream stream) {
+  const iree_hal_collective_batch_entry_t* entries =
+      &batch->entries[bucket->entry_index];
+  iree_hal_cuda_nccl_channel_t* channel =
+      iree_hal_cuda_nccl_channel_cast(entries[0].channel);
+  const iree_hal_cuda_dynamic_symbols_t* cuda_symbols = channel->cuda_symbols;
+  const iree_hal_cuda_nccl_dynamic_symbols_t* nccl_symbols =
+      channel->nccl_symbols;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, channel->bucket_size);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, bucket->entry_count);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, bucket->element_count);
+
+  ncclDataType_t datatype;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_cuda_get_nccl_data_type(entries[0].op.element_type,
+                                           &datatype));
+  ncclRedOp_t redop;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_hal_cuda_get_nccl_reduction_type(entries[0].op.reduction, &redop));
+  const iree_device_size_t element_size_bytes =
+      iree_hal_collective_element_byte_count(entries[0].op.element_type);
+
+  if (!channel->staging_buffer) {
+    IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, cuda_symbols,
+        cuMemAlloc(&channel->staging_buffer, channel->bucket_size),
+        "cuMemAlloc");
+  }
+
+  // Pack all inputs contiguously into the staging buffer.
+  iree_device_size_t staging_offset = 0;
+  for (iree_host_size_t i = 0; i < bucket->entry_count; ++i) {
+    const iree_device_size_t length =
+        entries[i].element_count * element_size_bytes;
+    IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, cuda_symbols,
+        cuMemcpyAsync(
+            channel->staging_buffer + staging_offset,
+            iree_hal_cuda_nccl_binding_device_pointer(entries[i].send_binding),
+            length, stream),
+        "cuMemcpyAsync");
+    staging_offset += length;
+  }
+
+  IREE_NCCL_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, nccl_symbols,
+      ncclAllReduce((const void*)channel->staging_buffer,
+                    (void*)channel->staging_buffer, bucket->element_count,
+                    datatype, redop, channel->comm, stream),
+      "ncclAllReduce");
+
+  // Unpack the reduced results to each output.
+  staging_offset = 0;
+  for (iree_host_size_t i = 0; i < bucket->entry_count; ++i) {
+    const iree_device_size_t length =
+        entries[i].element_count * element_size_bytes;
+    IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, cuda_symbols,
+        cuMemcpyAsync(
+            iree_hal_cuda_nccl_binding_device_pointer(entries[i].recv_binding),
+            channel->staging_buffer + staging_offset, length, stream),
+        "cuMemcpyAsync");
+    staging_offset += length;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_cuda_nccl_submit_batch(
     const iree_hal_cuda_nccl_dynamic_symbols_t* symbols,
     iree_hal_stream_tracing_context_t* tracing_context,
@@ -566,12 +676,32 @@ iree_status_t iree_hal_cuda_nccl_submit_batch(
   }
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 
-  // Issue all collective operations in the batch as part of a group.
+  // Issue runs of small all-reduce operations as single operations over the
+  // channel staging buffers. Operations within a batch are independent and
+  // can be reordered but the staging copies must be issued outside of the
+  // group as NCCL defers all grouped operations until ncclGroupEnd.
+  iree_hal_collective_bucket_t bucket;
+  for (iree_host_size_t i = 0; i < batch->count; i += bucket.entry_count) {
+    iree_hal_collective_batch_select_bucket(
+        batch, i, iree_hal_cuda_nccl_entry_bucket_size(&batch->entries[i]),
+        &bucket);
+    if (bucket.entry_count > 1) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_cuda_nccl_submit_bucket(batch, &bucket, stream));
+    }
+  }
+
+  // Issue all remaining collective operations in the batch as part of a group.
   // NCCL may be able to fuse or reduce overheads by issuing like this.
   IREE_NCCL_RETURN_IF_ERROR(symbols, ncclGroupStart(), "ncclGroupStart");
-  for (iree_host_size_t i = 0; i < batch->count; ++i) {
-    IREE_RETURN_IF_ERROR(
-        iree_hal_cuda_nccl_submit_batch_entry(&batch->entries[i], stream));
+  for (iree_host_size_t i = 0; i < batch->count; i += bucket.entry_count) {
+    iree_hal_collective_batch_select_bucket(
+        batch, i, iree_hal_cuda_nccl_entry_bucket_size(&batch->entries[i]),
+        &bucket);
+    if (bucket.entry_count == 1) {
+      IREE_RETURN_IF_ERROR(
+          iree_hal_cuda_nccl_submit_batch_entry(&batch->entries[i], stream));
+    }
   }
   IREE_NCCL_RETURN_IF_ERROR(symbols, ncclGroupEnd(), "ncclGroupEnd");
 
@@ -36,11 +36,18 @@ iree_status_t iree_hal_cuda_nccl_get_unique_id(
 
 // Creates a IREE HAL channel using the given NCCL |id|, |rank|, and |count|.
 // It calls ncclCommInitRankConfig under the hood.
+//
+// Contiguous small all-reduce operations submitted on the channel are packed
+// into a device staging buffer of |bucket_size| bytes and issued as a single
+// all-reduce. A |bucket_size| of 0 disables bucketing. All participants must
+// use the same bucket size so that they issue the same operations. Channels
+// split from the channel inherit its bucket size.
 iree_status_t iree_hal_cuda_nccl_channel_create(
     const iree_hal_cuda_dynamic_symbols_t* cuda_symbols,
     const iree_hal_cuda_nccl_dynamic_symbols_t* nccl_symbols,
     const iree_hal_cuda_nccl_id_t* id, int rank, int count,
-    iree_allocator_t host_allocator, iree_hal_channel_t** out_channel);
+    iree_device_size_t bucket_size, iree_allocator_t host_allocator,
+    iree_hal_channel_t** out_channel);
 
 // Performs a non-blocking submission of |batch| to |stream|.
 // The backing storage of |batch| is dropped immediately but all resources
@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/dynamic_library.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/drivers/cuda/cuda_dynamic_symbols.h"
 #include "iree/hal/drivers/cuda/nccl_headers.h"
 
@@ -50,6 +51,42 @@ iree_status_t iree_hal_cuda_nccl_dynamic_symbols_initialize(
 void iree_hal_cuda_nccl_dynamic_symbols_deinitialize(
     iree_hal_cuda_nccl_dynamic_symbols_t* syms);
 
+// NCCL symbols loaded on first use.
+//
+// NCCL is a large library that most programs never use and loading it (along
+// with its own dependencies) adds significant latency to driver creation.
+// Drivers own one of these and devices only resolve it when the first
+// collective channel is created. Thread-safe.
+typedef struct iree_hal_cuda_nccl_lazy_dynamic_symbols_t {
+  iree_allocator_t host_allocator;
+  // CUDA symbols that must outlive the lazy symbols.
+  const iree_hal_cuda_dynamic_symbols_t* cuda_symbols;
+  // Guards loading |symbols|.
+  iree_slim_mutex_t mutex;
+  // Loaded NCCL symbols. |symbols.dylib| is NULL until NCCL has been loaded
+  // successfully after which the symbols are immutable.
+  iree_hal_cuda_nccl_dynamic_symbols_t symbols;
+} iree_hal_cuda_nccl_lazy_dynamic_symbols_t;
+
+// Initializes |out_lazy_syms| such that NCCL is loaded with |cuda_symbols| on
+// the first call to iree_hal_cuda_nccl_lazy_dynamic_symbols_resolve.
+void iree_hal_cuda_nccl_lazy_dynamic_symbols_initialize(
+    iree_allocator_t host_allocator,
+    const iree_hal_cuda_dynamic_symbols_t* cuda_symbols,
+    iree_hal_cuda_nccl_lazy_dynamic_symbols_t* out_lazy_syms);
+
+// Deinitializes |lazy_syms| and unloads NCCL if it was loaded.
+void iree_hal_cuda_nccl_lazy_dynamic_symbols_deinitialize(
+    iree_hal_cuda_nccl_lazy_dynamic_symbols_t* lazy_syms);
+
+// Returns the NCCL symbols of |lazy_syms| in |out_syms|, loading NCCL if this
+// is the first successful request. Returns IREE_STATUS_UNAVAILABLE if NCCL is
+// unavailable or incompatible in which case loading will be retried on the
+// next request.
+iree_status_t iree_hal_cuda_nccl_lazy_dynamic_symbols_resolve(
+    iree_hal_cuda_nccl_lazy_dynamic_symbols_t* lazy_syms,
+    const iree_hal_cuda_nccl_dynamic_symbols_t** out_syms);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -35,6 +35,21 @@ IREE_FLAG(
     "   1 : coarse command buffer level tracing enabled.\n"
     "   2 : fine-grained kernel level tracing enabled.\n");
 
+IREE_FLAG(bool, cuda_dispatch_statistics, false,
+          "Aggregates the GPU execution time of each dispatch by executable\n"
+          "export for querying with iree_hal_cuda_device_query_dispatch_\n"
+          "statistics. Available in builds without tracing; requires\n"
+          "--cuda_use_streams.");
+
+IREE_FLAG(int32_t, cuda_queue_count, 1,
+          "Number of queues exposed by each CUDA device. Each queue is backed\n"
+          "by its own CUDA stream and queue affinities are mapped onto them.");
+
+IREE_FLAG(int64_t, cuda_collective_bucket_size, 0,
+          "Maximum size in bytes of the staging buffer used to fuse small\n"
+          "contiguous all-reduce operations into a single NCCL operation.\n"
+          "Must match on all participants. 0 disables bucketing.");
+
 IREE_FLAG(int32_t, cuda_default_index, 0,
           "Specifies the index of the default CUDA device to use");
 
@@ -106,7 +121,12 @@ static iree_status_t iree_hal_cuda_driver_factory_try_create(
       FLAG_cuda_use_streams ? IREE_HAL_CUDA_COMMAND_BUFFER_MODE_STREAM
                             : IREE_HAL_CUDA_COMMAND_BUFFER_MODE_GRAPH;
   device_params.stream_tracing = FLAG_cuda_tracing;
+  device_params.dispatch_statistics = FLAG_cuda_dispatch_statistics;
   device_params.async_allocations = FLAG_cuda_async_allocations;
+  device_params.queue_count =
+      (iree_host_size_t)iree_max(1, FLAG_cuda_queue_count);
+  device_params.collective_bucket_size =
+      (iree_device_size_t)iree_max(0, FLAG_cuda_collective_bucket_size);
 
   driver_options.default_device_index = FLAG_cuda_default_index;
   if (FLAG_cuda_default_index_from_mpi) {
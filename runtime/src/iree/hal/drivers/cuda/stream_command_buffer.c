@@ -24,8 +24,21 @@ typedef struct iree_hal_cuda_stream_command_buffer_t {
   iree_hal_stream_tracing_context_t* tracing_context;
   iree_hal_stream_tracing_context_event_list_t tracing_event_list;
 
+  // Context of the device |cu_stream| belongs to.
+  CUcontext cu_context;
   CUstream cu_stream;
 
+  // Optional stream used to issue collective operations concurrently with
+  // |cu_stream|. NULL if collectives are issued on |cu_stream|.
+  CUstream collective_cu_stream;
+  // Events used to order |collective_cu_stream| against |cu_stream|. Lazily
+  // created when the first collective batch is flushed.
+  CUevent collective_fork_event;
+  CUevent collective_join_event;
+  // True if collectives have been issued on |collective_cu_stream| that
+  // |cu_stream| has not yet waited on.
+  bool collective_join_pending;
+
   // A resource set to maintain references to all resources used within the
   // command buffer. Reset on each begin.
   iree_hal_resource_set_t* resource_set;
@@ -56,8 +69,9 @@ iree_status_t iree_hal_cuda_stream_command_buffer_create(
     iree_hal_stream_tracing_context_t* tracing_context,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
-    iree_host_size_t binding_capacity, CUstream stream,
-    iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
+    iree_host_size_t binding_capacity, CUcontext context, CUstream stream,
+    CUstream collective_stream, iree_arena_block_pool_t* block_pool,
+    iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(device_allocator);
   IREE_ASSERT_ARGUMENT(cuda_symbols);
@@ -90,9 +104,14 @@ iree_status_t iree_hal_cuda_stream_command_buffer_create(
   command_buffer->cuda_symbols = cuda_symbols;
   command_buffer->nccl_symbols = nccl_symbols;
   command_buffer->tracing_context = tracing_context;
-  command_buffer->tracing_event_list.head = NULL;
-  command_buffer->tracing_event_list.tail = NULL;
+  iree_hal_stream_tracing_context_event_list_initialize(
+      &command_buffer->tracing_event_list);
+  command_buffer->cu_context = context;
   command_buffer->cu_stream = stream;
+  command_buffer->collective_cu_stream = collective_stream;
+  command_buffer->collective_fork_event = NULL;
+  command_buffer->collective_join_event = NULL;
+  command_buffer->collective_join_pending = false;
   iree_arena_initialize(block_pool, &command_buffer->arena);
 
   iree_status_t status =
@@ -119,6 +138,17 @@ static void iree_hal_cuda_stream_command_buffer_destroy(
   iree_hal_stream_tracing_free(command_buffer->tracing_context,
                                &command_buffer->tracing_event_list);
 
+  if (command_buffer->collective_fork_event) {
+    IREE_CUDA_IGNORE_ERROR(
+        command_buffer->cuda_symbols,
+        cuEventDestroy(command_buffer->collective_fork_event));
+  }
+  if (command_buffer->collective_join_event) {
+    IREE_CUDA_IGNORE_ERROR(
+        command_buffer->cuda_symbols,
+        cuEventDestroy(command_buffer->collective_join_event));
+  }
+
   iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
   iree_hal_resource_set_free(command_buffer->resource_set);
   iree_arena_deinitialize(&command_buffer->arena);
@@ -145,6 +175,35 @@ void iree_hal_cuda_stream_notify_submitted_commands(
                                            &command_buffer->tracing_event_list);
 }
 
+// Makes the collective stream wait on all work issued on the dispatch stream.
+static iree_status_t iree_hal_cuda_stream_command_buffer_fork_collectives(
+    iree_hal_cuda_stream_command_buffer_t* command_buffer) {
+  const iree_hal_cuda_dynamic_symbols_t* symbols = command_buffer->cuda_symbols;
+  if (!command_buffer->collective_fork_event) {
+    IREE_CUDA_RETURN_IF_ERROR(
+        symbols,
+        cuEventCreate(&command_buffer->collective_fork_event,
+                      CU_EVENT_DISABLE_TIMING),
+        "cuEventCreate");
+    IREE_CUDA_RETURN_IF_ERROR(
+        symbols,
+        cuEventCreate(&command_buffer->collective_join_event,
+                      CU_EVENT_DISABLE_TIMING),
+        "cuEventCreate");
+  }
+  IREE_CUDA_RETURN_IF_ERROR(symbols,
+                            cuEventRecord(command_buffer->collective_fork_event,
+                                          command_buffer->cu_stream),
+                            "cuEventRecord");
+  IREE_CUDA_RETURN_IF_ERROR(
+      symbols,
+      cuStreamWaitEvent(command_buffer->collective_cu_stream,
+                        command_buffer->collective_fork_event,
+                        CU_EVENT_WAIT_DEFAULT),
+      "cuStreamWaitEvent");
+  return iree_ok_status();
+}
+
 // Flushes any pending batched collective operations.
 // Must be called before any other non-collective nodes are added to the graph
 // or a barrier is encountered.
@@ -158,15 +217,58 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_flush_collectives(
     return iree_ok_status();
   }
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_status_t status = iree_hal_cuda_nccl_submit_batch(
-      command_buffer->nccl_symbols, command_buffer->tracing_context,
-      &command_buffer->tracing_event_list, &command_buffer->collective_batch,
-      command_buffer->cu_stream);
+
+  // Issue the collectives on the collective stream (if any) after all work
+  // previously issued on the dispatch stream.
+  CUstream stream = command_buffer->cu_stream;
+  iree_status_t status = iree_ok_status();
+  if (command_buffer->collective_cu_stream) {
+    stream = command_buffer->collective_cu_stream;
+    status = iree_hal_cuda_stream_command_buffer_fork_collectives(
+        command_buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_cuda_nccl_submit_batch(
+        command_buffer->nccl_symbols, command_buffer->tracing_context,
+        &command_buffer->tracing_event_list, &command_buffer->collective_batch,
+        stream);
+  }
   iree_hal_collective_batch_clear(&command_buffer->collective_batch);
+
+  // Record the completion of the collectives for the dispatch stream to wait
+  // on at the next barrier. Until then dispatches recorded in the same barrier
+  // scope may run concurrently with the collectives.
+  if (iree_status_is_ok(status) && command_buffer->collective_cu_stream) {
+    status = IREE_CURESULT_TO_STATUS(
+        command_buffer->cuda_symbols,
+        cuEventRecord(command_buffer->collective_join_event,
+                      command_buffer->collective_cu_stream),
+        "cuEventRecord");
+    command_buffer->collective_join_pending = iree_status_is_ok(status);
+  }
+
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
 
+// Makes the dispatch stream wait on all collectives issued on the collective
+// stream. Must be called at barriers and before the command buffer ends.
+static iree_status_t iree_hal_cuda_stream_command_buffer_join_collectives(
+    iree_hal_cuda_stream_command_buffer_t* command_buffer) {
+  if (IREE_LIKELY(!command_buffer->collective_join_pending)) {
+    return iree_ok_status();
+  }
+  command_buffer->collective_join_pending = false;
+  IREE_CUDA_RETURN_IF_ERROR(
+      command_buffer->cuda_symbols,
+      cuStreamWaitEvent(command_buffer->cu_stream,
+                        command_buffer->collective_join_event,
+                        CU_EVENT_WAIT_DEFAULT),
+      "cuStreamWaitEvent");
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_cuda_stream_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_cuda_stream_command_buffer_t* command_buffer =
@@ -191,6 +293,8 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_end(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0,
       iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_cuda_stream_command_buffer_join_collectives(command_buffer));
 
   // Reset the arena as there should be nothing using it now that we've
   // dispatched all our operations inline.
@@ -277,12 +381,15 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_execution_barrier(
   }
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  IREE_RETURN_IF_ERROR(
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
       iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_cuda_stream_command_buffer_join_collectives(command_buffer));
 
-  // Nothing to do for barriers between memory operations or dispatches--CUDA
-  // stream semantics guarantees execution and memory visibility in program
-  // order.
+  // Nothing else to do for barriers between memory operations or dispatches--
+  // CUDA stream semantics guarantees execution and memory visibility in
+  // program order.
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
@@ -429,21 +536,45 @@ static iree_status_t iree_hal_cuda_stream_command_buffer_copy_buffer(
       z0,
       iree_hal_cuda_stream_command_buffer_flush_collectives(command_buffer));
 
-  CUdeviceptr source_device_buffer = iree_hal_cuda_buffer_device_pointer(
-      iree_hal_buffer_allocated_buffer(source_ref.buffer));
+  iree_hal_buffer_t* source_buffer =
+      iree_hal_buffer_allocated_buffer(source_ref.buffer);
+  iree_hal_buffer_t* target_buffer =
+      iree_hal_buffer_allocated_buffer(target_ref.buffer);
   iree_device_size_t source_offset =
       iree_hal_buffer_byte_offset(source_ref.buffer) + source_ref.offset;
-  CUdeviceptr target_device_buffer = iree_hal_cuda_buffer_device_pointer(
-      iree_hal_buffer_allocated_buffer(target_ref.buffer));
   iree_device_size_t target_offset =
       iree_hal_buffer_byte_offset(target_ref.buffer) + target_ref.offset;
-  CUdeviceptr src = source_device_buffer + source_offset;
-  CUdeviceptr dst = target_device_buffer + target_offset;
-
-  IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, command_buffer->cuda_symbols,
-      cuMemcpyAsync(dst, src, target_ref.length, command_buffer->cu_stream),
-      "cuMemcpyAsync");
+  CUdeviceptr src =
+      iree_hal_cuda_buffer_device_pointer(source_buffer) + source_offset;
+  CUdeviceptr dst =
+      iree_hal_cuda_buffer_device_pointer(target_buffer) + target_offset;
+
+  // Copies involving memory of a peer device go through cuMemcpyPeerAsync so
+  // that the driver uses the peer link when available and otherwise stages the
+  // copy through the host.
+  CUcontext source_peer_context =
+      iree_hal_cuda_buffer_peer_context(source_buffer);
+  CUcontext target_peer_context =
+      iree_hal_cuda_buffer_peer_context(target_buffer);
+  if (source_peer_context || target_peer_context) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "peer");
+    IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, command_buffer->cuda_symbols,
+        cuMemcpyPeerAsync(
+            dst,
+            target_peer_context ? target_peer_context
+                                : command_buffer->cu_context,
+            src,
+            source_peer_context ? source_peer_context
+                                : command_buffer->cu_context,
+            target_ref.length, command_buffer->cu_stream),
+        "cuMemcpyPeerAsync");
+  } else {
+    IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, command_buffer->cuda_symbols,
+        cuMemcpyAsync(dst, src, target_ref.length, command_buffer->cu_stream),
+        "cuMemcpyAsync");
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
@@ -29,6 +29,11 @@ extern "C" {
 // replaying the scratch data required for things like buffer updates is
 // retained by the source deferred command buffer and as such the |block_pool|
 // and can be NULL to avoid a double copy.
+//
+// If |collective_stream| is non-NULL collective operations are issued on it
+// instead of |stream| so that they may overlap with dispatches recorded in the
+// same barrier scope. |stream| waits for the collectives at the next execution
+// barrier or when the command buffer ends.
 iree_status_t iree_hal_cuda_stream_command_buffer_create(
     iree_hal_allocator_t* device_allocator,
     const iree_hal_cuda_dynamic_symbols_t* cuda_symbols,
@@ -36,8 +41,9 @@ iree_status_t iree_hal_cuda_stream_command_buffer_create(
     iree_hal_stream_tracing_context_t* tracing_context,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
-    iree_host_size_t binding_capacity, CUstream stream,
-    iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
+    iree_host_size_t binding_capacity, CUcontext context, CUstream stream,
+    CUstream collective_stream, iree_arena_block_pool_t* block_pool,
+    iree_allocator_t host_allocator,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Returns true if |command_buffer| is a CUDA stream-based command buffer.
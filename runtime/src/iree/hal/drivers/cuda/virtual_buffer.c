@@ -0,0 +1,280 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/cuda/virtual_buffer.h"
+
+#include <string.h>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/drivers/cuda/cuda_buffer.h"
+#include "iree/hal/drivers/cuda/cuda_status_util.h"
+
+// Backing state of an IREE_HAL_CUDA_BUFFER_TYPE_VIRTUAL buffer stored as the
+// user data of its release callback.
+typedef struct iree_hal_cuda_virtual_allocation_t {
+  const iree_hal_cuda_dynamic_symbols_t* cuda_symbols;
+  iree_allocator_t host_allocator;
+  CUcontext cu_context;
+  CUdevice cu_device;
+
+  // Base of the reserved virtual address range.
+  CUdeviceptr base_ptr;
+  // Total size of the reserved range; a multiple of |granularity|.
+  iree_device_size_t reserved_size;
+  // Minimum size and alignment of physical allocations on the device.
+  iree_device_size_t granularity;
+
+  // Guards |committed_size| and the mapping of new physical memory.
+  iree_slim_mutex_t mutex;
+  // Size of the prefix of the reserved range backed by physical memory.
+  iree_device_size_t committed_size;
+} iree_hal_cuda_virtual_allocation_t;
+
+static CUmemAllocationProp iree_hal_cuda_virtual_allocation_prop(
+    CUdevice cu_device) {
+  CUmemAllocationProp prop;
+  memset(&prop, 0, sizeof(prop));
+  prop.type = CU_MEM_ALLOCATION_TYPE_PINNED;
+  prop.location.type = CU_MEM_LOCATION_TYPE_DEVICE;
+  prop.location.id = cu_device;
+  return prop;
+}
+
+// Maps [committed_size, new_committed_size) of the reserved range of
+// |allocation| to newly created physical memory. The CUDA context must be
+// current and the allocation mutex held.
+static iree_status_t iree_hal_cuda_virtual_allocation_map(
+    iree_hal_cuda_virtual_allocation_t* allocation,
+    iree_device_size_t new_committed_size) {
+  const iree_hal_cuda_dynamic_symbols_t* symbols = allocation->cuda_symbols;
+  CUdeviceptr chunk_ptr = allocation->base_ptr + allocation->committed_size;
+  size_t chunk_size = (size_t)(new_committed_size - allocation->committed_size);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)chunk_size);
+
+  CUmemAllocationProp prop =
+      iree_hal_cuda_virtual_allocation_prop(allocation->cu_device);
+  CUmemGenericAllocationHandle handle = 0;
+  IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, symbols, cuMemCreate(&handle, chunk_size, &prop, /*flags=*/0),
+      "cuMemCreate");
+
+  // The mapping retains the physical memory so the handle can be released
+  // immediately: the memory is freed when the range is unmapped.
+  iree_status_t status = IREE_CURESULT_TO_STATUS(
+      symbols,
+      cuMemMap(chunk_ptr, chunk_size, /*offset=*/0, handle, /*flags=*/0),
+      "cuMemMap");
+  IREE_CUDA_IGNORE_ERROR(symbols, cuMemRelease(handle));
+  if (!iree_status_is_ok(status)) {
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  CUmemAccessDesc access_desc;
+  memset(&access_desc, 0, sizeof(access_desc));
+  access_desc.location = prop.location;
+  access_desc.flags = CU_MEM_ACCESS_FLAGS_PROT_READWRITE;
+  status = IREE_CURESULT_TO_STATUS(
+      symbols, cuMemSetAccess(chunk_ptr, chunk_size, &access_desc, 1),
+      "cuMemSetAccess");
+
+  if (iree_status_is_ok(status)) {
+    allocation->committed_size = new_committed_size;
+  } else {
+    IREE_CUDA_IGNORE_ERROR(symbols, cuMemUnmap(chunk_ptr, chunk_size));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_cuda_virtual_allocation_commit(
+    iree_hal_cuda_virtual_allocation_t* allocation,
+    iree_device_size_t minimum_committed_size) {
+  if (minimum_committed_size > allocation->reserved_size) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "cannot commit %" PRIdsz " bytes of a virtual buffer reserving %" PRIdsz
+        " bytes",
+        minimum_committed_size, allocation->reserved_size);
+  }
+
+  iree_slim_mutex_lock(&allocation->mutex);
+  iree_status_t status = iree_ok_status();
+  if (minimum_committed_size > allocation->committed_size) {
+    iree_device_size_t new_committed_size =
+        iree_device_align(minimum_committed_size, allocation->granularity);
+    status = IREE_CURESULT_TO_STATUS(allocation->cuda_symbols,
+                                     cuCtxPushCurrent(allocation->cu_context),
+                                     "cuCtxPushCurrent");
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_cuda_virtual_allocation_map(allocation,
+                                                    new_committed_size);
+      CUcontext popped_context = NULL;
+      status = iree_status_join(
+          status, IREE_CURESULT_TO_STATUS(allocation->cuda_symbols,
+                                          cuCtxPopCurrent(&popped_context),
+                                          "cuCtxPopCurrent"));
+    }
+  }
+  iree_slim_mutex_unlock(&allocation->mutex);
+  return status;
+}
+
+static void iree_hal_cuda_virtual_allocation_free(
+    iree_hal_cuda_virtual_allocation_t* allocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_hal_cuda_dynamic_symbols_t* symbols = allocation->cuda_symbols;
+  // All committed chunks are contiguous from the base and unmapping the whole
+  // range releases their physical memory.
+  if (allocation->committed_size > 0) {
+    IREE_CUDA_IGNORE_ERROR(symbols,
+                           cuMemUnmap(allocation->base_ptr,
+                                      (size_t)allocation->committed_size));
+  }
+  if (allocation->base_ptr) {
+    IREE_CUDA_IGNORE_ERROR(symbols,
+                           cuMemAddressFree(allocation->base_ptr,
+                                            (size_t)allocation->reserved_size));
+  }
+  iree_slim_mutex_deinitialize(&allocation->mutex);
+  iree_allocator_free(allocation->host_allocator, allocation);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_hal_cuda_virtual_buffer_release_callback(
+    void* user_data, iree_hal_buffer_t* buffer) {
+  iree_hal_cuda_virtual_allocation_free(
+      (iree_hal_cuda_virtual_allocation_t*)user_data);
+}
+
+iree_status_t iree_hal_cuda_virtual_buffer_allocate(
+    const iree_hal_cuda_dynamic_symbols_t* cuda_symbols, CUcontext cu_context,
+    CUdevice cu_device, iree_hal_buffer_params_t params,
+    iree_device_size_t reserved_size, iree_device_size_t committed_size,
+    iree_allocator_t host_allocator, iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(cuda_symbols);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  iree_hal_buffer_params_canonicalize(&params);
+  if (!iree_all_bits_set(params.type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) ||
+      iree_any_bit_set(params.type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "virtual buffers must be device-local and not "
+                            "host-visible");
+  }
+  if (reserved_size == 0 || committed_size > reserved_size) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid virtual buffer reservation of %" PRIdsz
+                            " bytes with %" PRIdsz " bytes committed",
+                            reserved_size, committed_size);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)reserved_size);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)committed_size);
+
+  CUmemAllocationProp prop = iree_hal_cuda_virtual_allocation_prop(cu_device);
+  size_t granularity = 0;
+  IREE_CUDA_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, cuda_symbols,
+      cuMemGetAllocationGranularity(&granularity, &prop,
+                                    CU_MEM_ALLOC_GRANULARITY_RECOMMENDED),
+      "cuMemGetAllocationGranularity");
+
+  iree_hal_cuda_virtual_allocation_t* allocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*allocation),
+                                (void**)&allocation));
+  allocation->cuda_symbols = cuda_symbols;
+  allocation->host_allocator = host_allocator;
+  allocation->cu_context = cu_context;
+  allocation->cu_device = cu_device;
+  allocation->reserved_size = iree_device_align(reserved_size, granularity);
+  allocation->granularity = granularity;
+  iree_slim_mutex_initialize(&allocation->mutex);
+
+  // Only the address range is reserved here; physical memory is created and
+  // mapped as the committed prefix grows.
+  iree_status_t status = IREE_CURESULT_TO_STATUS(
+      cuda_symbols,
+      cuMemAddressReserve(&allocation->base_ptr,
+                          (size_t)allocation->reserved_size,
+                          /*alignment=*/0, /*addr=*/0, /*flags=*/0),
+      "cuMemAddressReserve");
+  if (iree_status_is_ok(status) && committed_size > 0) {
+    status = iree_hal_cuda_virtual_allocation_commit(allocation,
+                                                     committed_size);
+  }
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    // NOTE: as with queue-ordered allocations we don't provide a device
+    // allocator as the memory is not tracked by one and instead the release
+    // callback owns the allocation.
+    iree_hal_buffer_release_callback_t release_callback = {
+        .fn = iree_hal_cuda_virtual_buffer_release_callback,
+        .user_data = allocation,
+    };
+    status = iree_hal_cuda_buffer_wrap(
+        /*device_allocator=*/NULL, params.type, params.access, params.usage,
+        allocation->reserved_size, /*byte_offset=*/0,
+        /*byte_length=*/allocation->reserved_size,
+        IREE_HAL_CUDA_BUFFER_TYPE_VIRTUAL, allocation->base_ptr,
+        /*host_ptr=*/NULL, release_callback, host_allocator, &buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_cuda_virtual_allocation_free(allocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_hal_cuda_virtual_allocation_t*
+iree_hal_cuda_virtual_buffer_allocation(iree_hal_buffer_t* buffer) {
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (iree_hal_cuda_buffer_type(allocated_buffer) !=
+      IREE_HAL_CUDA_BUFFER_TYPE_VIRTUAL) {
+    return NULL;
+  }
+  return (iree_hal_cuda_virtual_allocation_t*)
+      iree_hal_cuda_buffer_release_user_data(allocated_buffer);
+}
+
+iree_status_t iree_hal_cuda_virtual_buffer_commit(
+    iree_hal_buffer_t* buffer, iree_device_size_t minimum_committed_size) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_cuda_virtual_allocation_t* allocation =
+      iree_hal_cuda_virtual_buffer_allocation(buffer);
+  if (!allocation) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "buffer is not a CUDA virtual buffer");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)minimum_committed_size);
+  iree_status_t status = iree_hal_cuda_virtual_allocation_commit(
+      allocation, iree_hal_buffer_byte_offset(buffer) + minimum_committed_size);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_device_size_t iree_hal_cuda_virtual_buffer_committed_size(
+    iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_cuda_virtual_allocation_t* allocation =
+      iree_hal_cuda_virtual_buffer_allocation(buffer);
+  if (!allocation) return 0;
+  iree_slim_mutex_lock(&allocation->mutex);
+  iree_device_size_t committed_size = allocation->committed_size;
+  iree_slim_mutex_unlock(&allocation->mutex);
+  iree_device_size_t byte_offset = iree_hal_buffer_byte_offset(buffer);
+  if (committed_size <= byte_offset) return 0;
+  return iree_min(committed_size - byte_offset,
+                  iree_hal_buffer_byte_length(buffer));
+}
@@ -8,13 +8,20 @@
 // HIP symbols
 //===----------------------------------------------------------------------===//
 
+// Core symbols (IREE_HAL_HIP_CORE_PFN_*) are resolved when the driver is
+// created and are limited to those required to initialize HIP and enumerate
+// devices. All other symbols are only used by devices and are resolved when
+// the first device is created.
+
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipCtxGetCurrent, hipCtx_t *)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipCtxSetCurrent, hipCtx_t)
-IREE_HAL_HIP_REQUIRED_PFN_DECL(hipDeviceGet, hipDevice_t *, int)
-IREE_HAL_HIP_REQUIRED_PFN_DECL(hipDeviceGetAttribute, int *,
-                               hipDeviceAttribute_t, int)
-IREE_HAL_HIP_REQUIRED_PFN_DECL(hipDeviceGetName, char *, int, hipDevice_t)
-IREE_HAL_HIP_REQUIRED_PFN_DECL(hipDeviceGetUuid, hipUUID *, hipDevice_t)
+IREE_HAL_HIP_REQUIRED_PFN_DECL(hipDeviceCanAccessPeer, int *, int, int)
+IREE_HAL_HIP_REQUIRED_PFN_DECL(hipDeviceEnablePeerAccess, int, unsigned int)
+IREE_HAL_HIP_CORE_PFN_DECL(hipDeviceGet, hipDevice_t *, int)
+IREE_HAL_HIP_CORE_PFN_DECL(hipDeviceGetAttribute, int *, hipDeviceAttribute_t,
+                           int)
+IREE_HAL_HIP_CORE_PFN_DECL(hipDeviceGetName, char *, int, hipDevice_t)
+IREE_HAL_HIP_CORE_PFN_DECL(hipDeviceGetUuid, hipUUID *, hipDevice_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipDevicePrimaryCtxRelease, hipDevice_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipDevicePrimaryCtxRetain, hipCtx_t *,
                                hipDevice_t)
@@ -34,13 +41,16 @@ IREE_HAL_HIP_REQUIRED_PFN_DECL(hipFree, void *)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipFreeAsync, void *, hipStream_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipFuncSetAttribute, const void *,
                                hipFuncAttribute, int)
-IREE_HAL_HIP_REQUIRED_PFN_DECL(hipGetDeviceCount, int *)
+IREE_HAL_HIP_CORE_PFN_DECL(hipGetDeviceCount, int *)
 IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipGetDeviceProperties, hipDeviceProp_tR0000 *,
                                int)
 // hipGetErrorName(hipError_t) and hipGetErrorString(hipError_t) return
 // const char* instead of hipError_t so it uses a different macro.
-IREE_HAL_HIP_REQUIRED_PFN_STR_DECL(hipGetErrorName, hipError_t)
-IREE_HAL_HIP_REQUIRED_PFN_STR_DECL(hipGetErrorString, hipError_t)
+IREE_HAL_HIP_CORE_PFN_STR_DECL(hipGetErrorName, hipError_t)
+IREE_HAL_HIP_CORE_PFN_STR_DECL(hipGetErrorString, hipError_t)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipGraphAddChildGraphNode, hipGraphNode_t *,
+                               hipGraph_t, const hipGraphNode_t *, size_t,
+                               hipGraph_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipGraphAddEmptyNode, hipGraphNode_t *,
                                hipGraph_t, const hipGraphNode_t *, size_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipGraphAddEventRecordNode, hipGraphNode_t *,
@@ -64,7 +74,7 @@ IREE_HAL_HIP_REQUIRED_PFN_DECL(hipHostGetDevicePointer, void **, void *,
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipHostMalloc, void **, size_t, unsigned int)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipHostRegister, void *, size_t, unsigned int)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipHostUnregister, void *)
-IREE_HAL_HIP_REQUIRED_PFN_DECL(hipInit, unsigned int)
+IREE_HAL_HIP_CORE_PFN_DECL(hipInit, unsigned int)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipLaunchHostFunc, hipStream_t, hipHostFn_t,
                                void *)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipLaunchKernel, const void *, dim3, dim3,
@@ -75,12 +85,26 @@ IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMallocFromPoolAsync, void **, size_t,
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMallocManaged, hipDeviceptr_t *, size_t,
                                unsigned int)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMallocAsync, void **, size_t, hipStream_t)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipMemAddressFree, void *, size_t)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipMemAddressReserve, void **, size_t, size_t,
+                               void *, unsigned long long)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemcpy, void *, const void *, size_t,
                                hipMemcpyKind)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemcpyAsync, void *, const void *, size_t,
                                hipMemcpyKind, hipStream_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemcpyHtoDAsync, hipDeviceptr_t, void *,
                                size_t, hipStream_t)
+IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemcpyPeerAsync, void *, int, const void *,
+                               int, size_t, hipStream_t)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipMemCreate, hipMemGenericAllocationHandle_t *,
+                               size_t, const hipMemAllocationProp *,
+                               unsigned long long)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipMemGetAllocationGranularity, size_t *,
+                               const hipMemAllocationProp *,
+                               hipMemAllocationGranularity_flags)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipMemMap, void *, size_t, size_t,
+                               hipMemGenericAllocationHandle_t,
+                               unsigned long long)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemPoolCreate, hipMemPool_t *,
                                const hipMemPoolProps *)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemPoolDestroy, hipMemPool_t)
@@ -91,6 +115,10 @@ IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemPoolSetAttribute, hipMemPool_t,
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemPoolTrimTo, hipMemPool_t, size_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemPrefetchAsync, const void *, size_t, int,
                                hipStream_t)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipMemRelease, hipMemGenericAllocationHandle_t)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipMemSetAccess, void *, size_t,
+                               const hipMemAccessDesc *, size_t)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipMemUnmap, void *, size_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemset, void *, int, size_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemsetAsync, void *, int, size_t, hipStream_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipMemsetD8Async, void *, char, size_t,
@@ -109,10 +137,15 @@ IREE_HAL_HIP_REQUIRED_PFN_DECL(hipModuleLoadData, hipModule_t *, const void *)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipModuleLoadDataEx, hipModule_t *, const void *,
                                unsigned int, hipJitOption *, void **)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipModuleUnload, hipModule_t)
+IREE_HAL_HIP_REQUIRED_PFN_DECL(hipPointerGetAttributes, hipPointerAttribute_t *,
+                               const void *)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipSetDevice, unsigned int)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipStreamBeginCapture, hipStream_t,
+                               hipStreamCaptureMode)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipStreamCreateWithFlags, hipStream_t *,
                                unsigned int)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipStreamDestroy, hipStream_t)
+IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipStreamEndCapture, hipStream_t, hipGraph_t *)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipStreamSynchronize, hipStream_t)
 IREE_HAL_HIP_REQUIRED_PFN_DECL(hipStreamWaitEvent, hipStream_t, hipEvent_t,
                                unsigned int)
@@ -26,17 +26,43 @@ static const char* iree_hal_hip_dylib_names[] = {
 #endif  // IREE_PLATFORM_WINDOWS
 };
 
-// Resolves all HIP dynamic symbols in `dynamic_symbol_tables.h`
-static iree_status_t iree_hal_hip_dynamic_symbols_resolve_all(
+#define IREE_HAL_HIP_RESOLVE_REQUIRED_SYMBOL(syms, hip_symbol_name) \
+  {                                                                \
+    static const char* name = #hip_symbol_name;                    \
+    IREE_RETURN_IF_ERROR(iree_dynamic_library_lookup_symbol(       \
+        syms->dylib, name, (void**)&syms->hip_symbol_name));       \
+  }
+
+// Resolves the core HIP dynamic symbols in `dynamic_symbol_tables.h` required
+// to initialize HIP and enumerate devices.
+static iree_status_t iree_hal_hip_dynamic_symbols_resolve_core(
     iree_hal_hip_dynamic_symbols_t* syms) {
+#define IREE_HAL_HIP_CORE_PFN_DECL(hip_symbol_name, ...) \
+  IREE_HAL_HIP_RESOLVE_REQUIRED_SYMBOL(syms, hip_symbol_name)
+#define IREE_HAL_HIP_CORE_PFN_STR_DECL(hip_symbol_name, ...) \
+  IREE_HAL_HIP_RESOLVE_REQUIRED_SYMBOL(syms, hip_symbol_name)
+#define IREE_HAL_HIP_REQUIRED_PFN_DECL(hip_symbol_name, ...)
+#define IREE_HAL_HIP_REQUIRED_PFN_STR_DECL(hip_symbol_name, ...)
+#define IREE_HAL_HIP_OPTIONAL_PFN_DECL(hip_symbol_name, ...)
+#include "iree/hal/drivers/hip/dynamic_symbol_tables.h"  // IWYU pragma: keep
+#undef IREE_HAL_HIP_CORE_PFN_DECL
+#undef IREE_HAL_HIP_CORE_PFN_STR_DECL
+#undef IREE_HAL_HIP_REQUIRED_PFN_DECL
+#undef IREE_HAL_HIP_REQUIRED_PFN_STR_DECL
+#undef IREE_HAL_HIP_OPTIONAL_PFN_DECL
+  return iree_ok_status();
+}
+
+// Resolves the remaining HIP dynamic symbols in `dynamic_symbol_tables.h` used
+// by devices.
+static iree_status_t iree_hal_hip_dynamic_symbols_resolve_device(
+    iree_hal_hip_dynamic_symbols_t* syms) {
+#define IREE_HAL_HIP_CORE_PFN_DECL(hip_symbol_name, ...)
+#define IREE_HAL_HIP_CORE_PFN_STR_DECL(hip_symbol_name, ...)
 #define IREE_HAL_HIP_REQUIRED_PFN_DECL(hip_symbol_name, ...) \
-  {                                                          \
-    static const char* name = #hip_symbol_name;              \
-    IREE_RETURN_IF_ERROR(iree_dynamic_library_lookup_symbol( \
-        syms->dylib, name, (void**)&syms->hip_symbol_name)); \
-  }
+  IREE_HAL_HIP_RESOLVE_REQUIRED_SYMBOL(syms, hip_symbol_name)
 #define IREE_HAL_HIP_REQUIRED_PFN_STR_DECL(hip_symbol_name, ...) \
-  IREE_HAL_HIP_REQUIRED_PFN_DECL(hip_symbol_name, ...)
+  IREE_HAL_HIP_RESOLVE_REQUIRED_SYMBOL(syms, hip_symbol_name)
 #define IREE_HAL_HIP_OPTIONAL_PFN_DECL(hip_symbol_name, ...) \
   {                                                          \
     static const char* name = #hip_symbol_name;              \
@@ -44,6 +70,8 @@ static iree_status_t iree_hal_hip_dynamic_symbols_resolve_all(
         syms->dylib, name, (void**)&syms->hip_symbol_name)); \
   }
 #include "iree/hal/drivers/hip/dynamic_symbol_tables.h"  // IWYU pragma: keep
+#undef IREE_HAL_HIP_CORE_PFN_DECL
+#undef IREE_HAL_HIP_CORE_PFN_STR_DECL
 #undef IREE_HAL_HIP_REQUIRED_PFN_DECL
 #undef IREE_HAL_HIP_REQUIRED_PFN_STR_DECL
 #undef IREE_HAL_HIP_OPTIONAL_PFN_DECL
@@ -148,7 +176,7 @@ iree_status_t iree_hal_hip_dynamic_symbols_initialize(
 
   if (iree_status_is_ok(status)) {
     if (loaded_one) {
-      status = iree_hal_hip_dynamic_symbols_resolve_all(out_syms);
+      status = iree_hal_hip_dynamic_symbols_resolve_core(out_syms);
     } else {
 #if IREE_STATUS_MODE
       iree_string_view_t error_detail =
@@ -171,6 +199,19 @@ iree_status_t iree_hal_hip_dynamic_symbols_initialize(
   return status;
 }
 
+iree_status_t iree_hal_hip_dynamic_symbols_resolve_device_symbols(
+    iree_hal_hip_dynamic_symbols_t* syms) {
+  IREE_ASSERT_ARGUMENT(syms);
+  if (syms->device_symbols_resolved) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_status_t status = iree_hal_hip_dynamic_symbols_resolve_device(syms);
+  syms->device_symbols_resolved = iree_status_is_ok(status);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 void iree_hal_hip_dynamic_symbols_deinitialize(
     iree_hal_hip_dynamic_symbols_t* syms) {
   IREE_TRACE_ZONE_BEGIN(z0);
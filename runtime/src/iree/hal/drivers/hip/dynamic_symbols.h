@@ -19,6 +19,10 @@ extern "C" {
 // We load all the symbols in `dynamic_symbol_tables.h` and fail if any of the
 // symbol is not available. The functions signatures are matching the
 // declarations in `hip_runtime_api.h`.
+//
+// Only the core symbols required to initialize HIP and enumerate devices are
+// resolved on initialization. The remaining symbols must be resolved with
+// iree_hal_hip_dynamic_symbols_resolve_device_symbols before creating devices.
 
 //===----------------------------------------------------------------------===//
 // HIP dynamic symbols
@@ -29,7 +33,14 @@ typedef struct iree_hal_hip_dynamic_symbols_t {
   // The dynamic library handle.
   iree_dynamic_library_t* dylib;
 
+  // True once the non-core device symbols have been resolved.
+  bool device_symbols_resolved;
+
   // Concrete HIP symbols defined by including the `dynamic_symbol_tables.h`.
+#define IREE_HAL_HIP_CORE_PFN_DECL(hipSymbolName, ...) \
+  hipError_t (*hipSymbolName)(__VA_ARGS__);
+#define IREE_HAL_HIP_CORE_PFN_STR_DECL(hipSymbolName, ...) \
+  const char* (*hipSymbolName)(__VA_ARGS__);
 #define IREE_HAL_HIP_REQUIRED_PFN_DECL(hipSymbolName, ...) \
   hipError_t (*hipSymbolName)(__VA_ARGS__);
 #define IREE_HAL_HIP_REQUIRED_PFN_STR_DECL(hipSymbolName, ...) \
@@ -37,6 +48,8 @@ typedef struct iree_hal_hip_dynamic_symbols_t {
 #define IREE_HAL_HIP_OPTIONAL_PFN_DECL(hipSymbolName, ...) \
   hipError_t (*hipSymbolName)(__VA_ARGS__);
 #include "iree/hal/drivers/hip/dynamic_symbol_tables.h"  // IWYU pragma: export
+#undef IREE_HAL_HIP_CORE_PFN_DECL
+#undef IREE_HAL_HIP_CORE_PFN_STR_DECL
 #undef IREE_HAL_HIP_REQUIRED_PFN_DECL
 #undef IREE_HAL_HIP_REQUIRED_PFN_STR_DECL
 #undef IREE_HAL_HIP_OPTIONAL_PFN_DECL
@@ -63,6 +76,13 @@ iree_status_t iree_hal_hip_dynamic_symbols_initialize(
     const iree_string_view_t* hip_lib_search_paths,
     iree_hal_hip_dynamic_symbols_t* out_syms);
 
+// Resolves all symbols not resolved by iree_hal_hip_dynamic_symbols_initialize
+// as required by devices. No-op if the symbols have already been resolved.
+// Not thread-safe: callers must ensure exclusive access to |syms| until
+// resolution has completed.
+iree_status_t iree_hal_hip_dynamic_symbols_resolve_device_symbols(
+    iree_hal_hip_dynamic_symbols_t* syms);
+
 // Deinitializes |syms| by unloading the backing library. All function pointers
 // will be invalidated. They _may_ still work if there are other reasons the
 // library remains loaded so be careful.
@@ -11,6 +11,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/drivers/hip/rccl_dynamic_symbols.h"
 #include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
 
 namespace iree {
 namespace hal {
@@ -42,6 +43,12 @@ TEST(DynamicSymbolsTest, CreateFromSystemLoader) {
     HIP_CHECK_ERRORS(symbols.hipDeviceGet(&device, /*ordinal=*/0));
   }
 
+  // Device symbols are only resolved on request.
+  EXPECT_EQ(nullptr, symbols.hipStreamCreateWithFlags);
+  IREE_ASSERT_OK(iree_hal_hip_dynamic_symbols_resolve_device_symbols(&symbols));
+  EXPECT_NE(nullptr, symbols.hipStreamCreateWithFlags);
+  IREE_ASSERT_OK(iree_hal_hip_dynamic_symbols_resolve_device_symbols(&symbols));
+
   iree_hal_hip_dynamic_symbols_deinitialize(&symbols);
 }
 
@@ -96,6 +103,41 @@ TEST(NCCLDynamicSymbolsTest, CreateFromSystemLoader) {
   iree_hal_hip_dynamic_symbols_deinitialize(&hip_symbols);
 }
 
+TEST(NCCLDynamicSymbolsTest, LazilyLoaded) {
+  iree_hal_hip_dynamic_symbols_t hip_symbols;
+  iree_status_t status = iree_hal_hip_dynamic_symbols_initialize(
+      iree_allocator_system(), /*hip_lib_search_path_count=*/0,
+      /*hip_lib_search_paths=*/NULL, &hip_symbols);
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_ignore(status);
+    GTEST_SKIP() << "HIP symbols cannot be loaded, skipping test.";
+  }
+
+  iree_hal_hip_nccl_lazy_dynamic_symbols_t lazy_symbols;
+  iree_hal_hip_nccl_lazy_dynamic_symbols_initialize(
+      iree_allocator_system(), &hip_symbols, &lazy_symbols);
+  EXPECT_EQ(nullptr, lazy_symbols.symbols.dylib);
+
+  const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols = NULL;
+  status = iree_hal_hip_nccl_lazy_dynamic_symbols_resolve(&lazy_symbols,
+                                                          &nccl_symbols);
+  if (iree_status_is_ok(status)) {
+    ASSERT_EQ(&lazy_symbols.symbols, nccl_symbols);
+    const iree_hal_hip_nccl_dynamic_symbols_t* resolved_symbols = NULL;
+    IREE_ASSERT_OK(iree_hal_hip_nccl_lazy_dynamic_symbols_resolve(
+        &lazy_symbols, &resolved_symbols));
+    EXPECT_EQ(nccl_symbols, resolved_symbols);
+  } else {
+    EXPECT_TRUE(iree_status_is_unavailable(status));
+    EXPECT_EQ(nullptr, nccl_symbols);
+    iree_status_ignore(status);
+  }
+
+  iree_hal_hip_nccl_lazy_dynamic_symbols_deinitialize(&lazy_symbols);
+  iree_hal_hip_dynamic_symbols_deinitialize(&hip_symbols);
+}
+
 }  // namespace
 }  // namespace hip
 }  // namespace hal
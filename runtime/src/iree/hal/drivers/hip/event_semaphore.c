@@ -28,9 +28,10 @@ typedef struct iree_hal_hip_semaphore_t {
   // The timepoint pool to acquire timepoint objects.
   iree_hal_hip_timepoint_pool_t* timepoint_pool;
 
-  // The list of actions that this semaphore may need to advance on
-  // new signaled values.
-  iree_hal_deferred_work_queue_t* work_queue;
+  // The lists of actions that this semaphore may need to advance on
+  // new signaled values; one per device stream.
+  iree_host_size_t work_queue_count;
+  iree_hal_deferred_work_queue_t* const* work_queues;
 
   hipCtx_t hip_context;
 
@@ -61,11 +62,12 @@ static iree_hal_hip_semaphore_t* iree_hal_hip_semaphore_cast(
 iree_status_t iree_hal_hip_event_semaphore_create(
     uint64_t initial_value, const iree_hal_hip_dynamic_symbols_t* symbols,
     hipCtx_t hip_context, iree_hal_hip_timepoint_pool_t* timepoint_pool,
-    iree_hal_deferred_work_queue_t* work_queue, iree_allocator_t host_allocator,
-    iree_hal_semaphore_t** out_semaphore) {
+    iree_host_size_t work_queue_count,
+    iree_hal_deferred_work_queue_t* const* work_queues,
+    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
   IREE_ASSERT_ARGUMENT(symbols);
   IREE_ASSERT_ARGUMENT(timepoint_pool);
-  IREE_ASSERT_ARGUMENT(work_queue);
+  IREE_ASSERT_ARGUMENT(!work_queue_count || work_queues);
   IREE_ASSERT_ARGUMENT(out_semaphore);
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -81,7 +83,8 @@ iree_status_t iree_hal_hip_event_semaphore_create(
   semaphore->host_allocator = host_allocator;
   semaphore->symbols = symbols;
   semaphore->timepoint_pool = timepoint_pool;
-  semaphore->work_queue = work_queue;
+  semaphore->work_queue_count = work_queue_count;
+  semaphore->work_queues = work_queues;
   iree_slim_mutex_initialize(&semaphore->mutex);
   semaphore->current_value = initial_value;
   semaphore->failure_status = iree_ok_status();
@@ -111,6 +114,23 @@ static void iree_hal_hip_semaphore_destroy(
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Advances all deferred work queues that may be waiting on |semaphore|.
+// Returns the first failure but always tries to advance every queue.
+static iree_status_t iree_hal_hip_semaphore_issue_work_queues(
+    iree_hal_hip_semaphore_t* semaphore) {
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < semaphore->work_queue_count; ++i) {
+    iree_status_t issue_status =
+        iree_hal_deferred_work_queue_issue(semaphore->work_queues[i]);
+    if (iree_status_is_ok(status)) {
+      status = issue_status;
+    } else {
+      iree_status_ignore(issue_status);
+    }
+  }
+  return status;
+}
+
 static iree_status_t iree_hal_hip_semaphore_query(
     iree_hal_semaphore_t* base_semaphore, uint64_t* out_value) {
   iree_hal_hip_semaphore_t* semaphore =
@@ -158,10 +178,9 @@ static iree_status_t iree_hal_hip_semaphore_signal(
   // Notify timepoints - note that this must happen outside the lock.
   iree_hal_semaphore_notify(&semaphore->base, new_value, IREE_STATUS_OK);
 
-  // Advance the deferred work queue if possible. This also must happen
+  // Advance the deferred work queues if possible. This also must happen
   // outside the lock to avoid nesting.
-  iree_status_t status =
-      iree_hal_deferred_work_queue_issue(semaphore->work_queue);
+  iree_status_t status = iree_hal_hip_semaphore_issue_work_queues(semaphore);
 
   IREE_TRACE_ZONE_END(z0);
   return status;
@@ -197,9 +216,9 @@ static void iree_hal_hip_semaphore_fail(iree_hal_semaphore_t* base_semaphore,
   iree_hal_semaphore_notify(&semaphore->base, IREE_HAL_SEMAPHORE_FAILURE_VALUE,
                             status_code);
 
-  // Advance the deferred work queue if possible. This also must happen
+  // Advance the deferred work queues if possible. This also must happen
   // outside the lock to avoid nesting.
-  status = iree_hal_deferred_work_queue_issue(semaphore->work_queue);
+  status = iree_hal_hip_semaphore_issue_work_queues(semaphore);
   iree_status_ignore(status);
 
   IREE_TRACE_ZONE_END(z0);
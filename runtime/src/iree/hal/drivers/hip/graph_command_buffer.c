@@ -14,6 +14,7 @@
 #include "iree/hal/drivers/hip/dynamic_symbols.h"
 #include "iree/hal/drivers/hip/hip_buffer.h"
 #include "iree/hal/drivers/hip/native_executable.h"
+#include "iree/hal/drivers/hip/rccl_channel.h"
 #include "iree/hal/drivers/hip/status_util.h"
 #include "iree/hal/utils/collective_batch.h"
 #include "iree/hal/utils/resource_set.h"
@@ -30,6 +31,7 @@ typedef struct iree_hal_hip_graph_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
   const iree_hal_hip_dynamic_symbols_t* symbols;
+  const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols;
 
   // Per-stream HIP tracing context.
   iree_hal_stream_tracing_context_t* tracing_context;
@@ -58,6 +60,10 @@ typedef struct iree_hal_hip_graph_command_buffer_t {
 
   // Iteratively constructed batch of collective operations.
   iree_hal_collective_batch_t collective_batch;
+
+  // Stream used only to capture collective operations into child graphs.
+  // Created on first use as most command buffers have no collectives.
+  hipStream_t capture_stream;
 } iree_hal_hip_graph_command_buffer_t;
 
 static const iree_hal_command_buffer_vtable_t
@@ -164,6 +170,7 @@ static void iree_hip_graph_command_buffer_trace_zone_end(
 iree_status_t iree_hal_hip_graph_command_buffer_create(
     iree_hal_allocator_t* device_allocator,
     const iree_hal_hip_dynamic_symbols_t* hip_symbols,
+    const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols,
     iree_hal_stream_tracing_context_t* tracing_context, hipCtx_t context,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
@@ -199,15 +206,17 @@ iree_status_t iree_hal_hip_graph_command_buffer_create(
       &iree_hal_hip_graph_command_buffer_vtable, &command_buffer->base);
   command_buffer->host_allocator = host_allocator;
   command_buffer->symbols = hip_symbols;
+  command_buffer->nccl_symbols = nccl_symbols;
   command_buffer->tracing_context = tracing_context;
-  command_buffer->tracing_event_list.head = NULL;
-  command_buffer->tracing_event_list.tail = NULL;
+  iree_hal_stream_tracing_context_event_list_initialize(
+      &command_buffer->tracing_event_list);
   iree_arena_initialize(block_pool, &command_buffer->arena);
   command_buffer->hip_context = context;
   command_buffer->hip_graph = NULL;
   command_buffer->hip_exec = NULL;
   command_buffer->hip_barrier_node = NULL;
   command_buffer->graph_node_count = 0;
+  command_buffer->capture_stream = NULL;
 
   iree_status_t status =
       iree_hal_resource_set_allocate(block_pool, &command_buffer->resource_set);
@@ -253,6 +262,11 @@ static void iree_hal_hip_graph_command_buffer_destroy(
   }
   command_buffer->hip_barrier_node = NULL;
   command_buffer->graph_node_count = 0;
+  if (command_buffer->capture_stream != NULL) {
+    IREE_HIP_IGNORE_ERROR(command_buffer->symbols,
+                          hipStreamDestroy(command_buffer->capture_stream));
+    command_buffer->capture_stream = NULL;
+  }
 
   iree_hal_collective_batch_deinitialize(&command_buffer->collective_batch);
   iree_hal_resource_set_free(command_buffer->resource_set);
@@ -301,27 +315,74 @@ static iree_status_t iree_hal_hip_graph_command_buffer_flush_collectives(
   }
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // TODO(#9580): use HIP graph capture so that the NCCL calls end up in the
-  // graph:
-  // https://docs.nvidia.com/deeplearning/nccl/user-guide/docs/usage/hipgraph.html
-  //
-  // Something like:
-  //  syms->cuStreamBeginCapture(nccl_stream);
-  //  iree_hal_hip_nccl_submit_batch(command_buffer->context,
-  //                                  &command_buffer->collective_batch,
-  //                                  nccl_stream);
-  //  syms->cuStreamEndCapture(nccl_stream, &child_graph);
-  //  syms->cuGraphAddChildGraphNode(..., child_graph);
-  //  syms->cuGraphDestroy(child_graph);  // probably, I think it gets cloned
-  //
-  // Note that we'll want to create a scratch stream that we use to perform the
-  // capture - we could memoize that on the command buffer or on the device
-  // (though that introduces potential threading issues). There may be a special
-  // stream mode for these capture-only streams that is lighter weight than a
-  // normal stream.
-  iree_status_t status = iree_make_status(
-      IREE_STATUS_UNIMPLEMENTED,
-      "HIP graph capture of collective operations not yet implemented");
+  const iree_hal_hip_dynamic_symbols_t* symbols = command_buffer->symbols;
+  iree_status_t status = iree_ok_status();
+  if (!command_buffer->nccl_symbols || !command_buffer->nccl_symbols->dylib) {
+    status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "RCCL is unavailable; collective operations "
+                              "cannot be recorded");
+  } else if (!symbols->hipStreamBeginCapture || !symbols->hipStreamEndCapture ||
+             !symbols->hipGraphAddChildGraphNode) {
+    status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "missing HIP stream capture symbols; cannot "
+                              "record collective operations into graphs");
+  } else if (command_buffer->graph_node_count >=
+             IREE_HAL_HIP_MAX_CONCURRENT_GRAPH_NODE_COUNT) {
+    status = iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "exceeded max concurrent node limit");
+  }
+
+  // Lazily create the stream used for capture. It never executes any work.
+  if (iree_status_is_ok(status) && command_buffer->capture_stream == NULL) {
+    status = IREE_HIP_RESULT_TO_STATUS(
+        symbols,
+        hipStreamCreateWithFlags(&command_buffer->capture_stream,
+                                 hipStreamNonBlocking),
+        "hipStreamCreateWithFlags");
+  }
+
+  // Capture the RCCL calls for the whole batch into a child graph. The capture
+  // is thread-local so that other threads using HIP streams are unaffected.
+  // Tracing zones are not captured as their events would need to outlive the
+  // graph.
+  hipGraph_t child_graph = NULL;
+  if (iree_status_is_ok(status)) {
+    status = IREE_HIP_RESULT_TO_STATUS(
+        symbols,
+        hipStreamBeginCapture(command_buffer->capture_stream,
+                              hipStreamCaptureModeThreadLocal),
+        "hipStreamBeginCapture");
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_hip_nccl_submit_batch(
+          command_buffer->nccl_symbols, /*tracing_context=*/NULL,
+          /*tracing_event_list=*/NULL, &command_buffer->collective_batch,
+          command_buffer->capture_stream);
+      // Always end the capture so that the stream is usable again.
+      status = iree_status_join(
+          status,
+          IREE_HIP_RESULT_TO_STATUS(
+              symbols,
+              hipStreamEndCapture(command_buffer->capture_stream, &child_graph),
+              "hipStreamEndCapture"));
+    }
+  }
+
+  // Add the captured graph as a node that runs concurrently with the other
+  // nodes since the last barrier. The child graph is cloned into the node.
+  if (iree_status_is_ok(status)) {
+    size_t dependency_count = command_buffer->hip_barrier_node ? 1 : 0;
+    status = IREE_HIP_RESULT_TO_STATUS(
+        symbols,
+        hipGraphAddChildGraphNode(
+            &command_buffer
+                 ->hip_graph_nodes[command_buffer->graph_node_count++],
+            command_buffer->hip_graph, &command_buffer->hip_barrier_node,
+            dependency_count, child_graph),
+        "hipGraphAddChildGraphNode");
+  }
+  if (child_graph != NULL) {
+    IREE_HIP_IGNORE_ERROR(symbols, hipGraphDestroy(child_graph));
+  }
 
   iree_hal_collective_batch_clear(&command_buffer->collective_batch);
   IREE_TRACE_ZONE_END(z0);
@@ -760,29 +821,27 @@ static iree_status_t iree_hal_hip_graph_command_buffer_dispatch(
       z0, iree_hal_resource_set_insert(command_buffer->resource_set, 1,
                                        &executable));
 
-  // We append push constants to the end of descriptors to form a linear chain
-  // of kernel arguments.
-  iree_host_size_t kernel_params_count =
-      kernel_params->binding_count + kernel_params->constant_count;
-  iree_host_size_t kernel_params_length = kernel_params_count * sizeof(void*);
-
-  // TODO: use packed parameters instead of the indirection mechanism - this
-  // would avoid additional driver overhead to reflect and repack them all.
-  //
-  // Each kernel_params[i] is itself a pointer to the corresponding
-  // element at the *second* inline allocation at the end of the current
-  // segment.
-  iree_host_size_t total_size = kernel_params_length * 2;
-  uint8_t* storage_base = NULL;
+  // Kernel arguments are passed packed in a single buffer matching the kernel
+  // argument layout: all binding pointers followed by all 32-bit push
+  // constants. This avoids the driver reflecting on the kernel and repacking
+  // each argument through a pointer indirection when adding the node. The
+  // buffer and the launch config referencing it live in the arena as the graph
+  // captures them when the node is added.
+  iree_host_size_t bindings_length =
+      kernel_params->binding_count * sizeof(hipDeviceptr_t);
+  iree_host_size_t constants_length =
+      kernel_params->constant_count * sizeof(uint32_t);
+  size_t* packed_length = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_arena_allocate(&command_buffer->arena, total_size,
-                              (void**)&storage_base));
-  void** params_ptr = (void**)storage_base;
-  hipDeviceptr_t* payload_ptr =
-      (hipDeviceptr_t*)((uint8_t*)params_ptr + kernel_params_length);
-  for (size_t i = 0; i < kernel_params_count; i++) {
-    params_ptr[i] = &payload_ptr[i];
-  }
+      z0, iree_arena_allocate(&command_buffer->arena, sizeof(*packed_length),
+                              (void**)&packed_length));
+  *packed_length = bindings_length + constants_length;
+  uint8_t* packed_params = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(&command_buffer->arena,
+                              iree_max(*packed_length, 1),
+                              (void**)&packed_params));
+  hipDeviceptr_t* binding_ptrs = (hipDeviceptr_t*)packed_params;
   for (iree_host_size_t i = 0; i < bindings.count; i++) {
     const iree_hal_buffer_ref_t* binding = &bindings.values[i];
     hipDeviceptr_t device_ptr = NULL;
@@ -795,17 +854,19 @@ static iree_status_t iree_hal_hip_graph_command_buffer_dispatch(
       iree_device_size_t offset = iree_hal_buffer_byte_offset(binding->buffer);
       device_ptr = (uint8_t*)device_buffer + offset + binding->offset;
     }
-    payload_ptr[i] = device_ptr;
+    binding_ptrs[i] = device_ptr;
   }
+  memcpy(packed_params + bindings_length, constants.data, constants_length);
 
-  // Each kernel parameter points to is a hipDeviceptr_t, which as the size of a
-  // pointer on the target machine. we are just storing a 32-bit value for the
-  // push constant here instead. So we must process one element each type, for
-  // 64-bit machines.
-  for (iree_host_size_t i = 0; i < kernel_params->constant_count; i++) {
-    *((uint32_t*)params_ptr[kernel_params->binding_count + i]) =
-        ((const uint32_t*)constants.data)[i];
-  }
+  void** launch_config = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(&command_buffer->arena, 5 * sizeof(void*),
+                              (void**)&launch_config));
+  launch_config[0] = HIP_LAUNCH_PARAM_BUFFER_POINTER;
+  launch_config[1] = packed_params;
+  launch_config[2] = HIP_LAUNCH_PARAM_BUFFER_SIZE;
+  launch_config[3] = packed_length;
+  launch_config[4] = HIP_LAUNCH_PARAM_END;
 
   hipKernelNodeParams params = {
       .blockDim.x = kernel_params->block_dims[0],
@@ -815,7 +876,8 @@ static iree_status_t iree_hal_hip_graph_command_buffer_dispatch(
       .gridDim.y = workgroup_count[1],
       .gridDim.z = workgroup_count[2],
       .func = kernel_params->function,
-      .kernelParams = params_ptr,
+      .kernelParams = NULL,
+      .extra = launch_config,
       .sharedMemBytes = kernel_params->block_shared_memory_size,
   };
 
@@ -11,6 +11,7 @@
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/hip/dynamic_symbols.h"
 #include "iree/hal/drivers/hip/hip_headers.h"
+#include "iree/hal/drivers/hip/rccl_dynamic_symbols.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -26,11 +27,16 @@ typedef struct iree_hal_stream_tracing_context_t
 
 // Creates a command buffer that records into a HIP graph.
 //
+// Collective operations are captured into the graph from |nccl_symbols| calls
+// issued on a capture-only stream. |nccl_symbols| may be NULL if RCCL is not
+// available in which case recording collectives fails.
+//
 // NOTE: the |block_pool| must remain live for the lifetime of the command
 // buffers that use it.
 iree_status_t iree_hal_hip_graph_command_buffer_create(
     iree_hal_allocator_t* device_allocator,
     const iree_hal_hip_dynamic_symbols_t* hip_symbols,
+    const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols,
     iree_hal_stream_tracing_context_t* tracing_context, hipCtx_t context,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
@@ -7,6 +7,7 @@
 #include "iree/hal/drivers/hip/hip_allocator.h"
 
 #include <stddef.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/tracing.h"
@@ -148,6 +149,18 @@ static void iree_hal_hip_allocator_query_statistics(
   });
 }
 
+static void iree_hal_hip_allocator_reset_capture_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  IREE_STATISTICS({
+    iree_hal_hip_allocator_t* allocator =
+        iree_hal_hip_allocator_cast(base_allocator);
+    iree_hal_allocator_statistics_reset_capture(&allocator->statistics);
+    if (allocator->pools) {
+      iree_hal_hip_memory_pools_reset_capture_statistics(allocator->pools);
+    }
+  });
+}
+
 static iree_status_t iree_hal_hip_allocator_query_memory_heaps(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_host_size_t capacity,
@@ -314,6 +327,14 @@ static void iree_hal_hip_buffer_free(
       IREE_TRACE_ZONE_APPEND_TEXT(z0, "(ignored; external)");
       break;
     }
+    case IREE_HAL_HIP_BUFFER_TYPE_PEER: {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "(ignored; peer)");
+      break;
+    }
+    case IREE_HAL_HIP_BUFFER_TYPE_VIRTUAL: {
+      IREE_TRACE_ZONE_APPEND_TEXT(z0, "(ignored; virtual)");
+      break;
+    }
   }
   IREE_TRACE_ZONE_END(z0);
 }
@@ -470,6 +491,58 @@ static void iree_hal_hip_allocator_deallocate_buffer(
   iree_hal_buffer_destroy(base_buffer);
 }
 
+// Resolves the device owning the device allocation |device_ptr|. If the
+// allocation is owned by a peer device then peer access is enabled from the
+// allocator device and |out_peer_device| receives the owning device ordinal.
+// It is -1 if the allocation is local to the allocator device.
+//
+// Devices without peer access can only copy from and to peer allocations
+// (staged by the driver) and importing them for any other usage fails.
+// Expects the allocator context to be current.
+static iree_status_t iree_hal_hip_allocator_resolve_peer_device(
+    iree_hal_hip_allocator_t* allocator, hipDeviceptr_t device_ptr,
+    iree_hal_buffer_usage_t usage, int* out_peer_device) {
+  *out_peer_device = -1;
+
+  hipPointerAttribute_t attributes;
+  memset(&attributes, 0, sizeof(attributes));
+  IREE_HIP_RETURN_IF_ERROR(allocator->symbols,
+                           hipPointerGetAttributes(&attributes, device_ptr),
+                           "hipPointerGetAttributes");
+  if (attributes.device < 0 || attributes.device == allocator->device) {
+    return iree_ok_status();
+  }
+
+  int can_access_peer = 0;
+  IREE_HIP_RETURN_IF_ERROR(
+      allocator->symbols,
+      hipDeviceCanAccessPeer(&can_access_peer, allocator->device,
+                             attributes.device),
+      "hipDeviceCanAccessPeer");
+  if (!can_access_peer) {
+    if (iree_any_bit_set(usage, ~IREE_HAL_BUFFER_USAGE_TRANSFER)) {
+      return iree_make_status(
+          IREE_STATUS_UNAVAILABLE,
+          "device allocation is owned by device %d which is not accessible "
+          "as a peer; only transfer usage is supported",
+          attributes.device);
+    }
+    *out_peer_device = attributes.device;
+    return iree_ok_status();
+  }
+
+  // Enabling peer access persists for the lifetime of the device so it is fine
+  // if a prior import already enabled it.
+  hipError_t result =
+      allocator->symbols->hipDeviceEnablePeerAccess(attributes.device, 0);
+  if (result != hipSuccess && result != hipErrorPeerAccessAlreadyEnabled) {
+    return iree_hal_hip_result_to_status(allocator->symbols, result, __FILE__,
+                                         __LINE__);
+  }
+  *out_peer_device = attributes.device;
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_hip_allocator_import_buffer(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
@@ -515,6 +588,7 @@ static iree_status_t iree_hal_hip_allocator_import_buffer(
   iree_hal_hip_buffer_type_t buffer_type = IREE_HAL_HIP_BUFFER_TYPE_DEVICE;
   void* host_ptr = NULL;
   hipDeviceptr_t device_ptr = NULL;
+  int peer_device = -1;
 
   switch (external_buffer->type) {
     case IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION: {
@@ -543,6 +617,9 @@ static iree_status_t iree_hal_hip_allocator_import_buffer(
       buffer_type = IREE_HAL_HIP_BUFFER_TYPE_EXTERNAL;
       device_ptr =
           (hipDeviceptr_t)external_buffer->handle.device_allocation.ptr;
+      status = iree_hal_hip_allocator_resolve_peer_device(
+          allocator, device_ptr, compat_params.usage, &peer_device);
+      if (peer_device >= 0) buffer_type = IREE_HAL_HIP_BUFFER_TYPE_PEER;
       break;
     }
     case IREE_HAL_EXTERNAL_BUFFER_TYPE_OPAQUE_FD:
@@ -564,6 +641,9 @@ static iree_status_t iree_hal_hip_allocator_import_buffer(
         host_ptr, release_callback,
         iree_hal_allocator_host_allocator(base_allocator), &buffer);
   }
+  if (iree_status_is_ok(status) && peer_device >= 0) {
+    iree_hal_hip_buffer_set_peer_device(buffer, peer_device);
+  }
 
   if (iree_status_is_ok(status)) {
     *out_buffer = buffer;
@@ -591,6 +671,7 @@ static iree_status_t iree_hal_hip_allocator_export_buffer(
       switch (buffer_type) {
         case IREE_HAL_HIP_BUFFER_TYPE_DEVICE:
         case IREE_HAL_HIP_BUFFER_TYPE_EXTERNAL:
+        case IREE_HAL_HIP_BUFFER_TYPE_PEER:
           out_external_buffer->flags = requested_flags;
           out_external_buffer->type = requested_type;
           out_external_buffer->handle.device_allocation.ptr =
@@ -668,6 +749,7 @@ static const iree_hal_allocator_vtable_t iree_hal_hip_allocator_vtable = {
     .host_allocator = iree_hal_hip_allocator_host_allocator,
     .trim = iree_hal_hip_allocator_trim,
     .query_statistics = iree_hal_hip_allocator_query_statistics,
+    .reset_capture_statistics = iree_hal_hip_allocator_reset_capture_statistics,
     .query_memory_heaps = iree_hal_hip_allocator_query_memory_heaps,
     .query_buffer_compatibility =
         iree_hal_hip_allocator_query_buffer_compatibility,
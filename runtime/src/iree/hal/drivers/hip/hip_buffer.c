@@ -19,6 +19,8 @@ typedef struct iree_hal_hip_buffer_t {
   iree_hal_hip_buffer_type_t type;
   void* host_ptr;
   hipDeviceptr_t device_ptr;
+  // Ordinal of the device owning |device_ptr| when it is a peer allocation.
+  int peer_device;
   iree_hal_buffer_release_callback_t release_callback;
   iree_slim_mutex_t device_ptr_lock;
   iree_notification_t device_ptr_notification;
@@ -68,6 +70,7 @@ iree_status_t iree_hal_hip_buffer_wrap(
     buffer->type = buffer_type;
     buffer->host_ptr = host_ptr;
     buffer->device_ptr = device_ptr;
+    buffer->peer_device = -1;
     buffer->release_callback = release_callback;
     buffer->empty = false;
     iree_slim_mutex_initialize(&buffer->device_ptr_lock);
@@ -195,6 +198,26 @@ void* iree_hal_hip_buffer_host_pointer(const iree_hal_buffer_t* base_buffer) {
   return buffer->host_ptr;
 }
 
+int iree_hal_hip_buffer_peer_device(const iree_hal_buffer_t* base_buffer) {
+  const iree_hal_hip_buffer_t* buffer =
+      iree_hal_hip_buffer_const_cast(base_buffer);
+  return buffer->peer_device;
+}
+
+void iree_hal_hip_buffer_set_peer_device(iree_hal_buffer_t* base_buffer,
+                                         int peer_device) {
+  iree_hal_hip_buffer_t* buffer = iree_hal_hip_buffer_cast(base_buffer);
+  IREE_ASSERT_EQ(buffer->type, IREE_HAL_HIP_BUFFER_TYPE_PEER);
+  buffer->peer_device = peer_device;
+}
+
+void* iree_hal_hip_buffer_release_user_data(
+    const iree_hal_buffer_t* base_buffer) {
+  const iree_hal_hip_buffer_t* buffer =
+      iree_hal_hip_buffer_const_cast(base_buffer);
+  return buffer->release_callback.user_data;
+}
+
 void iree_hal_hip_buffer_drop_release_callback(iree_hal_buffer_t* base_buffer) {
   iree_hal_hip_buffer_t* buffer = iree_hal_hip_buffer_cast(base_buffer);
   buffer->release_callback = iree_hal_buffer_release_callback_null();
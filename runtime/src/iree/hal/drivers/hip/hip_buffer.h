@@ -30,6 +30,13 @@ typedef enum iree_hal_hip_buffer_type_e {
   // Externally registered buffer whose providence is unknown.
   // Must be freed by the user.
   IREE_HAL_HIP_BUFFER_TYPE_EXTERNAL,
+  // Externally registered device allocation owned by a peer device. Copies
+  // must use hipMemcpyPeerAsync. Must be freed by the user.
+  IREE_HAL_HIP_BUFFER_TYPE_PEER,
+  // Device local buffer backed by a virtual address range reserved with
+  // hipMemAddressReserve into which physical memory is mapped on demand with
+  // hipMemCreate/hipMemMap. Released with hipMemUnmap/hipMemAddressFree.
+  IREE_HAL_HIP_BUFFER_TYPE_VIRTUAL,
 } iree_hal_hip_buffer_type_t;
 
 // Wraps a HIP allocation in an iree_hal_buffer_t.
@@ -63,6 +70,20 @@ void iree_hal_hip_buffer_set_allocation_empty(iree_hal_buffer_t* buffer);
 // Returns the HIP host pointer for the given |buffer|, if available.
 void* iree_hal_hip_buffer_host_pointer(const iree_hal_buffer_t* buffer);
 
+// Returns the ordinal of the peer device owning the allocation of |buffer| or
+// -1 if the buffer is owned by the allocating device.
+int iree_hal_hip_buffer_peer_device(const iree_hal_buffer_t* buffer);
+
+// Sets the |peer_device| ordinal owning the allocation of the given |buffer|.
+// Only valid on IREE_HAL_HIP_BUFFER_TYPE_PEER buffers prior to their use.
+void iree_hal_hip_buffer_set_peer_device(iree_hal_buffer_t* buffer,
+                                         int peer_device);
+
+// Returns the user data of the release callback of |buffer|. Buffer types that
+// track additional state with their allocation (such as
+// IREE_HAL_HIP_BUFFER_TYPE_VIRTUAL) store it here.
+void* iree_hal_hip_buffer_release_user_data(const iree_hal_buffer_t* buffer);
+
 // Drops the release callback so that when the buffer is destroyed no callback
 // will be made. This is not thread safe but all callers are expected to be
 // holding an allocation and the earliest the buffer could be destroyed is after
@@ -28,16 +28,30 @@
 #include "iree/hal/drivers/hip/status_util.h"
 #include "iree/hal/drivers/hip/stream_command_buffer.h"
 #include "iree/hal/drivers/hip/timepoint_pool.h"
+#include "iree/hal/drivers/hip/virtual_buffer.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
 #include "iree/hal/utils/deferred_work_queue.h"
+#include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
-#include "iree/hal/utils/memory_file.h"
 #include "iree/hal/utils/stream_tracing.h"
 
 //===----------------------------------------------------------------------===//
 // iree_hal_hip_device_t
 //===----------------------------------------------------------------------===//
 
+// A HIP stream owned by the device along with the deferred work queue that
+// orders submissions to it.
+typedef struct iree_hal_hip_device_stream_t {
+  hipStream_t hip_stream;
+  // A queue to order device workloads and relase to the GPU when constraints
+  // are met. It buffers submissions and allocations internally before they
+  // are ready. This queue couples with HAL semaphores backed by iree_event_t
+  // and hipEvent_t objects.
+  iree_hal_deferred_work_queue_t* work_queue;
+  // Tracing context recording events on |hip_stream|; NULL if disabled.
+  iree_hal_stream_tracing_context_t* tracing_context;
+} iree_hal_hip_device_stream_t;
+
 typedef struct iree_hal_hip_device_t {
   // Abstract resource used for injecting reference counting and vtable;
   // must be at offset 0.
@@ -53,6 +67,10 @@ typedef struct iree_hal_hip_device_t {
   iree_hal_driver_t* driver;
 
   const iree_hal_hip_dynamic_symbols_t* hip_symbols;
+  // NCCL symbols owned by the driver that are loaded when the first collective
+  // channel is created. |nccl_symbols| aliases the loaded symbols and must only
+  // be used by collective operations as those require a channel.
+  iree_hal_hip_nccl_lazy_dynamic_symbols_t* nccl_lazy_symbols;
   const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols;
 
   // Parameters used to control device behavior.
@@ -60,11 +78,17 @@ typedef struct iree_hal_hip_device_t {
 
   hipCtx_t hip_context;
   hipDevice_t hip_device;
-  // TODO: Support multiple device streams.
-  // The hipStream_t used to issue device kernels and allocations.
-  hipStream_t hip_dispatch_stream;
 
-  iree_hal_stream_tracing_context_t* tracing_context;
+  // Streams backing the HAL queues. The first |params.queue_count| streams are
+  // used to issue device kernels and allocations with one per queue. If
+  // |params.transfer_streams| is set the remaining streams are used for
+  // transfer-only command buffers with one per queue. Cross-stream ordering is
+  // established by the hipEvent_t timepoints of the semaphores.
+  iree_host_size_t stream_count;
+  iree_hal_hip_device_stream_t* streams;
+  // The work queues of |streams| in the same order; shared with semaphores so
+  // that signals can advance all streams.
+  iree_hal_deferred_work_queue_t** work_queues;
 
   iree_allocator_t host_allocator;
 
@@ -74,12 +98,6 @@ typedef struct iree_hal_hip_device_t {
   // Timepoint pools, shared by various semaphores.
   iree_hal_hip_timepoint_pool_t* timepoint_pool;
 
-  // A queue to order device workloads and relase to the GPU when constraints
-  // are met. It buffers submissions and allocations internally before they
-  // are ready. This queue couples with HAL semaphores backed by iree_event_t
-  // and hipEvent_t objects.
-  iree_hal_deferred_work_queue_t* work_queue;
-
   // Device memory pools and allocators.
   bool supports_memory_pools;
   iree_hal_hip_memory_pools_t memory_pools;
@@ -105,11 +123,19 @@ typedef struct iree_hal_hip_deferred_work_queue_device_interface_t {
   iree_hal_device_t* device;
   hipDevice_t hip_device;
   hipCtx_t hip_context;
-  hipStream_t dispatch_hip_stream;
+  // The device stream this interface issues work to.
+  iree_hal_hip_device_stream_t* stream;
   iree_allocator_t host_allocator;
   const iree_hal_hip_dynamic_symbols_t* hip_symbols;
 } iree_hal_hip_deferred_work_queue_device_interface_t;
 
+static iree_status_t iree_hal_hip_device_create_stream_command_buffer_on(
+    iree_hal_hip_device_t* device, iree_hal_hip_device_stream_t* stream,
+    iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer);
+
 static void iree_hal_hip_deferred_work_queue_device_interface_destroy(
     iree_hal_deferred_work_queue_device_interface_t* base_device_interface) {
   iree_hal_hip_deferred_work_queue_device_interface_t* device_interface =
@@ -135,7 +161,7 @@ iree_hal_hip_deferred_work_queue_device_interface_wait_native_event(
       (iree_hal_hip_deferred_work_queue_device_interface_t*)(base_device_interface);
   return IREE_HIP_RESULT_TO_STATUS(
       device_interface->hip_symbols,
-      hipStreamWaitEvent(device_interface->dispatch_hip_stream,
+      hipStreamWaitEvent(device_interface->stream->hip_stream,
                          (hipEvent_t)event, 0),
       "hipStreamWaitEvent");
 }
@@ -158,7 +184,7 @@ iree_hal_hip_deferred_work_queue_device_interface_record_native_event(
       (iree_hal_hip_deferred_work_queue_device_interface_t*)(base_device_interface);
   return IREE_HIP_RESULT_TO_STATUS(
       device_interface->hip_symbols,
-      hipEventRecord((hipEvent_t)event, device_interface->dispatch_hip_stream),
+      hipEventRecord((hipEvent_t)event, device_interface->stream->hip_stream),
       "hipEventRecord");
 }
 
@@ -209,7 +235,7 @@ iree_hal_hip_deferred_work_queue_device_interface_device_wait_on_host_event(
   return IREE_HIP_RESULT_TO_STATUS(
       device_interface->hip_symbols,
       hipStreamWaitEvent(
-          device_interface->dispatch_hip_stream,
+          device_interface->stream->hip_stream,
           iree_hal_hip_event_handle((iree_hal_hip_event_t*)wait_event), 0),
       "hipStreamWaitEvent");
 }
@@ -236,14 +262,18 @@ iree_hal_hip_deferred_work_queue_device_interface_create_stream_command_buffer(
     iree_hal_command_buffer_t** out) {
   iree_hal_hip_deferred_work_queue_device_interface_t* device_interface =
       (iree_hal_hip_deferred_work_queue_device_interface_t*)(base_device_interface);
-  return iree_hal_hip_device_create_stream_command_buffer(
-      device_interface->device, mode, categories, 0, out);
+  return iree_hal_hip_device_create_stream_command_buffer_on(
+      iree_hal_hip_device_cast(device_interface->device),
+      device_interface->stream, mode, categories, 0, out);
 }
 
 static iree_status_t
 iree_hal_hip_deferred_work_queue_device_interface_submit_command_buffer(
     iree_hal_deferred_work_queue_device_interface_t* device_interface,
-    iree_hal_command_buffer_t* command_buffer) {
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
+  // HIP graph command buffers are only created without binding tables; any
+  // indirect command buffers are deferred and resolved by the work queue.
   iree_hal_hip_deferred_work_queue_device_interface_t* table =
       (iree_hal_hip_deferred_work_queue_device_interface_t*)(device_interface);
   iree_status_t status = iree_ok_status();
@@ -254,7 +284,7 @@ iree_hal_hip_deferred_work_queue_device_interface_submit_command_buffer(
     hipGraphExec_t exec =
         iree_hal_hip_graph_command_buffer_handle(command_buffer);
     status = IREE_HIP_RESULT_TO_STATUS(
-        table->hip_symbols, hipGraphLaunch(exec, table->dispatch_hip_stream));
+        table->hip_symbols, hipGraphLaunch(exec, table->stream->hip_stream));
     if (IREE_LIKELY(iree_status_is_ok(status))) {
       iree_hal_hip_graph_tracing_notify_submitted_commands(command_buffer);
     }
@@ -273,13 +303,13 @@ iree_hal_hip_deferred_work_queue_device_interface_async_alloc(
       iree_hal_hip_device_cast(device_interface->device);
   if (device->supports_memory_pools) {
     return iree_hal_hip_memory_pools_allocate_pointer(
-        &device->memory_pools, buffer, device->hip_dispatch_stream,
+        &device->memory_pools, buffer, device_interface->stream->hip_stream,
         iree_hal_buffer_allocation_size(buffer));
   }
 
   return iree_hal_hip_allocator_alloc_async(
       iree_hal_device_allocator(device_interface->device),
-      device->hip_dispatch_stream, buffer);
+      device_interface->stream->hip_stream, buffer);
 }
 
 // Asynchronously frees a buffer.
@@ -294,11 +324,11 @@ iree_hal_hip_deferred_work_queue_device_interface_async_dealloc(
       iree_hal_hip_device_cast(device_interface->device);
   if (device->supports_memory_pools) {
     return iree_hal_hip_memory_pools_deallocate(
-        &device->memory_pools, device->hip_dispatch_stream, buffer);
+        &device->memory_pools, device_interface->stream->hip_stream, buffer);
   }
   return iree_hal_hip_allocator_free_async(
       iree_hal_device_allocator(device_interface->device),
-      device->hip_dispatch_stream, buffer);
+      device_interface->stream->hip_stream, buffer);
 }
 
 typedef struct iree_hal_hip_tracing_device_interface_t {
@@ -420,12 +450,133 @@ IREE_API_EXPORT void iree_hal_hip_device_params_initialize(
   out_params->arena_block_size = 32 * 1024;
   out_params->event_pool_capacity = 32;
   out_params->queue_count = 1;
+  out_params->transfer_streams = true;
   out_params->command_buffer_mode = IREE_HAL_HIP_COMMAND_BUFFER_MODE_STREAM;
   out_params->stream_tracing = 0;
   out_params->async_allocations = true;
   out_params->allow_inline_execution = false;
 }
 
+static iree_status_t iree_hal_hip_device_check_dispatch_statistics(
+    iree_hal_device_t* base_device) {
+  if (!iree_hal_resource_is(base_device, &iree_hal_hip_device_vtable)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "device is not a HIP device");
+  }
+  iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
+  if (!device->params.dispatch_statistics) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "device was not created with dispatch statistics "
+                            "enabled");
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_hip_device_query_dispatch_statistics(
+    iree_hal_device_t* base_device, iree_host_size_t capacity,
+    iree_hal_hip_dispatch_statistics_t* out_statistics,
+    iree_host_size_t* out_count, uint64_t* out_dropped_count) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(!capacity || out_statistics);
+  IREE_ASSERT_ARGUMENT(out_count);
+  *out_count = 0;
+  if (out_dropped_count) *out_dropped_count = 0;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_hip_device_check_dispatch_statistics(base_device));
+  iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_stream_tracing_statistics_t* statistics = NULL;
+  if (capacity > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(device->host_allocator,
+                                  capacity * sizeof(*statistics),
+                                  (void**)&statistics));
+  }
+  iree_host_size_t count = 0;
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < device->stream_count && iree_status_is_ok(status); ++i) {
+    status = iree_hal_stream_tracing_context_merge_statistics(
+        device->streams[i].tracing_context, capacity, statistics, &count,
+        out_dropped_count);
+  }
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    out_statistics[i].name = statistics[i].name;
+    out_statistics[i].count = statistics[i].count;
+    out_statistics[i].total_ns = statistics[i].total_ns;
+    out_statistics[i].min_ns = statistics[i].min_ns;
+    out_statistics[i].max_ns = statistics[i].max_ns;
+  }
+  *out_count = count;
+  iree_allocator_free(device->host_allocator, statistics);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_hip_device_reset_dispatch_statistics(iree_hal_device_t* base_device) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_hip_device_check_dispatch_statistics(base_device));
+  iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
+  for (iree_host_size_t i = 0; i < device->stream_count; ++i) {
+    iree_hal_stream_tracing_context_reset_statistics(
+        device->streams[i].tracing_context);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_hip_device_allocate_growable_buffer(
+    iree_hal_device_t* base_device, iree_hal_buffer_params_t params,
+    iree_device_size_t reserved_size, iree_device_size_t committed_size,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  if (!iree_hal_resource_is(base_device, &iree_hal_hip_device_vtable)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "device is not a HIP device");
+  }
+  iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
+  return iree_hal_hip_virtual_buffer_allocate(
+      device->hip_symbols, device->hip_context, device->hip_device, params,
+      reserved_size, committed_size, device->host_allocator, out_buffer);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_hip_device_queue_grow_buffer(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer, iree_device_size_t minimum_committed_size) {
+  IREE_ASSERT_ARGUMENT(base_device);
+  IREE_ASSERT_ARGUMENT(buffer);
+  if (!iree_hal_resource_is(base_device, &iree_hal_hip_device_vtable)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "device is not a HIP device");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Mapping new physical memory does not disturb the committed range so it is
+  // safe to commit eagerly on the host while prior work is in-flight. Only
+  // work waiting on the signal may touch the new range so the grow itself is
+  // ordered on the queue with a barrier.
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_hip_virtual_buffer_commit(buffer, minimum_committed_size));
+  iree_status_t status = iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_device_size_t
+iree_hal_hip_buffer_committed_size(iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  return iree_hal_hip_virtual_buffer_committed_size(buffer);
+}
+
 static iree_status_t iree_hal_hip_device_check_params(
     const iree_hal_hip_device_params_t* params) {
   if (params->arena_block_size < 4096) {
@@ -436,92 +587,130 @@ static iree_status_t iree_hal_hip_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "at least one queue is required");
   }
+  if (params->queue_count > sizeof(iree_hal_queue_affinity_t) * 8) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at most one queue per queue affinity bit is "
+                            "supported but %" PRIhsz " were requested",
+                            params->queue_count);
+  }
+  if (params->stream_tracing >= IREE_HAL_STREAM_TRACING_VERBOSITY_MAX ||
+      params->stream_tracing < IREE_HAL_STREAM_TRACING_VERBOSITY_OFF) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "invalid stream_tracing argument: expected to be between %d and %d",
+        IREE_HAL_STREAM_TRACING_VERBOSITY_OFF,
+        IREE_HAL_STREAM_TRACING_VERBOSITY_MAX);
+  }
   return iree_ok_status();
 }
 
-static iree_status_t iree_hal_hip_device_create_internal(
-    iree_hal_driver_t* driver, iree_string_view_t identifier,
-    const iree_hal_hip_device_params_t* params, hipDevice_t hip_device,
-    hipStream_t dispatch_stream, hipCtx_t context,
-    const iree_hal_hip_dynamic_symbols_t* symbols,
-    const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols,
-    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
-  iree_hal_hip_device_t* device = NULL;
-  iree_host_size_t total_size = iree_sizeof_struct(*device) + identifier.size;
-  IREE_RETURN_IF_ERROR(
-      iree_allocator_malloc(host_allocator, total_size, (void**)&device));
+// Creates the HIP stream at |stream_index| along with its deferred work queue
+// and (if enabled) tracing context.
+static iree_status_t iree_hal_hip_device_initialize_stream(
+    iree_hal_hip_device_t* device, iree_host_size_t stream_index) {
+  const iree_hal_hip_dynamic_symbols_t* symbols = device->hip_symbols;
+  iree_allocator_t host_allocator = device->host_allocator;
+  iree_hal_hip_device_stream_t* stream = &device->streams[stream_index];
 
-  iree_hal_resource_initialize(&iree_hal_hip_device_vtable, &device->resource);
-  iree_string_view_append_to_buffer(
-      identifier, &device->identifier,
-      (char*)device + iree_sizeof_struct(*device));
-  iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
-                                   &device->block_pool);
-  device->driver = driver;
-  iree_hal_driver_retain(device->driver);
-  device->hip_symbols = symbols;
-  device->nccl_symbols = nccl_symbols;
-  device->params = *params;
-  device->hip_context = context;
-  device->hip_device = hip_device;
-  device->hip_dispatch_stream = dispatch_stream;
-  device->host_allocator = host_allocator;
+  IREE_RETURN_IF_ERROR(IREE_HIP_RESULT_TO_STATUS(
+      symbols,
+      hipStreamCreateWithFlags(&stream->hip_stream, hipStreamNonBlocking)));
 
   iree_hal_hip_deferred_work_queue_device_interface_t* device_interface;
-  iree_status_t status = iree_allocator_malloc(
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
       host_allocator,
       sizeof(iree_hal_hip_deferred_work_queue_device_interface_t),
-      (void**)&device_interface);
-  if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
-    iree_hal_device_release((iree_hal_device_t*)device);
-    return status;
-  }
+      (void**)&device_interface));
   device_interface->base.vtable =
       &iree_hal_hip_deferred_work_queue_device_interface_vtable;
-  device_interface->hip_context = context;
+  device_interface->hip_context = device->hip_context;
   device_interface->hip_symbols = symbols;
   device_interface->device = (iree_hal_device_t*)device;
-  device_interface->hip_device = hip_device;
-  device_interface->dispatch_hip_stream = dispatch_stream;
+  device_interface->hip_device = device->hip_device;
+  device_interface->stream = stream;
   device_interface->host_allocator = host_allocator;
-  status = iree_hal_deferred_work_queue_create(
+  IREE_RETURN_IF_ERROR(iree_hal_deferred_work_queue_create(
       (iree_hal_deferred_work_queue_device_interface_t*)device_interface,
-      &device->block_pool, host_allocator, &device->work_queue);
-
-  // Enable tracing for the (currently only) stream - no-op if disabled.
-  if (iree_status_is_ok(status) && device->params.stream_tracing) {
-    if (device->params.stream_tracing >=
-            IREE_HAL_STREAM_TRACING_VERBOSITY_MAX ||
-        device->params.stream_tracing < IREE_HAL_STREAM_TRACING_VERBOSITY_OFF) {
-      return iree_make_status(
-          IREE_STATUS_INVALID_ARGUMENT,
-          "invalid stream_tracing argument: expected to be between %d and %d",
-          IREE_HAL_STREAM_TRACING_VERBOSITY_OFF,
-          IREE_HAL_STREAM_TRACING_VERBOSITY_MAX);
-    }
+      &device->block_pool, host_allocator, &stream->work_queue));
+  device->work_queues[stream_index] = stream->work_queue;
 
+  // Enable tracing and/or dispatch statistics for the stream - no-op if
+  // disabled.
+  if (device->params.stream_tracing || device->params.dispatch_statistics) {
     iree_hal_hip_tracing_device_interface_t* tracing_device_interface = NULL;
-    status = iree_allocator_malloc(
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
         host_allocator, sizeof(iree_hal_hip_tracing_device_interface_t),
-        (void**)&tracing_device_interface);
-
-    if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
-      iree_hal_device_release((iree_hal_device_t*)device);
-      return status;
-    }
-
+        (void**)&tracing_device_interface));
     tracing_device_interface->base.vtable =
         &iree_hal_hip_tracing_device_interface_vtable_t;
-    tracing_device_interface->context = context;
-    tracing_device_interface->device = hip_device;
-    tracing_device_interface->dispatch_stream = dispatch_stream;
+    tracing_device_interface->context = device->hip_context;
+    tracing_device_interface->device = device->hip_device;
+    tracing_device_interface->dispatch_stream = stream->hip_stream;
     tracing_device_interface->host_allocator = host_allocator;
     tracing_device_interface->hip_symbols = symbols;
-
-    status = iree_hal_stream_tracing_context_allocate(
+    iree_hal_stream_tracing_mode_t tracing_mode =
+        IREE_HAL_STREAM_TRACING_MODE_NONE;
+    iree_hal_stream_tracing_verbosity_t tracing_verbosity =
+        device->params.stream_tracing;
+    if (device->params.stream_tracing) {
+      tracing_mode |= IREE_HAL_STREAM_TRACING_MODE_TRACY;
+    }
+    if (device->params.dispatch_statistics) {
+      // Dispatch zones are only recorded at fine verbosity.
+      tracing_mode |= IREE_HAL_STREAM_TRACING_MODE_STATISTICS;
+      tracing_verbosity = IREE_HAL_STREAM_TRACING_VERBOSITY_FINE;
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_stream_tracing_context_allocate(
         (iree_hal_stream_tracing_device_interface_t*)tracing_device_interface,
-        device->identifier, device->params.stream_tracing, &device->block_pool,
-        host_allocator, &device->tracing_context);
+        device->identifier, tracing_mode, tracing_verbosity,
+        &device->block_pool, host_allocator, &stream->tracing_context));
+  }
+
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_hip_device_create_internal(
+    iree_hal_driver_t* driver, iree_string_view_t identifier,
+    const iree_hal_hip_device_params_t* params, hipDevice_t hip_device,
+    hipCtx_t context, const iree_hal_hip_dynamic_symbols_t* symbols,
+    iree_hal_hip_nccl_lazy_dynamic_symbols_t* nccl_symbols,
+    iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
+  iree_host_size_t stream_count =
+      params->queue_count * (params->transfer_streams ? 2 : 1);
+  iree_hal_hip_device_t* device = NULL;
+  iree_host_size_t total_size =
+      iree_sizeof_struct(*device) + stream_count * sizeof(device->streams[0]) +
+      stream_count * sizeof(device->work_queues[0]) + identifier.size;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(host_allocator, total_size, (void**)&device));
+
+  iree_hal_resource_initialize(&iree_hal_hip_device_vtable, &device->resource);
+  uint8_t* buffer_ptr = (uint8_t*)device + iree_sizeof_struct(*device);
+  device->streams = (iree_hal_hip_device_stream_t*)buffer_ptr;
+  buffer_ptr += stream_count * sizeof(device->streams[0]);
+  device->work_queues = (iree_hal_deferred_work_queue_t**)buffer_ptr;
+  buffer_ptr += stream_count * sizeof(device->work_queues[0]);
+  iree_string_view_append_to_buffer(identifier, &device->identifier,
+                                    (char*)buffer_ptr);
+  iree_arena_block_pool_initialize(params->arena_block_size, host_allocator,
+                                   &device->block_pool);
+  device->driver = driver;
+  iree_hal_driver_retain(device->driver);
+  device->hip_symbols = symbols;
+  device->nccl_lazy_symbols = nccl_symbols;
+  device->nccl_symbols = &nccl_symbols->symbols;
+  device->params = *params;
+  device->hip_context = context;
+  device->hip_device = hip_device;
+  device->stream_count = stream_count;
+  device->host_allocator = host_allocator;
+
+  // Create all streams up front; partially initialized streams are cleaned up
+  // by the device destroy if any fail.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < stream_count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_hal_hip_device_initialize_stream(device, i);
   }
 
   // Memory pool support is conditional.
@@ -545,7 +734,7 @@ static iree_status_t iree_hal_hip_device_create_internal(
 
   if (iree_status_is_ok(status)) {
     status = iree_hal_hip_allocator_create(
-        symbols, hip_device, context, dispatch_stream,
+        symbols, hip_device, context, device->streams[0].hip_stream,
         device->supports_memory_pools ? &device->memory_pools : NULL,
         host_allocator, &device->device_allocator);
   }
@@ -562,11 +751,12 @@ iree_status_t iree_hal_hip_device_create(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
     const iree_hal_hip_device_params_t* params,
     const iree_hal_hip_dynamic_symbols_t* symbols,
-    const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols, hipDevice_t device,
+    iree_hal_hip_nccl_lazy_dynamic_symbols_t* nccl_symbols, hipDevice_t device,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device) {
   IREE_ASSERT_ARGUMENT(driver);
   IREE_ASSERT_ARGUMENT(params);
   IREE_ASSERT_ARGUMENT(symbols);
+  IREE_ASSERT_ARGUMENT(nccl_symbols);
   IREE_ASSERT_ARGUMENT(out_device);
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -582,20 +772,12 @@ iree_status_t iree_hal_hip_device_create(
     status = IREE_HIP_RESULT_TO_STATUS(symbols, hipCtxSetCurrent(context));
   }
 
-  // Create the default dispatch stream for the device.
-  hipStream_t dispatch_stream = NULL;
-  if (iree_status_is_ok(status)) {
-    status = IREE_HIP_RESULT_TO_STATUS(
-        symbols,
-        hipStreamCreateWithFlags(&dispatch_stream, hipStreamNonBlocking));
-  }
-
   if (iree_status_is_ok(status)) {
+    // NOTE: streams are owned by the device and released with it on failure.
     status = iree_hal_hip_device_create_internal(
-        driver, identifier, params, device, dispatch_stream, context, symbols,
-        nccl_symbols, host_allocator, out_device);
+        driver, identifier, params, device, context, symbols, nccl_symbols,
+        host_allocator, out_device);
   } else {
-    if (dispatch_stream) symbols->hipStreamDestroy(dispatch_stream);
     // NOTE: This function return hipSuccess though doesn't release the
     // primaryCtx by design on HIP/HCC path.
     if (context) symbols->hipDevicePrimaryCtxRelease(device);
@@ -656,8 +838,12 @@ static void iree_hal_hip_device_destroy(iree_hal_device_t* base_device) {
   const iree_hal_hip_dynamic_symbols_t* symbols = device->hip_symbols;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // Destroy the pending workload queue.
-  iree_hal_deferred_work_queue_destroy(device->work_queue);
+  // Destroy the pending workload queues.
+  for (iree_host_size_t i = 0; i < device->stream_count; ++i) {
+    if (device->streams[i].work_queue) {
+      iree_hal_deferred_work_queue_destroy(device->streams[i].work_queue);
+    }
+  }
 
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
@@ -668,7 +854,9 @@ static void iree_hal_hip_device_destroy(iree_hal_device_t* base_device) {
   // Destroy memory pools that hold on to reserved memory.
   iree_hal_hip_memory_pools_deinitialize(&device->memory_pools);
 
-  iree_hal_stream_tracing_context_free(device->tracing_context);
+  for (iree_host_size_t i = 0; i < device->stream_count; ++i) {
+    iree_hal_stream_tracing_context_free(device->streams[i].tracing_context);
+  }
 
   // Destroy various pools for synchronization.
   if (device->timepoint_pool) {
@@ -679,7 +867,12 @@ static void iree_hal_hip_device_destroy(iree_hal_device_t* base_device) {
   }
   if (device->host_event_pool) iree_event_pool_free(device->host_event_pool);
 
-  IREE_HIP_IGNORE_ERROR(symbols, hipStreamDestroy(device->hip_dispatch_stream));
+  for (iree_host_size_t i = 0; i < device->stream_count; ++i) {
+    if (device->streams[i].hip_stream) {
+      IREE_HIP_IGNORE_ERROR(symbols,
+                            hipStreamDestroy(device->streams[i].hip_stream));
+    }
+  }
 
   // NOTE: This function return hipSuccess though doesn't release the
   // primaryCtx by design on HIP/HCC path.
@@ -782,6 +975,28 @@ static iree_status_t iree_hal_hip_device_query_i64(
       (int)category.size, category.data, (int)key.size, key.data);
 }
 
+// Returns the stream to submit work to based on the |queue_affinity|.
+static iree_hal_hip_device_stream_t* iree_hal_hip_device_select_stream(
+    iree_hal_hip_device_t* device,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity) {
+  // Each affinity bit maps to one queue with the lowest set bit selecting the
+  // queue. IREE_HAL_QUEUE_AFFINITY_ANY (and 0) always select the first queue so
+  // that unannotated work stays in order. Transfer-only work uses the dedicated
+  // transfer stream of the queue (if any) and can overlap with dispatches;
+  // ordering between streams is established by the semaphores of each
+  // submission.
+  iree_host_size_t queue_count = device->params.queue_count;
+  iree_host_size_t queue_ordinal =
+      queue_affinity ? iree_math_count_trailing_zeros_u64(queue_affinity) : 0;
+  queue_ordinal %= queue_count;
+  if (command_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER &&
+      device->params.transfer_streams) {
+    return &device->streams[queue_count + queue_ordinal];
+  }
+  return &device->streams[queue_ordinal];
+}
+
 static iree_status_t iree_hal_hip_device_create_channel(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_channel_params_t params, iree_hal_channel_t** out_channel) {
@@ -789,21 +1004,19 @@ static iree_status_t iree_hal_hip_device_create_channel(
   IREE_RETURN_IF_ERROR(
       iree_hal_hip_set_context(device->hip_symbols, device->hip_context));
 
-  if (!device->nccl_symbols || !device->nccl_symbols->dylib) {
-    return iree_make_status(
-        IREE_STATUS_UNAVAILABLE,
-        "RCCL runtime library version %d.%d and greater not available; "
-        "ensure installed and the shared library (rccl.dll/librccl.so) "
-        "is on your PATH/LD_LIBRARY_PATH.",
-        NCCL_MAJOR, NCCL_MINOR);
-  }
+  // Load RCCL if this is the first channel created. This fails if RCCL is
+  // unavailable or incompatible.
+  const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_hip_nccl_lazy_dynamic_symbols_resolve(
+      device->nccl_lazy_symbols, &nccl_symbols));
 
   // Today we only allow a single logical device per channel.
   // We could multiplex channels but it'd be better to surface that to the
-  // compiler so that it can emit the right rank math.
+  // compiler so that it can emit the right rank math. The compiler assigns
+  // queues with the queue mask of #hal.device.affinity as propagated by the
+  // stream affinity analysis and unassigned channels use any queue.
   int requested_count = iree_math_count_ones_u64(queue_affinity);
-  // TODO(#12206): properly assign affinity in the compiler.
-  if (requested_count != 64 && requested_count != 1) {
+  if (queue_affinity != IREE_HAL_QUEUE_AFFINITY_ANY && requested_count != 1) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "exactly one participant is allowed in a "
                             "channel but %d were specified",
@@ -836,7 +1049,7 @@ static iree_status_t iree_hal_hip_device_create_channel(
     if (params.rank == 0) {
       // Bootstrap NCCL to get the root ID.
       IREE_RETURN_IF_ERROR(
-          iree_hal_hip_nccl_get_unique_id(device->nccl_symbols, &id),
+          iree_hal_hip_nccl_get_unique_id(nccl_symbols, &id),
           "bootstrapping NCCL root");
     }
     // Exchange NCCL ID with all participants.
@@ -865,26 +1078,38 @@ static iree_status_t iree_hal_hip_device_create_channel(
   // context of the device mapped to the queue_affinity. For now since this
   // implementation only supports one device we pass in the only one we have.
   return iree_hal_hip_nccl_channel_create(
-      device->hip_symbols, device->nccl_symbols, &id, params.rank, params.count,
+      device->hip_symbols, nccl_symbols, &id, params.rank, params.count,
       device->host_allocator, out_channel);
 }
 
-iree_status_t iree_hal_hip_device_create_stream_command_buffer(
-    iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
+static iree_status_t iree_hal_hip_device_create_stream_command_buffer_on(
+    iree_hal_hip_device_t* device, iree_hal_hip_device_stream_t* stream,
+    iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
-  iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
   IREE_RETURN_IF_ERROR(
       iree_hal_hip_set_context(device->hip_symbols, device->hip_context));
-
   return iree_hal_hip_stream_command_buffer_create(
-      iree_hal_device_allocator(base_device), device->hip_symbols,
-      device->nccl_symbols, device->hip_context, device->tracing_context, mode,
-      command_categories, binding_capacity, device->hip_dispatch_stream,
+      device->device_allocator, device->hip_symbols, device->nccl_symbols,
+      device->hip_device, device->hip_context, stream->tracing_context, mode,
+      command_categories, binding_capacity, stream->hip_stream,
       &device->block_pool, device->host_allocator, out_command_buffer);
 }
 
+iree_status_t iree_hal_hip_device_create_stream_command_buffer(
+    iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
+    iree_hal_command_category_t command_categories,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
+  return iree_hal_hip_device_create_stream_command_buffer_on(
+      device,
+      iree_hal_hip_device_select_stream(device, command_categories,
+                                        queue_affinity),
+      mode, command_categories, binding_capacity, out_command_buffer);
+}
+
 static iree_status_t iree_hal_hip_device_create_command_buffer(
     iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
@@ -901,11 +1126,11 @@ static iree_status_t iree_hal_hip_device_create_command_buffer(
     // recorded, implying that the command buffer cannot be reused and doesn't
     // need to be persisted. This lets us lower the execution delay as we can
     // directly route commands to a HIP stream and let it eagerly flush.
-    return iree_hal_hip_stream_command_buffer_create(
-        iree_hal_device_allocator(base_device), device->hip_symbols,
-        device->nccl_symbols, device->hip_context, device->tracing_context,
-        mode, command_categories, binding_capacity, device->hip_dispatch_stream,
-        &device->block_pool, device->host_allocator, out_command_buffer);
+    return iree_hal_hip_device_create_stream_command_buffer_on(
+        device,
+        iree_hal_hip_device_select_stream(device, command_categories,
+                                          queue_affinity),
+        mode, command_categories, binding_capacity, out_command_buffer);
   }
   switch (device->params.command_buffer_mode) {
     case IREE_HAL_HIP_COMMAND_BUFFER_MODE_GRAPH:
@@ -920,8 +1145,12 @@ static iree_status_t iree_hal_hip_device_create_command_buffer(
       } else {
         return iree_hal_hip_graph_command_buffer_create(
             iree_hal_device_allocator(base_device), device->hip_symbols,
-            device->tracing_context, device->hip_context, mode,
-            command_categories, queue_affinity, binding_capacity,
+            device->nccl_symbols,
+            iree_hal_hip_device_select_stream(device, command_categories,
+                                              queue_affinity)
+                ->tracing_context,
+            device->hip_context,
+            mode, command_categories, queue_affinity, binding_capacity,
             &device->block_pool, device->host_allocator, out_command_buffer);
       }
     case IREE_HAL_HIP_COMMAND_BUFFER_MODE_STREAM:
@@ -950,14 +1179,8 @@ static iree_status_t iree_hal_hip_device_import_file(
   IREE_RETURN_IF_ERROR(
       iree_hal_hip_set_context(device->hip_symbols, device->hip_context));
 
-  if (iree_io_file_handle_type(handle) !=
-      IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    return iree_make_status(
-        IREE_STATUS_UNAVAILABLE,
-        "implementation does not support the external file type");
-  }
-  return iree_hal_memory_file_wrap(
-      queue_affinity, access, handle, iree_hal_device_allocator(base_device),
+  return iree_hal_file_from_handle(
+      iree_hal_device_allocator(base_device), queue_affinity, access, handle,
       iree_hal_device_host_allocator(base_device), out_file);
 }
 
@@ -981,8 +1204,8 @@ static iree_status_t iree_hal_hip_device_create_semaphore(
 
   return iree_hal_hip_event_semaphore_create(
       initial_value, device->hip_symbols, device->hip_context,
-      device->timepoint_pool, device->work_queue, device->host_allocator,
-      out_semaphore);
+      device->timepoint_pool, device->stream_count, device->work_queues,
+      device->host_allocator, out_semaphore);
 }
 
 static iree_hal_semaphore_compatibility_t
@@ -1020,8 +1243,6 @@ static iree_status_t iree_hal_hip_device_pepare_async_alloc(
   return status;
 }
 
-// TODO: implement multiple streams; today we only have one and queue_affinity
-//       is ignored.
 // TODO: implement proper semaphores in HIP to ensure ordering and avoid
 //       the barrier here.
 static iree_status_t iree_hal_hip_device_queue_alloca(
@@ -1034,19 +1255,21 @@ static iree_status_t iree_hal_hip_device_queue_alloca(
   iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
   IREE_RETURN_IF_ERROR(
       iree_hal_hip_set_context(device->hip_symbols, device->hip_context));
+  iree_hal_hip_device_stream_t* stream = iree_hal_hip_device_select_stream(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
 
   if (device->supports_memory_pools &&
       !iree_all_bits_set(params.type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
     iree_hal_buffer_t* buffer = NULL;
 
     IREE_RETURN_IF_ERROR(iree_hal_hip_memory_pools_prepare_buffer(
-        &device->memory_pools, device->hip_dispatch_stream, pool, params,
+        &device->memory_pools, stream->hip_stream, pool, params,
         allocation_size, &buffer));
 
     iree_status_t status = iree_hal_deferred_work_queue_enqueue_alloc(
-        device->work_queue, wait_semaphore_list, signal_semaphore_list, buffer);
+        stream->work_queue, wait_semaphore_list, signal_semaphore_list, buffer);
     if (iree_status_is_ok(status)) {
-      status = iree_hal_deferred_work_queue_issue(device->work_queue);
+      status = iree_hal_deferred_work_queue_issue(stream->work_queue);
     }
     if (iree_status_is_ok(status)) {
       *out_buffer = buffer;
@@ -1065,9 +1288,9 @@ static iree_status_t iree_hal_hip_device_queue_alloca(
         device, params, allocation_size, &buffer));
 
     iree_status_t status = iree_hal_deferred_work_queue_enqueue_alloc(
-        device->work_queue, wait_semaphore_list, signal_semaphore_list, buffer);
+        stream->work_queue, wait_semaphore_list, signal_semaphore_list, buffer);
     if (iree_status_is_ok(status)) {
-      status = iree_hal_deferred_work_queue_issue(device->work_queue);
+      status = iree_hal_deferred_work_queue_issue(stream->work_queue);
     }
     if (iree_status_is_ok(status)) {
       *out_buffer = buffer;
@@ -1101,8 +1324,6 @@ static iree_status_t iree_hal_hip_device_queue_alloca(
   return status;
 }
 
-// TODO: implement multiple streams; today we only have one and queue_affinity
-//       is ignored.
 // TODO: implement proper semaphores in HIP to ensure ordering and avoid
 //       the barrier here.
 static iree_status_t iree_hal_hip_device_queue_dealloca(
@@ -1113,12 +1334,14 @@ static iree_status_t iree_hal_hip_device_queue_dealloca(
   iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
   IREE_RETURN_IF_ERROR(
       iree_hal_hip_set_context(device->hip_symbols, device->hip_context));
+  iree_hal_hip_device_stream_t* stream = iree_hal_hip_device_select_stream(
+      device, IREE_HAL_COMMAND_CATEGORY_ANY, queue_affinity);
 
   if (iree_hal_hip_allocator_isa(iree_hal_device_allocator(base_device))) {
     iree_status_t status = iree_hal_deferred_work_queue_enqueue_dealloc(
-        device->work_queue, wait_semaphore_list, signal_semaphore_list, buffer);
+        stream->work_queue, wait_semaphore_list, signal_semaphore_list, buffer);
     if (iree_status_is_ok(status)) {
-      status = iree_hal_deferred_work_queue_issue(device->work_queue);
+      status = iree_hal_deferred_work_queue_issue(stream->work_queue);
     }
     return status;
   }
@@ -1133,8 +1356,8 @@ static iree_status_t iree_hal_hip_device_queue_dealloca(
   // drop it on the floor and let it be freed when the buffer is released.
   iree_status_t status = iree_ok_status();
   if (device->supports_memory_pools) {
-    status = iree_hal_hip_memory_pools_deallocate(
-        &device->memory_pools, device->hip_dispatch_stream, buffer);
+    status = iree_hal_hip_memory_pools_deallocate(&device->memory_pools,
+                                                  stream->hip_stream, buffer);
   }
 
   // Only signal if not returning a synchronous error - synchronous failure
@@ -1205,14 +1428,22 @@ static iree_status_t iree_hal_hip_device_queue_execute(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_hip_set_context(device->hip_symbols, device->hip_context));
 
+  // Transfer-only command buffers are routed to the transfer stream of the
+  // queue so that they can overlap with dispatches.
+  iree_hal_hip_device_stream_t* stream = iree_hal_hip_device_select_stream(
+      device,
+      command_buffer ? iree_hal_command_buffer_allowed_categories(command_buffer)
+                     : IREE_HAL_COMMAND_CATEGORY_ANY,
+      queue_affinity);
+
   iree_status_t status = iree_hal_deferred_work_queue_enqueue(
-      device->work_queue, iree_hal_hip_device_collect_tracing_context,
-      device->tracing_context, wait_semaphore_list, signal_semaphore_list,
+      stream->work_queue, iree_hal_hip_device_collect_tracing_context,
+      stream->tracing_context, wait_semaphore_list, signal_semaphore_list,
       command_buffer ? 1 : 0, command_buffer ? &command_buffer : NULL,
       &binding_table);
   if (iree_status_is_ok(status)) {
     // Try to advance the deferred work queue.
-    status = iree_hal_deferred_work_queue_issue(device->work_queue);
+    status = iree_hal_deferred_work_queue_issue(stream->work_queue);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -1223,8 +1454,18 @@ static iree_status_t iree_hal_hip_device_queue_flush(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity) {
   iree_hal_hip_device_t* device = iree_hal_hip_device_cast(base_device);
   IREE_TRACE_ZONE_BEGIN(z0);
-  // Try to advance the deferred work queue.
-  iree_status_t status = iree_hal_deferred_work_queue_issue(device->work_queue);
+  // Try to advance the deferred work queues of all streams of the queue.
+  iree_hal_hip_device_stream_t* dispatch_stream =
+      iree_hal_hip_device_select_stream(device, IREE_HAL_COMMAND_CATEGORY_ANY,
+                                        queue_affinity);
+  iree_hal_hip_device_stream_t* transfer_stream =
+      iree_hal_hip_device_select_stream(
+          device, IREE_HAL_COMMAND_CATEGORY_TRANSFER, queue_affinity);
+  iree_status_t status =
+      iree_hal_deferred_work_queue_issue(dispatch_stream->work_queue);
+  if (iree_status_is_ok(status) && transfer_stream != dispatch_stream) {
+    status = iree_hal_deferred_work_queue_issue(transfer_stream->work_queue);
+  }
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -20,19 +20,22 @@ extern "C" {
 #endif  // __cplusplus
 
 // Creates a device that owns and manages its own hipCtx_t.
+// |symbols| must have had their device symbols resolved and |nccl_symbols| are
+// only loaded if the device is used to create a collective channel.
 iree_status_t iree_hal_hip_device_create(
     iree_hal_driver_t* driver, iree_string_view_t identifier,
     const iree_hal_hip_device_params_t* params,
     const iree_hal_hip_dynamic_symbols_t* symbols,
-    const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols, hipDevice_t device,
+    iree_hal_hip_nccl_lazy_dynamic_symbols_t* nccl_symbols, hipDevice_t device,
     iree_allocator_t host_allocator, iree_hal_device_t** out_device);
 
 // Creates a HIP stream-backed command buffer using resources from the
-// given |base_device|.
+// given |base_device|. The stream is selected based on the |queue_affinity|
+// and |command_categories|.
 iree_status_t iree_hal_hip_device_create_stream_command_buffer(
     iree_hal_device_t* base_device, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
-    iree_host_size_t binding_capacity,
+    iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Returns the HIP context bound to the given |device| if it is a HIP device
@@ -9,6 +9,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/assert.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/base/tracing.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/hip/api.h"
@@ -34,9 +35,14 @@ typedef struct iree_hal_hip_driver_t {
   // Identifier used for registering the driver in the IREE driver registry.
   iree_string_view_t identifier;
   // HIP driver API dynamic symbols to interact with the HIP system.
+  // Only the core symbols are resolved when the driver is created and the
+  // device symbols are resolved when the first device is created.
   iree_hal_hip_dynamic_symbols_t hip_symbols;
+  // Guards resolving the device symbols in |hip_symbols|.
+  iree_slim_mutex_t device_symbols_mutex;
   // NCCL API dynamic symbols to use collectives (multi-gpu/multi-node).
-  iree_hal_hip_nccl_dynamic_symbols_t nccl_symbols;
+  // Loaded when the first collective channel is created.
+  iree_hal_hip_nccl_lazy_dynamic_symbols_t nccl_symbols;
 
   // The default parameters for creating devices using this driver.
   iree_hal_hip_device_params_t device_params;
@@ -75,20 +81,17 @@ static iree_status_t iree_hal_hip_driver_create_internal(
       identifier, &driver->identifier,
       (char*)driver + iree_sizeof_struct(*driver));
   driver->default_device_index = options->default_device_index;
+  iree_slim_mutex_initialize(&driver->device_symbols_mutex);
+
+  // RCCL is only loaded if the user tries to create a channel. Any failure to
+  // find a compatible version is reported at that time.
+  iree_hal_hip_nccl_lazy_dynamic_symbols_initialize(
+      host_allocator, &driver->hip_symbols, &driver->nccl_symbols);
 
   iree_status_t status = iree_hal_hip_dynamic_symbols_initialize(
       host_allocator, options->hip_lib_search_path_count,
       options->hip_lib_search_paths, &driver->hip_symbols);
 
-  if (iree_status_is_ok(status)) {
-    // Try to dynamically load NCCL. This will fail if NCCL is unavailable or
-    // incompatible. We only fail on unavailability when the user tries to
-    // create a channel and otherwise defer reporting.
-    status = iree_hal_hip_nccl_dynamic_symbols_initialize(
-        host_allocator, &driver->hip_symbols, &driver->nccl_symbols);
-    if (iree_status_is_unavailable(status)) status = iree_status_ignore(status);
-  }
-
   memcpy(&driver->device_params, device_params, sizeof(driver->device_params));
 
   if (iree_status_is_ok(status)) {
@@ -122,8 +125,9 @@ static void iree_hal_hip_driver_destroy(iree_hal_driver_t* base_driver) {
   iree_allocator_t host_allocator = driver->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_hal_hip_nccl_dynamic_symbols_deinitialize(&driver->nccl_symbols);
+  iree_hal_hip_nccl_lazy_dynamic_symbols_deinitialize(&driver->nccl_symbols);
   iree_hal_hip_dynamic_symbols_deinitialize(&driver->hip_symbols);
+  iree_slim_mutex_deinitialize(&driver->device_symbols_mutex);
   iree_allocator_free(host_allocator, driver);
 
   IREE_TRACE_ZONE_END(z0);
@@ -138,6 +142,16 @@ static iree_status_t iree_hal_hip_init(iree_hal_hip_driver_t* driver) {
   return status;
 }
 
+// Resolves the non-core HIP symbols if they have not yet been resolved.
+static iree_status_t iree_hal_hip_driver_resolve_device_symbols(
+    iree_hal_hip_driver_t* driver) {
+  iree_slim_mutex_lock(&driver->device_symbols_mutex);
+  iree_status_t status = iree_hal_hip_dynamic_symbols_resolve_device_symbols(
+      &driver->hip_symbols);
+  iree_slim_mutex_unlock(&driver->device_symbols_mutex);
+  return status;
+}
+
 // Populates device information from the given HIP physical device handle.
 // |out_device_info| must point to valid memory and additional data will be
 // appended to |buffer_ptr| and the new pointer is returned.
@@ -261,6 +275,9 @@ static iree_status_t iree_hal_hip_driver_dump_device_info(
 
   hipDevice_t device = IREE_DEVICE_ID_TO_HIPDEVICE(device_id);
 
+  // hipGetDeviceProperties is not a core symbol.
+  IREE_RETURN_IF_ERROR(iree_hal_hip_driver_resolve_device_symbols(driver));
+
   hipDeviceProp_tR0000 prop;
   IREE_HIP_RETURN_IF_ERROR(&driver->hip_symbols,
                            hipGetDeviceProperties(&prop, device),
@@ -319,31 +336,27 @@ static iree_status_t iree_hal_hip_driver_dump_device_info(
   return iree_ok_status();
 }
 
+// Selects the default device without populating the device info of all
+// devices as each query may require the driver to initialize the device.
 static iree_status_t iree_hal_hip_driver_select_default_device(
-    iree_hal_driver_t* base_driver, iree_hal_hip_dynamic_symbols_t* syms,
-    int default_device_index, iree_allocator_t host_allocator,
+    iree_hal_hip_driver_t* driver, int default_device_index,
     hipDevice_t* out_device) {
-  iree_hal_device_info_t* device_infos = NULL;
-  iree_host_size_t device_count = 0;
-  IREE_RETURN_IF_ERROR(iree_hal_hip_driver_query_available_devices(
-      base_driver, host_allocator, &device_count, &device_infos));
-
-  iree_status_t status = iree_ok_status();
+  int device_count = 0;
+  IREE_HIP_RETURN_IF_ERROR(&driver->hip_symbols,
+                           hipGetDeviceCount(&device_count),
+                           "hipGetDeviceCount");
   if (device_count == 0) {
-    status = iree_make_status(IREE_STATUS_UNAVAILABLE,
-                              "no compatible HIP devices were found");
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "no compatible HIP devices were found");
   } else if (default_device_index >= device_count) {
-    status = iree_make_status(IREE_STATUS_NOT_FOUND,
-                              "default device %d not found (of %" PRIhsz
-                              " enumerated)",
-                              default_device_index, device_count);
-  } else {
-    *out_device = IREE_DEVICE_ID_TO_HIPDEVICE(
-        device_infos[default_device_index].device_id);
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "default device %d not found (of %d enumerated)",
+                            default_device_index, device_count);
   }
-  iree_allocator_free(host_allocator, device_infos);
-
-  return status;
+  IREE_HIP_RETURN_IF_ERROR(&driver->hip_symbols,
+                           hipDeviceGet(out_device, default_device_index),
+                           "hipDeviceGet");
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_hip_driver_create_device_by_id(
@@ -358,6 +371,8 @@ static iree_status_t iree_hal_hip_driver_create_device_by_id(
 
   // Ensure HIP is initialized before querying it.
   IREE_RETURN_AND_END_ZONE_IF_ERROR(z0, iree_hal_hip_init(driver));
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_hip_driver_resolve_device_symbols(driver));
 
   // Use either the specified device (enumerated earlier) or whatever default
   // one was specified when the driver was created.
@@ -365,8 +380,7 @@ static iree_status_t iree_hal_hip_driver_create_device_by_id(
   if (device_id == IREE_HAL_DEVICE_ID_DEFAULT) {
     IREE_RETURN_AND_END_ZONE_IF_ERROR(
         z0, iree_hal_hip_driver_select_default_device(
-                base_driver, &driver->hip_symbols, driver->default_device_index,
-                host_allocator, &device));
+                driver, driver->default_device_index, &device));
   } else {
     device = IREE_DEVICE_ID_TO_HIPDEVICE(device_id);
   }
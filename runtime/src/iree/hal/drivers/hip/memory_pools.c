@@ -113,6 +113,22 @@ void iree_hal_hip_memory_pools_deinitialize(
   IREE_TRACE_ZONE_END(z0);
 }
 
+#if IREE_STATISTICS_ENABLE
+// Raises |peak| to the bytes live as derived from |allocated| and |freed|.
+static void iree_hal_hip_memory_pool_update_peak(
+    iree_atomic_int64_t* peak, iree_atomic_int64_t* allocated,
+    iree_atomic_int64_t* freed) {
+  int64_t live = iree_atomic_load(allocated, iree_memory_order_relaxed) -
+                 iree_atomic_load(freed, iree_memory_order_relaxed);
+  int64_t current = iree_atomic_load(peak, iree_memory_order_relaxed);
+  while (live > current &&
+         !iree_atomic_compare_exchange_weak(peak, &current, live,
+                                            iree_memory_order_relaxed,
+                                            iree_memory_order_relaxed)) {
+  }
+}
+#endif  // IREE_STATISTICS_ENABLE
+
 static void iree_hal_hip_memory_pool_track_alloc(
     iree_hal_hip_memory_pools_t* pools, iree_hal_buffer_t* buffer) {
   bool is_device_local = iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
@@ -130,6 +146,17 @@ static void iree_hal_hip_memory_pool_track_alloc(
                         : &pools->statistics.host_bytes_allocated;
     iree_atomic_fetch_add(bytes_allocated, allocation_size,
                           iree_memory_order_relaxed);
+    if (is_device_local) {
+      iree_hal_hip_memory_pool_update_peak(
+          &pools->statistics.device_bytes_capture_peak,
+          &pools->statistics.device_bytes_allocated,
+          &pools->statistics.device_bytes_freed);
+    } else {
+      iree_hal_hip_memory_pool_update_peak(
+          &pools->statistics.host_bytes_capture_peak,
+          &pools->statistics.host_bytes_allocated,
+          &pools->statistics.host_bytes_freed);
+    }
   });
 }
 
@@ -160,14 +187,19 @@ void iree_hal_hip_memory_pools_merge_statistics(
       iree_hal_hip_set_context(pools->hip_symbols, pools->hip_context));
 
   IREE_STATISTICS({
-    statistics->device_bytes_allocated = iree_atomic_load(
+    statistics->device_bytes_allocated += iree_atomic_load(
         &pools->statistics.device_bytes_allocated, iree_memory_order_relaxed);
-    statistics->host_bytes_allocated = iree_atomic_load(
+    statistics->host_bytes_allocated += iree_atomic_load(
         &pools->statistics.host_bytes_allocated, iree_memory_order_relaxed);
-    statistics->device_bytes_freed = iree_atomic_load(
+    statistics->device_bytes_freed += iree_atomic_load(
         &pools->statistics.device_bytes_freed, iree_memory_order_relaxed);
-    statistics->host_bytes_freed = iree_atomic_load(
+    statistics->host_bytes_freed += iree_atomic_load(
         &pools->statistics.host_bytes_freed, iree_memory_order_relaxed);
+    statistics->device_bytes_capture_peak += iree_atomic_load(
+        &pools->statistics.device_bytes_capture_peak,
+        iree_memory_order_relaxed);
+    statistics->host_bytes_capture_peak += iree_atomic_load(
+        &pools->statistics.host_bytes_capture_peak, iree_memory_order_relaxed);
 
     if (pools->device_local) {
       uint64_t pool_peak = 0;
@@ -188,6 +220,26 @@ void iree_hal_hip_memory_pools_merge_statistics(
   });
 }
 
+void iree_hal_hip_memory_pools_reset_capture_statistics(
+    iree_hal_hip_memory_pools_t* pools) {
+  IREE_STATISTICS({
+    iree_atomic_store(
+        &pools->statistics.device_bytes_capture_peak,
+        iree_atomic_load(&pools->statistics.device_bytes_allocated,
+                         iree_memory_order_relaxed) -
+            iree_atomic_load(&pools->statistics.device_bytes_freed,
+                             iree_memory_order_relaxed),
+        iree_memory_order_relaxed);
+    iree_atomic_store(
+        &pools->statistics.host_bytes_capture_peak,
+        iree_atomic_load(&pools->statistics.host_bytes_allocated,
+                         iree_memory_order_relaxed) -
+            iree_atomic_load(&pools->statistics.host_bytes_freed,
+                             iree_memory_order_relaxed),
+        iree_memory_order_relaxed);
+  });
+}
+
 iree_status_t iree_hal_hip_memory_pools_trim(
     iree_hal_hip_memory_pools_t* pools,
     const iree_hal_hip_memory_pooling_params_t* pooling_params) {
@@ -41,6 +41,9 @@ typedef struct iree_hal_hip_memory_pools_t {
     iree_atomic_int64_t device_bytes_freed;
     iree_atomic_int64_t host_bytes_allocated;
     iree_atomic_int64_t host_bytes_freed;
+    // Peak bytes live since the last capture was started.
+    iree_atomic_int64_t device_bytes_capture_peak;
+    iree_atomic_int64_t host_bytes_capture_peak;
   } statistics;)
 } iree_hal_hip_memory_pools_t;
 
@@ -60,6 +63,10 @@ void iree_hal_hip_memory_pools_merge_statistics(
     iree_hal_hip_memory_pools_t* pools,
     iree_hal_allocator_statistics_t* statistics);
 
+// Resets the capture peaks of |pools| to the bytes currently live.
+void iree_hal_hip_memory_pools_reset_capture_statistics(
+    iree_hal_hip_memory_pools_t* pools);
+
 // Trims all memory pools by releasing resources back to the system.
 iree_status_t iree_hal_hip_memory_pools_trim(
     iree_hal_hip_memory_pools_t* pools,
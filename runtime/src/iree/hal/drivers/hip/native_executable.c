@@ -240,18 +240,16 @@ iree_status_t iree_hal_hip_native_executable_create(
   iree_host_size_t export_count = iree_hal_hip_ExportDef_vec_len(exports_vec);
 
   // Calculate the total number of characters across all entry point names. This
-  // is only required when tracing so that we can store copies of the names as
-  // the flatbuffer storing the strings may be released while the executable is
-  // still live.
+  // is required by tracing and dispatch statistics so that we can store copies
+  // of the names as the flatbuffer storing the strings may be released while
+  // the executable is still live.
   iree_host_size_t total_export_info_length = 0;
-  IREE_TRACE({
-    for (iree_host_size_t i = 0; i < export_count; ++i) {
-      iree_hal_hip_ExportDef_table_t export_def =
-          iree_hal_hip_ExportDef_vec_at(exports_vec, i);
-      total_export_info_length += iree_hal_debug_calculate_export_info_size(
-          iree_hal_hip_ExportDef_debug_info_get(export_def));
-    }
-  });
+  for (iree_host_size_t i = 0; i < export_count; ++i) {
+    iree_hal_hip_ExportDef_table_t export_def =
+        iree_hal_hip_ExportDef_vec_at(exports_vec, i);
+    total_export_info_length += iree_hal_debug_calculate_export_info_size(
+        iree_hal_hip_ExportDef_debug_info_get(export_def));
+  }
 
   // Allocate storage for the executable and its associated data structures.
   iree_hal_hip_native_executable_t* executable = NULL;
@@ -270,9 +268,8 @@ iree_status_t iree_hal_hip_native_executable_create(
       (hipModule_t*)((uint8_t*)executable + sizeof(*executable) +
                      export_count * sizeof(executable->exports[0]));
   executable->export_count = export_count;
-  IREE_TRACE(uint8_t* export_info_ptr =
-                 ((uint8_t*)executable->modules +
-                  module_count * sizeof(executable->modules[0])));
+  uint8_t* export_info_ptr = ((uint8_t*)executable->modules +
+                             module_count * sizeof(executable->modules[0]));
 
   // Publish any embedded source files to the tracing infrastructure.
   iree_hal_debug_publish_source_files(
@@ -376,15 +373,13 @@ iree_status_t iree_hal_hip_native_executable_create(
       kernel_info->binding_count =
           iree_hal_hip_BindingBits_vec_len(binding_flags_vec);
 
-      IREE_TRACE({
-        iree_hal_debug_export_info_t* export_info =
-            (iree_hal_debug_export_info_t*)export_info_ptr;
-        export_info_ptr += iree_hal_debug_copy_export_info(
-            iree_hal_hip_ExportDef_debug_info_get(export_def), export_info);
-        kernel_info->debug_info.function_name = export_info->function_name;
-        kernel_info->debug_info.source_filename = export_info->source_filename;
-        kernel_info->debug_info.source_line = export_info->source_line;
-      });
+      iree_hal_debug_export_info_t* export_info =
+          (iree_hal_debug_export_info_t*)export_info_ptr;
+      export_info_ptr += iree_hal_debug_copy_export_info(
+          iree_hal_hip_ExportDef_debug_info_get(export_def), export_info);
+      kernel_info->debug_info.function_name = export_info->function_name;
+      kernel_info->debug_info.source_filename = export_info->source_filename;
+      kernel_info->debug_info.source_line = export_info->source_line;
     }
   }
 
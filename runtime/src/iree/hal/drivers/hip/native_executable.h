@@ -42,7 +42,9 @@ typedef struct iree_hal_hip_kernel_params_t {
   uint32_t block_dims[3];
   uint32_t block_shared_memory_size;
 
-  IREE_TRACE(iree_hal_hip_kernel_debug_info_t debug_info;)
+  // Export names and source locations used to attribute dispatches in traces
+  // and dispatch statistics.
+  iree_hal_hip_kernel_debug_info_t debug_info;
 } iree_hal_hip_kernel_params_t;
 
 // Creates an IREE executable from a HSACO module. The module may contain
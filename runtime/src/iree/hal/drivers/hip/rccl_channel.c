@@ -611,12 +611,12 @@ iree_status_t iree_hal_hip_nccl_submit_batch(
 
   // End all zones we began above - note that these are just simply nested so
   // order doesn't matter so long as we end the right number of zones.
-  IREE_TRACE({
-    for (iree_host_size_t i = 0; i < batch->count; ++i) {
-      IREE_HAL_STREAM_TRACE_ZONE_END(tracing_context, tracing_event_list,
-                                     IREE_HAL_STREAM_TRACING_VERBOSITY_FINE);
-    }
-  });
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+  for (iree_host_size_t i = 0; i < batch->count; ++i) {
+    IREE_HAL_STREAM_TRACE_ZONE_END(tracing_context, tracing_event_list,
+                                   IREE_HAL_STREAM_TRACING_VERBOSITY_FINE);
+  }
+#endif  // IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 
   return iree_ok_status();
 }
@@ -142,3 +142,38 @@ void iree_hal_hip_nccl_dynamic_symbols_deinitialize(
 
   IREE_TRACE_ZONE_END(z0);
 }
+
+void iree_hal_hip_nccl_lazy_dynamic_symbols_initialize(
+    iree_allocator_t host_allocator,
+    const iree_hal_hip_dynamic_symbols_t* hip_symbols,
+    iree_hal_hip_nccl_lazy_dynamic_symbols_t* out_lazy_syms) {
+  IREE_ASSERT_ARGUMENT(hip_symbols);
+  IREE_ASSERT_ARGUMENT(out_lazy_syms);
+  memset(out_lazy_syms, 0, sizeof(*out_lazy_syms));
+  out_lazy_syms->host_allocator = host_allocator;
+  out_lazy_syms->hip_symbols = hip_symbols;
+  iree_slim_mutex_initialize(&out_lazy_syms->mutex);
+}
+
+void iree_hal_hip_nccl_lazy_dynamic_symbols_deinitialize(
+    iree_hal_hip_nccl_lazy_dynamic_symbols_t* lazy_syms) {
+  iree_hal_hip_nccl_dynamic_symbols_deinitialize(&lazy_syms->symbols);
+  iree_slim_mutex_deinitialize(&lazy_syms->mutex);
+}
+
+iree_status_t iree_hal_hip_nccl_lazy_dynamic_symbols_resolve(
+    iree_hal_hip_nccl_lazy_dynamic_symbols_t* lazy_syms,
+    const iree_hal_hip_nccl_dynamic_symbols_t** out_syms) {
+  IREE_ASSERT_ARGUMENT(lazy_syms);
+  IREE_ASSERT_ARGUMENT(out_syms);
+  *out_syms = NULL;
+  iree_status_t status = iree_ok_status();
+  iree_slim_mutex_lock(&lazy_syms->mutex);
+  if (!lazy_syms->symbols.dylib) {
+    status = iree_hal_hip_nccl_dynamic_symbols_initialize(
+        lazy_syms->host_allocator, lazy_syms->hip_symbols, &lazy_syms->symbols);
+  }
+  iree_slim_mutex_unlock(&lazy_syms->mutex);
+  if (iree_status_is_ok(status)) *out_syms = &lazy_syms->symbols;
+  return status;
+}
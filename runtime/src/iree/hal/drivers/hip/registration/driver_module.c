@@ -35,6 +35,14 @@ IREE_FLAG(
     bool, hip_async_allocations, true,
     "Enables HIP asynchronous stream-ordered allocations when supported.");
 
+IREE_FLAG(int32_t, hip_queue_count, 1,
+          "Number of HAL queues exposed on each HIP device. Each queue is \n"
+          "backed by its own HIP stream and queue affinities select them.");
+
+IREE_FLAG(bool, hip_transfer_streams, true,
+          "Uses an additional HIP stream per queue for transfer-only command \n"
+          "buffers so that copies can overlap with dispatches.");
+
 IREE_FLAG(
     int32_t, hip_tracing, 2,
     "Controls the verbosity of tracing when Tracy instrumentation is enabled.\n"
@@ -45,6 +53,12 @@ IREE_FLAG(
     "   1 : coarse command buffer level tracing enabled.\n"
     "   2 : fine-grained kernel level tracing enabled.\n");
 
+IREE_FLAG(bool, hip_dispatch_statistics, false,
+          "Aggregates the GPU execution time of each dispatch by executable\n"
+          "export for querying with iree_hal_hip_device_query_dispatch_\n"
+          "statistics. Available in builds without tracing; dispatches in\n"
+          "graph command buffers are only timed in tracing builds.");
+
 IREE_FLAG(int32_t, hip_default_index, 0,
           "Specifies the index of the default HIP device to use");
 
@@ -75,8 +89,14 @@ static const iree_string_view_t key_hip_allow_inline_execution =
     iree_string_view_literal("hip_allow_inline_execution");
 static const iree_string_view_t key_hip_async_allocations =
     iree_string_view_literal("hip_async_allocations");
+static const iree_string_view_t key_hip_queue_count =
+    iree_string_view_literal("hip_queue_count");
+static const iree_string_view_t key_hip_transfer_streams =
+    iree_string_view_literal("hip_transfer_streams");
 static const iree_string_view_t key_hip_tracing =
     iree_string_view_literal("hip_tracing");
+static const iree_string_view_t key_hip_dispatch_statistics =
+    iree_string_view_literal("hip_dispatch_statistics");
 static const iree_string_view_t key_hip_default_index =
     iree_string_view_literal("hip_default_index");
 
@@ -100,8 +120,14 @@ static iree_status_t iree_hal_hip_driver_parse_flags(
       FLAG_hip_allow_inline_execution));
   IREE_RETURN_IF_ERROR(iree_string_pair_builder_add_int32(
       builder, key_hip_async_allocations, FLAG_hip_async_allocations));
+  IREE_RETURN_IF_ERROR(iree_string_pair_builder_add_int32(
+      builder, key_hip_queue_count, FLAG_hip_queue_count));
+  IREE_RETURN_IF_ERROR(iree_string_pair_builder_add_int32(
+      builder, key_hip_transfer_streams, FLAG_hip_transfer_streams));
   IREE_RETURN_IF_ERROR(iree_string_pair_builder_add_int32(
       builder, key_hip_tracing, FLAG_hip_tracing));
+  IREE_RETURN_IF_ERROR(iree_string_pair_builder_add_int32(
+      builder, key_hip_dispatch_statistics, FLAG_hip_dispatch_statistics));
   IREE_RETURN_IF_ERROR(iree_string_pair_builder_add_int32(
       builder, key_hip_default_index, FLAG_hip_default_index));
 
@@ -178,6 +204,23 @@ static iree_status_t iree_hal_hip_driver_populate_options(
             (int)value.size, value.data);
       }
       device_params->async_allocations = ivalue ? true : false;
+    } else if (iree_string_view_equal(key, key_hip_queue_count)) {
+      if (!iree_string_view_atoi_int32(value, &ivalue) || ivalue <= 0) {
+        return iree_make_status(
+            IREE_STATUS_FAILED_PRECONDITION,
+            "Option 'hip_queue_count' expected to be a positive int. "
+            "Got: '%.*s'",
+            (int)value.size, value.data);
+      }
+      device_params->queue_count = (iree_host_size_t)ivalue;
+    } else if (iree_string_view_equal(key, key_hip_transfer_streams)) {
+      if (!iree_string_view_atoi_int32(value, &ivalue)) {
+        return iree_make_status(
+            IREE_STATUS_FAILED_PRECONDITION,
+            "Option 'hip_transfer_streams' expected to be int. Got: '%.*s'",
+            (int)value.size, value.data);
+      }
+      device_params->transfer_streams = ivalue ? true : false;
     } else if (iree_string_view_equal(key, key_hip_tracing)) {
       if (!iree_string_view_atoi_int32(value, &ivalue)) {
         return iree_make_status(
@@ -186,6 +229,14 @@ static iree_status_t iree_hal_hip_driver_populate_options(
             (int)value.size, value.data);
       }
       device_params->stream_tracing = ivalue;
+    } else if (iree_string_view_equal(key, key_hip_dispatch_statistics)) {
+      if (!iree_string_view_atoi_int32(value, &ivalue)) {
+        return iree_make_status(
+            IREE_STATUS_FAILED_PRECONDITION,
+            "Option 'hip_dispatch_statistics' expected to be int. Got: '%.*s'",
+            (int)value.size, value.data);
+      }
+      device_params->dispatch_statistics = ivalue ? true : false;
     } else if (iree_string_view_equal(key, key_hip_default_index)) {
       if (!iree_string_view_atoi_int32(value, &ivalue)) {
         return iree_make_status(
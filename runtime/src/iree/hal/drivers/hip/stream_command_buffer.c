@@ -28,6 +28,7 @@ typedef struct iree_hal_hip_stream_command_buffer_t {
   iree_hal_stream_tracing_context_event_list_t tracing_event_list;
 
   hipStream_t hip_stream;
+  hipDevice_t hip_device;
   hipCtx_t hip_context;
 
   // A resource set to maintain references to all resources used within the
@@ -56,7 +57,8 @@ iree_status_t iree_hal_hip_stream_command_buffer_create(
     iree_hal_allocator_t* device_allocator,
     const iree_hal_hip_dynamic_symbols_t* hip_symbols,
     const iree_hal_hip_nccl_dynamic_symbols_t* nccl_symbols,
-    hipCtx_t hip_context, iree_hal_stream_tracing_context_t* tracing_context,
+    hipDevice_t hip_device, hipCtx_t hip_context,
+    iree_hal_stream_tracing_context_t* tracing_context,
     iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_host_size_t binding_capacity, hipStream_t stream,
@@ -95,9 +97,10 @@ iree_status_t iree_hal_hip_stream_command_buffer_create(
   command_buffer->hip_symbols = hip_symbols;
   command_buffer->nccl_symbols = nccl_symbols;
   command_buffer->tracing_context = tracing_context;
-  command_buffer->tracing_event_list.head = NULL;
-  command_buffer->tracing_event_list.tail = NULL;
+  iree_hal_stream_tracing_context_event_list_initialize(
+      &command_buffer->tracing_event_list);
   command_buffer->hip_stream = stream;
+  command_buffer->hip_device = hip_device;
   command_buffer->hip_context = hip_context;
   iree_arena_initialize(block_pool, &command_buffer->arena);
 
@@ -443,22 +446,46 @@ static iree_status_t iree_hal_hip_stream_command_buffer_copy_buffer(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_hip_stream_command_buffer_flush_collectives(command_buffer));
 
-  hipDeviceptr_t target_device_buffer = iree_hal_hip_buffer_device_pointer(
-      iree_hal_buffer_allocated_buffer(target_ref.buffer));
+  iree_hal_buffer_t* target_buffer =
+      iree_hal_buffer_allocated_buffer(target_ref.buffer);
+  iree_hal_buffer_t* source_buffer =
+      iree_hal_buffer_allocated_buffer(source_ref.buffer);
+  hipDeviceptr_t target_device_buffer =
+      iree_hal_hip_buffer_device_pointer(target_buffer);
   iree_device_size_t target_offset =
       iree_hal_buffer_byte_offset(target_ref.buffer) + target_ref.offset;
-  hipDeviceptr_t source_device_buffer = iree_hal_hip_buffer_device_pointer(
-      iree_hal_buffer_allocated_buffer(source_ref.buffer));
+  hipDeviceptr_t source_device_buffer =
+      iree_hal_hip_buffer_device_pointer(source_buffer);
   iree_device_size_t source_offset =
       iree_hal_buffer_byte_offset(source_ref.buffer) + source_ref.offset;
   hipDeviceptr_t dst = (uint8_t*)target_device_buffer + target_offset;
   hipDeviceptr_t src = (uint8_t*)source_device_buffer + source_offset;
 
-  IREE_HIP_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, command_buffer->hip_symbols,
-      hipMemcpyAsync(dst, src, target_ref.length, hipMemcpyDeviceToDevice,
-                     command_buffer->hip_stream),
-      "hipMemcpyAsync");
+  // Copies involving memory of a peer device go through hipMemcpyPeerAsync so
+  // that the runtime uses the peer link when available and otherwise stages
+  // the copy through the host.
+  int target_peer_device = iree_hal_hip_buffer_peer_device(target_buffer);
+  int source_peer_device = iree_hal_hip_buffer_peer_device(source_buffer);
+  if (target_peer_device >= 0 || source_peer_device >= 0) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "peer");
+    IREE_HIP_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, command_buffer->hip_symbols,
+        hipMemcpyPeerAsync(
+            dst,
+            target_peer_device >= 0 ? target_peer_device
+                                    : command_buffer->hip_device,
+            src,
+            source_peer_device >= 0 ? source_peer_device
+                                    : command_buffer->hip_device,
+            target_ref.length, command_buffer->hip_stream),
+        "hipMemcpyPeerAsync");
+  } else {
+    IREE_HIP_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, command_buffer->hip_symbols,
+        hipMemcpyAsync(dst, src, target_ref.length, hipMemcpyDeviceToDevice,
+                       command_buffer->hip_stream),
+        "hipMemcpyAsync");
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
@@ -0,0 +1,282 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/hip/virtual_buffer.h"
+
+#include <string.h>
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/drivers/hip/context_util.h"
+#include "iree/hal/drivers/hip/hip_buffer.h"
+#include "iree/hal/drivers/hip/status_util.h"
+
+// Backing state of an IREE_HAL_HIP_BUFFER_TYPE_VIRTUAL buffer stored as the
+// user data of its release callback.
+typedef struct iree_hal_hip_virtual_allocation_t {
+  const iree_hal_hip_dynamic_symbols_t* hip_symbols;
+  iree_allocator_t host_allocator;
+  hipCtx_t hip_context;
+  hipDevice_t hip_device;
+
+  // Base of the reserved virtual address range.
+  void* base_ptr;
+  // Total size of the reserved range; a multiple of |granularity|.
+  iree_device_size_t reserved_size;
+  // Minimum size and alignment of physical allocations on the device.
+  iree_device_size_t granularity;
+
+  // Guards |committed_size| and the mapping of new physical memory.
+  iree_slim_mutex_t mutex;
+  // Size of the prefix of the reserved range backed by physical memory.
+  iree_device_size_t committed_size;
+} iree_hal_hip_virtual_allocation_t;
+
+static hipMemAllocationProp iree_hal_hip_virtual_allocation_prop(
+    hipDevice_t hip_device) {
+  hipMemAllocationProp prop;
+  memset(&prop, 0, sizeof(prop));
+  prop.type = hipMemAllocationTypePinned;
+  prop.location.type = hipMemLocationTypeDevice;
+  prop.location.id = hip_device;
+  return prop;
+}
+
+// Maps [committed_size, new_committed_size) of the reserved range of
+// |allocation| to newly created physical memory. The HIP context must be
+// current and the allocation mutex held.
+static iree_status_t iree_hal_hip_virtual_allocation_map(
+    iree_hal_hip_virtual_allocation_t* allocation,
+    iree_device_size_t new_committed_size) {
+  const iree_hal_hip_dynamic_symbols_t* symbols = allocation->hip_symbols;
+  void* chunk_ptr = (uint8_t*)allocation->base_ptr + allocation->committed_size;
+  size_t chunk_size = (size_t)(new_committed_size - allocation->committed_size);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)chunk_size);
+
+  hipMemAllocationProp prop =
+      iree_hal_hip_virtual_allocation_prop(allocation->hip_device);
+  hipMemGenericAllocationHandle_t handle = NULL;
+  IREE_HIP_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, symbols, hipMemCreate(&handle, chunk_size, &prop, /*flags=*/0),
+      "hipMemCreate");
+
+  // The mapping retains the physical memory so the handle can be released
+  // immediately: the memory is freed when the range is unmapped.
+  iree_status_t status = IREE_HIP_RESULT_TO_STATUS(
+      symbols,
+      hipMemMap(chunk_ptr, chunk_size, /*offset=*/0, handle, /*flags=*/0),
+      "hipMemMap");
+  IREE_HIP_IGNORE_ERROR(symbols, hipMemRelease(handle));
+  if (!iree_status_is_ok(status)) {
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  hipMemAccessDesc access_desc;
+  memset(&access_desc, 0, sizeof(access_desc));
+  access_desc.location = prop.location;
+  access_desc.flags = hipMemAccessFlagsProtReadWrite;
+  status = IREE_HIP_RESULT_TO_STATUS(
+      symbols, hipMemSetAccess(chunk_ptr, chunk_size, &access_desc, 1),
+      "hipMemSetAccess");
+
+  if (iree_status_is_ok(status)) {
+    allocation->committed_size = new_committed_size;
+  } else {
+    IREE_HIP_IGNORE_ERROR(symbols, hipMemUnmap(chunk_ptr, chunk_size));
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_hip_virtual_allocation_commit(
+    iree_hal_hip_virtual_allocation_t* allocation,
+    iree_device_size_t minimum_committed_size) {
+  if (minimum_committed_size > allocation->reserved_size) {
+    return iree_make_status(
+        IREE_STATUS_OUT_OF_RANGE,
+        "cannot commit %" PRIdsz " bytes of a virtual buffer reserving %" PRIdsz
+        " bytes",
+        minimum_committed_size, allocation->reserved_size);
+  }
+
+  iree_slim_mutex_lock(&allocation->mutex);
+  iree_status_t status = iree_ok_status();
+  if (minimum_committed_size > allocation->committed_size) {
+    iree_device_size_t new_committed_size =
+        iree_device_align(minimum_committed_size, allocation->granularity);
+    status = iree_hal_hip_set_context(allocation->hip_symbols,
+                                      allocation->hip_context);
+    if (iree_status_is_ok(status)) {
+      status =
+          iree_hal_hip_virtual_allocation_map(allocation, new_committed_size);
+    }
+  }
+  iree_slim_mutex_unlock(&allocation->mutex);
+  return status;
+}
+
+static void iree_hal_hip_virtual_allocation_free(
+    iree_hal_hip_virtual_allocation_t* allocation) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  const iree_hal_hip_dynamic_symbols_t* symbols = allocation->hip_symbols;
+  // All committed chunks are contiguous from the base and unmapping the whole
+  // range releases their physical memory.
+  if (allocation->committed_size > 0) {
+    IREE_HIP_IGNORE_ERROR(symbols,
+                          hipMemUnmap(allocation->base_ptr,
+                                      (size_t)allocation->committed_size));
+  }
+  if (allocation->base_ptr) {
+    IREE_HIP_IGNORE_ERROR(symbols,
+                          hipMemAddressFree(allocation->base_ptr,
+                                            (size_t)allocation->reserved_size));
+  }
+  iree_slim_mutex_deinitialize(&allocation->mutex);
+  iree_allocator_free(allocation->host_allocator, allocation);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_hal_hip_virtual_buffer_release_callback(
+    void* user_data, iree_hal_buffer_t* buffer) {
+  iree_hal_hip_virtual_allocation_free(
+      (iree_hal_hip_virtual_allocation_t*)user_data);
+}
+
+iree_status_t iree_hal_hip_virtual_buffer_allocate(
+    const iree_hal_hip_dynamic_symbols_t* hip_symbols, hipCtx_t hip_context,
+    hipDevice_t hip_device, iree_hal_buffer_params_t params,
+    iree_device_size_t reserved_size, iree_device_size_t committed_size,
+    iree_allocator_t host_allocator, iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(hip_symbols);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+  if (!hip_symbols->hipMemAddressReserve || !hip_symbols->hipMemCreate ||
+      !hip_symbols->hipMemMap || !hip_symbols->hipMemSetAccess) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "HIP runtime does not support virtual memory "
+                            "management");
+  }
+  iree_hal_buffer_params_canonicalize(&params);
+  if (!iree_all_bits_set(params.type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) ||
+      iree_any_bit_set(params.type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "virtual buffers must be device-local and not "
+                            "host-visible");
+  }
+  if (reserved_size == 0 || committed_size > reserved_size) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "invalid virtual buffer reservation of %" PRIdsz
+                            " bytes with %" PRIdsz " bytes committed",
+                            reserved_size, committed_size);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)reserved_size);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)committed_size);
+
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_hip_set_context(hip_symbols, hip_context));
+  hipMemAllocationProp prop = iree_hal_hip_virtual_allocation_prop(hip_device);
+  size_t granularity = 0;
+  IREE_HIP_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, hip_symbols,
+      hipMemGetAllocationGranularity(&granularity, &prop,
+                                     hipMemAllocationGranularityRecommended),
+      "hipMemGetAllocationGranularity");
+
+  iree_hal_hip_virtual_allocation_t* allocation = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*allocation),
+                                (void**)&allocation));
+  allocation->hip_symbols = hip_symbols;
+  allocation->host_allocator = host_allocator;
+  allocation->hip_context = hip_context;
+  allocation->hip_device = hip_device;
+  allocation->reserved_size = iree_device_align(reserved_size, granularity);
+  allocation->granularity = granularity;
+  iree_slim_mutex_initialize(&allocation->mutex);
+
+  // Only the address range is reserved here; physical memory is created and
+  // mapped as the committed prefix grows.
+  iree_status_t status = IREE_HIP_RESULT_TO_STATUS(
+      hip_symbols,
+      hipMemAddressReserve(&allocation->base_ptr,
+                           (size_t)allocation->reserved_size,
+                           /*alignment=*/0, /*addr=*/NULL, /*flags=*/0),
+      "hipMemAddressReserve");
+  if (iree_status_is_ok(status) && committed_size > 0) {
+    status = iree_hal_hip_virtual_allocation_commit(allocation, committed_size);
+  }
+
+  iree_hal_buffer_t* buffer = NULL;
+  if (iree_status_is_ok(status)) {
+    // NOTE: as with queue-ordered allocations we don't provide a device
+    // allocator as the memory is not tracked by one and instead the release
+    // callback owns the allocation.
+    iree_hal_buffer_release_callback_t release_callback = {
+        .fn = iree_hal_hip_virtual_buffer_release_callback,
+        .user_data = allocation,
+    };
+    status = iree_hal_hip_buffer_wrap(
+        /*device_allocator=*/NULL, params.type, params.access, params.usage,
+        allocation->reserved_size, /*byte_offset=*/0,
+        /*byte_length=*/allocation->reserved_size,
+        IREE_HAL_HIP_BUFFER_TYPE_VIRTUAL, allocation->base_ptr,
+        /*host_ptr=*/NULL, release_callback, host_allocator, &buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_hip_virtual_allocation_free(allocation);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_hal_hip_virtual_allocation_t*
+iree_hal_hip_virtual_buffer_allocation(iree_hal_buffer_t* buffer) {
+  iree_hal_buffer_t* allocated_buffer =
+      iree_hal_buffer_allocated_buffer(buffer);
+  if (iree_hal_hip_buffer_type(allocated_buffer) !=
+      IREE_HAL_HIP_BUFFER_TYPE_VIRTUAL) {
+    return NULL;
+  }
+  return (iree_hal_hip_virtual_allocation_t*)
+      iree_hal_hip_buffer_release_user_data(allocated_buffer);
+}
+
+iree_status_t iree_hal_hip_virtual_buffer_commit(
+    iree_hal_buffer_t* buffer, iree_device_size_t minimum_committed_size) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_hip_virtual_allocation_t* allocation =
+      iree_hal_hip_virtual_buffer_allocation(buffer);
+  if (!allocation) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "buffer is not a HIP virtual buffer");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)minimum_committed_size);
+  iree_status_t status = iree_hal_hip_virtual_allocation_commit(
+      allocation, iree_hal_buffer_byte_offset(buffer) + minimum_committed_size);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_device_size_t iree_hal_hip_virtual_buffer_committed_size(
+    iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_hip_virtual_allocation_t* allocation =
+      iree_hal_hip_virtual_buffer_allocation(buffer);
+  if (!allocation) return 0;
+  iree_slim_mutex_lock(&allocation->mutex);
+  iree_device_size_t committed_size = allocation->committed_size;
+  iree_slim_mutex_unlock(&allocation->mutex);
+  iree_device_size_t byte_offset = iree_hal_buffer_byte_offset(buffer);
+  if (committed_size <= byte_offset) return 0;
+  return iree_min(committed_size - byte_offset,
+                  iree_hal_buffer_byte_length(buffer));
+}
@@ -0,0 +1,54 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_HIP_VIRTUAL_BUFFER_H_
+#define IREE_HAL_DRIVERS_HIP_VIRTUAL_BUFFER_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/hip/dynamic_symbols.h"
+#include "iree/hal/drivers/hip/hip_headers.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Allocates a device-local buffer on |hip_device| that reserves a contiguous
+// virtual address range of at least |reserved_size| bytes and maps physical
+// memory for at least the first |committed_size| bytes. The buffer spans the
+// entire reserved range but only the committed prefix may be accessed.
+// Physical memory is committed in multiples of the device allocation
+// granularity. Returns UNAVAILABLE if the HIP runtime does not support virtual
+// memory management.
+//
+// The returned buffer has the IREE_HAL_HIP_BUFFER_TYPE_VIRTUAL type and
+// releases all physical memory and the reserved range when destroyed.
+iree_status_t iree_hal_hip_virtual_buffer_allocate(
+    const iree_hal_hip_dynamic_symbols_t* hip_symbols, hipCtx_t hip_context,
+    hipDevice_t hip_device, iree_hal_buffer_params_t params,
+    iree_device_size_t reserved_size, iree_device_size_t committed_size,
+    iree_allocator_t host_allocator, iree_hal_buffer_t** out_buffer);
+
+// Maps physical memory into the virtual |buffer| such that at least the first
+// |minimum_committed_size| bytes may be accessed. The device address of the
+// buffer and the contents of the already committed range are unchanged and
+// work using them may be in-flight. No-op if enough memory is committed.
+// Returns OUT_OF_RANGE if the size exceeds the reserved range.
+//
+// Thread-safe.
+iree_status_t iree_hal_hip_virtual_buffer_commit(
+    iree_hal_buffer_t* buffer, iree_device_size_t minimum_committed_size);
+
+// Returns the number of bytes of the virtual |buffer| backed by physical
+// memory.
+iree_device_size_t iree_hal_hip_virtual_buffer_committed_size(
+    iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_HIP_VIRTUAL_BUFFER_H_
@@ -11,15 +11,17 @@
 #include <string.h>
 
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/cpu.h"
 #include "iree/hal/drivers/local_sync/sync_event.h"
 #include "iree/hal/drivers/local_sync/sync_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/inline_command_buffer.h"
 #include "iree/hal/local/local_executable_cache.h"
+#include "iree/hal/local/profiling.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
-#include "iree/hal/utils/memory_file.h"
 
 typedef struct iree_hal_sync_device_t {
   iree_hal_resource_t resource;
@@ -31,10 +33,19 @@ typedef struct iree_hal_sync_device_t {
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Active dispatch profiling session, if any.
+  iree_hal_local_profiler_t* profiler;
+
   // Block pool used for command buffers with a larger block size (as command
   // buffers can contain inlined data uploads).
   iree_arena_block_pool_t large_block_pool;
 
+  // Optional fixed workgroup local memory reservation used when replaying
+  // command buffers. Only one submission may use it at a time and others fall
+  // back to allocating on demand.
+  iree_byte_span_t local_memory;
+  iree_atomic_int32_t local_memory_in_use;
+
   // Shared semaphore state used to emulate OS-level primitives. This backend
   // is intended to run on bare-metal systems where we need to perform all
   // synchronization ourselves.
@@ -64,6 +75,14 @@ static iree_status_t iree_hal_sync_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "arena block size too small (< 4096 bytes)");
   }
+  if (params->local_memory_size %
+          IREE_HAL_EXECUTABLE_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE !=
+      0) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "local memory size must be a multiple of %d bytes",
+        IREE_HAL_EXECUTABLE_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE);
+  }
   return iree_ok_status();
 }
 
@@ -109,6 +128,14 @@ iree_status_t iree_hal_sync_device_create(
     iree_hal_sync_semaphore_state_initialize(&device->semaphore_state);
   }
 
+  if (iree_status_is_ok(status) && params->local_memory_size > 0) {
+    status = iree_allocator_malloc(host_allocator, params->local_memory_size,
+                                   (void**)&device->local_memory.data);
+    if (iree_status_is_ok(status)) {
+      device->local_memory.data_length = params->local_memory_size;
+    }
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -125,6 +152,8 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
 
   iree_hal_sync_semaphore_state_deinitialize(&device->semaphore_state);
 
+  iree_status_ignore(iree_hal_local_profiler_end(device->profiler));
+
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
@@ -134,6 +163,7 @@ static void iree_hal_sync_device_destroy(iree_hal_device_t* base_device) {
 
   iree_arena_block_pool_deinitialize(&device->large_block_pool);
 
+  iree_allocator_free(host_allocator, device->local_memory.data);
   iree_allocator_free(host_allocator, device);
 
   IREE_TRACE_ZONE_END(z0);
@@ -236,7 +266,8 @@ static iree_status_t iree_hal_sync_device_create_command_buffer(
     return iree_hal_inline_command_buffer_create(
         iree_hal_device_allocator(base_device), mode, command_categories,
         queue_affinity, binding_capacity,
-        iree_hal_device_host_allocator(base_device), out_command_buffer);
+        iree_hal_device_host_allocator(base_device),
+        /*local_memory=*/iree_byte_span_empty(), out_command_buffer);
   } else {
     iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
     return iree_hal_deferred_command_buffer_create(
@@ -259,7 +290,8 @@ static iree_status_t iree_hal_sync_device_create_executable_cache(
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
   return iree_hal_local_executable_cache_create(
-      identifier, /*worker_capacity=*/1, device->loader_count, device->loaders,
+      identifier, /*worker_capacity=*/1, device->local_memory.data_length,
+      device->loader_count, device->loaders,
       iree_hal_device_host_allocator(base_device), out_executable_cache);
 }
 
@@ -267,14 +299,8 @@ static iree_status_t iree_hal_sync_device_import_file(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
     iree_hal_external_file_flags_t flags, iree_hal_file_t** out_file) {
-  if (iree_io_file_handle_type(handle) !=
-      IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    return iree_make_status(
-        IREE_STATUS_UNAVAILABLE,
-        "implementation does not support the external file type");
-  }
-  return iree_hal_memory_file_wrap(
-      queue_affinity, access, handle, iree_hal_device_allocator(base_device),
+  return iree_hal_file_from_handle(
+      iree_hal_device_allocator(base_device), queue_affinity, access, handle,
       iree_hal_device_host_allocator(base_device), out_file);
 }
 
@@ -389,10 +415,21 @@ static iree_status_t iree_hal_sync_device_apply_deferred_command_buffer(
   iree_byte_span_t storage =
       iree_make_byte_span(iree_alloca(storage_size), storage_size);
 
+  // Claim the local memory reservation if no other submission is using it.
+  // Executables were verified to fit within it when they were loaded.
+  iree_byte_span_t local_memory = iree_byte_span_empty();
+  int32_t expected_in_use = 0;
+  if (device->local_memory.data_length > 0 &&
+      iree_atomic_compare_exchange_strong(
+          &device->local_memory_in_use, &expected_in_use, 1,
+          iree_memory_order_acquire, iree_memory_order_relaxed)) {
+    local_memory = device->local_memory;
+  }
+
   // NOTE: we run unvalidated as inline command buffers don't support
   // binding tables and can be validated entirely while recording.
   iree_hal_command_buffer_t* inline_command_buffer = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_inline_command_buffer_initialize(
+  iree_status_t status = iree_hal_inline_command_buffer_initialize(
       device->device_allocator,
       iree_hal_command_buffer_mode(command_buffer) |
           IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
@@ -404,13 +441,19 @@ static iree_status_t iree_hal_sync_device_apply_deferred_command_buffer(
                : 0),
       iree_hal_command_buffer_allowed_categories(command_buffer),
       IREE_HAL_QUEUE_AFFINITY_ANY,
-      /*binding_capacity=*/0, device->host_allocator, storage,
-      &inline_command_buffer));
+      /*binding_capacity=*/0, device->host_allocator, local_memory, storage,
+      &inline_command_buffer);
 
-  iree_status_t status = iree_hal_deferred_command_buffer_apply(
-      command_buffer, inline_command_buffer, binding_table);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_deferred_command_buffer_apply(
+        command_buffer, inline_command_buffer, binding_table);
+    iree_hal_inline_command_buffer_deinitialize(inline_command_buffer);
+  }
 
-  iree_hal_inline_command_buffer_deinitialize(inline_command_buffer);
+  if (local_memory.data) {
+    iree_atomic_store(&device->local_memory_in_use, 0,
+                      iree_memory_order_release);
+  }
   return status;
 }
 
@@ -461,27 +504,30 @@ static iree_status_t iree_hal_sync_device_wait_semaphores(
 static iree_status_t iree_hal_sync_device_profiling_begin(
     iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
-  // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
-  // Capturing things like:
-  //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
-  //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
-  //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
-  return iree_ok_status();
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  if (device->profiler) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "profiling already active on the device");
+  }
+  // Only dispatch counters are supported; other modes are ignored (and that's
+  // ok). Counters are sampled with perf_event_open where available.
+  return iree_hal_local_profiler_begin(device->identifier, options,
+                                       device->host_allocator,
+                                       &device->profiler);
 }
 
 static iree_status_t iree_hal_sync_device_profiling_flush(
     iree_hal_device_t* base_device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  return iree_hal_local_profiler_flush(device->profiler);
 }
 
 static iree_status_t iree_hal_sync_device_profiling_end(
     iree_hal_device_t* base_device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+  iree_hal_sync_device_t* device = iree_hal_sync_device_cast(base_device);
+  iree_hal_local_profiler_t* profiler = device->profiler;
+  device->profiler = NULL;
+  return iree_hal_local_profiler_end(profiler);
 }
 
 static const iree_hal_device_vtable_t iree_hal_sync_device_vtable = {
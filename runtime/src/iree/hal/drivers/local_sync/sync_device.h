@@ -22,6 +22,12 @@ typedef struct iree_hal_sync_device_params_t {
   // Larger sizes will lower overhead and ensure the heap isn't hit for
   // transient allocations while also increasing memory consumption.
   iree_host_size_t arena_block_size;
+
+  // Size, in bytes, of a fixed workgroup local memory reservation allocated
+  // once with the device and reused by all dispatches. Executables requiring
+  // more local memory than this fail to load. 0 disables the reservation and
+  // local memory is allocated on demand per dispatch.
+  iree_host_size_t local_memory_size;
 } iree_hal_sync_device_params_t;
 
 // Initializes |out_params| to default values.
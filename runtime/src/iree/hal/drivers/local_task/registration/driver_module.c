@@ -20,6 +20,17 @@ IREE_FLAG(
     bool, task_abort_on_failure, false,
     "Aborts the program on the first failure within a task system queue.");
 
+IREE_FLAG(
+    int64_t, task_queue_pool_capacity, 256 * 1024 * 1024,
+    "Maximum bytes of queue-ordered allocations retained for reuse by each "
+    "local-task device. 0 disables pooling.");
+
+IREE_FLAG(
+    int32_t, task_queue_submission_timeout_ms, 0,
+    "Maximum milliseconds a local-task queue submission may remain in flight "
+    "before the queue cancels its remaining work and fails with "
+    "DEADLINE_EXCEEDED. 0 disables submission deadlines.");
+
 static iree_status_t iree_hal_local_task_driver_factory_enumerate(
     void* self, iree_host_size_t* out_driver_info_count,
     const iree_hal_driver_info_t** out_driver_infos) {
@@ -49,6 +60,12 @@ static iree_status_t iree_hal_local_task_driver_factory_try_create(
   if (FLAG_task_abort_on_failure) {
     default_params.queue_scope_flags |= IREE_TASK_SCOPE_FLAG_ABORT_ON_FAILURE;
   }
+  default_params.queue_pool_capacity =
+      (iree_device_size_t)iree_max(0, FLAG_task_queue_pool_capacity);
+  if (FLAG_task_queue_submission_timeout_ms > 0) {
+    default_params.queue_submission_timeout =
+        (iree_duration_t)FLAG_task_queue_submission_timeout_ms * 1000000;
+  }
 
   // Create executors for each topology specified by flags.
   // Stack allocated storage today but we can query for the total count and
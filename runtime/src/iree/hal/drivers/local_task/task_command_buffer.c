@@ -25,6 +25,89 @@
 // iree_hal_task_command_buffer_t
 //===----------------------------------------------------------------------===//
 
+// A node in the command buffer task DAG tracked during recording.
+// Each execution task emitted gets a node that accumulates the set of tasks
+// that must wait for it to complete. Once recording ends the dependents are
+// converted into the task system representation (completion task/barrier).
+typedef struct iree_hal_task_cmd_node_t iree_hal_task_cmd_node_t;
+
+// An edge from a node to a node that depends on it.
+typedef struct iree_hal_task_cmd_edge_t {
+  struct iree_hal_task_cmd_edge_t* next;
+  iree_hal_task_cmd_node_t* dependent_node;
+} iree_hal_task_cmd_edge_t;
+
+struct iree_hal_task_cmd_node_t {
+  // Next node in recording order.
+  iree_hal_task_cmd_node_t* next;
+  // Index of the node in recording order.
+  iree_host_size_t index;
+  // Task executing the command. The task is always at the start of the command
+  // storage and |cmd_size| bytes (including the task) describe the command.
+  iree_task_t* task;
+  iree_host_size_t cmd_size;
+  // Total number of nodes this node depends on (incoming edges).
+  iree_host_size_t dependency_count;
+  // Total number of nodes that depend on this node (outgoing edges).
+  iree_host_size_t dependent_count;
+  // LIFO list of nodes that depend on this node.
+  iree_hal_task_cmd_edge_t* dependents;
+};
+
+// A buffer range accessed by a command recorded in the command buffer.
+// Ranges are tracked in terms of the allocated buffer so that subspans of the
+// same allocation are correctly detected as aliasing. Indirect references have
+// no buffer and are tracked by binding table slot with slot-relative ranges.
+typedef struct iree_hal_task_cmd_access_t {
+  struct iree_hal_task_cmd_access_t* next;
+  // Node of the command that performed the access.
+  iree_hal_task_cmd_node_t* node;
+  // Barrier epoch the access was recorded in.
+  uint32_t epoch;
+  // True if the command may write to the range.
+  bool is_write;
+  // Allocated buffer (not subspan) or NULL if the access is indirect.
+  const iree_hal_buffer_t* buffer;
+  // Binding table slot when |buffer| is NULL.
+  uint32_t buffer_slot;
+  // Absolute byte range accessed in |buffer| or relative to |buffer_slot|.
+  iree_device_size_t offset;
+  iree_device_size_t length;
+} iree_hal_task_cmd_access_t;
+
+typedef enum iree_hal_task_cmd_fixup_type_e {
+  // Replaces an iree_hal_buffer_ref_t in the command with the resolved ref.
+  IREE_HAL_TASK_CMD_FIXUP_TYPE_BUFFER_REF = 0,
+  // Maps the resolved range and stores the host pointer (and length, if any).
+  IREE_HAL_TASK_CMD_FIXUP_TYPE_MAPPING,
+} iree_hal_task_cmd_fixup_type_t;
+
+// An indirect buffer reference in a recorded command that must be patched with
+// the binding table provided each time the command buffer is issued.
+typedef struct iree_hal_task_cmd_fixup_t {
+  struct iree_hal_task_cmd_fixup_t* next;
+  iree_hal_task_cmd_fixup_type_t type;
+  // Memory access used when mapping the resolved range.
+  iree_hal_memory_access_t access;
+  // Index of the node owning the command that is patched.
+  iree_host_size_t node_index;
+  // Byte offset from the start of the command to the iree_hal_buffer_ref_t
+  // (BUFFER_REF) or void* (MAPPING) patched.
+  iree_host_size_t ref_offset;
+  // Byte offset from the start of the command to the size_t mapped length or 0
+  // if the length is not stored.
+  iree_host_size_t length_offset;
+  // Indirect buffer reference as recorded.
+  iree_hal_buffer_ref_t buffer_ref;
+} iree_hal_task_cmd_fixup_t;
+
+// A buffer referenced directly by a command buffer that also has indirect
+// references. Used to detect binding tables that alias direct buffers.
+typedef struct iree_hal_task_cmd_direct_buffer_t {
+  struct iree_hal_task_cmd_direct_buffer_t* next;
+  const iree_hal_buffer_t* buffer;
+} iree_hal_task_cmd_direct_buffer_t;
+
 // iree/task/-based command buffer.
 // We track a minimal amount of state here and incrementally build out the task
 // DAG that we can submit to the task system directly. There's no intermediate
@@ -33,6 +116,22 @@
 // additional allocations required during recording or execution. That means our
 // command buffer here is essentially just a builder for the task system types
 // and manager of the lifetime of the tasks.
+//
+// Execution barriers do not join all prior work. Instead each command records
+// the buffer ranges it accesses and at each barrier boundary we only add edges
+// between commands that have a read-after-write, write-after-read, or
+// write-after-write hazard on overlapping ranges. Commands that are
+// independent are allowed to execute concurrently even if the HAL command
+// stream has barriers between them.
+//
+// One-shot command buffers with only direct buffer references issue the
+// recorded tasks directly. Reusable command buffers and those with indirect
+// buffer references instead retain the recorded tasks and DAG as a template:
+// each issue clones the commands into the submission arena with a single
+// allocation, patches any indirect references with the binding table, and
+// links the clones with the DAG edges computed once at the end of recording.
+// This allows the same command buffer to be in flight multiple times without
+// re-recording or re-running hazard analysis.
 typedef struct iree_hal_task_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
@@ -53,29 +152,47 @@ typedef struct iree_hal_task_command_buffer_t {
 
   // One or more tasks at the leaves of the DAG.
   // Only once all these tasks have completed execution will the command buffer
-  // be considered completed as a whole.
-  //
-  // An empty list indicates that root_tasks are also the leaves.
-  iree_task_list_t leaf_tasks;
+  // be considered completed as a whole. Tasks may be both roots and leaves and
+  // since the intrusive task list pointer is used by |root_tasks| the leaves
+  // are stored in an arena-allocated array.
+  iree_host_size_t leaf_task_count;
+  iree_task_t** leaf_tasks;
+
+  // Recorded template used to produce the tasks on each issue when the command
+  // buffer is replayable (reusable or with indirect bindings). The template
+  // tasks are never executed directly. All storage referenced is allocated
+  // from the arena and lives as long as the command buffer.
+  struct {
+    // True if the command buffer retains the template for replay.
+    bool enabled;
+    // All nodes in recording order.
+    iree_host_size_t node_count;
+    iree_hal_task_cmd_node_t* node_head;
+    // Total bytes required to clone all commands and fan-out barriers.
+    iree_host_size_t storage_size;
+    // Indirect buffer references patched on each issue.
+    iree_hal_task_cmd_fixup_t* fixup_head;
+    // Bitmap of binding table slots referenced by the command buffer.
+    uint64_t* slot_mask;
+    // Unique allocated buffers referenced directly.
+    iree_hal_task_cmd_direct_buffer_t* direct_buffer_head;
+  } program;
 
-  // TODO(benvanik): move this out of the struct and allocate from the arena -
-  // we only need this during recording and it's ~4KB of waste otherwise.
   // State tracked within the command buffer during recording only.
+  // All storage referenced is allocated from the arena.
   struct {
-    // The last global barrier that was inserted, if any.
-    // The barrier is allocated and inserted into the DAG when requested but the
-    // actual barrier dependency list is only allocated and set on flushes.
-    // This lets us allocate the appropriately sized barrier task list from the
-    // arena even though when the barrier is recorded we don't yet know what
-    // other tasks we'll be emitting as we walk the command stream.
-    iree_task_barrier_t* open_barrier;
-
-    // The number of tasks in the open barrier (|open_tasks|), used to quickly
-    // allocate storage for the task list without needing to walk the list.
-    iree_host_size_t open_task_count;
-
-    // All execution tasks emitted that must execute after |open_barrier|.
-    iree_task_list_t open_tasks;
+    // Current barrier epoch. Incremented on each barrier; commands recorded in
+    // the same epoch are allowed to execute concurrently.
+    uint32_t epoch;
+
+    // All nodes in recording order.
+    iree_host_size_t node_count;
+    iree_hal_task_cmd_node_t* node_head;
+    iree_hal_task_cmd_node_t* node_tail;
+
+    // Live buffer range accesses that later commands may have hazards with.
+    // Accesses are pruned when a later write fully covers them.
+    iree_hal_task_cmd_access_t* access_head;
   } state;
 } iree_hal_task_command_buffer_t;
 
@@ -98,25 +215,6 @@ iree_status_t iree_hal_task_command_buffer_create(
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
-  if (!iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT)) {
-    // If we want reuse we'd need to support duplicating the task DAG after
-    // recording or have some kind of copy-on-submit behavior that does so if
-    // a command buffer is submitted for execution twice. Allowing for the same
-    // command buffer to be enqueued multiple times would be fine so long as
-    // execution doesn't overlap (`cmdbuf|cmdbuf` vs
-    // `cmdbuf -> semaphore -> cmdbuf`) though we'd still need to be careful
-    // that we did the enqueuing and reset of the task structures at the right
-    // times. Definitely something that'll be useful in the future... but not
-    // today :)
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "only one-shot command buffer usage is supported");
-  }
-  if (binding_capacity > 0) {
-    // TODO(#10144): support indirect command buffers with binding tables.
-    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                            "indirect command buffers not yet implemented");
-  }
-
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_task_command_buffer_t* command_buffer = NULL;
@@ -134,11 +232,25 @@ iree_status_t iree_hal_task_command_buffer_create(
     command_buffer->scope = scope;
     iree_arena_initialize(block_pool, &command_buffer->arena);
     iree_task_list_initialize(&command_buffer->root_tasks);
-    iree_task_list_initialize(&command_buffer->leaf_tasks);
+    command_buffer->leaf_task_count = 0;
+    command_buffer->leaf_tasks = NULL;
+    memset(&command_buffer->program, 0, sizeof(command_buffer->program));
     memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+    command_buffer->program.enabled =
+        !iree_all_bits_set(mode, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT) ||
+        binding_capacity > 0;
     status = iree_hal_resource_set_allocate(block_pool,
                                             &command_buffer->resource_set);
   }
+  if (iree_status_is_ok(status) && binding_capacity > 0) {
+    const iree_host_size_t slot_mask_size =
+        iree_host_size_ceil_div(binding_capacity, 64) * sizeof(uint64_t);
+    status = iree_arena_allocate(&command_buffer->arena, slot_mask_size,
+                                 (void**)&command_buffer->program.slot_mask);
+    if (iree_status_is_ok(status)) {
+      memset(command_buffer->program.slot_mask, 0, slot_mask_size);
+    }
+  }
   if (iree_status_is_ok(status)) {
     *out_command_buffer = &command_buffer->base;
   } else {
@@ -157,8 +269,10 @@ static void iree_hal_task_command_buffer_destroy(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+  memset(&command_buffer->program, 0, sizeof(command_buffer->program));
   iree_task_list_discard(&command_buffer->root_tasks);
-  iree_task_list_discard(&command_buffer->leaf_tasks);
+  command_buffer->leaf_task_count = 0;
+  command_buffer->leaf_tasks = NULL;
   iree_arena_deinitialize(&command_buffer->arena);
   iree_hal_resource_set_free(command_buffer->resource_set);
   iree_allocator_free(host_allocator, command_buffer);
@@ -176,14 +290,15 @@ bool iree_hal_task_command_buffer_isa(
 // iree_hal_task_command_buffer_t recording
 //===----------------------------------------------------------------------===//
 
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
+static iree_status_t iree_hal_task_command_buffer_build_dag(
     iree_hal_task_command_buffer_t* command_buffer);
 
 static iree_status_t iree_hal_task_command_buffer_begin(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  if (!iree_task_list_is_empty(&command_buffer->root_tasks)) {
+  if (!iree_task_list_is_empty(&command_buffer->root_tasks) ||
+      command_buffer->program.node_count > 0) {
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "command buffer cannot be re-recorded");
   }
@@ -195,175 +310,556 @@ static iree_status_t iree_hal_task_command_buffer_end(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // Flush any open barriers.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
-
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
-  }
+  // Convert the recorded nodes and their edges into the task DAG.
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_build_dag(command_buffer));
 
   iree_hal_resource_set_freeze(command_buffer->resource_set);
 
   return iree_ok_status();
 }
 
-// Flushes all open tasks to the previous barrier and prepares for more
-// recording. The root tasks are also populated here when required as this is
-// the one place where we can see both halves of the most recent synchronization
-// event: those tasks recorded prior (if any) and the task that marks the set of
-// tasks that will be recorded after (if any).
-static iree_status_t iree_hal_task_command_buffer_flush_tasks(
+// Returns the bytes required to store the barrier used to fan out from |node|
+// to its dependents.
+static iree_host_size_t iree_hal_task_cmd_node_barrier_size(
+    const iree_hal_task_cmd_node_t* node) {
+  return sizeof(iree_task_barrier_t) +
+         node->dependent_count * sizeof(iree_task_t*);
+}
+
+// Links |task| (the task of |node|) to the tasks of its dependents as looked
+// up in |tasks| by node index. Nodes with a single dependent chain directly to
+// it while those with multiple fan out via a barrier initialized in
+// |barrier_storage| of iree_hal_task_cmd_node_barrier_size bytes.
+static void iree_hal_task_cmd_node_link(iree_task_scope_t* scope,
+                                        const iree_hal_task_cmd_node_t* node,
+                                        iree_task_t* task, iree_task_t** tasks,
+                                        uint8_t* barrier_storage) {
+  if (node->dependent_count == 1) {
+    // Special-case: only one dependent so we can avoid the additional barrier
+    // overhead by reusing the completion task.
+    iree_task_set_completion_task(
+        task, tasks[node->dependents->dependent_node->index]);
+    return;
+  }
+  // Fan out to all dependents via a barrier. The dependents were accumulated
+  // in LIFO order so we reverse them here to issue in recording order.
+  iree_task_barrier_t* barrier = (iree_task_barrier_t*)barrier_storage;
+  iree_task_t** dependent_tasks =
+      (iree_task_t**)(barrier_storage + sizeof(*barrier));
+  iree_host_size_t i = node->dependent_count;
+  for (iree_hal_task_cmd_edge_t* edge = node->dependents; edge;
+       edge = edge->next) {
+    dependent_tasks[--i] = tasks[edge->dependent_node->index];
+  }
+  iree_task_barrier_initialize_empty(scope, barrier);
+  iree_task_barrier_set_dependent_tasks(barrier, node->dependent_count,
+                                        dependent_tasks);
+  iree_task_set_completion_task(task, &barrier->header);
+}
+
+// Builds the task DAG from the nodes recorded. Nodes with no dependencies are
+// the roots and nodes with no dependents are the leaves. Recording state is
+// discarded afterward.
+//
+// Replayable command buffers keep the nodes as the template for each issue and
+// only compute the storage required to clone them.
+static iree_status_t iree_hal_task_command_buffer_build_dag(
     iree_hal_task_command_buffer_t* command_buffer) {
-  iree_task_barrier_t* open_barrier = command_buffer->state.open_barrier;
-  if (open_barrier != NULL) {
-    // There is an open barrier we need to fixup the fork out to all of the open
-    // tasks that were recorded after it.
-    iree_task_t* task_head =
-        iree_task_list_front(&command_buffer->state.open_tasks);
-    iree_host_size_t dependent_task_count =
-        command_buffer->state.open_task_count;
-    if (dependent_task_count == 1) {
-      // Special-case: only one open task so we can avoid the additional barrier
-      // overhead by reusing the completion task.
-      iree_task_set_completion_task(&open_barrier->header, task_head);
-    } else if (dependent_task_count > 1) {
-      // Allocate the list of tasks we'll stash back on the previous barrier.
-      // Since we couldn't know at the time how many tasks would end up in the
-      // barrier we had to defer it until now.
-      iree_task_t** dependent_tasks = NULL;
-      IREE_RETURN_IF_ERROR(iree_arena_allocate(
-          &command_buffer->arena, dependent_task_count * sizeof(iree_task_t*),
-          (void**)&dependent_tasks));
-      iree_task_t* task = task_head;
-      for (iree_host_size_t i = 0; i < dependent_task_count; ++i) {
-        dependent_tasks[i] = task;
-        task = task->next_task;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, command_buffer->state.node_count);
+
+  if (command_buffer->program.enabled) {
+    iree_host_size_t storage_size = iree_host_align(
+        command_buffer->state.node_count * sizeof(iree_task_t*),
+        iree_max_align_t);
+    for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head;
+         node; node = node->next) {
+      storage_size += iree_host_align(node->cmd_size, iree_max_align_t);
+      if (node->dependent_count > 1) {
+        storage_size += iree_host_align(
+            iree_hal_task_cmd_node_barrier_size(node), iree_max_align_t);
       }
-      iree_task_barrier_set_dependent_tasks(open_barrier, dependent_task_count,
-                                            dependent_tasks);
     }
+    command_buffer->program.node_count = command_buffer->state.node_count;
+    command_buffer->program.node_head = command_buffer->state.node_head;
+    command_buffer->program.storage_size = storage_size;
+    memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
   }
-  command_buffer->state.open_barrier = NULL;
 
-  // Move the open tasks to the tail as they represent the first half of the
-  // *next* barrier that will be inserted.
-  if (command_buffer->state.open_task_count > 0) {
-    iree_task_list_move(&command_buffer->state.open_tasks,
-                        &command_buffer->leaf_tasks);
-    command_buffer->state.open_task_count = 0;
+  // Count the leaves first so we can allocate their storage in one shot. The
+  // task lookup table is only needed while linking and is allocated alongside.
+  const iree_host_size_t node_count = command_buffer->state.node_count;
+  iree_host_size_t leaf_task_count = 0;
+  for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head; node;
+       node = node->next) {
+    if (node->dependent_count == 0) ++leaf_task_count;
+  }
+  iree_task_t** tasks = NULL;
+  if (node_count > 0) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_arena_allocate(&command_buffer->arena,
+                                (node_count + leaf_task_count) *
+                                    sizeof(iree_task_t*),
+                                (void**)&tasks));
+    command_buffer->leaf_tasks = tasks + node_count;
+  }
+  for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head; node;
+       node = node->next) {
+    tasks[node->index] = node->task;
   }
 
-  return iree_ok_status();
+  iree_status_t status = iree_ok_status();
+  for (iree_hal_task_cmd_node_t* node = command_buffer->state.node_head; node;
+       node = node->next) {
+    if (node->dependent_count == 0) {
+      command_buffer->leaf_tasks[command_buffer->leaf_task_count++] =
+          node->task;
+    } else {
+      uint8_t* barrier_storage = NULL;
+      if (node->dependent_count > 1) {
+        status = iree_arena_allocate(&command_buffer->arena,
+                                     iree_hal_task_cmd_node_barrier_size(node),
+                                     (void**)&barrier_storage);
+        if (!iree_status_is_ok(status)) break;
+      }
+      iree_hal_task_cmd_node_link(command_buffer->scope, node, node->task,
+                                  tasks, barrier_storage);
+    }
+    if (node->dependency_count == 0) {
+      iree_task_list_push_back(&command_buffer->root_tasks, node->task);
+    }
+  }
+
+  memset(&command_buffer->state, 0, sizeof(command_buffer->state));
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
-// Emits a global barrier, splitting execution into all prior recorded tasks
-// and all subsequent recorded tasks. This is currently the critical piece that
-// limits our concurrency: changing to fine-grained barriers (via barrier
-// buffers or events) will allow more work to overlap at the cost of more brain
-// to build out the proper task graph.
+// Emits a barrier splitting execution into all prior recorded commands and all
+// subsequent recorded commands. Only commands with hazards across the barrier
+// will be ordered; see iree_hal_task_command_buffer_track_access.
 static iree_status_t iree_hal_task_command_buffer_emit_global_barrier(
     iree_hal_task_command_buffer_t* command_buffer) {
-  // Flush open tasks to the previous barrier. This resets our state such that
-  // we can assign the new open barrier and start recording tasks for it.
-  // Previous tasks will be moved into the leaf_tasks list.
-  IREE_RETURN_IF_ERROR(
-      iree_hal_task_command_buffer_flush_tasks(command_buffer));
-
-  // Allocate the new open barrier.
-  // As we are recording forward we can't yet assign the dependent tasks (the
-  // second half of the synchronization domain) and instead are just inserting
-  // it so we can setup the join from previous tasks (the first half of the
-  // synchronization domain).
-  iree_task_barrier_t* barrier = NULL;
+  ++command_buffer->state.epoch;
+  return iree_ok_status();
+}
+
+// Emits the given execution |task| into the current barrier epoch and returns
+// the node used to track its dependencies. |cmd_size| is the total size of the
+// command storage starting with |task|. Callers must then declare all buffer
+// ranges the task accesses with iree_hal_task_command_buffer_track_access.
+static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
+    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task,
+    iree_host_size_t cmd_size, iree_hal_task_cmd_node_t** out_node) {
+  *out_node = NULL;
+  iree_hal_task_cmd_node_t* node = NULL;
   IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
-                                           sizeof(*barrier), (void**)&barrier));
-  iree_task_barrier_initialize_empty(command_buffer->scope, barrier);
+                                           sizeof(*node), (void**)&node));
+  memset(node, 0, sizeof(*node));
+  node->index = command_buffer->state.node_count;
+  node->task = task;
+  node->cmd_size = cmd_size;
+  if (command_buffer->state.node_tail) {
+    command_buffer->state.node_tail->next = node;
+  } else {
+    command_buffer->state.node_head = node;
+  }
+  command_buffer->state.node_tail = node;
+  ++command_buffer->state.node_count;
+  *out_node = node;
+  return iree_ok_status();
+}
 
-  // If there were previous tasks then join them to the barrier.
-  for (iree_task_t* task = iree_task_list_front(&command_buffer->leaf_tasks);
-       task != NULL; task = task->next_task) {
-    iree_task_set_completion_task(task, &barrier->header);
+// Adds an edge indicating that |dependent_node| must execute after |node|.
+static iree_status_t iree_hal_task_command_buffer_add_edge(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_hal_task_cmd_node_t* dependent_node) {
+  // Edges are added for a dependent all at once so checking the most recent
+  // edge is enough to avoid duplicates from multiple overlapping accesses.
+  if (node == dependent_node ||
+      (node->dependents &&
+       node->dependents->dependent_node == dependent_node)) {
+    return iree_ok_status();
   }
+  iree_hal_task_cmd_edge_t* edge = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*edge), (void**)&edge));
+  edge->next = node->dependents;
+  edge->dependent_node = dependent_node;
+  node->dependents = edge;
+  ++node->dependent_count;
+  ++dependent_node->dependency_count;
+  return iree_ok_status();
+}
 
-  // Move the tasks from the leaf list (tail) to the root list (head) if this
-  // was the first set of tasks recorded.
-  if (iree_task_list_is_empty(&command_buffer->root_tasks) &&
-      !iree_task_list_is_empty(&command_buffer->leaf_tasks)) {
-    iree_task_list_move(&command_buffer->leaf_tasks,
-                        &command_buffer->root_tasks);
+// Records that |allocated_buffer| is referenced directly so that binding tables
+// aliasing it can be detected on issue. Only required when the command buffer
+// has indirect bindings.
+static iree_status_t iree_hal_task_command_buffer_track_direct_buffer(
+    iree_hal_task_command_buffer_t* command_buffer,
+    const iree_hal_buffer_t* allocated_buffer) {
+  for (iree_hal_task_cmd_direct_buffer_t* direct_buffer =
+           command_buffer->program.direct_buffer_head;
+       direct_buffer; direct_buffer = direct_buffer->next) {
+    if (direct_buffer->buffer == allocated_buffer) return iree_ok_status();
   }
+  iree_hal_task_cmd_direct_buffer_t* direct_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(
+      &command_buffer->arena, sizeof(*direct_buffer), (void**)&direct_buffer));
+  direct_buffer->next = command_buffer->program.direct_buffer_head;
+  direct_buffer->buffer = allocated_buffer;
+  command_buffer->program.direct_buffer_head = direct_buffer;
+  return iree_ok_status();
+}
 
-  // Reset the tail of the command buffer to the barrier. This leaves us in a
-  // consistent state if the recording ends immediate after this (the barrier
-  // will be the last task).
-  iree_task_list_t* target_task_list =
-      iree_task_list_is_empty(&command_buffer->root_tasks)
-          ? &command_buffer->root_tasks
-          : &command_buffer->leaf_tasks;
-  iree_task_list_initialize(target_task_list);
-  iree_task_list_push_back(target_task_list, &barrier->header);
+// Declares that |node| accesses the range of |buffer_ref| and adds edges from
+// any prior commands recorded before the last barrier that have a hazard with
+// the access. Accesses by commands in the same barrier epoch are not ordered.
+//
+// Indirect references are tracked by binding table slot. Distinct slots are
+// assumed not to alias each other or any direct buffer; this is verified
+// against the binding table on issue and the commands are serialized if not.
+//
+// NOTE: buffers are compared by their allocated buffer; distinct buffer
+// objects that wrap the same underlying host memory (such as two imports of
+// the same pointer) will not be detected as aliasing.
+static iree_status_t iree_hal_task_command_buffer_track_access(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_hal_buffer_ref_t buffer_ref,
+    bool is_write) {
+  const iree_hal_buffer_t* allocated_buffer = NULL;
+  uint32_t buffer_slot = 0;
+  iree_device_size_t offset = buffer_ref.offset;
+  iree_device_size_t length = buffer_ref.length;
+  if (buffer_ref.buffer) {
+    allocated_buffer = iree_hal_buffer_allocated_buffer(buffer_ref.buffer);
+    offset += iree_hal_buffer_byte_offset(buffer_ref.buffer);
+    if (length == IREE_WHOLE_BUFFER) {
+      iree_device_size_t byte_length =
+          iree_hal_buffer_byte_length(buffer_ref.buffer);
+      length = buffer_ref.offset < byte_length
+                   ? byte_length - buffer_ref.offset
+                   : 0;
+    }
+    if (command_buffer->program.slot_mask) {
+      IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_direct_buffer(
+          command_buffer, allocated_buffer));
+    }
+  } else if (command_buffer->program.slot_mask) {
+    buffer_slot = buffer_ref.buffer_slot;
+    if (IREE_UNLIKELY(buffer_slot >= command_buffer->base.binding_capacity)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "buffer binding slot %u out of range of binding "
+                              "capacity %u",
+                              buffer_slot,
+                              (uint32_t)command_buffer->base.binding_capacity);
+    }
+    command_buffer->program.slot_mask[buffer_slot / 64] |=
+        1ull << (buffer_slot % 64);
+    if (length == IREE_WHOLE_BUFFER) {
+      length = IREE_WHOLE_BUFFER - offset;
+    }
+  } else {
+    return iree_ok_status();
+  }
+  if (length == 0) return iree_ok_status();
+  const iree_device_size_t end = offset + length;
+
+  const uint32_t epoch = command_buffer->state.epoch;
+  iree_hal_task_cmd_access_t** access_ptr =
+      &command_buffer->state.access_head;
+  while (*access_ptr) {
+    iree_hal_task_cmd_access_t* access = *access_ptr;
+    if (access->epoch == epoch || access->buffer != allocated_buffer ||
+        access->buffer_slot != buffer_slot ||
+        !(is_write || access->is_write) || access->offset >= end ||
+        offset >= access->offset + access->length) {
+      access_ptr = &access->next;
+      continue;
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_edge(
+        command_buffer, access->node, node));
+    if (is_write && offset <= access->offset &&
+        access->offset + access->length <= end) {
+      // The prior access is fully covered by this write: any later access that
+      // has a hazard with it will also have a hazard with this write and be
+      // transitively ordered after it.
+      *access_ptr = access->next;
+    } else {
+      access_ptr = &access->next;
+    }
+  }
 
-  // NOTE: all new tasks emitted will be executed after this barrier.
-  command_buffer->state.open_barrier = barrier;
-  command_buffer->state.open_task_count = 0;
+  iree_hal_task_cmd_access_t* access = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*access), (void**)&access));
+  access->next = command_buffer->state.access_head;
+  access->node = node;
+  access->epoch = epoch;
+  access->is_write = is_write;
+  access->buffer = allocated_buffer;
+  access->buffer_slot = buffer_slot;
+  access->offset = offset;
+  access->length = length;
+  command_buffer->state.access_head = access;
+  return iree_ok_status();
+}
 
+// Records a fixup that patches the command of |node| with the resolved
+// indirect |buffer_ref| on each issue. |ref_offset| and |length_offset| are
+// byte offsets from the start of the command; see iree_hal_task_cmd_fixup_t.
+static iree_status_t iree_hal_task_command_buffer_add_fixup(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_hal_task_cmd_fixup_type_t type,
+    iree_hal_memory_access_t access, iree_host_size_t ref_offset,
+    iree_host_size_t length_offset, iree_hal_buffer_ref_t buffer_ref) {
+  iree_hal_task_cmd_fixup_t* fixup = NULL;
+  IREE_RETURN_IF_ERROR(iree_arena_allocate(&command_buffer->arena,
+                                           sizeof(*fixup), (void**)&fixup));
+  fixup->next = command_buffer->program.fixup_head;
+  fixup->type = type;
+  fixup->access = access;
+  fixup->node_index = node->index;
+  fixup->ref_offset = ref_offset;
+  fixup->length_offset = length_offset;
+  fixup->buffer_ref = buffer_ref;
+  command_buffer->program.fixup_head = fixup;
   return iree_ok_status();
 }
 
-// Emits a the given execution |task| into the current open synchronization
-// scope (after state.open_barrier and before the next barrier).
-static iree_status_t iree_hal_task_command_buffer_emit_execution_task(
-    iree_hal_task_command_buffer_t* command_buffer, iree_task_t* task) {
-  if (command_buffer->state.open_barrier == NULL) {
-    // If there is no open barrier then we are at the head and going right into
-    // the task DAG.
-    iree_task_list_push_back(&command_buffer->leaf_tasks, task);
-  } else {
-    // Append to the open task list that will be flushed to the open barrier.
-    iree_task_list_push_back(&command_buffer->state.open_tasks, task);
-    ++command_buffer->state.open_task_count;
+// Handles an iree_hal_buffer_ref_t stored in a fill/copy/update command: direct
+// references are used as-is while indirect ones are patched on issue. The
+// length of transfer commands is used to compute their tiling when recorded
+// and must be known for indirect references.
+static iree_status_t iree_hal_task_command_buffer_track_transfer_ref(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_task_cmd_node_t* node, iree_host_size_t ref_offset,
+    iree_hal_buffer_ref_t buffer_ref, bool is_write) {
+  if (!buffer_ref.buffer) {
+    if (IREE_UNLIKELY(buffer_ref.length == IREE_WHOLE_BUFFER)) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "indirect transfer buffer references must have an explicit length");
+    }
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_fixup(
+        command_buffer, node, IREE_HAL_TASK_CMD_FIXUP_TYPE_BUFFER_REF,
+        IREE_HAL_MEMORY_ACCESS_NONE, ref_offset, /*length_offset=*/0,
+        buffer_ref));
   }
-  return iree_ok_status();
+  return iree_hal_task_command_buffer_track_access(command_buffer, node,
+                                                   buffer_ref, is_write);
 }
 
 //===----------------------------------------------------------------------===//
 // iree_hal_task_command_buffer_t execution
 //===----------------------------------------------------------------------===//
 
+// Returns true if any two binding table slots referenced by the command buffer
+// resolve to overlapping ranges of the same allocation or if any slot resolves
+// to an allocation the command buffer also references directly. Hazards were
+// tracked assuming neither happens.
+static bool iree_hal_task_command_buffer_bindings_alias(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
+  const uint64_t* slot_mask = command_buffer->program.slot_mask;
+  const iree_host_size_t slot_count =
+      iree_min(binding_table.count, command_buffer->base.binding_capacity);
+  for (iree_host_size_t i = 0; i < slot_count; ++i) {
+    if (!(slot_mask[i / 64] & (1ull << (i % 64)))) continue;
+    const iree_hal_buffer_binding_t* binding = &binding_table.bindings[i];
+    if (!binding->buffer) continue;
+    const iree_hal_buffer_t* allocated_buffer =
+        iree_hal_buffer_allocated_buffer(binding->buffer);
+    for (iree_hal_task_cmd_direct_buffer_t* direct_buffer =
+             command_buffer->program.direct_buffer_head;
+         direct_buffer; direct_buffer = direct_buffer->next) {
+      if (direct_buffer->buffer == allocated_buffer) return true;
+    }
+    const iree_device_size_t offset =
+        iree_hal_buffer_byte_offset(binding->buffer) + binding->offset;
+    const iree_device_size_t end =
+        binding->length == IREE_WHOLE_BUFFER
+            ? IREE_WHOLE_BUFFER
+            : offset + binding->length;
+    for (iree_host_size_t j = i + 1; j < slot_count; ++j) {
+      if (!(slot_mask[j / 64] & (1ull << (j % 64)))) continue;
+      const iree_hal_buffer_binding_t* other_binding =
+          &binding_table.bindings[j];
+      if (!other_binding->buffer ||
+          iree_hal_buffer_allocated_buffer(other_binding->buffer) !=
+              allocated_buffer) {
+        continue;
+      }
+      const iree_device_size_t other_offset =
+          iree_hal_buffer_byte_offset(other_binding->buffer) +
+          other_binding->offset;
+      const iree_device_size_t other_end =
+          other_binding->length == IREE_WHOLE_BUFFER
+              ? IREE_WHOLE_BUFFER
+              : other_offset + other_binding->length;
+      if (offset < other_end && other_offset < end) return true;
+    }
+  }
+  return false;
+}
+
+// Patches the cloned command |cmd| with the resolved buffer reference of
+// |fixup| from |binding_table|.
+static iree_status_t iree_hal_task_cmd_fixup_apply(
+    const iree_hal_task_cmd_fixup_t* fixup,
+    iree_hal_buffer_binding_table_t binding_table, uint8_t* cmd) {
+  iree_hal_buffer_ref_t resolved_ref;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_binding_table_resolve_ref(
+      binding_table, fixup->buffer_ref, &resolved_ref));
+  if (IREE_UNLIKELY(!resolved_ref.buffer)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "required binding table slot %u is NULL",
+                            fixup->buffer_ref.buffer_slot);
+  }
+  switch (fixup->type) {
+    case IREE_HAL_TASK_CMD_FIXUP_TYPE_BUFFER_REF:
+      memcpy(cmd + fixup->ref_offset, &resolved_ref, sizeof(resolved_ref));
+      return iree_ok_status();
+    case IREE_HAL_TASK_CMD_FIXUP_TYPE_MAPPING: {
+      // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
+      iree_hal_buffer_mapping_t buffer_mapping = {{0}};
+      IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+          resolved_ref.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT, fixup->access,
+          resolved_ref.offset, resolved_ref.length, &buffer_mapping));
+      void* data = buffer_mapping.contents.data;
+      memcpy(cmd + fixup->ref_offset, &data, sizeof(data));
+      if (fixup->length_offset) {
+        size_t data_length = (size_t)buffer_mapping.contents.data_length;
+        memcpy(cmd + fixup->length_offset, &data_length, sizeof(data_length));
+      }
+      return iree_ok_status();
+    }
+    default:
+      return iree_make_status(IREE_STATUS_INTERNAL, "unknown fixup type");
+  }
+}
+
+// Issues a replayable command buffer by cloning the recorded template into
+// |arena| and linking the clones. The template is left untouched so that the
+// command buffer may be issued again (even while prior issues are executing).
+static iree_status_t iree_hal_task_command_buffer_issue_program(
+    iree_hal_task_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table, iree_task_t* retire_task,
+    iree_arena_allocator_t* arena, iree_task_submission_t* pending_submission) {
+  const iree_host_size_t node_count = command_buffer->program.node_count;
+  if (node_count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, node_count);
+
+  uint8_t* storage = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_arena_allocate(arena, command_buffer->program.storage_size,
+                              (void**)&storage));
+  iree_task_t** tasks = (iree_task_t**)storage;
+  uint8_t* storage_ptr =
+      storage + iree_host_align(node_count * sizeof(iree_task_t*),
+                                iree_max_align_t);
+
+  // Clone all commands. Their tasks were never issued and are still in their
+  // initialized state aside from the closures referencing the original
+  // commands.
+  for (iree_hal_task_cmd_node_t* node = command_buffer->program.node_head;
+       node; node = node->next) {
+    memcpy(storage_ptr, node->task, node->cmd_size);
+    iree_task_t* task = (iree_task_t*)storage_ptr;
+    switch (task->type) {
+      case IREE_TASK_TYPE_CALL:
+        ((iree_task_call_t*)task)->closure.user_context = task;
+        break;
+      case IREE_TASK_TYPE_DISPATCH:
+        ((iree_task_dispatch_t*)task)->closure.user_context = task;
+        break;
+      default:
+        break;
+    }
+    tasks[node->index] = task;
+    storage_ptr += iree_host_align(node->cmd_size, iree_max_align_t);
+  }
+
+  // Patch indirect references with the binding table.
+  for (iree_hal_task_cmd_fixup_t* fixup = command_buffer->program.fixup_head;
+       fixup; fixup = fixup->next) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_hal_task_cmd_fixup_apply(fixup, binding_table,
+                                          (uint8_t*)tasks[fixup->node_index]));
+  }
+
+  // Link the clones using the recorded DAG. If the binding table aliases in a
+  // way the hazard tracking assumed it wouldn't we fall back to executing the
+  // commands one after another in recording order.
+  iree_task_list_t root_tasks;
+  iree_task_list_initialize(&root_tasks);
+  if (command_buffer->program.slot_mask &&
+      iree_hal_task_command_buffer_bindings_alias(command_buffer,
+                                                  binding_table)) {
+    for (iree_host_size_t i = 0; i + 1 < node_count; ++i) {
+      iree_task_set_completion_task(tasks[i], tasks[i + 1]);
+    }
+    iree_task_set_completion_task(tasks[node_count - 1], retire_task);
+    iree_task_list_push_back(&root_tasks, tasks[0]);
+  } else {
+    for (iree_hal_task_cmd_node_t* node = command_buffer->program.node_head;
+         node; node = node->next) {
+      iree_task_t* task = tasks[node->index];
+      if (node->dependent_count == 0) {
+        // Chain the retire task onto the leaf tasks as their completion
+        // indicates that all commands have completed.
+        iree_task_set_completion_task(task, retire_task);
+      } else {
+        uint8_t* barrier_storage = NULL;
+        if (node->dependent_count > 1) {
+          barrier_storage = storage_ptr;
+          storage_ptr += iree_host_align(
+              iree_hal_task_cmd_node_barrier_size(node), iree_max_align_t);
+        }
+        iree_hal_task_cmd_node_link(command_buffer->scope, node, task, tasks,
+                                    barrier_storage);
+      }
+      if (node->dependency_count == 0) {
+        iree_task_list_push_back(&root_tasks, task);
+      }
+    }
+  }
+
+  // Enqueue all root tasks that are ready to run immediately.
+  iree_task_submission_enqueue_list(pending_submission, &root_tasks);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* base_command_buffer,
-    iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
+    iree_hal_task_queue_state_t* queue_state,
+    iree_hal_buffer_binding_table_t binding_table, iree_task_t* retire_task,
     iree_arena_allocator_t* arena, iree_task_submission_t* pending_submission) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
   IREE_ASSERT_TRUE(command_buffer);
 
+  if (command_buffer->program.enabled) {
+    return iree_hal_task_command_buffer_issue_program(
+        command_buffer, binding_table, retire_task, arena, pending_submission);
+  }
+
   // If the command buffer is empty (valid!) then we are a no-op.
   bool has_root_tasks = !iree_task_list_is_empty(&command_buffer->root_tasks);
   if (!has_root_tasks) {
     return iree_ok_status();
   }
 
-  bool has_leaf_tasks = !iree_task_list_is_empty(&command_buffer->leaf_tasks);
-  if (has_leaf_tasks) {
-    // Chain the retire task onto the leaf tasks as their completion indicates
-    // that all commands have completed.
-    for (iree_task_t* task = command_buffer->leaf_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
-  } else {
-    // If we have no leaf tasks it means that this is a single layer DAG and
-    // after the root tasks complete the entire command buffer has completed.
-    for (iree_task_t* task = command_buffer->root_tasks.head; task != NULL;
-         task = task->next_task) {
-      iree_task_set_completion_task(task, retire_task);
-    }
+  // Chain the retire task onto the leaf tasks as their completion indicates
+  // that all commands have completed.
+  for (iree_host_size_t i = 0; i < command_buffer->leaf_task_count; ++i) {
+    iree_task_set_completion_task(command_buffer->leaf_tasks[i], retire_task);
   }
 
   // Enqueue all root tasks that are ready to run immediately.
@@ -371,7 +867,8 @@ iree_status_t iree_hal_task_command_buffer_issue(
   // we need to ensure the command buffer doesn't try to discard them.
   iree_task_submission_enqueue_list(pending_submission,
                                     &command_buffer->root_tasks);
-  iree_task_list_initialize(&command_buffer->leaf_tasks);
+  command_buffer->leaf_task_count = 0;
+  command_buffer->leaf_tasks = NULL;
 
   return iree_ok_status();
 }
@@ -410,8 +907,8 @@ static iree_status_t iree_hal_task_command_buffer_execution_barrier(
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
-  // TODO(benvanik): actual DAG construction. Right now we are just doing simple
-  // global barriers each time and forcing a join-fork point.
+  // NOTE: memory and buffer barriers are ignored as all host memory is coherent
+  // and hazards are tracked per command range by the DAG construction.
   return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
 }
 
@@ -452,7 +949,8 @@ static iree_status_t iree_hal_task_command_buffer_wait_events(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
-  // TODO(#4518): implement events. For now we just insert global barriers.
+  // TODO(#4518): implement events. For now we treat waits as barriers and rely
+  // on the hazard tracking to only order commands that need it.
   return iree_hal_task_command_buffer_emit_global_barrier(command_buffer);
 }
 
@@ -541,8 +1039,13 @@ static iree_status_t iree_hal_task_command_buffer_fill_buffer(
   memcpy(cmd->pattern, pattern, pattern_length);
   cmd->pattern_length = pattern_length;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, sizeof(*cmd), &node));
+  return iree_hal_task_command_buffer_track_transfer_ref(
+      command_buffer, node,
+      offsetof(iree_hal_task_cmd_fill_buffer_t, target_ref), target_ref,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -593,8 +1096,13 @@ static iree_status_t iree_hal_task_command_buffer_update_buffer(
   memcpy(cmd->source_buffer, (const uint8_t*)source_buffer + source_offset,
          cmd->target_ref.length);
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, total_cmd_size, &node));
+  return iree_hal_task_command_buffer_track_transfer_ref(
+      command_buffer, node,
+      offsetof(iree_hal_task_cmd_update_buffer_t, target_ref), target_ref,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -674,8 +1182,17 @@ static iree_status_t iree_hal_task_command_buffer_copy_buffer(
   cmd->source_ref = source_ref;
   cmd->target_ref = target_ref;
 
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, sizeof(*cmd), &node));
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_transfer_ref(
+      command_buffer, node,
+      offsetof(iree_hal_task_cmd_copy_buffer_t, source_ref), source_ref,
+      /*is_write=*/false));
+  return iree_hal_task_command_buffer_track_transfer_ref(
+      command_buffer, node,
+      offsetof(iree_hal_task_cmd_copy_buffer_t, target_ref), target_ref,
+      /*is_write=*/true);
 }
 
 //===----------------------------------------------------------------------===//
@@ -786,12 +1303,15 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
     iree_hal_executable_t* executable, int32_t entry_point,
     const uint32_t workgroup_count[3], iree_const_byte_span_t constants,
     iree_hal_buffer_ref_list_t bindings,
-    iree_hal_task_cmd_dispatch_t** out_cmd) {
+    iree_hal_task_cmd_dispatch_t** out_cmd,
+    iree_hal_task_cmd_node_t** out_node) {
   iree_hal_task_command_buffer_t* command_buffer =
       iree_hal_task_command_buffer_cast(base_command_buffer);
 
   iree_hal_local_executable_t* local_executable =
       iree_hal_local_executable_cast(executable);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_executable_ensure_loaded(local_executable));
   iree_hal_executable_dispatch_attrs_v0_t dispatch_attrs = {0};
   if (local_executable->dispatch_attrs) {
     dispatch_attrs = local_executable->dispatch_attrs[entry_point];
@@ -871,6 +1391,8 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
           binding.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
           IREE_HAL_MEMORY_ACCESS_ANY, binding.offset, binding.length,
           &buffer_mapping));
+    } else if (command_buffer->program.slot_mask) {
+      // Indirect binding mapped from the binding table on issue.
     } else {
       return iree_make_status(
           IREE_STATUS_FAILED_PRECONDITION,
@@ -885,9 +1407,33 @@ static iree_status_t iree_hal_task_command_buffer_build_dispatch(
       command_buffer->resource_set, bindings.count, bindings.values,
       offsetof(iree_hal_buffer_ref_t, buffer), sizeof(iree_hal_buffer_ref_t)));
 
+  iree_hal_task_cmd_node_t* node = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_emit_execution_task(
+      command_buffer, &cmd->task.header, total_cmd_size, &node));
+
+  // We don't know how the executable accesses each binding and must assume any
+  // may be written unless the buffer itself disallows writes.
+  for (iree_host_size_t i = 0; i < bindings.count; ++i) {
+    const iree_hal_buffer_ref_t binding = bindings.values[i];
+    if (!binding.buffer) {
+      IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_fixup(
+          command_buffer, node, IREE_HAL_TASK_CMD_FIXUP_TYPE_MAPPING,
+          IREE_HAL_MEMORY_ACCESS_ANY,
+          (iree_host_size_t)((uint8_t*)&binding_ptrs[i] - (uint8_t*)cmd),
+          (iree_host_size_t)((uint8_t*)&binding_lengths[i] - (uint8_t*)cmd),
+          binding));
+    }
+    const bool is_write =
+        !binding.buffer || iree_all_bits_set(
+                               iree_hal_buffer_allowed_access(binding.buffer),
+                               IREE_HAL_MEMORY_ACCESS_WRITE);
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_track_access(
+        command_buffer, node, binding, is_write));
+  }
+
   *out_cmd = cmd;
-  return iree_hal_task_command_buffer_emit_execution_task(command_buffer,
-                                                          &cmd->task.header);
+  *out_node = node;
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch(
@@ -902,9 +1448,10 @@ static iree_status_t iree_hal_task_command_buffer_dispatch(
       command_buffer->resource_set, 1, &executable));
 
   iree_hal_task_cmd_dispatch_t* cmd = NULL;
+  iree_hal_task_cmd_node_t* node = NULL;
   return iree_hal_task_command_buffer_build_dispatch(
       base_command_buffer, executable, entry_point, workgroup_count, constants,
-      bindings, &cmd);
+      bindings, &cmd, &node);
 }
 
 static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
@@ -921,19 +1468,35 @@ static iree_status_t iree_hal_task_command_buffer_dispatch_indirect(
 
   // TODO(benvanik): track mapping so we can properly map/unmap/flush/etc.
   iree_hal_buffer_mapping_t buffer_mapping = {{0}};
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
-      workgroups_ref.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
-      IREE_HAL_MEMORY_ACCESS_READ, workgroups_ref.offset, 3 * sizeof(uint32_t),
-      &buffer_mapping));
+  if (workgroups_ref.buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+        workgroups_ref.buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
+        IREE_HAL_MEMORY_ACCESS_READ, workgroups_ref.offset,
+        3 * sizeof(uint32_t), &buffer_mapping));
+  }
 
   uint32_t workgroup_count[3] = {0};  // unused with the indirect flag
   iree_hal_task_cmd_dispatch_t* cmd = NULL;
+  iree_hal_task_cmd_node_t* node = NULL;
   IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_build_dispatch(
       base_command_buffer, executable, entry_point, workgroup_count, constants,
-      bindings, &cmd));
+      bindings, &cmd, &node));
   cmd->task.workgroup_count.ptr = (const uint32_t*)buffer_mapping.contents.data;
   cmd->task.header.flags |= IREE_TASK_FLAG_DISPATCH_INDIRECT;
-  return iree_ok_status();
+
+  // The workgroup count is read when the dispatch is issued and must be
+  // ordered after any commands that produce it.
+  iree_hal_buffer_ref_t workgroups_count_ref = workgroups_ref;
+  workgroups_count_ref.length = 3 * sizeof(uint32_t);
+  if (!workgroups_ref.buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_task_command_buffer_add_fixup(
+        command_buffer, node, IREE_HAL_TASK_CMD_FIXUP_TYPE_MAPPING,
+        IREE_HAL_MEMORY_ACCESS_READ,
+        offsetof(iree_hal_task_cmd_dispatch_t, task.workgroup_count.ptr),
+        /*length_offset=*/0, workgroups_count_ref));
+  }
+  return iree_hal_task_command_buffer_track_access(
+      command_buffer, node, workgroups_count_ref, /*is_write=*/false);
 }
 
 //===----------------------------------------------------------------------===//
@@ -46,9 +46,17 @@ bool iree_hal_task_command_buffer_isa(
 //
 // |pending_submission| will receive the ready list of commands and must be
 // submitted to the executor (or discarded on failure) by the caller.
+//
+// One-shot command buffers without indirect bindings issue their recorded
+// tasks directly and may only be issued once. Reusable command buffers and
+// those with indirect bindings clone their recorded tasks into |arena| and
+// resolve indirect buffer references using |binding_table|; they may be issued
+// any number of times, including while prior issues are still executing. The
+// buffers in |binding_table| must remain live until |retire_task| completes.
 iree_status_t iree_hal_task_command_buffer_issue(
     iree_hal_command_buffer_t* command_buffer,
-    iree_hal_task_queue_state_t* queue_state, iree_task_t* retire_task,
+    iree_hal_task_queue_state_t* queue_state,
+    iree_hal_buffer_binding_table_t binding_table, iree_task_t* retire_task,
     iree_arena_allocator_t* arena, iree_task_submission_t* pending_submission);
 
 #ifdef __cplusplus
@@ -12,15 +12,17 @@
 
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/cpu.h"
+#include "iree/base/internal/math.h"
 #include "iree/hal/drivers/local_task/task_command_buffer.h"
 #include "iree/hal/drivers/local_task/task_event.h"
 #include "iree/hal/drivers/local_task/task_queue.h"
 #include "iree/hal/drivers/local_task/task_semaphore.h"
 #include "iree/hal/local/executable_environment.h"
 #include "iree/hal/local/local_executable_cache.h"
-#include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/local/profiling.h"
+#include "iree/hal/utils/caching_allocator.h"
+#include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
-#include "iree/hal/utils/memory_file.h"
 
 typedef struct iree_hal_task_device_t {
   iree_hal_resource_t resource;
@@ -39,9 +41,19 @@ typedef struct iree_hal_task_device_t {
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
+  // Maximum capacity of the queue allocation pool or 0 if disabled.
+  iree_device_size_t queue_pool_capacity;
+  // Pool serving queue-ordered allocations on top of |device_allocator|.
+  // Buffers released after their dealloca has been retired return here and
+  // are reused by subsequent queue allocations. NULL if pooling is disabled.
+  iree_hal_allocator_t* queue_pool;
+
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
+  // Active dispatch profiling session, if any.
+  iree_hal_local_profiler_t* profiler;
+
   iree_host_size_t queue_count;
   iree_hal_task_queue_t queues[];
 } iree_hal_task_device_t;
@@ -58,10 +70,13 @@ void iree_hal_task_device_params_initialize(
     iree_hal_task_device_params_t* out_params) {
   out_params->arena_block_size = 32 * 1024;
   out_params->queue_scope_flags = IREE_TASK_SCOPE_FLAG_NONE;
+  out_params->queue_pool_capacity = 256 * 1024 * 1024;
+  out_params->queue_submission_timeout = IREE_DURATION_INFINITE;
 }
 
 static iree_status_t iree_hal_task_device_check_params(
-    const iree_hal_task_device_params_t* params, iree_host_size_t queue_count) {
+    const iree_hal_task_device_params_t* params, iree_host_size_t queue_count,
+    iree_task_executor_t* const* queue_executors) {
   if (params->arena_block_size < 4096) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "arena block size too small (< 4096 bytes)");
@@ -70,9 +85,48 @@ static iree_status_t iree_hal_task_device_check_params(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "must have at least one queue");
   }
+  // Waiters can only donate themselves to a single executor and if there were
+  // multiple threadless executors the others would never make progress.
+  for (iree_host_size_t i = 0; queue_count > 1 && i < queue_count; ++i) {
+    if (iree_task_executor_is_threadless(queue_executors[i])) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "threadless executors can only be used with "
+                              "single-queue devices");
+    }
+  }
   return iree_ok_status();
 }
 
+// Creates the queue allocation pool for |device| on top of its current device
+// allocator. Each heap exposed by the allocator gets its own free list bounded
+// by the configured pool capacity.
+static iree_status_t iree_hal_task_device_create_queue_pool(
+    iree_hal_task_device_t* device) {
+  iree_hal_allocator_release(device->queue_pool);
+  device->queue_pool = NULL;
+  if (device->queue_pool_capacity == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_allocator_memory_heap_t heaps[8];
+  iree_host_size_t heap_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_allocator_query_memory_heaps(device->device_allocator,
+                                                IREE_ARRAYSIZE(heaps), heaps,
+                                                &heap_count));
+  iree_hal_caching_allocator_pool_params_t pool_params[IREE_ARRAYSIZE(heaps)];
+  for (iree_host_size_t i = 0; i < heap_count; ++i) {
+    iree_hal_caching_allocator_pool_params_initialize(heaps[i],
+                                                      &pool_params[i]);
+    pool_params[i].max_allocation_capacity = device->queue_pool_capacity;
+  }
+  iree_status_t status = iree_hal_caching_allocator_create_with_pools(
+      heap_count, pool_params, device->device_allocator,
+      device->host_allocator, &device->queue_pool);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Returns an event pool used for device-wide system event handles.
 // Each queue executor will have its own (potentially shared) pool and prefer
 // that but generic resource requests (creating semaphores, etc) will use this.
@@ -81,6 +135,14 @@ iree_event_pool_t* iree_hal_task_device_shared_event_pool(
   return iree_task_executor_event_pool(device->queues[0].executor);
 }
 
+// Returns the executor that callers donate themselves to when waiting on device
+// work. Threadless executors require this to make progress while executors
+// with worker threads let the waiting threads help execute the work.
+static iree_task_executor_t* iree_hal_task_device_donation_executor(
+    iree_hal_task_device_t* device) {
+  return device->queues[0].executor;
+}
+
 iree_status_t iree_hal_task_device_create(
     iree_string_view_t identifier, const iree_hal_task_device_params_t* params,
     iree_host_size_t queue_count, iree_task_executor_t* const* queue_executors,
@@ -96,7 +158,8 @@ iree_status_t iree_hal_task_device_create(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_task_device_check_params(params, queue_count));
+      z0, iree_hal_task_device_check_params(params, queue_count,
+                                            queue_executors));
 
   iree_hal_task_device_t* device = NULL;
   iree_host_size_t struct_size = sizeof(*device) +
@@ -114,6 +177,7 @@ iree_status_t iree_hal_task_device_create(
     device->host_allocator = host_allocator;
     device->device_allocator = device_allocator;
     iree_hal_allocator_retain(device_allocator);
+    device->queue_pool_capacity = params->queue_pool_capacity;
 
     iree_arena_block_pool_initialize(4096, host_allocator,
                                      &device->small_block_pool);
@@ -135,10 +199,13 @@ iree_status_t iree_hal_task_device_create(
       iree_hal_queue_affinity_t queue_affinity = 1ull << i;
       iree_hal_task_queue_initialize(
           device->identifier, queue_affinity, params->queue_scope_flags,
-          queue_executors[i], &device->small_block_pool,
+          params->queue_submission_timeout, queue_executors[i],
+          &device->small_block_pool,
           &device->large_block_pool, device->device_allocator,
           &device->queues[i]);
     }
+
+    status = iree_hal_task_device_create_queue_pool(device);
   }
 
   if (iree_status_is_ok(status)) {
@@ -159,10 +226,13 @@ static void iree_hal_task_device_destroy(iree_hal_device_t* base_device) {
     iree_hal_task_queue_deinitialize(&device->queues[i]);
   }
 
+  iree_status_ignore(iree_hal_local_profiler_end(device->profiler));
+
   for (iree_host_size_t i = 0; i < device->loader_count; ++i) {
     iree_hal_executable_loader_release(device->loaders[i]);
   }
 
+  iree_hal_allocator_release(device->queue_pool);
   iree_hal_allocator_release(device->device_allocator);
   iree_hal_channel_provider_release(device->channel_provider);
 
@@ -198,6 +268,15 @@ static void iree_hal_task_replace_device_allocator(
   iree_hal_allocator_retain(new_allocator);
   iree_hal_allocator_release(device->device_allocator);
   device->device_allocator = new_allocator;
+
+  // Rebuild the queue pool on top of the new allocator. Replacement is only
+  // valid while no buffers from the old allocator remain live so the old pool
+  // has nothing outstanding.
+  iree_status_t status = iree_hal_task_device_create_queue_pool(device);
+  if (!iree_status_is_ok(status)) {
+    // Fall back to unpooled queue allocations.
+    iree_status_ignore(status);
+  }
 }
 
 static void iree_hal_task_replace_channel_provider(
@@ -216,7 +295,12 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     iree_hal_task_queue_trim(&device->queues[i]);
   }
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->device_allocator));
+  if (device->queue_pool) {
+    // Trimming the pool also trims the underlying device allocator.
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->queue_pool));
+  } else {
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_trim(device->device_allocator));
+  }
 
   iree_arena_block_pool_trim(&device->small_block_pool);
   iree_arena_block_pool_trim(&device->large_block_pool);
@@ -224,6 +308,76 @@ static iree_status_t iree_hal_task_device_trim(iree_hal_device_t* base_device) {
   return iree_ok_status();
 }
 
+void iree_hal_task_device_query_queue_pool_statistics(
+    iree_hal_device_t* base_device,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics) {
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  iree_hal_allocator_query_statistics(
+      device->queue_pool ? device->queue_pool : device->device_allocator,
+      out_statistics);
+}
+
+// Queries a statistic summed across the executors of all device queues.
+// |key| is the name of an iree_task_executor_statistics_t field with histogram
+// buckets named `tile_histogram.<bucket>`.
+static iree_status_t iree_hal_task_device_query_executor_statistic(
+    iree_hal_task_device_t* device, iree_string_view_t key,
+    int64_t* out_value) {
+  static const struct {
+    const char* name;
+    iree_host_size_t offset;
+  } fields[] = {
+#define IREE_HAL_TASK_DEVICE_STATISTIC(field) \
+  {#field, offsetof(iree_task_executor_statistics_t, field)}
+      IREE_HAL_TASK_DEVICE_STATISTIC(tasks_executed),
+      IREE_HAL_TASK_DEVICE_STATISTIC(tiles_executed),
+      IREE_HAL_TASK_DEVICE_STATISTIC(tile_time_ns),
+      IREE_HAL_TASK_DEVICE_STATISTIC(steal_attempts),
+      IREE_HAL_TASK_DEVICE_STATISTIC(steal_successes),
+      IREE_HAL_TASK_DEVICE_STATISTIC(wakeups),
+      IREE_HAL_TASK_DEVICE_STATISTIC(wake_requests),
+      IREE_HAL_TASK_DEVICE_STATISTIC(wake_latency_ns),
+      IREE_HAL_TASK_DEVICE_STATISTIC(spin_time_ns),
+      IREE_HAL_TASK_DEVICE_STATISTIC(sleep_time_ns),
+#undef IREE_HAL_TASK_DEVICE_STATISTIC
+  };
+
+  // Resolve the key to the offset of the field in the statistics struct.
+  iree_host_size_t offset = IREE_HOST_SIZE_MAX;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(fields); ++i) {
+    if (iree_string_view_equal(key, iree_make_cstring_view(fields[i].name))) {
+      offset = fields[i].offset;
+      break;
+    }
+  }
+  iree_string_view_t bucket_key = key;
+  uint32_t bucket = 0;
+  if (offset == IREE_HOST_SIZE_MAX &&
+      iree_string_view_consume_prefix(&bucket_key,
+                                      IREE_SV("tile_histogram.")) &&
+      iree_string_view_atoi_uint32(bucket_key, &bucket) &&
+      bucket < IREE_TASK_EXECUTOR_TILE_HISTOGRAM_BUCKET_COUNT) {
+    offset = offsetof(iree_task_executor_statistics_t, tile_histogram) +
+             bucket * sizeof(int64_t);
+  }
+  if (offset == IREE_HOST_SIZE_MAX) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "unknown task executor statistic '%.*s'",
+                            (int)key.size, key.data);
+  }
+
+  int64_t value = 0;
+  for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+    iree_task_executor_statistics_t statistics;
+    iree_task_executor_query_statistics(device->queues[i].executor,
+                                        &statistics);
+    value += *(const int64_t*)((const uint8_t*)&statistics + offset);
+  }
+  *out_value = value;
+  return iree_ok_status();
+}
+
 static iree_status_t iree_hal_task_device_query_i64(
     iree_hal_device_t* base_device, iree_string_view_t category,
     iree_string_view_t key, int64_t* out_value) {
@@ -260,6 +414,9 @@ static iree_status_t iree_hal_task_device_query_i64(
     }
   } else if (iree_string_view_equal(category, IREE_SV("hal.cpu"))) {
     return iree_cpu_lookup_data_by_key(key, out_value);
+  } else if (iree_string_view_equal(category, IREE_SV("task.executor"))) {
+    return iree_hal_task_device_query_executor_statistic(device, key,
+                                                          out_value);
   }
 
   return iree_make_status(
@@ -269,6 +426,9 @@ static iree_status_t iree_hal_task_device_query_i64(
 }
 
 // Returns the queue index to submit work to based on the |queue_affinity|.
+// Each queue has its own executor (usually one per NUMA node) and when any
+// queue may be used we prefer the one local to the calling thread as it is
+// likely to have touched the memory the work will use.
 //
 // If we wanted to have dedicated transfer queues we'd fork off based on
 // command_categories. For now all queues are general purpose.
@@ -276,10 +436,22 @@ static iree_host_size_t iree_hal_task_device_select_queue(
     iree_hal_task_device_t* device,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity) {
+  if (queue_affinity == IREE_HAL_QUEUE_AFFINITY_ANY &&
+      device->queue_count > 1) {
+    iree_task_topology_node_id_t current_node_id =
+        iree_task_topology_query_current_node();
+    for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
+      if (iree_task_executor_node_id(device->queues[i].executor) ==
+          current_node_id) {
+        return i;
+      }
+    }
+  }
   // TODO(benvanik): evaluate if we want to obscure this mapping a bit so that
   // affinity really means "equivalent affinities map to equivalent queues" and
   // not a specific queue index.
-  return queue_affinity % device->queue_count;
+  return iree_math_count_trailing_zeros_u64(queue_affinity) %
+         device->queue_count;
 }
 
 static iree_status_t iree_hal_task_device_create_channel(
@@ -295,25 +467,13 @@ static iree_status_t iree_hal_task_device_create_command_buffer(
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
     iree_hal_command_buffer_t** out_command_buffer) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
-  if (binding_capacity > 0) {
-    // TODO(indirect-cmd): natively support reusable task command buffers. For
-    // now we emulate by recording into a deferred command buffer and
-    // recording/issuing at submission time. The task system needs some
-    // reworking to support being able to resubmit task graphs as today it is
-    // destructive.
-    return iree_hal_deferred_command_buffer_create(
-        iree_hal_device_allocator(base_device), mode, command_categories,
-        binding_capacity, &device->large_block_pool, device->host_allocator,
-        out_command_buffer);
-  } else {
-    iree_host_size_t queue_index = iree_hal_task_device_select_queue(
-        device, command_categories, queue_affinity);
-    return iree_hal_task_command_buffer_create(
-        iree_hal_device_allocator(base_device),
-        &device->queues[queue_index].scope, mode, command_categories,
-        queue_affinity, binding_capacity, &device->large_block_pool,
-        device->host_allocator, out_command_buffer);
-  }
+  iree_host_size_t queue_index = iree_hal_task_device_select_queue(
+      device, command_categories, queue_affinity);
+  return iree_hal_task_command_buffer_create(
+      iree_hal_device_allocator(base_device),
+      &device->queues[queue_index].scope, mode, command_categories,
+      queue_affinity, binding_capacity, &device->large_block_pool,
+      device->host_allocator, out_command_buffer);
 }
 
 static iree_status_t iree_hal_task_device_create_event(
@@ -329,16 +489,18 @@ static iree_status_t iree_hal_task_device_create_executable_cache(
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
 
-  // Sum up the total worker count across all queues so that the loaders can
-  // preallocate worker-specific storage.
+  // Sum up the total worker capacity across all queues so that the loaders can
+  // preallocate worker-specific storage. This includes the donors that threads
+  // waiting on the device act as when stealing work.
   iree_host_size_t total_worker_count = 0;
   for (iree_host_size_t i = 0; i < device->queue_count; ++i) {
     total_worker_count +=
-        iree_task_executor_worker_count(device->queues[i].executor);
+        iree_task_executor_worker_capacity(device->queues[i].executor);
   }
 
   return iree_hal_local_executable_cache_create(
-      identifier, total_worker_count, device->loader_count, device->loaders,
+      identifier, total_worker_count, /*local_memory_limit=*/0,
+      device->loader_count, device->loaders,
       iree_hal_device_host_allocator(base_device), out_executable_cache);
 }
 
@@ -346,14 +508,8 @@ static iree_status_t iree_hal_task_device_import_file(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
     iree_hal_external_file_flags_t flags, iree_hal_file_t** out_file) {
-  if (iree_io_file_handle_type(handle) !=
-      IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    return iree_make_status(
-        IREE_STATUS_UNAVAILABLE,
-        "implementation does not support the external file type");
-  }
-  return iree_hal_memory_file_wrap(
-      queue_affinity, access, handle, iree_hal_device_allocator(base_device),
+  return iree_hal_file_from_handle(
+      iree_hal_device_allocator(base_device), queue_affinity, access, handle,
       iree_hal_device_host_allocator(base_device), out_file);
 }
 
@@ -362,7 +518,8 @@ static iree_status_t iree_hal_task_device_create_semaphore(
     iree_hal_semaphore_flags_t flags, iree_hal_semaphore_t** out_semaphore) {
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   return iree_hal_task_semaphore_create(
-      iree_hal_task_device_shared_event_pool(device), initial_value,
+      iree_hal_task_device_shared_event_pool(device),
+      iree_hal_task_device_donation_executor(device), initial_value,
       device->host_allocator, out_semaphore);
 }
 
@@ -388,14 +545,28 @@ static iree_status_t iree_hal_task_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(
-      iree_hal_allocator_allocate_buffer(iree_hal_device_allocator(base_device),
-                                         params, allocation_size, out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  *out_buffer = NULL;
+
+  // Buffers only return to the pool once their last reference is released and
+  // queue operations retain the buffers they use until they retire, so
+  // anything in the pool is idle and can be handed out without blocking the
+  // host on the waits. The signal is still queue-ordered after the waits so
+  // that consumers observe the allocation in timeline order.
+  iree_hal_allocator_t* allocator =
+      device->queue_pool ? device->queue_pool : device->device_allocator;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+      allocator, params, allocation_size, &buffer));
+
+  iree_status_t status = iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_task_device_queue_dealloca(
@@ -403,7 +574,9 @@ static iree_status_t iree_hal_task_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
+  // The buffer returns to the queue pool when its last reference is released.
+  // Because in-flight queue operations retain the buffers they use that can
+  // only happen after all work using it has retired.
   IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
   return iree_ok_status();
@@ -489,6 +662,7 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
   iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
   return iree_hal_task_semaphore_multi_wait(
       wait_mode, semaphore_list, timeout,
+      iree_hal_task_device_donation_executor(device),
       iree_hal_task_device_shared_event_pool(device),
       &device->large_block_pool);
 }
@@ -496,27 +670,30 @@ static iree_status_t iree_hal_task_device_wait_semaphores(
 static iree_status_t iree_hal_task_device_profiling_begin(
     iree_hal_device_t* base_device,
     const iree_hal_device_profiling_options_t* options) {
-  // Unimplemented (and that's ok).
-  // We could hook in to vendor APIs (Intel/ARM/etc) or generic perf infra:
-  // https://man7.org/linux/man-pages/man2/perf_event_open.2.html
-  // Capturing things like:
-  //   PERF_COUNT_HW_CPU_CYCLES / PERF_COUNT_HW_INSTRUCTIONS
-  //   PERF_COUNT_HW_CACHE_REFERENCES / PERF_COUNT_HW_CACHE_MISSES
-  //   etc
-  // TODO(benvanik): shared iree/hal/local/profiling implementation of this.
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  if (device->profiler) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "profiling already active on the device");
+  }
+  // Only dispatch counters are supported; other modes are ignored (and that's
+  // ok). Counters are sampled with perf_event_open where available.
+  return iree_hal_local_profiler_begin(device->identifier, options,
+                                       device->host_allocator,
+                                       &device->profiler);
 }
 
 static iree_status_t iree_hal_task_device_profiling_flush(
     iree_hal_device_t* base_device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  return iree_hal_local_profiler_flush(device->profiler);
 }
 
 static iree_status_t iree_hal_task_device_profiling_end(
     iree_hal_device_t* base_device) {
-  // Unimplemented (and that's ok).
-  return iree_ok_status();
+  iree_hal_task_device_t* device = iree_hal_task_device_cast(base_device);
+  iree_hal_local_profiler_t* profiler = device->profiler;
+  device->profiler = NULL;
+  return iree_hal_local_profiler_end(profiler);
 }
 
 static const iree_hal_device_vtable_t iree_hal_task_device_vtable = {
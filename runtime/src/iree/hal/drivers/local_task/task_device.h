@@ -25,6 +25,19 @@ typedef struct iree_hal_task_device_params_t {
   iree_host_size_t arena_block_size;
   // Default flags for the iree_task_scope_t used for each queue.
   iree_task_scope_flags_t queue_scope_flags;
+  // Maximum total size in bytes of queue-ordered allocations (queue_alloca)
+  // retained by the device for reuse. Buffers released after their queue
+  // deallocation return to the pool and service later allocations of the same
+  // size without going back to the device allocator. 0 disables pooling.
+  iree_device_size_t queue_pool_capacity;
+  // Maximum duration a queue submission may remain in flight from when it is
+  // submitted until it retires. If any submission exceeds its deadline the
+  // queue scope is cancelled: remaining work (including in-flight dispatch
+  // tiles) is dropped and the queue fails with IREE_STATUS_DEADLINE_EXCEEDED
+  // as with any other execution failure. Intended for servers that would
+  // rather shed work than fall further behind under load.
+  // IREE_DURATION_INFINITE disables submission deadlines.
+  iree_duration_t queue_submission_timeout;
 } iree_hal_task_device_params_t;
 
 // Initializes |out_params| to default values.
@@ -48,6 +61,13 @@ iree_status_t iree_hal_task_device_create(
     iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator,
     iree_hal_device_t** out_device);
 
+// Queries statistics of the queue-ordered allocation pool of |device|.
+// The statistics include those of the underlying device allocator along with
+// the pool peak size and reuse counters. |device| must be a local-task device.
+void iree_hal_task_device_query_queue_pool_statistics(
+    iree_hal_device_t* device,
+    iree_hal_allocator_statistics_t* IREE_RESTRICT out_statistics);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -246,10 +246,11 @@ static iree_status_t iree_hal_task_queue_issue_cmd_deferred(
   // Issue the task command buffer as if it had been recorded directly to begin
   // with.
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_task_command_buffer_issue(task_command_buffer,
-                                             &cmd->queue->state,
-                                             cmd->task.header.completion_task,
-                                             cmd->arena, pending_submission));
+      z0, iree_hal_task_command_buffer_issue(
+              task_command_buffer, &cmd->queue->state,
+              iree_hal_buffer_binding_table_empty(),
+              cmd->task.header.completion_task, cmd->arena,
+              pending_submission));
 
   // Still retained in the resource set until retirement.
   iree_hal_command_buffer_release(task_command_buffer);
@@ -270,15 +271,9 @@ static iree_status_t iree_hal_task_queue_issue_cmd(
   iree_status_t status = iree_ok_status();
   if (cmd->command_buffer != NULL) {
     if (iree_hal_task_command_buffer_isa(cmd->command_buffer)) {
-      if (cmd->binding_table.count > 0) {
-        status = iree_make_status(
-            IREE_STATUS_UNIMPLEMENTED,
-            "task command buffers do not support binding tables yet");
-      } else {
-        status = iree_hal_task_command_buffer_issue(
-            cmd->command_buffer, &cmd->queue->state,
-            cmd->task.header.completion_task, cmd->arena, pending_submission);
-      }
+      status = iree_hal_task_command_buffer_issue(
+          cmd->command_buffer, &cmd->queue->state, cmd->binding_table,
+          cmd->task.header.completion_task, cmd->arena, pending_submission);
     } else if (iree_hal_deferred_command_buffer_isa(cmd->command_buffer)) {
       status = iree_hal_task_queue_issue_cmd_deferred(
           cmd, cmd->command_buffer, cmd->binding_table, pending_submission);
@@ -374,8 +369,61 @@ typedef struct iree_hal_task_queue_retire_cmd_t {
   // This resource set is allocated from the small block pool and is expected to
   // only have a small number of resources (command buffers, etc).
   iree_hal_resource_set_t* resource_set;
+
+  // Queue tracking the submission deadline or NULL if the submission has no
+  // deadline. Links the command into the queue in-flight deadline list.
+  iree_hal_task_queue_t* deadline_queue;
+  iree_time_t deadline_ns;
+  struct iree_hal_task_queue_retire_cmd_t* deadline_prev;
+  struct iree_hal_task_queue_retire_cmd_t* deadline_next;
 } iree_hal_task_queue_retire_cmd_t;
 
+// Adds |cmd| to the in-flight deadline list of |queue| with a deadline of
+// now + the queue submission timeout. If it is the only in-flight submission
+// the queue scope deadline is set to match.
+static void iree_hal_task_queue_track_deadline(
+    iree_hal_task_queue_t* queue, iree_hal_task_queue_retire_cmd_t* cmd) {
+  iree_slim_mutex_lock(&queue->deadline_mutex);
+  cmd->deadline_queue = queue;
+  cmd->deadline_ns =
+      iree_relative_timeout_to_deadline_ns(queue->submission_timeout);
+  cmd->deadline_prev = queue->deadline_tail;
+  cmd->deadline_next = NULL;
+  if (queue->deadline_tail) {
+    queue->deadline_tail->deadline_next = cmd;
+  } else {
+    queue->deadline_head = cmd;
+    iree_task_scope_set_deadline(&queue->scope, cmd->deadline_ns);
+  }
+  queue->deadline_tail = cmd;
+  iree_slim_mutex_unlock(&queue->deadline_mutex);
+}
+
+// Removes |cmd| from the in-flight deadline list of its queue (if tracked) and
+// moves the queue scope deadline to the oldest remaining submission.
+static void iree_hal_task_queue_untrack_deadline(
+    iree_hal_task_queue_retire_cmd_t* cmd) {
+  iree_hal_task_queue_t* queue = cmd->deadline_queue;
+  if (!queue) return;
+  iree_slim_mutex_lock(&queue->deadline_mutex);
+  if (cmd->deadline_prev) {
+    cmd->deadline_prev->deadline_next = cmd->deadline_next;
+  } else {
+    queue->deadline_head = cmd->deadline_next;
+  }
+  if (cmd->deadline_next) {
+    cmd->deadline_next->deadline_prev = cmd->deadline_prev;
+  } else {
+    queue->deadline_tail = cmd->deadline_prev;
+  }
+  iree_task_scope_set_deadline(&queue->scope,
+                               queue->deadline_head
+                                   ? queue->deadline_head->deadline_ns
+                                   : IREE_TIME_INFINITE_FUTURE);
+  iree_slim_mutex_unlock(&queue->deadline_mutex);
+  cmd->deadline_queue = NULL;
+}
+
 // Retires a submission by signaling semaphores to their desired value and
 // disposing of the temporary arena memory used for the submission.
 static iree_status_t iree_hal_task_queue_retire_cmd(
@@ -435,6 +483,9 @@ static void iree_hal_task_queue_retire_cmd_cleanup(
   // Release all semaphores.
   iree_hal_semaphore_list_release(&cmd->signal_semaphores);
 
+  // The submission is no longer in flight and its deadline no longer applies.
+  iree_hal_task_queue_untrack_deadline(cmd);
+
   // Drop all memory used by the submission (**including cmd**).
   iree_arena_allocator_t arena = cmd->arena;
   cmd = NULL;
@@ -471,6 +522,7 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
                            iree_hal_task_queue_retire_cmd_cleanup);
   cmd->signal_semaphores = iree_hal_semaphore_list_empty();
   cmd->resource_set = NULL;
+  cmd->deadline_queue = NULL;
 
   // Clone the signal semaphores from the batch - we retain them and their
   // payloads.
@@ -507,6 +559,7 @@ static iree_status_t iree_hal_task_queue_retire_cmd_allocate(
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_hal_queue_affinity_t affinity,
                                     iree_task_scope_flags_t scope_flags,
+                                    iree_duration_t submission_timeout,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* small_block_pool,
                                     iree_arena_block_pool_t* large_block_pool,
@@ -527,6 +580,9 @@ void iree_hal_task_queue_initialize(iree_string_view_t identifier,
 
   iree_task_scope_initialize(identifier, scope_flags, &out_queue->scope);
 
+  out_queue->submission_timeout = submission_timeout;
+  iree_slim_mutex_initialize(&out_queue->deadline_mutex);
+
   iree_hal_task_queue_state_initialize(&out_queue->state);
 
   IREE_TRACE_ZONE_END(z0);
@@ -536,9 +592,10 @@ void iree_hal_task_queue_deinitialize(iree_hal_task_queue_t* queue) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_status_ignore(
-      iree_task_scope_wait_idle(&queue->scope, IREE_TIME_INFINITE_FUTURE));
+      iree_hal_task_queue_wait_idle(queue, iree_infinite_timeout()));
 
   iree_hal_task_queue_state_deinitialize(&queue->state);
+  iree_slim_mutex_deinitialize(&queue->deadline_mutex);
   iree_task_scope_deinitialize(&queue->scope);
   iree_hal_allocator_release(queue->device_allocator);
   iree_task_executor_release(queue->executor);
@@ -612,6 +669,12 @@ static iree_status_t iree_hal_task_queue_submit(
     return status;
   }
 
+  // Start the submission deadline (if any) now that the submission can no
+  // longer fail. The retire command cleanup stops tracking it.
+  if (queue->submission_timeout != IREE_DURATION_INFINITE) {
+    iree_hal_task_queue_track_deadline(queue, retire_cmd);
+  }
+
   iree_task_submission_t submission;
   iree_task_submission_initialize(&submission);
 
@@ -705,8 +768,10 @@ iree_status_t iree_hal_task_queue_submit_callback(
 iree_status_t iree_hal_task_queue_wait_idle(iree_hal_task_queue_t* queue,
                                             iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_time_t deadline_ns = iree_timeout_as_deadline_ns(timeout);
-  iree_status_t status = iree_task_scope_wait_idle(&queue->scope, deadline_ns);
+  // Help perform the work while waiting (threadless executors require that we
+  // do it all).
+  iree_status_t status = iree_task_executor_donate_caller(
+      queue->executor, iree_task_scope_await_idle(&queue->scope), timeout);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
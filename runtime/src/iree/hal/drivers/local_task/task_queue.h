@@ -59,6 +59,18 @@ typedef struct iree_hal_task_queue_t {
   // differentiation of tasks within the executor.
   iree_task_scope_t scope;
 
+  // Maximum duration a submission may be in flight before the queue scope is
+  // cancelled or IREE_DURATION_INFINITE if submissions have no deadline.
+  iree_duration_t submission_timeout;
+
+  // Guards the in-flight submission deadline list.
+  iree_slim_mutex_t deadline_mutex;
+  // In-flight submissions with deadlines in submission order. All submissions
+  // share the same timeout so the head always has the earliest deadline and
+  // the scope deadline is kept in sync with it.
+  struct iree_hal_task_queue_retire_cmd_t* deadline_head;
+  struct iree_hal_task_queue_retire_cmd_t* deadline_tail;
+
   // State tracking used during command buffer issue.
   // The intra-queue synchronization (barriers/events) carries across command
   // buffers and this is used to rendezvous the tasks in each set.
@@ -68,6 +80,7 @@ typedef struct iree_hal_task_queue_t {
 void iree_hal_task_queue_initialize(iree_string_view_t identifier,
                                     iree_hal_queue_affinity_t affinity,
                                     iree_task_scope_flags_t scope_flags,
+                                    iree_duration_t submission_timeout,
                                     iree_task_executor_t* executor,
                                     iree_arena_block_pool_t* small_block_pool,
                                     iree_arena_block_pool_t* large_block_pool,
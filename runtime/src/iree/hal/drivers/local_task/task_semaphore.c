@@ -51,6 +51,10 @@ typedef struct iree_hal_task_semaphore_t {
   iree_allocator_t host_allocator;
   iree_event_pool_t* event_pool;
 
+  // Optional executor that waiters donate themselves to. Threadless executors
+  // require this in order for the semaphore to make progress.
+  iree_task_executor_t* donation_executor;
+
   // Guards all mutable fields. We expect low contention on semaphores and since
   // iree_slim_mutex_t is (effectively) just a CAS this keeps things simpler
   // than trying to make the entire structure lock-free.
@@ -74,8 +78,9 @@ static iree_hal_task_semaphore_t* iree_hal_task_semaphore_cast(
 }
 
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
-    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore) {
+    iree_event_pool_t* event_pool, iree_task_executor_t* donation_executor,
+    uint64_t initial_value, iree_allocator_t host_allocator,
+    iree_hal_semaphore_t** out_semaphore) {
   IREE_ASSERT_ARGUMENT(event_pool);
   IREE_ASSERT_ARGUMENT(out_semaphore);
   *out_semaphore = NULL;
@@ -89,6 +94,10 @@ iree_status_t iree_hal_task_semaphore_create(
                                   &semaphore->base);
     semaphore->host_allocator = host_allocator;
     semaphore->event_pool = event_pool;
+    semaphore->donation_executor = donation_executor;
+    iree_task_executor_retain(donation_executor);
+    semaphore->base.wait_requires_caller =
+        iree_task_executor_is_threadless(donation_executor);
 
     iree_slim_mutex_initialize(&semaphore->mutex);
     semaphore->current_value = initial_value;
@@ -110,6 +119,7 @@ static void iree_hal_task_semaphore_destroy(
 
   iree_slim_mutex_deinitialize(&semaphore->mutex);
   iree_status_ignore(semaphore->failure_status);
+  iree_task_executor_release(semaphore->donation_executor);
 
   iree_hal_semaphore_deinitialize(&semaphore->base);
   iree_allocator_free(host_allocator, semaphore);
@@ -312,7 +322,14 @@ static iree_status_t iree_hal_task_semaphore_wait(
   // Wait until the timepoint resolves.
   // If satisfied the timepoint is automatically cleaned up and we are done. If
   // the deadline is reached before satisfied then we have to clean it up.
-  status = iree_wait_one(&timepoint.event, deadline_ns);
+  if (semaphore->donation_executor) {
+    // Help perform the work (threadless executors require that we do it all).
+    status = iree_task_executor_donate_caller(
+        semaphore->donation_executor, iree_event_await(&timepoint.event),
+        iree_make_deadline(deadline_ns));
+  } else {
+    status = iree_wait_one(&timepoint.event, deadline_ns);
+  }
   if (!iree_status_is_ok(status)) {
     iree_hal_semaphore_cancel_timepoint(&semaphore->base, &timepoint.base);
   }
@@ -321,10 +338,75 @@ static iree_status_t iree_hal_task_semaphore_wait(
   return status;
 }
 
+// Wait source control function for a wait-any on the iree_wait_set_t in |self|.
+// Used to donate to executors while waiting on multiple timepoints.
+static iree_status_t iree_hal_task_semaphore_wait_any_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  iree_wait_set_t* wait_set = (iree_wait_set_t*)wait_source.self;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY: {
+      iree_status_code_t* out_wait_status_code = (iree_status_code_t*)inout_ptr;
+      iree_status_t status = iree_wait_any(wait_set, IREE_TIME_INFINITE_PAST,
+                                           /*out_wake_handle=*/NULL);
+      *out_wait_status_code = iree_status_is_deadline_exceeded(status)
+                                  ? IREE_STATUS_DEFERRED
+                                  : iree_status_code(status);
+      iree_status_ignore(status);
+      return iree_ok_status();
+    }
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      const iree_timeout_t timeout =
+          ((const iree_wait_source_wait_params_t*)params)->timeout;
+      return iree_wait_any(wait_set, iree_timeout_as_deadline_ns(timeout),
+                           /*out_wake_handle=*/NULL);
+    }
+    case IREE_WAIT_SOURCE_COMMAND_EXPORT: {
+      const iree_wait_primitive_type_t target_type =
+          ((const iree_wait_source_export_params_t*)params)->target_type;
+      iree_wait_primitive_t* out_wait_primitive =
+          (iree_wait_primitive_t*)inout_ptr;
+      memset(out_wait_primitive, 0, sizeof(*out_wait_primitive));
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "requested wait primitive type %d is unavailable",
+                              (int)target_type);
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
+// Performs a multi-wait on the timepoints by donating the calling thread to
+// the |donation_executor|.
+static iree_status_t iree_hal_task_semaphore_multi_wait_donated(
+    iree_task_executor_t* donation_executor, iree_hal_wait_mode_t wait_mode,
+    iree_host_size_t timepoint_count, iree_hal_task_timepoint_t* timepoints,
+    iree_wait_set_t* wait_set, iree_time_t deadline_ns) {
+  if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
+    iree_wait_source_t wait_source = {
+        .self = wait_set,
+        .data = 0,
+        .ctl = iree_hal_task_semaphore_wait_any_ctl,
+    };
+    return iree_task_executor_donate_caller(donation_executor, wait_source,
+                                            iree_make_deadline(deadline_ns));
+  }
+  // Waiting for each timepoint in order is equivalent to waiting for all of
+  // them as we perform the work on every timepoint regardless.
+  for (iree_host_size_t i = 0; i < timepoint_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_task_executor_donate_caller(
+        donation_executor, iree_event_await(&timepoints[i].event),
+        iree_make_deadline(deadline_ns)));
+  }
+  return iree_ok_status();
+}
+
 iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
-    iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool) {
+    iree_task_executor_t* donation_executor, iree_event_pool_t* event_pool,
+    iree_arena_block_pool_t* block_pool) {
   if (semaphore_list.count == 0) {
     return iree_ok_status();
   } else if (semaphore_list.count == 1) {
@@ -385,7 +467,11 @@ iree_status_t iree_hal_task_semaphore_multi_wait(
   }
 
   // Perform the wait.
-  if (iree_status_is_ok(status) && needs_wait) {
+  if (iree_status_is_ok(status) && needs_wait && donation_executor) {
+    status = iree_hal_task_semaphore_multi_wait_donated(
+        donation_executor, wait_mode, timepoint_count, timepoints, wait_set,
+        deadline_ns);
+  } else if (iree_status_is_ok(status) && needs_wait) {
     if (wait_mode == IREE_HAL_WAIT_MODE_ANY) {
       status = iree_wait_any(wait_set, deadline_ns, /*out_wake_handle=*/NULL);
     } else {
@@ -13,6 +13,7 @@
 #include "iree/base/internal/arena.h"
 #include "iree/base/internal/event_pool.h"
 #include "iree/hal/api.h"
+#include "iree/task/executor.h"
 #include "iree/task/submission.h"
 #include "iree/task/task.h"
 
@@ -22,9 +23,13 @@ extern "C" {
 
 // Creates a semaphore that integrates with the task system to allow for
 // pipelined wait and signal operations.
+// If provided then blocking waits on the semaphore donate the calling thread to
+// |donation_executor| until the wait is satisfied. This is required if the
+// executor is threadless.
 iree_status_t iree_hal_task_semaphore_create(
-    iree_event_pool_t* event_pool, uint64_t initial_value,
-    iree_allocator_t host_allocator, iree_hal_semaphore_t** out_semaphore);
+    iree_event_pool_t* event_pool, iree_task_executor_t* donation_executor,
+    uint64_t initial_value, iree_allocator_t host_allocator,
+    iree_hal_semaphore_t** out_semaphore);
 
 // Returns true if |semaphore| is a task system semaphore.
 bool iree_hal_task_semaphore_isa(iree_hal_semaphore_t* semaphore);
@@ -41,11 +46,13 @@ iree_status_t iree_hal_task_semaphore_enqueue_timepoint(
 
 // Performs a multi-wait on one or more semaphores.
 // Returns IREE_STATUS_DEADLINE_EXCEEDED if the wait does not complete before
-// |deadline_ns| elapses.
+// |deadline_ns| elapses. If provided then the calling thread is donated to
+// |donation_executor| while waiting.
 iree_status_t iree_hal_task_semaphore_multi_wait(
     iree_hal_wait_mode_t wait_mode,
     const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
-    iree_event_pool_t* event_pool, iree_arena_block_pool_t* block_pool);
+    iree_task_executor_t* donation_executor, iree_event_pool_t* event_pool,
+    iree_arena_block_pool_t* block_pool);
 
 #ifdef __cplusplus
 }  // extern "C"
@@ -15,6 +15,10 @@
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/metal/builtin/metal_buffer_kernels.h"
 
+#if defined(IREE_HAL_METAL_HAVE_PRECOMPILED_BUILTINS)
+#include "iree/hal/drivers/metal/builtin/metal_buffer_libraries.h"
+#endif  // IREE_HAL_METAL_HAVE_PRECOMPILED_BUILTINS
+
 typedef struct iree_hal_metal_builtin_pipeline_info_t {
   iree_string_view_t entry_point;
   uint32_t file_index;
@@ -46,10 +50,49 @@ typedef struct iree_hal_metal_buffer_copy_spec_t {
   uint64_t length;             // Buffer length to fill (in bytes)
 } iree_hal_metal_buffer_copy_spec_t;
 
-// Compiles |source_file| as MSL source into a MTLLibrary for the given |device|.
-//
-// TODO: we should be precompiling this and shipping a binary metallib instead: compiling from
-// source at runtime is _extremely_ inefficient.
+#if defined(IREE_HAL_METAL_HAVE_PRECOMPILED_BUILTINS)
+
+// Loads |library_file| as a precompiled metallib into a MTLLibrary for the given |device|.
+static iree_status_t iree_hal_metal_load_embedded_metallib(id<MTLDevice> device,
+                                                           iree_file_toc_t library_file,
+                                                           id<MTLLibrary>* out_library) {
+  *out_library = nil;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, library_file.name);
+
+  iree_status_t status = iree_ok_status();
+  id<MTLLibrary> library = nil;
+  @autoreleasepool {
+    // The embedded data is static so it need not be copied or freed.
+    dispatch_data_t data = dispatch_data_create(library_file.data, library_file.size,
+                                                /*queue=*/NULL, ^{
+                                                });
+    NSError* error = nil;
+    library = [device newLibraryWithData:data error:&error];  // +1
+    dispatch_release(data);
+    if (IREE_UNLIKELY(library == nil)) {
+      const char* ns_c_error = [error.localizedDescription
+          cStringUsingEncoding:[NSString defaultCStringEncoding]];  // autoreleased
+      status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "failed to create MTLLibrary from metallib %s: %s",
+                                library_file.name, ns_c_error);
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_library = library;
+  } else {
+    [library release];
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+// Compiles |source_file| as MSL source into a MTLLibrary for the given |device|. Only used when
+// the builtins could not be precompiled at build time as compiling from source at runtime is
+// _extremely_ inefficient.
 static iree_status_t iree_hal_metal_compile_embedded_msl(id<MTLDevice> device,
                                                          iree_file_toc_t source_file,
                                                          id<MTLLibrary>* out_library) {
@@ -90,6 +133,8 @@ static iree_status_t iree_hal_metal_compile_embedded_msl(id<MTLDevice> device,
   return status;
 }
 
+#endif  // IREE_HAL_METAL_HAVE_PRECOMPILED_BUILTINS
+
 // Loads all MTLLibrary instances required by the builtin pipelines.
 static iree_status_t iree_hal_metal_load_builtin_libraries(
     id<MTLDevice> device, NSArray<id<MTLLibrary>>** out_libraries) {
@@ -98,9 +143,17 @@ static iree_status_t iree_hal_metal_load_builtin_libraries(
 
   NSMutableArray<id<MTLLibrary>>* libraries = [[NSMutableArray alloc] init];  // +1
 
-  // TODO: don't compile sources and instead embed the libraries in binary form.
-  // Embedding source files is an anti-pattern.
+  // Libraries are ordered to match the embedded sources (and file indices).
   iree_status_t status = iree_ok_status();
+#if defined(IREE_HAL_METAL_HAVE_PRECOMPILED_BUILTINS)
+  const iree_file_toc_t* embedded_files = metal_buffer_libraries_create();
+  for (iree_host_size_t i = 0; i < metal_buffer_libraries_size(); ++i) {
+    id<MTLLibrary> library = nil;
+    status = iree_hal_metal_load_embedded_metallib(device, embedded_files[i], &library);
+    if (!iree_status_is_ok(status)) break;
+    [libraries addObject:library];
+  }
+#else
   const iree_file_toc_t* embedded_files = metal_buffer_kernels_create();
   for (iree_host_size_t i = 0; i < metal_buffer_kernels_size(); ++i) {
     iree_file_toc_t source_file = embedded_files[i];
@@ -109,6 +162,7 @@ static iree_status_t iree_hal_metal_load_builtin_libraries(
     if (!iree_status_is_ok(status)) break;
     [libraries addObject:library];
   }
+#endif  // IREE_HAL_METAL_HAVE_PRECOMPILED_BUILTINS
 
   if (iree_status_is_ok(status)) {
     *out_libraries = libraries;
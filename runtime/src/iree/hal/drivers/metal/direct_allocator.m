@@ -7,6 +7,7 @@
 #include "iree/hal/drivers/metal/direct_allocator.h"
 
 #import <Metal/Metal.h>
+#include <unistd.h>
 
 #include "iree/base/api.h"
 #include "iree/base/target_platform.h"
@@ -67,6 +68,9 @@ iree_status_t iree_hal_metal_allocator_create(
   if (iree_status_is_ok(status)) {
     iree_hal_resource_initialize(&iree_hal_metal_allocator_vtable, &allocator->resource);
     allocator->device = [device retain];  // +1
+#if defined(IREE_PLATFORM_MACOS)
+    allocator->queue = queue;
+#endif  // IREE_PLATFORM_MACOS
     allocator->is_unified_memory = [device hasUnifiedMemory];
     allocator->resource_tracking_mode = resource_tracking_mode;
     allocator->host_allocator = host_allocator;
@@ -117,13 +121,95 @@ static void iree_hal_metal_allocator_query_statistics(
   });
 }
 
+static void iree_hal_metal_allocator_reset_capture_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  IREE_STATISTICS({
+    iree_hal_metal_allocator_t* allocator = iree_hal_metal_allocator_cast(base_allocator);
+    iree_hal_allocator_statistics_reset_capture(&allocator->statistics);
+  });
+}
+
+static iree_status_t iree_hal_metal_allocator_query_memory_heaps(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator, iree_host_size_t capacity,
+    iree_hal_allocator_memory_heap_t* IREE_RESTRICT heaps,
+    iree_host_size_t* IREE_RESTRICT out_count) {
+  iree_hal_metal_allocator_t* allocator = iree_hal_metal_allocator_cast(base_allocator);
+
+  // On unified memory (Apple silicon and iOS) host-visible memory is backed by the Shared storage
+  // mode and there's no distinct device-local + host-visible heap. Discrete macOS devices
+  // additionally expose one backed by the Managed storage mode.
+  iree_host_size_t count = allocator->is_unified_memory ? 3 : 4;
+  if (out_count) *out_count = count;
+  if (capacity < count) {
+    // NOTE: lightweight as this is hit in normal pre-sizing usage.
+    return iree_status_from_code(IREE_STATUS_OUT_OF_RANGE);
+  }
+
+  const iree_device_size_t max_allocation_size =
+      (iree_device_size_t)allocator->device.maxBufferLength;
+  const iree_device_size_t min_alignment = IREE_HAL_HEAP_BUFFER_ALIGNMENT;
+
+  iree_host_size_t i = 0;
+
+  // Private storage mode; only accessible to the GPU.
+  heaps[i++] = (iree_hal_allocator_memory_heap_t){
+      .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
+      .allowed_usage = IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH,
+      .max_allocation_size = max_allocation_size,
+      .min_alignment = min_alignment,
+  };
+
+  if (!allocator->is_unified_memory) {
+    // Managed storage mode; synchronized explicitly between the CPU and GPU copies.
+    heaps[i++] = (iree_hal_allocator_memory_heap_t){
+        .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE,
+        .allowed_usage = IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH |
+                         IREE_HAL_BUFFER_USAGE_MAPPING,
+        .max_allocation_size = max_allocation_size,
+        .min_alignment = min_alignment,
+    };
+  }
+
+  // Write-combined shared storage mode (upload).
+  heaps[i++] = (iree_hal_allocator_memory_heap_t){
+      .type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE |
+              IREE_HAL_MEMORY_TYPE_HOST_COHERENT,
+      .allowed_usage = IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH |
+                       IREE_HAL_BUFFER_USAGE_MAPPING,
+      .max_allocation_size = max_allocation_size,
+      .min_alignment = min_alignment,
+  };
+
+  // Cached shared storage mode (download).
+  heaps[i++] = (iree_hal_allocator_memory_heap_t){
+      .type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE |
+              IREE_HAL_MEMORY_TYPE_HOST_COHERENT | IREE_HAL_MEMORY_TYPE_HOST_CACHED,
+      .allowed_usage = IREE_HAL_BUFFER_USAGE_TRANSFER | IREE_HAL_BUFFER_USAGE_DISPATCH |
+                       IREE_HAL_BUFFER_USAGE_MAPPING,
+      .max_allocation_size = max_allocation_size,
+      .min_alignment = min_alignment,
+  };
+
+  IREE_ASSERT(i == count);
+  return iree_ok_status();
+}
+
 static iree_hal_buffer_compatibility_t iree_hal_metal_allocator_query_buffer_compatibility(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_hal_buffer_params_t* IREE_RESTRICT params,
     iree_device_size_t* IREE_RESTRICT allocation_size) {
+  iree_hal_metal_allocator_t* allocator = iree_hal_metal_allocator_cast(base_allocator);
+
   // All buffers can be allocated on the heap.
   iree_hal_buffer_compatibility_t compatibility = IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE;
 
+  // Host allocations are imported without copies as Shared storage mode buffers. That is only
+  // device-local memory when the GPU shares physical memory with the CPU.
+  if (allocator->is_unified_memory ||
+      !iree_all_bits_set(params->type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL)) {
+    compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE;
+  }
+
   if (iree_any_bit_set(params->usage, IREE_HAL_BUFFER_USAGE_TRANSFER)) {
     compatibility |= IREE_HAL_BUFFER_COMPATIBILITY_QUEUE_TRANSFER;
   }
@@ -144,7 +230,6 @@ static iree_hal_buffer_compatibility_t iree_hal_metal_allocator_query_buffer_com
     // architecture, it's fine to just request host local + device visible memory.
     // On macOS, for unified memory architecture, it's similar to iOS. Otherwise, we can have
     // device local + host visible memory backed by Managed storage mode.
-    iree_hal_metal_allocator_t* allocator = iree_hal_metal_allocator_cast(base_allocator);
     if (allocator->is_unified_memory) {
       params->type &= ~(IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE);
       params->type |= IREE_HAL_MEMORY_TYPE_HOST_LOCAL | IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
@@ -321,28 +406,67 @@ static iree_status_t iree_hal_metal_allocator_import_host_buffer(
     iree_hal_buffer_release_callback_t release_callback,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
   iree_hal_metal_allocator_t* allocator = iree_hal_metal_allocator_cast(base_allocator);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, external_buffer->size);
 
-  // MTLResourceOptions options = iree_hal_metal_select_resource_options(
-  //     params->type, allocator->is_unified_memory, allocator->resource_tracking_mode);
-  MTLResourceOptions options = MTLResourceCPUCacheModeDefaultCache | MTLResourceStorageModeShared |
-                               MTLResourceHazardTrackingModeUntracked;
+  // Coerce options into those required by the current device.
+  iree_hal_buffer_params_t compat_params = *params;
+  iree_device_size_t allocation_size = external_buffer->size;
+  iree_hal_buffer_compatibility_t compatibility =
+      iree_hal_metal_allocator_query_buffer_compatibility(base_allocator, &compat_params,
+                                                          &allocation_size);
+  if (!iree_all_bits_set(compatibility, IREE_HAL_BUFFER_COMPATIBILITY_IMPORTABLE)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unable to import host allocations as device-local memory on devices "
+                            "without unified memory");
+  }
 
-  id<MTLBuffer> metal_buffer =
-      [allocator->device newBufferWithBytesNoCopy:external_buffer->handle.host_allocation.ptr
-                                           length:(NSUInteger)external_buffer->size
-                                          options:options
-                                      deallocator:nil];  // +1
+  // Metal can only wrap whole pages of host memory. Wrap the pages spanning the allocation and
+  // offset into them so that callers need not page-align their allocations; the pages themselves
+  // are always mapped in their entirety so this never touches memory outside of the process.
+  const uintptr_t page_size = (uintptr_t)getpagesize();
+  const uintptr_t host_ptr = (uintptr_t)external_buffer->handle.host_allocation.ptr;
+  const uintptr_t page_ptr = host_ptr & ~(page_size - 1);
+  const iree_device_size_t byte_offset = (iree_device_size_t)(host_ptr - page_ptr);
+  const NSUInteger page_length =
+      (NSUInteger)iree_host_align(byte_offset + external_buffer->size, page_size);
+
+  // Host memory is shared with the GPU without copies. The pages remain owned by the caller and are
+  // kept live by the release callback for as long as the HAL buffer is live.
+  MTLResourceOptions options = MTLResourceStorageModeShared | MTLResourceCPUCacheModeDefaultCache;
+  options |=
+      allocator->resource_tracking_mode == IREE_HAL_METAL_RESOURCE_HAZARD_TRACKING_MODE_TRACKED
+          ? MTLResourceHazardTrackingModeTracked
+          : MTLResourceHazardTrackingModeUntracked;
+  id<MTLBuffer> metal_buffer = [allocator->device newBufferWithBytesNoCopy:(void*)page_ptr
+                                                                    length:page_length
+                                                                   options:options
+                                                               deallocator:nil];  // +1
   if (!metal_buffer) {
-    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED, "unable to allocate buffer");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "unable to import host allocation of %" PRIdsz " bytes",
+                            external_buffer->size);
   }
 
-  return iree_hal_metal_buffer_wrap(
+  // The memory is always accessible to both the host and the device regardless of what was
+  // requested.
+  iree_hal_memory_type_t memory_type = compat_params.type | IREE_HAL_MEMORY_TYPE_HOST_VISIBLE |
+                                       IREE_HAL_MEMORY_TYPE_HOST_COHERENT |
+                                       IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE;
+  iree_status_t status = iree_hal_metal_buffer_wrap(
 #if defined(IREE_PLATFORM_MACOS)
       allocator->queue,
 #endif  // IREE_PLATFORM_MACOS
-      metal_buffer, base_allocator, params->type, params->access, params->usage,
-      external_buffer->size, /*byte_offset=*/0, /*byte_length=*/external_buffer->size,
+      metal_buffer, base_allocator, memory_type, compat_params.access, compat_params.usage,
+      (iree_device_size_t)page_length, byte_offset, /*byte_length=*/external_buffer->size,
       release_callback, out_buffer);  // +1
+
+  [metal_buffer release];  // -1
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
 }
 
 static iree_status_t iree_hal_metal_allocator_import_device_buffer(
@@ -404,6 +528,8 @@ static const iree_hal_allocator_vtable_t iree_hal_metal_allocator_vtable = {
     .host_allocator = iree_hal_metal_allocator_host_allocator,
     .trim = iree_hal_metal_allocator_trim,
     .query_statistics = iree_hal_metal_allocator_query_statistics,
+    .reset_capture_statistics = iree_hal_metal_allocator_reset_capture_statistics,
+    .query_memory_heaps = iree_hal_metal_allocator_query_memory_heaps,
     .query_buffer_compatibility = iree_hal_metal_allocator_query_buffer_compatibility,
     .allocate_buffer = iree_hal_metal_allocator_allocate_buffer,
     .deallocate_buffer = iree_hal_metal_allocator_deallocate_buffer,
@@ -151,6 +151,40 @@ static void iree_hal_metal_command_segment_list_push_back(
   }
 }
 
+//===------------------------------------------------------------------------------------------===//
+// Barrier and argument buffer tracking
+//===------------------------------------------------------------------------------------------===//
+
+// Maximum number of buffers a pending barrier tracks before falling back to a full buffer scope
+// memory barrier.
+#define IREE_HAL_METAL_MAX_PENDING_BARRIER_RESOURCES 32
+
+// Number of argument buffers cached per command buffer for reuse by dispatches with the same
+// pipeline and bindings. Must be a power of two.
+#define IREE_HAL_METAL_ARGUMENT_BUFFER_CACHE_CAPACITY 64
+
+// Synchronization required by a pending barrier, from weakest to strongest. Merging barriers takes
+// the strongest of them.
+typedef enum iree_hal_metal_pending_barrier_kind_e {
+  // No barrier pending.
+  IREE_HAL_METAL_PENDING_BARRIER_KIND_NONE = 0,
+  // Memory barrier limited to the tracked resources.
+  IREE_HAL_METAL_PENDING_BARRIER_KIND_RESOURCES,
+  // Memory barrier covering all buffers.
+  IREE_HAL_METAL_PENDING_BARRIER_KIND_BUFFERS,
+  // Execution barrier splitting encoders with an event signal/wait.
+  IREE_HAL_METAL_PENDING_BARRIER_KIND_EXECUTION,
+} iree_hal_metal_pending_barrier_kind_t;
+
+// An argument buffer encoded into the staging buffer for a dispatch segment.
+typedef struct iree_hal_metal_argument_buffer_cache_entry_t {
+  uint64_t hash;
+  // Dispatch segment whose descriptors were encoded; owned by the command buffer arena.
+  const iree_hal_metal_dispatch_segment_t* segment;
+  // Offset of the argument buffer in the staging buffer.
+  uint32_t offset;
+} iree_hal_metal_argument_buffer_cache_entry_t;
+
 //===------------------------------------------------------------------------------------------===//
 // iree_hal_metal_command_buffer_t
 //===------------------------------------------------------------------------------------------===//
@@ -201,6 +235,20 @@ typedef struct iree_hal_metal_command_buffer_t {
     id<MTLEvent> encoder_event;
     // The next available encoder event value to signal/wait to/on.
     uint64_t next_encoder_event_value;
+
+    // Barrier merged from all barrier segments since the last command. It is only flushed once the
+    // next command is recorded so that barriers without prior or subsequent work, and barriers
+    // already implied by switching encoders, are elided.
+    struct {
+      iree_hal_metal_pending_barrier_kind_t kind;
+      iree_host_size_t resource_count;
+      id<MTLResource> resources[IREE_HAL_METAL_MAX_PENDING_BARRIER_RESOURCES];
+    } pending_barrier;
+
+    // Direct-mapped cache of argument buffers encoded in this command buffer. Entries stay valid
+    // until reset as the staging buffer keeps its contents alive until the command buffer retires.
+    iree_hal_metal_argument_buffer_cache_entry_t
+        argument_buffer_cache[IREE_HAL_METAL_ARGUMENT_BUFFER_CACHE_CAPACITY];
   } state;
 } iree_hal_metal_command_buffer_t;
 
@@ -251,11 +299,63 @@ static void iree_hal_metal_command_buffer_reset(iree_hal_metal_command_buffer_t*
   iree_hal_metal_end_compute_encoder(command_buffer);
   iree_hal_metal_command_segment_list_reset(&command_buffer->segments);
   iree_arena_reset(&command_buffer->arena);
+  command_buffer->state.pending_barrier.kind = IREE_HAL_METAL_PENDING_BARRIER_KIND_NONE;
+  command_buffer->state.pending_barrier.resource_count = 0;
+  memset(command_buffer->state.argument_buffer_cache, 0,
+         sizeof(command_buffer->state.argument_buffer_cache));
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Encodes an execution barrier between all prior and subsequent commands by splitting encoders.
+// There is no direct corresponding API for execution only barriers in Metal. We just signal and
+// wait on the same value of a MTLEvent here.
+static void iree_hal_metal_encode_execution_barrier(
+    iree_hal_metal_command_buffer_t* command_buffer) {
+  iree_hal_metal_end_blit_encoder(command_buffer);
+  iree_hal_metal_end_compute_encoder(command_buffer);
+  id<MTLCommandBuffer> metal_handle = command_buffer->command_buffer;
+  uint64_t event_value = command_buffer->state.next_encoder_event_value++;
+  [metal_handle encodeSignalEvent:command_buffer->state.encoder_event value:event_value];
+  [metal_handle encodeWaitForEvent:command_buffer->state.encoder_event value:event_value];
+}
+
+// Flushes the pending barrier before recording a command into a compute (|is_compute|) or blit
+// encoder. The barrier is elided if no encoder is open as then all prior work, if any, has already
+// been synchronized, or if switching encoders as that synchronizes with an event.
+static void iree_hal_metal_flush_pending_barrier(iree_hal_metal_command_buffer_t* command_buffer,
+                                                 bool is_compute) {
+  iree_hal_metal_pending_barrier_kind_t kind = command_buffer->state.pending_barrier.kind;
+  if (kind == IREE_HAL_METAL_PENDING_BARRIER_KIND_NONE) return;
+  command_buffer->state.pending_barrier.kind = IREE_HAL_METAL_PENDING_BARRIER_KIND_NONE;
+  iree_host_size_t resource_count = command_buffer->state.pending_barrier.resource_count;
+  command_buffer->state.pending_barrier.resource_count = 0;
+
+  id<MTLComputeCommandEncoder> compute_encoder = command_buffer->state.compute_encoder;
+  bool continues_encoder =
+      is_compute ? compute_encoder != nil : command_buffer->state.blit_encoder != nil;
+  if (!continues_encoder) return;
+
+  // Blit encoders have no memory barriers so we need to split them.
+  if (!is_compute || kind == IREE_HAL_METAL_PENDING_BARRIER_KIND_EXECUTION) {
+    iree_hal_metal_encode_execution_barrier(command_buffer);
+    return;
+  }
+
+  if (kind == IREE_HAL_METAL_PENDING_BARRIER_KIND_BUFFERS) {
+    // If there is a memory barrier specified, we have to place a catch-all barrier for all buffers.
+    // Metal does not provide a more fine-grained control here.
+    [compute_encoder memoryBarrierWithScope:MTLBarrierScopeBuffers];
+  } else {
+    // But we do have the option to specify a list of buffers to synchronize if only buffer barriers
+    // are specified.
+    [compute_encoder memoryBarrierWithResources:command_buffer->state.pending_barrier.resources
+                                          count:resource_count];
+  }
+}
+
 static id<MTLComputeCommandEncoder> iree_hal_metal_get_or_begin_compute_encoder(
     iree_hal_metal_command_buffer_t* command_buffer) {
+  iree_hal_metal_flush_pending_barrier(command_buffer, /*is_compute=*/true);
   id<MTLCommandBuffer> metal_handle = command_buffer->command_buffer;
 
   // If we are switching encoders, we would need to use a fence to synchronize "one or more
@@ -286,6 +386,7 @@ static id<MTLComputeCommandEncoder> iree_hal_metal_get_or_begin_compute_encoder(
 
 static id<MTLBlitCommandEncoder> iree_hal_metal_get_or_begin_blit_encoder(
     iree_hal_metal_command_buffer_t* command_buffer) {
+  iree_hal_metal_flush_pending_barrier(command_buffer, /*is_compute=*/false);
   id<MTLCommandBuffer> metal_handle = command_buffer->command_buffer;
 
   // If we are switching encoders, we would need to use a fence to synchronize "one or more
@@ -493,43 +594,32 @@ static iree_status_t iree_hal_metal_command_buffer_prepare_barrier(
   return iree_ok_status();
 }
 
+// Merges the barrier |segment| into the pending barrier. Consecutive barriers are combined into the
+// strongest synchronization among them and only materialized before the next command.
 static iree_status_t iree_hal_metal_command_segment_record_barrier(
     iree_hal_metal_command_buffer_t* command_buffer, iree_hal_metal_barrier_segment_t* segment) {
-  // TODO(antiagainst): Analyze segments before and after to optimize barriers, e.g., switching
-  // encoders would require its own synchronization; so we don't need extract barriers in the
-  // middle.
+  iree_hal_metal_pending_barrier_kind_t kind = IREE_HAL_METAL_PENDING_BARRIER_KIND_RESOURCES;
   if (segment->memory_barrier_count == 0 && segment->buffer_barrier_count == 0) {
-    // There is no direct corresponding APIs for execution only barrier in Metal. We just signal and
-    // wait on the same value of a MTLEvent here.
-    iree_hal_metal_end_blit_encoder(command_buffer);
-    iree_hal_metal_end_compute_encoder(command_buffer);
-    id<MTLCommandBuffer> metal_handle = command_buffer->command_buffer;
-    uint64_t event_value = command_buffer->state.next_encoder_event_value++;
-    [metal_handle encodeSignalEvent:command_buffer->state.encoder_event value:event_value];
-    [metal_handle encodeWaitForEvent:command_buffer->state.encoder_event value:event_value];
-    return iree_ok_status();
+    kind = IREE_HAL_METAL_PENDING_BARRIER_KIND_EXECUTION;
+  } else if (segment->memory_barrier_count != 0 ||
+             command_buffer->state.pending_barrier.resource_count + segment->buffer_barrier_count >
+                 IREE_HAL_METAL_MAX_PENDING_BARRIER_RESOURCES) {
+    kind = IREE_HAL_METAL_PENDING_BARRIER_KIND_BUFFERS;
   }
-
-  id<MTLComputeCommandEncoder> encoder =
-      iree_hal_metal_get_or_begin_compute_encoder(command_buffer);
-
-  if (segment->memory_barrier_count != 0) {
-    // If there is a memory barrier specified, we have to place a catch-all barrier for all buffers.
-    // Metal does not provide a more fine-grained control here.
-    [encoder memoryBarrierWithScope:MTLBarrierScopeBuffers];
+  if (kind > command_buffer->state.pending_barrier.kind) {
+    command_buffer->state.pending_barrier.kind = kind;
+  }
+  if (command_buffer->state.pending_barrier.kind != IREE_HAL_METAL_PENDING_BARRIER_KIND_RESOURCES) {
+    // Stronger barriers cover all buffers so there is no need to track them.
+    command_buffer->state.pending_barrier.resource_count = 0;
     return iree_ok_status();
   }
 
-  if (segment->buffer_barrier_count != 0) {
-    // But we do have the option to specify a list of buffers to synchronize if only buffer barriers
-    // are specified.
-    id<MTLResource>* resources =
-        (id<MTLResource>*)iree_alloca(sizeof(id<MTLResource>) * segment->buffer_barrier_count);
-    for (iree_host_size_t i = 0; i < segment->buffer_barrier_count; ++i) {
-      resources[i] = iree_hal_metal_buffer_handle(
-          iree_hal_buffer_allocated_buffer(segment->buffer_barriers[i].buffer_ref.buffer));
-    }
-    [encoder memoryBarrierWithResources:resources count:segment->buffer_barrier_count];
+  for (iree_host_size_t i = 0; i < segment->buffer_barrier_count; ++i) {
+    command_buffer->state.pending_barrier
+        .resources[command_buffer->state.pending_barrier.resource_count++] =
+        iree_hal_metal_buffer_handle(
+            iree_hal_buffer_allocated_buffer(segment->buffer_barriers[i].buffer_ref.buffer));
   }
   return iree_ok_status();
 }
@@ -902,28 +992,43 @@ static iree_status_t iree_hal_metal_command_segment_create_dispatch(
   return iree_ok_status();
 }
 
-static iree_status_t iree_hal_metal_command_segment_record_dispatch(
-    iree_hal_metal_command_buffer_t* command_buffer, iree_hal_metal_dispatch_segment_t* segment) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-
-  // Set the compute kernel to dispatch.
-  id<MTLComputeCommandEncoder> compute_encoder =
-      iree_hal_metal_get_or_begin_compute_encoder(command_buffer);
-  [compute_encoder setComputePipelineState:segment->pipeline->pipeline_state];
-
-  // Record push constants.
-  if (segment->constant_count != 0) {
-    [compute_encoder setBytes:(void*)segment->constants
-                       length:segment->constant_count * sizeof(int32_t)
-                      atIndex:IREE_HAL_METAL_PUSH_CONSTANT_BUFFER_INDEX];
+// Hashes the pipeline and bindings that determine the argument buffer contents of |segment|.
+static uint64_t iree_hal_metal_hash_argument_buffer(
+    const iree_hal_metal_dispatch_segment_t* segment) {
+  // FNV-1a over the pipeline and each (binding, buffer, offset) tuple.
+  uint64_t hash = 14695981039346656037ull;
+#define IREE_HAL_METAL_HASH_MIX(value) hash = (hash ^ (uint64_t)(value)) * 1099511628211ull
+  IREE_HAL_METAL_HASH_MIX((uintptr_t)segment->pipeline);
+  for (iree_host_size_t i = 0; i < segment->descriptor_count; ++i) {
+    IREE_HAL_METAL_HASH_MIX(segment->descriptors[i].binding);
+    IREE_HAL_METAL_HASH_MIX((uintptr_t)segment->descriptors[i].buffer);
+    IREE_HAL_METAL_HASH_MIX(segment->descriptors[i].offset);
   }
+#undef IREE_HAL_METAL_HASH_MIX
+  return hash;
+}
 
-  // Record argument buffers for all descriptors and record buffer usages.
-  iree_hal_metal_descriptor_t* descriptors = segment->descriptors;
+// Returns true if the argument buffers of |lhs| and |rhs| have the same contents.
+static bool iree_hal_metal_argument_buffer_matches(const iree_hal_metal_dispatch_segment_t* lhs,
+                                                   const iree_hal_metal_dispatch_segment_t* rhs) {
+  if (lhs->pipeline != rhs->pipeline) return false;
+  if (lhs->descriptor_count != rhs->descriptor_count) return false;
+  for (iree_host_size_t i = 0; i < lhs->descriptor_count; ++i) {
+    if (lhs->descriptors[i].binding != rhs->descriptors[i].binding ||
+        lhs->descriptors[i].buffer != rhs->descriptors[i].buffer ||
+        lhs->descriptors[i].offset != rhs->descriptors[i].offset) {
+      return false;
+    }
+  }
+  return true;
+}
 
+// Encodes the argument buffer for all descriptors of |segment| into the staging buffer and returns
+// its offset in |out_offset|.
+static iree_status_t iree_hal_metal_encode_argument_buffer(
+    iree_hal_metal_command_buffer_t* command_buffer,
+    const iree_hal_metal_dispatch_segment_t* segment, uint32_t* out_offset) {
   // Build argument encoder and argument buffer for the current descriptor set.
-  // TODO(antiagainst): Use a cache layer to cache and reuse argument buffers with the same
-  // content, to avoid duplicating overhead.
   id<MTLBuffer> argument_buffer = command_buffer->staging_buffer->metal_buffer;
   id<MTLArgumentEncoder> argument_encoder =
       [segment->pipeline->function newArgumentEncoderWithBufferIndex:0];  // +1
@@ -932,13 +1037,17 @@ static iree_status_t iree_hal_metal_command_segment_record_dispatch(
   // Reserve space for the argument buffer from shared staging buffer.
   iree_byte_span_t reservation = iree_byte_span_empty();
   uint32_t argument_buffer_offset = 0;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_metal_staging_buffer_reserve(
-              command_buffer->staging_buffer, argument_encoder.encodedLength,
-              argument_encoder.alignment, &reservation, &argument_buffer_offset));
+  iree_status_t status = iree_hal_metal_staging_buffer_reserve(
+      command_buffer->staging_buffer, argument_encoder.encodedLength, argument_encoder.alignment,
+      &reservation, &argument_buffer_offset);
+  if (!iree_status_is_ok(status)) {
+    [argument_encoder release];  // -1
+    return status;
+  }
   [argument_encoder setArgumentBuffer:argument_buffer offset:argument_buffer_offset];
 
   // Now record all bound buffers belonging to the current set into the argument buffer.
+  const iree_hal_metal_descriptor_t* descriptors = segment->descriptors;
   for (iree_host_size_t i = 0; i < segment->descriptor_count; ++i) {
     uint32_t current_binding = descriptors[i].binding;
     id<MTLBuffer> current_buffer =
@@ -946,14 +1055,56 @@ static iree_status_t iree_hal_metal_command_segment_record_dispatch(
     iree_host_size_t offset =
         iree_hal_buffer_byte_offset(descriptors[i].buffer) + descriptors[i].offset;
     [argument_encoder setBuffer:current_buffer offset:offset atIndex:current_binding];
+  }
+
+  [argument_encoder release];  // -1
+
+  *out_offset = argument_buffer_offset;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_metal_command_segment_record_dispatch(
+    iree_hal_metal_command_buffer_t* command_buffer, iree_hal_metal_dispatch_segment_t* segment) {
+  IREE_TRACE_ZONE_BEGIN(z0);
 
-    // Also record buffer usages.
+  // Set the compute kernel to dispatch.
+  id<MTLComputeCommandEncoder> compute_encoder =
+      iree_hal_metal_get_or_begin_compute_encoder(command_buffer);
+  [compute_encoder setComputePipelineState:segment->pipeline->pipeline_state];
+
+  // Record push constants.
+  if (segment->constant_count != 0) {
+    [compute_encoder setBytes:(void*)segment->constants
+                       length:segment->constant_count * sizeof(int32_t)
+                      atIndex:IREE_HAL_METAL_PUSH_CONSTANT_BUFFER_INDEX];
+  }
+
+  // Record buffer usages for all descriptors.
+  iree_hal_metal_descriptor_t* descriptors = segment->descriptors;
+  for (iree_host_size_t i = 0; i < segment->descriptor_count; ++i) {
+    id<MTLBuffer> current_buffer =
+        iree_hal_metal_buffer_handle(iree_hal_buffer_allocated_buffer(descriptors[i].buffer));
     [compute_encoder useResource:current_buffer usage:descriptors[i].usage];
   }
-  // Record the argument buffer.
-  [compute_encoder setBuffer:argument_buffer offset:argument_buffer_offset atIndex:0];
 
-  [argument_encoder release];  // -1
+  // Reuse the argument buffer of a prior dispatch with the same content if possible.
+  id<MTLBuffer> argument_buffer = command_buffer->staging_buffer->metal_buffer;
+  uint64_t hash = iree_hal_metal_hash_argument_buffer(segment);
+  iree_host_size_t cache_index = hash & (IREE_HAL_METAL_ARGUMENT_BUFFER_CACHE_CAPACITY - 1);
+  iree_hal_metal_argument_buffer_cache_entry_t* cache_entry =
+      &command_buffer->state.argument_buffer_cache[cache_index];
+  if (!cache_entry->segment || cache_entry->hash != hash ||
+      !iree_hal_metal_argument_buffer_matches(cache_entry->segment, segment)) {
+    uint32_t argument_buffer_offset = 0;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(z0, iree_hal_metal_encode_argument_buffer(
+                                              command_buffer, segment, &argument_buffer_offset));
+    cache_entry->hash = hash;
+    cache_entry->segment = segment;
+    cache_entry->offset = argument_buffer_offset;
+  }
+
+  // Record the argument buffer.
+  [compute_encoder setBuffer:argument_buffer offset:cache_entry->offset atIndex:0];
 
   // Record the dispatch, either direct or indirect.
   if (segment->workgroups_buffer == nil) {
@@ -268,34 +268,14 @@ static iree_status_t iree_hal_metal_load_libraries(id<MTLDevice> device,
   return status;
 }
 
-#if 0
-// Creates MTL compute pipeline objects for the given |entry_point| in |library| and writes to
-// |out_function| and |out_pipeline_state|. The caller should release |out_function| and
-// |out_pipeline_state| after done.
-static iree_status_t iree_hal_metal_create_pipeline_state(
-    id<MTLLibrary> library, iree_string_view_t entry_point, const char* source_code,
-    id<MTLDevice> device, id<MTLFunction>* out_function,
-    id<MTLComputePipelineState>* out_pipeline_state) {
-  @autoreleasepool {
-    NSError* error = nil;
-
-    // TODO(#14047): Enable async pipeline creation at runtime.
-    *out_pipeline_state = [device newComputePipelineStateWithFunction:*out_function
-                                                                error:&error];  // +1
-    if (IREE_UNLIKELY(*out_pipeline_state == nil)) {
-      [*out_function release];
-      return iree_hal_metal_get_invalid_kernel_status(
-          "invalid shader source", "when creating MTLComputePipelineState with NSError: %s", error,
-          entry_point, source_code);
-    }
-  }
-  return iree_ok_status();
-}
-#endif  // 0
-
-static iree_status_t iree_hal_metal_create_pipeline(id<MTLDevice> device, id<MTLLibrary> library,
-                                                    iree_hal_metal_PipelineDef_table_t pipeline_def,
-                                                    iree_hal_metal_pipeline_t* out_pipeline) {
+// Begins asynchronously creating the MTL compute pipeline object for |pipeline_def| in |library|.
+// The |dispatch_group| is entered and left once creation has completed at which point
+// |out_pipeline|'s pipeline_state is set on success or |out_error| is set to a retained NSError on
+// failure. Pipelines are compiled concurrently by Metal so kicking off creation of all pipelines
+// before waiting on any avoids serializing shader compilation.
+static iree_status_t iree_hal_metal_begin_create_pipeline(
+    id<MTLDevice> device, id<MTLLibrary> library, iree_hal_metal_PipelineDef_table_t pipeline_def,
+    dispatch_group_t dispatch_group, NSError** out_error, iree_hal_metal_pipeline_t* out_pipeline) {
   IREE_TRACE_ZONE_BEGIN(z0);
   flatbuffers_string_t entry_point = iree_hal_metal_PipelineDef_entry_point_get(pipeline_def);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, entry_point);
@@ -330,45 +310,63 @@ static iree_status_t iree_hal_metal_create_pipeline(id<MTLDevice> device, id<MTL
       [[[descriptor buffers] objectAtIndexedSubscript:IREE_HAL_METAL_PUSH_CONSTANT_BUFFER_INDEX]
           setMutability:MTLMutabilityImmutable];
 
-      NSError* error = nil;
-      out_pipeline->pipeline_state =
-          [device newComputePipelineStateWithDescriptor:descriptor
-                                                options:MTLPipelineOptionNone
-                                             reflection:nil
-                                                  error:&error];
-      if (IREE_UNLIKELY(out_pipeline->pipeline_state == nil)) {
-        const char* ns_c_error = [error.localizedDescription
-            cStringUsingEncoding:[NSString defaultCStringEncoding]];  // autoreleased
-        status = iree_make_status(
-            IREE_STATUS_INVALID_ARGUMENT, "failed to create pipeline with function `%.*s`: %s",
-            (int)flatbuffers_string_len(entry_point), entry_point, ns_c_error);
-      }
+      dispatch_group_enter(dispatch_group);
+      [device newComputePipelineStateWithDescriptor:descriptor
+                                            options:MTLPipelineOptionNone
+                                  completionHandler:^(
+                                      id<MTLComputePipelineState> pipeline_state,
+                                      MTLComputePipelineReflection* reflection, NSError* error) {
+                                    out_pipeline->pipeline_state = [pipeline_state retain];  // +1
+                                    if (pipeline_state == nil) *out_error = [error retain];  // +1
+                                    dispatch_group_leave(dispatch_group);
+                                  }];
     }
   }
 
-  if (iree_status_is_ok(status)) {
-    const iree_hal_metal_ThreadgroupSize_t* threadgroup_size =
-        iree_hal_metal_PipelineDef_threadgroup_size_get(pipeline_def);
-    out_pipeline->threadgroup_size =
-        MTLSizeMake(threadgroup_size->x, threadgroup_size->y, threadgroup_size->z);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
 
-    out_pipeline->constant_count = iree_hal_metal_PipelineDef_constant_count_get(pipeline_def);
-    iree_hal_metal_BindingBits_vec_t binding_flags_vec =
-        iree_hal_metal_PipelineDef_binding_flags_get(pipeline_def);
-    out_pipeline->binding_count = iree_hal_metal_BindingBits_vec_len(binding_flags_vec);
-
-    out_pipeline->binding_read_only_bits = 0;
-    for (iree_host_size_t i = 0; i < out_pipeline->binding_count; ++i) {
-      iree_hal_metal_BindingBits_enum_t binding_flags =
-          iree_hal_metal_BindingBits_vec_at(binding_flags_vec, i);
-      if (iree_all_bits_set(binding_flags, iree_hal_metal_BindingBits_IMMUTABLE)) {
-        out_pipeline->binding_read_only_bits |= 1ull << i;
-      }
+// Completes creation of a pipeline started by iree_hal_metal_begin_create_pipeline after the
+// dispatch group has been waited on. Consumes |error|, if any.
+static iree_status_t iree_hal_metal_end_create_pipeline(
+    iree_hal_metal_PipelineDef_table_t pipeline_def, NSError* error,
+    iree_hal_metal_pipeline_t* out_pipeline) {
+  iree_status_t status = iree_ok_status();
+  if (IREE_UNLIKELY(out_pipeline->pipeline_state == nil)) {
+    flatbuffers_string_t entry_point = iree_hal_metal_PipelineDef_entry_point_get(pipeline_def);
+    @autoreleasepool {
+      const char* ns_c_error = error ? [error.localizedDescription
+                                           cStringUsingEncoding:[NSString defaultCStringEncoding]]
+                                     : "unknown error";  // autoreleased
+      status = iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT, "failed to create pipeline with function `%.*s`: %s",
+          (int)flatbuffers_string_len(entry_point), entry_point, ns_c_error);
+    }
+  }
+  [error release];  // -1
+  if (!iree_status_is_ok(status)) return status;
+
+  const iree_hal_metal_ThreadgroupSize_t* threadgroup_size =
+      iree_hal_metal_PipelineDef_threadgroup_size_get(pipeline_def);
+  out_pipeline->threadgroup_size =
+      MTLSizeMake(threadgroup_size->x, threadgroup_size->y, threadgroup_size->z);
+
+  out_pipeline->constant_count = iree_hal_metal_PipelineDef_constant_count_get(pipeline_def);
+  iree_hal_metal_BindingBits_vec_t binding_flags_vec =
+      iree_hal_metal_PipelineDef_binding_flags_get(pipeline_def);
+  out_pipeline->binding_count = iree_hal_metal_BindingBits_vec_len(binding_flags_vec);
+
+  out_pipeline->binding_read_only_bits = 0;
+  for (iree_host_size_t i = 0; i < out_pipeline->binding_count; ++i) {
+    iree_hal_metal_BindingBits_enum_t binding_flags =
+        iree_hal_metal_BindingBits_vec_at(binding_flags_vec, i);
+    if (iree_all_bits_set(binding_flags, iree_hal_metal_BindingBits_IMMUTABLE)) {
+      out_pipeline->binding_read_only_bits |= 1ull << i;
     }
   }
 
-  IREE_TRACE_ZONE_END(z0);
-  return status;
+  return iree_ok_status();
 }
 
 iree_status_t iree_hal_metal_executable_create(
@@ -427,17 +425,46 @@ iree_status_t iree_hal_metal_executable_create(
   iree_status_t status =
       iree_hal_metal_load_libraries(device, libraries_vec, &executable->libraries);
 
+  // Kick off creation of all pipelines so that Metal can compile them concurrently and then wait
+  // for all of them to complete. Errors are reported for the first failing pipeline.
+  NSError** pipeline_errors = NULL;
   if (iree_status_is_ok(status)) {
-    for (iree_host_size_t i = 0; i < pipeline_count; ++i) {
+    status = iree_allocator_malloc(host_allocator, pipeline_count * sizeof(pipeline_errors[0]),
+                                   (void**)&pipeline_errors);
+  }
+  if (iree_status_is_ok(status)) {
+    dispatch_group_t dispatch_group = dispatch_group_create();
+    iree_host_size_t begun_count = 0;
+    for (; begun_count < pipeline_count; ++begun_count) {
       iree_hal_metal_PipelineDef_table_t pipeline_def =
-          iree_hal_metal_PipelineDef_vec_at(pipelines_vec, i);
-
+          iree_hal_metal_PipelineDef_vec_at(pipelines_vec, begun_count);
       uint32_t library_ordinal = iree_hal_metal_PipelineDef_library_ordinal_get(pipeline_def);
       id<MTLLibrary> library = [executable->libraries objectAtIndex:library_ordinal];  // unretained
+      status = iree_hal_metal_begin_create_pipeline(device, library, pipeline_def, dispatch_group,
+                                                    &pipeline_errors[begun_count],
+                                                    &executable->pipelines[begun_count]);
+      if (!iree_status_is_ok(status)) break;
+    }
+
+    // Always wait for all pipelines that were begun as the completion handlers write into the
+    // executable.
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_hal_metal_executable_wait_pipelines");
+    dispatch_group_wait(dispatch_group, DISPATCH_TIME_FOREVER);
+    IREE_TRACE_ZONE_END(z_wait);
+    dispatch_release(dispatch_group);
 
+    for (iree_host_size_t i = 0; i < begun_count; ++i) {
+      iree_hal_metal_PipelineDef_table_t pipeline_def =
+          iree_hal_metal_PipelineDef_vec_at(pipelines_vec, i);
       iree_hal_metal_pipeline_t* pipeline = &executable->pipelines[i];
-      status = iree_hal_metal_create_pipeline(device, library, pipeline_def, pipeline);
-      if (!iree_status_is_ok(status)) break;
+      iree_status_t pipeline_status =
+          iree_hal_metal_end_create_pipeline(pipeline_def, pipeline_errors[i], pipeline);
+      if (iree_status_is_ok(status)) {
+        status = pipeline_status;
+      } else {
+        iree_status_ignore(pipeline_status);
+      }
+      if (!iree_status_is_ok(status)) continue;
 
       IREE_TRACE({
         iree_hal_debug_export_info_t* export_info = (iree_hal_debug_export_info_t*)export_info_ptr;
@@ -449,6 +476,7 @@ iree_status_t iree_hal_metal_executable_create(
       });
     }
   }
+  iree_allocator_free(host_allocator, pipeline_errors);
 
   if (iree_status_is_ok(status)) {
     *out_executable = (iree_hal_executable_t*)executable;
@@ -34,6 +34,11 @@ iree_status_t iree_hal_metal_buffer_wrap(
 // allocated by the HAL allocator.
 bool iree_hal_metal_buffer_is_external(const iree_hal_buffer_t* buffer);
 
+// Returns the user data of the release callback of |buffer| if it is a Metal buffer wrapped with a
+// release callback of |fn| and otherwise NULL.
+void* iree_hal_metal_buffer_release_user_data(const iree_hal_buffer_t* buffer,
+                                              iree_hal_buffer_release_fn_t fn);
+
 // Returns the underlying Metal buffer handle for the given |buffer|.
 id<MTLBuffer> iree_hal_metal_buffer_handle(const iree_hal_buffer_t* buffer);
 
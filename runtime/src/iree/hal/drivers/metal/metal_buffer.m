@@ -90,6 +90,13 @@ bool iree_hal_metal_buffer_is_external(const iree_hal_buffer_t* base_buffer) {
   return buffer->release_callback.fn != NULL;
 }
 
+void* iree_hal_metal_buffer_release_user_data(const iree_hal_buffer_t* base_buffer,
+                                              iree_hal_buffer_release_fn_t fn) {
+  if (!iree_hal_resource_is(base_buffer, &iree_hal_metal_buffer_vtable)) return NULL;
+  const iree_hal_metal_buffer_t* buffer = iree_hal_metal_buffer_const_cast(base_buffer);
+  return buffer->release_callback.fn == fn ? buffer->release_callback.user_data : NULL;
+}
+
 id<MTLBuffer> iree_hal_metal_buffer_handle(const iree_hal_buffer_t* base_buffer) {
   const iree_hal_metal_buffer_t* buffer = iree_hal_metal_buffer_const_cast(base_buffer);
   return buffer->buffer;
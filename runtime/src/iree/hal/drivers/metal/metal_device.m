@@ -16,9 +16,10 @@
 #include "iree/hal/drivers/metal/nop_executable_cache.h"
 #include "iree/hal/drivers/metal/shared_event.h"
 #include "iree/hal/drivers/metal/staging_buffer.h"
+#include "iree/hal/drivers/metal/transient_pool.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
-#include "iree/hal/utils/memory_file.h"
 #include "iree/hal/utils/resource_set.h"
 
 typedef struct iree_hal_metal_device_t {
@@ -39,6 +40,10 @@ typedef struct iree_hal_metal_device_t {
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
+  // Placement heap pool servicing queue-ordered allocations or NULL if resources are hazard
+  // tracked (which placement heaps do not support).
+  iree_hal_metal_transient_pool_t* transient_pool;
+
   id<MTLDevice> device;
   // We only expose one single command queue for now. This simplifies synchronization.
   // We can relax this to support multiple queues when needed later.
@@ -139,6 +144,16 @@ static iree_status_t iree_hal_metal_device_create_internal(
         metal_device, params->queue_uniform_buffer_size, &device->staging_buffer);
   }
 
+  if (iree_status_is_ok(status) && params->resource_hazard_tracking_mode ==
+                                      IREE_HAL_METAL_RESOURCE_HAZARD_TRACKING_MODE_UNTRACKED) {
+    status = iree_hal_metal_transient_pool_create(metal_device,
+#if defined(IREE_PLATFORM_MACOS)
+                                                  metal_queue,
+#endif  // IREE_PLATFORM_MACOS
+                                                  IREE_HAL_METAL_TRANSIENT_POOL_HEAP_SIZE,
+                                                  host_allocator, &device->transient_pool);
+  }
+
   if (iree_status_is_ok(status)) {
     *out_device = (iree_hal_device_t*)device;
   } else {
@@ -171,6 +186,7 @@ static void iree_hal_metal_device_destroy(iree_hal_device_t* base_device) {
 
   iree_hal_metal_builtin_executable_destroy(device->builtin_executable);
 
+  iree_hal_metal_transient_pool_release(device->transient_pool);
   iree_hal_allocator_release(device->device_allocator);
   [device->command_buffer_descriptor release];  // -1
   [device->queue release];                      // -1
@@ -210,6 +226,9 @@ static void iree_hal_metal_replace_device_allocator(iree_hal_device_t* base_devi
 static iree_status_t iree_hal_metal_device_trim(iree_hal_device_t* base_device) {
   iree_hal_metal_device_t* device = iree_hal_metal_device_cast(base_device);
   iree_arena_block_pool_trim(&device->block_pool);
+  if (device->transient_pool) {
+    iree_hal_metal_transient_pool_trim(device->transient_pool);
+  }
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
@@ -288,13 +307,8 @@ static iree_status_t iree_hal_metal_device_import_file(iree_hal_device_t* base_d
                                                        iree_io_file_handle_t* handle,
                                                        iree_hal_external_file_flags_t flags,
                                                        iree_hal_file_t** out_file) {
-  if (iree_io_file_handle_type(handle) != IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    return iree_make_status(IREE_STATUS_UNAVAILABLE,
-                            "implementation does not support the external file type");
-  }
-  return iree_hal_memory_file_wrap(queue_affinity, access, handle,
-                                   iree_hal_device_allocator(base_device),
-                                   iree_hal_device_host_allocator(base_device), out_file);
+  return iree_hal_file_from_handle(iree_hal_device_allocator(base_device), queue_affinity, access,
+                                   handle, iree_hal_device_host_allocator(base_device), out_file);
 }
 
 static iree_status_t iree_hal_metal_device_create_semaphore(iree_hal_device_t* base_device,
@@ -325,21 +339,52 @@ static iree_status_t iree_hal_metal_device_queue_alloca(
     const iree_hal_semaphore_list_t signal_semaphore_list, iree_hal_allocator_pool_t pool,
     iree_hal_buffer_params_t params, iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list, iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(iree_hal_device_allocator(base_device),
-                                                          params, allocation_size, out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_metal_device_t* device = iree_hal_metal_device_cast(base_device);
+  *out_buffer = NULL;
+
+  // Private buffers are placed in heap memory whose prior users have completed or that the waits
+  // order after. Memory is reserved immediately and only the availability of the buffer is ordered
+  // on the queue so we don't block on the waits.
+  iree_hal_buffer_t* buffer = NULL;
+  if (device->transient_pool) {
+    IREE_RETURN_IF_ERROR(iree_hal_metal_transient_pool_alloca(
+        device->transient_pool, iree_hal_device_allocator(base_device), wait_semaphore_list,
+        &params, allocation_size, &buffer));
+  }
+  if (!buffer) {
+    // TODO(benvanik): queue-ordered allocations of dedicated buffers.
+    IREE_RETURN_IF_ERROR(
+        iree_hal_semaphore_list_wait(wait_semaphore_list, iree_infinite_timeout()));
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(iree_hal_device_allocator(base_device),
+                                                            params, allocation_size, out_buffer));
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
+    return iree_ok_status();
+  }
+
+  iree_status_t status = iree_hal_device_queue_barrier(base_device, queue_affinity,
+                                                       wait_semaphore_list, signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_metal_device_queue_dealloca(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list, iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  return iree_hal_device_queue_barrier(base_device, queue_affinity, wait_semaphore_list,
-                                       signal_semaphore_list);
+  iree_hal_metal_device_t* device = iree_hal_metal_device_cast(base_device);
+  IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(base_device, queue_affinity,
+                                                     wait_semaphore_list, signal_semaphore_list));
+
+  // Pooled memory is reusable by later allocations once the barrier completes. Buffers that did
+  // not come from the pool are freed when they are released.
+  if (device->transient_pool) {
+    iree_hal_metal_transient_pool_dealloca(device->transient_pool, signal_semaphore_list, buffer);
+  }
+  return iree_ok_status();
 }
 
 static iree_status_t iree_hal_metal_device_queue_read(
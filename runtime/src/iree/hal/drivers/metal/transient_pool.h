@@ -0,0 +1,84 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_METAL_TRANSIENT_POOL_H_
+#define IREE_HAL_DRIVERS_METAL_TRANSIENT_POOL_H_
+
+#import <Metal/Metal.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Default minimum size of the MTLHeaps allocated by transient pools.
+#if !defined(IREE_HAL_METAL_TRANSIENT_POOL_HEAP_SIZE)
+#define IREE_HAL_METAL_TRANSIENT_POOL_HEAP_SIZE (64 * 1024 * 1024)
+#endif  // !IREE_HAL_METAL_TRANSIENT_POOL_HEAP_SIZE
+
+// Places queue-ordered transient buffers at explicit offsets within large placement MTLHeaps.
+// Buffers whose lifetimes do not overlap on the queue timeline alias the same heap memory so that
+// the number and total size of Metal allocations are bounded by the peak transient memory usage
+// instead of the sum of all allocations made over the lifetime of the device.
+//
+// Ranges deallocated with iree_hal_metal_transient_pool_dealloca are reused once the timepoint the
+// deallocation signals has been reached or immediately by allocations that wait on that timepoint
+// (as the GPU will have completed all work using the prior buffer before any work using the new
+// one begins). Buffers that are released without being deallocated return their ranges to the pool
+// immediately as the HAL guarantees no work is in-flight using them.
+//
+// Only private (device-local, host-invisible) buffers are serviced. Placement heap resources are
+// never hazard tracked by Metal so the pool is only usable when the device does not request
+// tracked resources. Callers are expected to fall back to a dedicated allocation for other buffers.
+//
+// Thread-safe. Buffers allocated from the pool keep the pool alive.
+typedef struct iree_hal_metal_transient_pool_t iree_hal_metal_transient_pool_t;
+
+// Creates a transient pool that allocates heaps of at least |heap_size| bytes from |device|.
+// Allocations larger than half of the heap size are not serviced by the pool.
+iree_status_t iree_hal_metal_transient_pool_create(id<MTLDevice> device,
+#if defined(IREE_PLATFORM_MACOS)
+                                                   id<MTLCommandQueue> queue,
+#endif  // IREE_PLATFORM_MACOS
+                                                   iree_device_size_t heap_size,
+                                                   iree_allocator_t host_allocator,
+                                                   iree_hal_metal_transient_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+void iree_hal_metal_transient_pool_retain(iree_hal_metal_transient_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+void iree_hal_metal_transient_pool_release(iree_hal_metal_transient_pool_t* pool);
+
+// Returns ranges whose deallocation has completed to the pool and frees all heaps that have no
+// live allocations.
+void iree_hal_metal_transient_pool_trim(iree_hal_metal_transient_pool_t* pool);
+
+// Allocates a transient buffer from the pool that will be used by work waiting on
+// |wait_semaphore_list|. The buffer reports |device_allocator| as its allocator and is usable by
+// any work ordered after the wait semaphores are reached. If the pool cannot service the request
+// (unsupported parameters, sizes, or memory exhaustion) |out_buffer| is set to NULL and the caller
+// must perform the allocation another way.
+iree_status_t iree_hal_metal_transient_pool_alloca(
+    iree_hal_metal_transient_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    const iree_hal_semaphore_list_t wait_semaphore_list, const iree_hal_buffer_params_t* params,
+    iree_device_size_t allocation_size, iree_hal_buffer_t** out_buffer);
+
+// Schedules the memory of |buffer| for reuse once the first semaphore in |signal_semaphore_list|
+// reaches its payload value. The buffer contents are undefined after that point even if the
+// buffer is still referenced. Returns false if |buffer| was not allocated from |pool| or was
+// already deallocated.
+bool iree_hal_metal_transient_pool_dealloca(iree_hal_metal_transient_pool_t* pool,
+                                            const iree_hal_semaphore_list_t signal_semaphore_list,
+                                            iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_METAL_TRANSIENT_POOL_H_
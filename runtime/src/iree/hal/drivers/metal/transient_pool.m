@@ -0,0 +1,541 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/metal/transient_pool.h"
+
+#import <Metal/Metal.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/target_platform.h"
+#include "iree/base/tracing.h"
+#include "iree/hal/drivers/metal/metal_buffer.h"
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_ALLOCATION_TRACKING
+static const char* IREE_HAL_METAL_TRANSIENT_POOL_ID = "Metal/Transient";
+#endif  // IREE_TRACING_FEATURE_ALLOCATION_TRACKING
+
+// Resource options used for all heaps and buffers in the pool. Placement heap resources are not
+// hazard tracked.
+static const MTLResourceOptions IREE_HAL_METAL_TRANSIENT_POOL_RESOURCE_OPTIONS =
+    MTLResourceStorageModePrivate | MTLResourceHazardTrackingModeUntracked;
+
+// A byte range within a heap.
+typedef struct iree_hal_metal_transient_range_t {
+  iree_device_size_t offset;
+  iree_device_size_t length;
+} iree_hal_metal_transient_range_t;
+
+// A single placement MTLHeap buffers are placed into.
+typedef struct iree_hal_metal_transient_heap_t {
+  id<MTLHeap> heap;
+  iree_device_size_t size;
+  // Number of ranges allocated from the heap including those pending reuse.
+  iree_host_size_t live_count;
+  // Free ranges sorted by offset. Adjacent ranges are always coalesced so there are never more than
+  // |live_count| + 1 free ranges; capacity is reserved when allocating so that returning a range
+  // never fails.
+  iree_host_size_t free_capacity;
+  iree_host_size_t free_count;
+  iree_hal_metal_transient_range_t* free_ranges;
+} iree_hal_metal_transient_heap_t;
+
+// A deallocated range that is reusable once |semaphore| reaches |value|.
+typedef struct iree_hal_metal_transient_pending_t {
+  iree_hal_metal_transient_heap_t* heap;
+  iree_hal_metal_transient_range_t range;
+  iree_hal_semaphore_t* semaphore;  // retained
+  uint64_t value;
+} iree_hal_metal_transient_pending_t;
+
+// Tracks a buffer allocated from the pool. Owned by the buffer as the user data of its release
+// callback.
+typedef struct iree_hal_metal_transient_allocation_t {
+  iree_hal_metal_transient_pool_t* pool;  // retained
+  iree_hal_metal_transient_heap_t* heap;
+  // Range reserved for the buffer. The buffer is placed at an offset within it meeting its
+  // alignment requirements.
+  iree_hal_metal_transient_range_t range;
+  // True once the range has been handed off to the pending list by a deallocation and must not be
+  // returned when the buffer is released.
+  bool is_deallocated;
+} iree_hal_metal_transient_allocation_t;
+
+struct iree_hal_metal_transient_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+
+  id<MTLDevice> device;
+#if defined(IREE_PLATFORM_MACOS)
+  id<MTLCommandQueue> queue;
+#endif  // IREE_PLATFORM_MACOS
+
+  // Minimum size of each heap allocated.
+  iree_device_size_t heap_size;
+
+  iree_slim_mutex_t mutex;
+  iree_host_size_t heap_capacity IREE_GUARDED_BY(mutex);
+  iree_host_size_t heap_count IREE_GUARDED_BY(mutex);
+  iree_hal_metal_transient_heap_t** heaps IREE_GUARDED_BY(mutex);
+  iree_host_size_t pending_capacity IREE_GUARDED_BY(mutex);
+  iree_host_size_t pending_count IREE_GUARDED_BY(mutex);
+  iree_hal_metal_transient_pending_t* pending IREE_GUARDED_BY(mutex);
+};
+
+// Grows |*elements| to hold at least |minimum_capacity| elements.
+static iree_status_t iree_hal_metal_transient_pool_reserve(iree_allocator_t host_allocator,
+                                                           iree_host_size_t element_size,
+                                                           iree_host_size_t minimum_capacity,
+                                                           iree_host_size_t* capacity,
+                                                           void** elements) {
+  if (minimum_capacity <= *capacity) return iree_ok_status();
+  iree_host_size_t new_capacity =
+      iree_max(iree_max((iree_host_size_t)8, *capacity * 2), minimum_capacity);
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_realloc(host_allocator, new_capacity * element_size, elements));
+  *capacity = new_capacity;
+  return iree_ok_status();
+}
+
+iree_status_t iree_hal_metal_transient_pool_create(id<MTLDevice> device,
+#if defined(IREE_PLATFORM_MACOS)
+                                                   id<MTLCommandQueue> queue,
+#endif  // IREE_PLATFORM_MACOS
+                                                   iree_device_size_t heap_size,
+                                                   iree_allocator_t host_allocator,
+                                                   iree_hal_metal_transient_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_metal_transient_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  memset(pool, 0, sizeof(*pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->host_allocator = host_allocator;
+  pool->device = [device retain];  // +1
+#if defined(IREE_PLATFORM_MACOS)
+  pool->queue = [queue retain];  // +1
+#endif  // IREE_PLATFORM_MACOS
+  // Heaps must be valid allocations on their own.
+  pool->heap_size = iree_min(heap_size, (iree_device_size_t)device.maxBufferLength);
+  iree_slim_mutex_initialize(&pool->mutex);
+
+  *out_pool = pool;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_metal_transient_heap_free(iree_hal_metal_transient_pool_t* pool,
+                                               iree_hal_metal_transient_heap_t* heap) {
+  IREE_TRACE_FREE_NAMED(IREE_HAL_METAL_TRANSIENT_POOL_ID, (void*)heap->heap);
+  [heap->heap release];  // -1
+  iree_allocator_free(pool->host_allocator, heap->free_ranges);
+  iree_allocator_free(pool->host_allocator, heap);
+}
+
+static void iree_hal_metal_transient_pool_destroy(iree_hal_metal_transient_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = pool->host_allocator;
+
+  // All buffers retain the pool and have been released. Pending ranges may remain (such as when
+  // their deallocation never completed) but no buffer is using them anymore.
+  for (iree_host_size_t i = 0; i < pool->pending_count; ++i) {
+    iree_hal_semaphore_release(pool->pending[i].semaphore);
+  }
+  iree_allocator_free(host_allocator, pool->pending);
+  for (iree_host_size_t i = 0; i < pool->heap_count; ++i) {
+    iree_hal_metal_transient_heap_free(pool, pool->heaps[i]);
+  }
+  iree_allocator_free(host_allocator, pool->heaps);
+
+  iree_slim_mutex_deinitialize(&pool->mutex);
+#if defined(IREE_PLATFORM_MACOS)
+  [pool->queue release];  // -1
+#endif                     // IREE_PLATFORM_MACOS
+  [pool->device release];  // -1
+  iree_allocator_free(host_allocator, pool);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+void iree_hal_metal_transient_pool_retain(iree_hal_metal_transient_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+void iree_hal_metal_transient_pool_release(iree_hal_metal_transient_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_metal_transient_pool_destroy(pool);
+  }
+}
+
+// Takes a range of |length| bytes aligned to |alignment| from the free ranges of |heap|. Sets
+// |out_found| to false if no free range is large enough.
+static iree_status_t iree_hal_metal_transient_heap_take(iree_hal_metal_transient_pool_t* pool,
+                                                        iree_hal_metal_transient_heap_t* heap,
+                                                        iree_device_size_t length,
+                                                        iree_device_size_t alignment,
+                                                        iree_hal_metal_transient_range_t* out_range,
+                                                        bool* out_found) {
+  *out_found = false;
+
+  // Ensure returning any range (including the new one) will not need to grow.
+  IREE_RETURN_IF_ERROR(iree_hal_metal_transient_pool_reserve(
+      pool->host_allocator, sizeof(heap->free_ranges[0]), heap->live_count + 2,
+      &heap->free_capacity, (void**)&heap->free_ranges));
+
+  for (iree_host_size_t i = 0; i < heap->free_count; ++i) {
+    iree_hal_metal_transient_range_t range = heap->free_ranges[i];
+    const iree_device_size_t range_end = range.offset + range.length;
+    const iree_device_size_t offset = iree_device_align(range.offset, alignment);
+    if (offset > range_end || range_end - offset < length) continue;
+    const iree_device_size_t head_length = offset - range.offset;
+    const iree_device_size_t tail_length = range_end - (offset + length);
+    if (head_length && tail_length) {
+      memmove(&heap->free_ranges[i + 2], &heap->free_ranges[i + 1],
+              (heap->free_count - i - 1) * sizeof(heap->free_ranges[0]));
+      ++heap->free_count;
+      heap->free_ranges[i].length = head_length;
+      heap->free_ranges[i + 1].offset = offset + length;
+      heap->free_ranges[i + 1].length = tail_length;
+    } else if (head_length) {
+      heap->free_ranges[i].length = head_length;
+    } else if (tail_length) {
+      heap->free_ranges[i].offset = offset + length;
+      heap->free_ranges[i].length = tail_length;
+    } else {
+      memmove(&heap->free_ranges[i], &heap->free_ranges[i + 1],
+              (heap->free_count - i - 1) * sizeof(heap->free_ranges[0]));
+      --heap->free_count;
+    }
+    ++heap->live_count;
+    out_range->offset = offset;
+    out_range->length = length;
+    *out_found = true;
+    break;
+  }
+  return iree_ok_status();
+}
+
+// Returns |range| to the free ranges of |heap|, coalescing with neighbors.
+static void iree_hal_metal_transient_heap_give(iree_hal_metal_transient_heap_t* heap,
+                                               iree_hal_metal_transient_range_t range) {
+  iree_host_size_t i = 0;
+  while (i < heap->free_count && heap->free_ranges[i].offset < range.offset) {
+    ++i;
+  }
+  const bool merge_prev =
+      i > 0 && heap->free_ranges[i - 1].offset + heap->free_ranges[i - 1].length == range.offset;
+  const bool merge_next =
+      i < heap->free_count && range.offset + range.length == heap->free_ranges[i].offset;
+  if (merge_prev && merge_next) {
+    heap->free_ranges[i - 1].length += range.length + heap->free_ranges[i].length;
+    memmove(&heap->free_ranges[i], &heap->free_ranges[i + 1],
+            (heap->free_count - i - 1) * sizeof(heap->free_ranges[0]));
+    --heap->free_count;
+  } else if (merge_prev) {
+    heap->free_ranges[i - 1].length += range.length;
+  } else if (merge_next) {
+    heap->free_ranges[i].offset = range.offset;
+    heap->free_ranges[i].length += range.length;
+  } else {
+    IREE_ASSERT_LT(heap->free_count, heap->free_capacity);
+    memmove(&heap->free_ranges[i + 1], &heap->free_ranges[i],
+            (heap->free_count - i) * sizeof(heap->free_ranges[0]));
+    heap->free_ranges[i] = range;
+    ++heap->free_count;
+  }
+  --heap->live_count;
+}
+
+// Returns all pending ranges whose deallocation has completed to their heaps. Ranges whose
+// semaphores have failed are kept as the GPU may still be using them.
+static void iree_hal_metal_transient_pool_reclaim_locked(iree_hal_metal_transient_pool_t* pool) {
+  iree_host_size_t i = 0;
+  while (i < pool->pending_count) {
+    iree_hal_metal_transient_pending_t* pending = &pool->pending[i];
+    uint64_t value = 0;
+    iree_status_t status = iree_hal_semaphore_query(pending->semaphore, &value);
+    if (!iree_status_is_ok(status) || value < pending->value) {
+      iree_status_ignore(status);
+      ++i;
+      continue;
+    }
+    iree_hal_metal_transient_heap_give(pending->heap, pending->range);
+    iree_hal_semaphore_release(pending->semaphore);
+    pool->pending[i] = pool->pending[--pool->pending_count];
+  }
+}
+
+// Returns true if work waiting on |wait_semaphore_list| is ordered after |pending| has been
+// deallocated.
+static bool iree_hal_metal_transient_pending_is_ordered_before(
+    const iree_hal_metal_transient_pending_t* pending,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    if (wait_semaphore_list.semaphores[i] == pending->semaphore &&
+        wait_semaphore_list.payload_values[i] >= pending->value) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reserves a range for a buffer with the given |size_and_align| from the pool, allocating a new
+// heap if needed. Sets |out_found| to false if the pool cannot allocate more memory.
+static iree_status_t iree_hal_metal_transient_pool_reserve_range_locked(
+    iree_hal_metal_transient_pool_t* pool, const iree_hal_semaphore_list_t wait_semaphore_list,
+    MTLSizeAndAlign size_and_align, iree_hal_metal_transient_heap_t** out_heap,
+    iree_hal_metal_transient_range_t* out_range, bool* out_found) {
+  *out_found = false;
+  iree_hal_metal_transient_pool_reclaim_locked(pool);
+
+  // Try free ranges in existing heaps first.
+  for (iree_host_size_t i = 0; i < pool->heap_count; ++i) {
+    iree_hal_metal_transient_heap_t* heap = pool->heaps[i];
+    IREE_RETURN_IF_ERROR(iree_hal_metal_transient_heap_take(
+        pool, heap, size_and_align.size, size_and_align.align, out_range, out_found));
+    if (*out_found) {
+      *out_heap = heap;
+      return iree_ok_status();
+    }
+  }
+
+  // Alias a range still pending deallocation if the new allocation is queue ordered after it. The
+  // whole range is reserved to avoid tracking the remainder separately so only ranges close in size
+  // are considered.
+  for (iree_host_size_t i = 0; i < pool->pending_count; ++i) {
+    iree_hal_metal_transient_pending_t* pending = &pool->pending[i];
+    if (pending->range.length > size_and_align.size * 2 ||
+        !iree_hal_metal_transient_pending_is_ordered_before(pending, wait_semaphore_list)) {
+      continue;
+    }
+    const iree_device_size_t range_end = pending->range.offset + pending->range.length;
+    const iree_device_size_t offset =
+        iree_device_align(pending->range.offset, size_and_align.align);
+    if (offset > range_end || range_end - offset < size_and_align.size) continue;
+    *out_heap = pending->heap;
+    *out_range = pending->range;
+    *out_found = true;
+    iree_hal_semaphore_release(pending->semaphore);
+    pool->pending[i] = pool->pending[--pool->pending_count];
+    return iree_ok_status();
+  }
+
+  // Allocate a new heap.
+  IREE_RETURN_IF_ERROR(iree_hal_metal_transient_pool_reserve(
+      pool->host_allocator, sizeof(pool->heaps[0]), pool->heap_count + 1, &pool->heap_capacity,
+      (void**)&pool->heaps));
+  iree_hal_metal_transient_heap_t* heap = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_allocator_malloc(pool->host_allocator, sizeof(*heap), (void**)&heap));
+  memset(heap, 0, sizeof(*heap));
+  heap->size = iree_max(pool->heap_size, (iree_device_size_t)size_and_align.size);
+  iree_status_t status =
+      iree_hal_metal_transient_pool_reserve(pool->host_allocator, sizeof(heap->free_ranges[0]), 2,
+                                            &heap->free_capacity, (void**)&heap->free_ranges);
+  if (iree_status_is_ok(status)) {
+    MTLHeapDescriptor* descriptor = [MTLHeapDescriptor new];  // +1
+    descriptor.type = MTLHeapTypePlacement;
+    descriptor.resourceOptions = IREE_HAL_METAL_TRANSIENT_POOL_RESOURCE_OPTIONS;
+    descriptor.size = heap->size;
+    heap->heap = [pool->device newHeapWithDescriptor:descriptor];  // +1
+    [descriptor release];                                          // -1
+  }
+  if (!iree_status_is_ok(status) || !heap->heap) {
+    // Device memory exhaustion is not an error here as the caller can still try to allocate a
+    // dedicated buffer.
+    iree_allocator_free(pool->host_allocator, heap->free_ranges);
+    iree_allocator_free(pool->host_allocator, heap);
+    return status;
+  }
+  IREE_TRACE_ALLOC_NAMED(IREE_HAL_METAL_TRANSIENT_POOL_ID, (void*)heap->heap, heap->size);
+  heap->free_ranges[0].offset = 0;
+  heap->free_ranges[0].length = heap->size;
+  heap->free_count = 1;
+  pool->heaps[pool->heap_count++] = heap;
+
+  IREE_RETURN_IF_ERROR(iree_hal_metal_transient_heap_take(
+      pool, heap, size_and_align.size, size_and_align.align, out_range, out_found));
+  *out_heap = heap;
+  return iree_ok_status();
+}
+
+void iree_hal_metal_transient_pool_trim(iree_hal_metal_transient_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&pool->mutex);
+
+  iree_hal_metal_transient_pool_reclaim_locked(pool);
+  iree_host_size_t i = 0;
+  while (i < pool->heap_count) {
+    iree_hal_metal_transient_heap_t* heap = pool->heaps[i];
+    if (heap->live_count == 0) {
+      iree_hal_metal_transient_heap_free(pool, heap);
+      pool->heaps[i] = pool->heaps[--pool->heap_count];
+    } else {
+      ++i;
+    }
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)pool->heap_count);
+
+  iree_slim_mutex_unlock(&pool->mutex);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Releases the allocation of a pooled buffer. Called when the buffer is destroyed right before the
+// MTLBuffer placed in the heap is released.
+static void iree_hal_metal_transient_pool_buffer_release(void* user_data,
+                                                         iree_hal_buffer_t* buffer) {
+  iree_hal_metal_transient_allocation_t* allocation =
+      (iree_hal_metal_transient_allocation_t*)user_data;
+  iree_hal_metal_transient_pool_t* pool = allocation->pool;
+  IREE_TRACE_FREE_NAMED(IREE_HAL_METAL_TRANSIENT_POOL_ID,
+                        buffer ? (void*)iree_hal_metal_buffer_handle(buffer) : NULL);
+
+  // Ranges that were not deallocated on a queue are immediately reusable as the buffer is no longer
+  // used by any work.
+  iree_slim_mutex_lock(&pool->mutex);
+  if (!allocation->is_deallocated) {
+    iree_hal_metal_transient_heap_give(allocation->heap, allocation->range);
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  iree_allocator_free(pool->host_allocator, allocation);
+  iree_hal_metal_transient_pool_release(pool);
+}
+
+iree_status_t iree_hal_metal_transient_pool_alloca(
+    iree_hal_metal_transient_pool_t* pool, iree_hal_allocator_t* device_allocator,
+    const iree_hal_semaphore_list_t wait_semaphore_list, const iree_hal_buffer_params_t* params,
+    iree_device_size_t allocation_size, iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+
+  // Only device-local buffers that will never be mapped or shared can be placed in private heaps.
+  iree_hal_buffer_params_t buffer_params = *params;
+  iree_hal_buffer_params_canonicalize(&buffer_params);
+  buffer_params.type &= ~IREE_HAL_MEMORY_TYPE_OPTIMAL;
+  if (!iree_all_bits_set(buffer_params.type, IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) ||
+      iree_any_bit_set(buffer_params.type, IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) ||
+      iree_any_bit_set(buffer_params.usage,
+                       IREE_HAL_BUFFER_USAGE_MAPPING | IREE_HAL_BUFFER_USAGE_SHARING_EXPORT)) {
+    return iree_ok_status();
+  }
+
+  // Match the sizing rules of the direct allocator.
+  if (allocation_size == 0) allocation_size = 4;
+  allocation_size = iree_device_align(allocation_size, 4);
+  if (allocation_size > pool->heap_size / 2) return iree_ok_status();
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)allocation_size);
+
+  const MTLResourceOptions options = IREE_HAL_METAL_TRANSIENT_POOL_RESOURCE_OPTIONS;
+  MTLSizeAndAlign size_and_align = [pool->device heapBufferSizeAndAlignWithLength:allocation_size
+                                                                          options:options];
+
+  iree_hal_metal_transient_allocation_t* allocation = NULL;
+  iree_status_t status =
+      iree_allocator_malloc(pool->host_allocator, sizeof(*allocation), (void**)&allocation);
+  bool found = false;
+  if (iree_status_is_ok(status)) {
+    memset(allocation, 0, sizeof(*allocation));
+    iree_slim_mutex_lock(&pool->mutex);
+    status = iree_hal_metal_transient_pool_reserve_range_locked(
+        pool, wait_semaphore_list, size_and_align, &allocation->heap, &allocation->range, &found);
+    iree_slim_mutex_unlock(&pool->mutex);
+  }
+  if (!iree_status_is_ok(status) || !found) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "pool exhausted");
+    iree_allocator_free(pool->host_allocator, allocation);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  allocation->pool = pool;
+  iree_hal_metal_transient_pool_retain(pool);
+
+  // Place the buffer within its range. Any prior buffers placed in the same range are no longer in
+  // use by the time work using this buffer runs so they are safe to alias.
+  id<MTLBuffer> metal_buffer = [allocation->heap->heap
+      newBufferWithLength:allocation_size
+                  options:options
+                   offset:iree_device_align(allocation->range.offset, size_and_align.align)];  // +1
+  if (!metal_buffer) {
+    iree_hal_metal_transient_pool_buffer_release(allocation, NULL);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // Wrap the buffer; from here on the release callback owns the allocation.
+  iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_hal_metal_transient_pool_buffer_release,
+      .user_data = allocation,
+  };
+  iree_hal_buffer_t* buffer = NULL;
+  status = iree_hal_metal_buffer_wrap(
+#if defined(IREE_PLATFORM_MACOS)
+      pool->queue,
+#endif  // IREE_PLATFORM_MACOS
+      metal_buffer, device_allocator, buffer_params.type, buffer_params.access, buffer_params.usage,
+      allocation_size, /*byte_offset=*/0, /*byte_length=*/allocation_size, release_callback,
+      &buffer);  // +1
+  if (iree_status_is_ok(status)) {
+    IREE_TRACE_ALLOC_NAMED(IREE_HAL_METAL_TRANSIENT_POOL_ID, (void*)metal_buffer, allocation_size);
+    *out_buffer = buffer;
+  } else {
+    iree_hal_metal_transient_pool_buffer_release(allocation, NULL);
+  }
+  [metal_buffer release];  // -1
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+bool iree_hal_metal_transient_pool_dealloca(iree_hal_metal_transient_pool_t* pool,
+                                            const iree_hal_semaphore_list_t signal_semaphore_list,
+                                            iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_metal_transient_allocation_t* allocation =
+      (iree_hal_metal_transient_allocation_t*)iree_hal_metal_buffer_release_user_data(
+          iree_hal_buffer_allocated_buffer(buffer), iree_hal_metal_transient_pool_buffer_release);
+  if (!allocation || allocation->pool != pool) return false;
+
+  // Without a timepoint to order reuse against the range is returned when the buffer is released.
+  if (signal_semaphore_list.count == 0) return false;
+
+  iree_slim_mutex_lock(&pool->mutex);
+  bool scheduled = false;
+  if (!allocation->is_deallocated) {
+    iree_status_t status = iree_hal_metal_transient_pool_reserve(
+        pool->host_allocator, sizeof(pool->pending[0]), pool->pending_count + 1,
+        &pool->pending_capacity, (void**)&pool->pending);
+    if (iree_status_is_ok(status)) {
+      iree_hal_metal_transient_pending_t* pending = &pool->pending[pool->pending_count++];
+      pending->heap = allocation->heap;
+      pending->range = allocation->range;
+      pending->semaphore = signal_semaphore_list.semaphores[0];
+      iree_hal_semaphore_retain(pending->semaphore);
+      pending->value = signal_semaphore_list.payload_values[0];
+      allocation->is_deallocated = true;
+      scheduled = true;
+    } else {
+      // Falls back to returning the range when the buffer is released.
+      iree_status_ignore(status);
+    }
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  return scheduled;
+}
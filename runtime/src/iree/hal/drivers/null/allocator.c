@@ -109,6 +109,15 @@ static void iree_hal_null_allocator_query_statistics(
   });
 }
 
+static void iree_hal_null_allocator_reset_capture_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  IREE_STATISTICS({
+    iree_hal_null_allocator_t* allocator =
+        iree_hal_null_allocator_cast(base_allocator);
+    iree_hal_allocator_statistics_reset_capture(&allocator->statistics);
+  });
+}
+
 static iree_status_t iree_hal_null_allocator_query_memory_heaps(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_host_size_t capacity,
@@ -329,6 +338,7 @@ static const iree_hal_allocator_vtable_t iree_hal_null_allocator_vtable = {
     .host_allocator = iree_hal_null_allocator_host_allocator,
     .trim = iree_hal_null_allocator_trim,
     .query_statistics = iree_hal_null_allocator_query_statistics,
+    .reset_capture_statistics = iree_hal_null_allocator_reset_capture_statistics,
     .query_memory_heaps = iree_hal_null_allocator_query_memory_heaps,
     .query_buffer_compatibility =
         iree_hal_null_allocator_query_buffer_compatibility,
@@ -213,6 +213,11 @@ typedef uint32_t iree_hal_vulkan_device_flags_t;
 typedef struct iree_hal_vulkan_device_options_t {
   // Flags controlling device behavior.
   iree_hal_vulkan_device_flags_t flags;
+  // Directory where pipeline caches are persisted across processes.
+  // Each physical device and driver version gets its own cache file so the
+  // directory can be shared by heterogeneous devices. When empty pipelines are
+  // recreated from SPIR-V each time a process prepares its executables.
+  iree_string_view_t pipeline_cache_path;
 } iree_hal_vulkan_device_options_t;
 
 IREE_API_EXPORT void iree_hal_vulkan_device_options_initialize(
@@ -99,7 +99,8 @@ iree_status_t iree_hal_vulkan_query_memory_heaps(
 typedef struct iree_hal_vulkan_base_buffer_t {
   iree_hal_buffer_t base;
   // NOTE: may be VK_NULL_HANDLE if sparse residency is used to back the buffer
-  // with multiple device memory allocations.
+  // with multiple device memory allocations or if the buffer is suballocated
+  // from a larger device memory allocation.
   VkDeviceMemory device_memory;
   VkBuffer handle;
 } iree_hal_vulkan_base_buffer_t;
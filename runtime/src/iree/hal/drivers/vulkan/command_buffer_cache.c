@@ -0,0 +1,150 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/vulkan/command_buffer_cache.h"
+
+#include <string.h>
+
+void iree_hal_vulkan_command_buffer_cache_initialize(
+    iree_allocator_t host_allocator,
+    iree_hal_vulkan_command_buffer_cache_t* out_cache) {
+  IREE_ASSERT_ARGUMENT(out_cache);
+  memset(out_cache, 0, sizeof(*out_cache));
+  out_cache->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&out_cache->mutex);
+}
+
+void iree_hal_vulkan_command_buffer_cache_deinitialize(
+    iree_hal_vulkan_command_buffer_cache_t* cache) {
+  IREE_ASSERT_ARGUMENT(cache);
+  iree_hal_vulkan_command_buffer_cache_trim(cache);
+  iree_slim_mutex_deinitialize(&cache->mutex);
+}
+
+static void iree_hal_vulkan_command_buffer_cache_entry_deinitialize(
+    iree_allocator_t host_allocator,
+    iree_hal_vulkan_command_buffer_cache_entry_t* entry) {
+  iree_hal_command_buffer_release(entry->translated);
+  iree_hal_command_buffer_release(entry->source);
+  iree_allocator_free(host_allocator, entry->bindings);
+  memset(entry, 0, sizeof(*entry));
+}
+
+// Removes the entry at |index| by swapping in the last entry. The entry must
+// have been deinitialized or moved out.
+static void iree_hal_vulkan_command_buffer_cache_remove_locked(
+    iree_hal_vulkan_command_buffer_cache_t* cache, iree_host_size_t index) {
+  cache->entries[index] = cache->entries[--cache->entry_count];
+}
+
+void iree_hal_vulkan_command_buffer_cache_trim(
+    iree_hal_vulkan_command_buffer_cache_t* cache) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&cache->mutex);
+  for (iree_host_size_t i = 0; i < cache->entry_count; ++i) {
+    iree_hal_vulkan_command_buffer_cache_entry_deinitialize(
+        cache->host_allocator, &cache->entries[i]);
+  }
+  cache->entry_count = 0;
+  iree_slim_mutex_unlock(&cache->mutex);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static bool iree_hal_vulkan_command_buffer_cache_entry_matches(
+    const iree_hal_vulkan_command_buffer_cache_entry_t* entry,
+    iree_hal_command_buffer_t* source,
+    iree_hal_buffer_binding_table_t binding_table) {
+  if (entry->source != source) return false;
+  if (entry->binding_count != binding_table.count) return false;
+  for (iree_host_size_t i = 0; i < binding_table.count; ++i) {
+    const iree_hal_buffer_binding_t* lhs = &entry->bindings[i];
+    const iree_hal_buffer_binding_t* rhs = &binding_table.bindings[i];
+    if (lhs->buffer != rhs->buffer || lhs->offset != rhs->offset ||
+        lhs->length != rhs->length) {
+      return false;
+    }
+  }
+  return true;
+}
+
+iree_hal_command_buffer_t* iree_hal_vulkan_command_buffer_cache_acquire(
+    iree_hal_vulkan_command_buffer_cache_t* cache,
+    iree_hal_command_buffer_t* source,
+    iree_hal_buffer_binding_table_t binding_table) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(source);
+  iree_hal_command_buffer_t* translated = NULL;
+  iree_slim_mutex_lock(&cache->mutex);
+  for (iree_host_size_t i = 0; i < cache->entry_count; ++i) {
+    iree_hal_vulkan_command_buffer_cache_entry_t* entry = &cache->entries[i];
+    if (!iree_hal_vulkan_command_buffer_cache_entry_matches(entry, source,
+                                                            binding_table)) {
+      continue;
+    }
+    // Transfer the translated command buffer reference to the caller.
+    translated = entry->translated;
+    entry->translated = NULL;
+    iree_hal_vulkan_command_buffer_cache_entry_deinitialize(
+        cache->host_allocator, entry);
+    iree_hal_vulkan_command_buffer_cache_remove_locked(cache, i);
+    break;
+  }
+  iree_slim_mutex_unlock(&cache->mutex);
+  return translated;
+}
+
+void iree_hal_vulkan_command_buffer_cache_release(
+    iree_hal_vulkan_command_buffer_cache_t* cache,
+    iree_hal_command_buffer_t* source,
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_hal_command_buffer_t* translated) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(source);
+  IREE_ASSERT_ARGUMENT(translated);
+
+  // Copy the binding table outside of the lock.
+  iree_hal_buffer_binding_t* bindings = NULL;
+  if (binding_table.count > 0) {
+    iree_status_t status = iree_allocator_malloc(
+        cache->host_allocator, binding_table.count * sizeof(bindings[0]),
+        (void**)&bindings);
+    if (!iree_status_is_ok(status)) {
+      // Not fatal; we'll just record the command buffer again next time.
+      iree_status_ignore(status);
+      return;
+    }
+    memcpy(bindings, binding_table.bindings,
+           binding_table.count * sizeof(bindings[0]));
+  }
+
+  iree_slim_mutex_lock(&cache->mutex);
+
+  // Evict the least recently used entry if full.
+  if (cache->entry_count == IREE_ARRAYSIZE(cache->entries)) {
+    iree_host_size_t lru_index = 0;
+    for (iree_host_size_t i = 1; i < cache->entry_count; ++i) {
+      if (cache->entries[i].epoch < cache->entries[lru_index].epoch) {
+        lru_index = i;
+      }
+    }
+    iree_hal_vulkan_command_buffer_cache_entry_deinitialize(
+        cache->host_allocator, &cache->entries[lru_index]);
+    iree_hal_vulkan_command_buffer_cache_remove_locked(cache, lru_index);
+  }
+
+  iree_hal_vulkan_command_buffer_cache_entry_t* entry =
+      &cache->entries[cache->entry_count++];
+  entry->source = source;
+  iree_hal_command_buffer_retain(source);
+  entry->translated = translated;
+  iree_hal_command_buffer_retain(translated);
+  entry->binding_count = binding_table.count;
+  entry->bindings = bindings;
+  entry->epoch = ++cache->epoch;
+
+  iree_slim_mutex_unlock(&cache->mutex);
+}
@@ -0,0 +1,95 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_VULKAN_COMMAND_BUFFER_CACHE_H_
+#define IREE_HAL_DRIVERS_VULKAN_COMMAND_BUFFER_CACHE_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of translated command buffers retained by a cache.
+#if !defined(IREE_HAL_VULKAN_COMMAND_BUFFER_CACHE_CAPACITY)
+#define IREE_HAL_VULKAN_COMMAND_BUFFER_CACHE_CAPACITY 16
+#endif  // !IREE_HAL_VULKAN_COMMAND_BUFFER_CACHE_CAPACITY
+
+// A translated command buffer and the binding table it was recorded with.
+typedef struct iree_hal_vulkan_command_buffer_cache_entry_t {
+  // Reusable command buffer (usually deferred) that was translated.
+  iree_hal_command_buffer_t* source;  // retained
+  // Native command buffer recorded from |source| with the bindings.
+  iree_hal_command_buffer_t* translated;  // retained
+  // Copy of the binding table resolved into |translated|. Buffers are retained
+  // by |translated| and cannot be reallocated while cached.
+  iree_host_size_t binding_count;
+  iree_hal_buffer_binding_t* bindings;
+  // Last use epoch for LRU eviction.
+  uint64_t epoch;
+} iree_hal_vulkan_command_buffer_cache_entry_t;
+
+// Caches native command buffers translated from reusable command buffers with
+// indirect bindings so that re-executing them with the same binding table
+// resubmits the previously recorded VkCommandBuffer instead of recording it
+// again. This makes replaying memoized command buffers with stable bindings
+// free on the host.
+//
+// Entries are acquired for exclusive use during a submission and released back
+// into the cache once it has completed so a VkCommandBuffer is never pending
+// execution more than once.
+//
+// Thread-safe.
+typedef struct iree_hal_vulkan_command_buffer_cache_t {
+  iree_allocator_t host_allocator;
+  iree_slim_mutex_t mutex;
+  uint64_t epoch IREE_GUARDED_BY(mutex);
+  iree_host_size_t entry_count IREE_GUARDED_BY(mutex);
+  iree_hal_vulkan_command_buffer_cache_entry_t
+      entries[IREE_HAL_VULKAN_COMMAND_BUFFER_CACHE_CAPACITY] IREE_GUARDED_BY(
+          mutex);
+} iree_hal_vulkan_command_buffer_cache_t;
+
+// Initializes |out_cache| in-place.
+void iree_hal_vulkan_command_buffer_cache_initialize(
+    iree_allocator_t host_allocator,
+    iree_hal_vulkan_command_buffer_cache_t* out_cache);
+
+// Deinitializes |cache| and releases all entries.
+void iree_hal_vulkan_command_buffer_cache_deinitialize(
+    iree_hal_vulkan_command_buffer_cache_t* cache);
+
+// Releases all entries in the cache.
+void iree_hal_vulkan_command_buffer_cache_trim(
+    iree_hal_vulkan_command_buffer_cache_t* cache);
+
+// Acquires the command buffer translated from |source| with |binding_table|
+// and removes it from the cache. Returns NULL if none is cached. The returned
+// command buffer is retained and the caller must release it once done (after
+// optionally returning it with iree_hal_vulkan_command_buffer_cache_release).
+iree_hal_command_buffer_t* iree_hal_vulkan_command_buffer_cache_acquire(
+    iree_hal_vulkan_command_buffer_cache_t* cache,
+    iree_hal_command_buffer_t* source,
+    iree_hal_buffer_binding_table_t binding_table);
+
+// Inserts |translated| as recorded from |source| with |binding_table| and
+// retains both command buffers until evicted. Must only be called once all
+// submissions of |translated| have completed. The least recently used entry is
+// evicted if the cache is full. Failures to insert are not fatal and just
+// prevent reuse.
+void iree_hal_vulkan_command_buffer_cache_release(
+    iree_hal_vulkan_command_buffer_cache_t* cache,
+    iree_hal_command_buffer_t* source,
+    iree_hal_buffer_binding_table_t binding_table,
+    iree_hal_command_buffer_t* translated);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_VULKAN_COMMAND_BUFFER_CACHE_H_
@@ -22,6 +22,10 @@ namespace {
 // chaining in the command buffer when pools run out.
 static constexpr int kMaxDescriptorSets = 4096;
 
+// Maximum number of reset pools retained for reuse. Pools released beyond this
+// are destroyed.
+static constexpr size_t kMaxFreeDescriptorPools = 64;
+
 }  // namespace
 
 DescriptorSetGroup::~DescriptorSetGroup() {
@@ -42,14 +46,33 @@ iree_status_t DescriptorSetGroup::Reset() {
 }
 
 DescriptorPoolCache::DescriptorPoolCache(VkDeviceHandle* logical_device)
-    : logical_device_(logical_device) {}
+    : logical_device_(logical_device) {
+  iree_slim_mutex_initialize(&mutex_);
+}
+
+DescriptorPoolCache::~DescriptorPoolCache() {
+  Trim();
+  iree_slim_mutex_deinitialize(&mutex_);
+}
 
 iree_status_t DescriptorPoolCache::AcquireDescriptorPool(
     VkDescriptorType descriptor_type, int max_descriptor_count,
     DescriptorPool* out_descriptor_pool) {
   IREE_TRACE_SCOPE_NAMED("DescriptorPoolCache::AcquireDescriptorPool");
 
-  // TODO(benvanik): lookup in cache.
+  // Reuse a previously released pool of the same shape, if any.
+  iree_slim_mutex_lock(&mutex_);
+  for (size_t i = free_pools_.size(); i > 0; --i) {
+    const DescriptorPool& free_pool = free_pools_[i - 1];
+    if (free_pool.descriptor_type == descriptor_type &&
+        free_pool.max_descriptor_count == max_descriptor_count) {
+      *out_descriptor_pool = free_pool;
+      free_pools_.erase(free_pools_.begin() + (i - 1));
+      iree_slim_mutex_unlock(&mutex_);
+      return iree_ok_status();
+    }
+  }
+  iree_slim_mutex_unlock(&mutex_);
 
   VkDescriptorPoolCreateInfo create_info;
   create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
@@ -64,6 +87,7 @@ iree_status_t DescriptorPoolCache::AcquireDescriptorPool(
 
   DescriptorPool descriptor_pool;
   descriptor_pool.descriptor_type = descriptor_type;
+  descriptor_pool.max_descriptor_count = max_descriptor_count;
   descriptor_pool.handle = VK_NULL_HANDLE;
 
   VK_RETURN_IF_ERROR(syms().vkCreateDescriptorPool(
@@ -87,14 +111,33 @@ iree_status_t DescriptorPoolCache::ReleaseDescriptorPools(
                                                     descriptor_pool.handle, 0),
                        "vkResetDescriptorPool");
 
-    // TODO(benvanik): release to cache.
-    syms().vkDestroyDescriptorPool(*logical_device_, descriptor_pool.handle,
-                                   logical_device_->allocator());
+    iree_slim_mutex_lock(&mutex_);
+    const bool retain = free_pools_.size() < kMaxFreeDescriptorPools;
+    if (retain) free_pools_.push_back(descriptor_pool);
+    iree_slim_mutex_unlock(&mutex_);
+    if (!retain) {
+      syms().vkDestroyDescriptorPool(*logical_device_, descriptor_pool.handle,
+                                     logical_device_->allocator());
+    }
   }
 
   return iree_ok_status();
 }
 
+void DescriptorPoolCache::Trim() {
+  IREE_TRACE_SCOPE_NAMED("DescriptorPoolCache::Trim");
+
+  iree_slim_mutex_lock(&mutex_);
+  std::vector<DescriptorPool> free_pools;
+  free_pools.swap(free_pools_);
+  iree_slim_mutex_unlock(&mutex_);
+
+  for (const auto& descriptor_pool : free_pools) {
+    syms().vkDestroyDescriptorPool(*logical_device_, descriptor_pool.handle,
+                                   logical_device_->allocator());
+  }
+}
+
 }  // namespace vulkan
 }  // namespace hal
 }  // namespace iree
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/drivers/vulkan/dynamic_symbols.h"
 #include "iree/hal/drivers/vulkan/handle_util.h"
 #include "iree/hal/drivers/vulkan/util/ref_ptr.h"
@@ -28,6 +29,8 @@ class DescriptorPoolCache;
 struct DescriptorPool {
   // Type of the descriptor in the set.
   VkDescriptorType descriptor_type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+  // Maximum number of descriptors in each set allocated from the pool.
+  int max_descriptor_count = 0;
   // Pool handle.
   VkDescriptorPool handle = VK_NULL_HANDLE;
 };
@@ -66,9 +69,15 @@ class DescriptorSetGroup final {
 // resources. After the descriptors in the pool are no longer used (all
 // command buffers using descriptor sets allocated from the pool have retired)
 // the pool is returned here to be reused in the future.
+//
+// Released pools are reset and retained keyed by their descriptor type and
+// count such that steady-state recording does not create or destroy pools.
+//
+// Thread-safe: pools may be acquired and released from multiple threads.
 class DescriptorPoolCache final {
  public:
   explicit DescriptorPoolCache(VkDeviceHandle* logical_device);
+  ~DescriptorPoolCache();
 
   VkDeviceHandle* logical_device() const { return logical_device_; }
   const DynamicSymbols& syms() const { return *logical_device_->syms(); }
@@ -86,8 +95,15 @@ class DescriptorPoolCache final {
   iree_status_t ReleaseDescriptorPools(
       const std::vector<DescriptorPool>& descriptor_pools);
 
+  // Destroys all pools retained for reuse.
+  void Trim();
+
  private:
   VkDeviceHandle* logical_device_;
+
+  iree_slim_mutex_t mutex_;
+  // Reset pools available for reuse.
+  std::vector<DescriptorPool> free_pools_ IREE_GUARDED_BY(mutex_);
 };
 
 }  // namespace vulkan
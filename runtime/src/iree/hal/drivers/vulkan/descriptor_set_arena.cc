@@ -7,6 +7,7 @@
 #include "iree/hal/drivers/vulkan/descriptor_set_arena.h"
 
 #include <cstddef>
+#include <cstring>
 #include <type_traits>
 #include <utility>
 
@@ -22,15 +23,9 @@ namespace vulkan {
 
 namespace {
 
-static void PopulateDescriptorSetWriteInfos(
+static void PopulateDescriptorBufferInfos(
     iree_host_size_t binding_count, const iree_hal_buffer_ref_t* bindings,
-    VkDescriptorSet dst_set, Arena* arena, iree_host_size_t* out_info_count,
-    VkWriteDescriptorSet** out_infos) {
-  arena->Reset();
-  auto buffer_infos =
-      arena->AllocateSpan<VkDescriptorBufferInfo>(binding_count);
-  auto write_infos = arena->AllocateSpan<VkWriteDescriptorSet>(binding_count);
-
+    VkDescriptorBufferInfo* buffer_infos) {
   for (int i = 0; i < binding_count; ++i) {
     const auto& binding = bindings[i];
 
@@ -66,7 +61,15 @@ static void PopulateDescriptorSetWriteInfos(
                                        binding.offset),
           4);
     }
+  }
+}
 
+static void PopulateDescriptorSetWriteInfos(
+    iree_host_size_t binding_count, const VkDescriptorBufferInfo* buffer_infos,
+    VkDescriptorSet dst_set, Arena* arena, iree_host_size_t* out_info_count,
+    VkWriteDescriptorSet** out_infos) {
+  auto write_infos = arena->AllocateSpan<VkWriteDescriptorSet>(binding_count);
+  for (int i = 0; i < binding_count; ++i) {
     auto& write_info = write_infos[i];
     write_info.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
     write_info.pNext = nullptr;
@@ -76,7 +79,7 @@ static void PopulateDescriptorSetWriteInfos(
     write_info.descriptorCount = 1;
     write_info.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
     write_info.pImageInfo = nullptr;
-    write_info.pBufferInfo = &buffer_info;
+    write_info.pBufferInfo = &buffer_infos[i];
     write_info.pTexelBufferView = nullptr;
   }
 
@@ -84,6 +87,27 @@ static void PopulateDescriptorSetWriteInfos(
   *out_infos = write_infos.data();
 }
 
+// Returns a 64-bit FNV-1a hash of a descriptor set's layout and contents.
+static uint64_t HashDescriptorSet(VkDescriptorSetLayout set_layout,
+                                  iree_host_size_t binding_count,
+                                  const VkDescriptorBufferInfo* buffer_infos) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  auto hash_bytes = [&hash](const void* data, size_t length) {
+    const uint8_t* bytes = (const uint8_t*)data;
+    for (size_t i = 0; i < length; ++i) {
+      hash ^= bytes[i];
+      hash *= 0x100000001B3ull;
+    }
+  };
+  hash_bytes(&set_layout, sizeof(set_layout));
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    hash_bytes(&buffer_infos[i].buffer, sizeof(buffer_infos[i].buffer));
+    hash_bytes(&buffer_infos[i].offset, sizeof(buffer_infos[i].offset));
+    hash_bytes(&buffer_infos[i].range, sizeof(buffer_infos[i].range));
+  }
+  return hash;
+}
+
 }  // namespace
 
 DescriptorSetArena::DescriptorSetArena(
@@ -114,6 +138,33 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
   IREE_TRACE_SCOPE_NAMED("DescriptorSetArena::BindDescriptorSet");
 
   auto* set_layout = iree_hal_vulkan_pipeline_layout_set(pipeline_layout, set);
+  VkDescriptorSetLayout set_layout_handle =
+      iree_hal_vulkan_descriptor_set_layout_handle(set_layout);
+
+  // Resolve the bindings and reuse an existing set if one was already written
+  // with the same contents.
+  scratch_arena_.Reset();
+  auto buffer_infos =
+      scratch_arena_.AllocateSpan<VkDescriptorBufferInfo>(binding_count);
+  PopulateDescriptorBufferInfos(binding_count, bindings, buffer_infos.data());
+  const uint64_t hash =
+      HashDescriptorSet(set_layout_handle, binding_count, buffer_infos.data());
+  auto it = cached_descriptor_sets_.find(hash);
+  if (it != cached_descriptor_sets_.end()) {
+    const CachedDescriptorSet& cached_set = it->second;
+    if (cached_set.set_layout == set_layout_handle &&
+        cached_set.buffer_info_count == binding_count &&
+        (binding_count == 0 ||
+         memcmp(&cached_buffer_infos_[cached_set.buffer_info_offset],
+                buffer_infos.data(),
+                binding_count * sizeof(VkDescriptorBufferInfo)) == 0)) {
+      syms().vkCmdBindDescriptorSets(
+          command_buffer, VK_PIPELINE_BIND_POINT_COMPUTE,
+          iree_hal_vulkan_pipeline_layout_handle(pipeline_layout), set, 1,
+          &cached_set.handle, 0, nullptr);
+      return iree_ok_status();
+    }
+  }
 
   // Pick a bucket based on the number of descriptors required.
   // NOTE: right now we are 1:1 with bindings.
@@ -141,8 +192,6 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
   allocate_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
   allocate_info.pNext = nullptr;
   allocate_info.descriptorPool = descriptor_pool.handle;
-  VkDescriptorSetLayout set_layout_handle =
-      iree_hal_vulkan_descriptor_set_layout_handle(set_layout);
   allocate_info.descriptorSetCount = 1;
   allocate_info.pSetLayouts = &set_layout_handle;
 
@@ -174,9 +223,9 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
   // Get a list of VkWriteDescriptorSet structs with all bound buffers.
   iree_host_size_t write_info_count = 0;
   VkWriteDescriptorSet* write_infos = NULL;
-  PopulateDescriptorSetWriteInfos(binding_count, bindings, descriptor_set,
-                                  &scratch_arena_, &write_info_count,
-                                  &write_infos);
+  PopulateDescriptorSetWriteInfos(binding_count, buffer_infos.data(),
+                                  descriptor_set, &scratch_arena_,
+                                  &write_info_count, &write_infos);
 
   // This is the reason why push descriptor sets are good.
   // We can't batch these effectively as we don't know prior to recording what
@@ -193,6 +242,16 @@ iree_status_t DescriptorSetArena::BindDescriptorSet(
       iree_hal_vulkan_pipeline_layout_handle(pipeline_layout), set, 1,
       &descriptor_set, 0, nullptr);
 
+  // Remember the set so that binding the same contents again is just a bind.
+  CachedDescriptorSet cached_set;
+  cached_set.set_layout = set_layout_handle;
+  cached_set.buffer_info_offset = cached_buffer_infos_.size();
+  cached_set.buffer_info_count = binding_count;
+  cached_set.handle = descriptor_set;
+  cached_buffer_infos_.insert(cached_buffer_infos_.end(), buffer_infos.data(),
+                              buffer_infos.data() + binding_count);
+  cached_descriptor_sets_[hash] = cached_set;
+
   return iree_ok_status();
 }
 
@@ -205,11 +264,15 @@ void DescriptorSetArena::PushDescriptorSet(
       iree_hal_vulkan_pipeline_layout_handle(pipeline_layout);
 
   // Get a list of VkWriteDescriptorSet structs with all bound buffers.
+  scratch_arena_.Reset();
+  auto buffer_infos =
+      scratch_arena_.AllocateSpan<VkDescriptorBufferInfo>(binding_count);
+  PopulateDescriptorBufferInfos(binding_count, bindings, buffer_infos.data());
   iree_host_size_t write_info_count = 0;
   VkWriteDescriptorSet* write_infos = NULL;
-  PopulateDescriptorSetWriteInfos(binding_count, bindings, VK_NULL_HANDLE,
-                                  &scratch_arena_, &write_info_count,
-                                  &write_infos);
+  PopulateDescriptorSetWriteInfos(binding_count, buffer_infos.data(),
+                                  VK_NULL_HANDLE, &scratch_arena_,
+                                  &write_info_count, &write_infos);
 
   // Fast path using push descriptors. These are pooled internally by the
   // command buffer and prevent the need for our own pooling mechanisms.
@@ -221,6 +284,10 @@ void DescriptorSetArena::PushDescriptorSet(
 DescriptorSetGroup DescriptorSetArena::Flush() {
   IREE_TRACE_SCOPE_NAMED("DescriptorSetArena::Flush");
 
+  // Sets are released with their pools.
+  cached_descriptor_sets_.clear();
+  cached_buffer_infos_.clear();
+
   if (used_descriptor_pools_.empty()) {
     // No resources to free.
     return DescriptorSetGroup{};
@@ -10,6 +10,7 @@
 #include <stdint.h>
 
 #include <array>
+#include <unordered_map>
 #include <vector>
 
 #include "iree/base/api.h"
@@ -27,6 +28,9 @@ namespace hal {
 namespace vulkan {
 
 // A reusable arena for allocating descriptor sets and batching updates.
+// Descriptor sets are reused when the same set layout and bindings are bound
+// multiple times between flushes (such as when the same dispatch is recorded
+// repeatedly) to avoid redundant allocations and updates.
 class DescriptorSetArena final {
  public:
   explicit DescriptorSetArena(DescriptorPoolCache* descriptor_pool_cache);
@@ -66,6 +70,21 @@ class DescriptorSetArena final {
 
   // All pools that have been used during allocation.
   std::vector<DescriptorPool> used_descriptor_pools_;
+
+  // A descriptor set allocated since the last flush. Sets are never updated
+  // after they are first written and remain valid until their pools are
+  // released so they can be rebound by any command with the same bindings.
+  struct CachedDescriptorSet {
+    VkDescriptorSetLayout set_layout;
+    // Range of |cached_buffer_infos_| the set was written with.
+    size_t buffer_info_offset;
+    size_t buffer_info_count;
+    VkDescriptorSet handle;
+  };
+  // Cached sets keyed by a hash of their layout and buffer infos. Colliding
+  // sets replace prior entries.
+  std::unordered_map<uint64_t, CachedDescriptorSet> cached_descriptor_sets_;
+  std::vector<VkDescriptorBufferInfo> cached_buffer_infos_;
 };
 
 }  // namespace vulkan
@@ -8,6 +8,7 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/inline_array.h"
@@ -27,6 +28,10 @@ using namespace iree::hal::vulkan;
 // Command buffer implementation that directly maps to VkCommandBuffer.
 // This records the commands on the calling thread without additional threading
 // indirection.
+// Maximum number of buffer barriers that can be merged into a single pending
+// barrier before it is flushed.
+#define IREE_HAL_VULKAN_MAX_PENDING_BUFFER_BARRIERS 16
+
 typedef struct iree_hal_vulkan_direct_command_buffer_t {
   iree_hal_command_buffer_t base;
   VkDeviceHandle* logical_device;
@@ -38,6 +43,26 @@ typedef struct iree_hal_vulkan_direct_command_buffer_t {
 
   DynamicSymbols* syms;
 
+  // Pipeline stages of all commands recorded since the command buffer began.
+  // Barriers only need to wait on stages that have had work recorded: HAL
+  // semantics require semaphores to order work across submissions and the
+  // queue waits on them cover all stages we record into.
+  VkPipelineStageFlags recorded_stage_mask;
+
+  // Execution barrier deferred until the next command is recorded such that
+  // consecutive barriers are merged into a single vkCmdPipelineBarrier.
+  bool has_pending_barrier;
+  struct {
+    VkPipelineStageFlags source_stage_mask;
+    VkPipelineStageFlags target_stage_mask;
+    // Union of all global memory barriers.
+    VkAccessFlags source_access_mask;
+    VkAccessFlags target_access_mask;
+    iree_host_size_t buffer_barrier_count;
+    VkBufferMemoryBarrier
+        buffer_barriers[IREE_HAL_VULKAN_MAX_PENDING_BUFFER_BARRIERS];
+  } pending_barrier;
+
   // Maintains a reference to all resources used within the command buffer.
   // Reset on each begin.
   iree_hal_resource_set_t* resource_set;
@@ -195,6 +220,9 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_begin(
                          command_buffer->handle, &begin_info),
                      "vkBeginCommandBuffer");
 
+  command_buffer->recorded_stage_mask = 0;
+  command_buffer->has_pending_barrier = false;
+
   IREE_VULKAN_TRACE_ZONE_BEGIN_EXTERNAL(
       command_buffer->tracing_context, command_buffer->handle,
       /*file_name=*/NULL, 0,
@@ -204,11 +232,18 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_begin(
   return iree_ok_status();
 }
 
+static void iree_hal_vulkan_direct_command_buffer_flush_barrier(
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer);
+
 static iree_status_t iree_hal_vulkan_direct_command_buffer_end(
     iree_hal_command_buffer_t* base_command_buffer) {
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
 
+  // Trailing barriers order work (and make it visible to the host) for work
+  // following the command buffer and must be kept.
+  iree_hal_vulkan_direct_command_buffer_flush_barrier(command_buffer);
+
   IREE_VULKAN_TRACE_ZONE_END(command_buffer->tracing_context,
                              command_buffer->handle);
 
@@ -332,6 +367,79 @@ static VkAccessFlags iree_hal_vulkan_convert_access_mask(
   return flags;
 }
 
+// Populates a Vulkan buffer memory barrier from a HAL buffer barrier.
+static void iree_hal_vulkan_populate_buffer_barrier(
+    const iree_hal_buffer_barrier_t* buffer_barrier,
+    VkBufferMemoryBarrier* info) {
+  info->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
+  info->pNext = NULL;
+  info->srcAccessMask =
+      iree_hal_vulkan_convert_access_mask(buffer_barrier->source_scope);
+  info->dstAccessMask =
+      iree_hal_vulkan_convert_access_mask(buffer_barrier->target_scope);
+  info->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  info->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+  info->buffer =
+      iree_hal_vulkan_buffer_handle(buffer_barrier->buffer_ref.buffer);
+  info->offset =
+      iree_hal_buffer_byte_offset(buffer_barrier->buffer_ref.buffer) +
+      buffer_barrier->buffer_ref.offset;
+  info->size = buffer_barrier->buffer_ref.length == IREE_WHOLE_BUFFER
+                   ? VK_WHOLE_SIZE
+                   : buffer_barrier->buffer_ref.length;
+}
+
+// Emits the pending barrier, if any. Source stages that have had no work
+// recorded are dropped and if no work at all could be ordered by the barrier
+// it is elided.
+static void iree_hal_vulkan_direct_command_buffer_flush_barrier(
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer) {
+  if (!command_buffer->has_pending_barrier) return;
+  command_buffer->has_pending_barrier = false;
+  auto& pending_barrier = command_buffer->pending_barrier;
+
+  // Only the stages we record work into are tracked; others (host, bottom of
+  // pipe, etc) are passed through as requested.
+  const VkPipelineStageFlags tracked_stage_mask =
+      VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT | VK_PIPELINE_STAGE_TRANSFER_BIT;
+  VkPipelineStageFlags source_stage_mask =
+      (pending_barrier.source_stage_mask & ~tracked_stage_mask) |
+      (pending_barrier.source_stage_mask & tracked_stage_mask &
+       command_buffer->recorded_stage_mask);
+  if ((source_stage_mask & ~VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT) == 0) {
+    // Nothing recorded prior to the barrier that it could order.
+    return;
+  }
+
+  VkMemoryBarrier memory_barrier;
+  memory_barrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+  memory_barrier.pNext = NULL;
+  memory_barrier.srcAccessMask = pending_barrier.source_access_mask;
+  memory_barrier.dstAccessMask = pending_barrier.target_access_mask;
+  const bool has_memory_barrier = memory_barrier.srcAccessMask != 0 ||
+                                  memory_barrier.dstAccessMask != 0;
+
+  command_buffer->syms->vkCmdPipelineBarrier(
+      command_buffer->handle, source_stage_mask,
+      pending_barrier.target_stage_mask,
+      /*dependencyFlags=*/0, has_memory_barrier ? 1 : 0,
+      has_memory_barrier ? &memory_barrier : NULL,
+      (uint32_t)pending_barrier.buffer_barrier_count,
+      pending_barrier.buffer_barrier_count ? pending_barrier.buffer_barriers
+                                           : NULL,
+      0, NULL);
+}
+
+// Flushes any pending barrier prior to recording a command that executes in
+// the given pipeline stages.
+static void iree_hal_vulkan_direct_command_buffer_begin_command(
+    iree_hal_vulkan_direct_command_buffer_t* command_buffer,
+    VkPipelineStageFlags stage_mask) {
+  iree_hal_vulkan_direct_command_buffer_flush_barrier(command_buffer);
+  command_buffer->recorded_stage_mask |= stage_mask;
+}
+
 static iree_status_t iree_hal_vulkan_direct_command_buffer_execution_barrier(
     iree_hal_command_buffer_t* base_command_buffer,
     iree_hal_execution_stage_t source_stage_mask,
@@ -343,52 +451,50 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_execution_barrier(
     const iree_hal_buffer_barrier_t* buffer_barriers) {
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
-  iree_allocator_t host_allocator =
-      command_buffer->logical_device->host_allocator();
-
-  iree_inline_array(VkMemoryBarrier, memory_barrier_infos, memory_barrier_count,
-                    host_allocator);
-  for (int i = 0; i < memory_barrier_count; ++i) {
-    const iree_hal_memory_barrier_t& memory_barrier = memory_barriers[i];
-    VkMemoryBarrier* info = iree_inline_array_at(memory_barrier_infos, i);
-    info->sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
-    info->pNext = NULL;
-    info->srcAccessMask =
-        iree_hal_vulkan_convert_access_mask(memory_barrier.source_scope);
-    info->dstAccessMask =
-        iree_hal_vulkan_convert_access_mask(memory_barrier.target_scope);
+  auto& pending_barrier = command_buffer->pending_barrier;
+
+  // Flush the pending barrier if the new buffer barriers won't fit. This is
+  // conservative as we could emit a global memory barrier instead but large
+  // buffer barrier lists are rare.
+  if (command_buffer->has_pending_barrier &&
+      pending_barrier.buffer_barrier_count + buffer_barrier_count >
+          IREE_HAL_VULKAN_MAX_PENDING_BUFFER_BARRIERS) {
+    iree_hal_vulkan_direct_command_buffer_flush_barrier(command_buffer);
   }
-
-  iree_inline_array(VkBufferMemoryBarrier, buffer_barrier_infos,
-                    buffer_barrier_count, host_allocator);
-  for (int i = 0; i < buffer_barrier_count; ++i) {
-    const iree_hal_buffer_barrier_t& buffer_barrier = buffer_barriers[i];
-    VkBufferMemoryBarrier* info = iree_inline_array_at(buffer_barrier_infos, i);
-    info->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    info->pNext = NULL;
-    info->srcAccessMask =
-        iree_hal_vulkan_convert_access_mask(buffer_barrier.source_scope);
-    info->dstAccessMask =
-        iree_hal_vulkan_convert_access_mask(buffer_barrier.target_scope);
-    info->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    info->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    info->buffer =
-        iree_hal_vulkan_buffer_handle(buffer_barrier.buffer_ref.buffer);
-    info->offset = buffer_barrier.buffer_ref.offset;
-    info->size = buffer_barrier.buffer_ref.length;
+  if (!command_buffer->has_pending_barrier) {
+    command_buffer->has_pending_barrier = true;
+    memset(&pending_barrier, 0, sizeof(pending_barrier));
   }
 
-  command_buffer->syms->vkCmdPipelineBarrier(
-      command_buffer->handle,
-      iree_hal_vulkan_convert_pipeline_stage_flags(source_stage_mask),
-      iree_hal_vulkan_convert_pipeline_stage_flags(target_stage_mask),
-      /*dependencyFlags=*/0, (uint32_t)memory_barrier_count,
-      iree_inline_array_data(memory_barrier_infos),
-      (uint32_t)buffer_barrier_count,
-      iree_inline_array_data(buffer_barrier_infos), 0, NULL);
-
-  iree_inline_array_deinitialize(memory_barrier_infos);
-  iree_inline_array_deinitialize(buffer_barrier_infos);
+  // Merge into the pending barrier. The union of the barriers is at least as
+  // strong as issuing them back-to-back as no work is recorded in between.
+  pending_barrier.source_stage_mask |=
+      iree_hal_vulkan_convert_pipeline_stage_flags(source_stage_mask);
+  pending_barrier.target_stage_mask |=
+      iree_hal_vulkan_convert_pipeline_stage_flags(target_stage_mask);
+  for (iree_host_size_t i = 0; i < memory_barrier_count; ++i) {
+    pending_barrier.source_access_mask |=
+        iree_hal_vulkan_convert_access_mask(memory_barriers[i].source_scope);
+    pending_barrier.target_access_mask |=
+        iree_hal_vulkan_convert_access_mask(memory_barriers[i].target_scope);
+  }
+  if (buffer_barrier_count > IREE_HAL_VULKAN_MAX_PENDING_BUFFER_BARRIERS) {
+    // Too many buffer barriers to track individually: promote them to a global
+    // memory barrier covering all of their access scopes.
+    for (iree_host_size_t i = 0; i < buffer_barrier_count; ++i) {
+      pending_barrier.source_access_mask |=
+          iree_hal_vulkan_convert_access_mask(buffer_barriers[i].source_scope);
+      pending_barrier.target_access_mask |=
+          iree_hal_vulkan_convert_access_mask(buffer_barriers[i].target_scope);
+    }
+  } else {
+    for (iree_host_size_t i = 0; i < buffer_barrier_count; ++i) {
+      iree_hal_vulkan_populate_buffer_barrier(
+          &buffer_barriers[i],
+          &pending_barrier
+               .buffer_barriers[pending_barrier.buffer_barrier_count++]);
+    }
+  }
 
   return iree_ok_status();
 }
@@ -398,6 +504,7 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_signal_event(
     iree_hal_execution_stage_t source_stage_mask) {
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
+  iree_hal_vulkan_direct_command_buffer_flush_barrier(command_buffer);
 
   IREE_RETURN_IF_ERROR(
       iree_hal_resource_set_insert(command_buffer->resource_set, 1, &event));
@@ -414,6 +521,7 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_reset_event(
     iree_hal_execution_stage_t source_stage_mask) {
   iree_hal_vulkan_direct_command_buffer_t* command_buffer =
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
+  iree_hal_vulkan_direct_command_buffer_flush_barrier(command_buffer);
 
   IREE_RETURN_IF_ERROR(
       iree_hal_resource_set_insert(command_buffer->resource_set, 1, &event));
@@ -438,6 +546,7 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_wait_events(
       iree_hal_vulkan_direct_command_buffer_cast(base_command_buffer);
   iree_allocator_t host_allocator =
       command_buffer->logical_device->host_allocator();
+  iree_hal_vulkan_direct_command_buffer_flush_barrier(command_buffer);
 
   IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert(
       command_buffer->resource_set, event_count, events));
@@ -464,20 +573,8 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_wait_events(
   iree_inline_array(VkBufferMemoryBarrier, buffer_barrier_infos,
                     buffer_barrier_count, host_allocator);
   for (int i = 0; i < buffer_barrier_count; ++i) {
-    const iree_hal_buffer_barrier_t& buffer_barrier = buffer_barriers[i];
-    VkBufferMemoryBarrier* info = iree_inline_array_at(buffer_barrier_infos, i);
-    info->sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER;
-    info->pNext = NULL;
-    info->srcAccessMask =
-        iree_hal_vulkan_convert_access_mask(buffer_barrier.source_scope);
-    info->dstAccessMask =
-        iree_hal_vulkan_convert_access_mask(buffer_barrier.target_scope);
-    info->srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    info->dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
-    info->buffer =
-        iree_hal_vulkan_buffer_handle(buffer_barrier.buffer_ref.buffer);
-    info->offset = buffer_barrier.buffer_ref.offset;
-    info->size = buffer_barrier.buffer_ref.length;
+    iree_hal_vulkan_populate_buffer_barrier(
+        &buffer_barriers[i], iree_inline_array_at(buffer_barrier_infos, i));
   }
 
   command_buffer->syms->vkCmdWaitEvents(
@@ -536,6 +633,14 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_fill_buffer(
   VkBuffer target_device_buffer =
       iree_hal_vulkan_buffer_handle(target_ref.buffer);
 
+  // Unaligned fills are partially performed with a dispatch.
+  iree_hal_vulkan_direct_command_buffer_begin_command(
+      command_buffer,
+      (target_ref.offset % 4 != 0 || target_ref.length % 4 != 0)
+          ? VK_PIPELINE_STAGE_TRANSFER_BIT |
+                VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT
+          : VK_PIPELINE_STAGE_TRANSFER_BIT);
+
   IREE_VULKAN_TRACE_ZONE_BEGIN(command_buffer->tracing_context,
                                command_buffer->handle);
 
@@ -600,6 +705,9 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_update_buffer(
   VkBuffer target_device_buffer =
       iree_hal_vulkan_buffer_handle(target_ref.buffer);
 
+  iree_hal_vulkan_direct_command_buffer_begin_command(
+      command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
   IREE_VULKAN_TRACE_ZONE_BEGIN(command_buffer->tracing_context,
                                command_buffer->handle);
 
@@ -644,6 +752,9 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_copy_buffer(
   VkBuffer target_device_buffer =
       iree_hal_vulkan_buffer_handle(target_ref.buffer);
 
+  iree_hal_vulkan_direct_command_buffer_begin_command(
+      command_buffer, VK_PIPELINE_STAGE_TRANSFER_BIT);
+
   IREE_VULKAN_TRACE_ZONE_BEGIN(command_buffer->tracing_context,
                                command_buffer->handle);
 
@@ -695,6 +806,9 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_dispatch(
   IREE_RETURN_IF_ERROR(iree_hal_vulkan_native_executable_lookup_pipeline(
       executable, entry_point, &pipeline));
 
+  iree_hal_vulkan_direct_command_buffer_begin_command(
+      command_buffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
   iree_hal_vulkan_source_location_t source_location = pipeline->source_location;
   IREE_VULKAN_TRACE_ZONE_BEGIN_EXTERNAL(
@@ -754,6 +868,11 @@ static iree_status_t iree_hal_vulkan_direct_command_buffer_dispatch_indirect(
   IREE_RETURN_IF_ERROR(iree_hal_vulkan_native_executable_lookup_pipeline(
       executable, entry_point, &pipeline));
 
+  // The workgroup count is read in the indirect command stage.
+  iree_hal_vulkan_direct_command_buffer_begin_command(
+      command_buffer, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                          VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT);
+
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
   iree_hal_vulkan_source_location_t source_location = pipeline->source_location;
   IREE_VULKAN_TRACE_ZONE_BEGIN_EXTERNAL(
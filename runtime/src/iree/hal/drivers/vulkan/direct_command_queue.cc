@@ -32,8 +32,14 @@ iree_status_t DirectCommandQueue::TranslateBatchInfo(
   // TODO(benvanik): see if we can go to finer-grained stages.
   // For example, if this was just queue ownership transfers then we can use
   // the pseudo-stage of VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT.
-  VkPipelineStageFlags dst_stage_mask =
-      VK_PIPELINE_STAGE_TRANSFER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  // Transfer-only queues do not support the compute stage. The waits must
+  // cover all stages command buffers record work into as they elide barriers
+  // that would only order work from prior submissions.
+  VkPipelineStageFlags dst_stage_mask = VK_PIPELINE_STAGE_TRANSFER_BIT;
+  if (can_dispatch()) {
+    dst_stage_mask |= VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT |
+                      VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT;
+  }
 
   auto wait_semaphore_handles =
       arena->AllocateSpan<VkSemaphore>(batch->wait_semaphores.count);
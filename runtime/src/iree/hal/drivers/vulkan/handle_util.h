@@ -100,6 +100,23 @@ class VkDeviceHandle : public RefObject<VkDeviceHandle> {
     return supported_properties_;
   }
 
+  // Queue families that resources created on the device may be used from.
+  // When more than one family is in use resources are created with concurrent
+  // sharing so that they can be used from any queue without ownership
+  // transfers.
+  iree_host_size_t queue_family_count() const { return queue_family_count_; }
+  const uint32_t* queue_family_indices() const {
+    return queue_family_indices_;
+  }
+  void set_queue_families(uint32_t dispatch_family_index,
+                          uint32_t transfer_family_index) {
+    queue_family_count_ = 0;
+    queue_family_indices_[queue_family_count_++] = dispatch_family_index;
+    if (transfer_family_index != dispatch_family_index) {
+      queue_family_indices_[queue_family_count_++] = transfer_family_index;
+    }
+  }
+
  private:
   VkPhysicalDevice physical_device_ = VK_NULL_HANDLE;
   VkDevice value_ = VK_NULL_HANDLE;
@@ -110,6 +127,8 @@ class VkDeviceHandle : public RefObject<VkDeviceHandle> {
   bool owns_device_;
   const VkAllocationCallbacks* allocator_ = nullptr;
   iree_allocator_t host_allocator_;
+  iree_host_size_t queue_family_count_ = 0;
+  uint32_t queue_family_indices_[2] = {0, 0};
 };
 
 class VkCommandPoolHandle {
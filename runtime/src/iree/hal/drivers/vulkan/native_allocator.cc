@@ -142,6 +142,15 @@ static void iree_hal_vulkan_native_allocator_query_statistics(
   });
 }
 
+static void iree_hal_vulkan_native_allocator_reset_capture_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  IREE_STATISTICS({
+    iree_hal_vulkan_native_allocator_t* allocator =
+        iree_hal_vulkan_native_allocator_cast(base_allocator);
+    iree_hal_allocator_statistics_reset_capture(&allocator->statistics);
+  });
+}
+
 static iree_status_t iree_hal_vulkan_native_allocator_query_memory_heaps(
     iree_hal_allocator_t* IREE_RESTRICT base_allocator,
     iree_host_size_t capacity,
@@ -344,7 +353,7 @@ static iree_status_t iree_hal_vulkan_native_allocator_commit_and_wrap(
   return status;
 }
 
-static iree_status_t iree_hal_vulkan_native_allocator_create_buffer(
+extern "C" iree_status_t iree_hal_vulkan_native_allocator_create_buffer(
     VkDeviceHandle* logical_device,
     const iree_hal_buffer_params_t* IREE_RESTRICT params,
     iree_device_size_t allocation_size, bool use_sparse_allocation,
@@ -376,9 +385,18 @@ static iree_status_t iree_hal_vulkan_native_allocator_create_buffer(
     buffer_create_info.flags |= VK_BUFFER_CREATE_SPARSE_BINDING_BIT |
                                 VK_BUFFER_CREATE_SPARSE_RESIDENCY_BIT;
   }
-  buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
-  buffer_create_info.queueFamilyIndexCount = 0;
-  buffer_create_info.pQueueFamilyIndices = NULL;
+  if (logical_device->queue_family_count() > 1) {
+    // Buffers may be used from both dispatch and transfer queues.
+    buffer_create_info.sharingMode = VK_SHARING_MODE_CONCURRENT;
+    buffer_create_info.queueFamilyIndexCount =
+        (uint32_t)logical_device->queue_family_count();
+    buffer_create_info.pQueueFamilyIndices =
+        logical_device->queue_family_indices();
+  } else {
+    buffer_create_info.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+    buffer_create_info.queueFamilyIndexCount = 0;
+    buffer_create_info.pQueueFamilyIndices = NULL;
+  }
 
   // If trying to bind to external memory we need to verify we can create a
   // buffer that can be bound.
@@ -859,6 +877,8 @@ const iree_hal_allocator_vtable_t iree_hal_vulkan_native_allocator_vtable = {
     /*.host_allocator=*/iree_hal_vulkan_native_allocator_host_allocator,
     /*.trim=*/iree_hal_vulkan_native_allocator_trim,
     /*.query_statistics=*/iree_hal_vulkan_native_allocator_query_statistics,
+    /*.reset_capture_statistics=*/
+    iree_hal_vulkan_native_allocator_reset_capture_statistics,
     /*.query_memory_heaps=*/iree_hal_vulkan_native_allocator_query_memory_heaps,
     /*.query_buffer_compatibility=*/
     iree_hal_vulkan_native_allocator_query_buffer_compatibility,
@@ -23,6 +23,16 @@ iree_status_t iree_hal_vulkan_native_allocator_create(
     iree::hal::vulkan::VkDeviceHandle* logical_device,
     iree_hal_allocator_t** out_allocator);
 
+// Creates an unbound VkBuffer |out_handle| usable as a HAL buffer with the
+// given |params|. The caller must bind memory to the buffer prior to use.
+// |use_sparse_allocation| creates a buffer for sparse binding and
+// |bind_host_memory| verifies that imported host memory can be bound to it.
+iree_status_t iree_hal_vulkan_native_allocator_create_buffer(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    const iree_hal_buffer_params_t* IREE_RESTRICT params,
+    iree_device_size_t allocation_size, bool use_sparse_allocation,
+    bool bind_host_memory, VkBuffer* out_handle);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
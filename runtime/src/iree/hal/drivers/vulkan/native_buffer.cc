@@ -41,7 +41,6 @@ iree_status_t iree_hal_vulkan_native_buffer_wrap(
     iree_hal_vulkan_native_buffer_release_callback_t internal_release_callback,
     iree_hal_buffer_release_callback_t user_release_callback,
     iree_hal_buffer_t** out_buffer) {
-  IREE_ASSERT_ARGUMENT(allocator);
   IREE_ASSERT_ARGUMENT(logical_device);
   IREE_ASSERT_ARGUMENT(handle);
   IREE_ASSERT_ARGUMENT(out_buffer);
@@ -49,7 +48,8 @@ iree_status_t iree_hal_vulkan_native_buffer_wrap(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)allocation_size);
 
   iree_allocator_t host_allocator =
-      iree_hal_allocator_host_allocator(allocator);
+      allocator ? iree_hal_allocator_host_allocator(allocator)
+                : logical_device->host_allocator();
   iree_hal_vulkan_native_buffer_t* buffer = NULL;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, sizeof(*buffer), (void**)&buffer);
@@ -71,6 +71,20 @@ iree_status_t iree_hal_vulkan_native_buffer_wrap(
   return status;
 }
 
+void* iree_hal_vulkan_native_buffer_release_user_data(
+    iree_hal_buffer_t* base_buffer,
+    iree_hal_vulkan_native_buffer_release_fn_t fn) {
+  if (!iree_hal_resource_is(base_buffer,
+                            &iree_hal_vulkan_native_buffer_vtable)) {
+    return NULL;
+  }
+  iree_hal_vulkan_native_buffer_t* buffer =
+      iree_hal_vulkan_native_buffer_cast(base_buffer);
+  return buffer->internal_release_callback.fn == fn
+             ? buffer->internal_release_callback.user_data
+             : NULL;
+}
+
 static void iree_hal_vulkan_native_buffer_destroy(
     iree_hal_buffer_t* base_buffer) {
   iree_hal_vulkan_native_buffer_t* buffer =
@@ -33,7 +33,8 @@ typedef struct {
 
 // Wraps a Vulkan |buffer| bound to device |device_memory| for exposure into the
 // HAL. The provided callback is made when the buffer is destroyed to allow the
-// caller to clean up as appropriate.
+// caller to clean up as appropriate. |allocator| may be NULL if the buffer was
+// not allocated from a HAL allocator.
 iree_status_t iree_hal_vulkan_native_buffer_wrap(
     iree_hal_allocator_t* allocator, iree_hal_memory_type_t memory_type,
     iree_hal_memory_access_t allowed_access,
@@ -45,6 +46,12 @@ iree_status_t iree_hal_vulkan_native_buffer_wrap(
     iree_hal_buffer_release_callback_t user_release_callback,
     iree_hal_buffer_t** out_buffer);
 
+// Returns the user data of the internal release callback |buffer| was wrapped
+// with if |buffer| is a native buffer and the callback function is |fn|.
+// Returns NULL otherwise. Used by the owners of buffers to recognize their own.
+void* iree_hal_vulkan_native_buffer_release_user_data(
+    iree_hal_buffer_t* buffer, iree_hal_vulkan_native_buffer_release_fn_t fn);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
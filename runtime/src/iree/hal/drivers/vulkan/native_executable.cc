@@ -884,6 +884,22 @@ iree_hal_vulkan_native_executable_cast(iree_hal_executable_t* base_value) {
   return (iree_hal_vulkan_native_executable_t*)base_value;
 }
 
+bool iree_hal_vulkan_native_executable_supports_format(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    iree_string_view_t executable_format) {
+  if (iree_string_view_equal(executable_format,
+                             iree_make_cstring_view("vulkan-spirv-fb"))) {
+    return true;
+  } else if (iree_string_view_equal(
+                 executable_format,
+                 iree_make_cstring_view("vulkan-spirv-fb-ptr"))) {
+    return iree_all_bits_set(
+        logical_device->enabled_features(),
+        IREE_HAL_VULKAN_FEATURE_ENABLE_BUFFER_DEVICE_ADDRESSES);
+  }
+  return false;
+}
+
 iree_status_t iree_hal_vulkan_native_executable_create(
     iree::hal::vulkan::VkDeviceHandle* logical_device,
     VkPipelineCache pipeline_cache,
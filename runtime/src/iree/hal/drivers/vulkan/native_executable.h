@@ -32,6 +32,11 @@ typedef struct iree_hal_vulkan_pipeline_t {
   IREE_TRACE(iree_hal_vulkan_source_location_t source_location;)
 } iree_hal_vulkan_pipeline_t;
 
+// Returns true if |executable_format| can be loaded on |logical_device|.
+bool iree_hal_vulkan_native_executable_supports_format(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    iree_string_view_t executable_format);
+
 // Creates a wrapper for one or more VkPipelines that are sourced from the same
 // IREE executable. Each of the pipelines will share the same shader module
 // and just differs by the entry point into the shader module they reference.
@@ -75,17 +75,8 @@ static bool iree_hal_vulkan_nop_executable_cache_can_prepare_format(
     iree_string_view_t executable_format) {
   iree_hal_vulkan_nop_executable_cache_t* executable_cache =
       iree_hal_vulkan_nop_executable_cache_cast(base_executable_cache);
-  if (iree_string_view_equal(executable_format,
-                             iree_make_cstring_view("vulkan-spirv-fb"))) {
-    return true;
-  } else if (iree_string_view_equal(
-                 executable_format,
-                 iree_make_cstring_view("vulkan-spirv-fb-ptr"))) {
-    return iree_all_bits_set(
-        executable_cache->logical_device->enabled_features(),
-        IREE_HAL_VULKAN_FEATURE_ENABLE_BUFFER_DEVICE_ADDRESSES);
-  }
-  return false;
+  return iree_hal_vulkan_native_executable_supports_format(
+      executable_cache->logical_device, executable_format);
 }
 
 static iree_status_t iree_hal_vulkan_nop_executable_cache_prepare_executable(
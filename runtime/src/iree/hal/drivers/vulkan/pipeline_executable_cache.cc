@@ -0,0 +1,277 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/vulkan/pipeline_executable_cache.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/hal/drivers/vulkan/dynamic_symbol_tables.h"
+#include "iree/hal/drivers/vulkan/native_executable.h"
+#include "iree/hal/drivers/vulkan/status_util.h"
+
+using namespace iree::hal::vulkan;
+
+typedef struct iree_hal_vulkan_pipeline_executable_cache_t {
+  iree_hal_resource_t resource;
+  VkDeviceHandle* logical_device;
+  VkPipelineCache handle;
+  // Size of the data loaded from the cache file used to detect whether any new
+  // pipelines were added and the file needs to be rewritten.
+  size_t initial_data_size;
+  // NUL-terminated path of the file the cache is persisted to.
+  char* file_path;
+} iree_hal_vulkan_pipeline_executable_cache_t;
+
+namespace {
+extern const iree_hal_executable_cache_vtable_t
+    iree_hal_vulkan_pipeline_executable_cache_vtable;
+}  // namespace
+
+static iree_hal_vulkan_pipeline_executable_cache_t*
+iree_hal_vulkan_pipeline_executable_cache_cast(
+    iree_hal_executable_cache_t* base_value) {
+  IREE_HAL_ASSERT_TYPE(base_value,
+                       &iree_hal_vulkan_pipeline_executable_cache_vtable);
+  return (iree_hal_vulkan_pipeline_executable_cache_t*)base_value;
+}
+
+// Formats the cache file path for the physical device into |buffer|.
+// Returns the length of the path excluding the NUL terminator or -1 if the
+// buffer is too small.
+static int iree_hal_vulkan_pipeline_cache_format_path(
+    iree_string_view_t cache_path,
+    const VkPhysicalDeviceProperties* properties, char* buffer,
+    size_t buffer_capacity) {
+  char uuid[VK_UUID_SIZE * 2 + 1];
+  for (int i = 0; i < VK_UUID_SIZE; ++i) {
+    snprintf(&uuid[i * 2], 3, "%02x", properties->pipelineCacheUUID[i]);
+  }
+  int length = snprintf(buffer, buffer_capacity,
+                        "%.*s/iree-vulkan-%08x-%08x-%08x-%s.pipeline_cache",
+                        (int)cache_path.size, cache_path.data,
+                        properties->vendorID, properties->deviceID,
+                        properties->driverVersion, uuid);
+  return length >= 0 && (size_t)length < buffer_capacity ? length : -1;
+}
+
+// Returns true if |data| has a pipeline cache header matching |properties|.
+// Drivers are required to handle incompatible data but some are known to
+// misbehave so we filter it out before handing it to them.
+static bool iree_hal_vulkan_pipeline_cache_is_compatible(
+    iree_const_byte_span_t data, const VkPhysicalDeviceProperties* properties) {
+  VkPipelineCacheHeaderVersionOne header;
+  if (data.data_length < sizeof(header)) return false;
+  memcpy(&header, data.data, sizeof(header));
+  return header.headerSize >= sizeof(header) &&
+         header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE &&
+         header.vendorID == properties->vendorID &&
+         header.deviceID == properties->deviceID &&
+         memcmp(header.pipelineCacheUUID, properties->pipelineCacheUUID,
+                VK_UUID_SIZE) == 0;
+}
+
+iree_status_t iree_hal_vulkan_pipeline_executable_cache_create(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    VkPhysicalDevice physical_device, iree_string_view_t cache_path,
+    iree_hal_executable_cache_t** out_executable_cache) {
+  IREE_ASSERT_ARGUMENT(logical_device);
+  IREE_ASSERT_ARGUMENT(out_executable_cache);
+  *out_executable_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, cache_path.data, cache_path.size);
+  iree_allocator_t host_allocator = logical_device->host_allocator();
+
+  VkPhysicalDeviceProperties properties;
+  logical_device->syms()->vkGetPhysicalDeviceProperties(physical_device,
+                                                        &properties);
+  char file_path[2048];
+  int file_path_length = iree_hal_vulkan_pipeline_cache_format_path(
+      cache_path, &properties, file_path, sizeof(file_path));
+  if (file_path_length < 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "pipeline cache path too long: '%.*s'",
+                            (int)cache_path.size, cache_path.data);
+  }
+
+  iree_hal_vulkan_pipeline_executable_cache_t* executable_cache = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator,
+                                sizeof(*executable_cache) + file_path_length +
+                                    /*NUL=*/1,
+                                (void**)&executable_cache));
+  iree_hal_resource_initialize(
+      &iree_hal_vulkan_pipeline_executable_cache_vtable,
+      &executable_cache->resource);
+  executable_cache->logical_device = logical_device;
+  executable_cache->handle = VK_NULL_HANDLE;
+  executable_cache->initial_data_size = 0;
+  executable_cache->file_path =
+      (char*)executable_cache + sizeof(*executable_cache);
+  memcpy(executable_cache->file_path, file_path, file_path_length + 1);
+
+  // Load existing data from a prior run, if any. Failing to read the file is
+  // not an error as it may not exist yet or may have been deleted.
+  iree_file_contents_t* file_contents = NULL;
+  iree_status_t read_status =
+      iree_file_read_contents(executable_cache->file_path,
+                              IREE_FILE_READ_FLAG_PRELOAD, host_allocator,
+                              &file_contents);
+  iree_const_byte_span_t initial_data = iree_const_byte_span_empty();
+  if (iree_status_is_ok(read_status) &&
+      iree_hal_vulkan_pipeline_cache_is_compatible(file_contents->const_buffer,
+                                                   &properties)) {
+    initial_data = file_contents->const_buffer;
+  }
+  iree_status_ignore(read_status);
+
+  VkPipelineCacheCreateInfo create_info;
+  memset(&create_info, 0, sizeof(create_info));
+  create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+  create_info.pNext = NULL;
+  create_info.flags = 0;
+  create_info.initialDataSize = initial_data.data_length;
+  create_info.pInitialData = initial_data.data;
+  iree_status_t status = VK_RESULT_TO_STATUS(
+      logical_device->syms()->vkCreatePipelineCache(
+          *logical_device, &create_info, logical_device->allocator(),
+          &executable_cache->handle),
+      "vkCreatePipelineCache");
+  executable_cache->initial_data_size = initial_data.data_length;
+  if (file_contents) iree_file_contents_free(file_contents);
+
+  if (iree_status_is_ok(status)) {
+    *out_executable_cache = (iree_hal_executable_cache_t*)executable_cache;
+  } else {
+    iree_hal_executable_cache_release(
+        (iree_hal_executable_cache_t*)executable_cache);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Writes the pipeline cache data to the cache file.
+// The data is written to a temporary file and renamed over the cache file so
+// that concurrent processes never observe a partially written cache.
+static iree_status_t iree_hal_vulkan_pipeline_executable_cache_persist(
+    iree_hal_vulkan_pipeline_executable_cache_t* executable_cache) {
+  VkDeviceHandle* logical_device = executable_cache->logical_device;
+  iree_allocator_t host_allocator = logical_device->host_allocator();
+
+  size_t data_size = 0;
+  VK_RETURN_IF_ERROR(logical_device->syms()->vkGetPipelineCacheData(
+                         *logical_device, executable_cache->handle, &data_size,
+                         NULL),
+                     "vkGetPipelineCacheData");
+  if (data_size == executable_cache->initial_data_size) {
+    return iree_ok_status();  // no new pipelines
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, data_size);
+  void* data = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, data_size, &data));
+  iree_status_t status = VK_RESULT_TO_STATUS(
+      logical_device->syms()->vkGetPipelineCacheData(
+          *logical_device, executable_cache->handle, &data_size, data),
+      "vkGetPipelineCacheData");
+
+  char temp_path[2048 + 32];
+  if (iree_status_is_ok(status)) {
+    snprintf(temp_path, sizeof(temp_path), "%s.%p.tmp",
+             executable_cache->file_path, (void*)executable_cache);
+    status = iree_file_write_contents(
+        temp_path, iree_make_const_byte_span(data, data_size));
+  }
+  if (iree_status_is_ok(status)) {
+    if (rename(temp_path, executable_cache->file_path) != 0) {
+      remove(temp_path);
+      status = iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "failed to replace pipeline cache file '%s'",
+                                executable_cache->file_path);
+    }
+  }
+
+  iree_allocator_free(host_allocator, data);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_hal_vulkan_pipeline_executable_cache_destroy(
+    iree_hal_executable_cache_t* base_executable_cache) {
+  iree_hal_vulkan_pipeline_executable_cache_t* executable_cache =
+      iree_hal_vulkan_pipeline_executable_cache_cast(base_executable_cache);
+  VkDeviceHandle* logical_device = executable_cache->logical_device;
+  iree_allocator_t host_allocator = logical_device->host_allocator();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (executable_cache->handle != VK_NULL_HANDLE) {
+    // Persistence is best-effort: the cache directory may be read-only or
+    // full and that should not impact the program.
+    iree_status_ignore(
+        iree_hal_vulkan_pipeline_executable_cache_persist(executable_cache));
+    logical_device->syms()->vkDestroyPipelineCache(
+        *logical_device, executable_cache->handle, logical_device->allocator());
+  }
+  iree_allocator_free(host_allocator, executable_cache);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static bool iree_hal_vulkan_pipeline_executable_cache_can_prepare_format(
+    iree_hal_executable_cache_t* base_executable_cache,
+    iree_hal_executable_caching_mode_t caching_mode,
+    iree_string_view_t executable_format) {
+  iree_hal_vulkan_pipeline_executable_cache_t* executable_cache =
+      iree_hal_vulkan_pipeline_executable_cache_cast(base_executable_cache);
+  return iree_hal_vulkan_native_executable_supports_format(
+      executable_cache->logical_device, executable_format);
+}
+
+static iree_status_t
+iree_hal_vulkan_pipeline_executable_cache_prepare_executable(
+    iree_hal_executable_cache_t* base_executable_cache,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executable) {
+  if (!iree_hal_vulkan_pipeline_executable_cache_can_prepare_format(
+          base_executable_cache, executable_params->caching_mode,
+          executable_params->executable_format)) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "no Vulkan executable implementation registered "
+                            "for the given executable format '%.*s'",
+                            (int)executable_params->executable_format.size,
+                            executable_params->executable_format.data);
+  }
+  iree_hal_vulkan_pipeline_executable_cache_t* executable_cache =
+      iree_hal_vulkan_pipeline_executable_cache_cast(base_executable_cache);
+  // Callers may opt out of persistent caching in which case we still create the
+  // pipelines but do not record them in the cache.
+  VkPipelineCache pipeline_cache =
+      iree_all_bits_set(
+          executable_params->caching_mode,
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_PERSISTENT_CACHING)
+          ? executable_cache->handle
+          : VK_NULL_HANDLE;
+  return iree_hal_vulkan_native_executable_create(
+      executable_cache->logical_device, pipeline_cache, executable_params,
+      out_executable);
+}
+
+namespace {
+const iree_hal_executable_cache_vtable_t
+    iree_hal_vulkan_pipeline_executable_cache_vtable = {
+        /*.destroy=*/iree_hal_vulkan_pipeline_executable_cache_destroy,
+        /*.can_prepare_format=*/
+        iree_hal_vulkan_pipeline_executable_cache_can_prepare_format,
+        /*.prepare_executable=*/
+        iree_hal_vulkan_pipeline_executable_cache_prepare_executable,
+};
+}  // namespace
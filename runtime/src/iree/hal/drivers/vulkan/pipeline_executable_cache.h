@@ -0,0 +1,38 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_VULKAN_PIPELINE_EXECUTABLE_CACHE_H_
+#define IREE_HAL_DRIVERS_VULKAN_PIPELINE_EXECUTABLE_CACHE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/vulkan/handle_util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates an executable cache that creates all pipelines through a
+// VkPipelineCache persisted to a file under |cache_path|.
+//
+// The cache file is keyed by the physical device vendor, device ID, driver
+// version, and pipeline cache UUID such that devices and drivers never load
+// each other's data; pipelines themselves are keyed by the Vulkan
+// implementation on the SPIR-V contents. Any existing cache file is loaded when
+// the executable cache is created and the cache file is rewritten when
+// the executable cache is destroyed if new pipelines were added. Missing or
+// incompatible cache files are ignored and failures to persist the cache are
+// not fatal.
+iree_status_t iree_hal_vulkan_pipeline_executable_cache_create(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    VkPhysicalDevice physical_device, iree_string_view_t cache_path,
+    iree_hal_executable_cache_t** out_executable_cache);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_VULKAN_PIPELINE_EXECUTABLE_CACHE_H_
@@ -46,6 +46,10 @@ IREE_FLAG(
     bool, vulkan_dedicated_compute_queue, false,
     "Use a dedicated queue with VK_QUEUE_COMPUTE_BIT for dispatch workloads.");
 
+IREE_FLAG(string, vulkan_pipeline_cache_path, "",
+          "Directory where Vulkan pipeline caches are persisted across runs.\n"
+          "Pipelines are recreated from SPIR-V each run when empty.");
+
 static iree_status_t iree_hal_vulkan_create_driver_with_flags(
     iree_string_view_t identifier, iree_allocator_t host_allocator,
     iree_hal_driver_t** out_driver) {
@@ -99,6 +103,8 @@ static iree_status_t iree_hal_vulkan_create_driver_with_flags(
     driver_options.device_options.flags |=
         IREE_HAL_VULKAN_DEVICE_FLAG_DEDICATED_COMPUTE_QUEUE;
   }
+  driver_options.device_options.pipeline_cache_path =
+      iree_make_cstring_view(FLAG_vulkan_pipeline_cache_path);
 
   // Load the Vulkan library. This will fail if the library cannot be found or
   // does not have the expected functions.
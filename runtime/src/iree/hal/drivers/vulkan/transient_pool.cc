@@ -0,0 +1,631 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/drivers/vulkan/transient_pool.h"
+
+#include <cstddef>
+#include <cstring>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/drivers/vulkan/base_buffer.h"
+#include "iree/hal/drivers/vulkan/dynamic_symbols.h"
+#include "iree/hal/drivers/vulkan/native_allocator.h"
+#include "iree/hal/drivers/vulkan/native_buffer.h"
+#include "iree/hal/drivers/vulkan/status_util.h"
+
+using namespace iree::hal::vulkan;
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_ALLOCATION_TRACKING
+static const char* IREE_HAL_VULKAN_TRANSIENT_POOL_ID = "Vulkan/Transient";
+#endif  // IREE_TRACING_FEATURE_ALLOCATION_TRACKING
+
+// A byte range within a block.
+typedef struct iree_hal_vulkan_transient_range_t {
+  iree_device_size_t offset;
+  iree_device_size_t length;
+} iree_hal_vulkan_transient_range_t;
+
+// A single VkDeviceMemory allocation ranges are suballocated from.
+typedef struct iree_hal_vulkan_transient_block_t {
+  VkDeviceMemory memory;
+  uint32_t memory_type_index;
+  iree_device_size_t size;
+  // Number of ranges allocated from the block including those pending reuse.
+  iree_host_size_t live_count;
+  // Free ranges sorted by offset. Adjacent ranges are always coalesced so
+  // there are never more than |live_count| + 1 free ranges; capacity is
+  // reserved when allocating so that returning a range never fails.
+  iree_host_size_t free_capacity;
+  iree_host_size_t free_count;
+  iree_hal_vulkan_transient_range_t* free_ranges;
+} iree_hal_vulkan_transient_block_t;
+
+// A deallocated range that is reusable once |semaphore| reaches |value|.
+typedef struct iree_hal_vulkan_transient_pending_t {
+  iree_hal_vulkan_transient_block_t* block;
+  iree_hal_vulkan_transient_range_t range;
+  iree_hal_semaphore_t* semaphore;  // retained
+  uint64_t value;
+} iree_hal_vulkan_transient_pending_t;
+
+// Tracks a buffer allocated from the pool. Owned by the buffer as the user
+// data of its native buffer release callback.
+typedef struct iree_hal_vulkan_transient_allocation_t {
+  iree_hal_vulkan_transient_pool_t* pool;  // retained
+  iree_hal_vulkan_transient_block_t* block;
+  // Range reserved for the buffer. The buffer is bound at an offset within it
+  // meeting its alignment requirements.
+  iree_hal_vulkan_transient_range_t range;
+  // True once the range has been handed off to the pending list by a
+  // deallocation and must not be returned when the buffer is released.
+  bool is_deallocated;
+} iree_hal_vulkan_transient_allocation_t;
+
+struct iree_hal_vulkan_transient_pool_t {
+  iree_atomic_ref_count_t ref_count;
+  VkDeviceHandle* logical_device;
+  iree_allocator_t host_allocator;
+
+  // Cached from the API to avoid additional queries in hot paths.
+  VkPhysicalDeviceProperties device_props;
+  VkPhysicalDeviceMemoryProperties memory_props;
+
+  // Minimum size of each block allocated.
+  iree_device_size_t block_size;
+
+  iree_slim_mutex_t mutex;
+  iree_host_size_t block_capacity IREE_GUARDED_BY(mutex);
+  iree_host_size_t block_count IREE_GUARDED_BY(mutex);
+  iree_hal_vulkan_transient_block_t** blocks IREE_GUARDED_BY(mutex);
+  iree_host_size_t pending_capacity IREE_GUARDED_BY(mutex);
+  iree_host_size_t pending_count IREE_GUARDED_BY(mutex);
+  iree_hal_vulkan_transient_pending_t* pending IREE_GUARDED_BY(mutex);
+};
+
+// Grows |*elements| to hold at least |minimum_capacity| elements.
+static iree_status_t iree_hal_vulkan_transient_pool_reserve(
+    iree_allocator_t host_allocator, iree_host_size_t element_size,
+    iree_host_size_t minimum_capacity, iree_host_size_t* capacity,
+    void** elements) {
+  if (minimum_capacity <= *capacity) return iree_ok_status();
+  iree_host_size_t new_capacity =
+      iree_max(iree_max((iree_host_size_t)8, *capacity * 2), minimum_capacity);
+  IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+      host_allocator, new_capacity * element_size, elements));
+  *capacity = new_capacity;
+  return iree_ok_status();
+}
+
+extern "C" iree_status_t iree_hal_vulkan_transient_pool_create(
+    VkDeviceHandle* logical_device, iree_device_size_t block_size,
+    iree_allocator_t host_allocator,
+    iree_hal_vulkan_transient_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(logical_device);
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_vulkan_transient_pool_t* pool = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*pool), (void**)&pool));
+  memset(pool, 0, sizeof(*pool));
+  iree_atomic_ref_count_init(&pool->ref_count);
+  pool->logical_device = logical_device;
+  pool->logical_device->AddReference();
+  pool->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&pool->mutex);
+
+  const auto& syms = logical_device->syms();
+  VkPhysicalDeviceVulkan11Properties device_props_11;
+  device_props_11.sType =
+      VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_1_PROPERTIES;
+  device_props_11.pNext = NULL;
+  VkPhysicalDeviceProperties2 device_props_2;
+  device_props_2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+  device_props_2.pNext = &device_props_11;
+  syms->vkGetPhysicalDeviceProperties2(logical_device->physical_device(),
+                                       &device_props_2);
+  pool->device_props = device_props_2.properties;
+  syms->vkGetPhysicalDeviceMemoryProperties(logical_device->physical_device(),
+                                            &pool->memory_props);
+
+  // Blocks must be valid allocations on their own.
+  pool->block_size =
+      iree_min(block_size, device_props_11.maxMemoryAllocationSize);
+
+  *out_pool = pool;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_vulkan_transient_block_free(
+    iree_hal_vulkan_transient_pool_t* pool,
+    iree_hal_vulkan_transient_block_t* block) {
+  VkDeviceHandle* logical_device = pool->logical_device;
+  IREE_TRACE_FREE_NAMED(IREE_HAL_VULKAN_TRANSIENT_POOL_ID,
+                        (void*)block->memory);
+  logical_device->syms()->vkFreeMemory(*logical_device, block->memory,
+                                       logical_device->allocator());
+  iree_allocator_free(pool->host_allocator, block->free_ranges);
+  iree_allocator_free(pool->host_allocator, block);
+}
+
+static void iree_hal_vulkan_transient_pool_destroy(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = pool->host_allocator;
+
+  // All buffers retain the pool and have been released. Pending ranges may
+  // remain (such as when their deallocation never completed) but the owning
+  // device waits for idle before releasing the pool.
+  for (iree_host_size_t i = 0; i < pool->pending_count; ++i) {
+    iree_hal_semaphore_release(pool->pending[i].semaphore);
+  }
+  iree_allocator_free(host_allocator, pool->pending);
+  for (iree_host_size_t i = 0; i < pool->block_count; ++i) {
+    iree_hal_vulkan_transient_block_free(pool, pool->blocks[i]);
+  }
+  iree_allocator_free(host_allocator, pool->blocks);
+
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  pool->logical_device->ReleaseReference();
+  iree_allocator_free(host_allocator, pool);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+extern "C" void iree_hal_vulkan_transient_pool_retain(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  if (IREE_LIKELY(pool)) {
+    iree_atomic_ref_count_inc(&pool->ref_count);
+  }
+}
+
+extern "C" void iree_hal_vulkan_transient_pool_release(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  if (IREE_LIKELY(pool) && iree_atomic_ref_count_dec(&pool->ref_count) == 1) {
+    iree_hal_vulkan_transient_pool_destroy(pool);
+  }
+}
+
+// Takes a range of |length| bytes aligned to |alignment| from the free ranges
+// of |block|. Returns false if no free range is large enough.
+static iree_status_t iree_hal_vulkan_transient_block_take(
+    iree_hal_vulkan_transient_pool_t* pool,
+    iree_hal_vulkan_transient_block_t* block, iree_device_size_t length,
+    iree_device_size_t alignment,
+    iree_hal_vulkan_transient_range_t* out_range, bool* out_found) {
+  *out_found = false;
+
+  // Ensure returning any range (including the new one) will not need to grow.
+  IREE_RETURN_IF_ERROR(iree_hal_vulkan_transient_pool_reserve(
+      pool->host_allocator, sizeof(block->free_ranges[0]),
+      block->live_count + 2, &block->free_capacity,
+      (void**)&block->free_ranges));
+
+  for (iree_host_size_t i = 0; i < block->free_count; ++i) {
+    iree_hal_vulkan_transient_range_t range = block->free_ranges[i];
+    const iree_device_size_t range_end = range.offset + range.length;
+    const iree_device_size_t offset =
+        iree_device_align(range.offset, alignment);
+    if (offset > range_end || range_end - offset < length) continue;
+    const iree_device_size_t head_length = offset - range.offset;
+    const iree_device_size_t tail_length = range_end - (offset + length);
+    if (head_length && tail_length) {
+      memmove(&block->free_ranges[i + 2], &block->free_ranges[i + 1],
+              (block->free_count - i - 1) * sizeof(block->free_ranges[0]));
+      ++block->free_count;
+      block->free_ranges[i].length = head_length;
+      block->free_ranges[i + 1].offset = offset + length;
+      block->free_ranges[i + 1].length = tail_length;
+    } else if (head_length) {
+      block->free_ranges[i].length = head_length;
+    } else if (tail_length) {
+      block->free_ranges[i].offset = offset + length;
+      block->free_ranges[i].length = tail_length;
+    } else {
+      memmove(&block->free_ranges[i], &block->free_ranges[i + 1],
+              (block->free_count - i - 1) * sizeof(block->free_ranges[0]));
+      --block->free_count;
+    }
+    ++block->live_count;
+    out_range->offset = offset;
+    out_range->length = length;
+    *out_found = true;
+    break;
+  }
+  return iree_ok_status();
+}
+
+// Returns |range| to the free ranges of |block|, coalescing with neighbors.
+static void iree_hal_vulkan_transient_block_give(
+    iree_hal_vulkan_transient_block_t* block,
+    iree_hal_vulkan_transient_range_t range) {
+  iree_host_size_t i = 0;
+  while (i < block->free_count && block->free_ranges[i].offset < range.offset) {
+    ++i;
+  }
+  const bool merge_prev =
+      i > 0 && block->free_ranges[i - 1].offset +
+                       block->free_ranges[i - 1].length ==
+                   range.offset;
+  const bool merge_next = i < block->free_count &&
+                          range.offset + range.length ==
+                              block->free_ranges[i].offset;
+  if (merge_prev && merge_next) {
+    block->free_ranges[i - 1].length +=
+        range.length + block->free_ranges[i].length;
+    memmove(&block->free_ranges[i], &block->free_ranges[i + 1],
+            (block->free_count - i - 1) * sizeof(block->free_ranges[0]));
+    --block->free_count;
+  } else if (merge_prev) {
+    block->free_ranges[i - 1].length += range.length;
+  } else if (merge_next) {
+    block->free_ranges[i].offset = range.offset;
+    block->free_ranges[i].length += range.length;
+  } else {
+    IREE_ASSERT_LT(block->free_count, block->free_capacity);
+    memmove(&block->free_ranges[i + 1], &block->free_ranges[i],
+            (block->free_count - i) * sizeof(block->free_ranges[0]));
+    block->free_ranges[i] = range;
+    ++block->free_count;
+  }
+  --block->live_count;
+}
+
+// Returns all pending ranges whose deallocation has completed to their blocks.
+// Ranges whose semaphores have failed are kept as the device may still be
+// using them.
+static void iree_hal_vulkan_transient_pool_reclaim_locked(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  iree_host_size_t i = 0;
+  while (i < pool->pending_count) {
+    iree_hal_vulkan_transient_pending_t* pending = &pool->pending[i];
+    uint64_t value = 0;
+    iree_status_t status = iree_hal_semaphore_query(pending->semaphore, &value);
+    if (!iree_status_is_ok(status) || value < pending->value) {
+      iree_status_ignore(status);
+      ++i;
+      continue;
+    }
+    iree_hal_vulkan_transient_block_give(pending->block, pending->range);
+    iree_hal_semaphore_release(pending->semaphore);
+    pool->pending[i] = pool->pending[--pool->pending_count];
+  }
+}
+
+// Returns true if work waiting on |wait_semaphore_list| is ordered after
+// |pending| has been deallocated.
+static bool iree_hal_vulkan_transient_pending_is_ordered_before(
+    const iree_hal_vulkan_transient_pending_t* pending,
+    const iree_hal_semaphore_list_t wait_semaphore_list) {
+  for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+    if (wait_semaphore_list.semaphores[i] == pending->semaphore &&
+        wait_semaphore_list.payload_values[i] >= pending->value) {
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reserves a range for a buffer with the given memory |requirements| from the
+// pool, allocating a new block if needed. Returns false if the pool cannot
+// allocate more device memory.
+static iree_status_t iree_hal_vulkan_transient_pool_reserve_range_locked(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    uint32_t memory_type_index, const VkMemoryRequirements* requirements,
+    iree_hal_vulkan_transient_block_t** out_block,
+    iree_hal_vulkan_transient_range_t* out_range, bool* out_found) {
+  *out_found = false;
+  iree_hal_vulkan_transient_pool_reclaim_locked(pool);
+
+  // Try free ranges in existing blocks first.
+  for (iree_host_size_t i = 0; i < pool->block_count; ++i) {
+    iree_hal_vulkan_transient_block_t* block = pool->blocks[i];
+    if (block->memory_type_index != memory_type_index) continue;
+    IREE_RETURN_IF_ERROR(iree_hal_vulkan_transient_block_take(
+        pool, block, requirements->size, requirements->alignment, out_range,
+        out_found));
+    if (*out_found) {
+      *out_block = block;
+      return iree_ok_status();
+    }
+  }
+
+  // Reuse a range still pending deallocation if the new allocation is queue
+  // ordered after it. The whole range is reserved to avoid tracking the
+  // remainder separately so only ranges close in size are considered.
+  for (iree_host_size_t i = 0; i < pool->pending_count; ++i) {
+    iree_hal_vulkan_transient_pending_t* pending = &pool->pending[i];
+    if (pending->block->memory_type_index != memory_type_index ||
+        pending->range.length > requirements->size * 2 ||
+        !iree_hal_vulkan_transient_pending_is_ordered_before(
+            pending, wait_semaphore_list)) {
+      continue;
+    }
+    const iree_device_size_t range_end =
+        pending->range.offset + pending->range.length;
+    const iree_device_size_t offset =
+        iree_device_align(pending->range.offset, requirements->alignment);
+    if (offset > range_end || range_end - offset < requirements->size) {
+      continue;
+    }
+    *out_block = pending->block;
+    *out_range = pending->range;
+    *out_found = true;
+    iree_hal_semaphore_release(pending->semaphore);
+    pool->pending[i] = pool->pending[--pool->pending_count];
+    return iree_ok_status();
+  }
+
+  // Allocate a new block.
+  IREE_RETURN_IF_ERROR(iree_hal_vulkan_transient_pool_reserve(
+      pool->host_allocator, sizeof(pool->blocks[0]), pool->block_count + 1,
+      &pool->block_capacity, (void**)&pool->blocks));
+  iree_hal_vulkan_transient_block_t* block = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      pool->host_allocator, sizeof(*block), (void**)&block));
+  memset(block, 0, sizeof(*block));
+  block->memory_type_index = memory_type_index;
+  block->size = iree_max(pool->block_size, requirements->size);
+  iree_status_t status = iree_hal_vulkan_transient_pool_reserve(
+      pool->host_allocator, sizeof(block->free_ranges[0]), 2,
+      &block->free_capacity, (void**)&block->free_ranges);
+  VkResult result = VK_SUCCESS;
+  if (iree_status_is_ok(status)) {
+    VkDeviceHandle* logical_device = pool->logical_device;
+    VkMemoryAllocateInfo allocate_info = {};
+    allocate_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+    allocate_info.pNext = NULL;
+    allocate_info.allocationSize = block->size;
+    allocate_info.memoryTypeIndex = memory_type_index;
+    VkMemoryAllocateFlagsInfo allocate_flags_info = {};
+    allocate_flags_info.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+    allocate_flags_info.pNext = NULL;
+    allocate_flags_info.flags = 0;
+    if (iree_all_bits_set(
+            logical_device->enabled_features(),
+            IREE_HAL_VULKAN_FEATURE_ENABLE_BUFFER_DEVICE_ADDRESSES)) {
+      allocate_flags_info.flags |= VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+    }
+    allocate_flags_info.deviceMask = 0;
+    allocate_info.pNext = &allocate_flags_info;
+    result = logical_device->syms()->vkAllocateMemory(
+        *logical_device, &allocate_info, logical_device->allocator(),
+        &block->memory);
+  }
+  if (!iree_status_is_ok(status) || result != VK_SUCCESS) {
+    // Device memory exhaustion is not an error here as the caller can still
+    // try to allocate a dedicated buffer.
+    iree_allocator_free(pool->host_allocator, block->free_ranges);
+    iree_allocator_free(pool->host_allocator, block);
+    return status;
+  }
+  IREE_TRACE_ALLOC_NAMED(IREE_HAL_VULKAN_TRANSIENT_POOL_ID,
+                         (void*)block->memory, block->size);
+  block->free_ranges[0].offset = 0;
+  block->free_ranges[0].length = block->size;
+  block->free_count = 1;
+  pool->blocks[pool->block_count++] = block;
+
+  IREE_RETURN_IF_ERROR(iree_hal_vulkan_transient_block_take(
+      pool, block, requirements->size, requirements->alignment, out_range,
+      out_found));
+  *out_block = block;
+  return iree_ok_status();
+}
+
+extern "C" void iree_hal_vulkan_transient_pool_trim(
+    iree_hal_vulkan_transient_pool_t* pool) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&pool->mutex);
+
+  iree_hal_vulkan_transient_pool_reclaim_locked(pool);
+  iree_host_size_t i = 0;
+  while (i < pool->block_count) {
+    iree_hal_vulkan_transient_block_t* block = pool->blocks[i];
+    if (block->live_count == 0) {
+      iree_hal_vulkan_transient_block_free(pool, block);
+      pool->blocks[i] = pool->blocks[--pool->block_count];
+    } else {
+      ++i;
+    }
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)pool->block_count);
+
+  iree_slim_mutex_unlock(&pool->mutex);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_hal_vulkan_transient_pool_buffer_release(
+    void* user_data, VkDeviceHandle* logical_device,
+    VkDeviceMemory device_memory, VkBuffer handle) {
+  iree_hal_vulkan_transient_allocation_t* allocation =
+      (iree_hal_vulkan_transient_allocation_t*)user_data;
+  iree_hal_vulkan_transient_pool_t* pool = allocation->pool;
+  IREE_TRACE_FREE_NAMED(IREE_HAL_VULKAN_TRANSIENT_POOL_ID, (void*)handle);
+
+  logical_device->syms()->vkDestroyBuffer(*logical_device, handle,
+                                          logical_device->allocator());
+
+  // Ranges that were not deallocated on a queue are immediately reusable as
+  // the buffer is no longer used by any work.
+  iree_slim_mutex_lock(&pool->mutex);
+  if (!allocation->is_deallocated) {
+    iree_hal_vulkan_transient_block_give(allocation->block, allocation->range);
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+
+  iree_allocator_free(pool->host_allocator, allocation);
+  iree_hal_vulkan_transient_pool_release(pool);
+}
+
+extern "C" iree_status_t iree_hal_vulkan_transient_pool_alloca(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(params);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  *out_buffer = NULL;
+
+  // Only device-local buffers that will never be mapped or shared can live
+  // within a larger allocation.
+  iree_hal_buffer_params_t buffer_params = *params;
+  iree_hal_buffer_params_canonicalize(&buffer_params);
+  buffer_params.type &= ~IREE_HAL_MEMORY_TYPE_OPTIMAL;
+  if (!iree_all_bits_set(buffer_params.type,
+                         IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL) ||
+      iree_any_bit_set(buffer_params.type,
+                       IREE_HAL_MEMORY_TYPE_HOST_VISIBLE) ||
+      iree_any_bit_set(buffer_params.usage,
+                       IREE_HAL_BUFFER_USAGE_MAPPING |
+                           IREE_HAL_BUFFER_USAGE_SHARING_EXPORT)) {
+    return iree_ok_status();
+  }
+
+  // Match the sizing rules of the native allocator.
+  if (allocation_size == 0) allocation_size = 4;
+  allocation_size = iree_device_align(allocation_size, 4);
+  if (allocation_size > pool->block_size / 2) return iree_ok_status();
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)allocation_size);
+  VkDeviceHandle* logical_device = pool->logical_device;
+
+  // Create the buffer and find out where it can be placed.
+  VkBuffer handle = VK_NULL_HANDLE;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_vulkan_native_allocator_create_buffer(
+              logical_device, &buffer_params, allocation_size,
+              /*use_sparse_allocation=*/false,
+              /*bind_host_memory=*/false, &handle));
+  VkMemoryRequirements requirements = {0};
+  logical_device->syms()->vkGetBufferMemoryRequirements(*logical_device, handle,
+                                                        &requirements);
+  uint32_t memory_type_index = 0;
+  iree_status_t status = iree_hal_vulkan_find_memory_type(
+      &pool->device_props, &pool->memory_props, &buffer_params,
+      /*allowed_type_indices=*/requirements.memoryTypeBits,
+      &memory_type_index);
+  if (!iree_status_is_ok(status)) {
+    // Let the dedicated allocation path report the error.
+    status = iree_status_ignore(status);
+    logical_device->syms()->vkDestroyBuffer(*logical_device, handle,
+                                            logical_device->allocator());
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  iree_hal_vulkan_transient_allocation_t* allocation = NULL;
+  status = iree_allocator_malloc(pool->host_allocator, sizeof(*allocation),
+                                 (void**)&allocation);
+  bool found = false;
+  if (iree_status_is_ok(status)) {
+    memset(allocation, 0, sizeof(*allocation));
+    iree_slim_mutex_lock(&pool->mutex);
+    status = iree_hal_vulkan_transient_pool_reserve_range_locked(
+        pool, wait_semaphore_list, memory_type_index, &requirements,
+        &allocation->block, &allocation->range, &found);
+    iree_slim_mutex_unlock(&pool->mutex);
+  }
+  if (!iree_status_is_ok(status) || !found) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "pool exhausted");
+    iree_allocator_free(pool->host_allocator, allocation);
+    logical_device->syms()->vkDestroyBuffer(*logical_device, handle,
+                                            logical_device->allocator());
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  allocation->pool = pool;
+  iree_hal_vulkan_transient_pool_retain(pool);
+
+  IREE_TRACE_ALLOC_NAMED(IREE_HAL_VULKAN_TRANSIENT_POOL_ID, (void*)handle,
+                         allocation_size);
+
+  // Wrap the buffer; from here on the release callback owns the allocation.
+  // The device memory is not exposed as it is shared with other buffers.
+  iree_hal_vulkan_native_buffer_release_callback_t internal_release_callback = {
+      0};
+  internal_release_callback.fn = iree_hal_vulkan_transient_pool_buffer_release;
+  internal_release_callback.user_data = allocation;
+  iree_hal_buffer_t* buffer = NULL;
+  status = iree_hal_vulkan_native_buffer_wrap(
+      /*allocator=*/NULL, buffer_params.type, buffer_params.access,
+      buffer_params.usage, allocation_size, /*byte_offset=*/0,
+      /*byte_length=*/allocation_size, logical_device,
+      /*device_memory=*/VK_NULL_HANDLE, handle, internal_release_callback,
+      iree_hal_buffer_release_callback_null(), &buffer);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_vulkan_transient_pool_buffer_release(allocation, logical_device,
+                                                  VK_NULL_HANDLE, handle);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Bind the buffer to its range within the block.
+  status = VK_RESULT_TO_STATUS(
+      logical_device->syms()->vkBindBufferMemory(
+          *logical_device, handle, allocation->block->memory,
+          iree_device_align(allocation->range.offset, requirements.alignment)),
+      "vkBindBufferMemory");
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+extern "C" bool iree_hal_vulkan_transient_pool_dealloca(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_hal_vulkan_transient_allocation_t* allocation =
+      (iree_hal_vulkan_transient_allocation_t*)
+          iree_hal_vulkan_native_buffer_release_user_data(
+              iree_hal_buffer_allocated_buffer(buffer),
+              iree_hal_vulkan_transient_pool_buffer_release);
+  if (!allocation || allocation->pool != pool) return false;
+
+  // Without a timepoint to order reuse against the range is returned when the
+  // buffer is released.
+  if (signal_semaphore_list.count == 0) return false;
+
+  iree_slim_mutex_lock(&pool->mutex);
+  bool scheduled = false;
+  if (!allocation->is_deallocated) {
+    iree_status_t status = iree_hal_vulkan_transient_pool_reserve(
+        pool->host_allocator, sizeof(pool->pending[0]),
+        pool->pending_count + 1, &pool->pending_capacity,
+        (void**)&pool->pending);
+    if (iree_status_is_ok(status)) {
+      iree_hal_vulkan_transient_pending_t* pending =
+          &pool->pending[pool->pending_count++];
+      pending->block = allocation->block;
+      pending->range = allocation->range;
+      pending->semaphore = signal_semaphore_list.semaphores[0];
+      iree_hal_semaphore_retain(pending->semaphore);
+      pending->value = signal_semaphore_list.payload_values[0];
+      allocation->is_deallocated = true;
+      scheduled = true;
+    } else {
+      // Falls back to returning the range when the buffer is released.
+      iree_status_ignore(status);
+    }
+  }
+  iree_slim_mutex_unlock(&pool->mutex);
+  return scheduled;
+}
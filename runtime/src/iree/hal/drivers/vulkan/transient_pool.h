@@ -0,0 +1,97 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_DRIVERS_VULKAN_TRANSIENT_POOL_H_
+#define IREE_HAL_DRIVERS_VULKAN_TRANSIENT_POOL_H_
+
+// clang-format off: must be included before all other headers.
+#include "iree/hal/drivers/vulkan/vulkan_headers.h"  // IWYU pragma: export
+// clang-format on
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/drivers/vulkan/handle_util.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Default minimum size of device memory blocks allocated by transient pools.
+#if !defined(IREE_HAL_VULKAN_TRANSIENT_POOL_BLOCK_SIZE)
+#define IREE_HAL_VULKAN_TRANSIENT_POOL_BLOCK_SIZE (64 * 1024 * 1024)
+#endif  // !IREE_HAL_VULKAN_TRANSIENT_POOL_BLOCK_SIZE
+
+// Suballocates queue-ordered transient buffers from large VkDeviceMemory
+// blocks. Each block holds memory of a single memory type and buffers are
+// bound at offsets within it so that the number of driver allocations is
+// bounded by the peak transient memory usage instead of the number of
+// allocations made over the lifetime of the device.
+//
+// Ranges deallocated with iree_hal_vulkan_transient_pool_dealloca are reused
+// once the timepoint the deallocation signals has been reached or immediately
+// by allocations that wait on that timepoint (as the device will have
+// completed all work using the prior buffer before any work using the new one
+// begins). Buffers that are released without being deallocated return their
+// ranges to the pool immediately as the HAL guarantees no work is in-flight
+// using them.
+//
+// Only device-local buffers that are not mappable or exportable are serviced
+// as VkDeviceMemory can only be mapped once at a time and suballocated memory
+// cannot be shared as a distinct allocation. Callers are expected to fall back
+// to a dedicated allocation for other buffers.
+//
+// Thread-safe. Buffers allocated from the pool keep the pool alive.
+typedef struct iree_hal_vulkan_transient_pool_t
+    iree_hal_vulkan_transient_pool_t;
+
+// Creates a transient pool that allocates device memory blocks of at least
+// |block_size| bytes from |logical_device|. Allocations larger than half of the
+// block size are not serviced by the pool.
+iree_status_t iree_hal_vulkan_transient_pool_create(
+    iree::hal::vulkan::VkDeviceHandle* logical_device,
+    iree_device_size_t block_size, iree_allocator_t host_allocator,
+    iree_hal_vulkan_transient_pool_t** out_pool);
+
+// Retains the given |pool| for the caller.
+void iree_hal_vulkan_transient_pool_retain(
+    iree_hal_vulkan_transient_pool_t* pool);
+
+// Releases the given |pool| from the caller.
+void iree_hal_vulkan_transient_pool_release(
+    iree_hal_vulkan_transient_pool_t* pool);
+
+// Returns ranges whose deallocation has completed to the pool and frees all
+// blocks that have no live allocations.
+void iree_hal_vulkan_transient_pool_trim(
+    iree_hal_vulkan_transient_pool_t* pool);
+
+// Allocates a transient buffer from the pool that will be used by work
+// waiting on |wait_semaphore_list|. The buffer is usable by any work ordered
+// after the wait semaphores are reached and is returned in |out_buffer|.
+// If the pool cannot service the request (unsupported parameters, sizes, or
+// memory exhaustion) |out_buffer| is set to NULL and the caller must perform
+// the allocation another way.
+iree_status_t iree_hal_vulkan_transient_pool_alloca(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_buffer_params_t* params, iree_device_size_t allocation_size,
+    iree_hal_buffer_t** out_buffer);
+
+// Schedules the memory of |buffer| for reuse once the first semaphore in
+// |signal_semaphore_list| reaches its payload value. The buffer contents are
+// undefined after that point even if the buffer is still referenced.
+// Returns false if |buffer| was not allocated from |pool| or was already
+// deallocated.
+bool iree_hal_vulkan_transient_pool_dealloca(
+    iree_hal_vulkan_transient_pool_t* pool,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* buffer);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_DRIVERS_VULKAN_TRANSIENT_POOL_H_
@@ -16,6 +16,7 @@
 #include "iree/hal/drivers/vulkan/api.h"
 #include "iree/hal/drivers/vulkan/builtin_executables.h"
 #include "iree/hal/drivers/vulkan/command_queue.h"
+#include "iree/hal/drivers/vulkan/command_buffer_cache.h"
 #include "iree/hal/drivers/vulkan/descriptor_pool_cache.h"
 #include "iree/hal/drivers/vulkan/direct_command_buffer.h"
 #include "iree/hal/drivers/vulkan/direct_command_queue.h"
@@ -26,13 +27,15 @@
 #include "iree/hal/drivers/vulkan/native_event.h"
 #include "iree/hal/drivers/vulkan/native_semaphore.h"
 #include "iree/hal/drivers/vulkan/nop_executable_cache.h"
+#include "iree/hal/drivers/vulkan/pipeline_executable_cache.h"
 #include "iree/hal/drivers/vulkan/status_util.h"
 #include "iree/hal/drivers/vulkan/tracing.h"
+#include "iree/hal/drivers/vulkan/transient_pool.h"
 #include "iree/hal/drivers/vulkan/util/arena.h"
 #include "iree/hal/drivers/vulkan/util/ref_ptr.h"
 #include "iree/hal/utils/deferred_command_buffer.h"
+#include "iree/hal/utils/file_registry.h"
 #include "iree/hal/utils/file_transfer.h"
-#include "iree/hal/utils/memory_file.h"
 
 using namespace iree::hal::vulkan;
 
@@ -472,7 +475,7 @@ static iree_status_t iree_hal_vulkan_build_queue_sets(
   uint32_t base_queue_index = 0;
   if (queue_family_info.dispatch_index == queue_family_info.transfer_index) {
     // Sharing a family, so transfer queues follow compute queues.
-    base_queue_index = queue_family_info.dispatch_index;
+    base_queue_index = (uint32_t)queue_family_info.dispatch_queue_count;
   }
   for (iree_host_size_t i = 0; i < queue_family_info.transfer_queue_count;
        ++i) {
@@ -496,6 +499,8 @@ typedef struct iree_hal_vulkan_device_t {
 
   // Flags overriding default device behavior.
   iree_hal_vulkan_device_flags_t flags;
+  // Optional directory where pipeline caches are persisted.
+  iree_string_view_t pipeline_cache_path;
   // Which optional extensions are active and available on the device.
   iree_hal_vulkan_device_extensions_t device_extensions;
   // Device properties for various optional features.
@@ -508,6 +513,9 @@ typedef struct iree_hal_vulkan_device_t {
   iree_allocator_t host_allocator;
   iree_hal_allocator_t* device_allocator;
 
+  // Pool servicing queue-ordered transient allocations.
+  iree_hal_vulkan_transient_pool_t* transient_pool;
+
   // Optional provider used for creating/configuring collective channels.
   iree_hal_channel_provider_t* channel_provider;
 
@@ -537,6 +545,10 @@ typedef struct iree_hal_vulkan_device_t {
 
   BuiltinExecutables* builtin_executables;
 
+  // Native command buffers translated from reusable command buffers with
+  // indirect bindings that can be resubmitted without recording.
+  iree_hal_vulkan_command_buffer_cache_t command_buffer_cache;
+
 #if defined(IREE_HAL_VULKAN_HAVE_RENDERDOC)
   RENDERDOC_API_LATEST* renderdoc_api;
 #endif  // IREE_HAL_VULKAN_HAVE_RENDERDOC
@@ -612,11 +624,9 @@ static iree_status_t iree_hal_vulkan_device_initialize_command_queues(
   // the tracing subsystem for query and cleanup tasks.
   VkQueue maintenance_dispatch_queue = VK_NULL_HANDLE;
 
-  uint64_t compute_queue_count =
-      iree_math_count_ones_u64(compute_queue_set->queue_indices);
   uint64_t transfer_queue_count =
       iree_math_count_ones_u64(transfer_queue_set->queue_indices);
-  for (iree_host_size_t i = 0; i < compute_queue_count; ++i) {
+  for (iree_host_size_t i = 0; i < 64; ++i) {
     if (!(compute_queue_set->queue_indices & (1ull << i))) continue;
 
     char queue_name_buffer[32];
@@ -654,7 +664,7 @@ static iree_status_t iree_hal_vulkan_device_initialize_command_queues(
       queue->set_tracing_context(device->queue_tracing_contexts[queue_index]);
     }
   }
-  for (iree_host_size_t i = 0; i < transfer_queue_count; ++i) {
+  for (iree_host_size_t i = 0; i < 64; ++i) {
     if (!(transfer_queue_set->queue_indices & (1ull << i))) continue;
 
     char queue_name_buffer[32];
@@ -705,7 +715,7 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
 
   iree_hal_vulkan_device_t* device = NULL;
   iree_host_size_t total_size =
-      sizeof(*device) + identifier.size +
+      sizeof(*device) + identifier.size + options->pipeline_cache_path.size +
       total_queue_count * sizeof(device->queues[0]) +
       total_queue_count * sizeof(device->dispatch_queues[0]) +
       total_queue_count * sizeof(device->transfer_queues[0]) +
@@ -722,6 +732,9 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
   buffer_ptr += iree_string_view_append_to_buffer(
       identifier, &device->identifier, (char*)buffer_ptr);
   device->flags = options->flags;
+  buffer_ptr += iree_string_view_append_to_buffer(
+      options->pipeline_cache_path, &device->pipeline_cache_path,
+      (char*)buffer_ptr);
 
   device->device_extensions = *device_extensions;
   device->device_properties = *device_properties;
@@ -751,6 +764,15 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
 
   device->descriptor_pool_cache =
       new DescriptorPoolCache(device->logical_device);
+  iree_hal_vulkan_command_buffer_cache_initialize(
+      host_allocator, &device->command_buffer_cache);
+
+  // Resources must be usable from all queue families we submit to.
+  logical_device->set_queue_families(
+      compute_queue_set->queue_family_index,
+      transfer_queue_set->queue_indices != 0
+          ? transfer_queue_set->queue_family_index
+          : compute_queue_set->queue_family_index);
 
   // Create the device memory allocator that will service all buffer
   // allocation requests.
@@ -758,6 +780,13 @@ static iree_status_t iree_hal_vulkan_device_create_internal(
       options, instance, physical_device, logical_device,
       &device->device_allocator);
 
+  // Create the pool used to suballocate transient (queue_alloca) buffers.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_vulkan_transient_pool_create(
+        logical_device, IREE_HAL_VULKAN_TRANSIENT_POOL_BLOCK_SIZE,
+        host_allocator, &device->transient_pool);
+  }
+
   // Create command pools for each queue family. If we don't have a transfer
   // queue then we'll ignore that one and just use the dispatch pool.
   // If we wanted to expose the pools through the HAL to allow the VM to more
@@ -808,6 +837,10 @@ static void iree_hal_vulkan_device_destroy(iree_hal_device_t* base_device) {
     iree_hal_vulkan_tracing_context_free(device->queue_tracing_contexts[i]);
   }
 
+  // Cached command buffers were allocated from the command pools.
+  iree_hal_vulkan_command_buffer_cache_deinitialize(
+      &device->command_buffer_cache);
+
   // Drop command pools now that we know there are no more outstanding command
   // buffers.
   delete device->dispatch_command_pool;
@@ -818,6 +851,10 @@ static void iree_hal_vulkan_device_destroy(iree_hal_device_t* base_device) {
   delete device->builtin_executables;
   delete device->descriptor_pool_cache;
 
+  // Transient buffers retain the pool and all pending deallocations have
+  // completed now that the queues are idle.
+  iree_hal_vulkan_transient_pool_release(device->transient_pool);
+
   // There should be no more buffers live that use the allocator.
   iree_hal_allocator_release(device->device_allocator);
 
@@ -1423,7 +1460,10 @@ static void iree_hal_vulkan_replace_channel_provider(
 static iree_status_t iree_hal_vulkan_device_trim(
     iree_hal_device_t* base_device) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+  iree_hal_vulkan_command_buffer_cache_trim(&device->command_buffer_cache);
   iree_arena_block_pool_trim(&device->block_pool);
+  iree_hal_vulkan_transient_pool_trim(device->transient_pool);
+  device->descriptor_pool_cache->Trim();
   return iree_hal_allocator_trim(device->device_allocator);
 }
 
@@ -1502,22 +1542,19 @@ static CommandQueue* iree_hal_vulkan_device_select_queue(
     iree_hal_vulkan_device_t* device,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity) {
-  // TODO(scotttodd): revisit queue selection logic and remove this
-  //   * the unaligned buffer fill polyfill and tracing timestamp queries may
-  //     both insert dispatches into command buffers that at compile time are
-  //     expected to only contain transfer commands
-  //   * we could set a bit at recording time if emulation or tracing is used
-  //     and submit to the right queue based on that
-  command_categories |= IREE_HAL_COMMAND_CATEGORY_DISPATCH;
-
-  // TODO(benvanik): meaningful heuristics for affinity. We don't generate
-  // anything from the compiler that uses multiple queues and until we do it's
-  // best not to do anything too clever here.
+  // Each affinity bit maps to one queue of the requested kind with the lowest
+  // set bit selecting the queue. IREE_HAL_QUEUE_AFFINITY_ANY (and 0) always
+  // select the first queue so that unannotated work stays in order. Transfer-
+  // only work uses dedicated transfer queues (if any) and can overlap with
+  // dispatches; ordering between queues is established by the timeline
+  // semaphores of each submission.
+  iree_host_size_t queue_ordinal =
+      queue_affinity ? iree_math_count_trailing_zeros_u64(queue_affinity) : 0;
   if (command_categories == IREE_HAL_COMMAND_CATEGORY_TRANSFER) {
     return device
-        ->transfer_queues[queue_affinity % device->transfer_queue_count];
+        ->transfer_queues[queue_ordinal % device->transfer_queue_count];
   }
-  return device->dispatch_queues[queue_affinity % device->dispatch_queue_count];
+  return device->dispatch_queues[queue_ordinal % device->dispatch_queue_count];
 }
 
 static iree_status_t iree_hal_vulkan_device_create_channel(
@@ -1591,6 +1628,11 @@ static iree_status_t iree_hal_vulkan_device_create_executable_cache(
     iree_hal_device_t* base_device, iree_string_view_t identifier,
     iree_loop_t loop, iree_hal_executable_cache_t** out_executable_cache) {
   iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+  if (!iree_string_view_is_empty(device->pipeline_cache_path)) {
+    return iree_hal_vulkan_pipeline_executable_cache_create(
+        device->logical_device, device->physical_device,
+        device->pipeline_cache_path, out_executable_cache);
+  }
   return iree_hal_vulkan_nop_executable_cache_create(
       device->logical_device, identifier, out_executable_cache);
 }
@@ -1599,14 +1641,8 @@ static iree_status_t iree_hal_vulkan_device_import_file(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
     iree_hal_external_file_flags_t flags, iree_hal_file_t** out_file) {
-  if (iree_io_file_handle_type(handle) !=
-      IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
-    return iree_make_status(
-        IREE_STATUS_UNAVAILABLE,
-        "implementation does not support the external file type");
-  }
-  return iree_hal_memory_file_wrap(
-      queue_affinity, access, handle, iree_hal_device_allocator(base_device),
+  return iree_hal_file_from_handle(
+      iree_hal_device_allocator(base_device), queue_affinity, access, handle,
       iree_hal_device_host_allocator(base_device), out_file);
 }
 
@@ -1639,14 +1675,31 @@ static iree_status_t iree_hal_vulkan_device_queue_alloca(
     iree_hal_allocator_pool_t pool, iree_hal_buffer_params_t params,
     iree_device_size_t allocation_size,
     iree_hal_buffer_t** IREE_RESTRICT out_buffer) {
-  // TODO(benvanik): queue-ordered allocations.
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_wait(wait_semaphore_list,
-                                                    iree_infinite_timeout()));
-  IREE_RETURN_IF_ERROR(
-      iree_hal_allocator_allocate_buffer(iree_hal_device_allocator(base_device),
-                                         params, allocation_size, out_buffer));
-  IREE_RETURN_IF_ERROR(iree_hal_semaphore_list_signal(signal_semaphore_list));
-  return iree_ok_status();
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+  *out_buffer = NULL;
+
+  // Memory is reserved immediately and only the availability of the buffer is
+  // ordered on the queue: the pool only hands out ranges whose prior users
+  // have completed or that the waits order after. Buffers the pool cannot
+  // service get a dedicated allocation. Neither path blocks on the waits.
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_vulkan_transient_pool_alloca(
+      device->transient_pool, wait_semaphore_list, &params, allocation_size,
+      &buffer));
+  if (!buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_allocator_allocate_buffer(
+        iree_hal_device_allocator(base_device), params, allocation_size,
+        &buffer));
+  }
+
+  iree_status_t status = iree_hal_device_queue_barrier(
+      base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list);
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  return status;
 }
 
 static iree_status_t iree_hal_vulkan_device_queue_dealloca(
@@ -1654,12 +1707,86 @@ static iree_status_t iree_hal_vulkan_device_queue_dealloca(
     const iree_hal_semaphore_list_t wait_semaphore_list,
     const iree_hal_semaphore_list_t signal_semaphore_list,
     iree_hal_buffer_t* buffer) {
-  // TODO(benvanik): queue-ordered allocations.
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
   IREE_RETURN_IF_ERROR(iree_hal_device_queue_barrier(
       base_device, queue_affinity, wait_semaphore_list, signal_semaphore_list));
+
+  // Pooled memory is reusable once the barrier completes. Buffers that did not
+  // come from the pool are freed when they are released.
+  iree_hal_vulkan_transient_pool_dealloca(device->transient_pool,
+                                          signal_semaphore_list, buffer);
   return iree_ok_status();
 }
 
+static iree_status_t iree_hal_vulkan_device_queue_copy(
+    iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* source_buffer, iree_device_size_t source_offset,
+    iree_hal_buffer_t* target_buffer, iree_device_size_t target_offset,
+    iree_device_size_t length, iree_hal_copy_flags_t flags) {
+  iree_hal_vulkan_device_t* device = iree_hal_vulkan_device_cast(base_device);
+
+  // Copies run on the transfer queues so that uploads and readbacks (including
+  // the staging copies of queue_read/queue_write) overlap with dispatches.
+  // Tracing may insert dispatches into command buffers so when enabled we use
+  // the dispatch queues like all other work.
+  if (!device->transfer_command_pool ||
+      iree_all_bits_set(device->logical_device->enabled_features(),
+                        IREE_HAL_VULKAN_FEATURE_ENABLE_TRACING)) {
+    return iree_hal_device_queue_emulated_copy(
+        base_device, queue_affinity, wait_semaphore_list,
+        signal_semaphore_list, source_buffer, source_offset, target_buffer,
+        target_offset, length, flags);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)length);
+
+  CommandQueue* queue = iree_hal_vulkan_device_select_queue(
+      device, IREE_HAL_COMMAND_CATEGORY_TRANSFER, queue_affinity);
+
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_vulkan_direct_command_buffer_allocate(
+              iree_hal_device_allocator(base_device), device->logical_device,
+              device->transfer_command_pool,
+              IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+              IREE_HAL_COMMAND_CATEGORY_TRANSFER, queue_affinity,
+              /*binding_capacity=*/0, queue->tracing_context(),
+              device->descriptor_pool_cache, device->builtin_executables,
+              &device->block_pool, &command_buffer));
+  iree_status_t status = iree_hal_command_buffer_begin(command_buffer);
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_copy_buffer(
+        command_buffer,
+        iree_hal_make_buffer_ref(source_buffer, source_offset, length),
+        iree_hal_make_buffer_ref(target_buffer, target_offset, length), flags);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_end(command_buffer);
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_hal_vulkan_submission_batch_t batch = {
+        /*.wait_semaphores=*/wait_semaphore_list,
+        /*.command_buffer_count=*/1,
+        /*.command_buffers=*/&command_buffer,
+        /*.signal_semaphores=*/signal_semaphore_list,
+    };
+    status = queue->Submit(1, &batch);
+  }
+
+  // HACK: we don't track async resource lifetimes so we have to block.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_list_wait(signal_semaphore_list,
+                                          iree_infinite_timeout());
+  }
+
+  iree_hal_command_buffer_release(command_buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_vulkan_device_queue_read(
     iree_hal_device_t* base_device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -1719,14 +1846,31 @@ static iree_status_t iree_hal_vulkan_device_queue_execute(
   // buffers on demand here. When we natively support them we'll still need to
   // process the binding table prior to submission but that can be done in a
   // much more lightweight way depending on our concurrency needs.
+  //
+  // Reusable command buffers are translated once per binding table and the
+  // native command buffer is cached and resubmitted as-is on subsequent
+  // executions with the same bindings.
   iree_hal_command_buffer_t* translated_command_buffer = NULL;
+  bool is_reusable = false;
   iree_status_t status = iree_ok_status();
   if (command_buffer != NULL) {
     if (iree_hal_deferred_command_buffer_isa(command_buffer)) {
+      is_reusable =
+          !iree_all_bits_set(iree_hal_command_buffer_mode(command_buffer),
+                             IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT);
+      if (is_reusable) {
+        translated_command_buffer =
+            iree_hal_vulkan_command_buffer_cache_acquire(
+                &device->command_buffer_cache, command_buffer, binding_table);
+      }
+    }
+    if (translated_command_buffer) {
+      // Reusing a previously translated command buffer.
+    } else if (iree_hal_deferred_command_buffer_isa(command_buffer)) {
       status = iree_hal_vulkan_device_create_command_buffer(
           base_device,
           iree_hal_command_buffer_mode(command_buffer) |
-              IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT |
+              (is_reusable ? 0 : IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT) |
               // NOTE: we need to validate if a binding table is provided as the
               // bindings were not known when it was originally recorded.
               (iree_hal_buffer_binding_table_is_empty(binding_table)
@@ -1762,8 +1906,15 @@ static iree_status_t iree_hal_vulkan_device_queue_execute(
                                           iree_infinite_timeout());
   }
 
+  // The submission has completed (see above) so the translated command buffer
+  // can be reused by the next execution with the same bindings.
   // TODO(indirect-cmd): when async these need to be retained until the
-  // submission completes.
+  // submission completes and returned to the cache after that.
+  if (iree_status_is_ok(status) && is_reusable && translated_command_buffer) {
+    iree_hal_vulkan_command_buffer_cache_release(
+        &device->command_buffer_cache, command_buffer, binding_table,
+        translated_command_buffer);
+  }
   iree_hal_command_buffer_release(translated_command_buffer);
 
   return status;
@@ -1894,7 +2045,7 @@ const iree_hal_device_vtable_t iree_hal_vulkan_device_vtable = {
     /*.queue_dealloca=*/iree_hal_vulkan_device_queue_dealloca,
     /*.queue_fill=*/iree_hal_device_queue_emulated_fill,
     /*.queue_update=*/iree_hal_device_queue_emulated_update,
-    /*.queue_copy=*/iree_hal_device_queue_emulated_copy,
+    /*.queue_copy=*/iree_hal_vulkan_device_queue_copy,
     /*.queue_read=*/iree_hal_vulkan_device_queue_read,
     /*.queue_write=*/iree_hal_vulkan_device_queue_write,
     /*.queue_execute=*/iree_hal_vulkan_device_queue_execute,
@@ -13,6 +13,7 @@
 #include "iree/base/api.h"
 #include "iree/hal/executable.h"
 #include "iree/hal/resource.h"
+#include "iree/io/file_handle.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -67,6 +68,13 @@ enum iree_hal_executable_caching_mode_bits_t {
   // be enabled for real usage as the verification is the best way to catch
   // API misuse.
   IREE_HAL_EXECUTABLE_CACHING_MODE_DISABLE_VERIFICATION = 1u << 6,
+  // Allows the cache to defer loading the executable until it is first used.
+  // Preparation may return a lightweight handle and perform the full load (and
+  // report any errors it produces) when the first dispatch using it is
+  // recorded. Only honored in combination with
+  // IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA as the data must
+  // remain available until the deferred load happens.
+  IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_DEFERRED_LOADING = 1u << 7,
 };
 typedef uint32_t iree_hal_executable_caching_mode_t;
 
@@ -91,6 +99,15 @@ typedef struct iree_hal_executable_params_t {
   // to any executable created using it still held by the caller.
   iree_const_byte_span_t executable_data;
 
+  // Optional file that |executable_data| was read or mapped from starting at
+  // |executable_file_offset|. Loaders that support it may map the executable
+  // contents directly from the file so that read-only pages are shared across
+  // all processes loading the same file instead of being copied into private
+  // memory. The file must not be modified while executables created from it
+  // are live. Ignored by implementations that do not support file mapping.
+  iree_io_file_handle_t* executable_file;
+  uint64_t executable_file_offset;
+
   // Executable-level constants table used to perform runtime specialization
   // when information is not available statically during compilation. The
   // compiler defines the contents of the table, how they are populated, and
@@ -176,6 +193,23 @@ IREE_API_EXPORT iree_status_t iree_hal_executable_cache_prepare_executable(
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable);
 
+// Prepares |count| executables defined by |executable_params| for use.
+// Each resulting executable is stored in the corresponding index of
+// |out_executables|. Preparation is all-or-nothing: if any executable fails to
+// prepare then all executables prepared by the call are released, every entry
+// in |out_executables| is NULL, and the first failure is returned.
+//
+// Issuing all executables a program requires in one batch allows
+// implementations to overlap expensive preparation (JIT compilation, pipeline
+// creation, etc) across executables instead of serializing it. Callers
+// blocking on initialization should prefer this over repeated calls to
+// iree_hal_executable_cache_prepare_executable. Implementations that do not
+// support batching prepare each executable in order.
+IREE_API_EXPORT iree_status_t iree_hal_executable_cache_prepare_executables(
+    iree_hal_executable_cache_t* executable_cache, iree_host_size_t count,
+    const iree_hal_executable_params_t* executable_params,
+    iree_hal_executable_t** out_executables);
+
 //===----------------------------------------------------------------------===//
 // iree_hal_executable_cache_t implementation details
 //===----------------------------------------------------------------------===//
@@ -192,6 +226,14 @@ typedef struct iree_hal_executable_cache_vtable_t {
       iree_hal_executable_cache_t* executable_cache,
       const iree_hal_executable_params_t* executable_params,
       iree_hal_executable_t** out_executable);
+
+  // Optional; when omitted executables are prepared one at a time with
+  // |prepare_executable|. Implementations must release any executables they
+  // prepared if the batch fails.
+  iree_status_t(IREE_API_PTR* prepare_executables)(
+      iree_hal_executable_cache_t* executable_cache, iree_host_size_t count,
+      const iree_hal_executable_params_t* executable_params,
+      iree_hal_executable_t** out_executables);
 } iree_hal_executable_cache_vtable_t;
 IREE_HAL_ASSERT_VTABLE_LAYOUT(iree_hal_executable_cache_vtable_t);
 
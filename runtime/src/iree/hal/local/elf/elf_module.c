@@ -229,11 +229,79 @@ static iree_byte_range_t iree_elf_module_calculate_vaddr_range(
   return byte_range;
 }
 
+// Returns true if all PT_LOAD segments can be mapped from |file| at the
+// current module->vaddr_bias. Each segment must have the same offset within a
+// host page in the file as in memory and no two segments may share a host
+// page as mapping one would clobber the other.
+static bool iree_elf_module_can_map_segments(
+    const iree_elf_module_file_t* file,
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+  if (!file || file->fd < 0) return false;
+  const iree_host_size_t page_size = load_state->memory_info.normal_page_size;
+  for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
+    const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
+    if (phdr->p_type != IREE_ELF_PT_LOAD) continue;
+    uintptr_t vaddr = (uintptr_t)(module->vaddr_bias + phdr->p_vaddr);
+    uint64_t file_offset = file->offset + phdr->p_offset;
+    if ((vaddr % page_size) != (file_offset % page_size)) return false;
+    uintptr_t page_min = iree_page_align_start(vaddr, page_size);
+    uintptr_t page_max = iree_page_align_end(vaddr + phdr->p_memsz, page_size);
+    for (iree_elf_half_t j = 0; j < i; ++j) {
+      const iree_elf_phdr_t* other_phdr = &load_state->phdr_table[j];
+      if (other_phdr->p_type != IREE_ELF_PT_LOAD) continue;
+      uintptr_t other_vaddr =
+          (uintptr_t)(module->vaddr_bias + other_phdr->p_vaddr);
+      uintptr_t other_page_min = iree_page_align_start(other_vaddr, page_size);
+      uintptr_t other_page_max = iree_page_align_end(
+          other_vaddr + other_phdr->p_memsz, page_size);
+      if (page_min < other_page_max && other_page_min < page_max) return false;
+    }
+  }
+  return true;
+}
+
+// Maps the file contents of the segment |phdr| copy-on-write from |file|.
+// Any p_memsz beyond p_filesz is zeroed: the remainder of the last file page
+// is cleared in place (making only that page private) and whole pages beyond
+// it are committed as anonymous zero pages.
+static iree_status_t iree_elf_module_map_segment(
+    const iree_elf_module_file_t* file, const iree_elf_phdr_t* phdr,
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
+  iree_byte_range_t file_range = {
+      .offset = phdr->p_vaddr,
+      .length = phdr->p_filesz,
+  };
+  IREE_RETURN_IF_ERROR(iree_memory_view_map_file_range(
+      module->vaddr_bias, file_range, file->fd, file->offset + phdr->p_offset,
+      IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
+  if (phdr->p_memsz > phdr->p_filesz) {
+    iree_elf_addr_t zero_start = phdr->p_vaddr + phdr->p_filesz;
+    iree_elf_addr_t zero_end = phdr->p_vaddr + phdr->p_memsz;
+    iree_elf_addr_t page_end = (iree_elf_addr_t)(
+        iree_page_align_end((uintptr_t)(module->vaddr_bias + zero_start),
+                            load_state->memory_info.normal_page_size) -
+        (uintptr_t)module->vaddr_bias);
+    memset(module->vaddr_bias + zero_start, 0,
+           iree_min(page_end, zero_end) - zero_start);
+    if (zero_end > page_end) {
+      iree_byte_range_t zero_range = {
+          .offset = page_end,
+          .length = zero_end - page_end,
+      };
+      IREE_RETURN_IF_ERROR(iree_memory_view_commit_ranges(
+          module->vaddr_bias, 1, &zero_range,
+          IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
+    }
+  }
+  return iree_ok_status();
+}
+
 // Allocates space for and loads all DT_LOAD segments into the host virtual
-// address space.
+// address space. If a backing |file| is provided and the platform supports it
+// the segments are mapped copy-on-write from the file instead of copied.
 static iree_status_t iree_elf_module_load_segments(
-    iree_const_byte_span_t raw_data, iree_elf_module_load_state_t* load_state,
-    iree_elf_module_t* module) {
+    iree_const_byte_span_t raw_data, const iree_elf_module_file_t* file,
+    iree_elf_module_load_state_t* load_state, iree_elf_module_t* module) {
   // Calculate the total internally-aligned vaddr range.
   iree_byte_range_t vaddr_range =
       iree_elf_module_calculate_vaddr_range(load_state);
@@ -247,11 +315,28 @@ static iree_status_t iree_elf_module_load_segments(
       module->host_allocator, (void**)&module->vaddr_base));
   module->vaddr_bias = module->vaddr_base - vaddr_range.offset;
 
+  // Mapping from the file keeps read-only pages shared with every other
+  // process loading the same file and avoids touching pages that are never
+  // used. Relocations applied later only make the pages they write private.
+  bool map_from_file =
+      iree_elf_module_can_map_segments(file, load_state, module);
+
   // Commit and load all of the segments.
   for (iree_elf_half_t i = 0; i < load_state->ehdr->e_phnum; ++i) {
     const iree_elf_phdr_t* phdr = &load_state->phdr_table[i];
     if (phdr->p_type != IREE_ELF_PT_LOAD) continue;
 
+    if (map_from_file && phdr->p_filesz > 0) {
+      iree_status_t status =
+          iree_elf_module_map_segment(file, phdr, load_state, module);
+      if (iree_status_is_ok(status)) continue;
+      if (!iree_status_is_unavailable(status)) return status;
+      // Platform can't map files; fall back to copying this and all remaining
+      // segments.
+      iree_status_ignore(status);
+      map_from_file = false;
+    }
+
     // Commit the range of pages used by this segment, initially with write
     // access so that we can modify the pages.
     iree_byte_range_t byte_range = {
@@ -263,13 +348,6 @@ static iree_status_t iree_elf_module_load_segments(
         IREE_MEMORY_ACCESS_READ | IREE_MEMORY_ACCESS_WRITE));
 
     // Copy data present in the file.
-    // TODO(benvanik): infra for being able to detect if the source model is in
-    // a mapped file - if it is, we can remap the page and directly reference it
-    // here for read-only segments and setup copy-on-write for writeable ones.
-    // We'd need a way to pass in the underlying mapping and some guarantees on
-    // the lifetime of it. Today we are just always committing above and copying
-    // here because it keeps this all super simple (you know, as simple as an
-    // entire custom ELF loader can be :).
     if (phdr->p_filesz > 0) {
       memcpy(module->vaddr_bias + phdr->p_vaddr, raw_data.data + phdr->p_offset,
              phdr->p_filesz);
@@ -570,8 +648,8 @@ static const iree_elf_sym_t* iree_elf_module_lookup_global_symbol(
 // API
 //==============================================================================
 
-iree_status_t iree_elf_module_initialize_from_memory(
-    iree_const_byte_span_t raw_data,
+static iree_status_t iree_elf_module_initialize(
+    iree_const_byte_span_t raw_data, const iree_elf_module_file_t* file,
     const iree_elf_import_table_t* import_table,
     iree_allocator_t host_allocator, iree_elf_module_t* out_module) {
   IREE_ASSERT_ARGUMENT(raw_data.data);
@@ -580,9 +658,16 @@ iree_status_t iree_elf_module_initialize_from_memory(
 
   // If the file is a FatELF then select the ELF for this architecture.
   // Ignored of not a FatELF and otherwise errors if no compatible architecture
-  // is available.
+  // is available. The file offset is adjusted to the selected ELF.
+  iree_const_byte_span_t fat_data = raw_data;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(z0,
                                     iree_fatelf_select(raw_data, &raw_data));
+  iree_elf_module_file_t selected_file;
+  if (file) {
+    selected_file.fd = file->fd;
+    selected_file.offset = file->offset + (raw_data.data - fat_data.data);
+    file = &selected_file;
+  }
 
   // Parse the ELF headers and verify that it's something we can handle.
   // Temporary state required during loading such as references to subtables
@@ -596,7 +681,8 @@ iree_status_t iree_elf_module_initialize_from_memory(
   // Allocate and load the ELF into memory.
   iree_memory_jit_context_begin();
   if (iree_status_is_ok(status)) {
-    status = iree_elf_module_load_segments(raw_data, &load_state, out_module);
+    status =
+        iree_elf_module_load_segments(raw_data, file, &load_state, out_module);
   }
 
   // Parse required dynamic symbol tables in loaded memory. These are used for
@@ -637,6 +723,23 @@ iree_status_t iree_elf_module_initialize_from_memory(
   return status;
 }
 
+iree_status_t iree_elf_module_initialize_from_memory(
+    iree_const_byte_span_t raw_data,
+    const iree_elf_import_table_t* import_table,
+    iree_allocator_t host_allocator, iree_elf_module_t* out_module) {
+  return iree_elf_module_initialize(raw_data, /*file=*/NULL, import_table,
+                                    host_allocator, out_module);
+}
+
+iree_status_t iree_elf_module_initialize_from_file(
+    iree_const_byte_span_t raw_data, const iree_elf_module_file_t* file,
+    const iree_elf_import_table_t* import_table,
+    iree_allocator_t host_allocator, iree_elf_module_t* out_module) {
+  IREE_ASSERT_ARGUMENT(file);
+  return iree_elf_module_initialize(raw_data, file, import_table,
+                                    host_allocator, out_module);
+}
+
 void iree_elf_module_deinitialize(iree_elf_module_t* module) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -77,6 +77,33 @@ iree_status_t iree_elf_module_initialize_from_memory(
     const iree_elf_import_table_t* import_table,
     iree_allocator_t host_allocator, iree_elf_module_t* out_module);
 
+// A file containing an ELF module at a particular byte offset.
+typedef struct iree_elf_module_file_t {
+  // POSIX file descriptor opened for reading.
+  int fd;
+  // Byte offset of the start of the ELF (or FatELF) data within the file.
+  uint64_t offset;
+} iree_elf_module_file_t;
+
+// Initializes an ELF module from the ELF |raw_data| in memory that was read or
+// mapped from |file|. |raw_data| must match the file contents starting at
+// |file->offset| and the file must not be modified while the module is loaded.
+//
+// Where supported by the platform the loadable segments are mapped
+// copy-on-write directly from the file instead of being copied into private
+// memory. Read-only pages (such as all of the code) are then shared by all
+// processes loading the same file and only pages written during loading (such
+// as those with relocations) become private. Segments are faulted in on first
+// use instead of being copied up front. If mapping is not possible (the file
+// data is not page-congruent with the ELF layout, the platform lacks support,
+// etc) this behaves as iree_elf_module_initialize_from_memory.
+//
+// NOTE: the file must reside on a filesystem that permits executable mappings.
+iree_status_t iree_elf_module_initialize_from_file(
+    iree_const_byte_span_t raw_data, const iree_elf_module_file_t* file,
+    const iree_elf_import_table_t* import_table,
+    iree_allocator_t host_allocator, iree_elf_module_t* out_module);
+
 // Deinitializes a |module|, releasing any allocated executable or data pages.
 // Invalidates all symbol pointers previous retrieved from the module and any
 // pointer to data that may have been in the module text or rwdata.
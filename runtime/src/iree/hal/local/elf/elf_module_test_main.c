@@ -51,23 +51,14 @@ static iree_status_t query_arch_test_file_data(
                           "the application for the current target platform");
 }
 
-static iree_status_t run_test() {
-  iree_const_byte_span_t file_data;
-  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
-
-  iree_elf_import_table_t import_table;
-  memset(&import_table, 0, sizeof(import_table));
-  iree_elf_module_t module;
-  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
-      file_data, &import_table, iree_allocator_system(), &module));
-
+static iree_status_t run_module(iree_elf_module_t* module) {
   iree_hal_executable_environment_v0_t environment;
   iree_hal_executable_environment_initialize(iree_allocator_system(),
                                              &environment);
 
   void* query_fn_ptr = NULL;
   IREE_RETURN_IF_ERROR(iree_elf_module_lookup_export(
-      &module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr));
+      module, IREE_HAL_EXECUTABLE_LIBRARY_EXPORT_NAME, &query_fn_ptr));
 
   union {
     const iree_hal_executable_library_header_t** header;
@@ -140,21 +131,76 @@ static iree_status_t run_test() {
                             "dispatch function returned failure: %d", ret);
   }
 
-  iree_status_t status = iree_ok_status();
   for (int i = 0; i < IREE_ARRAYSIZE(expected); ++i) {
     if (ret0[i] != expected[i]) {
-      status =
-          iree_make_status(IREE_STATUS_INTERNAL,
-                           "output mismatch: ret[%d] = %.1f, expected %.1f", i,
-                           ret0[i], expected[i]);
-      break;
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "output mismatch: ret[%d] = %.1f, expected %.1f",
+                              i, ret0[i], expected[i]);
     }
   }
+  return iree_ok_status();
+}
 
+static iree_status_t run_test_from_memory(iree_const_byte_span_t file_data) {
+  iree_elf_import_table_t import_table;
+  memset(&import_table, 0, sizeof(import_table));
+  iree_elf_module_t module;
+  IREE_RETURN_IF_ERROR(iree_elf_module_initialize_from_memory(
+      file_data, &import_table, iree_allocator_system(), &module));
+  iree_status_t status = run_module(&module);
   iree_elf_module_deinitialize(&module);
   return status;
 }
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+// Writes the ELF to a temporary file and loads it with the segments mapped
+// copy-on-write from the file.
+static iree_status_t run_test_from_file(iree_const_byte_span_t file_data) {
+  FILE* file = tmpfile();
+  if (!file) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "unable to create a temporary file");
+  }
+  iree_status_t status = iree_ok_status();
+  if (fwrite(file_data.data, 1, file_data.data_length, file) !=
+          file_data.data_length ||
+      fflush(file) != 0) {
+    status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "failed to write the temporary file");
+  }
+
+  iree_elf_import_table_t import_table;
+  memset(&import_table, 0, sizeof(import_table));
+  iree_elf_module_file_t module_file = {
+      .fd = fileno(file),
+      .offset = 0,
+  };
+  iree_elf_module_t module;
+  if (iree_status_is_ok(status)) {
+    status = iree_elf_module_initialize_from_file(
+        file_data, &module_file, &import_table, iree_allocator_system(),
+        &module);
+  }
+  // The mapping must remain valid after the descriptor is closed.
+  fclose(file);
+  if (iree_status_is_ok(status)) {
+    status = run_module(&module);
+    iree_elf_module_deinitialize(&module);
+  }
+  return status;
+}
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+static iree_status_t run_test() {
+  iree_const_byte_span_t file_data;
+  IREE_RETURN_IF_ERROR(query_arch_test_file_data(&file_data));
+  IREE_RETURN_IF_ERROR(run_test_from_memory(file_data));
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+  IREE_RETURN_IF_ERROR(run_test_from_file(file_data));
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+  return iree_ok_status();
+}
+
 int main() {
   const iree_status_t result = run_test();
   int ret = (int)iree_status_code(result);
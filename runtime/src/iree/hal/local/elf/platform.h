@@ -89,4 +89,21 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
                                               const iree_byte_range_t* ranges,
                                               iree_memory_access_t new_access);
 
+// Maps the contents of the file |fd| starting at |file_offset| into the view
+// byte range |range| as private copy-on-write pages. Pages are shared with all
+// other mappings of the same file until written to; writes (such as applying
+// relocations) only make the touched pages private to the process.
+// The range will be adjusted to the page granularity of the view and the bytes
+// preceding |file_offset| and following |range| within the boundary pages will
+// contain the adjacent file contents. |file_offset| must have the same offset
+// within a page as the start of |range|.
+//
+// Returns IREE_STATUS_UNAVAILABLE if the platform cannot map files into views
+// in which case callers should commit the range and copy the data instead.
+//
+// Implemented by mmap+MAP_PRIVATE|MAP_FIXED.
+iree_status_t iree_memory_view_map_file_range(
+    void* base_address, iree_byte_range_t range, int fd, uint64_t file_offset,
+    iree_memory_access_t initial_access);
+
 #endif  // IREE_HAL_LOCAL_ELF_PLATFORM_H_
@@ -136,4 +136,14 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
   return status;
 }
 
+iree_status_t iree_memory_view_map_file_range(
+    void* base_address, iree_byte_range_t range, int fd, uint64_t file_offset,
+    iree_memory_access_t initial_access) {
+  // Executable pages must come from MAP_JIT anonymous memory (or signed code)
+  // under the hardened runtime so we always copy.
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file-backed views are not supported on Apple "
+                          "platforms");
+}
+
 #endif  // IREE_PLATFORM_APPLE
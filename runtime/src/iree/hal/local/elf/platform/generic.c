@@ -49,4 +49,12 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
   return iree_ok_status();
 }
 
+iree_status_t iree_memory_view_map_file_range(
+    void* base_address, iree_byte_range_t range, int fd, uint64_t file_offset,
+    iree_memory_access_t initial_access) {
+  // No virtual memory to map into.
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file-backed views are not supported");
+}
+
 #endif  // IREE_PLATFORM_GENERIC
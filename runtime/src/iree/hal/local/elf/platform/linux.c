@@ -109,4 +109,43 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
   return status;
 }
 
+iree_status_t iree_memory_view_map_file_range(
+    void* base_address, iree_byte_range_t range, int fd, uint64_t file_offset,
+    iree_memory_access_t initial_access) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)range.length);
+
+  void* range_start = NULL;
+  iree_host_size_t aligned_length = 0;
+  const iree_host_size_t page_size = getpagesize();
+  iree_page_align_range(base_address, range, page_size, &range_start,
+                        &aligned_length);
+  const iree_host_size_t page_offset =
+      (iree_host_size_t)((uint8_t*)base_address + range.offset -
+                         (uint8_t*)range_start);
+  if (file_offset < page_offset ||
+      (file_offset - page_offset) % page_size != 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "file offset %" PRIu64
+                            " is not congruent with the view address modulo "
+                            "the page size %" PRIhsz,
+                            file_offset, page_size);
+  }
+
+  int mmap_prot = iree_memory_access_to_prot(initial_access);
+  int mmap_flags = MAP_PRIVATE | MAP_FIXED;
+
+  iree_status_t status = iree_ok_status();
+  void* result = mmap(range_start, aligned_length, mmap_prot, mmap_flags, fd,
+                      (off_t)(file_offset - page_offset));
+  if (result == MAP_FAILED) {
+    status = iree_make_status(iree_status_code_from_errno(errno),
+                              "mmap of file range failed");
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 #endif  // IREE_PLATFORM_*
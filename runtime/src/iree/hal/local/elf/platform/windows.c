@@ -112,4 +112,13 @@ iree_status_t iree_memory_view_protect_ranges(void* base_address,
   return status;
 }
 
+iree_status_t iree_memory_view_map_file_range(
+    void* base_address, iree_byte_range_t range, int fd, uint64_t file_offset,
+    iree_memory_access_t initial_access) {
+  // NOTE: MapViewOfFile3 with MEM_REPLACE_PLACEHOLDER could be used if the
+  // view reservation was created with placeholders.
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file-backed views are not supported on Windows");
+}
+
 #endif  // IREE_PLATFORM_WINDOWS
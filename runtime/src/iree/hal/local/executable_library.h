@@ -154,6 +154,19 @@ typedef const iree_hal_executable_library_header_t** (
 // a useful failure though the HAL does not mandate that all overflows are
 // caught and only that they are not harmful - clamping byte ranges and never
 // returning a failure is sufficient.
+//
+// Imports called once per element or tile from within a loop can instead
+// be declared with a batched form that is called once for the whole loop to
+// amortize the thunk and parameter packing overheads (see
+// `hal.import.batch`). Only imports without results can be batched. The
+// batched form is a separate import with its own symbol name and its
+// parameters are packed as:
+//   size_t count;             // number of iterations, possibly 0
+//   <args of iteration 0>     // same types as the unbatched import
+//   intptr_t strides[N];      // one per arg, 0 for loop-invariant args
+//   <extra fields>            // as requested on the unbatched import
+// Iteration `i` receives integer arguments as `arg + i * stride` and all
+// other arguments unchanged.
 typedef int (*iree_hal_executable_import_v0_t)(void* params, void* context,
                                                void* reserved);
 
@@ -18,6 +18,7 @@
 #include "iree/hal/local/loaders/registration/init.h"
 #include "iree/hal/local/local_executable.h"
 #include "iree/hal/local/plugins/registration/init.h"
+#include "iree/task/testing/concurrent_benchmark.h"
 #include "iree/testing/benchmark.h"
 
 IREE_FLAG(string, executable_format, "",
@@ -48,6 +49,12 @@ IREE_FLAG(int32_t, workgroup_size_z, 1,
 IREE_FLAG(int32_t, max_concurrency, 1,
           "Maximum available concurrency exposed to the dispatch.");
 
+IREE_FLAG(int32_t, threads, 0,
+          "Number of threads to issue the dispatch from concurrently, each "
+          "pinned to its own physical core and with its own copy of the "
+          "bindings. Reports aggregate and per-thread throughput. 0 issues "
+          "from the calling thread only.");
+
 // Parsed parameters from flags.
 // Used to construct the dispatch parameters for the benchmark invocation.
 struct {
@@ -126,49 +133,24 @@ IREE_FLAG_CALLBACK(
 // NOTE: error handling is here just for better diagnostics: it is not tracking
 // allocations correctly and will leak. Don't use this as an example for how to
 // write robust code.
-static iree_status_t iree_hal_executable_library_run(
-    const iree_benchmark_def_t* benchmark_def,
-    iree_benchmark_state_t* benchmark_state) {
-  iree_allocator_t host_allocator = benchmark_state->host_allocator;
-  iree_hal_executable_plugin_manager_t* plugin_manager =
-      (iree_hal_executable_plugin_manager_t*)benchmark_def->user_data;
-
-  // Register the loader used to load (or find) the executable.
-  iree_hal_executable_loader_t* executable_loader = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_create_executable_loader_by_name(
-      iree_make_cstring_view(FLAG_executable_format), plugin_manager,
-      host_allocator, &executable_loader));
-
-  // Setup the specification used to perform the executable load.
-  // This information is normally used to select the appropriate loader but in
-  // this benchmark we only have a single one.
-  iree_hal_executable_params_t executable_params;
-  iree_hal_executable_params_initialize(&executable_params);
-  executable_params.caching_mode =
-      IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_OPTIMIZATION |
-      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA |
-      IREE_HAL_EXECUTABLE_CACHING_MODE_DISABLE_VERIFICATION;
-  executable_params.executable_format =
-      iree_make_cstring_view(FLAG_executable_format);
+// Per-thread dispatch state with its own bindings and workgroup-local memory.
+typedef struct iree_hal_executable_library_thread_t {
+  iree_hal_local_executable_t* local_executable;
+  iree_hal_buffer_view_t* buffer_views[IREE_HAL_EXECUTABLE_MAX_BINDING_COUNT];
+  void* binding_ptrs[IREE_HAL_EXECUTABLE_MAX_BINDING_COUNT];
+  size_t binding_lengths[IREE_HAL_EXECUTABLE_MAX_BINDING_COUNT];
+  iree_byte_span_t local_memory;
+  iree_hal_executable_dispatch_state_v0_t dispatch_state;
+} iree_hal_executable_library_thread_t;
 
-  // Load the executable data.
-  iree_file_contents_t* file_contents = NULL;
-  IREE_RETURN_IF_ERROR(iree_file_read_contents(FLAG_executable_file,
-                                               IREE_FILE_READ_FLAG_DEFAULT,
-                                               host_allocator, &file_contents));
-  executable_params.executable_data = file_contents->const_buffer;
-
-  // Perform the load, which will fail if the executable cannot be loaded or
-  // there was an issue with the layouts.
-  iree_hal_executable_t* executable = NULL;
-  IREE_RETURN_IF_ERROR(
-      iree_hal_executable_loader_try_load(executable_loader, &executable_params,
-                                          /*worker_capacity=*/1, &executable));
-  iree_hal_local_executable_t* local_executable =
-      iree_hal_local_executable_cast(executable);
+static iree_status_t iree_hal_executable_library_thread_initialize(
+    iree_hal_local_executable_t* local_executable,
+    iree_hal_allocator_t* heap_allocator, iree_allocator_t host_allocator,
+    iree_hal_executable_library_thread_t* out_thread) {
+  memset(out_thread, 0, sizeof(*out_thread));
+  out_thread->local_executable = local_executable;
 
   // Allocate workgroup-local memory that each invocation can use.
-  iree_byte_span_t local_memory = iree_make_byte_span(NULL, 0);
   iree_host_size_t local_memory_size =
       local_executable->dispatch_attrs
           ? local_executable->dispatch_attrs[FLAG_entry_point]
@@ -176,35 +158,28 @@ static iree_status_t iree_hal_executable_library_run(
                 IREE_HAL_EXECUTABLE_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE
           : 0;
   if (local_memory_size > 0) {
-    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
-        host_allocator, local_memory_size, (void**)&local_memory.data));
-    local_memory.data_length = local_memory_size;
+    IREE_RETURN_IF_ERROR(
+        iree_allocator_malloc(host_allocator, local_memory_size,
+                              (void**)&out_thread->local_memory.data));
+    out_thread->local_memory.data_length = local_memory_size;
   }
 
-  // Allocate storage for buffers and populate them.
-  // They only need to remain valid for the duration of the invocation and all
-  // memory accessed by the invocation will come from here.
-  iree_hal_allocator_t* heap_allocator = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_allocator_create_heap(
-      iree_make_cstring_view("benchmark"), host_allocator, host_allocator,
-      &heap_allocator));
-  iree_hal_buffer_view_t* buffer_views[IREE_HAL_EXECUTABLE_MAX_BINDING_COUNT];
-  void* binding_ptrs[IREE_HAL_EXECUTABLE_MAX_BINDING_COUNT];
-  size_t binding_lengths[IREE_HAL_EXECUTABLE_MAX_BINDING_COUNT];
   for (iree_host_size_t i = 0; i < dispatch_params.binding_count; ++i) {
-    IREE_RETURN_IF_ERROR(
-        iree_hal_buffer_view_parse(dispatch_params.bindings[i], /*device=*/NULL,
-                                   heap_allocator, &buffer_views[i]));
-    iree_hal_buffer_t* buffer = iree_hal_buffer_view_buffer(buffer_views[i]);
+    IREE_RETURN_IF_ERROR(iree_hal_buffer_view_parse(
+        dispatch_params.bindings[i], /*device=*/NULL, heap_allocator,
+        &out_thread->buffer_views[i]));
+    iree_hal_buffer_t* buffer =
+        iree_hal_buffer_view_buffer(out_thread->buffer_views[i]);
     iree_device_size_t buffer_length =
-        iree_hal_buffer_view_byte_length(buffer_views[i]);
+        iree_hal_buffer_view_byte_length(out_thread->buffer_views[i]);
     iree_hal_buffer_mapping_t buffer_mapping = {{0}};
     IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
         buffer, IREE_HAL_MAPPING_MODE_PERSISTENT,
         IREE_HAL_MEMORY_ACCESS_READ | IREE_HAL_MEMORY_ACCESS_WRITE, 0,
         buffer_length, &buffer_mapping));
-    binding_ptrs[i] = buffer_mapping.contents.data;
-    binding_lengths[i] = (size_t)buffer_mapping.contents.data_length;
+    out_thread->binding_ptrs[i] = buffer_mapping.contents.data;
+    out_thread->binding_lengths[i] =
+        (size_t)buffer_mapping.contents.data_length;
   }
 
   // Setup dispatch state.
@@ -219,9 +194,61 @@ static iree_status_t iree_hal_executable_library_run(
       .constant_count = dispatch_params.constant_count,
       .constants = &dispatch_params.constants[0].ui32,
       .binding_count = dispatch_params.binding_count,
-      .binding_ptrs = binding_ptrs,
-      .binding_lengths = binding_lengths,
+      .binding_ptrs = out_thread->binding_ptrs,
+      .binding_lengths = out_thread->binding_lengths,
   };
+  memcpy(&out_thread->dispatch_state, &dispatch_state, sizeof(dispatch_state));
+  return iree_ok_status();
+}
+
+static void iree_hal_executable_library_thread_deinitialize(
+    iree_hal_executable_library_thread_t* thread,
+    iree_allocator_t host_allocator) {
+  for (iree_host_size_t i = 0; i < dispatch_params.binding_count; ++i) {
+    iree_hal_buffer_view_release(thread->buffer_views[i]);
+  }
+  iree_allocator_free(host_allocator, thread->local_memory.data);
+}
+
+// Returns the total number of workgroup invocations in one dispatch.
+static int64_t iree_hal_executable_library_invocation_count(
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state) {
+  return (int64_t)dispatch_state->workgroup_count_x *
+         dispatch_state->workgroup_count_y * dispatch_state->workgroup_count_z;
+}
+
+// Returns the total number of bytes bound to one dispatch.
+static int64_t iree_hal_executable_library_binding_bytes(
+    const iree_hal_executable_library_thread_t* thread) {
+  int64_t total_length = 0;
+  for (iree_host_size_t i = 0; i < dispatch_params.binding_count; ++i) {
+    total_length += thread->binding_lengths[i];
+  }
+  return total_length;
+}
+
+// Issues |iteration_count| dispatches using the state of |thread_index|.
+// |user_data| is the array of per-thread state.
+static iree_status_t iree_hal_executable_library_thread_run(
+    void* user_data, iree_host_size_t thread_index, int64_t iteration_count) {
+  iree_hal_executable_library_thread_t* thread =
+      (iree_hal_executable_library_thread_t*)user_data + thread_index;
+  for (int64_t i = 0; i < iteration_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_dispatch_inline(
+        thread->local_executable, FLAG_entry_point, &thread->dispatch_state,
+        (uint32_t)thread_index, thread->local_memory));
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_executable_library_run_inline(
+    iree_hal_local_executable_t* local_executable,
+    iree_hal_allocator_t* heap_allocator,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_hal_executable_library_thread_t thread;
+  IREE_RETURN_IF_ERROR(iree_hal_executable_library_thread_initialize(
+      local_executable, heap_allocator, host_allocator, &thread));
 
   // Execute benchmark the workgroup invocation.
   // Note that each iteration runs through the whole grid as it's important that
@@ -231,7 +258,8 @@ static iree_status_t iree_hal_executable_library_run(
   int64_t dispatch_count = 0;
   while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
     IREE_RETURN_IF_ERROR(iree_hal_local_executable_issue_dispatch_inline(
-        local_executable, FLAG_entry_point, &dispatch_state, 0, local_memory));
+        local_executable, FLAG_entry_point, &thread.dispatch_state, 0,
+        thread.local_memory));
     ++dispatch_count;
   }
 
@@ -239,14 +267,130 @@ static iree_status_t iree_hal_executable_library_run(
   // invocations dispatched. That gives us both total dispatch and single
   // invocation times in the reporter output.
   int64_t total_invocations =
-      dispatch_count * dispatch_state.workgroup_count_x *
-      dispatch_state.workgroup_count_y * dispatch_state.workgroup_count_z;
+      dispatch_count *
+      iree_hal_executable_library_invocation_count(&thread.dispatch_state);
   iree_benchmark_set_items_processed(benchmark_state, total_invocations);
 
-  // Deallocate buffers.
-  for (iree_host_size_t i = 0; i < dispatch_params.binding_count; ++i) {
-    iree_hal_buffer_view_release(buffer_views[i]);
+  iree_hal_executable_library_thread_deinitialize(&thread, host_allocator);
+  return iree_ok_status();
+}
+
+// Issues dispatches concurrently from all threads of |concurrent_benchmark|
+// with each thread having its own copy of the bindings.
+static iree_status_t iree_hal_executable_library_run_concurrent(
+    iree_hal_local_executable_t* local_executable,
+    iree_hal_allocator_t* heap_allocator,
+    iree_task_concurrent_benchmark_t* concurrent_benchmark,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_host_size_t thread_count = concurrent_benchmark->thread_count;
+  iree_hal_executable_library_thread_t* threads = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, thread_count * sizeof(threads[0]), (void**)&threads));
+  iree_host_size_t initialized_count = 0;
+  iree_status_t status = iree_ok_status();
+  for (; initialized_count < thread_count && iree_status_is_ok(status);
+       ++initialized_count) {
+    status = iree_hal_executable_library_thread_initialize(
+        local_executable, heap_allocator, host_allocator,
+        &threads[initialized_count]);
+  }
+
+  int64_t batch_count = 1;
+  while (iree_status_is_ok(status) &&
+         iree_benchmark_keep_running(benchmark_state, batch_count)) {
+    status = iree_task_concurrent_benchmark_run(
+        concurrent_benchmark, iree_hal_executable_library_thread_run, threads,
+        batch_count);
+    batch_count *= 2;
   }
+  if (iree_status_is_ok(status)) {
+    status = iree_task_concurrent_benchmark_report(
+        concurrent_benchmark, benchmark_state, "invocation",
+        iree_hal_executable_library_invocation_count(
+            &threads[0].dispatch_state),
+        iree_hal_executable_library_binding_bytes(&threads[0]));
+  }
+
+  for (iree_host_size_t i = 0; i < initialized_count; ++i) {
+    iree_hal_executable_library_thread_deinitialize(&threads[i],
+                                                    host_allocator);
+  }
+  iree_allocator_free(host_allocator, threads);
+  return status;
+}
+
+static iree_status_t iree_hal_executable_library_run(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_hal_executable_plugin_manager_t* plugin_manager =
+      (iree_hal_executable_plugin_manager_t*)benchmark_def->user_data;
+
+  // Register the loader used to load (or find) the executable.
+  iree_hal_executable_loader_t* executable_loader = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_create_executable_loader_by_name(
+      iree_make_cstring_view(FLAG_executable_format), plugin_manager,
+      host_allocator, &executable_loader));
+
+  // Setup the specification used to perform the executable load.
+  // This information is normally used to select the appropriate loader but in
+  // this benchmark we only have a single one.
+  iree_hal_executable_params_t executable_params;
+  iree_hal_executable_params_initialize(&executable_params);
+  executable_params.caching_mode =
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_OPTIMIZATION |
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA |
+      IREE_HAL_EXECUTABLE_CACHING_MODE_DISABLE_VERIFICATION;
+  executable_params.executable_format =
+      iree_make_cstring_view(FLAG_executable_format);
+
+  // Load the executable data.
+  iree_file_contents_t* file_contents = NULL;
+  IREE_RETURN_IF_ERROR(iree_file_read_contents(FLAG_executable_file,
+                                               IREE_FILE_READ_FLAG_DEFAULT,
+                                               host_allocator, &file_contents));
+  executable_params.executable_data = file_contents->const_buffer;
+
+  // Spin up the threads used to run the dispatches concurrently, if requested.
+  // Each thread is a worker of the executable with its own worker ID.
+  iree_task_concurrent_benchmark_t concurrent_benchmark = {0};
+  if (FLAG_threads > 0) {
+    IREE_RETURN_IF_ERROR(iree_task_concurrent_benchmark_initialize(
+        FLAG_threads, host_allocator, &concurrent_benchmark));
+  }
+
+  // Perform the load, which will fail if the executable cannot be loaded or
+  // there was an issue with the layouts.
+  iree_hal_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_executable_loader_try_load(
+      executable_loader, &executable_params,
+      /*worker_capacity=*/iree_max(1, concurrent_benchmark.thread_count),
+      &executable));
+  iree_hal_local_executable_t* local_executable =
+      iree_hal_local_executable_cast(executable);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_executable_ensure_loaded(local_executable));
+
+  // Allocate storage for buffers and populate them.
+  // They only need to remain valid for the duration of the invocation and all
+  // memory accessed by the invocation will come from here.
+  iree_hal_allocator_t* heap_allocator = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_allocator_create_heap(
+      iree_make_cstring_view("benchmark"), host_allocator, host_allocator,
+      &heap_allocator));
+
+  iree_status_t status = iree_ok_status();
+  if (concurrent_benchmark.thread_count > 0) {
+    status = iree_hal_executable_library_run_concurrent(
+        local_executable, heap_allocator, &concurrent_benchmark,
+        benchmark_state);
+    iree_task_concurrent_benchmark_deinitialize(&concurrent_benchmark);
+  } else {
+    status = iree_hal_executable_library_run_inline(
+        local_executable, heap_allocator, benchmark_state);
+  }
+
   iree_hal_allocator_release(heap_allocator);
 
   // Unload.
@@ -254,7 +398,7 @@ static iree_status_t iree_hal_executable_library_run(
   iree_hal_executable_loader_release(executable_loader);
   iree_file_contents_free(file_contents);
 
-  return iree_ok_status();
+  return status;
 }
 
 int main(int argc, char** argv) {
@@ -109,6 +109,39 @@ void iree_hal_executable_library_deinitialize_imports(
   environment->import_thunk = NULL;
 }
 
+void iree_hal_executable_library_query_export_info(
+    iree_string_view_t executable_identifier,
+    const iree_hal_executable_library_v0_t* library, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_info_t* out_info) {
+  memset(out_info, 0, sizeof(*out_info));
+  if (library->exports.names != NULL) {
+    out_info->name = iree_make_cstring_view(library->exports.names[ordinal]);
+  }
+  if (library->exports.tags != NULL && library->exports.tags[ordinal]) {
+    out_info->tag = iree_make_cstring_view(library->exports.tags[ordinal]);
+  }
+
+  const iree_hal_executable_source_location_v0_t* location = NULL;
+  if (library->exports.stage_locations != NULL &&
+      library->exports.stage_locations->count > 0) {
+    // TODO(benvanik): a way to select what location is chosen. For now we
+    // just pick the first one.
+    location = &library->exports.stage_locations->locations[0];
+  } else if (library->exports.source_locations != NULL) {
+    // We have source location data, so use it.
+    location = &library->exports.source_locations[ordinal];
+  }
+  if (location) {
+    out_info->source_file =
+        iree_make_string_view(location->path, location->path_length);
+    out_info->source_line = location->line;
+  } else {
+    // No source location data, so make do with what we have.
+    out_info->source_file = executable_identifier;
+    out_info->source_line = (uint32_t)ordinal;
+  }
+}
+
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION
 
 void iree_hal_executable_library_publish_source_files(
@@ -125,45 +158,16 @@ void iree_hal_executable_library_publish_source_files(
 iree_zone_id_t iree_hal_executable_library_call_zone_begin(
     iree_string_view_t executable_identifier,
     const iree_hal_executable_library_v0_t* library, iree_host_size_t ordinal) {
-  iree_string_view_t entry_point_name = iree_string_view_empty();
-  if (library->exports.names != NULL) {
-    entry_point_name = iree_make_cstring_view(library->exports.names[ordinal]);
-  }
+  iree_hal_local_executable_export_info_t info;
+  iree_hal_executable_library_query_export_info(executable_identifier, library,
+                                                ordinal, &info);
+  iree_string_view_t entry_point_name = info.name;
   if (iree_string_view_is_empty(entry_point_name)) {
     entry_point_name = iree_make_cstring_view("unknown_dylib_call");
   }
-
-  const char* source_file = NULL;
-  size_t source_file_length = 0;
-  uint32_t source_line = 0;
-  if (library->exports.stage_locations != NULL) {
-    for (uint32_t i = 0; i < library->exports.stage_locations->count; ++i) {
-      // TODO(benvanik): a way to select what location is chosen. For now we
-      // just pick the first one.
-      // const char* name = library->exports.stage_locations->names[i];
-      const iree_hal_executable_source_location_v0_t* location =
-          &library->exports.stage_locations->locations[i];
-      source_file = location->path;
-      source_file_length = location->path_length;
-      source_line = location->line;
-      break;
-    }
-  }
-  if (source_file == NULL) {
-    if (library->exports.source_locations != NULL) {
-      // We have source location data, so use it.
-      const iree_hal_executable_source_location_v0_t* location =
-          &library->exports.source_locations[ordinal];
-      source_file = location->path;
-      source_file_length = location->path_length;
-      source_line = location->line;
-    } else {
-      // No source location data, so make do with what we have.
-      source_file = executable_identifier.data;
-      source_file_length = executable_identifier.size;
-      source_line = ordinal;
-    }
-  }
+  const char* source_file = info.source_file.data;
+  size_t source_file_length = info.source_file.size;
+  uint32_t source_line = info.source_line;
 
   IREE_TRACE_ZONE_BEGIN_EXTERNAL(z0, source_file, source_file_length,
                                  source_line, entry_point_name.data,
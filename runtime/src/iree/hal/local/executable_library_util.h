@@ -11,6 +11,7 @@
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/executable_loader.h"
+#include "iree/hal/local/local_executable.h"
 
 // Verifies the |library| matches the |executable_params|.
 iree_status_t iree_hal_executable_library_verify(
@@ -33,6 +34,14 @@ void iree_hal_executable_library_deinitialize_imports(
     iree_hal_executable_environment_v0_t* environment,
     iree_allocator_t host_allocator);
 
+// Populates |out_info| with the debug information for the export |ordinal| of
+// |library|. Exports without source location information use the
+// |executable_identifier| as the file and the ordinal as the line.
+void iree_hal_executable_library_query_export_info(
+    iree_string_view_t executable_identifier,
+    const iree_hal_executable_library_v0_t* library, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_info_t* out_info);
+
 #if defined(IREE_HAL_EXECUTABLE_LIBRARY_CALL_HOOK)
 #if !IREE_HAVE_ATTRIBUTE_WEAK
 #error IREE_HAL_EXECUTABLE_LIBRARY_CALL_HOOK requires toolchain support for weak symbols.
@@ -26,6 +26,10 @@ typedef struct iree_hal_inline_command_buffer_t {
   iree_hal_command_buffer_t base;
   iree_allocator_t host_allocator;
 
+  // Optional caller-provided reservation for workgroup local memory. When
+  // empty we allocate local memory from the host allocator per dispatch.
+  iree_byte_span_t local_memory;
+
   struct {
     // Cached and initialized dispatch state reused for all dispatches.
     // Individual dispatches must populate the dynamically changing fields like
@@ -74,8 +78,8 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
     iree_hal_allocator_t* device_allocator, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_allocator_t host_allocator, iree_byte_span_t storage,
-    iree_hal_command_buffer_t** out_command_buffer) {
+    iree_allocator_t host_allocator, iree_byte_span_t local_memory,
+    iree_byte_span_t storage, iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
 
@@ -113,6 +117,7 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
       binding_capacity, (uint8_t*)command_buffer + sizeof(*command_buffer),
       &iree_hal_inline_command_buffer_vtable, &command_buffer->base);
   command_buffer->host_allocator = host_allocator;
+  command_buffer->local_memory = local_memory;
   iree_hal_inline_command_buffer_reset(command_buffer);
 
   *out_command_buffer = &command_buffer->base;
@@ -132,7 +137,7 @@ iree_status_t iree_hal_inline_command_buffer_create(
     iree_hal_allocator_t* device_allocator, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_allocator_t host_allocator,
+    iree_allocator_t host_allocator, iree_byte_span_t local_memory,
     iree_hal_command_buffer_t** out_command_buffer) {
   IREE_ASSERT_ARGUMENT(out_command_buffer);
   *out_command_buffer = NULL;
@@ -147,7 +152,7 @@ iree_status_t iree_hal_inline_command_buffer_create(
   if (iree_status_is_ok(status)) {
     status = iree_hal_inline_command_buffer_initialize(
         device_allocator, mode, command_categories, queue_affinity,
-        binding_capacity, host_allocator,
+        binding_capacity, host_allocator, local_memory,
         iree_make_byte_span(storage, iree_hal_inline_command_buffer_size(
                                          mode, binding_capacity)),
         &command_buffer);
@@ -359,6 +364,8 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
 
   iree_hal_local_executable_t* local_executable =
       iree_hal_local_executable_cast(executable);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_executable_ensure_loaded(local_executable));
 
   iree_hal_executable_dispatch_attrs_v0_t dispatch_attrs = {0};
   if (local_executable->dispatch_attrs) {
@@ -437,18 +444,29 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
         buffer_mapping.contents.data_length;
   }
 
-  // TODO(benvanik): plumb through an arena or fixed-size reservation to use.
-  // For now when deploying to devices where you want something like the
-  // inline command buffer you probably don't want 256KB of transient memory
-  // getting allocated and retained implicitly - this should be a compiler
-  // option. For now we just malloc here to make things work and strongly
-  // encourage the kind of user who wants synchronous inline execution to not
-  // also want tons of scratch memory.
+  // Workgroup local memory comes from the caller-provided reservation when
+  // available so that steady-state dispatch performs no allocations. Without
+  // one we fall back to allocating per dispatch; users who want synchronous
+  // inline execution on constrained devices should provide a reservation (and
+  // probably not want tons of scratch memory anyway).
   iree_byte_span_t local_memory = iree_make_byte_span(NULL, local_memory_size);
-  if (local_memory_size > 0) {
+  bool owns_local_memory = false;
+  if (local_memory_size > command_buffer->local_memory.data_length &&
+      command_buffer->local_memory.data_length > 0) {
+    return iree_make_status(
+        IREE_STATUS_RESOURCE_EXHAUSTED,
+        "dispatch requires %" PRIhsz
+        " bytes of workgroup local memory but the reservation is %" PRIhsz
+        " bytes",
+        local_memory_size, command_buffer->local_memory.data_length);
+  } else if (local_memory_size > 0 &&
+             command_buffer->local_memory.data_length > 0) {
+    local_memory.data = command_buffer->local_memory.data;
+  } else if (local_memory_size > 0) {
     IREE_RETURN_IF_ERROR(iree_allocator_malloc(command_buffer->host_allocator,
                                                local_memory_size,
                                                (void**)&local_memory.data));
+    owns_local_memory = true;
   }
 
   // Since we are running on a borrowed thread, we know nothing about the
@@ -460,7 +478,7 @@ static iree_status_t iree_hal_inline_command_buffer_dispatch(
       command_buffer->state.processor_id, local_memory);
   iree_fpu_state_pop(fpu_state);
 
-  if (local_memory.data) {
+  if (owns_local_memory) {
     iree_allocator_free(command_buffer->host_allocator, local_memory.data);
   }
   return status;
@@ -25,6 +25,13 @@ iree_host_size_t iree_hal_inline_command_buffer_size(
 // caller-allocated |storage| (must be at least the capacity specified by
 // iree_hal_inline_command_buffer_size).
 //
+// |local_memory| is an optional fixed-size reservation used for workgroup local
+// memory by all dispatches. When provided dispatches perform no allocations and
+// any dispatch requiring more local memory than is available will fail. When
+// empty local memory is allocated from |host_allocator| per dispatch as needed.
+// The reservation must remain valid and unused by others until the command
+// buffer is deinitialized.
+//
 // NOTE: this must only be used when the command buffer handle cannot escape
 // the caller: attempting to use the resulting command buffer as a ref object
 // is invalid.
@@ -32,8 +39,8 @@ iree_status_t iree_hal_inline_command_buffer_initialize(
     iree_hal_allocator_t* device_allocator, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_allocator_t host_allocator, iree_byte_span_t storage,
-    iree_hal_command_buffer_t** out_command_buffer);
+    iree_allocator_t host_allocator, iree_byte_span_t local_memory,
+    iree_byte_span_t storage, iree_hal_command_buffer_t** out_command_buffer);
 
 // Deinitializes an inline command buffer previously initialized with
 // iree_hal_inline_command_buffer_initialize.
@@ -46,14 +53,15 @@ void iree_hal_inline_command_buffer_deinitialize(
 // can begin execution immediately. No inter-command-buffer scheduling will be
 // performed and all barriers and events are ignored.
 //
-// Executes all work on the calling thread synchronously (today).
+// Executes all work on the calling thread synchronously (today). See
+// iree_hal_inline_command_buffer_initialize for details on |local_memory|.
 //
 // Must have IREE_HAL_COMMAND_BUFFER_MODE_ALLOW_INLINE_EXECUTION set.
 iree_status_t iree_hal_inline_command_buffer_create(
     iree_hal_allocator_t* device_allocator, iree_hal_command_buffer_mode_t mode,
     iree_hal_command_category_t command_categories,
     iree_hal_queue_affinity_t queue_affinity, iree_host_size_t binding_capacity,
-    iree_allocator_t host_allocator,
+    iree_allocator_t host_allocator, iree_byte_span_t local_memory,
     iree_hal_command_buffer_t** out_command_buffer);
 
 // Returns true if |command_buffer| is an inline command buffer.
@@ -10,6 +10,8 @@
 #include <stddef.h>
 #include <stdint.h>
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/elf/elf_module.h"
 #include "iree/hal/local/executable_library.h"
@@ -35,6 +37,22 @@ typedef struct iree_hal_elf_executable_t {
     const iree_hal_executable_library_header_t** header;
     const iree_hal_executable_library_v0_t* v0;
   } library;
+
+  // Nonzero once the module has been loaded and the library is available.
+  // Executables created with deferred loading start out as stubs and load on
+  // first use under |load_mutex|.
+  iree_atomic_int32_t is_loaded;
+  iree_slim_mutex_t load_mutex;
+
+  // Failure from the deferred load, if any, returned to all subsequent users.
+  iree_status_t load_status;
+
+  // Parameters retained for the deferred load. The executable data is aliased
+  // (required by IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_DEFERRED_LOADING) and
+  // constants reference our owned copy. The loader is retained to keep its
+  // import provider live. All are dropped once the load has been attempted.
+  iree_hal_executable_loader_t* pending_loader;
+  iree_hal_executable_params_t pending_params;
 } iree_hal_elf_executable_t;
 
 static const iree_hal_local_executable_vtable_t iree_hal_elf_executable_vtable;
@@ -78,26 +96,93 @@ static iree_status_t iree_hal_elf_executable_query_library(
   }
 
   executable->identifier = iree_make_cstring_view(header->name);
+  executable->base.export_count = executable->library.v0->exports.count;
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
   return iree_ok_status();
 }
 
+// Loads the ELF module and resolves the library, its imports, and the
+// dispatch attributes. Any partially-initialized state is cleaned up when the
+// executable is destroyed.
+static iree_status_t iree_hal_elf_executable_load(
+    iree_hal_elf_executable_t* executable,
+    const iree_hal_executable_params_t* executable_params,
+    const iree_hal_executable_import_provider_t import_provider) {
+  iree_allocator_t host_allocator = executable->base.host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Attempt to load the ELF module. If the data came from a file we can map
+  // the segments from it and share the pages with other processes.
+  iree_status_t status = iree_ok_status();
+  iree_io_file_handle_t* executable_file = executable_params->executable_file;
+  if (executable_file && iree_io_file_handle_type(executable_file) ==
+                             IREE_IO_FILE_HANDLE_TYPE_FD) {
+    iree_elf_module_file_t file = {
+        .fd = iree_io_file_handle_value(executable_file).fd,
+        .offset = executable_params->executable_file_offset,
+    };
+    status = iree_elf_module_initialize_from_file(
+        executable_params->executable_data, &file, /*import_table=*/NULL,
+        host_allocator, &executable->module);
+  } else {
+    status = iree_elf_module_initialize_from_memory(
+        executable_params->executable_data, /*import_table=*/NULL,
+        host_allocator, &executable->module);
+  }
+
+  // Query metadata and get the entry point function pointers.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_elf_executable_query_library(executable);
+  }
+
+  // Resolve imports, if any.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_executable_library_initialize_imports(
+        &executable->base.environment, import_provider,
+        &executable->library.v0->imports,
+        (iree_hal_executable_import_thunk_v0_t)iree_elf_thunk_i_ppp,
+        host_allocator);
+  }
+
+  // Verify that the library matches the executable params.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_executable_library_verify(executable_params,
+                                                executable->library.v0);
+  }
+
+  // Publish the executable sources with the tracing infrastructure.
+  if (iree_status_is_ok(status)) {
+    iree_hal_executable_library_publish_source_files(executable->library.v0);
+  }
+
+  // Don't expose partially loaded libraries to dispatches.
+  if (!iree_status_is_ok(status)) {
+    executable->library.header = NULL;
+    executable->base.export_count = 0;
+    executable->base.dispatch_attrs = NULL;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 static iree_status_t iree_hal_elf_executable_create(
     const iree_hal_executable_params_t* executable_params,
-    const iree_hal_executable_import_provider_t import_provider,
+    iree_hal_executable_loader_t* executable_loader,
     iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(executable_params->executable_data.data &&
                        executable_params->executable_data.data_length);
   IREE_ASSERT_ARGUMENT(!executable_params->constant_count ||
                        executable_params->constants);
+  IREE_ASSERT_ARGUMENT(executable_loader);
   IREE_ASSERT_ARGUMENT(out_executable);
   *out_executable = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  // TODO(benvanik): rework this so that we load and query the library before
-  // allocating so that we know the import count. Today since we allocate first
-  // we need an additional allocation once we've seen the import table.
+  // NOTE: we allocate before loading so that deferred loads have somewhere to
+  // stash their parameters; this means the import table needs an additional
+  // allocation once we've seen it.
   iree_hal_elf_executable_t* executable = NULL;
   iree_host_size_t total_size =
       sizeof(*executable) +
@@ -107,6 +192,9 @@ static iree_status_t iree_hal_elf_executable_create(
   if (iree_status_is_ok(status)) {
     iree_hal_local_executable_initialize(&iree_hal_elf_executable_vtable,
                                          host_allocator, &executable->base);
+    iree_atomic_store(&executable->is_loaded, 0, iree_memory_order_relaxed);
+    iree_slim_mutex_initialize(&executable->load_mutex);
+    executable->load_status = iree_ok_status();
   }
 
   // Copy executable constants so we own them.
@@ -119,36 +207,26 @@ static iree_status_t iree_hal_elf_executable_create(
     executable->base.environment.constants = target_constants;
   }
 
-  // Attempt to load the ELF module.
-  if (iree_status_is_ok(status)) {
-    status = iree_elf_module_initialize_from_memory(
-        executable_params->executable_data, /*import_table=*/NULL,
-        host_allocator, &executable->module);
-  }
-
-  // Query metadata and get the entry point function pointers.
-  if (iree_status_is_ok(status)) {
-    status = iree_hal_elf_executable_query_library(executable);
-  }
-
-  // Resolve imports, if any.
-  if (iree_status_is_ok(status)) {
-    status = iree_hal_executable_library_initialize_imports(
-        &executable->base.environment, import_provider,
-        &executable->library.v0->imports,
-        (iree_hal_executable_import_thunk_v0_t)iree_elf_thunk_i_ppp,
-        host_allocator);
-  }
-
-  // Verify that the library matches the executable params.
-  if (iree_status_is_ok(status)) {
-    status = iree_hal_executable_library_verify(executable_params,
-                                                executable->library.v0);
-  }
-
-  // Publish the executable sources with the tracing infrastructure.
-  if (iree_status_is_ok(status)) {
-    iree_hal_executable_library_publish_source_files(executable->library.v0);
+  // Deferred loading requires that the executable data outlive us; if it does
+  // we only retain what we need to load later and return the stub. Otherwise
+  // we perform the full load immediately.
+  const bool defer_load = iree_all_bits_set(
+      executable_params->caching_mode,
+      IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA |
+          IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_DEFERRED_LOADING);
+  if (iree_status_is_ok(status) && defer_load) {
+    executable->pending_params = *executable_params;
+    executable->pending_params.constants =
+        executable->base.environment.constants;
+    iree_io_file_handle_retain(executable->pending_params.executable_file);
+    executable->pending_loader = executable_loader;
+    iree_hal_executable_loader_retain(executable->pending_loader);
+  } else if (iree_status_is_ok(status)) {
+    status = iree_hal_elf_executable_load(executable, executable_params,
+                                          executable_loader->import_provider);
+    if (iree_status_is_ok(status)) {
+      iree_atomic_store(&executable->is_loaded, 1, iree_memory_order_release);
+    }
   }
 
   if (iree_status_is_ok(status)) {
@@ -160,6 +238,15 @@ static iree_status_t iree_hal_elf_executable_create(
   return status;
 }
 
+// Drops the resources retained for a deferred load.
+static void iree_hal_elf_executable_release_pending(
+    iree_hal_elf_executable_t* executable) {
+  iree_io_file_handle_release(executable->pending_params.executable_file);
+  executable->pending_params.executable_file = NULL;
+  iree_hal_executable_loader_release(executable->pending_loader);
+  executable->pending_loader = NULL;
+}
+
 static void iree_hal_elf_executable_destroy(
     iree_hal_executable_t* base_executable) {
   iree_hal_elf_executable_t* executable =
@@ -167,6 +254,10 @@ static void iree_hal_elf_executable_destroy(
   iree_allocator_t host_allocator = executable->base.host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_hal_elf_executable_release_pending(executable);
+  iree_status_ignore(executable->load_status);
+  iree_slim_mutex_deinitialize(&executable->load_mutex);
+
   iree_elf_module_deinitialize(&executable->module);
 
   iree_hal_executable_library_deinitialize_imports(
@@ -179,6 +270,37 @@ static void iree_hal_elf_executable_destroy(
   IREE_TRACE_ZONE_END(z0);
 }
 
+static iree_status_t iree_hal_elf_executable_ensure_loaded(
+    iree_hal_local_executable_t* base_executable) {
+  iree_hal_elf_executable_t* executable =
+      (iree_hal_elf_executable_t*)base_executable;
+  if (IREE_LIKELY(iree_atomic_load(&executable->is_loaded,
+                                   iree_memory_order_acquire))) {
+    return iree_ok_status();
+  }
+
+  iree_slim_mutex_lock(&executable->load_mutex);
+  iree_status_t status = iree_ok_status();
+  if (iree_atomic_load(&executable->is_loaded, iree_memory_order_relaxed)) {
+    // Loaded by another thread while we were waiting on the lock.
+  } else if (executable->pending_loader) {
+    status = iree_hal_elf_executable_load(
+        executable, &executable->pending_params,
+        executable->pending_loader->import_provider);
+    iree_hal_elf_executable_release_pending(executable);
+    if (iree_status_is_ok(status)) {
+      iree_atomic_store(&executable->is_loaded, 1, iree_memory_order_release);
+    } else {
+      executable->load_status = iree_status_clone(status);
+    }
+  } else {
+    // A prior load attempt failed; all users get the same error.
+    status = iree_status_clone(executable->load_status);
+  }
+  iree_slim_mutex_unlock(&executable->load_mutex);
+  return status;
+}
+
 static iree_status_t iree_hal_elf_executable_issue_call(
     iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -188,7 +310,10 @@ static iree_status_t iree_hal_elf_executable_issue_call(
       (iree_hal_elf_executable_t*)base_executable;
   const iree_hal_executable_library_v0_t* library = executable->library.v0;
 
-  if (IREE_UNLIKELY(ordinal >= library->exports.count)) {
+  if (IREE_UNLIKELY(!library)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "executable has not been loaded");
+  } else if (IREE_UNLIKELY(ordinal >= library->exports.count)) {
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "entry point ordinal out of bounds");
   }
@@ -211,6 +336,16 @@ static iree_status_t iree_hal_elf_executable_issue_call(
                         ret);
 }
 
+static void iree_hal_elf_executable_query_export_info(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_info_t* out_info) {
+  iree_hal_elf_executable_t* executable =
+      (iree_hal_elf_executable_t*)base_executable;
+  if (!executable->library.v0) return;  // not yet loaded
+  iree_hal_executable_library_query_export_info(
+      executable->identifier, executable->library.v0, ordinal, out_info);
+}
+
 static const iree_hal_local_executable_vtable_t iree_hal_elf_executable_vtable =
     {
         .base =
@@ -218,6 +353,8 @@ static const iree_hal_local_executable_vtable_t iree_hal_elf_executable_vtable =
                 .destroy = iree_hal_elf_executable_destroy,
             },
         .issue_call = iree_hal_elf_executable_issue_call,
+        .query_export_info = iree_hal_elf_executable_query_export_info,
+        .ensure_loaded = iree_hal_elf_executable_ensure_loaded,
 };
 
 //===----------------------------------------------------------------------===//
@@ -291,7 +428,7 @@ static iree_status_t iree_hal_embedded_elf_loader_try_load(
 
   // Perform the load of the ELF and wrap it in an executable handle.
   iree_status_t status = iree_hal_elf_executable_create(
-      executable_params, base_executable_loader->import_provider,
+      executable_params, base_executable_loader,
       executable_loader->host_allocator, out_executable);
 
   IREE_TRACE_ZONE_END(z0);
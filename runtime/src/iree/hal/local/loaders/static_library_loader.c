@@ -65,6 +65,7 @@ static iree_status_t iree_hal_static_executable_create(
                                          host_allocator, &executable->base);
     executable->library.header = library_header;
     executable->identifier = iree_make_cstring_view((*library_header)->name);
+    executable->base.export_count = executable->library.v0->exports.count;
     executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
   }
 
@@ -154,6 +155,16 @@ static iree_status_t iree_hal_static_executable_issue_call(
                         ret);
 }
 
+static void iree_hal_static_executable_query_export_info(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_info_t* out_info) {
+  iree_hal_static_executable_t* executable =
+      (iree_hal_static_executable_t*)base_executable;
+  if (!executable->library.v0) return;  // not yet loaded
+  iree_hal_executable_library_query_export_info(
+      executable->identifier, executable->library.v0, ordinal, out_info);
+}
+
 static const iree_hal_local_executable_vtable_t
     iree_hal_static_executable_vtable = {
         .base =
@@ -161,6 +172,7 @@ static const iree_hal_local_executable_vtable_t
                 .destroy = iree_hal_static_executable_destroy,
             },
         .issue_call = iree_hal_static_executable_issue_call,
+        .query_export_info = iree_hal_static_executable_query_export_info,
 };
 
 //===----------------------------------------------------------------------===//
@@ -9,8 +9,13 @@
 #include <stdbool.h>
 #include <stddef.h>
 #include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
 
+#include "iree/base/internal/call_once.h"
 #include "iree/base/internal/dynamic_library.h"
+#include "iree/base/internal/file_io.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/local/executable_library.h"
 #include "iree/hal/local/executable_library_util.h"
@@ -70,6 +75,251 @@ iree_hal_system_executable_try_query_footer(
   return footer;
 }
 
+//===----------------------------------------------------------------------===//
+// iree_hal_system_library_cache_t
+//===----------------------------------------------------------------------===//
+
+// File extension used for libraries extracted into the cache directory.
+#if defined(IREE_PLATFORM_APPLE)
+#define IREE_HAL_SYSTEM_LIBRARY_FILE_EXTENSION "dylib"
+#elif defined(IREE_PLATFORM_WINDOWS)
+#define IREE_HAL_SYSTEM_LIBRARY_FILE_EXTENSION "dll"
+#else
+#define IREE_HAL_SYSTEM_LIBRARY_FILE_EXTENSION "so"
+#endif  // IREE_PLATFORM_*
+
+// A loaded system library shared by all executables in the process that were
+// created from the same library contents. Loading a system library requires
+// extracting it to a file and running the platform dynamic linker over it and
+// that is wasted work (and duplicate mappings) when many contexts load the same
+// program.
+typedef struct iree_hal_system_library_cache_entry_t {
+  struct iree_hal_system_library_cache_entry_t* next;
+  // Digest and length of the library contents used as the cache key.
+  uint64_t digest;
+  iree_host_size_t length;
+  // Number of executables using the library. Guarded by the cache mutex.
+  iree_host_size_t use_count;
+  // Loaded platform dynamic library.
+  iree_dynamic_library_t* library;
+} iree_hal_system_library_cache_entry_t;
+
+// Process-wide cache of loaded libraries. Entries are removed and their
+// libraries unloaded when the last executable using them is destroyed.
+static struct {
+  iree_slim_mutex_t mutex;
+  iree_hal_system_library_cache_entry_t* head IREE_GUARDED_BY(mutex);
+} iree_hal_system_library_cache_;
+static iree_once_flag iree_hal_system_library_cache_init_once_flag_ =
+    IREE_ONCE_FLAG_INIT;
+
+static void iree_hal_system_library_cache_initialize(void) {
+  iree_slim_mutex_initialize(&iree_hal_system_library_cache_.mutex);
+}
+
+// Returns a digest of |data| used to identify libraries by their contents.
+// FNV-1a over little-endian 64-bit words with a final avalanche so that the
+// digest (and the file names derived from it) is stable across hosts.
+static uint64_t iree_hal_system_library_digest(iree_const_byte_span_t data) {
+  const uint64_t prime = 0x100000001B3ull;
+  uint64_t digest = 0xCBF29CE484222325ull ^ data.data_length;
+  const uint8_t* p = data.data;
+  iree_host_size_t remaining = data.data_length;
+  for (; remaining >= sizeof(uint64_t); remaining -= sizeof(uint64_t)) {
+    digest = (digest ^ iree_unaligned_load_le_u64((const uint64_t*)p)) * prime;
+    digest ^= digest >> 29;
+    p += sizeof(uint64_t);
+  }
+  for (; remaining > 0; --remaining) {
+    digest = (digest ^ *p++) * prime;
+  }
+  digest ^= digest >> 33;
+  return digest;
+}
+
+// Loads |library_data| from a file in |cache_dir| named by its |digest|,
+// extracting it first if no prior load (in this or any other process) has.
+static iree_status_t iree_hal_system_library_load_from_cache_dir(
+    iree_string_view_t cache_dir, uint64_t digest,
+    iree_const_byte_span_t library_data, iree_allocator_t host_allocator,
+    iree_dynamic_library_t** out_library) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_string_builder_t path_builder;
+  iree_string_builder_initialize(host_allocator, &path_builder);
+  iree_status_t status = iree_string_builder_append_format(
+      &path_builder,
+      "%.*s/iree_dylib_%016" PRIx64 "_%" PRIhsz
+      "." IREE_HAL_SYSTEM_LIBRARY_FILE_EXTENSION,
+      (int)cache_dir.size, cache_dir.data, digest, library_data.data_length);
+  const char* path = iree_string_builder_buffer(&path_builder);
+
+  bool exists = false;
+  if (iree_status_is_ok(status)) {
+    iree_status_t exists_status = iree_file_exists(path);
+    exists = iree_status_is_ok(exists_status);
+    iree_status_ignore(exists_status);
+  }
+
+  // Extract the library to a unique temporary file and then atomically rename
+  // it into place so that concurrent loaders never observe a partially
+  // written library. Losing the race to another loader is fine as the contents
+  // are identical.
+  if (iree_status_is_ok(status) && !exists) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_hal_system_library_extract");
+    iree_string_builder_t temp_path_builder;
+    iree_string_builder_initialize(host_allocator, &temp_path_builder);
+    status = iree_string_builder_append_format(
+        &temp_path_builder, "%s.%016" PRIx64 ".tmp", path,
+        (uint64_t)iree_time_now() ^ (uint64_t)(uintptr_t)&temp_path_builder);
+    const char* temp_path = iree_string_builder_buffer(&temp_path_builder);
+    if (iree_status_is_ok(status)) {
+      status = iree_file_write_contents(temp_path, library_data);
+    }
+    bool published = false;
+    if (iree_status_is_ok(status)) {
+      if (rename(temp_path, path) == 0) {
+        published = true;
+      } else {
+        // Some platforms fail the rename if another loader published the file
+        // first; only fail if there's still nothing to load.
+        status = iree_file_exists(path);
+      }
+    }
+    if (!published) remove(temp_path);
+    iree_string_builder_deinitialize(&temp_path_builder);
+    IREE_TRACE_ZONE_END(z1);
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_dynamic_library_load_from_file(
+        path, IREE_DYNAMIC_LIBRARY_FLAG_NONE, iree_allocator_system(),
+        out_library);
+  }
+
+  iree_string_builder_deinitialize(&path_builder);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Acquires a process-wide cache entry for the library with |library_data|
+// contents, loading it if it is not already loaded. When |cache_dir| is not
+// empty the library is extracted into and loaded from it so that subsequent
+// processes can skip the extraction. The entry must be released with
+// iree_hal_system_library_cache_release.
+static iree_status_t iree_hal_system_library_cache_acquire(
+    iree_string_view_t cache_dir, iree_const_byte_span_t library_data,
+    iree_const_byte_span_t debug_data, iree_allocator_t host_allocator,
+    iree_hal_system_library_cache_entry_t** out_entry) {
+  *out_entry = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_call_once(&iree_hal_system_library_cache_init_once_flag_,
+                 iree_hal_system_library_cache_initialize);
+
+  const uint64_t digest = iree_hal_system_library_digest(library_data);
+
+  // Fast path for libraries that are already loaded.
+  iree_slim_mutex_lock(&iree_hal_system_library_cache_.mutex);
+  for (iree_hal_system_library_cache_entry_t* entry =
+           iree_hal_system_library_cache_.head;
+       entry != NULL; entry = entry->next) {
+    if (entry->digest == digest &&
+        entry->length == library_data.data_length) {
+      ++entry->use_count;
+      *out_entry = entry;
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&iree_hal_system_library_cache_.mutex);
+  if (*out_entry) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  // Load the library outside of the lock so that loads of unrelated libraries
+  // can proceed concurrently. The library may outlive the device that first
+  // loaded it and uses the system allocator.
+  iree_dynamic_library_t* library = NULL;
+  iree_status_t status = iree_ok_status();
+  if (!iree_string_view_is_empty(cache_dir)) {
+    status = iree_hal_system_library_load_from_cache_dir(
+        cache_dir, digest, library_data, host_allocator, &library);
+  } else {
+    status = iree_dynamic_library_load_from_memory(
+        iree_make_cstring_view("aot"), library_data,
+        IREE_DYNAMIC_LIBRARY_FLAG_NONE, iree_allocator_system(), &library);
+  }
+  if (iree_status_is_ok(status) && debug_data.data_length > 0) {
+    status =
+        iree_dynamic_library_attach_symbols_from_memory(library, debug_data);
+  }
+  iree_hal_system_library_cache_entry_t* new_entry = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(iree_allocator_system(), sizeof(*new_entry),
+                                   (void**)&new_entry);
+  }
+  if (!iree_status_is_ok(status)) {
+    iree_dynamic_library_release(library);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+  new_entry->digest = digest;
+  new_entry->length = library_data.data_length;
+  new_entry->use_count = 1;
+  new_entry->library = library;
+
+  // Publish the entry unless another thread loaded the same library while we
+  // were loading ours.
+  iree_hal_system_library_cache_entry_t* existing_entry = NULL;
+  iree_slim_mutex_lock(&iree_hal_system_library_cache_.mutex);
+  for (iree_hal_system_library_cache_entry_t* entry =
+           iree_hal_system_library_cache_.head;
+       entry != NULL; entry = entry->next) {
+    if (entry->digest == digest &&
+        entry->length == library_data.data_length) {
+      ++entry->use_count;
+      existing_entry = entry;
+      break;
+    }
+  }
+  if (!existing_entry) {
+    new_entry->next = iree_hal_system_library_cache_.head;
+    iree_hal_system_library_cache_.head = new_entry;
+  }
+  iree_slim_mutex_unlock(&iree_hal_system_library_cache_.mutex);
+  if (existing_entry) {
+    iree_dynamic_library_release(new_entry->library);
+    iree_allocator_free(iree_allocator_system(), new_entry);
+    *out_entry = existing_entry;
+  } else {
+    *out_entry = new_entry;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Releases a use of |entry| and unloads its library if it was the last.
+static void iree_hal_system_library_cache_release(
+    iree_hal_system_library_cache_entry_t* entry) {
+  if (!entry) return;
+  bool is_last_use = false;
+  iree_slim_mutex_lock(&iree_hal_system_library_cache_.mutex);
+  if (--entry->use_count == 0) {
+    iree_hal_system_library_cache_entry_t** prev_next =
+        &iree_hal_system_library_cache_.head;
+    while (*prev_next != entry) prev_next = &(*prev_next)->next;
+    *prev_next = entry->next;
+    is_last_use = true;
+  }
+  iree_slim_mutex_unlock(&iree_hal_system_library_cache_.mutex);
+  if (is_last_use) {
+    iree_dynamic_library_release(entry->library);
+    iree_allocator_free(iree_allocator_system(), entry);
+  }
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_system_executable_t
 //===----------------------------------------------------------------------===//
@@ -77,7 +327,10 @@ iree_hal_system_executable_try_query_footer(
 typedef struct iree_hal_system_executable_t {
   iree_hal_local_executable_t base;
 
-  // Loaded platform dynamic library.
+  // Process-wide cache entry owning the loaded library.
+  iree_hal_system_library_cache_entry_t* cache_entry;
+
+  // Loaded platform dynamic library owned by |cache_entry|.
   iree_dynamic_library_t* handle;
 
   // Name used for the file field in tracy and debuggers.
@@ -95,10 +348,12 @@ static const iree_hal_local_executable_vtable_t
 
 // Loads the executable and optional debug database from the given
 // |executable_data| in memory. The memory must remain live for the lifetime
-// of the executable.
+// of the executable. If the same library has already been loaded in the
+// process the existing library is shared.
 static iree_status_t iree_hal_system_executable_load(
     iree_hal_system_executable_t* executable,
-    iree_const_byte_span_t executable_data, iree_allocator_t host_allocator) {
+    iree_const_byte_span_t executable_data, iree_string_view_t cache_dir,
+    iree_allocator_t host_allocator) {
   // Check to see if the library has a footer indicating embedded debug data.
   iree_const_byte_span_t library_data = iree_make_const_byte_span(NULL, 0);
   iree_const_byte_span_t debug_data = iree_make_const_byte_span(NULL, 0);
@@ -123,14 +378,10 @@ static iree_status_t iree_hal_system_executable_load(
     library_data = executable_data;
   }
 
-  IREE_RETURN_IF_ERROR(iree_dynamic_library_load_from_memory(
-      iree_make_cstring_view("aot"), library_data,
-      IREE_DYNAMIC_LIBRARY_FLAG_NONE, host_allocator, &executable->handle));
-
-  if (debug_data.data_length > 0) {
-    IREE_RETURN_IF_ERROR(iree_dynamic_library_attach_symbols_from_memory(
-        executable->handle, debug_data));
-  }
+  IREE_RETURN_IF_ERROR(iree_hal_system_library_cache_acquire(
+      cache_dir, library_data, debug_data, host_allocator,
+      &executable->cache_entry));
+  executable->handle = executable->cache_entry->library;
 
   return iree_ok_status();
 }
@@ -198,6 +449,7 @@ static iree_status_t iree_hal_system_executable_query_library(
   }
 
   executable->identifier = iree_make_cstring_view(header->name);
+  executable->base.export_count = executable->library.v0->exports.count;
   executable->base.dispatch_attrs = executable->library.v0->exports.attrs;
   return iree_ok_status();
 }
@@ -211,7 +463,8 @@ static int iree_hal_system_executable_import_thunk_v0(
 static iree_status_t iree_hal_system_executable_create(
     const iree_hal_executable_params_t* executable_params,
     const iree_hal_executable_import_provider_t import_provider,
-    iree_allocator_t host_allocator, iree_hal_executable_t** out_executable) {
+    iree_string_view_t cache_dir, iree_allocator_t host_allocator,
+    iree_hal_executable_t** out_executable) {
   IREE_ASSERT_ARGUMENT(executable_params);
   IREE_ASSERT_ARGUMENT(executable_params->executable_data.data &&
                        executable_params->executable_data.data_length);
@@ -245,7 +498,8 @@ static iree_status_t iree_hal_system_executable_create(
   // Attempt to extract the embedded library and load it.
   if (iree_status_is_ok(status)) {
     status = iree_hal_system_executable_load(
-        executable, executable_params->executable_data, host_allocator);
+        executable, executable_params->executable_data, cache_dir,
+        host_allocator);
   }
 
   // Query metadata and get the entry point function pointers.
@@ -288,7 +542,7 @@ static void iree_hal_system_executable_destroy(
   iree_allocator_t host_allocator = executable->base.host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
-  iree_dynamic_library_release(executable->handle);
+  iree_hal_system_library_cache_release(executable->cache_entry);
 
   iree_hal_executable_library_deinitialize_imports(
       &executable->base.environment, host_allocator);
@@ -331,6 +585,16 @@ static iree_status_t iree_hal_system_executable_issue_call(
                         ret);
 }
 
+static void iree_hal_system_executable_query_export_info(
+    iree_hal_local_executable_t* base_executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_info_t* out_info) {
+  iree_hal_system_executable_t* executable =
+      (iree_hal_system_executable_t*)base_executable;
+  if (!executable->library.v0) return;  // not yet loaded
+  iree_hal_executable_library_query_export_info(
+      executable->identifier, executable->library.v0, ordinal, out_info);
+}
+
 static const iree_hal_local_executable_vtable_t
     iree_hal_system_executable_vtable = {
         .base =
@@ -338,6 +602,7 @@ static const iree_hal_local_executable_vtable_t
                 .destroy = iree_hal_system_executable_destroy,
             },
         .issue_call = iree_hal_system_executable_issue_call,
+        .query_export_info = iree_hal_system_executable_query_export_info,
 };
 
 //===----------------------------------------------------------------------===//
@@ -348,22 +613,45 @@ typedef struct iree_hal_system_library_loader_t {
   iree_hal_executable_loader_t base;
   iree_allocator_t host_allocator;
   iree_hal_executable_plugin_manager_t* plugin_manager;
+  // Directory libraries are persisted to or empty if disabled.
+  // Stored inline with the loader allocation.
+  iree_string_view_t cache_dir;
 } iree_hal_system_library_loader_t;
 
 static const iree_hal_executable_loader_vtable_t
     iree_hal_system_library_loader_vtable;
 
+void iree_hal_system_library_loader_options_initialize(
+    iree_hal_system_library_loader_options_t* out_options) {
+  memset(out_options, 0, sizeof(*out_options));
+  out_options->cache_dir = iree_make_cstring_view(
+      getenv("IREE_SYSTEM_LIBRARY_CACHE_DIR"));
+}
+
 iree_status_t iree_hal_system_library_loader_create(
     iree_hal_executable_plugin_manager_t* plugin_manager,
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader) {
+  iree_hal_system_library_loader_options_t options;
+  iree_hal_system_library_loader_options_initialize(&options);
+  return iree_hal_system_library_loader_create_with_options(
+      &options, plugin_manager, host_allocator, out_executable_loader);
+}
+
+iree_status_t iree_hal_system_library_loader_create_with_options(
+    const iree_hal_system_library_loader_options_t* options,
+    iree_hal_executable_plugin_manager_t* plugin_manager,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader) {
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(out_executable_loader);
   *out_executable_loader = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
 
   iree_hal_system_library_loader_t* executable_loader = NULL;
   iree_status_t status = iree_allocator_malloc(
-      host_allocator, sizeof(*executable_loader), (void**)&executable_loader);
+      host_allocator, sizeof(*executable_loader) + options->cache_dir.size,
+      (void**)&executable_loader);
   if (iree_status_is_ok(status)) {
     iree_hal_executable_loader_initialize(
         &iree_hal_system_library_loader_vtable,
@@ -371,6 +659,9 @@ iree_status_t iree_hal_system_library_loader_create(
         &executable_loader->base);
     executable_loader->host_allocator = host_allocator;
     executable_loader->plugin_manager = plugin_manager;
+    iree_string_view_append_to_buffer(
+        options->cache_dir, &executable_loader->cache_dir,
+        (char*)executable_loader + sizeof(*executable_loader));
     iree_hal_executable_plugin_manager_retain(
         executable_loader->plugin_manager);
     *out_executable_loader = (iree_hal_executable_loader_t*)executable_loader;
@@ -424,7 +715,8 @@ static iree_status_t iree_hal_system_library_loader_try_load(
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_system_executable_create(
               executable_params, base_executable_loader->import_provider,
-              executable_loader->host_allocator, out_executable));
+              executable_loader->cache_dir, executable_loader->host_allocator,
+              out_executable));
 
   IREE_TRACE_ZONE_END(z0);
   return iree_ok_status();
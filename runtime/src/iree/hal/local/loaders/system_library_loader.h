@@ -20,9 +20,28 @@ extern "C" {
 typedef struct iree_hal_executable_plugin_manager_t
     iree_hal_executable_plugin_manager_t;
 
+// Options controlling how system libraries are loaded.
+typedef struct iree_hal_system_library_loader_options_t {
+  // Directory that libraries are extracted to and loaded from, keyed by a
+  // digest of their contents. Loads of a library that was extracted by a prior
+  // load in this or any other process skip the extraction. The directory must
+  // exist and is never cleaned up by the loader. When empty libraries are
+  // extracted to temporary files that are deleted once loaded.
+  iree_string_view_t cache_dir;
+} iree_hal_system_library_loader_options_t;
+
+// Initializes |out_options| to its default values. The cache directory is
+// taken from the IREE_SYSTEM_LIBRARY_CACHE_DIR environment variable, if set.
+void iree_hal_system_library_loader_options_initialize(
+    iree_hal_system_library_loader_options_t* out_options);
+
 // Creates an executable loader that can load files from platform-supported
 // dynamic libraries (such as .dylib on darwin, .so on linux, .dll on windows).
 //
+// Libraries are loaded once per process: executables created from the same
+// library contents (such as the same program loaded into multiple contexts)
+// share the loaded library until the last of them is destroyed.
+//
 // This uses the legacy "dylib"-style format that will be deleted soon and is
 // only a placeholder until the compiler can be switched to output
 // iree_hal_executable_library_t-compatible files.
@@ -31,6 +50,14 @@ iree_status_t iree_hal_system_library_loader_create(
     iree_allocator_t host_allocator,
     iree_hal_executable_loader_t** out_executable_loader);
 
+// Creates a system library executable loader with the given |options|.
+// See iree_hal_system_library_loader_create for more information.
+iree_status_t iree_hal_system_library_loader_create_with_options(
+    const iree_hal_system_library_loader_options_t* options,
+    iree_hal_executable_plugin_manager_t* plugin_manager,
+    iree_allocator_t host_allocator,
+    iree_hal_executable_loader_t** out_executable_loader);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
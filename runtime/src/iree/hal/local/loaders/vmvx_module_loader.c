@@ -17,6 +17,7 @@
 #include "iree/vm/bytecode/module.h"
 
 #define IREE_VMVX_ENTRY_SIGNATURE "0rrriiiiiiiii_v"
+#define IREE_VMVX_SET_CONSTANTS_SIGNATURE "0r_v"
 
 // Index of the module in the context_modules list.
 // This should always be first so that it can be overridden by user modules.
@@ -60,6 +61,20 @@ static iree_status_t iree_hal_vmvx_executable_set_constants(
                             "but none were provided");
   }
 
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&set_function);
+  if (!iree_string_view_equal(
+          signature.calling_convention,
+          iree_make_cstring_view(IREE_VMVX_SET_CONSTANTS_SIGNATURE))) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "executable __set_constants does not match the expected calling "
+        "convention; expected '" IREE_VMVX_SET_CONSTANTS_SIGNATURE
+        "' but got '%.*s', possible ABI version mismatch",
+        (int)signature.calling_convention.size,
+        signature.calling_convention.data);
+  }
+
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Wrap the constant memory in an on-stack buffer.
@@ -70,32 +85,28 @@ static iree_status_t iree_hal_vmvx_executable_set_constants(
                           constant_count * sizeof(*constants)),
       iree_allocator_null(), &buffer);
 
-  // Setup input list.
-  // TODO(benvanik): replace with direct call.
-  uint8_t input_storage[64] = {0};
-  iree_vm_list_t* inputs = NULL;
-  iree_vm_type_def_t element_type =
-      iree_vm_make_ref_type_def(iree_vm_buffer_type());
-  status = iree_vm_list_initialize(
-      iree_make_byte_span(input_storage, sizeof(input_storage)), &element_type,
-      1, &inputs);
-  if (iree_status_is_ok(status)) {
-    iree_vm_ref_t buffer_ref = iree_vm_buffer_retain_ref(&buffer);
-    status = iree_vm_list_push_ref_move(inputs, &buffer_ref);
-  }
-
-  // Copy the executable constants into the module state.
-  if (iree_status_is_ok(status)) {
-    status = iree_vm_invoke(context, set_function,
-                            IREE_VM_INVOCATION_FLAG_TRACE_INLINE,
-                            /*policy=*/NULL, inputs,
-                            /*outputs=*/NULL, host_allocator);
-  }
-
-  // Inputs *must* be released here as we allocated it on the stack.
-  if (inputs) {
-    iree_vm_list_deinitialize(inputs);
-  }
+  // Copy the executable constants into the module state with a direct call;
+  // we've verified the signature above and know the exact argument format.
+  struct {
+    iree_vm_ref_t constants;
+  } call_args = {
+      .constants =
+          {
+              .type = iree_vm_buffer_type(),
+              .ptr = &buffer,
+          },
+  };
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_TRACE_INLINE,
+                                  iree_vm_context_state_resolver(context),
+                                  host_allocator);
+  iree_vm_function_call_t call;
+  memset(&call, 0, sizeof(call));
+  call.function = set_function;
+  call.arguments = iree_make_byte_span(&call_args, sizeof(call_args));
+  call.results = iree_make_byte_span(NULL, 0);
+  status = set_function.module->begin_call(set_function.module->self, stack,
+                                           call);
+  iree_vm_stack_deinitialize(stack);
 
   // Buffer *must* be released here since we don't control the constant
   // lifetime - this will abort if it's not.
@@ -118,6 +129,16 @@ typedef struct iree_hal_vmvx_worker_state_t {
   // Pointer into the VMVX module state for the worker context.
   // This is used to update module state directly.
   iree_vm_module_state_t* vmvx_module_state;
+
+  // Reusable call argument state. The buffers are owned by the worker and
+  // retargeted in-place at the dispatch memory on each call so that issuing a
+  // workgroup performs no allocations or list construction. |binding_list|
+  // retains the first N binding buffers and is only resized when the binding
+  // count changes between dispatches.
+  iree_vm_buffer_t local_memory_buffer;
+  iree_vm_buffer_t constants_buffer;
+  iree_vm_list_t* binding_list;
+  iree_vm_buffer_t binding_buffers[IREE_HAL_EXECUTABLE_MAX_BINDING_COUNT];
 } iree_hal_vmvx_worker_state_t;
 
 static iree_status_t iree_hal_vmvx_worker_state_initialize(
@@ -129,6 +150,32 @@ static iree_status_t iree_hal_vmvx_worker_state_initialize(
   IREE_TRACE_ZONE_BEGIN(z0);
   memset(out_state, 0, sizeof(*out_state));
 
+  // Initialize the reusable argument buffers; they'll point at real memory
+  // once we issue calls.
+  iree_vm_buffer_initialize(
+      IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+      iree_byte_span_empty(), iree_allocator_null(),
+      &out_state->local_memory_buffer);
+  iree_vm_buffer_initialize(IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+                            iree_byte_span_empty(), iree_allocator_null(),
+                            &out_state->constants_buffer);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(out_state->binding_buffers);
+       ++i) {
+    // TODO(benvanik): pipeline layout contains the required access
+    // information. We will likely want to encode a bitmap of mutable bindings
+    // such that we can quickly set the access bit, though.
+    iree_vm_buffer_initialize(
+        IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
+        iree_byte_span_empty(), iree_allocator_null(),
+        &out_state->binding_buffers[i]);
+  }
+  iree_vm_type_def_t buffer_type =
+      iree_vm_make_ref_type_def(iree_vm_buffer_type());
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_list_create(buffer_type,
+                              IREE_ARRAYSIZE(out_state->binding_buffers),
+                              host_allocator, &out_state->binding_list));
+
   // Create the context unique to this worker.
   iree_vm_context_t* context = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -168,9 +215,58 @@ static void iree_hal_vmvx_worker_state_deinitialize(
     iree_vm_context_release(state->context);
     state->context = NULL;
   }
+  if (state->binding_list) {
+    // Drops the references to the binding buffers so they can be deinitialized.
+    iree_vm_list_release(state->binding_list);
+    state->binding_list = NULL;
+    iree_vm_buffer_deinitialize(&state->local_memory_buffer);
+    iree_vm_buffer_deinitialize(&state->constants_buffer);
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(state->binding_buffers);
+         ++i) {
+      iree_vm_buffer_deinitialize(&state->binding_buffers[i]);
+    }
+  }
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Retargets the worker argument buffers at the memory referenced by
+// |dispatch_state| and |workgroup_state|. The binding list is only modified
+// when the binding count differs from the prior call.
+static iree_status_t iree_hal_vmvx_worker_state_update_arguments(
+    iree_hal_vmvx_worker_state_t* state,
+    const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state) {
+  const iree_host_size_t binding_count = dispatch_state->binding_count;
+  if (IREE_UNLIKELY(binding_count > IREE_ARRAYSIZE(state->binding_buffers))) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "binding count %" PRIhsz " exceeds limit of %d",
+                            binding_count,
+                            IREE_HAL_EXECUTABLE_MAX_BINDING_COUNT);
+  }
+
+  state->local_memory_buffer.data = iree_make_byte_span(
+      workgroup_state->local_memory, workgroup_state->local_memory_size);
+  state->constants_buffer.data = iree_make_byte_span(
+      (void*)dispatch_state->constants,
+      sizeof(uint32_t) * dispatch_state->constant_count);
+  for (iree_host_size_t i = 0; i < binding_count; ++i) {
+    state->binding_buffers[i].data = iree_make_byte_span(
+        dispatch_state->binding_ptrs[i], dispatch_state->binding_lengths[i]);
+  }
+
+  const iree_host_size_t current_count = iree_vm_list_size(state->binding_list);
+  if (IREE_LIKELY(current_count == binding_count)) return iree_ok_status();
+  IREE_RETURN_IF_ERROR(iree_vm_list_resize(state->binding_list, binding_count));
+  for (iree_host_size_t i = current_count; i < binding_count; ++i) {
+    iree_vm_ref_t ref = {0};
+    IREE_RETURN_IF_ERROR(iree_vm_ref_wrap_assign(
+        &state->binding_buffers[i], iree_vm_buffer_type(), &ref));
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_set_ref_retain(state->binding_list, i, &ref));
+  }
+  return iree_ok_status();
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_vmvx_executable_t
 //===----------------------------------------------------------------------===//
@@ -249,6 +345,7 @@ static iree_status_t iree_hal_vmvx_executable_create(
     ptr += dispatch_attrs_size;
     iree_hal_local_executable_initialize(&iree_hal_vmvx_executable_vtable,
                                          host_allocator, &executable->base);
+    executable->base.export_count = entry_count;
     executable->base.dispatch_attrs = dispatch_attrs;
 
     executable->worker_capacity = worker_capacity;
@@ -378,65 +475,11 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   iree_vmvx_module_state_update_workgroup_state(worker_state->vmvx_module_state,
                                                 workgroup_state->processor_id);
 
-  // On-stack interface local to this invocation.
-  // Note that we _could_ share this across all invocations in a dispatch, but
-  // it's tricky to find a good place when threading is happening and it's
-  // intentionally fairly cheap to construct by matching the dispatch_state.
-  // The list would only need to be constructed once and we could avoid the
-  // extraneous retain/releases and mappings.
-  iree_vm_type_def_t buffer_type =
-      iree_vm_make_ref_type_def(iree_vm_buffer_type());
-  iree_host_size_t binding_list_size =
-      iree_vm_list_storage_size(&buffer_type, dispatch_state->binding_count);
-  void* binding_list_storage = iree_alloca(binding_list_size);
-  iree_vm_list_t* binding_list = NULL;
-  IREE_RETURN_IF_ERROR(iree_vm_list_initialize(
-      iree_make_byte_span(binding_list_storage, binding_list_size),
-      &buffer_type, dispatch_state->binding_count, &binding_list));
-
-  // Map bindings into on-stack VMVX buffers.
-  iree_status_t status = iree_ok_status();
-  iree_vm_buffer_t* binding_buffers = (iree_vm_buffer_t*)iree_alloca(
-      dispatch_state->binding_count * sizeof(iree_vm_buffer_t));
-  for (iree_host_size_t i = 0; i < dispatch_state->binding_count; ++i) {
-    iree_vm_buffer_t* binding_buffer = &binding_buffers[i];
-    // TODO(benvanik): pipeline layout contains the required access
-    // information. We will likely want to encode a bitmap of mutable bindings
-    // such that we can quickly set the access bit, though.
-    iree_vm_buffer_access_t access =
-        IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST;
-    iree_vm_buffer_initialize(
-        access,
-        iree_make_byte_span(dispatch_state->binding_ptrs[i],
-                            dispatch_state->binding_lengths[i]),
-        iree_allocator_null(), binding_buffer);
-    iree_vm_ref_t ref = {0};
-    status =
-        iree_vm_ref_wrap_assign(binding_buffer, iree_vm_buffer_type(), &ref);
-    if (!iree_status_is_ok(status)) break;
-    status = iree_vm_list_push_ref_retain(binding_list, &ref);
-    if (!iree_status_is_ok(status)) break;
-  }
-  if (!iree_status_is_ok(status)) {
-    iree_vm_list_deinitialize(binding_list);
-    return status;
-  }
-
-  // Acquire workgroup local memory for the dispatch.
-  iree_vm_buffer_t local_memory_buffer;
-  iree_vm_buffer_initialize(
-      IREE_VM_BUFFER_ACCESS_MUTABLE | IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
-      iree_make_byte_span(workgroup_state->local_memory,
-                          workgroup_state->local_memory_size),
-      iree_allocator_null(), &local_memory_buffer);
-
-  // Map the push constant memory directly from the dispatch state.
-  iree_vm_buffer_t constants_buffer;
-  iree_vm_buffer_initialize(
-      IREE_VM_BUFFER_ACCESS_ORIGIN_HOST,
-      iree_make_byte_span((void*)dispatch_state->constants,
-                          sizeof(uint32_t) * dispatch_state->constant_count),
-      iree_allocator_null(), &constants_buffer);
+  // Point the worker-owned argument buffers at the dispatch memory. The
+  // buffers and binding list persist across calls so steady-state workgroups
+  // perform no allocations.
+  IREE_RETURN_IF_ERROR(iree_hal_vmvx_worker_state_update_arguments(
+      worker_state, dispatch_state, workgroup_state));
 
   // Prepare call argument buffer. We've verified the signature on creation and
   // know the exact format we can assume here.
@@ -475,17 +518,17 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
       .local_memory =
           {
               .type = iree_vm_buffer_type(),
-              .ptr = &local_memory_buffer,
+              .ptr = &worker_state->local_memory_buffer,
           },
       .constants =
           {
               .type = iree_vm_buffer_type(),
-              .ptr = &constants_buffer,
+              .ptr = &worker_state->constants_buffer,
           },
       .bindings =
           {
               .type = iree_vm_list_type(),
-              .ptr = binding_list,
+              .ptr = worker_state->binding_list,
           },
       .workgroup_id_x = workgroup_state->workgroup_id_x,
       .workgroup_id_y = workgroup_state->workgroup_id_y,
@@ -501,7 +544,6 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   // VM stack stored on native stack. We really do abuse the stack too much
   // here but it's 8KB and that should be reasonable given that there isn't too
   // much above us in the stack.
-  // TODO(benvanik): pass in an iree_arena_t that can be used for this.
   IREE_VM_INLINE_STACK_INITIALIZE(
       stack, IREE_VM_INVOCATION_FLAG_TRACE_INLINE,
       iree_vm_context_state_resolver(worker_state->context),
@@ -515,18 +557,12 @@ static iree_status_t iree_hal_vmvx_executable_issue_call(
   call.function = entry_fn;
   call.arguments = iree_make_byte_span(&call_args, sizeof(call_args));
   call.results = iree_make_byte_span(NULL, 0);
-  status = entry_fn.module->begin_call(entry_fn.module->self, stack, call);
+  iree_status_t status =
+      entry_fn.module->begin_call(entry_fn.module->self, stack, call);
 
   // Clean up the stack if needed, such as when the call fails.
   iree_vm_stack_deinitialize(stack);
 
-  iree_vm_buffer_deinitialize(&local_memory_buffer);
-  iree_vm_buffer_deinitialize(&constants_buffer);
-  iree_vm_list_deinitialize(binding_list);
-  for (iree_host_size_t i = 0; i < dispatch_state->binding_count; ++i) {
-    iree_vm_buffer_deinitialize(&binding_buffers[i]);
-  }
-
   return status;
 }
 
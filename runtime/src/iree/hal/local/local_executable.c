@@ -7,6 +7,7 @@
 #include "iree/hal/local/local_executable.h"
 
 #include "iree/hal/local/executable_environment.h"
+#include "iree/hal/local/profiling.h"
 
 void iree_hal_local_executable_initialize(
     const iree_hal_local_executable_vtable_t* vtable,
@@ -16,6 +17,7 @@ void iree_hal_local_executable_initialize(
   out_base_executable->host_allocator = host_allocator;
 
   // Function attributes are optional and populated by the parent type.
+  out_base_executable->export_count = 0;
   out_base_executable->dispatch_attrs = NULL;
 
   // Default environment with no imports assigned.
@@ -31,6 +33,50 @@ iree_hal_local_executable_t* iree_hal_local_executable_cast(
   return (iree_hal_local_executable_t*)base_value;
 }
 
+iree_status_t iree_hal_local_executable_ensure_loaded(
+    iree_hal_local_executable_t* executable) {
+  IREE_ASSERT_ARGUMENT(executable);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  if (!vtable->ensure_loaded) return iree_ok_status();
+  return vtable->ensure_loaded(executable);
+}
+
+iree_status_t iree_hal_local_executable_verify_local_memory(
+    iree_hal_local_executable_t* executable,
+    iree_host_size_t local_memory_limit) {
+  IREE_ASSERT_ARGUMENT(executable);
+  if (!executable->dispatch_attrs) return iree_ok_status();
+  for (iree_host_size_t i = 0; i < executable->export_count; ++i) {
+    const iree_host_size_t local_memory_size =
+        executable->dispatch_attrs[i].local_memory_pages *
+        IREE_HAL_EXECUTABLE_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE;
+    if (IREE_UNLIKELY(local_memory_size > local_memory_limit)) {
+      return iree_make_status(
+          IREE_STATUS_RESOURCE_EXHAUSTED,
+          "entry point %" PRIhsz " requires %" PRIhsz
+          " bytes of workgroup local memory but only %" PRIhsz
+          " bytes are available",
+          i, local_memory_size, local_memory_limit);
+    }
+  }
+  return iree_ok_status();
+}
+
+void iree_hal_local_executable_query_export_info(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_info_t* out_info) {
+  IREE_ASSERT_ARGUMENT(executable);
+  IREE_ASSERT_ARGUMENT(out_info);
+  memset(out_info, 0, sizeof(*out_info));
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+  if (!vtable->query_export_info || ordinal >= executable->export_count) {
+    return;
+  }
+  vtable->query_export_info(executable, ordinal, out_info);
+}
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
@@ -39,16 +85,31 @@ iree_status_t iree_hal_local_executable_issue_call(
   IREE_ASSERT_ARGUMENT(executable);
   IREE_ASSERT_ARGUMENT(dispatch_state);
   IREE_ASSERT_ARGUMENT(workgroup_state);
-  return ((const iree_hal_local_executable_vtable_t*)
-              executable->resource.vtable)
-      ->issue_call(executable, ordinal, dispatch_state, workgroup_state,
-                   worker_id);
+  const iree_hal_local_executable_vtable_t* vtable =
+      (const iree_hal_local_executable_vtable_t*)executable->resource.vtable;
+
+  // Fast path when not profiling; the profiler check is a single relaxed load.
+  iree_hal_local_profiler_t* profiler = iree_hal_local_profiler_acquire();
+  if (IREE_LIKELY(!profiler)) {
+    return vtable->issue_call(executable, ordinal, dispatch_state,
+                              workgroup_state, worker_id);
+  }
+
+  iree_hal_local_profiler_call_t call;
+  iree_hal_local_profiler_call_begin(profiler, worker_id, &call);
+  iree_status_t status = vtable->issue_call(executable, ordinal, dispatch_state,
+                                            workgroup_state, worker_id);
+  iree_hal_local_profiler_call_end(profiler, &call, executable, ordinal,
+                                   workgroup_state);
+  iree_hal_local_profiler_release(profiler);
+  return status;
 }
 
 iree_status_t iree_hal_local_executable_issue_dispatch_inline(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
     uint32_t processor_id, iree_byte_span_t local_memory) {
+  IREE_RETURN_IF_ERROR(iree_hal_local_executable_ensure_loaded(executable));
   IREE_TRACE_ZONE_BEGIN(z0);
   // TODO(benvanik): annotate with executable name to calculate total time.
 
@@ -19,6 +19,9 @@ typedef struct iree_hal_local_executable_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
 
+  // Total number of exported entry points and entries in |dispatch_attrs|.
+  iree_host_size_t export_count;
+
   // Defines per-entry point how much workgroup local memory is required.
   // Contains entries with 0 to indicate no local memory is required or >0 in
   // units of IREE_HAL_EXECUTABLE_WORKGROUP_LOCAL_MEMORY_PAGE_SIZE for the
@@ -29,6 +32,18 @@ typedef struct iree_hal_local_executable_t {
   iree_hal_executable_environment_v0_t environment;
 } iree_hal_local_executable_t;
 
+// Debug information about an exported entry point.
+// String views reference storage owned by the executable.
+typedef struct iree_hal_local_executable_export_info_t {
+  // Name of the export function or empty if unavailable.
+  iree_string_view_t name;
+  // Source location the export was generated from or empty if unavailable.
+  iree_string_view_t source_file;
+  uint32_t source_line;
+  // Human-readable description of the export or empty if unavailable.
+  iree_string_view_t tag;
+} iree_hal_local_executable_export_info_t;
+
 typedef struct iree_hal_local_executable_vtable_t {
   iree_hal_executable_vtable_t base;
 
@@ -37,6 +52,18 @@ typedef struct iree_hal_local_executable_vtable_t {
       const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
       const iree_hal_executable_workgroup_state_v0_t* workgroup_state,
       uint32_t worker_id);
+
+  // Optional; ensures the executable has been fully loaded and that its
+  // dispatch_attrs and entry points are available. Executables that load
+  // eagerly during creation leave this NULL.
+  iree_status_t(IREE_API_PTR* ensure_loaded)(
+      iree_hal_local_executable_t* executable);
+
+  // Optional; populates debug information about the export |ordinal|.
+  // Executables without debug information leave this NULL.
+  void(IREE_API_PTR* query_export_info)(
+      iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+      iree_hal_local_executable_export_info_t* out_info);
 } iree_hal_local_executable_vtable_t;
 
 // Initializes the local executable base type.
@@ -51,6 +78,25 @@ void iree_hal_local_executable_deinitialize(
 iree_hal_local_executable_t* iree_hal_local_executable_cast(
     iree_hal_executable_t* base_value);
 
+// Ensures that |executable| has been fully loaded. Executables may defer their
+// load until first use and this must be called before the dispatch_attrs are
+// queried or any entry point is issued. Returns the load failure, if any.
+iree_status_t iree_hal_local_executable_ensure_loaded(
+    iree_hal_local_executable_t* executable);
+
+// Verifies that no entry point in |executable| requires more than
+// |local_memory_limit| bytes of workgroup local memory. The executable must
+// have been loaded with iree_hal_local_executable_ensure_loaded.
+iree_status_t iree_hal_local_executable_verify_local_memory(
+    iree_hal_local_executable_t* executable,
+    iree_host_size_t local_memory_limit);
+
+// Populates |out_info| with the debug information available for the export
+// |ordinal| of |executable|. Fields without information are left empty.
+void iree_hal_local_executable_query_export_info(
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    iree_hal_local_executable_export_info_t* out_info);
+
 iree_status_t iree_hal_local_executable_issue_call(
     iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
     const iree_hal_executable_dispatch_state_v0_t* dispatch_state,
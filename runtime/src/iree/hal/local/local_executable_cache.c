@@ -9,11 +9,14 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "iree/hal/local/local_executable.h"
+
 typedef struct iree_hal_local_executable_cache_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
   iree_string_view_t identifier;
   iree_host_size_t worker_capacity;
+  iree_host_size_t local_memory_limit;
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
 } iree_hal_local_executable_cache_t;
@@ -29,8 +32,8 @@ static iree_hal_local_executable_cache_t* iree_hal_local_executable_cache_cast(
 
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
-    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
-    iree_allocator_t host_allocator,
+    iree_host_size_t local_memory_limit, iree_host_size_t loader_count,
+    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache) {
   IREE_ASSERT_ARGUMENT(!loader_count || loaders);
   IREE_ASSERT_ARGUMENT(out_executable_cache);
@@ -52,6 +55,7 @@ iree_status_t iree_hal_local_executable_cache_create(
         identifier, &executable_cache->identifier,
         (char*)executable_cache + total_size - identifier.size);
     executable_cache->worker_capacity = worker_capacity;
+    executable_cache->local_memory_limit = local_memory_limit;
 
     executable_cache->loader_count = loader_count;
     for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
@@ -96,12 +100,36 @@ static bool iree_hal_local_executable_cache_can_prepare_format(
   return false;
 }
 
+// Verifies that a newly loaded |executable| fits within the cache limits.
+static iree_status_t iree_hal_local_executable_cache_verify_executable(
+    iree_hal_local_executable_cache_t* executable_cache,
+    iree_hal_executable_t* executable) {
+  if (!executable_cache->local_memory_limit) return iree_ok_status();
+  iree_hal_local_executable_t* local_executable =
+      iree_hal_local_executable_cast(executable);
+  IREE_RETURN_IF_ERROR(
+      iree_hal_local_executable_ensure_loaded(local_executable));
+  return iree_hal_local_executable_verify_local_memory(
+      local_executable, executable_cache->local_memory_limit);
+}
+
 static iree_status_t iree_hal_local_executable_cache_prepare_executable(
     iree_hal_executable_cache_t* base_executable_cache,
     const iree_hal_executable_params_t* executable_params,
     iree_hal_executable_t** out_executable) {
   iree_hal_local_executable_cache_t* executable_cache =
       iree_hal_local_executable_cache_cast(base_executable_cache);
+
+  // When limits are specified we need the executable metadata immediately so
+  // there's no use deferring the load.
+  iree_hal_executable_params_t limited_params;
+  if (executable_cache->local_memory_limit) {
+    limited_params = *executable_params;
+    limited_params.caching_mode &=
+        ~IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_DEFERRED_LOADING;
+    executable_params = &limited_params;
+  }
+
   for (iree_host_size_t i = 0; i < executable_cache->loader_count; ++i) {
     if (!iree_hal_executable_loader_query_support(
             executable_cache->loaders[i], executable_params->caching_mode,
@@ -117,6 +145,12 @@ static iree_status_t iree_hal_local_executable_cache_prepare_executable(
         executable_cache->worker_capacity, out_executable);
     if (iree_status_is_ok(status)) {
       // Executable was successfully loaded.
+      status = iree_hal_local_executable_cache_verify_executable(
+          executable_cache, *out_executable);
+      if (!iree_status_is_ok(status)) {
+        iree_hal_executable_release(*out_executable);
+        *out_executable = NULL;
+      }
       return status;
     } else if (!iree_status_is_cancelled(status)) {
       // Error beyond just the try failing due to unsupported formats.
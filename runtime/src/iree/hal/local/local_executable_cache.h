@@ -23,10 +23,14 @@ extern "C" {
 // one device is the same JIT'ed executable in another, and in multi-tenant
 // situations we're likely to want that isolation _and_ sharing.
 
+// Creates a local executable cache that prepares executables with |loaders|.
+// If |local_memory_limit| is non-zero executables are fully loaded when
+// prepared and verified to not require more workgroup local memory than that;
+// deferred loading is disabled so that failures are reported immediately.
 iree_status_t iree_hal_local_executable_cache_create(
     iree_string_view_t identifier, iree_host_size_t worker_capacity,
-    iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
-    iree_allocator_t host_allocator,
+    iree_host_size_t local_memory_limit, iree_host_size_t loader_count,
+    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
     iree_hal_executable_cache_t** out_executable_cache);
 
 #ifdef __cplusplus
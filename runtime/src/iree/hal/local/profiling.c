@@ -0,0 +1,609 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// NOTE: must be first before _any_ system includes.
+#define _GNU_SOURCE
+
+#include "iree/hal/local/profiling.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+#include "iree/hal/local/local_executable.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_LINUX)
+#include <linux/perf_event.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define IREE_HAL_LOCAL_PROFILER_HAVE_PERF_EVENTS 1
+#else
+#define IREE_HAL_LOCAL_PROFILER_HAVE_PERF_EVENTS 0
+#endif  // IREE_PLATFORM_ANDROID || IREE_PLATFORM_LINUX
+
+// Bytes transferred from memory per last-level cache miss used to estimate
+// the memory traffic of a dispatch.
+#define IREE_HAL_LOCAL_PROFILER_CACHE_LINE_SIZE 64
+
+//===----------------------------------------------------------------------===//
+// Hardware counters
+//===----------------------------------------------------------------------===//
+
+#if IREE_HAL_LOCAL_PROFILER_HAVE_PERF_EVENTS
+
+static const uint64_t iree_hal_local_profiler_perf_configs[] = {
+    [IREE_HAL_LOCAL_PROFILER_COUNTER_CYCLES] = PERF_COUNT_HW_CPU_CYCLES,
+    [IREE_HAL_LOCAL_PROFILER_COUNTER_INSTRUCTIONS] = PERF_COUNT_HW_INSTRUCTIONS,
+    [IREE_HAL_LOCAL_PROFILER_COUNTER_CACHE_REFERENCES] =
+        PERF_COUNT_HW_CACHE_REFERENCES,
+    [IREE_HAL_LOCAL_PROFILER_COUNTER_CACHE_MISSES] = PERF_COUNT_HW_CACHE_MISSES,
+};
+
+static uint64_t iree_hal_local_profiler_thread_id(void) {
+  return (uint64_t)syscall(__NR_gettid);
+}
+
+// Opens a counter group measuring the calling thread in user mode.
+// Returns the group leader or -1 if the counters are unavailable (unsupported
+// hardware, restrictive perf_event_paranoid settings, etc).
+static int iree_hal_local_profiler_open_counters(
+    int fds[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT]) {
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) fds[i] = -1;
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    struct perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = PERF_TYPE_HARDWARE;
+    attr.config = iree_hal_local_profiler_perf_configs[i];
+    attr.read_format = PERF_FORMAT_GROUP;
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+    fds[i] = (int)syscall(__NR_perf_event_open, &attr, /*pid=*/0, /*cpu=*/-1,
+                          /*group_fd=*/i == 0 ? -1 : fds[0], /*flags=*/0);
+    if (fds[i] < 0) {
+      for (int j = 0; j < i; ++j) close(fds[j]);
+      for (int j = 0; j < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++j) {
+        fds[j] = -1;
+      }
+      return -1;
+    }
+  }
+  return fds[0];
+}
+
+static void iree_hal_local_profiler_close_counters(
+    int fds[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT]) {
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    if (fds[i] >= 0) close(fds[i]);
+    fds[i] = -1;
+  }
+}
+
+static bool iree_hal_local_profiler_read_counters(
+    int leader_fd, uint64_t counters[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT]) {
+  struct {
+    uint64_t count;
+    uint64_t values[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+  } group;
+  if (read(leader_fd, &group, sizeof(group)) != (ssize_t)sizeof(group) ||
+      group.count != IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT) {
+    return false;
+  }
+  memcpy(counters, group.values, sizeof(group.values));
+  return true;
+}
+
+#else
+
+static uint64_t iree_hal_local_profiler_thread_id(void) { return 0; }
+
+static int iree_hal_local_profiler_open_counters(
+    int fds[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT]) {
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) fds[i] = -1;
+  return -1;
+}
+
+static void iree_hal_local_profiler_close_counters(
+    int fds[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT]) {}
+
+static bool iree_hal_local_profiler_read_counters(
+    int leader_fd, uint64_t counters[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT]) {
+  return false;
+}
+
+#endif  // IREE_HAL_LOCAL_PROFILER_HAVE_PERF_EVENTS
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_profiler_t
+//===----------------------------------------------------------------------===//
+
+// Aggregated measurements of a single executable export.
+typedef struct iree_hal_local_profiler_entry_t {
+  // Retained so that the identity stays unique and the debug information
+  // remains valid until the report is written.
+  iree_hal_local_executable_t* executable;
+  iree_host_size_t ordinal;
+  // Number of dispatches as counted by their first workgroup.
+  uint64_t dispatch_count;
+  uint64_t workgroup_count;
+  // Sum, minimum and maximum of workgroup execution times across all workers.
+  iree_duration_t total_ns;
+  iree_duration_t min_ns;
+  iree_duration_t max_ns;
+  // Number of workgroups with valid counter samples and their counter sums.
+  uint64_t counted_workgroup_count;
+  uint64_t counters[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+} iree_hal_local_profiler_entry_t;
+
+// Per-worker measurement state. The mutex is only contended when multiple
+// threads share a worker ID (such as multiple threads issuing inline
+// dispatches on a synchronous device).
+typedef struct iree_hal_local_profiler_slot_t {
+  iree_slim_mutex_t mutex;
+  // Thread the counters were opened on as they only measure that thread.
+  uint64_t thread_id;
+  bool counters_opened;
+  int counter_fds[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+  // Entries for each export called on this worker. Merged when reporting.
+  iree_host_size_t entry_count;
+  iree_host_size_t entry_capacity;
+  iree_hal_local_profiler_entry_t* entries;
+  // Index of the most recently used entry as workgroups of the same dispatch
+  // are usually issued back to back.
+  iree_host_size_t last_entry_index;
+} iree_hal_local_profiler_slot_t;
+
+struct iree_hal_local_profiler_t {
+  iree_allocator_t host_allocator;
+  char device_identifier[64];
+  char* file_path;
+  iree_time_t begin_time_ns;
+  // Number of samples dropped because entry storage could not be allocated.
+  iree_atomic_int64_t dropped_count;
+  iree_hal_local_profiler_slot_t slots[IREE_HAL_LOCAL_PROFILER_MAX_WORKERS];
+};
+
+// The active profiler, if any. Executables are shared across devices and have
+// no reference to the device they are dispatched on so the session is global.
+static iree_atomic_intptr_t iree_hal_local_profiler_active_ = 0;
+// Number of workgroups currently using the active profiler.
+static iree_atomic_int32_t iree_hal_local_profiler_users_ = 0;
+
+iree_hal_local_profiler_t* iree_hal_local_profiler_acquire(void) {
+  if (IREE_LIKELY(!iree_atomic_load(&iree_hal_local_profiler_active_,
+                                    iree_memory_order_relaxed))) {
+    return NULL;
+  }
+  // Register as a user before checking again so that ending the session
+  // observes us if we observe the profiler.
+  iree_atomic_fetch_add(&iree_hal_local_profiler_users_, 1,
+                        iree_memory_order_seq_cst);
+  iree_hal_local_profiler_t* profiler =
+      (iree_hal_local_profiler_t*)iree_atomic_load(
+          &iree_hal_local_profiler_active_, iree_memory_order_seq_cst);
+  if (!profiler) {
+    iree_atomic_fetch_sub(&iree_hal_local_profiler_users_, 1,
+                          iree_memory_order_release);
+  }
+  return profiler;
+}
+
+void iree_hal_local_profiler_release(iree_hal_local_profiler_t* profiler) {
+  iree_atomic_fetch_sub(&iree_hal_local_profiler_users_, 1,
+                        iree_memory_order_release);
+}
+
+iree_status_t iree_hal_local_profiler_begin(
+    iree_string_view_t device_identifier,
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_local_profiler_t** out_profiler) {
+  IREE_ASSERT_ARGUMENT(options);
+  IREE_ASSERT_ARGUMENT(out_profiler);
+  *out_profiler = NULL;
+  if (!iree_all_bits_set(options->mode,
+                         IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS)) {
+    return iree_ok_status();
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_host_size_t file_path_length =
+      options->file_path ? strlen(options->file_path) : 0;
+  iree_hal_local_profiler_t* profiler = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator,
+                                sizeof(*profiler) + file_path_length + 1,
+                                (void**)&profiler));
+  memset(profiler, 0, sizeof(*profiler));
+  profiler->host_allocator = host_allocator;
+  iree_string_view_to_cstring(device_identifier, profiler->device_identifier,
+                              sizeof(profiler->device_identifier));
+  profiler->file_path = (char*)profiler + sizeof(*profiler);
+  if (file_path_length) {
+    memcpy(profiler->file_path, options->file_path, file_path_length);
+  }
+  profiler->file_path[file_path_length] = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(profiler->slots); ++i) {
+    iree_hal_local_profiler_slot_t* slot = &profiler->slots[i];
+    iree_slim_mutex_initialize(&slot->mutex);
+    for (int j = 0; j < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++j) {
+      slot->counter_fds[j] = -1;
+    }
+  }
+  profiler->begin_time_ns = iree_time_now();
+
+  intptr_t expected = 0;
+  if (!iree_atomic_compare_exchange_strong(
+          &iree_hal_local_profiler_active_, &expected, (intptr_t)profiler,
+          iree_memory_order_seq_cst, iree_memory_order_seq_cst)) {
+    iree_allocator_free(host_allocator, profiler);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "another local device dispatch profiling session "
+                            "is already active");
+  }
+
+  *out_profiler = profiler;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_local_profiler_free(iree_hal_local_profiler_t* profiler) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(profiler->slots); ++i) {
+    iree_hal_local_profiler_slot_t* slot = &profiler->slots[i];
+    iree_hal_local_profiler_close_counters(slot->counter_fds);
+    for (iree_host_size_t j = 0; j < slot->entry_count; ++j) {
+      iree_hal_executable_release(
+          (iree_hal_executable_t*)slot->entries[j].executable);
+    }
+    iree_allocator_free(profiler->host_allocator, slot->entries);
+    iree_slim_mutex_deinitialize(&slot->mutex);
+  }
+  iree_allocator_free(profiler->host_allocator, profiler);
+}
+
+void iree_hal_local_profiler_call_begin(iree_hal_local_profiler_t* profiler,
+                                        uint32_t worker_id,
+                                        iree_hal_local_profiler_call_t* call) {
+  iree_hal_local_profiler_slot_t* slot =
+      &profiler->slots[worker_id % IREE_ARRAYSIZE(profiler->slots)];
+  iree_slim_mutex_lock(&slot->mutex);
+  call->slot = slot;
+
+  // Counters measure the thread that opened them so reopen them if the worker
+  // moved threads.
+  const uint64_t thread_id = iree_hal_local_profiler_thread_id();
+  if (!slot->counters_opened || slot->thread_id != thread_id) {
+    iree_hal_local_profiler_close_counters(slot->counter_fds);
+    iree_hal_local_profiler_open_counters(slot->counter_fds);
+    slot->thread_id = thread_id;
+    slot->counters_opened = true;
+  }
+  call->has_counters =
+      slot->counter_fds[0] >= 0 &&
+      iree_hal_local_profiler_read_counters(slot->counter_fds[0],
+                                            call->counters);
+
+  // Sampled last so that reading the counters is not included.
+  call->start_time_ns = iree_time_now();
+}
+
+static iree_hal_local_profiler_entry_t* iree_hal_local_profiler_slot_lookup(
+    iree_hal_local_profiler_t* profiler, iree_hal_local_profiler_slot_t* slot,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal) {
+  if (slot->last_entry_index < slot->entry_count) {
+    iree_hal_local_profiler_entry_t* entry =
+        &slot->entries[slot->last_entry_index];
+    if (entry->executable == executable && entry->ordinal == ordinal) {
+      return entry;
+    }
+  }
+  for (iree_host_size_t i = 0; i < slot->entry_count; ++i) {
+    iree_hal_local_profiler_entry_t* entry = &slot->entries[i];
+    if (entry->executable == executable && entry->ordinal == ordinal) {
+      slot->last_entry_index = i;
+      return entry;
+    }
+  }
+
+  if (slot->entry_count == slot->entry_capacity) {
+    iree_host_size_t new_capacity = iree_max(16, slot->entry_capacity * 2);
+    iree_status_t status = iree_allocator_realloc(
+        profiler->host_allocator, new_capacity * sizeof(*slot->entries),
+        (void**)&slot->entries);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      return NULL;
+    }
+    slot->entry_capacity = new_capacity;
+  }
+  iree_hal_local_profiler_entry_t* entry = &slot->entries[slot->entry_count];
+  memset(entry, 0, sizeof(*entry));
+  entry->executable = executable;
+  iree_hal_executable_retain((iree_hal_executable_t*)executable);
+  entry->ordinal = ordinal;
+  entry->min_ns = INT64_MAX;
+  slot->last_entry_index = slot->entry_count++;
+  return entry;
+}
+
+void iree_hal_local_profiler_call_end(
+    iree_hal_local_profiler_t* profiler, iree_hal_local_profiler_call_t* call,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state) {
+  const iree_time_t end_time_ns = iree_time_now();
+  iree_hal_local_profiler_slot_t* slot = call->slot;
+  uint64_t counters[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+  const bool has_counters =
+      call->has_counters &&
+      iree_hal_local_profiler_read_counters(slot->counter_fds[0], counters);
+
+  iree_hal_local_profiler_entry_t* entry =
+      iree_hal_local_profiler_slot_lookup(profiler, slot, executable, ordinal);
+  if (entry) {
+    if (workgroup_state->workgroup_id_x == 0 &&
+        workgroup_state->workgroup_id_y == 0 &&
+        workgroup_state->workgroup_id_z == 0) {
+      ++entry->dispatch_count;
+    }
+    ++entry->workgroup_count;
+    const iree_duration_t duration_ns = end_time_ns - call->start_time_ns;
+    entry->total_ns += duration_ns;
+    entry->min_ns = iree_min(entry->min_ns, duration_ns);
+    entry->max_ns = iree_max(entry->max_ns, duration_ns);
+    if (has_counters) {
+      ++entry->counted_workgroup_count;
+      for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+        entry->counters[i] += counters[i] - call->counters[i];
+      }
+    }
+  } else {
+    iree_atomic_fetch_add(&profiler->dropped_count, 1,
+                          iree_memory_order_relaxed);
+  }
+
+  iree_slim_mutex_unlock(&slot->mutex);
+}
+
+//===----------------------------------------------------------------------===//
+// Reporting
+//===----------------------------------------------------------------------===//
+
+static void iree_hal_local_profiler_merge_entry(
+    const iree_hal_local_profiler_entry_t* source,
+    iree_hal_local_profiler_entry_t* target) {
+  target->dispatch_count += source->dispatch_count;
+  target->workgroup_count += source->workgroup_count;
+  target->total_ns += source->total_ns;
+  target->min_ns = iree_min(target->min_ns, source->min_ns);
+  target->max_ns = iree_max(target->max_ns, source->max_ns);
+  target->counted_workgroup_count += source->counted_workgroup_count;
+  for (int i = 0; i < IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT; ++i) {
+    target->counters[i] += source->counters[i];
+  }
+}
+
+static int iree_hal_local_profiler_compare_entries(const void* lhs,
+                                                   const void* rhs) {
+  const iree_hal_local_profiler_entry_t* a =
+      (const iree_hal_local_profiler_entry_t*)lhs;
+  const iree_hal_local_profiler_entry_t* b =
+      (const iree_hal_local_profiler_entry_t*)rhs;
+  // Most expensive exports first.
+  return (a->total_ns < b->total_ns) - (a->total_ns > b->total_ns);
+}
+
+// Merges the entries from all slots into a new array sorted by total time.
+// The merged entries do not hold references to their executables.
+static iree_status_t iree_hal_local_profiler_merge_entries(
+    iree_hal_local_profiler_t* profiler,
+    iree_hal_local_profiler_entry_t** out_entries,
+    iree_host_size_t* out_entry_count) {
+  *out_entries = NULL;
+  *out_entry_count = 0;
+
+  iree_host_size_t max_entry_count = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(profiler->slots); ++i) {
+    iree_slim_mutex_lock(&profiler->slots[i].mutex);
+    max_entry_count += profiler->slots[i].entry_count;
+    iree_slim_mutex_unlock(&profiler->slots[i].mutex);
+  }
+  if (!max_entry_count) return iree_ok_status();
+
+  // NOTE: entries may be added concurrently while flushing; those beyond the
+  // count captured above are included in the next report.
+  iree_hal_local_profiler_entry_t* entries = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(profiler->host_allocator,
+                                             max_entry_count * sizeof(*entries),
+                                             (void**)&entries));
+  iree_host_size_t entry_count = 0;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(profiler->slots); ++i) {
+    iree_hal_local_profiler_slot_t* slot = &profiler->slots[i];
+    iree_slim_mutex_lock(&slot->mutex);
+    for (iree_host_size_t j = 0; j < slot->entry_count; ++j) {
+      const iree_hal_local_profiler_entry_t* source = &slot->entries[j];
+      iree_hal_local_profiler_entry_t* target = NULL;
+      for (iree_host_size_t k = 0; k < entry_count; ++k) {
+        if (entries[k].executable == source->executable &&
+            entries[k].ordinal == source->ordinal) {
+          target = &entries[k];
+          break;
+        }
+      }
+      if (target) {
+        iree_hal_local_profiler_merge_entry(source, target);
+      } else if (entry_count < max_entry_count) {
+        entries[entry_count++] = *source;
+      }
+    }
+    iree_slim_mutex_unlock(&slot->mutex);
+  }
+
+  qsort(entries, entry_count, sizeof(*entries),
+        iree_hal_local_profiler_compare_entries);
+  *out_entries = entries;
+  *out_entry_count = entry_count;
+  return iree_ok_status();
+}
+
+static void iree_hal_local_profiler_fprint_json_string(
+    FILE* file, iree_string_view_t value) {
+  fputc('"', file);
+  for (iree_host_size_t i = 0; i < value.size; ++i) {
+    char c = value.data[i];
+    if (c == '"' || c == '\\') {
+      fputc('\\', file);
+      fputc(c, file);
+    } else if ((unsigned char)c < 0x20) {
+      fprintf(file, "\\u%04x", (unsigned char)c);
+    } else {
+      fputc(c, file);
+    }
+  }
+  fputc('"', file);
+}
+
+static void iree_hal_local_profiler_fprint_entry(
+    FILE* file, const iree_hal_local_profiler_entry_t* entry) {
+  iree_hal_local_executable_export_info_t info;
+  iree_hal_local_executable_query_export_info(entry->executable,
+                                              entry->ordinal, &info);
+  fprintf(file, "    {\"export\": ");
+  if (iree_string_view_is_empty(info.name)) {
+    fprintf(file, "\"%p:%" PRIhsz "\"", (void*)entry->executable,
+            entry->ordinal);
+  } else {
+    iree_hal_local_profiler_fprint_json_string(file, info.name);
+  }
+  fprintf(file, ", \"ordinal\": %" PRIhsz, entry->ordinal);
+  if (!iree_string_view_is_empty(info.source_file)) {
+    fprintf(file, ", \"source\": ");
+    iree_hal_local_profiler_fprint_json_string(file, info.source_file);
+    fprintf(file, ", \"line\": %u", info.source_line);
+  }
+  if (!iree_string_view_is_empty(info.tag)) {
+    fprintf(file, ", \"tag\": ");
+    iree_hal_local_profiler_fprint_json_string(file, info.tag);
+  }
+  fprintf(file,
+          ",\n     \"dispatches\": %" PRIu64 ", \"workgroups\": %" PRIu64
+          ", \"workgroup_ns\": {\"total\": %" PRId64 ", \"min\": %" PRId64
+          ", \"max\": %" PRId64 "}",
+          entry->dispatch_count, entry->workgroup_count, entry->total_ns,
+          entry->workgroup_count ? entry->min_ns : 0, entry->max_ns);
+  if (entry->counted_workgroup_count) {
+    const uint64_t cycles =
+        entry->counters[IREE_HAL_LOCAL_PROFILER_COUNTER_CYCLES];
+    const uint64_t instructions =
+        entry->counters[IREE_HAL_LOCAL_PROFILER_COUNTER_INSTRUCTIONS];
+    const uint64_t cache_misses =
+        entry->counters[IREE_HAL_LOCAL_PROFILER_COUNTER_CACHE_MISSES];
+    const uint64_t memory_bytes =
+        cache_misses * IREE_HAL_LOCAL_PROFILER_CACHE_LINE_SIZE;
+    fprintf(file,
+            ",\n     \"counters\": {\"workgroups\": %" PRIu64
+            ", \"cycles\": %" PRIu64 ", \"instructions\": %" PRIu64
+            ", \"cache_references\": %" PRIu64 ", \"cache_misses\": %" PRIu64
+            "}",
+            entry->counted_workgroup_count, cycles, instructions,
+            entry->counters[IREE_HAL_LOCAL_PROFILER_COUNTER_CACHE_REFERENCES],
+            cache_misses);
+    // Roofline coordinates: operational intensity (instructions per byte of
+    // estimated memory traffic) and the achieved throughput per worker.
+    const double seconds = entry->total_ns ? entry->total_ns / 1e9 : 0.0;
+    fprintf(file,
+            ",\n     \"roofline\": {\"instructions_per_cycle\": %.3f"
+            ", \"estimated_memory_bytes\": %" PRIu64
+            ", \"instructions_per_byte\": %.3f"
+            ", \"giga_instructions_per_second\": %.3f"
+            ", \"estimated_gigabytes_per_second\": %.3f}",
+            cycles ? (double)instructions / cycles : 0.0, memory_bytes,
+            memory_bytes ? (double)instructions / memory_bytes : 0.0,
+            seconds > 0.0 ? instructions / seconds / 1e9 : 0.0,
+            seconds > 0.0 ? memory_bytes / seconds / 1e9 : 0.0);
+  }
+  fprintf(file, "}");
+}
+
+static iree_status_t iree_hal_local_profiler_write_report(
+    iree_hal_local_profiler_t* profiler) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_local_profiler_entry_t* entries = NULL;
+  iree_host_size_t entry_count = 0;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_hal_local_profiler_merge_entries(profiler, &entries, &entry_count));
+
+  FILE* file = stderr;
+  if (profiler->file_path[0]) {
+    file = fopen(profiler->file_path, "w");
+    if (!file) {
+      iree_allocator_free(profiler->host_allocator, entries);
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                              "failed to open profile report file '%s'",
+                              profiler->file_path);
+    }
+  }
+
+  fprintf(file, "{\n  \"device\": ");
+  iree_hal_local_profiler_fprint_json_string(
+      file, iree_make_cstring_view(profiler->device_identifier));
+  fprintf(file,
+          ",\n  \"duration_ns\": %" PRId64 ",\n  \"dropped_samples\": %" PRId64
+          ",\n  \"cache_line_size\": %d,\n  \"exports\": [",
+          iree_time_now() - profiler->begin_time_ns,
+          iree_atomic_load(&profiler->dropped_count,
+                           iree_memory_order_relaxed),
+          IREE_HAL_LOCAL_PROFILER_CACHE_LINE_SIZE);
+  for (iree_host_size_t i = 0; i < entry_count; ++i) {
+    fprintf(file, i ? ",\n" : "\n");
+    iree_hal_local_profiler_fprint_entry(file, &entries[i]);
+  }
+  fprintf(file, "\n  ]\n}\n");
+
+  iree_status_t status = iree_ok_status();
+  if (file != stderr) {
+    if (ferror(file)) {
+      status = iree_make_status(IREE_STATUS_DATA_LOSS,
+                                "failed to write profile report file '%s'",
+                                profiler->file_path);
+    }
+    fclose(file);
+  } else {
+    fflush(file);
+  }
+  iree_allocator_free(profiler->host_allocator, entries);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_hal_local_profiler_flush(
+    iree_hal_local_profiler_t* profiler) {
+  if (!profiler) return iree_ok_status();
+  return iree_hal_local_profiler_write_report(profiler);
+}
+
+iree_status_t iree_hal_local_profiler_end(iree_hal_local_profiler_t* profiler) {
+  if (!profiler) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Stop new workgroups from being measured and wait for the ones in flight.
+  iree_atomic_store(&iree_hal_local_profiler_active_, 0,
+                    iree_memory_order_seq_cst);
+  while (iree_atomic_load(&iree_hal_local_profiler_users_,
+                          iree_memory_order_acquire) != 0) {
+    iree_thread_yield();
+  }
+
+  iree_status_t status = iree_hal_local_profiler_write_report(profiler);
+  iree_hal_local_profiler_free(profiler);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
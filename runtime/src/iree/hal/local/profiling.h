@@ -0,0 +1,103 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_LOCAL_PROFILING_H_
+#define IREE_HAL_LOCAL_PROFILING_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/local/executable_library.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+typedef struct iree_hal_local_executable_t iree_hal_local_executable_t;
+
+//===----------------------------------------------------------------------===//
+// iree_hal_local_profiler_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of workers tracked independently. Workers with larger IDs
+// share slots and serialize their measurements.
+#define IREE_HAL_LOCAL_PROFILER_MAX_WORKERS 256
+
+// Hardware counters sampled around each workgroup when available.
+typedef enum iree_hal_local_profiler_counter_e {
+  IREE_HAL_LOCAL_PROFILER_COUNTER_CYCLES = 0,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_INSTRUCTIONS,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_CACHE_REFERENCES,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_CACHE_MISSES,
+  IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT,
+} iree_hal_local_profiler_counter_t;
+
+// A dispatch profiling session shared by the local HAL drivers.
+//
+// While a session is active every workgroup issued through
+// iree_hal_local_executable_issue_call is timed and, on platforms supporting
+// perf_event_open, the per-thread cycle, instruction and cache counters are
+// sampled around it. Measurements are aggregated per executable export and
+// joined with the export names and source locations embedded in the executable
+// to produce a JSON roofline report: cache misses approximate the bytes moved
+// from memory and the instruction count approximates the compute performed.
+//
+// Sessions are process-wide as executables are shared across devices: only
+// one session may be active at a time.
+typedef struct iree_hal_local_profiler_t iree_hal_local_profiler_t;
+
+// Begins a profiling session if |options| requests
+// IREE_HAL_DEVICE_PROFILING_MODE_DISPATCH_COUNTERS and otherwise returns NULL.
+// The report is written to |options|.file_path or stderr if not specified.
+iree_status_t iree_hal_local_profiler_begin(
+    iree_string_view_t device_identifier,
+    const iree_hal_device_profiling_options_t* options,
+    iree_allocator_t host_allocator, iree_hal_local_profiler_t** out_profiler);
+
+// Writes the report of all measurements captured so far.
+iree_status_t iree_hal_local_profiler_flush(
+    iree_hal_local_profiler_t* profiler);
+
+// Ends the profiling session, writes the final report, and frees |profiler|.
+// Workgroups executing concurrently are allowed to complete before returning.
+iree_status_t iree_hal_local_profiler_end(iree_hal_local_profiler_t* profiler);
+
+//===----------------------------------------------------------------------===//
+// Executable instrumentation
+//===----------------------------------------------------------------------===//
+
+// Measurement of a single in-flight workgroup.
+typedef struct iree_hal_local_profiler_call_t {
+  struct iree_hal_local_profiler_slot_t* slot;
+  iree_time_t start_time_ns;
+  bool has_counters;
+  uint64_t counters[IREE_HAL_LOCAL_PROFILER_COUNTER_COUNT];
+} iree_hal_local_profiler_call_t;
+
+// Returns the active profiler, if any, and prevents it from ending until
+// released with iree_hal_local_profiler_release. Cheap when no session is
+// active.
+iree_hal_local_profiler_t* iree_hal_local_profiler_acquire(void);
+
+// Releases a profiler acquired with iree_hal_local_profiler_acquire.
+void iree_hal_local_profiler_release(iree_hal_local_profiler_t* profiler);
+
+// Starts measuring a workgroup issued on |worker_id|.
+void iree_hal_local_profiler_call_begin(iree_hal_local_profiler_t* profiler,
+                                        uint32_t worker_id,
+                                        iree_hal_local_profiler_call_t* call);
+
+// Stops measuring |call| and attributes it to the export |ordinal| of
+// |executable|.
+void iree_hal_local_profiler_call_end(
+    iree_hal_local_profiler_t* profiler, iree_hal_local_profiler_call_t* call,
+    iree_hal_local_executable_t* executable, iree_host_size_t ordinal,
+    const iree_hal_executable_workgroup_state_v0_t* workgroup_state);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_LOCAL_PROFILING_H_
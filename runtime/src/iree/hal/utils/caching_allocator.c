@@ -6,11 +6,78 @@
 
 #include "iree/hal/utils/caching_allocator.h"
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/math.h"
 #include "iree/base/internal/synchronization.h"
 
 // Default capacity of a pool free list when not specified by the user.
 #define IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY 64
 
+// Number of per-thread magazines in pools with magazines enabled.
+// Threads are assigned magazines round-robin on first use and once there are
+// more threads than magazines they will share.
+#if !defined(IREE_HAL_CACHING_ALLOCATOR_MAGAZINE_COUNT)
+#define IREE_HAL_CACHING_ALLOCATOR_MAGAZINE_COUNT 8
+#endif  // !IREE_HAL_CACHING_ALLOCATOR_MAGAZINE_COUNT
+
+// log2 of the smallest size class; all smaller sizes share the first class.
+#define IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_SHIFT 8
+
+// Total number of size classes: one power-of-two and one half-step class per
+// power of two from the smallest class up to 2^64. The last class also holds
+// all sizes that are too large to round.
+#define IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT \
+  (2 * (64 - IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_SHIFT))
+
+// Sentinel entry index used to terminate free lists.
+#define IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE UINT32_MAX
+
+// NOTE: threading support is optional.
+#if IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+#define iree_thread_local static
+#elif defined(__STDC_VERSION__) && (__STDC_VERSION__ >= 201102L) && \
+    !__STDC_NO_THREADS__
+#define iree_thread_local _Thread_local
+#elif defined(IREE_COMPILER_MSVC)
+#define iree_thread_local __declspec(thread)
+#else
+#define iree_thread_local
+#endif  // IREE_SYNCHRONIZATION_DISABLE_UNSAFE
+
+//===----------------------------------------------------------------------===//
+// Size classes
+//===----------------------------------------------------------------------===//
+
+// Returns the index of the smallest size class that can hold |size| bytes.
+// Even classes are powers of two (256, 512, ...) and odd classes the half-steps
+// between them (384, 768, ...) such that at most 1/3 of a rounded allocation is
+// wasted. Sizes too large for any class map to the last class.
+static iree_host_size_t iree_hal_caching_allocator_size_class_index(
+    iree_device_size_t size) {
+  if (size <= (1ull << IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_SHIFT)) {
+    return 0;
+  }
+  // |size| is in (2^(k-1), 2^k] and the half-step between is 3 * 2^(k-2).
+  const int k = 64 - iree_math_count_leading_zeros_u64(size - 1);
+  const iree_host_size_t index =
+      size <= (3ull << (k - 2))
+          ? 2 * (k - 1 - IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_SHIFT) + 1
+          : 2 * (k - IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_SHIFT);
+  return iree_min(index, IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT - 1);
+}
+
+// Returns |size| rounded up to its size class or |size| if it is too large.
+static iree_device_size_t iree_hal_caching_allocator_size_class_round(
+    iree_device_size_t size) {
+  const iree_host_size_t index =
+      iree_hal_caching_allocator_size_class_index(size);
+  const int shift =
+      IREE_HAL_CACHING_ALLOCATOR_MIN_SIZE_CLASS_SHIFT + (int)(index / 2);
+  const iree_device_size_t class_size =
+      (index & 1) ? (3ull << (shift - 1)) : (1ull << shift);
+  return iree_max(class_size, size);
+}
+
 //===----------------------------------------------------------------------===//
 // iree_hal_caching_allocator_pool_t
 //===----------------------------------------------------------------------===//
@@ -28,8 +95,39 @@ void iree_hal_caching_allocator_pool_params_initialize(
   out_params->max_allocation_capacity = IREE_DEVICE_SIZE_MAX;
   out_params->max_free_allocation_count =
       IREE_HAL_CACHING_ALLOCATOR_DEFAULT_FREE_LIST_CAPACITY;
+  out_params->size_class_mode =
+      IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MODE_EXACT;
+  out_params->magazine_capacity = 0;
 }
 
+// A free buffer retained by a pool. Each entry with a buffer is linked into
+// both the list of its size class and the pool-wide recency list. Entries
+// without a buffer are linked into the pool empty list via |class_next|.
+typedef struct iree_hal_caching_allocator_entry_t {
+  iree_hal_buffer_t* buffer;
+  // Neighbors in the size class list ordered from most to least recent.
+  uint32_t class_prev;
+  uint32_t class_next;
+  // Neighbors in the pool recency list ordered from most to least recent.
+  uint32_t lru_prev;
+  uint32_t lru_next;
+} iree_hal_caching_allocator_entry_t;
+
+// A small cache of free buffers preferred by a subset of threads.
+// Magazines are checked before the shared pool free lists and have their own
+// mutex so that threads using different magazines do not contend.
+typedef struct iree_hal_caching_allocator_magazine_t {
+  iree_slim_mutex_t mutex;
+  // Number of valid buffers in |buffers|.
+  iree_host_size_t count;
+  // Total size, in bytes, of all buffers in |buffers|.
+  iree_device_size_t free_allocated_size;
+  // Number of acquisitions serviced from the magazine.
+  IREE_STATISTICS(uint64_t reuse_count;)
+  // Free buffers sorted by ascending recency.
+  iree_hal_buffer_t* buffers[IREE_HAL_CACHING_ALLOCATOR_MAX_MAGAZINE_CAPACITY];
+} iree_hal_caching_allocator_magazine_t;
+
 // Pool of arbitrarily-sized device allocations for a particular heap.
 // This maintains a free list of blocks available for use but does not track
 // outstanding allocations.
@@ -60,16 +158,39 @@ typedef iree_alignas(
   // observe imported/exported buffers.
   iree_device_size_t total_allocated_size;
 
-  // Total size, in bytes, of all free buffers currently in this pool.
+  // Total size, in bytes, of all free buffers currently in the shared free
+  // lists of this pool. Buffers held in magazines are tracked by each magazine.
   iree_device_size_t free_allocated_size;
 
-  // Flat MRU list of available buffers with max_free_allocation_count slots.
-  // Sorted by ascending recency (the higher the index the more recent).
-  // If we really cared about optimizing the interior removal then we'd want
-  // a linked/skip list or some bucketing but that's really for the higher
-  // level allocators to do.
+  // Number of entries holding free buffers out of max_free_allocation_count.
   iree_host_size_t free_count;
-  iree_hal_buffer_t* free_buffers[];
+
+  // Most and least recently released entries in the pool recency list.
+  uint32_t lru_head;
+  uint32_t lru_tail;
+
+  // First entry in the list of entries without a buffer.
+  uint32_t empty_head;
+
+  // Most recently released entry of each size class. Lookups only walk the
+  // list of the requested size class and in the common case of reusing a
+  // buffer of the same size class the head entry is taken.
+  uint32_t class_heads[IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_COUNT];
+
+  // Per-thread caches in front of the shared free lists.
+  // Only used if params.magazine_capacity is non-zero.
+  iree_hal_caching_allocator_magazine_t
+      magazines[IREE_HAL_CACHING_ALLOCATOR_MAGAZINE_COUNT];
+
+  // Pool usage counters reported via iree_hal_allocator_query_statistics.
+  IREE_STATISTICS(struct {
+    iree_device_size_t peak_allocated_size;
+    uint64_t acquire_count;
+    uint64_t reuse_count;
+  } statistics;)
+
+  // Storage for max_free_allocation_count free list entries.
+  iree_hal_caching_allocator_entry_t entries[];
 } iree_hal_caching_allocator_pool_t;
 
 static void iree_hal_caching_allocator_pool_trim(
@@ -89,6 +210,29 @@ static void iree_hal_caching_allocator_pool_initialize(
   out_pool->total_allocated_size = 0;
   out_pool->free_allocated_size = 0;
   out_pool->free_count = 0;
+  out_pool->lru_head = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  out_pool->lru_tail = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(out_pool->class_heads); ++i) {
+    out_pool->class_heads[i] = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  }
+
+  // All entries start in the empty list.
+  out_pool->empty_head = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  for (iree_host_size_t i = params.max_free_allocation_count; i > 0; --i) {
+    iree_hal_caching_allocator_entry_t* entry = &out_pool->entries[i - 1];
+    memset(entry, 0, sizeof(*entry));
+    entry->class_next = out_pool->empty_head;
+    out_pool->empty_head = (uint32_t)(i - 1);
+  }
+
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(out_pool->magazines); ++i) {
+    iree_hal_caching_allocator_magazine_t* magazine = &out_pool->magazines[i];
+    memset(magazine, 0, sizeof(*magazine));
+    iree_slim_mutex_initialize(&magazine->mutex);
+  }
+
+  IREE_STATISTICS(
+      memset(&out_pool->statistics, 0, sizeof(out_pool->statistics)));
 
   IREE_TRACE_SET_PLOT_TYPE(IREE_HAL_CACHING_ALLOCATOR_ID,
                            IREE_TRACING_PLOT_TYPE_MEMORY, /*step=*/true,
@@ -114,26 +258,64 @@ static void iree_hal_caching_allocator_pool_deinitialize(
   IREE_ASSERT_EQ(pool->free_count, 0,
                  "must have released all allocations prior to deinit");
 
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(pool->magazines); ++i) {
+    iree_slim_mutex_deinitialize(&pool->magazines[i].mutex);
+  }
   iree_slim_mutex_deinitialize(&pool->mutex);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Returns true if |buffer| can be used to service a request for a buffer with
+// |params| and |allocation_size|.
+static bool iree_hal_caching_allocator_buffer_is_compatible(
+    iree_hal_buffer_t* buffer, const iree_hal_buffer_params_t* params,
+    iree_device_size_t allocation_size) {
+  // NOTE: we are not currently checking alignment as we don't really have it.
+  // We assume programs will use consistent alignments for a particular heap
+  // (as the heap has a min alignment).
+  return iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                           params->type) &&
+         iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
+                           params->usage) &&
+         iree_hal_buffer_allocation_size(buffer) == allocation_size;
+}
+
 // Pushes |buffer| on to the pool free list as the most recently used.
-// The buffer will be retained in the list.
+// Ownership of the retained buffer is transferred to the pool.
 //
 // Must be called with the pool mutex held.
 static void iree_hal_caching_allocator_pool_push_buffer(
     iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* buffer) {
-  // Retain the buffer; the caller must release it to complete the ownership
-  // transfer.
-  iree_hal_buffer_retain(buffer);
-
   IREE_ASSERT_LT(pool->free_count, pool->params.max_free_allocation_count);
 
-  // Add to the end of the list (the most recent).
-  iree_host_size_t i = pool->free_count++;
-  pool->free_buffers[i] = buffer;
+  // Take an empty entry.
+  const uint32_t i = pool->empty_head;
+  iree_hal_caching_allocator_entry_t* entry = &pool->entries[i];
+  pool->empty_head = entry->class_next;
+  ++pool->free_count;
+  entry->buffer = buffer;
+
+  // Add to the front of the size class list (the most recent).
+  const iree_host_size_t class_index =
+      iree_hal_caching_allocator_size_class_index(
+          iree_hal_buffer_allocation_size(buffer));
+  entry->class_prev = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  entry->class_next = pool->class_heads[class_index];
+  if (entry->class_next != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->class_next].class_prev = i;
+  }
+  pool->class_heads[class_index] = i;
+
+  // Add to the front of the pool recency list (the most recent).
+  entry->lru_prev = IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+  entry->lru_next = pool->lru_head;
+  if (entry->lru_next != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->lru_next].lru_prev = i;
+  } else {
+    pool->lru_tail = i;
+  }
+  pool->lru_head = i;
 
   // Track that we're now retaining unused memory.
   pool->free_allocated_size += buffer->allocation_size;
@@ -141,50 +323,171 @@ static void iree_hal_caching_allocator_pool_push_buffer(
                             pool->free_allocated_size);
 }
 
-// Takes the buffer in the |pool| free list at index |i| and returns ownership.
-// If the list is large this is bad but in most cases it's just a few dozen
-// elements.
+// Takes the buffer in the |pool| free list entry |i| and returns ownership.
 //
 // Must be called with the pool mutex held.
 static iree_hal_buffer_t* iree_hal_caching_allocator_pool_take_buffer_at(
-    iree_hal_caching_allocator_pool_t* pool, iree_host_size_t i) {
-  iree_hal_buffer_t* buffer = pool->free_buffers[i];
-  if (i < pool->free_count - 1) {
-    // Shift the list down to keep it dense and in ascending recency order.
-    memmove(&pool->free_buffers[i], &pool->free_buffers[i + 1],
-            (pool->free_count - i - 1) * sizeof(pool->free_buffers[0]));
+    iree_hal_caching_allocator_pool_t* pool, uint32_t i) {
+  iree_hal_caching_allocator_entry_t* entry = &pool->entries[i];
+  iree_hal_buffer_t* buffer = entry->buffer;
+
+  // Unlink from the size class list.
+  if (entry->class_prev != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->class_prev].class_next = entry->class_next;
+  } else {
+    const iree_host_size_t class_index =
+        iree_hal_caching_allocator_size_class_index(
+            iree_hal_buffer_allocation_size(buffer));
+    pool->class_heads[class_index] = entry->class_next;
+  }
+  if (entry->class_next != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->class_next].class_prev = entry->class_prev;
+  }
+
+  // Unlink from the pool recency list.
+  if (entry->lru_prev != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->lru_prev].lru_next = entry->lru_next;
+  } else {
+    pool->lru_head = entry->lru_next;
   }
+  if (entry->lru_next != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+    pool->entries[entry->lru_next].lru_prev = entry->lru_prev;
+  } else {
+    pool->lru_tail = entry->lru_prev;
+  }
+
+  // Return the entry to the empty list.
+  entry->buffer = NULL;
+  entry->class_next = pool->empty_head;
+  pool->empty_head = i;
   --pool->free_count;
+
   pool->free_allocated_size -= buffer->allocation_size;
   IREE_TRACE_PLOT_VALUE_I64(IREE_HAL_CACHING_ALLOCATOR_ID,
                             pool->free_allocated_size);
   return buffer;
 }
 
-// Scans the |pool| free list for a buffer matching the given requirements and
-// returns ownership.
+// Scans the |pool| free list of the size class of |allocation_size| for a
+// buffer matching the given requirements and returns ownership.
 //
 // Must be called with the pool mutex held.
 static iree_hal_buffer_t* iree_hal_caching_allocator_pool_find_and_take_buffer(
     iree_hal_caching_allocator_pool_t* pool,
     const iree_hal_buffer_params_t* params,
     iree_device_size_t allocation_size) {
-  // Walk backwards so that we check the most recently released buffers first.
-  for (int i = (int)pool->free_count - 1; i >= 0; --i) {
-    // NOTE: we are not currently checking alignment as we don't really have it.
-    // We assume programs will use consistent alignments for a particular heap
-    // (as the heap has a min alignment).
-    iree_hal_buffer_t* buffer = pool->free_buffers[i];
-    if (iree_all_bits_set(iree_hal_buffer_memory_type(buffer), params->type) &&
-        iree_all_bits_set(iree_hal_buffer_allowed_usage(buffer),
-                          params->usage) &&
-        iree_hal_buffer_allocation_size(buffer) == allocation_size) {
+  // Walk the size class list from the most recently released buffer. Only
+  // buffers with a different memory type, usage, or a size that maps to the
+  // same class are skipped.
+  const iree_host_size_t class_index =
+      iree_hal_caching_allocator_size_class_index(allocation_size);
+  for (uint32_t i = pool->class_heads[class_index];
+       i != IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE;
+       i = pool->entries[i].class_next) {
+    if (iree_hal_caching_allocator_buffer_is_compatible(
+            pool->entries[i].buffer, params, allocation_size)) {
       return iree_hal_caching_allocator_pool_take_buffer_at(pool, i);
     }
   }
   return NULL;  // nothing found
 }
 
+// Returns the magazine preferred by the calling thread.
+// Threads are assigned magazines round-robin on first use so that up to
+// IREE_HAL_CACHING_ALLOCATOR_MAGAZINE_COUNT threads (such as executor workers)
+// each have a magazine to themselves.
+static iree_hal_caching_allocator_magazine_t*
+iree_hal_caching_allocator_pool_thread_magazine(
+    iree_hal_caching_allocator_pool_t* pool) {
+  static iree_atomic_int32_t next_thread_ordinal;
+  static iree_thread_local int32_t thread_ordinal = 0;
+  if (IREE_UNLIKELY(thread_ordinal == 0)) {
+    thread_ordinal = iree_atomic_fetch_add(&next_thread_ordinal, 1,
+                                           iree_memory_order_relaxed) +
+                     1;
+  }
+  return &pool->magazines[(iree_host_size_t)(thread_ordinal - 1) %
+                          IREE_HAL_CACHING_ALLOCATOR_MAGAZINE_COUNT];
+}
+
+// Scans |magazine| for a buffer matching the given requirements and returns
+// ownership.
+//
+// Thread-safe; the magazine mutex must not be held by the caller.
+static iree_hal_buffer_t* iree_hal_caching_allocator_magazine_take_buffer(
+    iree_hal_caching_allocator_magazine_t* magazine,
+    const iree_hal_buffer_params_t* params,
+    iree_device_size_t allocation_size) {
+  iree_hal_buffer_t* buffer = NULL;
+  iree_slim_mutex_lock(&magazine->mutex);
+  for (iree_host_size_t i = magazine->count; i > 0; --i) {
+    if (iree_hal_caching_allocator_buffer_is_compatible(
+            magazine->buffers[i - 1], params, allocation_size)) {
+      buffer = magazine->buffers[i - 1];
+      memmove(&magazine->buffers[i - 1], &magazine->buffers[i],
+              (magazine->count - i) * sizeof(magazine->buffers[0]));
+      --magazine->count;
+      magazine->free_allocated_size -= allocation_size;
+      IREE_STATISTICS(++magazine->reuse_count);
+      break;
+    }
+  }
+  iree_slim_mutex_unlock(&magazine->mutex);
+  return buffer;
+}
+
+static void iree_hal_caching_allocator_pool_release_shared(
+    iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* buffer);
+
+// Pushes |buffer| on to |magazine| as the most recently used. If the magazine
+// is full its least recently used buffer is evicted to the shared free list.
+// Ownership of the retained buffer is transferred to the pool.
+//
+// Thread-safe; the magazine and pool mutexes must not be held by the caller.
+static void iree_hal_caching_allocator_magazine_push_buffer(
+    iree_hal_caching_allocator_pool_t* pool,
+    iree_hal_caching_allocator_magazine_t* magazine,
+    iree_hal_buffer_t* buffer) {
+  iree_hal_buffer_t* evicted_buffer = NULL;
+  iree_slim_mutex_lock(&magazine->mutex);
+  if (magazine->count == pool->params.magazine_capacity) {
+    evicted_buffer = magazine->buffers[0];
+    memmove(&magazine->buffers[0], &magazine->buffers[1],
+            (magazine->count - 1) * sizeof(magazine->buffers[0]));
+    --magazine->count;
+    magazine->free_allocated_size -=
+        iree_hal_buffer_allocation_size(evicted_buffer);
+  }
+  magazine->buffers[magazine->count++] = buffer;
+  magazine->free_allocated_size += iree_hal_buffer_allocation_size(buffer);
+  iree_slim_mutex_unlock(&magazine->mutex);
+  if (evicted_buffer) {
+    iree_hal_caching_allocator_pool_release_shared(pool, evicted_buffer);
+  }
+}
+
+// Moves all buffers held in the |pool| magazines to the shared free list (or
+// releases them to the underlying allocator if the free list is full).
+//
+// Thread-safe; no pool or magazine mutexes may be held by the caller.
+static void iree_hal_caching_allocator_pool_flush_magazines(
+    iree_hal_caching_allocator_pool_t* pool) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(pool->magazines); ++i) {
+    iree_hal_caching_allocator_magazine_t* magazine = &pool->magazines[i];
+    iree_hal_buffer_t*
+        buffers[IREE_HAL_CACHING_ALLOCATOR_MAX_MAGAZINE_CAPACITY];
+    iree_slim_mutex_lock(&magazine->mutex);
+    const iree_host_size_t count = magazine->count;
+    memcpy(buffers, magazine->buffers, count * sizeof(buffers[0]));
+    magazine->count = 0;
+    magazine->free_allocated_size = 0;
+    iree_slim_mutex_unlock(&magazine->mutex);
+    for (iree_host_size_t j = 0; j < count; ++j) {
+      iree_hal_caching_allocator_pool_release_shared(pool, buffers[j]);
+    }
+  }
+}
+
 // Trims |pool| down to at most |target_size| of available allocations.
 // The oldest allocations will be trimmed first.
 //
@@ -194,13 +497,21 @@ static void iree_hal_caching_allocator_pool_trim_to_size(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)target_size);
 
+  // Magazines are only flushed when over the target so that the common case of
+  // allocating under capacity doesn't disturb other threads.
+  if (pool->params.magazine_capacity > 0) {
+    iree_slim_mutex_lock(&pool->mutex);
+    const bool over_target = pool->total_allocated_size > target_size;
+    iree_slim_mutex_unlock(&pool->mutex);
+    if (over_target) iree_hal_caching_allocator_pool_flush_magazines(pool);
+  }
+
   iree_slim_mutex_lock(&pool->mutex);
 
   while (pool->free_count > 0 && pool->total_allocated_size > target_size) {
     // Take the oldest buffer in the list.
     iree_hal_buffer_t* dead_buffer =
-        iree_hal_caching_allocator_pool_take_buffer_at(pool,
-                                                       pool->free_count - 1);
+        iree_hal_caching_allocator_pool_take_buffer_at(pool, pool->lru_tail);
 
     // NOTE: we've removed the buffer but have not subtracted the size from
     // the total yet - we want to do that only after releasing the buffer.
@@ -232,6 +543,21 @@ static void iree_hal_caching_allocator_pool_trim(
   iree_hal_caching_allocator_pool_trim_to_size(pool, 0);
 }
 
+// Returns the size that allocations of |allocation_size| are made with in
+// |pool| based on the pool size class mode.
+static iree_device_size_t iree_hal_caching_allocator_pool_round_size(
+    iree_hal_caching_allocator_pool_t* pool,
+    iree_device_size_t allocation_size) {
+  if (pool->params.size_class_mode !=
+      IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MODE_PO2) {
+    return allocation_size;
+  }
+  const iree_device_size_t rounded_size =
+      iree_hal_caching_allocator_size_class_round(allocation_size);
+  return rounded_size <= pool->params.max_allocation_size ? rounded_size
+                                                          : allocation_size;
+}
+
 // Acquires a buffer of |allocation_size| from the |pool|.
 // The buffer will have a memory type and usage compatible with the given types.
 // Fails if the pool is empty and the underlying device fails the allocation.
@@ -244,6 +570,20 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)allocation_size);
 
+  // Check the magazine of the calling thread first as it is unlikely to be
+  // contended.
+  if (pool->params.magazine_capacity > 0) {
+    iree_hal_buffer_t* magazine_buffer =
+        iree_hal_caching_allocator_magazine_take_buffer(
+            iree_hal_caching_allocator_pool_thread_magazine(pool), params,
+            allocation_size);
+    if (magazine_buffer) {
+      *out_buffer = magazine_buffer;
+      IREE_TRACE_ZONE_END(z0);
+      return iree_ok_status();
+    }
+  }
+
   // Scan the free list to find an appropriate block.
   // If found we pop it off the list and return it without needing to allocate.
   iree_slim_mutex_lock(&pool->mutex);
@@ -255,6 +595,13 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
     // for by other threads allocating at the same time.
     pool->total_allocated_size += allocation_size;
   }
+  IREE_STATISTICS({
+    ++pool->statistics.acquire_count;
+    if (existing_buffer) ++pool->statistics.reuse_count;
+    pool->statistics.peak_allocated_size =
+        iree_max(pool->statistics.peak_allocated_size,
+                 pool->total_allocated_size);
+  });
   iree_slim_mutex_unlock(&pool->mutex);
   if (existing_buffer) {
     // Found a buffer! Return it uninitialized.
@@ -289,15 +636,12 @@ static iree_status_t iree_hal_caching_allocator_pool_acquire(
   return status;
 }
 
-// Releases a |buffer| to the |pool| if there is capacity remaining.
+// Releases a retained |buffer| to the |pool| shared free list if there is
+// capacity remaining and otherwise to the underlying allocator.
 //
 // Thread-safe; multiple threads may concurrently access the |pool|.
-static void iree_hal_caching_allocator_pool_release(
+static void iree_hal_caching_allocator_pool_release_shared(
     iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* buffer) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(
-      z0, (int64_t)iree_hal_buffer_allocation_size(buffer));
-
   // Try to add the buffer to the pool. If the pool is at capacity we'll just
   // release it back to the allocator.
   iree_slim_mutex_lock(&pool->mutex);
@@ -323,6 +667,27 @@ static void iree_hal_caching_allocator_pool_release(
   }
 
   iree_slim_mutex_unlock(&pool->mutex);
+}
+
+// Releases a |buffer| to the |pool| if there is capacity remaining.
+//
+// Thread-safe; multiple threads may concurrently access the |pool|.
+static void iree_hal_caching_allocator_pool_release(
+    iree_hal_caching_allocator_pool_t* pool, iree_hal_buffer_t* buffer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(
+      z0, (int64_t)iree_hal_buffer_allocation_size(buffer));
+
+  // Retain the buffer as we are resurrecting it from its last release; the
+  // pool owns the reference until the buffer is reused or deallocated.
+  iree_hal_buffer_retain(buffer);
+
+  if (pool->params.magazine_capacity > 0) {
+    iree_hal_caching_allocator_magazine_push_buffer(
+        pool, iree_hal_caching_allocator_pool_thread_magazine(pool), buffer);
+  } else {
+    iree_hal_caching_allocator_pool_release_shared(pool, buffer);
+  }
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -396,6 +761,26 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
   IREE_ASSERT_ARGUMENT(out_allocator);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  for (iree_host_size_t i = 0; i < pool_count; ++i) {
+    if (pool_params[i].max_free_allocation_count >=
+        IREE_HAL_CACHING_ALLOCATOR_ENTRY_NONE) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "pool max_free_allocation_count %" PRIhsz
+                              " exceeds limits",
+                              pool_params[i].max_free_allocation_count);
+    }
+    if (pool_params[i].magazine_capacity >
+        IREE_HAL_CACHING_ALLOCATOR_MAX_MAGAZINE_CAPACITY) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "pool magazine_capacity %" PRIhsz " exceeds the maximum of %d",
+          pool_params[i].magazine_capacity,
+          IREE_HAL_CACHING_ALLOCATOR_MAX_MAGAZINE_CAPACITY);
+    }
+  }
+
   // Allocate the allocator itself and then a trailing list of variable-length
   // pools based on their free list sizes.
   iree_hal_caching_allocator_t* allocator = NULL;
@@ -406,7 +791,7 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
   for (iree_host_size_t i = 0; i < pool_count; ++i) {
     iree_hal_caching_allocator_pool_t* pool = NULL;
     total_size += iree_host_align(
-        sizeof(*pool) + sizeof(pool->free_buffers[0]) *
+        sizeof(*pool) + sizeof(pool->entries[0]) *
                             pool_params[i].max_free_allocation_count,
         iree_max_align_t);
   }
@@ -428,7 +813,7 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
     iree_hal_caching_allocator_pool_t* pool =
         (iree_hal_caching_allocator_pool_t*)pool_ptr;
     pool_ptr += iree_host_align(
-        sizeof(*pool) + sizeof(pool->free_buffers[0]) *
+        sizeof(*pool) + sizeof(pool->entries[0]) *
                             pool_params[i].max_free_allocation_count,
         iree_max_align_t);
     allocator->pools[i] = pool;
@@ -553,6 +938,12 @@ iree_status_t iree_hal_caching_allocator_create_from_spec(
                            &pool_config);
     iree_string_view_split(pool_config, ';', &max_free_allocation_count_str,
                            &pool_config);
+    iree_string_view_t size_class_mode_str = iree_string_view_empty();
+    iree_string_view_t magazine_capacity_str = iree_string_view_empty();
+    iree_string_view_split(pool_config, ';', &size_class_mode_str,
+                           &pool_config);
+    iree_string_view_split(pool_config, ';', &magazine_capacity_str,
+                           &pool_config);
     max_allocation_size_str = iree_string_view_trim(max_allocation_size_str);
     if (!iree_string_view_is_empty(max_allocation_size_str) &&
         !iree_string_view_equal(max_allocation_size_str, IREE_SV("*"))) {
@@ -584,6 +975,33 @@ iree_status_t iree_hal_caching_allocator_create_from_spec(
       }
       pool_params->max_free_allocation_count = max_free_allocation_count;
     }
+    size_class_mode_str = iree_string_view_trim(size_class_mode_str);
+    if (iree_string_view_equal(size_class_mode_str, IREE_SV("po2"))) {
+      pool_params->size_class_mode =
+          IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MODE_PO2;
+    } else if (!iree_string_view_is_empty(size_class_mode_str) &&
+               !iree_string_view_equal(size_class_mode_str, IREE_SV("*")) &&
+               !iree_string_view_equal(size_class_mode_str,
+                                       IREE_SV("exact"))) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "invalid size class mode '%.*s'; expected "
+                              "'exact' or 'po2'",
+                              (int)size_class_mode_str.size,
+                              size_class_mode_str.data);
+    }
+    magazine_capacity_str = iree_string_view_trim(magazine_capacity_str);
+    if (!iree_string_view_is_empty(magazine_capacity_str) &&
+        !iree_string_view_equal(magazine_capacity_str, IREE_SV("*"))) {
+      uint32_t magazine_capacity = 0;
+      if (!iree_string_view_atoi_uint32(magazine_capacity_str,
+                                        &magazine_capacity)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "invalid count '%.*s'",
+                                (int)magazine_capacity_str.size,
+                                magazine_capacity_str.data);
+      }
+      pool_params->magazine_capacity = magazine_capacity;
+    }
   } while (!iree_string_view_is_empty(config_pairs));
   return iree_hal_caching_allocator_create_with_pools(
       pool_count, pool_params_storage, device_allocator, host_allocator,
@@ -633,6 +1051,33 @@ static void iree_hal_caching_allocator_query_statistics(
       iree_hal_caching_allocator_cast(base_allocator);
   iree_hal_allocator_query_statistics(allocator->device_allocator,
                                       out_statistics);
+  IREE_STATISTICS({
+    for (iree_host_size_t i = 0; i < allocator->pool_count; ++i) {
+      iree_hal_caching_allocator_pool_t* pool = allocator->pools[i];
+      iree_slim_mutex_lock(&pool->mutex);
+      out_statistics->pool_bytes_peak += pool->statistics.peak_allocated_size;
+      out_statistics->pool_bytes_free += pool->free_allocated_size;
+      out_statistics->pool_acquire_count += pool->statistics.acquire_count;
+      out_statistics->pool_reuse_count += pool->statistics.reuse_count;
+      iree_slim_mutex_unlock(&pool->mutex);
+      for (iree_host_size_t j = 0; j < IREE_ARRAYSIZE(pool->magazines); ++j) {
+        iree_hal_caching_allocator_magazine_t* magazine = &pool->magazines[j];
+        iree_slim_mutex_lock(&magazine->mutex);
+        out_statistics->pool_bytes_free += magazine->free_allocated_size;
+        out_statistics->pool_acquire_count += magazine->reuse_count;
+        out_statistics->pool_reuse_count += magazine->reuse_count;
+        iree_slim_mutex_unlock(&magazine->mutex);
+      }
+    }
+  });
+}
+
+static void iree_hal_caching_allocator_reset_capture_statistics(
+    iree_hal_allocator_t* IREE_RESTRICT base_allocator) {
+  iree_hal_caching_allocator_t* allocator =
+      iree_hal_caching_allocator_cast(base_allocator);
+  iree_hal_allocator_capture_t capture;
+  iree_hal_allocator_begin_capture(allocator->device_allocator, &capture);
 }
 
 static iree_status_t iree_hal_caching_allocator_query_memory_heaps(
@@ -725,6 +1170,21 @@ static iree_status_t iree_hal_caching_allocator_allocate_buffer(
                                               out_buffer);
   }
 
+  // Round the allocation up to the pool size class, if any, and requery the
+  // underlying allocator so that the size used to match free buffers is the
+  // size that buffers will be allocated with.
+  iree_device_size_t rounded_size =
+      iree_hal_caching_allocator_pool_round_size(pool, allocation_size);
+  if (rounded_size != allocation_size) {
+    iree_hal_buffer_params_t rounded_params;
+    if (iree_all_bits_set(iree_hal_allocator_query_buffer_compatibility(
+                              allocator->device_allocator, compat_params,
+                              rounded_size, &rounded_params, &rounded_size),
+                          IREE_HAL_BUFFER_COMPATIBILITY_ALLOCATABLE)) {
+      allocation_size = rounded_size;
+    }
+  }
+
   // Acquire the buffer from the pool.
   IREE_RETURN_IF_ERROR(iree_hal_caching_allocator_pool_acquire(
       pool, &compat_params, allocation_size, out_buffer));
@@ -792,6 +1252,7 @@ static const iree_hal_allocator_vtable_t iree_hal_caching_allocator_vtable = {
     .host_allocator = iree_hal_caching_allocator_host_allocator,
     .trim = iree_hal_caching_allocator_trim,
     .query_statistics = iree_hal_caching_allocator_query_statistics,
+    .reset_capture_statistics = iree_hal_caching_allocator_reset_capture_statistics,
     .query_memory_heaps = iree_hal_caching_allocator_query_memory_heaps,
     .query_buffer_compatibility =
         iree_hal_caching_allocator_query_buffer_compatibility,
@@ -22,10 +22,33 @@ extern "C" {
 // device-local and host-visible buffers on devices with discrete memory.
 // Pools are scanned in-order to allow for prioritization.
 //
+// Free buffers are bucketed by size class so that lookups only inspect the
+// buffers of the requested size class instead of the whole free list. Pools
+// may optionally round allocation sizes up to power-of-two and half-step size
+// classes (256, 384, 512, 768, 1024, ...) so that programs with dynamic shapes
+// producing many slightly different sizes can still reuse buffers at the cost
+// of at most 1/3 of additional memory per allocation. Pools may also keep small
+// per-thread magazines in front of the shared free lists so that threads
+// repeatedly allocating and freeing buffers avoid contending on the pool.
+//
 // Thread-safe: the allocator can be shared across multiple user-level devices
 // manipulated from multiple threads.
 typedef struct iree_hal_caching_allocator_t iree_hal_caching_allocator_t;
 
+// Maximum number of buffers each per-thread magazine of a pool can hold.
+#define IREE_HAL_CACHING_ALLOCATOR_MAX_MAGAZINE_CAPACITY 16
+
+// Controls how a pool rounds allocation sizes.
+typedef enum iree_hal_caching_allocator_size_class_mode_e {
+  // Allocations are made with the exact requested size (after any adjustment
+  // by the underlying allocator) and only reused for identical sizes.
+  IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MODE_EXACT = 0,
+  // Allocations are rounded up to the next power-of-two or half-step between
+  // powers of two (3 * 2^(n-1)) and reused for any size in the same class.
+  // Buffers returned will have an allocation size larger than requested.
+  IREE_HAL_CACHING_ALLOCATOR_SIZE_CLASS_MODE_PO2 = 1,
+} iree_hal_caching_allocator_size_class_mode_t;
+
 // Parameters used to configure an iree_hal_caching_allocator_t pool.
 // These cannot be changed once the allocator has been created.
 typedef struct iree_hal_caching_allocator_pool_params_t {
@@ -49,6 +72,16 @@ typedef struct iree_hal_caching_allocator_pool_params_t {
   // This is used to allocate storage for the free list and should be reasonably
   // bounded (~64-1024).
   iree_host_size_t max_free_allocation_count;
+
+  // Controls whether allocation sizes are rounded up to size classes.
+  iree_hal_caching_allocator_size_class_mode_t size_class_mode;
+
+  // Maximum number of free buffers retained in each per-thread magazine in
+  // front of the shared free list, or 0 to disable magazines. Must be at most
+  // IREE_HAL_CACHING_ALLOCATOR_MAX_MAGAZINE_CAPACITY. Buffers held in
+  // magazines are in addition to max_free_allocation_count and are only
+  // trimmed to max_allocation_capacity when the pool needs to allocate.
+  iree_host_size_t magazine_capacity;
 } iree_hal_caching_allocator_pool_params_t;
 
 // Initializes |out_params| to the default values using |heap| for storage.
@@ -101,10 +134,14 @@ iree_status_t iree_hal_caching_allocator_create_with_pools(
 // defaults.
 //
 // Expected form:
-//   heap_key=max_allocation_size;max_allocation_capacity;max_free_allocation_count
+//   heap_key=max_allocation_size;max_allocation_capacity;
+//            max_free_allocation_count;size_class_mode;magazine_capacity
+// Where size_class_mode is either `exact` (default) or `po2` and trailing
+// fields may be omitted.
 // Example:
 //   device_local=1gib;1gib;8
 //   host_local=*;*;32
+//   device_local=*;4gib;256;po2;8
 iree_status_t iree_hal_caching_allocator_create_from_spec(
     iree_string_view_t config_pairs, iree_hal_allocator_t* device_allocator,
     iree_allocator_t host_allocator, iree_hal_allocator_t** out_allocator);
@@ -75,11 +75,84 @@ static iree_status_t iree_hal_collective_batch_grow(
   return iree_ok_status();
 }
 
+// Verifies that the |send_binding| and |recv_binding| of a collective either
+// don't overlap or overlap exactly as required for the collective to run
+// in-place. NCCL/RCCL (and MPI with IN_PLACE) natively support these layouts
+// but produce undefined results for any other overlap.
+static iree_status_t iree_hal_collective_batch_verify_aliasing(
+    iree_hal_channel_t* channel, iree_hal_collective_op_t op,
+    iree_hal_buffer_binding_t send_binding,
+    iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  if (!send_binding.buffer || !recv_binding.buffer ||
+      iree_hal_buffer_allocated_buffer(send_binding.buffer) !=
+          iree_hal_buffer_allocated_buffer(recv_binding.buffer)) {
+    return iree_ok_status();
+  }
+
+  int32_t rank = 0;
+  int32_t count = 0;
+  iree_hal_channel_query_rank_and_count(channel, &rank, &count);
+  const iree_device_size_t block_length =
+      element_count * iree_hal_collective_element_byte_count(op.element_type);
+  const iree_device_size_t send_offset =
+      iree_hal_buffer_byte_offset(send_binding.buffer) + send_binding.offset;
+  const iree_device_size_t recv_offset =
+      iree_hal_buffer_byte_offset(recv_binding.buffer) + recv_binding.offset;
+
+  // Determine the ranges accessed and where the send range must be relative to
+  // the recv range for the operation to be in-place. Operations that exchange
+  // data between ranks (all-to-all, send-recv) can never run in-place.
+  iree_device_size_t send_length = block_length;
+  iree_device_size_t recv_length = block_length;
+  bool supports_in_place = false;
+  bool is_in_place = false;
+  switch (op.kind) {
+    case IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE:
+    case IREE_HAL_COLLECTIVE_KIND_BROADCAST:
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE:
+      supports_in_place = true;
+      is_in_place = send_offset == recv_offset;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_ALL_GATHER:
+      // Each rank sends its block from its slice of the gathered result.
+      supports_in_place = true;
+      recv_length = block_length * count;
+      is_in_place = send_offset == recv_offset + rank * block_length;
+      break;
+    case IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER:
+      // Each rank receives its block into its slice of the reduced input.
+      supports_in_place = true;
+      send_length = block_length * count;
+      is_in_place = recv_offset == send_offset + rank * block_length;
+      break;
+    default:
+      break;
+  }
+  if (is_in_place) return iree_ok_status();
+
+  const bool overlaps = send_offset < recv_offset + recv_length &&
+                        recv_offset < send_offset + send_length;
+  if (!overlaps) return iree_ok_status();
+  iree_bitfield_string_temp_t string_temp;
+  iree_string_view_t op_str = iree_hal_collective_op_format(&op, &string_temp);
+  return iree_make_status(
+      IREE_STATUS_INVALID_ARGUMENT,
+      "collective %.*s send range [%" PRIdsz ", %" PRIdsz
+      ") overlaps recv range [%" PRIdsz ", %" PRIdsz ")%s",
+      (int)op_str.size, op_str.data, send_offset, send_offset + send_length,
+      recv_offset, recv_offset + recv_length,
+      supports_in_place ? " but is not in-place"
+                        : " and the operation cannot run in-place");
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_collective_batch_append(
     iree_hal_collective_batch_t* batch, iree_hal_channel_t* channel,
     iree_hal_collective_op_t op, uint32_t param,
     iree_hal_buffer_binding_t send_binding,
     iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count) {
+  IREE_RETURN_IF_ERROR(iree_hal_collective_batch_verify_aliasing(
+      channel, op, send_binding, recv_binding, element_count));
+
   // Grow the entry storage if required.
   if (batch->count + 1 > batch->capacity) {
     IREE_RETURN_IF_ERROR(iree_hal_collective_batch_grow(batch));
@@ -110,3 +183,50 @@ IREE_API_EXPORT iree_status_t iree_hal_collective_batch_append(
 
   return iree_ok_status();
 }
+
+//===----------------------------------------------------------------------===//
+// Collective bucketing utility
+//===----------------------------------------------------------------------===//
+
+// Returns the total byte length of the elements in |entry|.
+static iree_device_size_t iree_hal_collective_batch_entry_length(
+    const iree_hal_collective_batch_entry_t* entry) {
+  return entry->element_count *
+         iree_hal_collective_element_byte_count(entry->op.element_type);
+}
+
+IREE_API_EXPORT void iree_hal_collective_batch_select_bucket(
+    const iree_hal_collective_batch_t* batch, iree_host_size_t entry_index,
+    iree_device_size_t bucket_size, iree_hal_collective_bucket_t* out_bucket) {
+  IREE_ASSERT_ARGUMENT(batch);
+  IREE_ASSERT_ARGUMENT(out_bucket);
+  out_bucket->entry_index = entry_index;
+  out_bucket->entry_count = 0;
+  out_bucket->element_count = 0;
+  if (entry_index >= batch->count) return;
+
+  const iree_hal_collective_batch_entry_t* base_entry =
+      &batch->entries[entry_index];
+  out_bucket->entry_count = 1;
+  out_bucket->element_count = base_entry->element_count;
+  iree_device_size_t bucket_length =
+      iree_hal_collective_batch_entry_length(base_entry);
+  if (base_entry->op.kind != IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE ||
+      bucket_length > bucket_size) {
+    return;
+  }
+
+  for (iree_host_size_t i = entry_index + 1; i < batch->count; ++i) {
+    const iree_hal_collective_batch_entry_t* entry = &batch->entries[i];
+    if (entry->channel != base_entry->channel ||
+        entry->op.packed != base_entry->op.packed) {
+      break;
+    }
+    iree_device_size_t entry_length =
+        iree_hal_collective_batch_entry_length(entry);
+    if (bucket_length + entry_length > bucket_size) break;
+    bucket_length += entry_length;
+    out_bucket->element_count += entry->element_count;
+    ++out_bucket->entry_count;
+  }
+}
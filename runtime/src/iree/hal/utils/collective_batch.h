@@ -86,12 +86,47 @@ IREE_API_EXPORT void iree_hal_collective_batch_clear(
 
 // Appends a collective operation to the batch.
 // Referenced resources will be retained.
+//
+// The send and recv bindings may alias only if the operation runs in-place:
+// identical ranges for all-reduce, broadcast, and reduce or the local rank's
+// block of the larger binding for all-gather and reduce-scatter. Any other
+// overlap fails with IREE_STATUS_INVALID_ARGUMENT.
 IREE_API_EXPORT iree_status_t iree_hal_collective_batch_append(
     iree_hal_collective_batch_t* batch, iree_hal_channel_t* channel,
     iree_hal_collective_op_t op, uint32_t param,
     iree_hal_buffer_binding_t send_binding,
     iree_hal_buffer_binding_t recv_binding, iree_device_size_t element_count);
 
+//===----------------------------------------------------------------------===//
+// Collective bucketing utility
+//===----------------------------------------------------------------------===//
+
+// A contiguous range of batch entries that can be fused into one collective
+// operation by packing their inputs into a staging buffer, issuing a single
+// operation over the staging buffer, and unpacking the results.
+//
+// Only all-reduce operations are bucketed today as they are elementwise and
+// produce results in the same layout as their inputs.
+typedef struct {
+  // Index of the first entry in the batch covered by the bucket.
+  iree_host_size_t entry_index;
+  // Total number of entries covered by the bucket. A bucket with a single entry
+  // gains nothing from packing and should be issued directly.
+  iree_host_size_t entry_count;
+  // Total number of elements across all entries in the bucket.
+  iree_device_size_t element_count;
+} iree_hal_collective_bucket_t;
+
+// Selects the bucket starting at |entry_index| in |batch|. Subsequent entries
+// are added to the bucket so long as they are all-reduce operations on the
+// same channel with the same reduction and element type and the total packed
+// size does not exceed |bucket_size| bytes. Always returns a bucket with at
+// least one entry if |entry_index| is in range; callers should advance by
+// |entry_count| and repeat. A |bucket_size| of 0 disables bucketing.
+IREE_API_EXPORT void iree_hal_collective_batch_select_bucket(
+    const iree_hal_collective_batch_t* batch, iree_host_size_t entry_index,
+    iree_device_size_t bucket_size, iree_hal_collective_bucket_t* out_bucket);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
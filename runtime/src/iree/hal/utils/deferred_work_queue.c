@@ -11,6 +11,7 @@
 
 #include "iree/base/api.h"
 #include "iree/base/internal/arena.h"
+#include "iree/base/internal/atomic_slist.h"
 #include "iree/base/internal/synchronization.h"
 #include "iree/base/internal/threading.h"
 #include "iree/hal/api.h"
@@ -19,6 +20,10 @@
 
 // The maximal number of events a command buffer can wait on.
 #define IREE_HAL_MAX_WAIT_EVENT_COUNT 32
+// Bytes of trailing storage in pooled action allocations used for the captured
+// semaphore lists, command buffers, and binding tables. Actions that need more
+// are allocated from the host allocator instead.
+#define IREE_HAL_DEFERRED_WORK_QUEUE_POOLED_ACTION_STORAGE_SIZE 512
 #define IREE_HAL_DEFERRED_WORKER_QUEUE_VERBOSE_PLOTS 0
 
 #if IREE_HAL_DEFERRED_WORKER_QUEUE_VERBOSE_PLOTS
@@ -50,6 +55,20 @@ typedef enum iree_hal_deferred_work_queue_action_state_e {
   IREE_HAL_QUEUE_ACTION_STATE_ALIVE,
 } iree_hal_deferred_work_queue_action_state_t;
 
+// Completion list entry struct.
+typedef struct iree_hal_deferred_work_queue_completion_list_node_t {
+  // The callback and user data for that callback. To be called
+  // when the associated event has completed.
+  iree_status_t (*callback)(iree_status_t, void* user_data);
+  void* user_data;
+  // The event to wait for on the completion thread.
+  iree_hal_deferred_work_queue_native_event_t native_event;
+  // If this event was created just for the completion thread, and therefore
+  // needs to be cleaned up.
+  bool created_event;
+  struct iree_hal_deferred_work_queue_completion_list_node_t* next;
+} iree_hal_deferred_work_queue_completion_list_node_t;
+
 // A work queue action.
 // Note that this struct does not have internal synchronization; it's expected
 // to work together with the deferred work queue, which synchronizes accesses.
@@ -105,8 +124,20 @@ typedef struct iree_hal_deferred_work_queue_action_t {
   iree_host_size_t event_count;
   // Whether the current action is still not ready for releasing to the GPU.
   bool is_pending;
+  // Whether the action was allocated from the work queue action pool.
+  bool is_pooled;
+
+  // Entry used to hand the action to the completion thread once issued.
+  // Each action is issued at most once and owns the storage for its entry.
+  iree_hal_deferred_work_queue_completion_list_node_t completion_entry;
 } iree_hal_deferred_work_queue_action_t;
 
+// Pooled actions are linked through their |next| pointer while unused.
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(iree_hal_deferred_work_queue_action,
+                                iree_hal_deferred_work_queue_action_t,
+                                offsetof(iree_hal_deferred_work_queue_action_t,
+                                         next));
+
 static void iree_hal_deferred_work_queue_action_fail_locked(
     iree_hal_deferred_work_queue_action_t* action, iree_status_t status);
 
@@ -200,6 +231,12 @@ typedef struct iree_hal_deferred_work_queue_entry_list_node_t {
   struct iree_hal_deferred_work_queue_entry_list_node_t* next;
 } iree_hal_deferred_work_queue_entry_list_node_t;
 
+// Unused ready entries are pooled and linked through their |next| pointer.
+IREE_TYPED_ATOMIC_SLIST_WRAPPER(
+    iree_hal_deferred_work_queue_entry_list_node,
+    iree_hal_deferred_work_queue_entry_list_node_t,
+    offsetof(iree_hal_deferred_work_queue_entry_list_node_t, next));
+
 typedef struct iree_hal_deferred_work_queue_entry_list_t {
   iree_slim_mutex_t guard_mutex;
 
@@ -260,20 +297,6 @@ static void iree_hal_deferred_work_queue_ready_action_list_initialize(
   iree_slim_mutex_initialize(&list->guard_mutex);
 }
 
-// Ready action entry struct.
-typedef struct iree_hal_deferred_work_queue_completion_list_node_t {
-  // The callback and user data for that callback. To be called
-  // when the associated event has completed.
-  iree_status_t (*callback)(iree_status_t, void* user_data);
-  void* user_data;
-  // The event to wait for on the completion thread.
-  iree_hal_deferred_work_queue_native_event_t native_event;
-  // If this event was created just for the completion thread, and therefore
-  // needs to be cleaned up.
-  bool created_event;
-  struct iree_hal_deferred_work_queue_completion_list_node_t* next;
-} iree_hal_deferred_work_queue_completion_list_node_t;
-
 typedef struct iree_hal_deferred_work_queue_completion_list_t {
   iree_slim_mutex_t guard_mutex;
   iree_hal_deferred_work_queue_completion_list_node_t* head
@@ -330,8 +353,9 @@ static void iree_hal_deferred_work_queue_completion_list_deinitialize(
       device_interface->vtable->destroy_native_event(device_interface,
                                                      head->native_event);
     }
+    // NOTE: entries are owned by the actions they complete.
     list->head = list->head->next;
-    iree_allocator_free(host_allocator, head);
+    head = list->head;
   }
   iree_slim_mutex_deinitialize(&list->guard_mutex);
 }
@@ -413,8 +437,8 @@ static void iree_hal_deferred_work_queue_working_area_initialize(
     const iree_hal_deferred_work_queue_device_interface_t* device_interface,
     iree_hal_deferred_work_queue_working_area_t* working_area) {
   iree_notification_initialize(&working_area->state_notification);
-  iree_hal_deferred_work_queue_ready_action_list_deinitialize(
-      &working_area->ready_worklist, host_allocator);
+  iree_hal_deferred_work_queue_ready_action_list_initialize(
+      &working_area->ready_worklist);
   iree_atomic_store(&working_area->worker_state,
                     IREE_HAL_WORKER_STATE_IDLE_WAITING,
                     iree_memory_order_release);
@@ -470,6 +494,15 @@ struct iree_hal_deferred_work_queue_t {
   // The block pool to allocate resource sets from.
   iree_arena_block_pool_t* block_pool;
 
+  // Unused action allocations with
+  // IREE_HAL_DEFERRED_WORK_QUEUE_POOLED_ACTION_STORAGE_SIZE bytes of storage.
+  // Actions are allocated on the submitting thread and returned on the
+  // completion thread so this avoids a host allocation per submission.
+  iree_hal_deferred_work_queue_action_slist_t action_pool;
+
+  // Unused ready list entries handed from the issuing thread to the worker.
+  iree_hal_deferred_work_queue_entry_list_node_slist_t entry_pool;
+
   // The device interface used to interact with the native driver.
   iree_hal_deferred_work_queue_device_interface_t* device_interface;
 
@@ -545,6 +578,9 @@ iree_status_t iree_hal_deferred_work_queue_create(
   actions->host_allocator = host_allocator;
   actions->block_pool = block_pool;
   actions->device_interface = device_interface;
+  iree_hal_deferred_work_queue_action_slist_initialize(&actions->action_pool);
+  iree_hal_deferred_work_queue_entry_list_node_slist_initialize(
+      &actions->entry_pool);
 
   iree_slim_mutex_initialize(&actions->action_mutex);
   memset(&actions->action_list, 0, sizeof(actions->action_list));
@@ -648,17 +684,70 @@ void iree_hal_deferred_work_queue_destroy(
   iree_hal_deferred_work_queue_action_list_destroy(
       work_queue->action_list.head);
 
+  iree_hal_deferred_work_queue_action_t* pooled_action = NULL;
+  while ((pooled_action = iree_hal_deferred_work_queue_action_slist_pop(
+              &work_queue->action_pool))) {
+    iree_allocator_free(host_allocator, pooled_action);
+  }
+  iree_hal_deferred_work_queue_action_slist_deinitialize(
+      &work_queue->action_pool);
+  iree_hal_deferred_work_queue_entry_list_node_t* pooled_entry = NULL;
+  while ((pooled_entry = iree_hal_deferred_work_queue_entry_list_node_slist_pop(
+              &work_queue->entry_pool))) {
+    iree_allocator_free(host_allocator, pooled_entry);
+  }
+  iree_hal_deferred_work_queue_entry_list_node_slist_deinitialize(
+      &work_queue->entry_pool);
+
   work_queue->device_interface->vtable->destroy(work_queue->device_interface);
   iree_allocator_free(host_allocator, work_queue);
 
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Allocates an action with |total_action_size| bytes including the trailing
+// storage for its captured lists. Small actions are served from the pool.
+static iree_status_t iree_hal_deferred_work_queue_action_allocate(
+    iree_hal_deferred_work_queue_t* actions, iree_host_size_t total_action_size,
+    iree_hal_deferred_work_queue_action_t** out_action) {
+  *out_action = NULL;
+  const iree_host_size_t pooled_action_size =
+      sizeof(iree_hal_deferred_work_queue_action_t) +
+      IREE_HAL_DEFERRED_WORK_QUEUE_POOLED_ACTION_STORAGE_SIZE;
+  iree_hal_deferred_work_queue_action_t* action = NULL;
+  if (total_action_size <= pooled_action_size) {
+    action =
+        iree_hal_deferred_work_queue_action_slist_pop(&actions->action_pool);
+    if (!action) {
+      IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+          actions->host_allocator, pooled_action_size, (void**)&action));
+    }
+    memset(action, 0, sizeof(*action));
+    action->is_pooled = true;
+  } else {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        actions->host_allocator, total_action_size, (void**)&action));
+  }
+  *out_action = action;
+  return iree_ok_status();
+}
+
+// Frees |action| back to the pool it was allocated from.
+static void iree_hal_deferred_work_queue_action_free(
+    iree_hal_deferred_work_queue_t* actions,
+    iree_hal_deferred_work_queue_action_t* action) {
+  if (action->is_pooled) {
+    iree_hal_deferred_work_queue_action_slist_push(&actions->action_pool,
+                                                   action);
+  } else {
+    iree_allocator_free(actions->host_allocator, action);
+  }
+}
+
 static void iree_hal_deferred_work_queue_action_destroy(
     iree_hal_deferred_work_queue_action_t* action) {
   IREE_TRACE_ZONE_BEGIN(z0);
   iree_hal_deferred_work_queue_t* actions = action->owning_actions;
-  iree_allocator_t host_allocator = actions->host_allocator;
 
   // Call user provided callback before releasing any resource.
   if (action->cleanup_callback) {
@@ -670,9 +759,9 @@ static void iree_hal_deferred_work_queue_action_destroy(
 
   iree_hal_deferred_work_queue_action_clear_events(action);
 
-  iree_hal_resource_release(actions);
+  iree_hal_deferred_work_queue_action_free(actions, action);
 
-  iree_allocator_free(host_allocator, action);
+  iree_hal_resource_release(actions);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -723,8 +812,8 @@ iree_status_t iree_hal_deferred_work_queue_enqueue(
       sizeof(*action) + wait_semaphore_list_size + signal_semaphore_list_size +
       payload_size;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(actions->host_allocator, total_action_size,
-                                (void**)&action));
+      z0, iree_hal_deferred_work_queue_action_allocate(
+              actions, total_action_size, &action));
   uint8_t* action_ptr = (uint8_t*)action + sizeof(*action);
 
   action->owning_actions = actions;
@@ -842,7 +931,7 @@ iree_status_t iree_hal_deferred_work_queue_enqueue(
     iree_slim_mutex_unlock(&actions->action_mutex);
   } else {
     iree_hal_resource_set_free(action->resource_set);
-    iree_allocator_free(actions->host_allocator, action);
+    iree_hal_deferred_work_queue_action_free(actions, action);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -873,8 +962,8 @@ static iree_status_t iree_hal_deferred_work_queue_enqueue_buffer_operation(
       sizeof(*action) + wait_semaphore_list_size + signal_semaphore_list_size;
 
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(actions->host_allocator, total_action_size,
-                                (void**)&action));
+      z0, iree_hal_deferred_work_queue_action_allocate(
+              actions, total_action_size, &action));
   uint8_t* action_ptr = (uint8_t*)action + sizeof(*action);
 
   action->owning_actions = actions;
@@ -956,7 +1045,7 @@ static iree_status_t iree_hal_deferred_work_queue_enqueue_buffer_operation(
     iree_slim_mutex_unlock(&actions->action_mutex);
   } else {
     iree_hal_resource_set_free(action->resource_set);
-    iree_allocator_free(actions->host_allocator, action);
+    iree_hal_deferred_work_queue_action_free(actions, action);
   }
 
   IREE_TRACE_ZONE_END(z0);
@@ -1165,13 +1254,14 @@ static iree_status_t iree_hal_deferred_work_queue_issue_execution(
               z0, iree_hal_deferred_command_buffer_apply(
                       command_buffer, stream_command_buffer, binding_table));
           command_buffer = stream_command_buffer;
+          binding_table = iree_hal_buffer_binding_table_empty();
         } else {
           iree_hal_resource_retain(command_buffer);
         }
 
         IREE_RETURN_AND_END_ZONE_IF_ERROR(
             z0, device_interface->vtable->submit_command_buffer(
-                    device_interface, command_buffer));
+                    device_interface, command_buffer, binding_table));
 
         // The stream_command_buffer is going to be retained by
         // the action->resource_set and deleted after the action
@@ -1233,18 +1323,10 @@ static iree_status_t iree_hal_deferred_work_queue_issue_execution(
       z0, device_interface->vtable->record_native_event(device_interface,
                                                         completion_event));
 
-  iree_hal_deferred_work_queue_completion_list_node_t* entry = NULL;
-  // TODO: avoid host allocator malloc; use some pool for the allocation.
-  iree_status_t status = iree_allocator_malloc(actions->host_allocator,
-                                               sizeof(*entry), (void**)&entry);
-
-  if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
-    IREE_TRACE_ZONE_END(z0);
-    return status;
-  }
-
   // Now push the ready list to the worker and have it to issue the actions to
   // the GPU.
+  iree_hal_deferred_work_queue_completion_list_node_t* entry =
+      &action->completion_entry;
   entry->native_event = completion_event;
   entry->created_event = created_event;
   entry->callback =
@@ -1431,10 +1513,13 @@ iree_status_t iree_hal_deferred_work_queue_issue(
   }
 
   iree_hal_deferred_work_queue_entry_list_node_t* entry = NULL;
-  // TODO: avoid host allocator malloc; use some pool for the allocation.
   if (iree_status_is_ok(status)) {
-    status = iree_allocator_malloc(actions->host_allocator, sizeof(*entry),
-                                   (void**)&entry);
+    entry = iree_hal_deferred_work_queue_entry_list_node_slist_pop(
+        &actions->entry_pool);
+    if (!entry) {
+      status = iree_allocator_malloc(actions->host_allocator, sizeof(*entry),
+                                     (void**)&entry);
+    }
   }
 
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
@@ -1521,7 +1606,8 @@ static void iree_hal_deferred_work_queue_worker_process_ready_list(
       break;
     }
 
-    iree_allocator_free(actions->host_allocator, entry);
+    iree_hal_deferred_work_queue_entry_list_node_slist_push(
+        &actions->entry_pool, entry);
   }
 
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
@@ -1546,10 +1632,15 @@ static void iree_hal_deferred_work_queue_worker_process_completion(
         iree_hal_deferred_work_queue_completion_list_pop(worklist);
     if (!entry) break;
 
+    // The entry is owned by the action and may be released by the callback.
+    iree_hal_deferred_work_queue_native_event_t native_event =
+        entry->native_event;
+    const bool created_event = entry->created_event;
+
     if (IREE_LIKELY(iree_status_is_ok(status))) {
       IREE_TRACE_ZONE_BEGIN_NAMED(z1, "synchronize_native_event");
       status = actions->device_interface->vtable->synchronize_native_event(
-          actions->device_interface, entry->native_event);
+          actions->device_interface, native_event);
       IREE_TRACE_ZONE_END(z1);
     }
 
@@ -1558,12 +1649,11 @@ static void iree_hal_deferred_work_queue_worker_process_completion(
           iree_status_join(status, entry->callback(status, entry->user_data));
     }
 
-    if (IREE_UNLIKELY(entry->created_event)) {
+    if (IREE_UNLIKELY(created_event)) {
       status = iree_status_join(
           status, actions->device_interface->vtable->destroy_native_event(
-                      actions->device_interface, entry->native_event));
+                      actions->device_interface, native_event));
     }
-    iree_allocator_free(actions->host_allocator, entry);
   }
 
   if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
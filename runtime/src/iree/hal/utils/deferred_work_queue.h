@@ -106,9 +106,12 @@ typedef struct iree_hal_deferred_work_queue_device_interface_vtable_t {
       iree_hal_command_buffer_t** out_command_buffer);
 
   // Submits a command buffer to the device.
+  // |binding_table| is empty for command buffers that were produced by
+  // replaying a deferred command buffer as its bindings have been resolved.
   iree_status_t(IREE_API_PTR* submit_command_buffer)(
       iree_hal_deferred_work_queue_device_interface_t* device_interface,
-      iree_hal_command_buffer_t* command_buffer);
+      iree_hal_command_buffer_t* command_buffer,
+      iree_hal_buffer_binding_table_t binding_table);
 
   // Asynchronously allocates a pointer and assigns it to the given buffer.
   //
@@ -0,0 +1,258 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/deferred_work_queue.h"
+#include "iree/testing/benchmark.h"
+
+//===----------------------------------------------------------------------===//
+// iree_hal_test_device_interface_t
+//===----------------------------------------------------------------------===//
+
+// A device interface that performs no device work so that the benchmarks
+// measure just the host-side overhead of the work queue.
+typedef struct iree_hal_test_device_interface_t {
+  iree_hal_deferred_work_queue_device_interface_t base;
+  iree_allocator_t host_allocator;
+} iree_hal_test_device_interface_t;
+
+static const iree_hal_deferred_work_queue_device_interface_vtable_t
+    iree_hal_test_device_interface_vtable;
+
+// Any non-NULL value; events are never dereferenced.
+static int iree_hal_test_native_event_storage = 0;
+
+static iree_status_t iree_hal_test_device_interface_create(
+    iree_allocator_t host_allocator,
+    iree_hal_deferred_work_queue_device_interface_t** out_device_interface) {
+  iree_hal_test_device_interface_t* device_interface = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*device_interface), (void**)&device_interface));
+  device_interface->base.vtable = &iree_hal_test_device_interface_vtable;
+  device_interface->host_allocator = host_allocator;
+  *out_device_interface = &device_interface->base;
+  return iree_ok_status();
+}
+
+static void iree_hal_test_device_interface_destroy(
+    iree_hal_deferred_work_queue_device_interface_t* base_device_interface) {
+  iree_hal_test_device_interface_t* device_interface =
+      (iree_hal_test_device_interface_t*)base_device_interface;
+  iree_allocator_free(device_interface->host_allocator, device_interface);
+}
+
+static iree_status_t iree_hal_test_device_interface_bind_to_thread(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface) {
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_test_device_interface_create_native_event(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    iree_hal_deferred_work_queue_native_event_t* out_event) {
+  *out_event = &iree_hal_test_native_event_storage;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_test_device_interface_native_event_noop(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    iree_hal_deferred_work_queue_native_event_t event) {
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_test_device_interface_acquire_signal_event(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    struct iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_hal_deferred_work_queue_native_event_t* out_event) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "semaphores are not used by the benchmarks");
+}
+
+static iree_status_t iree_hal_test_device_interface_device_wait_on_host_event(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    iree_hal_deferred_work_queue_host_device_event_t event) {
+  return iree_ok_status();
+}
+
+static bool iree_hal_test_device_interface_acquire_host_wait_event(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    struct iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_hal_deferred_work_queue_host_device_event_t* out_event) {
+  return false;
+}
+
+static void iree_hal_test_device_interface_release_wait_event(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    iree_hal_deferred_work_queue_host_device_event_t event) {}
+
+static iree_hal_deferred_work_queue_native_event_t
+iree_hal_test_device_interface_native_event_from_wait_event(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    iree_hal_deferred_work_queue_host_device_event_t event) {
+  return &iree_hal_test_native_event_storage;
+}
+
+static iree_status_t
+iree_hal_test_device_interface_create_stream_command_buffer(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    iree_hal_command_buffer_mode_t mode, iree_hal_command_category_t category,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "command buffers are not used by the benchmarks");
+}
+
+static iree_status_t iree_hal_test_device_interface_submit_command_buffer(
+    iree_hal_deferred_work_queue_device_interface_t* device_interface,
+    iree_hal_command_buffer_t* command_buffer,
+    iree_hal_buffer_binding_table_t binding_table) {
+  return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                          "command buffers are not used by the benchmarks");
+}
+
+static const iree_hal_deferred_work_queue_device_interface_vtable_t
+    iree_hal_test_device_interface_vtable = {
+        .destroy = iree_hal_test_device_interface_destroy,
+        .bind_to_thread = iree_hal_test_device_interface_bind_to_thread,
+        .create_native_event =
+            iree_hal_test_device_interface_create_native_event,
+        .wait_native_event = iree_hal_test_device_interface_native_event_noop,
+        .record_native_event = iree_hal_test_device_interface_native_event_noop,
+        .synchronize_native_event =
+            iree_hal_test_device_interface_native_event_noop,
+        .destroy_native_event =
+            iree_hal_test_device_interface_native_event_noop,
+        .semaphore_acquire_timepoint_device_signal_native_event =
+            iree_hal_test_device_interface_acquire_signal_event,
+        .device_wait_on_host_event =
+            iree_hal_test_device_interface_device_wait_on_host_event,
+        .acquire_host_wait_event =
+            iree_hal_test_device_interface_acquire_host_wait_event,
+        .release_wait_event = iree_hal_test_device_interface_release_wait_event,
+        .native_event_from_wait_event =
+            iree_hal_test_device_interface_native_event_from_wait_event,
+        .create_stream_command_buffer =
+            iree_hal_test_device_interface_create_stream_command_buffer,
+        .submit_command_buffer =
+            iree_hal_test_device_interface_submit_command_buffer,
+};
+
+//===----------------------------------------------------------------------===//
+// Benchmarks
+//===----------------------------------------------------------------------===//
+
+// Tracks the executions that have been cleaned up by the completion thread.
+typedef struct iree_hal_test_completion_state_t {
+  iree_atomic_int64_t completed_count;
+  iree_notification_t notification;
+} iree_hal_test_completion_state_t;
+
+static void iree_hal_test_cleanup_callback(void* user_data) {
+  iree_hal_test_completion_state_t* state =
+      (iree_hal_test_completion_state_t*)user_data;
+  iree_atomic_fetch_add(&state->completed_count, 1, iree_memory_order_release);
+  iree_notification_post(&state->notification, IREE_ALL_WAITERS);
+}
+
+typedef struct iree_hal_test_completion_wait_t {
+  iree_hal_test_completion_state_t* state;
+  int64_t target_count;
+} iree_hal_test_completion_wait_t;
+
+static bool iree_hal_test_completion_reached(void* user_data) {
+  iree_hal_test_completion_wait_t* wait =
+      (iree_hal_test_completion_wait_t*)user_data;
+  return iree_atomic_load(&wait->state->completed_count,
+                          iree_memory_order_acquire) >= wait->target_count;
+}
+
+// Tests the round-trip performance of empty executions that have no waits,
+// signals, or command buffers. This exercises the action lifecycle: enqueue,
+// issue to the device, and cleanup on the completion thread.
+//
+// user_data is a count of executions enqueued before issuing them.
+static iree_status_t iree_hal_deferred_work_queue_benchmark_empty_n(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+
+  iree_arena_block_pool_t block_pool;
+  iree_arena_block_pool_initialize(4096, host_allocator, &block_pool);
+
+  iree_hal_deferred_work_queue_device_interface_t* device_interface = NULL;
+  IREE_CHECK_OK(
+      iree_hal_test_device_interface_create(host_allocator, &device_interface));
+
+  // The work queue takes ownership of the device interface.
+  iree_hal_deferred_work_queue_t* work_queue = NULL;
+  IREE_CHECK_OK(iree_hal_deferred_work_queue_create(
+      device_interface, &block_pool, host_allocator, &work_queue));
+
+  iree_hal_test_completion_state_t state;
+  iree_atomic_store(&state.completed_count, 0, iree_memory_order_relaxed);
+  iree_notification_initialize(&state.notification);
+
+  uint32_t count = (uint32_t)(uintptr_t)benchmark_def->user_data;
+  iree_hal_test_completion_wait_t wait = {
+      .state = &state,
+      .target_count = 0,
+  };
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/count)) {
+    for (uint32_t i = 0; i < count; ++i) {
+      IREE_CHECK_OK(iree_hal_deferred_work_queue_enqueue(
+          work_queue, iree_hal_test_cleanup_callback, &state,
+          iree_hal_semaphore_list_empty(), iree_hal_semaphore_list_empty(),
+          /*command_buffer_count=*/0, /*command_buffers=*/NULL,
+          /*binding_tables=*/NULL));
+    }
+    IREE_CHECK_OK(iree_hal_deferred_work_queue_issue(work_queue));
+    wait.target_count += count;
+    iree_notification_await(&state.notification,
+                            iree_hal_test_completion_reached, &wait,
+                            iree_infinite_timeout());
+  }
+
+  // Cleanup.
+  iree_hal_deferred_work_queue_destroy(work_queue);
+  iree_notification_deinitialize(&state.notification);
+  iree_arena_block_pool_deinitialize(&block_pool);
+
+  return iree_ok_status();
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+
+  // iree_hal_deferred_work_queue_benchmark_empty_n
+  {
+    iree_benchmark_def_t benchmark_def = {
+        .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                 IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+        .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+        .minimum_duration_ns = 0,
+        .iteration_count = 0,
+        .run = iree_hal_deferred_work_queue_benchmark_empty_n,
+    };
+    benchmark_def.user_data = (void*)1u;
+    iree_benchmark_register(iree_make_cstring_view("empty_1"), &benchmark_def);
+    benchmark_def.user_data = (void*)64u;
+    iree_benchmark_register(iree_make_cstring_view("empty_64"), &benchmark_def);
+    // ~1M executions in steady state so that pooled allocations dominate.
+    benchmark_def.user_data = (void*)1024u;
+    benchmark_def.iteration_count = 1024 * 1024;
+    iree_benchmark_register(iree_make_cstring_view("empty_1024"),
+                            &benchmark_def);
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -0,0 +1,637 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Needed for O_DIRECT on Linux.
+#define _GNU_SOURCE
+
+#include "iree/hal/utils/fd_file.h"
+
+#include "iree/base/internal/synchronization.h"
+
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_IOS) || \
+    defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_MACOS)
+#define IREE_HAL_FD_FILE_HAVE_FD 1
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_*
+
+//===----------------------------------------------------------------------===//
+// Configuration
+//===----------------------------------------------------------------------===//
+
+// When 1 io_uring will be used on Linux to keep multiple reads in flight.
+// If the kernel does not support io_uring (or it is blocked by the sandbox)
+// reads fall back to pread.
+#if !defined(IREE_HAL_FD_FILE_IO_URING_ENABLE)
+#define IREE_HAL_FD_FILE_IO_URING_ENABLE 1
+#endif  // !IREE_HAL_FD_FILE_IO_URING_ENABLE
+
+// Maximum number of reads in flight per file.
+#if !defined(IREE_HAL_FD_FILE_QUEUE_DEPTH)
+#define IREE_HAL_FD_FILE_QUEUE_DEPTH 32
+#endif  // !IREE_HAL_FD_FILE_QUEUE_DEPTH
+
+// Bytes per individual read request; large requests are split into segments of
+// this size such that many can be serviced by the device in parallel.
+#if !defined(IREE_HAL_FD_FILE_READ_SEGMENT_SIZE)
+#define IREE_HAL_FD_FILE_READ_SEGMENT_SIZE (1 * 1024 * 1024)
+#endif  // !IREE_HAL_FD_FILE_READ_SEGMENT_SIZE
+
+// Alignment of offsets, lengths, and host memory used with O_DIRECT files.
+// This covers devices with either 512 or 4096 byte logical blocks.
+#if !defined(IREE_HAL_FD_FILE_DIRECT_ALIGNMENT)
+#define IREE_HAL_FD_FILE_DIRECT_ALIGNMENT 4096
+#endif  // !IREE_HAL_FD_FILE_DIRECT_ALIGNMENT
+
+// Maximum size of the bounce buffer used for unaligned O_DIRECT reads.
+// Must be a multiple of IREE_HAL_FD_FILE_DIRECT_ALIGNMENT.
+#if !defined(IREE_HAL_FD_FILE_BOUNCE_BUFFER_SIZE)
+#define IREE_HAL_FD_FILE_BOUNCE_BUFFER_SIZE (4 * 1024 * 1024)
+#endif  // !IREE_HAL_FD_FILE_BOUNCE_BUFFER_SIZE
+
+#if IREE_HAL_FD_FILE_IO_URING_ENABLE && defined(IREE_PLATFORM_LINUX) && \
+    defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#if defined(__NR_io_uring_setup) && defined(__NR_io_uring_enter)
+#define IREE_HAL_FD_FILE_HAVE_IO_URING 1
+#endif  // __NR_io_uring_*
+#endif  // __has_include(<linux/io_uring.h>)
+#endif  // IREE_HAL_FD_FILE_IO_URING_ENABLE && IREE_PLATFORM_LINUX
+
+#if defined(IREE_HAL_FD_FILE_HAVE_FD)
+
+//===----------------------------------------------------------------------===//
+// iree_hal_fd_file_ring_t
+//===----------------------------------------------------------------------===//
+
+#if defined(IREE_HAL_FD_FILE_HAVE_IO_URING)
+
+// A minimal io_uring instance used only for batches of reads.
+// We use the raw syscalls instead of liburing to avoid the dependency; the
+// subset of functionality required is small.
+typedef struct iree_hal_fd_file_ring_t {
+  // io_uring file descriptor or -1 if the ring is unavailable.
+  int fd;
+  // Number of submission queue entries; bounds the reads in flight.
+  uint32_t entries;
+  // Mapped submission and completion queue rings. They may alias when the
+  // kernel supports IORING_FEAT_SINGLE_MMAP.
+  void* sq_ring;
+  size_t sq_ring_size;
+  void* cq_ring;
+  size_t cq_ring_size;
+  // Mapped submission queue entries.
+  struct io_uring_sqe* sqes;
+  size_t sqes_size;
+  // Pointers into the submission queue ring.
+  uint32_t* sq_head;
+  uint32_t* sq_tail;
+  uint32_t sq_mask;
+  uint32_t* sq_array;
+  // Pointers into the completion queue ring.
+  uint32_t* cq_head;
+  uint32_t* cq_tail;
+  uint32_t cq_mask;
+  struct io_uring_cqe* cqes;
+} iree_hal_fd_file_ring_t;
+
+static void iree_hal_fd_file_ring_deinitialize(iree_hal_fd_file_ring_t* ring) {
+  if (ring->sqes) munmap(ring->sqes, ring->sqes_size);
+  if (ring->cq_ring && ring->cq_ring != ring->sq_ring) {
+    munmap(ring->cq_ring, ring->cq_ring_size);
+  }
+  if (ring->sq_ring) munmap(ring->sq_ring, ring->sq_ring_size);
+  if (ring->fd != -1) close(ring->fd);
+  memset(ring, 0, sizeof(*ring));
+  ring->fd = -1;
+}
+
+// Initializes |out_ring| with up to |entries| in flight. Returns false if
+// io_uring is not available in which case the ring must not be used.
+static bool iree_hal_fd_file_ring_initialize(
+    uint32_t entries, iree_hal_fd_file_ring_t* out_ring) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  memset(out_ring, 0, sizeof(*out_ring));
+  out_ring->fd = -1;
+
+  struct io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = (int)syscall(__NR_io_uring_setup, entries, &params);
+  if (ring_fd < 0) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "io_uring unavailable");
+    IREE_TRACE_ZONE_END(z0);
+    return false;
+  }
+  out_ring->fd = ring_fd;
+  out_ring->entries = params.sq_entries;
+
+  out_ring->sq_ring_size =
+      params.sq_off.array + params.sq_entries * sizeof(uint32_t);
+  out_ring->cq_ring_size =
+      params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+  const bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    out_ring->sq_ring_size =
+        iree_max(out_ring->sq_ring_size, out_ring->cq_ring_size);
+    out_ring->cq_ring_size = out_ring->sq_ring_size;
+  }
+
+  void* sq_ring = mmap(NULL, out_ring->sq_ring_size, PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQ_RING);
+  if (sq_ring == MAP_FAILED) {
+    iree_hal_fd_file_ring_deinitialize(out_ring);
+    IREE_TRACE_ZONE_END(z0);
+    return false;
+  }
+  out_ring->sq_ring = sq_ring;
+  if (single_mmap) {
+    out_ring->cq_ring = sq_ring;
+  } else {
+    void* cq_ring =
+        mmap(NULL, out_ring->cq_ring_size, PROT_READ | PROT_WRITE,
+             MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_CQ_RING);
+    if (cq_ring == MAP_FAILED) {
+      iree_hal_fd_file_ring_deinitialize(out_ring);
+      IREE_TRACE_ZONE_END(z0);
+      return false;
+    }
+    out_ring->cq_ring = cq_ring;
+  }
+  out_ring->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+  void* sqes = mmap(NULL, out_ring->sqes_size, PROT_READ | PROT_WRITE,
+                    MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    iree_hal_fd_file_ring_deinitialize(out_ring);
+    IREE_TRACE_ZONE_END(z0);
+    return false;
+  }
+  out_ring->sqes = (struct io_uring_sqe*)sqes;
+
+  uint8_t* sq_base = (uint8_t*)out_ring->sq_ring;
+  out_ring->sq_head = (uint32_t*)(sq_base + params.sq_off.head);
+  out_ring->sq_tail = (uint32_t*)(sq_base + params.sq_off.tail);
+  out_ring->sq_mask = *(uint32_t*)(sq_base + params.sq_off.ring_mask);
+  out_ring->sq_array = (uint32_t*)(sq_base + params.sq_off.array);
+  uint8_t* cq_base = (uint8_t*)out_ring->cq_ring;
+  out_ring->cq_head = (uint32_t*)(cq_base + params.cq_off.head);
+  out_ring->cq_tail = (uint32_t*)(cq_base + params.cq_off.tail);
+  out_ring->cq_mask = *(uint32_t*)(cq_base + params.cq_off.ring_mask);
+  out_ring->cqes = (struct io_uring_cqe*)(cq_base + params.cq_off.cqes);
+
+  IREE_TRACE_ZONE_END(z0);
+  return true;
+}
+
+#endif  // IREE_HAL_FD_FILE_HAVE_IO_URING
+
+//===----------------------------------------------------------------------===//
+// iree_hal_fd_file_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_fd_file_t {
+  iree_hal_resource_t resource;
+  // Used to allocate this structure and any bounce buffers.
+  iree_allocator_t host_allocator;
+  // Allowed access bits.
+  iree_hal_memory_access_t access;
+  // Base file handle, retained.
+  iree_io_file_handle_t* handle;
+  // File descriptor from the handle, unowned.
+  int fd;
+  // Total length of the file in bytes when it was opened.
+  uint64_t length;
+  // Required alignment of I/O offsets, lengths, and host memory. 1 unless the
+  // file descriptor was opened with O_DIRECT.
+  iree_host_size_t alignment;
+#if defined(IREE_HAL_FD_FILE_HAVE_IO_URING)
+  // Guards the ring as only one batch of reads may use it at a time.
+  iree_slim_mutex_t ring_mutex;
+  // Ring used for reads; fd is -1 if unavailable.
+  iree_hal_fd_file_ring_t ring;
+#endif  // IREE_HAL_FD_FILE_HAVE_IO_URING
+} iree_hal_fd_file_t;
+
+static const iree_hal_file_vtable_t iree_hal_fd_file_vtable;
+
+static iree_hal_fd_file_t* iree_hal_fd_file_cast(
+    iree_hal_file_t* IREE_RESTRICT base_value) {
+  return (iree_hal_fd_file_t*)base_value;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_from_handle(
+    iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(handle);
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  if (iree_io_file_handle_type(handle) != IREE_IO_FILE_HANDLE_TYPE_FD) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "file handle is not a file descriptor");
+  }
+  int fd = iree_io_file_handle_value(handle).fd;
+
+  // Query the file length once; files are not expected to change size while
+  // in use by the HAL.
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to query file descriptor length");
+  }
+
+  // Direct I/O requires aligned requests - we remember that here so that we
+  // don't need to query it per-operation.
+  iree_host_size_t alignment = 1;
+#if defined(O_DIRECT)
+  int fd_flags = fcntl(fd, F_GETFL);
+  if (fd_flags != -1 && (fd_flags & O_DIRECT)) {
+    alignment = IREE_HAL_FD_FILE_DIRECT_ALIGNMENT;
+  }
+#endif  // O_DIRECT
+
+  iree_hal_fd_file_t* file = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*file), (void**)&file));
+  iree_hal_resource_initialize(&iree_hal_fd_file_vtable, &file->resource);
+  file->host_allocator = host_allocator;
+  file->access = access;
+  file->handle = handle;
+  iree_io_file_handle_retain(handle);
+  file->fd = fd;
+  file->length = (uint64_t)file_stat.st_size;
+  file->alignment = alignment;
+
+#if defined(IREE_HAL_FD_FILE_HAVE_IO_URING)
+  // NOTE: failure to create the ring is not an error; it's often disabled in
+  // containers and we can fall back to pread.
+  iree_slim_mutex_initialize(&file->ring_mutex);
+  iree_hal_fd_file_ring_initialize(IREE_HAL_FD_FILE_QUEUE_DEPTH, &file->ring);
+#endif  // IREE_HAL_FD_FILE_HAVE_IO_URING
+
+  *out_file = (iree_hal_file_t*)file;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_fd_file_destroy(iree_hal_file_t* IREE_RESTRICT base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  iree_allocator_t host_allocator = file->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+#if defined(IREE_HAL_FD_FILE_HAVE_IO_URING)
+  iree_hal_fd_file_ring_deinitialize(&file->ring);
+  iree_slim_mutex_deinitialize(&file->ring_mutex);
+#endif  // IREE_HAL_FD_FILE_HAVE_IO_URING
+
+  iree_io_file_handle_release(file->handle);
+
+  iree_allocator_free(host_allocator, file);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_hal_memory_access_t iree_hal_fd_file_allowed_access(
+    iree_hal_file_t* base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  return file->access;
+}
+
+static uint64_t iree_hal_fd_file_length(iree_hal_file_t* base_file) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  return file->length;
+}
+
+static iree_hal_buffer_t* iree_hal_fd_file_storage_buffer(
+    iree_hal_file_t* base_file) {
+  // File descriptors are never directly device-accessible.
+  return NULL;
+}
+
+//===----------------------------------------------------------------------===//
+// Reads
+//===----------------------------------------------------------------------===//
+
+// Reads [offset, offset+length) of |file| into |target| with pread.
+// |length| may extend past the end of the file (as is required for aligned
+// direct I/O of the last block) in which case only the bytes up to the end of
+// the file are required to be read. The full |length| is still requested from
+// the kernel as direct I/O rejects unaligned lengths.
+static iree_status_t iree_hal_fd_file_pread(iree_hal_fd_file_t* file,
+                                            uint64_t offset, uint8_t* target,
+                                            iree_host_size_t length) {
+  if (offset >= file->length) return iree_ok_status();
+  const iree_host_size_t required_length =
+      (iree_host_size_t)iree_min((uint64_t)length, file->length - offset);
+  iree_host_size_t total_length = 0;
+  while (total_length < required_length) {
+    ssize_t read_length = pread(file->fd, target + total_length,
+                                length - total_length, offset + total_length);
+    if (read_length < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "pread of %" PRIhsz " bytes at offset %" PRIu64
+                              " failed",
+                              length - total_length, offset + total_length);
+    } else if (read_length == 0) {
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "unexpected end of file at offset %" PRIu64,
+                              offset + total_length);
+    }
+    total_length += (iree_host_size_t)read_length;
+  }
+  return iree_ok_status();
+}
+
+#if defined(IREE_HAL_FD_FILE_HAVE_IO_URING)
+
+// Reads [offset, offset+length) of |file| into |target| in segments with up to
+// the ring depth of reads in flight at a time. Any read that completes short
+// or fails (such as if the kernel does not support IORING_OP_READ) is finished
+// synchronously with pread.
+//
+// Must be called with the ring mutex held.
+static iree_status_t iree_hal_fd_file_ring_read(iree_hal_fd_file_t* file,
+                                                uint64_t offset,
+                                                uint8_t* target,
+                                                iree_host_size_t length) {
+  iree_hal_fd_file_ring_t* ring = &file->ring;
+  const iree_host_size_t segment_size = IREE_HAL_FD_FILE_READ_SEGMENT_SIZE;
+  const iree_host_size_t segment_count =
+      iree_host_size_ceil_div(length, segment_size);
+  iree_host_size_t submitted_count = 0;
+  iree_host_size_t completed_count = 0;
+  iree_status_t status = iree_ok_status();
+  while (completed_count < segment_count) {
+    // Once a failure is recorded no new reads are issued but any reads still
+    // in flight must complete before the target memory can be released.
+    if (!iree_status_is_ok(status) && completed_count == submitted_count) {
+      break;
+    }
+
+    // Fill the submission queue with as many segments as fit.
+    uint32_t sq_tail = *ring->sq_tail;
+    while (iree_status_is_ok(status) && submitted_count < segment_count &&
+           submitted_count - completed_count < ring->entries) {
+      const uint32_t sqe_index = sq_tail & ring->sq_mask;
+      struct io_uring_sqe* sqe = &ring->sqes[sqe_index];
+      memset(sqe, 0, sizeof(*sqe));
+      const iree_host_size_t segment_offset = submitted_count * segment_size;
+      sqe->opcode = IORING_OP_READ;
+      sqe->fd = file->fd;
+      sqe->off = offset + segment_offset;
+      sqe->addr = (uint64_t)(uintptr_t)(target + segment_offset);
+      sqe->len = (uint32_t)iree_min(segment_size, length - segment_offset);
+      sqe->user_data = (uint64_t)submitted_count;
+      ring->sq_array[sqe_index] = sqe_index;
+      ++sq_tail;
+      ++submitted_count;
+    }
+    __atomic_store_n(ring->sq_tail, sq_tail, __ATOMIC_RELEASE);
+
+    // Submit any pending reads and wait for at least one to complete.
+    const uint32_t pending_count =
+        sq_tail - __atomic_load_n(ring->sq_head, __ATOMIC_ACQUIRE);
+    int ret = (int)syscall(__NR_io_uring_enter, ring->fd, pending_count,
+                           /*min_complete=*/1, IORING_ENTER_GETEVENTS, NULL, 0);
+    if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+      // The ring is unusable; nothing can be reaped and we bail.
+      if (iree_status_is_ok(status)) {
+        status = iree_make_status(iree_status_code_from_errno(errno),
+                                  "io_uring_enter failed");
+      }
+      break;
+    }
+
+    // Reap all available completions.
+    uint32_t cq_head = *ring->cq_head;
+    const uint32_t cq_tail = __atomic_load_n(ring->cq_tail, __ATOMIC_ACQUIRE);
+    for (; cq_head != cq_tail; ++cq_head) {
+      const struct io_uring_cqe* cqe = &ring->cqes[cq_head & ring->cq_mask];
+      const iree_host_size_t segment_offset =
+          (iree_host_size_t)cqe->user_data * segment_size;
+      const iree_host_size_t segment_length =
+          iree_min(segment_size, length - segment_offset);
+      const iree_host_size_t read_length =
+          cqe->res > 0 ? (iree_host_size_t)cqe->res : 0;
+      ++completed_count;
+      if (iree_status_is_ok(status) && read_length < segment_length) {
+        status = iree_hal_fd_file_pread(
+            file, offset + segment_offset + read_length,
+            target + segment_offset + read_length,
+            segment_length - read_length);
+      }
+    }
+    __atomic_store_n(ring->cq_head, cq_head, __ATOMIC_RELEASE);
+  }
+  return status;
+}
+
+#endif  // IREE_HAL_FD_FILE_HAVE_IO_URING
+
+// Reads [offset, offset+length) of |file| into |target| with as many reads in
+// flight as possible. If the file uses direct I/O the range and target must be
+// aligned.
+static iree_status_t iree_hal_fd_file_read_batch(iree_hal_fd_file_t* file,
+                                                 uint64_t offset,
+                                                 uint8_t* target,
+                                                 iree_host_size_t length) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)length);
+  iree_status_t status = iree_ok_status();
+#if defined(IREE_HAL_FD_FILE_HAVE_IO_URING)
+  if (file->ring.fd != -1 && length > IREE_HAL_FD_FILE_READ_SEGMENT_SIZE) {
+    iree_slim_mutex_lock(&file->ring_mutex);
+    status = iree_hal_fd_file_ring_read(file, offset, target, length);
+    iree_slim_mutex_unlock(&file->ring_mutex);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+#endif  // IREE_HAL_FD_FILE_HAVE_IO_URING
+  status = iree_hal_fd_file_pread(file, offset, target, length);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Reads [offset, offset+length) of a direct I/O |file| into |target| through
+// an aligned bounce buffer. Used for the portions of requests that do not meet
+// the direct I/O alignment requirements.
+static iree_status_t iree_hal_fd_file_read_bounced(iree_hal_fd_file_t* file,
+                                                   uint64_t offset,
+                                                   uint8_t* target,
+                                                   iree_host_size_t length) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)length);
+  const iree_host_size_t alignment = file->alignment;
+  const iree_host_size_t bounce_capacity =
+      iree_min(IREE_HAL_FD_FILE_BOUNCE_BUFFER_SIZE,
+               iree_host_align(length, alignment) + alignment);
+  uint8_t* bounce_buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc_aligned(file->host_allocator, bounce_capacity,
+                                        alignment, 0, (void**)&bounce_buffer));
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && length > 0) {
+    const uint64_t aligned_offset = offset & ~((uint64_t)alignment - 1);
+    const iree_host_size_t skip_length =
+        (iree_host_size_t)(offset - aligned_offset);
+    const iree_host_size_t chunk_length =
+        iree_min(length, bounce_capacity - skip_length);
+    status = iree_hal_fd_file_pread(
+        file, aligned_offset, bounce_buffer,
+        iree_host_align(skip_length + chunk_length, alignment));
+    if (iree_status_is_ok(status)) {
+      memcpy(target, bounce_buffer + skip_length, chunk_length);
+    }
+    offset += chunk_length;
+    target += chunk_length;
+    length -= chunk_length;
+  }
+  iree_allocator_free_aligned(file->host_allocator, bounce_buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_hal_fd_file_read_into(iree_hal_fd_file_t* file,
+                                                uint64_t offset,
+                                                uint8_t* target,
+                                                iree_host_size_t length) {
+  const iree_host_size_t alignment = file->alignment;
+  if (alignment <= 1) {
+    return iree_hal_fd_file_read_batch(file, offset, target, length);
+  }
+
+  // Direct I/O: if the start of the request is aligned we can read the aligned
+  // body in-place and only need to bounce the tail. Callers streaming through
+  // staging buffers (such as iree_hal_device_queue_read_streaming) arrange
+  // for this to be the common case.
+  if ((offset & (alignment - 1)) == 0 &&
+      ((uintptr_t)target & (alignment - 1)) == 0) {
+    const iree_host_size_t body_length = length & ~(alignment - 1);
+    iree_status_t status = iree_ok_status();
+    if (body_length > 0) {
+      status = iree_hal_fd_file_read_batch(file, offset, target, body_length);
+    }
+    if (iree_status_is_ok(status) && body_length < length) {
+      status = iree_hal_fd_file_read_bounced(file, offset + body_length,
+                                             target + body_length,
+                                             length - body_length);
+    }
+    return status;
+  }
+  return iree_hal_fd_file_read_bounced(file, offset, target, length);
+}
+
+static iree_status_t iree_hal_fd_file_read(
+    iree_hal_file_t* base_file, uint64_t file_offset, iree_hal_buffer_t* buffer,
+    iree_device_size_t buffer_offset, iree_device_size_t length) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  if (file_offset > file->length || length > file->length - file_offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "read of %" PRIdsz " bytes at offset %" PRIu64
+                            " exceeds file length %" PRIu64,
+                            length, file_offset, file->length);
+  }
+
+  iree_hal_buffer_mapping_t target_mapping;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED,
+      IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE, buffer_offset, length,
+      &target_mapping));
+
+  iree_status_t status = iree_hal_fd_file_read_into(
+      file, file_offset, target_mapping.contents.data,
+      target_mapping.contents.data_length);
+
+  if (iree_status_is_ok(status) &&
+      !iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status = iree_hal_buffer_mapping_flush_range(&target_mapping, 0,
+                                                 IREE_WHOLE_BUFFER);
+  }
+
+  iree_hal_buffer_unmap_range(&target_mapping);
+  return status;
+}
+
+//===----------------------------------------------------------------------===//
+// Writes
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_hal_fd_file_write(
+    iree_hal_file_t* base_file, uint64_t file_offset, iree_hal_buffer_t* buffer,
+    iree_device_size_t buffer_offset, iree_device_size_t length) {
+  iree_hal_fd_file_t* file = iree_hal_fd_file_cast(base_file);
+  if (file_offset > file->length || length > file->length - file_offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "write of %" PRIdsz " bytes at offset %" PRIu64
+                            " exceeds file length %" PRIu64,
+                            length, file_offset, file->length);
+  }
+
+  iree_hal_buffer_mapping_t source_mapping;
+  IREE_RETURN_IF_ERROR(iree_hal_buffer_map_range(
+      buffer, IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ,
+      buffer_offset, length, &source_mapping));
+
+  iree_status_t status = iree_ok_status();
+  if (!iree_all_bits_set(iree_hal_buffer_memory_type(buffer),
+                         IREE_HAL_MEMORY_TYPE_HOST_COHERENT)) {
+    status = iree_hal_buffer_mapping_invalidate_range(&source_mapping, 0,
+                                                      IREE_WHOLE_BUFFER);
+  }
+
+  const uint8_t* source = source_mapping.contents.data;
+  iree_host_size_t remaining_length = source_mapping.contents.data_length;
+  while (iree_status_is_ok(status) && remaining_length > 0) {
+    ssize_t write_length =
+        pwrite(file->fd, source, remaining_length, file_offset);
+    if (write_length < 0) {
+      if (errno == EINTR) continue;
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "pwrite of %" PRIhsz " bytes at offset %" PRIu64
+                                " failed",
+                                remaining_length, file_offset);
+      break;
+    }
+    file_offset += (uint64_t)write_length;
+    source += write_length;
+    remaining_length -= (iree_host_size_t)write_length;
+  }
+
+  iree_hal_buffer_unmap_range(&source_mapping);
+  return status;
+}
+
+static const iree_hal_file_vtable_t iree_hal_fd_file_vtable = {
+    .destroy = iree_hal_fd_file_destroy,
+    .allowed_access = iree_hal_fd_file_allowed_access,
+    .length = iree_hal_fd_file_length,
+    .storage_buffer = iree_hal_fd_file_storage_buffer,
+    .read = iree_hal_fd_file_read,
+    .write = iree_hal_fd_file_write,
+};
+
+#else
+
+IREE_API_EXPORT iree_status_t iree_hal_fd_file_from_handle(
+    iree_hal_memory_access_t access, iree_io_file_handle_t* handle,
+    iree_allocator_t host_allocator, iree_hal_file_t** out_file) {
+  IREE_ASSERT_ARGUMENT(out_file);
+  *out_file = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file descriptors not available on this platform");
+}
+
+#endif  // IREE_HAL_FD_FILE_HAVE_FD
@@ -0,0 +1,186 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/fd_file.h"
+
+#include <cinttypes>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/io/file_handle.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+std::string GetUniquePath(const char* unique_name) {
+  char* test_tmpdir = getenv("TEST_TMPDIR");
+  if (!test_tmpdir) {
+    test_tmpdir = getenv("TMPDIR");
+  }
+  if (!test_tmpdir) {
+    test_tmpdir = getenv("TEMP");
+  }
+  if (!test_tmpdir) {
+    test_tmpdir = (char*)"/tmp";
+  }
+  std::random_device d;
+  uint64_t random = (static_cast<uint64_t>(d()) << 32) | d();
+  char unique_path[256];
+  snprintf(unique_path, sizeof unique_path, "%s/iree_test_%" PRIx64 "_%s",
+           test_tmpdir, random, unique_name);
+  return unique_path;
+}
+
+class FdFileTest : public ::testing::Test {
+ protected:
+  // Large enough to be split into many reads with an unaligned tail.
+  static constexpr iree_host_size_t kFileSize = 5 * 1024 * 1024 + 777;
+
+  void SetUp() override {
+    path_ = GetUniquePath("fd_file_test.bin");
+    contents_.resize(kFileSize);
+    for (iree_host_size_t i = 0; i < contents_.size(); ++i) {
+      contents_[i] = static_cast<uint8_t>(i * 131 + (i >> 11));
+    }
+    FILE* file = fopen(path_.c_str(), "wb");
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(fwrite(contents_.data(), 1, contents_.size(), file),
+              contents_.size());
+    fclose(file);
+
+    IREE_ASSERT_OK(iree_hal_allocator_create_heap(
+        iree_make_cstring_view("heap"), iree_allocator_system(),
+        iree_allocator_system(), &device_allocator_));
+  }
+
+  void TearDown() override {
+    iree_hal_allocator_release(device_allocator_);
+    remove(path_.c_str());
+  }
+
+  // Opens the test file with |mode| and returns the HAL file or nullptr if
+  // the mode is not supported by the platform/file system.
+  iree_hal_file_t* OpenFile(iree_io_file_mode_t mode) {
+    iree_io_file_handle_t* handle = NULL;
+    iree_status_t status =
+        iree_io_file_handle_open(mode, iree_make_cstring_view(path_.c_str()),
+                                 iree_allocator_system(), &handle);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      return nullptr;
+    }
+    iree_hal_file_t* file = NULL;
+    IREE_CHECK_OK(iree_hal_fd_file_from_handle(IREE_HAL_MEMORY_ACCESS_READ,
+                                               handle, iree_allocator_system(),
+                                               &file));
+    iree_io_file_handle_release(handle);
+    return file;
+  }
+
+  // Reads |length| bytes at |file_offset| into a buffer at |buffer_offset| and
+  // verifies the contents.
+  void ReadAndVerify(iree_hal_file_t* file, uint64_t file_offset,
+                     iree_device_size_t buffer_offset,
+                     iree_device_size_t length) {
+    iree_hal_buffer_params_t params = {0};
+    params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+    params.usage =
+        IREE_HAL_BUFFER_USAGE_MAPPING | IREE_HAL_BUFFER_USAGE_TRANSFER;
+    params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+    params.min_alignment = 4096;
+    iree_hal_buffer_t* buffer = NULL;
+    IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(
+        device_allocator_, params, buffer_offset + length, &buffer));
+    uint8_t fill_pattern = 0xCD;
+    IREE_ASSERT_OK(iree_hal_buffer_map_fill(buffer, 0, IREE_WHOLE_BUFFER,
+                                            &fill_pattern, 1));
+    IREE_ASSERT_OK(
+        iree_hal_file_read(file, file_offset, buffer, buffer_offset, length));
+    std::vector<uint8_t> actual(length);
+    IREE_ASSERT_OK(
+        iree_hal_buffer_map_read(buffer, buffer_offset, actual.data(), length));
+    iree_hal_buffer_release(buffer);
+    EXPECT_TRUE(std::equal(actual.begin(), actual.end(),
+                           contents_.begin() + file_offset))
+        << "file_offset=" << file_offset << " buffer_offset=" << buffer_offset
+        << " length=" << length;
+  }
+
+  void ReadAll(iree_hal_file_t* file) {
+    ASSERT_EQ(iree_hal_file_length(file), kFileSize);
+    ReadAndVerify(file, 0, 0, kFileSize);
+    ReadAndVerify(file, 4096, 0, kFileSize - 4096);
+    ReadAndVerify(file, 4096, 4096, 3 * 1024 * 1024);
+    ReadAndVerify(file, 13, 7, kFileSize - 20);
+    ReadAndVerify(file, kFileSize - 100, 1, 100);
+    ReadAndVerify(file, 1, 4096, 5000);
+    ReadAndVerify(file, 0, 0, 1);
+  }
+
+  std::string path_;
+  std::vector<uint8_t> contents_;
+  iree_hal_allocator_t* device_allocator_ = NULL;
+};
+
+TEST_F(FdFileTest, Read) {
+  iree_hal_file_t* file = OpenFile(IREE_IO_FILE_MODE_READ);
+  ASSERT_NE(file, nullptr);
+  ReadAll(file);
+  iree_hal_file_release(file);
+}
+
+TEST_F(FdFileTest, ReadDirect) {
+  iree_hal_file_t* file =
+      OpenFile(IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_DIRECT);
+  if (!file) {
+    GTEST_SKIP() << "direct I/O not supported by the file system";
+  }
+  ReadAll(file);
+  iree_hal_file_release(file);
+}
+
+TEST_F(FdFileTest, ReadOutOfRange) {
+  iree_hal_file_t* file = OpenFile(IREE_IO_FILE_MODE_READ);
+  ASSERT_NE(file, nullptr);
+  iree_hal_buffer_params_t params = {0};
+  params.type = IREE_HAL_MEMORY_TYPE_HOST_LOCAL;
+  params.usage = IREE_HAL_BUFFER_USAGE_MAPPING | IREE_HAL_BUFFER_USAGE_TRANSFER;
+  params.access = IREE_HAL_MEMORY_ACCESS_ALL;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_ASSERT_OK(iree_hal_allocator_allocate_buffer(device_allocator_, params,
+                                                    64, &buffer));
+  EXPECT_THAT(Status(iree_hal_file_read(file, kFileSize - 10, buffer, 0, 11)),
+              StatusIs(StatusCode::kOutOfRange));
+  iree_hal_buffer_release(buffer);
+  iree_hal_file_release(file);
+}
+
+TEST_F(FdFileTest, DirectRequiresReadOnly) {
+  iree_io_file_handle_t* handle = NULL;
+  EXPECT_THAT(
+      Status(iree_io_file_handle_open(
+          IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_WRITE |
+              IREE_IO_FILE_MODE_DIRECT,
+          iree_make_cstring_view(path_.c_str()), iree_allocator_system(),
+          &handle)),
+      StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(handle, nullptr);
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -0,0 +1,36 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_FILE_REGISTRY_H_
+#define IREE_HAL_UTILS_FILE_REGISTRY_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/io/file_handle.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a HAL file backed by |handle| using the generic host implementation
+// for the handle type:
+//   IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION: iree_hal_memory_file_wrap
+//   IREE_IO_FILE_HANDLE_TYPE_FD: iree_hal_fd_file_from_handle
+// Intended for use by HAL implementations without native file support in their
+// iree_hal_device_import_file implementation.
+//
+// Fails with IREE_STATUS_UNAVAILABLE if the handle type is not supported.
+IREE_API_EXPORT iree_status_t iree_hal_file_from_handle(
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_queue_affinity_t queue_affinity, iree_hal_memory_access_t access,
+    iree_io_file_handle_t* handle, iree_allocator_t host_allocator,
+    iree_hal_file_t** out_file);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_FILE_REGISTRY_H_
@@ -7,7 +7,6 @@
 #include "iree/hal/utils/file_transfer.h"
 
 #include "iree/base/internal/math.h"
-#include "iree/hal/utils/memory_file.h"
 
 //===----------------------------------------------------------------------===//
 // Configuration
@@ -36,12 +35,24 @@
 #define IREE_HAL_TRANSFER_CHUNKS_PER_WORKER 8
 #endif  // IREE_HAL_TRANSFER_CHUNKS_PER_WORKER
 
+#if !defined(IREE_HAL_TRANSFER_READ_ALIGNMENT)
+// Alignment of file reads into staging buffers. Reads are widened to cover the
+// aligned range containing each chunk such that files using direct I/O (which
+// requires block-aligned offsets, lengths, and host memory) can read directly
+// into the staging buffer. Must be a power of two.
+#define IREE_HAL_TRANSFER_READ_ALIGNMENT 4096
+#endif  // !IREE_HAL_TRANSFER_READ_ALIGNMENT
+
+#if !defined(IREE_HAL_TRANSFER_WRITE_ALIGNMENT)
+// Alignment of the staging buffer and each staging slot used by writes.
+// TODO(benvanik): make staging alignment an option/device query?
+#define IREE_HAL_TRANSFER_WRITE_ALIGNMENT 64
+#endif  // !IREE_HAL_TRANSFER_WRITE_ALIGNMENT
+
 //===----------------------------------------------------------------------===//
 // iree_hal_transfer_operation_t
 //===----------------------------------------------------------------------===//
 
-// TODO(benvanik): move to utils/ without relying on iree_hal_memory_file_t.
-
 // Maximum number of transfer workers that can be used; common usage should be
 // 1-4 but on very large systems with lots of bandwidth we may be able to
 // use more.
@@ -51,6 +62,11 @@
 // the operation workers array.
 typedef uint64_t iree_hal_transfer_worker_bitmask_t;
 
+// Maximum number of staging slots per worker. Writes use two slots so that the
+// device copy of the next chunk into one slot overlaps with the file write of
+// the previous chunk out of the other.
+#define IREE_HAL_TRANSFER_WORKER_SLOT_MAX_COUNT 2
+
 // Counts the total number of workers indicated by the given worker bitmask.
 #define iree_hal_transfer_worker_live_count(bitmask) \
   iree_math_count_ones_u64(bitmask)
@@ -65,6 +81,18 @@ typedef enum {
 
 typedef struct iree_hal_transfer_operation_t iree_hal_transfer_operation_t;
 
+// A chunk of a write staged in a worker's staging buffer reservation.
+typedef struct iree_hal_transfer_slot_t {
+  // Aligned offset into the staging buffer of the slot storage.
+  iree_device_size_t staging_buffer_offset;
+  // Offset into the transfer operation of the chunk staged in the slot.
+  iree_device_size_t transfer_offset;
+  // Length of the chunk staged in the slot.
+  iree_device_size_t transfer_length;
+  // Worker timepoint reached when the chunk has been copied into the slot.
+  uint64_t ready_timepoint;
+} iree_hal_transfer_slot_t;
+
 // A worker greedily processing subranges of a larger transfer operation.
 // Since transfers are 99% IO bound we avoid real threads and use workers as
 // coroutines (or something like them): workers submit operations and schedule
@@ -92,6 +120,16 @@ typedef struct iree_hal_transfer_worker_t {
   // Length of the current worker transfer; usually staging_buffer_length but
   // may be less if this worker is processing the end of the file.
   iree_device_size_t pending_transfer_length;
+
+  // Staging slots used by writes as a ring: the device copies chunks into the
+  // slots in order and the host writes them to the file in the same order.
+  // Reads use the worker staging buffer range directly and have no slots.
+  iree_host_size_t slot_count;
+  // Index of the oldest slot with a chunk pending a file write.
+  iree_host_size_t slot_head;
+  // Number of slots with chunks being copied or pending a file write.
+  iree_host_size_t slot_pending_count;
+  iree_hal_transfer_slot_t slots[IREE_HAL_TRANSFER_WORKER_SLOT_MAX_COUNT];
 } iree_hal_transfer_worker_t;
 
 // Manages an asynchronous transfer operation.
@@ -113,6 +151,8 @@ typedef struct iree_hal_transfer_operation_t {
   iree_hal_file_t* file;
   // Offset into the file where the operation begins.
   uint64_t file_offset;
+  // Total length of the file used to clamp aligned reads.
+  uint64_t file_length;
   // Retained buffer resource.
   iree_hal_buffer_t* buffer;
   // Offset into the buffer where the operation begins.
@@ -190,6 +230,25 @@ static iree_status_t iree_hal_transfer_operation_create(
       iree_min(worker_count, iree_min(IREE_HAL_TRANSFER_WORKER_LIMIT,
                                       IREE_HAL_TRANSFER_WORKER_MAX_COUNT));
 
+  // Reads are widened to the aligned range containing each chunk and need
+  // space in each worker's staging reservation for the partial head/tail
+  // blocks. Writes stage exactly the chunk in each of their slots and use
+  // multiple slots only if there are multiple chunks to pipeline.
+  iree_host_size_t worker_slot_count = 0;
+  iree_device_size_t worker_slot_stride = 0;
+  iree_device_size_t worker_staging_stride = worker_chunk_size;
+  if (direction == IREE_HAL_TRANSFER_READ_FILE_TO_BUFFER) {
+    worker_staging_stride =
+        iree_device_align(worker_chunk_size, IREE_HAL_TRANSFER_READ_ALIGNMENT) +
+        IREE_HAL_TRANSFER_READ_ALIGNMENT;
+  } else {
+    worker_slot_count = (iree_host_size_t)iree_min(
+        IREE_HAL_TRANSFER_WORKER_SLOT_MAX_COUNT, total_chunk_count);
+    worker_slot_stride =
+        iree_device_align(worker_chunk_size, IREE_HAL_TRANSFER_WRITE_ALIGNMENT);
+    worker_staging_stride = worker_slot_stride * worker_slot_count;
+  }
+
   // Calculate total size of the structure with all its associated data.
   iree_hal_transfer_operation_t* operation = NULL;
   iree_host_size_t total_size = sizeof(*operation);
@@ -218,11 +277,12 @@ static iree_status_t iree_hal_transfer_operation_create(
   operation->file = file;
   iree_hal_file_retain(file);
   operation->file_offset = file_offset;
+  operation->file_length = iree_hal_file_length(file);
   operation->buffer = buffer;
   iree_hal_buffer_retain(buffer);
   operation->buffer_offset = buffer_offset;
   operation->length = length;
-  operation->staging_buffer_size = worker_count * worker_chunk_size;
+  operation->staging_buffer_size = worker_count * worker_staging_stride;
   operation->transfer_head = 0;
   operation->remaining_chunks = (iree_host_size_t)total_chunk_count;
   operation->worker_count = worker_count;
@@ -273,8 +333,13 @@ static iree_status_t iree_hal_transfer_operation_create(
     IREE_TRACE(worker->trace_id = (int64_t)i);
 
     // View into the staging buffer where the worker keeps its memory.
-    worker->staging_buffer_offset = worker_chunk_size * i;
+    worker->staging_buffer_offset = worker_staging_stride * i;
     worker->staging_buffer_length = worker_chunk_size;
+    worker->slot_count = worker_slot_count;
+    for (iree_host_size_t j = 0; j < worker_slot_count; ++j) {
+      worker->slots[j].staging_buffer_offset =
+          worker->staging_buffer_offset + worker_slot_stride * j;
+    }
 
     // Create semaphore for tracking worker progress.
     worker->pending_timepoint = 0ull;
@@ -342,9 +407,10 @@ static void iree_hal_transfer_operation_destroy(
 }
 
 // Notifies listeners that the operation has completed and releases its memory.
-// If this was a read then the staging buffer dealloca will be chained to the
-// last asynchronous copies. In writes the last flush to the file happened
-// synchronously so the dealloca happens immediately.
+// The staging buffer dealloca is chained to the last asynchronous copies of
+// each worker: in reads these are the copies out of the staging buffer and in
+// writes any copies into staging slots that were still in-flight when a
+// worker exited due to an error.
 //
 // Pre-condition: all workers have exited and there are no operations in flight.
 // Post-condition: the operation is freed.
@@ -359,22 +425,20 @@ static void iree_hal_transfer_operation_notify_completion(
 
   // Deallocating the staging buffer can only happen after all workers have
   // completed copies into/out-of it. In reads it's expected there are copies
-  // in-flight and we can wait on all worker semaphores. In writes the last
-  // flush to the file happened synchronously so we don't need to wait at all.
-  iree_hal_semaphore_list_t wait_semaphore_list =
-      iree_hal_semaphore_list_empty();
-  if (operation->direction == IREE_HAL_TRANSFER_READ_FILE_TO_BUFFER) {
-    wait_semaphore_list.count = operation->worker_count;
-    wait_semaphore_list.semaphores = (iree_hal_semaphore_t**)iree_alloca(
-        wait_semaphore_list.count * sizeof(wait_semaphore_list.semaphores[0]));
-    wait_semaphore_list.payload_values =
-        (uint64_t*)iree_alloca(wait_semaphore_list.count *
-                               sizeof(wait_semaphore_list.payload_values[0]));
-    for (iree_host_size_t i = 0; i < operation->worker_count; ++i) {
-      iree_hal_transfer_worker_t* worker = &operation->workers[i];
-      wait_semaphore_list.semaphores[i] = worker->semaphore;
-      wait_semaphore_list.payload_values[i] = worker->pending_timepoint;
-    }
+  // in-flight. In writes the last flush to the file happened synchronously
+  // and the worker timelines have already been reached unless a worker exited
+  // early with a copy into its next staging slot still in-flight.
+  iree_hal_semaphore_list_t wait_semaphore_list = {
+      .count = operation->worker_count,
+      .semaphores = (iree_hal_semaphore_t**)iree_alloca(
+          operation->worker_count * sizeof(iree_hal_semaphore_t*)),
+      .payload_values =
+          (uint64_t*)iree_alloca(operation->worker_count * sizeof(uint64_t)),
+  };
+  for (iree_host_size_t i = 0; i < operation->worker_count; ++i) {
+    iree_hal_transfer_worker_t* worker = &operation->workers[i];
+    wait_semaphore_list.semaphores[i] = worker->semaphore;
+    wait_semaphore_list.payload_values[i] = worker->pending_timepoint;
   }
 
   // When the dealloca completes signal the original semaphores passed in to the
@@ -512,18 +576,32 @@ static iree_status_t iree_hal_transfer_worker_copy_file_to_buffer(
   worker->pending_transfer_offset = transfer_offset;
   worker->pending_transfer_length = transfer_length;
 
+  // Widen the read to the aligned range containing the chunk (clamped to the
+  // end of the file). The staging buffer and each worker's reservation are
+  // aligned so direct I/O files can read in-place without bouncing.
+  const uint64_t chunk_file_offset =
+      operation->file_offset + worker->pending_transfer_offset;
+  const uint64_t read_file_offset =
+      chunk_file_offset & ~((uint64_t)IREE_HAL_TRANSFER_READ_ALIGNMENT - 1);
+  const uint64_t read_file_end =
+      iree_min(iree_device_align(chunk_file_offset + transfer_length,
+                                 IREE_HAL_TRANSFER_READ_ALIGNMENT),
+               operation->file_length);
+  const iree_device_size_t read_skip_length =
+      (iree_device_size_t)(chunk_file_offset - read_file_offset);
+
   // Synchronously copy the contents from the file to the staging buffer.
   status = iree_hal_file_read(
-      operation->file, operation->file_offset + worker->pending_transfer_offset,
-      operation->staging_buffer, worker->staging_buffer_offset,
-      worker->pending_transfer_length);
+      operation->file, read_file_offset, operation->staging_buffer,
+      worker->staging_buffer_offset,
+      (iree_device_size_t)(read_file_end - read_file_offset));
 
   // Issue asynchronous copy from the staging buffer into the target buffer.
   if (iree_status_is_ok(status)) {
     status = iree_hal_device_queue_copy(
         operation->device, operation->queue_affinity, wait_semaphore_list,
         signal_semaphore_list, operation->staging_buffer,
-        worker->staging_buffer_offset, operation->buffer,
+        worker->staging_buffer_offset + read_skip_length, operation->buffer,
         operation->buffer_offset + transfer_offset, transfer_length,
         IREE_HAL_COPY_FLAG_NONE);
   }
@@ -574,8 +652,8 @@ static iree_status_t iree_hal_transfer_operation_launch_read(
   // staging out of the buffer.
   iree_hal_buffer_params_t staging_buffer_params = {
       .access = IREE_HAL_MEMORY_ACCESS_ALL,
-      // TODO(benvanik): make staging alignment an option/device query?
-      .min_alignment = 64,
+      // Aligned for direct I/O reads into the staging buffer.
+      .min_alignment = IREE_HAL_TRANSFER_READ_ALIGNMENT,
       .queue_affinity = operation->queue_affinity,
       .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
               IREE_HAL_MEMORY_TYPE_DEVICE_VISIBLE,
@@ -640,19 +718,16 @@ static iree_status_t iree_hal_transfer_operation_launch_read(
 static iree_status_t iree_hal_transfer_worker_copy_staging_to_file(
     void* user_data, iree_loop_t loop, iree_status_t status);
 
-static iree_status_t iree_hal_transfer_worker_copy_buffer_to_staging(
+// Enqueues an asynchronous copy of the next chunk of the transfer from the
+// source buffer into the next free staging slot of |worker|.
+static iree_status_t iree_hal_transfer_worker_enqueue_buffer_to_staging(
     iree_hal_transfer_operation_t* operation,
-    iree_hal_transfer_worker_t* worker, iree_loop_t loop) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->trace_id);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)worker->trace_id);
-
-  // If there's been an error we bail.
-  if (!iree_status_is_ok(operation->error_status)) {
-    IREE_TRACE_ZONE_APPEND_TEXT(z0, "bail: error bit set");
-    IREE_TRACE_ZONE_END(z0);
-    return iree_hal_transfer_worker_exit(operation, worker, iree_ok_status());
-  }
+    iree_hal_transfer_worker_t* worker) {
+  IREE_ASSERT(worker->slot_pending_count < worker->slot_count,
+              "must have a free staging slot");
+  iree_hal_transfer_slot_t* slot =
+      &worker->slots[(worker->slot_head + worker->slot_pending_count) %
+                     worker->slot_count];
 
   // Grab a piece of the transfer to operate on.
   IREE_ASSERT(operation->remaining_chunks > 0,
@@ -664,38 +739,77 @@ static iree_status_t iree_hal_transfer_worker_copy_buffer_to_staging(
   IREE_ASSERT(transfer_length > 0,
               "should not have ticked if there was no work to do");
   operation->transfer_head += transfer_length;
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_offset);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)transfer_length);
 
-  // Timeline increments by one.
+  // Timeline increments by one. Copies are ordered on the worker timeline so
+  // slots become ready in the order they are written to the file.
+  uint64_t wait_timepoint = worker->pending_timepoint;
   iree_hal_semaphore_list_t wait_semaphore_list = {
       .count = 1,
       .semaphores = &worker->semaphore,
-      .payload_values = &worker->pending_timepoint,
+      .payload_values = &wait_timepoint,
   };
-  ++worker->pending_timepoint;
+  uint64_t signal_timepoint = ++worker->pending_timepoint;
   iree_hal_semaphore_list_t signal_semaphore_list = {
       .count = 1,
       .semaphores = &worker->semaphore,
-      .payload_values = &worker->pending_timepoint,
+      .payload_values = &signal_timepoint,
   };
 
   // Track the pending copy operation so we know where to place it in the file.
-  worker->pending_transfer_offset = transfer_offset;
-  worker->pending_transfer_length = transfer_length;
+  slot->transfer_offset = transfer_offset;
+  slot->transfer_length = transfer_length;
+  slot->ready_timepoint = signal_timepoint;
+  ++worker->slot_pending_count;
 
-  // Issue an asynchronous copy from the source buffer to the staging buffer.
-  iree_status_t status = iree_hal_device_queue_copy(
+  // Issue an asynchronous copy from the source buffer to the staging slot.
+  return iree_hal_device_queue_copy(
       operation->device, operation->queue_affinity, wait_semaphore_list,
       signal_semaphore_list, operation->buffer,
       operation->buffer_offset + transfer_offset, operation->staging_buffer,
-      worker->staging_buffer_offset, transfer_length, IREE_HAL_COPY_FLAG_NONE);
+      slot->staging_buffer_offset, transfer_length, IREE_HAL_COPY_FLAG_NONE);
+}
+
+// Fills all free staging slots of |worker| with copies of the next chunks of
+// the transfer and waits for the oldest slot to be ready to write to the file.
+// Exits the worker if there are no more chunks to stage or write.
+static iree_status_t iree_hal_transfer_worker_copy_buffer_to_staging(
+    iree_hal_transfer_operation_t* operation,
+    iree_hal_transfer_worker_t* worker, iree_loop_t loop) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)operation->trace_id);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)worker->trace_id);
+
+  // If there's been an error we bail.
+  if (!iree_status_is_ok(operation->error_status)) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "bail: error bit set");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_hal_transfer_worker_exit(operation, worker, iree_ok_status());
+  }
 
-  // Wait for the copy to complete so we can write it to the file.
+  // Keep all slots busy: while the host writes one slot to the file the device
+  // copies the next chunk into the other.
+  iree_status_t status = iree_ok_status();
+  while (worker->slot_pending_count < worker->slot_count &&
+         operation->remaining_chunks > 0) {
+    status =
+        iree_hal_transfer_worker_enqueue_buffer_to_staging(operation, worker);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  // All chunks claimed by this worker have been written.
+  if (iree_status_is_ok(status) && worker->slot_pending_count == 0) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "exit: no more chunks remaining to write");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_hal_transfer_worker_exit(operation, worker, iree_ok_status());
+  }
+
+  // Wait for the oldest copy to complete so we can write it to the file.
   if (iree_status_is_ok(status)) {
     status = iree_loop_wait_one(
         loop,
-        iree_hal_semaphore_await(worker->semaphore, worker->pending_timepoint),
+        iree_hal_semaphore_await(worker->semaphore,
+                                 worker->slots[worker->slot_head]
+                                     .ready_timepoint),
         iree_infinite_timeout(), iree_hal_transfer_worker_copy_staging_to_file,
         worker);
   }
@@ -724,27 +838,29 @@ static iree_status_t iree_hal_transfer_worker_copy_staging_to_file(
     return iree_hal_transfer_worker_exit(operation, worker, status);
   }
 
-  // Synchronously copy the contents from the staging buffer to the file.
+  // Synchronously copy the contents from the oldest staging slot to the file.
+  // Copies into any other slots continue on the device in the meantime.
+  iree_hal_transfer_slot_t* slot = &worker->slots[worker->slot_head];
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)slot->transfer_offset);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)slot->transfer_length);
   status = iree_hal_file_write(
-      operation->file, operation->file_offset + worker->pending_transfer_offset,
-      operation->staging_buffer, worker->staging_buffer_offset,
-      worker->pending_transfer_length);
-
-  if (iree_status_is_ok(status) && operation->remaining_chunks == 0) {
-    IREE_TRACE_ZONE_APPEND_TEXT(z0, "exit: no more chunks remaining to write");
-    IREE_TRACE_ZONE_END(z0);
-    return iree_hal_transfer_worker_exit(operation, worker, iree_ok_status());
-  }
-
+      operation->file, operation->file_offset + slot->transfer_offset,
+      operation->staging_buffer, slot->staging_buffer_offset,
+      slot->transfer_length);
   if (!iree_status_is_ok(status)) {
     IREE_TRACE_ZONE_APPEND_TEXT(z0, "bail: file write error");
     IREE_TRACE_ZONE_END(z0);
     return iree_hal_transfer_worker_exit(operation, worker, status);
   }
 
+  // Release the slot so it can stage another chunk.
+  worker->slot_head = (worker->slot_head + 1) % worker->slot_count;
+  --worker->slot_pending_count;
+
   IREE_TRACE_ZONE_END(z0);
 
-  // Tail call: tick the worker so that it transfers another chunk.
+  // Tail call: tick the worker so that it stages another chunk and writes the
+  // next one.
   return iree_hal_transfer_worker_copy_buffer_to_staging(operation, worker,
                                                          loop);
 }
@@ -765,8 +881,7 @@ static iree_status_t iree_hal_transfer_operation_launch_write(
   // staging out of the buffer.
   iree_hal_buffer_params_t staging_buffer_params = {
       .access = IREE_HAL_MEMORY_ACCESS_ALL,
-      // TODO(benvanik): make staging alignment an option/device query?
-      .min_alignment = 64,
+      .min_alignment = IREE_HAL_TRANSFER_WRITE_ALIGNMENT,
       .queue_affinity = operation->queue_affinity,
       .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_HOST |
               IREE_HAL_MEMORY_TYPE_HOST_CACHED |
@@ -805,10 +920,11 @@ static iree_status_t iree_hal_transfer_operation_launch_write(
     operation->live_workers |= 1ull << worker_index;
     iree_hal_transfer_operation_retain(operation);
 
-    // Issue the initial asynchronous copy from the source buffer to the worker
-    // chunk. This will wait for the alloca to complete so that the staging
-    // buffer is available for use. After the copy completes the worker will
-    // tick itself so long as there are chunks remaining to write.
+    // Issue the initial asynchronous copies from the source buffer to the
+    // worker staging slots. These will wait for the alloca to complete so that
+    // the staging buffer is available for use. After each copy completes the
+    // worker will write it to the file and tick itself so long as there are
+    // chunks remaining to write.
     status = iree_hal_transfer_worker_copy_buffer_to_staging(operation, worker,
                                                              loop);
     if (!iree_status_is_ok(status)) break;
@@ -52,8 +52,9 @@ typedef struct iree_hal_file_transfer_options_t {
 // The provided |options.loop| is used for any asynchronous host operations
 // performed as part of the transfer.
 //
-// WARNING: this only works with memory files as created via
-// iree_hal_memory_file_wrap.
+// WARNING: this only works with files implementing the synchronous file API
+// such as those created via iree_hal_memory_file_wrap and
+// iree_hal_fd_file_from_handle.
 IREE_API_EXPORT iree_status_t iree_hal_device_queue_read_streaming(
     iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
@@ -72,11 +73,19 @@ IREE_API_EXPORT iree_status_t iree_hal_device_queue_read_streaming(
 // each chunk and |options.chunk_count| specifies how many chunks will be
 // allocated at once.
 //
+// Writes of more than one chunk are double-buffered: two chunks of staging
+// memory are reserved and the device copy of the next chunk into one is
+// enqueued before the previous chunk is written to the file out of the other
+// so that device->host transfers overlap with file I/O. All device work is
+// ordered by semaphores after |wait_semaphore_list| and |signal_semaphore_list|
+// is signaled once the last chunk has been written to the file.
+//
 // The provided |options.loop| is used for any asynchronous host operations
 // performed as part of the transfer.
 //
-// WARNING: this only works with memory files as created via
-// iree_hal_memory_file_wrap.
+// WARNING: this only works with files implementing the synchronous file API
+// such as those created via iree_hal_memory_file_wrap and
+// iree_hal_fd_file_from_handle.
 IREE_API_EXPORT iree_status_t iree_hal_device_queue_write_streaming(
     iree_hal_device_t* device, iree_hal_queue_affinity_t queue_affinity,
     const iree_hal_semaphore_list_t wait_semaphore_list,
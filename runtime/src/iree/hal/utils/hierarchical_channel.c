@@ -0,0 +1,152 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/hierarchical_channel.h"
+
+IREE_API_EXPORT iree_status_t iree_hal_hierarchical_channel_initialize(
+    iree_hal_channel_t* base_channel, int32_t local_count,
+    iree_hal_hierarchical_channel_t* out_channel) {
+  IREE_ASSERT_ARGUMENT(base_channel);
+  IREE_ASSERT_ARGUMENT(out_channel);
+  memset(out_channel, 0, sizeof(*out_channel));
+
+  int32_t rank = 0;
+  int32_t count = 0;
+  iree_hal_channel_query_rank_and_count(base_channel, &rank, &count);
+  if (local_count <= 0 || count % local_count != 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "local count %d must evenly divide the channel "
+                            "participant count %d",
+                            local_count, count);
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, local_count);
+
+  out_channel->local_rank = rank % local_count;
+  out_channel->local_count = local_count;
+  out_channel->node_rank = rank / local_count;
+  out_channel->node_count = count / local_count;
+
+  // Splits are collective and all participants must issue them in the same
+  // order even if the resulting channel will not be used locally.
+  iree_status_t status = iree_ok_status();
+  if (out_channel->local_count > 1) {
+    status = iree_hal_channel_split(
+        base_channel, /*color=*/out_channel->node_rank,
+        /*key=*/out_channel->local_rank, IREE_HAL_CHANNEL_FLAG_NONE,
+        &out_channel->intra_node);
+  }
+  if (iree_status_is_ok(status) && out_channel->node_count > 1) {
+    status = iree_hal_channel_split(
+        base_channel, /*color=*/out_channel->local_rank,
+        /*key=*/out_channel->node_rank, IREE_HAL_CHANNEL_FLAG_NONE,
+        &out_channel->inter_node);
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_hal_hierarchical_channel_deinitialize(out_channel);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_hal_hierarchical_channel_deinitialize(
+    iree_hal_hierarchical_channel_t* channel) {
+  IREE_ASSERT_ARGUMENT(channel);
+  iree_hal_channel_release(channel->inter_node);
+  iree_hal_channel_release(channel->intra_node);
+  memset(channel, 0, sizeof(*channel));
+}
+
+IREE_API_EXPORT bool iree_hal_hierarchical_channel_prefers_all_reduce(
+    const iree_hal_hierarchical_channel_t* channel,
+    iree_device_size_t element_count) {
+  IREE_ASSERT_ARGUMENT(channel);
+  return channel->intra_node && channel->inter_node &&
+         element_count >= (iree_device_size_t)channel->local_count &&
+         element_count % channel->local_count == 0;
+}
+
+// Full barrier between dependent collective stages.
+static iree_status_t iree_hal_hierarchical_channel_barrier(
+    iree_hal_command_buffer_t* command_buffer) {
+  return iree_hal_command_buffer_execution_barrier(
+      command_buffer, IREE_HAL_EXECUTION_STAGE_COMMAND_RETIRE,
+      IREE_HAL_EXECUTION_STAGE_COMMAND_ISSUE,
+      IREE_HAL_EXECUTION_BARRIER_FLAG_NONE, 0, NULL, 0, NULL);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_command_buffer_hierarchical_all_reduce(
+    iree_hal_command_buffer_t* command_buffer,
+    const iree_hal_hierarchical_channel_t* channel,
+    iree_hal_channel_t* base_channel, iree_hal_collective_op_t op,
+    iree_hal_buffer_ref_t send_ref, iree_hal_buffer_ref_t recv_ref,
+    iree_device_size_t element_count) {
+  IREE_ASSERT_ARGUMENT(command_buffer);
+  IREE_ASSERT_ARGUMENT(channel);
+  IREE_ASSERT_ARGUMENT(base_channel);
+  if (op.kind != IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "hierarchical collectives only support all-reduce");
+  }
+
+  // Fall back to the flat channel when the topology doesn't benefit.
+  if (!iree_hal_hierarchical_channel_prefers_all_reduce(channel,
+                                                        element_count)) {
+    return iree_hal_command_buffer_collective(command_buffer, base_channel, op,
+                                              /*param=*/0, send_ref, recv_ref,
+                                              element_count);
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, element_count);
+
+  // Each participant owns one block of the results on its node. The block is
+  // placed at its final location in |recv_ref| so that the all-gather can run
+  // in-place.
+  const iree_device_size_t block_count = element_count / channel->local_count;
+  const iree_device_size_t block_length =
+      block_count * iree_hal_collective_element_byte_count(op.element_type);
+  iree_hal_buffer_ref_t block_ref = recv_ref;
+  block_ref.offset += channel->local_rank * block_length;
+  block_ref.length = block_length;
+
+  // Reduce the full input across the node leaving each participant with the
+  // node-local reduction of its block.
+  iree_hal_collective_op_t reduce_scatter_op = op;
+  reduce_scatter_op.kind = IREE_HAL_COLLECTIVE_KIND_REDUCE_SCATTER;
+  iree_status_t status = iree_hal_command_buffer_collective(
+      command_buffer, channel->intra_node, reduce_scatter_op, /*param=*/0,
+      send_ref, block_ref, block_count);
+
+  // Reduce the block with the participants owning the same block on all other
+  // nodes. Only 1/local_count of the data crosses the inter-node network.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_hierarchical_channel_barrier(command_buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_command_buffer_collective(
+        command_buffer, channel->inter_node, op, /*param=*/0, block_ref,
+        block_ref, block_count);
+  }
+
+  // Gather the fully reduced blocks back to all participants on the node.
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_hierarchical_channel_barrier(command_buffer);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_hal_collective_op_t all_gather_op = op;
+    all_gather_op.kind = IREE_HAL_COLLECTIVE_KIND_ALL_GATHER;
+    all_gather_op.reduction = IREE_HAL_COLLECTIVE_REDUCTION_NONE;
+    status = iree_hal_command_buffer_collective(
+        command_buffer, channel->intra_node, all_gather_op, /*param=*/0,
+        block_ref, recv_ref, block_count);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,83 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_HIERARCHICAL_CHANNEL_H_
+#define IREE_HAL_UTILS_HIERARCHICAL_CHANNEL_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_hierarchical_channel_t
+//===----------------------------------------------------------------------===//
+
+// A two-level decomposition of a channel into ranks sharing a node and ranks
+// sharing a local rank across nodes. Collectives over all ranks can then use
+// the fast intra-node interconnect (NVLink/xGMI) for most of their traffic and
+// only send 1/local_count of the data over the inter-node network.
+//
+// Ranks are expected to be placed on nodes in contiguous blocks such that
+// rank = node_rank * local_count + local_rank (the default placement of
+// mpirun and srun).
+typedef struct iree_hal_hierarchical_channel_t {
+  // Ranks on the same node ordered by local rank. NULL if local_count == 1.
+  iree_hal_channel_t* intra_node;
+  // Ranks with the same local rank ordered by node. NULL if node_count == 1.
+  iree_hal_channel_t* inter_node;
+  // Rank of this participant within its node.
+  int32_t local_rank;
+  // Number of participants on each node.
+  int32_t local_count;
+  // Rank of the node hosting this participant.
+  int32_t node_rank;
+  // Total number of nodes.
+  int32_t node_count;
+} iree_hal_hierarchical_channel_t;
+
+// Initializes |out_channel| by splitting |base_channel| into intra-node and
+// inter-node channels with |local_count| participants per node. |local_count|
+// must evenly divide the participant count of |base_channel|. Splitting is a
+// collective operation and must be performed by all participants.
+IREE_API_EXPORT iree_status_t iree_hal_hierarchical_channel_initialize(
+    iree_hal_channel_t* base_channel, int32_t local_count,
+    iree_hal_hierarchical_channel_t* out_channel);
+
+// Releases the split channels of |channel|.
+IREE_API_EXPORT void iree_hal_hierarchical_channel_deinitialize(
+    iree_hal_hierarchical_channel_t* channel);
+
+// Returns true if an all-reduce of |element_count| elements benefits from the
+// hierarchical decomposition: the participants span more than one node with
+// more than one participant per node and the elements can be evenly split
+// across the participants of each node.
+IREE_API_EXPORT bool iree_hal_hierarchical_channel_prefers_all_reduce(
+    const iree_hal_hierarchical_channel_t* channel,
+    iree_device_size_t element_count);
+
+// Records an all-reduce of |element_count| elements from |send_ref| into
+// |recv_ref| over all participants of |channel|. When profitable this is
+// recorded as an intra-node reduce-scatter, an inter-node all-reduce of the
+// scattered block, and an intra-node all-gather with barriers between each.
+// Otherwise |base_channel| is used for a single flat all-reduce.
+//
+// |op| must be an IREE_HAL_COLLECTIVE_KIND_ALL_REDUCE operation.
+IREE_API_EXPORT iree_status_t
+iree_hal_command_buffer_hierarchical_all_reduce(
+    iree_hal_command_buffer_t* command_buffer,
+    const iree_hal_hierarchical_channel_t* channel,
+    iree_hal_channel_t* base_channel, iree_hal_collective_op_t op,
+    iree_hal_buffer_ref_t send_ref, iree_hal_buffer_ref_t recv_ref,
+    iree_device_size_t element_count);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_HIERARCHICAL_CHANNEL_H_
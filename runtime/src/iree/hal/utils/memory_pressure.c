@@ -0,0 +1,542 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/memory_pressure.h"
+
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+
+// Maximum length of a target name retained for tracing.
+#define IREE_HAL_MEMORY_PRESSURE_MAX_NAME_LENGTH 32
+
+// Maximum length of a cgroup directory path.
+#define IREE_HAL_MEMORY_PRESSURE_MAX_PATH_LENGTH 256
+
+IREE_API_EXPORT iree_string_view_t
+iree_hal_memory_pressure_level_string(iree_hal_memory_pressure_level_t level) {
+  switch (level) {
+    case IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE:
+      return IREE_SV("none");
+    case IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE:
+      return IREE_SV("moderate");
+    case IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL:
+      return IREE_SV("critical");
+    default:
+      return IREE_SV("unknown");
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Sources
+//===----------------------------------------------------------------------===//
+
+typedef enum iree_hal_memory_pressure_source_type_e {
+  IREE_HAL_MEMORY_PRESSURE_SOURCE_TYPE_CGROUP = 0,
+  IREE_HAL_MEMORY_PRESSURE_SOURCE_TYPE_DEVICE,
+} iree_hal_memory_pressure_source_type_t;
+
+// Counters parsed from a cgroup v2 memory.events file.
+typedef struct iree_hal_memory_pressure_cgroup_events_t {
+  uint64_t high;
+  uint64_t max;
+  uint64_t oom;
+  uint64_t oom_kill;
+} iree_hal_memory_pressure_cgroup_events_t;
+
+typedef struct iree_hal_memory_pressure_source_t {
+  iree_hal_memory_pressure_source_type_t type;
+  union {
+    struct {
+      // NUL-terminated path to the memory.events file.
+      char events_path[IREE_HAL_MEMORY_PRESSURE_MAX_PATH_LENGTH];
+      // Counters from the last poll. Pressure is reported when they increase.
+      iree_hal_memory_pressure_cgroup_events_t last_events;
+    } cgroup;
+    struct {
+      // Retained device queried for its free memory.
+      iree_hal_device_t* device;
+      float moderate_free_fraction;
+      float critical_free_fraction;
+    } device;
+  };
+} iree_hal_memory_pressure_source_t;
+
+// Reads the cgroup memory.events file at |events_path| into |out_events|.
+// Returns false if the file could not be read.
+static bool iree_hal_memory_pressure_read_cgroup_events(
+    const char* events_path,
+    iree_hal_memory_pressure_cgroup_events_t* out_events) {
+  memset(out_events, 0, sizeof(*out_events));
+#if IREE_FILE_IO_ENABLE && defined(IREE_PLATFORM_LINUX)
+  FILE* file = fopen(events_path, "r");
+  if (!file) return false;
+  char line[64];
+  while (fgets(line, sizeof(line), file)) {
+    iree_string_view_t key = iree_string_view_empty();
+    iree_string_view_t value = iree_string_view_empty();
+    iree_string_view_split(iree_string_view_trim(iree_make_cstring_view(line)),
+                           ' ', &key, &value);
+    uint64_t* counter = NULL;
+    if (iree_string_view_equal(key, IREE_SV("high"))) {
+      counter = &out_events->high;
+    } else if (iree_string_view_equal(key, IREE_SV("max"))) {
+      counter = &out_events->max;
+    } else if (iree_string_view_equal(key, IREE_SV("oom"))) {
+      counter = &out_events->oom;
+    } else if (iree_string_view_equal(key, IREE_SV("oom_kill"))) {
+      counter = &out_events->oom_kill;
+    }
+    if (counter) iree_string_view_atoi_uint64(value, counter);
+  }
+  fclose(file);
+  return true;
+#else
+  (void)events_path;
+  return false;
+#endif  // IREE_FILE_IO_ENABLE && IREE_PLATFORM_LINUX
+}
+
+// Samples the free and total memory of |device|.
+static iree_status_t iree_hal_memory_pressure_query_device_memory(
+    iree_hal_device_t* device, int64_t* out_free, int64_t* out_total) {
+  IREE_RETURN_IF_ERROR(iree_hal_device_query_i64(
+      device, IREE_SV("hal.device.memory"), IREE_SV("free"), out_free));
+  IREE_RETURN_IF_ERROR(iree_hal_device_query_i64(
+      device, IREE_SV("hal.device.memory"), IREE_SV("total"), out_total));
+  return iree_ok_status();
+}
+
+// Samples |source| and returns the pressure level it reports.
+static iree_status_t iree_hal_memory_pressure_source_poll(
+    iree_hal_memory_pressure_source_t* source,
+    iree_hal_memory_pressure_level_t* out_level) {
+  *out_level = IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE;
+  switch (source->type) {
+    case IREE_HAL_MEMORY_PRESSURE_SOURCE_TYPE_CGROUP: {
+      iree_hal_memory_pressure_cgroup_events_t events;
+      if (!iree_hal_memory_pressure_read_cgroup_events(
+              source->cgroup.events_path, &events)) {
+        return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                                "unable to read cgroup memory events from %s",
+                                source->cgroup.events_path);
+      }
+      const iree_hal_memory_pressure_cgroup_events_t* last_events =
+          &source->cgroup.last_events;
+      if (events.max > last_events->max || events.oom > last_events->oom ||
+          events.oom_kill > last_events->oom_kill) {
+        *out_level = IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL;
+      } else if (events.high > last_events->high) {
+        *out_level = IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE;
+      }
+      source->cgroup.last_events = events;
+      return iree_ok_status();
+    }
+    case IREE_HAL_MEMORY_PRESSURE_SOURCE_TYPE_DEVICE: {
+      int64_t free_size = 0;
+      int64_t total_size = 0;
+      IREE_RETURN_IF_ERROR(iree_hal_memory_pressure_query_device_memory(
+          source->device.device, &free_size, &total_size));
+      if (total_size <= 0) return iree_ok_status();
+      const float free_fraction = (float)free_size / (float)total_size;
+      if (free_fraction < source->device.critical_free_fraction) {
+        *out_level = IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL;
+      } else if (free_fraction < source->device.moderate_free_fraction) {
+        *out_level = IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE;
+      }
+      return iree_ok_status();
+    }
+    default:
+      return iree_make_status(IREE_STATUS_INTERNAL,
+                              "unhandled memory pressure source type");
+  }
+}
+
+static void iree_hal_memory_pressure_source_deinitialize(
+    iree_hal_memory_pressure_source_t* source) {
+  if (source->type == IREE_HAL_MEMORY_PRESSURE_SOURCE_TYPE_DEVICE) {
+    iree_hal_device_release(source->device.device);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_memory_pressure_monitor_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_hal_memory_pressure_target_t {
+  iree_hal_memory_pressure_target_id_t id;
+  iree_hal_memory_pressure_level_t min_level;
+  int32_t priority;
+  iree_hal_memory_pressure_trim_callback_t callback;
+  // Name used in trace messages; not NUL-terminated.
+  iree_host_size_t name_length;
+  char name[IREE_HAL_MEMORY_PRESSURE_MAX_NAME_LENGTH];
+} iree_hal_memory_pressure_target_t;
+
+struct iree_hal_memory_pressure_monitor_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+
+  // Guards all monitor state. Held during trims so that targets cannot be
+  // unregistered while they are being trimmed.
+  iree_slim_mutex_t mutex;
+
+  // ID assigned to the next registered target.
+  iree_hal_memory_pressure_target_id_t next_target_id;
+
+  // Registered targets sorted by ascending priority. Targets with equal
+  // priority are kept in registration order.
+  iree_host_size_t target_count;
+  iree_hal_memory_pressure_target_t
+      targets[IREE_HAL_MEMORY_PRESSURE_MAX_TARGETS];
+
+  iree_host_size_t source_count;
+  iree_hal_memory_pressure_source_t
+      sources[IREE_HAL_MEMORY_PRESSURE_MAX_SOURCES];
+};
+
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_create(
+    iree_allocator_t host_allocator,
+    iree_hal_memory_pressure_monitor_t** out_monitor) {
+  IREE_ASSERT_ARGUMENT(out_monitor);
+  *out_monitor = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_memory_pressure_monitor_t* monitor = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*monitor),
+                                (void**)&monitor));
+  memset(monitor, 0, sizeof(*monitor));
+  iree_atomic_ref_count_init(&monitor->ref_count);
+  monitor->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&monitor->mutex);
+  monitor->next_target_id = 1;
+
+  *out_monitor = monitor;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_hal_memory_pressure_monitor_destroy(
+    iree_hal_memory_pressure_monitor_t* monitor) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = monitor->host_allocator;
+
+  for (iree_host_size_t i = 0; i < monitor->source_count; ++i) {
+    iree_hal_memory_pressure_source_deinitialize(&monitor->sources[i]);
+  }
+  iree_slim_mutex_deinitialize(&monitor->mutex);
+  iree_allocator_free(host_allocator, monitor);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_hal_memory_pressure_monitor_retain(
+    iree_hal_memory_pressure_monitor_t* monitor) {
+  if (IREE_LIKELY(monitor)) {
+    iree_atomic_ref_count_inc(&monitor->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_hal_memory_pressure_monitor_release(
+    iree_hal_memory_pressure_monitor_t* monitor) {
+  if (IREE_LIKELY(monitor) &&
+      iree_atomic_ref_count_dec(&monitor->ref_count) == 1) {
+    iree_hal_memory_pressure_monitor_destroy(monitor);
+  }
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_register(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_level_t min_level, int32_t priority,
+    iree_string_view_t name, iree_hal_memory_pressure_trim_callback_t callback,
+    iree_hal_memory_pressure_target_id_t* out_target_id) {
+  IREE_ASSERT_ARGUMENT(monitor);
+  IREE_ASSERT_ARGUMENT(callback.fn);
+  if (out_target_id) *out_target_id = 0;
+  if (min_level == IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "targets must be trimmed at moderate or critical "
+                            "pressure levels");
+  }
+
+  iree_slim_mutex_lock(&monitor->mutex);
+  if (monitor->target_count + 1 > IREE_ARRAYSIZE(monitor->targets)) {
+    iree_slim_mutex_unlock(&monitor->mutex);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "too many memory pressure targets registered; "
+                            "max %d",
+                            IREE_HAL_MEMORY_PRESSURE_MAX_TARGETS);
+  }
+
+  // Insert after all targets with lower or equal priority.
+  iree_host_size_t index = monitor->target_count;
+  while (index > 0 && monitor->targets[index - 1].priority > priority) {
+    --index;
+  }
+  memmove(&monitor->targets[index + 1], &monitor->targets[index],
+          (monitor->target_count - index) * sizeof(monitor->targets[0]));
+  ++monitor->target_count;
+
+  iree_hal_memory_pressure_target_t* target = &monitor->targets[index];
+  memset(target, 0, sizeof(*target));
+  target->id = monitor->next_target_id++;
+  target->min_level = min_level;
+  target->priority = priority;
+  target->callback = callback;
+  target->name_length = iree_min(name.size, sizeof(target->name));
+  memcpy(target->name, name.data, target->name_length);
+
+  if (out_target_id) *out_target_id = target->id;
+  iree_slim_mutex_unlock(&monitor->mutex);
+  return iree_ok_status();
+}
+
+static iree_status_t iree_hal_memory_pressure_trim_allocator(
+    void* user_data, iree_hal_memory_pressure_level_t level) {
+  return iree_hal_allocator_trim((iree_hal_allocator_t*)user_data);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_memory_pressure_monitor_register_allocator(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_allocator_t* allocator,
+    iree_hal_memory_pressure_target_id_t* out_target_id) {
+  IREE_ASSERT_ARGUMENT(allocator);
+  return iree_hal_memory_pressure_monitor_register(
+      monitor, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE,
+      IREE_HAL_MEMORY_PRESSURE_PRIORITY_ALLOCATOR, IREE_SV("allocator"),
+      (iree_hal_memory_pressure_trim_callback_t){
+          .fn = iree_hal_memory_pressure_trim_allocator,
+          .user_data = allocator,
+      },
+      out_target_id);
+}
+
+static iree_status_t iree_hal_memory_pressure_trim_file_cache(
+    void* user_data, iree_hal_memory_pressure_level_t level) {
+  iree_hal_file_cache_trim((iree_hal_file_cache_t*)user_data);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_memory_pressure_monitor_register_file_cache(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_file_cache_t* file_cache,
+    iree_hal_memory_pressure_target_id_t* out_target_id) {
+  IREE_ASSERT_ARGUMENT(file_cache);
+  return iree_hal_memory_pressure_monitor_register(
+      monitor, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE,
+      IREE_HAL_MEMORY_PRESSURE_PRIORITY_FILE_CACHE, IREE_SV("file_cache"),
+      (iree_hal_memory_pressure_trim_callback_t){
+          .fn = iree_hal_memory_pressure_trim_file_cache,
+          .user_data = file_cache,
+      },
+      out_target_id);
+}
+
+static iree_status_t iree_hal_memory_pressure_trim_device(
+    void* user_data, iree_hal_memory_pressure_level_t level) {
+  return iree_hal_device_trim((iree_hal_device_t*)user_data);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_register_device(
+    iree_hal_memory_pressure_monitor_t* monitor, iree_hal_device_t* device,
+    iree_hal_memory_pressure_target_id_t* out_target_id) {
+  IREE_ASSERT_ARGUMENT(device);
+  return iree_hal_memory_pressure_monitor_register(
+      monitor, IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL,
+      IREE_HAL_MEMORY_PRESSURE_PRIORITY_DEVICE, iree_hal_device_id(device),
+      (iree_hal_memory_pressure_trim_callback_t){
+          .fn = iree_hal_memory_pressure_trim_device,
+          .user_data = device,
+      },
+      out_target_id);
+}
+
+IREE_API_EXPORT void iree_hal_memory_pressure_monitor_unregister(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_target_id_t target_id) {
+  IREE_ASSERT_ARGUMENT(monitor);
+  iree_slim_mutex_lock(&monitor->mutex);
+  for (iree_host_size_t i = 0; i < monitor->target_count; ++i) {
+    if (monitor->targets[i].id != target_id) continue;
+    memmove(&monitor->targets[i], &monitor->targets[i + 1],
+            (monitor->target_count - i - 1) * sizeof(monitor->targets[0]));
+    --monitor->target_count;
+    break;
+  }
+  iree_slim_mutex_unlock(&monitor->mutex);
+}
+
+// Adds |source| to the |monitor| source list.
+static iree_status_t iree_hal_memory_pressure_monitor_add_source(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    const iree_hal_memory_pressure_source_t* source) {
+  iree_slim_mutex_lock(&monitor->mutex);
+  if (monitor->source_count + 1 > IREE_ARRAYSIZE(monitor->sources)) {
+    iree_slim_mutex_unlock(&monitor->mutex);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "too many memory pressure sources; max %d",
+                            IREE_HAL_MEMORY_PRESSURE_MAX_SOURCES);
+  }
+  monitor->sources[monitor->source_count++] = *source;
+  iree_slim_mutex_unlock(&monitor->mutex);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_memory_pressure_monitor_add_cgroup_source(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_string_view_t cgroup_path) {
+  IREE_ASSERT_ARGUMENT(monitor);
+  if (iree_string_view_is_empty(cgroup_path)) {
+    cgroup_path = IREE_SV("/sys/fs/cgroup");
+  }
+
+  iree_hal_memory_pressure_source_t source;
+  memset(&source, 0, sizeof(source));
+  source.type = IREE_HAL_MEMORY_PRESSURE_SOURCE_TYPE_CGROUP;
+  const int path_length =
+      snprintf(source.cgroup.events_path, sizeof(source.cgroup.events_path),
+               "%.*s/memory.events", (int)cgroup_path.size, cgroup_path.data);
+  if (path_length < 0 ||
+      path_length >= (int)sizeof(source.cgroup.events_path)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "cgroup path '%.*s' too long",
+                            (int)cgroup_path.size, cgroup_path.data);
+  }
+
+  // Read the current counters so that only new events are reported.
+  if (!iree_hal_memory_pressure_read_cgroup_events(
+          source.cgroup.events_path, &source.cgroup.last_events)) {
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "unable to read cgroup memory events from %s",
+                            source.cgroup.events_path);
+  }
+
+  return iree_hal_memory_pressure_monitor_add_source(monitor, &source);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_hal_memory_pressure_monitor_add_device_source(
+    iree_hal_memory_pressure_monitor_t* monitor, iree_hal_device_t* device,
+    float moderate_free_fraction, float critical_free_fraction) {
+  IREE_ASSERT_ARGUMENT(monitor);
+  IREE_ASSERT_ARGUMENT(device);
+  if (critical_free_fraction > moderate_free_fraction) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "critical free fraction %f must not exceed moderate free fraction %f",
+        critical_free_fraction, moderate_free_fraction);
+  }
+
+  // Verify the device supports the queries so that failures are reported at
+  // configuration time instead of each poll.
+  int64_t free_size = 0;
+  int64_t total_size = 0;
+  iree_status_t status = iree_hal_memory_pressure_query_device_memory(
+      device, &free_size, &total_size);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    iree_string_view_t device_id = iree_hal_device_id(device);
+    return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                            "device '%.*s' does not support memory queries",
+                            (int)device_id.size, device_id.data);
+  }
+
+  iree_hal_memory_pressure_source_t source;
+  memset(&source, 0, sizeof(source));
+  source.type = IREE_HAL_MEMORY_PRESSURE_SOURCE_TYPE_DEVICE;
+  source.device.device = device;
+  source.device.moderate_free_fraction = moderate_free_fraction;
+  source.device.critical_free_fraction = critical_free_fraction;
+  iree_hal_device_retain(device);
+  status = iree_hal_memory_pressure_monitor_add_source(monitor, &source);
+  if (!iree_status_is_ok(status)) iree_hal_device_release(device);
+  return status;
+}
+
+// Trims all targets for |level|.
+// Must be called with the monitor mutex held.
+static iree_status_t iree_hal_memory_pressure_monitor_trim_locked(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_level_t level) {
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < monitor->target_count; ++i) {
+    iree_hal_memory_pressure_target_t* target = &monitor->targets[i];
+    if (target->min_level > level) continue;
+    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_hal_memory_pressure_trim_target");
+    IREE_TRACE_ZONE_APPEND_TEXT(z1, target->name, target->name_length);
+    IREE_TRACE({
+      char message[96];
+      iree_string_view_t level_name =
+          iree_hal_memory_pressure_level_string(level);
+      int message_length = snprintf(
+          message, sizeof(message), "memory pressure (%.*s): trimming %.*s",
+          (int)level_name.size, level_name.data, (int)target->name_length,
+          target->name);
+      IREE_TRACE_MESSAGE_DYNAMIC(WARNING, message,
+                                 iree_min(message_length,
+                                          (int)sizeof(message) - 1));
+    });
+    status = iree_status_join(status,
+                              target->callback.fn(target->callback.user_data,
+                                                  level));
+    IREE_TRACE_ZONE_END(z1);
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_poll(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_level_t* out_level) {
+  IREE_ASSERT_ARGUMENT(monitor);
+  if (out_level) *out_level = IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&monitor->mutex);
+
+  iree_status_t status = iree_ok_status();
+  iree_hal_memory_pressure_level_t level = IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE;
+  for (iree_host_size_t i = 0; i < monitor->source_count; ++i) {
+    iree_hal_memory_pressure_level_t source_level =
+        IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE;
+    status = iree_hal_memory_pressure_source_poll(&monitor->sources[i],
+                                                  &source_level);
+    if (!iree_status_is_ok(status)) break;
+    level = iree_max(level, source_level);
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, level);
+
+  if (iree_status_is_ok(status) &&
+      level != IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE) {
+    status = iree_hal_memory_pressure_monitor_trim_locked(monitor, level);
+  }
+
+  iree_slim_mutex_unlock(&monitor->mutex);
+
+  if (out_level) *out_level = level;
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_notify(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_level_t level) {
+  IREE_ASSERT_ARGUMENT(monitor);
+  if (level == IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, level);
+  iree_slim_mutex_lock(&monitor->mutex);
+  iree_status_t status =
+      iree_hal_memory_pressure_monitor_trim_locked(monitor, level);
+  iree_slim_mutex_unlock(&monitor->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
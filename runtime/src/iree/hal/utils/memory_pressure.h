@@ -0,0 +1,170 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_MEMORY_PRESSURE_H_
+#define IREE_HAL_UTILS_MEMORY_PRESSURE_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/file_cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// iree_hal_memory_pressure_level_t
+//===----------------------------------------------------------------------===//
+
+// Severity of a memory pressure condition.
+typedef enum iree_hal_memory_pressure_level_e {
+  // No memory pressure; nothing is trimmed.
+  IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE = 0,
+  // Memory is running low and caches that are cheap to repopulate (caching
+  // allocators, file caches) should be released.
+  IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE = 1,
+  // Memory is nearly exhausted and everything not required by live resources
+  // should be released, including device queue and block pools.
+  IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL = 2,
+} iree_hal_memory_pressure_level_t;
+
+// Returns a string name for the given pressure |level| (`none`, etc).
+IREE_API_EXPORT iree_string_view_t
+iree_hal_memory_pressure_level_string(iree_hal_memory_pressure_level_t level);
+
+//===----------------------------------------------------------------------===//
+// iree_hal_memory_pressure_monitor_t
+//===----------------------------------------------------------------------===//
+
+// Maximum number of trim targets that can be registered with a monitor.
+#define IREE_HAL_MEMORY_PRESSURE_MAX_TARGETS 32
+
+// Maximum number of pressure sources that can be added to a monitor.
+#define IREE_HAL_MEMORY_PRESSURE_MAX_SOURCES 8
+
+// Well-known trim priorities. Targets are trimmed in ascending priority order
+// so that the cheapest to repopulate are released first. Any value may be used.
+enum iree_hal_memory_pressure_priority_e {
+  IREE_HAL_MEMORY_PRESSURE_PRIORITY_FILE_CACHE = 100,
+  IREE_HAL_MEMORY_PRESSURE_PRIORITY_ALLOCATOR = 200,
+  IREE_HAL_MEMORY_PRESSURE_PRIORITY_DEVICE = 300,
+};
+
+// Called to release resources in response to memory pressure of |level|.
+typedef struct iree_hal_memory_pressure_trim_callback_t {
+  iree_status_t(IREE_API_PTR* fn)(void* user_data,
+                                  iree_hal_memory_pressure_level_t level);
+  void* user_data;
+} iree_hal_memory_pressure_trim_callback_t;
+
+// Identifies a registered trim target for unregistration.
+typedef uint32_t iree_hal_memory_pressure_target_id_t;
+
+// Tracks memory pressure from one or more sources (cgroup memory events,
+// device memory budgets) and trims registered targets in priority order when
+// pressure is observed. Each trim is reported as a tracing message.
+//
+// Monitors do not spawn threads: hosting applications call
+// iree_hal_memory_pressure_monitor_poll periodically (or from their own OS
+// low-memory notification) or directly notify with a known pressure level.
+//
+// Registered targets are not retained and must remain live until they are
+// unregistered or the monitor is released.
+//
+// Thread-safe: registration, polling, and notification may happen from
+// multiple threads. Trim callbacks are issued with an internal lock held and
+// must not call back into the monitor.
+typedef struct iree_hal_memory_pressure_monitor_t
+    iree_hal_memory_pressure_monitor_t;
+
+// Creates a new memory pressure monitor with no sources or targets.
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_create(
+    iree_allocator_t host_allocator,
+    iree_hal_memory_pressure_monitor_t** out_monitor);
+
+// Retains the given |monitor| for the caller.
+IREE_API_EXPORT void iree_hal_memory_pressure_monitor_retain(
+    iree_hal_memory_pressure_monitor_t* monitor);
+
+// Releases the given |monitor| from the caller.
+IREE_API_EXPORT void iree_hal_memory_pressure_monitor_release(
+    iree_hal_memory_pressure_monitor_t* monitor);
+
+// Registers a trim |callback| issued when pressure of at least |min_level| is
+// observed. Targets are trimmed in ascending |priority| order.
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_register(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_level_t min_level, int32_t priority,
+    iree_string_view_t name, iree_hal_memory_pressure_trim_callback_t callback,
+    iree_hal_memory_pressure_target_id_t* out_target_id);
+
+// Registers |allocator| to be trimmed with iree_hal_allocator_trim under
+// moderate or higher pressure. Caching allocators release all free buffers.
+IREE_API_EXPORT iree_status_t
+iree_hal_memory_pressure_monitor_register_allocator(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_allocator_t* allocator,
+    iree_hal_memory_pressure_target_id_t* out_target_id);
+
+// Registers |file_cache| to be trimmed with iree_hal_file_cache_trim under
+// moderate or higher pressure.
+IREE_API_EXPORT iree_status_t
+iree_hal_memory_pressure_monitor_register_file_cache(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_file_cache_t* file_cache,
+    iree_hal_memory_pressure_target_id_t* out_target_id);
+
+// Registers |device| to be trimmed with iree_hal_device_trim under critical
+// pressure. This releases queue pools, block pools, and the device allocator
+// caches and is more expensive to recover from than allocator trims.
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_register_device(
+    iree_hal_memory_pressure_monitor_t* monitor, iree_hal_device_t* device,
+    iree_hal_memory_pressure_target_id_t* out_target_id);
+
+// Unregisters a target previously registered with |target_id|.
+IREE_API_EXPORT void iree_hal_memory_pressure_monitor_unregister(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_target_id_t target_id);
+
+// Adds a Linux cgroup v2 source reading `memory.events` from |cgroup_path|
+// (defaults to `/sys/fs/cgroup` when empty). Increases in the `high` counter
+// since the last poll are reported as moderate pressure and increases in the
+// `max`, `oom`, or `oom_kill` counters as critical pressure.
+// Returns IREE_STATUS_UNAVAILABLE if the events file cannot be read.
+IREE_API_EXPORT iree_status_t
+iree_hal_memory_pressure_monitor_add_cgroup_source(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_string_view_t cgroup_path);
+
+// Adds a source sampling the free device memory of |device| through the
+// `hal.device.memory :: free` and `hal.device.memory :: total` queries (backed
+// by cuMemGetInfo on CUDA). Free memory below |moderate_free_fraction| or
+// |critical_free_fraction| of the total is reported as the respective pressure
+// level. The device is retained by the monitor.
+// Returns IREE_STATUS_UNAVAILABLE if the device does not support the queries.
+IREE_API_EXPORT iree_status_t
+iree_hal_memory_pressure_monitor_add_device_source(
+    iree_hal_memory_pressure_monitor_t* monitor, iree_hal_device_t* device,
+    float moderate_free_fraction, float critical_free_fraction);
+
+// Samples all sources and trims targets if any source reports pressure.
+// The highest level reported by any source is returned in |out_level|.
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_poll(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_level_t* out_level);
+
+// Trims all targets registered for |level| or lower in priority order.
+// Can be used to forward OS low-memory notifications. All targets are trimmed
+// even if one fails and the first failure is returned.
+IREE_API_EXPORT iree_status_t iree_hal_memory_pressure_monitor_notify(
+    iree_hal_memory_pressure_monitor_t* monitor,
+    iree_hal_memory_pressure_level_t level);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_MEMORY_PRESSURE_H_
@@ -0,0 +1,142 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/memory_pressure.h"
+
+#include <string>
+#include <vector>
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Records the name of each trimmed target in the order trimmed.
+struct TrimLog {
+  std::vector<std::string> trims;
+};
+
+struct TestTarget {
+  TrimLog* log;
+  std::string name;
+  iree_status_code_t result = IREE_STATUS_OK;
+};
+
+static iree_status_t RecordTrim(void* user_data,
+                                iree_hal_memory_pressure_level_t level) {
+  auto* target = reinterpret_cast<TestTarget*>(user_data);
+  target->log->trims.push_back(target->name);
+  return iree_status_from_code(target->result);
+}
+
+class MemoryPressureMonitorTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_memory_pressure_monitor_create(
+        iree_allocator_system(), &monitor_));
+  }
+
+  void TearDown() override {
+    iree_hal_memory_pressure_monitor_release(monitor_);
+  }
+
+  iree_hal_memory_pressure_target_id_t Register(
+      TestTarget* target, iree_hal_memory_pressure_level_t min_level,
+      int32_t priority) {
+    iree_hal_memory_pressure_target_id_t target_id = 0;
+    IREE_EXPECT_OK(iree_hal_memory_pressure_monitor_register(
+        monitor_, min_level, priority,
+        iree_make_string_view(target->name.data(), target->name.size()),
+        {RecordTrim, target}, &target_id));
+    return target_id;
+  }
+
+  iree_hal_memory_pressure_monitor_t* monitor_ = NULL;
+  TrimLog log_;
+};
+
+TEST_F(MemoryPressureMonitorTest, NoTargets) {
+  IREE_EXPECT_OK(iree_hal_memory_pressure_monitor_notify(
+      monitor_, IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL));
+  iree_hal_memory_pressure_level_t level = IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE;
+  IREE_EXPECT_OK(iree_hal_memory_pressure_monitor_poll(monitor_, &level));
+  EXPECT_EQ(level, IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE);
+}
+
+TEST_F(MemoryPressureMonitorTest, TrimsInPriorityOrder) {
+  TestTarget device = {&log_, "device"};
+  TestTarget allocator_a = {&log_, "allocator_a"};
+  TestTarget file_cache = {&log_, "file_cache"};
+  TestTarget allocator_b = {&log_, "allocator_b"};
+  Register(&device, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 300);
+  Register(&allocator_a, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 200);
+  Register(&file_cache, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 100);
+  Register(&allocator_b, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 200);
+  IREE_EXPECT_OK(iree_hal_memory_pressure_monitor_notify(
+      monitor_, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE));
+  EXPECT_THAT(log_.trims, ElementsAre("file_cache", "allocator_a",
+                                      "allocator_b", "device"));
+}
+
+TEST_F(MemoryPressureMonitorTest, TrimsByLevel) {
+  TestTarget cache = {&log_, "cache"};
+  TestTarget pools = {&log_, "pools"};
+  Register(&cache, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 100);
+  Register(&pools, IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL, 300);
+
+  IREE_EXPECT_OK(iree_hal_memory_pressure_monitor_notify(
+      monitor_, IREE_HAL_MEMORY_PRESSURE_LEVEL_NONE));
+  EXPECT_THAT(log_.trims, IsEmpty());
+
+  IREE_EXPECT_OK(iree_hal_memory_pressure_monitor_notify(
+      monitor_, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE));
+  EXPECT_THAT(log_.trims, ElementsAre("cache"));
+
+  log_.trims.clear();
+  IREE_EXPECT_OK(iree_hal_memory_pressure_monitor_notify(
+      monitor_, IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL));
+  EXPECT_THAT(log_.trims, ElementsAre("cache", "pools"));
+}
+
+TEST_F(MemoryPressureMonitorTest, Unregister) {
+  TestTarget a = {&log_, "a"};
+  TestTarget b = {&log_, "b"};
+  iree_hal_memory_pressure_target_id_t a_id =
+      Register(&a, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 100);
+  Register(&b, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 100);
+  iree_hal_memory_pressure_monitor_unregister(monitor_, a_id);
+  IREE_EXPECT_OK(iree_hal_memory_pressure_monitor_notify(
+      monitor_, IREE_HAL_MEMORY_PRESSURE_LEVEL_CRITICAL));
+  EXPECT_THAT(log_.trims, ElementsAre("b"));
+}
+
+TEST_F(MemoryPressureMonitorTest, TrimFailureStillTrimsAll) {
+  TestTarget failing = {&log_, "failing", IREE_STATUS_INTERNAL};
+  TestTarget other = {&log_, "other"};
+  Register(&failing, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 100);
+  Register(&other, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE, 200);
+  EXPECT_THAT(Status(iree_hal_memory_pressure_monitor_notify(
+                  monitor_, IREE_HAL_MEMORY_PRESSURE_LEVEL_MODERATE)),
+              StatusIs(StatusCode::kInternal));
+  EXPECT_THAT(log_.trims, ElementsAre("failing", "other"));
+}
+
+TEST_F(MemoryPressureMonitorTest, MissingCgroupSource) {
+  EXPECT_THAT(Status(iree_hal_memory_pressure_monitor_add_cgroup_source(
+                  monitor_, IREE_SV("/nonexistent/cgroup"))),
+              StatusIs(StatusCode::kUnavailable));
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
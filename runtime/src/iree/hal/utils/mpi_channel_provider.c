@@ -28,6 +28,47 @@ IREE_API_EXPORT bool iree_hal_mpi_is_configured(void) {
          iree_hal_mpi_env_is_set("MPIEXEC_HOSTNAME");
 }
 
+// Parses a non-negative integer from the environment variable |var_name|.
+static bool iree_hal_mpi_env_parse_int32(const char* var_name,
+                                         int32_t* out_value) {
+  const char* var_value = getenv(var_name);
+  if (!var_value || strlen(var_value) == 0) return false;
+  int32_t value = 0;
+  if (!iree_string_view_atoi_int32(iree_make_cstring_view(var_value),
+                                   &value) ||
+      value < 0) {
+    return false;
+  }
+  *out_value = value;
+  return true;
+}
+
+IREE_API_EXPORT bool iree_hal_mpi_query_local_rank_and_count(
+    int32_t* out_local_rank, int32_t* out_local_count) {
+  IREE_ASSERT_ARGUMENT(out_local_rank);
+  IREE_ASSERT_ARGUMENT(out_local_count);
+  *out_local_rank = 0;
+  *out_local_count = 1;
+  // Pairs of (local rank, local count) variables set by common launchers.
+  static const char* const var_names[][2] = {
+      {"OMPI_COMM_WORLD_LOCAL_RANK", "OMPI_COMM_WORLD_LOCAL_SIZE"},
+      {"MPI_LOCALRANKID", "MPI_LOCALNRANKS"},
+      {"SLURM_LOCALID", "SLURM_NTASKS_PER_NODE"},
+  };
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(var_names); ++i) {
+    int32_t local_rank = 0;
+    int32_t local_count = 0;
+    if (iree_hal_mpi_env_parse_int32(var_names[i][0], &local_rank) &&
+        iree_hal_mpi_env_parse_int32(var_names[i][1], &local_count) &&
+        local_rank < local_count) {
+      *out_local_rank = local_rank;
+      *out_local_count = local_count;
+      return true;
+    }
+  }
+  return false;
+}
+
 typedef struct iree_hal_mpi_channel_provider_t {
   iree_hal_resource_t resource;
   iree_allocator_t host_allocator;
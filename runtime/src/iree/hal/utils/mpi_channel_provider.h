@@ -21,6 +21,13 @@ typedef struct iree_hal_mpi_dynamic_symbols_t iree_hal_mpi_dynamic_symbols_t;
 // when running under mpirun.
 IREE_API_EXPORT bool iree_hal_mpi_is_configured(void);
 
+// Queries the rank of this process among the processes on the same node and
+// the number of processes per node from the environment set by the MPI
+// launcher (OpenMPI, MPICH/Intel MPI, or Slurm). Returns false if the launcher
+// does not provide the information.
+IREE_API_EXPORT bool iree_hal_mpi_query_local_rank_and_count(
+    int32_t* out_local_rank, int32_t* out_local_count);
+
 // Creates an MPI-based collective channel provider.
 // On creation the provider will initialize MPI with MPI_Init and on destruction
 // will finalize MPI with MPI_Finalize after which time MPI can never be used in
@@ -6,6 +6,8 @@
 
 #include "iree/hal/utils/resource_set.h"
 
+#include <stdlib.h>
+
 #include "iree/base/internal/debugging.h"
 
 // Computes the total capacity in resources of a chunk allocated with a total
@@ -19,6 +21,13 @@ static uint16_t iree_hal_resource_set_chunk_capacity(
 
 IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate(
     iree_arena_block_pool_t* block_pool, iree_hal_resource_set_t** out_set) {
+  return iree_hal_resource_set_allocate_with_flags(
+      block_pool, IREE_HAL_RESOURCE_SET_FLAG_NONE, out_set);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate_with_flags(
+    iree_arena_block_pool_t* block_pool, iree_hal_resource_set_flags_t flags,
+    iree_hal_resource_set_t** out_set) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // We could allow larger sizes (would require widening the capacity/count
@@ -33,6 +42,7 @@ IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate(
       z0, iree_arena_block_pool_acquire(block_pool, &block, (void**)&set));
   memset(set, 0, sizeof(*set));
   set->block_pool = block_pool;
+  set->flags = flags;
 
   // Inline the first chunk into the block using all of the remaining space.
   // This is a special case chunk that is released back to the pool with the
@@ -274,18 +284,101 @@ static iree_status_t iree_hal_resource_set_insert_1(
   return iree_ok_status();
 }
 
+// Returns true if |resource| is in the |set| MRU. The MRU order is unchanged.
+static bool iree_hal_resource_set_mru_contains(iree_hal_resource_set_t* set,
+                                               iree_hal_resource_t* resource) {
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(set->mru); ++i) {
+    if (set->mru[i] == resource) return true;
+  }
+  return false;
+}
+
+static int iree_hal_resource_set_compare_resources(const void* lhs,
+                                                   const void* rhs) {
+  const uintptr_t lhs_ptr = *(const uintptr_t*)lhs;
+  const uintptr_t rhs_ptr = *(const uintptr_t*)rhs;
+  return lhs_ptr < rhs_ptr ? -1 : (lhs_ptr > rhs_ptr ? 1 : 0);
+}
+
+// Inserts a batch of at most IREE_HAL_RESOURCE_SET_BULK_BATCH_SIZE resources.
+static iree_status_t iree_hal_resource_set_insert_batch(
+    iree_hal_resource_set_t* set, iree_host_size_t count,
+    iree_hal_resource_t* const* resources) {
+  IREE_ASSERT_LE(count, IREE_HAL_RESOURCE_SET_BULK_BATCH_SIZE);
+
+  // Gather all resources that are not already known to be in the set.
+  iree_hal_resource_t* batch[IREE_HAL_RESOURCE_SET_BULK_BATCH_SIZE];
+  iree_host_size_t batch_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_hal_resource_t* resource = resources[i];
+    if (!resource || iree_hal_resource_set_mru_contains(set, resource)) {
+      continue;
+    }
+    batch[batch_count++] = resource;
+  }
+
+  // Sort so that duplicates are adjacent and retain each unique resource once.
+  if (batch_count > 1) {
+    qsort(batch, batch_count, sizeof(batch[0]),
+          iree_hal_resource_set_compare_resources);
+  }
+  for (iree_host_size_t i = 0; i < batch_count; ++i) {
+    if (i > 0 && batch[i] == batch[i - 1]) continue;
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_retain(set, batch[i]));
+  }
+
+  // Seed the MRU with the most recently used resources from the batch so that
+  // subsequent insertions of them hit. All have been retained by now.
+  const iree_host_size_t mru_count = iree_min(count, IREE_ARRAYSIZE(set->mru));
+  for (iree_host_size_t i = count - mru_count; i < count; ++i) {
+    iree_hal_resource_t* resource = resources[i];
+    if (!resource || iree_hal_resource_set_mru_contains(set, resource)) {
+      continue;
+    }
+    memmove(&set->mru[1], &set->mru[0],
+            sizeof(set->mru[0]) * (IREE_ARRAYSIZE(set->mru) - 1));
+    set->mru[0] = resource;
+  }
+
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t
 iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
                              iree_host_size_t count, const void* resources) {
   IREE_ASSERT_ARGUMENT(set);
+  if (count > 2 * IREE_HAL_RESOURCE_SET_MRU_SIZE) {
+    return iree_hal_resource_set_insert_bulk(set, count, resources);
+  }
   return iree_hal_resource_set_insert_strided(set, count, resources, 0,
                                               sizeof(iree_hal_resource_t*));
 }
 
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_insert_bulk(
+    iree_hal_resource_set_t* set, iree_host_size_t count,
+    const void* resources) {
+  IREE_ASSERT_ARGUMENT(set);
+  if (iree_all_bits_set(set->flags, IREE_HAL_RESOURCE_SET_FLAG_BORROWED)) {
+    return iree_ok_status();
+  }
+  iree_hal_resource_t* const* resource_ptrs =
+      (iree_hal_resource_t* const*)resources;
+  for (iree_host_size_t i = 0; i < count;
+       i += IREE_HAL_RESOURCE_SET_BULK_BATCH_SIZE) {
+    IREE_RETURN_IF_ERROR(iree_hal_resource_set_insert_batch(
+        set, iree_min(count - i, IREE_HAL_RESOURCE_SET_BULK_BATCH_SIZE),
+        resource_ptrs + i));
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_hal_resource_set_insert_strided(
     iree_hal_resource_set_t* set, iree_host_size_t count, const void* elements,
     iree_host_size_t offset, iree_host_size_t stride) {
   IREE_ASSERT_ARGUMENT(set);
+  if (iree_all_bits_set(set->flags, IREE_HAL_RESOURCE_SET_FLAG_BORROWED)) {
+    return iree_ok_status();
+  }
   // For now we process one at a time. We should have a stride that lets us
   // amortize the cost of doing the MRU update and insertion allocation by
   // say slicing off 4/8/16/32 resources at a time etc. Today each miss that
@@ -54,6 +54,20 @@ typedef struct iree_hal_resource_set_chunk_t {
 #define IREE_HAL_RESOURCE_SET_MRU_SIZE \
   (iree_hardware_constructive_interference_size / sizeof(uintptr_t))
 
+// Controls resource set behavior.
+enum iree_hal_resource_set_flag_bits_t {
+  IREE_HAL_RESOURCE_SET_FLAG_NONE = 0u,
+  // Resources inserted into the set are borrowed and not retained. The caller
+  // guarantees that all resources outlive the set (and whatever is using the
+  // set to track lifetime, such as a command buffer). Insertions become no-ops.
+  IREE_HAL_RESOURCE_SET_FLAG_BORROWED = 1u << 0,
+};
+typedef uint32_t iree_hal_resource_set_flags_t;
+
+// Maximum number of resources deduplicated at a time by bulk insertion.
+// Batches are sorted on the stack so this bounds stack usage.
+#define IREE_HAL_RESOURCE_SET_BULK_BATCH_SIZE 256
+
 // "Efficient" append-only set for retaining a set of resources.
 // This is a non-deterministic data structure that tries to reduce the amount of
 // overhead involved in tracking a reasonably-sized set of resources (~dozens to
@@ -97,6 +111,9 @@ typedef struct iree_hal_resource_set_t {
   // Block pool used for allocating additional set storage slabs.
   iree_arena_block_pool_t* block_pool;
 
+  // Flags controlling set behavior.
+  iree_hal_resource_set_flags_t flags;
+
   // Linked list of storage chunks.
   iree_hal_resource_set_chunk_t* chunk_head;
 } iree_hal_resource_set_t;
@@ -110,6 +127,11 @@ typedef struct iree_hal_resource_set_t {
 IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate(
     iree_arena_block_pool_t* block_pool, iree_hal_resource_set_t** out_set);
 
+// Allocates a new resource from the given |block_pool| with the given |flags|.
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_allocate_with_flags(
+    iree_arena_block_pool_t* block_pool, iree_hal_resource_set_flags_t flags,
+    iree_hal_resource_set_t** out_set);
+
 // Frees a resource set and releases all inserted resources.
 // The |set| itself will be returned back to the block pool it was allocated
 // from.
@@ -123,10 +145,25 @@ IREE_API_EXPORT void iree_hal_resource_set_freeze(iree_hal_resource_set_t* set);
 // Inserts zero or more resources into the set.
 // Each resource will be retained for at least the lifetime of the set.
 // Entries will be ignored if NULL.
+//
+// Large insertions are routed to iree_hal_resource_set_insert_bulk.
 IREE_API_EXPORT iree_status_t
 iree_hal_resource_set_insert(iree_hal_resource_set_t* set,
                              iree_host_size_t count, const void* resources);
 
+// Inserts zero or more resources into the set in batches.
+// Each resource will be retained for at least the lifetime of the set.
+// Entries will be ignored if NULL.
+//
+// Instead of checking and updating the MRU per resource each batch of up to
+// IREE_HAL_RESOURCE_SET_BULK_BATCH_SIZE resources is sorted and deduplicated
+// so that every unique resource in the batch is retained once. This is
+// preferred when inserting many resources at once such as all of the buffers
+// referenced by a command buffer.
+IREE_API_EXPORT iree_status_t iree_hal_resource_set_insert_bulk(
+    iree_hal_resource_set_t* set, iree_host_size_t count,
+    const void* resources);
+
 // Inserts zero or more resources into the set from a user-defined data
 // structure. Each resource will be retained for at least the lifetime of the
 // set. Entries will be ignored if NULL.
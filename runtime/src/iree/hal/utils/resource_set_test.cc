@@ -10,6 +10,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
@@ -285,6 +286,67 @@ TEST_F(ResourceSetTest, RedundantInsertion) {
   EXPECT_EQ(live_bitmap, 0u);
 }
 
+// Tests that bulk insertion retains each unique resource exactly once even
+// when the input contains duplicates and NULL entries.
+TEST_F(ResourceSetTest, BulkInsertionDeduplicates) {
+  auto resource_set = make_resource_set(&block_pool);
+  uint32_t live_bitmap = 0u;
+  iree_hal_resource_t* resources[32] = {NULL};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    IREE_ASSERT_OK(iree_hal_test_resource_create(i, &live_bitmap,
+                                                 host_allocator, &resources[i]));
+  }
+
+  // Interleave each resource several times with some NULLs mixed in.
+  std::vector<iree_hal_resource_t*> batch;
+  for (int round = 0; round < 4; ++round) {
+    for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+      batch.push_back(resources[(i * 7 + round) % IREE_ARRAYSIZE(resources)]);
+      if (i % 5 == 0) batch.push_back(NULL);
+    }
+  }
+  IREE_ASSERT_OK(iree_hal_resource_set_insert_bulk(
+      resource_set.get(), batch.size(), batch.data()));
+
+  // Each resource should have been retained once by the set.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    EXPECT_EQ(iree_atomic_ref_count_load(&resources[i]->ref_count), 2);
+  }
+
+  // Release all of the resources - they should still be owned by the set.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    iree_hal_resource_release(resources[i]);
+  }
+  EXPECT_EQ(live_bitmap, 0xFFFFFFFFu);
+
+  // Ensure the set releases the resources.
+  resource_set.reset();
+  EXPECT_EQ(live_bitmap, 0u);
+}
+
+// Tests that borrowed sets do not retain inserted resources.
+TEST_F(ResourceSetTest, BorrowedInsertion) {
+  iree_hal_resource_set_t* resource_set = NULL;
+  IREE_ASSERT_OK(iree_hal_resource_set_allocate_with_flags(
+      &block_pool, IREE_HAL_RESOURCE_SET_FLAG_BORROWED, &resource_set));
+  uint32_t live_bitmap = 0u;
+  iree_hal_resource_t* resources[5] = {NULL};
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    IREE_ASSERT_OK(iree_hal_test_resource_create(i, &live_bitmap,
+                                                 host_allocator, &resources[i]));
+  }
+  IREE_ASSERT_OK(iree_hal_resource_set_insert(
+      resource_set, IREE_ARRAYSIZE(resources), resources));
+
+  // The caller is the only owner so releasing destroys the resources.
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(resources); ++i) {
+    iree_hal_resource_release(resources[i]);
+  }
+  EXPECT_EQ(live_bitmap, 0u);
+
+  iree_hal_resource_set_free(resource_set);
+}
+
 }  // namespace
 }  // namespace hal
 }  // namespace iree
@@ -195,6 +195,7 @@ IREE_API_EXPORT void iree_hal_semaphore_initialize(
   iree_slim_mutex_initialize(&out_semaphore->timepoint_mutex);
   memset(&out_semaphore->timepoint_list, 0,
          sizeof(out_semaphore->timepoint_list));
+  out_semaphore->wait_requires_caller = false;
 }
 
 IREE_API_EXPORT void iree_hal_semaphore_deinitialize(
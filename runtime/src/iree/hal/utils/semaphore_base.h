@@ -103,6 +103,13 @@ struct iree_hal_semaphore_t {
   // counts (0..1) it's not worth the complexity today.
   iree_hal_semaphore_timepoint_list_t timepoint_list
       IREE_GUARDED_BY(timepoint_mutex);
+
+  // True if the semaphore only makes progress while a thread is blocked in
+  // iree_hal_semaphore_wait on it (such as when waits donate the caller to a
+  // threadless executor). Timepoints on such semaphores are only resolved once
+  // something else waits on them and utilities that wait solely on timepoints
+  // must wait on them directly instead.
+  bool wait_requires_caller;
 };
 
 // Initializes the base |out_semaphore| resource.
@@ -0,0 +1,212 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/semaphore_wait.h"
+
+#include "iree/base/internal/synchronization.h"
+#include "iree/hal/utils/semaphore_base.h"
+
+// Number of timepoints stored on the stack before spilling to the heap.
+// Multi-device joins are usually across a handful of devices.
+#define IREE_HAL_SEMAPHORE_WAIT_INLINE_CAPACITY 16
+
+// Shared state between the waiting thread and all timepoint callbacks.
+typedef struct iree_hal_semaphore_wait_state_t {
+  // Held by callbacks while they update the state and post the notification so
+  // that the waiter can't return (and free the state) while one is in-flight.
+  iree_slim_mutex_t mutex;
+  // Number of timepoints that have not yet resolved.
+  iree_host_size_t pending_count IREE_GUARDED_BY(mutex);
+  // First non-OK status code received from a timepoint.
+  iree_status_code_t status_code IREE_GUARDED_BY(mutex);
+  // Semaphore that reported |status_code|, used to fetch the full status.
+  iree_hal_semaphore_t* failed_semaphore IREE_GUARDED_BY(mutex);
+  // Posted each time a timepoint resolves.
+  iree_notification_t notification;
+} iree_hal_semaphore_wait_state_t;
+
+static iree_status_t iree_hal_semaphore_wait_state_resolve(
+    void* user_data, iree_hal_semaphore_t* semaphore, uint64_t value,
+    iree_status_code_t status_code) {
+  iree_hal_semaphore_wait_state_t* state =
+      (iree_hal_semaphore_wait_state_t*)user_data;
+  iree_slim_mutex_lock(&state->mutex);
+  if (status_code != IREE_STATUS_OK &&
+      state->status_code == IREE_STATUS_OK) {
+    state->status_code = status_code;
+    state->failed_semaphore = semaphore;
+  }
+  --state->pending_count;
+  iree_notification_post(&state->notification, IREE_ALL_WAITERS);
+  iree_slim_mutex_unlock(&state->mutex);
+  return iree_ok_status();
+}
+
+static bool iree_hal_semaphore_wait_state_is_resolved(void* arg) {
+  iree_hal_semaphore_wait_state_t* state =
+      (iree_hal_semaphore_wait_state_t*)arg;
+  iree_slim_mutex_lock(&state->mutex);
+  bool is_resolved =
+      state->pending_count == 0 || state->status_code != IREE_STATUS_OK;
+  iree_slim_mutex_unlock(&state->mutex);
+  return is_resolved;
+}
+
+// Acquires a timepoint on each of the |pending_count| unreached semaphores in
+// |semaphore_list| and blocks until all resolve, one fails, or |timeout|.
+static iree_status_t iree_hal_semaphore_list_wait_timepoints(
+    const iree_hal_semaphore_list_t semaphore_list,
+    iree_host_size_t pending_count, iree_timeout_t timeout,
+    iree_allocator_t host_allocator) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, pending_count);
+
+  iree_hal_semaphore_timepoint_t
+      inline_timepoints[IREE_HAL_SEMAPHORE_WAIT_INLINE_CAPACITY];
+  iree_hal_semaphore_timepoint_t* timepoints = inline_timepoints;
+  if (pending_count > IREE_HAL_SEMAPHORE_WAIT_INLINE_CAPACITY) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(host_allocator,
+                                  pending_count * sizeof(timepoints[0]),
+                                  (void**)&timepoints));
+  }
+  memset(timepoints, 0, pending_count * sizeof(timepoints[0]));
+
+  iree_hal_semaphore_wait_state_t state;
+  iree_slim_mutex_initialize(&state.mutex);
+  state.pending_count = pending_count;
+  state.status_code = IREE_STATUS_OK;
+  state.failed_semaphore = NULL;
+  iree_notification_initialize(&state.notification);
+
+  // Reached semaphores were already filtered out and those reached since will
+  // resolve their timepoints immediately (or on the poll below).
+  iree_host_size_t timepoint_count = 0;
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = semaphore_list.semaphores[i];
+    if (!semaphore) continue;
+    iree_hal_semaphore_acquire_timepoint(
+        semaphore, semaphore_list.payload_values[i], timeout,
+        (iree_hal_semaphore_callback_t){
+            .fn = iree_hal_semaphore_wait_state_resolve,
+            .user_data = &state,
+        },
+        &timepoints[timepoint_count++]);
+  }
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    if (semaphore_list.semaphores[i]) {
+      iree_hal_semaphore_poll(semaphore_list.semaphores[i]);
+    }
+  }
+
+  // Block once for all semaphores.
+  bool did_resolve = iree_notification_await(
+      &state.notification, iree_hal_semaphore_wait_state_is_resolved, &state,
+      timeout);
+
+  // Cancel any timepoints that have not yet resolved. Cancellation of resolved
+  // timepoints is a no-op.
+  for (iree_host_size_t i = 0, j = 0; i < semaphore_list.count; ++i) {
+    if (!semaphore_list.semaphores[i]) continue;
+    iree_hal_semaphore_cancel_timepoint(semaphore_list.semaphores[i],
+                                        &timepoints[j++]);
+  }
+
+  // Wait for any callback still holding the state before dropping it.
+  iree_slim_mutex_lock(&state.mutex);
+  iree_status_code_t status_code = state.status_code;
+  iree_hal_semaphore_t* failed_semaphore = state.failed_semaphore;
+  iree_slim_mutex_unlock(&state.mutex);
+  iree_notification_deinitialize(&state.notification);
+  iree_slim_mutex_deinitialize(&state.mutex);
+  if (timepoints != inline_timepoints) {
+    iree_allocator_free(host_allocator, timepoints);
+  }
+
+  iree_status_t status = iree_ok_status();
+  if (!did_resolve || status_code == IREE_STATUS_DEADLINE_EXCEEDED) {
+    status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+  } else if (status_code != IREE_STATUS_OK) {
+    // Query the semaphore to get the full failure status.
+    uint64_t value = 0;
+    status = iree_hal_semaphore_query(failed_semaphore, &value);
+    if (iree_status_is_ok(status)) {
+      status = iree_make_status(status_code, "semaphore wait failed");
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_list_wait_coalesced(
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
+    iree_allocator_t host_allocator) {
+  if (!semaphore_list.count) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, semaphore_list.count);
+
+  // Ensure an absolute timeout so that the caller-driven waits below don't
+  // drift from the user-intended relative timeout.
+  iree_convert_timeout_to_absolute(&timeout);
+
+  // Wait on semaphores that need the caller to make progress and gather the
+  // ones that are still pending. Reached semaphores are masked out of a local
+  // copy of the list so that no timepoints are acquired for them.
+  iree_hal_semaphore_t* inline_semaphores
+      [IREE_HAL_SEMAPHORE_WAIT_INLINE_CAPACITY];
+  iree_hal_semaphore_list_t pending_list = {
+      .count = semaphore_list.count,
+      .semaphores = inline_semaphores,
+      .payload_values = semaphore_list.payload_values,
+  };
+  if (semaphore_list.count > IREE_HAL_SEMAPHORE_WAIT_INLINE_CAPACITY) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_allocator_malloc(
+                host_allocator,
+                semaphore_list.count * sizeof(pending_list.semaphores[0]),
+                (void**)&pending_list.semaphores));
+  }
+  iree_host_size_t pending_count = 0;
+  iree_host_size_t last_pending_index = 0;
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < semaphore_list.count; ++i) {
+    iree_hal_semaphore_t* semaphore = semaphore_list.semaphores[i];
+    pending_list.semaphores[i] = NULL;
+    if (semaphore->wait_requires_caller) {
+      status = iree_hal_semaphore_wait(
+          semaphore, semaphore_list.payload_values[i], timeout);
+    } else {
+      uint64_t current_value = 0;
+      status = iree_hal_semaphore_query(semaphore, &current_value);
+      if (iree_status_is_ok(status) &&
+          current_value < semaphore_list.payload_values[i]) {
+        pending_list.semaphores[i] = semaphore;
+        last_pending_index = i;
+        ++pending_count;
+      }
+    }
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  if (iree_status_is_ok(status)) {
+    if (pending_count == 1) {
+      // Nothing to coalesce; use the implementation wait as it may be faster.
+      status = iree_hal_semaphore_wait(
+          semaphore_list.semaphores[last_pending_index],
+          semaphore_list.payload_values[last_pending_index], timeout);
+    } else if (pending_count > 1) {
+      status = iree_hal_semaphore_list_wait_timepoints(
+          pending_list, pending_count, timeout, host_allocator);
+    }
+  }
+
+  if (pending_list.semaphores != inline_semaphores) {
+    iree_allocator_free(host_allocator, pending_list.semaphores);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
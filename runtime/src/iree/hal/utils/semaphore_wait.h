@@ -0,0 +1,42 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_HAL_UTILS_SEMAPHORE_WAIT_H_
+#define IREE_HAL_UTILS_SEMAPHORE_WAIT_H_
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Waits until all semaphores in |semaphore_list| reach or exceed their
+// payload values or |timeout| is reached.
+//
+// Unlike iree_hal_semaphore_list_wait (which waits on each semaphore in turn
+// and wakes once per semaphore) this acquires a timepoint on every pending
+// semaphore and blocks the calling thread once until the last of them resolves.
+// This is most useful when the semaphores belong to different devices and would
+// otherwise each require their own wake-up and requery: a join across N devices
+// costs a single host wake regardless of the order in which they complete.
+//
+// Semaphores that can only make progress when waited on directly (see
+// iree_hal_semaphore_t::wait_requires_caller) are waited on in-order before
+// coalescing the remainder.
+//
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if the |timeout| elapses before all
+// semaphores are reached and the failure status of the first failed semaphore
+// observed if any fail.
+IREE_API_EXPORT iree_status_t iree_hal_semaphore_list_wait_coalesced(
+    const iree_hal_semaphore_list_t semaphore_list, iree_timeout_t timeout,
+    iree_allocator_t host_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_HAL_UTILS_SEMAPHORE_WAIT_H_
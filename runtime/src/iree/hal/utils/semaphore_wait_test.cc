@@ -0,0 +1,203 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/hal/utils/semaphore_wait.h"
+
+#include <cstdint>
+#include <thread>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/hal/utils/semaphore_base.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace hal {
+namespace {
+
+using ::iree::testing::status::StatusIs;
+
+namespace {
+extern const iree_hal_semaphore_vtable_t test_semaphore_vtable;
+}  // namespace
+
+// Minimal host semaphore notifying its timepoints on signal and failure.
+struct TestSemaphore {
+  iree_hal_semaphore_t base;
+  iree_allocator_t host_allocator;
+  iree_slim_mutex_t mutex;
+  uint64_t current_value;
+  iree_status_t failure_status;
+  iree_notification_t notification;
+
+  static TestSemaphore* Create(uint64_t initial_value,
+                               iree_allocator_t host_allocator) {
+    TestSemaphore* semaphore = nullptr;
+    IREE_CHECK_OK(iree_allocator_malloc(host_allocator, sizeof(*semaphore),
+                                        (void**)&semaphore));
+    iree_hal_semaphore_initialize(&test_semaphore_vtable, &semaphore->base);
+    semaphore->host_allocator = host_allocator;
+    iree_slim_mutex_initialize(&semaphore->mutex);
+    semaphore->current_value = initial_value;
+    semaphore->failure_status = iree_ok_status();
+    iree_notification_initialize(&semaphore->notification);
+    return semaphore;
+  }
+
+  static TestSemaphore* Cast(iree_hal_semaphore_t* base_semaphore) {
+    return reinterpret_cast<TestSemaphore*>(base_semaphore);
+  }
+
+  static void Destroy(iree_hal_semaphore_t* base_semaphore) {
+    auto* semaphore = Cast(base_semaphore);
+    iree_status_ignore(semaphore->failure_status);
+    iree_notification_deinitialize(&semaphore->notification);
+    iree_slim_mutex_deinitialize(&semaphore->mutex);
+    iree_hal_semaphore_deinitialize(&semaphore->base);
+    iree_allocator_free(semaphore->host_allocator, semaphore);
+  }
+
+  static iree_status_t Query(iree_hal_semaphore_t* base_semaphore,
+                             uint64_t* out_value) {
+    auto* semaphore = Cast(base_semaphore);
+    iree_slim_mutex_lock(&semaphore->mutex);
+    iree_status_t status = iree_status_clone(semaphore->failure_status);
+    *out_value = semaphore->current_value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    return status;
+  }
+
+  static iree_status_t Signal(iree_hal_semaphore_t* base_semaphore,
+                              uint64_t new_value) {
+    auto* semaphore = Cast(base_semaphore);
+    iree_slim_mutex_lock(&semaphore->mutex);
+    semaphore->current_value = new_value;
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    iree_hal_semaphore_notify(&semaphore->base, new_value, IREE_STATUS_OK);
+    iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
+    return iree_ok_status();
+  }
+
+  static void Fail(iree_hal_semaphore_t* base_semaphore, iree_status_t status) {
+    auto* semaphore = Cast(base_semaphore);
+    iree_slim_mutex_lock(&semaphore->mutex);
+    iree_status_ignore(semaphore->failure_status);
+    semaphore->failure_status = status;
+    const iree_status_code_t status_code = iree_status_code(status);
+    iree_slim_mutex_unlock(&semaphore->mutex);
+    iree_hal_semaphore_notify(&semaphore->base, 0, status_code);
+    iree_notification_post(&semaphore->notification, IREE_ALL_WAITERS);
+  }
+
+  static iree_status_t Wait(iree_hal_semaphore_t* base_semaphore,
+                            uint64_t value, iree_timeout_t timeout) {
+    auto* semaphore = Cast(base_semaphore);
+    struct notify_state_t {
+      TestSemaphore* semaphore;
+      uint64_t value;
+    } notify_state = {semaphore, value};
+    bool did_resolve = iree_notification_await(
+        &semaphore->notification,
+        [](void* user_data) -> bool {
+          auto* state = reinterpret_cast<notify_state_t*>(user_data);
+          iree_slim_mutex_lock(&state->semaphore->mutex);
+          bool is_signaled =
+              state->semaphore->current_value >= state->value ||
+              !iree_status_is_ok(state->semaphore->failure_status);
+          iree_slim_mutex_unlock(&state->semaphore->mutex);
+          return is_signaled;
+        },
+        (void*)&notify_state, timeout);
+    if (!did_resolve) {
+      return iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+    }
+    uint64_t current_value = 0;
+    return Query(base_semaphore, &current_value);
+  }
+
+  constexpr operator iree_hal_semaphore_t*() noexcept { return &base; }
+};
+
+namespace {
+const iree_hal_semaphore_vtable_t test_semaphore_vtable = {
+    /*.destroy=*/TestSemaphore::Destroy,
+    /*.query=*/TestSemaphore::Query,
+    /*.signal=*/TestSemaphore::Signal,
+    /*.fail=*/TestSemaphore::Fail,
+    /*.wait=*/TestSemaphore::Wait,
+};
+}  // namespace
+
+struct SemaphoreWaitTest : public ::testing::Test {
+  void SetUp() override {
+    for (auto& semaphore : semaphores) {
+      semaphore = *TestSemaphore::Create(0ull, host_allocator);
+    }
+  }
+
+  void TearDown() override {
+    for (auto* semaphore : semaphores) {
+      iree_hal_semaphore_release(semaphore);
+    }
+  }
+
+  iree_hal_semaphore_list_t MakeList() {
+    return {IREE_ARRAYSIZE(semaphores), semaphores, payload_values};
+  }
+
+  iree_allocator_t host_allocator = iree_allocator_system();
+  iree_hal_semaphore_t* semaphores[3] = {nullptr};
+  uint64_t payload_values[3] = {1ull, 2ull, 3ull};
+};
+
+// Tests that no wait is performed if all semaphores have been reached.
+TEST_F(SemaphoreWaitTest, AllReached) {
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphores[0], 1ull));
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphores[1], 2ull));
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphores[2], 3ull));
+  IREE_ASSERT_OK(iree_hal_semaphore_list_wait_coalesced(
+      MakeList(), iree_immediate_timeout(), host_allocator));
+}
+
+// Tests waiting on semaphores signaled out of order from other threads.
+TEST_F(SemaphoreWaitTest, SignaledFromThreads) {
+  std::thread thread0([&]() {
+    IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphores[2], 3ull));
+  });
+  std::thread thread1([&]() {
+    IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphores[0], 1ull));
+    IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphores[1], 2ull));
+  });
+  IREE_ASSERT_OK(iree_hal_semaphore_list_wait_coalesced(
+      MakeList(), iree_infinite_timeout(), host_allocator));
+  thread0.join();
+  thread1.join();
+}
+
+// Tests that the deadline is reported if any semaphore is not reached.
+TEST_F(SemaphoreWaitTest, DeadlineExceeded) {
+  IREE_ASSERT_OK(iree_hal_semaphore_signal(semaphores[0], 1ull));
+  EXPECT_THAT(Status(iree_hal_semaphore_list_wait_coalesced(
+                  MakeList(), iree_make_timeout_ms(10), host_allocator)),
+              StatusIs(StatusCode::kDeadlineExceeded));
+}
+
+// Tests that a failure on one semaphore wakes the waiter with its status.
+TEST_F(SemaphoreWaitTest, FailurePropagates) {
+  std::thread thread([&]() {
+    iree_hal_semaphore_fail(semaphores[1],
+                            iree_make_status(IREE_STATUS_DATA_LOSS));
+  });
+  EXPECT_THAT(Status(iree_hal_semaphore_list_wait_coalesced(
+                  MakeList(), iree_infinite_timeout(), host_allocator)),
+              StatusIs(StatusCode::kDataLoss));
+  thread.join();
+}
+
+}  // namespace
+}  // namespace hal
+}  // namespace iree
@@ -7,12 +7,40 @@
 #include "iree/hal/utils/stream_tracing.h"
 
 #if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+#define IREE_HAL_STREAM_TRACING_AVAILABLE_MODES        \
+  (IREE_HAL_STREAM_TRACING_MODE_TRACY |                \
+   IREE_HAL_STREAM_TRACING_MODE_STATISTICS)
+#else
+#define IREE_HAL_STREAM_TRACING_AVAILABLE_MODES \
+  IREE_HAL_STREAM_TRACING_MODE_STATISTICS
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 
 // Total number of events per tracing context. This translates to the maximum
 // number of outstanding timestamp queries before collection is required.
 // To prevent spilling pages we leave some room for the context structure.
 #define IREE_HAL_TRACING_DEFAULT_QUERY_CAPACITY (16 * 1024 - 256)
 
+// Number of events kept in reserve for ending zones. New zones are dropped
+// once the freelist shrinks to this size so that zones already begun can
+// still be ended.
+#define IREE_HAL_TRACING_END_QUERY_RESERVE 256
+
+// Maximum number of unique zone names aggregated per tracing context.
+// Must be a power of two.
+#define IREE_HAL_TRACING_STATISTICS_CAPACITY 512
+
+// Maximum zone nesting depth paired when computing statistics. Deeper zones
+// are not included in the statistics.
+#define IREE_HAL_TRACING_STATISTICS_MAX_DEPTH 32
+
+// Sentinel statistic index for zones that are not aggregated.
+#define IREE_HAL_TRACING_STATISTIC_INDEX_NONE UINT16_MAX
+
+typedef enum iree_hal_stream_tracing_event_kind_e {
+  IREE_HAL_STREAM_TRACING_EVENT_KIND_BEGIN = 0,
+  IREE_HAL_STREAM_TRACING_EVENT_KIND_END,
+} iree_hal_stream_tracing_event_kind_t;
+
 // iree_hal_stream_tracing_context_event_t contains a native event that is used
 // to record timestamps for tracing GPU execution. In this struct, there are
 // also two linked lists that the current event may be added to during its
@@ -39,6 +67,11 @@ struct iree_hal_stream_tracing_context_event_t {
   iree_hal_stream_tracing_context_event_t* next_in_command_buffer;
   iree_hal_stream_tracing_context_event_t* next_submission;
   bool was_submitted;
+  // iree_hal_stream_tracing_event_kind_t of the zone boundary recorded.
+  uint8_t kind;
+  // Index into the context statistics of the zone begun by this event or
+  // IREE_HAL_TRACING_STATISTIC_INDEX_NONE.
+  uint16_t statistic_index;
 };
 
 struct iree_hal_stream_tracing_context_t {
@@ -49,6 +82,9 @@ struct iree_hal_stream_tracing_context_t {
   iree_arena_block_pool_t* block_pool;
   iree_allocator_t host_allocator;
 
+  // Sinks receiving the recorded timestamps.
+  iree_hal_stream_tracing_mode_t mode;
+
   // A unique GPU zone ID allocated from Tracy.
   // There is a global limit of 255 GPU zones (ID 255 is special).
   uint8_t id;
@@ -61,6 +97,16 @@ struct iree_hal_stream_tracing_context_t {
   // Unallocated event list head. next_in_command_buffer points to the next
   // available event.
   iree_hal_stream_tracing_context_event_t* event_freelist_head;
+  // Number of events in the freelist.
+  uint32_t event_freelist_count;
+
+  // Open-addressed table of zone statistics keyed by name. Only allocated
+  // with IREE_HAL_STREAM_TRACING_MODE_STATISTICS. Entries with an empty name
+  // are unused and names are owned by the context.
+  iree_hal_stream_tracing_statistics_t* statistics;
+  // Number of zones that were not recorded as the event pool was exhausted or
+  // were not aggregated as the statistics table was full.
+  uint64_t dropped_count;
 
   // Submitted events
   iree_hal_stream_tracing_context_event_list_t submitted_event_list;
@@ -89,6 +135,147 @@ struct iree_hal_stream_tracing_context_t {
       event_pool[IREE_HAL_TRACING_DEFAULT_QUERY_CAPACITY];
 };
 
+//===----------------------------------------------------------------------===//
+// Statistics
+//===----------------------------------------------------------------------===//
+
+static uint32_t iree_hal_stream_tracing_hash_name(iree_string_view_t name) {
+  // FNV-1a.
+  uint32_t hash = 2166136261u;
+  for (iree_host_size_t i = 0; i < name.size; ++i) {
+    hash ^= (uint8_t)name.data[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+// Returns the index of the statistics entry for |name|, inserting it if
+// needed, or IREE_HAL_TRACING_STATISTIC_INDEX_NONE if the zone is not
+// aggregated. Must be called with the event mutex held.
+static uint16_t iree_hal_stream_tracing_context_lookup_statistic(
+    iree_hal_stream_tracing_context_t* context, iree_string_view_t name) {
+  if (!context->statistics || iree_string_view_is_empty(name)) {
+    return IREE_HAL_TRACING_STATISTIC_INDEX_NONE;
+  }
+  const uint32_t mask = IREE_HAL_TRACING_STATISTICS_CAPACITY - 1;
+  uint32_t index = iree_hal_stream_tracing_hash_name(name) & mask;
+  for (uint32_t probe = 0; probe < IREE_HAL_TRACING_STATISTICS_CAPACITY;
+       ++probe, index = (index + 1) & mask) {
+    iree_hal_stream_tracing_statistics_t* entry = &context->statistics[index];
+    if (iree_string_view_equal(entry->name, name)) return (uint16_t)index;
+    if (!iree_string_view_is_empty(entry->name)) continue;
+    char* name_storage = NULL;
+    if (!iree_status_is_ok(iree_allocator_malloc(
+            context->host_allocator, name.size, (void**)&name_storage))) {
+      break;
+    }
+    memcpy(name_storage, name.data, name.size);
+    entry->name = iree_make_string_view(name_storage, name.size);
+    entry->min_ns = UINT64_MAX;
+    return (uint16_t)index;
+  }
+  ++context->dropped_count;
+  return IREE_HAL_TRACING_STATISTIC_INDEX_NONE;
+}
+
+// Accumulates the duration of the zone bounded by |begin| and |end|.
+static void iree_hal_stream_tracing_context_record_statistic(
+    iree_hal_stream_tracing_context_t* context,
+    iree_hal_stream_tracing_context_event_t* begin,
+    iree_hal_stream_tracing_context_event_t* end) {
+  if (begin->statistic_index == IREE_HAL_TRACING_STATISTIC_INDEX_NONE) return;
+  // Timing the zone directly avoids the precision lost by subtracting two
+  // float offsets from the base event.
+  float elapsed_millis = 0.0f;
+  context->device_interface->vtable->event_elapsed_time(
+      context->device_interface, &elapsed_millis, begin->event, end->event);
+  uint64_t elapsed_ns =
+      elapsed_millis > 0.0f ? (uint64_t)((double)elapsed_millis * 1000000.0)
+                            : 0;
+  iree_hal_stream_tracing_statistics_t* entry =
+      &context->statistics[begin->statistic_index];
+  ++entry->count;
+  entry->total_ns += elapsed_ns;
+  entry->min_ns = iree_min(entry->min_ns, elapsed_ns);
+  entry->max_ns = iree_max(entry->max_ns, elapsed_ns);
+}
+
+static void iree_hal_stream_tracing_context_free_statistics(
+    iree_hal_stream_tracing_context_t* context) {
+  if (!context->statistics) return;
+  for (iree_host_size_t i = 0; i < IREE_HAL_TRACING_STATISTICS_CAPACITY; ++i) {
+    iree_allocator_free(context->host_allocator,
+                        (void*)context->statistics[i].name.data);
+  }
+  iree_allocator_free(context->host_allocator, context->statistics);
+  context->statistics = NULL;
+}
+
+iree_status_t iree_hal_stream_tracing_context_merge_statistics(
+    iree_hal_stream_tracing_context_t* context, iree_host_size_t capacity,
+    iree_hal_stream_tracing_statistics_t* statistics,
+    iree_host_size_t* inout_count, uint64_t* out_dropped_count) {
+  IREE_ASSERT_ARGUMENT(!capacity || statistics);
+  IREE_ASSERT_ARGUMENT(inout_count);
+  if (!context || !context->statistics) return iree_ok_status();
+  iree_slim_mutex_lock(&context->event_mutex);
+
+  if (out_dropped_count) *out_dropped_count += context->dropped_count;
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < IREE_HAL_TRACING_STATISTICS_CAPACITY; ++i) {
+    const iree_hal_stream_tracing_statistics_t* entry = &context->statistics[i];
+    if (!entry->count) continue;
+    iree_hal_stream_tracing_statistics_t* target = NULL;
+    for (iree_host_size_t j = 0; j < *inout_count; ++j) {
+      if (iree_string_view_equal(statistics[j].name, entry->name)) {
+        target = &statistics[j];
+        break;
+      }
+    }
+    if (!target) {
+      if (*inout_count >= capacity) {
+        status = iree_make_status(
+            IREE_STATUS_RESOURCE_EXHAUSTED,
+            "statistics capacity %" PRIhsz " insufficient for all zones",
+            capacity);
+        break;
+      }
+      target = &statistics[(*inout_count)++];
+      *target = *entry;
+      continue;
+    }
+    target->min_ns = iree_min(target->min_ns, entry->min_ns);
+    target->max_ns = iree_max(target->max_ns, entry->max_ns);
+    target->count += entry->count;
+    target->total_ns += entry->total_ns;
+  }
+
+  iree_slim_mutex_unlock(&context->event_mutex);
+  return status;
+}
+
+void iree_hal_stream_tracing_context_reset_statistics(
+    iree_hal_stream_tracing_context_t* context) {
+  if (!context || !context->statistics) return;
+  iree_slim_mutex_lock(&context->event_mutex);
+  // Names are retained as in-flight events may still reference the entries.
+  for (iree_host_size_t i = 0; i < IREE_HAL_TRACING_STATISTICS_CAPACITY; ++i) {
+    iree_hal_stream_tracing_statistics_t* entry = &context->statistics[i];
+    entry->count = 0;
+    entry->total_ns = 0;
+    entry->min_ns = UINT64_MAX;
+    entry->max_ns = 0;
+  }
+  context->dropped_count = 0;
+  iree_slim_mutex_unlock(&context->event_mutex);
+}
+
+//===----------------------------------------------------------------------===//
+// iree_hal_stream_tracing_context_t
+//===----------------------------------------------------------------------===//
+
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+
 static iree_status_t iree_hal_stream_tracing_context_initial_calibration(
     iree_hal_stream_tracing_device_interface_t* device_interface,
     iree_hal_stream_tracing_native_event_t base_event,
@@ -119,18 +306,27 @@ static iree_status_t iree_hal_stream_tracing_context_initial_calibration(
   return iree_ok_status();
 }
 
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+
 iree_status_t iree_hal_stream_tracing_context_allocate(
     iree_hal_stream_tracing_device_interface_t* device_interface,
-    iree_string_view_t queue_name,
+    iree_string_view_t queue_name, iree_hal_stream_tracing_mode_t mode,
     iree_hal_stream_tracing_verbosity_t stream_tracing_verbosity,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_stream_tracing_context_t** out_context) {
-  IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(device_interface);
   IREE_ASSERT_ARGUMENT(block_pool);
   IREE_ASSERT_ARGUMENT(out_context);
   *out_context = NULL;
 
+  // Nothing to do if none of the requested sinks were compiled in.
+  mode &= IREE_HAL_STREAM_TRACING_AVAILABLE_MODES;
+  if (mode == IREE_HAL_STREAM_TRACING_MODE_NONE) {
+    device_interface->vtable->destroy(device_interface);
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
   iree_hal_stream_tracing_context_t* context = NULL;
   iree_status_t status =
       iree_allocator_malloc(host_allocator, sizeof(*context), (void**)&context);
@@ -138,11 +334,22 @@ iree_status_t iree_hal_stream_tracing_context_allocate(
     context->device_interface = device_interface;
     context->block_pool = block_pool;
     context->host_allocator = host_allocator;
+    context->mode = mode;
     context->query_capacity = IREE_ARRAYSIZE(context->event_pool);
-    context->submitted_event_list.head = NULL;
-    context->submitted_event_list.tail = NULL;
+    iree_hal_stream_tracing_context_event_list_initialize(
+        &context->submitted_event_list);
     context->verbosity = stream_tracing_verbosity;
     iree_slim_mutex_initialize(&context->event_mutex);
+  } else {
+    device_interface->vtable->destroy(device_interface);
+  }
+
+  if (iree_status_is_ok(status) &&
+      iree_all_bits_set(mode, IREE_HAL_STREAM_TRACING_MODE_STATISTICS)) {
+    status = iree_allocator_malloc(
+        host_allocator,
+        IREE_HAL_TRACING_STATISTICS_CAPACITY * sizeof(*context->statistics),
+        (void**)&context->statistics);
   }
 
   // Pre-allocate all events in the event pool.
@@ -166,31 +373,35 @@ iree_status_t iree_hal_stream_tracing_context_allocate(
         context->event_pool[i].next_in_command_buffer = NULL;
       }
     }
+    context->event_freelist_count = context->query_capacity;
     IREE_TRACE_ZONE_END(z_event_pool);
   }
 
-  // Create the initial GPU event and insert it into the stream.
-  // All events we record are relative to this event.
-  int64_t cpu_timestamp = 0;
-  int64_t gpu_timestamp = 0;
-  float timestamp_period = 0.0f;
-  if (iree_status_is_ok(status)) {
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+  if (iree_status_is_ok(status) &&
+      iree_all_bits_set(mode, IREE_HAL_STREAM_TRACING_MODE_TRACY)) {
+    // Create the initial GPU event and insert it into the stream.
+    // All events we record are relative to this event.
+    int64_t cpu_timestamp = 0;
+    int64_t gpu_timestamp = 0;
+    float timestamp_period = 0.0f;
     status = device_interface->vtable->create_native_event(
         device_interface, &context->base_event);
-  }
-  if (iree_status_is_ok(status)) {
-    status = iree_hal_stream_tracing_context_initial_calibration(
-        device_interface, context->base_event, &cpu_timestamp, &gpu_timestamp,
-        &timestamp_period);
-  }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_stream_tracing_context_initial_calibration(
+          device_interface, context->base_event, &cpu_timestamp,
+          &gpu_timestamp, &timestamp_period);
+    }
 
-  // Allocate the GPU context and pass initial calibration data.
-  if (iree_status_is_ok(status)) {
-    context->id = iree_tracing_gpu_context_allocate(
-        IREE_TRACING_GPU_CONTEXT_TYPE_VULKAN, queue_name.data, queue_name.size,
-        /*is_calibrated=*/false, cpu_timestamp, gpu_timestamp,
-        timestamp_period);
+    // Allocate the GPU context and pass initial calibration data.
+    if (iree_status_is_ok(status)) {
+      context->id = iree_tracing_gpu_context_allocate(
+          IREE_TRACING_GPU_CONTEXT_TYPE_VULKAN, queue_name.data,
+          queue_name.size, /*is_calibrated=*/false, cpu_timestamp,
+          gpu_timestamp, timestamp_period);
+    }
   }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 
   if (iree_status_is_ok(status)) {
     *out_context = context;
@@ -223,7 +434,9 @@ void iree_hal_stream_tracing_context_free(
     context->device_interface->vtable->destroy_native_event(
         context->device_interface, context->base_event);
   }
+  context->device_interface->vtable->destroy(context->device_interface);
 
+  iree_hal_stream_tracing_context_free_statistics(context);
   iree_slim_mutex_deinitialize(&context->event_mutex);
 
   iree_allocator_t host_allocator = context->host_allocator;
@@ -251,10 +464,15 @@ void iree_hal_stream_tracing_context_collect(
   uint32_t read_query_count = 0;
   // Outer per-command_buffer loop.
   while (events) {
+    // Zones are perfectly nested within a command buffer so begin events are
+    // paired with their end events using a stack.
+    iree_hal_stream_tracing_context_event_t*
+        open_zones[IREE_HAL_TRACING_STATISTICS_MAX_DEPTH];
+    uint32_t open_zone_depth = 0;
+    uint32_t overflow_zone_depth = 0;
     iree_hal_stream_tracing_context_event_t* event = events;
     // Inner per-event loop.
     while (event) {
-      uint32_t query_id = (uint32_t)(event - &context->event_pool[0]);
       iree_status_t status =
           context->device_interface->vtable->synchronize_native_event(
               context->device_interface, event->event);
@@ -263,15 +481,35 @@ void iree_hal_stream_tracing_context_collect(
           context->device_interface, event->event);
       if (!iree_status_is_ok(status)) break;
 
-      // Calculate context-relative time and notify tracy.
-      float relative_millis = 0.0f;
-      context->device_interface->vtable->event_elapsed_time(
-          context->device_interface, &relative_millis, context->base_event,
-          event->event);
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+      if (iree_all_bits_set(context->mode,
+                            IREE_HAL_STREAM_TRACING_MODE_TRACY)) {
+        // Calculate context-relative time and notify tracy.
+        uint32_t query_id = (uint32_t)(event - &context->event_pool[0]);
+        float relative_millis = 0.0f;
+        context->device_interface->vtable->event_elapsed_time(
+            context->device_interface, &relative_millis, context->base_event,
+            event->event);
+        int64_t gpu_timestamp = (int64_t)((double)relative_millis * 1000000.0);
+        iree_tracing_gpu_zone_notify(context->id, query_id, gpu_timestamp);
+      }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 
-      int64_t gpu_timestamp = (int64_t)((double)relative_millis * 1000000.0);
+      if (context->statistics) {
+        if (event->kind == IREE_HAL_STREAM_TRACING_EVENT_KIND_BEGIN) {
+          if (open_zone_depth < IREE_ARRAYSIZE(open_zones)) {
+            open_zones[open_zone_depth++] = event;
+          } else {
+            ++overflow_zone_depth;
+          }
+        } else if (overflow_zone_depth > 0) {
+          --overflow_zone_depth;
+        } else if (open_zone_depth > 0) {
+          iree_hal_stream_tracing_context_record_statistic(
+              context, open_zones[--open_zone_depth], event);
+        }
+      }
 
-      iree_tracing_gpu_zone_notify(context->id, query_id, gpu_timestamp);
       read_query_count += 1;
       event = event->next_in_command_buffer;
     }
@@ -324,29 +562,28 @@ void iree_hal_stream_tracing_free(
   // to keep tracy happy, and then we remove the elements from the
   // passed in event_list and add them to the front of the free-list.
 
-  // If this event list has never been submitted we still need to add values to
-  // the timeline otherwise tracy will not behave correctly.
-  if (!event_list->head->was_submitted) {
-    iree_hal_stream_tracing_context_event_t* event = event_list->head;
-    while (event) {
+  uint32_t event_count = 0;
+  for (iree_hal_stream_tracing_context_event_t* event = event_list->head;
+       event; event = event->next_in_command_buffer) {
+    ++event_count;
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+    // If this event list has never been submitted we still need to add values
+    // to the timeline otherwise tracy will not behave correctly.
+    if (!event_list->head->was_submitted &&
+        iree_all_bits_set(context->mode, IREE_HAL_STREAM_TRACING_MODE_TRACY)) {
       uint32_t query_id = (uint32_t)(event - &context->event_pool[0]);
       iree_tracing_gpu_zone_notify(context->id, query_id, 0);
-      event = event->next_in_command_buffer;
     }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
   }
 
-  if (!context->event_freelist_head) {
-    context->event_freelist_head = event_list->head;
-    iree_slim_mutex_unlock(&context->event_mutex);
-    return;
-  }
   event_list->head->next_submission = NULL;
   event_list->head->was_submitted = false;
   event_list->tail->next_in_command_buffer = context->event_freelist_head;
   context->event_freelist_head = event_list->head;
+  context->event_freelist_count += event_count;
 
-  event_list->head = NULL;
-  event_list->tail = NULL;
+  iree_hal_stream_tracing_context_event_list_initialize(event_list);
   iree_slim_mutex_unlock(&context->event_mutex);
 }
 
@@ -362,23 +599,56 @@ static void iree_hal_stream_tracing_context_event_list_append_event(
   }
 }
 
+// Grabs the next available event out of the freelist for a zone boundary of
+// |kind| named |statistic_name|. Returns NULL if the event pool is exhausted,
+// in which case the zone must be dropped. Must be called with the event mutex
+// held.
+static iree_hal_stream_tracing_context_event_t*
+iree_hal_stream_tracing_context_acquire_event(
+    iree_hal_stream_tracing_context_t* context,
+    iree_hal_stream_tracing_event_kind_t kind,
+    iree_string_view_t statistic_name) {
+  // Zones begun must always be able to end so new zones are not started once
+  // the pool is close to exhaustion.
+  uint32_t reserve_count = kind == IREE_HAL_STREAM_TRACING_EVENT_KIND_BEGIN
+                               ? IREE_HAL_TRACING_END_QUERY_RESERVE
+                               : 0;
+  if (context->event_freelist_count <= reserve_count) {
+    ++context->dropped_count;
+    return NULL;
+  }
+  iree_hal_stream_tracing_context_event_t* event = context->event_freelist_head;
+  context->event_freelist_head = event->next_in_command_buffer;
+  --context->event_freelist_count;
+  event->next_in_command_buffer = NULL;
+  event->kind = (uint8_t)kind;
+  event->statistic_index =
+      kind == IREE_HAL_STREAM_TRACING_EVENT_KIND_BEGIN
+          ? iree_hal_stream_tracing_context_lookup_statistic(context,
+                                                             statistic_name)
+          : IREE_HAL_TRACING_STATISTIC_INDEX_NONE;
+  return event;
+}
+
 // Grabs the next available query out of the freelist and adds it to
 // the event_list that was passed in. Also starts the recording of the
-// event.
-static uint16_t iree_hal_stream_tracing_context_insert_query(
+// event. Returns false if the zone was dropped.
+static bool iree_hal_stream_tracing_context_insert_query(
     iree_hal_stream_tracing_context_t* context,
-    iree_hal_stream_tracing_context_event_list_t* event_list) {
-  iree_slim_mutex_lock(&context->event_mutex);
+    iree_hal_stream_tracing_context_event_list_t* event_list,
+    iree_hal_stream_tracing_event_kind_t kind,
+    iree_string_view_t statistic_name, uint16_t* out_query_id) {
   IREE_ASSERT_ARGUMENT(event_list);
+  iree_slim_mutex_lock(&context->event_mutex);
 
-  // Allocate an event from the pool for use by the query.
-  // TODO: If we have run out of our freelist, then we need to try and recover
-  // or allocate more events.
-  iree_hal_stream_tracing_context_event_t* event = context->event_freelist_head;
-  context->event_freelist_head = event->next_in_command_buffer;
-  uint32_t query_id = event - &context->event_pool[0];
-  IREE_ASSERT(event->next_in_command_buffer != NULL);
-  event->next_in_command_buffer = NULL;
+  iree_hal_stream_tracing_context_event_t* event =
+      iree_hal_stream_tracing_context_acquire_event(context, kind,
+                                                    statistic_name);
+  if (!event) {
+    iree_slim_mutex_unlock(&context->event_mutex);
+    return false;
+  }
+  *out_query_id = (uint16_t)(event - &context->event_pool[0]);
 
   IREE_IGNORE_ERROR(context->device_interface->vtable->record_native_event(
       context->device_interface, event->event));
@@ -386,31 +656,31 @@ static uint16_t iree_hal_stream_tracing_context_insert_query(
   iree_hal_stream_tracing_context_event_list_append_event(event_list, event);
 
   iree_slim_mutex_unlock(&context->event_mutex);
-  return query_id;
+  return true;
 }
 
 // Grabs the next available query out of the freelist and adds it to
 // the event_list that was passed in. Also inserts the event record
-// node into the passed in graph. It returns the index of the
-// event.
-static uint16_t iree_hal_graph_tracing_context_insert_query(
+// node into the passed in graph. Returns false if the zone was dropped.
+static bool iree_hal_graph_tracing_context_insert_query(
     iree_hal_stream_tracing_context_t* context,
     iree_hal_stream_tracing_context_event_list_t* event_list,
     iree_hal_stream_tracing_native_graph_node_t* out_node,
     iree_hal_stream_tracing_native_graph_t graph,
     iree_hal_stream_tracing_native_graph_node_t* dependency_nodes,
-    size_t dependency_nodes_count) {
+    size_t dependency_nodes_count, iree_hal_stream_tracing_event_kind_t kind,
+    iree_string_view_t statistic_name, uint16_t* out_query_id) {
   IREE_ASSERT_ARGUMENT(event_list);
   iree_slim_mutex_lock(&context->event_mutex);
-  // Allocate an event from the pool for use by the query.
-  // TODO: If we have run out of our freelist, then we need to try and recover
-  // or
-  //  allocate more events.
-  iree_hal_stream_tracing_context_event_t* event = context->event_freelist_head;
-  context->event_freelist_head = event->next_in_command_buffer;
-  uint32_t query_id = event - &context->event_pool[0];
-  IREE_ASSERT(event->next_in_command_buffer != NULL);
-  event->next_in_command_buffer = NULL;
+
+  iree_hal_stream_tracing_context_event_t* event =
+      iree_hal_stream_tracing_context_acquire_event(context, kind,
+                                                    statistic_name);
+  if (!event) {
+    iree_slim_mutex_unlock(&context->event_mutex);
+    return false;
+  }
+  *out_query_id = (uint16_t)(event - &context->event_pool[0]);
 
   iree_status_t status =
       context->device_interface->vtable->add_graph_event_record_node(
@@ -423,24 +693,73 @@ static uint16_t iree_hal_graph_tracing_context_insert_query(
   iree_hal_stream_tracing_context_event_list_append_event(event_list, event);
 
   iree_slim_mutex_unlock(&context->event_mutex);
-  return query_id;
+  return true;
+}
+
+// Returns the name zones are aggregated under in the statistics.
+static iree_string_view_t iree_hal_stream_tracing_statistic_name(
+    const char* function_name, size_t function_name_length, const char* name,
+    size_t name_length) {
+  return function_name_length
+             ? iree_make_string_view(function_name, function_name_length)
+             : iree_make_string_view(name, name_length);
+}
+
+// Returns true if a zone begin should record an event into |event_list|.
+// Zones nested within dropped zones are dropped as well.
+static bool iree_hal_stream_tracing_should_begin_zone(
+    iree_hal_stream_tracing_context_t* context,
+    iree_hal_stream_tracing_context_event_list_t* event_list,
+    iree_hal_stream_tracing_verbosity_t verbosity) {
+  if (!context) return false;
+  if (verbosity > context->verbosity) return false;
+  if (event_list->dropped_depth > 0) {
+    ++event_list->dropped_depth;
+    return false;
+  }
+  return true;
+}
+
+// Returns true if a zone end should record an event into |event_list|.
+static bool iree_hal_stream_tracing_should_end_zone(
+    iree_hal_stream_tracing_context_t* context,
+    iree_hal_stream_tracing_context_event_list_t* event_list,
+    iree_hal_stream_tracing_verbosity_t verbosity) {
+  if (!context) return false;
+  if (verbosity > context->verbosity) return false;
+  if (event_list->dropped_depth > 0) {
+    --event_list->dropped_depth;
+    return false;
+  }
+  return true;
 }
 
 // TODO: optimize this implementation to reduce the number of events required:
 // today we insert 2 events per zone (one for begin and one for end) but in
 // many cases we could reduce this by inserting events only between zones and
 // using the differences between them.
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 void iree_hal_stream_tracing_zone_begin_impl(
     iree_hal_stream_tracing_context_t* context,
     iree_hal_stream_tracing_context_event_list_t* event_list,
     iree_hal_stream_tracing_verbosity_t verbosity,
     const iree_tracing_location_t* src_loc) {
-  if (!context) return;
-  if (verbosity > context->verbosity) return;
-  uint16_t query_id =
-      iree_hal_stream_tracing_context_insert_query(context, event_list);
-  iree_tracing_gpu_zone_begin(context->id, query_id, src_loc);
+  if (!iree_hal_stream_tracing_should_begin_zone(context, event_list,
+                                                 verbosity)) {
+    return;
+  }
+  uint16_t query_id = 0;
+  if (!iree_hal_stream_tracing_context_insert_query(
+          context, event_list, IREE_HAL_STREAM_TRACING_EVENT_KIND_BEGIN,
+          iree_make_cstring_view(src_loc->function), &query_id)) {
+    ++event_list->dropped_depth;
+    return;
+  }
+  if (iree_all_bits_set(context->mode, IREE_HAL_STREAM_TRACING_MODE_TRACY)) {
+    iree_tracing_gpu_zone_begin(context->id, query_id, src_loc);
+  }
 }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 
 void iree_hal_stream_tracing_zone_begin_external_impl(
     iree_hal_stream_tracing_context_t* context,
@@ -448,13 +767,26 @@ void iree_hal_stream_tracing_zone_begin_external_impl(
     iree_hal_stream_tracing_verbosity_t verbosity, const char* file_name,
     size_t file_name_length, uint32_t line, const char* function_name,
     size_t function_name_length, const char* name, size_t name_length) {
-  if (!context) return;
-  if (verbosity > context->verbosity) return;
-  uint16_t query_id =
-      iree_hal_stream_tracing_context_insert_query(context, event_list);
-  iree_tracing_gpu_zone_begin_external(context->id, query_id, file_name,
-                                       file_name_length, line, function_name,
-                                       function_name_length, name, name_length);
+  if (!iree_hal_stream_tracing_should_begin_zone(context, event_list,
+                                                 verbosity)) {
+    return;
+  }
+  uint16_t query_id = 0;
+  if (!iree_hal_stream_tracing_context_insert_query(
+          context, event_list, IREE_HAL_STREAM_TRACING_EVENT_KIND_BEGIN,
+          iree_hal_stream_tracing_statistic_name(
+              function_name, function_name_length, name, name_length),
+          &query_id)) {
+    ++event_list->dropped_depth;
+    return;
+  }
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+  if (iree_all_bits_set(context->mode, IREE_HAL_STREAM_TRACING_MODE_TRACY)) {
+    iree_tracing_gpu_zone_begin_external(
+        context->id, query_id, file_name, file_name_length, line,
+        function_name, function_name_length, name, name_length);
+  }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 }
 
 void iree_hal_graph_tracing_zone_begin_external_impl(
@@ -467,25 +799,48 @@ void iree_hal_graph_tracing_zone_begin_external_impl(
     size_t dependency_nodes_count, const char* file_name,
     size_t file_name_length, uint32_t line, const char* function_name,
     size_t function_name_length, const char* name, size_t name_length) {
-  if (!context) return;
-  if (verbosity > context->verbosity) return;
-  uint16_t query_id = iree_hal_graph_tracing_context_insert_query(
-      context, event_list, out_node, graph, dependency_nodes,
-      dependency_nodes_count);
-  iree_tracing_gpu_zone_begin_external(context->id, query_id, file_name,
-                                       file_name_length, line, function_name,
-                                       function_name_length, name, name_length);
+  if (!iree_hal_stream_tracing_should_begin_zone(context, event_list,
+                                                 verbosity)) {
+    return;
+  }
+  uint16_t query_id = 0;
+  if (!iree_hal_graph_tracing_context_insert_query(
+          context, event_list, out_node, graph, dependency_nodes,
+          dependency_nodes_count, IREE_HAL_STREAM_TRACING_EVENT_KIND_BEGIN,
+          iree_hal_stream_tracing_statistic_name(
+              function_name, function_name_length, name, name_length),
+          &query_id)) {
+    ++event_list->dropped_depth;
+    return;
+  }
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+  if (iree_all_bits_set(context->mode, IREE_HAL_STREAM_TRACING_MODE_TRACY)) {
+    iree_tracing_gpu_zone_begin_external(
+        context->id, query_id, file_name, file_name_length, line,
+        function_name, function_name_length, name, name_length);
+  }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 }
 
 void iree_hal_stream_tracing_zone_end_impl(
     iree_hal_stream_tracing_context_t* context,
     iree_hal_stream_tracing_context_event_list_t* event_list,
     iree_hal_stream_tracing_verbosity_t verbosity) {
-  if (!context) return;
-  if (verbosity > context->verbosity) return;
-  uint16_t query_id =
-      iree_hal_stream_tracing_context_insert_query(context, event_list);
-  iree_tracing_gpu_zone_end(context->id, query_id);
+  if (!iree_hal_stream_tracing_should_end_zone(context, event_list,
+                                               verbosity)) {
+    return;
+  }
+  uint16_t query_id = 0;
+  if (!iree_hal_stream_tracing_context_insert_query(
+          context, event_list, IREE_HAL_STREAM_TRACING_EVENT_KIND_END,
+          iree_string_view_empty(), &query_id)) {
+    return;
+  }
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+  if (iree_all_bits_set(context->mode, IREE_HAL_STREAM_TRACING_MODE_TRACY)) {
+    iree_tracing_gpu_zone_end(context->id, query_id);
+  }
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 }
 
 void iree_hal_graph_tracing_zone_end_impl(
@@ -496,38 +851,20 @@ void iree_hal_graph_tracing_zone_end_impl(
     iree_hal_stream_tracing_verbosity_t verbosity,
     iree_hal_stream_tracing_native_graph_node_t* dependency_nodes,
     size_t dependency_nodes_count) {
-  if (!context) return;
-  if (verbosity > context->verbosity) return;
-  uint16_t query_id = iree_hal_graph_tracing_context_insert_query(
-      context, event_list, out_node, graph, dependency_nodes,
-      dependency_nodes_count);
-  iree_tracing_gpu_zone_end(context->id, query_id);
-}
-
-#else
-
-iree_status_t iree_hal_stream_tracing_context_allocate(
-    iree_hal_stream_tracing_device_interface_t* interface,
-    iree_string_view_t queue_name,
-    iree_hal_stream_tracing_verbosity_t stream_tracing_verbosity,
-    iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
-    iree_hal_stream_tracing_context_t** out_context) {
-  *out_context = NULL;
-  return iree_ok_status();
-}
-
-void iree_hal_stream_tracing_context_free(
-    iree_hal_stream_tracing_context_t* context) {}
-
-void iree_hal_stream_tracing_context_collect(
-    iree_hal_stream_tracing_context_t* context) {}
-
-void iree_hal_stream_tracing_notify_submitted(
-    iree_hal_stream_tracing_context_t* context,
-    iree_hal_stream_tracing_context_event_list_t* event_list) {}
-
-void iree_hal_stream_tracing_free(
-    iree_hal_stream_tracing_context_t* context,
-    iree_hal_stream_tracing_context_event_list_t* event_list) {}
-
+  if (!iree_hal_stream_tracing_should_end_zone(context, event_list,
+                                               verbosity)) {
+    return;
+  }
+  uint16_t query_id = 0;
+  if (!iree_hal_graph_tracing_context_insert_query(
+          context, event_list, out_node, graph, dependency_nodes,
+          dependency_nodes_count, IREE_HAL_STREAM_TRACING_EVENT_KIND_END,
+          iree_string_view_empty(), &query_id)) {
+    return;
+  }
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+  if (iree_all_bits_set(context->mode, IREE_HAL_STREAM_TRACING_MODE_TRACY)) {
+    iree_tracing_gpu_zone_end(context->id, query_id);
+  }
 #endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+}
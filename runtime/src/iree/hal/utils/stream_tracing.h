@@ -17,7 +17,9 @@ extern "C" {
 #endif  // __cplusplus
 
 // Per-stream tracing context.
-// No-op if IREE tracing is not enabled.
+// Timestamps are fed to Tracy when IREE device tracing is enabled and/or
+// aggregated into per-function statistics available in all builds (see
+// iree_hal_stream_tracing_mode_t).
 //
 // Use the IREE_TRACE_* macros to trace a contiguous set of stream
 // operations. Unlike the normal tracy macros there are no zone IDs and instead
@@ -49,8 +51,19 @@ typedef struct iree_hal_stream_tracing_context_event_t
 typedef struct iree_hal_stream_tracing_context_event_list_t {
   iree_hal_stream_tracing_context_event_t* head;
   iree_hal_stream_tracing_context_event_t* tail;
+  // Depth of zones that were not recorded because the event pool was
+  // exhausted. All zones nested within a dropped zone are also dropped.
+  uint32_t dropped_depth;
 } iree_hal_stream_tracing_context_event_list_t;
 
+// Initializes an empty |out_event_list|.
+static inline void iree_hal_stream_tracing_context_event_list_initialize(
+    iree_hal_stream_tracing_context_event_list_t* out_event_list) {
+  out_event_list->head = NULL;
+  out_event_list->tail = NULL;
+  out_event_list->dropped_depth = 0;
+}
+
 typedef enum iree_hal_stream_tracing_verbosity_e {
   IREE_HAL_STREAM_TRACING_VERBOSITY_OFF = 0,
   IREE_HAL_STREAM_TRACING_VERBOSITY_COARSE,
@@ -58,6 +71,31 @@ typedef enum iree_hal_stream_tracing_verbosity_e {
   IREE_HAL_STREAM_TRACING_VERBOSITY_MAX
 } iree_hal_stream_tracing_verbosity_t;
 
+// Bitfield specifying where recorded stream timestamps are delivered.
+typedef uint32_t iree_hal_stream_tracing_mode_t;
+enum iree_hal_stream_tracing_mode_bits_t {
+  IREE_HAL_STREAM_TRACING_MODE_NONE = 0u,
+  // Feeds zones to Tracy. Ignored if IREE device tracing is not compiled in.
+  IREE_HAL_STREAM_TRACING_MODE_TRACY = 1u << 0,
+  // Aggregates the GPU execution time of zones by function name for querying
+  // with iree_hal_stream_tracing_context_merge_statistics. Available in all
+  // builds and intended for production monitoring.
+  IREE_HAL_STREAM_TRACING_MODE_STATISTICS = 1u << 1,
+};
+
+// Aggregated GPU execution time of all zones sharing a function name.
+typedef struct iree_hal_stream_tracing_statistics_t {
+  // Function name of the zones (such as the executable export name).
+  // Valid for the lifetime of the tracing context.
+  iree_string_view_t name;
+  // Total number of completed zones.
+  uint64_t count;
+  // Sum, minimum and maximum of the zone durations in nanoseconds.
+  uint64_t total_ns;
+  uint64_t min_ns;
+  uint64_t max_ns;
+} iree_hal_stream_tracing_statistics_t;
+
 typedef struct iree_hal_stream_tracing_device_interface_vtable_t
     iree_hal_stream_tracing_device_interface_vtable_t;
 
@@ -118,9 +156,11 @@ typedef struct iree_hal_stream_tracing_device_interface_vtable_t {
 // The tracing context takes ownership of the interface,
 // and the interface's destroy method will be called
 // when cleanup is required.
+// Returns NULL if none of the requested |mode| sinks are available in the
+// build, in which case the interface is not used.
 iree_status_t iree_hal_stream_tracing_context_allocate(
     iree_hal_stream_tracing_device_interface_t* interface,
-    iree_string_view_t queue_name,
+    iree_string_view_t queue_name, iree_hal_stream_tracing_mode_t mode,
     iree_hal_stream_tracing_verbosity_t stream_tracing_verbosity,
     iree_arena_block_pool_t* block_pool, iree_allocator_t host_allocator,
     iree_hal_stream_tracing_context_t** out_context);
@@ -130,12 +170,32 @@ iree_status_t iree_hal_stream_tracing_context_allocate(
 void iree_hal_stream_tracing_context_free(
     iree_hal_stream_tracing_context_t* context);
 
-// Collects in-flight timestamp queries from the stream and feeds them to tracy.
-// Must be called frequently (every submission, etc) to drain the backlog;
-// tracing may start failing if the internal ringbuffer is exceeded.
+// Collects in-flight timestamp queries from the stream and feeds them to tracy
+// and/or the statistics. Must be called frequently (every submission, etc) to
+// drain the backlog; zones are dropped while the internal event pool is
+// exhausted.
 void iree_hal_stream_tracing_context_collect(
     iree_hal_stream_tracing_context_t* context);
 
+// Merges the statistics collected by |context| into |statistics| by name.
+// |statistics| has |*inout_count| valid entries and room for |capacity|; new
+// names are appended and |*inout_count| is updated. This allows statistics
+// from multiple contexts (such as one per stream) to be combined. Returns
+// RESOURCE_EXHAUSTED with |*inout_count| set to |capacity| if there were more
+// names than capacity. A NULL |context| or one without
+// IREE_HAL_STREAM_TRACING_MODE_STATISTICS merges nothing.
+//
+// |out_dropped_count| is optional and incremented by the number of zones that
+// were not recorded because the event pool was exhausted.
+iree_status_t iree_hal_stream_tracing_context_merge_statistics(
+    iree_hal_stream_tracing_context_t* context, iree_host_size_t capacity,
+    iree_hal_stream_tracing_statistics_t* statistics,
+    iree_host_size_t* inout_count, uint64_t* out_dropped_count);
+
+// Resets all statistics collected by |context|.
+void iree_hal_stream_tracing_context_reset_statistics(
+    iree_hal_stream_tracing_context_t* context);
+
 // Notifies that the given list of events has been dispached on to the gpu.
 void iree_hal_stream_tracing_notify_submitted(
     iree_hal_stream_tracing_context_t* context,
@@ -146,18 +206,9 @@ void iree_hal_stream_tracing_free(
     iree_hal_stream_tracing_context_t* context,
     iree_hal_stream_tracing_context_event_list_t* event_list);
 
-#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
-
-// Begins a normal zone derived on the calling |src_loc|.
-// Must be perfectly nested and paired with a corresponding zone end.
-void iree_hal_stream_tracing_zone_begin_impl(
-    iree_hal_stream_tracing_context_t* context,
-    iree_hal_stream_tracing_context_event_list_t* event_list,
-    iree_hal_stream_tracing_verbosity_t verbosity,
-    const iree_tracing_location_t* src_loc);
-
 // Begins an external zone using the given source information.
-// The provided strings will be copied into the tracy buffer.
+// The provided strings will be copied into the tracy buffer; the statistics
+// copy the |function_name| on first use.
 void iree_hal_stream_tracing_zone_begin_external_impl(
     iree_hal_stream_tracing_context_t* context,
     iree_hal_stream_tracing_context_event_list_t* event_list,
@@ -189,6 +240,16 @@ void iree_hal_graph_tracing_zone_end_impl(
     iree_hal_stream_tracing_native_graph_node_t* dependency_nodes,
     size_t dependency_nodes_count);
 
+#if IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+
+// Begins a normal zone derived on the calling |src_loc|.
+// Must be perfectly nested and paired with a corresponding zone end.
+void iree_hal_stream_tracing_zone_begin_impl(
+    iree_hal_stream_tracing_context_t* context,
+    iree_hal_stream_tracing_context_event_list_t* event_list,
+    iree_hal_stream_tracing_verbosity_t verbosity,
+    const iree_tracing_location_t* src_loc);
+
 // Begins a new zone with the parent function name.
 #define IREE_HAL_STREAM_TRACE_ZONE_BEGIN(context, event_list, verbosity)  \
   static const iree_tracing_location_t TracyConcat(                       \
@@ -198,9 +259,22 @@ void iree_hal_graph_tracing_zone_end_impl(
       context, event_list, verbosity,                                     \
       &TracyConcat(__tracy_source_location, __LINE__));
 
+#else
+
+// Begins a new zone with the parent function name.
+#define IREE_HAL_STREAM_TRACE_ZONE_BEGIN(context, event_list, verbosity) \
+  iree_hal_stream_tracing_zone_begin_external_impl(                      \
+      context, event_list, verbosity, __FILE__, strlen(__FILE__),        \
+      (uint32_t)__LINE__, __FUNCTION__, strlen(__FUNCTION__), NULL, 0);
+
+#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
+
 // Begins an externally defined zone with a dynamic source location.
 // The |file_name|, |function_name|, and optional |name| strings will be copied
 // into the trace buffer and do not need to persist.
+//
+// Zones are recorded in all builds so that the statistics sink is available
+// without Tracy. The calls are no-ops when |context| is NULL.
 #define IREE_HAL_STREAM_TRACE_ZONE_BEGIN_EXTERNAL(                       \
     context, event_list, verbosity, file_name, file_name_length, line,   \
     function_name, function_name_length, name, name_length)              \
@@ -226,21 +300,6 @@ void iree_hal_graph_tracing_zone_end_impl(
   iree_hal_graph_tracing_zone_end_impl(context, event_list, out_node, graph, \
                                        verbosity, dependency_nodes,          \
                                        dependency_nodes_count)
-#else
-
-#define IREE_HAL_STREAM_TRACE_ZONE_BEGIN(context, event_list, verbosity)
-#define IREE_HAL_STREAM_TRACE_ZONE_BEGIN_EXTERNAL(                     \
-    context, event_list, verbosity, file_name, file_name_length, line, \
-    function_name, function_name_length, name, name_length)
-#define IREE_HAL_GRAPH_TRACE_ZONE_BEGIN_EXTERNAL(                             \
-    context, event_list, out_node, graph, verbosity, dependency_nodes,        \
-    dependency_nodes_count, file_name, file_name_length, line, function_name, \
-    function_name_length, name, name_length)
-#define IREE_HAL_STREAM_TRACE_ZONE_END(context, evnet_list, verbosity)
-#define IREE_HAL_GRAPH_TRACE_ZONE_END(context, event_list, out_node, graph, \
-                                      verbosity, dependency_nodes,          \
-                                      dependency_nodes_count)
-#endif  // IREE_TRACING_FEATURES & IREE_TRACING_FEATURE_INSTRUMENTATION_DEVICE
 
 #ifdef __cplusplus
 }  // extern "C"
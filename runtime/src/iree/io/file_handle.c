@@ -4,11 +4,22 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+// Needed for O_DIRECT on Linux.
+#define _GNU_SOURCE
+
 #include "iree/io/file_handle.h"
 
 #include "iree/base/internal/atomics.h"
 #include "iree/io/memory_stream.h"
 
+#if defined(IREE_PLATFORM_ANDROID) || defined(IREE_PLATFORM_IOS) || \
+    defined(IREE_PLATFORM_LINUX) || defined(IREE_PLATFORM_MACOS)
+#define IREE_IO_FILE_HANDLE_HAVE_FD 1
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif  // IREE_PLATFORM_*
+
 //===----------------------------------------------------------------------===//
 // iree_io_file_handle_t
 //===----------------------------------------------------------------------===//
@@ -60,6 +71,102 @@ IREE_API_EXPORT iree_status_t iree_io_file_handle_wrap_host_allocation(
                                   release_callback, host_allocator, out_handle);
 }
 
+#if defined(IREE_IO_FILE_HANDLE_HAVE_FD)
+
+static void iree_io_file_handle_fd_release(
+    void* user_data, iree_io_file_handle_primitive_t handle_primitive) {
+  close(handle_primitive.value.fd);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_file_handle_open(
+    iree_io_file_mode_t mode, iree_string_view_t path,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle) {
+  IREE_ASSERT_ARGUMENT(out_handle);
+  *out_handle = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
+
+  iree_io_file_access_t allowed_access = 0;
+  int flags = O_CLOEXEC;
+  if (iree_all_bits_set(mode,
+                        IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_WRITE)) {
+    flags |= O_RDWR;
+    allowed_access = IREE_IO_FILE_ACCESS_READ | IREE_IO_FILE_ACCESS_WRITE;
+  } else if (iree_all_bits_set(mode, IREE_IO_FILE_MODE_WRITE)) {
+    flags |= O_WRONLY;
+    allowed_access = IREE_IO_FILE_ACCESS_WRITE;
+  } else {
+    flags |= O_RDONLY;
+    allowed_access = IREE_IO_FILE_ACCESS_READ;
+  }
+  if (iree_all_bits_set(mode, IREE_IO_FILE_MODE_DIRECT)) {
+    if (iree_all_bits_set(mode, IREE_IO_FILE_MODE_WRITE)) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "direct I/O is only supported on read-only files");
+    }
+#if defined(O_DIRECT)
+    flags |= O_DIRECT;
+#endif  // O_DIRECT
+  }
+
+  // Paths are not guaranteed to be NUL terminated.
+  char* path_str = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, path.size + 1,
+                                (void**)&path_str));
+  iree_string_view_to_cstring(path, path_str, path.size + 1);
+  int fd = open(path_str, flags);
+  int open_errno = errno;
+  iree_allocator_free(host_allocator, path_str);
+  if (fd == -1) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(open_errno),
+                            "failed to open file '%.*s'", (int)path.size,
+                            path.data);
+  }
+
+#if defined(F_NOCACHE)
+  // Apple platforms have no O_DIRECT but can disable caching per descriptor.
+  if (iree_all_bits_set(mode, IREE_IO_FILE_MODE_DIRECT)) {
+    fcntl(fd, F_NOCACHE, 1);
+  }
+#endif  // F_NOCACHE
+
+  iree_io_file_handle_primitive_t handle_primitive = {
+      .type = IREE_IO_FILE_HANDLE_TYPE_FD,
+      .value =
+          {
+              .fd = fd,
+          },
+  };
+  iree_io_file_handle_release_callback_t release_callback = {
+      .fn = iree_io_file_handle_fd_release,
+      .user_data = NULL,
+  };
+  iree_status_t status =
+      iree_io_file_handle_wrap(allowed_access, handle_primitive,
+                               release_callback, host_allocator, out_handle);
+  if (!iree_status_is_ok(status)) close(fd);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+#else
+
+IREE_API_EXPORT iree_status_t iree_io_file_handle_open(
+    iree_io_file_mode_t mode, iree_string_view_t path,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle) {
+  IREE_ASSERT_ARGUMENT(out_handle);
+  *out_handle = NULL;
+  return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                          "file descriptors not available on this platform");
+}
+
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
+
 static void iree_io_file_handle_destroy(iree_io_file_handle_t* handle) {
   IREE_ASSERT_ARGUMENT(handle);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -111,6 +218,15 @@ iree_io_file_handle_flush(iree_io_file_handle_t* handle) {
       // No-op (though we could flush when known mapped).
       break;
     }
+#if defined(IREE_IO_FILE_HANDLE_HAVE_FD)
+    case IREE_IO_FILE_HANDLE_TYPE_FD: {
+      if (fsync(handle->primitive.value.fd) != 0) {
+        status = iree_make_status(iree_status_code_from_errno(errno),
+                                  "failed to flush file descriptor");
+      }
+      break;
+    }
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
     default: {
       status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                                 "flush not supported on handle type %d",
@@ -122,6 +238,214 @@ iree_io_file_handle_flush(iree_io_file_handle_t* handle) {
   return status;
 }
 
+// Returns the host pointer to the |offset| and |length| range of the
+// IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION |primitive|.
+static iree_status_t iree_io_file_handle_host_range(
+    iree_io_file_handle_primitive_t primitive, uint64_t offset,
+    uint64_t length, uint8_t** out_ptr) {
+  iree_byte_span_t allocation = primitive.value.host_allocation;
+  if (offset > allocation.data_length ||
+      length > allocation.data_length - offset) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%" PRIu64 ", %" PRIu64
+                            ") out of bounds of host allocation with %" PRIhsz
+                            " bytes",
+                            offset, offset + length, allocation.data_length);
+  }
+  *out_ptr = allocation.data + offset;
+  return iree_ok_status();
+}
+
+#if defined(IREE_IO_FILE_HANDLE_HAVE_FD)
+
+// Maximum number of bytes transferred by a single positional I/O call.
+// Linux caps transfers at slightly under 2GB and other platforms may fail
+// larger requests outright.
+#define IREE_IO_FILE_HANDLE_MAX_IO_LENGTH (1024 * 1024 * 1024)
+
+// Size of the bounce buffer used to copy between file descriptors.
+#define IREE_IO_FILE_HANDLE_COPY_BOUNCE_SIZE (4 * 1024 * 1024)
+
+static iree_status_t iree_io_fd_verify_buffered(int fd) {
+#if defined(O_DIRECT)
+  int flags = fcntl(fd, F_GETFL);
+  if (flags != -1 && (flags & O_DIRECT)) {
+    return iree_make_status(
+        IREE_STATUS_UNIMPLEMENTED,
+        "copies from file descriptors opened for direct I/O are not supported");
+  }
+#endif  // O_DIRECT
+  return iree_ok_status();
+}
+
+static iree_status_t iree_io_fd_pread_all(int fd, uint64_t offset,
+                                          uint8_t* buffer, uint64_t length) {
+  while (length > 0) {
+    size_t request_length =
+        (size_t)iree_min(length, IREE_IO_FILE_HANDLE_MAX_IO_LENGTH);
+    ssize_t read_length = pread(fd, buffer, request_length, (off_t)offset);
+    if (read_length < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to read %" PRIu64
+                              " bytes at file offset %" PRIu64,
+                              length, offset);
+    } else if (read_length == 0) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "unexpected end of file reading %" PRIu64
+                              " bytes at file offset %" PRIu64,
+                              length, offset);
+    }
+    buffer += read_length;
+    offset += (uint64_t)read_length;
+    length -= (uint64_t)read_length;
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_io_fd_pwrite_all(int fd, uint64_t offset,
+                                           const uint8_t* buffer,
+                                           uint64_t length) {
+  while (length > 0) {
+    size_t request_length =
+        (size_t)iree_min(length, IREE_IO_FILE_HANDLE_MAX_IO_LENGTH);
+    ssize_t write_length = pwrite(fd, buffer, request_length, (off_t)offset);
+    if (write_length < 0) {
+      if (errno == EINTR) continue;
+      return iree_make_status(iree_status_code_from_errno(errno),
+                              "failed to write %" PRIu64
+                              " bytes at file offset %" PRIu64,
+                              length, offset);
+    }
+    buffer += write_length;
+    offset += (uint64_t)write_length;
+    length -= (uint64_t)write_length;
+  }
+  return iree_ok_status();
+}
+
+static iree_status_t iree_io_fd_copy(int source_fd, uint64_t source_offset,
+                                     int target_fd, uint64_t target_offset,
+                                     uint64_t length,
+                                     iree_allocator_t host_allocator) {
+#if defined(IREE_PLATFORM_LINUX)
+  // Let the kernel copy (or reflink) the range directly. Any failure other
+  // than an interruption (such as cross-file system copies on older kernels)
+  // falls back to the bounce buffer for whatever remains.
+  while (length > 0) {
+    off_t source_position = (off_t)source_offset;
+    off_t target_position = (off_t)target_offset;
+    ssize_t copy_length = copy_file_range(
+        source_fd, &source_position, target_fd, &target_position,
+        (size_t)iree_min(length, IREE_IO_FILE_HANDLE_MAX_IO_LENGTH), 0);
+    if (copy_length < 0 && errno == EINTR) continue;
+    if (copy_length <= 0) break;
+    source_offset += (uint64_t)copy_length;
+    target_offset += (uint64_t)copy_length;
+    length -= (uint64_t)copy_length;
+  }
+  if (length == 0) return iree_ok_status();
+#endif  // IREE_PLATFORM_LINUX
+
+  iree_host_size_t bounce_size =
+      (iree_host_size_t)iree_min(length, IREE_IO_FILE_HANDLE_COPY_BOUNCE_SIZE);
+  uint8_t* bounce_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc_uninitialized(
+      host_allocator, bounce_size, (void**)&bounce_buffer));
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status) && length > 0) {
+    iree_host_size_t block_length =
+        (iree_host_size_t)iree_min(length, bounce_size);
+    status = iree_io_fd_pread_all(source_fd, source_offset, bounce_buffer,
+                                  block_length);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_fd_pwrite_all(target_fd, target_offset, bounce_buffer,
+                                     block_length);
+    }
+    source_offset += block_length;
+    target_offset += block_length;
+    length -= block_length;
+  }
+  iree_allocator_free(host_allocator, bounce_buffer);
+  return status;
+}
+
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
+
+IREE_API_EXPORT iree_status_t iree_io_file_handle_copy(
+    iree_io_file_handle_t* source_handle, uint64_t source_offset,
+    iree_io_file_handle_t* target_handle, uint64_t target_offset,
+    uint64_t length, iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(source_handle);
+  IREE_ASSERT_ARGUMENT(target_handle);
+  if (!iree_all_bits_set(source_handle->access, IREE_IO_FILE_ACCESS_READ)) {
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "source file handle does not allow reads");
+  } else if (!iree_all_bits_set(target_handle->access,
+                                IREE_IO_FILE_ACCESS_WRITE)) {
+    return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                            "target file handle does not allow writes");
+  }
+  if (length == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)length);
+
+  iree_io_file_handle_primitive_t source = source_handle->primitive;
+  iree_io_file_handle_primitive_t target = target_handle->primitive;
+  uint8_t* source_ptr = NULL;
+  uint8_t* target_ptr = NULL;
+  iree_status_t status = iree_ok_status();
+  if (source.type == IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION &&
+      target.type == IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
+    status = iree_io_file_handle_host_range(source, source_offset, length,
+                                            &source_ptr);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_file_handle_host_range(target, target_offset, length,
+                                              &target_ptr);
+    }
+    if (iree_status_is_ok(status)) {
+      memcpy(target_ptr, source_ptr, (iree_host_size_t)length);
+    }
+#if defined(IREE_IO_FILE_HANDLE_HAVE_FD)
+  } else if (source.type == IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION &&
+             target.type == IREE_IO_FILE_HANDLE_TYPE_FD) {
+    status = iree_io_file_handle_host_range(source, source_offset, length,
+                                            &source_ptr);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_fd_pwrite_all(target.value.fd, target_offset,
+                                     source_ptr, length);
+    }
+  } else if (source.type == IREE_IO_FILE_HANDLE_TYPE_FD &&
+             target.type == IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
+    status = iree_io_fd_verify_buffered(source.value.fd);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_file_handle_host_range(target, target_offset, length,
+                                              &target_ptr);
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_io_fd_pread_all(source.value.fd, source_offset,
+                                    target_ptr, length);
+    }
+  } else if (source.type == IREE_IO_FILE_HANDLE_TYPE_FD &&
+             target.type == IREE_IO_FILE_HANDLE_TYPE_FD) {
+    status = iree_io_fd_verify_buffered(source.value.fd);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_fd_copy(source.value.fd, source_offset,
+                               target.value.fd, target_offset, length,
+                               host_allocator);
+    }
+#endif  // IREE_IO_FILE_HANDLE_HAVE_FD
+  } else {
+    status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "copy not supported from handle type %d to "
+                              "handle type %d",
+                              (int)source.type, (int)target.type);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_io_stream_t utilities
 //===----------------------------------------------------------------------===//
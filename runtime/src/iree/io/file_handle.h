@@ -29,6 +29,21 @@ enum iree_io_file_access_bits_t {
 };
 typedef uint32_t iree_io_file_access_t;
 
+// Bits defining how a file is opened with iree_io_file_handle_open.
+enum iree_io_file_mode_bits_t {
+  // Opens the file for reading.
+  IREE_IO_FILE_MODE_READ = 1u << 0,
+  // Opens the file for writing.
+  IREE_IO_FILE_MODE_WRITE = 1u << 1,
+  // Bypasses the platform page cache when performing I/O (O_DIRECT on Linux).
+  // Intended for streaming large read-only files (such as parameters) that are
+  // read once and would otherwise thrash the page cache. All I/O on the file
+  // must be aligned to the device block size; the HAL file transfer utilities
+  // handle this automatically. Ignored on platforms without support.
+  IREE_IO_FILE_MODE_DIRECT = 1u << 2,
+};
+typedef uint32_t iree_io_file_mode_t;
+
 //===----------------------------------------------------------------------===//
 // iree_io_file_handle_primitive_t
 //===----------------------------------------------------------------------===//
@@ -46,7 +61,13 @@ typedef enum iree_io_file_handle_type_e {
   // as long as the file handle referencing it.
   IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION = 0u,
 
-  // TODO(benvanik): file descriptor, FILE*, HANDLE, etc.
+  // A POSIX file descriptor supporting positional reads/writes.
+  // The file may have been opened with O_DIRECT (see IREE_IO_FILE_MODE_DIRECT)
+  // in which case all offsets, lengths, and host memory used with it must be
+  // aligned to the device logical block size.
+  IREE_IO_FILE_HANDLE_TYPE_FD = 1u,
+
+  // TODO(benvanik): FILE*, HANDLE, etc.
 } iree_io_file_handle_type_t;
 
 // A platform handle to a file primitive.
@@ -55,6 +76,8 @@ typedef enum iree_io_file_handle_type_e {
 typedef union iree_io_file_handle_primitive_value_t {
   // IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION
   iree_byte_span_t host_allocation;
+  // IREE_IO_FILE_HANDLE_TYPE_FD
+  int fd;
 } iree_io_file_handle_primitive_value_t;
 
 // A (type, value) pair describing a system file primitive handle.
@@ -112,6 +135,15 @@ IREE_API_EXPORT iree_status_t iree_io_file_handle_wrap_host_allocation(
     iree_io_file_handle_release_callback_t release_callback,
     iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle);
 
+// Opens the file at |path| with the given |mode| and returns a handle to it.
+// On POSIX platforms this produces an IREE_IO_FILE_HANDLE_TYPE_FD handle that
+// owns the file descriptor and closes it when the last reference is released.
+// Files opened with IREE_IO_FILE_MODE_DIRECT must be read-only.
+// Fails with IREE_STATUS_UNAVAILABLE on platforms without file descriptors.
+IREE_API_EXPORT iree_status_t iree_io_file_handle_open(
+    iree_io_file_mode_t mode, iree_string_view_t path,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_handle);
+
 // Retains the file |handle| for the caller.
 IREE_API_EXPORT void iree_io_file_handle_retain(iree_io_file_handle_t* handle);
 
@@ -151,6 +183,21 @@ static inline iree_io_file_handle_primitive_value_t iree_io_file_handle_value(
 IREE_API_EXPORT iree_status_t
 iree_io_file_handle_flush(iree_io_file_handle_t* handle);
 
+// Copies |length| bytes starting at |source_offset| in |source_handle| to
+// |target_offset| in |target_handle|. Host allocations are copied with
+// memcpy and file descriptors with positional reads/writes; on Linux copies
+// between two file descriptors use copy_file_range so that the data need not
+// round-trip through user memory. |host_allocator| may be used for transient
+// bounce buffers.
+//
+// No handle state is modified and copies to disjoint target ranges may be
+// issued concurrently from multiple threads. Sources opened with
+// IREE_IO_FILE_MODE_DIRECT are not supported.
+IREE_API_EXPORT iree_status_t iree_io_file_handle_copy(
+    iree_io_file_handle_t* source_handle, uint64_t source_offset,
+    iree_io_file_handle_t* target_handle, uint64_t target_offset,
+    uint64_t length, iree_allocator_t host_allocator);
+
 //===----------------------------------------------------------------------===//
 // iree_io_stream_t utilities
 //===----------------------------------------------------------------------===//
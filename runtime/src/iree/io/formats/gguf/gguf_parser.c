@@ -51,23 +51,23 @@
 #define GGUF_DEFAULT_ALIGNMENT 32
 
 enum ggml_type_e {
-  GGML_TYPE_F32 = 0,
-  GGML_TYPE_F16 = 1,
-  GGML_TYPE_Q4_0 = 2,
-  GGML_TYPE_Q4_1 = 3,
-  GGML_TYPE_Q5_0 = 6,
-  GGML_TYPE_Q5_1 = 7,
-  GGML_TYPE_Q8_0 = 8,
-  GGML_TYPE_Q8_1 = 9,
-  GGML_TYPE_Q2_K = 10,
-  GGML_TYPE_Q3_K = 11,
-  GGML_TYPE_Q4_K = 12,
-  GGML_TYPE_Q5_K = 13,
-  GGML_TYPE_Q6_K = 14,
-  GGML_TYPE_Q8_K = 15,
-  GGML_TYPE_I8 = 16,
-  GGML_TYPE_I16 = 17,
-  GGML_TYPE_I32 = 18,
+  GGML_TYPE_F32 = IREE_IO_GGUF_TENSOR_TYPE_F32,
+  GGML_TYPE_F16 = IREE_IO_GGUF_TENSOR_TYPE_F16,
+  GGML_TYPE_Q4_0 = IREE_IO_GGUF_TENSOR_TYPE_Q4_0,
+  GGML_TYPE_Q4_1 = IREE_IO_GGUF_TENSOR_TYPE_Q4_1,
+  GGML_TYPE_Q5_0 = IREE_IO_GGUF_TENSOR_TYPE_Q5_0,
+  GGML_TYPE_Q5_1 = IREE_IO_GGUF_TENSOR_TYPE_Q5_1,
+  GGML_TYPE_Q8_0 = IREE_IO_GGUF_TENSOR_TYPE_Q8_0,
+  GGML_TYPE_Q8_1 = IREE_IO_GGUF_TENSOR_TYPE_Q8_1,
+  GGML_TYPE_Q2_K = IREE_IO_GGUF_TENSOR_TYPE_Q2_K,
+  GGML_TYPE_Q3_K = IREE_IO_GGUF_TENSOR_TYPE_Q3_K,
+  GGML_TYPE_Q4_K = IREE_IO_GGUF_TENSOR_TYPE_Q4_K,
+  GGML_TYPE_Q5_K = IREE_IO_GGUF_TENSOR_TYPE_Q5_K,
+  GGML_TYPE_Q6_K = IREE_IO_GGUF_TENSOR_TYPE_Q6_K,
+  GGML_TYPE_Q8_K = IREE_IO_GGUF_TENSOR_TYPE_Q8_K,
+  GGML_TYPE_I8 = IREE_IO_GGUF_TENSOR_TYPE_I8,
+  GGML_TYPE_I16 = IREE_IO_GGUF_TENSOR_TYPE_I16,
+  GGML_TYPE_I32 = IREE_IO_GGUF_TENSOR_TYPE_I32,
   GGML_TYPE_COUNT,
 };
 typedef uint32_t ggml_type_t;
@@ -423,6 +423,11 @@ static iree_status_t iree_io_gguf_calculate_storage_size(
                             (int)tensor_info->type);
   }
   const ggml_type_traits_t type_traits = ggml_type_traits[tensor_info->type];
+  if (type_traits.blck_size == 0) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "GGML tensor type %d not supported",
+                            (int)tensor_info->type);
+  }
   *out_storage_size =
       (element_count * type_traits.type_size) / type_traits.blck_size;
   return iree_ok_status();
@@ -635,10 +640,29 @@ static iree_status_t iree_io_gguf_append_tensor_info(
                             begin, end, parser->tensor_data_size);
   }
 
+  // Describe the tensor storage so that consumers can interpret the native
+  // block layout. GGML tensors have at most 4 dimensions but we don't want to
+  // fail to index files with larger tensors if someone produces them.
+  const ggml_type_traits_t type_traits = ggml_type_traits[tensor_info->type];
+  iree_io_gguf_tensor_metadata_t tensor_metadata = {
+      .magic = IREE_IO_GGUF_TENSOR_METADATA_MAGIC,
+      .type = tensor_info->type,
+      .block_size = (uint32_t)type_traits.blck_size,
+      .block_byte_size = (uint32_t)type_traits.type_size,
+      .rank = tensor_info->n_dimensions,
+  };
+  iree_const_byte_span_t metadata = iree_const_byte_span_empty();
+  if (tensor_info->n_dimensions <= IREE_IO_GGUF_MAX_TENSOR_RANK) {
+    memcpy(tensor_metadata.shape, tensor_info->dimensions,
+           tensor_info->n_dimensions * sizeof(tensor_info->dimensions[0]));
+    metadata = iree_make_const_byte_span(&tensor_metadata,
+                                         sizeof(tensor_metadata));
+  }
+
   // Add entry to the index.
   iree_io_parameter_index_entry_t entry = {
       .key = tensor_info->name,
-      .metadata = iree_const_byte_span_empty(),
+      .metadata = metadata,
       .length = storage_size,
       .type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE,
       .storage =
@@ -726,6 +750,29 @@ static iree_status_t iree_io_parse_gguf_index_from_memory(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_io_gguf_tensor_metadata_parse(
+    iree_const_byte_span_t metadata,
+    iree_io_gguf_tensor_metadata_t* out_metadata) {
+  IREE_ASSERT_ARGUMENT(out_metadata);
+  memset(out_metadata, 0, sizeof(*out_metadata));
+  // Index metadata storage has no alignment guarantees so we copy it out.
+  uint32_t magic = 0;
+  if (metadata.data_length == sizeof(*out_metadata)) {
+    memcpy(&magic, metadata.data, sizeof(magic));
+  }
+  if (magic != IREE_IO_GGUF_TENSOR_METADATA_MAGIC) {
+    return iree_make_status(IREE_STATUS_NOT_FOUND,
+                            "metadata is not GGUF tensor metadata");
+  }
+  memcpy(out_metadata, metadata.data, sizeof(*out_metadata));
+  if (out_metadata->rank > IREE_IO_GGUF_MAX_TENSOR_RANK) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "GGUF tensor metadata rank %u exceeds the maximum",
+                            out_metadata->rank);
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_io_parse_gguf_index(
     iree_io_file_handle_t* file_handle, iree_io_parameter_index_t* index) {
   IREE_ASSERT_ARGUMENT(index);
@@ -15,7 +15,78 @@
 extern "C" {
 #endif  // __cplusplus
 
+//===----------------------------------------------------------------------===//
+// GGUF tensor metadata
+//===----------------------------------------------------------------------===//
+
+// Storage type of a GGUF tensor. Values match the GGML `ggml_type` enum.
+// Quantized types are stored as consecutive blocks of elements along the
+// fastest-varying dimension with each block using the layout defined by GGML
+// (such as `block_q4_K` for IREE_IO_GGUF_TENSOR_TYPE_Q4_K).
+enum iree_io_gguf_tensor_type_e {
+  IREE_IO_GGUF_TENSOR_TYPE_F32 = 0,
+  IREE_IO_GGUF_TENSOR_TYPE_F16 = 1,
+  IREE_IO_GGUF_TENSOR_TYPE_Q4_0 = 2,
+  IREE_IO_GGUF_TENSOR_TYPE_Q4_1 = 3,
+  IREE_IO_GGUF_TENSOR_TYPE_Q5_0 = 6,
+  IREE_IO_GGUF_TENSOR_TYPE_Q5_1 = 7,
+  IREE_IO_GGUF_TENSOR_TYPE_Q8_0 = 8,
+  IREE_IO_GGUF_TENSOR_TYPE_Q8_1 = 9,
+  IREE_IO_GGUF_TENSOR_TYPE_Q2_K = 10,
+  IREE_IO_GGUF_TENSOR_TYPE_Q3_K = 11,
+  IREE_IO_GGUF_TENSOR_TYPE_Q4_K = 12,
+  IREE_IO_GGUF_TENSOR_TYPE_Q5_K = 13,
+  IREE_IO_GGUF_TENSOR_TYPE_Q6_K = 14,
+  IREE_IO_GGUF_TENSOR_TYPE_Q8_K = 15,
+  IREE_IO_GGUF_TENSOR_TYPE_I8 = 16,
+  IREE_IO_GGUF_TENSOR_TYPE_I16 = 17,
+  IREE_IO_GGUF_TENSOR_TYPE_I32 = 18,
+};
+typedef uint32_t iree_io_gguf_tensor_type_t;
+
+// Maximum rank of a GGUF tensor (GGML_MAX_DIMS).
+#define IREE_IO_GGUF_MAX_TENSOR_RANK 4
+
+// Magic value identifying iree_io_gguf_tensor_metadata_t ('GGTM').
+#define IREE_IO_GGUF_TENSOR_METADATA_MAGIC 0x4D544747u
+
+// Type and layout of a GGUF tensor.
+// Stored in host byte order as the metadata of each parameter index entry
+// produced by iree_io_parse_gguf_index so that consumers can interpret the
+// native (possibly quantized) storage without converting it.
+typedef struct iree_io_gguf_tensor_metadata_t {
+  // IREE_IO_GGUF_TENSOR_METADATA_MAGIC.
+  uint32_t magic;
+  // Storage type of the tensor.
+  iree_io_gguf_tensor_type_t type;
+  // Number of elements in each storage block; 1 for non-quantized types.
+  uint32_t block_size;
+  // Size in bytes of each storage block.
+  uint32_t block_byte_size;
+  // Number of valid dimensions in |shape|.
+  uint32_t rank;
+  uint32_t reserved;
+  // Tensor dimensions ordered from fastest-varying (GGML `ne[0]`, the
+  // dimension along which quantized blocks are formed) to slowest-varying.
+  uint64_t shape[IREE_IO_GGUF_MAX_TENSOR_RANK];
+} iree_io_gguf_tensor_metadata_t;
+
+// Decodes the GGUF tensor |metadata| of a parameter index entry.
+// Returns IREE_STATUS_NOT_FOUND if the metadata is not GGUF tensor metadata.
+IREE_API_EXPORT iree_status_t iree_io_gguf_tensor_metadata_parse(
+    iree_const_byte_span_t metadata,
+    iree_io_gguf_tensor_metadata_t* out_metadata);
+
+//===----------------------------------------------------------------------===//
+// GGUF parser
+//===----------------------------------------------------------------------===//
+
 // Parses a .gguf file and merges its contained resources into |index|.
+// Each tensor is added as a file-backed entry referencing its storage in
+// |file_handle| without any conversion such that mapped files can be imported
+// directly by devices. Entry metadata is an iree_io_gguf_tensor_metadata_t
+// describing the tensor type and shape for tensors of rank <=
+// IREE_IO_GGUF_MAX_TENSOR_RANK.
 //
 // Specification:
 // https://github.com/ggerganov/ggml/blob/master/docs/gguf.md
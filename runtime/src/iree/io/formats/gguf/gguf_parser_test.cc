@@ -6,6 +6,8 @@
 
 #include "iree/io/formats/gguf/gguf_parser.h"
 
+#include <vector>
+
 #include "iree/io/formats/gguf/testdata/gguf_files.h"
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -13,6 +15,8 @@
 namespace iree {
 namespace {
 
+using ::iree::testing::status::StatusIs;
+
 static iree_io_file_handle_t* OpenTestFile(const char* name) {
   const struct iree_file_toc_t* file_toc = iree_io_gguf_files_create();
   for (size_t i = 0; i < iree_io_gguf_files_size(); ++i) {
@@ -32,6 +36,21 @@ static iree_io_file_handle_t* OpenTestFile(const char* name) {
   return NULL;
 }
 
+// Verifies |entry| has GGUF tensor metadata for an F32 tensor of |shape|.
+static void ExpectF32TensorMetadata(
+    const iree_io_parameter_index_entry_t* entry, std::vector<uint64_t> shape) {
+  iree_io_gguf_tensor_metadata_t metadata;
+  IREE_ASSERT_OK(
+      iree_io_gguf_tensor_metadata_parse(entry->metadata, &metadata));
+  EXPECT_EQ(metadata.type, IREE_IO_GGUF_TENSOR_TYPE_F32);
+  EXPECT_EQ(metadata.block_size, 1);
+  EXPECT_EQ(metadata.block_byte_size, sizeof(float));
+  ASSERT_EQ(metadata.rank, shape.size());
+  for (size_t i = 0; i < shape.size(); ++i) {
+    EXPECT_EQ(metadata.shape[i], shape[i]);
+  }
+}
+
 TEST(GgufFormatTest, Empty) {
   iree_io_parameter_index_t* index = NULL;
   IREE_ASSERT_OK(
@@ -57,7 +76,7 @@ TEST(GgufFormatTest, SingleTensor) {
   IREE_ASSERT_OK(
       iree_io_parameter_index_lookup(index, IREE_SV("tensor0"), &entry0));
   EXPECT_TRUE(iree_string_view_equal(IREE_SV("tensor0"), entry0->key));
-  EXPECT_TRUE(iree_const_byte_span_is_empty(entry0->metadata));
+  ExpectF32TensorMetadata(entry0, {2, 2});
   EXPECT_EQ(entry0->storage.file.offset, 384);
   EXPECT_EQ(entry0->length, 16);
 
@@ -78,7 +97,7 @@ TEST(GgufFormatTest, SingleTensorV2) {
   IREE_ASSERT_OK(
       iree_io_parameter_index_lookup(index, IREE_SV("tensor0"), &entry0));
   EXPECT_TRUE(iree_string_view_equal(IREE_SV("tensor0"), entry0->key));
-  EXPECT_TRUE(iree_const_byte_span_is_empty(entry0->metadata));
+  ExpectF32TensorMetadata(entry0, {2, 2});
   EXPECT_EQ(entry0->storage.file.offset, 384);
   EXPECT_EQ(entry0->length, 16);
 
@@ -98,7 +117,7 @@ TEST(GgufFormatTest, MultipleTensors) {
   IREE_ASSERT_OK(
       iree_io_parameter_index_lookup(index, IREE_SV("tensor0"), &entry0));
   EXPECT_TRUE(iree_string_view_equal(IREE_SV("tensor0"), entry0->key));
-  EXPECT_TRUE(iree_const_byte_span_is_empty(entry0->metadata));
+  ExpectF32TensorMetadata(entry0, {2, 2});
   EXPECT_EQ(entry0->storage.file.offset, 448);
   EXPECT_EQ(entry0->length, 16);
 
@@ -106,7 +125,7 @@ TEST(GgufFormatTest, MultipleTensors) {
   IREE_ASSERT_OK(
       iree_io_parameter_index_lookup(index, IREE_SV("tensor1"), &entry1));
   EXPECT_TRUE(iree_string_view_equal(IREE_SV("tensor1"), entry1->key));
-  EXPECT_TRUE(iree_const_byte_span_is_empty(entry1->metadata));
+  ExpectF32TensorMetadata(entry1, {2, 1});
   EXPECT_EQ(entry1->storage.file.offset, 512);
   EXPECT_EQ(entry1->length, 8);
 
@@ -114,12 +133,23 @@ TEST(GgufFormatTest, MultipleTensors) {
   IREE_ASSERT_OK(
       iree_io_parameter_index_lookup(index, IREE_SV("tensor2"), &entry2));
   EXPECT_TRUE(iree_string_view_equal(IREE_SV("tensor2"), entry2->key));
-  EXPECT_TRUE(iree_const_byte_span_is_empty(entry2->metadata));
+  ExpectF32TensorMetadata(entry2, {3, 4});
   EXPECT_EQ(entry2->storage.file.offset, 576);
   EXPECT_EQ(entry2->length, 48);
 
   iree_io_parameter_index_release(index);
 }
 
+TEST(GgufFormatTest, NonTensorMetadata) {
+  iree_io_gguf_tensor_metadata_t metadata;
+  EXPECT_THAT(Status(iree_io_gguf_tensor_metadata_parse(
+                  iree_const_byte_span_empty(), &metadata)),
+              StatusIs(StatusCode::kNotFound));
+  uint8_t bytes[sizeof(metadata)] = {0};
+  EXPECT_THAT(Status(iree_io_gguf_tensor_metadata_parse(
+                  iree_make_const_byte_span(bytes, sizeof(bytes)), &metadata)),
+              StatusIs(StatusCode::kNotFound));
+}
+
 }  // namespace
 }  // namespace iree
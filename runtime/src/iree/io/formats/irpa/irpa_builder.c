@@ -6,6 +6,10 @@
 
 #include "iree/io/formats/irpa/irpa_builder.h"
 
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_initialize(
     iree_allocator_t host_allocator,
     iree_io_parameter_archive_builder_t* out_builder) {
@@ -48,6 +52,16 @@ iree_io_parameter_archive_builder_storage_offset(
       iree_io_parameter_archive_builder_storage_alignment(builder));
 }
 
+// Returns the size of each data entry in the entry table.
+static iree_io_physical_size_t
+iree_io_parameter_archive_builder_data_entry_size(
+    const iree_io_parameter_archive_builder_t* builder) {
+  return sizeof(iree_io_parameter_archive_data_entry_t) +
+         (builder->reserve_content_hashes
+              ? sizeof(iree_io_parameter_archive_content_hash_t)
+              : 0);
+}
+
 IREE_API_EXPORT iree_io_physical_size_t
 iree_io_parameter_archive_builder_total_size(
     const iree_io_parameter_archive_builder_t* builder) {
@@ -168,7 +182,9 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
         iree_io_parameter_archive_data_entry_t data_entry = {
             .header =
                 {
-                    .entry_size = sizeof(data_entry),
+                    .entry_size =
+                        iree_io_parameter_archive_builder_data_entry_size(
+                            builder),
                     .type = IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_DATA,
                     .flags = 0,
                     .name = name_ref,
@@ -186,6 +202,13 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
         target_entry.storage.file.offset += storage_segment.offset;
         IREE_RETURN_AND_END_ZONE_IF_ERROR(
             z0, iree_io_stream_write(stream, sizeof(data_entry), &data_entry));
+        if (builder->reserve_content_hashes) {
+          // Zeroed until written; ignored by readers until the flag is set.
+          const iree_io_parameter_archive_content_hash_t content_hash = {0};
+          IREE_RETURN_AND_END_ZONE_IF_ERROR(
+              z0, iree_io_stream_write(stream, sizeof(content_hash),
+                                       &content_hash));
+        }
         break;
       }
       default: {
@@ -223,6 +246,76 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_archive_builder_write_content_hashes(
+    const iree_io_parameter_archive_builder_t* builder,
+    const uint64_t* content_hashes, iree_io_stream_t* stream) {
+  IREE_ASSERT_ARGUMENT(builder);
+  IREE_ASSERT_ARGUMENT(!iree_io_parameter_index_count(builder->index) ||
+                       content_hashes);
+  IREE_ASSERT_ARGUMENT(stream);
+  if (!builder->reserve_content_hashes) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "builder did not reserve content hashes");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Walk the entry table as laid out by iree_io_parameter_archive_builder_write
+  // and set the flag and hash of each data entry.
+  iree_io_physical_offset_t entry_offset =
+      iree_align_uint64(sizeof(iree_io_parameter_archive_header_v0_t),
+                        IREE_IO_PARAMETER_ARCHIVE_ENTRY_ALIGNMENT);
+  for (iree_host_size_t i = 0;
+       i < iree_io_parameter_index_count(builder->index); ++i) {
+    entry_offset = iree_align_uint64(entry_offset,
+                                     IREE_IO_PARAMETER_ARCHIVE_ENTRY_ALIGNMENT);
+    const iree_io_parameter_index_entry_t* source_entry = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_parameter_index_get(builder->index, i, &source_entry));
+    switch (source_entry->type) {
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT: {
+        entry_offset += sizeof(iree_io_parameter_archive_splat_entry_t);
+        break;
+      }
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE: {
+        const iree_io_parameter_archive_entry_flags_t flags =
+            IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_CONTENT_HASH;
+        const iree_io_parameter_archive_content_hash_t content_hash = {
+            .value = content_hashes[i],
+        };
+        const iree_io_physical_offset_t flags_offset =
+            entry_offset +
+            offsetof(iree_io_parameter_archive_entry_header_t, flags);
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_io_stream_seek(stream, IREE_IO_STREAM_SEEK_SET,
+                                    flags_offset));
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_io_stream_write(stream, sizeof(flags), &flags));
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_io_stream_seek(
+                    stream, IREE_IO_STREAM_SEEK_SET,
+                    entry_offset +
+                        sizeof(iree_io_parameter_archive_data_entry_t)));
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_io_stream_write(stream, sizeof(content_hash),
+                                     &content_hash));
+        entry_offset +=
+            iree_io_parameter_archive_builder_data_entry_size(builder);
+        break;
+      }
+      default: {
+        IREE_RETURN_AND_END_ZONE_IF_ERROR(
+            z0, iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                 "unhandled entry type %d",
+                                 (int)source_entry->type));
+      }
+    }
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_splat_entry(
     iree_io_parameter_archive_builder_t* builder, iree_string_view_t name,
     iree_const_byte_span_t metadata, const void* pattern,
@@ -292,7 +385,7 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
   builder->entry_segment_size =
       iree_align_uint64(builder->entry_segment_size,
                         IREE_IO_PARAMETER_ARCHIVE_ENTRY_ALIGNMENT) +
-      sizeof(iree_io_parameter_archive_data_entry_t);
+      iree_io_parameter_archive_builder_data_entry_size(builder);
   builder->metadata_segment_size += name.size + metadata.data_length;
   builder->storage_segment_size = entry.storage.file.offset + entry.length;
   if (!builder->storage_alignment) {
@@ -303,19 +396,330 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_add_data_entry(
   return iree_ok_status();
 }
 
+// A contiguous block of a data entry's contents copied by a single worker.
+typedef struct iree_io_parameter_archive_copy_block_t {
+  // Source file handle (retained by the source index).
+  iree_io_file_handle_t* source_handle;
+  // Offset of the block in the source file.
+  uint64_t source_offset;
+  // Absolute offset of the block in the target file.
+  uint64_t target_offset;
+  // Length of the block in bytes.
+  uint64_t length;
+  // FNV-1a hash of the block contents if checksums were requested.
+  uint64_t checksum;
+} iree_io_parameter_archive_copy_block_t;
+
+// State shared by all workers copying blocks into the target file.
+typedef struct iree_io_parameter_archive_copy_t {
+  iree_io_file_handle_t* target_handle;
+  bool compute_checksums;
+  iree_allocator_t host_allocator;
+  iree_host_size_t block_count;
+  iree_io_parameter_archive_copy_block_t* blocks;
+  // Index of the next block to be claimed by a worker.
+  iree_atomic_int32_t next_block;
+  // Set when any worker fails so the others stop claiming blocks.
+  iree_atomic_int32_t failed;
+  iree_slim_mutex_t mutex;
+  // First failure of any worker.
+  iree_status_t status IREE_GUARDED_BY(mutex);
+} iree_io_parameter_archive_copy_t;
+
+#define IREE_IO_PARAMETER_ARCHIVE_FNV1A_OFFSET_BASIS 0xCBF29CE484222325ull
+#define IREE_IO_PARAMETER_ARCHIVE_FNV1A_PRIME 0x100000001B3ull
+
+static uint64_t iree_io_parameter_archive_fnv1a(uint64_t hash,
+                                                const uint8_t* data,
+                                                iree_host_size_t length) {
+  for (iree_host_size_t i = 0; i < length; ++i) {
+    hash ^= data[i];
+    hash *= IREE_IO_PARAMETER_ARCHIVE_FNV1A_PRIME;
+  }
+  return hash;
+}
+
+static iree_status_t iree_io_parameter_archive_copy_block(
+    iree_io_parameter_archive_copy_t* copy,
+    iree_io_parameter_archive_copy_block_t* block) {
+  IREE_RETURN_IF_ERROR(iree_io_file_handle_copy(
+      block->source_handle, block->source_offset, copy->target_handle,
+      block->target_offset, block->length, copy->host_allocator));
+  if (!copy->compute_checksums) return iree_ok_status();
+
+  // Prefer hashing the target as the contents were just written and are
+  // likely still in cache. The copy has already validated the ranges.
+  iree_io_file_handle_primitive_t primitive =
+      iree_io_file_handle_primitive(copy->target_handle);
+  uint64_t offset = block->target_offset;
+  if (primitive.type != IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
+    primitive = iree_io_file_handle_primitive(block->source_handle);
+    offset = block->source_offset;
+  }
+  if (primitive.type != IREE_IO_FILE_HANDLE_TYPE_HOST_ALLOCATION) {
+    return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                            "checksums require either the source or target "
+                            "file to be a host allocation");
+  }
+  block->checksum = iree_io_parameter_archive_fnv1a(
+      IREE_IO_PARAMETER_ARCHIVE_FNV1A_OFFSET_BASIS,
+      primitive.value.host_allocation.data + offset,
+      (iree_host_size_t)block->length);
+  return iree_ok_status();
+}
+
+static int iree_io_parameter_archive_copy_worker(void* entry_arg) {
+  iree_io_parameter_archive_copy_t* copy =
+      (iree_io_parameter_archive_copy_t*)entry_arg;
+  while (!iree_atomic_load(&copy->failed, iree_memory_order_relaxed)) {
+    int32_t block_index =
+        iree_atomic_fetch_add(&copy->next_block, 1, iree_memory_order_relaxed);
+    if (block_index >= (int32_t)copy->block_count) break;
+    iree_status_t status =
+        iree_io_parameter_archive_copy_block(copy, &copy->blocks[block_index]);
+    if (!iree_status_is_ok(status)) {
+      iree_slim_mutex_lock(&copy->mutex);
+      if (iree_status_is_ok(copy->status)) {
+        copy->status = status;
+      } else {
+        iree_status_ignore(status);
+      }
+      iree_slim_mutex_unlock(&copy->mutex);
+      iree_atomic_store(&copy->failed, 1, iree_memory_order_relaxed);
+      break;
+    }
+  }
+  return 0;
+}
+
+// Copies all blocks using up to |worker_count| threads (including the calling
+// thread) and returns the first failure of any of them.
+static iree_status_t iree_io_parameter_archive_copy_run(
+    iree_io_parameter_archive_copy_t* copy, iree_host_size_t worker_count) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)copy->block_count);
+  worker_count = iree_min(worker_count, copy->block_count);
+
+  // The calling thread acts as one of the workers.
+  iree_host_size_t thread_count = worker_count > 1 ? worker_count - 1 : 0;
+  iree_thread_t** threads = NULL;
+  iree_status_t status = iree_ok_status();
+  if (thread_count > 0) {
+    status = iree_allocator_malloc(copy->host_allocator,
+                                   thread_count * sizeof(threads[0]),
+                                   (void**)&threads);
+    if (!iree_status_is_ok(status)) thread_count = 0;
+  }
+  iree_host_size_t created_count = 0;
+  for (; iree_status_is_ok(status) && created_count < thread_count;
+       ++created_count) {
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = iree_make_cstring_view("iree-irpa-copy");
+    status = iree_thread_create(iree_io_parameter_archive_copy_worker, copy,
+                                params, copy->host_allocator,
+                                &threads[created_count]);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  // Even if not all threads could be created we proceed with those that were
+  // as they are already claiming blocks.
+  iree_status_ignore(status);
+  iree_io_parameter_archive_copy_worker(copy);
+  for (iree_host_size_t i = 0; i < created_count; ++i) {
+    iree_thread_join(threads[i]);
+    iree_thread_release(threads[i]);
+  }
+  iree_allocator_free(copy->host_allocator, threads);
+
+  iree_slim_mutex_lock(&copy->mutex);
+  status = copy->status;
+  copy->status = iree_ok_status();
+  iree_slim_mutex_unlock(&copy->mutex);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Returns the number of blocks the contents of |source_entry| are split into.
+static iree_host_size_t iree_io_parameter_archive_entry_block_count(
+    const iree_io_parameter_index_entry_t* source_entry) {
+  if (source_entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+    return 0;
+  }
+  const uint64_t block_size = IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_BLOCK_SIZE;
+  return (iree_host_size_t)((source_entry->length + block_size - 1) /
+                            block_size);
+}
+
+// Copies the contents of all data entries in |source_index| to their
+// locations in |target_index| and optionally reports their checksums.
+// If provided |out_entry_checksums| receives the checksum of each entry in
+// |source_index| (0 for splats).
+static iree_status_t iree_io_parameter_archive_copy_contents(
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index,
+    iree_io_file_handle_t* target_file_handle,
+    iree_io_physical_offset_t target_file_offset,
+    const iree_io_parameter_archive_build_options_t* options,
+    iree_allocator_t host_allocator, uint64_t* out_entry_checksums) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Split each data entry into blocks. Splats have no contents to copy.
+  iree_host_size_t entry_count = iree_io_parameter_index_count(source_index);
+  iree_host_size_t block_count = 0;
+  for (iree_host_size_t i = 0; i < entry_count; ++i) {
+    const iree_io_parameter_index_entry_t* source_entry = NULL;
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_parameter_index_get(source_index, i, &source_entry));
+    block_count += iree_io_parameter_archive_entry_block_count(source_entry);
+  }
+  if (block_count > INT32_MAX) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_RESOURCE_EXHAUSTED,
+                            "too many blocks (%" PRIhsz ") to copy",
+                            block_count);
+  }
+
+  iree_io_parameter_archive_copy_t copy;
+  memset(&copy, 0, sizeof(copy));
+  copy.target_handle = target_file_handle;
+  copy.compute_checksums =
+      options->checksum.fn != NULL || out_entry_checksums != NULL;
+  copy.host_allocator = host_allocator;
+  copy.block_count = block_count;
+  iree_atomic_store(&copy.next_block, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&copy.failed, 0, iree_memory_order_relaxed);
+  iree_slim_mutex_initialize(&copy.mutex);
+  copy.status = iree_ok_status();
+  iree_status_t status = iree_ok_status();
+  if (block_count > 0) {
+    status = iree_allocator_malloc(host_allocator,
+                                   block_count * sizeof(copy.blocks[0]),
+                                   (void**)&copy.blocks);
+  }
+
+  iree_host_size_t block_index = 0;
+  for (iree_host_size_t i = 0; iree_status_is_ok(status) && i < entry_count;
+       ++i) {
+    const iree_io_parameter_index_entry_t* source_entry = NULL;
+    status = iree_io_parameter_index_get(source_index, i, &source_entry);
+    if (!iree_status_is_ok(status)) break;
+    switch (source_entry->type) {
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT:
+        // No work to do.
+        break;
+      case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE: {
+        const iree_io_parameter_index_entry_t* target_entry = NULL;
+        status = iree_io_parameter_index_lookup(
+            target_index, source_entry->key, &target_entry);
+        if (!iree_status_is_ok(status)) break;
+        for (uint64_t offset = 0; offset < source_entry->length;
+             offset += IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_BLOCK_SIZE) {
+          iree_io_parameter_archive_copy_block_t* block =
+              &copy.blocks[block_index++];
+          block->source_handle = source_entry->storage.file.handle;
+          block->source_offset = source_entry->storage.file.offset + offset;
+          block->target_offset =
+              target_file_offset + target_entry->storage.file.offset + offset;
+          block->length =
+              iree_min(source_entry->length - offset,
+                       (uint64_t)IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_BLOCK_SIZE);
+        }
+        break;
+      }
+      default:
+        status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                  "unhandled index entry storage type %d",
+                                  (int)source_entry->type);
+        break;
+    }
+  }
+
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_archive_copy_run(&copy, options->worker_count);
+  }
+
+  // Combine block hashes into entry checksums and report them in order.
+  if (iree_status_is_ok(status) && copy.compute_checksums) {
+    block_index = 0;
+    for (iree_host_size_t i = 0; i < entry_count; ++i) {
+      const iree_io_parameter_index_entry_t* source_entry = NULL;
+      status = iree_io_parameter_index_get(source_index, i, &source_entry);
+      if (!iree_status_is_ok(status)) break;
+      if (out_entry_checksums) out_entry_checksums[i] = 0;
+      if (source_entry->type !=
+          IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+        continue;
+      }
+      uint64_t checksum = IREE_IO_PARAMETER_ARCHIVE_FNV1A_OFFSET_BASIS;
+      iree_host_size_t entry_block_count =
+          iree_io_parameter_archive_entry_block_count(source_entry);
+      for (iree_host_size_t j = 0; j < entry_block_count; ++j) {
+        uint64_t block_checksum = copy.blocks[block_index++].checksum;
+        uint8_t block_bytes[sizeof(block_checksum)];
+        for (iree_host_size_t k = 0; k < sizeof(block_bytes); ++k) {
+          block_bytes[k] = (uint8_t)(block_checksum >> (k * 8));
+        }
+        checksum = iree_io_parameter_archive_fnv1a(checksum, block_bytes,
+                                                   sizeof(block_bytes));
+      }
+      if (out_entry_checksums) out_entry_checksums[i] = checksum;
+      if (options->checksum.fn) {
+        status = options->checksum.fn(options->checksum.user_data,
+                                      source_entry->key, checksum);
+        if (!iree_status_is_ok(status)) break;
+      }
+    }
+  }
+
+  iree_allocator_free(host_allocator, copy.blocks);
+  iree_slim_mutex_deinitialize(&copy.mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
     iree_io_parameter_index_t* source_index,
     iree_io_parameter_index_t* target_index,
     iree_io_parameter_archive_file_open_callback_t target_file_open,
     iree_io_physical_offset_t target_file_offset,
     iree_allocator_t host_allocator) {
+  return iree_io_build_parameter_archive_with_options(
+      source_index, target_index, target_file_open, target_file_offset,
+      /*options=*/NULL, host_allocator);
+}
+
+IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive_with_options(
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index,
+    iree_io_parameter_archive_file_open_callback_t target_file_open,
+    iree_io_physical_offset_t target_file_offset,
+    const iree_io_parameter_archive_build_options_t* options,
+    iree_allocator_t host_allocator) {
   IREE_ASSERT_ARGUMENT(source_index);
   IREE_ASSERT_ARGUMENT(target_index);
   IREE_ASSERT_ARGUMENT(target_file_open.fn);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_io_parameter_archive_build_options_t default_options;
+  memset(&default_options, 0, sizeof(default_options));
+  if (!options) options = &default_options;
+  const iree_io_physical_size_t data_alignment =
+      options->data_alignment
+          ? options->data_alignment
+          : IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT;
+  if (!iree_is_power_of_two_uint64(data_alignment)) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "data alignment must be a power of two; got %" PRIu64, data_alignment);
+  }
+
   iree_io_parameter_archive_builder_t builder;
   iree_io_parameter_archive_builder_initialize(host_allocator, &builder);
+  builder.reserve_content_hashes = options->content_hashes;
+  builder.file_alignment = iree_max(builder.file_alignment, data_alignment);
 
   // Declare a parameter for each entry in the index.
   // This lets us calculate the size we require to store the entry metadata and
@@ -336,8 +740,7 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
       case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
         status = iree_io_parameter_archive_builder_add_data_entry(
             &builder, source_entry->key, source_entry->metadata,
-            IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT,
-            source_entry->length);
+            data_alignment, source_entry->length);
         break;
       default:
         status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
@@ -375,42 +778,29 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
         target_index);
   }
 
-  // Copy over parameter entry file contents (if any).
-  // This is a slow operation and something we could optimize with lower-level
-  // platform primitives.
+  // Storage for the content hash of each entry computed while copying.
+  iree_host_size_t entry_count = iree_io_parameter_index_count(source_index);
+  uint64_t* content_hashes = NULL;
+  if (iree_status_is_ok(status) && options->content_hashes && entry_count) {
+    status = iree_allocator_malloc(host_allocator,
+                                   entry_count * sizeof(content_hashes[0]),
+                                   (void**)&content_hashes);
+  }
+
+  // Copy over parameter entry file contents (if any). Each entry has a fixed
+  // location in the target file so blocks can be copied independently.
   if (iree_status_is_ok(status)) {
-    for (iree_host_size_t i = 0;
-         i < iree_io_parameter_index_count(source_index); ++i) {
-      const iree_io_parameter_index_entry_t* source_entry = NULL;
-      status = iree_io_parameter_index_get(source_index, i, &source_entry);
-      if (!iree_status_is_ok(status)) break;
-      const iree_io_parameter_index_entry_t* target_entry = NULL;
-      status = iree_io_parameter_index_lookup(target_index, source_entry->key,
-                                              &target_entry);
-      if (!iree_status_is_ok(status)) break;
-      switch (source_entry->type) {
-        case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT:
-          // No work to do.
-          break;
-        case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE:
-          status = iree_io_stream_seek(
-              target_stream, IREE_IO_STREAM_SEEK_SET,
-              target_file_offset + target_entry->storage.file.offset);
-          if (!iree_status_is_ok(status)) break;
-          status = iree_io_stream_write_file(
-              target_stream, source_entry->storage.file.handle,
-              source_entry->storage.file.offset, target_entry->length,
-              host_allocator);
-          break;
-        default:
-          status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                    "unhandled index entry storage type %d",
-                                    (int)source_entry->type);
-          break;
-      }
-      if (!iree_status_is_ok(status)) break;
-    }
+    status = iree_io_parameter_archive_copy_contents(
+        source_index, target_index, target_file_handle, target_file_offset,
+        options, host_allocator, content_hashes);
+  }
+
+  // Now that the contents are known commit their hashes to the entry table.
+  if (iree_status_is_ok(status) && content_hashes) {
+    status = iree_io_parameter_archive_builder_write_content_hashes(
+        &builder, content_hashes, target_stream);
   }
+  iree_allocator_free(host_allocator, content_hashes);
 
   iree_io_stream_release(target_stream);
 
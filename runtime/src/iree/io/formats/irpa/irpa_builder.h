@@ -40,6 +40,10 @@ typedef struct iree_io_parameter_archive_builder_t {
   iree_io_physical_size_t metadata_segment_size;
   iree_io_physical_size_t storage_segment_size;
   iree_io_physical_size_t storage_alignment;
+  // Reserves space for a content hash after each data entry. Must be set prior
+  // to adding entries. Hashes are written after the entry contents with
+  // iree_io_parameter_archive_builder_write_content_hashes.
+  bool reserve_content_hashes;
 } iree_io_parameter_archive_builder_t;
 
 // Initializes a new parameter builder in |out_builder| for use.
@@ -74,6 +78,16 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_archive_builder_write(
     iree_io_file_handle_t* file_handle, iree_io_physical_offset_t file_offset,
     iree_io_stream_t* stream, iree_io_parameter_index_t* target_index);
 
+// Writes the |content_hashes| of each entry in the archive previously written
+// to |stream| by iree_io_parameter_archive_builder_write. |content_hashes| has
+// one value per entry in the order entries were added; values for splat
+// entries are ignored. The builder must have been created with
+// |reserve_content_hashes| set.
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_archive_builder_write_content_hashes(
+    const iree_io_parameter_archive_builder_t* builder,
+    const uint64_t* content_hashes, iree_io_stream_t* stream);
+
 // Adds a new splat entry to |builder|.
 // Splat entries have no physical storage and exist only in the header.
 // |pattern| and |metadata| (if provided) are copied prior to returning.
@@ -121,6 +135,61 @@ IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive(
     iree_io_physical_offset_t target_file_offset,
     iree_allocator_t host_allocator);
 
+// Size of the blocks data entry contents are divided into for copying and
+// checksumming. Fixed as it is part of the checksum definition.
+#define IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_BLOCK_SIZE \
+  IREE_IO_PARAMETER_ARCHIVE_CONTENT_HASH_BLOCK_SIZE
+
+// Called once per data entry with the checksum of its contents.
+// The checksum is the content hash as defined by
+// iree_io_parameter_archive_content_hash_t.
+typedef iree_status_t(IREE_API_PTR* iree_io_parameter_archive_checksum_fn_t)(
+    void* user_data, iree_string_view_t key, uint64_t checksum);
+
+// A callback issued with the checksum of each data entry.
+typedef struct {
+  // Callback function pointer.
+  iree_io_parameter_archive_checksum_fn_t fn;
+  // User data passed to the callback function. Unowned.
+  void* user_data;
+} iree_io_parameter_archive_checksum_callback_t;
+
+// Options controlling how iree_io_build_parameter_archive_with_options
+// produces the archive. Zero-initialized options match
+// iree_io_build_parameter_archive.
+typedef struct iree_io_parameter_archive_build_options_t {
+  // Number of threads used to copy entry contents. The layout of the archive
+  // is computed up-front so that each thread copies disjoint ranges directly
+  // into the target file. 0 or 1 copies on the calling thread.
+  iree_host_size_t worker_count;
+  // Optional callback receiving the checksum of each data entry. Checksums
+  // are computed by the copying threads and the callback is issued on the
+  // calling thread in source index order once all contents are written.
+  // Requires either the target file or the entry source to be a host
+  // allocation.
+  iree_io_parameter_archive_checksum_callback_t checksum;
+  // Stores the checksum of each data entry in the archive as its content hash
+  // (see IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_CONTENT_HASH). Has the same
+  // requirements as |checksum|.
+  bool content_hashes;
+  // Alignment in bytes of each data entry in the archive. Must be a power of
+  // two. Memory-mapped archives can be imported directly as device buffers
+  // when entries meet the device alignment requirements and using the page
+  // size (4096) allows any entry to be mapped independently. 0 uses
+  // IREE_IO_PARAMETER_ARCHIVE_DEFAULT_DATA_ALIGNMENT.
+  iree_io_physical_size_t data_alignment;
+} iree_io_parameter_archive_build_options_t;
+
+// Builds a parameter archive as with iree_io_build_parameter_archive using the
+// provided |options|.
+IREE_API_EXPORT iree_status_t iree_io_build_parameter_archive_with_options(
+    iree_io_parameter_index_t* source_index,
+    iree_io_parameter_index_t* target_index,
+    iree_io_parameter_archive_file_open_callback_t target_file_open,
+    iree_io_physical_offset_t target_file_offset,
+    const iree_io_parameter_archive_build_options_t* options,
+    iree_allocator_t host_allocator);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
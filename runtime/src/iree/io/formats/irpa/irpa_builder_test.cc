@@ -0,0 +1,286 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/formats/irpa/irpa_builder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "iree/io/formats/irpa/irpa_parser.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+// Reference implementation of the documented checksum.
+static uint64_t ReferenceChecksum(const uint8_t* data, uint64_t length) {
+  auto fnv1a = [](uint64_t hash, const uint8_t* bytes, uint64_t count) {
+    for (uint64_t i = 0; i < count; ++i) {
+      hash ^= bytes[i];
+      hash *= 0x100000001B3ull;
+    }
+    return hash;
+  };
+  uint64_t checksum = 0xCBF29CE484222325ull;
+  for (uint64_t offset = 0; offset < length;
+       offset += IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_BLOCK_SIZE) {
+    uint64_t block_length =
+        std::min<uint64_t>(length - offset,
+                           IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_BLOCK_SIZE);
+    uint64_t block_checksum =
+        fnv1a(0xCBF29CE484222325ull, data + offset, block_length);
+    uint8_t block_bytes[8];
+    for (int i = 0; i < 8; ++i) {
+      block_bytes[i] = (uint8_t)(block_checksum >> (i * 8));
+    }
+    checksum = fnv1a(checksum, block_bytes, sizeof(block_bytes));
+  }
+  return checksum;
+}
+
+class IrpaBuilderTest : public ::testing::Test {
+ protected:
+  struct BuiltArchive {
+    std::vector<uint8_t> contents;
+    std::vector<std::pair<std::string, uint64_t>> checksums;
+  };
+
+  void SetUp() override {
+    // Large enough that the first entry is split into multiple blocks with a
+    // short tail.
+    source_.resize(2 * IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_BLOCK_SIZE +
+                   5 * 1024 * 1024 + 123);
+    for (size_t i = 0; i < source_.size(); ++i) {
+      source_[i] = (uint8_t)(i * 31 + (i >> 13));
+    }
+    IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+        IREE_IO_FILE_ACCESS_READ,
+        iree_make_byte_span(source_.data(), source_.size()),
+        iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+        &source_handle_));
+    IREE_ASSERT_OK(
+        iree_io_parameter_index_create(iree_allocator_system(), &index_));
+    AddFileEntry("large", 0,
+                 2 * IREE_IO_PARAMETER_ARCHIVE_CHECKSUM_BLOCK_SIZE + 7);
+    AddFileEntry("small", 3, 100);
+    AddFileEntry("empty", 0, 0);
+    AddFileEntry("tail", source_.size() - 5 * 1024 * 1024,
+                 5 * 1024 * 1024);
+    iree_io_parameter_index_entry_t splat_entry;
+    memset(&splat_entry, 0, sizeof(splat_entry));
+    splat_entry.key = IREE_SV("splat");
+    splat_entry.length = 64;
+    splat_entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT;
+    splat_entry.storage.splat.pattern_length = 1;
+    splat_entry.storage.splat.pattern[0] = 0xAB;
+    IREE_ASSERT_OK(iree_io_parameter_index_add(index_, &splat_entry));
+  }
+
+  void TearDown() override {
+    iree_io_parameter_index_release(index_);
+    iree_io_file_handle_release(source_handle_);
+  }
+
+  void AddFileEntry(const char* key, uint64_t offset, uint64_t length) {
+    iree_io_parameter_index_entry_t entry;
+    memset(&entry, 0, sizeof(entry));
+    entry.key = iree_make_cstring_view(key);
+    entry.length = length;
+    entry.type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE;
+    entry.storage.file.handle = source_handle_;
+    entry.storage.file.offset = offset;
+    IREE_ASSERT_OK(iree_io_parameter_index_add(index_, &entry));
+  }
+
+  static iree_status_t OpenArchive(void* user_data,
+                                   iree_io_physical_offset_t archive_offset,
+                                   iree_io_physical_size_t archive_length,
+                                   iree_io_file_handle_t** out_file_handle) {
+    auto* contents = reinterpret_cast<std::vector<uint8_t>*>(user_data);
+    contents->resize(archive_offset + archive_length);
+    return iree_io_file_handle_wrap_host_allocation(
+        IREE_IO_FILE_ACCESS_READ | IREE_IO_FILE_ACCESS_WRITE,
+        iree_make_byte_span(contents->data(), contents->size()),
+        iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+        out_file_handle);
+  }
+
+  static iree_status_t RecordChecksum(void* user_data, iree_string_view_t key,
+                                      uint64_t checksum) {
+    auto* checksums =
+        reinterpret_cast<std::vector<std::pair<std::string, uint64_t>>*>(
+            user_data);
+    checksums->emplace_back(std::string(key.data, key.size), checksum);
+    return iree_ok_status();
+  }
+
+  // Builds an archive from the test index with |worker_count| threads.
+  BuiltArchive Build(iree_host_size_t worker_count,
+                     bool content_hashes = false,
+                     iree_io_physical_size_t data_alignment = 0) {
+    BuiltArchive archive;
+    iree_io_parameter_index_t* target_index = NULL;
+    IREE_CHECK_OK(
+        iree_io_parameter_index_create(iree_allocator_system(), &target_index));
+    iree_io_parameter_archive_build_options_t options;
+    memset(&options, 0, sizeof(options));
+    options.worker_count = worker_count;
+    options.content_hashes = content_hashes;
+    options.data_alignment = data_alignment;
+    options.checksum.fn = RecordChecksum;
+    options.checksum.user_data = &archive.checksums;
+    iree_io_parameter_archive_file_open_callback_t open_callback = {
+        OpenArchive,
+        &archive.contents,
+    };
+    IREE_CHECK_OK(iree_io_build_parameter_archive_with_options(
+        index_, target_index, open_callback, /*target_file_offset=*/0,
+        &options, iree_allocator_system()));
+    iree_io_parameter_index_release(target_index);
+    return archive;
+  }
+
+  // Parses |archive| and verifies each data entry matches its source range.
+  void VerifyContents(BuiltArchive& archive) {
+    iree_io_file_handle_t* archive_handle = NULL;
+    IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+        IREE_IO_FILE_ACCESS_READ,
+        iree_make_byte_span(archive.contents.data(), archive.contents.size()),
+        iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+        &archive_handle));
+    iree_io_parameter_index_t* parsed_index = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_create(iree_allocator_system(),
+                                                  &parsed_index));
+    IREE_ASSERT_OK(iree_io_parse_irpa_index(archive_handle, parsed_index));
+    ASSERT_EQ(iree_io_parameter_index_count(parsed_index),
+              iree_io_parameter_index_count(index_));
+    for (iree_host_size_t i = 0; i < iree_io_parameter_index_count(index_);
+         ++i) {
+      const iree_io_parameter_index_entry_t* source_entry = NULL;
+      IREE_ASSERT_OK(iree_io_parameter_index_get(index_, i, &source_entry));
+      if (source_entry->type !=
+          IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+        continue;
+      }
+      const iree_io_parameter_index_entry_t* parsed_entry = NULL;
+      IREE_ASSERT_OK(iree_io_parameter_index_lookup(
+          parsed_index, source_entry->key, &parsed_entry));
+      ASSERT_EQ(parsed_entry->length, source_entry->length);
+      EXPECT_EQ(0, memcmp(archive.contents.data() +
+                              parsed_entry->storage.file.offset,
+                          source_.data() + source_entry->storage.file.offset,
+                          source_entry->length))
+          << "contents of " << std::string(source_entry->key.data,
+                                           source_entry->key.size);
+    }
+    iree_io_parameter_index_release(parsed_index);
+    iree_io_file_handle_release(archive_handle);
+  }
+
+  std::vector<uint8_t> source_;
+  iree_io_file_handle_t* source_handle_ = NULL;
+  iree_io_parameter_index_t* index_ = NULL;
+};
+
+TEST_F(IrpaBuilderTest, SerialCopy) {
+  BuiltArchive archive = Build(/*worker_count=*/1);
+  VerifyContents(archive);
+}
+
+TEST_F(IrpaBuilderTest, ParallelCopyMatchesSerial) {
+  BuiltArchive serial_archive = Build(/*worker_count=*/1);
+  BuiltArchive parallel_archive = Build(/*worker_count=*/4);
+  VerifyContents(parallel_archive);
+  EXPECT_EQ(serial_archive.contents, parallel_archive.contents);
+  EXPECT_EQ(serial_archive.checksums, parallel_archive.checksums);
+}
+
+TEST_F(IrpaBuilderTest, Checksums) {
+  BuiltArchive archive = Build(/*worker_count=*/3);
+  // Only data entries are reported and in source index order.
+  ASSERT_EQ(archive.checksums.size(), 4);
+  const char* expected_keys[] = {"large", "small", "empty", "tail"};
+  for (iree_host_size_t i = 0; i < archive.checksums.size(); ++i) {
+    const iree_io_parameter_index_entry_t* source_entry = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_get(index_, i, &source_entry));
+    EXPECT_EQ(archive.checksums[i].first, expected_keys[i]);
+    EXPECT_EQ(archive.checksums[i].second,
+              ReferenceChecksum(
+                  source_.data() + source_entry->storage.file.offset,
+                  source_entry->length));
+  }
+}
+
+TEST_F(IrpaBuilderTest, ContentHashes) {
+  BuiltArchive archive = Build(/*worker_count=*/2, /*content_hashes=*/true);
+  VerifyContents(archive);
+
+  iree_io_file_handle_t* archive_handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(archive.contents.data(), archive.contents.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &archive_handle));
+  iree_io_parameter_index_t* parsed_index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &parsed_index));
+  IREE_ASSERT_OK(iree_io_parse_irpa_index(archive_handle, parsed_index));
+  for (iree_host_size_t i = 0; i < iree_io_parameter_index_count(index_);
+       ++i) {
+    const iree_io_parameter_index_entry_t* source_entry = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_get(index_, i, &source_entry));
+    const iree_io_parameter_index_entry_t* parsed_entry = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_lookup(
+        parsed_index, source_entry->key, &parsed_entry));
+    if (source_entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+      EXPECT_EQ(parsed_entry->content_hash,
+                ReferenceChecksum(
+                    source_.data() + source_entry->storage.file.offset,
+                    source_entry->length));
+    } else {
+      EXPECT_EQ(parsed_entry->content_hash, 0);
+    }
+  }
+  iree_io_parameter_index_release(parsed_index);
+  iree_io_file_handle_release(archive_handle);
+}
+
+TEST_F(IrpaBuilderTest, DataAlignment) {
+  BuiltArchive archive = Build(/*worker_count=*/2, /*content_hashes=*/false,
+                               /*data_alignment=*/4096);
+  VerifyContents(archive);
+  EXPECT_EQ(archive.contents.size() % 4096, 0);
+
+  iree_io_file_handle_t* archive_handle = NULL;
+  IREE_ASSERT_OK(iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ,
+      iree_make_byte_span(archive.contents.data(), archive.contents.size()),
+      iree_io_file_handle_release_callback_null(), iree_allocator_system(),
+      &archive_handle));
+  iree_io_parameter_index_t* parsed_index = NULL;
+  IREE_ASSERT_OK(
+      iree_io_parameter_index_create(iree_allocator_system(), &parsed_index));
+  IREE_ASSERT_OK(iree_io_parse_irpa_index(archive_handle, parsed_index));
+  for (iree_host_size_t i = 0; i < iree_io_parameter_index_count(parsed_index);
+       ++i) {
+    const iree_io_parameter_index_entry_t* parsed_entry = NULL;
+    IREE_ASSERT_OK(iree_io_parameter_index_get(parsed_index, i, &parsed_entry));
+    if (parsed_entry->type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE) {
+      EXPECT_EQ(parsed_entry->storage.file.offset % 4096, 0)
+          << std::string(parsed_entry->key.data, parsed_entry->key.size);
+    }
+  }
+  iree_io_parameter_index_release(parsed_index);
+  iree_io_file_handle_release(archive_handle);
+}
+
+}  // namespace
+}  // namespace iree
@@ -137,10 +137,27 @@ static iree_status_t iree_io_parse_irpa_v0_data_entry(
   IREE_RETURN_IF_ERROR(
       iree_io_resolve_irpa_v0_storage(file_contents, base_offset, header,
                                       data_entry->storage, &storage_offset));
+  // Entries may be followed by an optional content hash.
+  uint64_t content_hash = 0;
+  if (iree_all_bits_set(
+          data_entry->header.flags,
+          IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_CONTENT_HASH)) {
+    if (data_entry->header.entry_size <
+        sizeof(*data_entry) +
+            sizeof(iree_io_parameter_archive_content_hash_t)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "data entry content hash length underflow");
+    }
+    iree_io_parameter_archive_content_hash_t hash;
+    memcpy(&hash, (const uint8_t*)data_entry + sizeof(*data_entry),
+           sizeof(hash));
+    content_hash = hash.value;
+  }
   iree_io_parameter_index_entry_t entry = {
       .key = name,
       .metadata = metadata,
       .length = data_entry->storage.length,
+      .content_hash = content_hash,
       .type = IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE,
       .storage =
           {
@@ -0,0 +1,244 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_dedup_cache.h"
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+
+// A buffer loaded with a particular key.
+typedef struct iree_io_parameter_dedup_entry_t {
+  // Key the buffer was loaded with. The device is retained.
+  iree_io_parameter_dedup_key_t key;
+  // Buffer produced by the load.
+  iree_hal_buffer_t* buffer;  // retained
+  // Semaphore signaled to |ready_value| when the load producing the buffer
+  // completes. NULL once the load is known to have completed successfully.
+  iree_hal_semaphore_t* ready_semaphore;  // retained
+  uint64_t ready_value;
+} iree_io_parameter_dedup_entry_t;
+
+struct iree_io_parameter_dedup_cache_t {
+  iree_atomic_ref_count_t ref_count;
+  iree_allocator_t host_allocator;
+  iree_slim_mutex_t mutex;
+  iree_host_size_t entry_capacity IREE_GUARDED_BY(mutex);
+  iree_host_size_t entry_count IREE_GUARDED_BY(mutex);
+  iree_io_parameter_dedup_entry_t* entries IREE_GUARDED_BY(mutex);
+};
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_dedup_cache_create(
+    iree_allocator_t host_allocator,
+    iree_io_parameter_dedup_cache_t** out_cache) {
+  IREE_ASSERT_ARGUMENT(out_cache);
+  *out_cache = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_io_parameter_dedup_cache_t* cache = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0,
+      iree_allocator_malloc(host_allocator, sizeof(*cache), (void**)&cache));
+  iree_atomic_ref_count_init(&cache->ref_count);
+  cache->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&cache->mutex);
+  cache->entry_capacity = 0;
+  cache->entry_count = 0;
+  cache->entries = NULL;
+
+  *out_cache = cache;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+static void iree_io_parameter_dedup_entry_deinitialize(
+    iree_io_parameter_dedup_entry_t* entry) {
+  iree_hal_semaphore_release(entry->ready_semaphore);
+  iree_hal_buffer_release(entry->buffer);
+  iree_hal_device_release(entry->key.device);
+}
+
+// Removes the entry at |index| by swapping in the last entry.
+static void iree_io_parameter_dedup_cache_remove_locked(
+    iree_io_parameter_dedup_cache_t* cache, iree_host_size_t index) {
+  iree_io_parameter_dedup_entry_deinitialize(&cache->entries[index]);
+  cache->entries[index] = cache->entries[--cache->entry_count];
+}
+
+static void iree_io_parameter_dedup_cache_destroy(
+    iree_io_parameter_dedup_cache_t* cache) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = cache->host_allocator;
+
+  // Resources are safe to release even if there are pending device operations
+  // as the device guarantees the resources remain live.
+  for (iree_host_size_t i = 0; i < cache->entry_count; ++i) {
+    iree_io_parameter_dedup_entry_deinitialize(&cache->entries[i]);
+  }
+  iree_allocator_free(host_allocator, cache->entries);
+  iree_slim_mutex_deinitialize(&cache->mutex);
+  iree_allocator_free(host_allocator, cache);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT void iree_io_parameter_dedup_cache_retain(
+    iree_io_parameter_dedup_cache_t* cache) {
+  if (IREE_LIKELY(cache)) {
+    iree_atomic_ref_count_inc(&cache->ref_count);
+  }
+}
+
+IREE_API_EXPORT void iree_io_parameter_dedup_cache_release(
+    iree_io_parameter_dedup_cache_t* cache) {
+  if (IREE_LIKELY(cache) && iree_atomic_ref_count_dec(&cache->ref_count) == 1) {
+    iree_io_parameter_dedup_cache_destroy(cache);
+  }
+}
+
+// Returns true if the load that produced the |entry| buffer has completed.
+// Sets |out_failed| if the load failed and the buffer contents are invalid.
+static bool iree_io_parameter_dedup_entry_is_ready(
+    iree_io_parameter_dedup_entry_t* entry, bool* out_failed) {
+  *out_failed = false;
+  if (!entry->ready_semaphore) return true;
+  uint64_t value = 0;
+  iree_status_t status =
+      iree_hal_semaphore_query(entry->ready_semaphore, &value);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    *out_failed = true;
+    return true;
+  } else if (value < entry->ready_value) {
+    return false;
+  }
+  iree_hal_semaphore_release(entry->ready_semaphore);
+  entry->ready_semaphore = NULL;
+  return true;
+}
+
+IREE_API_EXPORT void iree_io_parameter_dedup_cache_trim(
+    iree_io_parameter_dedup_cache_t* cache) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_slim_mutex_lock(&cache->mutex);
+
+  iree_host_size_t i = 0;
+  while (i < cache->entry_count) {
+    iree_io_parameter_dedup_entry_t* entry = &cache->entries[i];
+    bool is_failed = false;
+    if (iree_io_parameter_dedup_entry_is_ready(entry, &is_failed) &&
+        iree_atomic_ref_count_load(
+            &((iree_hal_resource_t*)entry->buffer)->ref_count) == 1) {
+      iree_io_parameter_dedup_cache_remove_locked(cache, i);
+    } else {
+      ++i;
+    }
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)cache->entry_count);
+
+  iree_slim_mutex_unlock(&cache->mutex);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static bool iree_io_parameter_dedup_key_equal(
+    const iree_io_parameter_dedup_key_t* lhs,
+    const iree_io_parameter_dedup_key_t* rhs) {
+  return lhs->content_hash == rhs->content_hash &&
+         lhs->content_length == rhs->content_length &&
+         lhs->span.parameter_offset == rhs->span.parameter_offset &&
+         lhs->span.buffer_offset == rhs->span.buffer_offset &&
+         lhs->span.length == rhs->span.length && lhs->device == rhs->device &&
+         lhs->queue_affinity == rhs->queue_affinity &&
+         lhs->params.type == rhs->params.type &&
+         lhs->params.usage == rhs->params.usage &&
+         lhs->params.access == rhs->params.access;
+}
+
+// Returns the index of the entry matching |key| or -1 if not found.
+static iree_host_size_t iree_io_parameter_dedup_cache_find_locked(
+    iree_io_parameter_dedup_cache_t* cache,
+    const iree_io_parameter_dedup_key_t* key) {
+  for (iree_host_size_t i = 0; i < cache->entry_count; ++i) {
+    if (iree_io_parameter_dedup_key_equal(&cache->entries[i].key, key)) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+IREE_API_EXPORT bool iree_io_parameter_dedup_cache_lookup(
+    iree_io_parameter_dedup_cache_t* cache,
+    const iree_io_parameter_dedup_key_t* key, iree_hal_buffer_t** out_buffer,
+    iree_hal_semaphore_t** out_ready_semaphore, uint64_t* out_ready_value) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(key);
+  IREE_ASSERT_ARGUMENT(out_buffer);
+  IREE_ASSERT_ARGUMENT(out_ready_semaphore);
+  IREE_ASSERT_ARGUMENT(out_ready_value);
+  *out_buffer = NULL;
+  *out_ready_semaphore = NULL;
+  *out_ready_value = 0;
+  iree_slim_mutex_lock(&cache->mutex);
+
+  bool found = false;
+  iree_host_size_t index =
+      iree_io_parameter_dedup_cache_find_locked(cache, key);
+  if (index != -1) {
+    iree_io_parameter_dedup_entry_t* entry = &cache->entries[index];
+    bool is_failed = false;
+    iree_io_parameter_dedup_entry_is_ready(entry, &is_failed);
+    if (is_failed) {
+      // The load failed and the buffer contents are undefined; let the caller
+      // load it again.
+      iree_io_parameter_dedup_cache_remove_locked(cache, index);
+    } else {
+      *out_buffer = entry->buffer;
+      iree_hal_buffer_retain(entry->buffer);
+      *out_ready_semaphore = entry->ready_semaphore;
+      iree_hal_semaphore_retain(entry->ready_semaphore);
+      *out_ready_value = entry->ready_value;
+      found = true;
+    }
+  }
+
+  iree_slim_mutex_unlock(&cache->mutex);
+  return found;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_dedup_cache_insert(
+    iree_io_parameter_dedup_cache_t* cache,
+    const iree_io_parameter_dedup_key_t* key, iree_hal_buffer_t* buffer,
+    iree_hal_semaphore_t* ready_semaphore, uint64_t ready_value) {
+  IREE_ASSERT_ARGUMENT(cache);
+  IREE_ASSERT_ARGUMENT(key);
+  IREE_ASSERT_ARGUMENT(buffer);
+  iree_slim_mutex_lock(&cache->mutex);
+
+  iree_status_t status = iree_ok_status();
+  if (iree_io_parameter_dedup_cache_find_locked(cache, key) == -1) {
+    if (cache->entry_count == cache->entry_capacity) {
+      iree_host_size_t new_capacity = iree_max(16, cache->entry_capacity * 2);
+      status = iree_allocator_realloc(
+          cache->host_allocator, new_capacity * sizeof(cache->entries[0]),
+          (void**)&cache->entries);
+      if (iree_status_is_ok(status)) cache->entry_capacity = new_capacity;
+    }
+    if (iree_status_is_ok(status)) {
+      iree_io_parameter_dedup_entry_t* entry =
+          &cache->entries[cache->entry_count++];
+      entry->key = *key;
+      iree_hal_device_retain(entry->key.device);
+      entry->buffer = buffer;
+      iree_hal_buffer_retain(buffer);
+      entry->ready_semaphore = ready_semaphore;
+      iree_hal_semaphore_retain(ready_semaphore);
+      entry->ready_value = ready_value;
+    }
+  }
+
+  iree_slim_mutex_unlock(&cache->mutex);
+  return status;
+}
@@ -0,0 +1,89 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARAMETER_DEDUP_CACHE_H_
+#define IREE_IO_PARAMETER_DEDUP_CACHE_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/io/parameter_provider.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Identifies the contents of a loaded parameter buffer and how it was loaded.
+// Loads with equal keys produce buffers with identical contents regardless of
+// which archive or scope the parameter came from.
+typedef struct iree_io_parameter_dedup_key_t {
+  // Content hash of the source parameter (see
+  // iree_io_parameter_index_entry_t::content_hash). Never 0.
+  uint64_t content_hash;
+  // Total length of the source parameter in bytes.
+  uint64_t content_length;
+  // Span of the parameter loaded into the buffer.
+  iree_io_parameter_span_t span;
+  // Device and queues the buffer was loaded for.
+  iree_hal_device_t* device;
+  iree_hal_queue_affinity_t queue_affinity;
+  // Buffer parameters requested by the load.
+  iree_hal_buffer_params_t params;
+} iree_io_parameter_dedup_key_t;
+
+// An in-memory cache of loaded parameter buffers keyed by their contents.
+// A single cache may be shared by multiple parameter providers (such as one
+// per parameter archive) so that parameters with identical contents are only
+// loaded into device memory once and shared by reference by all programs
+// loading them.
+//
+// Cached buffers are retained until the cache is trimmed or released.
+//
+// Thread-safe: multiple threads can access the cache concurrently.
+typedef struct iree_io_parameter_dedup_cache_t iree_io_parameter_dedup_cache_t;
+
+// Creates a new empty parameter dedup cache.
+IREE_API_EXPORT iree_status_t iree_io_parameter_dedup_cache_create(
+    iree_allocator_t host_allocator,
+    iree_io_parameter_dedup_cache_t** out_cache);
+
+// Retains the given |cache| for the caller.
+IREE_API_EXPORT void iree_io_parameter_dedup_cache_retain(
+    iree_io_parameter_dedup_cache_t* cache);
+
+// Releases the given |cache| from the caller.
+IREE_API_EXPORT void iree_io_parameter_dedup_cache_release(
+    iree_io_parameter_dedup_cache_t* cache);
+
+// Drops all cached buffers that are not referenced outside of the cache.
+IREE_API_EXPORT void iree_io_parameter_dedup_cache_trim(
+    iree_io_parameter_dedup_cache_t* cache);
+
+// Looks up a buffer previously loaded with |key| and returns it retained in
+// |out_buffer|. If the load that produced the buffer may still be in-flight
+// |out_ready_semaphore| is set to a retained semaphore that will reach
+// |out_ready_value| when the buffer contents are available and otherwise it is
+// set to NULL. Returns false if no buffer is cached (or its load failed).
+IREE_API_EXPORT bool iree_io_parameter_dedup_cache_lookup(
+    iree_io_parameter_dedup_cache_t* cache,
+    const iree_io_parameter_dedup_key_t* key, iree_hal_buffer_t** out_buffer,
+    iree_hal_semaphore_t** out_ready_semaphore, uint64_t* out_ready_value);
+
+// Inserts |buffer| loaded with |key| into the cache. The contents of the buffer
+// are available once the optional |ready_semaphore| reaches |ready_value|.
+// If a buffer is already cached for |key| (such as when the same contents are
+// loaded concurrently) the existing buffer is kept.
+IREE_API_EXPORT iree_status_t iree_io_parameter_dedup_cache_insert(
+    iree_io_parameter_dedup_cache_t* cache,
+    const iree_io_parameter_dedup_key_t* key, iree_hal_buffer_t* buffer,
+    iree_hal_semaphore_t* ready_semaphore, uint64_t ready_value);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARAMETER_DEDUP_CACHE_H_
@@ -168,6 +168,7 @@ iree_io_parameter_index_add(iree_io_parameter_index_t* index,
                   (uint8_t*)cloned_entry->key.data + cloned_entry->key.size,
                   entry->metadata.data_length);
     cloned_entry->length = entry->length;
+    cloned_entry->content_hash = entry->content_hash;
     cloned_entry->type = entry->type;
     switch (entry->type) {
       default:
@@ -38,6 +38,11 @@ typedef struct iree_io_parameter_index_entry_t {
   iree_const_byte_span_t metadata;
   // Length of the entry in bytes.
   uint64_t length;
+  // Optional hash of the entry contents or 0 if unknown. Entries with the same
+  // length and content hash are treated as having identical contents. Only
+  // populated by formats that store hashes (such as IRPA data entries with
+  // IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_CONTENT_HASH).
+  uint64_t content_hash;
   // Type of the parameter dictating how storage is handled.
   iree_io_parameter_index_entry_storage_type_t type;
   // Defines the backing storage of a parameter based on its type.
@@ -6,13 +6,38 @@
 
 #include "iree/io/parameter_index_provider.h"
 
+#include <stdlib.h>
+
 #include "iree/hal/utils/file_cache.h"
+#include "iree/io/parameter_dedup_cache.h"
 
 // Limit concurrent operations to avoid blowing the stack. This is arbitrary and
 // if we wanted to support more we could switch to using heap allocations or
 // a growable stack scratchpad.
 #define IREE_IO_PARAMETER_OP_BATCH_MAX_CONCURRENCY 8
 
+// Maximum number of unused bytes between two gathered parameters in the same
+// file that will be read and discarded in order to coalesce their reads.
+#if !defined(IREE_IO_PARAMETER_GATHER_MAX_GAP_LENGTH)
+#define IREE_IO_PARAMETER_GATHER_MAX_GAP_LENGTH (64 * 1024)
+#endif  // !IREE_IO_PARAMETER_GATHER_MAX_GAP_LENGTH
+
+// Maximum length of a single coalesced gather read. Bounds the size of the
+// transient staging buffers used when coalesced parameters are not contiguous
+// in the target buffer and ensures large gathers are still distributed across
+// timelines.
+#if !defined(IREE_IO_PARAMETER_GATHER_MAX_RUN_LENGTH)
+#define IREE_IO_PARAMETER_GATHER_MAX_RUN_LENGTH (64 * 1024 * 1024)
+#endif  // !IREE_IO_PARAMETER_GATHER_MAX_RUN_LENGTH
+
+// Minimum length of a span (or contiguous run of spans) that is always read
+// directly into the target buffer instead of being coalesced with neighboring
+// spans through a staging buffer. Below this the cost of the additional device
+// copy is expected to be less than the cost of an additional file operation.
+#if !defined(IREE_IO_PARAMETER_GATHER_MIN_DIRECT_LENGTH)
+#define IREE_IO_PARAMETER_GATHER_MIN_DIRECT_LENGTH (1 * 1024 * 1024)
+#endif  // !IREE_IO_PARAMETER_GATHER_MIN_DIRECT_LENGTH
+
 typedef struct iree_io_parameter_index_provider_t {
   iree_io_parameter_provider_t base;
   iree_allocator_t host_allocator;
@@ -20,6 +45,9 @@ typedef struct iree_io_parameter_index_provider_t {
   iree_string_view_t scope;
   iree_io_parameter_index_t* index;
   iree_hal_file_cache_t* file_cache;
+  // Optional cache shared with other providers used to deduplicate loads of
+  // parameters with identical contents.
+  iree_io_parameter_dedup_cache_t* dedup_cache;
 } iree_io_parameter_index_provider_t;
 
 static const iree_io_parameter_provider_vtable_t
@@ -35,6 +63,18 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_string_view_t scope, iree_io_parameter_index_t* index,
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
     iree_io_parameter_provider_t** out_provider) {
+  return iree_io_parameter_index_provider_create_with_dedup_cache(
+      scope, index, max_concurrent_operations, /*dedup_cache=*/NULL,
+      host_allocator, out_provider);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_create_with_dedup_cache(
+    iree_string_view_t scope, iree_io_parameter_index_t* index,
+    iree_host_size_t max_concurrent_operations,
+    iree_io_parameter_dedup_cache_t* dedup_cache,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider) {
   IREE_ASSERT_ARGUMENT(index);
   IREE_ASSERT_ARGUMENT(out_provider);
   *out_provider = NULL;
@@ -61,6 +101,9 @@ IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
   provider->index = index;
   iree_io_parameter_index_retain(index);
 
+  provider->dedup_cache = dedup_cache;
+  iree_io_parameter_dedup_cache_retain(dedup_cache);
+
   iree_status_t status =
       iree_hal_file_cache_create(host_allocator, &provider->file_cache);
 
@@ -80,6 +123,7 @@ static void iree_io_parameter_index_provider_destroy(
   iree_allocator_t host_allocator = provider->host_allocator;
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_io_parameter_dedup_cache_release(provider->dedup_cache);
   iree_hal_file_cache_release(provider->file_cache);
   iree_io_parameter_index_release(provider->index);
 
@@ -99,6 +143,9 @@ static iree_status_t iree_io_parameter_index_provider_notify(
     case IREE_IO_PARAMETER_PROVIDER_SIGNAL_SUSPEND:
     case IREE_IO_PARAMETER_PROVIDER_SIGNAL_LOW_MEMORY:
       iree_hal_file_cache_trim(provider->file_cache);
+      if (provider->dedup_cache) {
+        iree_io_parameter_dedup_cache_trim(provider->dedup_cache);
+      }
       break;
     default:
       break;
@@ -230,7 +277,9 @@ static iree_status_t iree_io_validate_parameter_range(
 // splats (synthetic parameters) and copies (device->device transfers) by way
 // of a command buffer we build and submit when needed. Today there is just a
 // single command buffer we submit with zero barriers which should be equivalent
-// to spreading it out over multiple timelines.
+// to spreading it out over multiple timelines. If the command buffer copies
+// out of buffers populated by file reads in the batch it is submitted after
+// all timelines have completed.
 //
 // NOTE: we expect count == 0 to have been handled by callers to avoid the
 // overhead of the batch setup and submission but it's valid to have a zero
@@ -276,6 +325,9 @@ typedef struct iree_io_parameter_op_batch_t {
   // operations to be cheaper than file I/O operations but are not trying to be
   // precise here.
   uint64_t transfer_bytes_outstanding;
+  // True if the transfer command buffer reads from buffers written by other
+  // operations in the batch and must wait for all timelines to complete.
+  bool transfer_requires_join;
 } iree_io_parameter_op_batch_t;
 
 // Begins a parameter operation batch against the given |provider|.
@@ -479,6 +531,23 @@ static iree_status_t iree_io_parameter_op_batch_enqueue_alloca(
   return iree_ok_status();
 }
 
+// Returns the transfer command buffer for the batch, creating and beginning it
+// on first use.
+static iree_status_t iree_io_parameter_op_batch_transfer_command_buffer(
+    iree_io_parameter_op_batch_t* batch,
+    iree_hal_command_buffer_t** out_command_buffer) {
+  if (!batch->transfer_command_buffer) {
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_create(
+        batch->device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
+        IREE_HAL_COMMAND_CATEGORY_TRANSFER, batch->queue_affinity, 0,
+        &batch->transfer_command_buffer));
+    IREE_RETURN_IF_ERROR(
+        iree_hal_command_buffer_begin(batch->transfer_command_buffer));
+  }
+  *out_command_buffer = batch->transfer_command_buffer;
+  return iree_ok_status();
+}
+
 // Enqueues a splat operation in the batch into the |buffer| range.
 // Splats get routed to a transfer command buffer that we'll submit at the end
 // of the batch. This avoids the need for us to check all of the operations
@@ -495,22 +564,17 @@ static iree_status_t iree_io_parameter_op_batch_enqueue_splat(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Create the transfer command buffer on first use.
-  if (!batch->transfer_command_buffer) {
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_hal_command_buffer_create(
-                batch->device, IREE_HAL_COMMAND_BUFFER_MODE_ONE_SHOT,
-                IREE_HAL_COMMAND_CATEGORY_TRANSFER, batch->queue_affinity, 0,
-                &batch->transfer_command_buffer));
-    IREE_RETURN_AND_END_ZONE_IF_ERROR(
-        z0, iree_hal_command_buffer_begin(batch->transfer_command_buffer));
-  }
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_op_batch_transfer_command_buffer(batch,
+                                                              &command_buffer));
 
   // Add the splat fill to the command buffer.
   // Parameter ranges cannot overlap so there's no barrier required.
   batch->transfer_bytes_outstanding += length;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
       z0, iree_hal_command_buffer_fill_buffer(
-              batch->transfer_command_buffer,
+              command_buffer,
               iree_hal_make_buffer_ref(buffer, buffer_offset, length), pattern,
               pattern_length, IREE_HAL_FILL_FLAG_NONE));
 
@@ -518,6 +582,42 @@ static iree_status_t iree_io_parameter_op_batch_enqueue_splat(
   return iree_ok_status();
 }
 
+// Enqueues a copy from |source_buffer| into the |target_buffer| range.
+// Copies get routed to the transfer command buffer and the command buffer will
+// be submitted only after all other operations in the batch have completed such
+// that the source buffer can be populated by file reads in the same batch.
+static iree_status_t iree_io_parameter_op_batch_enqueue_copy(
+    iree_io_parameter_op_batch_t* batch, iree_hal_buffer_t* source_buffer,
+    iree_device_size_t source_buffer_offset, iree_hal_buffer_t* target_buffer,
+    iree_device_size_t target_buffer_offset, iree_device_size_t length) {
+  IREE_ASSERT_ARGUMENT(batch);
+  IREE_ASSERT_ARGUMENT(source_buffer);
+  IREE_ASSERT_ARGUMENT(target_buffer);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Create the transfer command buffer on first use.
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_op_batch_transfer_command_buffer(batch,
+                                                              &command_buffer));
+
+  // Add the copy to the command buffer.
+  // Parameter ranges cannot overlap so there's no barrier required.
+  batch->transfer_bytes_outstanding += length;
+  batch->transfer_requires_join = true;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_command_buffer_copy_buffer(
+              command_buffer,
+              iree_hal_make_buffer_ref(source_buffer, source_buffer_offset,
+                                       length),
+              iree_hal_make_buffer_ref(target_buffer, target_buffer_offset,
+                                       length),
+              IREE_HAL_COPY_FLAG_NONE));
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
 // Enqueues a file read operation in the batch.
 static iree_status_t iree_io_parameter_op_batch_enqueue_file_read(
     iree_io_parameter_op_batch_t* batch, iree_hal_file_t* source_file,
@@ -584,11 +684,25 @@ static iree_status_t iree_io_parameter_op_batch_flush(
     IREE_TRACE_ZONE_BEGIN_NAMED(z_transfer,
                                 "iree_io_parameter_op_batch_flush_transfer");
     status = iree_hal_command_buffer_end(batch->transfer_command_buffer);
+
+    // If the command buffer consumes the results of other operations in the
+    // batch it must wait on all timelines as they were prior to selecting the
+    // one the command buffer executes on.
+    iree_host_size_t join_count = batch->timeline_live_count;
+    uint64_t join_values[IREE_IO_PARAMETER_OP_BATCH_MAX_CONCURRENCY];
+    memcpy(join_values, batch->timeline_values, sizeof(join_values));
+
     iree_io_parameter_op_step_t step;
     if (iree_status_is_ok(status)) {
       status = iree_io_parameter_op_batch_advance_timeline(
           batch, batch->transfer_bytes_outstanding, &step);
     }
+    if (iree_status_is_ok(status) && batch->transfer_requires_join) {
+      IREE_ASSERT_GT(join_count, 0);
+      step.wait_semaphore_list.count = join_count;
+      step.wait_semaphore_list.semaphores = batch->timeline_semaphores;
+      step.wait_semaphore_list.payload_values = join_values;
+    }
     if (iree_status_is_ok(status)) {
       status = iree_hal_device_queue_execute(
           batch->device, batch->queue_affinity, step.wait_semaphore_list,
@@ -677,6 +791,190 @@ static void iree_io_file_handle_buffer_release(void* user_data,
   iree_io_file_handle_release((iree_io_file_handle_t*)user_data);
 }
 
+// Per-parameter state of a load deduplicated through the provider cache.
+typedef struct iree_io_parameter_dedup_slot_t {
+  // Key identifying the loaded contents. The content_hash is 0 if the parameter
+  // does not participate in deduplication (splats, unhashed parameters, etc).
+  iree_io_parameter_dedup_key_t key;
+  // Cached buffer when the load hit in the cache, the buffer loaded by the
+  // batch when it missed and NULL when not participating.
+  iree_hal_buffer_t* buffer;  // retained
+  // True if |buffer| came from the cache.
+  bool is_hit;
+} iree_io_parameter_dedup_slot_t;
+
+// Deduplication state of a single load operation.
+typedef struct iree_io_parameter_dedup_state_t {
+  // Number of slots, one per loaded parameter, or 0 if dedup is not used.
+  iree_host_size_t slot_count;
+  iree_io_parameter_dedup_slot_t* slots;
+  // Semaphores the batch must wait on: the user-provided semaphores followed
+  // by the retained ready semaphores of any cached buffers.
+  iree_hal_semaphore_list_t wait_semaphore_list;
+  // Number of user-provided semaphores at the head of |wait_semaphore_list|.
+  iree_host_size_t user_wait_count;
+} iree_io_parameter_dedup_state_t;
+
+// Appends |semaphore| reaching |value| to |list| or raises the payload value of
+// an existing entry for the same semaphore. |semaphore| is retained by the list
+// when it is appended.
+static void iree_io_parameter_dedup_state_append_wait(
+    iree_io_parameter_dedup_state_t* state, iree_hal_semaphore_t* semaphore,
+    uint64_t value) {
+  iree_hal_semaphore_list_t* list = &state->wait_semaphore_list;
+  for (iree_host_size_t i = 0; i < list->count; ++i) {
+    if (list->semaphores[i] == semaphore) {
+      list->payload_values[i] = iree_max(list->payload_values[i], value);
+      return;
+    }
+  }
+  iree_hal_semaphore_retain(semaphore);
+  list->semaphores[list->count] = semaphore;
+  list->payload_values[list->count] = value;
+  ++list->count;
+}
+
+// Looks up all parameters being loaded in the provider dedup cache.
+// Parameters that hit have their buffers returned in the state slots and the
+// semaphores indicating when the cached buffers are ready are appended to the
+// wait semaphore list that must be used by the load batch. Any parameter that
+// cannot be resolved here is skipped so that the load reports the error.
+static iree_status_t iree_io_parameter_dedup_state_initialize(
+    iree_io_parameter_index_provider_t* provider, iree_hal_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_hal_buffer_params_t target_params, iree_host_size_t count,
+    iree_io_parameter_enumerator_t enumerator,
+    iree_io_parameter_dedup_state_t* out_state) {
+  memset(out_state, 0, sizeof(*out_state));
+  out_state->wait_semaphore_list = wait_semaphore_list;
+  out_state->user_wait_count = wait_semaphore_list.count;
+  if (!provider->dedup_cache || count == 0) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Slots followed by the wait semaphores and their payload values. The wait
+  // list has capacity for one ready semaphore per parameter.
+  iree_host_size_t wait_capacity = wait_semaphore_list.count + count;
+  iree_host_size_t total_size =
+      count * sizeof(out_state->slots[0]) +
+      wait_capacity * sizeof(out_state->wait_semaphore_list.semaphores[0]) +
+      wait_capacity * sizeof(out_state->wait_semaphore_list.payload_values[0]);
+  uint8_t* storage = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(provider->host_allocator, total_size,
+                                (void**)&storage));
+  memset(storage, 0, total_size);
+  out_state->slot_count = count;
+  out_state->slots = (iree_io_parameter_dedup_slot_t*)storage;
+  out_state->wait_semaphore_list.payload_values =
+      (uint64_t*)(storage + count * sizeof(out_state->slots[0]));
+  out_state->wait_semaphore_list.semaphores =
+      (iree_hal_semaphore_t**)(out_state->wait_semaphore_list.payload_values +
+                               wait_capacity);
+  if (wait_semaphore_list.count > 0) {
+    memcpy(out_state->wait_semaphore_list.semaphores,
+           wait_semaphore_list.semaphores,
+           wait_semaphore_list.count *
+               sizeof(wait_semaphore_list.semaphores[0]));
+    memcpy(out_state->wait_semaphore_list.payload_values,
+           wait_semaphore_list.payload_values,
+           wait_semaphore_list.count *
+               sizeof(wait_semaphore_list.payload_values[0]));
+  }
+
+  iree_host_size_t hit_count = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_string_view_t key = iree_string_view_empty();
+    iree_io_parameter_span_t span = {0};
+    const iree_io_parameter_index_entry_t* entry = NULL;
+    iree_status_t status = enumerator.fn(enumerator.user_data, i, &key, &span);
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parameter_index_lookup(provider->index, key, &entry);
+    }
+    if (iree_status_is_ok(status) &&
+        (entry->type != IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE ||
+         entry->content_hash == 0)) {
+      continue;
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_io_validate_parameter_range(
+          IREE_HAL_MEMORY_ACCESS_READ, entry, span.parameter_offset,
+          span.length);
+    }
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      continue;
+    }
+
+    iree_io_parameter_dedup_slot_t* slot = &out_state->slots[i];
+    slot->key.content_hash = entry->content_hash;
+    slot->key.content_length = entry->length;
+    slot->key.span = span;
+    slot->key.device = device;
+    slot->key.queue_affinity = queue_affinity;
+    slot->key.params = target_params;
+
+    iree_hal_semaphore_t* ready_semaphore = NULL;
+    uint64_t ready_value = 0;
+    if (iree_io_parameter_dedup_cache_lookup(provider->dedup_cache, &slot->key,
+                                             &slot->buffer, &ready_semaphore,
+                                             &ready_value)) {
+      slot->is_hit = true;
+      ++hit_count;
+      if (ready_semaphore) {
+        iree_io_parameter_dedup_state_append_wait(out_state, ready_semaphore,
+                                                  ready_value);
+        iree_hal_semaphore_release(ready_semaphore);
+      }
+    }
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, hit_count);
+
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Inserts all buffers loaded by a successful batch into the provider dedup
+// cache. Their contents are available once |signal_semaphore_list| is reached.
+// Caching is best-effort and failures only prevent future deduplication.
+static void iree_io_parameter_dedup_state_commit(
+    iree_io_parameter_index_provider_t* provider,
+    iree_io_parameter_dedup_state_t* state,
+    const iree_hal_semaphore_list_t signal_semaphore_list) {
+  iree_hal_semaphore_t* ready_semaphore =
+      signal_semaphore_list.count > 0 ? signal_semaphore_list.semaphores[0]
+                                      : NULL;
+  uint64_t ready_value = signal_semaphore_list.count > 0
+                             ? signal_semaphore_list.payload_values[0]
+                             : 0;
+  for (iree_host_size_t i = 0; i < state->slot_count; ++i) {
+    iree_io_parameter_dedup_slot_t* slot = &state->slots[i];
+    if (slot->is_hit || !slot->buffer) continue;
+    iree_status_t status = iree_io_parameter_dedup_cache_insert(
+        provider->dedup_cache, &slot->key, slot->buffer, ready_semaphore,
+        ready_value);
+    if (!iree_status_is_ok(status)) {
+      iree_status_ignore(status);
+      break;
+    }
+  }
+}
+
+static void iree_io_parameter_dedup_state_deinitialize(
+    iree_io_parameter_index_provider_t* provider,
+    iree_io_parameter_dedup_state_t* state) {
+  if (!state->slots) return;
+  for (iree_host_size_t i = 0; i < state->slot_count; ++i) {
+    iree_hal_buffer_release(state->slots[i].buffer);
+  }
+  for (iree_host_size_t i = state->user_wait_count;
+       i < state->wait_semaphore_list.count; ++i) {
+    iree_hal_semaphore_release(state->wait_semaphore_list.semaphores[i]);
+  }
+  iree_allocator_free(provider->host_allocator, state->slots);
+  memset(state, 0, sizeof(*state));
+}
+
 static iree_status_t iree_io_parameter_index_provider_load(
     iree_io_parameter_provider_t* base_provider, iree_hal_device_t* device,
     iree_hal_queue_affinity_t queue_affinity,
@@ -690,19 +988,42 @@ static iree_status_t iree_io_parameter_index_provider_load(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, count);
 
+  // Resolve any parameters that have already been loaded with the same
+  // contents. The batch waits for those loads to complete.
+  iree_io_parameter_dedup_state_t dedup_state;
+  iree_status_t status = iree_io_parameter_dedup_state_initialize(
+      provider, device, queue_affinity, wait_semaphore_list, target_params,
+      count, enumerator, &dedup_state);
+  if (!iree_status_is_ok(status)) {
+    iree_hal_semaphore_list_fail(signal_semaphore_list,
+                                 iree_status_clone(status));
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   // Initialize the batch state.
   iree_io_parameter_op_batch_t batch;
   iree_io_parameter_op_batch_begin(provider, device, queue_affinity,
-                                   wait_semaphore_list, signal_semaphore_list,
-                                   &batch);
+                                   dedup_state.wait_semaphore_list,
+                                   signal_semaphore_list, &batch);
 
   // Process each entry by enqueuing the appropriate operation.
-  iree_status_t status = iree_ok_status();
   for (iree_host_size_t i = 0; i < count; ++i) {
     IREE_TRACE_ZONE_BEGIN_NAMED(z_entry,
                                 "iree_io_parameter_index_provider_load_entry");
     IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, i);
 
+    // Reuse the buffer previously loaded with the same contents, if any.
+    iree_io_parameter_dedup_slot_t* dedup_slot =
+        dedup_state.slots ? &dedup_state.slots[i] : NULL;
+    if (dedup_slot && dedup_slot->is_hit) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z_entry, "dedup hit");
+      status = emitter.fn(emitter.user_data, i, dedup_slot->buffer);
+      IREE_TRACE_ZONE_END(z_entry);
+      if (!iree_status_is_ok(status)) break;
+      continue;
+    }
+
     // Fetch the next parameter to process.
     const iree_io_parameter_index_entry_t* source_entry = NULL;
     iree_io_parameter_span_t span;
@@ -740,36 +1061,56 @@ static iree_status_t iree_io_parameter_index_provider_load(
       iree_byte_span_t host_allocation =
           iree_io_file_handle_primitive(source_entry->storage.file.handle)
               .value.host_allocation;
-      iree_hal_external_buffer_t external_buffer = {
-          .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
-          .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
-          .size = host_allocation.data_length,
-          .handle =
-              {
-                  .host_allocation =
-                      {
-                          .ptr = host_allocation.data +
-                                 source_entry->storage.file.offset,
-                      },
-              },
-      };
-      iree_hal_buffer_release_callback_t release_callback = {
-          .fn = iree_io_file_handle_buffer_release,
-          .user_data = source_entry->storage.file.handle,
-      };
-      iree_io_file_handle_retain(source_entry->storage.file.handle);
-      iree_status_t import_status = iree_hal_allocator_import_buffer(
-          iree_hal_device_allocator(device), target_params, &external_buffer,
-          release_callback, &target_buffer);
-      if (iree_status_is_ok(import_status)) {
-        // Import succeeded - issue a barrier to preserve the async timeline.
-        IREE_TRACE_ZONE_APPEND_TEXT(z_entry, "import succeeded");
+      uint8_t* host_ptr = host_allocation.data +
+                          source_entry->storage.file.offset +
+                          span.parameter_offset;
+
+      // Devices require imported host memory to be at least as aligned as the
+      // buffers they allocate themselves. Formats that pack their data (such as
+      // safetensors) frequently leave entries misaligned and there's no sense
+      // in asking the device to import them only to have it fail; archives
+      // converted with a larger data alignment (iree-convert-parameters
+      // --data_alignment=) always take the import path.
+      const iree_device_size_t required_alignment =
+          iree_max(target_params.min_alignment, IREE_HAL_HEAP_BUFFER_ALIGNMENT);
+      if (!iree_host_size_has_alignment((uintptr_t)host_ptr,
+                                        (iree_host_size_t)required_alignment)) {
+        IREE_TRACE_ZONE_APPEND_TEXT(z_entry, "import skipped: unaligned");
+        IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, required_alignment);
       } else {
-        // Failed to import - that's ok as we'll just do the full allocate +
-        // read.
-        IREE_TRACE_ZONE_APPEND_TEXT(z_entry, "import failed");
-        import_status = iree_status_ignore(import_status);
-        iree_io_file_handle_release(source_entry->storage.file.handle);
+        iree_hal_external_buffer_t external_buffer = {
+            .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+            .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+            .size = span.length,
+            .handle =
+                {
+                    .host_allocation =
+                        {
+                            .ptr = host_ptr,
+                        },
+                },
+        };
+        iree_hal_buffer_release_callback_t release_callback = {
+            .fn = iree_io_file_handle_buffer_release,
+            .user_data = source_entry->storage.file.handle,
+        };
+        iree_io_file_handle_retain(source_entry->storage.file.handle);
+        iree_status_t import_status = iree_hal_allocator_import_buffer(
+            iree_hal_device_allocator(device), target_params, &external_buffer,
+            release_callback, &target_buffer);
+        if (iree_status_is_ok(import_status)) {
+          // Import succeeded - issue a barrier to preserve the async timeline.
+          IREE_TRACE_ZONE_APPEND_TEXT(z_entry, "import succeeded");
+        } else {
+          // Failed to import - that's ok as we'll just do the full allocate +
+          // read.
+          IREE_TRACE_ZONE_APPEND_TEXT(z_entry, "import failed");
+          IREE_TRACE_ZONE_APPEND_TEXT(
+              z_entry,
+              iree_status_code_string(iree_status_code(import_status)));
+          import_status = iree_status_ignore(import_status);
+          iree_io_file_handle_release(source_entry->storage.file.handle);
+        }
       }
     }
 
@@ -820,7 +1161,13 @@ static iree_status_t iree_io_parameter_index_provider_load(
     if (iree_status_is_ok(status)) {
       status = emitter.fn(emitter.user_data, i, target_buffer);
     }
-    iree_hal_buffer_release(target_buffer);
+    if (iree_status_is_ok(status) && dedup_slot &&
+        dedup_slot->key.content_hash != 0) {
+      // Ownership moves to the slot so the buffer can be cached.
+      dedup_slot->buffer = target_buffer;
+    } else {
+      iree_hal_buffer_release(target_buffer);
+    }
 
     IREE_TRACE_ZONE_END(z_entry);
     if (!iree_status_is_ok(status)) break;
@@ -829,6 +1176,97 @@ static iree_status_t iree_io_parameter_index_provider_load(
   // Flush any outstanding batch operations and end the batch.
   status = iree_io_parameter_op_batch_end(&batch, status);
 
+  // Make the newly loaded buffers available to subsequent loads.
+  if (iree_status_is_ok(status)) {
+    iree_io_parameter_dedup_state_commit(provider, &dedup_state,
+                                         signal_semaphore_list);
+  }
+  iree_io_parameter_dedup_state_deinitialize(provider, &dedup_state);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// A file read of a single gathered parameter span.
+typedef struct iree_io_parameter_gather_op_t {
+  // File the parameter is read from.
+  iree_hal_file_t* file;  // retained
+  // Absolute offset of the span in the file.
+  uint64_t file_offset;
+  // Offset of the span in the target buffer.
+  iree_device_size_t buffer_offset;
+  // Length of the span in bytes.
+  iree_device_size_t length;
+} iree_io_parameter_gather_op_t;
+
+// Orders gather operations by file and then by file offset.
+static int iree_io_parameter_gather_op_compare(const void* lhs_ptr,
+                                               const void* rhs_ptr) {
+  const iree_io_parameter_gather_op_t* lhs =
+      (const iree_io_parameter_gather_op_t*)lhs_ptr;
+  const iree_io_parameter_gather_op_t* rhs =
+      (const iree_io_parameter_gather_op_t*)rhs_ptr;
+  if (lhs->file != rhs->file) {
+    return (uintptr_t)lhs->file < (uintptr_t)rhs->file ? -1 : 1;
+  }
+  if (lhs->file_offset != rhs->file_offset) {
+    return lhs->file_offset < rhs->file_offset ? -1 : 1;
+  }
+  return 0;
+}
+
+// Enqueues the file reads for the gather operations in |ops| as a single read
+// of the file range spanning all of them. |ops| must be sorted by file offset
+// and all reference the same file. If the spans are contiguous in both the file
+// and the |target_buffer| the read goes directly into the target buffer and
+// otherwise the range is read into a transient staging buffer and each span is
+// copied into place by the batch transfer command buffer.
+static iree_status_t iree_io_parameter_op_batch_enqueue_gather_run(
+    iree_io_parameter_op_batch_t* batch, iree_hal_buffer_t* target_buffer,
+    iree_host_size_t op_count, const iree_io_parameter_gather_op_t* ops,
+    uint64_t run_length, bool is_contiguous) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, op_count);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, run_length);
+
+  // Fast path for a single span or spans that land contiguously in the target.
+  if (is_contiguous) {
+    iree_status_t status = iree_io_parameter_op_batch_enqueue_file_read(
+        batch, ops[0].file, ops[0].file_offset, target_buffer,
+        ops[0].buffer_offset, (iree_device_size_t)run_length, 0);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
+  // Read the whole range into a staging buffer. The allocation is on the same
+  // timeline as the read so the read is serialized after it.
+  const iree_hal_buffer_params_t staging_params = {
+      .usage = IREE_HAL_BUFFER_USAGE_TRANSFER,
+      .access = IREE_HAL_MEMORY_ACCESS_ALL,
+      .type = IREE_HAL_MEMORY_TYPE_OPTIMAL_FOR_DEVICE,
+      .queue_affinity = batch->queue_affinity,
+  };
+  iree_hal_buffer_t* staging_buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_io_parameter_op_batch_enqueue_alloca(
+              batch, IREE_HAL_ALLOCATOR_POOL_DEFAULT, staging_params,
+              (iree_device_size_t)run_length, &staging_buffer));
+  iree_status_t status = iree_io_parameter_op_batch_enqueue_file_read(
+      batch, ops[0].file, ops[0].file_offset, staging_buffer, 0,
+      (iree_device_size_t)run_length, 0);
+
+  // Scatter each span from the staging buffer into the target buffer.
+  for (iree_host_size_t i = 0; i < op_count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_io_parameter_op_batch_enqueue_copy(
+        batch, staging_buffer,
+        (iree_device_size_t)(ops[i].file_offset - ops[0].file_offset),
+        target_buffer, ops[i].buffer_offset, ops[i].length);
+  }
+
+  // The staging buffer is kept live by the pending operations using it.
+  iree_hal_buffer_release(staging_buffer);
+
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
@@ -851,9 +1289,19 @@ static iree_status_t iree_io_parameter_index_provider_gather(
                                    wait_semaphore_list, signal_semaphore_list,
                                    &batch);
 
-  // Process each entry by enqueuing the appropriate operation.
+  // Scratch storage for the file reads so that they can be sorted and
+  // coalesced prior to enqueuing.
+  iree_host_size_t op_count = 0;
+  iree_io_parameter_gather_op_t* ops = NULL;
   iree_status_t status = iree_ok_status();
-  for (iree_host_size_t i = 0; i < count; ++i) {
+  if (count > 0) {
+    status = iree_allocator_malloc(provider->host_allocator,
+                                   count * sizeof(*ops), (void**)&ops);
+  }
+
+  // Resolve each entry. Splats are enqueued immediately and file reads are
+  // recorded for coalescing.
+  for (iree_host_size_t i = 0; i < count && iree_status_is_ok(status); ++i) {
     IREE_TRACE_ZONE_BEGIN_NAMED(
         z_entry, "iree_io_parameter_index_provider_gather_entry");
     IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, i);
@@ -871,7 +1319,7 @@ static iree_status_t iree_io_parameter_index_provider_gather(
       IREE_TRACE_ZONE_APPEND_VALUE_I64(z_entry, span.length);
     }
 
-    // Enqueue the transfer/file operation.
+    // Enqueue the transfer or record the file operation.
     if (iree_status_is_ok(status)) {
       switch (source_entry->type) {
         case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_SPLAT: {
@@ -884,10 +1332,14 @@ static iree_status_t iree_io_parameter_index_provider_gather(
         }
         case IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE: {
           IREE_ASSERT(source_file);
-          status = iree_io_parameter_op_batch_enqueue_file_read(
-              &batch, source_file,
-              source_entry->storage.file.offset + span.parameter_offset,
-              target_buffer, span.buffer_offset, span.length, 0);
+          if (span.length == 0) break;
+          iree_io_parameter_gather_op_t* op = &ops[op_count++];
+          op->file = source_file;
+          iree_hal_file_retain(source_file);
+          op->file_offset =
+              source_entry->storage.file.offset + span.parameter_offset;
+          op->buffer_offset = span.buffer_offset;
+          op->length = span.length;
           break;
         }
         default: {
@@ -903,9 +1355,61 @@ static iree_status_t iree_io_parameter_index_provider_gather(
     iree_hal_file_release(source_file);
 
     IREE_TRACE_ZONE_END(z_entry);
-    if (!iree_status_is_ok(status)) break;
   }
 
+  // Sort the file reads such that spans with adjacent (or nearby) file ranges
+  // can be coalesced into single large reads. Parameters are usually laid out
+  // contiguously in the file in the same order as they are gathered and in
+  // those cases each run is read with a single operation directly into the
+  // target buffer.
+  if (iree_status_is_ok(status) && op_count > 1) {
+    qsort(ops, op_count, sizeof(*ops), iree_io_parameter_gather_op_compare);
+  }
+  for (iree_host_size_t run_start = 0;
+       run_start < op_count && iree_status_is_ok(status);) {
+    const iree_io_parameter_gather_op_t* run_ops = &ops[run_start];
+    uint64_t run_end_offset = run_ops[0].file_offset + run_ops[0].length;
+    bool is_contiguous = true;
+    iree_host_size_t run_count = 1;
+    for (; run_start + run_count < op_count; ++run_count) {
+      const iree_io_parameter_gather_op_t* prev_op = &run_ops[run_count - 1];
+      const iree_io_parameter_gather_op_t* next_op = &run_ops[run_count];
+      if (next_op->file != run_ops[0].file) break;
+      if (next_op->file_offset > run_end_offset &&
+          next_op->file_offset - run_end_offset >
+              IREE_IO_PARAMETER_GATHER_MAX_GAP_LENGTH) {
+        break;
+      }
+      const uint64_t next_end_offset =
+          iree_max(run_end_offset, next_op->file_offset + next_op->length);
+      if (next_end_offset - run_ops[0].file_offset >
+          IREE_IO_PARAMETER_GATHER_MAX_RUN_LENGTH) {
+        break;
+      }
+      if (next_op->file_offset != prev_op->file_offset + prev_op->length ||
+          next_op->buffer_offset != prev_op->buffer_offset + prev_op->length) {
+        // Large contiguous runs and large spans are read directly instead of
+        // being staged along with their neighbors.
+        if ((is_contiguous && run_end_offset - run_ops[0].file_offset >=
+                                  IREE_IO_PARAMETER_GATHER_MIN_DIRECT_LENGTH) ||
+            next_op->length >= IREE_IO_PARAMETER_GATHER_MIN_DIRECT_LENGTH) {
+          break;
+        }
+        is_contiguous = false;
+      }
+      run_end_offset = next_end_offset;
+    }
+    status = iree_io_parameter_op_batch_enqueue_gather_run(
+        &batch, target_buffer, run_count, run_ops,
+        run_end_offset - run_ops[0].file_offset, is_contiguous);
+    run_start += run_count;
+  }
+
+  for (iree_host_size_t i = 0; i < op_count; ++i) {
+    iree_hal_file_release(ops[i].file);
+  }
+  iree_allocator_free(provider->host_allocator, ops);
+
   // Flush any outstanding batch operations and end the batch.
   status = iree_io_parameter_op_batch_end(&batch, status);
 
@@ -11,6 +11,7 @@
 
 #include "iree/base/api.h"
 #include "iree/hal/api.h"
+#include "iree/io/parameter_dedup_cache.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/parameter_provider.h"
 
@@ -30,11 +31,40 @@ extern "C" {
 // number can reduce system resource requirements during the operation (less
 // transient memory required, etc) while increasing latency (lower I/O
 // utilization).
+//
+// Gathers sort their spans by file offset and coalesce spans that are adjacent
+// (or nearly adjacent) in the same file into single large reads, staging them
+// through transient buffers and copying them into place with a single transfer
+// command buffer when they are not also contiguous in the target buffer.
 IREE_API_EXPORT iree_status_t iree_io_parameter_index_provider_create(
     iree_string_view_t scope, iree_io_parameter_index_t* index,
     iree_host_size_t max_concurrent_operations, iree_allocator_t host_allocator,
     iree_io_parameter_provider_t** out_provider);
 
+// Creates a parameter provider serving from the provided |index| as with
+// iree_io_parameter_index_provider_create that deduplicates loads through the
+// optional |dedup_cache|.
+//
+// Loads of file-backed parameters with a known content hash (such as those
+// parsed from archives built with content hashes) first look for a buffer
+// previously loaded with the same contents, span, device, queue affinity, and
+// buffer parameters in the cache. Hits return the cached buffer without any
+// I/O and are ordered after the load that produced it. Misses are loaded as
+// normal and inserted into the cache once the load has been enqueued. Sharing
+// one cache across the providers of multiple scopes or archives allows any
+// parameters they have in common to be resident only once.
+//
+// Cached buffers remain live until the cache is trimmed. Providers trim the
+// cache when they receive IREE_IO_PARAMETER_PROVIDER_SIGNAL_SUSPEND or
+// IREE_IO_PARAMETER_PROVIDER_SIGNAL_LOW_MEMORY.
+IREE_API_EXPORT iree_status_t
+iree_io_parameter_index_provider_create_with_dedup_cache(
+    iree_string_view_t scope, iree_io_parameter_index_t* index,
+    iree_host_size_t max_concurrent_operations,
+    iree_io_parameter_dedup_cache_t* dedup_cache,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,662 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/io/parameter_residency_provider.h"
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_residency_entry_t
+//===----------------------------------------------------------------------===//
+
+// A resident parameter span loaded for a particular device.
+typedef struct iree_io_parameter_residency_entry_t {
+  // Adjacent entries in least-recently-used order. The provider head is the
+  // most recently used entry and the tail is the least recently used.
+  struct iree_io_parameter_residency_entry_t* prev;
+  struct iree_io_parameter_residency_entry_t* next;
+  // Hash of the scope, key, and span used to accelerate lookups.
+  uint64_t hash;
+  // Device and queues the buffer was loaded for.
+  iree_hal_device_t* device;  // retained
+  iree_hal_queue_affinity_t queue_affinity;
+  // Buffer parameters requested by the load.
+  iree_hal_buffer_params_t params;
+  // Parameter scope and key stored in the trailing entry allocation.
+  iree_string_view_t scope;
+  iree_string_view_t key;
+  // Parameter span requested by the load.
+  iree_io_parameter_span_t span;
+  // Buffer produced by the load.
+  iree_hal_buffer_t* buffer;  // retained
+  // Semaphore signaled to |ready_value| when the load producing the buffer
+  // completes. NULL once the load is known to have completed successfully.
+  iree_hal_semaphore_t* ready_semaphore;  // retained
+  uint64_t ready_value;
+} iree_io_parameter_residency_entry_t;
+
+// FNV-1a; lookups only need to discard most mismatches quickly.
+static uint64_t iree_io_parameter_residency_hash_bytes(
+    uint64_t hash, const void* data, iree_host_size_t length) {
+  const uint8_t* bytes = (const uint8_t*)data;
+  for (iree_host_size_t i = 0; i < length; ++i) {
+    hash = (hash ^ bytes[i]) * 0x100000001B3ull;
+  }
+  return hash;
+}
+
+static uint64_t iree_io_parameter_residency_hash(
+    iree_string_view_t scope, iree_string_view_t key,
+    const iree_io_parameter_span_t* span) {
+  uint64_t hash = 0xCBF29CE484222325ull;
+  hash = iree_io_parameter_residency_hash_bytes(hash, scope.data, scope.size);
+  hash = iree_io_parameter_residency_hash_bytes(hash, key.data, key.size);
+  hash = iree_io_parameter_residency_hash_bytes(hash, &span->parameter_offset,
+                                                sizeof(span->parameter_offset));
+  hash = iree_io_parameter_residency_hash_bytes(hash, &span->buffer_offset,
+                                                sizeof(span->buffer_offset));
+  hash = iree_io_parameter_residency_hash_bytes(hash, &span->length,
+                                                sizeof(span->length));
+  return hash;
+}
+
+// Returns true if the load that produced the |entry| buffer has completed.
+// Sets |out_failed| if the load failed and the buffer contents are invalid.
+static bool iree_io_parameter_residency_entry_is_ready(
+    iree_io_parameter_residency_entry_t* entry, bool* out_failed) {
+  *out_failed = false;
+  if (!entry->ready_semaphore) return true;
+  uint64_t value = 0;
+  iree_status_t status =
+      iree_hal_semaphore_query(entry->ready_semaphore, &value);
+  if (!iree_status_is_ok(status)) {
+    iree_status_ignore(status);
+    *out_failed = true;
+    return true;
+  } else if (value < entry->ready_value) {
+    return false;
+  }
+  iree_hal_semaphore_release(entry->ready_semaphore);
+  entry->ready_semaphore = NULL;
+  return true;
+}
+
+// Returns true if the |entry| buffer is only referenced by the provider.
+static bool iree_io_parameter_residency_entry_is_unreferenced(
+    const iree_io_parameter_residency_entry_t* entry) {
+  return iree_atomic_ref_count_load(
+             &((iree_hal_resource_t*)entry->buffer)->ref_count) == 1;
+}
+
+//===----------------------------------------------------------------------===//
+// iree_io_parameter_residency_provider_t
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_io_parameter_residency_provider_t {
+  iree_io_parameter_provider_t base;
+  iree_allocator_t host_allocator;
+  // Provider all operations are forwarded to.
+  iree_io_parameter_provider_t* base_provider;
+  // Total number of resident bytes before eviction occurs.
+  iree_device_size_t budget;
+
+  // Guards the residency state and serializes loads.
+  iree_slim_mutex_t mutex;
+  // Total bytes of all resident buffers.
+  iree_device_size_t resident_size;
+  // Most recently used entry.
+  iree_io_parameter_residency_entry_t* head;
+  // Least recently used entry.
+  iree_io_parameter_residency_entry_t* tail;
+} iree_io_parameter_residency_provider_t;
+
+static const iree_io_parameter_provider_vtable_t
+    iree_io_parameter_residency_provider_vtable;
+
+static iree_io_parameter_residency_provider_t*
+iree_io_parameter_residency_provider_cast(
+    iree_io_parameter_provider_t* IREE_RESTRICT base_provider) {
+  return (iree_io_parameter_residency_provider_t*)base_provider;
+}
+
+IREE_API_EXPORT iree_status_t iree_io_parameter_residency_provider_create(
+    iree_io_parameter_provider_t* base_provider, iree_device_size_t budget,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider) {
+  IREE_ASSERT_ARGUMENT(base_provider);
+  IREE_ASSERT_ARGUMENT(out_provider);
+  *out_provider = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)budget);
+
+  iree_io_parameter_residency_provider_t* provider = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*provider),
+                                (void**)&provider));
+  iree_atomic_ref_count_init(&provider->base.ref_count);
+  provider->base.vtable = &iree_io_parameter_residency_provider_vtable;
+  provider->host_allocator = host_allocator;
+  provider->base_provider = base_provider;
+  iree_io_parameter_provider_retain(base_provider);
+  provider->budget = budget;
+  iree_slim_mutex_initialize(&provider->mutex);
+
+  *out_provider = (iree_io_parameter_provider_t*)provider;
+  IREE_TRACE_ZONE_END(z0);
+  return iree_ok_status();
+}
+
+// Inserts a new entry for |buffer| as the most recently used entry.
+static iree_status_t iree_io_parameter_residency_provider_insert(
+    iree_io_parameter_residency_provider_t* provider, iree_hal_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity, iree_hal_buffer_params_t params,
+    iree_string_view_t scope, iree_string_view_t key,
+    const iree_io_parameter_span_t* span, iree_hal_buffer_t* buffer,
+    iree_hal_semaphore_t* ready_semaphore, uint64_t ready_value) {
+  iree_io_parameter_residency_entry_t* entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      provider->host_allocator, sizeof(*entry) + scope.size + key.size,
+      (void**)&entry));
+  char* string_storage = (char*)entry + sizeof(*entry);
+  memcpy(string_storage, scope.data, scope.size);
+  entry->scope = iree_make_string_view(string_storage, scope.size);
+  memcpy(string_storage + scope.size, key.data, key.size);
+  entry->key = iree_make_string_view(string_storage + scope.size, key.size);
+  entry->hash = iree_io_parameter_residency_hash(scope, key, span);
+  entry->device = device;
+  iree_hal_device_retain(device);
+  entry->queue_affinity = queue_affinity;
+  entry->params = params;
+  entry->span = *span;
+  entry->buffer = buffer;
+  iree_hal_buffer_retain(buffer);
+  entry->ready_semaphore = ready_semaphore;
+  iree_hal_semaphore_retain(ready_semaphore);
+  entry->ready_value = ready_value;
+
+  entry->prev = NULL;
+  entry->next = provider->head;
+  if (provider->head) provider->head->prev = entry;
+  provider->head = entry;
+  if (!provider->tail) provider->tail = entry;
+  provider->resident_size += iree_hal_buffer_byte_length(buffer);
+  return iree_ok_status();
+}
+
+// Removes |entry| from the provider and releases its resources.
+static void iree_io_parameter_residency_provider_remove(
+    iree_io_parameter_residency_provider_t* provider,
+    iree_io_parameter_residency_entry_t* entry) {
+  if (entry->prev) {
+    entry->prev->next = entry->next;
+  } else {
+    provider->head = entry->next;
+  }
+  if (entry->next) {
+    entry->next->prev = entry->prev;
+  } else {
+    provider->tail = entry->prev;
+  }
+  provider->resident_size -= iree_hal_buffer_byte_length(entry->buffer);
+  iree_hal_semaphore_release(entry->ready_semaphore);
+  iree_hal_buffer_release(entry->buffer);
+  iree_hal_device_release(entry->device);
+  iree_allocator_free(provider->host_allocator, entry);
+}
+
+// Moves |entry| to the head of the LRU list.
+static void iree_io_parameter_residency_provider_touch(
+    iree_io_parameter_residency_provider_t* provider,
+    iree_io_parameter_residency_entry_t* entry) {
+  if (provider->head == entry) return;
+  entry->prev->next = entry->next;
+  if (entry->next) {
+    entry->next->prev = entry->prev;
+  } else {
+    provider->tail = entry->prev;
+  }
+  entry->prev = NULL;
+  entry->next = provider->head;
+  provider->head->prev = entry;
+  provider->head = entry;
+}
+
+// Returns the resident entry matching the load request or NULL if not resident.
+// Entries whose loads failed are removed and treated as not resident.
+static iree_io_parameter_residency_entry_t*
+iree_io_parameter_residency_provider_lookup(
+    iree_io_parameter_residency_provider_t* provider, iree_hal_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity, iree_hal_buffer_params_t params,
+    iree_string_view_t scope, iree_string_view_t key,
+    const iree_io_parameter_span_t* span) {
+  const uint64_t hash = iree_io_parameter_residency_hash(scope, key, span);
+  for (iree_io_parameter_residency_entry_t* entry = provider->head; entry;
+       entry = entry->next) {
+    if (entry->hash != hash || entry->device != device ||
+        entry->queue_affinity != queue_affinity ||
+        entry->params.type != params.type ||
+        entry->params.usage != params.usage ||
+        entry->params.access != params.access ||
+        entry->span.parameter_offset != span->parameter_offset ||
+        entry->span.buffer_offset != span->buffer_offset ||
+        entry->span.length != span->length ||
+        !iree_string_view_equal(entry->scope, scope) ||
+        !iree_string_view_equal(entry->key, key)) {
+      continue;
+    }
+    bool is_failed = false;
+    iree_io_parameter_residency_entry_is_ready(entry, &is_failed);
+    if (is_failed) {
+      iree_io_parameter_residency_provider_remove(provider, entry);
+      return NULL;
+    }
+    return entry;
+  }
+  return NULL;
+}
+
+// Releases all resident buffers that are not referenced outside of the
+// provider and whose loads have completed.
+static void iree_io_parameter_residency_provider_trim(
+    iree_io_parameter_residency_provider_t* provider) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_io_parameter_residency_entry_t* entry = provider->tail;
+  while (entry) {
+    iree_io_parameter_residency_entry_t* prev = entry->prev;
+    bool is_failed = false;
+    if (iree_io_parameter_residency_entry_is_ready(entry, &is_failed) &&
+        iree_io_parameter_residency_entry_is_unreferenced(entry)) {
+      iree_io_parameter_residency_provider_remove(provider, entry);
+    }
+    entry = prev;
+  }
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)provider->resident_size);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static void iree_io_parameter_residency_provider_destroy(
+    iree_io_parameter_provider_t* IREE_RESTRICT base_provider) {
+  iree_io_parameter_residency_provider_t* provider =
+      iree_io_parameter_residency_provider_cast(base_provider);
+  iree_allocator_t host_allocator = provider->host_allocator;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Resources are safe to release even if there are pending device operations
+  // as the device guarantees the resources remain live.
+  while (provider->head) {
+    iree_io_parameter_residency_provider_remove(provider, provider->head);
+  }
+  iree_slim_mutex_deinitialize(&provider->mutex);
+  iree_io_parameter_provider_release(provider->base_provider);
+
+  iree_allocator_free(host_allocator, provider);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+static iree_status_t iree_io_parameter_residency_provider_notify(
+    iree_io_parameter_provider_t* base_provider,
+    iree_io_parameter_provider_signal_t signal) {
+  iree_io_parameter_residency_provider_t* provider =
+      iree_io_parameter_residency_provider_cast(base_provider);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  switch (signal) {
+    case IREE_IO_PARAMETER_PROVIDER_SIGNAL_SUSPEND:
+    case IREE_IO_PARAMETER_PROVIDER_SIGNAL_LOW_MEMORY:
+      iree_slim_mutex_lock(&provider->mutex);
+      iree_io_parameter_residency_provider_trim(provider);
+      iree_slim_mutex_unlock(&provider->mutex);
+      break;
+    default:
+      break;
+  }
+
+  iree_status_t status =
+      iree_io_parameter_provider_notify(provider->base_provider, signal);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static bool iree_io_parameter_residency_provider_query_support(
+    iree_io_parameter_provider_t* base_provider, iree_string_view_t scope) {
+  iree_io_parameter_residency_provider_t* provider =
+      iree_io_parameter_residency_provider_cast(base_provider);
+  return iree_io_parameter_provider_query_support(provider->base_provider,
+                                                  scope);
+}
+
+// Evicts unreferenced entries in least-recently-used order until
+// |required_size| additional bytes fit within the budget. Buffers loaded for
+// |device| are deallocated in queue order by chaining deallocations on
+// |timeline_semaphore| starting after |wait_semaphore_list| and buffers for
+// other devices are released immediately. Returns the timeline value that
+// subsequent operations must wait on or 0 if no deallocations were enqueued.
+static iree_status_t iree_io_parameter_residency_provider_evict(
+    iree_io_parameter_residency_provider_t* provider, iree_hal_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    iree_device_size_t required_size, iree_hal_semaphore_t* timeline_semaphore,
+    uint64_t* out_timeline_value) {
+  *out_timeline_value = 0;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)required_size);
+
+  uint64_t timeline_value = 0;
+  iree_status_t status = iree_ok_status();
+  iree_io_parameter_residency_entry_t* entry = provider->tail;
+  while (entry && provider->resident_size + required_size > provider->budget) {
+    iree_io_parameter_residency_entry_t* prev = entry->prev;
+    bool is_failed = false;
+    if (!iree_io_parameter_residency_entry_is_ready(entry, &is_failed) ||
+        !iree_io_parameter_residency_entry_is_unreferenced(entry)) {
+      entry = prev;
+      continue;
+    }
+    if (entry->device == device && !is_failed) {
+      // Deallocate in queue order so that the memory is available to the
+      // allocations that follow.
+      iree_hal_semaphore_list_t dealloca_wait_semaphore_list =
+          wait_semaphore_list;
+      if (timeline_value > 0) {
+        dealloca_wait_semaphore_list.count = 1;
+        dealloca_wait_semaphore_list.semaphores = &timeline_semaphore;
+        dealloca_wait_semaphore_list.payload_values = &timeline_value;
+      }
+      uint64_t next_timeline_value = timeline_value + 1;
+      iree_hal_semaphore_list_t dealloca_signal_semaphore_list = {
+          .count = 1,
+          .semaphores = &timeline_semaphore,
+          .payload_values = &next_timeline_value,
+      };
+      status = iree_hal_device_queue_dealloca(
+          device, queue_affinity, dealloca_wait_semaphore_list,
+          dealloca_signal_semaphore_list, entry->buffer);
+      if (!iree_status_is_ok(status)) break;
+      timeline_value = next_timeline_value;
+    }
+    iree_io_parameter_residency_provider_remove(provider, entry);
+    entry = prev;
+  }
+
+  *out_timeline_value = timeline_value;
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)provider->resident_size);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// State for a load of non-resident parameters forwarded to the base provider.
+typedef struct iree_io_parameter_residency_load_state_t {
+  iree_io_parameter_residency_provider_t* provider;
+  iree_hal_device_t* device;
+  iree_hal_queue_affinity_t queue_affinity;
+  iree_hal_buffer_params_t params;
+  iree_string_view_t scope;
+  // Original request enumerator and emitter.
+  iree_io_parameter_enumerator_t enumerator;
+  iree_io_parameter_emitter_t emitter;
+  // Indices into the original request of each forwarded parameter.
+  const iree_host_size_t* indices;
+  // Semaphore and value signaled when the forwarded load completes.
+  iree_hal_semaphore_t* ready_semaphore;
+  uint64_t ready_value;
+} iree_io_parameter_residency_load_state_t;
+
+static iree_status_t iree_io_parameter_residency_load_enumerate(
+    void* user_data, iree_host_size_t i, iree_string_view_t* out_key,
+    iree_io_parameter_span_t* out_span) {
+  iree_io_parameter_residency_load_state_t* state =
+      (iree_io_parameter_residency_load_state_t*)user_data;
+  return state->enumerator.fn(state->enumerator.user_data, state->indices[i],
+                              out_key, out_span);
+}
+
+static iree_status_t iree_io_parameter_residency_load_emit(
+    void* user_data, iree_host_size_t i, iree_hal_buffer_t* buffer) {
+  iree_io_parameter_residency_load_state_t* state =
+      (iree_io_parameter_residency_load_state_t*)user_data;
+  const iree_host_size_t index = state->indices[i];
+  iree_string_view_t key = iree_string_view_empty();
+  iree_io_parameter_span_t span = {0};
+  IREE_RETURN_IF_ERROR(state->enumerator.fn(state->enumerator.user_data, index,
+                                            &key, &span));
+  IREE_RETURN_IF_ERROR(iree_io_parameter_residency_provider_insert(
+      state->provider, state->device, state->queue_affinity, state->params,
+      state->scope, key, &span, buffer, state->ready_semaphore,
+      state->ready_value));
+  return state->emitter.fn(state->emitter.user_data, index, buffer);
+}
+
+static iree_status_t iree_io_parameter_residency_provider_load_locked(
+    iree_io_parameter_residency_provider_t* provider, iree_hal_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_string_view_t source_scope, iree_hal_buffer_params_t target_params,
+    iree_host_size_t count, iree_io_parameter_enumerator_t enumerator,
+    iree_io_parameter_emitter_t emitter) {
+  // Scratch storage for the indices of non-resident parameters and the final
+  // join wait list. Each resident parameter may contribute a pending load.
+  iree_host_size_t miss_count = 0;
+  iree_host_size_t* miss_indices = NULL;
+  const iree_host_size_t max_wait_count = count + wait_semaphore_list.count + 1;
+  iree_hal_semaphore_t** wait_semaphores = NULL;
+  uint64_t* wait_values = NULL;
+  iree_host_size_t wait_count = 0;
+  iree_host_size_t total_size =
+      count * sizeof(*miss_indices) +
+      max_wait_count * (sizeof(*wait_semaphores) + sizeof(*wait_values));
+  uint8_t* scratch = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(provider->host_allocator,
+                                             total_size, (void**)&scratch));
+  wait_values = (uint64_t*)scratch;
+  miss_indices = (iree_host_size_t*)(wait_values + max_wait_count);
+  wait_semaphores = (iree_hal_semaphore_t**)(miss_indices + count);
+
+  // Emit resident parameters and gather the non-resident ones.
+  iree_status_t status = iree_ok_status();
+  iree_device_size_t required_size = 0;
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    iree_string_view_t key = iree_string_view_empty();
+    iree_io_parameter_span_t span = {0};
+    status = enumerator.fn(enumerator.user_data, i, &key, &span);
+    if (!iree_status_is_ok(status)) break;
+    iree_io_parameter_residency_entry_t* entry =
+        iree_io_parameter_residency_provider_lookup(
+            provider, device, queue_affinity, target_params, source_scope, key,
+            &span);
+    if (!entry) {
+      miss_indices[miss_count++] = i;
+      required_size += span.length;
+      continue;
+    }
+    iree_io_parameter_residency_provider_touch(provider, entry);
+
+    // If the load producing the buffer is still in-flight the request must
+    // wait for it.
+    bool is_failed = false;
+    if (!iree_io_parameter_residency_entry_is_ready(entry, &is_failed)) {
+      bool is_waiting = false;
+      for (iree_host_size_t j = 0; j < wait_count; ++j) {
+        if (wait_semaphores[j] == entry->ready_semaphore) {
+          wait_values[j] = iree_max(wait_values[j], entry->ready_value);
+          is_waiting = true;
+          break;
+        }
+      }
+      if (!is_waiting) {
+        wait_semaphores[wait_count] = entry->ready_semaphore;
+        wait_values[wait_count] = entry->ready_value;
+        ++wait_count;
+      }
+    }
+
+    status = emitter.fn(emitter.user_data, i, entry->buffer);
+    if (!iree_status_is_ok(status)) break;
+  }
+
+  // Make room for and load all non-resident parameters. Evictions and the load
+  // are chained on a timeline that the request signal waits on.
+  iree_hal_semaphore_t* timeline_semaphore = NULL;
+  if (iree_status_is_ok(status) && miss_count > 0) {
+    status = iree_hal_semaphore_create(device, 0ull,
+                                       IREE_HAL_SEMAPHORE_FLAG_NONE,
+                                       &timeline_semaphore);
+    uint64_t timeline_value = 0;
+    if (iree_status_is_ok(status)) {
+      status = iree_io_parameter_residency_provider_evict(
+          provider, device, queue_affinity, wait_semaphore_list, required_size,
+          timeline_semaphore, &timeline_value);
+    }
+    if (iree_status_is_ok(status)) {
+      iree_hal_semaphore_list_t load_wait_semaphore_list = wait_semaphore_list;
+      if (timeline_value > 0) {
+        load_wait_semaphore_list.count = 1;
+        load_wait_semaphore_list.semaphores = &timeline_semaphore;
+        load_wait_semaphore_list.payload_values = &timeline_value;
+      }
+      uint64_t ready_value = timeline_value + 1;
+      iree_hal_semaphore_list_t load_signal_semaphore_list = {
+          .count = 1,
+          .semaphores = &timeline_semaphore,
+          .payload_values = &ready_value,
+      };
+      iree_io_parameter_residency_load_state_t state = {
+          .provider = provider,
+          .device = device,
+          .queue_affinity = queue_affinity,
+          .params = target_params,
+          .scope = source_scope,
+          .enumerator = enumerator,
+          .emitter = emitter,
+          .indices = miss_indices,
+          .ready_semaphore = timeline_semaphore,
+          .ready_value = ready_value,
+      };
+      status = iree_io_parameter_provider_load(
+          provider->base_provider, device, queue_affinity,
+          load_wait_semaphore_list, load_signal_semaphore_list, source_scope,
+          target_params, miss_count,
+          (iree_io_parameter_enumerator_t){
+              .fn = iree_io_parameter_residency_load_enumerate,
+              .user_data = &state,
+          },
+          (iree_io_parameter_emitter_t){
+              .fn = iree_io_parameter_residency_load_emit,
+              .user_data = &state,
+          });
+      wait_semaphores[wait_count] = timeline_semaphore;
+      wait_values[wait_count] = ready_value;
+      ++wait_count;
+    }
+  } else {
+    // The base load is what waits on the request wait list when issued and
+    // otherwise we have to.
+    for (iree_host_size_t i = 0; i < wait_semaphore_list.count; ++i) {
+      wait_semaphores[wait_count] = wait_semaphore_list.semaphores[i];
+      wait_values[wait_count] = wait_semaphore_list.payload_values[i];
+      ++wait_count;
+    }
+  }
+
+  // Join the pending loads and signal the request.
+  if (iree_status_is_ok(status)) {
+    iree_hal_semaphore_list_t join_semaphore_list = {
+        .count = wait_count,
+        .semaphores = wait_semaphores,
+        .payload_values = wait_values,
+    };
+    status = iree_hal_device_queue_barrier(
+        device, queue_affinity, join_semaphore_list, signal_semaphore_list);
+  }
+
+  // Drop any entries inserted by a failed load.
+  if (!iree_status_is_ok(status) && timeline_semaphore) {
+    iree_io_parameter_residency_entry_t* entry = provider->head;
+    while (entry) {
+      iree_io_parameter_residency_entry_t* next = entry->next;
+      if (entry->ready_semaphore == timeline_semaphore) {
+        iree_io_parameter_residency_provider_remove(provider, entry);
+      }
+      entry = next;
+    }
+  }
+
+  iree_hal_semaphore_release(timeline_semaphore);
+  iree_allocator_free(provider->host_allocator, scratch);
+  return status;
+}
+
+static iree_status_t iree_io_parameter_residency_provider_load(
+    iree_io_parameter_provider_t* base_provider, iree_hal_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_string_view_t source_scope, iree_hal_buffer_params_t target_params,
+    iree_host_size_t count, iree_io_parameter_enumerator_t enumerator,
+    iree_io_parameter_emitter_t emitter) {
+  iree_io_parameter_residency_provider_t* provider =
+      iree_io_parameter_residency_provider_cast(base_provider);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, count);
+
+  iree_slim_mutex_lock(&provider->mutex);
+  iree_status_t status = iree_io_parameter_residency_provider_load_locked(
+      provider, device, queue_affinity, wait_semaphore_list,
+      signal_semaphore_list, source_scope, target_params, count, enumerator,
+      emitter);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)provider->resident_size);
+  iree_slim_mutex_unlock(&provider->mutex);
+
+  // Propagate failures to the request timeline.
+  if (!iree_status_is_ok(status)) {
+    iree_hal_semaphore_list_fail(signal_semaphore_list,
+                                 iree_status_clone(status));
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_io_parameter_residency_provider_gather(
+    iree_io_parameter_provider_t* base_provider, iree_hal_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_string_view_t source_scope, iree_hal_buffer_t* target_buffer,
+    iree_host_size_t count, iree_io_parameter_enumerator_t enumerator) {
+  iree_io_parameter_residency_provider_t* provider =
+      iree_io_parameter_residency_provider_cast(base_provider);
+  return iree_io_parameter_provider_gather(
+      provider->base_provider, device, queue_affinity, wait_semaphore_list,
+      signal_semaphore_list, source_scope, target_buffer, count, enumerator);
+}
+
+static iree_status_t iree_io_parameter_residency_provider_scatter(
+    iree_io_parameter_provider_t* base_provider, iree_hal_device_t* device,
+    iree_hal_queue_affinity_t queue_affinity,
+    const iree_hal_semaphore_list_t wait_semaphore_list,
+    const iree_hal_semaphore_list_t signal_semaphore_list,
+    iree_hal_buffer_t* source_buffer, iree_string_view_t target_scope,
+    iree_host_size_t count, iree_io_parameter_enumerator_t enumerator) {
+  iree_io_parameter_residency_provider_t* provider =
+      iree_io_parameter_residency_provider_cast(base_provider);
+  return iree_io_parameter_provider_scatter(
+      provider->base_provider, device, queue_affinity, wait_semaphore_list,
+      signal_semaphore_list, source_buffer, target_scope, count, enumerator);
+}
+
+static const iree_io_parameter_provider_vtable_t
+    iree_io_parameter_residency_provider_vtable = {
+        .destroy = iree_io_parameter_residency_provider_destroy,
+        .notify = iree_io_parameter_residency_provider_notify,
+        .query_support = iree_io_parameter_residency_provider_query_support,
+        .load = iree_io_parameter_residency_provider_load,
+        .gather = iree_io_parameter_residency_provider_gather,
+        .scatter = iree_io_parameter_residency_provider_scatter,
+};
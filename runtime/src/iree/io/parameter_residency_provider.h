@@ -0,0 +1,49 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_IO_PARAMETER_RESIDENCY_PROVIDER_H_
+#define IREE_IO_PARAMETER_RESIDENCY_PROVIDER_H_
+
+#include <stdint.h>
+
+#include "iree/base/api.h"
+#include "iree/hal/api.h"
+#include "iree/io/parameter_provider.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Creates a parameter provider that keeps the buffers produced by loads from
+// |base_provider| resident up to |budget| bytes of device memory.
+//
+// Loads of a parameter span that is already resident return the resident
+// buffer without any I/O and are ordered after the load that made it resident.
+// Loads of non-resident spans are forwarded to |base_provider| and the
+// resulting buffers are tracked in least-recently-used order. When a load would
+// exceed the budget the least recently used buffers that are no longer
+// referenced outside of the provider are evicted by enqueuing
+// iree_hal_device_queue_dealloca operations ordered before the new allocations
+// so that the memory can be reused by them. Buffers still referenced by the
+// program are never evicted and the budget may be exceeded while they are
+// live. Programs that load parameters on demand (such as per-expert weights)
+// immediately prior to their use have cold parameters paged out and hot
+// parameters kept resident.
+//
+// Gathers and scatters are forwarded to |base_provider| unmodified.
+// IREE_IO_PARAMETER_PROVIDER_SIGNAL_SUSPEND and
+// IREE_IO_PARAMETER_PROVIDER_SIGNAL_LOW_MEMORY release all unreferenced
+// resident buffers.
+IREE_API_EXPORT iree_status_t iree_io_parameter_residency_provider_create(
+    iree_io_parameter_provider_t* base_provider, iree_device_size_t budget,
+    iree_allocator_t host_allocator,
+    iree_io_parameter_provider_t** out_provider);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_IO_PARAMETER_RESIDENCY_PROVIDER_H_
@@ -567,14 +567,21 @@ IREE_VM_ABI_EXPORT(iree_hal_inline_module_device_query_i64,  //
 // VM module interface implementation
 //===----------------------------------------------------------------------===//
 
+// Shims specialized for each export so that calls are made directly to the
+// target functions instead of through the shared per-signature shims.
+#define EXPORT_FN(name, target_fn, arg_types, ret_types)                    \
+  IREE_VM_ABI_DEFINE_EXPORT_SHIM(target_fn, iree_hal_inline_module_state_t, \
+                                 arg_types, ret_types)
+#include "iree/modules/hal/inline/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN
+
 // NOTE: this must match the ordering of the iree_hal_inline_module_exports_
 // table.
 static const iree_vm_native_function_ptr_t iree_hal_inline_module_funcs_[] = {
-#define EXPORT_FN(name, target_fn, arg_types, ret_types)       \
-  {                                                            \
-      .shim = (iree_vm_native_function_shim_t)                 \
-          iree_vm_shim_##arg_types##_##ret_types,              \
-      .target = (iree_vm_native_function_target_t)(target_fn), \
+#define EXPORT_FN(name, target_fn, arg_types, ret_types)          \
+  {                                                               \
+      .shim = (iree_vm_native_function_shim_t)(target_fn##_shim), \
+      .target = NULL,                                             \
   },
 #include "iree/modules/hal/inline/exports.inl"  // IWYU pragma: keep
 #undef EXPORT_FN
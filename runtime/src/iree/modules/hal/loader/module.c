@@ -21,6 +21,9 @@
 typedef struct iree_hal_loader_module_t {
   iree_allocator_t host_allocator;
   iree_hal_loader_module_flags_t flags;
+  // Used to distribute workgroups across threads; unused when worker_count
+  // is 1 or less.
+  iree_hal_loader_parallel_for_t parallel_for;
   // TODO(benvanik): types.
   iree_host_size_t loader_count;
   iree_hal_executable_loader_t* loaders[];
@@ -33,6 +36,8 @@ typedef struct iree_hal_loader_module_t {
 typedef struct iree_hal_loader_module_state_t {
   iree_allocator_t host_allocator;
   iree_hal_loader_module_flags_t flags;
+  // Borrowed from the module which outlives all of its states.
+  const iree_hal_loader_parallel_for_t* parallel_for;
 } iree_hal_loader_module_state_t;
 
 static void IREE_API_PTR iree_hal_loader_module_destroy(void* base_module) {
@@ -40,6 +45,9 @@ static void IREE_API_PTR iree_hal_loader_module_destroy(void* base_module) {
   for (iree_host_size_t i = 0; i < module->loader_count; ++i) {
     iree_hal_executable_loader_release(module->loaders[i]);
   }
+  if (module->parallel_for.release) {
+    module->parallel_for.release(module->parallel_for.self);
+  }
 }
 
 static iree_status_t IREE_API_PTR
@@ -55,6 +63,7 @@ iree_hal_loader_module_alloc_state(void* self, iree_allocator_t host_allocator,
   memset(state, 0, sizeof(*state));
   state->host_allocator = host_allocator;
   state->flags = module->flags;
+  state->parallel_for = &module->parallel_for;
 
   *out_module_state = (iree_vm_module_state_t*)state;
   IREE_TRACE_ZONE_END(z0);
@@ -208,7 +217,8 @@ IREE_HAL_ABI_EXPORT(iree_hal_loader_module_executable_load,  //
   iree_hal_executable_params_initialize(&executable_params);
   executable_params.caching_mode |=
       executable_data->access == IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE
-          ? IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA
+          ? IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA |
+                IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_DEFERRED_LOADING
           : 0;
   executable_params.executable_format = executable_format_str;
   executable_params.executable_data = iree_make_const_byte_span(
@@ -242,6 +252,37 @@ typedef struct {
   const iree_vm_abi_rII_t* bindings;
 } iree_hal_loader_dispatch_args_t;
 
+// A dispatch whose workgroups are distributed by a parallel-for.
+typedef struct iree_hal_loader_workgroup_task_t {
+  iree_hal_local_executable_t* executable;
+  iree_host_size_t ordinal;
+  const iree_hal_executable_dispatch_state_v0_t* dispatch_state;
+  uint32_t processor_id;
+  iree_byte_span_t local_memory;
+} iree_hal_loader_workgroup_task_t;
+
+// Issues the workgroup with the linearized |index| (x fastest varying).
+static iree_status_t IREE_API_PTR iree_hal_loader_module_issue_workgroup(
+    void* task_user_data, uint32_t index, uint32_t worker_id) {
+  const iree_hal_loader_workgroup_task_t* task =
+      (const iree_hal_loader_workgroup_task_t*)task_user_data;
+  const iree_hal_executable_dispatch_state_v0_t* dispatch_state =
+      task->dispatch_state;
+  const uint32_t count_x = dispatch_state->workgroup_count_x;
+  const uint32_t count_xy = count_x * dispatch_state->workgroup_count_y;
+  iree_alignas(64) iree_hal_executable_workgroup_state_v0_t workgroup_state = {
+      .workgroup_id_x = index % count_x,
+      .workgroup_id_y = (index % count_xy) / count_x,
+      .workgroup_id_z = index / count_xy,
+      .processor_id = task->processor_id,
+      .local_memory = task->local_memory.data,
+      .local_memory_size = (size_t)task->local_memory.data_length,
+  };
+  return iree_hal_local_executable_issue_call(
+      task->executable, task->ordinal, dispatch_state, &workgroup_state,
+      worker_id);
+}
+
 static iree_status_t iree_hal_loader_module_executable_dispatch(
     iree_vm_stack_t* IREE_RESTRICT stack, void* IREE_RESTRICT module,
     iree_hal_loader_module_state_t* IREE_RESTRICT state,
@@ -274,6 +315,15 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
     binding_lengths[i] = span.data_length;
   }
 
+  // Workgroups are only distributed when there are enough to keep more than
+  // one worker busy.
+  const iree_hal_loader_parallel_for_t* parallel_for = state->parallel_for;
+  const uint64_t workgroup_count =
+      (uint64_t)args->workgroup_x * args->workgroup_y * args->workgroup_z;
+  const bool use_parallel_for = parallel_for->worker_count > 1 &&
+                                workgroup_count > 1 &&
+                                workgroup_count <= UINT32_MAX;
+
   const iree_hal_executable_dispatch_state_v0_t dispatch_state = {
       .workgroup_size_x = 1,
       .workgroup_size_y = 1,
@@ -282,7 +332,7 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
       .workgroup_count_x = args->workgroup_x,
       .workgroup_count_y = args->workgroup_y,
       .workgroup_count_z = args->workgroup_z,
-      .max_concurrency = 1,
+      .max_concurrency = use_parallel_for ? parallel_for->worker_count : 1,
       .binding_count = args->binding_count,
       .constants = args->constants,
       .binding_ptrs = binding_ptrs,
@@ -293,6 +343,24 @@ static iree_status_t iree_hal_loader_module_executable_dispatch(
   uint32_t processor_id = 0;
   iree_byte_span_t local_memory = iree_byte_span_empty();
 
+  if (use_parallel_for) {
+    IREE_RETURN_IF_ERROR(iree_hal_local_executable_ensure_loaded(
+        (iree_hal_local_executable_t*)executable));
+    IREE_TRACE_ZONE_BEGIN(z0);
+    iree_hal_loader_workgroup_task_t task = {
+        .executable = (iree_hal_local_executable_t*)executable,
+        .ordinal = args->entry_point,
+        .dispatch_state = &dispatch_state,
+        .processor_id = processor_id,
+        .local_memory = local_memory,
+    };
+    iree_status_t status = parallel_for->fn(
+        parallel_for->self, (uint32_t)workgroup_count,
+        iree_hal_loader_module_issue_workgroup, &task);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   return iree_hal_local_executable_issue_dispatch_inline(
       (iree_hal_local_executable_t*)executable, args->entry_point,
       &dispatch_state, processor_id, local_memory);
@@ -396,9 +464,24 @@ IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
     iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  return iree_hal_loader_module_create_with_parallel_for(
+      instance, flags, iree_hal_loader_parallel_for_null(), loader_count,
+      loaders, host_allocator, out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_hal_loader_module_create_with_parallel_for(
+    iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
+    iree_hal_loader_parallel_for_t parallel_for, iree_host_size_t loader_count,
+    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
+    iree_vm_module_t** out_module) {
   IREE_ASSERT_ARGUMENT(instance);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
+  if (parallel_for.worker_count > 1 && !parallel_for.fn) {
+    if (parallel_for.release) parallel_for.release(parallel_for.self);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "parallel-for with workers requires a function");
+  }
 
   // Setup the interface with the functions we implement ourselves. Any function
   // we omit will be handled by the base native module.
@@ -415,20 +498,26 @@ IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
       iree_vm_native_module_size() + sizeof(iree_hal_loader_module_t) +
       loader_count * sizeof(iree_hal_executable_loader_t*);
   iree_vm_module_t* base_module = NULL;
-  IREE_RETURN_IF_ERROR(
-      iree_allocator_malloc(host_allocator, total_size, (void**)&base_module));
-  memset(base_module, 0, total_size);
-  iree_status_t status = iree_vm_native_module_initialize(
-      &interface, &iree_hal_loader_module_descriptor_, instance, host_allocator,
-      base_module);
+  iree_status_t status =
+      iree_allocator_malloc(host_allocator, total_size, (void**)&base_module);
+  if (iree_status_is_ok(status)) {
+    memset(base_module, 0, total_size);
+    status = iree_vm_native_module_initialize(
+        &interface, &iree_hal_loader_module_descriptor_, instance,
+        host_allocator, base_module);
+    if (!iree_status_is_ok(status)) {
+      iree_allocator_free(host_allocator, base_module);
+    }
+  }
   if (!iree_status_is_ok(status)) {
-    iree_allocator_free(host_allocator, base_module);
+    if (parallel_for.release) parallel_for.release(parallel_for.self);
     return status;
   }
 
   iree_hal_loader_module_t* module = IREE_HAL_LOADER_MODULE_CAST(base_module);
   module->host_allocator = host_allocator;
   module->flags = flags;
+  module->parallel_for = parallel_for;
   module->loader_count = loader_count;
   for (iree_host_size_t i = 0; i < loader_count; ++i) {
     module->loaders[i] = loaders[i];
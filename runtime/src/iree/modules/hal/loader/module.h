@@ -24,12 +24,57 @@ enum iree_hal_loader_module_flag_bits_t {
 };
 typedef uint32_t iree_hal_loader_module_flags_t;
 
+// Function invoked by a parallel-for for each |index| in [0, count).
+// |worker_id| identifies the thread executing the call and is in
+// [0, worker_count) of the parallel-for. Calls running concurrently always
+// have distinct worker IDs.
+typedef iree_status_t(IREE_API_PTR* iree_hal_loader_parallel_for_task_fn_t)(
+    void* task_user_data, uint32_t index, uint32_t worker_id);
+
+// Pluggable parallel-for used to distribute the workgroups of each dispatch
+// across threads. Hosting applications can route this to their own thread pool
+// or use iree_hal_loader_thread_pool_t for a small fixed pool that does not
+// depend on the full task system.
+typedef struct iree_hal_loader_parallel_for_t {
+  // Maximum number of calls to the task function that may run concurrently.
+  // The parallel-for is not used when 1 or less.
+  uint32_t worker_count;
+  // Calls |task_fn| once for each index in [0, count) and returns only once
+  // all calls have completed. Should return the first failure of any call and
+  // may skip remaining indices after one fails.
+  iree_status_t(IREE_API_PTR* fn)(
+      void* self, uint32_t count,
+      iree_hal_loader_parallel_for_task_fn_t task_fn, void* task_user_data);
+  // Optional function called when the module is destroyed.
+  void(IREE_API_PTR* release)(void* self);
+  void* self;
+} iree_hal_loader_parallel_for_t;
+
+// Returns a parallel-for that is never used. Dispatches run serially on the
+// calling thread.
+static inline iree_hal_loader_parallel_for_t iree_hal_loader_parallel_for_null(
+    void) {
+  iree_hal_loader_parallel_for_t parallel_for = {0, NULL, NULL, NULL};
+  return parallel_for;
+}
+
 // Creates the dynamic HAL executable loader module for local execution.
+// All workgroups of a dispatch run serially on the calling thread.
 IREE_API_EXPORT iree_status_t iree_hal_loader_module_create(
     iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
     iree_host_size_t loader_count, iree_hal_executable_loader_t** loaders,
     iree_allocator_t host_allocator, iree_vm_module_t** out_module);
 
+// Creates the dynamic HAL executable loader module for local execution with
+// the workgroups of each dispatch distributed using |parallel_for|. The module
+// takes ownership of |parallel_for| and calls its release function when
+// destroyed, including when creation fails.
+IREE_API_EXPORT iree_status_t iree_hal_loader_module_create_with_parallel_for(
+    iree_vm_instance_t* instance, iree_hal_loader_module_flags_t flags,
+    iree_hal_loader_parallel_for_t parallel_for, iree_host_size_t loader_count,
+    iree_hal_executable_loader_t** loaders, iree_allocator_t host_allocator,
+    iree_vm_module_t** out_module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,250 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/hal/loader/thread_pool.h"
+
+#include <string.h>
+
+#include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
+
+typedef struct iree_hal_loader_thread_pool_worker_t {
+  iree_hal_loader_thread_pool_t* pool;
+  iree_thread_t* thread;
+  uint32_t worker_id;
+} iree_hal_loader_thread_pool_worker_t;
+
+struct iree_hal_loader_thread_pool_t {
+  iree_allocator_t host_allocator;
+
+  // Serializes parallel-fors issued from multiple threads.
+  iree_slim_mutex_t mutex;
+
+  // Incremented for each parallel-for and on shutdown. Workers run the current
+  // parallel-for each time they observe a new epoch.
+  iree_atomic_int32_t epoch;
+  // Set when the pool is being destroyed.
+  iree_atomic_int32_t shutdown;
+  // Posted when the epoch changes.
+  iree_notification_t work_notification;
+
+  // Current parallel-for. Written by the issuing thread before the epoch is
+  // incremented and only read by workers afterwards.
+  iree_hal_loader_parallel_for_task_fn_t task_fn;
+  void* task_user_data;
+  uint32_t count;
+  // Next index to be claimed by any worker.
+  iree_atomic_int32_t next_index;
+  // First failure of any call as an iree_status_t or 0 if all succeeded.
+  iree_atomic_intptr_t status;
+  // Number of threads (excluding the caller) still running the parallel-for.
+  iree_atomic_int32_t pending_thread_count;
+  // Posted when pending_thread_count reaches 0.
+  iree_notification_t done_notification;
+
+  iree_host_size_t worker_count;
+  // Workers [1, worker_count); worker 0 is the calling thread.
+  iree_hal_loader_thread_pool_worker_t workers[];
+};
+
+// Claims and runs indices of the current parallel-for until all are claimed.
+// Stops claiming new indices once any call fails.
+static void iree_hal_loader_thread_pool_run(iree_hal_loader_thread_pool_t* pool,
+                                            uint32_t worker_id) {
+  const uint32_t count = pool->count;
+  while (!iree_atomic_load(&pool->status, iree_memory_order_relaxed)) {
+    uint32_t index = (uint32_t)iree_atomic_fetch_add(
+        &pool->next_index, 1, iree_memory_order_relaxed);
+    if (index >= count) break;
+    iree_status_t status =
+        pool->task_fn(pool->task_user_data, index, worker_id);
+    if (IREE_UNLIKELY(!iree_status_is_ok(status))) {
+      intptr_t expected = 0;
+      if (!iree_atomic_compare_exchange_strong(
+              &pool->status, &expected, (intptr_t)status,
+              iree_memory_order_acq_rel, iree_memory_order_relaxed)) {
+        iree_status_ignore(status);
+      }
+    }
+  }
+}
+
+static bool iree_hal_loader_thread_pool_is_done(void* arg) {
+  iree_hal_loader_thread_pool_t* pool = (iree_hal_loader_thread_pool_t*)arg;
+  return iree_atomic_load(&pool->pending_thread_count,
+                          iree_memory_order_acquire) == 0;
+}
+
+static int iree_hal_loader_thread_pool_worker_main(void* entry_arg) {
+  iree_hal_loader_thread_pool_worker_t* worker =
+      (iree_hal_loader_thread_pool_worker_t*)entry_arg;
+  iree_hal_loader_thread_pool_t* pool = worker->pool;
+  int32_t seen_epoch = 0;
+  for (;;) {
+    // Park until the epoch changes.
+    int32_t epoch = iree_atomic_load(&pool->epoch, iree_memory_order_acquire);
+    while (epoch == seen_epoch) {
+      iree_wait_token_t wait_token =
+          iree_notification_prepare_wait(&pool->work_notification);
+      epoch = iree_atomic_load(&pool->epoch, iree_memory_order_acquire);
+      if (epoch != seen_epoch) {
+        iree_notification_cancel_wait(&pool->work_notification);
+        break;
+      }
+      iree_notification_commit_wait(&pool->work_notification, wait_token,
+                                    IREE_DURATION_ZERO,
+                                    IREE_TIME_INFINITE_FUTURE);
+      epoch = iree_atomic_load(&pool->epoch, iree_memory_order_acquire);
+    }
+    seen_epoch = epoch;
+    if (iree_atomic_load(&pool->shutdown, iree_memory_order_acquire)) break;
+
+    iree_hal_loader_thread_pool_run(pool, worker->worker_id);
+    if (iree_atomic_fetch_sub(&pool->pending_thread_count, 1,
+                              iree_memory_order_acq_rel) == 1) {
+      iree_notification_post(&pool->done_notification, IREE_ALL_WAITERS);
+    }
+  }
+  return 0;
+}
+
+iree_status_t iree_hal_loader_thread_pool_create(
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_loader_thread_pool_t** out_pool) {
+  IREE_ASSERT_ARGUMENT(out_pool);
+  *out_pool = NULL;
+  if (worker_count == 0) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "at least one worker is required");
+  }
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)worker_count);
+
+  iree_hal_loader_thread_pool_t* pool = NULL;
+  iree_host_size_t total_size =
+      sizeof(*pool) + worker_count * sizeof(pool->workers[0]);
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, total_size, (void**)&pool));
+  memset(pool, 0, total_size);
+  pool->host_allocator = host_allocator;
+  iree_slim_mutex_initialize(&pool->mutex);
+  iree_notification_initialize(&pool->work_notification);
+  iree_notification_initialize(&pool->done_notification);
+
+  iree_thread_create_params_t params;
+  memset(&params, 0, sizeof(params));
+  params.name = iree_make_cstring_view("iree-hal-loader-worker");
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 1; i < worker_count; ++i) {
+    iree_hal_loader_thread_pool_worker_t* worker = &pool->workers[i];
+    worker->pool = pool;
+    worker->worker_id = (uint32_t)i;
+    status = iree_thread_create(iree_hal_loader_thread_pool_worker_main,
+                                worker, params, host_allocator,
+                                &worker->thread);
+    if (!iree_status_is_ok(status)) break;
+    pool->worker_count = i + 1;
+  }
+  if (iree_status_is_ok(status)) {
+    pool->worker_count = worker_count;
+    *out_pool = pool;
+  } else {
+    iree_hal_loader_thread_pool_destroy(pool);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_hal_loader_thread_pool_destroy(iree_hal_loader_thread_pool_t* pool) {
+  if (!pool) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Wake all threads and have them exit.
+  iree_atomic_store(&pool->shutdown, 1, iree_memory_order_release);
+  iree_atomic_fetch_add(&pool->epoch, 1, iree_memory_order_acq_rel);
+  iree_notification_post(&pool->work_notification, IREE_ALL_WAITERS);
+  for (iree_host_size_t i = 1; i < pool->worker_count; ++i) {
+    iree_thread_release(pool->workers[i].thread);  // joins
+  }
+
+  iree_notification_deinitialize(&pool->done_notification);
+  iree_notification_deinitialize(&pool->work_notification);
+  iree_slim_mutex_deinitialize(&pool->mutex);
+  iree_allocator_free(pool->host_allocator, pool);
+  IREE_TRACE_ZONE_END(z0);
+}
+
+iree_host_size_t iree_hal_loader_thread_pool_worker_count(
+    iree_hal_loader_thread_pool_t* pool) {
+  return pool->worker_count;
+}
+
+iree_status_t iree_hal_loader_thread_pool_parallel_for(
+    iree_hal_loader_thread_pool_t* pool, uint32_t count,
+    iree_hal_loader_parallel_for_task_fn_t task_fn, void* task_user_data) {
+  IREE_ASSERT_ARGUMENT(pool);
+  IREE_ASSERT_ARGUMENT(task_fn);
+
+  // Not worth waking the threads for a single index.
+  if (count <= 1 || pool->worker_count <= 1) {
+    for (uint32_t i = 0; i < count; ++i) {
+      IREE_RETURN_IF_ERROR(task_fn(task_user_data, i, /*worker_id=*/0));
+    }
+    return iree_ok_status();
+  }
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, count);
+  iree_slim_mutex_lock(&pool->mutex);
+
+  pool->task_fn = task_fn;
+  pool->task_user_data = task_user_data;
+  pool->count = count;
+  iree_atomic_store(&pool->next_index, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&pool->status, 0, iree_memory_order_relaxed);
+  iree_atomic_store(&pool->pending_thread_count,
+                    (int32_t)(pool->worker_count - 1),
+                    iree_memory_order_relaxed);
+  // Publishes the parallel-for to the threads.
+  iree_atomic_fetch_add(&pool->epoch, 1, iree_memory_order_acq_rel);
+  iree_notification_post(&pool->work_notification, IREE_ALL_WAITERS);
+
+  // The calling thread participates as worker 0 and then waits for the threads
+  // to finish the indices they claimed.
+  iree_hal_loader_thread_pool_run(pool, /*worker_id=*/0);
+  iree_notification_await(&pool->done_notification,
+                          iree_hal_loader_thread_pool_is_done, pool,
+                          iree_infinite_timeout());
+
+  iree_status_t status = (iree_status_t)iree_atomic_load(
+      &pool->status, iree_memory_order_acquire);
+  iree_slim_mutex_unlock(&pool->mutex);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t IREE_API_PTR iree_hal_loader_thread_pool_parallel_for_fn(
+    void* self, uint32_t count, iree_hal_loader_parallel_for_task_fn_t task_fn,
+    void* task_user_data) {
+  return iree_hal_loader_thread_pool_parallel_for(
+      (iree_hal_loader_thread_pool_t*)self, count, task_fn, task_user_data);
+}
+
+static void IREE_API_PTR iree_hal_loader_thread_pool_release_fn(void* self) {
+  iree_hal_loader_thread_pool_destroy((iree_hal_loader_thread_pool_t*)self);
+}
+
+iree_hal_loader_parallel_for_t iree_hal_loader_thread_pool_as_parallel_for(
+    iree_hal_loader_thread_pool_t* pool, bool take_ownership) {
+  iree_hal_loader_parallel_for_t parallel_for = {
+      .worker_count = (uint32_t)pool->worker_count,
+      .fn = iree_hal_loader_thread_pool_parallel_for_fn,
+      .release = take_ownership ? iree_hal_loader_thread_pool_release_fn : NULL,
+      .self = pool,
+  };
+  return parallel_for;
+}
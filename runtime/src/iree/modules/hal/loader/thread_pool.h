@@ -0,0 +1,56 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_MODULES_HAL_LOADER_THREAD_POOL_H_
+#define IREE_MODULES_HAL_LOADER_THREAD_POOL_H_
+
+#include "iree/base/api.h"
+#include "iree/modules/hal/loader/module.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// A tiny fixed-size thread pool implementing iree_hal_loader_parallel_for_t.
+// Intended for the inline HAL flow on small systems where the full task system
+// is undesirable: there are no queues, no work stealing and no topology. Each
+// parallel-for wakes all threads, which then claim indices from a shared
+// atomic counter until all have been issued. The calling thread participates as
+// worker 0.
+//
+// Parallel-fors issued concurrently from multiple threads are serialized.
+typedef struct iree_hal_loader_thread_pool_t iree_hal_loader_thread_pool_t;
+
+// Creates a pool with |worker_count| workers including the calling thread.
+// Spawns |worker_count| - 1 threads that stay parked until a parallel-for.
+iree_status_t iree_hal_loader_thread_pool_create(
+    iree_host_size_t worker_count, iree_allocator_t host_allocator,
+    iree_hal_loader_thread_pool_t** out_pool);
+
+// Destroys |pool| and joins all of its threads.
+void iree_hal_loader_thread_pool_destroy(iree_hal_loader_thread_pool_t* pool);
+
+// Returns the number of workers of |pool| including the calling thread.
+iree_host_size_t iree_hal_loader_thread_pool_worker_count(
+    iree_hal_loader_thread_pool_t* pool);
+
+// Runs |task_fn| for each index in [0, count) across the pool workers and
+// returns the first failure, if any, once all calls have completed.
+iree_status_t iree_hal_loader_thread_pool_parallel_for(
+    iree_hal_loader_thread_pool_t* pool, uint32_t count,
+    iree_hal_loader_parallel_for_task_fn_t task_fn, void* task_user_data);
+
+// Returns a parallel-for that runs on |pool|. When |take_ownership| is true the
+// pool is destroyed when the parallel-for is released, such as when passed to
+// iree_hal_loader_module_create_with_parallel_for.
+iree_hal_loader_parallel_for_t iree_hal_loader_thread_pool_as_parallel_for(
+    iree_hal_loader_thread_pool_t* pool, bool take_ownership);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_MODULES_HAL_LOADER_THREAD_POOL_H_
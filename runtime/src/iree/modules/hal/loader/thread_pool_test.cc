@@ -0,0 +1,87 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/hal/loader/thread_pool.h"
+
+#include <atomic>
+#include <vector>
+
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace {
+
+struct VisitState {
+  explicit VisitState(uint32_t count, uint32_t worker_count)
+      : visits(count), worker_count(worker_count) {}
+  std::vector<std::atomic<int>> visits;
+  uint32_t worker_count;
+  std::atomic<bool> bad_worker_id{false};
+  // Index that fails or UINT32_MAX to never fail.
+  uint32_t failing_index = UINT32_MAX;
+};
+
+static iree_status_t IREE_API_PTR VisitIndex(void* task_user_data,
+                                            uint32_t index,
+                                            uint32_t worker_id) {
+  auto* state = reinterpret_cast<VisitState*>(task_user_data);
+  if (worker_id >= state->worker_count) state->bad_worker_id = true;
+  state->visits[index].fetch_add(1);
+  if (index == state->failing_index) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS, "failing index");
+  }
+  return iree_ok_status();
+}
+
+class ThreadPoolTest : public ::testing::TestWithParam<iree_host_size_t> {
+ protected:
+  void SetUp() override {
+    IREE_ASSERT_OK(iree_hal_loader_thread_pool_create(
+        GetParam(), iree_allocator_system(), &pool_));
+  }
+  void TearDown() override { iree_hal_loader_thread_pool_destroy(pool_); }
+  iree_hal_loader_thread_pool_t* pool_ = NULL;
+};
+
+// Every index is visited exactly once by a valid worker, including when the
+// pool is reused across many parallel-fors.
+TEST_P(ThreadPoolTest, VisitsAllIndicesOnce) {
+  for (uint32_t count : {0u, 1u, 2u, 7u, 1000u}) {
+    for (int repeat = 0; repeat < 16; ++repeat) {
+      VisitState state(count, (uint32_t)GetParam());
+      IREE_ASSERT_OK(iree_hal_loader_thread_pool_parallel_for(
+          pool_, count, VisitIndex, &state));
+      for (uint32_t i = 0; i < count; ++i) {
+        ASSERT_EQ(state.visits[i].load(), 1) << "index " << i;
+      }
+      ASSERT_FALSE(state.bad_worker_id.load());
+    }
+  }
+}
+
+// Failures are returned to the caller and the pool remains usable.
+TEST_P(ThreadPoolTest, PropagatesFailure) {
+  VisitState failing_state(100, (uint32_t)GetParam());
+  failing_state.failing_index = 42;
+  IREE_EXPECT_STATUS_IS(IREE_STATUS_DATA_LOSS,
+                        iree_hal_loader_thread_pool_parallel_for(
+                            pool_, 100, VisitIndex, &failing_state));
+  for (auto& visits : failing_state.visits) {
+    EXPECT_LE(visits.load(), 1);
+  }
+
+  VisitState state(100, (uint32_t)GetParam());
+  IREE_ASSERT_OK(iree_hal_loader_thread_pool_parallel_for(pool_, 100,
+                                                          VisitIndex, &state));
+  for (auto& visits : state.visits) {
+    EXPECT_EQ(visits.load(), 1);
+  }
+}
+
+INSTANTIATE_TEST_SUITE_P(WorkerCounts, ThreadPoolTest,
+                         ::testing::Values(1, 2, 4));
+
+}  // namespace
@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include <stddef.h>
 
+#include "iree/hal/utils/semaphore_wait.h"
 #include "iree/modules/hal/utils/buffer_diagnostics.h"
 
 //===----------------------------------------------------------------------===//
@@ -28,12 +29,18 @@
 #define IREE_HAL_MODULE_MAX_STACK_COMMAND_BUFFER_BINDING_COUNT \
   ((iree_host_size_t)64)
 
+// Maximum number of released buffer views retained for reuse by each module
+// state. Programs returning many tensors per call create and release a buffer
+// view per result and reusing them avoids a host allocation for each.
+#define IREE_HAL_MODULE_MAX_POOLED_BUFFER_VIEW_COUNT ((iree_host_size_t)512)
+
 //===----------------------------------------------------------------------===//
 // Module type definitions
 //===----------------------------------------------------------------------===//
 
 #define IREE_HAL_MODULE_VERSION_0_5 0x00000005u
-#define IREE_HAL_MODULE_VERSION_LATEST IREE_HAL_MODULE_VERSION_0_5
+#define IREE_HAL_MODULE_VERSION_0_6 0x00000006u
+#define IREE_HAL_MODULE_VERSION_LATEST IREE_HAL_MODULE_VERSION_0_6
 
 typedef struct iree_hal_module_t {
   iree_allocator_t host_allocator;
@@ -75,6 +82,11 @@ typedef struct iree_hal_module_state_t {
   // instead be taking a loop upon creation and scheduling work against that.
   iree_status_t loop_status;
 
+  // Pool of buffer views returned from the module. Buffer views are host-only
+  // metadata and not associated with any particular device so a single pool
+  // is shared by all devices.
+  iree_hal_buffer_view_pool_t* buffer_view_pool;
+
   // Shared executable cache for each device used to cache all executables
   // created in the context. We could have multiple to allow for modules to
   // create distinct sets of executables like ones for training vs inference in
@@ -103,12 +115,14 @@ iree_hal_module_alloc_state(void* self, iree_allocator_t host_allocator,
   state->devices = module->devices;
   state->loop_status = iree_ok_status();
 
-  iree_status_t status = iree_ok_status();
+  iree_status_t status = iree_hal_buffer_view_pool_create(
+      IREE_HAL_MODULE_MAX_POOLED_BUFFER_VIEW_COUNT, host_allocator,
+      &state->buffer_view_pool);
   for (iree_host_size_t i = 0; i < state->device_count; ++i) {
+    if (!iree_status_is_ok(status)) break;
     status = iree_hal_executable_cache_create(
         state->devices[i], iree_string_view_empty(),
         iree_loop_inline(&state->loop_status), &state->executable_caches[i]);
-    if (!iree_status_is_ok(status)) break;
   }
 
   if (iree_status_is_ok(status)) {
@@ -117,6 +131,7 @@ iree_hal_module_alloc_state(void* self, iree_allocator_t host_allocator,
     for (iree_host_size_t i = 0; i < state->device_count; ++i) {
       iree_hal_executable_cache_release(state->executable_caches[i]);
     }
+    iree_hal_buffer_view_pool_release(state->buffer_view_pool);
     iree_allocator_free(host_allocator, state);
   }
   IREE_TRACE_ZONE_END(z0);
@@ -131,6 +146,8 @@ iree_hal_module_free_state(void* self, iree_vm_module_state_t* module_state) {
   for (iree_host_size_t i = 0; i < state->device_count; ++i) {
     iree_hal_executable_cache_release(state->executable_caches[i]);
   }
+  // Buffer views still referenced by the application keep the pool alive.
+  iree_hal_buffer_view_pool_release(state->buffer_view_pool);
   iree_status_ignore(state->loop_status);
   iree_allocator_free(state->host_allocator, state);
 
@@ -556,11 +573,12 @@ IREE_VM_ABI_EXPORT(iree_hal_module_buffer_view_create,  //
   }
 
   iree_hal_buffer_view_t* buffer_view = NULL;
-  IREE_RETURN_IF_ERROR(iree_hal_buffer_view_create(
-      subspan_buffer ? subspan_buffer : source_buffer, shape_rank, shape_dims,
-      element_type, encoding_type, state->host_allocator, &buffer_view));
+  iree_status_t status = iree_hal_buffer_view_pool_acquire(
+      state->buffer_view_pool, subspan_buffer ? subspan_buffer : source_buffer,
+      shape_rank, shape_dims, element_type, encoding_type, &buffer_view);
 
   iree_hal_buffer_release(subspan_buffer);
+  IREE_RETURN_IF_ERROR(status);
 
   rets->r0 = iree_hal_buffer_view_move_ref(buffer_view);
   return iree_ok_status();
@@ -1012,6 +1030,151 @@ static iree_status_t iree_hal_module_command_buffer_dispatch_shim(
                                                  &args);
 }
 
+// Argument signature: rrCiDCiirIIDCiiiiiiID
+// Each dispatch tuple is <entry_point, workgroup_x, workgroup_y, workgroup_z,
+// constant_count, binding_count, flags> and consumes the next constant_count
+// constants and binding_count bindings from the shared segments in order.
+typedef struct {
+  union {
+    struct {
+      iree_vm_ref_t command_buffer;
+      iree_vm_ref_t executable;
+    };
+    iree_vm_abi_rr_t params;
+  };
+  iree_vm_size_t constant_count;
+  const uint32_t* constants;
+  iree_vm_size_t binding_count;
+  const iree_vm_abi_iirII_t* bindings;
+  iree_vm_size_t dispatch_count;
+  const iree_vm_abi_iiiiiiI_t* dispatches;
+} iree_hal_module_command_buffer_dispatch_batch_args_t;
+static iree_status_t iree_hal_module_command_buffer_dispatch_batch(
+    iree_vm_stack_t* IREE_RESTRICT stack, void* IREE_RESTRICT module,
+    iree_hal_module_state_t* IREE_RESTRICT state,
+    const iree_hal_module_command_buffer_dispatch_batch_args_t* IREE_RESTRICT
+        args) {
+  iree_hal_command_buffer_t* command_buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_command_buffer_check_deref(args->command_buffer,
+                                                           &command_buffer));
+  iree_hal_executable_t* executable = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_hal_executable_check_deref(args->executable, &executable));
+
+  // Bindings are converted into a single reusable list sized for the largest
+  // dispatch we support so that the alloca happens once per batch.
+  iree_hal_buffer_ref_t* binding_storage = (iree_hal_buffer_ref_t*)iree_alloca(
+      IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT *
+      sizeof(iree_hal_buffer_ref_t));
+
+  iree_host_size_t constant_base = 0;
+  iree_host_size_t binding_base = 0;
+  for (iree_host_size_t i = 0; i < args->dispatch_count; ++i) {
+    const iree_vm_abi_iiiiiiI_t* dispatch = &args->dispatches[i];
+    const iree_host_size_t constant_count = (iree_host_size_t)dispatch->i4;
+    const iree_host_size_t binding_count = (iree_host_size_t)dispatch->i5;
+    if (IREE_UNLIKELY(dispatch->i4 < 0 || dispatch->i5 < 0 ||
+                      constant_base + constant_count > args->constant_count ||
+                      binding_base + binding_count > args->binding_count)) {
+      return iree_make_status(
+          IREE_STATUS_OUT_OF_RANGE,
+          "dispatch %" PRIhsz " constant/binding ranges exceed the batch", i);
+    }
+    if (IREE_UNLIKELY(binding_count >
+                      IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT)) {
+      return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                              "binding count %" PRIhsz " > %" PRIhsz,
+                              binding_count,
+                              IREE_HAL_MODULE_MAX_DESCRIPTOR_BINDING_COUNT);
+    }
+    for (iree_host_size_t j = 0; j < binding_count; ++j) {
+      const iree_vm_abi_iirII_t* source = &args->bindings[binding_base + j];
+      iree_hal_buffer_ref_t* binding = &binding_storage[j];
+      binding->reserved = 0;
+      binding->buffer_slot = (uint32_t)source->i1;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_buffer_check_deref_or_null(source->r2, &binding->buffer));
+      binding->offset = iree_hal_cast_device_size(source->i3);
+      binding->length = iree_hal_cast_device_size(source->i4);
+    }
+    const uint32_t workgroup_count[3] = {
+        (uint32_t)dispatch->i1,
+        (uint32_t)dispatch->i2,
+        (uint32_t)dispatch->i3,
+    };
+    iree_hal_buffer_ref_list_t bindings = {
+        .count = binding_count,
+        .values = binding_storage,
+    };
+    IREE_RETURN_IF_ERROR(iree_hal_command_buffer_dispatch(
+        command_buffer, executable, dispatch->i0, workgroup_count,
+        iree_make_const_byte_span(args->constants + constant_base,
+                                  constant_count * sizeof(uint32_t)),
+        bindings, (iree_hal_dispatch_flags_t)dispatch->i6));
+    constant_base += constant_count;
+    binding_base += binding_count;
+  }
+
+  return iree_ok_status();
+}
+static iree_status_t iree_hal_module_command_buffer_dispatch_batch_shim(
+    iree_vm_stack_t* IREE_RESTRICT stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module,
+    void* IREE_RESTRICT module_state) {
+  // TODO(benvanik): support multiple variadic segments in one call.
+  // For now we inline what it would do in a very painful way.
+  bool args_ok = true;
+  if (args_storage.data_length <
+      (sizeof(iree_vm_abi_rr_t) + sizeof(iree_vm_size_t) +
+       sizeof(iree_vm_size_t) + sizeof(iree_vm_size_t))) {
+    // Can't fit even with zero lengths.
+    args_ok = false;
+  }
+  iree_hal_module_command_buffer_dispatch_batch_args_t args = {
+      .params = *(const iree_vm_abi_rr_t*)args_storage.data,
+  };
+  if (args_ok) {
+    const uint8_t* end_ptr = args_storage.data + args_storage.data_length;
+    const uint8_t* constants_ptr = args_storage.data + sizeof(args.params);
+    args.constant_count = *(const iree_vm_size_t*)constants_ptr;
+    args.constants = (const uint32_t*)(constants_ptr + sizeof(iree_vm_size_t));
+    const uint8_t* bindings_ptr =
+        constants_ptr + sizeof(iree_vm_size_t) +
+        args.constant_count * sizeof(args.constants[0]);
+    if (bindings_ptr + sizeof(iree_vm_size_t) > end_ptr) {
+      args_ok = false;
+    } else {
+      args.binding_count = *(const iree_vm_size_t*)bindings_ptr;
+      args.bindings =
+          (const iree_vm_abi_iirII_t*)(bindings_ptr + sizeof(iree_vm_size_t));
+      const uint8_t* dispatches_ptr =
+          (const uint8_t*)args.bindings +
+          args.binding_count * sizeof(args.bindings[0]);
+      if (dispatches_ptr + sizeof(iree_vm_size_t) > end_ptr) {
+        args_ok = false;
+      } else {
+        args.dispatch_count = *(const iree_vm_size_t*)dispatches_ptr;
+        args.dispatches =
+            (const iree_vm_abi_iiiiiiI_t*)(dispatches_ptr +
+                                           sizeof(iree_vm_size_t));
+        const uint8_t* max_ptr =
+            (const uint8_t*)args.dispatches +
+            args.dispatch_count * sizeof(args.dispatches[0]);
+        if (max_ptr > end_ptr) args_ok = false;
+      }
+    }
+  }
+  if (IREE_UNLIKELY(!args_ok || rets_storage.data_length > 0)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "argument/result signature mismatch");
+  }
+  IREE_ASSERT(target_fn == (iree_vm_native_function_target2_t)
+                               iree_hal_module_command_buffer_dispatch_batch);
+  return iree_hal_module_command_buffer_dispatch_batch(stack, module,
+                                                       module_state, &args);
+}
+
 // Argument signature: rriirIICiDCiirIID
 typedef struct {
   union {
@@ -1472,7 +1635,8 @@ IREE_VM_ABI_EXPORT(iree_hal_module_executable_create,  //
   iree_hal_executable_params_initialize(&executable_params);
   executable_params.caching_mode |=
       executable_data->access == IREE_VM_BUFFER_ACCESS_ORIGIN_MODULE
-          ? IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA
+          ? IREE_HAL_EXECUTABLE_CACHING_MODE_ALIAS_PROVIDED_DATA |
+                IREE_HAL_EXECUTABLE_CACHING_MODE_ALLOW_DEFERRED_LOADING
           : 0;
   executable_params.executable_format = executable_format_str;
   executable_params.executable_data = iree_make_const_byte_span(
@@ -1765,13 +1929,29 @@ IREE_VM_ABI_EXPORT(iree_hal_module_fence_await,  //
     // If all fences have been reached we can exit early as if we waited
     // successfully.
     if (fence_count > 0) {
-      if (iree_all_bits_set(state->flags, IREE_HAL_MODULE_FLAG_SYNCHRONOUS)) {
-        // Block the native thread until the fence is reached or the deadline is
-        // exceeded.
-        for (iree_host_size_t i = 0; i < fence_count; ++i) {
-          wait_status = iree_hal_fence_wait(fences[i], timeout);
-          if (!iree_status_is_ok(wait_status)) break;
+      if (iree_all_bits_set(state->flags, IREE_HAL_MODULE_FLAG_SYNCHRONOUS) ||
+          !iree_all_bits_set(iree_vm_stack_invocation_flags(stack),
+                             IREE_VM_INVOCATION_FLAG_ASYNC)) {
+        // Only async invocations are resumed by their invoker after a yield;
+        // others (such as module initializers) cannot handle deferral.
+        // Block the native thread until all fences are reached or the deadline
+        // is exceeded. Multiple fences (commonly one per device) are joined so
+        // that the thread wakes once for all of them instead of once per fence.
+        iree_hal_fence_t* joined_fence = NULL;
+        if (fence_count == 1) {
+          joined_fence = fences[0];
+          iree_hal_fence_retain(joined_fence);
+        } else {
+          wait_status = iree_hal_fence_join(fence_count, fences,
+                                            state->host_allocator,
+                                            &joined_fence);
+        }
+        if (iree_status_is_ok(wait_status)) {
+          wait_status = iree_hal_semaphore_list_wait_coalesced(
+              iree_hal_fence_semaphore_list(joined_fence), timeout,
+              state->host_allocator);
         }
+        iree_hal_fence_release(joined_fence);
       } else {
         current_frame->pc = IREE_HAL_MODULE_FENCE_AWAIT_PC_RESUME;
         IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -1818,13 +1998,22 @@ IREE_VM_ABI_EXPORT(iree_hal_module_fence_await,  //
 // VM module interface implementation
 //===----------------------------------------------------------------------===//
 
+// Shims specialized for each export so that calls are made directly to the
+// target functions instead of through the shared per-signature shims.
+#define EXPORT_FN(name, target_fn, arg_types, ret_types)             \
+  IREE_VM_ABI_DEFINE_EXPORT_SHIM(target_fn, iree_hal_module_state_t, \
+                                 arg_types, ret_types)
+#define EXPORT_FN_CUSTOM(name, target_fn, arg_types, ret_types)
+#include "iree/modules/hal/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN
+#undef EXPORT_FN_CUSTOM
+
 // NOTE: this must match the ordering of the iree_hal_module_exports_ table.
 static const iree_vm_native_function_ptr_t iree_hal_module_funcs_[] = {
-#define EXPORT_FN(name, target_fn, arg_types, ret_types)       \
-  {                                                            \
-      .shim = (iree_vm_native_function_shim_t)                 \
-          iree_vm_shim_##arg_types##_##ret_types,              \
-      .target = (iree_vm_native_function_target_t)(target_fn), \
+#define EXPORT_FN(name, target_fn, arg_types, ret_types)          \
+  {                                                               \
+      .shim = (iree_vm_native_function_shim_t)(target_fn##_shim), \
+      .target = NULL,                                             \
   },
 #define EXPORT_FN_CUSTOM(name, target_fn, arg_types, ret_types)   \
   {                                                               \
@@ -1913,8 +2102,7 @@ IREE_API_EXPORT iree_status_t iree_hal_module_create(
 
   iree_hal_module_t* module = IREE_HAL_MODULE_CAST(base_module);
   module->host_allocator = host_allocator;
-  // TODO(benvanik): fix vm yield with result storage.
-  module->flags = flags | IREE_HAL_MODULE_FLAG_SYNCHRONOUS;
+  module->flags = flags;
   module->debug_sink = debug_sink;
   module->device_count = device_count;
   for (iree_host_size_t i = 0; i < device_count; ++i) {
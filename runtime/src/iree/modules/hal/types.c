@@ -215,6 +215,21 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_buffer_view_retain(
   return iree_vm_list_set_ref_retain(list, i, &value_ref);
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_list_get_buffer_views_assign(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_hal_buffer_view_t** out_buffer_views) {
+  return iree_vm_list_get_ref_ptrs(list, i, count, iree_hal_buffer_view_type(),
+                                   (void**)out_buffer_views);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_buffer_views_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_hal_buffer_view_t* const* buffer_views) {
+  return iree_vm_list_set_ref_ptrs_retain(list, i, count,
+                                          iree_hal_buffer_view_type(),
+                                          (void* const*)buffer_views);
+}
+
 IREE_API_EXPORT iree_hal_fence_t* iree_vm_list_get_fence_assign(
     const iree_vm_list_t* list, iree_host_size_t i) {
   return (iree_hal_fence_t*)iree_vm_list_get_ref_deref(list, i,
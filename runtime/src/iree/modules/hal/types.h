@@ -76,6 +76,17 @@ IREE_API_EXPORT iree_hal_buffer_view_t* iree_vm_list_get_buffer_view_retain(
 IREE_API_EXPORT iree_status_t iree_vm_list_set_buffer_view_retain(
     iree_vm_list_t* list, iree_host_size_t i, iree_hal_buffer_view_t* value);
 
+// Gets |count| buffer views starting at |i| without retaining them.
+// Lists with a !hal.buffer_view element type are read without per-element
+// type checks.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_buffer_views_assign(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_hal_buffer_view_t** out_buffer_views);
+// Sets |count| buffer views starting at |i|, retaining each one.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_buffer_views_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_hal_buffer_view_t* const* buffer_views);
+
 IREE_API_EXPORT iree_hal_fence_t* iree_vm_list_get_fence_assign(
     const iree_vm_list_t* list, iree_host_size_t i);
 IREE_API_EXPORT iree_hal_fence_t* iree_vm_list_get_fence_retain(
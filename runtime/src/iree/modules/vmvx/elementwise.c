@@ -13,48 +13,16 @@
 // path.
 #include <math.h>
 
+#include "iree/base/internal/cpu.h"
+#include "iree/modules/vmvx/elementwise_internal.h"
+#include "iree/schemas/cpu_data.h"
+
 //===----------------------------------------------------------------------===//
 // Helpers for defining generic implementations of elementwise functions.
 // Since it affords the best code size tradeoff options, the entrypoint
 // is dispatched based on an opcode.
 //===----------------------------------------------------------------------===//
 
-// Opcodes for generic functions operating on 32-bit operands and result.
-// Since the outer dispatcher only differentiates based on width, all other
-// type specificity is carried by the opcode.
-// Binary opcodes are named "X32B" and unary opcodes "X32U".
-// The initial list was sorted, and it is encouraged to sort extensions, but
-// each opcode must be numerically stable, so the list is not expected to
-// be sorted over time.
-typedef enum {
-  IREE_UK_X32B_ADDF = 0,
-  IREE_UK_X32B_ADDI = 1,
-  IREE_UK_X32B_ANDI = 2,
-  IREE_UK_X32B_DIVF = 3,
-  IREE_UK_X32B_DIVSI = 4,
-  IREE_UK_X32B_DIVUI = 5,
-  IREE_UK_X32B_MULF = 6,
-  IREE_UK_X32B_MULI = 7,
-  IREE_UK_X32B_ORI = 8,
-  IREE_UK_X32B_SHLI = 9,
-  IREE_UK_X32B_SHRSI = 10,
-  IREE_UK_X32B_SHRUI = 11,
-  IREE_UK_X32B_SUBF = 12,
-  IREE_UK_X32B_SUBI = 13,
-  IREE_UKENREL_X32B_XORI = 14,
-} iree_uk_x32b_opcode_t;
-
-typedef enum {
-  IREE_UK_X32U_ABSF,
-  IREE_UK_X32U_CEILF,
-  IREE_UK_X32U_CTLZ,
-  IREE_UK_X32U_EXPF,
-  IREE_UK_X32U_FLOORF,
-  IREE_UK_X32U_LOGF,
-  IREE_UK_X32U_NEGF,
-  IREE_UK_X32U_RSQRTF,
-} iree_uk_x32u_opcode_t;
-
 // Macros to access various typed, dereferenced pointers.
 #define ASF32(ptr) *((float*)ptr)
 #define ASUI32(ptr) *((iree_uk_uint32_t*)ptr)
@@ -195,6 +163,116 @@ static void iree_uk_generic_x32u_op(iree_uk_x32u_opcode_t opcode,
   }
 }
 
+// Expands to a loop applying |op| to a contiguous row of |ctype| elements.
+#define IREE_UK_X32B_ROW_LOOP(ctype, op)         \
+  {                                              \
+    const ctype* l = (const ctype*)lhs;          \
+    const ctype* r = (const ctype*)rhs;          \
+    ctype* o = (ctype*)out;                      \
+    for (iree_uk_index_t j = 0; j < size; ++j) { \
+      o[j] = l[j] op r[j];                       \
+    }                                            \
+    return;                                      \
+  }
+
+// Computes a contiguous row of |size| elements of an x32b opcode. Simple
+// opcodes are written as plain loops so that compilers can auto-vectorize them
+// for any target; other opcodes fall back to per-element dispatch.
+static void iree_uk_generic_x32b_row(iree_uk_x32b_opcode_t opcode,
+                                     int* result_code,
+                                     const iree_uk_uint32_t* lhs,
+                                     const iree_uk_uint32_t* rhs,
+                                     iree_uk_uint32_t* out,
+                                     iree_uk_index_t size) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      IREE_UK_X32B_ROW_LOOP(float, +);
+    case IREE_UK_X32B_ADDI:
+      IREE_UK_X32B_ROW_LOOP(iree_uk_uint32_t, +);
+    case IREE_UK_X32B_ANDI:
+      IREE_UK_X32B_ROW_LOOP(iree_uk_uint32_t, &);
+    case IREE_UK_X32B_DIVF:
+      IREE_UK_X32B_ROW_LOOP(float, /);
+    case IREE_UK_X32B_MULF:
+      IREE_UK_X32B_ROW_LOOP(float, *);
+    case IREE_UK_X32B_MULI:
+      IREE_UK_X32B_ROW_LOOP(iree_uk_uint32_t, *);
+    case IREE_UK_X32B_ORI:
+      IREE_UK_X32B_ROW_LOOP(iree_uk_uint32_t, |);
+    case IREE_UKENREL_X32B_XORI:
+      IREE_UK_X32B_ROW_LOOP(iree_uk_uint32_t, ^);
+    case IREE_UK_X32B_SUBF:
+      IREE_UK_X32B_ROW_LOOP(float, -);
+    case IREE_UK_X32B_SUBI:
+      IREE_UK_X32B_ROW_LOOP(iree_uk_uint32_t, -);
+    default:
+      for (iree_uk_index_t j = 0; j < size; ++j) {
+        iree_uk_generic_x32b_op(opcode, result_code, &lhs[j], &rhs[j], &out[j]);
+      }
+      return;
+  }
+}
+
+// Computes a contiguous row of |size| elements of an x32u opcode.
+static void iree_uk_generic_x32u_row(iree_uk_x32u_opcode_t opcode,
+                                     int* result_code,
+                                     const iree_uk_uint32_t* in,
+                                     iree_uk_uint32_t* out,
+                                     iree_uk_index_t size) {
+  switch (opcode) {
+    case IREE_UK_X32U_NEGF:
+      for (iree_uk_index_t j = 0; j < size; ++j) {
+        ((float*)out)[j] = -((const float*)in)[j];
+      }
+      return;
+    default:
+      for (iree_uk_index_t j = 0; j < size; ++j) {
+        iree_uk_generic_x32u_op(opcode, result_code, &in[j], &out[j]);
+      }
+      return;
+  }
+}
+
+// Returns an architecture-specific row kernel for |opcode| or NULL if the
+// generic row implementation should be used. Kernels requiring ISA extensions
+// beyond the architecture baseline are selected based on the runtime CPU
+// features.
+static iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func(
+    iree_uk_x32b_opcode_t opcode) {
+#if defined(IREE_VMVX_HAVE_X86_64_AVX2)
+  if (iree_cpu_data_field(0) & IREE_CPU_DATA0_X86_64_AVX2) {
+    iree_uk_x32b_row_func_t func =
+        iree_uk_x32b_select_row_func_x86_64_avx2(opcode);
+    if (func) return func;
+  }
+#endif  // IREE_VMVX_HAVE_X86_64_AVX2
+#if defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_x32b_select_row_func_x86_64_sse2(opcode);
+#elif defined(IREE_UK_ARCH_ARM_64)
+  return iree_uk_x32b_select_row_func_arm_64(opcode);
+#else
+  return 0;
+#endif  // IREE_UK_ARCH_*
+}
+
+static iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func(
+    iree_uk_x32u_opcode_t opcode) {
+#if defined(IREE_VMVX_HAVE_X86_64_AVX2)
+  if (iree_cpu_data_field(0) & IREE_CPU_DATA0_X86_64_AVX2) {
+    iree_uk_x32u_row_func_t func =
+        iree_uk_x32u_select_row_func_x86_64_avx2(opcode);
+    if (func) return func;
+  }
+#endif  // IREE_VMVX_HAVE_X86_64_AVX2
+#if defined(IREE_UK_ARCH_X86_64)
+  return iree_uk_x32u_select_row_func_x86_64_sse2(opcode);
+#elif defined(IREE_UK_ARCH_ARM_64)
+  return iree_uk_x32u_select_row_func_arm_64(opcode);
+#else
+  return 0;
+#endif  // IREE_UK_ARCH_*
+}
+
 //===----------------------------------------------------------------------===//
 // Opcode dispatch entry points.
 //===----------------------------------------------------------------------===//
@@ -214,7 +292,21 @@ IREE_UK_ATTRIBUTE_NOINLINE static int iree_uk_generic_x32b_2d(
     // Sizes.
     iree_uk_index_t size0, iree_uk_index_t size1) {
   int result_code = 0;
-  // TODO: Manually unroll to x4 to trigger vectorization.
+  if (lhs_stride1 == 1 && rhs_stride1 == 1 && out_stride1 == 1) {
+    // Contiguous rows: run the architecture kernel over as much of each row as
+    // it handles and finish the remainder with the generic row loop.
+    iree_uk_x32b_row_func_t row_func = iree_uk_x32b_select_row_func(opcode);
+    for (iree_uk_index_t i = 0; i < size0; ++i) {
+      const iree_uk_uint32_t* lhs_row = &lhs[i * lhs_stride0];
+      const iree_uk_uint32_t* rhs_row = &rhs[i * rhs_stride0];
+      iree_uk_uint32_t* out_row = &out[i * out_stride0];
+      iree_uk_index_t j = row_func ? row_func(lhs_row, rhs_row, out_row, size1)
+                                   : 0;
+      iree_uk_generic_x32b_row(opcode, &result_code, lhs_row + j, rhs_row + j,
+                               out_row + j, size1 - j);
+    }
+    return result_code;
+  }
   for (iree_uk_index_t i = 0; i < size0; ++i) {
     for (iree_uk_index_t j = 0; j < size1; ++j) {
       iree_uk_generic_x32b_op(opcode, &result_code,
@@ -238,7 +330,17 @@ IREE_UK_ATTRIBUTE_NOINLINE static int iree_uk_generic_x32u_2d(
     // Sizes.
     iree_uk_index_t size0, iree_uk_index_t size1) {
   int result_code = 0;
-  // TODO: Manually unroll to x4 to trigger vectorization.
+  if (in_stride1 == 1 && out_stride1 == 1) {
+    iree_uk_x32u_row_func_t row_func = iree_uk_x32u_select_row_func(opcode);
+    for (iree_uk_index_t i = 0; i < size0; ++i) {
+      const iree_uk_uint32_t* in_row = &in[i * in_stride0];
+      iree_uk_uint32_t* out_row = &out[i * out_stride0];
+      iree_uk_index_t j = row_func ? row_func(in_row, out_row, size1) : 0;
+      iree_uk_generic_x32u_row(opcode, &result_code, in_row + j, out_row + j,
+                               size1 - j);
+    }
+    return result_code;
+  }
   for (iree_uk_index_t i = 0; i < size0; ++i) {
     for (iree_uk_index_t j = 0; j < size1; ++j) {
       iree_uk_generic_x32u_op(opcode, &result_code,
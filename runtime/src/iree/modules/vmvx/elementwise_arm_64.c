@@ -0,0 +1,132 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/vmvx/elementwise_internal.h"
+
+#if defined(IREE_UK_ARCH_ARM_64)
+
+#include <arm_neon.h>
+
+//===----------------------------------------------------------------------===//
+// NEON row kernels (arm_64 baseline)
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_X32B_ROW_NEON_F32(name, vop)                                   \
+  static iree_uk_index_t iree_uk_x32b_##name##_row_arm_64(                     \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,                \
+      iree_uk_uint32_t* out, iree_uk_index_t size) {                           \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 4 <= size; i += 4) {                                            \
+      float32x4_t l = vld1q_f32((const float*)(lhs + i));                      \
+      float32x4_t r = vld1q_f32((const float*)(rhs + i));                      \
+      vst1q_f32((float*)(out + i), vop(l, r));                                 \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+#define IREE_UK_X32B_ROW_NEON_U32(name, vop)                                   \
+  static iree_uk_index_t iree_uk_x32b_##name##_row_arm_64(                     \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,                \
+      iree_uk_uint32_t* out, iree_uk_index_t size) {                           \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 4 <= size; i += 4) {                                            \
+      uint32x4_t l = vld1q_u32(lhs + i);                                       \
+      uint32x4_t r = vld1q_u32(rhs + i);                                       \
+      vst1q_u32(out + i, vop(l, r));                                           \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+#define IREE_UK_X32U_ROW_NEON_F32(name, vop)                                   \
+  static iree_uk_index_t iree_uk_x32u_##name##_row_arm_64(                     \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* out,                       \
+      iree_uk_index_t size) {                                                  \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 4 <= size; i += 4) {                                            \
+      float32x4_t v = vld1q_f32((const float*)(in + i));                       \
+      vst1q_f32((float*)(out + i), vop(v));                                    \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+// Matches the scalar 1.0f / sqrtf(x) exactly instead of using the approximate
+// vrsqrteq_f32.
+static inline float32x4_t iree_uk_rsqrtf_arm_64(float32x4_t v) {
+  return vdivq_f32(vdupq_n_f32(1.0f), vsqrtq_f32(v));
+}
+
+IREE_UK_X32B_ROW_NEON_F32(addf, vaddq_f32)
+IREE_UK_X32B_ROW_NEON_F32(divf, vdivq_f32)
+IREE_UK_X32B_ROW_NEON_F32(mulf, vmulq_f32)
+IREE_UK_X32B_ROW_NEON_F32(subf, vsubq_f32)
+IREE_UK_X32B_ROW_NEON_U32(addi, vaddq_u32)
+IREE_UK_X32B_ROW_NEON_U32(andi, vandq_u32)
+IREE_UK_X32B_ROW_NEON_U32(muli, vmulq_u32)
+IREE_UK_X32B_ROW_NEON_U32(ori, vorrq_u32)
+IREE_UK_X32B_ROW_NEON_U32(subi, vsubq_u32)
+IREE_UK_X32B_ROW_NEON_U32(xori, veorq_u32)
+
+IREE_UK_X32U_ROW_NEON_F32(absf, vabsq_f32)
+IREE_UK_X32U_ROW_NEON_F32(ceilf, vrndpq_f32)
+IREE_UK_X32U_ROW_NEON_F32(floorf, vrndmq_f32)
+IREE_UK_X32U_ROW_NEON_F32(negf, vnegq_f32)
+IREE_UK_X32U_ROW_NEON_F32(rsqrtf, iree_uk_rsqrtf_arm_64)
+
+#endif  // IREE_UK_ARCH_ARM_64
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_arm_64(
+    iree_uk_x32b_opcode_t opcode) {
+#if defined(IREE_UK_ARCH_ARM_64)
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_arm_64;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_arm_64;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_arm_64;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_arm_64;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_arm_64;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_arm_64;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_arm_64;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_arm_64;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_arm_64;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_xori_row_arm_64;
+    default:
+      return 0;
+  }
+#else
+  return 0;
+#endif  // IREE_UK_ARCH_ARM_64
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_arm_64(
+    iree_uk_x32u_opcode_t opcode) {
+#if defined(IREE_UK_ARCH_ARM_64)
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_arm_64;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_arm_64;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_arm_64;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_arm_64;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_arm_64;
+    default:
+      return 0;
+  }
+#else
+  return 0;
+#endif  // IREE_UK_ARCH_ARM_64
+}
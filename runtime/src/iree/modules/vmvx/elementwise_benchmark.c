@@ -0,0 +1,140 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "iree/base/api.h"
+#include "iree/base/internal/cpu.h"
+#include "iree/modules/vmvx/elementwise.h"
+#include "iree/testing/benchmark.h"
+
+// Contiguous 2D shapes covering a single short row (tail-dominated), a single
+// long row, and a tile with multiple rows.
+typedef struct {
+  const char* name;
+  iree_uk_index_t size0;
+  iree_uk_index_t size1;
+} iree_uk_elementwise_benchmark_shape_t;
+
+static const iree_uk_elementwise_benchmark_shape_t
+    iree_uk_elementwise_benchmark_shapes[] = {
+        {"1x7", 1, 7},
+        {"1x4096", 1, 4096},
+        {"64x64", 64, 64},
+};
+
+typedef struct {
+  const char* name;
+  iree_uk_x32b_2d_func_t binary_func;
+  iree_uk_x32u_2d_func_t unary_func;
+} iree_uk_elementwise_benchmark_op_t;
+
+static const iree_uk_elementwise_benchmark_op_t
+    iree_uk_elementwise_benchmark_ops[] = {
+        {"addf", iree_uk_x32b_addf_2d, NULL},
+        {"mulf", iree_uk_x32b_mulf_2d, NULL},
+        {"divf", iree_uk_x32b_divf_2d, NULL},
+        {"addi", iree_uk_x32b_addi_2d, NULL},
+        {"muli", iree_uk_x32b_muli_2d, NULL},
+        {"xori", iree_uk_x32b_xori_2d, NULL},
+        {"shli", iree_uk_x32b_shli_2d, NULL},
+        {"absf", NULL, iree_uk_x32u_absf_2d},
+        {"floorf", NULL, iree_uk_x32u_floorf_2d},
+        {"rsqrtf", NULL, iree_uk_x32u_rsqrtf_2d},
+        {"expf", NULL, iree_uk_x32u_expf_2d},
+};
+
+typedef struct {
+  const iree_uk_elementwise_benchmark_op_t* op;
+  const iree_uk_elementwise_benchmark_shape_t* shape;
+} iree_uk_elementwise_benchmark_params_t;
+
+// Storage for the per-benchmark parameters referenced by user_data.
+static iree_uk_elementwise_benchmark_params_t
+    iree_uk_elementwise_benchmark_params
+        [IREE_ARRAYSIZE(iree_uk_elementwise_benchmark_ops) *
+         IREE_ARRAYSIZE(iree_uk_elementwise_benchmark_shapes)];
+
+static iree_status_t iree_uk_elementwise_benchmark(
+    const iree_benchmark_def_t* benchmark_def,
+    iree_benchmark_state_t* benchmark_state) {
+  const iree_uk_elementwise_benchmark_params_t* params =
+      (const iree_uk_elementwise_benchmark_params_t*)benchmark_def->user_data;
+  iree_uk_index_t size0 = params->shape->size0;
+  iree_uk_index_t size1 = params->shape->size1;
+  iree_host_size_t count = (iree_host_size_t)(size0 * size1);
+
+  iree_allocator_t host_allocator = benchmark_state->host_allocator;
+  iree_uk_uint32_t* buffer = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, 3 * count * sizeof(iree_uk_uint32_t), (void**)&buffer));
+  iree_uk_uint32_t* lhs = buffer;
+  iree_uk_uint32_t* rhs = buffer + count;
+  iree_uk_uint32_t* out = buffer + 2 * count;
+  // Small positive values keep the float ops on the fast (non-denormal) path
+  // and the integer shifts/divisions well-defined.
+  for (iree_host_size_t i = 0; i < count; ++i) {
+    float value = 1.0f + (float)(i % 17);
+    memcpy(&lhs[i], &value, sizeof(value));
+    rhs[i] = (iree_uk_uint32_t)(i % 7) + 1;
+  }
+
+  int result = 0;
+  int64_t total_iterations = 0;
+  while (iree_benchmark_keep_running(benchmark_state, /*batch_count=*/1)) {
+    if (params->op->binary_func) {
+      result |= params->op->binary_func(lhs, 0, size1, 1, rhs, 0, size1, 1, out,
+                                        0, size1, 1, size0, size1);
+    } else {
+      result |= params->op->unary_func(lhs, 0, size1, 1, out, 0, size1, 1,
+                                       size0, size1);
+    }
+    ++total_iterations;
+  }
+  iree_benchmark_set_items_processed(benchmark_state,
+                                     total_iterations * (int64_t)count);
+
+  iree_allocator_free(host_allocator, buffer);
+  return result == 0 ? iree_ok_status()
+                     : iree_make_status(IREE_STATUS_INTERNAL,
+                                        "elementwise kernel failed");
+}
+
+int main(int argc, char** argv) {
+  iree_benchmark_initialize(&argc, argv);
+  // Required for the runtime selection of ISA-specific kernels.
+  iree_cpu_initialize(iree_allocator_system());
+
+  iree_host_size_t index = 0;
+  for (iree_host_size_t i = 0;
+       i < IREE_ARRAYSIZE(iree_uk_elementwise_benchmark_ops); ++i) {
+    for (iree_host_size_t j = 0;
+         j < IREE_ARRAYSIZE(iree_uk_elementwise_benchmark_shapes); ++j) {
+      iree_uk_elementwise_benchmark_params_t* params =
+          &iree_uk_elementwise_benchmark_params[index++];
+      params->op = &iree_uk_elementwise_benchmark_ops[i];
+      params->shape = &iree_uk_elementwise_benchmark_shapes[j];
+      iree_benchmark_def_t benchmark_def = {
+          .flags = IREE_BENCHMARK_FLAG_MEASURE_PROCESS_CPU_TIME |
+                   IREE_BENCHMARK_FLAG_USE_REAL_TIME,
+          .time_unit = IREE_BENCHMARK_UNIT_NANOSECOND,
+          .minimum_duration_ns = 0,
+          .iteration_count = 0,
+          .run = iree_uk_elementwise_benchmark,
+          .user_data = params,
+      };
+      char name[64];
+      snprintf(name, sizeof(name), "%s_%s", params->op->name,
+               params->shape->name);
+      iree_benchmark_register(iree_make_cstring_view(name), &benchmark_def);
+    }
+  }
+
+  iree_benchmark_run_specified();
+  return 0;
+}
@@ -0,0 +1,101 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_MODULES_VMVX_ELEMENTWISE_INTERNAL_H_
+#define IREE_MODULES_VMVX_ELEMENTWISE_INTERNAL_H_
+
+#include "iree/modules/vmvx/elementwise.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+//===----------------------------------------------------------------------===//
+// Opcodes
+//===----------------------------------------------------------------------===//
+
+// Opcodes for generic functions operating on 32-bit operands and result.
+// Since the outer dispatcher only differentiates based on width, all other
+// type specificity is carried by the opcode.
+// Binary opcodes are named "X32B" and unary opcodes "X32U".
+// The initial list was sorted, and it is encouraged to sort extensions, but
+// each opcode must be numerically stable, so the list is not expected to
+// be sorted over time.
+typedef enum {
+  IREE_UK_X32B_ADDF = 0,
+  IREE_UK_X32B_ADDI = 1,
+  IREE_UK_X32B_ANDI = 2,
+  IREE_UK_X32B_DIVF = 3,
+  IREE_UK_X32B_DIVSI = 4,
+  IREE_UK_X32B_DIVUI = 5,
+  IREE_UK_X32B_MULF = 6,
+  IREE_UK_X32B_MULI = 7,
+  IREE_UK_X32B_ORI = 8,
+  IREE_UK_X32B_SHLI = 9,
+  IREE_UK_X32B_SHRSI = 10,
+  IREE_UK_X32B_SHRUI = 11,
+  IREE_UK_X32B_SUBF = 12,
+  IREE_UK_X32B_SUBI = 13,
+  IREE_UKENREL_X32B_XORI = 14,
+} iree_uk_x32b_opcode_t;
+
+typedef enum {
+  IREE_UK_X32U_ABSF,
+  IREE_UK_X32U_CEILF,
+  IREE_UK_X32U_CTLZ,
+  IREE_UK_X32U_EXPF,
+  IREE_UK_X32U_FLOORF,
+  IREE_UK_X32U_LOGF,
+  IREE_UK_X32U_NEGF,
+  IREE_UK_X32U_RSQRTF,
+} iree_uk_x32u_opcode_t;
+
+//===----------------------------------------------------------------------===//
+// Architecture-specific row kernels
+//===----------------------------------------------------------------------===//
+
+// Computes a leading portion of a contiguous row of |size| elements of a
+// binary opcode and returns the number of elements processed. Kernels only
+// process whole vectors and the caller is responsible for the remainder.
+typedef iree_uk_index_t (*iree_uk_x32b_row_func_t)(const iree_uk_uint32_t* lhs,
+                                                   const iree_uk_uint32_t* rhs,
+                                                   iree_uk_uint32_t* out,
+                                                   iree_uk_index_t size);
+
+// Computes a leading portion of a contiguous row of |size| elements of a
+// unary opcode and returns the number of elements processed.
+typedef iree_uk_index_t (*iree_uk_x32u_row_func_t)(const iree_uk_uint32_t* in,
+                                                   iree_uk_uint32_t* out,
+                                                   iree_uk_index_t size);
+
+// Returns the SSE2 row kernel for |opcode| or NULL if there is none or the
+// target is not x86_64. SSE2 is part of the x86_64 baseline and needs no
+// runtime feature check.
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_sse2(
+    iree_uk_x32b_opcode_t opcode);
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_sse2(
+    iree_uk_x32u_opcode_t opcode);
+
+// Returns the AVX2 row kernel for |opcode| or NULL if there is none.
+// Only available when built with IREE_VMVX_HAVE_X86_64_AVX2 and must only be
+// called when the CPU reports AVX2 support.
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_avx2(
+    iree_uk_x32b_opcode_t opcode);
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_avx2(
+    iree_uk_x32u_opcode_t opcode);
+
+// Returns the NEON row kernel for |opcode| or NULL if there is none or the
+// target is not arm_64. NEON is part of the arm_64 baseline.
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_arm_64(
+    iree_uk_x32b_opcode_t opcode);
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_arm_64(
+    iree_uk_x32u_opcode_t opcode);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_MODULES_VMVX_ELEMENTWISE_INTERNAL_H_
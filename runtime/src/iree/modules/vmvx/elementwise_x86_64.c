@@ -0,0 +1,133 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/modules/vmvx/elementwise_internal.h"
+
+#if defined(IREE_UK_ARCH_X86_64)
+
+#include <emmintrin.h>
+
+//===----------------------------------------------------------------------===//
+// SSE2 row kernels (x86_64 baseline)
+//===----------------------------------------------------------------------===//
+
+#define IREE_UK_X32B_ROW_SSE2_PS(name, vop)                                    \
+  static iree_uk_index_t iree_uk_x32b_##name##_row_x86_64_sse2(                \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,                \
+      iree_uk_uint32_t* out, iree_uk_index_t size) {                           \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 4 <= size; i += 4) {                                            \
+      __m128 l = _mm_loadu_ps((const float*)(lhs + i));                        \
+      __m128 r = _mm_loadu_ps((const float*)(rhs + i));                        \
+      _mm_storeu_ps((float*)(out + i), vop(l, r));                             \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+#define IREE_UK_X32B_ROW_SSE2_EPI32(name, vop)                                 \
+  static iree_uk_index_t iree_uk_x32b_##name##_row_x86_64_sse2(                \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,                \
+      iree_uk_uint32_t* out, iree_uk_index_t size) {                           \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 4 <= size; i += 4) {                                            \
+      __m128i l = _mm_loadu_si128((const __m128i*)(lhs + i));                  \
+      __m128i r = _mm_loadu_si128((const __m128i*)(rhs + i));                  \
+      _mm_storeu_si128((__m128i*)(out + i), vop(l, r));                        \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+#define IREE_UK_X32U_ROW_SSE2_PS(name, vop)                                    \
+  static iree_uk_index_t iree_uk_x32u_##name##_row_x86_64_sse2(                \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* out,                       \
+      iree_uk_index_t size) {                                                  \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 4 <= size; i += 4) {                                            \
+      __m128 v = _mm_loadu_ps((const float*)(in + i));                         \
+      _mm_storeu_ps((float*)(out + i), vop(v));                                \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+static inline __m128 iree_uk_absf_x86_64_sse2(__m128 v) {
+  return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+
+static inline __m128 iree_uk_negf_x86_64_sse2(__m128 v) {
+  return _mm_xor_ps(v, _mm_set1_ps(-0.0f));
+}
+
+// Matches the scalar 1.0f / sqrtf(x) exactly instead of using the approximate
+// _mm_rsqrt_ps.
+static inline __m128 iree_uk_rsqrtf_x86_64_sse2(__m128 v) {
+  return _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(v));
+}
+
+IREE_UK_X32B_ROW_SSE2_PS(addf, _mm_add_ps)
+IREE_UK_X32B_ROW_SSE2_PS(divf, _mm_div_ps)
+IREE_UK_X32B_ROW_SSE2_PS(mulf, _mm_mul_ps)
+IREE_UK_X32B_ROW_SSE2_PS(subf, _mm_sub_ps)
+IREE_UK_X32B_ROW_SSE2_EPI32(addi, _mm_add_epi32)
+IREE_UK_X32B_ROW_SSE2_EPI32(andi, _mm_and_si128)
+IREE_UK_X32B_ROW_SSE2_EPI32(ori, _mm_or_si128)
+IREE_UK_X32B_ROW_SSE2_EPI32(subi, _mm_sub_epi32)
+IREE_UK_X32B_ROW_SSE2_EPI32(xori, _mm_xor_si128)
+
+IREE_UK_X32U_ROW_SSE2_PS(absf, iree_uk_absf_x86_64_sse2)
+IREE_UK_X32U_ROW_SSE2_PS(negf, iree_uk_negf_x86_64_sse2)
+IREE_UK_X32U_ROW_SSE2_PS(rsqrtf, iree_uk_rsqrtf_x86_64_sse2)
+
+#endif  // IREE_UK_ARCH_X86_64
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_sse2(
+    iree_uk_x32b_opcode_t opcode) {
+#if defined(IREE_UK_ARCH_X86_64)
+  // MULI is absent as _mm_mullo_epi32 requires SSE4.1.
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_x86_64_sse2;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_x86_64_sse2;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_x86_64_sse2;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_x86_64_sse2;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_x86_64_sse2;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_x86_64_sse2;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_x86_64_sse2;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_x86_64_sse2;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_xori_row_x86_64_sse2;
+    default:
+      return 0;
+  }
+#else
+  return 0;
+#endif  // IREE_UK_ARCH_X86_64
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_sse2(
+    iree_uk_x32u_opcode_t opcode) {
+#if defined(IREE_UK_ARCH_X86_64)
+  // CEILF/FLOORF are absent as _mm_round_ps requires SSE4.1.
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_x86_64_sse2;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_x86_64_sse2;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_x86_64_sse2;
+    default:
+      return 0;
+  }
+#else
+  return 0;
+#endif  // IREE_UK_ARCH_X86_64
+}
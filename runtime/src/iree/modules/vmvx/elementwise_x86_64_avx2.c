@@ -0,0 +1,130 @@
+// Copyright 2022 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <immintrin.h>
+
+#include "iree/modules/vmvx/elementwise_internal.h"
+
+//===----------------------------------------------------------------------===//
+// AVX2 row kernels
+//===----------------------------------------------------------------------===//
+// This file is only compiled when the compiler supports AVX2 and its functions
+// are only reached after a runtime CPU feature check.
+
+#define IREE_UK_X32B_ROW_AVX2_PS(name, vop)                                    \
+  static iree_uk_index_t iree_uk_x32b_##name##_row_x86_64_avx2(                \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,                \
+      iree_uk_uint32_t* out, iree_uk_index_t size) {                           \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 8 <= size; i += 8) {                                            \
+      __m256 l = _mm256_loadu_ps((const float*)(lhs + i));                     \
+      __m256 r = _mm256_loadu_ps((const float*)(rhs + i));                     \
+      _mm256_storeu_ps((float*)(out + i), vop(l, r));                          \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+#define IREE_UK_X32B_ROW_AVX2_EPI32(name, vop)                                 \
+  static iree_uk_index_t iree_uk_x32b_##name##_row_x86_64_avx2(                \
+      const iree_uk_uint32_t* lhs, const iree_uk_uint32_t* rhs,                \
+      iree_uk_uint32_t* out, iree_uk_index_t size) {                           \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 8 <= size; i += 8) {                                            \
+      __m256i l = _mm256_loadu_si256((const __m256i*)(lhs + i));               \
+      __m256i r = _mm256_loadu_si256((const __m256i*)(rhs + i));               \
+      _mm256_storeu_si256((__m256i*)(out + i), vop(l, r));                     \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+#define IREE_UK_X32U_ROW_AVX2_PS(name, vop)                                    \
+  static iree_uk_index_t iree_uk_x32u_##name##_row_x86_64_avx2(                \
+      const iree_uk_uint32_t* in, iree_uk_uint32_t* out,                       \
+      iree_uk_index_t size) {                                                  \
+    iree_uk_index_t i = 0;                                                     \
+    for (; i + 8 <= size; i += 8) {                                            \
+      __m256 v = _mm256_loadu_ps((const float*)(in + i));                      \
+      _mm256_storeu_ps((float*)(out + i), vop(v));                             \
+    }                                                                          \
+    return i;                                                                  \
+  }
+
+static inline __m256 iree_uk_absf_x86_64_avx2(__m256 v) {
+  return _mm256_andnot_ps(_mm256_set1_ps(-0.0f), v);
+}
+
+static inline __m256 iree_uk_negf_x86_64_avx2(__m256 v) {
+  return _mm256_xor_ps(v, _mm256_set1_ps(-0.0f));
+}
+
+// Matches the scalar 1.0f / sqrtf(x) exactly instead of using the approximate
+// _mm256_rsqrt_ps.
+static inline __m256 iree_uk_rsqrtf_x86_64_avx2(__m256 v) {
+  return _mm256_div_ps(_mm256_set1_ps(1.0f), _mm256_sqrt_ps(v));
+}
+
+IREE_UK_X32B_ROW_AVX2_PS(addf, _mm256_add_ps)
+IREE_UK_X32B_ROW_AVX2_PS(divf, _mm256_div_ps)
+IREE_UK_X32B_ROW_AVX2_PS(mulf, _mm256_mul_ps)
+IREE_UK_X32B_ROW_AVX2_PS(subf, _mm256_sub_ps)
+IREE_UK_X32B_ROW_AVX2_EPI32(addi, _mm256_add_epi32)
+IREE_UK_X32B_ROW_AVX2_EPI32(andi, _mm256_and_si256)
+IREE_UK_X32B_ROW_AVX2_EPI32(muli, _mm256_mullo_epi32)
+IREE_UK_X32B_ROW_AVX2_EPI32(ori, _mm256_or_si256)
+IREE_UK_X32B_ROW_AVX2_EPI32(subi, _mm256_sub_epi32)
+IREE_UK_X32B_ROW_AVX2_EPI32(xori, _mm256_xor_si256)
+
+IREE_UK_X32U_ROW_AVX2_PS(absf, iree_uk_absf_x86_64_avx2)
+IREE_UK_X32U_ROW_AVX2_PS(ceilf, _mm256_ceil_ps)
+IREE_UK_X32U_ROW_AVX2_PS(floorf, _mm256_floor_ps)
+IREE_UK_X32U_ROW_AVX2_PS(negf, iree_uk_negf_x86_64_avx2)
+IREE_UK_X32U_ROW_AVX2_PS(rsqrtf, iree_uk_rsqrtf_x86_64_avx2)
+
+iree_uk_x32b_row_func_t iree_uk_x32b_select_row_func_x86_64_avx2(
+    iree_uk_x32b_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32B_ADDF:
+      return iree_uk_x32b_addf_row_x86_64_avx2;
+    case IREE_UK_X32B_ADDI:
+      return iree_uk_x32b_addi_row_x86_64_avx2;
+    case IREE_UK_X32B_ANDI:
+      return iree_uk_x32b_andi_row_x86_64_avx2;
+    case IREE_UK_X32B_DIVF:
+      return iree_uk_x32b_divf_row_x86_64_avx2;
+    case IREE_UK_X32B_MULF:
+      return iree_uk_x32b_mulf_row_x86_64_avx2;
+    case IREE_UK_X32B_MULI:
+      return iree_uk_x32b_muli_row_x86_64_avx2;
+    case IREE_UK_X32B_ORI:
+      return iree_uk_x32b_ori_row_x86_64_avx2;
+    case IREE_UK_X32B_SUBF:
+      return iree_uk_x32b_subf_row_x86_64_avx2;
+    case IREE_UK_X32B_SUBI:
+      return iree_uk_x32b_subi_row_x86_64_avx2;
+    case IREE_UKENREL_X32B_XORI:
+      return iree_uk_x32b_xori_row_x86_64_avx2;
+    default:
+      return 0;
+  }
+}
+
+iree_uk_x32u_row_func_t iree_uk_x32u_select_row_func_x86_64_avx2(
+    iree_uk_x32u_opcode_t opcode) {
+  switch (opcode) {
+    case IREE_UK_X32U_ABSF:
+      return iree_uk_x32u_absf_row_x86_64_avx2;
+    case IREE_UK_X32U_CEILF:
+      return iree_uk_x32u_ceilf_row_x86_64_avx2;
+    case IREE_UK_X32U_FLOORF:
+      return iree_uk_x32u_floorf_row_x86_64_avx2;
+    case IREE_UK_X32U_NEGF:
+      return iree_uk_x32u_negf_row_x86_64_avx2;
+    case IREE_UK_X32U_RSQRTF:
+      return iree_uk_x32u_rsqrtf_row_x86_64_avx2;
+    default:
+      return 0;
+  }
+}
@@ -186,8 +186,12 @@ static iree_host_size_t iree_vmvx_cast_host_size(int64_t value,
                      ret_types)
 #define IREE_VMVX_ABI_FIXED_STRUCT(name, types, body) \
   IREE_VM_ABI_FIXED_STRUCT(name, body)
+// Argument shims are only called from the per-export shims defined with
+// IREE_VMVX_ABI_DEFINE_EXPORT_SHIM and are always inlined into them so that the
+// target function becomes a direct call.
 #define IREE_VMVX_ABI_DEFINE_SHIM(arg_types, ret_types) \
-  static IREE_VM_ABI_DEFINE_SHIM(arg_types, ret_types)
+  static inline IREE_ATTRIBUTE_ALWAYS_INLINE            \
+  IREE_VM_ABI_DEFINE_SHIM(arg_types, ret_types)
 
 IREE_VMVX_ABI_FIXED_STRUCT(unary2d, rIIIrIIIII, {
   iree_vm_ref_t in_ref;
@@ -243,7 +247,8 @@ IREE_VMVX_ABI_FIXED_STRUCT(ukernel_x32b_2d, rIIIrIIIrIIIII, {
   int64_t size1;
 });
 
-static iree_status_t iree_vm_shim_ukernel_x32b_2d_v(
+static inline IREE_ATTRIBUTE_ALWAYS_INLINE iree_status_t
+iree_vm_shim_ukernel_x32b_2d_v(
     iree_vm_stack_t* IREE_RESTRICT stack, iree_vm_native_function_flags_t flags,
     iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
     iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module,
@@ -312,7 +317,8 @@ IREE_VMVX_ABI_FIXED_STRUCT(ukernel_x32u_2d, rIIIrIIIII, {
   int64_t size1;
 });
 
-static iree_status_t iree_vm_shim_ukernel_x32u_2d_v(
+static inline IREE_ATTRIBUTE_ALWAYS_INLINE iree_status_t
+iree_vm_shim_ukernel_x32u_2d_v(
     iree_vm_stack_t* IREE_RESTRICT stack, iree_vm_native_function_flags_t flags,
     iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
     iree_vm_native_function_target2_t target_fn, void* IREE_RESTRICT module,
@@ -744,13 +750,31 @@ IREE_VMVX_ABI_EXPORT(iree_vmvx_query_tile_sizes_2d, query_tile_sizes_2d, II) {
 // VM module interface implementation
 //===----------------------------------------------------------------------===//
 
+// Shims specialized for each export. Each forwards to the argument shim for
+// its argument struct with a constant target so that once inlined the target
+// (including ukernels) is called directly instead of through the function
+// table.
+#define EXPORT_FN(name, target_fn, arg_struct, arg_types, ret_types)           \
+  static iree_status_t iree_vmvx_##target_fn##_shim(                           \
+      iree_vm_stack_t* IREE_RESTRICT stack,                                    \
+      iree_vm_native_function_flags_t flags, iree_byte_span_t args_storage,    \
+      iree_byte_span_t rets_storage,                                           \
+      iree_vm_native_function_target2_t unused_target_fn,                      \
+      void* IREE_RESTRICT module, void* IREE_RESTRICT module_state) {          \
+    return iree_vm_shim_##arg_struct##_##ret_types(                            \
+        stack, flags, args_storage, rets_storage,                              \
+        (iree_vm_native_function_target2_t)(target_fn), module, module_state); \
+  }
+#include "iree/modules/vmvx/exports.inl"  // IWYU pragma: keep
+#undef EXPORT_FN
+
 // NOTE: this must match the ordering of the iree_vmvx_module_exports_table.
 static const iree_vm_native_function_ptr_t iree_vmvx_module_funcs_[] = {
 #define EXPORT_FN(name, target_fn, arg_struct, arg_types, ret_types) \
   {                                                                  \
-      .shim = (iree_vm_native_function_shim_t)                       \
-          iree_vm_shim_##arg_struct##_##ret_types,                   \
-      .target = (iree_vm_native_function_target_t)(target_fn),       \
+      .shim = (iree_vm_native_function_shim_t)(                      \
+          iree_vmvx_##target_fn##_shim),                             \
+      .target = NULL,                                                \
   },
 #include "iree/modules/vmvx/exports.inl"  // IWYU pragma: keep
 #undef EXPORT_FN
@@ -10,6 +10,7 @@
 #include <string.h>
 
 #include "iree/base/internal/atomics.h"
+#include "iree/base/internal/synchronization.h"
 #include "iree/hal/api.h"
 #include "iree/hal/drivers/init.h"
 #include "iree/modules/hal/module.h"
@@ -37,6 +38,16 @@ IREE_API_EXPORT void iree_runtime_instance_options_use_all_available_drivers(
 // iree_runtime_instance_t
 //===----------------------------------------------------------------------===//
 
+// A HAL driver or device cached on the instance and shared by all sessions.
+// Exactly one of |driver| or |device| is set based on the list the entry is in.
+typedef struct iree_runtime_instance_cache_entry_t {
+  struct iree_runtime_instance_cache_entry_t* next;
+  // Driver name or device URI; references trailing storage.
+  iree_string_view_t key;
+  iree_hal_driver_t* driver;
+  iree_hal_device_t* device;
+} iree_runtime_instance_cache_entry_t;
+
 struct iree_runtime_instance_t {
   iree_atomic_ref_count_t ref_count;
 
@@ -46,10 +57,16 @@ struct iree_runtime_instance_t {
   // An optional driver registry used to enumerate and create HAL devices.
   iree_hal_driver_registry_t* driver_registry;
 
-  // TODO(#5724): we should have a device cache here so that multiple sessions
-  // can find the same devices. This may mean a new HAL type like
-  // iree_hal_device_pool_t to prevent too much coupling and make weak
-  // references easier.
+  // Guards the driver and device caches. Held while creating drivers and
+  // devices so that concurrent requests for the same key share one instance.
+  iree_slim_mutex_t cache_mutex;
+  // Drivers created from the registry keyed by driver name.
+  iree_runtime_instance_cache_entry_t* driver_cache;
+  // Devices created from the drivers keyed by device URI. Sessions using the
+  // same device share its executors, allocator pools, and caches.
+  // TODO(#5724): this may move to a new HAL type like iree_hal_device_pool_t
+  // to prevent too much coupling and make weak references easier.
+  iree_runtime_instance_cache_entry_t* device_cache;
 
   // VM instance shared across all sessions.
   iree_vm_instance_t* vm_instance;
@@ -70,6 +87,7 @@ IREE_API_EXPORT iree_status_t iree_runtime_instance_create(
                                 (void**)&instance));
   instance->host_allocator = host_allocator;
   iree_atomic_ref_count_init(&instance->ref_count);
+  iree_slim_mutex_initialize(&instance->cache_mutex);
 
   instance->driver_registry = options->driver_registry;
   // TODO(benvanik): driver registry ref counting.
@@ -93,6 +111,8 @@ static void iree_runtime_instance_destroy(iree_runtime_instance_t* instance) {
   IREE_ASSERT_ARGUMENT(instance);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_runtime_instance_trim_devices(instance);
+  iree_slim_mutex_deinitialize(&instance->cache_mutex);
   iree_vm_instance_release(instance->vm_instance);
   iree_allocator_free(instance->host_allocator, instance);
 
@@ -131,39 +151,164 @@ iree_runtime_instance_driver_registry(const iree_runtime_instance_t* instance) {
   return instance->driver_registry;
 }
 
-IREE_API_EXPORT iree_status_t iree_runtime_instance_try_create_default_device(
+// Frees all entries in |list| and releases their drivers or devices.
+static void iree_runtime_instance_cache_free(
+    iree_allocator_t host_allocator,
+    iree_runtime_instance_cache_entry_t* list) {
+  while (list) {
+    iree_runtime_instance_cache_entry_t* entry = list;
+    list = entry->next;
+    iree_hal_device_release(entry->device);
+    iree_hal_driver_release(entry->driver);
+    iree_allocator_free(host_allocator, entry);
+  }
+}
+
+// Returns the entry in |list| with |key| or NULL if not found.
+static iree_runtime_instance_cache_entry_t* iree_runtime_instance_cache_find(
+    iree_runtime_instance_cache_entry_t* list, iree_string_view_t key) {
+  for (iree_runtime_instance_cache_entry_t* entry = list; entry;
+       entry = entry->next) {
+    if (iree_string_view_equal(entry->key, key)) return entry;
+  }
+  return NULL;
+}
+
+// Allocates a new entry for |key| and prepends it to |list|.
+static iree_status_t iree_runtime_instance_cache_insert(
+    iree_allocator_t host_allocator, iree_string_view_t key,
+    iree_runtime_instance_cache_entry_t** list,
+    iree_runtime_instance_cache_entry_t** out_entry) {
+  iree_runtime_instance_cache_entry_t* entry = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      host_allocator, sizeof(*entry) + key.size, (void**)&entry));
+  char* key_storage = (char*)entry + sizeof(*entry);
+  memcpy(key_storage, key.data, key.size);
+  entry->key = iree_make_string_view(key_storage, key.size);
+  entry->next = *list;
+  *list = entry;
+  *out_entry = entry;
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT void iree_runtime_instance_trim_devices(
+    iree_runtime_instance_t* instance) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_slim_mutex_lock(&instance->cache_mutex);
+  iree_runtime_instance_cache_entry_t* device_cache = instance->device_cache;
+  iree_runtime_instance_cache_entry_t* driver_cache = instance->driver_cache;
+  instance->device_cache = NULL;
+  instance->driver_cache = NULL;
+  iree_slim_mutex_unlock(&instance->cache_mutex);
+
+  // Devices must be released before the drivers that created them.
+  iree_runtime_instance_cache_free(instance->host_allocator, device_cache);
+  iree_runtime_instance_cache_free(instance->host_allocator, driver_cache);
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+// Returns the cached driver with |driver_name|, creating it if needed.
+// The returned driver is owned by the cache. Must be called with the cache
+// mutex held.
+static iree_status_t iree_runtime_instance_lookup_or_create_driver(
     iree_runtime_instance_t* instance, iree_string_view_t driver_name,
+    iree_hal_driver_t** out_driver) {
+  iree_runtime_instance_cache_entry_t* entry =
+      iree_runtime_instance_cache_find(instance->driver_cache, driver_name);
+  if (entry) {
+    *out_driver = entry->driver;
+    return iree_ok_status();
+  }
+
+  iree_hal_driver_t* driver = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_driver_registry_try_create(
+      instance->driver_registry, driver_name, instance->host_allocator,
+      &driver));
+  iree_status_t status = iree_runtime_instance_cache_insert(
+      instance->host_allocator, driver_name, &instance->driver_cache, &entry);
+  if (iree_status_is_ok(status)) {
+    entry->driver = driver;
+    *out_driver = driver;
+  } else {
+    iree_hal_driver_release(driver);
+  }
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_runtime_instance_lookup_or_create_device(
+    iree_runtime_instance_t* instance, iree_string_view_t device_uri,
     iree_hal_device_t** out_device) {
   IREE_ASSERT_ARGUMENT(instance);
   IREE_ASSERT_ARGUMENT(out_device);
   *out_device = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_TEXT(z0, driver_name.data, driver_name.size);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, device_uri.data, device_uri.size);
 
   // This is only supported when we have a driver registry we can use to create
   // the drivers.
-  iree_hal_driver_registry_t* driver_registry =
-      iree_runtime_instance_driver_registry(instance);
-  if (!driver_registry) {
+  if (!instance->driver_registry) {
     IREE_TRACE_ZONE_END(z0);
     return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
                             "instance was created without a driver registry "
                             "and cannot perform enumeration");
   }
 
-  // Create a driver with the given name (if one exists).
-  iree_allocator_t host_allocator =
-      iree_runtime_instance_host_allocator(instance);
-  iree_hal_driver_t* driver = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_driver_registry_try_create(driver_registry, driver_name,
-                                              host_allocator, &driver));
+  iree_slim_mutex_lock(&instance->cache_mutex);
 
-  // Create the default device on that driver.
-  iree_status_t status =
-      iree_hal_driver_create_default_device(driver, host_allocator, out_device);
+  // Fast path for devices already created by this or another session.
+  iree_runtime_instance_cache_entry_t* entry =
+      iree_runtime_instance_cache_find(instance->device_cache, device_uri);
+  if (entry) {
+    iree_hal_device_retain(entry->device);
+    *out_device = entry->device;
+    iree_slim_mutex_unlock(&instance->cache_mutex);
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "hit");
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
 
-  iree_hal_driver_release(driver);
+  // Create the device from the (possibly cached) driver. The driver name is
+  // the URI scheme or the entire URI if no path or params are specified.
+  iree_string_view_t driver_name = iree_string_view_empty();
+  iree_string_view_t device_path = iree_string_view_empty();
+  iree_string_view_split(device_uri, ':', &driver_name, &device_path);
+  iree_hal_driver_t* driver = NULL;
+  iree_status_t status = iree_runtime_instance_lookup_or_create_driver(
+      instance, driver_name, &driver);
+  iree_hal_device_t* device = NULL;
+  if (iree_status_is_ok(status)) {
+    if (iree_string_view_is_empty(device_path)) {
+      status = iree_hal_driver_create_default_device(
+          driver, instance->host_allocator, &device);
+    } else {
+      status = iree_hal_driver_create_device_by_uri(
+          driver, device_uri, instance->host_allocator, &device);
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_runtime_instance_cache_insert(
+        instance->host_allocator, device_uri, &instance->device_cache, &entry);
+  }
+  if (iree_status_is_ok(status)) {
+    entry->device = device;
+    iree_hal_device_retain(device);
+    *out_device = device;
+  } else {
+    iree_hal_device_release(device);
+  }
+
+  iree_slim_mutex_unlock(&instance->cache_mutex);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+IREE_API_EXPORT iree_status_t iree_runtime_instance_try_create_default_device(
+    iree_runtime_instance_t* instance, iree_string_view_t driver_name,
+    iree_hal_device_t** out_device) {
+  // A URI with only a driver name selects the default device of the driver.
+  return iree_runtime_instance_lookup_or_create_device(instance, driver_name,
+                                                       out_device);
+}
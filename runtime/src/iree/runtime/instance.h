@@ -111,6 +111,29 @@ IREE_API_EXPORT iree_vm_instance_t* iree_runtime_instance_vm_instance(
 IREE_API_EXPORT iree_hal_driver_registry_t*
 iree_runtime_instance_driver_registry(const iree_runtime_instance_t* instance);
 
+// Returns the HAL device for |device_uri| shared by all sessions using the
+// instance, creating it on first use. |device_uri| is of the form
+// `driver://path?params` as with iree_hal_create_device; a bare driver name
+// selects the default device of the driver. Drivers are also cached so that
+// each is only created once per instance.
+//
+// Sessions sharing a device share its executors (and their worker threads),
+// allocator pools, and caches. The instance retains all devices it creates
+// until it is destroyed or iree_runtime_instance_trim_devices is called.
+// |out_device| must be released by the caller.
+IREE_API_EXPORT iree_status_t iree_runtime_instance_lookup_or_create_device(
+    iree_runtime_instance_t* instance, iree_string_view_t device_uri,
+    iree_hal_device_t** out_device);
+
+// Drops the instance references to all cached devices and drivers. Devices
+// still in use by sessions remain alive until released but will no longer be
+// returned from iree_runtime_instance_lookup_or_create_device.
+IREE_API_EXPORT void iree_runtime_instance_trim_devices(
+    iree_runtime_instance_t* instance);
+
+// Returns the default device of the driver with |driver_name| shared by all
+// sessions using the instance. Equivalent to
+// iree_runtime_instance_lookup_or_create_device with the driver name as URI.
 // TODO(#5724): remove this once user modules query devices themselves.
 IREE_API_EXPORT iree_status_t iree_runtime_instance_try_create_default_device(
     iree_runtime_instance_t* instance, iree_string_view_t driver_name,
@@ -235,13 +235,22 @@ iree_runtime_session_append_bytecode_module_from_file(
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, file_path);
 
-  // TODO(#3909): actually map the memory here. For now we just load the
-  // contents.
+  // Map the file so that the bytecode and rodata are demand-paged and shared
+  // with other processes mapping the same file. Platforms without file mapping
+  // support fall back to reading the contents into memory.
+  iree_allocator_t host_allocator =
+      iree_runtime_session_host_allocator(session);
   iree_file_contents_t* flatbuffer_contents = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_file_read_contents(file_path, IREE_FILE_READ_FLAG_DEFAULT,
-                                  iree_runtime_session_host_allocator(session),
-                                  &flatbuffer_contents));
+  iree_status_t map_status = iree_file_read_contents(
+      file_path, IREE_FILE_READ_FLAG_MMAP, host_allocator,
+      &flatbuffer_contents);
+  if (iree_status_is_unavailable(map_status)) {
+    iree_status_ignore(map_status);
+    map_status =
+        iree_file_read_contents(file_path, IREE_FILE_READ_FLAG_PRELOAD,
+                                host_allocator, &flatbuffer_contents);
+  }
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(z0, map_status);
 
   // Create the module from the file contents. The contents are consumed
   // regardless of whether the module can be loaded or not.
@@ -166,6 +166,10 @@ iree_runtime_session_append_bytecode_module_from_memory(
     iree_allocator_t flatbuffer_allocator);
 
 // Appends a bytecode module to the context loaded from the given |file_path|.
+// The file is memory mapped when supported by the platform so that the module
+// bytecode and rodata are paged in on demand and shared with other processes
+// mapping the same file. The file must not be modified while the session is
+// live.
 //
 // NOTE: only valid if the context is not yet frozen; see
 // iree_vm_context_freeze for more information.
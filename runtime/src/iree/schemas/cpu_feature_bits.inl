@@ -123,3 +123,6 @@ IREE_CPU_FEATURE_BIT(X86_64, 0, 52, AMXBF16, "amx-bf16")
 // General features and high-level switches.
 // RISCV vector extension.
 IREE_CPU_FEATURE_BIT(RISCV_64, 0, 0, RVV, "rvv")
+
+// Vector half-precision floating-point arithmetic (Zvfh).
+IREE_CPU_FEATURE_BIT(RISCV_64, 0, 1, ZVFH, "zvfh")
@@ -30,6 +30,9 @@ enum iree_idbts_chunk_type_e {
   // NOTE: these will change in the real IDB spec.
   IREE_IDBTS_CHUNK_TYPE_DISPATCH_METADATA = 0x0000u,
   IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER = 0x0001u,
+  // Contents are an iree_idbts_dispatch_ringbuffer_span_t followed by the
+  // dispatch records drained from a live ringbuffer.
+  IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER_SPAN = 0x0002u,
 };
 typedef uint16_t iree_idbts_chunk_type_t;
 
@@ -64,11 +67,28 @@ static_assert(sizeof(iree_idbts_chunk_header_t) % 16 == 0,
 // its end.
 #define IREE_INSTRUMENT_DISPATCH_PADDING 4096
 
+// Header of a IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER_SPAN chunk.
+// Spans are produced by draining the ringbuffer while the program is running.
+// The records in the span are stored linearly (unwrapped) and cover the
+// monotonic write head range [head_begin, head_end).
+typedef struct iree_idbts_dispatch_ringbuffer_span_t {
+  // Write head offset of the first record in the span.
+  uint64_t head_begin;
+  // Write head offset immediately following the last record in the span.
+  uint64_t head_end;
+  // Total bytes of records overwritten before they could be drained since the
+  // previous span.
+  uint64_t dropped_length;
+  uint64_t reserved;
+} iree_idbts_dispatch_ringbuffer_span_t;
+static_assert(sizeof(iree_idbts_dispatch_ringbuffer_span_t) % 16 == 0,
+              "span header must be 16-byte aligned");
+
 typedef enum iree_instrument_dispatch_type_e {
   IREE_INSTRUMENT_DISPATCH_TYPE_WORKGROUP = 0b00000000,
   IREE_INSTRUMENT_DISPATCH_TYPE_PRINT = 0b00000001,
   IREE_INSTRUMENT_DISPATCH_TYPE_VALUE = 0b00000010,
-  IREE_INSTRUMENT_DISPATCH_TYPE_RESERVED_0 = 0b00000011,  // free for use
+  IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_SUMMARY = 0b00000011,
   IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD = 0b00000100,
   IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_STORE = 0b00000101,
 } iree_instrument_dispatch_type_t;
@@ -105,6 +125,46 @@ typedef struct iree_instrument_dispatch_memory_op_t {
   uint64_t address;
 } iree_instrument_dispatch_memory_op_t;
 
+// Buckets of the stride between consecutive accesses made by the same memory
+// operation within a workgroup. Strides are measured in bytes between the
+// starting addresses of the accesses.
+enum iree_instrument_dispatch_stride_bucket_e {
+  // Same address as the previous access (temporal reuse).
+  IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_ZERO = 0,
+  // Immediately following the previous access (unit stride).
+  IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_SEQUENTIAL,
+  // Any other stride up to a 64 byte cache line.
+  IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_CACHE_LINE,
+  // Any other stride up to a 4096 byte page.
+  IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_PAGE,
+  // Strides larger than a page.
+  IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_FAR,
+  IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_COUNT,
+};
+
+// Aggregate of all memory accesses made by a workgroup to a single binding.
+// Emitted once per accessed binding when the workgroup completes instead of
+// one IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD/_STORE record per access.
+typedef struct iree_instrument_dispatch_memory_summary_t {
+  uint64_t tag : 8;  // IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_SUMMARY
+  // Binding ordinal or 0xFF for memory not originating from a binding (such
+  // as workgroup-local allocations).
+  uint64_t binding : 8;
+  uint64_t reserved : 8;
+  uint64_t workgroup_offset : 40;
+  uint64_t load_count;
+  uint64_t load_bytes;
+  uint64_t store_count;
+  uint64_t store_bytes;
+  // Number of accesses in each iree_instrument_dispatch_stride_bucket_e.
+  uint64_t stride_histogram[IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_COUNT];
+} iree_instrument_dispatch_memory_summary_t;
+static_assert(sizeof(iree_instrument_dispatch_memory_summary_t) % 16 == 0,
+              "memory summary records must be 16-byte aligned");
+
+// Binding ordinal used for memory not originating from a binding.
+#define IREE_INSTRUMENT_DISPATCH_MEMORY_SUMMARY_BINDING_OTHER 0xFFu
+
 enum iree_instrument_dispatch_value_type_e {
   IREE_INSTRUMENT_DISPATCH_VALUE_TYPE_SINT_8 = 0,
   IREE_INSTRUMENT_DISPATCH_VALUE_TYPE_UINT_8,
@@ -130,4 +190,28 @@ typedef struct iree_instrument_dispatch_value_t {
   uint64_t bits;
 } iree_instrument_dispatch_value_t;
 
+// Returns the total byte length of the dispatch record starting at |header| or
+// 0 if the record type is unknown.
+static inline uint64_t iree_instrument_dispatch_record_length(
+    const iree_instrument_dispatch_header_t* header) {
+  switch (header->tag) {
+    case IREE_INSTRUMENT_DISPATCH_TYPE_WORKGROUP:
+      return sizeof(iree_instrument_dispatch_workgroup_t);
+    case IREE_INSTRUMENT_DISPATCH_TYPE_PRINT: {
+      const iree_instrument_dispatch_print_t* print =
+          (const iree_instrument_dispatch_print_t*)header;
+      return (sizeof(*print) + print->length + 15) & ~(uint64_t)15;
+    }
+    case IREE_INSTRUMENT_DISPATCH_TYPE_VALUE:
+      return sizeof(iree_instrument_dispatch_value_t);
+    case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD:
+    case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_STORE:
+      return sizeof(iree_instrument_dispatch_memory_op_t);
+    case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_SUMMARY:
+      return sizeof(iree_instrument_dispatch_memory_summary_t);
+    default:
+      return 0;
+  }
+}
+
 #endif  // IREE_SCHEMAS_INSTRUMENTS_DISPATCH_H_
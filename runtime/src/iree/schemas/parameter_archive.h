@@ -226,6 +226,26 @@ typedef struct iree_io_parameter_archive_data_entry_t {
   iree_io_parameter_archive_storage_ref_t storage;
 } iree_io_parameter_archive_data_entry_t;
 
+// Data entry flag indicating that the entry is immediately followed by an
+// iree_io_parameter_archive_content_hash_t included in the entry size.
+#define IREE_IO_PARAMETER_ARCHIVE_DATA_ENTRY_FLAG_CONTENT_HASH (1ull << 0)
+
+// Size of the blocks entry contents are divided into when computing content
+// hashes.
+#define IREE_IO_PARAMETER_ARCHIVE_CONTENT_HASH_BLOCK_SIZE (16 * 1024 * 1024)
+
+// Hash of the stored contents of a data entry. Readers may treat entries with
+// the same storage length and content hash as having identical contents (such
+// as when deduplicating parameters shared by multiple archives).
+//
+// The hash is the 64-bit FNV-1a hash of the sequence of little-endian 64-bit
+// FNV-1a hashes of each IREE_IO_PARAMETER_ARCHIVE_CONTENT_HASH_BLOCK_SIZE block
+// of the contents (with a short final block) such that blocks can be hashed
+// independently.
+typedef struct iree_io_parameter_archive_content_hash_t {
+  uint64_t value;
+} iree_io_parameter_archive_content_hash_t;
+
 // An entry referencing data in an external file.
 typedef struct iree_io_parameter_archive_external_entry_t {
   // Entry header with type IREE_IO_PARAMETER_ARCHIVE_ENTRY_TYPE_EXTERNAL.
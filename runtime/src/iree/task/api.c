@@ -16,6 +16,19 @@
 // Executor configuration
 //===----------------------------------------------------------------------===//
 
+IREE_FLAG(
+    string, task_scheduling_mode, "default",
+    "Selects how the executor balances ready work across workers:\n"
+    " 'default':\n"
+    "   Breadth-first scheduling that spreads work across idle workers.\n"
+    " 'drain':\n"
+    "   Drains each worker queue until it blocks before waking idle workers.\n"
+    "   Improves cache locality and the memory high-water mark of offline\n"
+    "   workloads at the cost of latency.\n"
+    " 'widest':\n"
+    "   Issues the widest tasks first and spreads them across all workers.\n"
+    "   Improves utilization and latency at the cost of more wakes.");
+
 IREE_FLAG(
     int32_t, task_worker_spin_us, 0,
     "Maximum duration in microseconds each worker should spin waiting for\n"
@@ -24,6 +37,13 @@ IREE_FLAG(
     "when latency is the #1 priority (vs. thermals, system-wide scheduling,\n"
     "etc).");
 
+IREE_FLAG(
+    bool, task_worker_adaptive_spin, false,
+    "Workers learn how long they are typically idle before new work arrives\n"
+    "and only spin (for up to --task_worker_spin_us or 100us if unset) when\n"
+    "work is expected soon. Reduces the wake latency of bursty workloads\n"
+    "without spinning through long idle periods.");
+
 IREE_FLAG(
     int32_t, task_worker_stack_size, 128 * 1024,
     "Minimum size in bytes of each worker thread stack.\n"
@@ -44,10 +64,34 @@ IREE_FLAG(
     "be configured to make at least that amount of local memory available.\n"
     "By default the CPU L2 cache size is used if such queries are supported.");
 
+static iree_status_t iree_task_executor_parse_scheduling_mode(
+    const char* value, iree_task_scheduling_mode_t* out_mode) {
+  *out_mode = IREE_TASK_SCHEDULING_MODE_DEFAULT;
+  if (strcmp(value, "default") == 0) {
+    *out_mode = IREE_TASK_SCHEDULING_MODE_DEFAULT;
+    return iree_ok_status();
+  } else if (strcmp(value, "drain") == 0) {
+    *out_mode = IREE_TASK_SCHEDULING_MODE_DRAIN_UNTIL_BLOCKED;
+    return iree_ok_status();
+  } else if (strcmp(value, "widest") == 0) {
+    *out_mode = IREE_TASK_SCHEDULING_MODE_WIDEST_FIRST;
+    return iree_ok_status();
+  }
+  return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                          "unknown value `%s` for scheduling mode; expected "
+                          "one of [default, drain, widest]",
+                          value);
+}
+
 iree_status_t iree_task_executor_options_initialize_from_flags(
     iree_task_executor_options_t* out_options) {
   IREE_ASSERT_ARGUMENT(out_options);
   iree_task_executor_options_initialize(out_options);
+  IREE_RETURN_IF_ERROR(iree_task_executor_parse_scheduling_mode(
+      FLAG_task_scheduling_mode, &out_options->scheduling_mode));
+  if (FLAG_task_worker_adaptive_spin) {
+    out_options->scheduling_mode |= IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN;
+  }
   out_options->worker_spin_ns =
       (iree_duration_t)FLAG_task_worker_spin_us * 1000;
   out_options->worker_stack_size =
@@ -72,7 +116,11 @@ IREE_FLAG(
     " 'physical_cores':\n"
     "   Creates one executor per NUMA node in --task_topology_nodes= and one\n"
     "   group per physical core in each NUMA node up to the value specified\n"
-    "   by --task_topology_max_group_count=.");
+    "   by --task_topology_max_group_count=.\n"
+    " 'threadless':\n"
+    "   Creates a single executor with no worker threads. Tasks only execute\n"
+    "   on threads that wait for them (donating themselves to the executor)\n"
+    "   which avoids cross-thread hops for latency-sensitive workloads.");
 
 IREE_FLAG(
     int32_t, task_topology_group_count, 0,
@@ -91,11 +139,13 @@ IREE_FLAG_LIST(
     "[0, total_processor_count) range on Windows.");
 
 IREE_FLAG(
-    string, task_topology_nodes, "current",
+    string, task_topology_nodes, "auto",
     "Comma-separated list of NUMA nodes that topologies will be defined for.\n"
     "Each node specified will be configured based on the other topology\n"
     "flags. 'all' can be used to indicate all available NUMA nodes and\n"
-    "'current' will inherit the node of the calling thread.");
+    "'current' will inherit the node of the calling thread. 'auto' selects\n"
+    "'all' with --task_topology_mode=physical_cores (one executor per node)\n"
+    "and 'current' otherwise.");
 
 IREE_FLAG(
     int32_t, task_topology_max_group_count, 64,
@@ -105,7 +155,9 @@ IREE_FLAG(
 
 IREE_FLAG(string, task_topology_performance_level, "any",
           "Selects only cores that match the specified performance level from\n"
-          "[`any`, `low` (or `efficiency`), `high` (or `performance`)].");
+          "[`any`, `low` (or `efficiency`), `high` (or `performance`)].\n"
+          "On hybrid systems `any` selects performance cores first when\n"
+          "--task_topology_max_group_count is less than the core count.");
 
 // Builds a bitmask of NUMA nodes that topologies should be created for.
 //
@@ -127,6 +179,14 @@ static iree_status_t iree_task_topologies_select_nodes_from_flags(
   // Build a bitmask based on the flags.
   iree_string_view_t nodes_flag =
       iree_make_cstring_view(FLAG_task_topology_nodes);
+  if (iree_string_view_equal(nodes_flag, IREE_SV("auto"))) {
+    // Executors pinned to physical cores are most efficient when each stays
+    // within a single node. Unpinned and threadless executors gain nothing
+    // from being split across nodes.
+    const bool pinned = FLAG_task_topology_group_count == 0 &&
+                        strcmp(FLAG_task_topology_mode, "physical_cores") == 0;
+    nodes_flag = pinned ? IREE_SV("all") : IREE_SV("current");
+  }
   uint64_t node_mask = 0ull;
   if (iree_string_view_is_empty(nodes_flag) ||
       iree_string_view_equal(nodes_flag, IREE_SV("current"))) {
@@ -189,6 +249,9 @@ iree_status_t iree_task_topology_initialize_from_flags(
     iree_task_topology_initialize_from_group_count(
         FLAG_task_topology_group_count, out_topology);
     return iree_ok_status();
+  } else if (strcmp(FLAG_task_topology_mode, "threadless") == 0) {
+    // No groups; executors created with the topology are threadless.
+    return iree_ok_status();
   } else if (strcmp(FLAG_task_topology_mode, "physical_cores") == 0) {
     // Physical cores sourced from a specific NUMA node.
     iree_task_topology_performance_level_t performance_level =
@@ -243,6 +306,19 @@ static void iree_task_flags_dump_task_topology(
     }
     fprintf(stdout, "\n");
 
+    fprintf(stdout, "#    performance: ");
+    switch (group->performance_level) {
+      case IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW:
+        fprintf(stdout, "low (efficiency core)\n");
+        break;
+      case IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH:
+        fprintf(stdout, "high (performance core)\n");
+        break;
+      default:
+        fprintf(stdout, "(homogeneous/unknown)\n");
+        break;
+    }
+
     fprintf(stdout, "#  caches: l1d=%u, l2d=%u\n", group->caches.l1_data,
             group->caches.l2_data);
 
@@ -377,6 +453,17 @@ iree_status_t iree_task_executors_create_from_flags(
         "proper NUMA-aware scheduling");
   }
 
+  // Threadless executors have no threads to pin to nodes and only one of them
+  // can be pumped by any particular waiter.
+  if (cpu_ids_list.count == 0 && FLAG_task_topology_group_count == 0 &&
+      strcmp(FLAG_task_topology_mode, "threadless") == 0 &&
+      topology_count > 1) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "multiple nodes specified with --task_topology_mode=threadless; "
+        "threadless mode creates a single executor with no worker threads");
+  }
+
   // Create one executor per topology.
   iree_status_t status = iree_ok_status();
   if (cpu_ids_list.count == 0) {
@@ -396,10 +483,9 @@ iree_status_t iree_task_executors_create_from_flags(
       status = iree_task_topology_initialize_from_flags(node_id, &topology);
       if (!iree_status_is_ok(status)) break;
 
-      // TODO(benvanik): if group count is 0 then don't create the executor.
-      // Today the executor creation will fail with 0 groups so the program
-      // won't get in a weird state but it's probably not what a user would
-      // expect.
+      // NOTE: topologies with no groups (such as when
+      // --task_topology_mode=threadless) create threadless executors that only
+      // make progress when callers donate their threads.
 
       // Create executor with the given topology.
       status = iree_task_executor_create(options, &topology, host_allocator,
@@ -417,11 +503,6 @@ iree_status_t iree_task_executors_create_from_flags(
           cpu_ids_list.values[i], &topology);
       if (!iree_status_is_ok(status)) break;
 
-      // TODO(benvanik): if group count is 0 then don't create the executor.
-      // Today the executor creation will fail with 0 groups so the program
-      // won't get in a weird state but it's probably not what a user would
-      // expect.
-
       // Create executor with the given topology.
       status = iree_task_executor_create(options, &topology, host_allocator,
                                          &executors[i]);
@@ -22,6 +22,9 @@
 #include "iree/task/tuning.h"
 #include "iree/task/worker.h"
 
+static_assert(IREE_TASK_EXECUTOR_MAX_DONOR_COUNT < 32,
+              "donors are tracked in a 32-bit mask");
+
 static void iree_task_executor_destroy(iree_task_executor_t* executor);
 
 void iree_task_executor_options_initialize(
@@ -59,46 +62,87 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
                             worker_count, IREE_TASK_EXECUTOR_MAX_WORKER_COUNT);
   }
 
-  // TODO(benvanik): support a threadless mode where we have one dummy worker
-  // that just holds the lists but is pumped from donate_caller.
-  if (worker_count == 0) {
-    return iree_make_status(
-        IREE_STATUS_UNIMPLEMENTED,
-        "threadless donate-only executor mode not yet implemented");
+  if (iree_all_bits_set(options.scheduling_mode,
+                        IREE_TASK_SCHEDULING_MODE_DRAIN_UNTIL_BLOCKED |
+                            IREE_TASK_SCHEDULING_MODE_WIDEST_FIRST)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "drain-until-blocked and widest-first scheduling "
+                            "modes are mutually exclusive");
   }
 
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_ASSERT_ARGUMENT(out_executor);
   *out_executor = NULL;
 
-  // The executor is followed in memory by worker[] + worker_local_memory[].
+  // Topologies with no groups produce a threadless executor: we still need a
+  // worker to hold the task queues but it will have no thread of its own and
+  // only be pumped by callers donating their threads. The worker is
+  // configured as if it were an unpinned group.
+  const bool threadless = worker_count == 0;
+  const iree_task_topology_node_id_t node_id = topology->node_id;
+  iree_task_topology_t threadless_topology;
+  if (threadless) {
+    iree_task_topology_initialize_from_group_count(1, &threadless_topology);
+    topology = &threadless_topology;
+    worker_count = 1;
+  }
+
+  // Executors with worker threads reserve donor workers that threads donated
+  // via iree_task_executor_donate_caller use to steal work. Donors may steal
+  // from any worker and get the largest local memory of any of them.
+  const iree_host_size_t donor_count =
+      threadless || IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR == 0
+          ? 0
+          : IREE_TASK_EXECUTOR_MAX_DONOR_COUNT;
+
+  // The executor is followed in memory by worker[] + worker_local_memory[]
+  // with the donors after the regular workers in each.
   iree_host_size_t total_worker_local_memory_size = 0;
+  iree_host_size_t donor_local_memory_size = 0;
   for (iree_host_size_t i = 0; i < worker_count; ++i) {
-    total_worker_local_memory_size +=
+    iree_host_size_t worker_local_memory_size =
         iree_task_topology_group_local_memory_size(
             options, iree_task_topology_get_group(topology, i));
+    total_worker_local_memory_size += worker_local_memory_size;
+    donor_local_memory_size =
+        iree_max(donor_local_memory_size, worker_local_memory_size);
   }
+  total_worker_local_memory_size += donor_count * donor_local_memory_size;
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)total_worker_local_memory_size);
 
   iree_host_size_t executor_base_size =
       iree_host_align(sizeof(iree_task_executor_t),
                       iree_hardware_destructive_interference_size);
-  iree_host_size_t worker_list_size =
-      iree_host_align(worker_count * sizeof(iree_task_worker_t),
-                      iree_hardware_destructive_interference_size);
+  iree_host_size_t worker_list_size = iree_host_align(
+      (worker_count + donor_count) * sizeof(iree_task_worker_t),
+      iree_hardware_destructive_interference_size);
   iree_host_size_t executor_size =
       executor_base_size + worker_list_size + total_worker_local_memory_size;
 
+  // Worker local memory is left untouched here so that each worker thread
+  // performs the first touch of its own memory after it has been pinned. On
+  // NUMA systems this places the pages on the node local to the worker.
   iree_task_executor_t* executor = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_allocator_malloc(allocator, executor_size, (void**)&executor));
-  memset(executor, 0, executor_size);
+      z0, iree_allocator_malloc_uninitialized(allocator, executor_size,
+                                              (void**)&executor));
+  memset(executor, 0, executor_base_size + worker_list_size);
   iree_atomic_ref_count_init(&executor->ref_count);
   executor->allocator = allocator;
   executor->scheduling_mode = options.scheduling_mode;
   executor->worker_spin_ns = options.worker_spin_ns;
+  if ((options.scheduling_mode & IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN) &&
+      executor->worker_spin_ns == IREE_DURATION_ZERO) {
+    executor->worker_spin_ns = IREE_TASK_WORKER_ADAPTIVE_SPIN_MAX_NS;
+  }
+  executor->threadless = threadless;
+  executor->node_id = node_id;
   iree_atomic_task_slist_initialize(&executor->incoming_ready_slist);
-  iree_slim_mutex_initialize(&executor->coordinator_mutex);
+  iree_atomic_store(&executor->coordinator_state, 0, iree_memory_order_release);
+  iree_slim_mutex_initialize(&executor->donation_mutex);
+#if IREE_NOTIFICATION_HAS_MASKED_WAKE
+  iree_notification_initialize(&executor->worker_wake_notification);
+#endif  // IREE_NOTIFICATION_HAS_MASKED_WAKE
 
   IREE_TRACE({
     static iree_atomic_int32_t executor_id = IREE_ATOMIC_VAR_INIT(0);
@@ -187,6 +231,16 @@ iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
       if (!iree_status_is_ok(status)) break;
     }
 
+    executor->donor_count = donor_count;
+    iree_atomic_store(&executor->donor_mask, 0, iree_memory_order_release);
+    for (iree_host_size_t i = 0; i < donor_count; ++i) {
+      iree_task_worker_initialize_donor(
+          executor, worker_count + i,
+          iree_make_byte_span(worker_local_memory, donor_local_memory_size),
+          &seed_prng, &executor->workers[worker_count + i]);
+      worker_local_memory += donor_local_memory_size;
+    }
+
     iree_atomic_task_affinity_set_store(&executor->worker_idle_mask,
                                         worker_mask, iree_memory_order_release);
     iree_atomic_task_affinity_set_store(&executor->worker_live_mask,
@@ -212,7 +266,10 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
 
   // First ask all workers to exit. We do this prior to waiting on them to exit
   // so that we parallelize the shutdown logic (which may flush pending tasks).
-  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+  // Donors have no threads and immediately transition to the zombie state.
+  const iree_host_size_t total_worker_count =
+      executor->worker_count + executor->donor_count;
+  for (iree_host_size_t i = 0; i < total_worker_count; ++i) {
     iree_task_worker_t* worker = &executor->workers[i];
     iree_task_worker_request_exit(worker);
   }
@@ -233,14 +290,17 @@ static void iree_task_executor_destroy(iree_task_executor_t* executor) {
   // Tear down all workers and the poller now that no more threads are live.
   // Any live threads may still be touching their own data structures or those
   // of others (for example when trying to steal work).
-  for (iree_host_size_t i = 0; i < executor->worker_count; ++i) {
+  for (iree_host_size_t i = 0; i < total_worker_count; ++i) {
     iree_task_worker_t* worker = &executor->workers[i];
     iree_task_worker_deinitialize(worker);
   }
   iree_task_poller_deinitialize(&executor->poller);
 
   iree_event_pool_free(executor->event_pool);
-  iree_slim_mutex_deinitialize(&executor->coordinator_mutex);
+#if IREE_NOTIFICATION_HAS_MASKED_WAKE
+  iree_notification_deinitialize(&executor->worker_wake_notification);
+#endif  // IREE_NOTIFICATION_HAS_MASKED_WAKE
+  iree_slim_mutex_deinitialize(&executor->donation_mutex);
   iree_atomic_task_slist_deinitialize(&executor->incoming_ready_slist);
   iree_task_pool_deinitialize(&executor->transient_task_pool);
   iree_allocator_free(executor->allocator, executor);
@@ -274,6 +334,50 @@ iree_host_size_t iree_task_executor_worker_count(
   return executor->worker_count;
 }
 
+iree_host_size_t iree_task_executor_worker_capacity(
+    iree_task_executor_t* executor) {
+  return executor->worker_count + executor->donor_count;
+}
+
+iree_task_topology_node_id_t iree_task_executor_node_id(
+    iree_task_executor_t* executor) {
+  return executor->node_id;
+}
+
+bool iree_task_executor_is_threadless(iree_task_executor_t* executor) {
+  return executor->threadless;
+}
+
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  const iree_host_size_t total_worker_count =
+      executor->worker_count + executor->donor_count;
+  for (iree_host_size_t i = 0; i < total_worker_count; ++i) {
+    iree_task_worker_accumulate_statistics(&executor->workers[i],
+                                           out_statistics);
+  }
+}
+
+iree_status_t iree_task_executor_query_worker_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    iree_task_executor_statistics_t* out_statistics) {
+  IREE_ASSERT_ARGUMENT(out_statistics);
+  memset(out_statistics, 0, sizeof(*out_statistics));
+  if (worker_index >= executor->worker_count + executor->donor_count) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "worker index %" PRIhsz
+                            " out of range of the executor capacity %" PRIhsz,
+                            worker_index,
+                            executor->worker_count + executor->donor_count);
+  }
+  iree_task_worker_accumulate_statistics(&executor->workers[worker_index],
+                                         out_statistics);
+  return iree_ok_status();
+}
+
 iree_event_pool_t* iree_task_executor_event_pool(
     iree_task_executor_t* executor) {
   return executor->event_pool;
@@ -298,7 +402,7 @@ iree_status_t iree_task_executor_acquire_fence(iree_task_executor_t* executor,
 // The task will be posted to the worker mailbox and available for the worker to
 // begin processing as soon as the |post_batch| is submitted.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 static void iree_task_executor_relay_to_worker(
     iree_task_executor_t* executor, iree_task_post_batch_t* post_batch,
     iree_task_t* task) {
@@ -307,6 +411,75 @@ static void iree_task_executor_relay_to_worker(
   iree_task_post_batch_enqueue(post_batch, worker_index, task);
 }
 
+// Returns the number of tiles |task| will fan out to when issued or 1 if the
+// task is not a dispatch (or is a dispatch that has already been issued).
+// Only valid to call on ready tasks as indirect dispatches will have their
+// workgroup count buffers read.
+static uint32_t iree_task_executor_task_width(iree_task_t* task) {
+  if (task->type != IREE_TASK_TYPE_DISPATCH ||
+      (task->flags & IREE_TASK_FLAG_DISPATCH_RETIRE)) {
+    return 1;
+  }
+  iree_task_dispatch_t* dispatch_task = (iree_task_dispatch_t*)task;
+  const uint32_t* workgroup_count =
+      (task->flags & IREE_TASK_FLAG_DISPATCH_INDIRECT)
+          ? dispatch_task->workgroup_count.ptr
+          : dispatch_task->workgroup_count.value;
+  uint64_t tile_count = (uint64_t)workgroup_count[0] * workgroup_count[1] *
+                        workgroup_count[2];
+  return (uint32_t)iree_min(tile_count, (uint64_t)UINT32_MAX);
+}
+
+// Merges two lists sorted by descending task width into |out_list|.
+// Stable: ties preserve the order of |lhs| before |rhs|.
+static void iree_task_executor_merge_by_width(iree_task_list_t* lhs,
+                                              iree_task_list_t* rhs,
+                                              iree_task_list_t* out_list) {
+  iree_task_list_initialize(out_list);
+  while (!iree_task_list_is_empty(lhs) && !iree_task_list_is_empty(rhs)) {
+    if (iree_task_executor_task_width(iree_task_list_front(rhs)) >
+        iree_task_executor_task_width(iree_task_list_front(lhs))) {
+      iree_task_list_push_back(out_list, iree_task_list_pop_front(rhs));
+    } else {
+      iree_task_list_push_back(out_list, iree_task_list_pop_front(lhs));
+    }
+  }
+  iree_task_list_append(out_list, lhs);
+  iree_task_list_append(out_list, rhs);
+}
+
+// Moves up to |count| tasks from the front of |list| to |out_list|.
+static void iree_task_executor_take_front(iree_task_list_t* list,
+                                          iree_host_size_t count,
+                                          iree_task_list_t* out_list) {
+  iree_task_list_initialize(out_list);
+  for (iree_host_size_t i = 0; i < count && !iree_task_list_is_empty(list);
+       ++i) {
+    iree_task_list_push_back(out_list, iree_task_list_pop_front(list));
+  }
+}
+
+// Stable sorts |list| such that the widest tasks are at the front.
+// This is a bottom-up merge sort over the intrusive list so that we don't need
+// any scratch memory; ready lists are usually short and hot in cache.
+static void iree_task_executor_sort_by_width(iree_task_list_t* list) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_host_size_t count = iree_task_list_calculate_size(list);
+  for (iree_host_size_t run_size = 1; run_size < count; run_size *= 2) {
+    iree_task_list_t sorted_list;
+    iree_task_list_initialize(&sorted_list);
+    while (!iree_task_list_is_empty(list)) {
+      iree_task_list_t lhs, rhs, merged_list;
+      iree_task_executor_take_front(list, run_size, &lhs);
+      iree_task_executor_take_front(list, run_size, &rhs);
+      iree_task_executor_merge_by_width(&lhs, &rhs, &merged_list);
+      iree_task_list_append(&sorted_list, &merged_list);
+    }
+    iree_task_list_move(&sorted_list, list);
+  }
+  IREE_TRACE_ZONE_END(z0);
+}
+
 // Schedules all ready tasks in the |pending_submission| list.
 // Task may enqueue zero or more new tasks (or newly-ready/waiting tasks) to
 // |pending_submission| or queue work for posting to workers via the
@@ -317,18 +490,27 @@ static void iree_task_executor_relay_to_worker(
 // least recently added tasks from the submission (nice in-order traversal) we
 // are pushing them as what will become the least recent tasks in the batch.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 void iree_task_executor_schedule_ready_tasks(
     iree_task_executor_t* executor, iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch) {
   IREE_TRACE_ZONE_BEGIN(z0);
+
+  // When optimizing for width we issue the widest tasks first so that they get
+  // first pick of the idle workers. Tasks readied during scheduling are pushed
+  // to the front of the list and issued immediately as they would be in other
+  // modes.
+  if (executor->scheduling_mode & IREE_TASK_SCHEDULING_MODE_WIDEST_FIRST) {
+    iree_task_executor_sort_by_width(&pending_submission->ready_list);
+  }
+
   iree_task_t* task = NULL;
   while ((task = iree_task_list_pop_front(&pending_submission->ready_list))) {
-    // If the scope has been marked as failing then we abort the task.
-    // This needs to happen as a poll here because one or more of the tasks we
-    // are joining may have failed.
+    // If the scope has been marked as failing (or has been cancelled by its
+    // deadline elapsing) then we abort the task. This needs to happen as a poll
+    // here because one or more of the tasks we are joining may have failed.
     if (IREE_UNLIKELY(!task->scope ||
-                      iree_task_scope_has_failed(task->scope))) {
+                      iree_task_scope_is_cancelled(task->scope))) {
       iree_task_list_t discard_worklist;
       iree_task_list_initialize(&discard_worklist);
       iree_task_discard(task, &discard_worklist);
@@ -431,14 +613,57 @@ void iree_task_executor_flush(iree_task_executor_t* executor) {
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Bits of the executor coordinator_state.
+enum iree_task_executor_coordinator_state_bits_t {
+  // A thread is acting as the coordinator.
+  IREE_TASK_EXECUTOR_COORDINATOR_STATE_ACTIVE = 1u << 0,
+  // Another thread requested coordination while the coordinator was active and
+  // the coordinator must perform another pass before stopping.
+  IREE_TASK_EXECUTOR_COORDINATOR_STATE_REQUESTED = 1u << 1,
+};
+
+// Tries to make the calling thread the active coordinator.
+// Returns false if another thread is already coordinating; in that case it has
+// been asked to perform another pass on behalf of the caller and will observe
+// any submissions made by the caller prior to this call.
+static bool iree_task_executor_try_begin_coordination(
+    iree_task_executor_t* executor) {
+  int32_t state =
+      iree_atomic_load(&executor->coordinator_state, iree_memory_order_relaxed);
+  while (true) {
+    if (state & IREE_TASK_EXECUTOR_COORDINATOR_STATE_ACTIVE) {
+      if (iree_atomic_compare_exchange_weak(
+              &executor->coordinator_state, &state,
+              state | IREE_TASK_EXECUTOR_COORDINATOR_STATE_REQUESTED,
+              iree_memory_order_acq_rel, iree_memory_order_relaxed)) {
+        return false;
+      }
+    } else if (iree_atomic_compare_exchange_weak(
+                   &executor->coordinator_state, &state,
+                   IREE_TASK_EXECUTOR_COORDINATOR_STATE_ACTIVE,
+                   iree_memory_order_acquire, iree_memory_order_relaxed)) {
+      return true;
+    }
+  }
+}
+
+// Stops acting as the coordinator. Returns true if another thread requested
+// coordination while the caller was active and another pass is required.
+static bool iree_task_executor_end_coordination(
+    iree_task_executor_t* executor) {
+  int32_t state = iree_atomic_exchange(&executor->coordinator_state, 0,
+                                       iree_memory_order_acq_rel);
+  return (state & IREE_TASK_EXECUTOR_COORDINATOR_STATE_REQUESTED) != 0;
+}
+
 // Dispatches tasks in the global submission queue to workers.
 // This is called by users upon submission of new tasks or by workers when they
 // run out of tasks to process. If |current_worker| is provided then tasks will
 // prefer to be routed back to it for immediate processing.
 //
-// If a coordination run ends up with no ready tasks and |current_worker| is
-// provided the calling thread will enter a wait until the worker has more tasks
-// posted to it.
+// Coordination never blocks: if another thread is already coordinating the
+// call returns immediately and that thread performs another pass on behalf of
+// the caller before it stops coordinating.
 void iree_task_executor_coordinate(iree_task_executor_t* executor,
                                    iree_task_worker_t* current_worker) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -449,10 +674,14 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
   bool schedule_dirty = true;
   do {
     IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_task_executor_coordinate_try");
-    // TODO(#10212): remove this lock or do something more clever to avoid
-    // contention when many workers try to coordinate at the same time. This can
-    // create very long serialized lock chains that slow down worker wakes.
-    iree_slim_mutex_lock(&executor->coordinator_mutex);
+    // Only one thread coordinates at a time. Instead of forming serialized lock
+    // chains when many threads submit or go idle at once the others leave
+    // their work for the active coordinator and continue on.
+    if (!iree_task_executor_try_begin_coordination(executor)) {
+      IREE_TRACE_ZONE_APPEND_TEXT(z1, "deferred");
+      IREE_TRACE_ZONE_END(z1);
+      break;
+    }
 
     // Check for incoming submissions and move their posted tasks into our
     // local lists. Any of the tasks here are ready to execute immediately and
@@ -474,9 +703,11 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     iree_task_submission_initialize_from_lifo_slist(
         &executor->incoming_ready_slist, &pending_submission);
     if (iree_task_list_is_empty(&pending_submission.ready_list)) {
-      iree_slim_mutex_unlock(&executor->coordinator_mutex);
+      // Nothing to do but we still need to check the incoming list again if
+      // anyone submitted work while we were active.
+      schedule_dirty = iree_task_executor_end_coordination(executor);
       IREE_TRACE_ZONE_END(z1);
-      break;
+      continue;
     }
 
     // Scratch coordinator submission batch used during scheduling to batch up
@@ -499,12 +730,14 @@ void iree_task_executor_coordinate(iree_task_executor_t* executor,
     iree_task_poller_enqueue(&executor->poller,
                              &pending_submission.waiting_list);
 
-    iree_slim_mutex_unlock(&executor->coordinator_mutex);
+    const bool coordination_requested =
+        iree_task_executor_end_coordination(executor);
     IREE_TRACE_ZONE_END(z1);
 
     // Post all new work to workers; they may wake and begin executing
     // immediately. Returns whether this worker has new tasks for it to work on.
-    schedule_dirty = iree_task_post_batch_submit(post_batch);
+    schedule_dirty =
+        iree_task_post_batch_submit(post_batch) || coordination_requested;
   } while (schedule_dirty);
 
   IREE_TRACE_ZONE_END(z0);
@@ -622,20 +855,67 @@ iree_task_t* iree_task_executor_try_steal_task(
   return task;
 }
 
+// Acquires an unused donor worker for the calling thread to act as.
+// Returns NULL if all donors are currently acquired by other threads.
+static iree_task_worker_t* iree_task_executor_acquire_donor(
+    iree_task_executor_t* executor) {
+  const int32_t all_donor_bits = (int32_t)((1u << executor->donor_count) - 1);
+  int32_t donor_mask =
+      iree_atomic_load(&executor->donor_mask, iree_memory_order_relaxed);
+  int32_t donor_bit = 0;
+  do {
+    int32_t free_mask = ~donor_mask & all_donor_bits;
+    if (!free_mask) return NULL;
+    donor_bit = free_mask & -free_mask;
+  } while (!iree_atomic_compare_exchange_weak(
+      &executor->donor_mask, &donor_mask, donor_mask | donor_bit,
+      iree_memory_order_acquire, iree_memory_order_relaxed));
+  int donor_index = iree_math_count_trailing_zeros_u32((uint32_t)donor_bit);
+  return &executor->workers[executor->worker_count + donor_index];
+}
+
+// Releases a |donor| acquired with iree_task_executor_acquire_donor.
+static void iree_task_executor_release_donor(iree_task_executor_t* executor,
+                                             iree_task_worker_t* donor) {
+  iree_host_size_t donor_index =
+      (iree_host_size_t)(donor - executor->workers) - executor->worker_count;
+  iree_atomic_fetch_and(&executor->donor_mask, ~(int32_t)(1u << donor_index),
+                        iree_memory_order_release);
+}
+
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
                                                iree_timeout_t timeout) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // Threadless executors only make progress when callers donate themselves and
+  // the caller must act as the worker until the wait source resolves.
+  if (executor->threadless) {
+    iree_status_t status = iree_task_worker_pump_until_resolved(
+        &executor->workers[0], wait_source,
+        iree_timeout_as_deadline_ns(timeout));
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  }
+
   // Perform an immediate flush/coordination (in case the caller queued).
   iree_task_executor_flush(executor);
 
-  // Wait until completed.
-  // TODO(benvanik): make this steal tasks until wait_handle resolves?
-  // Somewhat dangerous as we don't know what kind of thread we are running on;
-  // it may have a smaller stack than we are expecting or have some weird thread
-  // local state (FPU rounding modes/etc).
-  iree_status_t status = iree_wait_source_wait_one(wait_source, timeout);
+  // Join the workers by stealing tasks from them until the wait resolves.
+  // Polls don't steal as they'd block the caller for however long it takes to
+  // execute the stolen tasks.
+  iree_task_worker_t* donor = iree_timeout_is_immediate(timeout)
+                                  ? NULL
+                                  : iree_task_executor_acquire_donor(executor);
+  iree_status_t status = iree_ok_status();
+  if (donor) {
+    status = iree_task_worker_steal_until_resolved(
+        donor, wait_source, iree_timeout_as_deadline_ns(timeout));
+    iree_task_executor_release_donor(executor, donor);
+  } else {
+    // No donor available (or only polling); wait until completed.
+    status = iree_wait_source_wait_one(wait_source, timeout);
+  }
 
   IREE_TRACE_ZONE_END(z0);
   return status;
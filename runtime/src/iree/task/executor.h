@@ -251,20 +251,48 @@ extern "C" {
 
 // A bitfield specifying the scheduling mode used for configuring how (or if)
 // work is balanced across queues.
+//
+// The default mode (no bits set) distributes ready tasks breadth-first: tasks
+// are routed back to the worker that readied them if it has nothing else
+// pending in the batch and otherwise spread across idle workers. The other
+// modes trade that balance for either locality or width.
+//
+// TODO(benvanik): round-robin, FCFS, SJF, etc. We can also allow for custom
+// scheduling, though I'm skeptical of the value of that. We should look into
+// what GPUs do in hardware for balancing things (if anything this
+// sophisticated at all). There are other more interesting scheduling
+// strategies such as artificially limiting which tasks we allow through to
+// keep certain CPU cores asleep unless absolutely required.
 enum iree_task_scheduling_mode_bits_t {
-  // TODO(benvanik): batch, round-robin, FCFS, SJF, etc.
-  // We can also allow for custom scheduling, though I'm skeptical of the value
-  // of that. We should look into what GPUs do in hardware for balancing things
-  // (if anything this sophisticated at all). The potential benefit here is that
-  // we can optimize for offline workloads by allowing each queue to be drained
-  // until blocking - hopefully optimizing cache coherency and reducing the
-  // total memory high-water mark - or optimize for latency across all queues by
-  // taking tasks from all queues equally. There are other more interesting
-  // scheduling strategies such as preferring the widest tasks available from
-  // any queue such that we are keeping as many workers active as possible to
-  // reach peak utilization or artificially limiting which tasks we allow
-  // through to keep certain CPU cores asleep unless absolutely required.
-  IREE_TASK_SCHEDULING_MODE_RESERVED = 0u,
+  // Default breadth-first scheduling across all queues.
+  IREE_TASK_SCHEDULING_MODE_DEFAULT = 0u,
+  // Deprecated alias of IREE_TASK_SCHEDULING_MODE_DEFAULT.
+  IREE_TASK_SCHEDULING_MODE_RESERVED = IREE_TASK_SCHEDULING_MODE_DEFAULT,
+
+  // Drains each worker queue until it blocks before spilling work to other
+  // workers. Tasks readied on a worker are always kept on that worker when its
+  // affinity allows and otherwise are routed to workers that are already awake
+  // before any idle workers are woken. This optimizes offline/batch workloads
+  // for cache locality and a reduced total memory high-water mark at the cost
+  // of latency as fewer workers are kept active. Work stealing still balances
+  // the load if queues grow deep.
+  IREE_TASK_SCHEDULING_MODE_DRAIN_UNTIL_BLOCKED = 1u << 0,
+
+  // Prefers issuing the widest tasks available (those with the most tiles)
+  // before any others and spreads work across idle workers before routing it
+  // back to the coordinating worker. This keeps as many workers active as
+  // possible to reach peak utilization and optimizes for latency across all
+  // queues at the cost of more wakes and cross-thread traffic.
+  IREE_TASK_SCHEDULING_MODE_WIDEST_FIRST = 1u << 1,
+
+  // Workers learn the typical time between going idle and being woken with
+  // new work and only spin before parking when work is likely to arrive within
+  // the spin budget. This lowers the wake latency of bursty workloads with
+  // short gaps between submissions (such as per-token decode steps) without
+  // burning power spinning through long idle periods. worker_spin_ns bounds
+  // the spin duration and IREE_TASK_WORKER_ADAPTIVE_SPIN_MAX_NS is used if it
+  // is zero. May be combined with any other mode.
+  IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN = 1u << 2,
 };
 typedef uint32_t iree_task_scheduling_mode_t;
 
@@ -285,7 +313,9 @@ typedef struct iree_task_executor_options_t {
   // additional work. In almost all cases this should be IREE_DURATION_ZERO as
   // spinning is often extremely harmful to system health. Only set to non-zero
   // values when latency is the #1 priority (over thermals, system-wide
-  // scheduling, and the environment).
+  // scheduling, and the environment). When
+  // IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN is set this is the upper bound of
+  // the learned spin duration.
   iree_duration_t worker_spin_ns;
 
   // Minimum size in bytes of each worker thread stack.
@@ -317,6 +347,12 @@ typedef struct iree_task_executor_t iree_task_executor_t;
 // callers and then overridden as required.
 // |topology| is only used during creation and need not live beyond this call.
 // |out_executor| must be released by the caller.
+//
+// If |topology| has no groups the executor is created in threadless mode: no
+// worker threads are created and tasks only execute on threads donated with
+// iree_task_executor_donate_caller. This avoids all cross-thread hops for
+// callers that submit work and then immediately wait on it. Note that waits
+// performed by wait tasks are still serviced by the executor poller thread.
 iree_status_t iree_task_executor_create(iree_task_executor_options_t options,
                                         const iree_task_topology_t* topology,
                                         iree_allocator_t allocator,
@@ -336,6 +372,76 @@ void iree_task_executor_trim(iree_task_executor_t* executor);
 iree_host_size_t iree_task_executor_worker_count(
     iree_task_executor_t* executor);
 
+// Returns the total number of worker indices that may be used by tasks
+// executing on |executor|. This includes the worker threads and the donors
+// used by threads donated with iree_task_executor_donate_caller; all worker
+// indices passed to tasks are in [worker_base_index, worker_base_index +
+// capacity). Use this and not iree_task_executor_worker_count when
+// preallocating per-worker storage.
+iree_host_size_t iree_task_executor_worker_capacity(
+    iree_task_executor_t* executor);
+
+// Returns the NUMA node the |executor| workers are located on as defined by
+// the topology the executor was created with or IREE_TASK_TOPOLOGY_NODE_ID_ANY
+// if the workers are unpinned or span multiple nodes.
+iree_task_topology_node_id_t iree_task_executor_node_id(
+    iree_task_executor_t* executor);
+
+// Returns true if |executor| owns no worker threads and only makes progress
+// while callers are donated with iree_task_executor_donate_caller. Any thread
+// that waits on work submitted to a threadless executor must donate itself
+// instead of performing a system wait or the work will never complete.
+bool iree_task_executor_is_threadless(iree_task_executor_t* executor);
+
+// Number of buckets in iree_task_executor_statistics_t::tile_histogram.
+// Bucket 0 counts tiles that took less than 1024ns and each bucket i > 0 counts
+// tiles that took [2^(9+i), 2^(10+i)) ns. The last bucket also counts all tiles
+// that took longer than its range.
+#define IREE_TASK_EXECUTOR_TILE_HISTOGRAM_BUCKET_COUNT 16
+
+// Counters accumulated by workers as they execute tasks.
+// These are always maintained when IREE_STATISTICS_ENABLE is set and compiled
+// out (reading as zeros) otherwise. Times are in nanoseconds. Counters are
+// updated without synchronization and a query may observe a tear across fields.
+typedef struct iree_task_executor_statistics_t {
+  // Total number of tasks executed (calls and dispatch shards).
+  int64_t tasks_executed;
+  // Total number of dispatch tiles executed.
+  int64_t tiles_executed;
+  // Total time spent executing dispatch shards.
+  int64_t tile_time_ns;
+  // Number of times a worker ran out of work and tried to steal from others.
+  int64_t steal_attempts;
+  // Number of steal attempts that found work.
+  int64_t steal_successes;
+  // Number of times a worker returned from an idle wait because it was woken.
+  int64_t wakeups;
+  // Number of wake requests observed by workers and the total time between
+  // the request being made and the worker observing it.
+  int64_t wake_requests;
+  int64_t wake_latency_ns;
+  // Total time idle workers spent spinning before sleeping and the total time
+  // spent sleeping in the kernel. The split is estimated from the configured
+  // worker spin duration.
+  int64_t spin_time_ns;
+  int64_t sleep_time_ns;
+  // Histogram of the average time taken per tile by each dispatch shard,
+  // weighted by the number of tiles the shard executed.
+  int64_t tile_histogram[IREE_TASK_EXECUTOR_TILE_HISTOGRAM_BUCKET_COUNT];
+} iree_task_executor_statistics_t;
+
+// Queries the aggregate statistics of all workers and donors of |executor|
+// since it was created. Thread-safe but the results may be slightly stale.
+void iree_task_executor_query_statistics(
+    iree_task_executor_t* executor,
+    iree_task_executor_statistics_t* out_statistics);
+
+// Queries the statistics of the worker with the executor-local |worker_index|
+// in [0, iree_task_executor_worker_capacity).
+iree_status_t iree_task_executor_query_worker_statistics(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    iree_task_executor_statistics_t* out_statistics);
+
 // Returns an iree_event_t pool managed by the executor.
 // Users of the task system should acquire their transient events from this.
 // Long-lived events should be allocated on their own in order to avoid
@@ -402,6 +508,25 @@ void iree_task_executor_flush(iree_task_executor_t* executor);
 // Especially in large applications it's almost certainly better to do something
 // useful with the calling thread (even if that's go to sleep).
 //
+// Executors with worker threads let up to IREE_TASK_EXECUTOR_MAX_DONOR_COUNT
+// callers at a time join the workers: each steals tasks (such as dispatch
+// tiles) queued on the workers and executes them on the calling thread with
+// its own worker index and local memory. Tasks are stolen in batches and the
+// batch is always completed before checking |wait_source| so the caller may
+// return some time after it resolves. Callers donating when all donors are in
+// use or with an immediate timeout wait without stealing. As with workers the
+// FPU state is set for the duration of the donation but tasks run on the
+// caller's stack and callers must have sufficient stack space to execute them.
+//
+// Threadless executors (see iree_task_executor_is_threadless) rely entirely on
+// donation: the caller acts as the only worker and executes all ready tasks
+// until |wait_source| resolves. Only one thread at a time may act as the
+// worker and any other donated threads sleep as though there were no work. If
+// the caller runs out of work before |wait_source| resolves it sleeps until
+// more work is posted to the executor, polling |wait_source| at least every
+// IREE_TASK_EXECUTOR_DONATION_POLL_INTERVAL_NS so that resolutions from other
+// threads are observed.
+//
 // Safe to call from any thread (though bad to reentrantly call from workers).
 iree_status_t iree_task_executor_donate_caller(iree_task_executor_t* executor,
                                                iree_wait_source_t wait_source,
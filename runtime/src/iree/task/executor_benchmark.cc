@@ -0,0 +1,113 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include <cstddef>
+
+#include "benchmark/benchmark.h"
+#include "iree/base/api.h"
+#include "iree/task/executor.h"
+#include "iree/task/scope.h"
+#include "iree/task/submission.h"
+#include "iree/task/task.h"
+
+namespace {
+
+// Executor shared by all benchmark threads so that they contend on submission
+// and coordination as many request threads sharing one device would.
+iree_task_executor_t* GetSharedExecutor() {
+  static iree_task_executor_t* executor = ([]() -> iree_task_executor_t* {
+    iree_task_executor_options_t options;
+    iree_task_executor_options_initialize(&options);
+    options.worker_local_memory_size = 64 * 1024;
+    iree_task_topology_t topology;
+    iree_task_topology_initialize_from_group_count(/*group_count=*/4,
+                                                   &topology);
+    iree_task_executor_t* executor = NULL;
+    IREE_CHECK_OK(iree_task_executor_create(
+        options, &topology, iree_allocator_system(), &executor));
+    iree_task_topology_deinitialize(&topology);
+    return executor;
+  })();
+  return executor;
+}
+
+//==============================================================================
+// Concurrent submission
+//==============================================================================
+
+// Each thread repeatedly submits a small call + fence to the shared executor
+// and waits for it to complete. Throughput should scale with the thread count
+// until the workers are saturated instead of being bound by coordination.
+void BM_ConcurrentSubmit(benchmark::State& state) {
+  iree_task_executor_t* executor = GetSharedExecutor();
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("benchmark"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+  for (auto _ : state) {
+    iree_task_call_t call;
+    iree_task_call_initialize(
+        &scope,
+        iree_task_make_call_closure(
+            [](void* user_context, iree_task_t* task,
+               iree_task_submission_t* pending_submission) {
+              benchmark::DoNotOptimize(user_context);
+              return iree_ok_status();
+            },
+            NULL),
+        &call);
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&call.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &call.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+  iree_task_scope_deinitialize(&scope);
+}
+BENCHMARK(BM_ConcurrentSubmit)->UseRealTime()->ThreadRange(1, 32);
+
+// Each thread repeatedly submits a small dispatch and waits for it to
+// complete. Dispatches require coordination both to issue the shards and to
+// retire the dispatch once they complete.
+void BM_ConcurrentDispatch(benchmark::State& state) {
+  iree_task_executor_t* executor = GetSharedExecutor();
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("benchmark"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {8, 1, 1};
+  for (auto _ : state) {
+    iree_task_dispatch_t dispatch;
+    iree_task_dispatch_initialize(
+        &scope,
+        iree_task_make_dispatch_closure(
+            [](void* user_context, const iree_task_tile_context_t* tile_context,
+               iree_task_submission_t* pending_submission) {
+              benchmark::DoNotOptimize(tile_context->workgroup_xyz);
+              return iree_ok_status();
+            },
+            NULL),
+        workgroup_size, workgroup_count, &dispatch);
+    iree_task_fence_t* fence = NULL;
+    IREE_CHECK_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+    iree_task_submission_t submission;
+    iree_task_submission_initialize(&submission);
+    iree_task_submission_enqueue(&submission, &dispatch.header);
+    iree_task_executor_submit(executor, &submission);
+    iree_task_executor_flush(executor);
+    IREE_CHECK_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  }
+  iree_task_scope_deinitialize(&scope);
+}
+BENCHMARK(BM_ConcurrentDispatch)->UseRealTime()->ThreadRange(1, 32);
+
+}  // namespace
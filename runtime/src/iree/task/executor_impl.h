@@ -34,12 +34,18 @@ struct iree_task_executor_t {
   // process and can be used for IREE_TRACE plotting/allocation calls.
   IREE_TRACE(const char* trace_name;)
 
+  // NUMA node the executor workers are pinned to or
+  // IREE_TASK_TOPOLOGY_NODE_ID_ANY if unpinned or spanning multiple nodes.
+  iree_task_topology_node_id_t node_id;
+
   // Defines how work is selected across queues.
-  // TODO(benvanik): make mutable; currently always the same reserved value.
+  // See iree_task_scheduling_mode_bits_t for the available modes.
+  // TODO(benvanik): make mutable; currently fixed at creation time.
   iree_task_scheduling_mode_t scheduling_mode;
 
   // Time each worker should spin before parking itself to wait for more work.
-  // IREE_DURATION_ZERO is used to disable spinning.
+  // IREE_DURATION_ZERO is used to disable spinning. With
+  // IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN this is the maximum spin duration.
   iree_duration_t worker_spin_ns;
 
   // State used by the work-stealing operations performed by donated threads.
@@ -84,8 +90,10 @@ struct iree_task_executor_t {
   iree_event_pool_t* event_pool;
 
   // Guards coordination logic; only one thread at a time may be acting as the
-  // coordinator.
-  iree_slim_mutex_t coordinator_mutex;
+  // coordinator (iree_task_executor_coordinator_state_bits_t). Threads that
+  // need coordination while another is coordinating flag a request that the
+  // active coordinator handles before it stops instead of blocking.
+  iree_atomic_int32_t coordinator_state;
 
   // Wait task polling and wait thread manager.
   // This handles all system waits so that we can keep the syscalls off the
@@ -116,6 +124,14 @@ struct iree_task_executor_t {
   // comment on worker_live_mask.
   iree_atomic_task_affinity_set_t worker_idle_mask;
 
+#if IREE_NOTIFICATION_HAS_MASKED_WAKE
+  // Notification shared by all workers waiting for new work. Each worker waits
+  // with a mask derived from its worker bit so that wakes for any subset of
+  // workers can be performed with a single system call (see
+  // iree_task_worker_wake_set).
+  iree_notification_t worker_wake_notification;
+#endif  // IREE_NOTIFICATION_HAS_MASKED_WAKE
+
   // Base value added to each executor-local worker index.
   // This allows workers to uniquely identify themselves in multi-executor
   // configurations.
@@ -126,6 +142,25 @@ struct iree_task_executor_t {
   // live join/leave behavior we could change this to a registration mechanism.
   iree_host_size_t worker_count;
   iree_task_worker_t* workers;  // [worker_count]
+
+  // True if the executor owns no worker threads. A single worker without a
+  // thread holds the task queues and it is pumped only by threads donated via
+  // iree_task_executor_donate_caller.
+  bool threadless;
+
+  // Guards the threadless worker such that only one donated thread at a time
+  // may be acting as it. Unused when the executor owns its worker threads.
+  iree_slim_mutex_t donation_mutex;
+
+  // Number of thread-less donor workers following the regular workers in
+  // |workers| (at workers[worker_count + i]). Threads donated with
+  // iree_task_executor_donate_caller acquire a donor and act as it while
+  // stealing tasks from the regular workers. Donors are not part of any worker
+  // set and nothing is ever posted to them. Always 0 for threadless executors.
+  iree_host_size_t donor_count;
+
+  // A bitmask indicating which donors are currently acquired by a thread.
+  iree_atomic_int32_t donor_mask;
 };
 
 // Merges a submission into the primary FIFO queues.
@@ -137,7 +172,7 @@ void iree_task_executor_merge_submission(iree_task_executor_t* executor,
                                          iree_task_submission_t* submission);
 
 // Schedules all ready tasks in the |pending_submission| list.
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 void iree_task_executor_schedule_ready_tasks(
     iree_task_executor_t* executor, iree_task_submission_t* pending_submission,
     iree_task_post_batch_t* post_batch);
@@ -6,7 +6,9 @@
 
 #include "iree/task/executor.h"
 
+#include <atomic>
 #include <cstddef>
+#include <thread>
 
 #include "iree/testing/gtest.h"
 #include "iree/testing/status_matchers.h"
@@ -135,4 +137,296 @@ TEST(ExecutorTest, SubmissionStress) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Tests that executors created with each scheduling mode correctly execute a
+// mix of independent dispatches of varying widths joined by a barrier.
+class ExecutorSchedulingModeTest
+    : public ::testing::TestWithParam<iree_task_scheduling_mode_t> {};
+
+TEST_P(ExecutorSchedulingModeTest, IndependentDispatches) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.scheduling_mode = GetParam();
+  options.worker_local_memory_size = 64 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/4, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  static std::atomic<uint32_t> tile_count = {0};
+  tile_count = 0;
+  auto tile_fn = [](void* user_context,
+                    const iree_task_tile_context_t* tile_context,
+                    iree_task_submission_t* pending_submission) {
+    ++tile_count;
+    return iree_ok_status();
+  };
+
+  // Dispatches are ordered narrowest to widest so that widest-first scheduling
+  // has something to reorder.
+  static const uint32_t kDispatchCount = 8;
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  iree_task_dispatch_t dispatches[kDispatchCount];
+  iree_task_t* dispatch_tasks[kDispatchCount];
+  uint32_t expected_tile_count = 0;
+  for (uint32_t i = 0; i < kDispatchCount; ++i) {
+    const uint32_t workgroup_count[3] = {i + 1, 2 * i + 1, 1};
+    expected_tile_count += workgroup_count[0] * workgroup_count[1];
+    iree_task_dispatch_initialize(
+        &scope, iree_task_make_dispatch_closure(tile_fn, NULL), workgroup_size,
+        workgroup_count, &dispatches[i]);
+    dispatch_tasks[i] = &dispatches[i].header;
+  }
+
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_barrier_t barrier;
+  iree_task_barrier_initialize_empty(&scope, &barrier);
+  iree_task_set_completion_task(&barrier.header, &fence->header);
+  for (uint32_t i = 0; i < kDispatchCount; ++i) {
+    iree_task_set_completion_task(dispatch_tasks[i], &barrier.header);
+  }
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  for (uint32_t i = 0; i < kDispatchCount; ++i) {
+    iree_task_submission_enqueue(&submission, dispatch_tasks[i]);
+  }
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  IREE_ASSERT_OK(iree_task_scope_wait_idle(&scope, IREE_TIME_INFINITE_FUTURE));
+  EXPECT_EQ(tile_count, expected_tile_count);
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+INSTANTIATE_TEST_SUITE_P(
+    AllModes, ExecutorSchedulingModeTest,
+    ::testing::Values(IREE_TASK_SCHEDULING_MODE_DEFAULT,
+                      IREE_TASK_SCHEDULING_MODE_DRAIN_UNTIL_BLOCKED,
+                      IREE_TASK_SCHEDULING_MODE_WIDEST_FIRST,
+                      IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN,
+                      IREE_TASK_SCHEDULING_MODE_DRAIN_UNTIL_BLOCKED |
+                          IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN));
+
+// Tests that conflicting scheduling modes are rejected.
+TEST(ExecutorTest, ConflictingSchedulingModes) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.scheduling_mode = IREE_TASK_SCHEDULING_MODE_DRAIN_UNTIL_BLOCKED |
+                            IREE_TASK_SCHEDULING_MODE_WIDEST_FIRST;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  iree_status_t status = iree_task_executor_create(
+      options, &topology, iree_allocator_system(), &executor);
+  EXPECT_EQ(iree_status_code(status), IREE_STATUS_INVALID_ARGUMENT);
+  iree_status_ignore(status);
+  EXPECT_EQ(executor, nullptr);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that an empty topology creates a threadless executor.
+// Tests that a thread donated to an executor with workers steals tasks that
+// are queued on a busy worker instead of only waiting.
+TEST(ExecutorTest, DonationStealsWork) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize_from_group_count(/*group_count=*/1, &topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  EXPECT_FALSE(iree_task_executor_is_threadless(executor));
+  EXPECT_GT(iree_task_executor_worker_capacity(executor),
+            iree_task_executor_worker_count(executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  // The blocking call occupies the only worker until the stolen call runs.
+  static std::atomic<bool> blocking_call_started = {false};
+  static std::atomic<bool> stolen_call_completed = {false};
+  static std::thread::id stolen_call_thread_id;
+  blocking_call_started = false;
+  stolen_call_completed = false;
+  iree_task_call_t blocking_call;
+  iree_task_call_initialize(
+      &scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            blocking_call_started = true;
+            while (!stolen_call_completed) std::this_thread::yield();
+            return iree_ok_status();
+          },
+          NULL),
+      &blocking_call);
+  iree_task_call_t stolen_call;
+  iree_task_call_initialize(
+      &scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            stolen_call_thread_id = std::this_thread::get_id();
+            stolen_call_completed = true;
+            return iree_ok_status();
+          },
+          NULL),
+      &stolen_call);
+  iree_task_t* calls[2] = {&blocking_call.header, &stolen_call.header};
+  for (iree_task_t* call : calls) {
+    iree_task_fence_t* fence = NULL;
+    IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+    iree_task_set_completion_task(call, &fence->header);
+  }
+
+  // Submit the stolen call only once the worker is busy so that it remains
+  // queued on the worker until it is stolen.
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &blocking_call.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+  while (!blocking_call_started) std::this_thread::yield();
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &stolen_call.header);
+  iree_task_executor_submit(executor, &submission);
+
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+  EXPECT_EQ(stolen_call_thread_id, std::this_thread::get_id());
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+TEST(ExecutorTest, ThreadlessLifetime) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  EXPECT_TRUE(iree_task_executor_is_threadless(executor));
+  EXPECT_EQ(iree_task_executor_worker_count(executor), 1);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that threadless executors only execute tasks on the donated thread.
+TEST(ExecutorTest, ThreadlessDonation) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  options.worker_local_memory_size = 64 * 1024;
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  // A call that fans out to a dispatch so that tasks readied during execution
+  // are also coordinated on the donated thread.
+  static std::thread::id call_thread_id;
+  static std::atomic<uint32_t> tile_count = {0};
+  tile_count = 0;
+  iree_task_call_t call;
+  iree_task_call_initialize(
+      &scope,
+      iree_task_make_call_closure(
+          [](void* user_context, iree_task_t* task,
+             iree_task_submission_t* pending_submission) {
+            call_thread_id = std::this_thread::get_id();
+            return iree_ok_status();
+          },
+          NULL),
+      &call);
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {4, 3, 2};
+  iree_task_dispatch_t dispatch;
+  iree_task_dispatch_initialize(
+      &scope,
+      iree_task_make_dispatch_closure(
+          [](void* user_context, const iree_task_tile_context_t* tile_context,
+             iree_task_submission_t* pending_submission) {
+            ++tile_count;
+            return iree_ok_status();
+          },
+          NULL),
+      workgroup_size, workgroup_count, &dispatch);
+  iree_task_set_completion_task(&call.header, &dispatch.header);
+  iree_task_fence_t* fence = NULL;
+  IREE_ASSERT_OK(iree_task_executor_acquire_fence(executor, &scope, &fence));
+  iree_task_set_completion_task(&dispatch.header, &fence->header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &call.header);
+  iree_task_executor_submit(executor, &submission);
+  iree_task_executor_flush(executor);
+
+  // Nothing can make progress until we donate.
+  EXPECT_FALSE(iree_task_scope_is_idle(&scope));
+  IREE_ASSERT_OK(iree_task_executor_donate_caller(
+      executor, iree_task_scope_await_idle(&scope), iree_infinite_timeout()));
+  EXPECT_EQ(call_thread_id, std::this_thread::get_id());
+  EXPECT_EQ(tile_count, 4 * 3 * 2);
+
+#if IREE_STATISTICS_ENABLE
+  // All work executed on the single threadless worker.
+  iree_task_executor_statistics_t statistics;
+  iree_task_executor_query_statistics(executor, &statistics);
+  EXPECT_GE(statistics.tasks_executed, 2);
+  EXPECT_EQ(statistics.tiles_executed, 4 * 3 * 2);
+  int64_t histogram_tile_count = 0;
+  for (int64_t bucket_count : statistics.tile_histogram) {
+    histogram_tile_count += bucket_count;
+  }
+  EXPECT_EQ(histogram_tile_count, 4 * 3 * 2);
+  iree_task_executor_statistics_t worker_statistics;
+  IREE_ASSERT_OK(iree_task_executor_query_worker_statistics(
+      executor, /*worker_index=*/0, &worker_statistics));
+  EXPECT_EQ(worker_statistics.tiles_executed, statistics.tiles_executed);
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_OUT_OF_RANGE,
+      iree_task_executor_query_worker_statistics(
+          executor, iree_task_executor_worker_capacity(executor),
+          &worker_statistics));
+#endif  // IREE_STATISTICS_ENABLE
+
+  iree_task_scope_deinitialize(&scope);
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
+// Tests that donating to a threadless executor times out if the wait source
+// never resolves.
+TEST(ExecutorTest, ThreadlessDonationTimeout) {
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  iree_task_executor_t* executor = NULL;
+  IREE_ASSERT_OK(iree_task_executor_create(options, &topology,
+                                           iree_allocator_system(), &executor));
+  IREE_EXPECT_STATUS_IS(
+      IREE_STATUS_DEADLINE_EXCEEDED,
+      iree_task_executor_donate_caller(
+          executor, iree_wait_source_delay(IREE_TIME_INFINITE_FUTURE),
+          iree_make_timeout_ms(5)));
+  iree_task_executor_release(executor);
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
@@ -49,9 +49,49 @@ static iree_host_size_t iree_task_post_batch_select_random_worker(
   return iree_task_affinity_set_count_trailing_zeros(valid_worker_mask);
 }
 
+// Selects a worker following IREE_TASK_SCHEDULING_MODE_DRAIN_UNTIL_BLOCKED.
+// Work is kept on the posting worker whenever possible and otherwise sent to
+// workers that are already awake so that we only wake idle workers when all
+// active ones are excluded by the affinity set.
+static iree_host_size_t iree_task_post_batch_select_draining_worker(
+    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
+  if (post_batch->current_worker &&
+      (affinity_set & post_batch->current_worker->worker_bit)) {
+    return iree_task_affinity_set_count_trailing_zeros(
+        post_batch->current_worker->worker_bit);
+  }
+
+  // Workers we've already queued work for in this batch are going to be awake
+  // and so are any that are not idle.
+  // The masks are accessed with 'relaxed' order because they are just hints.
+  iree_task_affinity_set_t worker_idle_mask =
+      iree_atomic_task_affinity_set_load(
+          &post_batch->executor->worker_idle_mask, iree_memory_order_relaxed);
+  iree_task_affinity_set_t worker_active_mask =
+      ~worker_idle_mask | post_batch->worker_pending_mask;
+  iree_task_affinity_set_t active_affinity_set =
+      affinity_set & worker_active_mask;
+  if (active_affinity_set) {
+    return iree_task_post_batch_select_random_worker(post_batch,
+                                                     active_affinity_set);
+  }
+  return iree_task_post_batch_select_random_worker(post_batch, affinity_set);
+}
+
 iree_host_size_t iree_task_post_batch_select_worker(
     iree_task_post_batch_t* post_batch, iree_task_affinity_set_t affinity_set) {
-  if (post_batch->current_worker) {
+  const iree_task_scheduling_mode_t scheduling_mode =
+      post_batch->executor->scheduling_mode;
+  if (scheduling_mode & IREE_TASK_SCHEDULING_MODE_DRAIN_UNTIL_BLOCKED) {
+    return iree_task_post_batch_select_draining_worker(post_batch,
+                                                       affinity_set);
+  }
+
+  // When optimizing for width we skip routing back to the current worker so
+  // that idle workers get the work first; the current worker will still get
+  // work if there are no idle workers left (or it steals).
+  if (post_batch->current_worker &&
+      !(scheduling_mode & IREE_TASK_SCHEDULING_MODE_WIDEST_FIRST)) {
     // Posting from a worker - prefer sending right back to this worker if we
     // haven't already scheduled for it.
     if ((affinity_set & post_batch->current_worker->worker_bit) &&
@@ -93,40 +133,6 @@ void iree_task_post_batch_enqueue(iree_task_post_batch_t* post_batch,
       iree_task_affinity_for_worker(worker_index);
 }
 
-// Wakes each worker indicated in the |wake_mask|, if needed.
-static void iree_task_post_batch_wake_workers(
-    iree_task_post_batch_t* post_batch, iree_task_affinity_set_t wake_mask) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, iree_math_count_ones_u64(wake_mask));
-
-  // TODO(#4016): use a FUTEX_WAKE_BITSET here to wake all of the workers that
-  // have pending work in a single syscall (vs. popcnt(worker_pending_mask)
-  // syscalls). This will reduce wake latency for workers later in the set;
-  // for example today worker[31] will wait until workers[0-30] have had their
-  // syscalls performed before it's even requested to wake. This also loses
-  // information the kernel could use to avoid core migration as it knows when N
-  // threads will be needed simultaneously and can hopefully perform any needed
-  // migrations prior to beginning execution.
-  iree_task_executor_t* executor = post_batch->executor;
-  int wake_count = iree_task_affinity_set_count_ones(wake_mask);
-  int worker_index = 0;
-  for (int i = 0; i < wake_count; ++i) {
-    int offset = iree_task_affinity_set_count_trailing_zeros(wake_mask);
-    int wake_index = worker_index + offset;
-    worker_index += offset + 1;
-    wake_mask = iree_shr(wake_mask, offset + 1);
-
-    // Wake workers if they are waiting - workers are the only thing that can
-    // wait on this notification so this should almost always be either free (an
-    // atomic load) if a particular worker isn't waiting or it's required to
-    // actually wake it and we can't avoid it.
-    iree_task_worker_t* worker = &executor->workers[wake_index];
-    iree_notification_post(&worker->wake_notification, 1);
-  }
-
-  IREE_TRACE_ZONE_END(z0);
-}
-
 bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
   if (!post_batch->worker_pending_mask) return false;
 
@@ -162,10 +168,11 @@ bool iree_task_post_batch_submit(iree_task_post_batch_t* post_batch) {
   }
 
   // Wake all workers that now have pending work. If a worker is not already
-  // waiting this will be cheap (no syscall).
-  if (worker_wake_mask != 0) {
-    iree_task_post_batch_wake_workers(post_batch, worker_wake_mask);
-  }
+  // waiting this will be cheap (no syscall) and where supported all waiting
+  // workers are woken together with a single syscall. This reduces wake
+  // latency for workers later in the set and lets the kernel know that all of
+  // the threads will be needed simultaneously.
+  iree_task_worker_wake_set(post_batch->executor, worker_wake_mask);
 
   IREE_TRACE_ZONE_END(z0);
   return post_count != 0;
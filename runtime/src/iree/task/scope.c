@@ -26,6 +26,8 @@ void iree_task_scope_initialize(iree_string_view_t name,
   out_scope->name[name_length] = 0;
 
   out_scope->flags = flags;
+  iree_atomic_store(&out_scope->deadline_ns, IREE_TIME_INFINITE_FUTURE,
+                    iree_memory_order_relaxed);
 
   // TODO(benvanik): pick trace colors based on name hash.
   IREE_TRACE(out_scope->task_trace_color = 0xFFFF0000u);
@@ -135,6 +137,32 @@ void iree_task_scope_fail(iree_task_scope_t* scope, iree_status_t status) {
   iree_task_scope_try_set_status(scope, status);
 }
 
+void iree_task_scope_set_deadline(iree_task_scope_t* scope,
+                                  iree_time_t deadline_ns) {
+  iree_atomic_store(&scope->deadline_ns, deadline_ns,
+                    iree_memory_order_relaxed);
+}
+
+iree_time_t iree_task_scope_deadline(iree_task_scope_t* scope) {
+  return iree_atomic_load(&scope->deadline_ns, iree_memory_order_relaxed);
+}
+
+bool iree_task_scope_is_cancelled(iree_task_scope_t* scope) {
+  if (IREE_UNLIKELY(iree_task_scope_has_failed(scope))) return true;
+  const iree_time_t deadline_ns =
+      iree_atomic_load(&scope->deadline_ns, iree_memory_order_relaxed);
+  if (IREE_LIKELY(deadline_ns == IREE_TIME_INFINITE_FUTURE)) return false;
+  if (iree_time_now() < deadline_ns) return false;
+  // Deadline elapsed: transition into the failure state so that all other
+  // checks (including ones that only look for failures) drop the work. If
+  // multiple threads race here only the first status is retained.
+  iree_task_scope_try_set_status(
+      scope, iree_make_status(IREE_STATUS_DEADLINE_EXCEEDED,
+                              "scope deadline elapsed; remaining work in the "
+                              "scope has been cancelled"));
+  return true;
+}
+
 void iree_task_scope_begin(iree_task_scope_t* scope) {
   iree_atomic_ref_count_inc(&scope->pending_submissions);
   // relaxed because this 'begin' call will be paired with a 'end' call that
@@ -181,3 +209,46 @@ iree_status_t iree_task_scope_wait_idle(iree_task_scope_t* scope,
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+static iree_status_t iree_task_scope_idle_wait_source_ctl(
+    iree_wait_source_t wait_source, iree_wait_source_command_t command,
+    const void* params, void** inout_ptr) {
+  iree_task_scope_t* scope = (iree_task_scope_t*)wait_source.self;
+  switch (command) {
+    case IREE_WAIT_SOURCE_COMMAND_QUERY: {
+      iree_status_code_t* out_wait_status_code = (iree_status_code_t*)inout_ptr;
+      *out_wait_status_code = iree_task_scope_is_idle(scope)
+                                  ? IREE_STATUS_OK
+                                  : IREE_STATUS_DEFERRED;
+      return iree_ok_status();
+    }
+    case IREE_WAIT_SOURCE_COMMAND_WAIT_ONE: {
+      const iree_timeout_t timeout =
+          ((const iree_wait_source_wait_params_t*)params)->timeout;
+      return iree_task_scope_wait_idle(scope,
+                                       iree_timeout_as_deadline_ns(timeout));
+    }
+    case IREE_WAIT_SOURCE_COMMAND_EXPORT: {
+      const iree_wait_primitive_type_t target_type =
+          ((const iree_wait_source_export_params_t*)params)->target_type;
+      iree_wait_primitive_t* out_wait_primitive =
+          (iree_wait_primitive_t*)inout_ptr;
+      memset(out_wait_primitive, 0, sizeof(*out_wait_primitive));
+      return iree_make_status(IREE_STATUS_UNAVAILABLE,
+                              "requested wait primitive type %d is unavailable",
+                              (int)target_type);
+    }
+    default:
+      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
+                              "unimplemented wait_source command");
+  }
+}
+
+iree_wait_source_t iree_task_scope_await_idle(iree_task_scope_t* scope) {
+  iree_wait_source_t wait_source = {
+      .self = scope,
+      .data = 0,
+      .ctl = iree_task_scope_idle_wait_source_ctl,
+  };
+  return wait_source;
+}
@@ -69,6 +69,11 @@ typedef struct iree_task_scope_t {
   // to completion.
   iree_atomic_intptr_t permanent_status;
 
+  // Absolute time in nanoseconds after which the scope is cancelled with
+  // IREE_STATUS_DEADLINE_EXCEEDED or IREE_TIME_INFINITE_FUTURE if there is no
+  // deadline. Checked cooperatively by iree_task_scope_is_cancelled.
+  iree_atomic_int64_t deadline_ns;
+
   // Dispatch statistics aggregated from all dispatches in this scope. Updated
   // relatively infrequently and must not be used for task control as values
   // are undefined in the case of failure and may tear.
@@ -131,6 +136,28 @@ void iree_task_scope_abort(iree_task_scope_t* scope);
 // marked as failing then the status is ignored.
 void iree_task_scope_fail(iree_task_scope_t* scope, iree_status_t status);
 
+// Sets the absolute |deadline_ns| after which all work in the scope is
+// cancelled. Once the deadline elapses the scope fails with
+// IREE_STATUS_DEADLINE_EXCEEDED the next time it is checked: pending tasks are
+// dropped and in-flight dispatches stop executing tiles. Passing
+// IREE_TIME_INFINITE_FUTURE (the default) clears the deadline. Has no effect if
+// the scope has already failed.
+void iree_task_scope_set_deadline(iree_task_scope_t* scope,
+                                  iree_time_t deadline_ns);
+
+// Returns the absolute deadline of the scope or IREE_TIME_INFINITE_FUTURE if
+// none has been set.
+iree_time_t iree_task_scope_deadline(iree_task_scope_t* scope);
+
+// Returns true if work within the scope should stop because the scope has been
+// aborted, has failed, or its deadline has elapsed. An elapsed deadline moves
+// the scope into a permanent IREE_STATUS_DEADLINE_EXCEEDED failure.
+//
+// Tasks poll this cooperatively before they begin executing and dispatches
+// poll it between tiles; work already executing is never interrupted. This is
+// cheap (a relaxed atomic load) when no deadline is set.
+bool iree_task_scope_is_cancelled(iree_task_scope_t* scope);
+
 // Notifies the scope that a new execution task assigned to the scope has begun.
 // The scope is considered active until it is notified execution has completed
 // with iree_task_scope_end.
@@ -168,6 +195,13 @@ bool iree_task_scope_is_idle(iree_task_scope_t* scope);
 iree_status_t iree_task_scope_wait_idle(iree_task_scope_t* scope,
                                         iree_time_t deadline_ns);
 
+// Returns a wait source that resolves when the scope becomes idle.
+// The scope must remain live for as long as the wait source is in use. Useful
+// for waiting on a scope with iree_task_executor_donate_caller.
+//
+// Memory ordering: see iree_task_scope_is_idle.
+iree_wait_source_t iree_task_scope_await_idle(iree_task_scope_t* scope);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -79,6 +79,48 @@ TEST(ScopeTest, FailEmpty) {
   iree_task_scope_deinitialize(&scope);
 }
 
+TEST(ScopeTest, DeadlineEmpty) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+
+  // No deadline by default.
+  EXPECT_EQ(IREE_TIME_INFINITE_FUTURE, iree_task_scope_deadline(&scope));
+  EXPECT_FALSE(iree_task_scope_is_cancelled(&scope));
+
+  // A future deadline does not cancel.
+  iree_task_scope_set_deadline(&scope, iree_time_now() + 60000000000ll);
+  EXPECT_FALSE(iree_task_scope_is_cancelled(&scope));
+  EXPECT_FALSE(iree_task_scope_has_failed(&scope));
+
+  // An elapsed deadline cancels and fails the scope.
+  iree_task_scope_set_deadline(&scope, IREE_TIME_INFINITE_PAST);
+  EXPECT_TRUE(iree_task_scope_is_cancelled(&scope));
+  EXPECT_TRUE(iree_task_scope_has_failed(&scope));
+  iree_status_t consumed_status = iree_task_scope_consume_status(&scope);
+  EXPECT_TRUE(iree_status_is_deadline_exceeded(consumed_status));
+  iree_status_ignore(consumed_status);
+
+  // Ensure the cancellation is sticky even if the deadline is cleared.
+  iree_task_scope_set_deadline(&scope, IREE_TIME_INFINITE_FUTURE);
+  EXPECT_TRUE(iree_task_scope_is_cancelled(&scope));
+  EXPECT_TRUE(iree_status_is_deadline_exceeded(
+      iree_task_scope_consume_status(&scope)));
+
+  iree_task_scope_deinitialize(&scope);
+}
+
+TEST(ScopeTest, AbortCancels) {
+  iree_task_scope_t scope;
+  iree_task_scope_initialize(iree_make_cstring_view("scope_a"),
+                             IREE_TASK_SCOPE_FLAG_NONE, &scope);
+  EXPECT_FALSE(iree_task_scope_is_cancelled(&scope));
+  iree_task_scope_abort(&scope);
+  EXPECT_TRUE(iree_task_scope_is_cancelled(&scope));
+  EXPECT_TRUE(iree_status_is_aborted(iree_task_scope_consume_status(&scope)));
+  iree_task_scope_deinitialize(&scope);
+}
+
 // NOTE: only the first failure is recorded and made sticky; subsequent failure
 // calls are ignored.
 TEST(ScopeTest, FailAgain) {
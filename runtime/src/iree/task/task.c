@@ -247,8 +247,13 @@ void iree_task_call_execute(iree_task_call_t* task,
   IREE_TRACE_ZONE_SET_COLOR(z0,
                             iree_math_ptr_to_xrgb(task->closure.user_context));
 
-  if (IREE_LIKELY(
-          !iree_any_bit_set(task->header.flags, IREE_TASK_FLAG_ABORTED))) {
+  if (IREE_UNLIKELY(iree_task_scope_is_cancelled(task->header.scope))) {
+    // The scope was cancelled while the task was queued for execution; fail
+    // the task so that its cleanup observes the abort and skip the callback.
+    iree_task_try_set_status(&task->status,
+                             iree_status_from_code(IREE_STATUS_ABORTED));
+  } else if (IREE_LIKELY(!iree_any_bit_set(task->header.flags,
+                                           IREE_TASK_FLAG_ABORTED))) {
     // Execute the user callback.
     // Note that this may enqueue more nested tasks, including tasks that
     // prevent this task from retiring.
@@ -606,16 +611,18 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
   iree_host_size_t shard_count =
       iree_min(dispatch_task->tile_count, worker_count);
 
-  // Compute how many tiles we want each shard to reserve at a time from the
+  // Compute the most tiles we want each shard to reserve at a time from the
   // larger grid. A higher number reduces overhead and improves locality while
   // a lower number reduces maximum worst-case latency (coarser work stealing).
-  if (dispatch_task->tile_count <
-      worker_count * IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION) {
-    // Grid is small - allow it to be eagerly sliced up.
-    dispatch_task->tiles_per_reservation = 1;
-  } else {
-    dispatch_task->tiles_per_reservation =
-        IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION;
+  // Shards start small and adapt within this bound as they measure how long
+  // tiles take (see iree_task_dispatch_shard_reservation_size). Grids with
+  // fewer than a couple of tiles per shard are always sliced up eagerly.
+  dispatch_task->shard_count = (uint32_t)shard_count;
+  dispatch_task->tiles_per_reservation = 1;
+  if (shard_count > 0) {
+    dispatch_task->tiles_per_reservation = (uint32_t)iree_max(
+        1, iree_min(dispatch_task->tile_count / (2 * shard_count),
+                    IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION));
   }
 
   // Randomize starting worker.
@@ -707,7 +714,37 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
   return shard_task;
 }
 
-void iree_task_dispatch_shard_execute(
+// Returns the number of tiles a shard of |dispatch_task| should reserve next
+// given that its last reservation of |reserved_tile_count| tiles took
+// |reservation_ns| and the grid has been reserved up to at least
+// |next_tile_index|.
+//
+// This is guided self-scheduling: reservations are sized to take about
+// IREE_TASK_DISPATCH_TARGET_RESERVATION_NS so that grids of cheap tiles hit the
+// shared counter less while grids of expensive tiles are reserved one at a
+// time. Each shard never reserves more than half of its share of the remaining
+// tiles so reservations shrink as the grid drains and all shards finish at
+// about the same time.
+static uint32_t iree_task_dispatch_shard_reservation_size(
+    const iree_task_dispatch_t* dispatch_task, uint32_t next_tile_index,
+    uint32_t reserved_tile_count, iree_duration_t reservation_ns) {
+  const iree_duration_t tile_ns =
+      iree_max(1, reservation_ns / iree_max(1, reserved_tile_count));
+  uint64_t reservation_size =
+      (uint64_t)(IREE_TASK_DISPATCH_TARGET_RESERVATION_NS / tile_ns);
+  const uint32_t remaining_tile_count =
+      next_tile_index < dispatch_task->tile_count
+          ? dispatch_task->tile_count - next_tile_index
+          : 0;
+  const uint32_t guided_tile_count =
+      remaining_tile_count / (2 * dispatch_task->shard_count);
+  reservation_size = iree_min(reservation_size, guided_tile_count);
+  reservation_size =
+      iree_min(reservation_size, dispatch_task->tiles_per_reservation);
+  return (uint32_t)iree_max(1, reservation_size);
+}
+
+uint32_t iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
     iree_task_submission_t* pending_submission) {
@@ -732,7 +769,7 @@ void iree_task_dispatch_shard_execute(
                          worker_local_memory.data_length));
     iree_task_retire(&task->header, pending_submission, iree_ok_status());
     IREE_TRACE_ZONE_END(z0);
-    return;
+    return 0;
   }
 
   // Prepare context shared for all tiles in the shard.
@@ -758,13 +795,26 @@ void iree_task_dispatch_shard_execute(
 
   // Loop over all tiles until they are all processed.
   const uint32_t tile_count = dispatch_task->tile_count;
-  const uint32_t tiles_per_reservation = dispatch_task->tiles_per_reservation;
+  const bool adaptive_reservations = dispatch_task->tiles_per_reservation > 1;
+  // Start with a single tile so we can measure how long tiles take before
+  // reserving more.
+  uint32_t tiles_per_reservation = 1;
+  iree_time_t reservation_start_ns =
+      adaptive_reservations ? iree_time_now() : 0;
+  uint32_t tiles_executed = 0;
   // relaxed order because we only care about atomic increments, not about
   // ordering of tile_index accesses w.r.t. other memory accesses.
   uint32_t tile_base =
       iree_atomic_fetch_add(&dispatch_task->tile_index, tiles_per_reservation,
                             iree_memory_order_relaxed);
   while (tile_base < tile_count) {
+    // Stop issuing tiles if the scope was cancelled (aborted, failed, or its
+    // deadline elapsed). Any remaining tiles are dropped and the dispatch and
+    // its dependents will be discarded once all shards have retired.
+    if (IREE_UNLIKELY(iree_task_scope_is_cancelled(task->header.scope))) {
+      break;
+    }
+
     const uint32_t tile_range =
         iree_min(tile_base + tiles_per_reservation, tile_count);
     for (uint32_t tile_index = tile_base; tile_index < tile_range;
@@ -796,6 +846,7 @@ void iree_task_dispatch_shard_execute(
                                     &tile_context, pending_submission);
 
       IREE_TRACE_ZONE_END(z_tile);
+      ++tiles_executed;
 
       // If any tile fails we bail early from the loop. This doesn't match
       // what an accelerator would do but saves some unneeded work.
@@ -810,6 +861,15 @@ void iree_task_dispatch_shard_execute(
       }
     }
 
+    // Resize the next reservation based on how long this one took.
+    if (adaptive_reservations) {
+      const iree_time_t reservation_end_ns = iree_time_now();
+      tiles_per_reservation = iree_task_dispatch_shard_reservation_size(
+          dispatch_task, tile_base + tiles_per_reservation,
+          tile_range - tile_base, reservation_end_ns - reservation_start_ns);
+      reservation_start_ns = reservation_end_ns;
+    }
+
     // Try to grab the next slice of tiles.
     tile_base =
         iree_atomic_fetch_add(&dispatch_task->tile_index, tiles_per_reservation,
@@ -827,4 +887,5 @@ abort_shard:
   // propagated to the dispatch and it'll clean up after all shards are joined.
   iree_task_retire(&task->header, pending_submission, iree_ok_status());
   IREE_TRACE_ZONE_END(z0);
+  return tiles_executed;
 }
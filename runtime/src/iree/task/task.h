@@ -643,9 +643,14 @@ typedef iree_alignas(iree_max_align_t) struct iree_task_dispatch_t {
 
   // Maximum number of tiles to fetch per tile reservation from the grid.
   // Bounded by IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION and a
-  // reasonable number chosen based on the tile and shard counts.
+  // reasonable number chosen based on the tile and shard counts. Each shard
+  // adapts its reservations within this bound as it executes.
   uint32_t tiles_per_reservation;
 
+  // Number of shards the dispatch was issued as. Used by shards to scale their
+  // reservations to their share of the remaining tiles.
+  uint32_t shard_count;
+
   // The tail tile index; the next reservation will start from here.
   // This is used by shards to slice off the work to perform in their inner
   // loop. Ideally we'd have no destructive interference with other shared data
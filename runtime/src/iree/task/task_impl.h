@@ -46,7 +46,7 @@ void iree_task_call_execute(iree_task_call_t* task,
 // Retires a barrier task by notifying all dependent tasks.
 // May add zero or more tasks to the |pending_submission| if they are ready.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 void iree_task_barrier_retire(iree_task_barrier_t* task,
                               iree_task_submission_t* pending_submission);
 
@@ -56,7 +56,7 @@ void iree_task_barrier_retire(iree_task_barrier_t* task,
 
 // Retires a fence task by updating the scope state.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 void iree_task_fence_retire(iree_task_fence_t* task,
                             iree_task_submission_t* pending_submission);
 
@@ -66,12 +66,12 @@ void iree_task_fence_retire(iree_task_fence_t* task,
 
 // Returns true if the user-specified condition on the task is true.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 bool iree_task_wait_check_condition(iree_task_wait_t* task);
 
 // Retires a wait when it has completed waiting (successfully or not).
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 void iree_task_wait_retire(iree_task_wait_t* task,
                            iree_task_submission_t* pending_submission,
                            iree_status_t status);
@@ -86,7 +86,7 @@ void iree_task_wait_retire(iree_task_wait_t* task,
 // execution prior to the shards and end execution after the last shard
 // finishes.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
                               iree_task_pool_t* shard_task_pool,
                               iree_task_submission_t* pending_submission,
@@ -94,7 +94,7 @@ void iree_task_dispatch_issue(iree_task_dispatch_t* dispatch_task,
 
 // Retires a dispatch when all issued shards have completed executing.
 //
-// Only called during coordination and expects the coordinator lock to be held.
+// Only called during coordination and expects to be the active coordinator.
 void iree_task_dispatch_retire(iree_task_dispatch_t* dispatch_task,
                                iree_task_submission_t* pending_submission);
 
@@ -120,7 +120,9 @@ iree_task_dispatch_shard_t* iree_task_dispatch_shard_allocate(
 //
 // Errors are propagated to the parent scope and the dispatch will fail once
 // all shards have completed.
-void iree_task_dispatch_shard_execute(
+//
+// Returns the number of tiles executed by the shard.
+uint32_t iree_task_dispatch_shard_execute(
     iree_task_dispatch_shard_t* task, iree_cpu_processor_id_t processor_id,
     uint32_t worker_id, iree_byte_span_t worker_local_memory,
     iree_task_submission_t* pending_submission);
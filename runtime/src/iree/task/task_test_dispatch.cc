@@ -112,6 +112,14 @@ TEST_F(TaskDispatchTest, Issue345) {
   DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
 }
 
+// Tests a large grid of cheap tiles where shards grow their reservations.
+TEST_F(TaskDispatchTest, IssueLarge) {
+  IREE_TRACE_SCOPE();
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {128, 64, 13};
+  DispatchAndVerifyGrid(kWorkgroupSize, kWorkgroupCount, IREE_TASK_FLAG_NONE);
+}
+
 TEST_F(TaskDispatchTest, IssueIndirect) {
   IREE_TRACE_SCOPE();
 
@@ -213,4 +221,59 @@ TEST_F(TaskDispatchTest, IssueFailureChained) {
               StatusIs(StatusCode::kDataLoss));
 }
 
+// Tests that a scope deadline elapsing while a dispatch is in-flight stops the
+// remaining tiles from executing and drops dependent tasks.
+TEST_F(TaskDispatchTest, IssueDeadlineExceeded) {
+  IREE_TRACE_SCOPE();
+
+  const uint32_t kWorkgroupSize[3] = {1, 1, 1};
+  const uint32_t kWorkgroupCount[3] = {64 * 1024, 1, 1};
+
+  struct DeadlineState {
+    iree_task_scope_t* scope;
+    iree_atomic_int32_t tiles_executed;
+  } state;
+  state.scope = &scope_;
+  iree_atomic_store(&state.tiles_executed, 0, iree_memory_order_relaxed);
+  auto tile = [](void* user_context,
+                 const iree_task_tile_context_t* tile_context,
+                 iree_task_submission_t* pending_submission) -> iree_status_t {
+    auto* state = (DeadlineState*)user_context;
+    iree_atomic_fetch_add(&state->tiles_executed, 1,
+                          iree_memory_order_relaxed);
+    if (tile_context->workgroup_xyz[0] == 0) {
+      // Expire the deadline as if time had run out.
+      iree_task_scope_set_deadline(state->scope, IREE_TIME_INFINITE_PAST);
+    }
+    return iree_ok_status();
+  };
+
+  iree_task_dispatch_t dispatch_task;
+  iree_task_dispatch_initialize(
+      &scope_, iree_task_make_dispatch_closure(tile, &state), kWorkgroupSize,
+      kWorkgroupCount, &dispatch_task);
+
+  int did_call = 0;
+  iree_task_call_t call_task;
+  iree_task_call_initialize(&scope_,
+                            iree_task_make_call_closure(
+                                [](void* user_context, iree_task_t* task,
+                                   iree_task_submission_t* pending_submission) {
+                                  int* did_call_ptr = (int*)user_context;
+                                  ++(*did_call_ptr);
+                                  return iree_ok_status();
+                                },
+                                &did_call),
+                            &call_task);
+  iree_task_set_completion_task(&dispatch_task.header, &call_task.header);
+
+  IREE_ASSERT_OK(
+      SubmitTasksAndWaitIdle(&dispatch_task.header, &call_task.header));
+  EXPECT_LT(iree_atomic_load(&state.tiles_executed, iree_memory_order_relaxed),
+            (int32_t)kWorkgroupCount[0]);
+  EXPECT_EQ(0, did_call);
+  EXPECT_THAT(Status(iree_task_scope_consume_status(&scope_)),
+              StatusIs(StatusCode::kDeadlineExceeded));
+}
+
 }  // namespace
@@ -0,0 +1,166 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/task/testing/concurrent_benchmark.h"
+
+#include <string.h>
+
+#include "iree/task/submission.h"
+#include "iree/task/task.h"
+#include "iree/task/topology.h"
+
+iree_status_t iree_task_concurrent_benchmark_initialize(
+    iree_host_size_t thread_count, iree_allocator_t host_allocator,
+    iree_task_concurrent_benchmark_t* out_benchmark) {
+  IREE_ASSERT_ARGUMENT(out_benchmark);
+  memset(out_benchmark, 0, sizeof(*out_benchmark));
+  out_benchmark->host_allocator = host_allocator;
+
+  // One worker per physical core so that threads do not share core resources
+  // (SMT siblings, etc) and only contend on the shared caches and memory.
+  iree_task_topology_t topology;
+  IREE_RETURN_IF_ERROR(iree_task_topology_initialize_from_physical_cores(
+      IREE_TASK_TOPOLOGY_NODE_ID_ANY, IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY,
+      thread_count, &topology));
+  out_benchmark->thread_count = iree_task_topology_group_count(&topology);
+
+  iree_task_executor_options_t options;
+  iree_task_executor_options_initialize(&options);
+  iree_status_t status = iree_task_executor_create(
+      options, &topology, host_allocator, &out_benchmark->executor);
+  iree_task_topology_deinitialize(&topology);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc_aligned(
+        host_allocator,
+        out_benchmark->thread_count * sizeof(out_benchmark->threads[0]),
+        iree_hardware_destructive_interference_size, 0,
+        (void**)&out_benchmark->threads);
+  }
+  if (iree_status_is_ok(status)) {
+    iree_task_scope_initialize(iree_make_cstring_view("benchmark"),
+                               IREE_TASK_SCOPE_FLAG_NONE,
+                               &out_benchmark->scope);
+  } else {
+    iree_task_executor_release(out_benchmark->executor);
+    memset(out_benchmark, 0, sizeof(*out_benchmark));
+  }
+  return status;
+}
+
+void iree_task_concurrent_benchmark_deinitialize(
+    iree_task_concurrent_benchmark_t* benchmark) {
+  if (!benchmark->executor) return;
+  iree_task_scope_deinitialize(&benchmark->scope);
+  iree_task_executor_release(benchmark->executor);
+  iree_allocator_free_aligned(benchmark->host_allocator, benchmark->threads);
+  memset(benchmark, 0, sizeof(*benchmark));
+}
+
+typedef struct iree_task_concurrent_benchmark_dispatch_t {
+  iree_task_concurrent_benchmark_t* benchmark;
+  iree_task_concurrent_benchmark_fn_t fn;
+  void* user_data;
+  int64_t iteration_count;
+} iree_task_concurrent_benchmark_dispatch_t;
+
+// Runs the payload for the thread matching the tile. Each tile is one thread
+// and with as many workers as tiles each worker runs exactly one tile.
+static iree_status_t iree_task_concurrent_benchmark_tile(
+    void* user_context, const iree_task_tile_context_t* tile_context,
+    iree_task_submission_t* pending_submission) {
+  iree_task_concurrent_benchmark_dispatch_t* dispatch =
+      (iree_task_concurrent_benchmark_dispatch_t*)user_context;
+  iree_host_size_t thread_index = tile_context->workgroup_xyz[0];
+  iree_task_concurrent_benchmark_thread_t* thread =
+      &dispatch->benchmark->threads[thread_index];
+  iree_time_t start_ns = iree_time_now();
+  iree_status_t status = dispatch->fn(dispatch->user_data, thread_index,
+                                      dispatch->iteration_count);
+  thread->duration_ns += iree_time_now() - start_ns;
+  thread->iteration_count += dispatch->iteration_count;
+  thread->worker_id = tile_context->worker_id;
+  return status;
+}
+
+iree_status_t iree_task_concurrent_benchmark_run(
+    iree_task_concurrent_benchmark_t* benchmark,
+    iree_task_concurrent_benchmark_fn_t fn, void* user_data,
+    int64_t iteration_count) {
+  iree_task_concurrent_benchmark_dispatch_t dispatch = {
+      .benchmark = benchmark,
+      .fn = fn,
+      .user_data = user_data,
+      .iteration_count = iteration_count,
+  };
+  const uint32_t workgroup_size[3] = {1, 1, 1};
+  const uint32_t workgroup_count[3] = {(uint32_t)benchmark->thread_count, 1,
+                                       1};
+  iree_task_dispatch_t dispatch_task;
+  iree_task_dispatch_initialize(
+      &benchmark->scope,
+      iree_task_make_dispatch_closure(iree_task_concurrent_benchmark_tile,
+                                      &dispatch),
+      workgroup_size, workgroup_count, &dispatch_task);
+
+  iree_task_fence_t* fence = NULL;
+  IREE_RETURN_IF_ERROR(iree_task_executor_acquire_fence(
+      benchmark->executor, &benchmark->scope, &fence));
+  iree_task_set_completion_task(&dispatch_task.header, &fence->header);
+
+  iree_task_submission_t submission;
+  iree_task_submission_initialize(&submission);
+  iree_task_submission_enqueue(&submission, &dispatch_task.header);
+  iree_task_executor_submit(benchmark->executor, &submission);
+  iree_task_executor_flush(benchmark->executor);
+  return iree_task_scope_wait_idle(&benchmark->scope,
+                                   IREE_TIME_INFINITE_FUTURE);
+}
+
+iree_status_t iree_task_concurrent_benchmark_report(
+    iree_task_concurrent_benchmark_t* benchmark,
+    iree_benchmark_state_t* benchmark_state, const char* item_unit,
+    int64_t items_per_iteration, int64_t bytes_per_iteration) {
+  iree_string_builder_t label;
+  iree_string_builder_initialize(benchmark->host_allocator, &label);
+  iree_status_t status = iree_string_builder_append_format(
+      &label, "threads=%" PRIhsz, benchmark->thread_count);
+
+  // Work stealing may have run more than one thread on the same worker in
+  // which case the threads did not actually run concurrently.
+  uint64_t worker_mask = 0;
+  bool oversubscribed = false;
+  int64_t total_iteration_count = 0;
+  for (iree_host_size_t i = 0; i < benchmark->thread_count; ++i) {
+    const iree_task_concurrent_benchmark_thread_t* thread =
+        &benchmark->threads[i];
+    total_iteration_count += thread->iteration_count;
+    uint64_t worker_bit = 1ull << (thread->worker_id % 64);
+    oversubscribed |= (worker_mask & worker_bit) != 0;
+    worker_mask |= worker_bit;
+    if (!iree_status_is_ok(status) || !thread->duration_ns) continue;
+    double seconds = thread->duration_ns / 1e9;
+    status = iree_string_builder_append_format(
+        &label, " t%" PRIhsz "=%.2fG%s/s,%.2fGB/s", i,
+        thread->iteration_count * items_per_iteration / seconds / 1e9,
+        item_unit,
+        thread->iteration_count * bytes_per_iteration / seconds / 1e9);
+  }
+  if (iree_status_is_ok(status) && oversubscribed) {
+    status = iree_string_builder_append_cstring(&label, " (oversubscribed)");
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_benchmark_set_label(benchmark_state,
+                             iree_string_builder_buffer(&label));
+    iree_benchmark_set_items_processed(
+        benchmark_state, total_iteration_count * items_per_iteration);
+    iree_benchmark_set_bytes_processed(
+        benchmark_state, total_iteration_count * bytes_per_iteration);
+  }
+  iree_string_builder_deinitialize(&label);
+  return status;
+}
@@ -0,0 +1,83 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_TASK_TESTING_CONCURRENT_BENCHMARK_H_
+#define IREE_TASK_TESTING_CONCURRENT_BENCHMARK_H_
+
+#include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
+#include "iree/task/executor.h"
+#include "iree/task/scope.h"
+#include "iree/testing/benchmark.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Function run by each benchmark thread. Must perform |iteration_count|
+// iterations of the benchmarked payload using state private to |thread_index|.
+typedef iree_status_t (*iree_task_concurrent_benchmark_fn_t)(
+    void* user_data, iree_host_size_t thread_index, int64_t iteration_count);
+
+// Per-thread measurements accumulated across runs.
+typedef iree_alignas(iree_hardware_destructive_interference_size) struct {
+  // Total wall time spent running the payload.
+  iree_duration_t duration_ns;
+  // Total payload iterations performed.
+  int64_t iteration_count;
+  // Worker that last ran the thread payload.
+  uint32_t worker_id;
+} iree_task_concurrent_benchmark_thread_t;
+
+// Runs a benchmark payload concurrently on multiple task executor workers
+// pinned to distinct physical cores. Many performance issues (memory bandwidth
+// and shared cache contention, thermal throttling, etc) only appear when the
+// whole socket is loaded and this is used to produce scaling curves for
+// kernels that are otherwise benchmarked on a single thread.
+typedef struct iree_task_concurrent_benchmark_t {
+  iree_allocator_t host_allocator;
+  iree_task_executor_t* executor;
+  iree_task_scope_t scope;
+  // Number of threads the payload runs on concurrently. May be less than
+  // requested if the system has fewer physical cores.
+  iree_host_size_t thread_count;
+  // Measurements for each thread, [0, thread_count).
+  iree_task_concurrent_benchmark_thread_t* threads;
+} iree_task_concurrent_benchmark_t;
+
+// Initializes |out_benchmark| to run payloads on up to |thread_count| threads
+// each pinned to its own physical core.
+iree_status_t iree_task_concurrent_benchmark_initialize(
+    iree_host_size_t thread_count, iree_allocator_t host_allocator,
+    iree_task_concurrent_benchmark_t* out_benchmark);
+
+// Deinitializes |benchmark| and joins all threads.
+void iree_task_concurrent_benchmark_deinitialize(
+    iree_task_concurrent_benchmark_t* benchmark);
+
+// Runs |fn| on all threads concurrently with each performing
+// |iteration_count| iterations and returns once all threads have completed.
+iree_status_t iree_task_concurrent_benchmark_run(
+    iree_task_concurrent_benchmark_t* benchmark,
+    iree_task_concurrent_benchmark_fn_t fn, void* user_data,
+    int64_t iteration_count);
+
+// Reports the measurements of all runs to |benchmark_state|. The aggregate
+// items and bytes processed across all threads are reported as the benchmark
+// counters and the per-thread rates in the benchmark label, such as
+// `t0=12.34GFLOP/s,5.67GB/s` for an |item_unit| of `FLOP`.
+// |items_per_iteration| and |bytes_per_iteration| describe a single iteration
+// of the payload on one thread.
+iree_status_t iree_task_concurrent_benchmark_report(
+    iree_task_concurrent_benchmark_t* benchmark,
+    iree_benchmark_state_t* benchmark_state, const char* item_unit,
+    int64_t items_per_iteration, int64_t bytes_per_iteration);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TASK_TESTING_CONCURRENT_BENCHMARK_H_
@@ -60,6 +60,26 @@ typedef struct iree_task_topology_caches_t {
   uint32_t l3_data;
 } iree_task_topology_caches_t;
 
+// Selects what core types in a heterogeneous core cluster are used.
+// This maps to x86 efficiency/performance cores and ARM big.LITTLE cores.
+//
+// Hosting applications can decide whether they want low power consumption/less
+// contention on high performance cores by forcing only low performance cores
+// or predictable(ish) low latency by forcing only high performance cores. On
+// homogeneous core clusters, where wall-time is the primary metric, or where
+// contention is unlikely selecting all cores can usually result in the lowest
+// latency. Each application with each set of programs will need to evaluate for
+// themselves what to use based on their duty cycle, concurrently issued work,
+// and user experience.
+typedef enum iree_task_topology_performance_level_e {
+  // Selects all cores.
+  IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY = 0,
+  // Selects "E(fficiency)" cores that favor lower power/thermal load.
+  IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW,
+  // Selects "P(erformance)" cores that favor higher power/thermal load.
+  IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH,
+} iree_task_topology_performance_level_t;
+
 // Information about a particular group within the topology.
 // Groups may be of varying levels of granularity even within the same topology
 // based on how the topology is defined.
@@ -82,6 +102,12 @@ typedef struct iree_task_topology_group_t {
   // allows us to model Simultaneous Multi-Threading (SMT) (aka hyperthreading).
   iree_thread_affinity_t ideal_thread_affinity;
 
+  // Performance level of the core the group is placed on in heterogeneous core
+  // clusters. IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY if the cores are
+  // homogeneous or the core type could not be determined. Workers may use this
+  // to request scheduling treatment appropriate for the core type.
+  iree_task_topology_performance_level_t performance_level;
+
   // A bitmask of other group indices that share some level of the cache
   // hierarchy. Workers of this group are more likely to constructively share
   // some cache levels higher up with these other groups. For example, if the
@@ -116,6 +142,12 @@ void iree_task_topology_group_initialize(uint8_t group_index,
 // We can add the more common heuristics over time to the core and leave the
 // edge cases for applications to construct.
 typedef struct iree_task_topology_t {
+  // NUMA node all groups are located on or IREE_TASK_TOPOLOGY_NODE_ID_ANY if
+  // the groups are unpinned or may span multiple nodes. Executors use this to
+  // place their worker memory and users to route work to the executor local to
+  // the memory it touches.
+  iree_task_topology_node_id_t node_id;
+
   iree_host_size_t group_count;
   iree_task_topology_group_t groups[IREE_TASK_EXECUTOR_MAX_WORKER_COUNT];
 } iree_task_topology_t;
@@ -190,26 +222,6 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
 iree_status_t iree_task_topology_initialize_from_logical_cpu_set_string(
     iree_string_view_t cpu_id_set, iree_task_topology_t* out_topology);
 
-// Selects what core types in a heterogeneous core cluster are used.
-// This maps to x86 efficiency/performance cores and ARM big.LITTLE cores.
-//
-// Hosting applications can decide whether they want low power consumption/less
-// contention on high performance cores by forcing only low performance cores
-// or predictable(ish) low latency by forcing only high performance cores. On
-// homogeneous core clusters, where wall-time is the primary metric, or where
-// contention is unlikely selecting all cores can usually result in the lowest
-// latency. Each application with each set of programs will need to evaluate for
-// themselves what to use based on their duty cycle, concurrently issued work,
-// and user experience.
-typedef enum iree_task_topology_performance_level_e {
-  // Selects all cores.
-  IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY = 0,
-  // Selects "E(fficiency)" cores that favor lower power/thermal load.
-  IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW,
-  // Selects "P(erformance)" cores that favor higher power/thermal load.
-  IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH,
-} iree_task_topology_performance_level_t;
-
 // Initializes a topology with one group for each physical core with the given
 // NUMA |node_id| (usually package or cluster). Up to |max_core_count| physical
 // cores will be selected from the node.
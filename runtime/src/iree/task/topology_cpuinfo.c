@@ -4,6 +4,9 @@
 // See https://llvm.org/LICENSE.txt for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <stdio.h>
+#include <string.h>
+
 #include "iree/base/api.h"
 #include "iree/base/internal/math.h"
 #include "iree/task/topology.h"
@@ -206,6 +209,155 @@ static void iree_task_topology_group_initialize_from_core(
                                                      out_group);
 }
 
+// System-wide information used to classify cores by performance level.
+// cpuinfo only distinguishes heterogeneous cores by uarch and doesn't know
+// about most hybrid parts so on Linux we prefer what the kernel reports.
+typedef struct iree_task_topology_core_levels_t {
+  // Lowest and highest cpu_capacity of any processor or 0 if the kernel does
+  // not report capacities (only ARM/RISC-V kernels do). Capacities are
+  // normalized such that the fastest processor in the system is 1024.
+  uint32_t min_capacity;
+  uint32_t max_capacity;
+  // Contents of /sys/devices/cpu_atom/cpus listing the efficiency cores of
+  // Intel hybrid parts in kernel cpu list format (`16-23`) or empty if the
+  // system is not hybrid.
+  char atom_cpus[256];
+} iree_task_topology_core_levels_t;
+
+#if defined(__linux__)
+
+// Reads up to |capacity| - 1 characters of the sysfs file at |path| into
+// |buffer| and NUL terminates it. Returns false if the file could not be read.
+static bool iree_task_topology_read_sysfs_string(const char* path,
+                                                 char* buffer,
+                                                 size_t capacity) {
+  buffer[0] = 0;
+  FILE* file = fopen(path, "rb");
+  if (!file) return false;
+  size_t length = fread(buffer, 1, capacity - 1, file);
+  fclose(file);
+  buffer[length] = 0;
+  return length > 0;
+}
+
+// Returns the kernel-reported capacity of logical processor |linux_id| or 0 if
+// not available.
+static uint32_t iree_task_topology_read_cpu_capacity(uint32_t linux_id) {
+  char path[64];
+  snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%u/cpu_capacity",
+           linux_id);
+  char buffer[32];
+  if (!iree_task_topology_read_sysfs_string(path, buffer, sizeof(buffer))) {
+    return 0;
+  }
+  uint32_t capacity = 0;
+  if (!iree_string_view_atoi_uint32(
+          iree_string_view_trim(iree_make_cstring_view(buffer)), &capacity)) {
+    return 0;
+  }
+  return capacity;
+}
+
+// Returns true if |cpu_id| is included in the kernel cpu |list| (`0-3,8`).
+static bool iree_task_topology_cpu_list_contains(iree_string_view_t list,
+                                                 uint32_t cpu_id) {
+  while (!iree_string_view_is_empty(list)) {
+    iree_string_view_t range = iree_string_view_empty();
+    iree_string_view_split(list, ',', &range, &list);
+    iree_string_view_t first_str = iree_string_view_empty();
+    iree_string_view_t last_str = iree_string_view_empty();
+    const bool is_range =
+        iree_string_view_split(range, '-', &first_str, &last_str) != -1;
+    uint32_t first = 0;
+    if (!iree_string_view_atoi_uint32(iree_string_view_trim(first_str),
+                                      &first)) {
+      continue;
+    }
+    uint32_t last = first;
+    if (is_range && !iree_string_view_atoi_uint32(
+                        iree_string_view_trim(last_str), &last)) {
+      continue;
+    }
+    if (cpu_id >= first && cpu_id <= last) return true;
+  }
+  return false;
+}
+
+#endif  // __linux__
+
+// Queries the system-wide core performance information into |out_levels|.
+static void iree_task_topology_query_core_levels(
+    iree_task_topology_core_levels_t* out_levels) {
+  memset(out_levels, 0, sizeof(*out_levels));
+#if defined(__linux__)
+  // Intel hybrid parts expose a PMU per core type.
+  iree_task_topology_read_sysfs_string("/sys/devices/cpu_atom/cpus",
+                                       out_levels->atom_cpus,
+                                       sizeof(out_levels->atom_cpus));
+  // ARM big.LITTLE/DynamIQ expose the relative capacity of each processor.
+  // Kernels that don't support capacities won't have the file for any
+  // processor so we stop early if the first one is missing.
+  for (uint32_t i = 0; i < cpuinfo_get_processors_count(); ++i) {
+    const struct cpuinfo_processor* processor = cpuinfo_get_processor(i);
+    uint32_t capacity =
+        iree_task_topology_read_cpu_capacity(processor->linux_id);
+    if (!capacity) break;
+    out_levels->min_capacity =
+        i ? iree_min(out_levels->min_capacity, capacity) : capacity;
+    out_levels->max_capacity = iree_max(out_levels->max_capacity, capacity);
+  }
+#endif  // __linux__
+}
+
+// Returns the performance level of the core |processor| is on or
+// IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY if the cores are homogeneous or the
+// level cannot be determined.
+static iree_task_topology_performance_level_t
+iree_task_topology_query_core_performance_level(
+    const iree_task_topology_core_levels_t* levels,
+    const struct cpuinfo_processor* processor) {
+#if defined(__linux__)
+  if (levels->atom_cpus[0]) {
+    return iree_task_topology_cpu_list_contains(
+               iree_make_cstring_view(levels->atom_cpus), processor->linux_id)
+               ? IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW
+               : IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH;
+  }
+  if (levels->min_capacity * 2 < levels->max_capacity) {
+    // Cores with less than half the capacity of the fastest core are treated
+    // as efficiency cores. On three-tier designs (prime/big/LITTLE) this groups
+    // the mid cores with the performance cores. Systems where all cores are
+    // within 2x of each other are treated as homogeneous.
+    uint32_t capacity =
+        iree_task_topology_read_cpu_capacity(processor->linux_id);
+    if (capacity) {
+      return capacity * 2 < levels->max_capacity
+                 ? IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW
+                 : IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH;
+    }
+  }
+#endif  // __linux__
+  // cpuinfo doesn't expose performance levels and instead we have to switch on
+  // uarch - yuck.
+  switch (processor->core->uarch) {
+    default:
+      // Unknown or homogeneous.
+      return IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY;
+    case cpuinfo_uarch_monsoon:    // Apple A11 big core
+    case cpuinfo_uarch_vortex:     // Apple A12 big core
+    case cpuinfo_uarch_lightning:  // Apple A13 big core
+    case cpuinfo_uarch_firestorm:  // Apple A14 big core
+    case cpuinfo_uarch_avalanche:  // Apple A15 big core
+      return IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH;
+    case cpuinfo_uarch_mistral:   // Apple A11 little core
+    case cpuinfo_uarch_tempest:   // Apple A12 little core
+    case cpuinfo_uarch_thunder:   // Apple A13 little core
+    case cpuinfo_uarch_icestorm:  // Apple A14 little core
+    case cpuinfo_uarch_blizzard:  // Apple A15 little core
+      return IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW;
+  }
+}
+
 // Returns a bitset with all *processors* that share the same |cache|.
 static uint64_t iree_task_topology_calculate_cache_bits(
     const struct cpuinfo_cache* cache) {
@@ -302,12 +454,18 @@ iree_status_t iree_task_topology_initialize_from_logical_cpu_set(
 
   iree_task_topology_initialize(out_topology);
 
+  iree_task_topology_core_levels_t core_levels;
+  iree_task_topology_query_core_levels(&core_levels);
+
   out_topology->group_count = cpu_count;
   for (iree_host_size_t i = 0; i < cpu_count; ++i) {
     const struct cpuinfo_processor* processor =
         cpuinfo_get_processor(cpu_ids[i]);
-    iree_task_topology_group_initialize_from_processor(
-        i, processor, &out_topology->groups[i]);
+    iree_task_topology_group_t* group = &out_topology->groups[i];
+    iree_task_topology_group_initialize_from_processor(i, processor, group);
+    group->performance_level =
+        iree_task_topology_query_core_performance_level(&core_levels,
+                                                        processor);
   }
 
   iree_status_t status =
@@ -324,6 +482,7 @@ typedef bool (*iree_task_topology_core_filter_t)(
 typedef struct iree_task_topology_core_filter_params_t {
   uint32_t cluster_id;
   iree_task_topology_performance_level_t performance_level;
+  const iree_task_topology_core_levels_t* core_levels;
 } iree_task_topology_core_filter_params_t;
 
 // Matches all cores that have the provided cluster ID.
@@ -335,30 +494,12 @@ static bool iree_task_topology_core_filter_by_cluster_id(
       core->cluster->cluster_id != params->cluster_id) {
     return false;
   }
-  // cpuinfo doesn't expose performance levels and instead we have to switch on
-  // uarch - yuck.
-  iree_task_topology_performance_level_t core_performance_level =
-      IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY;
-  switch (core->uarch) {
-    default:
-      // Unknown or homogeneous.
-      core_performance_level = IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY;
-      break;
-    case cpuinfo_uarch_monsoon:    // Apple A11 big core
-    case cpuinfo_uarch_vortex:     // Apple A12 big core
-    case cpuinfo_uarch_lightning:  // Apple A13 big core
-    case cpuinfo_uarch_firestorm:  // Apple A14 big core
-    case cpuinfo_uarch_avalanche:  // Apple A15 big core
-      core_performance_level = IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH;
-      break;
-    case cpuinfo_uarch_mistral:   // Apple A11 little core
-    case cpuinfo_uarch_tempest:   // Apple A12 little core
-    case cpuinfo_uarch_thunder:   // Apple A13 little core
-    case cpuinfo_uarch_icestorm:  // Apple A14 little core
-    case cpuinfo_uarch_blizzard:  // Apple A15 little core
-      core_performance_level = IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW;
-      break;
+  if (params->performance_level == IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY) {
+    return true;
   }
+  iree_task_topology_performance_level_t core_performance_level =
+      iree_task_topology_query_core_performance_level(
+          params->core_levels, cpuinfo_get_processor(core->processor_start));
   if (core_performance_level == IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY) {
     // Unable to distinguish/homogenous cores, always match.
     return true;
@@ -367,12 +508,15 @@ static bool iree_task_topology_core_filter_by_cluster_id(
 }
 
 // Initializes a topology with one group for each core that matches |filter_fn|.
+// When the cores are heterogeneous the performance cores are selected first so
+// that if |max_core_count| limits the selection the fastest cores are used.
 //
 // If cpuinfo is not available this falls back to the same behavior as
 // iree_task_topology_initialize_from_physical_cores.
 static iree_status_t
 iree_task_topology_initialize_from_physical_cores_with_filter(
     iree_task_topology_core_filter_t filter_fn, void* filter_fn_data,
+    const iree_task_topology_core_levels_t* core_levels,
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
   if (!iree_task_topology_is_cpuinfo_available()) {
     iree_task_topology_initialize_fallback(max_core_count, out_topology);
@@ -393,22 +537,35 @@ iree_task_topology_initialize_from_physical_cores_with_filter(
 
   iree_task_topology_initialize(out_topology);
 
-  // Build each core up to the max allowed.
+  // Build each core up to the max allowed. The first pass takes all cores
+  // except efficiency cores and the second pass takes the efficiency cores such
+  // that they are only used once all performance cores have been assigned.
   // TODO(benvanik): if our group_count <= core_count/2 then distribute better;
   // for now we just do a straight-line through (cores 0-N) when instead we may
   // want to take advantage of L3 cache info (half of groups on one L3 cache,
   // half of groups on another, etc).
   out_topology->group_count = core_count;
-  for (uint32_t core_i = 0, group_i = 0; group_i < out_topology->group_count;
-       ++core_i) {
-    // Rotate the core ID so that we avoid setting the affinity to the calling
-    // thread which we assume is something the user has plans for and doesn't
-    // want to have our workers stealing their time.
-    const struct cpuinfo_core* core =
-        cpuinfo_get_core(iree_task_topology_rotate_from_base_core(core_i));
-    if (filter_fn(core, filter_fn_data)) {
-      iree_task_topology_group_initialize_from_core(
-          group_i, core, &out_topology->groups[group_i]);
+  uint32_t group_i = 0;
+  for (int pass = 0; pass < 2; ++pass) {
+    for (uint32_t core_i = 0;
+         core_i < cpuinfo_get_cores_count() &&
+         group_i < out_topology->group_count;
+         ++core_i) {
+      // Rotate the core ID so that we avoid setting the affinity to the calling
+      // thread which we assume is something the user has plans for and doesn't
+      // want to have our workers stealing their time.
+      const struct cpuinfo_core* core =
+          cpuinfo_get_core(iree_task_topology_rotate_from_base_core(core_i));
+      if (!filter_fn(core, filter_fn_data)) continue;
+      iree_task_topology_performance_level_t core_performance_level =
+          iree_task_topology_query_core_performance_level(
+              core_levels, cpuinfo_get_processor(core->processor_start));
+      const bool is_efficiency_core =
+          core_performance_level == IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW;
+      if (is_efficiency_core != (pass == 1)) continue;
+      iree_task_topology_group_t* group = &out_topology->groups[group_i];
+      iree_task_topology_group_initialize_from_core(group_i, core, group);
+      group->performance_level = core_performance_level;
       ++group_i;
     }
   }
@@ -423,13 +580,21 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
     iree_task_topology_node_id_t node_id,
     iree_task_topology_performance_level_t performance_level,
     iree_host_size_t max_core_count, iree_task_topology_t* out_topology) {
+  iree_task_topology_core_levels_t core_levels;
+  iree_task_topology_query_core_levels(&core_levels);
   iree_task_topology_core_filter_params_t params = {
       .cluster_id = node_id,
       .performance_level = performance_level,
+      .core_levels = &core_levels,
   };
-  return iree_task_topology_initialize_from_physical_cores_with_filter(
-      iree_task_topology_core_filter_by_cluster_id, &params, max_core_count,
-      out_topology);
+  IREE_RETURN_IF_ERROR(
+      iree_task_topology_initialize_from_physical_cores_with_filter(
+          iree_task_topology_core_filter_by_cluster_id, &params, &core_levels,
+          max_core_count, out_topology));
+  // Only cores from |node_id| were selected (unless it was ANY). If cpuinfo is
+  // unavailable there is only a single node.
+  out_topology->node_id = node_id;
+  return iree_ok_status();
 }
 
 #endif  // IREE_TASK_CPUINFO_DISABLED
@@ -148,6 +148,7 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)node_id);
 
   iree_task_topology_initialize(out_topology);
+  out_topology->node_id = node_id;
 
   // Total number of physical cores in the system of all types.
   int32_t total_physicalcpu_max = 0;
@@ -202,7 +203,21 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
     // perflevel[0], the next as perflevel[1], etc.
     int perflevel = 0;
     if (nperflevels > 1) {
-      perflevel = i < perflevels[0].physicalcpu_max ? 0 : 1;
+      switch (performance_level) {
+        default:
+        case IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY:
+          perflevel = i < perflevels[0].physicalcpu_max ? 0 : 1;
+          break;
+        case IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW:
+          perflevel = 1;
+          break;
+        case IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH:
+          perflevel = 0;
+          break;
+      }
+      group->performance_level = perflevel == 0
+                                     ? IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH
+                                     : IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW;
     }
     group->caches.l1_data = perflevels[perflevel].l1dcachesize;
     group->caches.l2_data = perflevels[perflevel].l2cachesize;
@@ -224,7 +239,9 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
         group->ideal_thread_affinity.smt = perflevel > 0 ? 1 : 0;
         break;
       case IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH:
-        // Try to avoid efficiency cores (but no way to do that).
+        // Try to avoid efficiency cores. There's no way to pin but workers
+        // with a high performance_level raise their QoS class which the
+        // scheduler uses to prefer performance cores.
         group->ideal_thread_affinity.smt = 0;
         break;
       case IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW:
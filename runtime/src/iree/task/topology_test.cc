@@ -20,6 +20,7 @@ TEST(TopologyTest, Lifetime) {
   iree_task_topology_initialize(&topology);
   EXPECT_GT(iree_task_topology_group_capacity(&topology), 0);
   EXPECT_EQ(0, iree_task_topology_group_count(&topology));
+  EXPECT_EQ(IREE_TASK_TOPOLOGY_NODE_ID_ANY, topology.node_id);
   iree_task_topology_deinitialize(&topology);
 }
 
@@ -145,4 +146,49 @@ TEST(TopologyTest, FromPhysicalCores) {
   iree_task_topology_deinitialize(&topology);
 }
 
+// Verifies that groups only report the requested performance level (or ANY if
+// the cores are homogeneous/unknown) and that performance cores are selected
+// before efficiency cores when all levels are requested.
+TEST(TopologyTest, FromPhysicalCoresPerformanceLevels) {
+  static constexpr iree_host_size_t kMaxGroupCount = 64;
+  for (auto performance_level : {IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW,
+                                 IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH}) {
+    iree_task_topology_t topology;
+    iree_task_topology_initialize(&topology);
+    IREE_ASSERT_OK(iree_task_topology_initialize_from_physical_cores(
+        IREE_TASK_TOPOLOGY_NODE_ID_ANY, performance_level, kMaxGroupCount,
+        &topology));
+    EnsureTopologyValid(kMaxGroupCount, &topology);
+    for (iree_host_size_t i = 0; i < iree_task_topology_group_count(&topology);
+         ++i) {
+      const iree_task_topology_group_t* group =
+          iree_task_topology_get_group(&topology, i);
+      if (group->performance_level !=
+          IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY) {
+        EXPECT_EQ(group->performance_level, performance_level);
+      }
+    }
+    iree_task_topology_deinitialize(&topology);
+  }
+
+  iree_task_topology_t topology;
+  iree_task_topology_initialize(&topology);
+  IREE_ASSERT_OK(iree_task_topology_initialize_from_physical_cores(
+      IREE_TASK_TOPOLOGY_NODE_ID_ANY, IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY,
+      kMaxGroupCount, &topology));
+  EnsureTopologyValid(kMaxGroupCount, &topology);
+  bool seen_efficiency_core = false;
+  for (iree_host_size_t i = 0; i < iree_task_topology_group_count(&topology);
+       ++i) {
+    const iree_task_topology_group_t* group =
+        iree_task_topology_get_group(&topology, i);
+    if (group->performance_level == IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW) {
+      seen_efficiency_core = true;
+    } else {
+      EXPECT_FALSE(seen_efficiency_core);
+    }
+  }
+  iree_task_topology_deinitialize(&topology);
+}
+
 }  // namespace
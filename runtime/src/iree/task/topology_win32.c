@@ -350,6 +350,7 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
   IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)node_id);
 
   iree_task_topology_initialize(out_topology);
+  out_topology->node_id = node_id;
 
   // Query the total size required for all information and allocate storage for
   // it on the stack - it's generally just a few KB.
@@ -516,35 +517,53 @@ iree_status_t iree_task_topology_initialize_from_physical_cores(
   // instead. How much this matters needs to be measured but it'd at least make
   // sense vs being random as it is now.
 
-  // Initialize all topology groups from the selected cores.
-  for (iree_host_size_t used_core_index = 0;
-       used_core_index < used_core_count;) {
-    iree_host_size_t adjusted_core_index = used_core_index;
-    if (base_core_index != -1) {
-      // Rotate the starting core index by the base core such that we only use
-      // the base core if all other available cores are utilized.
-      adjusted_core_index =
-          (((base_core_index + 1) % total_core_count) + used_core_index) %
-          total_core_count;
-    }
+  // Initialize all topology groups from the selected cores. Performance cores
+  // are assigned in the first pass and efficiency cores in the second so that
+  // when |max_core_count| limits the selection the fastest cores are used.
+  for (int pass = 0; pass < 2; ++pass) {
+    for (iree_host_size_t core_index = 0;
+         core_index < total_core_count &&
+         out_topology->group_count < used_core_count;
+         ++core_index) {
+      iree_host_size_t adjusted_core_index = core_index;
+      if (base_core_index != -1) {
+        // Rotate the starting core index by the base core such that we only
+        // use the base core if all other available cores are utilized.
+        adjusted_core_index =
+            (((base_core_index + 1) % total_core_count) + core_index) %
+            total_core_count;
+      }
 
-    PROCESSOR_RELATIONSHIP* core = all_cores[adjusted_core_index];
-    if (!iree_task_topology_core_is_selected(has_heterogeneous_cores,
-                                             performance_level, core)) {
-      // Core filtered out by performance level; skip and try to find another
-      // usable one. Note that cores with different performance levels may be
-      // arbitrarily distributed across the logical core domain.
-      continue;
+      PROCESSOR_RELATIONSHIP* core = all_cores[adjusted_core_index];
+      if (!group_table[core->GroupMask[0].Group].selected ||
+          !iree_task_topology_core_is_selected(has_heterogeneous_cores,
+                                               performance_level, core)) {
+        // Core filtered out by NUMA node or performance level. Note that cores
+        // with different performance levels may be arbitrarily distributed
+        // across the logical core domain.
+        continue;
+      }
+      iree_task_topology_performance_level_t core_performance_level =
+          IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_ANY;
+      if (has_heterogeneous_cores) {
+        core_performance_level =
+            core->EfficiencyClass == 0
+                ? IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW
+                : IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH;
+      }
+      const bool is_efficiency_core =
+          core_performance_level == IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_LOW;
+      if (is_efficiency_core != (pass == 1)) continue;
+
+      uint8_t group_index = (uint8_t)out_topology->group_count++;
+      iree_task_topology_group_t* group = &out_topology->groups[group_index];
+      iree_task_topology_group_initialize(group_index, group);
+      group->processor_index = (uint32_t)adjusted_core_index;
+      group->performance_level = core_performance_level;
+      group->constructive_sharing_mask = 0;  // set below
+      iree_task_topology_set_affinity_from_processor(
+          core, &group->ideal_thread_affinity);
     }
-    ++used_core_index;
-
-    uint8_t group_index = (uint8_t)out_topology->group_count++;
-    iree_task_topology_group_t* group = &out_topology->groups[group_index];
-    iree_task_topology_group_initialize(group_index, group);
-    group->processor_index = (uint32_t)adjusted_core_index;
-    group->constructive_sharing_mask = 0;  // set below
-    iree_task_topology_set_affinity_from_processor(
-        core, &group->ideal_thread_affinity);
   }
 
   // Assign constructive sharing masks to each topology group.
@@ -53,6 +53,33 @@ extern "C" {
 // 1ms may result in 10-15ms.
 #define IREE_TASK_EXECUTOR_DELAY_SLOP_NS (1 /*ms*/ * 1000000)
 
+// Maximum amount of time a donated thread will wait without checking for new
+// work. Threads donated to a threadless executor sleep until work is posted
+// and this only bounds how late a wait source resolved by an external thread
+// (such as a host semaphore signal) is noticed while there is nothing to
+// execute. Threads donated to an executor with workers block on their wait
+// source and this bounds how long they go without trying to steal new work.
+#define IREE_TASK_EXECUTOR_DONATION_POLL_INTERVAL_NS (1 /*ms*/ * 1000000)
+
+// Maximum number of threads that may concurrently donate themselves to an
+// executor with worker threads and steal work while their waits are pending.
+// Each donor slot has its own worker-local memory and worker index (following
+// those of the worker threads) so increasing this increases executor memory
+// consumption and the per-worker storage executables must reserve. Threads
+// donating while all slots are in use perform a system wait instead.
+// Setting this to 0 will disable work stealing by donated threads.
+#define IREE_TASK_EXECUTOR_MAX_DONOR_COUNT (4)
+
+// Maximum duration a worker will spin before parking when using
+// IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN and no worker_spin_ns was specified.
+// Workers only spin when their recent idle gaps were shorter than this.
+#define IREE_TASK_WORKER_ADAPTIVE_SPIN_MAX_NS (100 /*us*/ * 1000)
+
+// Weight (as a power of two) of each new idle gap in the moving average used
+// to predict the next idle gap with IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN.
+// Higher values adapt more slowly to changes in the workload.
+#define IREE_TASK_WORKER_ADAPTIVE_SPIN_AVERAGE_SHIFT (3)
+
 // Allows for dividing the total number of attempts that a worker will make to
 // steal tasks from other workers. By default all other workers will be
 // attempted while setting this to 2, for example, will try for only half of
@@ -80,9 +107,11 @@ extern "C" {
 #define IREE_TASK_EXECUTOR_MAX_THEFT_TASK_COUNT \
   IREE_TASK_EXECUTOR_MAX_WORKER_COUNT
 
-// Number of tiles that will be batched into a single reservation from the grid.
-// This is a maximum; if there are fewer tiles that would otherwise allow for
-// maximum parallelism then this may be ignored.
+// Maximum number of tiles that will be batched into a single reservation from
+// the grid. Shards use guided self-scheduling: reservations start at a single
+// tile, grow toward IREE_TASK_DISPATCH_TARGET_RESERVATION_NS based on the
+// measured tile time, and shrink as the grid drains so the tail is balanced.
+// This bounds how large reservations may grow for grids of very cheap tiles.
 //
 // The more tiles reserved at a time the higher the chance for latency to
 // increase as many reserved tiles are held up on one worker while another may
@@ -92,7 +121,12 @@ extern "C" {
 // destroying behavior where multiple workers all stomp on the same cache lines
 // (as say worker 0 and worker 1 both fight over sequential tiles adjacent in
 // memory).
-#define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (8)
+#define IREE_TASK_DISPATCH_MAX_TILES_PER_SHARD_RESERVATION (256)
+
+// Target duration of each tile reservation made by a dispatch shard.
+// Longer reservations reduce contention on the shared grid counter while
+// shorter ones allow for finer-grained balancing across shards.
+#define IREE_TASK_DISPATCH_TARGET_RESERVATION_NS (20 /*us*/ * 1000)
 
 // Whether to enable per-tile colors for each tile tracing zone based on the
 // tile grid xyz. Not cheap and can be disabled to reduce tracing overhead.
@@ -21,27 +21,29 @@
 
 static int iree_task_worker_main(iree_task_worker_t* worker);
 
-iree_status_t iree_task_worker_initialize(
+// Initializes the |out_worker| state shared by all kinds of workers.
+// The caller must set the worker bit and topology-derived fields.
+static void iree_task_worker_initialize_state(
     iree_task_executor_t* executor, iree_host_size_t worker_index,
-    const iree_task_topology_group_t* topology_group,
-    iree_host_size_t stack_size, iree_byte_span_t local_memory,
-    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
-  IREE_TRACE_ZONE_BEGIN(z0);
-
+    iree_byte_span_t local_memory, iree_prng_splitmix64_state_t* seed_prng,
+    iree_task_worker_t* out_worker) {
   out_worker->executor = executor;
   out_worker->worker_index = executor->worker_base_index + worker_index;
-  out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
-  out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
-  out_worker->constructive_sharing_mask =
-      topology_group->constructive_sharing_mask;
   out_worker->max_theft_attempts =
       executor->worker_count / IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR;
   iree_prng_minilcg128_initialize(iree_prng_splitmix64_next(seed_prng),
                                   &out_worker->theft_prng);
+  out_worker->idle_estimate_ns = executor->worker_spin_ns / 2;
   out_worker->local_memory = local_memory;
   out_worker->processor_id = 0;
   out_worker->processor_tag = 0;
 
+  iree_atomic_store(&out_worker->wake_pending, 0, iree_memory_order_relaxed);
+#if IREE_STATISTICS_ENABLE
+  iree_atomic_store(&out_worker->wake_request_time_ns, 0,
+                    iree_memory_order_relaxed);
+  memset(&out_worker->statistics, 0, sizeof(out_worker->statistics));
+#endif  // IREE_STATISTICS_ENABLE
   iree_notification_initialize(&out_worker->wake_notification);
   iree_notification_initialize(&out_worker->state_notification);
   iree_atomic_task_slist_initialize(&out_worker->mailbox_slist);
@@ -50,12 +52,47 @@ iree_status_t iree_task_worker_initialize(
   iree_task_worker_state_t initial_state = IREE_TASK_WORKER_STATE_RUNNING;
   iree_atomic_store(&out_worker->state, initial_state,
                     iree_memory_order_release);
+}
+
+iree_status_t iree_task_worker_initialize(
+    iree_task_executor_t* executor, iree_host_size_t worker_index,
+    const iree_task_topology_group_t* topology_group,
+    iree_host_size_t stack_size, iree_byte_span_t local_memory,
+    iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_task_worker_initialize_state(executor, worker_index, local_memory,
+                                    seed_prng, out_worker);
+  out_worker->worker_bit = iree_task_affinity_for_worker(worker_index);
+  out_worker->ideal_thread_affinity = topology_group->ideal_thread_affinity;
+  out_worker->constructive_sharing_mask =
+      topology_group->constructive_sharing_mask;
+
+  // Threadless executors have a single worker that is only ever pumped by
+  // donated threads (see iree_task_worker_pump_until_resolved). There's no
+  // thread to touch the local memory first so do it here.
+  if (executor->threadless) {
+    memset(local_memory.data, 0, local_memory.data_length);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
 
   iree_thread_create_params_t thread_params;
   memset(&thread_params, 0, sizeof(thread_params));
   thread_params.name = iree_make_cstring_view(topology_group->name);
   thread_params.create_suspended = false;
   thread_params.priority_class = IREE_THREAD_PRIORITY_CLASS_NORMAL;
+#if defined(IREE_PLATFORM_APPLE)
+  // Darwin doesn't support pinning and instead places threads on performance
+  // or efficiency cores based on their QoS class. The priority class maps to
+  // the QoS class there and the highest class keeps performance core workers
+  // from being migrated to efficiency cores. Elsewhere the priority class
+  // changes the scheduling policy and we rely on affinity for placement.
+  if (topology_group->performance_level ==
+      IREE_TASK_TOPOLOGY_PERFORMANCE_LEVEL_HIGH) {
+    thread_params.priority_class = IREE_THREAD_PRIORITY_CLASS_HIGHEST;
+  }
+#endif  // IREE_PLATFORM_APPLE
   thread_params.initial_affinity = out_worker->ideal_thread_affinity;
   thread_params.stack_size =
       iree_max(IREE_TASK_WORKER_MIN_STACK_SIZE, stack_size);
@@ -71,8 +108,31 @@ iree_status_t iree_task_worker_initialize(
   return status;
 }
 
+void iree_task_worker_initialize_donor(iree_task_executor_t* executor,
+                                       iree_host_size_t worker_index,
+                                       iree_byte_span_t local_memory,
+                                       iree_prng_splitmix64_state_t* seed_prng,
+                                       iree_task_worker_t* out_worker) {
+  iree_task_worker_initialize_state(executor, worker_index, local_memory,
+                                    seed_prng, out_worker);
+  // Donors are not part of any worker set and may steal from any worker.
+  out_worker->worker_bit = 0;
+  iree_thread_affinity_set_any(&out_worker->ideal_thread_affinity);
+  out_worker->constructive_sharing_mask =
+      iree_task_affinity_set_ones(executor->worker_count);
+  // Donors may be acted as by any thread and have no preferred placement.
+  memset(local_memory.data, 0, local_memory.data_length);
+}
+
 void iree_task_worker_request_exit(iree_task_worker_t* worker) {
-  if (!worker->thread) return;
+  if (!worker->thread) {
+    // No thread to exit (threadless worker or thread creation failed). It's
+    // safe to transition directly to the zombie state as nothing can be
+    // pumping the worker during teardown.
+    iree_atomic_store(&worker->state, IREE_TASK_WORKER_STATE_ZOMBIE,
+                      iree_memory_order_release);
+    return;
+  }
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // If the thread is already in the exiting/zombie state we don't need to do
@@ -93,7 +153,7 @@ void iree_task_worker_request_exit(iree_task_worker_t* worker) {
   }
 
   // Kick the worker in case it is waiting for work.
-  iree_notification_post(&worker->wake_notification, 1);
+  iree_task_worker_wake_set(worker->executor, worker->worker_bit);
 
   IREE_TRACE_ZONE_END(z0);
 }
@@ -171,6 +231,186 @@ static void iree_task_worker_mark_idle(iree_task_worker_t* worker) {
                    (float)worker->executor->worker_count);
 }
 
+#if IREE_STATISTICS_ENABLE
+
+// Adds |delta| to a statistics |counter| that is only updated by the calling
+// thread. This avoids the cost of an atomic read-modify-write as concurrent
+// readers only need to observe a consistent value.
+static inline void iree_task_worker_statistics_add(
+    iree_atomic_int64_t* counter, int64_t delta) {
+  iree_atomic_store(
+      counter, iree_atomic_load(counter, iree_memory_order_relaxed) + delta,
+      iree_memory_order_relaxed);
+}
+
+#define IREE_TASK_WORKER_STATISTICS_ADD(worker, field, delta) \
+  iree_task_worker_statistics_add(&(worker)->statistics.field, (delta))
+
+// Records that a wake was requested at |now_ns| if one is not already pending.
+static void iree_task_worker_record_wake_request(iree_task_worker_t* worker,
+                                                 iree_time_t now_ns) {
+  int64_t expected = 0;
+  iree_atomic_compare_exchange_strong(
+      &worker->wake_request_time_ns, &expected, now_ns,
+      iree_memory_order_relaxed, iree_memory_order_relaxed);
+}
+
+// Consumes any pending wake request and records how long it took to observe.
+static void iree_task_worker_record_wake_observed(iree_task_worker_t* worker) {
+  if (!iree_atomic_load(&worker->wake_request_time_ns,
+                        iree_memory_order_relaxed)) {
+    return;  // no request pending; avoid the exchange
+  }
+  iree_time_t request_time_ns = iree_atomic_exchange(
+      &worker->wake_request_time_ns, 0, iree_memory_order_relaxed);
+  if (!request_time_ns) return;
+  IREE_TASK_WORKER_STATISTICS_ADD(worker, wake_requests, 1);
+  IREE_TASK_WORKER_STATISTICS_ADD(
+      worker, wake_latency_ns, iree_max(0, iree_time_now() - request_time_ns));
+}
+
+// Records an idle wait of |duration_ns| that ended due to a wake if |woken|.
+// Waits spin for up to |spin_ns| before sleeping and we attribute time to each
+// phase based on that.
+static void iree_task_worker_record_wait(iree_task_worker_t* worker,
+                                         iree_duration_t spin_ns,
+                                         iree_duration_t duration_ns,
+                                         bool woken) {
+  spin_ns = iree_min(duration_ns, spin_ns);
+  IREE_TASK_WORKER_STATISTICS_ADD(worker, spin_time_ns, spin_ns);
+  IREE_TASK_WORKER_STATISTICS_ADD(worker, sleep_time_ns, duration_ns - spin_ns);
+  if (woken) IREE_TASK_WORKER_STATISTICS_ADD(worker, wakeups, 1);
+}
+
+// Records the execution of a dispatch shard that ran |tile_count| tiles in
+// |duration_ns|.
+static void iree_task_worker_record_shard(iree_task_worker_t* worker,
+                                          uint32_t tile_count,
+                                          iree_duration_t duration_ns) {
+  IREE_TASK_WORKER_STATISTICS_ADD(worker, tiles_executed, tile_count);
+  IREE_TASK_WORKER_STATISTICS_ADD(worker, tile_time_ns, duration_ns);
+  if (!tile_count) return;
+  const uint64_t tile_ns = (uint64_t)iree_max(1, duration_ns / tile_count);
+  const int tile_log2 = 63 - iree_math_count_leading_zeros_u64(tile_ns);
+  const int bucket =
+      iree_min(iree_max(0, tile_log2 - 9),
+               IREE_TASK_EXECUTOR_TILE_HISTOGRAM_BUCKET_COUNT - 1);
+  IREE_TASK_WORKER_STATISTICS_ADD(worker, tile_histogram[bucket], tile_count);
+}
+
+#else
+
+#define IREE_TASK_WORKER_STATISTICS_ADD(worker, field, delta)
+#define iree_task_worker_record_wake_request(worker, now_ns)
+#define iree_task_worker_record_wake_observed(worker)
+#define iree_task_worker_record_wait(worker, spin_ns, duration_ns, woken)
+
+#endif  // IREE_STATISTICS_ENABLE
+
+void iree_task_worker_accumulate_statistics(
+    iree_task_worker_t* worker, iree_task_executor_statistics_t* statistics) {
+#if IREE_STATISTICS_ENABLE
+#define IREE_TASK_WORKER_STATISTICS_ACCUMULATE(field)                      \
+  statistics->field +=                                                     \
+      iree_atomic_load(&worker->statistics.field, iree_memory_order_relaxed)
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(tasks_executed);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(tiles_executed);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(tile_time_ns);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(steal_attempts);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(steal_successes);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(wakeups);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(wake_requests);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(wake_latency_ns);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(spin_time_ns);
+  IREE_TASK_WORKER_STATISTICS_ACCUMULATE(sleep_time_ns);
+  for (iree_host_size_t i = 0; i < IREE_ARRAYSIZE(statistics->tile_histogram);
+       ++i) {
+    IREE_TASK_WORKER_STATISTICS_ACCUMULATE(tile_histogram[i]);
+  }
+#undef IREE_TASK_WORKER_STATISTICS_ACCUMULATE
+#endif  // IREE_STATISTICS_ENABLE
+}
+
+#if IREE_NOTIFICATION_HAS_MASKED_WAKE
+
+// Returns the notification the worker waits on for new work.
+#define iree_task_worker_wake_notification(worker) \
+  (&(worker)->executor->worker_wake_notification)
+
+// Folds a set of executor-local workers into a 32-bit notification mask.
+// Workers whose bits alias share a mask bit and may be woken along with the
+// targeted worker; they will find their wake_pending flag clear and go back to
+// waiting without pumping.
+static inline uint32_t iree_task_worker_fold_wake_mask(
+    iree_task_affinity_set_t worker_mask) {
+  return (uint32_t)worker_mask | (uint32_t)(worker_mask >> 32);
+}
+
+void iree_task_worker_wake_set(iree_task_executor_t* executor,
+                               iree_task_affinity_set_t worker_mask) {
+  if (!worker_mask) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, iree_math_count_ones_u64(worker_mask));
+
+  // Flag each worker before posting so that they can tell the wake was meant
+  // for them. The post acts as a release of these stores.
+#if IREE_STATISTICS_ENABLE
+  const iree_time_t now_ns = iree_time_now();
+#endif  // IREE_STATISTICS_ENABLE
+  iree_task_affinity_set_t remaining_mask = worker_mask;
+  while (remaining_mask) {
+    int worker_index = iree_task_affinity_set_count_trailing_zeros(
+        remaining_mask);
+    remaining_mask &= remaining_mask - 1;
+    iree_task_worker_record_wake_request(&executor->workers[worker_index],
+                                         now_ns);
+    iree_atomic_store(&executor->workers[worker_index].wake_pending, 1,
+                      iree_memory_order_relaxed);
+  }
+
+  // Wake all of the workers in a single syscall (if any are waiting at all).
+  iree_notification_post_masked(&executor->worker_wake_notification,
+                                iree_task_worker_fold_wake_mask(worker_mask));
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+#else
+
+// Returns the notification the worker waits on for new work.
+#define iree_task_worker_wake_notification(worker) \
+  (&(worker)->wake_notification)
+
+void iree_task_worker_wake_set(iree_task_executor_t* executor,
+                               iree_task_affinity_set_t worker_mask) {
+  if (!worker_mask) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, iree_math_count_ones_u64(worker_mask));
+
+  // Without masked wakes each worker has its own notification and must be
+  // woken individually. Workers are the only thing that can wait on these
+  // notifications so this should almost always be either free (an atomic
+  // load) if a particular worker isn't waiting or it's required to actually
+  // wake it and we can't avoid it.
+#if IREE_STATISTICS_ENABLE
+  const iree_time_t now_ns = iree_time_now();
+#endif  // IREE_STATISTICS_ENABLE
+  iree_task_affinity_set_t remaining_mask = worker_mask;
+  while (remaining_mask) {
+    int worker_index = iree_task_affinity_set_count_trailing_zeros(
+        remaining_mask);
+    remaining_mask &= remaining_mask - 1;
+    iree_task_worker_record_wake_request(&executor->workers[worker_index],
+                                         now_ns);
+    iree_notification_post(&executor->workers[worker_index].wake_notification,
+                           1);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
+#endif  // IREE_NOTIFICATION_HAS_MASKED_WAKE
+
 void iree_task_worker_post_tasks(iree_task_worker_t* worker,
                                  iree_task_list_t* list) {
   // Move the list into the mailbox. Note that the mailbox is LIFO and this list
@@ -215,9 +455,18 @@ static void iree_task_worker_execute(
       break;
     }
     case IREE_TASK_TYPE_DISPATCH_SHARD: {
+#if IREE_STATISTICS_ENABLE
+      const iree_time_t start_time_ns = iree_time_now();
+      const uint32_t tile_count = iree_task_dispatch_shard_execute(
+          (iree_task_dispatch_shard_t*)task, worker->processor_id,
+          worker->worker_index, worker->local_memory, pending_submission);
+      iree_task_worker_record_shard(worker, tile_count,
+                                    iree_time_now() - start_time_ns);
+#else
       iree_task_dispatch_shard_execute(
           (iree_task_dispatch_shard_t*)task, worker->processor_id,
           worker->worker_index, worker->local_memory, pending_submission);
+#endif  // IREE_STATISTICS_ENABLE
       break;
     }
     default:
@@ -227,6 +476,7 @@ static void iree_task_worker_execute(
 
   // NOTE: task is invalidated above and must not be used!
   task = NULL;
+  IREE_TASK_WORKER_STATISTICS_ADD(worker, tasks_executed, 1);
 }
 
 // Pumps the worker thread once, processing a single task.
@@ -265,6 +515,8 @@ static bool iree_task_worker_pump_once(
         worker->executor, worker->constructive_sharing_mask,
         worker->max_theft_attempts, &worker->theft_prng,
         &worker->local_task_queue);
+    IREE_TASK_WORKER_STATISTICS_ADD(worker, steal_attempts, 1);
+    IREE_TASK_WORKER_STATISTICS_ADD(worker, steal_successes, task ? 1 : 0);
   }
 #endif  // IREE_TASK_EXECUTOR_MAX_THEFT_ATTEMPTS_DIVISOR > 0
 
@@ -287,6 +539,74 @@ static void iree_task_worker_update_processor_id(iree_task_worker_t* worker) {
   iree_cpu_requery_processor_id(&worker->processor_tag, &worker->processor_id);
 }
 
+// Returns the duration the worker should spin before parking when idle.
+// With IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN workers spin for about twice
+// their predicted idle gap when it is within the executor spin budget and park
+// immediately when work isn't expected to arrive soon.
+static iree_duration_t iree_task_worker_select_spin_ns(
+    iree_task_worker_t* worker) {
+  iree_task_executor_t* executor = worker->executor;
+  if (!(executor->scheduling_mode & IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN)) {
+    return executor->worker_spin_ns;
+  }
+  if (worker->idle_estimate_ns > executor->worker_spin_ns) {
+    return IREE_DURATION_ZERO;
+  }
+  return iree_min(worker->idle_estimate_ns * 2, executor->worker_spin_ns);
+}
+
+// Updates the predicted idle gap of |worker| after it was idle for
+// |idle_ns| before being woken. Gaps are clamped to twice the spin budget so
+// that a single long idle period doesn't stop spinning during the next burst
+// but several in a row will.
+static void iree_task_worker_update_idle_estimate(iree_task_worker_t* worker,
+                                                  iree_duration_t idle_ns) {
+  const iree_duration_t max_idle_ns = worker->executor->worker_spin_ns * 2;
+  idle_ns = iree_min(idle_ns, max_idle_ns);
+  worker->idle_estimate_ns +=
+      (idle_ns - worker->idle_estimate_ns) /
+      (1 << IREE_TASK_WORKER_ADAPTIVE_SPIN_AVERAGE_SHIFT);
+}
+
+// Waits until the worker is woken with iree_task_worker_wake_set or
+// |deadline_ns| is reached. Returns false if the deadline was reached.
+// |wait_token| must have been prepared on the worker wake notification prior to
+// the worker checking for work. The worker spins for up to |spin_ns| before
+// parking in the kernel.
+static bool iree_task_worker_wait_for_wake(iree_task_worker_t* worker,
+                                           iree_wait_token_t wait_token,
+                                           iree_duration_t spin_ns,
+                                           iree_time_t deadline_ns) {
+  iree_notification_t* notification =
+      iree_task_worker_wake_notification(worker);
+#if IREE_NOTIFICATION_HAS_MASKED_WAKE
+  // Wakes targeting other workers that share the notification also advance
+  // its epoch and end our wait. Keep waiting until a wake was meant for us so
+  // that idle workers don't repeatedly contend on coordination.
+  const uint32_t wait_mask =
+      iree_task_worker_fold_wake_mask(worker->worker_bit);
+  while (true) {
+    if (!iree_notification_commit_wait_masked(
+            notification, wait_token, wait_mask, spin_ns, deadline_ns)) {
+      return false;
+    }
+    if (iree_atomic_exchange(&worker->wake_pending, 0,
+                             iree_memory_order_acquire)) {
+      return true;
+    }
+    wait_token = iree_notification_prepare_wait(notification);
+    if (iree_atomic_exchange(&worker->wake_pending, 0,
+                             iree_memory_order_acquire)) {
+      iree_notification_cancel_wait(notification);
+      return true;
+    }
+  }
+#else
+  return iree_notification_commit_wait(notification, wait_token, spin_ns,
+                                       deadline_ns);
+#endif  // IREE_NOTIFICATION_HAS_MASKED_WAKE
+}
+
 // Alternates between pumping ready tasks in the worker queue and waiting
 // for more tasks to arrive. Only returns when the worker has been asked by
 // the executor to exit.
@@ -296,6 +616,9 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
   // be able to process it with the proper processor ID immediately.
   iree_task_worker_update_processor_id(worker);
 
+  iree_notification_t* wake_notification =
+      iree_task_worker_wake_notification(worker);
+
   // Pump the thread loop to process more tasks.
   while (true) {
     // If we fail to find any work to do we'll wait at the end of this loop.
@@ -304,7 +627,12 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     // will prevent the wait from happening if anyone touches the data
     // structures we use.
     iree_wait_token_t wait_token =
-        iree_notification_prepare_wait(&worker->wake_notification);
+        iree_notification_prepare_wait(wake_notification);
+
+    // Any wake requested from here on will advance the notification epoch so
+    // prior requests have been observed by the pump below.
+    iree_atomic_store(&worker->wake_pending, 0, iree_memory_order_relaxed);
+    iree_task_worker_record_wake_observed(worker);
 
     // Now active until we decide to go back to sleep until the next pump.
     iree_task_worker_mark_active(worker);
@@ -313,7 +641,7 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     if (iree_atomic_load(&worker->state, iree_memory_order_acquire) ==
         IREE_TASK_WORKER_STATE_EXITING) {
       // Thread exit requested - cancel pumping.
-      iree_notification_cancel_wait(&worker->wake_notification);
+      iree_notification_cancel_wait(wake_notification);
       // TODO(benvanik): complete tasks before exiting?
       break;
     }
@@ -356,16 +684,19 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
     if (schedule_dirty ||
         !iree_task_queue_is_empty(&worker->local_task_queue)) {
       // Have more work to do; loop around to try another pump.
-      iree_notification_cancel_wait(&worker->wake_notification);
+      iree_notification_cancel_wait(wake_notification);
     } else {
       // Spin/wait in the kernel. We don't care if the condition fails as we're
       // just using it as a pulse.
       IREE_TRACE_ZONE_BEGIN_NAMED(z_wait,
                                   "iree_task_worker_main_pump_wake_wait");
-      iree_notification_commit_wait(
-          &worker->wake_notification, wait_token,
-          /*spin_ns=*/worker->executor->worker_spin_ns,
-          /*deadline_ns=*/IREE_TIME_INFINITE_FUTURE);
+      const iree_duration_t spin_ns = iree_task_worker_select_spin_ns(worker);
+      const iree_time_t wait_start_ns = iree_time_now();
+      const bool woken = iree_task_worker_wait_for_wake(
+          worker, wait_token, spin_ns, IREE_TIME_INFINITE_FUTURE);
+      const iree_duration_t wait_ns = iree_time_now() - wait_start_ns;
+      iree_task_worker_record_wait(worker, spin_ns, wait_ns, woken);
+      if (woken) iree_task_worker_update_idle_estimate(worker, wait_ns);
       IREE_TRACE_ZONE_END(z_wait);
 
       // Woke from a wait - query the processor ID in case we migrated during
@@ -379,6 +710,169 @@ static void iree_task_worker_pump_until_exit(iree_task_worker_t* worker) {
   }
 }
 
+// Pumps the worker from the calling thread until there are no more tasks ready
+// for it. Returns true if any work was performed. The caller must hold the
+// executor donation_mutex.
+static bool iree_task_worker_pump_until_idle(iree_task_worker_t* worker) {
+  iree_task_worker_mark_active(worker);
+  iree_task_worker_record_wake_observed(worker);
+
+  // Coordinate first so that any tasks submitted prior to donation (and not
+  // yet flushed) are routed directly to our local queue.
+  iree_task_executor_coordinate(worker->executor, worker);
+
+  bool did_work = false;
+  bool schedule_dirty = false;
+  do {
+    iree_task_submission_t pending_submission;
+    iree_task_submission_initialize(&pending_submission);
+    while (iree_task_worker_pump_once(worker, &pending_submission)) {
+      did_work = true;
+    }
+
+    // Tasks readied by those we executed must go back through coordination
+    // as they may have to be issued (dispatches) or retired (barriers/fences).
+    schedule_dirty = !iree_task_submission_is_empty(&pending_submission);
+    if (schedule_dirty) {
+      iree_task_executor_merge_submission(worker->executor,
+                                          &pending_submission);
+      iree_task_executor_coordinate(worker->executor, worker);
+    }
+  } while (schedule_dirty ||
+           !iree_task_queue_is_empty(&worker->local_task_queue));
+
+  iree_task_worker_mark_idle(worker);
+  return did_work;
+}
+
+iree_status_t iree_task_worker_pump_until_resolved(
+    iree_task_worker_t* worker, iree_wait_source_t wait_source,
+    iree_time_t deadline_ns) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_task_executor_t* executor = worker->executor;
+
+  // We cannot rely on the state of the donated thread and must be explicit
+  // about what tasks expect just as the worker threads are.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_task_worker_update_processor_id(worker);
+
+  iree_notification_t* wake_notification =
+      iree_task_worker_wake_notification(worker);
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    // Prepare the wait before checking for work so that any work posted after
+    // we've checked will prevent us from sleeping (same as the worker pump).
+    iree_wait_token_t wait_token =
+        iree_notification_prepare_wait(wake_notification);
+    iree_atomic_store(&worker->wake_pending, 0, iree_memory_order_relaxed);
+
+    // Act as the worker if no other donated thread is currently doing so. If
+    // one is then it will be running any tasks we'd want and we can sleep as
+    // though there was no work available.
+    bool did_work = false;
+    if (iree_slim_mutex_try_lock(&executor->donation_mutex)) {
+      did_work = iree_task_worker_pump_until_idle(worker);
+      iree_slim_mutex_unlock(&executor->donation_mutex);
+    }
+
+    // Check to see if the work we did (or something else) resolved the wait.
+    status = iree_wait_source_wait_one(wait_source, iree_immediate_timeout());
+    if (!iree_status_is_deadline_exceeded(status)) {
+      iree_notification_cancel_wait(wake_notification);
+      break;
+    }
+    iree_status_ignore(status);
+    status = iree_ok_status();
+
+    iree_time_t now_ns = iree_time_now();
+    if (now_ns >= deadline_ns) {
+      iree_notification_cancel_wait(wake_notification);
+      status = iree_status_from_code(IREE_STATUS_DEADLINE_EXCEEDED);
+      break;
+    } else if (did_work) {
+      // Performing work may have readied more; loop around to try again.
+      iree_notification_cancel_wait(wake_notification);
+      continue;
+    }
+
+    // Sleep until more work is posted. We don't know what will resolve the
+    // wait source and need to periodically poll it in case it was another
+    // thread.
+    IREE_TRACE_ZONE_BEGIN_NAMED(z_wait, "iree_task_worker_donation_wait");
+    iree_time_t wake_deadline_ns =
+        iree_min(deadline_ns,
+                 now_ns + IREE_TASK_EXECUTOR_DONATION_POLL_INTERVAL_NS);
+    // NOTE: multiple donated threads may be waiting here concurrently so we
+    // use the fixed spin budget instead of the adaptive worker estimate.
+    if (iree_task_worker_wait_for_wake(worker, wait_token,
+                                       executor->worker_spin_ns,
+                                       wake_deadline_ns)) {
+      iree_task_worker_update_processor_id(worker);
+    }
+    IREE_TRACE_ZONE_END(z_wait);
+  }
+
+  iree_fpu_state_pop(fpu_state);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_task_worker_steal_until_resolved(
+    iree_task_worker_t* donor, iree_wait_source_t wait_source,
+    iree_time_t deadline_ns) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // We cannot rely on the state of the donated thread and must be explicit
+  // about what tasks expect just as the worker threads are.
+  iree_fpu_state_t fpu_state =
+      iree_fpu_state_push(IREE_FPU_STATE_FLAG_FLUSH_DENORMALS_TO_ZERO);
+  iree_task_worker_update_processor_id(donor);
+
+  iree_status_t status = iree_ok_status();
+  while (true) {
+    // Steal a batch of tasks from the workers and execute all of them. Nothing
+    // can steal from donors so the batch must be completed before we can exit.
+    iree_task_submission_t pending_submission;
+    iree_task_submission_initialize(&pending_submission);
+    bool did_work = false;
+    while (iree_task_worker_pump_once(donor, &pending_submission)) {
+      did_work = true;
+      if (iree_task_queue_is_empty(&donor->local_task_queue)) break;
+    }
+    if (!iree_task_submission_is_empty(&pending_submission)) {
+      iree_task_executor_merge_submission(donor->executor,
+                                          &pending_submission);
+      iree_task_executor_coordinate(donor->executor, /*current_worker=*/NULL);
+    }
+
+    // Check to see if the work we did (or something else) resolved the wait.
+    // If there was nothing to steal then block on the wait source for a bit
+    // before trying to steal again.
+    iree_timeout_t timeout = iree_immediate_timeout();
+    if (!did_work) {
+      timeout = iree_make_deadline(iree_min(
+          deadline_ns,
+          iree_time_now() + IREE_TASK_EXECUTOR_DONATION_POLL_INTERVAL_NS));
+    }
+    status = iree_wait_source_wait_one(wait_source, timeout);
+    if (!iree_status_is_deadline_exceeded(status) ||
+        iree_time_now() >= deadline_ns) {
+      break;  // resolved, failed, or out of time
+    }
+    iree_status_ignore(status);
+    status = iree_ok_status();
+    if (!did_work) {
+      // Query the processor ID in case we migrated during the wait.
+      iree_task_worker_update_processor_id(donor);
+    }
+  }
+
+  iree_fpu_state_pop(fpu_state);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Thread entry point for each worker.
 static int iree_task_worker_main(iree_task_worker_t* worker) {
   IREE_TRACE_ZONE_BEGIN(thread_zone);
@@ -391,6 +885,10 @@ static int iree_task_worker_main(iree_task_worker_t* worker) {
   // TODO(benvanik): call this after waking in case CPU hotplugging happens.
   iree_thread_request_affinity(worker->thread, worker->ideal_thread_affinity);
 
+  // Touch our local memory first now that we are (hopefully) running on our
+  // ideal processor so that the OS places the pages near it.
+  memset(worker->local_memory.data, 0, worker->local_memory.data_length);
+
   // Enter the running state immediately. Note that we could have been requested
   // to exit while suspended/still starting up, so check that here before we
   // mess with any data structures.
@@ -53,6 +53,25 @@ typedef enum iree_task_worker_state_e {
 // techniques. The alignment of the entire iree_task_worker_t as well as the
 // alignment and padding between particular fields is carefully (though perhaps
 // not yet correctly) selected; see the 'LAYOUT' comments below.
+// Counters maintained by a worker for iree_task_executor_query_statistics.
+// Only the thread pumping the worker updates the counters (at most one at a
+// time) and it does so with plain relaxed load/store pairs; readers may observe
+// tears across fields but never torn values.
+typedef struct iree_task_worker_statistics_t {
+  iree_atomic_int64_t tasks_executed;
+  iree_atomic_int64_t tiles_executed;
+  iree_atomic_int64_t tile_time_ns;
+  iree_atomic_int64_t steal_attempts;
+  iree_atomic_int64_t steal_successes;
+  iree_atomic_int64_t wakeups;
+  iree_atomic_int64_t wake_requests;
+  iree_atomic_int64_t wake_latency_ns;
+  iree_atomic_int64_t spin_time_ns;
+  iree_atomic_int64_t sleep_time_ns;
+  iree_atomic_int64_t
+      tile_histogram[IREE_TASK_EXECUTOR_TILE_HISTOGRAM_BUCKET_COUNT];
+} iree_task_worker_statistics_t;
+
 typedef struct iree_task_worker_t {
   // A LIFO mailbox used by coordinators to post tasks to this worker.
   // As workers self-nominate to be coordinators and fan out dispatch shards
@@ -68,7 +87,23 @@ typedef struct iree_task_worker_t {
   //         accessed together.
   iree_atomic_int32_t state;
 
+  // Set when the worker has been requested to wake by iree_task_worker_wake_set
+  // and cleared by the worker when it wakes. Used with
+  // IREE_NOTIFICATION_HAS_MASKED_WAKE to distinguish wakes meant for this
+  // worker from those meant for others sharing the executor notification.
+  // LAYOUT: next to state for similar access patterns.
+  iree_atomic_int32_t wake_pending;
+
+#if IREE_STATISTICS_ENABLE
+  // Time at which a wake was first requested since the worker last observed
+  // one or 0 if none is pending. Used to measure wake latency.
+  // LAYOUT: next to wake_pending as wakers touch both.
+  iree_atomic_int64_t wake_request_time_ns;
+#endif  // IREE_STATISTICS_ENABLE
+
   // Notification signaled when the worker should wake (if it is idle).
+  // Unused if IREE_NOTIFICATION_HAS_MASKED_WAKE as all workers then wait on
+  // the executor worker_wake_notification.
   // LAYOUT: next to state for similar access patterns; when posting other
   //         threads will touch mailbox_slist and then send a wake
   //         notification.
@@ -107,8 +142,15 @@ typedef struct iree_task_worker_t {
   // Only ever touched by the worker thread as it steals work.
   iree_prng_minilcg128_state_t theft_prng;
 
+  // Moving average of the time the worker spent idle before being woken with
+  // more work. Used with IREE_TASK_SCHEDULING_MODE_ADAPTIVE_SPIN to decide how
+  // long to spin before parking. Only ever touched by the worker thread.
+  iree_duration_t idle_estimate_ns;
+
   // Thread handle of the worker. If the thread has exited the handle will
-  // remain valid so that the executor can query its state.
+  // remain valid so that the executor can query its state. NULL for donors and
+  // the worker of a threadless executor as they are only pumped by donated
+  // threads.
   iree_thread_t* thread;
 
   // Guess at the current processor ID.
@@ -142,6 +184,12 @@ typedef struct iree_task_worker_t {
   // of work of their own.
   // LAYOUT: must be 64b away from mailbox_slist.
   iree_task_queue_t local_task_queue;
+
+#if IREE_STATISTICS_ENABLE
+  // Counters updated by the worker as it executes tasks.
+  // LAYOUT: only touched by the thread pumping the worker and readers.
+  iree_task_worker_statistics_t statistics;
+#endif  // IREE_STATISTICS_ENABLE
 } iree_task_worker_t;
 static_assert(offsetof(iree_task_worker_t, mailbox_slist) +
                       sizeof(iree_atomic_task_slist_t) <
@@ -162,6 +210,16 @@ iree_status_t iree_task_worker_initialize(
     iree_host_size_t stack_size, iree_byte_span_t local_memory,
     iree_prng_splitmix64_state_t* seed_prng, iree_task_worker_t* out_worker);
 
+// Initializes a donor worker that threads donated to the executor act as while
+// stealing tasks from the other workers. Donors have no thread or worker bit
+// and nothing is ever posted to them. They must still go through the normal
+// shutdown sequence below.
+void iree_task_worker_initialize_donor(iree_task_executor_t* executor,
+                                       iree_host_size_t worker_index,
+                                       iree_byte_span_t local_memory,
+                                       iree_prng_splitmix64_state_t* seed_prng,
+                                       iree_task_worker_t* out_worker);
+
 // Requests that the worker begin exiting (if it hasn't already).
 // If the worker is actively processing tasks it will wait until it has
 // completed all it can and is about to go idle prior to exiting.
@@ -183,6 +241,14 @@ void iree_task_worker_await_exit(iree_task_worker_t* worker);
 //  - deinitialize all workers
 void iree_task_worker_deinitialize(iree_task_worker_t* worker);
 
+// Wakes each worker of |executor| indicated in |worker_mask| if it is idle.
+// Where supported (IREE_NOTIFICATION_HAS_MASKED_WAKE) all workers are woken
+// with a single system call and otherwise each worker is woken individually.
+//
+// May be called from any thread (including worker threads).
+void iree_task_worker_wake_set(iree_task_executor_t* executor,
+                               iree_task_affinity_set_t worker_mask);
+
 // Posts a FIFO list of tasks to the worker mailbox. The target worker takes
 // ownership of the tasks and will be woken if it is currently idle.
 //
@@ -199,6 +265,31 @@ iree_task_t* iree_task_worker_try_steal_task(iree_task_worker_t* worker,
                                              iree_task_queue_t* target_queue,
                                              iree_host_size_t max_tasks);
 
+// Pumps the threadless |worker| from the calling thread until |wait_source|
+// resolves or |deadline_ns| is reached. The caller executes all tasks posted
+// to the worker and sleeps while there are none. Returns
+// IREE_STATUS_DEADLINE_EXCEEDED if the deadline is reached first.
+//
+// May be called from any thread that is not already pumping the worker.
+iree_status_t iree_task_worker_pump_until_resolved(
+    iree_task_worker_t* worker, iree_wait_source_t wait_source,
+    iree_time_t deadline_ns);
+
+// Acts as the |donor| worker from the calling thread by stealing tasks from
+// the executor workers until |wait_source| resolves or |deadline_ns| is
+// reached. The caller blocks on |wait_source| while there is nothing to steal.
+// Returns IREE_STATUS_DEADLINE_EXCEEDED if the deadline is reached first.
+//
+// May only be called from the thread that has acquired the donor.
+iree_status_t iree_task_worker_steal_until_resolved(
+    iree_task_worker_t* donor, iree_wait_source_t wait_source,
+    iree_time_t deadline_ns);
+
+// Adds the counters of |worker| into |statistics|.
+// Thread-safe; the counters may be updated concurrently.
+void iree_task_worker_accumulate_statistics(
+    iree_task_worker_t* worker, iree_task_executor_statistics_t* statistics);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -17,6 +17,7 @@
 #include "iree/hal/local/plugins/registration/init.h"
 #include "iree/modules/hal/inline/module.h"
 #include "iree/modules/hal/loader/module.h"
+#include "iree/modules/hal/loader/thread_pool.h"
 #include "iree/modules/hal/module.h"
 #include "iree/tooling/device_util.h"
 #include "iree/tooling/modules/resolver.h"
@@ -120,6 +121,35 @@ static iree_status_t iree_tooling_load_dynamic_module(
   return status;
 }
 
+iree_status_t iree_tooling_load_module_from_path(
+    iree_vm_instance_t* instance, iree_string_view_t module_spec,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(out_module);
+  *out_module = NULL;
+
+  // We support `file.so@export_name?params` syntax to allow loading multiple
+  // modules from the same shared library and passing in parameters. When
+  // omitted we'll use the default export name.
+  iree_string_view_t path, export_name, params;
+  iree_string_view_split(module_spec, '@', &path, &export_name);
+  iree_string_view_split(export_name, '?', &export_name, &params);
+
+  // Load the module based on its (guessed) type.
+  if (iree_file_path_is_dynamic_library(path)) {
+    IREE_RETURN_IF_ERROR(
+        iree_tooling_load_dynamic_module(instance, path, export_name, params,
+                                         host_allocator, out_module),
+        "loading dynamic module at '%.*s'", (int)path.size, path.data);
+  } else {
+    IREE_RETURN_IF_ERROR(iree_tooling_load_bytecode_module(
+                             instance, path, host_allocator, out_module),
+                         "loading bytecode module at '%.*s'", (int)path.size,
+                         path.data);
+  }
+  return iree_ok_status();
+}
+
 iree_status_t iree_tooling_load_modules_from_flags(
     iree_vm_instance_t* instance, iree_allocator_t host_allocator,
     iree_tooling_module_list_t* list) {
@@ -136,29 +166,11 @@ iree_status_t iree_tooling_load_modules_from_flags(
   IREE_TRACE_ZONE_BEGIN(z0);
 
   for (iree_host_size_t i = 0; i < FLAG_module_list().count; ++i) {
-    // We support `file.so@export_name?params` syntax to allow loading multiple
-    // modules from the same shared library and passing in parameters. When
-    // omitted we'll use the default export name.
-    iree_string_view_t path, export_name, params;
-    iree_string_view_split(FLAG_module_list().values[i], '@', &path,
-                           &export_name);
-    iree_string_view_split(export_name, '?', &export_name, &params);
-
-    // Load the module based on its (guessed) type.
     iree_vm_module_t* module = NULL;
-    if (iree_file_path_is_dynamic_library(path)) {
-      IREE_RETURN_AND_END_ZONE_IF_ERROR(
-          z0,
-          iree_tooling_load_dynamic_module(instance, path, export_name, params,
-                                           host_allocator, &module),
-          "loading dynamic module at '%.*s'", (int)path.size, path.data);
-    } else {
-      IREE_RETURN_AND_END_ZONE_IF_ERROR(
-          z0,
-          iree_tooling_load_bytecode_module(instance, path, host_allocator,
-                                            &module),
-          "loading bytecode module at '%.*s'", (int)path.size, path.data);
-    }
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_tooling_load_module_from_path(
+                instance, FLAG_module_list().values[i], host_allocator,
+                &module));
 
     // Store loaded module in the list. It'll be the caller's responsibility to
     // clean it up even if we fail while loading more.
@@ -294,6 +306,12 @@ static iree_status_t iree_tooling_load_hal_inline_module(
   return status;
 }
 
+IREE_FLAG(
+    int32_t, loader_worker_count, 1,
+    "Number of threads, including the calling thread, used to execute the\n"
+    "workgroups of dispatches issued through the hal_loader module. Values\n"
+    "greater than 1 create a small fixed thread pool.");
+
 static iree_status_t iree_tooling_load_hal_loader_module(
     iree_vm_instance_t* instance, iree_allocator_t host_allocator,
     iree_vm_module_t** out_module) {
@@ -324,8 +342,23 @@ static iree_status_t iree_tooling_load_hal_loader_module(
   iree_vm_module_t* module = NULL;
   if (iree_status_is_ok(status)) {
     iree_hal_loader_module_flags_t flags = IREE_HAL_LOADER_MODULE_FLAG_NONE;
-    status = iree_hal_loader_module_create(instance, flags, loader_count,
-                                           loaders, host_allocator, &module);
+    iree_hal_loader_parallel_for_t parallel_for =
+        iree_hal_loader_parallel_for_null();
+    if (FLAG_loader_worker_count > 1) {
+      iree_hal_loader_thread_pool_t* thread_pool = NULL;
+      status = iree_hal_loader_thread_pool_create(
+          (iree_host_size_t)FLAG_loader_worker_count, host_allocator,
+          &thread_pool);
+      if (iree_status_is_ok(status)) {
+        parallel_for = iree_hal_loader_thread_pool_as_parallel_for(
+            thread_pool, /*take_ownership=*/true);
+      }
+    }
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_loader_module_create_with_parallel_for(
+          instance, flags, parallel_for, loader_count, loaders, host_allocator,
+          &module);
+    }
   }
 
   // Always release loaders; loader module has retained them.
@@ -588,6 +621,17 @@ iree_status_t iree_tooling_create_instance(iree_allocator_t host_allocator,
   return status;
 }
 
+// Returns the VM context flags requested by the command line flags.
+static iree_vm_context_flags_t iree_tooling_context_flags(void) {
+  iree_vm_context_flags_t flags = IREE_VM_CONTEXT_FLAG_NONE;
+  if (FLAG_trace_execution) {
+    // This enables tracing for all invocations but even if not set each
+    // invocation can have the flag specified to trace.
+    flags |= IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION;
+  }
+  return flags;
+}
+
 iree_status_t iree_tooling_create_context_from_flags(
     iree_vm_instance_t* instance, iree_host_size_t user_module_count,
     iree_vm_module_t** user_modules, iree_string_view_t default_device_uri,
@@ -613,19 +657,12 @@ iree_status_t iree_tooling_create_context_from_flags(
               instance, user_module_count, user_modules, default_device_uri,
               host_allocator, &resolved_list, &device, &device_allocator));
 
-  iree_vm_context_flags_t flags = IREE_VM_CONTEXT_FLAG_NONE;
-  if (FLAG_trace_execution) {
-    // This enables tracing for all invocations but even if not set each
-    // invocation can have the flag specified to trace.
-    flags |= IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION;
-  }
-
   // Create the context with the full list of resolved modules.
   // The context retains the modules and we can release them afterward.
   iree_vm_context_t* context = NULL;
   iree_status_t status = iree_vm_context_create_with_modules(
-      instance, flags, resolved_list.count, resolved_list.values,
-      host_allocator, &context);
+      instance, iree_tooling_context_flags(), resolved_list.count,
+      resolved_list.values, host_allocator, &context);
   iree_tooling_module_list_reset(&resolved_list);
 
   // If no device allocator was created we'll create a default one just so that
@@ -657,3 +694,34 @@ iree_status_t iree_tooling_create_context_from_flags(
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+iree_status_t iree_tooling_create_context_with_system_modules(
+    iree_vm_instance_t* instance,
+    const iree_tooling_module_list_t* system_modules,
+    iree_host_size_t user_module_count, iree_vm_module_t** user_modules,
+    iree_allocator_t host_allocator, iree_vm_context_t** out_context) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_ASSERT_ARGUMENT(system_modules);
+  IREE_ASSERT_ARGUMENT(!user_module_count || user_modules);
+  IREE_ASSERT_ARGUMENT(out_context);
+  *out_context = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // System modules never depend on user modules and are registered first.
+  iree_tooling_module_list_t module_list;
+  iree_tooling_module_list_clone(system_modules, &module_list);
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < user_module_count; ++i) {
+    status = iree_tooling_module_list_push_back(&module_list, user_modules[i]);
+    if (!iree_status_is_ok(status)) break;
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_context_create_with_modules(
+        instance, iree_tooling_context_flags(), module_list.count,
+        module_list.values, host_allocator, out_context);
+  }
+  iree_tooling_module_list_reset(&module_list);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -64,6 +64,13 @@ iree_status_t iree_tooling_resolve_modules(
     iree_hal_device_t** out_device,
     iree_hal_allocator_t** out_device_allocator);
 
+// Loads a single module from |module_spec| in the same form as the --module=
+// flag: either a path to a vmfb or a `file.so@export_name?params` dynamic
+// module specification.
+iree_status_t iree_tooling_load_module_from_path(
+    iree_vm_instance_t* instance, iree_string_view_t module_spec,
+    iree_allocator_t host_allocator, iree_vm_module_t** out_module);
+
 // Loads modules in the order specified by the --module= flag.
 // Appends the modules to the |list|.
 iree_status_t iree_tooling_load_modules_from_flags(
@@ -102,6 +109,20 @@ iree_status_t iree_tooling_create_context_from_flags(
     iree_hal_device_t** out_device,
     iree_hal_allocator_t** out_device_allocator);
 
+// Creates a new VM context with the already resolved |system_modules| (such as
+// the non-user modules produced by iree_tooling_resolve_modules) followed by
+// |user_modules|. The context is returned frozen.
+//
+// Contexts created from the same |system_modules| share the HAL devices along
+// with their executors and allocators. This allows multiple independent
+// programs to be hosted in one process the same way a serving application
+// would instead of each context creating its own devices.
+iree_status_t iree_tooling_create_context_with_system_modules(
+    iree_vm_instance_t* instance,
+    const iree_tooling_module_list_t* system_modules,
+    iree_host_size_t user_module_count, iree_vm_module_t** user_modules,
+    iree_allocator_t host_allocator, iree_vm_context_t** out_context);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -6,6 +6,8 @@
 
 #include "iree/tooling/function_io.h"
 
+#include "iree/base/internal/file_io.h"
+#include "iree/io/file_handle.h"
 #include "iree/io/stdio_stream.h"
 #include "iree/io/stream.h"
 #include "iree/modules/hal/module.h"
@@ -48,6 +50,62 @@ static iree_status_t iree_io_stream_open_path(iree_io_stdio_stream_mode_t mode,
   return status;
 }
 
+static void iree_io_file_contents_release(
+    void* user_data, iree_io_file_handle_primitive_t handle_primitive) {
+  iree_file_contents_free((iree_file_contents_t*)user_data);
+}
+
+// Maps the file at |path| into host memory for read-only access and returns a
+// stream over the contents along with a host allocation file handle that can
+// be used to reference the mapped memory directly.
+static iree_status_t iree_io_stream_open_mapped_path(
+    iree_string_view_t path, iree_allocator_t host_allocator,
+    iree_io_stream_t** out_stream, iree_io_file_handle_t** out_file_handle) {
+  IREE_ASSERT_ARGUMENT(out_stream);
+  IREE_ASSERT_ARGUMENT(out_file_handle);
+  *out_stream = NULL;
+  *out_file_handle = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
+
+  char* path_str = (char*)iree_alloca(path.size + 1);
+  memcpy(path_str, path.data, path.size);
+  path_str[path.size] = 0;
+  iree_file_contents_t* contents = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_file_map_contents_readonly(path_str, host_allocator, &contents));
+
+  // The file handle owns the mapping and releases it when the last stream or
+  // imported buffer referencing it is released.
+  iree_io_file_handle_t* file_handle = NULL;
+  iree_io_file_handle_release_callback_t release_callback = {
+      .fn = iree_io_file_contents_release,
+      .user_data = contents,
+  };
+  iree_status_t status = iree_io_file_handle_wrap_host_allocation(
+      IREE_IO_FILE_ACCESS_READ, contents->buffer, release_callback,
+      host_allocator, &file_handle);
+  if (!iree_status_is_ok(status)) {
+    iree_file_contents_free(contents);
+  }
+
+  iree_io_stream_t* stream = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_io_stream_open(
+        IREE_IO_STREAM_MODE_READABLE | IREE_IO_STREAM_MODE_SEEKABLE,
+        file_handle, 0ull, host_allocator, &stream);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_stream = stream;
+    *out_file_handle = file_handle;
+  } else {
+    iree_io_file_handle_release(file_handle);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 //===----------------------------------------------------------------------===//
 // iree_io_stream_list_t
 //===----------------------------------------------------------------------===//
@@ -55,6 +113,9 @@ static iree_status_t iree_io_stream_open_path(iree_io_stdio_stream_mode_t mode,
 typedef struct iree_io_stream_list_entry_t {
   iree_string_view_t path;
   iree_io_stream_t* stream;
+  // Host allocation handle of the mapped file contents backing |stream|, if
+  // the file was mapped.
+  iree_io_file_handle_t* file_handle;
   // + path char storage of path.size
 } iree_io_stream_list_entry_t;
 
@@ -100,6 +161,7 @@ void iree_io_stream_list_free(iree_io_stream_list_t* list) {
   for (iree_host_size_t i = 0; i < list->count; ++i) {
     iree_io_stream_list_entry_t* entry = list->entries[i];
     iree_io_stream_release(entry->stream);
+    iree_io_file_handle_release(entry->file_handle);
     iree_allocator_free(list->host_allocator, entry);
   }
   iree_allocator_free(list->host_allocator, list->entries);
@@ -123,10 +185,11 @@ static iree_io_stream_list_entry_t* iree_io_stream_list_find_entry(
 }
 
 // Appends a stream to the list. The |path| will be cloned into the list
-// storage and the stream will be retained until the list is freed.
+// storage and the stream and optional |file_handle| will be retained until the
+// list is freed.
 static iree_status_t iree_io_stream_list_append_entry(
     iree_io_stream_list_t* list, iree_string_view_t path,
-    iree_io_stream_t* stream) {
+    iree_io_stream_t* stream, iree_io_file_handle_t* file_handle) {
   IREE_ASSERT_ARGUMENT(list);
   IREE_ASSERT_ARGUMENT(stream);
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -152,6 +215,8 @@ static iree_status_t iree_io_stream_list_append_entry(
     memcpy((void*)entry->path.data, path.data, path.size);
     entry->stream = stream;
     iree_io_stream_retain(entry->stream);
+    entry->file_handle = file_handle;
+    if (entry->file_handle) iree_io_file_handle_retain(entry->file_handle);
   }
 
   // Store in list.
@@ -205,12 +270,18 @@ static iree_status_t iree_io_stream_list_open_existing(
 // already been opened. If |append| is true the stream will be returned at its
 // existing position for continued reading/writing and otherwise it will be
 // reset to position 0.
-iree_status_t iree_io_stream_list_open(iree_io_stream_list_t* list,
-                                       iree_string_view_t path, bool is_append,
-                                       iree_io_stream_t** out_stream) {
+//
+// Read-only lists map files into host memory when possible and return the
+// mapped file in |out_file_handle| (unretained, valid as long as the list is)
+// so that contents can be imported without copying. |out_file_handle| is set
+// to NULL if the stream is not backed by a mapped file.
+iree_status_t iree_io_stream_list_open(
+    iree_io_stream_list_t* list, iree_string_view_t path, bool is_append,
+    iree_io_stream_t** out_stream, iree_io_file_handle_t** out_file_handle) {
   IREE_ASSERT_ARGUMENT(list);
   IREE_ASSERT_ARGUMENT(out_stream);
   *out_stream = NULL;
+  if (out_file_handle) *out_file_handle = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, path.data, path.size);
 
@@ -220,18 +291,36 @@ iree_status_t iree_io_stream_list_open(iree_io_stream_list_t* list,
   if (entry) {
     iree_status_t status = iree_io_stream_list_open_existing(
         list, path, entry, is_append, out_stream);
+    if (iree_status_is_ok(status) && out_file_handle) {
+      *out_file_handle = entry->file_handle;
+    }
     IREE_TRACE_ZONE_END(z0);
     return status;
   }
 
-  // Open the file at the path specified.
+  // Map the file if only reading. Not all paths can be mapped (pipes, empty
+  // files, etc) and those fall back to normal file streams.
   iree_io_stream_t* stream = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_io_stream_open_path(list->mode, path, 0ull, list->host_allocator,
-                                   &stream));
+  iree_io_file_handle_t* file_handle = NULL;
+  if (list->mode == IREE_IO_STDIO_STREAM_MODE_READ) {
+    iree_status_ignore(iree_io_stream_open_mapped_path(
+        path, list->host_allocator, &stream, &file_handle));
+  }
+
+  // Open the file at the path specified.
+  if (!stream) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_io_stream_open_path(list->mode, path, 0ull,
+                                     list->host_allocator, &stream));
+  }
 
   // Append the stream entry to the list so it's retained for future opens.
-  iree_status_t status = iree_io_stream_list_append_entry(list, path, stream);
+  iree_status_t status =
+      iree_io_stream_list_append_entry(list, path, stream, file_handle);
+  if (iree_status_is_ok(status) && out_file_handle) {
+    *out_file_handle = file_handle;
+  }
+  iree_io_file_handle_release(file_handle);  // Now retained by the entry.
 
   if (iree_status_is_ok(status)) {
     *out_stream = stream;
@@ -401,15 +490,202 @@ static iree_status_t iree_tooling_parse_buffer_view_file_callback(
                              /*out_buffer_length=*/NULL);
 }
 
+static void iree_tooling_file_handle_buffer_release(void* user_data,
+                                                    iree_hal_buffer_t* buffer) {
+  iree_io_file_handle_release((iree_io_file_handle_t*)user_data);
+}
+
+// Tries to import |length| bytes at |offset| of the mapped |file_handle| as a
+// buffer without copying. Returns OK with a NULL |out_buffer| if the device
+// allocator cannot use the memory directly.
+static iree_status_t iree_tooling_try_import_file_range(
+    iree_io_file_handle_t* file_handle, uint64_t offset,
+    iree_device_size_t length, iree_hal_buffer_params_t buffer_params,
+    iree_hal_allocator_t* device_allocator, iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+
+  // The mapping is read-only and anything that may be written (such as output
+  // storage) needs its own memory.
+  if (iree_any_bit_set(buffer_params.access, IREE_HAL_MEMORY_ACCESS_WRITE)) {
+    return iree_ok_status();
+  }
+
+  // Devices require imported host memory to be at least as aligned as the
+  // buffers they allocate themselves. Offsets of .npy contents are 64-byte
+  // aligned by the format and raw binary files start at the page-aligned base.
+  iree_byte_span_t host_allocation =
+      iree_io_file_handle_value(file_handle).host_allocation;
+  if (offset + length > host_allocation.data_length) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "file contents of %" PRIhsz
+                            " bytes too short to read %" PRIu64
+                            " bytes at offset %" PRIu64,
+                            host_allocation.data_length, (uint64_t)length,
+                            offset);
+  }
+  uint8_t* host_ptr = host_allocation.data + offset;
+  const iree_device_size_t required_alignment =
+      iree_max(buffer_params.min_alignment, IREE_HAL_HEAP_BUFFER_ALIGNMENT);
+  if (!iree_host_size_has_alignment((uintptr_t)host_ptr,
+                                    (iree_host_size_t)required_alignment)) {
+    return iree_ok_status();
+  }
+
+  iree_hal_external_buffer_t external_buffer = {
+      .type = IREE_HAL_EXTERNAL_BUFFER_TYPE_HOST_ALLOCATION,
+      .flags = IREE_HAL_EXTERNAL_BUFFER_FLAG_NONE,
+      .size = length,
+      .handle =
+          {
+              .host_allocation =
+                  {
+                      .ptr = host_ptr,
+                  },
+          },
+  };
+  iree_hal_buffer_release_callback_t release_callback = {
+      .fn = iree_tooling_file_handle_buffer_release,
+      .user_data = file_handle,
+  };
+  iree_io_file_handle_retain(file_handle);
+  iree_status_t status = iree_hal_allocator_import_buffer(
+      device_allocator, buffer_params, &external_buffer, release_callback,
+      out_buffer);
+  if (!iree_status_is_ok(status)) {
+    // Not importable into the requested memory type; the caller falls back.
+    iree_status_ignore(status);
+    iree_io_file_handle_release(file_handle);
+    *out_buffer = NULL;
+  }
+  return iree_ok_status();
+}
+
+// Reads |length| bytes at |offset| of |file_handle| into a new device buffer
+// with a queue read. This lets devices with discrete memory stream the mapped
+// file contents directly instead of staging them through a host allocation.
+static iree_status_t iree_tooling_queue_read_file_range(
+    iree_io_file_handle_t* file_handle, uint64_t offset,
+    iree_device_size_t length, iree_hal_buffer_params_t buffer_params,
+    iree_hal_device_t* device, iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_t** out_buffer) {
+  *out_buffer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, (int64_t)length);
+
+  buffer_params.usage |= IREE_HAL_BUFFER_USAGE_TRANSFER_TARGET;
+  iree_hal_buffer_t* buffer = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_allocator_allocate_buffer(device_allocator, buffer_params,
+                                             length, &buffer));
+
+  iree_hal_file_t* file = NULL;
+  iree_status_t status = iree_hal_file_import(
+      device, IREE_HAL_QUEUE_AFFINITY_ANY, IREE_HAL_MEMORY_ACCESS_READ,
+      file_handle, IREE_HAL_EXTERNAL_FILE_FLAG_NONE, &file);
+
+  iree_hal_semaphore_t* semaphore = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_create(
+        device, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &semaphore);
+  }
+  if (iree_status_is_ok(status)) {
+    uint64_t signal_value = 1ull;
+    iree_hal_semaphore_list_t signal_semaphore_list = {
+        .count = 1,
+        .semaphores = &semaphore,
+        .payload_values = &signal_value,
+    };
+    status = iree_hal_device_queue_read(
+        device, IREE_HAL_QUEUE_AFFINITY_ANY, iree_hal_semaphore_list_empty(),
+        signal_semaphore_list, file, offset, buffer, 0, length,
+        IREE_HAL_READ_FLAG_NONE);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_semaphore_wait(semaphore, 1ull, iree_infinite_timeout());
+  }
+  iree_hal_semaphore_release(semaphore);
+  iree_hal_file_release(file);
+
+  if (iree_status_is_ok(status)) {
+    *out_buffer = buffer;
+  } else {
+    iree_hal_buffer_release(buffer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Creates a buffer view with the given shape and element type from the next
+// contents of |stream| and advances the stream past them.
+//
+// If the stream is backed by the mapped |file_handle| the contents are
+// imported without copying when the device allocator can use host memory and
+// otherwise streamed into device memory with a queue read. Streams that are
+// not mapped (or when no |device| is available) are read into a new buffer.
+static iree_status_t iree_tooling_load_buffer_view_from_stream(
+    iree_io_stream_t* stream, iree_io_file_handle_t* file_handle,
+    iree_host_size_t shape_rank, const iree_hal_dim_t* shape,
+    iree_hal_element_type_t element_type,
+    iree_hal_encoding_type_t encoding_type,
+    iree_hal_buffer_params_t buffer_params, iree_hal_device_t* device,
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  *out_buffer_view = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_hal_buffer_t* buffer = NULL;
+  iree_device_size_t length = 0;
+  iree_status_t status = iree_ok_status();
+  if (file_handle && device_allocator) {
+    status = iree_hal_buffer_compute_view_size(shape_rank, shape, element_type,
+                                               encoding_type, &length);
+    uint64_t offset = iree_io_stream_offset(stream);
+    if (iree_status_is_ok(status)) {
+      status = iree_tooling_try_import_file_range(
+          file_handle, offset, length, buffer_params, device_allocator,
+          &buffer);
+    }
+    if (iree_status_is_ok(status) && !buffer && device) {
+      status = iree_tooling_queue_read_file_range(file_handle, offset, length,
+                                                  buffer_params, device,
+                                                  device_allocator, &buffer);
+    }
+  }
+
+  if (iree_status_is_ok(status) && buffer) {
+    IREE_TRACE_ZONE_APPEND_TEXT(z0, "mapped");
+    status = iree_io_stream_seek(stream, IREE_IO_STREAM_SEEK_FROM_CURRENT,
+                                 (iree_io_stream_pos_t)length);
+    if (iree_status_is_ok(status)) {
+      status = iree_hal_buffer_view_create(
+          buffer, shape_rank, shape, element_type, encoding_type,
+          iree_hal_allocator_host_allocator(device_allocator),
+          out_buffer_view);
+    }
+    iree_hal_buffer_release(buffer);
+  } else if (iree_status_is_ok(status)) {
+    // Allocate the buffer view and directly read into the allocated memory.
+    buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
+    status = iree_hal_buffer_view_generate_buffer(
+        device, device_allocator, shape_rank, shape, element_type,
+        encoding_type, buffer_params,
+        iree_tooling_parse_buffer_view_file_callback, stream, out_buffer_view);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 // Creates a HAL buffer view with the given |metadata| and reads the contents
 // from the file reference in |string| which has the prefix `@` to indicate
 // the contents starting from 0 and `+` for the next contents in an already
 // opened stream.
-// The file contents are directly read in to memory with no processing.
+// The file contents are used with no processing and buffers with read-only
+// |access| may directly reference the mapped file.
 static iree_status_t iree_tooling_parse_buffer_view_file(
     iree_string_view_t metadata, iree_string_view_t string,
-    iree_hal_device_t* device, iree_hal_allocator_t* device_allocator,
-    iree_io_stream_list_t* stream_list,
+    iree_hal_memory_access_t access, iree_hal_device_t* device,
+    iree_hal_allocator_t* device_allocator, iree_io_stream_list_t* stream_list,
     iree_hal_buffer_view_t** out_buffer_view) {
   IREE_TRACE_ZONE_BEGIN(z0);
   IREE_TRACE_ZONE_APPEND_TEXT(z0, string.data, string.size);
@@ -434,27 +710,21 @@ static iree_status_t iree_tooling_parse_buffer_view_file(
 
   // Open (or retrieve) the file.
   iree_io_stream_t* stream = NULL;
+  iree_io_file_handle_t* file_handle = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_io_stream_list_open(stream_list, path, is_append, &stream));
-
-  // TODO(benvanik): support mapping on allocators that can handle importing
-  // host memory. We only want to do this when it won't hurt performance
-  // (unified memory systems and where the mapped memory meets alignment
-  // requirements). For now we always wire new device memory to read into.
-  // A real application would want to either do the import or use
-  // iree_hal_file_t to stream the file contents into device memory without
-  // going through host memory.
+      z0, iree_io_stream_list_open(stream_list, path, is_append, &stream,
+                                   &file_handle));
 
-  // Read the stream contents into the buffer.
+  // Import or read the stream contents into the buffer. Only read-only
+  // buffers can reference the mapped file contents directly.
   iree_hal_buffer_params_t buffer_params = {
       .usage = IREE_HAL_BUFFER_USAGE_DEFAULT,
-      .access = IREE_HAL_MEMORY_ACCESS_ALL,
+      .access = access,
       .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
   };
-  iree_status_t status = iree_hal_buffer_view_generate_buffer(
-      device, device_allocator, shape_rank, shape, element_type, encoding_type,
-      buffer_params, iree_tooling_parse_buffer_view_file_callback, stream,
-      out_buffer_view);
+  iree_status_t status = iree_tooling_load_buffer_view_from_stream(
+      stream, file_handle, shape_rank, shape, element_type, encoding_type,
+      buffer_params, device, device_allocator, out_buffer_view);
 
   iree_io_stream_release(stream);
   IREE_TRACE_ZONE_END(z0);
@@ -462,19 +732,21 @@ static iree_status_t iree_tooling_parse_buffer_view_file(
 }
 
 // Parses a shaped tensor type into a HAL buffer view.
+// File contents are loaded into buffers with the given memory |access|.
 static iree_status_t iree_tooling_parse_tensor(
-    iree_string_view_t string, iree_hal_device_t* device,
-    iree_hal_allocator_t* device_allocator, iree_io_stream_list_t* stream_list,
-    iree_allocator_t host_allocator, iree_hal_buffer_view_t** out_buffer_view) {
+    iree_string_view_t string, iree_hal_memory_access_t access,
+    iree_hal_device_t* device, iree_hal_allocator_t* device_allocator,
+    iree_io_stream_list_t* stream_list, iree_allocator_t host_allocator,
+    iree_hal_buffer_view_t** out_buffer_view) {
   // If contents are sourced from a file then route to that, and otherwise
   // parse as a normal HAL buffer view with inline contents (or none).
   iree_string_view_t metadata, contents;
   if (iree_string_view_split(string, '=', &metadata, &contents) != -1) {
     if (iree_string_view_starts_with(contents, IREE_SV("@")) ||
         iree_string_view_starts_with(contents, IREE_SV("+"))) {
-      return iree_tooling_parse_buffer_view_file(metadata, contents, device,
-                                                 device_allocator, stream_list,
-                                                 out_buffer_view);
+      return iree_tooling_parse_buffer_view_file(
+          metadata, contents, access, device, device_allocator, stream_list,
+          out_buffer_view);
     }
   }
 
@@ -512,8 +784,9 @@ static iree_status_t iree_tooling_parse_tensor_into(
   // Parse the tensor contents.
   iree_hal_buffer_view_t* buffer_view = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_tooling_parse_tensor(string, device, device_allocator,
-                                    stream_list, host_allocator, &buffer_view));
+      z0, iree_tooling_parse_tensor(string, IREE_HAL_MEMORY_ACCESS_READ, device,
+                                    device_allocator, stream_list,
+                                    host_allocator, &buffer_view));
 
   // Add buffer view to list.
   iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_move_ref(buffer_view);
@@ -538,8 +811,9 @@ static iree_status_t iree_tooling_parse_storage_into(
   // Parse the tensor contents.
   iree_hal_buffer_view_t* buffer_view = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_tooling_parse_tensor(string, device, device_allocator,
-                                    stream_list, host_allocator, &buffer_view));
+      z0, iree_tooling_parse_tensor(string, IREE_HAL_MEMORY_ACCESS_ALL, device,
+                                    device_allocator, stream_list,
+                                    host_allocator, &buffer_view));
 
   // Add just the storage buffer to the list - we don't need the metadata.
   iree_vm_ref_t buffer_ref =
@@ -552,10 +826,12 @@ static iree_status_t iree_tooling_parse_storage_into(
 }
 
 // Parses a single ndarray from |stream| as a HAL buffer view and appends it to
-// |list|.
+// |list|. If the stream is backed by the mapped |file_handle| the ndarray
+// contents are imported or streamed from the mapping instead of copied.
 static iree_status_t iree_tooling_parse_ndarray_into(
     iree_string_view_t* cconv, iree_vm_list_t* list, iree_io_stream_t* stream,
-    iree_hal_device_t* device, iree_hal_allocator_t* device_allocator) {
+    iree_io_file_handle_t* file_handle, iree_hal_device_t* device,
+    iree_hal_allocator_t* device_allocator, iree_allocator_t host_allocator) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Expect a ref holding the buffer view.
@@ -566,10 +842,16 @@ static iree_status_t iree_tooling_parse_ndarray_into(
       .access = IREE_HAL_MEMORY_ACCESS_READ,
       .type = IREE_HAL_MEMORY_TYPE_DEVICE_LOCAL,
   };
+  iree_numpy_npy_ndarray_header_t header;
+  iree_status_t status =
+      iree_numpy_npy_read_ndarray_header(stream, host_allocator, &header);
   iree_hal_buffer_view_t* buffer_view = NULL;
-  iree_status_t status = iree_numpy_npy_load_ndarray(
-      stream, IREE_NUMPY_NPY_LOAD_OPTION_DEFAULT, buffer_params, device,
-      device_allocator, &buffer_view);
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_load_buffer_view_from_stream(
+        stream, file_handle, header.shape_rank, header.shape,
+        header.element_type, header.encoding_type, buffer_params, device,
+        device_allocator, &buffer_view);
+  }
 
   if (iree_status_is_ok(status)) {
     iree_vm_ref_t buffer_view_ref = iree_hal_buffer_view_move_ref(buffer_view);
@@ -609,20 +891,24 @@ static iree_status_t iree_tooling_parse_file_into(
 
   // Open (or retrieve) the file.
   iree_io_stream_t* stream = NULL;
+  iree_io_file_handle_t* file_handle = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_io_stream_list_open(stream_list, path, is_append, &stream));
+      z0, iree_io_stream_list_open(stream_list, path, is_append, &stream,
+                                   &file_handle));
 
   iree_status_t status = iree_ok_status();
   if (!is_splat) {
     // Read a single ndarray from the stream at the current offset.
-    status = iree_tooling_parse_ndarray_into(cconv, list, stream, device,
-                                             device_allocator);
+    status = iree_tooling_parse_ndarray_into(cconv, list, stream, file_handle,
+                                             device, device_allocator,
+                                             host_allocator);
   } else {
     // Read zero or more ndarrays from the stream - note that it may already be
     // at EOS.
     while (iree_status_is_ok(status) && !iree_io_stream_is_eos(stream)) {
-      status = iree_tooling_parse_ndarray_into(cconv, list, stream, device,
-                                               device_allocator);
+      status = iree_tooling_parse_ndarray_into(
+          cconv, list, stream, file_handle, device, device_allocator,
+          host_allocator);
     }
   }
 
@@ -8,40 +8,92 @@
 
 #include "iree/modules/hal/module.h"
 
+// Parses the decimal fence count reflection attribute |name| of |function|.
+static iree_status_t iree_tooling_lookup_fence_count(
+    iree_vm_function_t function, iree_string_view_t name,
+    iree_host_size_t* out_count) {
+  iree_string_view_t value =
+      iree_vm_function_lookup_attr_by_name(&function, name);
+  uint32_t count = 0;
+  if (!iree_string_view_atoi_uint32(value, &count)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "function has an invalid `%.*s` attribute: '%.*s'",
+                            (int)name.size, name.data, (int)value.size,
+                            value.data);
+  }
+  *out_count = count;
+  return iree_ok_status();
+}
+
+// Appends a new signal fence transitioning a new semaphore 0->1 to |list| and
+// inserts the timepoint into |joined_fence|.
+static iree_status_t iree_tooling_append_signal_fence(
+    iree_vm_list_t* list, iree_hal_device_t* device,
+    iree_hal_fence_t* joined_fence) {
+  iree_hal_semaphore_t* semaphore = NULL;
+  IREE_RETURN_IF_ERROR(iree_hal_semaphore_create(
+      device, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &semaphore));
+  iree_hal_fence_t* signal_fence = NULL;
+  iree_status_t status = iree_hal_fence_create_at(
+      semaphore, 1ull, iree_hal_device_host_allocator(device), &signal_fence);
+  if (iree_status_is_ok(status)) {
+    iree_vm_ref_t signal_fence_ref = iree_hal_fence_move_ref(signal_fence);
+    status = iree_vm_list_push_ref_move(list, &signal_fence_ref);
+    iree_vm_ref_release(&signal_fence_ref);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_hal_fence_insert(joined_fence, semaphore, 1ull);
+  }
+  iree_hal_semaphore_release(semaphore);
+  return status;
+}
+
 iree_status_t iree_tooling_append_async_fences(
     iree_vm_list_t* list, iree_vm_function_t function,
     iree_hal_device_t* device, iree_hal_fence_t* wait_fence,
     iree_hal_fence_t** out_signal_fence) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  // The coarse model takes a single (wait, signal) fence pair while the fine
+  // model takes one wait fence per input followed by one signal fence per
+  // output with the counts reflected on the function.
+  iree_host_size_t wait_count = 1;
+  iree_host_size_t signal_count = 1;
   iree_string_view_t model = iree_vm_function_lookup_attr_by_name(
       &function, IREE_SV("iree.abi.model"));
-  if (!iree_string_view_equal(model, IREE_SV("coarse-fences"))) {
+  if (iree_string_view_equal(model, IREE_SV("coarse-fences"))) {
+    // Defaults above.
+  } else if (iree_string_view_equal(model, IREE_SV("fine-fences"))) {
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_tooling_lookup_fence_count(
+                function, IREE_SV("iree.abi.wait_fences"), &wait_count));
+    IREE_RETURN_AND_END_ZONE_IF_ERROR(
+        z0, iree_tooling_lookup_fence_count(
+                function, IREE_SV("iree.abi.signal_fences"), &signal_count));
+  } else {
     // Ignore unknown models - the user may have provided their own fences.
     IREE_TRACE_ZONE_END(z0);
     return iree_ok_status();
   }
 
-  // Create the signal fence as a 0->1 transition. The caller will wait on that.
-  iree_hal_semaphore_t* semaphore = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_hal_semaphore_create(device, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE,
-                                    &semaphore));
-  iree_hal_fence_t* signal_fence = NULL;
-  iree_status_t status = iree_hal_fence_create_at(
-      semaphore, 1ull, iree_hal_device_host_allocator(device), &signal_fence);
-  iree_hal_semaphore_release(semaphore);
-
-  // Append (wait, signal) fences.
-  if (iree_status_is_ok(status)) {
+  // All inputs wait on the same fence provided by the caller.
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < wait_count && iree_status_is_ok(status);
+       ++i) {
     iree_vm_ref_t wait_fence_ref = iree_hal_fence_retain_ref(wait_fence);
     status = iree_vm_list_push_ref_move(list, &wait_fence_ref);
     iree_vm_ref_release(&wait_fence_ref);
   }
+
+  // Each output signals its own semaphore and the caller waits on all of them.
+  iree_hal_fence_t* signal_fence = NULL;
   if (iree_status_is_ok(status)) {
-    iree_vm_ref_t signal_fence_ref = iree_hal_fence_retain_ref(signal_fence);
-    status = iree_vm_list_push_ref_move(list, &signal_fence_ref);
-    iree_vm_ref_release(&signal_fence_ref);
+    status = iree_hal_fence_create(
+        signal_count, iree_hal_device_host_allocator(device), &signal_fence);
+  }
+  for (iree_host_size_t i = 0; i < signal_count && iree_status_is_ok(status);
+       ++i) {
+    status = iree_tooling_append_signal_fence(list, device, signal_fence);
   }
 
   if (iree_status_is_ok(status)) {
@@ -16,7 +16,9 @@ extern "C" {
 #endif
 
 // Appends fences to |list| if the invocation model of |function| requires them
-// (has the `iree.abi.model` as `coarse-fences`).
+// (has the `iree.abi.model` as `coarse-fences` or `fine-fences`).
+// With fine-grained fences all inputs wait on |wait_fence| and each output
+// signals its own fence; the returned |out_signal_fence| joins all of them.
 // If no |wait_fence| is provided then the invocation will begin immediately.
 // Upon return if |out_signal_fence| is not NULL the caller must wait on the
 // returned |out_signal_fence| before accessing the contents of any buffers
@@ -6,12 +6,17 @@
 
 #include "iree/tooling/instrument_util.h"
 
+#include <errno.h>
 #include <memory.h>
 #include <stdio.h>
 #include <string.h>
 
+#include "iree/base/internal/atomics.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/synchronization.h"
+#include "iree/base/internal/threading.h"
 #include "iree/modules/hal/types.h"
+#include "iree/schemas/instruments/dispatch.h"
 
 //===----------------------------------------------------------------------===//
 // Instrument data management
@@ -19,6 +24,10 @@
 
 IREE_FLAG(string, instrument_file, "",
           "File to populate with instrument data from the program.");
+IREE_FLAG(int32_t, instrument_drain_interval_ms, 0,
+          "Drains the dispatch instrumentation ringbuffer to "
+          "--instrument_file= every N milliseconds while the program is "
+          "running instead of only writing its contents once at exit.");
 
 static iree_status_t iree_tooling_write_iovec(iree_vm_ref_t iovec, FILE* file) {
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -50,31 +59,17 @@ static iree_status_t iree_tooling_write_iovec(iree_vm_ref_t iovec, FILE* file) {
                                      "failed to write iovec to file");
 }
 
-iree_status_t iree_tooling_process_instrument_data(
-    iree_vm_context_t* context, iree_allocator_t host_allocator) {
-  // If no flag was specified we ignore instrument data.
-  if (strlen(FLAG_instrument_file) == 0) return iree_ok_status();
-
-  IREE_TRACE_ZONE_BEGIN(z0);
-  IREE_TRACE_ZONE_APPEND_TEXT(z0, FLAG_instrument_file);
-
-  // Open the file for overwriting. We do this even if there is no instrument
-  // data in the program as we'd rather have the user end up with a 0-byte file
-  // when they explicitly ask for it instead of stale data from previous runs.
-  FILE* file = fopen(FLAG_instrument_file, "wb");
-  if (!file) {
-    IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(iree_status_code_from_errno(errno),
-                            "failed to open instrument file '%s' for writing",
-                            FLAG_instrument_file);
-  }
+// Queries the instrument data iovecs from all modules in |context|.
+static iree_status_t iree_tooling_query_instrument_iovecs(
+    iree_vm_context_t* context, iree_allocator_t host_allocator,
+    iree_vm_list_t** out_iovec_list) {
+  *out_iovec_list = NULL;
 
   // Each query function pushes iovecs on to a list we provide; we create one
   // list and use that across all of them.
   iree_vm_list_t* iovec_list = NULL;
-  IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_vm_list_create(iree_vm_make_undefined_type_def(), 8,
-                              host_allocator, &iovec_list));
+  IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                           8, host_allocator, &iovec_list));
 
   iree_vm_list_t* input_list = NULL;
   iree_status_t status = iree_vm_list_create(iree_vm_make_undefined_type_def(),
@@ -84,7 +79,7 @@ iree_status_t iree_tooling_process_instrument_data(
     status = iree_vm_list_push_ref_move(input_list, &iovec_list_ref);
   }
 
-  // Process instrument data from all modules in the context.
+  // Query instrument data from all modules in the context.
   if (iree_status_is_ok(status)) {
     for (iree_host_size_t i = 0; i < iree_vm_context_module_count(context);
          ++i) {
@@ -112,6 +107,38 @@ iree_status_t iree_tooling_process_instrument_data(
     }
   }
 
+  iree_vm_list_release(input_list);
+  if (iree_status_is_ok(status)) {
+    *out_iovec_list = iovec_list;
+  } else {
+    iree_vm_list_release(iovec_list);
+  }
+  return status;
+}
+
+iree_status_t iree_tooling_process_instrument_data(
+    iree_vm_context_t* context, iree_allocator_t host_allocator) {
+  // If no flag was specified we ignore instrument data.
+  if (strlen(FLAG_instrument_file) == 0) return iree_ok_status();
+
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_TEXT(z0, FLAG_instrument_file);
+
+  // Open the file for overwriting. We do this even if there is no instrument
+  // data in the program as we'd rather have the user end up with a 0-byte file
+  // when they explicitly ask for it instead of stale data from previous runs.
+  FILE* file = fopen(FLAG_instrument_file, "wb");
+  if (!file) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open instrument file '%s' for writing",
+                            FLAG_instrument_file);
+  }
+
+  iree_vm_list_t* iovec_list = NULL;
+  iree_status_t status = iree_tooling_query_instrument_iovecs(
+      context, host_allocator, &iovec_list);
+
   if (iree_status_is_ok(status)) {
     for (iree_host_size_t i = 0; i < iree_vm_list_size(iovec_list); ++i) {
       iree_vm_ref_t iovec = iree_vm_ref_null();
@@ -122,9 +149,346 @@ iree_status_t iree_tooling_process_instrument_data(
     }
   }
 
-  iree_vm_list_release(input_list);
   iree_vm_list_release(iovec_list);
   fclose(file);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
+
+//===----------------------------------------------------------------------===//
+// Instrument ringbuffer draining
+//===----------------------------------------------------------------------===//
+
+struct iree_tooling_instrument_drainer_t {
+  iree_allocator_t host_allocator;
+  iree_duration_t interval;
+  iree_tooling_instrument_sink_t sink;
+  // File owned by the drainer when created from flags, if any.
+  FILE* file;
+
+  // Live ringbuffer of the instrumented module.
+  iree_hal_buffer_view_t* ringbuffer;
+  // Monotonic write head offset up to which records have been drained.
+  uint64_t drained_head;
+  // Total bytes of records overwritten before being drained and not yet
+  // reported in a span.
+  uint64_t dropped_length;
+  // Scratch storage used to linearize records from the ringbuffer.
+  uint8_t* scratch;
+  iree_host_size_t scratch_capacity;
+
+  iree_thread_t* thread;
+  iree_notification_t stop_notification;
+  iree_atomic_int32_t stop_requested;
+  // First failure from the drainer thread; read after the thread is joined.
+  iree_status_t thread_status;
+};
+
+static iree_status_t iree_tooling_instrument_drainer_write_chunk(
+    iree_tooling_instrument_drainer_t* drainer, iree_idbts_chunk_type_t type,
+    iree_const_byte_span_t prefix, iree_const_byte_span_t contents) {
+  iree_idbts_chunk_header_t header = {
+      .magic = IREE_IDBTS_CHUNK_MAGIC,
+      .type = type,
+      .version = 0,
+      .content_length = prefix.data_length + contents.data_length,
+  };
+  IREE_RETURN_IF_ERROR(drainer->sink.write(
+      drainer->sink.user_data,
+      iree_make_const_byte_span(&header, sizeof(header))));
+  if (prefix.data_length) {
+    IREE_RETURN_IF_ERROR(
+        drainer->sink.write(drainer->sink.user_data, prefix));
+  }
+  if (contents.data_length) {
+    IREE_RETURN_IF_ERROR(
+        drainer->sink.write(drainer->sink.user_data, contents));
+  }
+  static const uint8_t padding[16] = {0};
+  iree_host_size_t padding_length =
+      iree_host_align(header.content_length, 16) - header.content_length;
+  if (padding_length) {
+    IREE_RETURN_IF_ERROR(drainer->sink.write(
+        drainer->sink.user_data,
+        iree_make_const_byte_span(padding, padding_length)));
+  }
+  return iree_ok_status();
+}
+
+// Linearizes the records written to |ring_data| since the last drain into the
+// drainer scratch buffer and emits them as a span chunk.
+static iree_status_t iree_tooling_instrument_drainer_drain_mapping(
+    iree_tooling_instrument_drainer_t* drainer, const uint8_t* ring_data,
+    iree_host_size_t ring_data_length) {
+  const uint64_t ring_size =
+      ring_data_length - IREE_INSTRUMENT_DISPATCH_PADDING;
+  uint64_t ring_head = 0;
+  memcpy(&ring_head, ring_data + ring_data_length - sizeof(ring_head),
+         sizeof(ring_head));
+  if (ring_head == drainer->drained_head) return iree_ok_status();
+
+  // If the device has lapped us then the records since the last drain have
+  // been (at least partially) overwritten. Record boundaries are only known by
+  // walking from a known boundary so everything up to the current head is
+  // dropped.
+  uint64_t head_begin = drainer->drained_head;
+  if (ring_head - head_begin > ring_size) {
+    drainer->dropped_length += ring_head - head_begin;
+    drainer->drained_head = ring_head;
+    head_begin = ring_head;
+  }
+
+  if (drainer->scratch_capacity < ring_head - head_begin) {
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        drainer->host_allocator, (iree_host_size_t)ring_size,
+        (void**)&drainer->scratch));
+    drainer->scratch_capacity = (iree_host_size_t)ring_size;
+  }
+
+  // Records are written contiguously starting at their wrapped offset and may
+  // spill into the padding past the end of the ring. Records that have been
+  // reserved but not yet written are retried on the next drain.
+  uint64_t head_end = head_begin;
+  while (head_end < ring_head) {
+    const iree_instrument_dispatch_header_t* header =
+        (const iree_instrument_dispatch_header_t*)(ring_data +
+                                                   (head_end &
+                                                    (ring_size - 1)));
+    uint64_t record_length = iree_instrument_dispatch_record_length(header);
+    if (!record_length || head_end + record_length > ring_head) break;
+    memcpy(drainer->scratch + (head_end - head_begin), header,
+           (iree_host_size_t)record_length);
+    head_end += record_length;
+  }
+  if (head_end == head_begin && !drainer->dropped_length) {
+    return iree_ok_status();
+  }
+
+  iree_idbts_dispatch_ringbuffer_span_t span = {
+      .head_begin = head_begin,
+      .head_end = head_end,
+      .dropped_length = drainer->dropped_length,
+      .reserved = 0,
+  };
+  IREE_RETURN_IF_ERROR(iree_tooling_instrument_drainer_write_chunk(
+      drainer, IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER_SPAN,
+      iree_make_const_byte_span(&span, sizeof(span)),
+      iree_make_const_byte_span(drainer->scratch,
+                                (iree_host_size_t)(head_end - head_begin))));
+  drainer->drained_head = head_end;
+  drainer->dropped_length = 0;
+  return iree_ok_status();
+}
+
+static iree_status_t iree_tooling_instrument_drainer_drain(
+    iree_tooling_instrument_drainer_t* drainer) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_hal_buffer_mapping_t mapping;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_hal_buffer_map_range(
+              iree_hal_buffer_view_buffer(drainer->ringbuffer),
+              IREE_HAL_MAPPING_MODE_SCOPED, IREE_HAL_MEMORY_ACCESS_READ, 0,
+              IREE_WHOLE_BUFFER, &mapping));
+  iree_status_t status = iree_tooling_instrument_drainer_drain_mapping(
+      drainer, mapping.contents.data, mapping.contents.data_length);
+  IREE_IGNORE_ERROR(iree_hal_buffer_unmap_range(&mapping));
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static bool iree_tooling_instrument_drainer_is_stop_requested(void* arg) {
+  iree_tooling_instrument_drainer_t* drainer =
+      (iree_tooling_instrument_drainer_t*)arg;
+  return iree_atomic_load(&drainer->stop_requested,
+                          iree_memory_order_acquire) != 0;
+}
+
+static int iree_tooling_instrument_drainer_main(void* arg) {
+  iree_tooling_instrument_drainer_t* drainer =
+      (iree_tooling_instrument_drainer_t*)arg;
+  while (!iree_notification_await(
+      &drainer->stop_notification,
+      iree_tooling_instrument_drainer_is_stop_requested, drainer,
+      iree_make_timeout_ns(drainer->interval))) {
+    iree_status_t status = iree_tooling_instrument_drainer_drain(drainer);
+    if (!iree_status_is_ok(status)) {
+      drainer->thread_status = status;
+      break;
+    }
+  }
+  return 0;
+}
+
+// Writes all instrument iovecs except for the ringbuffer chunk to the sink and
+// retains the ringbuffer for draining.
+static iree_status_t iree_tooling_instrument_drainer_consume_iovecs(
+    iree_tooling_instrument_drainer_t* drainer, iree_vm_list_t* iovec_list) {
+  bool in_ringbuffer_chunk = false;
+  for (iree_host_size_t i = 0; i < iree_vm_list_size(iovec_list); ++i) {
+    iree_vm_ref_t iovec = iree_vm_ref_null();
+    IREE_RETURN_IF_ERROR(iree_vm_list_get_ref_assign(iovec_list, i, &iovec));
+    if (iree_hal_buffer_view_isa(iovec)) {
+      if (drainer->ringbuffer) {
+        return iree_make_status(
+            IREE_STATUS_UNIMPLEMENTED,
+            "draining instrument data from multiple modules is not supported");
+      }
+      drainer->ringbuffer = iree_hal_buffer_view_deref(iovec);
+      iree_hal_buffer_view_retain(drainer->ringbuffer);
+      continue;
+    } else if (!iree_vm_buffer_isa(iovec)) {
+      continue;
+    }
+    iree_vm_buffer_t* buffer = iree_vm_buffer_deref(iovec);
+    iree_const_byte_span_t data = iree_make_const_byte_span(
+        iree_vm_buffer_data(buffer), iree_vm_buffer_length(buffer));
+    if (data.data_length == sizeof(iree_idbts_chunk_header_t)) {
+      const iree_idbts_chunk_header_t* header =
+          (const iree_idbts_chunk_header_t*)data.data;
+      if (header->magic == IREE_IDBTS_CHUNK_MAGIC) {
+        in_ringbuffer_chunk =
+            header->type == IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER;
+      }
+    }
+    // The ringbuffer chunk header and its padding are replaced by spans.
+    if (in_ringbuffer_chunk) continue;
+    IREE_RETURN_IF_ERROR(drainer->sink.write(drainer->sink.user_data, data));
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_tooling_instrument_drainer_create(
+    iree_vm_context_t* context, iree_duration_t interval,
+    iree_tooling_instrument_sink_t sink, iree_allocator_t host_allocator,
+    iree_tooling_instrument_drainer_t** out_drainer) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(sink.write);
+  IREE_ASSERT_ARGUMENT(out_drainer);
+  *out_drainer = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // The ringbuffer global is immutable after initialization so we only need
+  // to query it once and can then drain it without touching the context.
+  iree_vm_list_t* iovec_list = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_tooling_query_instrument_iovecs(context, host_allocator,
+                                               &iovec_list));
+  if (iree_vm_list_size(iovec_list) == 0) {
+    iree_vm_list_release(iovec_list);
+    IREE_TRACE_ZONE_END(z0);
+    return iree_ok_status();
+  }
+
+  iree_tooling_instrument_drainer_t* drainer = NULL;
+  iree_status_t status = iree_allocator_malloc(
+      host_allocator, sizeof(*drainer), (void**)&drainer);
+  if (iree_status_is_ok(status)) {
+    memset(drainer, 0, sizeof(*drainer));
+    drainer->host_allocator = host_allocator;
+    drainer->interval = interval;
+    drainer->sink = sink;
+    iree_notification_initialize(&drainer->stop_notification);
+    status = iree_tooling_instrument_drainer_consume_iovecs(drainer,
+                                                            iovec_list);
+  }
+  iree_vm_list_release(iovec_list);
+  if (iree_status_is_ok(status) && !drainer->ringbuffer) {
+    status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "instrument data has no dispatch ringbuffer");
+  }
+
+  if (iree_status_is_ok(status)) {
+    iree_thread_create_params_t params;
+    memset(&params, 0, sizeof(params));
+    params.name = IREE_SV("iree-instrument-drainer");
+    status = iree_thread_create(iree_tooling_instrument_drainer_main, drainer,
+                                params, host_allocator, &drainer->thread);
+  }
+
+  if (iree_status_is_ok(status)) {
+    *out_drainer = drainer;
+  } else {
+    iree_tooling_instrument_drainer_free(drainer);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static iree_status_t iree_tooling_instrument_file_write(
+    void* user_data, iree_const_byte_span_t data) {
+  FILE* file = (FILE*)user_data;
+  if (fwrite(data.data, 1, data.data_length, file) != data.data_length) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to write instrument data to file");
+  }
+  return iree_ok_status();
+}
+
+iree_status_t iree_tooling_instrument_drainer_create_from_flags(
+    iree_vm_context_t* context, iree_allocator_t host_allocator,
+    iree_tooling_instrument_drainer_t** out_drainer) {
+  *out_drainer = NULL;
+  if (strlen(FLAG_instrument_file) == 0 ||
+      FLAG_instrument_drain_interval_ms <= 0) {
+    return iree_ok_status();
+  }
+
+  FILE* file = fopen(FLAG_instrument_file, "wb");
+  if (!file) {
+    return iree_make_status(iree_status_code_from_errno(errno),
+                            "failed to open instrument file '%s' for writing",
+                            FLAG_instrument_file);
+  }
+  iree_tooling_instrument_sink_t sink = {
+      .write = iree_tooling_instrument_file_write,
+      .user_data = file,
+  };
+  iree_status_t status = iree_tooling_instrument_drainer_create(
+      context, FLAG_instrument_drain_interval_ms * 1000000ll, sink,
+      host_allocator, out_drainer);
+  if (iree_status_is_ok(status) && *out_drainer) {
+    (*out_drainer)->file = file;
+  } else {
+    fclose(file);
+  }
+  return status;
+}
+
+iree_status_t iree_tooling_instrument_drainer_stop(
+    iree_tooling_instrument_drainer_t* drainer) {
+  IREE_ASSERT_ARGUMENT(drainer);
+  if (!drainer->thread) return iree_ok_status();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  iree_atomic_store(&drainer->stop_requested, 1, iree_memory_order_release);
+  iree_notification_post(&drainer->stop_notification, IREE_ALL_WAITERS);
+  iree_thread_join(drainer->thread);
+  iree_thread_release(drainer->thread);
+  drainer->thread = NULL;
+
+  // Drain whatever was written since the last periodic drain.
+  iree_status_t status = drainer->thread_status;
+  drainer->thread_status = iree_ok_status();
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_instrument_drainer_drain(drainer);
+  }
+  if (iree_status_is_ok(status) && drainer->file) {
+    fflush(drainer->file);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+void iree_tooling_instrument_drainer_free(
+    iree_tooling_instrument_drainer_t* drainer) {
+  if (!drainer) return;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_status_ignore(iree_tooling_instrument_drainer_stop(drainer));
+  iree_notification_deinitialize(&drainer->stop_notification);
+  iree_hal_buffer_view_release(drainer->ringbuffer);
+  iree_allocator_free(drainer->host_allocator, drainer->scratch);
+  if (drainer->file) fclose(drainer->file);
+  iree_allocator_free(drainer->host_allocator, drainer);
+  IREE_TRACE_ZONE_END(z0);
+}
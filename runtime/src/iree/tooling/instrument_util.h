@@ -23,6 +23,53 @@ extern "C" {
 iree_status_t iree_tooling_process_instrument_data(
     iree_vm_context_t* context, iree_allocator_t host_allocator);
 
+//===----------------------------------------------------------------------===//
+// Instrument ringbuffer draining
+//===----------------------------------------------------------------------===//
+
+// Receives instrument data as a stream of IDBTS chunks (see
+// iree/schemas/instruments/dispatch.h). |data| is only valid for the duration
+// of the call.
+typedef struct iree_tooling_instrument_sink_t {
+  iree_status_t (*write)(void* user_data, iree_const_byte_span_t data);
+  void* user_data;
+} iree_tooling_instrument_sink_t;
+
+// Drains the dispatch instrumentation ringbuffer of a context while the program
+// is running. Records written since the previous drain are emitted to the sink
+// as IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER_SPAN chunks and records
+// overwritten before they could be drained are counted as dropped. Combined
+// with compiler-side sampling (--iree-hal-instrument-dispatches-sample-rate=)
+// this allows instrumentation to remain enabled on long-running programs.
+typedef struct iree_tooling_instrument_drainer_t
+    iree_tooling_instrument_drainer_t;
+
+// Creates a drainer for the instrument data in |context| that drains to |sink|
+// every |interval| on a background thread. The dispatch metadata is written to
+// the sink before returning. |out_drainer| is set to NULL if the context has no
+// instrument data.
+iree_status_t iree_tooling_instrument_drainer_create(
+    iree_vm_context_t* context, iree_duration_t interval,
+    iree_tooling_instrument_sink_t sink, iree_allocator_t host_allocator,
+    iree_tooling_instrument_drainer_t** out_drainer);
+
+// Creates a drainer writing to the --instrument_file= file if
+// --instrument_drain_interval_ms= is set. |out_drainer| is set to NULL when
+// not enabled by flags in which case iree_tooling_process_instrument_data
+// should be used instead.
+iree_status_t iree_tooling_instrument_drainer_create_from_flags(
+    iree_vm_context_t* context, iree_allocator_t host_allocator,
+    iree_tooling_instrument_drainer_t** out_drainer);
+
+// Stops the background thread and performs a final drain of any remaining
+// records. Returns the first failure encountered while draining.
+iree_status_t iree_tooling_instrument_drainer_stop(
+    iree_tooling_instrument_drainer_t* drainer);
+
+// Stops the drainer if needed (ignoring failures) and frees it.
+void iree_tooling_instrument_drainer_free(
+    iree_tooling_instrument_drainer_t* drainer);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
@@ -0,0 +1,750 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/multi_model.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "iree/base/internal/flags.h"
+#include "iree/base/internal/threading.h"
+#include "iree/hal/api.h"
+#include "iree/tooling/context_util.h"
+#include "iree/tooling/function_io.h"
+#include "iree/tooling/function_util.h"
+
+IREE_FLAG_LIST(
+    string, model,
+    "A model hosted by the benchmark as a comma-separated list of key=value\n"
+    "pairs:\n"
+    "  name=<name>: name of the model in the report\n"
+    "  module=<module>: module in the same form as --module= (repeatable)\n"
+    "  function=<function>: exported function of the last module to invoke\n"
+    "  input=<input>: input in the same form as --input= (repeatable)\n"
+    "  concurrency=<n>: number of workers each with their own context\n"
+    "  rate=<n>: target invocations per second across all workers or 0 to\n"
+    "            invoke back-to-back\n"
+    "e.g.: --model=name=a,module=a.vmfb,function=main,input=@a.npy,rate=50\n"
+    "Inputs containing commas must be provided from files.\n"
+    "Each occurrence of the flag adds a model; all models run concurrently\n"
+    "on the devices specified by --device=.");
+
+IREE_FLAG(double, warmup_duration, 1.0,
+          "Seconds to run all models before measuring.");
+
+IREE_FLAG(double, measure_duration, 10.0,
+          "Seconds to run all models while measuring.");
+
+IREE_FLAG(string, report, "-",
+          "Path to write the JSON report to or `-` for stdout.");
+
+// Maximum number of models hosted concurrently.
+#define IREE_TOOLING_MULTI_MODEL_MAX_MODELS 16
+
+//===----------------------------------------------------------------------===//
+// iree_tooling_multi_model_spec_t
+//===----------------------------------------------------------------------===//
+
+iree_status_t iree_tooling_multi_model_spec_parse(
+    iree_string_view_t value, iree_tooling_multi_model_spec_t* out_spec) {
+  IREE_ASSERT_ARGUMENT(out_spec);
+  memset(out_spec, 0, sizeof(*out_spec));
+  out_spec->concurrency = 1;
+
+  iree_string_view_t remaining = value;
+  while (!iree_string_view_is_empty(remaining)) {
+    iree_string_view_t pair = iree_string_view_empty();
+    iree_string_view_split(remaining, ',', &pair, &remaining);
+    pair = iree_string_view_trim(pair);
+    if (iree_string_view_is_empty(pair)) continue;
+    iree_string_view_t key = iree_string_view_empty();
+    iree_string_view_t key_value = iree_string_view_empty();
+    if (iree_string_view_split(pair, '=', &key, &key_value) == -1) {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "expected `key=value` in model spec, got `%.*s`",
+                              (int)pair.size, pair.data);
+    }
+    key = iree_string_view_trim(key);
+    key_value = iree_string_view_trim(key_value);
+    if (iree_string_view_equal(key, IREE_SV("name"))) {
+      out_spec->name = key_value;
+    } else if (iree_string_view_equal(key, IREE_SV("module"))) {
+      if (out_spec->module_count >= IREE_TOOLING_MULTI_MODEL_MAX_MODULES) {
+        return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                "too many modules in model spec; max %d",
+                                IREE_TOOLING_MULTI_MODEL_MAX_MODULES);
+      }
+      out_spec->modules[out_spec->module_count++] = key_value;
+    } else if (iree_string_view_equal(key, IREE_SV("function"))) {
+      out_spec->function = key_value;
+    } else if (iree_string_view_equal(key, IREE_SV("input"))) {
+      if (out_spec->input_count >= IREE_TOOLING_MULTI_MODEL_MAX_INPUTS) {
+        return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                                "too many inputs in model spec; max %d",
+                                IREE_TOOLING_MULTI_MODEL_MAX_INPUTS);
+      }
+      out_spec->inputs[out_spec->input_count++] = key_value;
+    } else if (iree_string_view_equal(key, IREE_SV("concurrency"))) {
+      if (!iree_string_view_atoi_int32(key_value, &out_spec->concurrency) ||
+          out_spec->concurrency <= 0) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "invalid model concurrency `%.*s`",
+                                (int)key_value.size, key_value.data);
+      }
+    } else if (iree_string_view_equal(key, IREE_SV("rate"))) {
+      if (!iree_string_view_atod(key_value, &out_spec->rate) ||
+          out_spec->rate < 0.0) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "invalid model rate `%.*s`",
+                                (int)key_value.size, key_value.data);
+      }
+    } else {
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                              "unknown model spec key `%.*s`", (int)key.size,
+                              key.data);
+    }
+  }
+
+  if (!out_spec->module_count) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "model spec `%.*s` has no module", (int)value.size,
+                            value.data);
+  }
+  if (iree_string_view_is_empty(out_spec->name)) {
+    out_spec->name = out_spec->function;
+  }
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// Benchmark state
+//===----------------------------------------------------------------------===//
+
+typedef struct iree_tooling_multi_model_benchmark_t
+    iree_tooling_multi_model_benchmark_t;
+typedef struct iree_tooling_multi_model_t iree_tooling_multi_model_t;
+
+// A worker thread repeatedly invoking the function of a model.
+typedef struct iree_tooling_multi_model_worker_t {
+  iree_tooling_multi_model_t* model;
+  // Ordinal of the worker within the model used to stagger arrivals.
+  iree_host_size_t ordinal;
+  // Context owned exclusively by the worker.
+  iree_vm_context_t* context;
+  iree_thread_t* thread;
+  // Latencies in nanoseconds of the invocations that arrived while measuring.
+  iree_host_size_t latency_capacity;
+  iree_host_size_t latency_count;
+  int64_t* latencies;
+  // Failure of the worker, if any. Only valid after the thread is joined.
+  iree_status_t status;
+} iree_tooling_multi_model_worker_t;
+
+struct iree_tooling_multi_model_t {
+  iree_tooling_multi_model_benchmark_t* benchmark;
+  iree_tooling_multi_model_spec_t spec;
+  iree_host_size_t module_count;
+  iree_vm_module_t* modules[IREE_TOOLING_MULTI_MODEL_MAX_MODULES];
+  iree_vm_function_t function;
+  // Inputs shared by all workers. Each invocation uses a shallow clone.
+  iree_vm_list_t* inputs;
+  iree_host_size_t worker_count;
+  iree_tooling_multi_model_worker_t* workers;
+};
+
+struct iree_tooling_multi_model_benchmark_t {
+  iree_allocator_t host_allocator;
+  iree_hal_device_t* device;
+  iree_hal_allocator_t* device_allocator;
+  // System modules (HAL, etc) shared by the contexts of all models.
+  iree_tooling_module_list_t system_modules;
+  iree_time_t start_time;
+  iree_time_t measure_start_time;
+  iree_time_t end_time;
+  iree_host_size_t model_count;
+  iree_tooling_multi_model_t models[IREE_TOOLING_MULTI_MODEL_MAX_MODELS];
+};
+
+// Returns true if |module| is a user module of any model in |benchmark|.
+static bool iree_tooling_multi_model_is_user_module(
+    iree_tooling_multi_model_benchmark_t* benchmark, iree_vm_module_t* module) {
+  for (iree_host_size_t i = 0; i < benchmark->model_count; ++i) {
+    const iree_tooling_multi_model_t* model = &benchmark->models[i];
+    for (iree_host_size_t j = 0; j < model->module_count; ++j) {
+      if (model->modules[j] == module) return true;
+    }
+  }
+  return false;
+}
+
+// Loads the modules of all models and resolves their dependencies once so
+// that all contexts share the same system modules and HAL device.
+static iree_status_t iree_tooling_multi_model_resolve_system_modules(
+    iree_vm_instance_t* instance,
+    iree_tooling_multi_model_benchmark_t* benchmark) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator = benchmark->host_allocator;
+
+  iree_status_t status = iree_ok_status();
+  iree_tooling_module_list_t user_modules;
+  iree_tooling_module_list_initialize(&user_modules);
+  for (iree_host_size_t i = 0;
+       i < benchmark->model_count && iree_status_is_ok(status); ++i) {
+    iree_tooling_multi_model_t* model = &benchmark->models[i];
+    for (iree_host_size_t j = 0; j < model->spec.module_count; ++j) {
+      iree_string_view_t module_spec = model->spec.modules[j];
+      status = iree_status_annotate_f(
+          iree_tooling_load_module_from_path(instance, module_spec,
+                                             host_allocator,
+                                             &model->modules[j]),
+          "loading module '%.*s'", (int)module_spec.size, module_spec.data);
+      if (!iree_status_is_ok(status)) break;
+      ++model->module_count;
+      status = iree_tooling_module_list_push_back(&user_modules,
+                                                  model->modules[j]);
+      if (!iree_status_is_ok(status)) break;
+    }
+  }
+
+  iree_tooling_module_list_t resolved_modules;
+  iree_tooling_module_list_initialize(&resolved_modules);
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_resolve_modules(
+        instance, user_modules.count, user_modules.values,
+        iree_string_view_empty(), host_allocator, &resolved_modules,
+        &benchmark->device, &benchmark->device_allocator);
+  }
+  for (iree_host_size_t i = 0;
+       i < resolved_modules.count && iree_status_is_ok(status); ++i) {
+    iree_vm_module_t* module = resolved_modules.values[i];
+    if (iree_tooling_multi_model_is_user_module(benchmark, module)) continue;
+    status = iree_tooling_module_list_push_back(&benchmark->system_modules,
+                                                module);
+  }
+  iree_tooling_module_list_reset(&resolved_modules);
+  iree_tooling_module_list_reset(&user_modules);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Prepares the function, inputs and per-worker contexts of |model|.
+static iree_status_t iree_tooling_multi_model_prepare(
+    iree_vm_instance_t* instance, iree_tooling_multi_model_t* model) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_tooling_multi_model_benchmark_t* benchmark = model->benchmark;
+  iree_allocator_t host_allocator = benchmark->host_allocator;
+
+  // The function is exported from the last module of the model as with
+  // --module= and --function= in the other tools.
+  iree_vm_module_t* main_module = model->modules[model->module_count - 1];
+  iree_status_t status = iree_ok_status();
+  if (iree_string_view_is_empty(model->spec.function)) {
+    status = iree_tooling_find_single_exported_function(main_module,
+                                                        &model->function);
+    if (iree_status_is_ok(status) &&
+        iree_string_view_is_empty(model->spec.name)) {
+      model->spec.name = iree_vm_function_name(&model->function);
+    }
+  } else {
+    status = iree_status_annotate_f(
+        iree_vm_module_lookup_function_by_name(
+            main_module, IREE_VM_FUNCTION_LINKAGE_EXPORT, model->spec.function,
+            &model->function),
+        "looking up function '%.*s'", (int)model->spec.function.size,
+        model->spec.function.data);
+  }
+
+  // Inputs are parsed once and shared by all invocations of the model.
+  if (iree_status_is_ok(status)) {
+    iree_vm_function_signature_t signature =
+        iree_vm_function_signature(&model->function);
+    iree_string_view_t arguments_cconv, results_cconv;
+    status = iree_vm_function_call_get_cconv_fragments(
+        &signature, &arguments_cconv, &results_cconv);
+    if (iree_status_is_ok(status)) {
+      iree_string_view_list_t input_list = {
+          .count = model->spec.input_count,
+          .values = model->spec.inputs,
+      };
+      status = iree_status_annotate_f(
+          iree_tooling_parse_variants(arguments_cconv, input_list,
+                                      benchmark->device,
+                                      benchmark->device_allocator,
+                                      host_allocator, &model->inputs),
+          "parsing inputs of model '%.*s'", (int)model->spec.name.size,
+          model->spec.name.data);
+    }
+  }
+
+  // Each worker gets its own context as contexts may not be used by multiple
+  // threads concurrently.
+  if (iree_status_is_ok(status)) {
+    status = iree_allocator_malloc(
+        host_allocator, model->spec.concurrency * sizeof(*model->workers),
+        (void**)&model->workers);
+  }
+  for (iree_host_size_t i = 0;
+       i < (iree_host_size_t)model->spec.concurrency &&
+       iree_status_is_ok(status);
+       ++i) {
+    iree_tooling_multi_model_worker_t* worker = &model->workers[i];
+    worker->model = model;
+    worker->ordinal = i;
+    status = iree_tooling_create_context_with_system_modules(
+        instance, &benchmark->system_modules, model->module_count,
+        model->modules, host_allocator, &worker->context);
+    if (iree_status_is_ok(status)) ++model->worker_count;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+static void iree_tooling_multi_model_deinitialize(
+    iree_tooling_multi_model_benchmark_t* benchmark) {
+  iree_allocator_t host_allocator = benchmark->host_allocator;
+  for (iree_host_size_t i = 0; i < benchmark->model_count; ++i) {
+    iree_tooling_multi_model_t* model = &benchmark->models[i];
+    for (iree_host_size_t j = 0; j < model->worker_count; ++j) {
+      iree_tooling_multi_model_worker_t* worker = &model->workers[j];
+      iree_status_ignore(worker->status);
+      iree_allocator_free(host_allocator, worker->latencies);
+      iree_vm_context_release(worker->context);
+    }
+    iree_allocator_free(host_allocator, model->workers);
+    iree_vm_list_release(model->inputs);
+    for (iree_host_size_t j = 0; j < model->module_count; ++j) {
+      iree_vm_module_release(model->modules[j]);
+    }
+  }
+  iree_tooling_module_list_reset(&benchmark->system_modules);
+  iree_hal_allocator_release(benchmark->device_allocator);
+  iree_hal_device_release(benchmark->device);
+}
+
+//===----------------------------------------------------------------------===//
+// Workers
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_tooling_multi_model_record_latency(
+    iree_tooling_multi_model_worker_t* worker, int64_t latency_ns) {
+  if (worker->latency_count == worker->latency_capacity) {
+    iree_host_size_t new_capacity =
+        iree_max((iree_host_size_t)1024, worker->latency_capacity * 2);
+    IREE_RETURN_IF_ERROR(iree_allocator_realloc(
+        worker->model->benchmark->host_allocator,
+        new_capacity * sizeof(*worker->latencies),
+        (void**)&worker->latencies));
+    worker->latency_capacity = new_capacity;
+  }
+  worker->latencies[worker->latency_count++] = latency_ns;
+  return iree_ok_status();
+}
+
+// Invokes the model function once and waits for it to complete.
+static iree_status_t iree_tooling_multi_model_invoke(
+    iree_tooling_multi_model_worker_t* worker, iree_vm_list_t* outputs) {
+  iree_tooling_multi_model_t* model = worker->model;
+  iree_allocator_t host_allocator = model->benchmark->host_allocator;
+
+  // Async functions have fences appended and need a fresh argument list.
+  iree_vm_list_t* inputs = NULL;
+  IREE_RETURN_IF_ERROR(
+      iree_vm_list_clone(model->inputs, host_allocator, &inputs));
+  iree_hal_fence_t* finish_fence = NULL;
+  iree_status_t status = iree_tooling_append_async_fences(
+      inputs, model->function, model->benchmark->device,
+      /*wait_fence=*/NULL, &finish_fence);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_invoke(worker->context, model->function,
+                            IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/NULL,
+                            inputs, outputs, host_allocator);
+  }
+  iree_vm_list_release(inputs);
+  if (iree_status_is_ok(status) && finish_fence) {
+    status = iree_hal_fence_wait(finish_fence, iree_infinite_timeout());
+  }
+  iree_hal_fence_release(finish_fence);
+  iree_vm_list_clear(outputs);
+  return status;
+}
+
+// Runs invocations until the end of the benchmark.
+//
+// Closed-loop workers invoke again as soon as the previous invocation
+// completes. Open-loop workers follow a fixed arrival schedule with the
+// arrivals of a model interleaved across its workers; latency is measured from
+// the scheduled arrival so that time spent queued behind a slow invocation is
+// included the same way a serving application would observe it.
+static iree_status_t iree_tooling_multi_model_worker_run(
+    iree_tooling_multi_model_worker_t* worker) {
+  iree_tooling_multi_model_t* model = worker->model;
+  iree_tooling_multi_model_benchmark_t* benchmark = model->benchmark;
+
+  iree_vm_list_t* outputs = NULL;
+  IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                           16, benchmark->host_allocator,
+                                           &outputs));
+
+  iree_duration_t interval_ns = 0;
+  iree_time_t arrival_time = benchmark->start_time;
+  if (model->spec.rate > 0.0) {
+    interval_ns =
+        (iree_duration_t)(model->spec.concurrency * 1e9 / model->spec.rate);
+    arrival_time += interval_ns * (iree_duration_t)worker->ordinal /
+                    model->spec.concurrency;
+  }
+
+  iree_status_t status = iree_ok_status();
+  while (iree_status_is_ok(status)) {
+    if (interval_ns) {
+      if (arrival_time >= benchmark->end_time) break;
+      iree_wait_until(arrival_time);
+    } else {
+      arrival_time = iree_time_now();
+    }
+    if (iree_time_now() >= benchmark->end_time) break;
+    status = iree_tooling_multi_model_invoke(worker, outputs);
+    iree_time_t completion_time = iree_time_now();
+    if (iree_status_is_ok(status) &&
+        arrival_time >= benchmark->measure_start_time) {
+      status = iree_tooling_multi_model_record_latency(
+          worker, completion_time - arrival_time);
+    }
+    arrival_time += interval_ns;
+  }
+
+  iree_vm_list_release(outputs);
+  return status;
+}
+
+static int iree_tooling_multi_model_worker_main(void* entry_arg) {
+  iree_tooling_multi_model_worker_t* worker =
+      (iree_tooling_multi_model_worker_t*)entry_arg;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  worker->status = iree_tooling_multi_model_worker_run(worker);
+  IREE_TRACE_ZONE_END(z0);
+  return 0;
+}
+
+//===----------------------------------------------------------------------===//
+// Reporting
+//===----------------------------------------------------------------------===//
+
+// Executor counters reported as the delta over the measurement.
+static const char* iree_tooling_multi_model_executor_keys[] = {
+    "tasks_executed", "tiles_executed", "tile_time_ns",
+    "steal_attempts", "steal_successes", "wakeups",
+    "wake_requests",  "wake_latency_ns", "spin_time_ns",
+    "sleep_time_ns",
+};
+#define IREE_TOOLING_MULTI_MODEL_EXECUTOR_KEY_COUNT \
+  IREE_ARRAYSIZE(iree_tooling_multi_model_executor_keys)
+
+typedef struct iree_tooling_multi_model_snapshot_t {
+  // False if the device has no task executor (non-CPU devices).
+  bool has_executor;
+  int64_t executor[IREE_TOOLING_MULTI_MODEL_EXECUTOR_KEY_COUNT];
+  iree_hal_allocator_statistics_t allocator;
+} iree_tooling_multi_model_snapshot_t;
+
+static iree_status_t iree_tooling_multi_model_snapshot(
+    iree_tooling_multi_model_benchmark_t* benchmark,
+    iree_tooling_multi_model_snapshot_t* out_snapshot) {
+  memset(out_snapshot, 0, sizeof(*out_snapshot));
+  if (benchmark->device) {
+    out_snapshot->has_executor = true;
+    for (iree_host_size_t i = 0;
+         i < IREE_TOOLING_MULTI_MODEL_EXECUTOR_KEY_COUNT; ++i) {
+      iree_status_t status = iree_hal_device_query_i64(
+          benchmark->device, IREE_SV("task.executor"),
+          iree_make_cstring_view(iree_tooling_multi_model_executor_keys[i]),
+          &out_snapshot->executor[i]);
+      if (iree_status_is_not_found(status)) {
+        iree_status_ignore(status);
+        out_snapshot->has_executor = false;
+        break;
+      }
+      IREE_RETURN_IF_ERROR(status);
+    }
+  }
+  if (benchmark->device_allocator) {
+    iree_hal_allocator_query_statistics(benchmark->device_allocator,
+                                        &out_snapshot->allocator);
+  }
+  return iree_ok_status();
+}
+
+static int iree_tooling_multi_model_compare_i64(const void* lhs,
+                                                const void* rhs) {
+  int64_t a = *(const int64_t*)lhs;
+  int64_t b = *(const int64_t*)rhs;
+  return a < b ? -1 : (a > b ? 1 : 0);
+}
+
+static double iree_tooling_multi_model_percentile_us(const int64_t* sorted,
+                                                     iree_host_size_t count,
+                                                     double percentile) {
+  if (!count) return 0.0;
+  iree_host_size_t index = (iree_host_size_t)(percentile / 100.0 * count);
+  if (index >= count) index = count - 1;
+  return sorted[index] / 1e3;
+}
+
+static iree_status_t iree_tooling_multi_model_print_model(
+    iree_tooling_multi_model_t* model, double measure_seconds, FILE* file) {
+  iree_allocator_t host_allocator = model->benchmark->host_allocator;
+
+  // Gather the latencies of all workers into one sorted list.
+  iree_host_size_t count = 0;
+  for (iree_host_size_t i = 0; i < model->worker_count; ++i) {
+    count += model->workers[i].latency_count;
+  }
+  int64_t* latencies = NULL;
+  if (count) {
+    IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+        host_allocator, count * sizeof(*latencies), (void**)&latencies));
+    iree_host_size_t offset = 0;
+    for (iree_host_size_t i = 0; i < model->worker_count; ++i) {
+      const iree_tooling_multi_model_worker_t* worker = &model->workers[i];
+      memcpy(latencies + offset, worker->latencies,
+             worker->latency_count * sizeof(*latencies));
+      offset += worker->latency_count;
+    }
+    qsort(latencies, count, sizeof(*latencies),
+          iree_tooling_multi_model_compare_i64);
+  }
+  double total_ns = 0.0;
+  for (iree_host_size_t i = 0; i < count; ++i) total_ns += latencies[i];
+
+  iree_string_view_t function_name = iree_vm_function_name(&model->function);
+  fprintf(file, "    {\n");
+  fprintf(file, "      \"name\": \"%.*s\",\n", (int)model->spec.name.size,
+          model->spec.name.data);
+  fprintf(file, "      \"function\": \"%.*s\",\n", (int)function_name.size,
+          function_name.data);
+  fprintf(file, "      \"concurrency\": %d,\n", model->spec.concurrency);
+  fprintf(file, "      \"target_rate\": %.3f,\n", model->spec.rate);
+  fprintf(file, "      \"invocations\": %" PRIhsz ",\n", count);
+  fprintf(file, "      \"throughput\": %.3f,\n", count / measure_seconds);
+  fprintf(file, "      \"latency_us\": {\n");
+  fprintf(file, "        \"mean\": %.3f,\n",
+          count ? total_ns / count / 1e3 : 0.0);
+  fprintf(file, "        \"p50\": %.3f,\n",
+          iree_tooling_multi_model_percentile_us(latencies, count, 50.0));
+  fprintf(file, "        \"p90\": %.3f,\n",
+          iree_tooling_multi_model_percentile_us(latencies, count, 90.0));
+  fprintf(file, "        \"p99\": %.3f,\n",
+          iree_tooling_multi_model_percentile_us(latencies, count, 99.0));
+  fprintf(file, "        \"max\": %.3f\n",
+          count ? latencies[count - 1] / 1e3 : 0.0);
+  fprintf(file, "      }\n");
+  fprintf(file, "    }");
+
+  iree_allocator_free(host_allocator, latencies);
+  return iree_ok_status();
+}
+
+static void iree_tooling_multi_model_print_allocator(
+    const iree_hal_allocator_statistics_t* statistics, FILE* file) {
+  fprintf(file, "  \"allocator\": {");
+#if IREE_STATISTICS_ENABLE
+  fprintf(file, "\n");
+  fprintf(file, "    \"host_bytes_peak\": %" PRIu64 ",\n",
+          (uint64_t)statistics->host_bytes_peak);
+  fprintf(file, "    \"device_bytes_peak\": %" PRIu64 ",\n",
+          (uint64_t)statistics->device_bytes_peak);
+  fprintf(file, "    \"device_bytes_allocated\": %" PRIu64 ",\n",
+          (uint64_t)statistics->device_bytes_allocated);
+  fprintf(file, "    \"device_bytes_freed\": %" PRIu64 ",\n",
+          (uint64_t)statistics->device_bytes_freed);
+  fprintf(file, "    \"pool_bytes_peak\": %" PRIu64 ",\n",
+          (uint64_t)statistics->pool_bytes_peak);
+  fprintf(file, "    \"pool_acquire_count\": %" PRIu64 ",\n",
+          statistics->pool_acquire_count);
+  fprintf(file, "    \"pool_reuse_count\": %" PRIu64 "\n",
+          statistics->pool_reuse_count);
+  fprintf(file, "  ");
+#else
+  (void)statistics;
+#endif  // IREE_STATISTICS_ENABLE
+  fprintf(file, "}\n");
+}
+
+static iree_status_t iree_tooling_multi_model_print_report(
+    iree_tooling_multi_model_benchmark_t* benchmark,
+    const iree_tooling_multi_model_snapshot_t* begin,
+    const iree_tooling_multi_model_snapshot_t* end, FILE* file) {
+  double measure_seconds =
+      (benchmark->end_time - benchmark->measure_start_time) / 1e9;
+  fprintf(file, "{\n");
+  fprintf(file, "  \"measure_duration_s\": %.3f,\n", measure_seconds);
+  fprintf(file, "  \"models\": [\n");
+  for (iree_host_size_t i = 0; i < benchmark->model_count; ++i) {
+    IREE_RETURN_IF_ERROR(iree_tooling_multi_model_print_model(
+        &benchmark->models[i], measure_seconds, file));
+    fprintf(file, i + 1 < benchmark->model_count ? ",\n" : "\n");
+  }
+  fprintf(file, "  ],\n");
+  if (begin->has_executor && end->has_executor) {
+    fprintf(file, "  \"executor\": {\n");
+    for (iree_host_size_t i = 0;
+         i < IREE_TOOLING_MULTI_MODEL_EXECUTOR_KEY_COUNT; ++i) {
+      fprintf(file, "    \"%s\": %" PRId64 "%s\n",
+              iree_tooling_multi_model_executor_keys[i],
+              end->executor[i] - begin->executor[i],
+              i + 1 < IREE_TOOLING_MULTI_MODEL_EXECUTOR_KEY_COUNT ? "," : "");
+    }
+    fprintf(file, "  },\n");
+  }
+  iree_tooling_multi_model_print_allocator(&end->allocator, file);
+  fprintf(file, "}\n");
+  return iree_ok_status();
+}
+
+//===----------------------------------------------------------------------===//
+// iree_tooling_run_multi_model_benchmark_from_flags
+//===----------------------------------------------------------------------===//
+
+static iree_status_t iree_tooling_multi_model_run(
+    iree_tooling_multi_model_benchmark_t* benchmark,
+    iree_tooling_multi_model_snapshot_t* out_begin,
+    iree_tooling_multi_model_snapshot_t* out_end) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  benchmark->start_time = iree_time_now();
+  benchmark->measure_start_time =
+      benchmark->start_time +
+      (iree_duration_t)(FLAG_warmup_duration * 1000000000.0);
+  benchmark->end_time =
+      benchmark->measure_start_time +
+      (iree_duration_t)(FLAG_measure_duration * 1000000000.0);
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0;
+       i < benchmark->model_count && iree_status_is_ok(status); ++i) {
+    iree_tooling_multi_model_t* model = &benchmark->models[i];
+    for (iree_host_size_t j = 0; j < model->worker_count; ++j) {
+      iree_tooling_multi_model_worker_t* worker = &model->workers[j];
+      iree_thread_create_params_t params;
+      memset(&params, 0, sizeof(params));
+      params.name = model->spec.name;
+      status = iree_thread_create(iree_tooling_multi_model_worker_main, worker,
+                                  params, benchmark->host_allocator,
+                                  &worker->thread);
+      if (!iree_status_is_ok(status)) break;
+    }
+  }
+
+  // Workers stop on their own at the end time; if a thread failed to launch
+  // the others still need to run to completion before we can bail.
+  if (iree_status_is_ok(status)) {
+    iree_wait_until(benchmark->measure_start_time);
+    status = iree_tooling_multi_model_snapshot(benchmark, out_begin);
+  }
+  for (iree_host_size_t i = 0; i < benchmark->model_count; ++i) {
+    iree_tooling_multi_model_t* model = &benchmark->models[i];
+    for (iree_host_size_t j = 0; j < model->worker_count; ++j) {
+      iree_tooling_multi_model_worker_t* worker = &model->workers[j];
+      if (!worker->thread) continue;
+      iree_thread_join(worker->thread);
+      iree_thread_release(worker->thread);
+      worker->thread = NULL;
+      if (iree_status_is_ok(status) && !iree_status_is_ok(worker->status)) {
+        iree_string_view_t name = model->spec.name;
+        status = iree_status_annotate_f(worker->status,
+                                        "running model '%.*s' worker %" PRIhsz,
+                                        (int)name.size, name.data, j);
+        worker->status = iree_ok_status();
+      }
+    }
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_multi_model_snapshot(benchmark, out_end);
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+iree_status_t iree_tooling_run_multi_model_benchmark_from_flags(
+    iree_vm_instance_t* instance, iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(instance);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  const iree_flag_string_list_t model_flags = FLAG_model_list();
+  if (model_flags.count == 0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "no models specified; use --model= to add one");
+  } else if (model_flags.count > IREE_TOOLING_MULTI_MODEL_MAX_MODELS) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "too many models specified; max %d",
+                            IREE_TOOLING_MULTI_MODEL_MAX_MODELS);
+  }
+  if (FLAG_warmup_duration < 0.0 || FLAG_measure_duration <= 0.0) {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "--warmup_duration= must be non-negative and "
+                            "--measure_duration= must be positive");
+  }
+
+  iree_tooling_multi_model_benchmark_t* benchmark = NULL;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_allocator_malloc(host_allocator, sizeof(*benchmark),
+                                (void**)&benchmark));
+  benchmark->host_allocator = host_allocator;
+  iree_tooling_module_list_initialize(&benchmark->system_modules);
+
+  iree_status_t status = iree_ok_status();
+  for (iree_host_size_t i = 0; i < model_flags.count; ++i) {
+    iree_tooling_multi_model_t* model = &benchmark->models[i];
+    model->benchmark = benchmark;
+    status = iree_tooling_multi_model_spec_parse(model_flags.values[i],
+                                                 &model->spec);
+    if (!iree_status_is_ok(status)) break;
+    ++benchmark->model_count;
+  }
+  if (iree_status_is_ok(status)) {
+    status =
+        iree_tooling_multi_model_resolve_system_modules(instance, benchmark);
+  }
+  for (iree_host_size_t i = 0;
+       i < benchmark->model_count && iree_status_is_ok(status); ++i) {
+    status = iree_tooling_multi_model_prepare(instance, &benchmark->models[i]);
+  }
+
+  iree_tooling_multi_model_snapshot_t begin, end;
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_multi_model_run(benchmark, &begin, &end);
+  }
+
+  if (iree_status_is_ok(status)) {
+    bool use_stdout = strcmp(FLAG_report, "-") == 0;
+    FILE* file = use_stdout ? stdout : fopen(FLAG_report, "wb");
+    if (!file) {
+      status = iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                                "failed to open report file '%s'",
+                                FLAG_report);
+    } else {
+      status = iree_tooling_multi_model_print_report(benchmark, &begin, &end,
+                                                     file);
+      if (use_stdout) {
+        fflush(file);
+      } else {
+        fclose(file);
+      }
+    }
+  }
+
+  iree_tooling_multi_model_deinitialize(benchmark);
+  iree_allocator_free(host_allocator, benchmark);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
@@ -0,0 +1,71 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef IREE_TOOLING_MULTI_MODEL_H_
+#define IREE_TOOLING_MULTI_MODEL_H_
+
+#include "iree/base/api.h"
+#include "iree/vm/api.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif  // __cplusplus
+
+// Maximum number of modules loaded for a single model.
+#define IREE_TOOLING_MULTI_MODEL_MAX_MODULES 8
+
+// Maximum number of inputs provided to the function of a single model.
+#define IREE_TOOLING_MULTI_MODEL_MAX_INPUTS 32
+
+// A model hosted by the multi-model benchmark as specified by a --model= flag.
+// All string views reference the storage of the parsed specification string.
+typedef struct iree_tooling_multi_model_spec_t {
+  // Name of the model in the report. Defaults to the function name.
+  iree_string_view_t name;
+  // Modules in the same form as the --module= flag loaded into each context
+  // of the model in order. The function is looked up in the last module.
+  iree_host_size_t module_count;
+  iree_string_view_t modules[IREE_TOOLING_MULTI_MODEL_MAX_MODULES];
+  // Name of the exported function invoked.
+  iree_string_view_t function;
+  // Function inputs in the same form as the --input= flag.
+  iree_host_size_t input_count;
+  iree_string_view_t inputs[IREE_TOOLING_MULTI_MODEL_MAX_INPUTS];
+  // Number of workers invoking the function concurrently. Each worker has its
+  // own VM context as a serving application would for independent requests.
+  int32_t concurrency;
+  // Target invocations per second across all workers of the model or 0 to
+  // invoke the function again as soon as the previous invocation completes.
+  double rate;
+} iree_tooling_multi_model_spec_t;
+
+// Parses a model specification of the form `key=value,key=value,...`.
+// Supported keys are `name`, `module` (repeated), `function`, `input`
+// (repeated), `concurrency` and `rate`. Example:
+//   name=encoder,module=encoder.vmfb,function=main,input=@input.npy,
+//   concurrency=2,rate=50
+iree_status_t iree_tooling_multi_model_spec_parse(
+    iree_string_view_t value, iree_tooling_multi_model_spec_t* out_spec);
+
+// Runs the multi-model benchmark specified by the command line flags.
+//
+// Each --model= flag describes a model whose modules are loaded once and
+// instantiated into one VM context per worker. All contexts of all models
+// share the HAL devices created from the --device= flags along with their
+// task executors and allocators, so the measurements include the interference
+// between models: executor contention, allocator sharing and cache thrashing.
+// Workers run concurrently for --warmup_duration= seconds followed by
+// --measure_duration= seconds and a JSON report with the per-model throughput
+// and latency percentiles and the executor and allocator counters accumulated
+// while measuring is written to --report= (stdout by default).
+iree_status_t iree_tooling_run_multi_model_benchmark_from_flags(
+    iree_vm_instance_t* instance, iree_allocator_t host_allocator);
+
+#ifdef __cplusplus
+}  // extern "C"
+#endif  // __cplusplus
+
+#endif  // IREE_TOOLING_MULTI_MODEL_H_
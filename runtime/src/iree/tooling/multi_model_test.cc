@@ -0,0 +1,74 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/tooling/multi_model.h"
+
+#include "iree/base/api.h"
+#include "iree/testing/gtest.h"
+#include "iree/testing/status_matchers.h"
+
+namespace iree {
+namespace {
+
+using iree::testing::status::StatusIs;
+
+static std::string ToString(iree_string_view_t value) {
+  return std::string(value.data, value.size);
+}
+
+TEST(MultiModelSpecTest, ParseDefaults) {
+  iree_tooling_multi_model_spec_t spec;
+  IREE_ASSERT_OK(iree_tooling_multi_model_spec_parse(
+      IREE_SV("module=a.vmfb,function=main"), &spec));
+  EXPECT_EQ(ToString(spec.name), "main");
+  ASSERT_EQ(spec.module_count, 1u);
+  EXPECT_EQ(ToString(spec.modules[0]), "a.vmfb");
+  EXPECT_EQ(ToString(spec.function), "main");
+  EXPECT_EQ(spec.input_count, 0u);
+  EXPECT_EQ(spec.concurrency, 1);
+  EXPECT_EQ(spec.rate, 0.0);
+}
+
+TEST(MultiModelSpecTest, ParseAll) {
+  iree_tooling_multi_model_spec_t spec;
+  IREE_ASSERT_OK(iree_tooling_multi_model_spec_parse(
+      IREE_SV("name=encoder, module=dep.so@create, module=enc.vmfb,"
+              "function=run,input=4xf32=1 2 3 4,input=@in.npy,"
+              "concurrency=3,rate=12.5"),
+      &spec));
+  EXPECT_EQ(ToString(spec.name), "encoder");
+  ASSERT_EQ(spec.module_count, 2u);
+  EXPECT_EQ(ToString(spec.modules[0]), "dep.so@create");
+  EXPECT_EQ(ToString(spec.modules[1]), "enc.vmfb");
+  EXPECT_EQ(ToString(spec.function), "run");
+  ASSERT_EQ(spec.input_count, 2u);
+  EXPECT_EQ(ToString(spec.inputs[0]), "4xf32=1 2 3 4");
+  EXPECT_EQ(ToString(spec.inputs[1]), "@in.npy");
+  EXPECT_EQ(spec.concurrency, 3);
+  EXPECT_EQ(spec.rate, 12.5);
+}
+
+TEST(MultiModelSpecTest, ParseErrors) {
+  iree_tooling_multi_model_spec_t spec;
+  EXPECT_THAT(Status(iree_tooling_multi_model_spec_parse(
+                  IREE_SV("function=main"), &spec)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_THAT(Status(iree_tooling_multi_model_spec_parse(
+                  IREE_SV("module=a.vmfb,bogus"), &spec)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_THAT(Status(iree_tooling_multi_model_spec_parse(
+                  IREE_SV("module=a.vmfb,color=red"), &spec)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_THAT(Status(iree_tooling_multi_model_spec_parse(
+                  IREE_SV("module=a.vmfb,concurrency=0"), &spec)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_THAT(Status(iree_tooling_multi_model_spec_parse(
+                  IREE_SV("module=a.vmfb,rate=-1"), &spec)),
+              StatusIs(StatusCode::kInvalidArgument));
+}
+
+}  // namespace
+}  // namespace iree
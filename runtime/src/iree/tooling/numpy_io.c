@@ -281,18 +281,13 @@ static iree_status_t iree_numpy_parse_shape_dims(iree_string_view_t shape,
   return iree_ok_status();
 }
 
-IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray(
-    iree_io_stream_t* stream, iree_numpy_npy_load_options_t options,
-    iree_hal_buffer_params_t buffer_params, iree_hal_device_t* device,
-    iree_hal_allocator_t* device_allocator,
-    iree_hal_buffer_view_t** out_buffer_view) {
+IREE_API_EXPORT iree_status_t iree_numpy_npy_read_ndarray_header(
+    iree_io_stream_t* stream, iree_allocator_t host_allocator,
+    iree_numpy_npy_ndarray_header_t* out_header) {
   IREE_ASSERT_ARGUMENT(stream);
-  IREE_ASSERT_ARGUMENT(device_allocator);
-  IREE_ASSERT_ARGUMENT(out_buffer_view);
-  *out_buffer_view = NULL;
+  IREE_ASSERT_ARGUMENT(out_header);
+  memset(out_header, 0, sizeof(*out_header));
   IREE_TRACE_ZONE_BEGIN(z0);
-  iree_allocator_t host_allocator =
-      iree_hal_allocator_host_allocator(device_allocator);
 
   // Quick check for EOF; if already there we can give a better error than
   // if we failed trying to parse the header. Since npy files are often
@@ -321,10 +316,8 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray(
   // also be keys we don't understand such as when what's saved is a pickled
   // object. We implement a basic scanning parser here and try to deal with it.
   iree_status_t status = iree_ok_status();
-  iree_host_size_t shape_rank = 0;
-  iree_hal_dim_t* shape = NULL;
-  iree_hal_element_type_t element_type = IREE_HAL_ELEMENT_TYPE_NONE;
-  iree_hal_encoding_type_t encoding_type = IREE_HAL_ENCODING_TYPE_OPAQUE;
+  out_header->element_type = IREE_HAL_ELEMENT_TYPE_NONE;
+  out_header->encoding_type = IREE_HAL_ENCODING_TYPE_OPAQUE;
   iree_string_view_consume_prefix(&header, IREE_SV("{"));
   iree_string_view_consume_suffix(&header, IREE_SV("}"));
   while (!iree_string_view_is_empty(header)) {
@@ -334,43 +327,65 @@ IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray(
     if (!iree_status_is_ok(status)) break;
 
     if (iree_string_view_equal(key, IREE_SV("descr"))) {
-      status = iree_numpy_descr_to_element_type(value, &element_type);
+      status =
+          iree_numpy_descr_to_element_type(value, &out_header->element_type);
     } else if (iree_string_view_equal(key, IREE_SV("fortran_order"))) {
       if (iree_string_view_equal(value, IREE_SV("False"))) {
-        encoding_type = IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
+        out_header->encoding_type = IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR;
       } else {
         status = iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                                   "fortran order arrays not supported");
       }
     } else if (iree_string_view_equal(key, IREE_SV("shape"))) {
-      shape_rank = iree_numpy_parse_shape_rank(value);
-      if (shape_rank > 128) {
+      iree_host_size_t shape_rank = iree_numpy_parse_shape_rank(value);
+      if (shape_rank > IREE_ARRAYSIZE(out_header->shape)) {
         status = iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                                   "shape rank %" PRIhsz
-                                  " too large; be reasonable please");
+                                  " too large; be reasonable please",
+                                  shape_rank);
       } else {
-        shape = iree_alloca(shape_rank * sizeof(*shape));
-        status = iree_numpy_parse_shape_dims(value, shape_rank, shape);
+        out_header->shape_rank = shape_rank;
+        status =
+            iree_numpy_parse_shape_dims(value, shape_rank, out_header->shape);
       }
     }
     if (!iree_status_is_ok(status)) break;
   }
 
+  iree_allocator_free(host_allocator, header_buffer);
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT iree_status_t iree_numpy_npy_load_ndarray(
+    iree_io_stream_t* stream, iree_numpy_npy_load_options_t options,
+    iree_hal_buffer_params_t buffer_params, iree_hal_device_t* device,
+    iree_hal_allocator_t* device_allocator,
+    iree_hal_buffer_view_t** out_buffer_view) {
+  IREE_ASSERT_ARGUMENT(stream);
+  IREE_ASSERT_ARGUMENT(device_allocator);
+  IREE_ASSERT_ARGUMENT(out_buffer_view);
+  *out_buffer_view = NULL;
+  IREE_TRACE_ZONE_BEGIN(z0);
+  iree_allocator_t host_allocator =
+      iree_hal_allocator_host_allocator(device_allocator);
+
+  iree_numpy_npy_ndarray_header_t header;
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_numpy_npy_read_ndarray_header(stream, host_allocator, &header));
+
   // Allocate the buffer view and directly read into the allocated memory.
   // On targets where we can perform host mapping this will be zero-copy; on
   // others it'll at least be _somewhat_ efficient.
-  if (iree_status_is_ok(status)) {
-    iree_numpy_npy_read_params_t read_params = {
-        .stream = stream,
-    };
-    buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
-    status = iree_hal_buffer_view_generate_buffer(
-        device, device_allocator, shape_rank, shape, element_type,
-        encoding_type, buffer_params, iree_numpy_npy_read_into_mapping,
-        &read_params, out_buffer_view);
-  }
+  iree_numpy_npy_read_params_t read_params = {
+      .stream = stream,
+  };
+  buffer_params.access |= IREE_HAL_MEMORY_ACCESS_DISCARD_WRITE;
+  iree_status_t status = iree_hal_buffer_view_generate_buffer(
+      device, device_allocator, header.shape_rank, header.shape,
+      header.element_type, header.encoding_type, buffer_params,
+      iree_numpy_npy_read_into_mapping, &read_params, out_buffer_view);
 
-  iree_allocator_free(host_allocator, header_buffer);
   IREE_TRACE_ZONE_END(z0);
   return status;
 }
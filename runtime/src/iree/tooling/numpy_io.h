@@ -67,6 +67,26 @@ enum iree_numpy_npy_save_options_bits_t {
 };
 typedef uint32_t iree_numpy_npy_save_options_t;
 
+// Maximum rank of an ndarray loaded from a .npy file.
+#define IREE_NUMPY_NPY_MAX_SHAPE_RANK 128
+
+// Metadata describing a single ndarray in a .npy file.
+typedef struct iree_numpy_npy_ndarray_header_t {
+  iree_hal_element_type_t element_type;
+  iree_hal_encoding_type_t encoding_type;
+  iree_host_size_t shape_rank;
+  iree_hal_dim_t shape[IREE_NUMPY_NPY_MAX_SHAPE_RANK];
+} iree_numpy_npy_ndarray_header_t;
+
+// Reads the header of the next value in a .npy |stream| into |out_header|.
+// Upon return the |stream| will be positioned at the start of the ndarray
+// contents. Callers can use this to source the contents themselves such as by
+// importing a mapped file instead of reading into a new allocation.
+// Fails with IREE_STATUS_OUT_OF_RANGE if the stream is at its end.
+IREE_API_EXPORT iree_status_t iree_numpy_npy_read_ndarray_header(
+    iree_io_stream_t* stream, iree_allocator_t host_allocator,
+    iree_numpy_npy_ndarray_header_t* out_header);
+
 // Loads a single value from a .npy |stream| into a buffer view.
 // On success |out_buffer_view| will have a buffer view matching the parameters
 // in the npy file allocated from the given |device_allocator|.
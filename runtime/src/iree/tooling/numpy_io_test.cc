@@ -177,6 +177,48 @@ TEST_F(NumpyIOTest, LoadMultipleArrays) {
   ASSERT_TRUE(iree_io_stream_is_eos(stream.get()));
 }
 
+// Tests reading only the headers of arrays in a concatenated file, as used by
+// callers that source the contents themselves from a mapped file.
+TEST_F(NumpyIOTest, ReadArrayHeaders) {
+  auto stream = OpenInputFile("multiple.npy");
+
+  // np.array([1.1, 2.2, 3.3], dtype=np.float32)
+  iree_numpy_npy_ndarray_header_t header;
+  IREE_ASSERT_OK(iree_numpy_npy_read_ndarray_header(
+      stream.get(), iree_allocator_system(), &header));
+  EXPECT_EQ(header.element_type, IREE_HAL_ELEMENT_TYPE_FLOAT_32);
+  EXPECT_EQ(header.encoding_type, IREE_HAL_ENCODING_TYPE_DENSE_ROW_MAJOR);
+  ASSERT_EQ(header.shape_rank, 1u);
+  EXPECT_EQ(header.shape[0], 3u);
+  // Contents start at a 64-byte aligned offset so they can be imported.
+  EXPECT_EQ(iree_io_stream_offset(stream.get()) % 64, 0u);
+  IREE_ASSERT_OK(iree_io_stream_seek(
+      stream.get(), IREE_IO_STREAM_SEEK_FROM_CURRENT, 3 * sizeof(float)));
+
+  // np.array([[0, 1], [2, 3]], dtype=np.int32)
+  IREE_ASSERT_OK(iree_numpy_npy_read_ndarray_header(
+      stream.get(), iree_allocator_system(), &header));
+  EXPECT_EQ(header.element_type, IREE_HAL_ELEMENT_TYPE_SINT_32);
+  ASSERT_EQ(header.shape_rank, 2u);
+  EXPECT_EQ(header.shape[0], 2u);
+  EXPECT_EQ(header.shape[1], 2u);
+  IREE_ASSERT_OK(iree_io_stream_seek(
+      stream.get(), IREE_IO_STREAM_SEEK_FROM_CURRENT, 4 * sizeof(int32_t)));
+
+  // np.array(42, dtype=np.int32)
+  IREE_ASSERT_OK(iree_numpy_npy_read_ndarray_header(
+      stream.get(), iree_allocator_system(), &header));
+  EXPECT_EQ(header.element_type, IREE_HAL_ELEMENT_TYPE_SINT_32);
+  EXPECT_EQ(header.shape_rank, 0u);
+  IREE_ASSERT_OK(iree_io_stream_seek(
+      stream.get(), IREE_IO_STREAM_SEEK_FROM_CURRENT, sizeof(int32_t)));
+
+  // Reading past the last array fails with EOF.
+  EXPECT_THAT(Status(iree_numpy_npy_read_ndarray_header(
+                  stream.get(), iree_allocator_system(), &header)),
+              StatusIs(StatusCode::kOutOfRange));
+}
+
 // Tests loading arrays with various shapes.
 TEST_F(NumpyIOTest, ArrayShapes) {
   auto stream = OpenInputFile("array_shapes.npy");
@@ -8,9 +8,12 @@
 
 #include "iree/base/internal/file_io.h"
 #include "iree/base/internal/flags.h"
+#include "iree/io/file_handle.h"
 #include "iree/io/formats/parser_registry.h"
+#include "iree/io/parameter_dedup_cache.h"
 #include "iree/io/parameter_index.h"
 #include "iree/io/parameter_index_provider.h"
+#include "iree/io/parameter_residency_provider.h"
 #include "iree/io/scope_map.h"
 #include "iree/modules/io/parameters/module.h"
 
@@ -20,11 +23,14 @@
 
 IREE_FLAG(
     string, parameter_mode, "mmap",
-    "A parameter I/O mode of ['preload', 'mmap'].\n"
+    "A parameter I/O mode of ['preload', 'mmap', 'direct'].\n"
     "  preload: read entire parameter files into wired memory on startup.\n"
     "  mmap: maps the parameter files into discardable memory - can increase\n"
     "        warm-up time and variance as mapped pages are swapped\n"
-    "        by the OS.");
+    "        by the OS.\n"
+    "  direct: streams parameters from storage on demand using direct I/O\n"
+    "          (O_DIRECT) with many reads in flight, bypassing the page\n"
+    "          cache. Best for very large files on fast storage.");
 
 static void iree_file_contents_release_callback(
     void* user_data, iree_io_file_handle_primitive_t handle_primitive) {
@@ -32,11 +38,11 @@ static void iree_file_contents_release_callback(
   iree_file_contents_free(file_contents);
 }
 
-// Opens the parameter file at |path| with the mode specified by the
-// --parameter_mode flag and returns its handle.
+// Opens the parameter file at |path| into host memory with |read_flags| and
+// returns its handle.
 static iree_status_t iree_io_open_parameter_file(
-    iree_string_view_t path, iree_allocator_t host_allocator,
-    iree_io_file_handle_t** out_file_handle) {
+    iree_string_view_t path, iree_file_read_flags_t read_flags,
+    iree_allocator_t host_allocator, iree_io_file_handle_t** out_file_handle) {
   IREE_ASSERT_ARGUMENT(out_file_handle);
   *out_file_handle = NULL;
   IREE_TRACE_ZONE_BEGIN(z0);
@@ -44,17 +50,6 @@ static iree_status_t iree_io_open_parameter_file(
 
   char path_str[2048] = {0};
   iree_string_view_to_cstring(path, path_str, sizeof(path_str));
-  iree_file_read_flags_t read_flags = 0;
-  if (strcmp(FLAG_parameter_mode, "mmap") == 0) {
-    read_flags |= IREE_FILE_READ_FLAG_MMAP;
-  } else if (strcmp(FLAG_parameter_mode, "preload") == 0) {
-    read_flags |= IREE_FILE_READ_FLAG_PRELOAD;
-  } else {
-    IREE_TRACE_ZONE_END(z0);
-    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                            "unrecognized --parameter_mode= value '%s'",
-                            FLAG_parameter_mode);
-  }
 
   iree_file_contents_t* file_contents = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
@@ -93,17 +88,104 @@ IREE_FLAG_LIST(
     "- .gguf (https://github.com/ggerganov/ggml/blob/master/docs/gguf.md)\n"
     "- .safetensors (https://github.com/huggingface/safetensors)");
 
-// Appends the parameter file located at |path| to |index|.
+// Appends the parameter file located at |path| to |index| such that all
+// file-backed entries are read with direct I/O.
+//
+// The format parsers require the file headers in memory so we parse a mapped
+// view of the file into a scratch index and then rebind its entries to a
+// direct I/O file handle. Only the pages containing the headers are touched.
+static iree_status_t iree_io_append_parameter_file_to_index_direct(
+    iree_string_view_t path, iree_io_parameter_index_t* index,
+    iree_allocator_t host_allocator) {
+  IREE_ASSERT_ARGUMENT(index);
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Open the file with direct I/O. Some file systems (such as tmpfs) do not
+  // support direct I/O and we fall back to normal buffered reads.
+  iree_io_file_handle_t* direct_handle = NULL;
+  iree_status_t status = iree_io_file_handle_open(
+      IREE_IO_FILE_MODE_READ | IREE_IO_FILE_MODE_DIRECT, path, host_allocator,
+      &direct_handle);
+  if (iree_status_is_invalid_argument(status)) {
+    iree_status_ignore(status);
+    status = iree_io_file_handle_open(IREE_IO_FILE_MODE_READ, path,
+                                      host_allocator, &direct_handle);
+  }
+
+  // Parse the file index from a mapped view of the file.
+  iree_io_file_handle_t* mapped_handle = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_io_open_parameter_file(path, IREE_FILE_READ_FLAG_MMAP,
+                                         host_allocator, &mapped_handle);
+  }
+  iree_io_parameter_index_t* scratch_index = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_index_create(host_allocator, &scratch_index);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parse_file_index(path, mapped_handle, scratch_index);
+  }
+
+  // Rebind all entries referencing the mapped file to the direct file.
+  iree_host_size_t entry_count =
+      scratch_index ? iree_io_parameter_index_count(scratch_index) : 0;
+  if (iree_status_is_ok(status)) {
+    status = iree_io_parameter_index_reserve(
+        index, iree_io_parameter_index_count(index) + entry_count);
+  }
+  for (iree_host_size_t i = 0; i < entry_count && iree_status_is_ok(status);
+       ++i) {
+    const iree_io_parameter_index_entry_t* scratch_entry = NULL;
+    status = iree_io_parameter_index_get(scratch_index, i, &scratch_entry);
+    if (!iree_status_is_ok(status)) break;
+    iree_io_parameter_index_entry_t entry = *scratch_entry;
+    if (entry.type == IREE_IO_PARAMETER_INDEX_ENTRY_STORAGE_TYPE_FILE &&
+        entry.storage.file.handle == mapped_handle) {
+      entry.storage.file.handle = direct_handle;
+    }
+    status = iree_io_parameter_index_add(index, &entry);
+  }
+
+  // Release our references - the direct file is still retained by the index
+  // if it had any parameters in it and the mapping is no longer needed.
+  iree_io_parameter_index_release(scratch_index);
+  iree_io_file_handle_release(mapped_handle);
+  iree_io_file_handle_release(direct_handle);
+
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+// Appends the parameter file located at |path| to |index| with the mode
+// specified by the --parameter_mode flag.
 static iree_status_t iree_io_append_parameter_file_to_index(
     iree_string_view_t path, iree_io_parameter_index_t* index,
     iree_allocator_t host_allocator) {
   IREE_ASSERT_ARGUMENT(index);
   IREE_TRACE_ZONE_BEGIN(z0);
 
+  iree_file_read_flags_t read_flags = 0;
+  if (strcmp(FLAG_parameter_mode, "mmap") == 0) {
+    read_flags |= IREE_FILE_READ_FLAG_MMAP;
+  } else if (strcmp(FLAG_parameter_mode, "preload") == 0) {
+    read_flags |= IREE_FILE_READ_FLAG_PRELOAD;
+  } else if (strcmp(FLAG_parameter_mode, "direct") == 0) {
+    iree_status_t status = iree_io_append_parameter_file_to_index_direct(
+        path, index, host_allocator);
+    IREE_TRACE_ZONE_END(z0);
+    return status;
+  } else {
+    IREE_TRACE_ZONE_END(z0);
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unrecognized --parameter_mode= value '%s'",
+                            FLAG_parameter_mode);
+  }
+
   // Open the file.
   iree_io_file_handle_t* file_handle = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0, iree_io_open_parameter_file(path, host_allocator, &file_handle));
+      z0, iree_io_open_parameter_file(path, read_flags, host_allocator,
+                                      &file_handle));
 
   // Index the file based on its (inferred) format.
   iree_status_t status = iree_io_parse_file_index(path, file_handle, index);
@@ -146,6 +228,20 @@ iree_status_t iree_tooling_build_parameter_indices_from_flags(
   return iree_ok_status();
 }
 
+IREE_FLAG(
+    int64_t, parameter_residency_budget, 0,
+    "Maximum number of bytes of loaded parameters kept resident per scope.\n"
+    "When non-zero parameters loaded by programs are cached and the least\n"
+    "recently used unreferenced parameters are evicted when loading new\n"
+    "ones would exceed the budget. Useful for programs that load subsets of\n"
+    "their parameters on demand (such as mixture-of-experts weights).");
+
+IREE_FLAG(
+    bool, parameter_dedup, false,
+    "Shares loaded parameters with identical contents across all scopes.\n"
+    "Only parameters with content hashes (such as those in archives built\n"
+    "with `iree-convert-parameters --content_hashes`) are deduplicated.");
+
 iree_status_t iree_tooling_create_parameters_module_from_flags(
     iree_vm_instance_t* instance, iree_allocator_t host_allocator,
     iree_vm_module_t** out_module) {
@@ -158,6 +254,12 @@ iree_status_t iree_tooling_create_parameters_module_from_flags(
   iree_status_t status =
       iree_tooling_build_parameter_indices_from_flags(&scope_map);
 
+  // Create the cache shared by all scopes if deduplicating.
+  iree_io_parameter_dedup_cache_t* dedup_cache = NULL;
+  if (iree_status_is_ok(status) && FLAG_parameter_dedup) {
+    status = iree_io_parameter_dedup_cache_create(host_allocator, &dedup_cache);
+  }
+
   // Create one provider per scope.
   iree_host_size_t provider_count = 0;
   iree_io_parameter_provider_t** providers =
@@ -165,10 +267,18 @@ iree_status_t iree_tooling_create_parameters_module_from_flags(
           scope_map.count * sizeof(iree_io_parameter_provider_t*));
   if (iree_status_is_ok(status)) {
     for (iree_host_size_t i = 0; i < scope_map.count; ++i) {
-      status = iree_io_parameter_index_provider_create(
+      status = iree_io_parameter_index_provider_create_with_dedup_cache(
           scope_map.entries[i]->scope, scope_map.entries[i]->index,
           IREE_IO_PARAMETER_INDEX_PROVIDER_DEFAULT_MAX_CONCURRENT_OPERATIONS,
-          host_allocator, &providers[i]);
+          dedup_cache, host_allocator, &providers[i]);
+      if (iree_status_is_ok(status) && FLAG_parameter_residency_budget > 0) {
+        iree_io_parameter_provider_t* index_provider = providers[i];
+        status = iree_io_parameter_residency_provider_create(
+            index_provider,
+            (iree_device_size_t)FLAG_parameter_residency_budget,
+            host_allocator, &providers[i]);
+        iree_io_parameter_provider_release(index_provider);
+      }
       if (!iree_status_is_ok(status)) break;
       ++provider_count;
     }
@@ -184,6 +294,7 @@ iree_status_t iree_tooling_create_parameters_module_from_flags(
   for (iree_host_size_t i = 0; i < provider_count; ++i) {
     iree_io_parameter_provider_release(providers[i]);
   }
+  iree_io_parameter_dedup_cache_release(dedup_cache);
   iree_io_scope_map_deinitialize(&scope_map);
 
   IREE_TRACE_ZONE_END(z0);
@@ -89,7 +89,8 @@ IREE_FLAG(
     "the remainder.");
 
 IREE_FLAG(bool, print_statistics, false,
-          "Prints runtime statistics to stderr on exit.");
+          "Prints runtime statistics to stderr on exit along with the peak\n"
+          "memory allocated by the invocation.");
 
 static iree_status_t iree_tooling_process_results(
     iree_hal_device_t* device, iree_string_view_t results_cconv,
@@ -247,6 +248,21 @@ static iree_status_t iree_tooling_run_function(
                                     "beginning device profiling");
   }
 
+  // Start draining instrumentation data while the function runs if requested.
+  iree_tooling_instrument_drainer_t* instrument_drainer = NULL;
+  if (iree_status_is_ok(status)) {
+    status = iree_status_annotate_f(
+        iree_tooling_instrument_drainer_create_from_flags(
+            context, host_allocator, &instrument_drainer),
+        "starting instrument data drainer");
+  }
+
+  // Capture the memory allocated by the invocation.
+  iree_hal_allocator_capture_t allocator_capture;
+  if (iree_status_is_ok(status) && device_allocator && FLAG_print_statistics) {
+    iree_hal_allocator_begin_capture(device_allocator, &allocator_capture);
+  }
+
   // Invoke the function with the provided inputs.
   if (iree_status_is_ok(status)) {
     status = iree_status_annotate_f(
@@ -265,6 +281,14 @@ static iree_status_t iree_tooling_run_function(
   }
   iree_hal_fence_release(finish_fence);
 
+  // Report the peak memory used by the invocation on top of what was live
+  // before it (constants, inputs, etc).
+  if (iree_status_is_ok(status) && device_allocator && FLAG_print_statistics) {
+    iree_hal_allocator_end_capture(device_allocator, &allocator_capture);
+    IREE_IGNORE_ERROR(iree_hal_allocator_capture_fprint(
+        stderr, function_name, &allocator_capture, host_allocator));
+  }
+
   // End profiling after waiting for the invocation to finish.
   if (iree_status_is_ok(status)) {
     status = iree_status_annotate_f(iree_hal_end_profiling_from_flags(device),
@@ -272,11 +296,17 @@ static iree_status_t iree_tooling_run_function(
   }
 
   // Grab any instrumentation data present in the context and write it to disk.
-  if (iree_status_is_ok(status)) {
+  // When draining the remaining records are flushed after the final drain.
+  if (iree_status_is_ok(status) && instrument_drainer) {
+    status = iree_status_annotate_f(
+        iree_tooling_instrument_drainer_stop(instrument_drainer),
+        "draining instrument data");
+  } else if (iree_status_is_ok(status)) {
     status = iree_status_annotate_f(
         iree_tooling_process_instrument_data(context, host_allocator),
         "processing instrument data");
   }
+  iree_tooling_instrument_drainer_free(instrument_drainer);
 
   // Transfer outputs to the host so they can be processed. Only required when
   // using full HAL device-based execution.
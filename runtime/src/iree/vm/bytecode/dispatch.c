@@ -78,9 +78,8 @@ static inline iree_vm_registers_t iree_vm_bytecode_get_register_storage(
 }
 
 // Releases any remaining refs held in the frame storage.
+// Only registered for functions that use ref registers.
 static void iree_vm_bytecode_stack_frame_cleanup(iree_vm_stack_frame_t* frame) {
-  // TODO(benvanik): allow the VM to elide this when it's known that there are
-  // no more live registers.
   const iree_vm_bytecode_frame_storage_t* stack_storage =
       (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(frame);
   iree_vm_ref_t* refs = (iree_vm_ref_t*)((uintptr_t)stack_storage +
@@ -102,6 +101,8 @@ static iree_status_t iree_vm_bytecode_function_enter(
     return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
                             "import ordinal out of range");
   }
+  IREE_RETURN_IF_ERROR(iree_vm_bytecode_module_ensure_function_verified(
+      module, (uint16_t)function.ordinal));
   const iree_vm_FunctionDescriptor_t* target_descriptor =
       &module->function_descriptor_table[function.ordinal];
 
@@ -127,16 +128,21 @@ static iree_status_t iree_vm_bytecode_function_enter(
   iree_host_size_t frame_size =
       header_size + i32_register_size + ref_register_size;
 
-  // Enter function and allocate stack frame storage.
+  // Enter function and allocate stack frame storage. Functions that have no
+  // ref registers (common for scalar helpers and loop bodies) have nothing to
+  // release when the frame is left and skip the cleanup entirely.
   IREE_RETURN_IF_ERROR(iree_vm_stack_function_enter(
       stack, &function, IREE_VM_STACK_FRAME_BYTECODE, frame_size,
-      iree_vm_bytecode_stack_frame_cleanup, out_callee_frame));
+      ref_register_count ? iree_vm_bytecode_stack_frame_cleanup : NULL,
+      out_callee_frame));
 
   // Stash metadata and compute register pointers.
   iree_vm_bytecode_frame_storage_t* stack_storage =
       (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
           *out_callee_frame);
   stack_storage->cconv_results = cconv_results;
+  stack_storage->return_registers = NULL;
+  stack_storage->pending_import = NULL;
   stack_storage->i32_register_count = i32_register_count;
   stack_storage->i32_register_offset = header_size;
   stack_storage->ref_register_count = ref_register_count;
@@ -144,6 +150,14 @@ static iree_status_t iree_vm_bytecode_function_enter(
   *out_callee_registers =
       iree_vm_bytecode_get_register_storage(*out_callee_frame);
 
+  // The stack does not initialize frame storage. Ref registers must start out
+  // null as assigning to them releases the prior value. i32 registers are
+  // always written before they are read as the compiler allocates them from
+  // SSA values so they are left as-is; the cost of entering a frame then only
+  // scales with the ref registers the function uses.
+  memset(out_callee_registers->ref, 0,
+         ref_register_count * sizeof(iree_vm_ref_t));
+
   return iree_ok_status();
 }
 
@@ -440,39 +454,21 @@ static void iree_vm_bytecode_populate_import_cconv_arguments(
   }
 }
 
-// Issues a populated import call and marshals the results into |dst_reg_list|.
-static iree_status_t iree_vm_bytecode_issue_import_call(
-    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
-    iree_string_view_t cconv_results,
+// Marshals import call |results| into the |dst_reg_list| registers.
+static void iree_vm_bytecode_marshal_import_results(
+    iree_string_view_t cconv_results, iree_vm_bytecode_import_flags_t flags,
     const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
-    iree_vm_stack_frame_t* IREE_RESTRICT* out_caller_frame,
-    iree_vm_registers_t* out_caller_registers) {
-  // Call external function.
-  iree_status_t call_status =
-      call.function.module->begin_call(call.function.module->self, stack, call);
-  if (iree_status_is_deferred(call_status)) {
-    if (!iree_byte_span_is_empty(call.results)) {
-      iree_status_ignore(call_status);
-      return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
-                              "yield in imports with results not supported");
+    iree_byte_span_t results, iree_vm_registers_t caller_registers) {
+  if (flags & IREE_VM_BYTECODE_IMPORT_FLAG_I32_RESULTS) {
+    const int32_t* IREE_RESTRICT i32_results = (const int32_t*)results.data;
+    const iree_host_size_t result_count =
+        iree_min(cconv_results.size, dst_reg_list->size);
+    for (iree_host_size_t i = 0; i < result_count; ++i) {
+      caller_registers.i32[dst_reg_list->registers[i]] = i32_results[i];
     }
-    return call_status;  // deferred for future resume
-  } else if (IREE_UNLIKELY(!iree_status_is_ok(call_status))) {
-    // TODO(benvanik): set execution result to failure/capture stack.
-    return iree_status_annotate(call_status,
-                                iree_make_cstring_view("while calling import"));
+    return;
   }
-
-  // NOTE: we don't support yielding within imported functions right now so it's
-  // safe to assume the stack is still valid here. If the called function can
-  // yield then we'll need to requery all pointers here.
-  *out_caller_frame = iree_vm_stack_current_frame(stack);
-  *out_caller_registers =
-      iree_vm_bytecode_get_register_storage(*out_caller_frame);
-
-  // Marshal outputs from the ABI results buffer to registers.
-  iree_vm_registers_t caller_registers = *out_caller_registers;
-  uint8_t* IREE_RESTRICT p = call.results.data;
+  uint8_t* IREE_RESTRICT p = results.data;
   for (iree_host_size_t i = 0; i < cconv_results.size && i < dst_reg_list->size;
        ++i) {
     uint16_t dst_reg = dst_reg_list->registers[i];
@@ -497,7 +493,61 @@ static iree_status_t iree_vm_bytecode_issue_import_call(
         break;
     }
   }
+}
+
+// Issues a populated import call and marshals the results into |dst_reg_list|.
+//
+// If the callee yields the results are not yet available. Storage for them is
+// reserved on the caller frame and passed to the callee when it is resumed and
+// the caller frame records the pending import so that the results can be
+// marshaled into |dst_reg_list| when it is itself resumed.
+static iree_status_t iree_vm_bytecode_issue_import_call(
+    iree_vm_stack_t* stack, const iree_vm_function_call_t call,
+    const iree_vm_bytecode_import_t* import,
+    const iree_vm_register_list_t* IREE_RESTRICT dst_reg_list,
+    iree_vm_stack_frame_t* IREE_RESTRICT* out_caller_frame,
+    iree_vm_registers_t* out_caller_registers) {
+  // The caller frame pointer may be invalidated by stack growth during the call
+  // so we track it by depth.
+  const int32_t caller_depth = iree_vm_stack_current_frame(stack)->depth;
+
+  // Call external function.
+  iree_status_t call_status =
+      call.function.module->begin_call(call.function.module->self, stack, call);
+  if (iree_status_is_deferred(call_status)) {
+    if (!iree_byte_span_is_empty(call.results)) {
+      iree_vm_stack_frame_t* caller_frame =
+          iree_vm_stack_frame_at_depth(stack, caller_depth);
+      iree_byte_span_t yield_results = iree_byte_span_empty();
+      iree_status_t status = iree_vm_stack_frame_reserve_yield_results(
+          stack, caller_frame, call.results.data_length, &yield_results);
+      if (!iree_status_is_ok(status)) {
+        iree_status_ignore(call_status);
+        return status;
+      }
+      iree_vm_bytecode_frame_storage_t* caller_storage =
+          (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
+              caller_frame);
+      caller_storage->return_registers = dst_reg_list;
+      caller_storage->pending_import = import;
+    }
+    return call_status;  // deferred for future resume
+  } else if (IREE_UNLIKELY(!iree_status_is_ok(call_status))) {
+    // TODO(benvanik): set execution result to failure/capture stack.
+    return iree_status_annotate(call_status,
+                                iree_make_cstring_view("while calling import"));
+  }
+
+  // The call completed without yielding but the stack may have grown during it
+  // so all frame pointers must be requeried.
+  *out_caller_frame = iree_vm_stack_current_frame(stack);
+  *out_caller_registers =
+      iree_vm_bytecode_get_register_storage(*out_caller_frame);
 
+  // Marshal outputs from the ABI results buffer to registers.
+  iree_vm_bytecode_marshal_import_results(import->results, import->flags,
+                                          dst_reg_list, call.results,
+                                          *out_caller_registers);
   return iree_ok_status();
 }
 
@@ -556,17 +606,25 @@ static iree_status_t iree_vm_bytecode_call_import(
   // Marshal inputs from registers to the ABI arguments buffer.
   call.arguments.data_length = import->argument_buffer_size;
   call.arguments.data = iree_alloca(call.arguments.data_length);
-  memset(call.arguments.data, 0, call.arguments.data_length);
-  iree_vm_bytecode_populate_import_cconv_arguments(
-      import->arguments, caller_registers,
-      /*segment_size_list=*/NULL, src_reg_list, call.arguments);
+  if (import->flags & IREE_VM_BYTECODE_IMPORT_FLAG_I32_ARGUMENTS) {
+    // Every byte of the buffer is written so there's no need to clear it.
+    int32_t* IREE_RESTRICT arguments = (int32_t*)call.arguments.data;
+    for (iree_host_size_t i = 0; i < import->arguments.size; ++i) {
+      arguments[i] = caller_registers.i32[src_reg_list->registers[i]];
+    }
+  } else {
+    memset(call.arguments.data, 0, call.arguments.data_length);
+    iree_vm_bytecode_populate_import_cconv_arguments(
+        import->arguments, caller_registers,
+        /*segment_size_list=*/NULL, src_reg_list, call.arguments);
+  }
 
   // Issue the call and handle results.
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
+  return iree_vm_bytecode_issue_import_call(stack, call, import, dst_reg_list,
+                                            out_caller_frame,
                                             out_caller_registers);
 }
 
@@ -606,8 +664,8 @@ static iree_status_t iree_vm_bytecode_call_import_variadic(
   call.results.data_length = import->result_buffer_size;
   call.results.data = iree_alloca(call.results.data_length);
   memset(call.results.data, 0, call.results.data_length);
-  return iree_vm_bytecode_issue_import_call(stack, call, import->results,
-                                            dst_reg_list, out_caller_frame,
+  return iree_vm_bytecode_issue_import_call(stack, call, import, dst_reg_list,
+                                            out_caller_frame,
                                             out_caller_registers);
 }
 
@@ -652,6 +710,22 @@ iree_status_t iree_vm_bytecode_dispatch_resume(
   }
   iree_vm_registers_t regs =
       iree_vm_bytecode_get_register_storage(current_frame);
+
+  // If the frame yielded in an import call the callee has since completed and
+  // written its results to the storage we reserved for it. Marshal them into
+  // the destination registers and continue after the call.
+  iree_vm_bytecode_frame_storage_t* stack_storage =
+      (iree_vm_bytecode_frame_storage_t*)iree_vm_stack_frame_storage(
+          current_frame);
+  if (stack_storage->pending_import) {
+    const iree_vm_bytecode_import_t* import = stack_storage->pending_import;
+    stack_storage->pending_import = NULL;
+    iree_vm_bytecode_marshal_import_results(
+        import->results, import->flags, stack_storage->return_registers,
+        iree_vm_stack_frame_yield_results(stack, current_frame), regs);
+    iree_vm_stack_frame_release_yield_results(stack, current_frame);
+  }
+
   // TODO(benvanik): assert the module is at the top of the frame? We should
   // only be coming in from a call based on the current frame.
   return iree_vm_bytecode_dispatch(stack, module, current_frame, regs,
@@ -985,201 +1059,48 @@ static iree_status_t iree_vm_bytecode_dispatch(
                                              rhs_offset, length, result));
     });
 
-    // TODO(benvanik): rework dispatch so that the FillI* ops can share the same
-    // body - they all only vary by the length passed to fill_elements. The
-    // gotcha is that on big-endian machines we'd have to flip around the bytes.
+    // The FillI* ops share their decoding and only vary by the element type.
+    // TODO(benvanik): share a single handler once the encoding carries the
+    // element width. The gotcha is that on big-endian machines we'd have to
+    // flip around the bytes.
     // See VMOpcodesCore.td for more information on the encoding.
-    DISPATCH_OP(CORE, BufferFillI8, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-      iree_host_size_t length = VM_DecOperandRegI64HostSize("length");
-      uint8_t value = (uint8_t)VM_DecOperandRegI32("value");
-      vm_buffer_fill_i8_inline(buffer, offset, length, value);
-    });
-    DISPATCH_OP(CORE, BufferFillI16, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-      iree_host_size_t length = VM_DecOperandRegI64HostSize("length");
-      uint16_t value = (uint16_t)VM_DecOperandRegI32("value");
-      vm_buffer_fill_i16_inline(buffer, offset, length, value);
-    });
-    DISPATCH_OP(CORE, BufferFillI32, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-      iree_host_size_t length = VM_DecOperandRegI64HostSize("length");
-      uint32_t value = VM_DecOperandRegI32("value");
-      vm_buffer_fill_i32_inline(buffer, offset, length, value);
-    });
-    DISPATCH_OP(CORE, BufferFillI64, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT, "buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-      iree_host_size_t length = VM_DecOperandRegI64HostSize("length");
-      uint64_t value = VM_DecOperandRegI64("value");
-      vm_buffer_fill_i64_inline(buffer, offset, length, value);
-    });
-
-    // TODO(benvanik): rework dispatch so that the LoadI* ops can share the same
-    // body - they only vary on the length and sign/zero extension mode but
-    // can be packed into a single handler to reduce code-size.
+    DISPATCH_OP_BUFFER_FILL(CORE, BufferFillI8, uint8_t, VM_DecOperandRegI32,
+                            vm_buffer_fill_i8_inline);
+    DISPATCH_OP_BUFFER_FILL(CORE, BufferFillI16, uint16_t, VM_DecOperandRegI32,
+                            vm_buffer_fill_i16_inline);
+    DISPATCH_OP_BUFFER_FILL(CORE, BufferFillI32, uint32_t, VM_DecOperandRegI32,
+                            vm_buffer_fill_i32_inline);
+    DISPATCH_OP_BUFFER_FILL(CORE, BufferFillI64, uint64_t, VM_DecOperandRegI64,
+                            vm_buffer_fill_i64_inline);
+
+    // The LoadI* ops share their decoding and only vary on the length and
+    // sign/zero extension mode.
+    // TODO(benvanik): pack into a single handler to reduce code-size.
     // See VMOpcodesCore.td for more information on the encoding.
-    DISPATCH_OP(CORE, BufferLoadI8U, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("source_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "source_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");
-      int32_t* result = VM_DecResultRegI32("result");
-      vm_buffer_load_i8u_inline(buffer, offset, result);
-    });
-    DISPATCH_OP(CORE, BufferLoadI8S, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("source_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "source_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");
-      int32_t* result = VM_DecResultRegI32("result");
-      vm_buffer_load_i8s_inline(buffer, offset, result);
-    });
-    DISPATCH_OP(CORE, BufferLoadI16U, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("source_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "source_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");
-      int32_t* result = VM_DecResultRegI32("result");
-      vm_buffer_load_i16u_inline(buffer, offset, result);
-    });
-    DISPATCH_OP(CORE, BufferLoadI16S, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("source_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "source_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");
-      int32_t* result = VM_DecResultRegI32("result");
-      vm_buffer_load_i16s_inline(buffer, offset, result);
-    });
-    DISPATCH_OP(CORE, BufferLoadI32, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("source_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "source_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");
-      int32_t* result = VM_DecResultRegI32("result");
-      vm_buffer_load_i32_inline(buffer, offset, result);
-    });
-    DISPATCH_OP(CORE, BufferLoadI64, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("source_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "source_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");
-      int64_t* result = VM_DecResultRegI64("result");
-      vm_buffer_load_i64_inline(buffer, offset, result);
-    });
-
-    // TODO(benvanik): rework dispatch so that the StoreI* ops can share the
-    // same body - they only vary on the length.
+    DISPATCH_OP_BUFFER_LOAD(CORE, BufferLoadI8U, int32_t, VM_DecResultRegI32,
+                            vm_buffer_load_i8u_inline);
+    DISPATCH_OP_BUFFER_LOAD(CORE, BufferLoadI8S, int32_t, VM_DecResultRegI32,
+                            vm_buffer_load_i8s_inline);
+    DISPATCH_OP_BUFFER_LOAD(CORE, BufferLoadI16U, int32_t, VM_DecResultRegI32,
+                            vm_buffer_load_i16u_inline);
+    DISPATCH_OP_BUFFER_LOAD(CORE, BufferLoadI16S, int32_t, VM_DecResultRegI32,
+                            vm_buffer_load_i16s_inline);
+    DISPATCH_OP_BUFFER_LOAD(CORE, BufferLoadI32, int32_t, VM_DecResultRegI32,
+                            vm_buffer_load_i32_inline);
+    DISPATCH_OP_BUFFER_LOAD(CORE, BufferLoadI64, int64_t, VM_DecResultRegI64,
+                            vm_buffer_load_i64_inline);
+
+    // The StoreI* ops share their decoding and only vary on the length.
+    // TODO(benvanik): pack into a single handler to reduce code-size.
     // See VMOpcodesCore.td for more information on the encoding.
-    DISPATCH_OP(CORE, BufferStoreI8, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "target_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-      uint8_t value = (uint8_t)VM_DecOperandRegI32("value");
-      vm_buffer_store_i8_inline(buffer, offset, value);
-    });
-    DISPATCH_OP(CORE, BufferStoreI16, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "target_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-      uint16_t value = (uint16_t)VM_DecOperandRegI32("value");
-      vm_buffer_store_i16_inline(buffer, offset, value);
-    });
-    DISPATCH_OP(CORE, BufferStoreI32, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "target_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-      uint32_t value = VM_DecOperandRegI32("value");
-      vm_buffer_store_i32_inline(buffer, offset, value);
-    });
-    DISPATCH_OP(CORE, BufferStoreI64, {
-      bool buffer_is_move;
-      iree_vm_ref_t* buffer_ref =
-          VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-      iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-      if (IREE_UNLIKELY(!buffer)) {
-        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                "target_buffer is null");
-      }
-      iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-      uint64_t value = (uint64_t)VM_DecOperandRegI64("value");
-      vm_buffer_store_i64_inline(buffer, offset, value);
-    });
+    DISPATCH_OP_BUFFER_STORE(CORE, BufferStoreI8, uint8_t, VM_DecOperandRegI32,
+                             vm_buffer_store_i8_inline);
+    DISPATCH_OP_BUFFER_STORE(CORE, BufferStoreI16, uint16_t,
+                             VM_DecOperandRegI32, vm_buffer_store_i16_inline);
+    DISPATCH_OP_BUFFER_STORE(CORE, BufferStoreI32, uint32_t,
+                             VM_DecOperandRegI32, vm_buffer_store_i32_inline);
+    DISPATCH_OP_BUFFER_STORE(CORE, BufferStoreI64, uint64_t,
+                             VM_DecOperandRegI64, vm_buffer_store_i64_inline);
 
     DISPATCH_OP(CORE, BufferHash, {
       bool source_buffer_is_move;
@@ -2112,48 +2033,14 @@ static iree_status_t iree_vm_bytecode_dispatch(
       // ExtF32: Buffers
       //===----------------------------------------------------------------===//
 
-      DISPATCH_OP(EXT_F32, BufferFillF32, {
-        bool buffer_is_move;
-        iree_vm_ref_t* buffer_ref =
-            VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-        iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-        if (IREE_UNLIKELY(!buffer)) {
-          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                  "buffer is null");
-        }
-        iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-        iree_host_size_t length = VM_DecOperandRegI64HostSize("length");
-        float value = VM_DecOperandRegF32("value");
-        IREE_RETURN_IF_ERROR(vm_buffer_fill_f32(buffer, offset, length, value));
-      });
+      DISPATCH_OP_BUFFER_FILL(EXT_F32, BufferFillF32, float,
+                              VM_DecOperandRegF32, vm_buffer_fill_f32_inline);
 
-      DISPATCH_OP(EXT_F32, BufferLoadF32, {
-        bool buffer_is_move;
-        iree_vm_ref_t* buffer_ref =
-            VM_DecOperandRegRef("source_buffer", &buffer_is_move);
-        iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-        if (IREE_UNLIKELY(!buffer)) {
-          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                  "source_buffer is null");
-        }
-        iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");
-        float* result = VM_DecResultRegF32("result");
-        vm_buffer_load_f32_inline(buffer, offset, result);
-      });
+      DISPATCH_OP_BUFFER_LOAD(EXT_F32, BufferLoadF32, float, VM_DecResultRegF32,
+                              vm_buffer_load_f32_inline);
 
-      DISPATCH_OP(EXT_F32, BufferStoreF32, {
-        bool buffer_is_move;
-        iree_vm_ref_t* buffer_ref =
-            VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-        iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-        if (IREE_UNLIKELY(!buffer)) {
-          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                  "target_buffer is null");
-        }
-        iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-        float value = VM_DecOperandRegF32("value");
-        vm_buffer_store_f32_inline(buffer, offset, value);
-      });
+      DISPATCH_OP_BUFFER_STORE(EXT_F32, BufferStoreF32, float,
+                               VM_DecOperandRegF32, vm_buffer_store_f32_inline);
     }
     END_DISPATCH_PREFIX();
 #else
@@ -2417,48 +2304,14 @@ static iree_status_t iree_vm_bytecode_dispatch(
       // ExtF64: Buffers
       //===----------------------------------------------------------------===//
 
-      DISPATCH_OP(EXT_F64, BufferFillF64, {
-        bool buffer_is_move;
-        iree_vm_ref_t* buffer_ref =
-            VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-        iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-        if (IREE_UNLIKELY(!buffer)) {
-          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                  "buffer is null");
-        }
-        iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-        iree_host_size_t length = VM_DecOperandRegI64HostSize("length");
-        double value = VM_DecOperandRegF64("value");
-        IREE_RETURN_IF_ERROR(vm_buffer_fill_f64(buffer, offset, length, value));
-      });
+      DISPATCH_OP_BUFFER_FILL(EXT_F64, BufferFillF64, double,
+                              VM_DecOperandRegF64, vm_buffer_fill_f64_inline);
 
-      DISPATCH_OP(EXT_F64, BufferLoadF64, {
-        bool buffer_is_move;
-        iree_vm_ref_t* buffer_ref =
-            VM_DecOperandRegRef("source_buffer", &buffer_is_move);
-        iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-        if (IREE_UNLIKELY(!buffer)) {
-          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                  "source_buffer is null");
-        }
-        iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");
-        double* result = VM_DecResultRegF64("result");
-        vm_buffer_load_f64_inline(buffer, offset, result);
-      });
+      DISPATCH_OP_BUFFER_LOAD(EXT_F64, BufferLoadF64, double,
+                              VM_DecResultRegF64, vm_buffer_load_f64_inline);
 
-      DISPATCH_OP(EXT_F64, BufferStoreF64, {
-        bool buffer_is_move;
-        iree_vm_ref_t* buffer_ref =
-            VM_DecOperandRegRef("target_buffer", &buffer_is_move);
-        iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);
-        if (IREE_UNLIKELY(!buffer)) {
-          return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
-                                  "target_buffer is null");
-        }
-        iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");
-        double value = VM_DecOperandRegF64("value");
-        vm_buffer_store_f64_inline(buffer, offset, value);
-      });
+      DISPATCH_OP_BUFFER_STORE(EXT_F64, BufferStoreF64, double,
+                               VM_DecOperandRegF64, vm_buffer_store_f64_inline);
     }
     END_DISPATCH_PREFIX();
 #else
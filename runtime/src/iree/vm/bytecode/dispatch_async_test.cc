@@ -24,6 +24,57 @@ namespace {
 
 using iree::testing::status::StatusIs;
 
+// yieldable_test.yield_add(i32, i32) -> i32
+// Yields on an immediate wait before returning the sum of its arguments. The
+// pending result is stashed in the frame pc as native frames have no storage.
+static iree_status_t YieldableTestYieldAdd(
+    iree_vm_stack_t* stack, iree_vm_native_function_flags_t flags,
+    iree_byte_span_t args_storage, iree_byte_span_t rets_storage,
+    iree_vm_native_function_target_t target_fn, void* module,
+    void* module_state) {
+  iree_vm_stack_frame_t* current_frame = iree_vm_stack_top(stack);
+  if (!(flags & IREE_VM_NATIVE_FUNCTION_CALL_RESUME)) {
+    const int32_t* args = reinterpret_cast<const int32_t*>(args_storage.data);
+    current_frame->pc = args[0] + args[1];
+    iree_vm_wait_frame_t* wait_frame = nullptr;
+    IREE_RETURN_IF_ERROR(iree_vm_stack_wait_enter(
+        stack, IREE_VM_WAIT_UNTIL, /*wait_count=*/0, iree_immediate_timeout(),
+        /*trace_zone=*/0, &wait_frame));
+    return iree_status_from_code(IREE_STATUS_DEFERRED);
+  }
+  iree_vm_wait_result_t wait_result;
+  IREE_RETURN_IF_ERROR(iree_vm_stack_wait_leave(stack, &wait_result));
+  IREE_RETURN_IF_ERROR(wait_result.status);
+  if (rets_storage.data_length != sizeof(int32_t)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "result storage mismatch on resume");
+  }
+  *reinterpret_cast<int32_t*>(rets_storage.data) =
+      static_cast<int32_t>(current_frame->pc);
+  return iree_ok_status();
+}
+
+static const iree_vm_native_export_descriptor_t yieldable_test_exports_[] = {
+    {IREE_SV("yield_add"), IREE_SV("0ii_i"), 0, NULL},
+};
+static const iree_vm_native_function_ptr_t yieldable_test_funcs_[] = {
+    {(iree_vm_native_function_shim_t)YieldableTestYieldAdd, NULL},
+};
+static const iree_vm_native_module_descriptor_t yieldable_test_descriptor_ = {
+    /*name=*/IREE_SV("yieldable_test"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(yieldable_test_exports_),
+    /*exports=*/yieldable_test_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(yieldable_test_funcs_),
+    /*functions=*/yieldable_test_funcs_,
+};
+
 class VMBytecodeDispatchAsyncTest : public ::testing::Test {
  protected:
   void SetUp() override {
@@ -33,13 +84,20 @@ class VMBytecodeDispatchAsyncTest : public ::testing::Test {
     IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
                                           iree_allocator_system(), &instance_));
 
+    iree_vm_module_t interface;
+    IREE_CHECK_OK(iree_vm_module_initialize(&interface, NULL));
+    IREE_CHECK_OK(iree_vm_native_module_create(
+        &interface, &yieldable_test_descriptor_, instance_,
+        iree_allocator_system(), &native_module_));
+
     IREE_CHECK_OK(iree_vm_bytecode_module_create(
         instance_,
         iree_const_byte_span_t{reinterpret_cast<const uint8_t*>(file->data),
                                static_cast<iree_host_size_t>(file->size)},
         iree_allocator_null(), iree_allocator_system(), &bytecode_module_));
 
-    std::vector<iree_vm_module_t*> modules = {bytecode_module_};
+    std::vector<iree_vm_module_t*> modules = {native_module_,
+                                              bytecode_module_};
     IREE_CHECK_OK(iree_vm_context_create_with_modules(
         instance_, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
         iree_allocator_system(), &context_));
@@ -48,12 +106,14 @@ class VMBytecodeDispatchAsyncTest : public ::testing::Test {
   void TearDown() override {
     IREE_TRACE_SCOPE();
     iree_vm_module_release(bytecode_module_);
+    iree_vm_module_release(native_module_);
     iree_vm_context_release(context_);
     iree_vm_instance_release(instance_);
   }
 
   iree_vm_instance_t* instance_ = nullptr;
   iree_vm_context_t* context_ = nullptr;
+  iree_vm_module_t* native_module_ = nullptr;
   iree_vm_module_t* bytecode_module_ = nullptr;
 };
 
@@ -153,5 +213,42 @@ TEST_F(VMBytecodeDispatchAsyncTest, YieldDivergent) {
   iree_vm_stack_deinitialize(stack);
 }
 
+// Tests a bytecode function calling an import that yields before returning its
+// result. The invocation resumes the import with storage reserved by the
+// bytecode frame and the bytecode frame then picks up the result.
+// See iree/vm/test/async_ops.mlir > @call_yieldable_import
+TEST_F(VMBytecodeDispatchAsyncTest, YieldInImportWithResults) {
+  IREE_TRACE_SCOPE();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      bytecode_module_, IREE_VM_FUNCTION_LINKAGE_EXPORT,
+      IREE_SV("call_yieldable_import"), &function));
+
+  iree_vm_type_def_t i32_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* inputs = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(i32_type, 1, iree_allocator_system(), &inputs));
+  iree_vm_value_t arg_value = iree_vm_value_make_i32(97);
+  IREE_ASSERT_OK(iree_vm_list_push_value(inputs, &arg_value));
+  iree_vm_list_t* outputs = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(i32_type, 1, iree_allocator_system(), &outputs));
+
+  // The synchronous invoke waits on and resumes the yielded import inline.
+  IREE_ASSERT_OK(iree_vm_invoke(context_, function,
+                                IREE_VM_INVOCATION_FLAG_NONE,
+                                /*policy=*/nullptr, inputs, outputs,
+                                iree_allocator_system()));
+
+  iree_vm_value_t ret_value;
+  IREE_ASSERT_OK(iree_vm_list_get_value(outputs, 0, &ret_value));
+  EXPECT_EQ(ret_value.i32, 97 + 5 + 1);
+
+  iree_vm_list_release(inputs);
+  iree_vm_list_release(outputs);
+}
+
 }  // namespace
 }  // namespace iree
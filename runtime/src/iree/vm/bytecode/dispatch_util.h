@@ -78,6 +78,11 @@ typedef struct iree_vm_bytecode_frame_storage_t {
   // will be stored by callees upon return.
   const iree_vm_register_list_t* return_registers;
 
+  // Import called by this frame that yielded before returning or NULL if none.
+  // The import results are stored in the stack yield results storage of this
+  // frame and marshaled into |return_registers| when the frame resumes.
+  const iree_vm_bytecode_import_t* pending_import;
+
   // Counts of each register type and their relative byte offsets from the head
   // of this struct.
   uint32_t i32_register_count;
@@ -398,6 +403,58 @@ static inline const iree_vm_register_list_t* VM_DecVariadicOperandsImpl(
     *result = op_func(a, b, c);                        \
   });
 
+// Buffer element access ops only vary by the element type and the inline
+// access helper used. Sharing the decoding keeps the handlers consistent with
+// the VM_Enc* order of the tablegen definitions.
+#define DISPATCH_OP_BUFFER_FILL(ext, op_name, value_type, value_decoder,     \
+                                fill_func)                                   \
+  DISPATCH_OP(ext, op_name, {                                                \
+    bool buffer_is_move;                                                     \
+    iree_vm_ref_t* buffer_ref =                                              \
+        VM_DecOperandRegRef("target_buffer", &buffer_is_move);               \
+    iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);            \
+    if (IREE_UNLIKELY(!buffer)) {                                            \
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,                  \
+                              "buffer is null");                             \
+    }                                                                        \
+    iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");  \
+    iree_host_size_t length = VM_DecOperandRegI64HostSize("length");         \
+    value_type value = (value_type)value_decoder("value");                   \
+    fill_func(buffer, offset, length, value);                                \
+  });
+
+#define DISPATCH_OP_BUFFER_LOAD(ext, op_name, result_type, result_decoder,   \
+                                load_func)                                   \
+  DISPATCH_OP(ext, op_name, {                                                \
+    bool buffer_is_move;                                                     \
+    iree_vm_ref_t* buffer_ref =                                              \
+        VM_DecOperandRegRef("source_buffer", &buffer_is_move);               \
+    iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);            \
+    if (IREE_UNLIKELY(!buffer)) {                                            \
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,                  \
+                              "source_buffer is null");                      \
+    }                                                                        \
+    iree_host_size_t offset = VM_DecOperandRegI64HostSize("source_offset");  \
+    result_type* result = result_decoder("result");                          \
+    load_func(buffer, offset, result);                                       \
+  });
+
+#define DISPATCH_OP_BUFFER_STORE(ext, op_name, value_type, value_decoder,    \
+                                 store_func)                                 \
+  DISPATCH_OP(ext, op_name, {                                                \
+    bool buffer_is_move;                                                     \
+    iree_vm_ref_t* buffer_ref =                                              \
+        VM_DecOperandRegRef("target_buffer", &buffer_is_move);               \
+    iree_vm_buffer_t* buffer = iree_vm_buffer_deref(*buffer_ref);            \
+    if (IREE_UNLIKELY(!buffer)) {                                            \
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,                  \
+                              "target_buffer is null");                      \
+    }                                                                        \
+    iree_host_size_t offset = VM_DecOperandRegI64HostSize("target_offset");  \
+    value_type value = (value_type)value_decoder("value");                   \
+    store_func(buffer, offset, value);                                       \
+  });
+
 #define DISPATCH_OP_EXT_F32_UNARY_F32(op_name, op_func) \
   DISPATCH_OP(EXT_F32, op_name, {                       \
     float operand = VM_DecOperandRegF32("operand");     \
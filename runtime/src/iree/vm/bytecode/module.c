@@ -750,6 +750,21 @@ static iree_status_t IREE_API_PTR iree_vm_bytecode_module_fork_state(
   return iree_ok_status();
 }
 
+// Returns true if |cconv_fragment| contains only 32-bit primitive values.
+static bool iree_vm_bytecode_cconv_fragment_is_i32(
+    iree_string_view_t cconv_fragment) {
+  for (iree_host_size_t i = 0; i < cconv_fragment.size; ++i) {
+    switch (cconv_fragment.data[i]) {
+      case IREE_VM_CCONV_TYPE_I32:
+      case IREE_VM_CCONV_TYPE_F32:
+        break;
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
 static iree_status_t iree_vm_bytecode_module_resolve_import(
     void* self, iree_vm_module_state_t* module_state, iree_host_size_t ordinal,
     const iree_vm_function_t* function,
@@ -792,6 +807,17 @@ static iree_status_t iree_vm_bytecode_module_resolve_import(
   import->argument_buffer_size = (uint16_t)argument_buffer_size;
   import->result_buffer_size = (uint16_t)result_buffer_size;
 
+  // Select specialized marshalers for the common case of imports that only
+  // take/return 32-bit primitives so that calls can skip per-value type
+  // dispatch.
+  import->flags = IREE_VM_BYTECODE_IMPORT_FLAG_NONE;
+  if (iree_vm_bytecode_cconv_fragment_is_i32(import->arguments)) {
+    import->flags |= IREE_VM_BYTECODE_IMPORT_FLAG_I32_ARGUMENTS;
+  }
+  if (iree_vm_bytecode_cconv_fragment_is_i32(import->results)) {
+    import->flags |= IREE_VM_BYTECODE_IMPORT_FLAG_I32_RESULTS;
+  }
+
   return iree_ok_status();
 }
 
@@ -853,14 +879,90 @@ static iree_status_t iree_vm_bytecode_module_resume_call(
   return iree_vm_bytecode_dispatch_resume(stack, module, call_results);  // tail
 }
 
+IREE_API_EXPORT void iree_vm_bytecode_module_options_initialize(
+    iree_vm_bytecode_module_options_t* out_options) {
+  IREE_ASSERT_ARGUMENT(out_options);
+  memset(out_options, 0, sizeof(*out_options));
+}
+
+IREE_API_EXPORT uint64_t iree_vm_bytecode_module_compute_digest(
+    iree_const_byte_span_t archive_contents) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  // FNV-1a over little-endian 64-bit words with a final avalanche so that the
+  // digest is stable across hosts. Word-at-a-time keeps this bandwidth bound
+  // on large archives.
+  const uint64_t prime = 0x100000001B3ull;
+  uint64_t digest = 0xCBF29CE484222325ull ^ archive_contents.data_length;
+  const uint8_t* p = archive_contents.data;
+  iree_host_size_t remaining = archive_contents.data_length;
+  for (; remaining >= sizeof(uint64_t); remaining -= sizeof(uint64_t)) {
+    digest = (digest ^ iree_unaligned_load_le_u64((const uint64_t*)p)) * prime;
+    digest ^= digest >> 29;
+    p += sizeof(uint64_t);
+  }
+  for (; remaining > 0; --remaining) {
+    digest = (digest ^ *p++) * prime;
+  }
+  digest ^= digest >> 33;
+  digest *= 0xFF51AFD7ED558CCDull;
+  digest ^= digest >> 33;
+  IREE_TRACE_ZONE_END(z0);
+  return digest;
+}
+
+iree_status_t iree_vm_bytecode_module_verify_function_lazy(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_TRACE_ZONE_APPEND_VALUE_I64(z0, function_ordinal);
+  // Verification has no side effects on the module so if multiple threads race
+  // to verify the same function they will all produce the same result.
+  iree_status_t status = iree_vm_bytecode_function_verify(
+      module, function_ordinal, module->allocator);
+  if (iree_status_is_ok(status)) {
+    iree_atomic_fetch_or(&module->lazy_verified_bits[function_ordinal / 32],
+                         1 << (function_ordinal % 32),
+                         iree_memory_order_release);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module) {
+  iree_vm_bytecode_module_options_t options;
+  iree_vm_bytecode_module_options_initialize(&options);
+  return iree_vm_bytecode_module_create_with_options(
+      instance, &options, archive_contents, archive_allocator, allocator,
+      out_module);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_options(
+    iree_vm_instance_t* instance,
+    const iree_vm_bytecode_module_options_t* options,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module) {
   IREE_TRACE_ZONE_BEGIN(z0);
+  IREE_ASSERT_ARGUMENT(options);
   IREE_ASSERT_ARGUMENT(out_module);
   *out_module = NULL;
 
+  // Trusted archives may carry a digest to guard against loading the wrong
+  // file; this is checked before anything else reads the contents.
+  const bool is_trusted =
+      iree_all_bits_set(options->flags, IREE_VM_BYTECODE_MODULE_FLAG_TRUSTED);
+  if (is_trusted && options->trusted_digest != 0) {
+    uint64_t digest = iree_vm_bytecode_module_compute_digest(archive_contents);
+    if (digest != options->trusted_digest) {
+      IREE_TRACE_ZONE_END(z0);
+      return iree_make_status(IREE_STATUS_DATA_LOSS,
+                              "trusted module digest mismatch; expected "
+                              "%016" PRIx64 " but archive has %016" PRIx64,
+                              options->trusted_digest, digest);
+    }
+  }
+
   // Parse and verify the archive header to locate the FlatBuffer.
   iree_const_byte_span_t flatbuffer_contents = iree_const_byte_span_empty();
   iree_host_size_t archive_rodata_offset = 0;
@@ -897,18 +999,42 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
   size_t rodata_ref_table_size =
       iree_host_align(rodata_ref_count * sizeof(iree_vm_buffer_t), 16);
 
+  iree_vm_FunctionDescriptor_vec_t function_descriptors =
+      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
+  iree_host_size_t function_descriptor_count =
+      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+
+  // Functions are either verified here, on first use, or never when trusted.
+  bool verify_eagerly = false;
+  bool verify_lazily = false;
+#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  if (!is_trusted) {
+    if (iree_all_bits_set(options->flags,
+                          IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION)) {
+      verify_lazily = true;
+    } else {
+      verify_eagerly = true;
+    }
+  }
+#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
+  size_t lazy_verified_bits_size = 0;
+  if (verify_lazily) {
+    iree_host_size_t word_count =
+        iree_host_size_ceil_div(function_descriptor_count, 32);
+    lazy_verified_bits_size =
+        iree_host_align(word_count * sizeof(iree_atomic_int32_t), 16);
+  }
+
   iree_vm_bytecode_module_t* module = NULL;
   IREE_RETURN_AND_END_ZONE_IF_ERROR(
-      z0,
-      iree_allocator_malloc(
-          allocator, sizeof(*module) + type_table_size + rodata_ref_table_size,
-          (void**)&module));
+      z0, iree_allocator_malloc(allocator,
+                                sizeof(*module) + type_table_size +
+                                    rodata_ref_table_size +
+                                    lazy_verified_bits_size,
+                                (void**)&module));
   module->allocator = allocator;
 
-  iree_vm_FunctionDescriptor_vec_t function_descriptors =
-      iree_vm_BytecodeModuleDef_function_descriptors(module_def);
-  module->function_descriptor_count =
-      iree_vm_FunctionDescriptor_vec_len(function_descriptors);
+  module->function_descriptor_count = function_descriptor_count;
   module->function_descriptor_table = function_descriptors;
 
   flatbuffers_uint8_vec_t bytecode_data =
@@ -981,17 +1107,26 @@ IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
                               iree_allocator_null(), ref);
   }
 
+  // Lazily verified functions are tracked in a bitmap following the tables.
+  module->lazy_verified_bits = NULL;
+  if (verify_lazily) {
+    module->lazy_verified_bits =
+        (iree_atomic_int32_t*)((uint8_t*)module->rodata_ref_table +
+                               rodata_ref_table_size);
+    memset(module->lazy_verified_bits, 0, lazy_verified_bits_size);
+  }
+
   // Verify functions in the module now that we've verified the metadata that we
   // need to do so.
   iree_status_t verify_status = iree_ok_status();
-#if IREE_VM_BYTECODE_VERIFICATION_ENABLE
-  for (uint16_t i = 0; i < module->function_descriptor_count; ++i) {
-    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
-    verify_status = iree_vm_bytecode_function_verify(module, i, allocator);
-    IREE_TRACE_ZONE_END(z1);
-    if (!iree_status_is_ok(verify_status)) break;
+  if (verify_eagerly) {
+    for (uint16_t i = 0; i < module->function_descriptor_count; ++i) {
+      IREE_TRACE_ZONE_BEGIN_NAMED(z1, "iree_vm_bytecode_function_verify");
+      verify_status = iree_vm_bytecode_function_verify(module, i, allocator);
+      IREE_TRACE_ZONE_END(z1);
+      if (!iree_status_is_ok(verify_status)) break;
+    }
   }
-#endif  // IREE_VM_BYTECODE_VERIFICATION_ENABLE
   if (iree_status_is_ok(verify_status)) {
     *out_module = &module->interface;
   } else {
@@ -14,15 +14,69 @@
 extern "C" {
 #endif  // __cplusplus
 
+// Controls how a bytecode module is verified when it is loaded.
+enum iree_vm_bytecode_module_flag_bits_t {
+  IREE_VM_BYTECODE_MODULE_FLAG_NONE = 0u,
+  // Defers bytecode verification of each function until it is first called.
+  // Modules with many functions that are not all used in a particular session
+  // avoid paying the full verification cost at load time. Verification
+  // failures are reported from the call that first entered the function.
+  IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION = 1u << 0,
+  // Skips bytecode verification entirely. Only use with archives produced by a
+  // trusted toolchain as malformed bytecode can crash the interpreter. When a
+  // non-zero |trusted_digest| is provided in the options the archive contents
+  // must produce the same digest or module creation fails. This guards against
+  // loading the wrong file, not against a malicious one: the digest is not a
+  // cryptographic signature and authenticity must be established separately.
+  IREE_VM_BYTECODE_MODULE_FLAG_TRUSTED = 1u << 1,
+};
+typedef uint32_t iree_vm_bytecode_module_flags_t;
+
+// Options controlling bytecode module creation.
+typedef struct iree_vm_bytecode_module_options_t {
+  iree_vm_bytecode_module_flags_t flags;
+  // Expected iree_vm_bytecode_module_compute_digest result for the archive when
+  // IREE_VM_BYTECODE_MODULE_FLAG_TRUSTED is set. Zero skips the check.
+  uint64_t trusted_digest;
+} iree_vm_bytecode_module_options_t;
+
+// Initializes |out_options| to their defaults (full verification at load).
+IREE_API_EXPORT void iree_vm_bytecode_module_options_initialize(
+    iree_vm_bytecode_module_options_t* out_options);
+
+// Computes a 64-bit digest of |archive_contents| suitable for use as the
+// |trusted_digest| in iree_vm_bytecode_module_options_t. This is much cheaper
+// than verification but still touches every byte of the archive.
+IREE_API_EXPORT uint64_t iree_vm_bytecode_module_compute_digest(
+    iree_const_byte_span_t archive_contents);
+
 // Creates a VM module from an in-memory ModuleDef FlatBuffer archive.
 // If a |archive_allocator| is provided then it will be used to free the
 // |archive_contents| when the module is destroyed and otherwise the ownership
 // of the memory remains with the caller.
+//
+// The archive is referenced in place: function bytecode and rodata segments
+// (both embedded and trailing external data) are used directly from
+// |archive_contents| without copies. Archives backed by a read-only file
+// mapping are paged in on demand as functions execute and rodata is accessed
+// and the pages can be shared by all processes mapping the same file.
+// Combine with IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION or
+// IREE_VM_BYTECODE_MODULE_FLAG_TRUSTED to avoid touching all bytecode pages
+// during creation.
 IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create(
     iree_vm_instance_t* instance, iree_const_byte_span_t archive_contents,
     iree_allocator_t archive_allocator, iree_allocator_t allocator,
     iree_vm_module_t** out_module);
 
+// Creates a VM module from an in-memory ModuleDef FlatBuffer archive with the
+// verification behavior specified by |options|.
+// See iree_vm_bytecode_module_create for ownership of |archive_contents|.
+IREE_API_EXPORT iree_status_t iree_vm_bytecode_module_create_with_options(
+    iree_vm_instance_t* instance,
+    const iree_vm_bytecode_module_options_t* options,
+    iree_const_byte_span_t archive_contents, iree_allocator_t archive_allocator,
+    iree_allocator_t allocator, iree_vm_module_t** out_module);
+
 #ifdef __cplusplus
 }  // extern "C"
 #endif  // __cplusplus
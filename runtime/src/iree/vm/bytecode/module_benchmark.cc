@@ -70,15 +70,8 @@ static iree_status_t native_import_module_create(
                                       instance, allocator, out_module);
 }
 
-// Benchmarks the given exported function, optionally passing in arguments.
-static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
-                                 iree_string_view_t function_name,
-                                 std::vector<int32_t> i32_args,
-                                 int result_count, int64_t batch_size = 1) {
-  iree_vm_instance_t* instance = NULL;
-  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
-                                        iree_allocator_system(), &instance));
-
+// Creates a context with the native import module and the benchmark module.
+static iree_vm_context_t* CreateContext(iree_vm_instance_t* instance) {
   iree_vm_module_t* import_module = NULL;
   IREE_CHECK_OK(native_import_module_create(instance, iree_allocator_system(),
                                             &import_module));
@@ -99,6 +92,22 @@ static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
       instance, IREE_VM_CONTEXT_FLAG_NONE, modules.size(), modules.data(),
       iree_allocator_system(), &context));
 
+  // The context retains the modules.
+  iree_vm_module_release(import_module);
+  iree_vm_module_release(bytecode_module);
+  return context;
+}
+
+// Benchmarks the given exported function, optionally passing in arguments.
+static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
+                                 iree_string_view_t function_name,
+                                 std::vector<int32_t> i32_args,
+                                 int result_count, int64_t batch_size = 1) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+  iree_vm_context_t* context = CreateContext(instance);
+
   iree_vm_function_t function;
   IREE_CHECK_OK(
       iree_vm_context_resolve_function(context, function_name, &function));
@@ -121,18 +130,89 @@ static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
       reinterpret_cast<int32_t*>(call.arguments.data)[i] = i32_args[i];
     }
     IREE_CHECK_OK(
-        bytecode_module->begin_call(bytecode_module->self, stack, call));
+        function.module->begin_call(function.module->self, stack, call));
   }
   iree_vm_stack_deinitialize(stack);
 
-  iree_vm_module_release(import_module);
-  iree_vm_module_release(bytecode_module);
   iree_vm_context_release(context);
   iree_vm_instance_release(instance);
 
   return iree_ok_status();
 }
 
+// Allocator that counts allocations and forwards them to the system allocator.
+static iree_status_t CountingAllocatorCtl(void* self,
+                                          iree_allocator_command_t command,
+                                          const void* params,
+                                          void** inout_ptr) {
+  if (command != IREE_ALLOCATOR_COMMAND_FREE) ++*(int64_t*)self;
+  iree_allocator_t system_allocator = iree_allocator_system();
+  return system_allocator.ctl(system_allocator.self, command, params,
+                              inout_ptr);
+}
+
+// Benchmarks the full iree_vm_invoke path of the given exported function
+// taking and returning a single i32. When |reuse_invoker| is set a reusable
+// iree_vm_invoker_t is used and the benchmark fails if any host allocations
+// are made in steady state.
+static iree_status_t RunInvoke(iree_benchmark_state_t* benchmark_state,
+                               iree_string_view_t function_name, int32_t arg0,
+                               bool reuse_invoker) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+  iree_vm_context_t* context = CreateContext(instance);
+
+  iree_vm_function_t function;
+  IREE_CHECK_OK(
+      iree_vm_context_resolve_function(context, function_name, &function));
+
+  int64_t allocation_count = 0;
+  iree_allocator_t host_allocator = {&allocation_count, CountingAllocatorCtl};
+  iree_vm_value_t arg0_value = iree_vm_value_make_i32(arg0);
+  iree_status_t status = iree_ok_status();
+  if (reuse_invoker) {
+    iree_vm_invoker_t invoker;
+    IREE_CHECK_OK(iree_vm_invoker_initialize(context, function,
+                                             IREE_VM_INVOCATION_FLAG_NONE,
+                                             host_allocator, &invoker));
+    IREE_CHECK_OK(iree_vm_list_set_value(iree_vm_invoker_inputs(&invoker), 0,
+                                         &arg0_value));
+    allocation_count = 0;
+    while (iree_benchmark_keep_running(benchmark_state, 1)) {
+      IREE_CHECK_OK(iree_vm_invoker_invoke(&invoker));
+    }
+    if (allocation_count != 0) {
+      status = iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                                "steady-state invocations performed %" PRId64
+                                " host allocations",
+                                allocation_count);
+    }
+    iree_vm_invoker_deinitialize(&invoker);
+  } else {
+    while (iree_benchmark_keep_running(benchmark_state, 1)) {
+      iree_vm_list_t* inputs = NULL;
+      IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                        host_allocator, &inputs));
+      IREE_CHECK_OK(iree_vm_list_push_value(inputs, &arg0_value));
+      iree_vm_list_t* outputs = NULL;
+      IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 1,
+                                        host_allocator, &outputs));
+      IREE_CHECK_OK(iree_vm_invoke(context, function,
+                                   IREE_VM_INVOCATION_FLAG_NONE,
+                                   /*policy=*/NULL, inputs, outputs,
+                                   host_allocator));
+      iree_vm_list_release(inputs);
+      iree_vm_list_release(outputs);
+    }
+  }
+
+  iree_vm_context_release(context);
+  iree_vm_instance_release(instance);
+
+  return status;
+}
+
 IREE_BENCHMARK_FN(BM_ModuleCreate) {
   iree_vm_instance_t* instance = NULL;
   IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
@@ -303,6 +383,22 @@ IREE_BENCHMARK_FN(BM_CallImportedFuncBytecode) {
 }
 IREE_BENCHMARK_REGISTER(BM_CallImportedFuncBytecode);
 
+IREE_BENCHMARK_FN(BM_InvokeImportedFuncBytecode) {
+  return RunInvoke(
+      benchmark_state,
+      iree_make_cstring_view("bytecode_module_benchmark.call_imported_func"),
+      /*arg0=*/1, /*reuse_invoker=*/false);
+}
+IREE_BENCHMARK_REGISTER(BM_InvokeImportedFuncBytecode);
+
+IREE_BENCHMARK_FN(BM_InvokeImportedFuncBytecodeInvoker) {
+  return RunInvoke(
+      benchmark_state,
+      iree_make_cstring_view("bytecode_module_benchmark.call_imported_func"),
+      /*arg0=*/1, /*reuse_invoker=*/true);
+}
+IREE_BENCHMARK_REGISTER(BM_InvokeImportedFuncBytecodeInvoker);
+
 IREE_BENCHMARK_FN(BM_LoopSumReference) {
   static const int batch = 100000;
   static auto work = +[](int x) {
@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include "iree/base/api.h"
+#include "iree/base/internal/atomics.h"
 #include "iree/vm/api.h"
 #include "iree/vm/bytecode/utils/isa.h"
 
@@ -48,11 +49,48 @@ typedef struct iree_vm_bytecode_module_t {
   iree_host_size_t rodata_ref_count;
   iree_vm_buffer_t* rodata_ref_table;
 
+  // Bitmap with one bit per function set once the function has been verified.
+  // Only allocated when IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION is used
+  // and otherwise NULL as all functions were verified (or trusted) at load.
+  iree_atomic_int32_t* lazy_verified_bits;
+
   // Type table mapping module type IDs to registered VM types.
   iree_host_size_t type_count;
   iree_vm_type_def_t type_table[];
 } iree_vm_bytecode_module_t;
 
+// Verifies |function_ordinal| if it has not yet been verified.
+// Only called when the module was created with lazy verification.
+iree_status_t iree_vm_bytecode_module_verify_function_lazy(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal);
+
+// Ensures that |function_ordinal| has been verified before it is executed.
+// This is a no-op unless the module was created with lazy verification.
+static inline iree_status_t iree_vm_bytecode_module_ensure_function_verified(
+    iree_vm_bytecode_module_t* module, uint16_t function_ordinal) {
+  if (IREE_LIKELY(!module->lazy_verified_bits)) return iree_ok_status();
+  int32_t bits = iree_atomic_load(
+      &module->lazy_verified_bits[function_ordinal / 32],
+      iree_memory_order_acquire);
+  if (IREE_LIKELY(bits & (1 << (function_ordinal % 32)))) {
+    return iree_ok_status();
+  }
+  return iree_vm_bytecode_module_verify_function_lazy(module,
+                                                      function_ordinal);
+}
+
+// Specialized marshaling paths selected for an import when it is resolved.
+enum iree_vm_bytecode_import_flag_bits_t {
+  IREE_VM_BYTECODE_IMPORT_FLAG_NONE = 0u,
+  // All arguments are 32-bit primitives (`i` or `f`) and can be copied from
+  // registers into the ABI buffer without switching on the cconv type.
+  IREE_VM_BYTECODE_IMPORT_FLAG_I32_ARGUMENTS = 1u << 0,
+  // All results are 32-bit primitives (`i` or `f`) and can be copied from the
+  // ABI buffer into registers without switching on the cconv type.
+  IREE_VM_BYTECODE_IMPORT_FLAG_I32_RESULTS = 1u << 1,
+};
+typedef uint16_t iree_vm_bytecode_import_flags_t;
+
 // A resolved and split import in the module state table.
 //
 // NOTE: a table of these are stored per module per context so ideally we'd
@@ -73,6 +111,9 @@ typedef struct iree_vm_bytecode_import_t {
   // don't support variadic values (yet).
   uint16_t argument_buffer_size;
   uint16_t result_buffer_size;
+
+  // Marshaling fast paths usable with this import.
+  iree_vm_bytecode_import_flags_t flags;
 } iree_vm_bytecode_import_t;
 
 // Per-instance module state.
@@ -100,6 +100,7 @@ static std::vector<iree_vm_ref_t> MakeNullRefList(size_t count) {
 
 namespace {
 
+using iree::Status;
 using iree::StatusCode;
 using iree::StatusOr;
 using iree::testing::status::IsOkAndHolds;
@@ -228,4 +229,75 @@ TEST_F(VMBytecodeModuleTest, FuncIO600) {
               IsOkAndHolds(Eq(MakeNullRefList(600))));
 }
 
+static iree_const_byte_span_t GetModuleTestArchive() {
+  const auto* module_file_toc = iree_vm_bytecode_module_test_module_create();
+  return iree_const_byte_span_t{
+      reinterpret_cast<const uint8_t*>(module_file_toc->data),
+      static_cast<iree_host_size_t>(module_file_toc->size)};
+}
+
+// Tests that lazily verified functions can be called.
+TEST(VMBytecodeModuleOptionsTest, LazyVerification) {
+  iree_vm_instance_t* instance = nullptr;
+  IREE_ASSERT_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                         iree_allocator_system(), &instance));
+
+  iree_vm_bytecode_module_options_t options;
+  iree_vm_bytecode_module_options_initialize(&options);
+  options.flags = IREE_VM_BYTECODE_MODULE_FLAG_LAZY_VERIFICATION;
+  iree_vm_module_t* module = nullptr;
+  IREE_ASSERT_OK(iree_vm_bytecode_module_create_with_options(
+      instance, &options, GetModuleTestArchive(), iree_allocator_null(),
+      iree_allocator_system(), &module));
+
+  iree_vm_context_t* context = nullptr;
+  IREE_ASSERT_OK(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, 1, &module, iree_allocator_system(),
+      &context));
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_module_lookup_function_by_name(
+      module, IREE_VM_FUNCTION_LINKAGE_EXPORT, IREE_SV("FuncIOEmpty"),
+      &function));
+  // Call twice to cover both the verifying and already-verified paths.
+  for (int i = 0; i < 2; ++i) {
+    IREE_ASSERT_OK(iree_vm_invoke(
+        context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+        /*inputs=*/nullptr, /*outputs=*/nullptr, iree_allocator_system()));
+  }
+
+  iree_vm_context_release(context);
+  iree_vm_module_release(module);
+  iree_vm_instance_release(instance);
+}
+
+// Tests that trusted modules are only loaded when their digest matches.
+TEST(VMBytecodeModuleOptionsTest, TrustedDigest) {
+  iree_vm_instance_t* instance = nullptr;
+  IREE_ASSERT_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                         iree_allocator_system(), &instance));
+
+  iree_const_byte_span_t archive = GetModuleTestArchive();
+  iree_vm_bytecode_module_options_t options;
+  iree_vm_bytecode_module_options_initialize(&options);
+  options.flags = IREE_VM_BYTECODE_MODULE_FLAG_TRUSTED;
+  options.trusted_digest = iree_vm_bytecode_module_compute_digest(archive);
+
+  iree_vm_module_t* module = nullptr;
+  IREE_ASSERT_OK(iree_vm_bytecode_module_create_with_options(
+      instance, &options, archive, iree_allocator_null(),
+      iree_allocator_system(), &module));
+  iree_vm_module_release(module);
+
+  options.trusted_digest ^= 1;
+  module = nullptr;
+  EXPECT_THAT(Status(iree_vm_bytecode_module_create_with_options(
+                  instance, &options, archive, iree_allocator_null(),
+                  iree_allocator_system(), &module)),
+              StatusIs(StatusCode::kDataLoss));
+  EXPECT_EQ(module, nullptr);
+
+  iree_vm_instance_release(instance);
+}
+
 }  // namespace
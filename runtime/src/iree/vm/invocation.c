@@ -269,11 +269,20 @@ static void iree_vm_invoke_fiber_leave(iree_vm_invocation_id_t invocation_id,
 // Synchronous invocation
 //===----------------------------------------------------------------------===//
 
-IREE_API_EXPORT iree_status_t iree_vm_invoke(
+static iree_status_t iree_vm_begin_invoke_with_stack(
+    iree_vm_invoke_state_t* state, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
+    iree_vm_stack_t* borrowed_stack, iree_allocator_t host_allocator);
+
+// Synchronously invokes |function| as with iree_vm_invoke. If |borrowed_stack|
+// is provided it is used instead of the inline invocation state stack storage
+// and reset when the invocation completes.
+static iree_status_t iree_vm_invoke_with_stack(
     iree_vm_context_t* context, iree_vm_function_t function,
     iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
     const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
-    iree_allocator_t host_allocator) {
+    iree_vm_stack_t* borrowed_stack, iree_allocator_t host_allocator) {
   IREE_TRACE_ZONE_BEGIN(z0);
 
   // Bound the synchronous invocation to the timeout specified by the user
@@ -299,8 +308,9 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
   // complete the invocation before returning. If it yields we'll need to resume
   // it, possibly after taking care of pending waits.
   iree_vm_invoke_state_t state = {0};
-  iree_status_t status = iree_vm_begin_invoke(&state, context, function, flags,
-                                              policy, inputs, host_allocator);
+  iree_status_t status =
+      iree_vm_begin_invoke_with_stack(&state, context, function, flags, policy,
+                                      inputs, borrowed_stack, host_allocator);
   while (iree_status_is_deferred(status)) {
     // Grab the wait frame from the stack holding the wait parameters.
     // This is optional: if an invocation yields for cooperative scheduling
@@ -368,6 +378,106 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
   return status;
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_invoke(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, const iree_vm_invocation_policy_t* policy,
+    const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
+    iree_allocator_t host_allocator) {
+  return iree_vm_invoke_with_stack(context, function, flags, policy, inputs,
+                                   outputs, /*borrowed_stack=*/NULL,
+                                   host_allocator);
+}
+
+//===----------------------------------------------------------------------===//
+// Reusable synchronous invocation
+//===----------------------------------------------------------------------===//
+
+// Returns the number of values in |cconv_fragment| as expected by the
+// invocation marshaling routines.
+static iree_host_size_t iree_vm_invoke_fragment_value_count(
+    iree_string_view_t cconv_fragment) {
+  return cconv_fragment.size > 0
+             ? (cconv_fragment.data[0] == 'v' ? 0 : cconv_fragment.size)
+             : 0;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_invoker_initialize(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, iree_allocator_t host_allocator,
+    iree_vm_invoker_t* out_invoker) {
+  IREE_ASSERT_ARGUMENT(context);
+  IREE_ASSERT_ARGUMENT(out_invoker);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  memset(out_invoker, 0, sizeof(*out_invoker));
+
+  // Force tracing if specified on the context. The stack captures the flags
+  // so they must be resolved before it is allocated.
+  if (iree_vm_context_flags(context) & IREE_VM_CONTEXT_FLAG_TRACE_EXECUTION) {
+    flags |= IREE_VM_INVOCATION_FLAG_TRACE_EXECUTION;
+  }
+
+  iree_vm_function_signature_t signature =
+      iree_vm_function_signature(&function);
+  iree_string_view_t cconv_arguments = iree_string_view_empty();
+  iree_string_view_t cconv_results = iree_string_view_empty();
+  IREE_RETURN_AND_END_ZONE_IF_ERROR(
+      z0, iree_vm_function_call_get_cconv_fragments(
+              &signature, &cconv_arguments, &cconv_results));
+  const iree_host_size_t input_count =
+      iree_vm_invoke_fragment_value_count(cconv_arguments);
+  const iree_host_size_t output_count =
+      iree_vm_invoke_fragment_value_count(cconv_results);
+
+  out_invoker->context = context;
+  iree_vm_context_retain(context);
+  out_invoker->function = function;
+  out_invoker->flags = flags;
+  out_invoker->host_allocator = host_allocator;
+
+  iree_status_t status = iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             input_count, host_allocator,
+                                             &out_invoker->inputs);
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_resize(out_invoker->inputs, input_count);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                 output_count, host_allocator,
+                                 &out_invoker->outputs);
+  }
+  if (iree_status_is_ok(status)) {
+    status = iree_vm_stack_allocate(flags,
+                                    iree_vm_context_state_resolver(context),
+                                    host_allocator, &out_invoker->stack);
+  }
+
+  if (!iree_status_is_ok(status)) {
+    iree_vm_invoker_deinitialize(out_invoker);
+  }
+  IREE_TRACE_ZONE_END(z0);
+  return status;
+}
+
+IREE_API_EXPORT void iree_vm_invoker_deinitialize(iree_vm_invoker_t* invoker) {
+  IREE_ASSERT_ARGUMENT(invoker);
+  IREE_TRACE_ZONE_BEGIN(z0);
+  if (invoker->stack) iree_vm_stack_free(invoker->stack);
+  iree_vm_list_release(invoker->outputs);
+  iree_vm_list_release(invoker->inputs);
+  iree_vm_context_release(invoker->context);
+  memset(invoker, 0, sizeof(*invoker));
+  IREE_TRACE_ZONE_END(z0);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_invoker_invoke(iree_vm_invoker_t* invoker) {
+  IREE_ASSERT_ARGUMENT(invoker);
+  return iree_vm_invoke_with_stack(invoker->context, invoker->function,
+                                   invoker->flags, /*policy=*/NULL,
+                                   invoker->inputs, invoker->outputs,
+                                   invoker->stack, invoker->host_allocator);
+}
+
 //===----------------------------------------------------------------------===//
 // Asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -377,11 +487,11 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
 
 // WARNING: this function cannot have any trace markers that span the begin
 // call; the begin may yield with zones still open.
-IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
+static iree_status_t iree_vm_begin_invoke_with_stack(
     iree_vm_invoke_state_t* state, iree_vm_context_t* context,
     iree_vm_function_t function, iree_vm_invocation_flags_t flags,
     const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
-    iree_allocator_t host_allocator) {
+    iree_vm_stack_t* borrowed_stack, iree_allocator_t host_allocator) {
   IREE_ASSERT_ARGUMENT(context);
   IREE_TRACE_ZONE_BEGIN(z0);
 
@@ -460,14 +570,18 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
     return status;
   }
 
-  // Initialize the stack with the inline storage.
-  // We (probably) sliced off the head of the storage above to use for results
-  // and perform an offset here to account for that.
-  iree_vm_stack_t* stack = NULL;
-  status = iree_vm_stack_initialize(
-      iree_make_byte_span(state->stack_storage + reserved_storage_size,
-                          sizeof(state->stack_storage) - reserved_storage_size),
-      flags, iree_vm_context_state_resolver(context), host_allocator, &stack);
+  // Initialize the stack with the inline storage unless the caller provided
+  // one. We (probably) sliced off the head of the storage above to use for
+  // results and perform an offset here to account for that.
+  iree_vm_stack_t* stack = borrowed_stack;
+  if (!stack) {
+    status = iree_vm_stack_initialize(
+        iree_make_byte_span(
+            state->stack_storage + reserved_storage_size,
+            sizeof(state->stack_storage) - reserved_storage_size),
+        flags, iree_vm_context_state_resolver(context), host_allocator,
+        &stack);
+  }
   if (!iree_status_is_ok(status)) {
     iree_vm_invoke_release_argument_storage(cconv_arguments, arguments,
                                             arguments_on_heap, host_allocator);
@@ -487,6 +601,7 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
   state->results = results;
   iree_vm_context_retain(context);
   state->stack = stack;
+  state->borrowed_stack = borrowed_stack != NULL;
 
   // NOTE: we must end the zone here as the begin_call will return with
   // unbalanced zones if we yield.
@@ -519,6 +634,17 @@ IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
   return iree_ok_status();
 }
 
+IREE_API_EXPORT iree_status_t iree_vm_begin_invoke(
+    iree_vm_invoke_state_t* state, iree_vm_context_t* context,
+    iree_vm_function_t function, iree_vm_invocation_flags_t flags,
+    const iree_vm_invocation_policy_t* policy, const iree_vm_list_t* inputs,
+    iree_allocator_t host_allocator) {
+  return iree_vm_begin_invoke_with_stack(state, context, function, flags,
+                                         policy, inputs,
+                                         /*borrowed_stack=*/NULL,
+                                         host_allocator);
+}
+
 // WARNING: this function cannot have any trace markers that span the resume
 // call; the resume may yield with zones still open.
 IREE_API_EXPORT iree_status_t
@@ -549,11 +675,20 @@ iree_vm_resume_invoke(iree_vm_invoke_state_t* state) {
                               "resume called with no parent frame");
     }
 
+    // Frames called from within the VM write their results into storage
+    // reserved by their caller when they yielded while the bottom frame writes
+    // into the invocation results.
+    iree_byte_span_t resume_results =
+        iree_vm_stack_frame_resume_results(state->stack, resume_frame);
+    if (iree_byte_span_is_empty(resume_results)) {
+      resume_results = state->results;
+    }
+
     // Call into the VM to resume the function. It may complete (returning OK),
     // defer to be waited/resumed later, or fail.
     iree_vm_function_t resume_function = resume_frame->function;
     state->status = resume_function.module->resume_call(
-        resume_function.module->self, state->stack, state->results);
+        resume_function.module->self, state->stack, resume_results);
 
     // If the call yielded then return that so the user knows to resume again.
     if (iree_status_is_deferred(state->status)) {
@@ -602,13 +737,24 @@ iree_vm_wait_invoke(iree_vm_invoke_state_t* state,
   } else if (wait_frame->count == 1) {
     wait_frame->wait_status = iree_wait_source_wait_one(
         wait_frame->wait_sources[0], iree_make_deadline(min_deadline_ns));
+  } else if (wait_frame->wait_type == IREE_VM_WAIT_ALL) {
+    // All sources must resolve so waiting on each in turn with the same
+    // deadline is equivalent to a multi-wait; sources that resolved while we
+    // waited on earlier ones return immediately.
+    iree_status_t wait_status = iree_ok_status();
+    for (iree_host_size_t i = 0; i < wait_frame->count; ++i) {
+      wait_status = iree_wait_source_wait_one(
+          wait_frame->wait_sources[i], iree_make_deadline(min_deadline_ns));
+      if (!iree_status_is_ok(wait_status)) break;
+    }
+    wait_frame->wait_status = wait_status;
   } else {
-    // TODO(benvanik): multi-wait when running synchronously. This is already
+    // TODO(benvanik): wait-any when running synchronously. This is already
     // supported by iree_loop_inline_t and maybe we can just reuse that. These
     // are not currently emitted by the compiler.
     return iree_make_status(
         IREE_STATUS_UNIMPLEMENTED,
-        "multi-wait in synchronous invocations not yet implemented");
+        "wait-any in synchronous invocations not yet implemented");
   }
 
   // Reset status to OK - the next resume will pick back up in the waiter.
@@ -678,7 +824,12 @@ IREE_API_EXPORT void iree_vm_abort_invoke(iree_vm_invoke_state_t* state) {
                                         : iree_allocator_null();
 
   if (state->stack) {
-    iree_vm_stack_deinitialize(state->stack);
+    if (state->borrowed_stack) {
+      // Pop any remaining frames but keep the storage for reuse.
+      iree_vm_stack_reset(state->stack);
+    } else {
+      iree_vm_stack_deinitialize(state->stack);
+    }
     state->stack = NULL;
   }
 
@@ -794,7 +945,10 @@ static iree_status_t iree_vm_async_begin_invoke(void* user_data,
   // to begin the invocation.
   iree_vm_context_t* context = state->begin_params.context;
   iree_vm_function_t function = state->begin_params.function;
-  iree_vm_invocation_flags_t flags = state->begin_params.flags;
+  // The loop resumes the invocation whenever it yields so callees are allowed
+  // to yield on waits instead of blocking the loop thread.
+  iree_vm_invocation_flags_t flags =
+      state->begin_params.flags | IREE_VM_INVOCATION_FLAG_ASYNC;
   const iree_vm_invocation_policy_t* policy = state->begin_params.policy;
   iree_vm_list_t* inputs = state->begin_params.inputs;
 
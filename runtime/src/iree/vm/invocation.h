@@ -48,6 +48,81 @@ IREE_API_EXPORT iree_status_t iree_vm_invoke(
     const iree_vm_list_t* inputs, iree_vm_list_t* outputs,
     iree_allocator_t host_allocator);
 
+//===----------------------------------------------------------------------===//
+// Reusable synchronous invocation
+//===----------------------------------------------------------------------===//
+
+// Reusable state for repeatedly invoking the same function synchronously.
+// This is intended to be embedded within higher-level objects or used directly
+// on the stack by callers that issue many invocations (such as benchmarks or
+// request loops).
+//
+// The VM stack is retained across invocations along with any storage it grew
+// into and input/output lists are preallocated to match the function
+// signature. Once the stack has grown to the high-water mark of the function
+// steady-state invocations perform no host allocations. Functions with
+// argument or result storage larger than the inline limits of
+// iree_vm_invoke_state_t will still allocate per invocation.
+//
+// Usage:
+//   iree_vm_invoker_t invoker;
+//   iree_vm_invoker_initialize(context, function, flags, allocator, &invoker);
+//   for (...) {
+//     iree_vm_list_set_value(iree_vm_invoker_inputs(&invoker), 0, &value);
+//     iree_vm_invoker_invoke(&invoker);
+//     iree_vm_list_get_value(iree_vm_invoker_outputs(&invoker), 0, &value);
+//   }
+//   iree_vm_invoker_deinitialize(&invoker);
+//
+// Thread-compatible: invocations may be made from any thread so long as none
+// are made concurrently.
+typedef struct iree_vm_invoker_t {
+  // Retains the context invocations are run within.
+  iree_vm_context_t* context;
+  // Target function.
+  iree_vm_function_t function;
+  // Flags controlling invocation behavior.
+  iree_vm_invocation_flags_t flags;
+  // Allocator used for the stack, lists, and any oversized I/O storage.
+  iree_allocator_t host_allocator;
+  // Input list sized to the function arguments. Contents are retained across
+  // invocations until changed by the caller.
+  iree_vm_list_t* inputs;
+  // Output list receiving the function results of the last invocation.
+  iree_vm_list_t* outputs;
+  // VM stack reset (but not deinitialized) after each invocation such that
+  // any dynamic growth it performed is reused by subsequent invocations.
+  iree_vm_stack_t* stack;
+} iree_vm_invoker_t;
+
+// Initializes |out_invoker| for invoking |function| in |context|.
+// The input list is resized to the number of function arguments with each
+// element left unset; callers must populate it before the first invocation.
+IREE_API_EXPORT iree_status_t iree_vm_invoker_initialize(
+    iree_vm_context_t* context, iree_vm_function_t function,
+    iree_vm_invocation_flags_t flags, iree_allocator_t host_allocator,
+    iree_vm_invoker_t* out_invoker);
+
+// Deinitializes |invoker| and releases all retained resources.
+IREE_API_EXPORT void iree_vm_invoker_deinitialize(iree_vm_invoker_t* invoker);
+
+// Returns the input list passed to each invocation.
+static inline iree_vm_list_t* iree_vm_invoker_inputs(
+    iree_vm_invoker_t* invoker) {
+  return invoker->inputs;
+}
+
+// Returns the output list populated by the last successful invocation.
+static inline iree_vm_list_t* iree_vm_invoker_outputs(
+    iree_vm_invoker_t* invoker) {
+  return invoker->outputs;
+}
+
+// Synchronously invokes the function with the current inputs and stores the
+// results in the outputs list. Behaves as iree_vm_invoke otherwise.
+IREE_API_EXPORT iree_status_t
+iree_vm_invoker_invoke(iree_vm_invoker_t* invoker);
+
 //===----------------------------------------------------------------------===//
 // Asynchronous invocation
 //===----------------------------------------------------------------------===//
@@ -90,6 +165,9 @@ typedef struct iree_vm_invoke_state_t {
   // VM stack used during the invocation. Will retain required resources
   // across invocation stages.
   iree_vm_stack_t* stack;
+  // True if |stack| is owned by the caller and must only be reset when the
+  // invocation ends instead of deinitialized.
+  bool borrowed_stack;
   // Inlined stack storage. If the stack grows larger than this amount
   // additional storage will be allocated automatically.
   uint8_t stack_storage[IREE_VM_STACK_DEFAULT_SIZE];
@@ -291,12 +291,12 @@ iree_vm_list_reserve(iree_vm_list_t* list, iree_host_size_t minimum_capacity) {
   if (list->capacity >= minimum_capacity) {
     return iree_ok_status();
   }
-  iree_host_size_t old_capacity = list->capacity;
+  // NOTE: the new storage is not zeroed here and is instead initialized as the
+  // list is resized to include it. This avoids touching the memory of large
+  // reservations that may never be fully used.
   iree_host_size_t new_capacity = iree_host_align(minimum_capacity, 64);
   IREE_RETURN_IF_ERROR(iree_allocator_realloc(
       list->allocator, new_capacity * list->element_size, &list->storage));
-  memset((void*)((uintptr_t)list->storage + old_capacity * list->element_size),
-         0, (new_capacity - old_capacity) * list->element_size);
   list->capacity = new_capacity;
   return iree_ok_status();
 }
@@ -315,11 +315,16 @@ IREE_API_EXPORT iree_status_t iree_vm_list_resize(iree_vm_list_t* list,
     // Truncating.
     iree_vm_list_reset_range(list, new_size, list->count - new_size);
     list->count = new_size;
+    return iree_ok_status();
   } else if (new_size > list->capacity) {
     // Extending beyond capacity.
     IREE_RETURN_IF_ERROR(iree_vm_list_reserve(
         list, iree_max(list->capacity * 2, iree_host_align(new_size, 64))));
   }
+  // Initialize the extended range to the default value as elements beyond the
+  // current count may be uninitialized reserved storage.
+  memset((void*)((uintptr_t)list->storage + list->count * list->element_size),
+         0, (new_size - list->count) * list->element_size);
   list->count = new_size;
   return iree_ok_status();
 }
@@ -784,6 +789,86 @@ iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value) {
   return iree_vm_list_set_value(list, i, value);
 }
 
+// Verifies that the element range [i, i + count) is within the list bounds.
+static iree_status_t iree_vm_list_verify_range(const iree_vm_list_t* list,
+                                               iree_host_size_t i,
+                                               iree_host_size_t count) {
+  if (IREE_UNLIKELY(i > list->count || count > list->count - i)) {
+    return iree_make_status(IREE_STATUS_OUT_OF_RANGE,
+                            "range [%" PRIhsz ", %" PRIhsz
+                            ") out of bounds (%" PRIhsz ")",
+                            i, i + count, list->count);
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values_as(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, void* out_values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(!count || out_values);
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, i, count));
+  const iree_host_size_t value_size =
+      iree_vm_value_type_size(iree_vm_make_value_type_def(value_type));
+  if (IREE_UNLIKELY(!value_size)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsized value type %d", (int)value_type);
+  }
+
+  // Fast path for lists storing the requested type directly.
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE &&
+      iree_vm_type_def_as_value(list->element_type) == value_type) {
+    memcpy(out_values, (uint8_t*)list->storage + i * list->element_size,
+           count * value_size);
+    return iree_ok_status();
+  }
+
+  // Slow path requiring per-element checks and conversion.
+  uint8_t* p = (uint8_t*)out_values;
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_value_t value;
+    IREE_RETURN_IF_ERROR(
+        iree_vm_list_get_value_as(list, i + j, value_type, &value));
+    memcpy(p, value.value_storage, value_size);
+    p += value_size;
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(!count || values);
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, i, count));
+  const iree_host_size_t value_size =
+      iree_vm_value_type_size(iree_vm_make_value_type_def(value_type));
+  if (IREE_UNLIKELY(!value_size)) {
+    return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                            "unsized value type %d", (int)value_type);
+  }
+
+  // Fast path for lists storing the provided type directly.
+  if (list->storage_mode == IREE_VM_LIST_STORAGE_MODE_VALUE &&
+      iree_vm_type_def_as_value(list->element_type) == value_type) {
+    memcpy((uint8_t*)list->storage + i * list->element_size, values,
+           count * value_size);
+    return iree_ok_status();
+  }
+
+  // Slow path requiring per-element conversion.
+  const uint8_t* p = (const uint8_t*)values;
+  for (iree_host_size_t j = 0; j < count; ++j) {
+    iree_vm_value_t value;
+    memset(&value, 0, sizeof(value));
+    value.type = value_type;
+    memcpy(value.value_storage, p, value_size);
+    IREE_RETURN_IF_ERROR(iree_vm_list_set_value(list, i + j, &value));
+    p += value_size;
+  }
+  return iree_ok_status();
+}
+
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
                                                  iree_host_size_t i,
                                                  iree_vm_ref_type_t type) {
@@ -943,6 +1028,217 @@ static void iree_vm_list_ref_op(iree_vm_list_ref_mode_t mode,
   }
 }
 
+// Gets |count| ref elements starting at |i| into |out_values| using |mode|.
+static iree_status_t iree_vm_list_get_refs(const iree_vm_list_t* list,
+                                           iree_host_size_t i,
+                                           iree_host_size_t count,
+                                           iree_vm_list_ref_mode_t mode,
+                                           iree_vm_ref_t* out_values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(!count || out_values);
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, i, count));
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_REF: {
+      iree_vm_ref_t* refs = (iree_vm_ref_t*)list->storage + i;
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        iree_vm_list_ref_op(mode, &refs[j], &out_values[j]);
+      }
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      iree_vm_variant_t* variants = (iree_vm_variant_t*)list->storage + i;
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        if (!iree_vm_variant_is_empty(variants[j]) &&
+            !iree_vm_type_def_is_ref(variants[j].type)) {
+          return iree_make_status(
+              IREE_STATUS_FAILED_PRECONDITION,
+              "variant at index %" PRIhsz " is not a ref type", i + j);
+        }
+      }
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        iree_vm_list_ref_op(mode, &variants[j].ref, &out_values[j]);
+      }
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list does not store refs");
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* out_values) {
+  return iree_vm_list_get_refs(list, i, count, IREE_VM_LIST_REF_RETAIN,
+                               out_values);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_move(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* out_values) {
+  return iree_vm_list_get_refs(list, i, count, IREE_VM_LIST_REF_MOVE,
+                               out_values);
+}
+
+// Sets |count| ref elements starting at |i| from |values|.
+// If |is_move|=true then ownership of the references is transferred to the
+// list and otherwise each reference is retained.
+static iree_status_t iree_vm_list_set_refs(iree_vm_list_t* list,
+                                           iree_host_size_t i,
+                                           iree_host_size_t count, bool is_move,
+                                           iree_vm_ref_t* values) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(!count || values);
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, i, count));
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_REF: {
+      // Verify all types first so that we fail without making changes.
+      const iree_vm_ref_type_t element_type =
+          iree_vm_type_def_as_ref(list->element_type);
+      if (element_type != IREE_VM_REF_TYPE_ANY) {
+        for (iree_host_size_t j = 0; j < count; ++j) {
+          if (IREE_UNLIKELY(values[j].type != IREE_VM_REF_TYPE_NULL &&
+                            values[j].type != element_type)) {
+            return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                    "ref value %" PRIhsz
+                                    " does not match the list element type",
+                                    j);
+          }
+        }
+      }
+      iree_vm_ref_t* refs = (iree_vm_ref_t*)list->storage + i;
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        iree_vm_ref_retain_or_move(is_move, &values[j], &refs[j]);
+      }
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        IREE_RETURN_IF_ERROR(
+            iree_vm_list_set_ref(list, i + j, is_move, &values[j]));
+      }
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list cannot store refs");
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    const iree_vm_ref_t* values) {
+  return iree_vm_list_set_refs(list, i, count, /*is_move=*/false,
+                               (iree_vm_ref_t*)values);
+}
+
+IREE_API_EXPORT iree_status_t
+iree_vm_list_set_refs_move(iree_vm_list_t* list, iree_host_size_t i,
+                           iree_host_size_t count, iree_vm_ref_t* values) {
+  return iree_vm_list_set_refs(list, i, count, /*is_move=*/true, values);
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_ptrs(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_type_t type, void** out_ptrs) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(!count || out_ptrs);
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, i, count));
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_REF: {
+      const iree_vm_ref_t* refs = (const iree_vm_ref_t*)list->storage + i;
+      if (iree_vm_type_def_as_ref(list->element_type) == type) {
+        // Homogeneous list of the requested type; all elements are either null
+        // or of |type| and can be read directly.
+        for (iree_host_size_t j = 0; j < count; ++j) {
+          out_ptrs[j] = refs[j].ptr;
+        }
+        break;
+      }
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        if (IREE_UNLIKELY(refs[j].ptr && refs[j].type != type)) {
+          return iree_make_status(
+              IREE_STATUS_INVALID_ARGUMENT,
+              "ref at index %" PRIhsz " is not of the requested type", i + j);
+        }
+        out_ptrs[j] = refs[j].ptr;
+      }
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      const iree_vm_variant_t* variants =
+          (const iree_vm_variant_t*)list->storage + i;
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        if (iree_vm_variant_is_empty(variants[j])) {
+          out_ptrs[j] = NULL;
+        } else if (IREE_LIKELY(iree_vm_type_def_is_ref(variants[j].type) &&
+                               (!variants[j].ref.ptr ||
+                                variants[j].ref.type == type))) {
+          out_ptrs[j] = variants[j].ref.ptr;
+        } else {
+          return iree_make_status(
+              IREE_STATUS_INVALID_ARGUMENT,
+              "variant at index %" PRIhsz " is not of the requested type",
+              i + j);
+        }
+      }
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list does not store refs");
+  }
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_list_set_ref_ptrs_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_type_t type, void* const* ptrs) {
+  IREE_ASSERT_ARGUMENT(list);
+  IREE_ASSERT_ARGUMENT(!count || ptrs);
+  IREE_RETURN_IF_ERROR(iree_vm_list_verify_range(list, i, count));
+  switch (list->storage_mode) {
+    case IREE_VM_LIST_STORAGE_MODE_REF: {
+      const iree_vm_ref_type_t element_type =
+          iree_vm_type_def_as_ref(list->element_type);
+      if (IREE_UNLIKELY(element_type != type &&
+                        element_type != IREE_VM_REF_TYPE_ANY)) {
+        return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,
+                                "list element type does not match the "
+                                "provided ref type");
+      }
+      iree_vm_ref_t* refs = (iree_vm_ref_t*)list->storage + i;
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        // NOTE: we retain first in case the element already references the
+        // same object.
+        void* ptr = ptrs[j];
+        if (ptr) iree_vm_ref_object_retain(ptr, type);
+        iree_vm_ref_release(&refs[j]);
+        refs[j].ptr = ptr;
+        refs[j].type = ptr ? type : IREE_VM_REF_TYPE_NULL;
+      }
+      break;
+    }
+    case IREE_VM_LIST_STORAGE_MODE_VARIANT: {
+      for (iree_host_size_t j = 0; j < count; ++j) {
+        iree_vm_ref_t ref = iree_vm_ref_null();
+        if (ptrs[j]) {
+          IREE_RETURN_IF_ERROR(iree_vm_ref_wrap_retain(ptrs[j], type, &ref));
+        }
+        IREE_RETURN_IF_ERROR(
+            iree_vm_list_set_ref(list, i + j, /*is_move=*/true, &ref));
+      }
+      break;
+    }
+    default:
+      return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                              "list cannot store refs");
+  }
+  return iree_ok_status();
+}
+
 static iree_status_t iree_vm_list_get_variant(const iree_vm_list_t* list,
                                               iree_host_size_t i,
                                               iree_vm_list_ref_mode_t ref_mode,
@@ -88,7 +88,8 @@ IREE_API_EXPORT iree_host_size_t
 iree_vm_list_capacity(const iree_vm_list_t* list);
 
 // Reserves storage for at least minimum_capacity elements. If the list already
-// has at least the specified capacity the operation is ignored.
+// has at least the specified capacity the operation is ignored. Reserved
+// storage is not initialized until the list is resized to include it.
 IREE_API_EXPORT iree_status_t
 iree_vm_list_reserve(iree_vm_list_t* list, iree_host_size_t minimum_capacity);
 
@@ -157,6 +158,22 @@ IREE_API_EXPORT iree_status_t iree_vm_list_set_value(
 IREE_API_EXPORT iree_status_t
 iree_vm_list_push_value(iree_vm_list_t* list, const iree_vm_value_t* value);
 
+// Returns |count| values starting at index |i| as a dense array of
+// |value_type| elements in |out_values|. Lists storing |value_type| directly
+// are copied in bulk and otherwise values are converted as with
+// iree_vm_list_get_value_as.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_values_as(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, void* out_values);
+
+// Sets |count| elements starting at index |i| from the dense array of
+// |value_type| elements in |values|. Lists storing |value_type| directly are
+// copied in bulk and otherwise values are converted as with
+// iree_vm_list_set_value.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_values(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_value_type_t value_type, const void* values);
+
 // Returns a dereferenced pointer to the given type if the element at the
 // given index |i| matches the |type|. Returns NULL on error.
 IREE_API_EXPORT void* iree_vm_list_get_ref_deref(const iree_vm_list_t* list,
@@ -199,6 +216,49 @@ IREE_API_EXPORT iree_status_t iree_vm_list_push_ref_move(iree_vm_list_t* list,
 IREE_API_EXPORT iree_status_t
 iree_vm_list_pop_front_ref_move(iree_vm_list_t* list, iree_vm_ref_t* out_value);
 
+// Retains |count| ref elements starting at index |i| into |out_values|.
+// Existing references in |out_values| are released. The range is verified in
+// full before any references are modified.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_retain(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* out_values);
+
+// Moves |count| ref elements starting at index |i| into |out_values| and leaves
+// the list elements null. Existing references in |out_values| are released.
+// The range is verified in full before any references are modified.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_refs_move(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_t* out_values);
+
+// Sets |count| ref elements starting at index |i| to |values|, retaining a
+// reference to each. All |values| must match the list element type (or be null)
+// and are verified before any elements are modified.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_refs_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    const iree_vm_ref_t* values);
+
+// Sets |count| ref elements starting at index |i| to |values|, moving ownership
+// of each reference to the list. All |values| must match the list element type
+// (or be null) and are verified before any elements are modified.
+IREE_API_EXPORT iree_status_t
+iree_vm_list_set_refs_move(iree_vm_list_t* list, iree_host_size_t i,
+                           iree_host_size_t count, iree_vm_ref_t* values);
+
+// Returns the dereferenced object pointers of |count| ref elements starting at
+// index |i| in |out_ptrs| without retaining them. Elements must either be null
+// or of |type|. Lists with an element type of |type| are read without
+// per-element checks.
+IREE_API_EXPORT iree_status_t iree_vm_list_get_ref_ptrs(
+    const iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_type_t type, void** out_ptrs);
+
+// Sets |count| ref elements starting at index |i| to objects of |type|,
+// retaining each. NULL pointers clear the element. Lists with an element type
+// of |type| are written without per-element checks.
+IREE_API_EXPORT iree_status_t iree_vm_list_set_ref_ptrs_retain(
+    iree_vm_list_t* list, iree_host_size_t i, iree_host_size_t count,
+    iree_vm_ref_type_t type, void* const* ptrs);
+
 // Returns the value of the element at the given index. If the element contains
 // a ref it will *not* be retained and the caller must retain it to extend its
 // lifetime.
@@ -1253,6 +1253,127 @@ TEST_F(VMListTest, PushPopRef) {
   iree_vm_list_release(list);
 }
 
+// Tests bulk value get/set on typed and variant lists.
+TEST_F(VMListTest, BulkValues) {
+  iree_vm_type_def_t element_type =
+      iree_vm_make_value_type_def(IREE_VM_VALUE_TYPE_I32);
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 8, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 8));
+
+  // Direct i32 storage.
+  const int32_t values[4] = {1, 2, 3, 4};
+  IREE_ASSERT_OK(
+      iree_vm_list_set_values(list, 2, 4, IREE_VM_VALUE_TYPE_I32, values));
+  EXPECT_EQ(GetValuesList(list),
+            MakeValuesList((const int32_t[8]){0, 0, 1, 2, 3, 4, 0, 0}));
+
+  // Conversion to i64.
+  int64_t i64_values[4] = {0};
+  IREE_ASSERT_OK(iree_vm_list_get_values_as(list, 2, 4, IREE_VM_VALUE_TYPE_I64,
+                                            i64_values));
+  for (int i = 0; i < 4; ++i) EXPECT_EQ(i64_values[i], i + 1);
+
+  // Out of range.
+  EXPECT_THAT(Status(iree_vm_list_get_values_as(
+                  list, 6, 4, IREE_VM_VALUE_TYPE_I64, i64_values)),
+              StatusIs(StatusCode::kOutOfRange));
+
+  // Variant lists check and convert each element.
+  iree_vm_list_t* variant_list = nullptr;
+  IREE_ASSERT_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 4,
+                                     iree_allocator_system(), &variant_list));
+  IREE_ASSERT_OK(iree_vm_list_resize(variant_list, 4));
+  IREE_ASSERT_OK(iree_vm_list_set_values(variant_list, 0, 4,
+                                         IREE_VM_VALUE_TYPE_I32, values));
+  int32_t i32_values[4] = {0};
+  IREE_ASSERT_OK(iree_vm_list_get_values_as(variant_list, 0, 4,
+                                            IREE_VM_VALUE_TYPE_I32,
+                                            i32_values));
+  EXPECT_EQ(0, memcmp(values, i32_values, sizeof(values)));
+
+  iree_vm_list_release(variant_list);
+  iree_vm_list_release(list);
+}
+
+// Tests bulk ref move-in/move-out and retains.
+TEST_F(VMListTest, BulkRefs) {
+  iree_vm_type_def_t element_type = iree_vm_make_ref_type_def(test_a_type());
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 4, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 4));
+
+  iree_vm_ref_t refs[4];
+  for (int i = 0; i < 4; ++i) refs[i] = MakeRef<A>((float)i);
+  IREE_ASSERT_OK(iree_vm_list_set_refs_move(list, 0, 4, refs));
+  for (int i = 0; i < 4; ++i) EXPECT_TRUE(iree_vm_ref_is_null(&refs[i]));
+
+  // Mismatched types fail without modifying the list.
+  iree_vm_ref_t mixed_refs[2] = {MakeRef<A>(10.0f), MakeRef<B>(11)};
+  EXPECT_THAT(Status(iree_vm_list_set_refs_retain(list, 0, 2, mixed_refs)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_EQ(GetValuesList(list),
+            MakeValuesList((const float[4]){0.0f, 1.0f, 2.0f, 3.0f}));
+  iree_vm_ref_release(&mixed_refs[0]);
+  iree_vm_ref_release(&mixed_refs[1]);
+
+  // Retain out leaves the list unchanged.
+  iree_vm_ref_t out_refs[2] = {iree_vm_ref_null(), iree_vm_ref_null()};
+  IREE_ASSERT_OK(iree_vm_list_get_refs_retain(list, 1, 2, out_refs));
+  EXPECT_EQ(test_a_deref(out_refs[0])->data(), 1.0f);
+  EXPECT_EQ(test_a_deref(out_refs[1])->data(), 2.0f);
+  iree_vm_ref_release(&out_refs[0]);
+  iree_vm_ref_release(&out_refs[1]);
+
+  // Move out leaves the list elements null.
+  IREE_ASSERT_OK(iree_vm_list_get_refs_move(list, 2, 2, out_refs));
+  EXPECT_EQ(test_a_deref(out_refs[0])->data(), 2.0f);
+  EXPECT_EQ(test_a_deref(out_refs[1])->data(), 3.0f);
+  iree_vm_ref_t null_ref = iree_vm_ref_null();
+  IREE_ASSERT_OK(iree_vm_list_get_ref_assign(list, 2, &null_ref));
+  EXPECT_TRUE(iree_vm_ref_is_null(&null_ref));
+  iree_vm_ref_release(&out_refs[0]);
+  iree_vm_ref_release(&out_refs[1]);
+
+  iree_vm_list_release(list);
+}
+
+// Tests bulk access to the object pointers of homogeneous ref lists.
+TEST_F(VMListTest, RefPtrs) {
+  iree_vm_type_def_t element_type = iree_vm_make_ref_type_def(test_a_type());
+  iree_vm_list_t* list = nullptr;
+  IREE_ASSERT_OK(
+      iree_vm_list_create(element_type, 3, iree_allocator_system(), &list));
+  IREE_ASSERT_OK(iree_vm_list_resize(list, 3));
+
+  iree_vm_ref_t refs[2] = {MakeRef<A>(1.0f), MakeRef<A>(2.0f)};
+  void* ptrs[3] = {refs[0].ptr, NULL, refs[1].ptr};
+  IREE_ASSERT_OK(iree_vm_list_set_ref_ptrs_retain(list, 0, 3, test_a_type(),
+                                                  ptrs));
+  // The list holds its own references.
+  iree_vm_ref_release(&refs[0]);
+  iree_vm_ref_release(&refs[1]);
+
+  void* out_ptrs[3] = {NULL, NULL, NULL};
+  IREE_ASSERT_OK(
+      iree_vm_list_get_ref_ptrs(list, 0, 3, test_a_type(), out_ptrs));
+  EXPECT_EQ(static_cast<A*>(out_ptrs[0])->data(), 1.0f);
+  EXPECT_EQ(out_ptrs[1], nullptr);
+  EXPECT_EQ(static_cast<A*>(out_ptrs[2])->data(), 2.0f);
+
+  // Mismatched list types are rejected.
+  EXPECT_THAT(Status(iree_vm_list_set_ref_ptrs_retain(list, 0, 1,
+                                                      test_b_type(), ptrs)),
+              StatusIs(StatusCode::kInvalidArgument));
+  EXPECT_THAT(
+      Status(iree_vm_list_get_ref_ptrs(list, 0, 3, test_b_type(), out_ptrs)),
+      StatusIs(StatusCode::kInvalidArgument));
+
+  iree_vm_list_release(list);
+}
+
 // TODO(benvanik): test primitive variant get/set.
 
 // TODO(benvanik): test ref variant get/set.
@@ -6,13 +6,140 @@
 
 #include "iree/base/api.h"
 #include "iree/testing/benchmark.h"
+#include "iree/vm/context.h"
+#include "iree/vm/instance.h"
 #include "iree/vm/module.h"
 #include "iree/vm/native_module.h"
 #include "iree/vm/native_module_test.h"
+#include "iree/vm/shims.h"
 #include "iree/vm/stack.h"
 
 namespace {
 
-// TODO(benvanik): native module benchmarks.
+//===----------------------------------------------------------------------===//
+// shim_module
+//===----------------------------------------------------------------------===//
+// Exports the same function through a shared per-signature shim (as used by
+// most modules built on shims.h) and through a shim specialized for the export
+// with IREE_VM_ABI_DEFINE_EXPORT_SHIM.
+
+typedef struct shim_module_state_t shim_module_state_t;
+
+IREE_VM_ABI_EXPORT(shim_module_add_1, shim_module_state_t, i, i) {
+  rets->i0 = args->i0 + 1;
+  return iree_ok_status();
+}
+
+// Stands in for the shared shims in shims.c: out-of-line and only reachable
+// through the function table.
+static IREE_ATTRIBUTE_NOINLINE IREE_VM_ABI_DEFINE_SHIM(i, i);
+
+IREE_VM_ABI_DEFINE_EXPORT_SHIM(shim_module_add_1, shim_module_state_t, i, i);
+
+static const iree_vm_native_export_descriptor_t shim_module_exports_[] = {
+    {IREE_SV("add_1_export_shim"), IREE_SV("0i_i"), 0, NULL},
+    {IREE_SV("add_1_shared_shim"), IREE_SV("0i_i"), 0, NULL},
+};
+static const iree_vm_native_function_ptr_t shim_module_funcs_[] = {
+    {(iree_vm_native_function_shim_t)shim_module_add_1_shim, NULL},
+    {(iree_vm_native_function_shim_t)iree_vm_shim_i_i,
+     (iree_vm_native_function_target_t)shim_module_add_1},
+};
+static_assert(IREE_ARRAYSIZE(shim_module_funcs_) ==
+                  IREE_ARRAYSIZE(shim_module_exports_),
+              "function pointer table must be 1:1 with exports");
+static const iree_vm_native_module_descriptor_t shim_module_descriptor_ = {
+    /*name=*/IREE_SV("shim_module"),
+    /*version=*/0,
+    /*attr_count=*/0,
+    /*attrs=*/NULL,
+    /*dependency_count=*/0,
+    /*dependencies=*/NULL,
+    /*import_count=*/0,
+    /*imports=*/NULL,
+    /*export_count=*/IREE_ARRAYSIZE(shim_module_exports_),
+    /*exports=*/shim_module_exports_,
+    /*function_count=*/IREE_ARRAYSIZE(shim_module_funcs_),
+    /*functions=*/shim_module_funcs_,
+};
+
+static iree_status_t shim_module_create(iree_vm_instance_t* instance,
+                                        iree_allocator_t allocator,
+                                        iree_vm_module_t** out_module) {
+  iree_vm_module_t interface;
+  IREE_RETURN_IF_ERROR(iree_vm_module_initialize(&interface, NULL));
+  return iree_vm_native_module_create(&interface, &shim_module_descriptor_,
+                                      instance, allocator, out_module);
+}
+
+// Benchmarks calling |function_name| with an i32 argument and result.
+// The function is resolved once outside of the timed loop as an application
+// would and each iteration measures begin_call through the native shim.
+static iree_status_t RunFunction(iree_benchmark_state_t* benchmark_state,
+                                 iree_string_view_t function_name) {
+  iree_vm_instance_t* instance = NULL;
+  IREE_CHECK_OK(iree_vm_instance_create(IREE_VM_TYPE_CAPACITY_DEFAULT,
+                                        iree_allocator_system(), &instance));
+
+  iree_vm_module_t* module_a = NULL;
+  IREE_CHECK_OK(module_a_create(instance, iree_allocator_system(), &module_a));
+  iree_vm_module_t* module_b = NULL;
+  IREE_CHECK_OK(module_b_create(instance, iree_allocator_system(), &module_b));
+  iree_vm_module_t* shim_module = NULL;
+  IREE_CHECK_OK(
+      shim_module_create(instance, iree_allocator_system(), &shim_module));
+
+  iree_vm_module_t* modules[3] = {module_a, module_b, shim_module};
+  iree_vm_context_t* context = NULL;
+  IREE_CHECK_OK(iree_vm_context_create_with_modules(
+      instance, IREE_VM_CONTEXT_FLAG_NONE, IREE_ARRAYSIZE(modules), modules,
+      iree_allocator_system(), &context));
+  iree_vm_module_release(module_a);
+  iree_vm_module_release(module_b);
+  iree_vm_module_release(shim_module);
+
+  iree_vm_function_t function;
+  IREE_CHECK_OK(
+      iree_vm_context_resolve_function(context, function_name, &function));
+
+  IREE_VM_INLINE_STACK_INITIALIZE(stack, IREE_VM_INVOCATION_FLAG_NONE,
+                                  iree_vm_context_state_resolver(context),
+                                  iree_allocator_system());
+  int32_t value = 0;
+  while (iree_benchmark_keep_running(benchmark_state, 1)) {
+    IREE_CHECK_OK(call_import_i32_i32(stack, &function, value, &value));
+    iree_optimization_barrier(value);
+  }
+  iree_vm_stack_deinitialize(stack);
+
+  iree_vm_context_release(context);
+  iree_vm_instance_release(instance);
+  return iree_ok_status();
+}
+
+// Measures the overhead of a single call into a native function.
+IREE_BENCHMARK_FN(BM_CallNativeFunc) {
+  return RunFunction(benchmark_state, IREE_SV("module_a.add_1"));
+}
+IREE_BENCHMARK_REGISTER(BM_CallNativeFunc);
+
+// Measures a native function that itself makes two calls to resolved imports
+// in another native module.
+IREE_BENCHMARK_FN(BM_CallNativeFuncWithImports) {
+  return RunFunction(benchmark_state, IREE_SV("module_b.entry"));
+}
+IREE_BENCHMARK_REGISTER(BM_CallNativeFuncWithImports);
+
+// Measures a call through the shared per-signature shim for `(i32)->i32`.
+IREE_BENCHMARK_FN(BM_CallNativeFuncSharedShim) {
+  return RunFunction(benchmark_state, IREE_SV("shim_module.add_1_shared_shim"));
+}
+IREE_BENCHMARK_REGISTER(BM_CallNativeFuncSharedShim);
+
+// Measures the same call through a shim specialized for the export.
+IREE_BENCHMARK_FN(BM_CallNativeFuncExportShim) {
+  return RunFunction(benchmark_state, IREE_SV("shim_module.add_1_export_shim"));
+}
+IREE_BENCHMARK_REGISTER(BM_CallNativeFuncExportShim);
 
 }  // namespace
@@ -159,5 +159,54 @@ TEST_F(VMNativeModuleTest, Fork) {
   iree_vm_context_release(child_context);
 }
 
+// Tests that a reusable invoker produces the same results as iree_vm_invoke
+// and does not allocate once initialized.
+TEST_F(VMNativeModuleTest, Invoker) {
+  iree_vm_context_t* context = CreateContext();
+
+  iree_vm_function_t function;
+  IREE_ASSERT_OK(iree_vm_context_resolve_function(
+      context, iree_make_cstring_view("module_b.entry"), &function));
+
+  // Counts all allocations made through the allocator and forwards them to the
+  // system allocator.
+  int allocation_count = 0;
+  iree_allocator_t counting_allocator = {
+      /*.self=*/&allocation_count,
+      /*.ctl=*/
+      +[](void* self, iree_allocator_command_t command, const void* params,
+          void** inout_ptr) {
+        if (command != IREE_ALLOCATOR_COMMAND_FREE) ++*(int*)self;
+        iree_allocator_t system_allocator = iree_allocator_system();
+        return system_allocator.ctl(system_allocator.self, command, params,
+                                    inout_ptr);
+      },
+  };
+
+  iree_vm_invoker_t invoker;
+  IREE_ASSERT_OK(iree_vm_invoker_initialize(context, function,
+                                            IREE_VM_INVOCATION_FLAG_NONE,
+                                            counting_allocator, &invoker));
+  ASSERT_EQ(iree_vm_list_size(iree_vm_invoker_inputs(&invoker)), 1);
+  allocation_count = 0;
+
+  // Matches the sequence in the Example test as the invocations share state.
+  const int32_t expected_values[] = {1, 4, 8};
+  for (size_t i = 0; i < IREE_ARRAYSIZE(expected_values); ++i) {
+    iree_vm_value_t arg0_value = iree_vm_value_make_i32((int32_t)i + 1);
+    IREE_ASSERT_OK(iree_vm_list_set_value(iree_vm_invoker_inputs(&invoker), 0,
+                                          &arg0_value));
+    IREE_ASSERT_OK(iree_vm_invoker_invoke(&invoker));
+    iree_vm_value_t ret0_value;
+    IREE_ASSERT_OK(iree_vm_list_get_value(iree_vm_invoker_outputs(&invoker), 0,
+                                          &ret0_value));
+    EXPECT_EQ(ret0_value.i32, expected_values[i]);
+  }
+  EXPECT_EQ(allocation_count, 0);
+
+  iree_vm_invoker_deinitialize(&invoker);
+  iree_vm_context_release(context);
+}
+
 }  // namespace
 }  // namespace iree
@@ -100,6 +100,39 @@ typedef iree_status_t(IREE_API_PTR* iree_vm_native_function_target2_t)(
     return target_fn(stack, module, module_state, args, rets);                 \
   }
 
+// Defines a shim specialized for the single export |target_fn| previously
+// defined with IREE_VM_ABI_EXPORT using the same types.
+//
+// The generic shims from IREE_VM_ABI_DEFINE_SHIM are shared by all functions
+// with the same signature and make an indirect call through the target
+// function pointer stored in the module function table. Specialized shims call
+// |target_fn| directly with its declared argument and result struct types:
+// mismatches between the export table and the function definition are caught
+// at compile time and the target may be inlined into the shim. The shim is
+// named `<target_fn>_shim` and ignores the target function pointer passed by
+// the native module.
+#define IREE_VM_ABI_DEFINE_EXPORT_SHIM(target_fn, module_state, arg_types,    \
+                                       ret_types)                             \
+  static iree_status_t target_fn##_shim(                                      \
+      iree_vm_stack_t* IREE_RESTRICT stack,                                   \
+      iree_vm_native_function_flags_t flags, iree_byte_span_t args_storage,   \
+      iree_byte_span_t rets_storage,                                          \
+      iree_vm_native_function_target2_t unused_target_fn,                     \
+      void* IREE_RESTRICT module, void* IREE_RESTRICT state) {                \
+    IREE_VM_ABI_TYPE_NAME(arg_types)* args =                                  \
+        iree_vm_abi_##arg_types##_checked_deref(args_storage);                \
+    IREE_VM_ABI_TYPE_NAME(ret_types)* rets =                                  \
+        iree_vm_abi_##ret_types##_checked_deref(rets_storage);                \
+    if (IREE_UNLIKELY(                                                        \
+            !((flags & IREE_VM_NATIVE_FUNCTION_CALL_RESUME) || args) ||       \
+            !rets)) {                                                         \
+      return iree_make_status(IREE_STATUS_INVALID_ARGUMENT,                   \
+                              "argument/result signature mismatch");          \
+    }                                                                         \
+    iree_vm_abi_##ret_types##_reset(rets);                                    \
+    return target_fn(stack, module, (module_state*)state, args, rets);        \
+  }
+
 #define IREE_VM_ABI_EXPORT(function_name, module_state, arg_types, ret_types) \
   static iree_status_t function_name(                                         \
       iree_vm_stack_t* IREE_RESTRICT stack, void* IREE_RESTRICT module,       \
@@ -328,6 +361,16 @@ IREE_VM_ABI_FIXED_STRUCT(riiI, {
   int64_t i3;
 });
 
+IREE_VM_ABI_FIXED_STRUCT(iiiiiiI, {
+  int32_t i0;
+  int32_t i1;
+  int32_t i2;
+  int32_t i3;
+  int32_t i4;
+  int32_t i5;
+  int64_t i6;
+});
+
 IREE_VM_ABI_FIXED_STRUCT(iirII, {
   int32_t i0;
   int32_t i1;
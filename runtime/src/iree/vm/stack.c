@@ -113,6 +113,20 @@
 // but otherwise leave as small as we can to avoid overallocation.
 #define IREE_VM_STACK_GROWTH_FACTOR 2
 
+// Heap storage reserved by a frame to receive the results of a callee that
+// yielded before returning. Stored outside of the frames so that the frame
+// layout (and the alignment of frame storage) is unchanged.
+typedef struct iree_vm_stack_yield_results_t {
+  // Next reserved storage in the stack ordered by descending depth.
+  struct iree_vm_stack_yield_results_t* next;
+  // Depth of the frame that reserved the storage.
+  int32_t depth;
+  // Size, in bytes, of the |data| storage.
+  iree_host_size_t size;
+  // Results storage as passed to the callee when it is resumed.
+  uint8_t data[];
+} iree_vm_stack_yield_results_t;
+
 // A private stack frame header that allows us to walk the linked list of
 // frames without exposing their exact structure through the API. This makes it
 // easier for us to add/version additional information or hide implementation
@@ -157,6 +171,10 @@ struct iree_vm_stack_t {
   // updating.
   iree_vm_stack_frame_header_t* top;
 
+  // Results storage reserved by frames with a pending yielded call ordered by
+  // descending frame depth. Usually NULL.
+  iree_vm_stack_yield_results_t* yield_results;
+
   // Base pointer to stack storage.
   // For statically-allocated stacks this will (likely) point to immediately
   // after the iree_vm_stack_t in memory. For dynamically-allocated stacks this
@@ -215,6 +233,7 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_initialize(
   stack->frame_storage = storage.data + storage_offset;
 
   stack->top = NULL;
+  stack->yield_results = NULL;
 
   *out_stack = stack;
 
@@ -320,6 +339,20 @@ IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_parent_frame(
   return parent_header ? &parent_header->frame : NULL;
 }
 
+IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_frame_at_depth(
+    iree_vm_stack_t* stack, int32_t depth) {
+  for (iree_vm_stack_frame_header_t* header = stack->top; header != NULL;
+       header = header->parent) {
+    if (header->frame.depth == depth &&
+        header->frame.type != IREE_VM_STACK_FRAME_WAIT) {
+      return &header->frame;
+    } else if (header->frame.depth < depth) {
+      break;
+    }
+  }
+  return NULL;
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_stack_query_module_state(
     iree_vm_stack_t* stack, iree_vm_module_t* module,
     iree_vm_module_state_t** out_module_state) {
@@ -568,7 +601,10 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
   iree_vm_stack_frame_header_t* frame_header =
       (iree_vm_stack_frame_header_t*)((uintptr_t)stack->frame_storage +
                                       stack->frame_storage_size);
-  memset(frame_header, 0, header_size + frame_size);
+  // Only the header is initialized: callers requesting frame storage know
+  // which portions of it need initialization (if any) and can avoid clearing
+  // large register files that will be written before they are read.
+  memset(frame_header, 0, header_size);
 
   frame_header->frame_size = header_size + frame_size;
   frame_header->parent = stack->top;
@@ -610,6 +646,11 @@ iree_vm_stack_function_leave(iree_vm_stack_t* stack) {
     stack->top->frame_cleanup_fn(&stack->top->frame);
   }
 
+  // Drop results storage of a yielded call that was never resumed.
+  if (IREE_UNLIKELY(stack->yield_results)) {
+    iree_vm_stack_frame_release_yield_results(stack, &stack->top->frame);
+  }
+
   IREE_TRACE({
     if (stack->top->trace_zone) {
       IREE_TRACE_ZONE_END(stack->top->trace_zone);
@@ -623,6 +664,89 @@ iree_vm_stack_function_leave(iree_vm_stack_t* stack) {
   return iree_ok_status();
 }
 
+// Returns the results storage reserved for a yielded call made by the frame at
+// |depth| or NULL if none has been reserved.
+static iree_vm_stack_yield_results_t* iree_vm_stack_find_yield_results(
+    iree_vm_stack_t* stack, int32_t depth) {
+  for (iree_vm_stack_yield_results_t* yield_results = stack->yield_results;
+       yield_results != NULL; yield_results = yield_results->next) {
+    if (yield_results->depth == depth) return yield_results;
+    if (yield_results->depth < depth) break;
+  }
+  return NULL;
+}
+
+IREE_API_EXPORT iree_status_t iree_vm_stack_frame_reserve_yield_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame,
+    iree_host_size_t size, iree_byte_span_t* out_results) {
+  IREE_ASSERT_ARGUMENT(stack);
+  IREE_ASSERT_ARGUMENT(frame);
+  IREE_ASSERT_ARGUMENT(out_results);
+  *out_results = iree_byte_span_empty();
+
+  // The list is sorted by descending depth. Callers reserve storage as the
+  // deferral propagates down the stack so the insertion point is almost always
+  // the head.
+  iree_vm_stack_yield_results_t** insert_ptr = &stack->yield_results;
+  while (*insert_ptr && (*insert_ptr)->depth > frame->depth) {
+    insert_ptr = &(*insert_ptr)->next;
+  }
+  if (IREE_UNLIKELY(*insert_ptr && (*insert_ptr)->depth == frame->depth)) {
+    return iree_make_status(IREE_STATUS_FAILED_PRECONDITION,
+                            "frame already has a yielded call pending");
+  }
+
+  iree_vm_stack_yield_results_t* yield_results = NULL;
+  IREE_RETURN_IF_ERROR(iree_allocator_malloc(
+      stack->allocator, sizeof(*yield_results) + size, (void**)&yield_results));
+  yield_results->next = *insert_ptr;
+  yield_results->depth = frame->depth;
+  yield_results->size = size;
+  memset(yield_results->data, 0, size);
+  *insert_ptr = yield_results;
+
+  *out_results = iree_make_byte_span(yield_results->data, size);
+  return iree_ok_status();
+}
+
+IREE_API_EXPORT iree_byte_span_t iree_vm_stack_frame_yield_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame) {
+  IREE_ASSERT_ARGUMENT(stack);
+  IREE_ASSERT_ARGUMENT(frame);
+  iree_vm_stack_yield_results_t* yield_results =
+      iree_vm_stack_find_yield_results(stack, frame->depth);
+  return yield_results
+             ? iree_make_byte_span(yield_results->data, yield_results->size)
+             : iree_byte_span_empty();
+}
+
+IREE_API_EXPORT void iree_vm_stack_frame_release_yield_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame) {
+  IREE_ASSERT_ARGUMENT(stack);
+  IREE_ASSERT_ARGUMENT(frame);
+  iree_vm_stack_yield_results_t** yield_results_ptr = &stack->yield_results;
+  while (*yield_results_ptr) {
+    iree_vm_stack_yield_results_t* yield_results = *yield_results_ptr;
+    if (yield_results->depth == frame->depth) {
+      *yield_results_ptr = yield_results->next;
+      iree_allocator_free(stack->allocator, yield_results);
+      return;
+    }
+    yield_results_ptr = &yield_results->next;
+  }
+}
+
+IREE_API_EXPORT iree_byte_span_t iree_vm_stack_frame_resume_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame) {
+  IREE_ASSERT_ARGUMENT(stack);
+  IREE_ASSERT_ARGUMENT(frame);
+  iree_vm_stack_yield_results_t* yield_results =
+      iree_vm_stack_find_yield_results(stack, frame->depth - 1);
+  return yield_results
+             ? iree_make_byte_span(yield_results->data, yield_results->size)
+             : iree_byte_span_empty();
+}
+
 IREE_API_EXPORT iree_status_t iree_vm_stack_format_backtrace(
     iree_vm_stack_t* stack, iree_string_builder_t* builder) {
   for (iree_vm_stack_frame_header_t* frame = stack->top; frame != NULL;
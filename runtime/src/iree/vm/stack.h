@@ -49,6 +49,13 @@ enum iree_vm_invocation_flag_bits_t {
   // Attributes invocation timings to the caller instead of a context or
   // invocation-specific fiber.
   IREE_VM_INVOCATION_FLAG_TRACE_INLINE = 1u << 1,
+
+  // Indicates that the invoker resumes the invocation from a scheduler (such
+  // as iree_vm_async_invoke) and that callees may yield on waits instead of
+  // blocking the calling thread. Callers that issue calls without handling
+  // IREE_STATUS_DEFERRED (such as module initializers) leave this unset and
+  // modules should block when performing waits.
+  IREE_VM_INVOCATION_FLAG_ASYNC = 1u << 2,
 };
 typedef uint32_t iree_vm_invocation_flags_t;
 
@@ -259,6 +266,11 @@ IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_current_frame(
 IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_parent_frame(
     iree_vm_stack_t* stack);
 
+// Returns the frame at |depth| in the stack or NULL if the stack is not that
+// deep. Wait frames are never returned.
+IREE_API_EXPORT iree_vm_stack_frame_t* iree_vm_stack_frame_at_depth(
+    iree_vm_stack_t* stack, int32_t depth);
+
 // Queries the context-specific module state for the given module.
 IREE_API_EXPORT iree_status_t iree_vm_stack_query_module_state(
     iree_vm_stack_t* stack, iree_vm_module_t* module,
@@ -296,9 +308,11 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_wait_leave(
 // assumed valid after return is the one in |out_callee_frame|.
 //
 // |frame_size| can optionally be used to allocate storage within the stack for
-// callee data. |frame_cleanup_fn| will be called when the frame is left either
-// normally via an iree_vm_stack_function_leave call or if an error occurs and
-// the stack needs to be torn down.
+// callee data. The storage is uninitialized and callers must initialize any
+// portions they may read before writing them. |frame_cleanup_fn| will be
+// called when the frame is left either normally via an
+// iree_vm_stack_function_leave call or if an error occurs and the stack needs
+// to be torn down.
 IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
     iree_vm_stack_t* stack, const iree_vm_function_t* function,
     iree_vm_stack_frame_type_t frame_type, iree_host_size_t frame_size,
@@ -309,6 +323,35 @@ IREE_API_EXPORT iree_status_t iree_vm_stack_function_enter(
 IREE_API_EXPORT iree_status_t
 iree_vm_stack_function_leave(iree_vm_stack_t* stack);
 
+// Reserves |size| bytes of zeroed storage on |frame| that will receive the
+// results of a call made by |frame| that yielded before returning. The storage
+// is owned by the stack and remains valid (and at the same address) until
+// released with iree_vm_stack_frame_release_yield_results or |frame| is left.
+//
+// When the invocation is resumed the callee is passed this storage as its
+// |call_results| (see iree_vm_stack_frame_resume_results) and the caller reads
+// the results out of it when it is itself resumed. Results containing refs must
+// be moved out by the caller: releasing the storage does not release them.
+IREE_API_EXPORT iree_status_t iree_vm_stack_frame_reserve_yield_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame,
+    iree_host_size_t size, iree_byte_span_t* out_results);
+
+// Returns the storage reserved on |frame| with
+// iree_vm_stack_frame_reserve_yield_results or an empty span if none.
+IREE_API_EXPORT iree_byte_span_t iree_vm_stack_frame_yield_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame);
+
+// Releases the storage reserved on |frame|, if any.
+IREE_API_EXPORT void iree_vm_stack_frame_release_yield_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame);
+
+// Returns the storage that |frame| must write its results into when resumed
+// after a yield. This is the storage reserved by the caller of |frame| or an
+// empty span if the caller reserved none, such as when |frame| was called
+// from external code that provides its own results storage.
+IREE_API_EXPORT iree_byte_span_t iree_vm_stack_frame_resume_results(
+    iree_vm_stack_t* stack, iree_vm_stack_frame_t* frame);
+
 // Formats a backtrace of the current stack to the given string |builder|.
 IREE_API_EXPORT iree_status_t iree_vm_stack_format_backtrace(
     iree_vm_stack_t* stack, iree_string_builder_t* builder);
@@ -50,4 +50,25 @@ vm.module @async_ops {
     vm.return %result : i32
   }
 
+  //===--------------------------------------------------------------------===//
+  // Yielding imports
+  //===--------------------------------------------------------------------===//
+
+  // Native import provided by the test that yields on a wait before returning
+  // %arg0 + %arg1.
+  vm.import private @yieldable_test.yield_add(%arg0: i32, %arg1: i32) -> i32
+
+  // Tests an import call that yields before producing its result and that the
+  // result is available to the caller after it is resumed.
+  //
+  // Expects a result of %arg0 + 5 + 1.
+  vm.export @call_yieldable_import
+  vm.func @call_yieldable_import(%arg0: i32) -> i32 {
+    %c1 = vm.const.i32 1
+    %c5 = vm.const.i32 5
+    %0 = vm.call @yieldable_test.yield_add(%arg0, %c5) : (i32, i32) -> i32
+    %1 = vm.add.i32 %0, %c1 : i32
+    vm.return %1 : i32
+  }
+
 }
@@ -134,3 +134,32 @@ func.func @scan_2d_dim1_inclusive_sum() {
 
   return
 }
+
+func.func @scan_1d_dim0_inclusive_sum_large() {
+  %input = util.unfoldable_constant dense<1> : tensor<8192xi32>
+
+  %init = tensor.empty() : tensor<8192xi32>
+  %t0 = util.unfoldable_constant dense<0> : tensor<i32>
+  %0:2 = iree_linalg_ext.scan
+         dimension(0) inclusive(true)
+         ins(%input : tensor<8192xi32>)
+         outs(%init, %t0 : tensor<8192xi32>, tensor<i32>) {
+           ^bb0(%arg0 : i32, %arg1 : i32):
+             %sum = arith.addi %arg0, %arg1 : i32
+             iree_linalg_ext.yield %sum : i32
+         } -> tensor<8192xi32>, tensor<i32>
+
+  // Samples elements on either side of a chunk boundary.
+  %slice = tensor.extract_slice %0#0[511] [2] [1] : tensor<8192xi32> to tensor<2xi32>
+  check.expect_eq_const(
+      %slice,
+      dense<[512, 513]> : tensor<2xi32>
+  ) : tensor<2xi32>
+
+  check.expect_eq_const(
+      %0#1,
+      dense<8192> : tensor<i32>
+  ) : tensor<i32>
+
+  return
+}
@@ -52,9 +52,13 @@
 // an appropriate device-specific tool before trusting the more generic and
 // higher-level numbers from this tool.
 
+#include <algorithm>
 #include <array>
+#include <cinttypes>
 #include <cstdio>
+#include <cstring>
 #include <iterator>
+#include <random>
 #include <string>
 #include <type_traits>
 #include <utility>
@@ -63,6 +67,7 @@
 #include "benchmark/benchmark.h"
 #include "iree/base/api.h"
 #include "iree/base/internal/flags.h"
+#include "iree/base/internal/math.h"
 #include "iree/hal/api.h"
 #include "iree/modules/hal/types.h"
 #include "iree/tooling/context_util.h"
@@ -89,7 +94,8 @@ IREE_FLAG(string, function, "",
           "benchmarked and they are expected to not have input arguments.");
 
 IREE_FLAG(bool, print_statistics, false,
-          "Prints runtime statistics to stderr on exit.");
+          "Prints runtime statistics to stderr on exit and reports the peak\n"
+          "transient memory of each invocation as a benchmark counter.");
 
 IREE_FLAG_LIST(
     string, input,
@@ -105,6 +111,25 @@ IREE_FLAG_LIST(
     "Each occurrence of the flag indicates an input in the order they were\n"
     "specified on the command line.");
 
+IREE_FLAG(double, load_rate, 0.0,
+          "Target arrival rate in invocations per second. When set the "
+          "function specified by --function= is run as an open-loop load "
+          "generator instead of being benchmarked and latency percentiles are "
+          "reported as JSON. The function must use the coarse-fences ABI "
+          "(compile with --iree-execution-model=async-external).");
+IREE_FLAG(int32_t, load_concurrency, 4,
+          "Maximum number of invocations in flight when generating load. "
+          "Arrivals beyond this are queued and the time spent queued is "
+          "included in their latency.");
+IREE_FLAG(int32_t, load_requests, 1000,
+          "Total number of invocations issued when generating load.");
+IREE_FLAG(bool, load_poisson, false,
+          "Uses exponentially distributed inter-arrival times (a Poisson "
+          "process) instead of uniformly spaced arrivals.");
+IREE_FLAG(string, load_output, "-",
+          "File the load generation JSON report is written to or `-` for "
+          "stdout.");
+
 static iree_status_t parse_time_unit(iree_string_view_t flag_name,
                                      void* storage, iree_string_view_t value) {
   auto* unit = (std::pair<bool, benchmark::TimeUnit>*)storage;
@@ -171,6 +196,16 @@ static void BenchmarkGenericFunction(const std::string& benchmark_name,
   IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 16,
                                     iree_allocator_system(), &outputs));
 
+  // Capture the memory allocated by the invocations. As invocations are
+  // sequential the peak across all of them is the peak of a single invocation.
+  iree_hal_allocator_t* device_allocator =
+      device && FLAG_print_statistics ? iree_hal_device_allocator(device)
+                                      : nullptr;
+  iree_hal_allocator_capture_t allocator_capture;
+  if (device_allocator) {
+    iree_hal_allocator_begin_capture(device_allocator, &allocator_capture);
+  }
+
   // Benchmarking loop.
   while (state.KeepRunningBatch(batch_size)) {
     IREE_TRACE_ZONE_BEGIN_NAMED(z1, "BenchmarkIteration");
@@ -188,6 +223,12 @@ static void BenchmarkGenericFunction(const std::string& benchmark_name,
   }
   state.SetItemsProcessed(state.iterations());
 
+  if (device_allocator) {
+    iree_hal_allocator_end_capture(device_allocator, &allocator_capture);
+    state.counters["transient_peak_bytes"] = benchmark::Counter(
+        (double)iree_hal_allocator_capture_transient_peak(&allocator_capture));
+  }
+
   IREE_TRACE_ZONE_END(z0);
 }
 
@@ -403,14 +444,97 @@ static void BenchmarkDispatchFunction(const std::string& benchmark_name,
   IREE_TRACE_ZONE_END(z0);
 }
 
+// Benchmarks a dispatch function using the coarse-fences ABI:
+//   (i32 batch_size, !hal.fence wait, !hal.fence signal) -> ()
+// Each invocation is chained to the previous one on the device and the host
+// only waits for the prior invocation after submitting the next such that one
+// submission is always queued behind the one executing. This hides submission
+// and host synchronization latency from the reported time.
+static void BenchmarkAsyncDispatchFunction(const std::string& benchmark_name,
+                                           iree_hal_device_t* device,
+                                           iree_vm_context_t* context,
+                                           iree_vm_function_t function,
+                                           benchmark::State& state) {
+  IREE_TRACE_ZONE_BEGIN_NAMED_DYNAMIC(z0, benchmark_name.data(),
+                                      benchmark_name.size());
+  IREE_TRACE_FRAME_MARK();
+  iree_allocator_t host_allocator = iree_allocator_system();
+
+  vm::ref<iree_hal_semaphore_t> timeline_semaphore;
+  IREE_CHECK_OK(iree_hal_semaphore_create(
+      device, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &timeline_semaphore));
+  uint64_t timeline_value = 0ull;
+
+  vm::ref<iree_vm_list_t> inputs;
+  IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 16,
+                                    host_allocator, &inputs));
+  vm::ref<iree_vm_list_t> outputs;
+  IREE_CHECK_OK(iree_vm_list_create(iree_vm_make_undefined_type_def(), 16,
+                                    host_allocator, &outputs));
+
+  // Benchmarking loop.
+  vm::ref<iree_hal_fence_t> pending_fence;
+  while (state.KeepRunningBatch(FLAG_batch_size)) {
+    IREE_TRACE_ZONE_BEGIN_NAMED(z1, "BenchmarkIteration");
+    IREE_TRACE_FRAME_MARK_NAMED("Iteration");
+
+    vm::ref<iree_hal_fence_t> signal_fence;
+    IREE_CHECK_OK(iree_hal_fence_create_at(timeline_semaphore.get(),
+                                           ++timeline_value, host_allocator,
+                                           &signal_fence));
+    IREE_CHECK_OK(iree_vm_list_resize(inputs.get(), 0));
+    iree_vm_value_t batch_size = iree_vm_value_make_i32(FLAG_batch_size);
+    IREE_CHECK_OK(iree_vm_list_push_value(inputs.get(), &batch_size));
+    vm::ref<iree_hal_fence_t> wait_fence = vm::retain_ref(pending_fence);
+    IREE_CHECK_OK(iree_vm_list_push_ref_move(inputs.get(), wait_fence));
+    vm::ref<iree_hal_fence_t> invocation_signal_fence =
+        vm::retain_ref(signal_fence);
+    IREE_CHECK_OK(
+        iree_vm_list_push_ref_move(inputs.get(), invocation_signal_fence));
+    IREE_CHECK_OK(iree_vm_invoke(context, function,
+                                 IREE_VM_INVOCATION_FLAG_NONE,
+                                 /*policy=*/nullptr, inputs.get(),
+                                 outputs.get(), host_allocator));
+    IREE_CHECK_OK(iree_vm_list_resize(outputs.get(), 0));
+
+    // Wait for the previous invocation while the one just submitted is
+    // queued behind it.
+    if (pending_fence) {
+      IREE_CHECK_OK(
+          iree_hal_fence_wait(pending_fence.get(), iree_infinite_timeout()));
+    }
+    pending_fence = std::move(signal_fence);
+
+    IREE_TRACE_ZONE_END(z1);
+  }
+  if (pending_fence) {
+    IREE_CHECK_OK(
+        iree_hal_fence_wait(pending_fence.get(), iree_infinite_timeout()));
+  }
+  state.SetItemsProcessed(state.iterations());
+
+  IREE_TRACE_ZONE_END(z0);
+}
+
 void RegisterDispatchBenchmark(const std::string& function_name,
+                               iree_hal_device_t* device,
                                iree_vm_context_t* context,
                                iree_vm_function_t function) {
   auto benchmark_name = "BM_" + function_name;
+  iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
+      &function, IREE_SV("iree.abi.model"));
+  bool is_async =
+      iree_string_view_equal(invocation_model, IREE_SV("coarse-fences"));
   benchmark::RegisterBenchmark(
       benchmark_name.c_str(),
-      [benchmark_name, context, function](benchmark::State& state) -> void {
-        BenchmarkDispatchFunction(benchmark_name, context, function, state);
+      [benchmark_name, device, context, function,
+       is_async](benchmark::State& state) -> void {
+        if (is_async) {
+          BenchmarkAsyncDispatchFunction(benchmark_name, device, context,
+                                         function, state);
+        } else {
+          BenchmarkDispatchFunction(benchmark_name, context, function, state);
+        }
       })
       // By default only the main thread is included in CPU time. Include all
       // the threads instead.
@@ -423,6 +547,254 @@ void RegisterDispatchBenchmark(const std::string& function_name,
                                   : benchmark::kMicrosecond);
 }
 
+// Log-linear histogram of latencies in nanoseconds in the style of
+// HdrHistogram. Values are bucketed by their power of two and each power of two
+// is split into linear sub-buckets, bounding the relative error of reported
+// values to 2^-(kSubBucketBits - 1) (under 2%) independent of magnitude.
+class LatencyHistogram {
+ public:
+  LatencyHistogram() : counts_(kBucketCount, 0) {}
+
+  int64_t count() const { return count_; }
+  int64_t min() const { return count_ ? min_ : 0; }
+  int64_t max() const { return max_; }
+  double mean() const { return count_ ? (double)sum_ / count_ : 0.0; }
+
+  void Record(int64_t value) {
+    value = value < 0 ? 0 : value;
+    ++counts_[GetBucketIndex((uint64_t)value)];
+    min_ = count_ ? std::min(min_, value) : value;
+    max_ = std::max(max_, value);
+    sum_ += value;
+    ++count_;
+  }
+
+  // Returns the highest value equivalent to the value at |percentile| in
+  // [0, 100], clamped to the largest recorded value.
+  int64_t ValueAtPercentile(double percentile) const {
+    if (!count_) return 0;
+    int64_t rank = (int64_t)((percentile / 100.0) * count_ + 0.5);
+    rank = std::max<int64_t>(1, std::min(rank, count_));
+    int64_t seen = 0;
+    for (size_t i = 0; i < counts_.size(); ++i) {
+      seen += counts_[i];
+      if (seen >= rank) {
+        return std::min<int64_t>(GetBucketHighestValue(i), max_);
+      }
+    }
+    return max_;
+  }
+
+ private:
+  static constexpr int kSubBucketBits = 7;
+  static constexpr uint64_t kSubBucketCount = 1ull << kSubBucketBits;
+  static constexpr size_t kBucketCount = (64 - kSubBucketBits + 2)
+                                         << (kSubBucketBits - 1);
+
+  // Values below kSubBucketCount map to themselves. Larger values keep their
+  // top kSubBucketBits bits and are grouped by the number of bits dropped.
+  static size_t GetBucketIndex(uint64_t value) {
+    if (value < kSubBucketCount) return (size_t)value;
+    int shift = (63 - iree_math_count_leading_zeros_u64(value)) -
+                kSubBucketBits + 1;
+    return ((size_t)shift << (kSubBucketBits - 1)) + (size_t)(value >> shift);
+  }
+  static int64_t GetBucketHighestValue(size_t index) {
+    if (index < kSubBucketCount) return (int64_t)index;
+    int shift = (int)(index >> (kSubBucketBits - 1)) - 1;
+    uint64_t top = index - ((size_t)shift << (kSubBucketBits - 1));
+    return (int64_t)(((top + 1) << shift) - 1);
+  }
+
+  std::vector<int64_t> counts_;
+  int64_t count_ = 0;
+  int64_t min_ = 0;
+  int64_t max_ = 0;
+  int64_t sum_ = 0;
+};
+
+// Writes the load generation report as JSON to |file|.
+static void PrintLoadReport(FILE* file, const std::string& function_name,
+                            int32_t concurrency, iree_duration_t duration_ns,
+                            const LatencyHistogram& histogram) {
+  auto to_us = [](int64_t ns) { return ns / 1000.0; };
+  double duration_s = duration_ns / 1e9;
+  fprintf(file, "{\n");
+  fprintf(file, "  \"function\": \"%s\",\n", function_name.c_str());
+  fprintf(file, "  \"target_rate\": %.3f,\n", FLAG_load_rate);
+  fprintf(file, "  \"achieved_rate\": %.3f,\n",
+          duration_s > 0.0 ? histogram.count() / duration_s : 0.0);
+  fprintf(file, "  \"arrivals\": \"%s\",\n",
+          FLAG_load_poisson ? "poisson" : "uniform");
+  fprintf(file, "  \"concurrency\": %d,\n", concurrency);
+  fprintf(file, "  \"requests\": %" PRId64 ",\n", histogram.count());
+  fprintf(file, "  \"duration_s\": %.6f,\n", duration_s);
+  fprintf(file, "  \"latency_us\": {\n");
+  fprintf(file, "    \"min\": %.3f,\n", to_us(histogram.min()));
+  fprintf(file, "    \"mean\": %.3f,\n", histogram.mean() / 1000.0);
+  fprintf(file, "    \"p50\": %.3f,\n",
+          to_us(histogram.ValueAtPercentile(50.0)));
+  fprintf(file, "    \"p90\": %.3f,\n",
+          to_us(histogram.ValueAtPercentile(90.0)));
+  fprintf(file, "    \"p99\": %.3f,\n",
+          to_us(histogram.ValueAtPercentile(99.0)));
+  fprintf(file, "    \"p999\": %.3f,\n",
+          to_us(histogram.ValueAtPercentile(99.9)));
+  fprintf(file, "    \"max\": %.3f\n", to_us(histogram.max()));
+  fprintf(file, "  }\n");
+  fprintf(file, "}\n");
+}
+
+// Runs |function| as an open-loop load generator: invocations arrive at
+// --load_rate independent of when earlier invocations complete and up to
+// --load_concurrency of them are in flight at once. Each invocation signals
+// its own fence and the latency of an invocation is measured from its
+// scheduled arrival time to the host observing its fence, so that time spent
+// queued behind earlier invocations is included in the reported percentiles.
+static iree_status_t RunLoadGenerator(const std::string& function_name,
+                                      iree_hal_device_t* device,
+                                      iree_vm_context_t* context,
+                                      iree_vm_function_t function,
+                                      iree_vm_list_t* common_inputs) {
+  IREE_TRACE_SCOPE_NAMED("RunLoadGenerator");
+  iree_allocator_t host_allocator = iree_allocator_system();
+  if (FLAG_load_concurrency <= 0 || FLAG_load_requests <= 0) {
+    return iree_make_status(
+        IREE_STATUS_INVALID_ARGUMENT,
+        "--load_concurrency= and --load_requests= must be positive");
+  }
+  const int32_t concurrency = FLAG_load_concurrency;
+  const int64_t request_count = FLAG_load_requests;
+
+  // Each in-flight slot has its own timeline semaphore that is advanced by one
+  // for every invocation issued into the slot.
+  struct Slot {
+    vm::ref<iree_hal_semaphore_t> semaphore;
+    uint64_t pending_value = 0;
+    bool busy = false;
+    iree_time_t arrival_time = 0;
+    vm::ref<iree_vm_list_t> outputs;
+  };
+  std::vector<Slot> slots(concurrency);
+  for (auto& slot : slots) {
+    IREE_RETURN_IF_ERROR(iree_hal_semaphore_create(
+        device, 0ull, IREE_HAL_SEMAPHORE_FLAG_NONE, &slot.semaphore));
+    IREE_RETURN_IF_ERROR(iree_vm_list_create(iree_vm_make_undefined_type_def(),
+                                             16, host_allocator,
+                                             &slot.outputs));
+  }
+
+  std::mt19937_64 generator(/*seed=*/0);
+  std::exponential_distribution<double> interarrival_s(FLAG_load_rate);
+  auto next_interarrival_ns = [&]() -> iree_duration_t {
+    double seconds =
+        FLAG_load_poisson ? interarrival_s(generator) : 1.0 / FLAG_load_rate;
+    return (iree_duration_t)(seconds * 1e9);
+  };
+
+  LatencyHistogram histogram;
+  int64_t issued_count = 0;
+  int64_t completed_count = 0;
+  const iree_time_t start_time = iree_time_now();
+  iree_time_t next_arrival_time = start_time;
+  iree_time_t end_time = start_time;
+  std::vector<iree_hal_semaphore_t*> wait_semaphores;
+  std::vector<uint64_t> wait_values;
+  while (completed_count < request_count) {
+    // Retire all completed invocations.
+    for (auto& slot : slots) {
+      if (!slot.busy) continue;
+      uint64_t value = 0;
+      IREE_RETURN_IF_ERROR(
+          iree_hal_semaphore_query(slot.semaphore.get(), &value));
+      if (value < slot.pending_value) continue;
+      end_time = iree_time_now();
+      histogram.Record(end_time - slot.arrival_time);
+      iree_vm_list_clear(slot.outputs.get());
+      slot.busy = false;
+      ++completed_count;
+    }
+
+    // Issue all arrivals that are due into free slots. Arrivals that are due
+    // while all slots are busy keep their scheduled arrival time.
+    for (auto& slot : slots) {
+      if (slot.busy) continue;
+      if (issued_count >= request_count ||
+          next_arrival_time > iree_time_now()) {
+        break;
+      }
+      vm::ref<iree_vm_list_t> inputs;
+      IREE_RETURN_IF_ERROR(
+          iree_vm_list_clone(common_inputs, host_allocator, &inputs));
+      vm::ref<iree_hal_fence_t> wait_fence;
+      IREE_RETURN_IF_ERROR(
+          iree_vm_list_push_ref_move(inputs.get(), wait_fence));
+      vm::ref<iree_hal_fence_t> signal_fence;
+      IREE_RETURN_IF_ERROR(iree_hal_fence_create_at(
+          slot.semaphore.get(), slot.pending_value + 1, host_allocator,
+          &signal_fence));
+      IREE_RETURN_IF_ERROR(
+          iree_vm_list_push_ref_move(inputs.get(), signal_fence));
+      IREE_RETURN_IF_ERROR(iree_vm_invoke(
+          context, function, IREE_VM_INVOCATION_FLAG_NONE, /*policy=*/nullptr,
+          inputs.get(), slot.outputs.get(), host_allocator));
+      ++slot.pending_value;
+      slot.busy = true;
+      slot.arrival_time = next_arrival_time;
+      next_arrival_time += next_interarrival_ns();
+      ++issued_count;
+    }
+    if (completed_count >= request_count) break;
+
+    // Sleep until either an invocation completes or the next arrival is due.
+    bool has_free_slot =
+        std::any_of(slots.begin(), slots.end(),
+                    [](const Slot& slot) { return !slot.busy; });
+    iree_time_t deadline_ns = IREE_TIME_INFINITE_FUTURE;
+    if (has_free_slot && issued_count < request_count) {
+      deadline_ns = next_arrival_time;
+    }
+    wait_semaphores.clear();
+    wait_values.clear();
+    for (auto& slot : slots) {
+      if (!slot.busy) continue;
+      wait_semaphores.push_back(slot.semaphore.get());
+      wait_values.push_back(slot.pending_value);
+    }
+    if (wait_semaphores.empty()) {
+      iree_wait_until(deadline_ns);
+      continue;
+    }
+    iree_hal_semaphore_list_t wait_list = {
+        wait_semaphores.size(),
+        wait_semaphores.data(),
+        wait_values.data(),
+    };
+    iree_status_t status = iree_hal_device_wait_semaphores(
+        device, IREE_HAL_WAIT_MODE_ANY, wait_list,
+        iree_make_deadline(deadline_ns));
+    if (iree_status_is_deadline_exceeded(status)) {
+      iree_status_ignore(status);
+    } else {
+      IREE_RETURN_IF_ERROR(status);
+    }
+  }
+
+  FILE* file = stdout;
+  if (strcmp(FLAG_load_output, "-") != 0) {
+    file = fopen(FLAG_load_output, "w");
+    if (!file) {
+      return iree_make_status(IREE_STATUS_PERMISSION_DENIED,
+                              "unable to open load report file '%s'",
+                              FLAG_load_output);
+    }
+  }
+  PrintLoadReport(file, function_name, concurrency, end_time - start_time,
+                  histogram);
+  if (file != stdout) fclose(file);
+  return iree_ok_status();
+}
+
 // The lifetime of IREEBenchmark should be as long as
 // ::benchmark::RunSpecifiedBenchmarks() where the resources are used during
 // benchmarking.
@@ -466,6 +838,37 @@ class IREEBenchmark {
     return iree_ok_status();
   }
 
+  // Runs the function specified by --function= as an open-loop load generator
+  // instead of registering benchmarks.
+  iree_status_t RunLoad() {
+    IREE_TRACE_SCOPE_NAMED("IREEBenchmark::RunLoad");
+
+    if (!instance_ || !device_allocator_ || !context_ || !module_list_.count) {
+      IREE_RETURN_IF_ERROR(Init());
+    }
+
+    auto function_name = std::string(FLAG_function);
+    if (function_name.empty()) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "--function= must be specified with --load_rate=");
+    }
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(PrepareSpecificFunction(function_name, &function));
+
+    // Synchronous invocations block until complete and cannot be overlapped.
+    iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
+        &function, IREE_SV("iree.abi.model"));
+    if (!iree_string_view_equal(invocation_model, IREE_SV("coarse-fences"))) {
+      return iree_make_status(
+          IREE_STATUS_INVALID_ARGUMENT,
+          "load generation requires a function using the coarse-fences ABI; "
+          "compile with --iree-execution-model=async-external");
+    }
+    return iree::RunLoadGenerator(function_name, device_.get(), context_.get(),
+                                  function, inputs_.get());
+  }
+
  private:
   iree_status_t Init() {
     IREE_TRACE_SCOPE_NAMED("IREEBenchmark::Init");
@@ -487,9 +890,10 @@ class IREEBenchmark {
     return iree_ok_status();
   }
 
-  iree_status_t RegisterSpecificFunction(const std::string& function_name) {
-    IREE_TRACE_SCOPE_NAMED("IREEBenchmark::RegisterSpecificFunction");
-
+  // Looks up |function_name| in the main module and parses its inputs from
+  // the --input= flags.
+  iree_status_t PrepareSpecificFunction(const std::string& function_name,
+                                        iree_vm_function_t* out_function) {
     iree_vm_module_t* main_module =
         iree_tooling_module_list_back(&module_list_);
     iree_vm_function_t function;
@@ -508,6 +912,15 @@ class IREEBenchmark {
         arguments_cconv, FLAG_input_list(), device_.get(),
         device_allocator_.get(), iree_vm_instance_allocator(instance_.get()),
         &inputs_));
+    *out_function = function;
+    return iree_ok_status();
+  }
+
+  iree_status_t RegisterSpecificFunction(const std::string& function_name) {
+    IREE_TRACE_SCOPE_NAMED("IREEBenchmark::RegisterSpecificFunction");
+
+    iree_vm_function_t function;
+    IREE_RETURN_IF_ERROR(PrepareSpecificFunction(function_name, &function));
 
     iree_string_view_t invocation_model = iree_vm_function_lookup_attr_by_name(
         &function, IREE_SV("iree.abi.model"));
@@ -541,8 +954,8 @@ class IREEBenchmark {
           &function, IREE_SV("iree.benchmark"));
       if (iree_string_view_equal(benchmark_type, IREE_SV("dispatch"))) {
         iree::RegisterDispatchBenchmark(
-            std::string(function_name.data, function_name.size), context_.get(),
-            function);
+            std::string(function_name.data, function_name.size), device_.get(),
+            context_.get(), function);
       } else if (iree_string_view_equal(benchmark_type, IREE_SV("entry"))) {
         iree::RegisterGenericBenchmark(
             std::string(function_name.data, function_name.size), device_.get(),
@@ -622,6 +1035,17 @@ int main(int argc, char** argv) {
   ::benchmark::Initialize(&argc, argv);
 
   iree::IREEBenchmark iree_benchmark;
+  if (FLAG_load_rate > 0.0) {
+    iree_status_t status = iree_benchmark.RunLoad();
+    int exit_code = static_cast<int>(iree_status_code(status));
+    if (!iree_status_is_ok(status)) {
+      printf("%s\n", iree::Status(std::move(status)).ToString().c_str());
+    }
+    IREE_TRACE_ZONE_END(z0);
+    IREE_TRACE_APP_EXIT(exit_code);
+    return exit_code;
+  }
+
   iree_status_t status = iree_benchmark.Register();
   if (!iree_status_is_ok(status)) {
     int exit_code = static_cast<int>(iree_status_code(status));
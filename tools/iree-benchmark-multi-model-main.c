@@ -0,0 +1,53 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "iree/base/api.h"
+#include "iree/base/internal/flags.h"
+#include "iree/tooling/context_util.h"
+#include "iree/tooling/multi_model.h"
+#include "iree/vm/api.h"
+
+int main(int argc, char** argv) {
+  IREE_TRACE_APP_ENTER();
+  IREE_TRACE_ZONE_BEGIN(z0);
+
+  // Parse command line flags.
+  iree_flags_set_usage(
+      "iree-benchmark-multi-model",
+      "Benchmarks multiple models hosted concurrently in one process the way\n"
+      "a serving application would. Each `--model=` flag loads a set of\n"
+      "modules into one context per worker and all contexts share the devices\n"
+      "specified by `--device=`. Example:\n"
+      "  iree-benchmark-multi-model --device=local-task \\\n"
+      "    --model=name=a,module=a.vmfb,function=main,rate=100 \\\n"
+      "    --model=name=b,module=b.vmfb,function=main,concurrency=2\n"
+      "A JSON report with per-model throughput and latency percentiles and\n"
+      "the executor and allocator counters is written to `--report=`.\n");
+  iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_DEFAULT, &argc, &argv);
+
+  iree_allocator_t host_allocator = iree_allocator_system();
+  iree_vm_instance_t* instance = NULL;
+  iree_status_t status =
+      iree_tooling_create_instance(host_allocator, &instance);
+
+  if (iree_status_is_ok(status)) {
+    status = iree_tooling_run_multi_model_benchmark_from_flags(
+        instance, host_allocator);
+  }
+
+  iree_vm_instance_release(instance);
+
+  int exit_code = EXIT_SUCCESS;
+  if (!iree_status_is_ok(status)) {
+    iree_status_fprint(stderr, status);
+    iree_status_free(status);
+    exit_code = EXIT_FAILURE;
+  }
+
+  IREE_TRACE_ZONE_END(z0);
+  IREE_TRACE_APP_EXIT(exit_code);
+  return exit_code;
+}
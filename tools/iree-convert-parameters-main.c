@@ -8,7 +8,10 @@
 // Allows for stripping and renaming parameters as basic editing features.
 
 #include <ctype.h>
+#include <errno.h>
+#include <inttypes.h>
 #include <stdio.h>
+#include <string.h>
 
 #include "iree/base/api.h"
 #include "iree/base/internal/file_io.h"
@@ -164,6 +167,37 @@ IREE_FLAG(bool, quiet, false,
 
 IREE_FLAG(string, output, "", "Output .irpa file path.");
 
+IREE_FLAG(int32_t, threads, 8,
+          "Number of threads used to copy parameter contents into the output\n"
+          "file. 1 copies on the main thread.");
+
+IREE_FLAG(string, checksum_output, "",
+          "Writes a 64-bit checksum of the contents of each data parameter\n"
+          "to the given file as `<hex checksum> <name>` lines.");
+
+IREE_FLAG(bool, content_hashes, false,
+          "Stores the 64-bit content hash of each data parameter in the\n"
+          "output archive so that runtimes can deduplicate parameters with\n"
+          "identical contents (see `--parameter_dedup`).");
+
+IREE_FLAG(int32_t, data_alignment, 0,
+          "Alignment in bytes of each data parameter in the output archive.\n"
+          "Use the page size (4096) to allow memory-mapped parameters to be\n"
+          "imported directly by devices requiring page-aligned host memory\n"
+          "instead of being copied. 0 uses the default alignment (64).");
+
+static iree_status_t iree_tooling_write_parameter_checksum(
+    void* user_data, iree_string_view_t key, uint64_t checksum) {
+  FILE* file = (FILE*)user_data;
+  if (fprintf(file, "%016" PRIx64 " %.*s\n", checksum, (int)key.size,
+              key.data) < 0) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "failed to write checksum of parameter '%.*s'",
+                            (int)key.size, key.data);
+  }
+  return iree_ok_status();
+}
+
 static void iree_io_file_handle_release_mapping(
     void* user_data, iree_io_file_handle_primitive_t handle_primitive) {
   iree_file_contents_free((iree_file_contents_t*)user_data);
@@ -231,6 +265,18 @@ int main(int argc, char** argv) {
       "    --parameters=input.irpa \\\n"
       "    --strip \\\n"
       "    --splat=special_param=f32=1.0 \\\n"
+      "    --output=output.irpa\n"
+      "\n"
+      "Contents are copied into the output file with `--threads=` threads.\n"
+      "`--checksum_output=file.txt` additionally records a checksum of each\n"
+      "data parameter computed while copying and `--content_hashes` stores\n"
+      "them in the output archive.\n"
+      "\n"
+      "Example re-laying out safetensors data page-aligned so that it can be\n"
+      "memory-mapped and imported without a staging copy:\n"
+      "  iree-convert-parameters \\\n"
+      "    --parameters=input.safetensors \\\n"
+      "    --data_alignment=4096 \\\n"
       "    --output=output.irpa\n");
   iree_flags_parse_checked(IREE_FLAGS_PARSE_MODE_DEFAULT, &argc, &argv);
 
@@ -256,6 +302,17 @@ int main(int argc, char** argv) {
     status = iree_io_parameter_index_create(host_allocator, &built_index);
   }
 
+  // Open the checksum file, if requested.
+  FILE* checksum_file = NULL;
+  if (iree_status_is_ok(status) && strlen(FLAG_checksum_output) > 0) {
+    checksum_file = fopen(FLAG_checksum_output, "w");
+    if (!checksum_file) {
+      status = iree_make_status(iree_status_code_from_errno(errno),
+                                "failed to open checksum output file '%s'",
+                                FLAG_checksum_output);
+    }
+  }
+
   // Write out the new archive.
   if (iree_status_is_ok(status)) {
     iree_tooling_open_params_t open_params = {
@@ -266,10 +323,22 @@ int main(int argc, char** argv) {
         .fn = iree_tooling_open_output_parameter_file,
         .user_data = &open_params,
     };
-    status = iree_io_build_parameter_archive(
+    iree_io_parameter_archive_build_options_t build_options = {
+        .worker_count = FLAG_threads > 0 ? (iree_host_size_t)FLAG_threads : 1,
+        .content_hashes = FLAG_content_hashes,
+        .data_alignment = FLAG_data_alignment > 0
+                              ? (iree_io_physical_size_t)FLAG_data_alignment
+                              : 0,
+    };
+    if (checksum_file) {
+      build_options.checksum.fn = iree_tooling_write_parameter_checksum;
+      build_options.checksum.user_data = checksum_file;
+    }
+    status = iree_io_build_parameter_archive_with_options(
         new_index, built_index, open_callback,
-        /*target_file_offset=*/0, host_allocator);
+        /*target_file_offset=*/0, &build_options, host_allocator);
   }
+  if (checksum_file) fclose(checksum_file);
 
   // Dump the new index ala iree-dump-parameters to show the final file.
   if (iree_status_is_ok(status) && !FLAG_quiet) {
@@ -141,17 +141,14 @@ static void iree_tooling_dump_print_value(
   }
 }
 
-static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
-    const uint8_t* data_ptr, iree_host_size_t data_size,
+// Dumps the linear sequence of records in |records_ptr| that were written
+// starting at |base_offset| in the ringbuffer.
+static iree_status_t iree_tooling_dump_dispatch_records(
+    const uint8_t* records_ptr, uint64_t base_offset, uint64_t records_length,
     const iree_dispatch_metadata_t* metadata, FILE* stream) {
-  const uint64_t ring_size = data_size - IREE_INSTRUMENT_DISPATCH_PADDING;
-  const uint8_t* ring_data = data_ptr;
-  const uint64_t ring_head = *(const uint64_t*)(ring_data + data_size - 8);
-  const uint64_t ring_range = iree_min(ring_head, ring_size);
-
-  for (iree_host_size_t i = 0; i < ring_range;) {
+  for (iree_host_size_t i = 0; i < records_length;) {
     const iree_instrument_dispatch_header_t* header =
-        (const iree_instrument_dispatch_header_t*)(ring_data + i);
+        (const iree_instrument_dispatch_header_t*)(records_ptr + i);
     switch (header->tag) {
       case IREE_INSTRUMENT_DISPATCH_TYPE_WORKGROUP: {
         const iree_instrument_dispatch_workgroup_t* workgroup =
@@ -168,12 +165,11 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
         fprintf(stream,
                 "%016" PRIX64
                 " | WORKGROUP dispatch(%u %s %ux%ux%u) %u,%u,%u pid:%u\n",
-                (uint64_t)i, workgroup->dispatch_id, name_def,
+                base_offset + i, workgroup->dispatch_id, name_def,
                 workgroup->workgroup_count_x, workgroup->workgroup_count_y,
                 workgroup->workgroup_count_z, workgroup->workgroup_id_x,
                 workgroup->workgroup_id_y, workgroup->workgroup_id_z,
                 workgroup->processor_id);
-        i += sizeof(*workgroup);
         break;
       }
       case IREE_INSTRUMENT_DISPATCH_TYPE_PRINT: {
@@ -182,7 +178,6 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
         fprintf(stream, "%016" PRIX64 " | PRINT %.*s\n",
                 (uint64_t)print->workgroup_offset, (int)print->length,
                 print->data);
-        i += iree_host_align(sizeof(*print) + print->length, 16);
         break;
       }
       case IREE_INSTRUMENT_DISPATCH_TYPE_VALUE: {
@@ -192,7 +187,6 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
                 (uint64_t)value->workgroup_offset, (uint32_t)value->ordinal);
         iree_tooling_dump_print_value(value->type, value->bits, stream);
         fputc('\n', stream);
-        i += sizeof(*value);
         break;
       }
       case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_LOAD: {
@@ -200,7 +194,6 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
             (const iree_instrument_dispatch_memory_op_t*)header;
         fprintf(stream, "%016" PRIX64 " | LOAD  %016" PRIX64 " %u\n",
                 (uint64_t)op->workgroup_offset, op->address, (int)op->length);
-        i += sizeof(*op);
         break;
       }
       case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_STORE: {
@@ -208,7 +201,29 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
             (const iree_instrument_dispatch_memory_op_t*)header;
         fprintf(stream, "%016" PRIX64 " | STORE %016" PRIX64 " %u\n",
                 (uint64_t)op->workgroup_offset, op->address, (int)op->length);
-        i += sizeof(*op);
+        break;
+      }
+      case IREE_INSTRUMENT_DISPATCH_TYPE_MEMORY_SUMMARY: {
+        const iree_instrument_dispatch_memory_summary_t* summary =
+            (const iree_instrument_dispatch_memory_summary_t*)header;
+        fprintf(stream,
+                "%016" PRIX64 " | MEMORY binding(%u) load %" PRIu64
+                "x/%" PRIu64 "B store %" PRIu64 "x/%" PRIu64
+                "B stride 0:%" PRIu64 " seq:%" PRIu64 " line:%" PRIu64
+                " page:%" PRIu64 " far:%" PRIu64 "\n",
+                (uint64_t)summary->workgroup_offset, (uint32_t)summary->binding,
+                summary->load_count, summary->load_bytes, summary->store_count,
+                summary->store_bytes,
+                summary->stride_histogram
+                    [IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_ZERO],
+                summary->stride_histogram
+                    [IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_SEQUENTIAL],
+                summary->stride_histogram
+                    [IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_CACHE_LINE],
+                summary->stride_histogram
+                    [IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_PAGE],
+                summary->stride_histogram
+                    [IREE_INSTRUMENT_DISPATCH_STRIDE_BUCKET_FAR]);
         break;
       }
       default:
@@ -216,11 +231,42 @@ static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
                                 "unimplemented dispatch instr type: %u",
                                 (uint32_t)header->tag);
     }
+    i += iree_instrument_dispatch_record_length(header);
   }
 
   return iree_ok_status();
 }
 
+static iree_status_t iree_tooling_dump_dispatch_ringbuffer(
+    const uint8_t* data_ptr, iree_host_size_t data_size,
+    const iree_dispatch_metadata_t* metadata, FILE* stream) {
+  const uint64_t ring_size = data_size - IREE_INSTRUMENT_DISPATCH_PADDING;
+  const uint8_t* ring_data = data_ptr;
+  const uint64_t ring_head = *(const uint64_t*)(ring_data + data_size - 8);
+  const uint64_t ring_range = iree_min(ring_head, ring_size);
+  return iree_tooling_dump_dispatch_records(ring_data, 0, ring_range, metadata,
+                                            stream);
+}
+
+static iree_status_t iree_tooling_dump_dispatch_ringbuffer_span(
+    const uint8_t* data_ptr, iree_host_size_t data_size,
+    const iree_dispatch_metadata_t* metadata, FILE* stream) {
+  const iree_idbts_dispatch_ringbuffer_span_t* span =
+      (const iree_idbts_dispatch_ringbuffer_span_t*)data_ptr;
+  if (data_size < sizeof(*span) ||
+      data_size - sizeof(*span) < span->head_end - span->head_begin) {
+    return iree_make_status(IREE_STATUS_DATA_LOSS,
+                            "truncated dispatch ringbuffer span");
+  }
+  if (span->dropped_length) {
+    fprintf(stream, "%016" PRIX64 " | DROPPED %" PRIu64 " bytes\n",
+            span->head_begin, span->dropped_length);
+  }
+  return iree_tooling_dump_dispatch_records(
+      data_ptr + sizeof(*span), span->head_begin,
+      span->head_end - span->head_begin, metadata, stream);
+}
+
 static iree_status_t iree_tooling_dump_instrument_file(
     iree_const_byte_span_t file_contents, FILE* stream) {
   const uint8_t* file_ptr = file_contents.data;
@@ -242,6 +288,11 @@ static iree_status_t iree_tooling_dump_instrument_file(
             payload, header->content_length, &dispatch_metadata, stream));
         break;
       }
+      case IREE_IDBTS_CHUNK_TYPE_DISPATCH_RINGBUFFER_SPAN: {
+        IREE_RETURN_IF_ERROR(iree_tooling_dump_dispatch_ringbuffer_span(
+            payload, header->content_length, &dispatch_metadata, stream));
+        break;
+      }
       default:
         return iree_make_status(IREE_STATUS_UNIMPLEMENTED,
                                 "unimplemented chunk type: %u",
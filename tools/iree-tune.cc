@@ -0,0 +1,25 @@
+// Copyright 2024 The IREE Authors
+//
+// Licensed under the Apache License v2.0 with LLVM Exceptions.
+// See https://llvm.org/LICENSE.txt for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+//
+// A dispatch autotuner which searches for faster lowering configurations of
+// the slowest dispatches of a program and writes them as a tuning spec that
+// later compilations pick up.
+//
+// Usage:
+//  iree-compile model.mlir <target flags> \
+//      --iree-hal-dump-executable-benchmarks-to=benchmarks/ -o /dev/null
+//  iree-tune benchmarks/*.mlir --device=<device> \
+//      --Xiree-compile=<target flag> ... -o tuning_spec.mlir
+//  iree-compile model.mlir <target flags> \
+//      --iree-codegen-tuning-spec-path=tuning_spec.mlir -o model.vmfb
+//
+// Each benchmark is compiled with iree-compile and run with
+// iree-benchmark-module, which must be found next to this tool, on the PATH or
+// specified with --iree-compile= and --iree-benchmark-module=.
+
+#include "iree/compiler/tool_entry_points_api.h"
+
+int main(int argc, char **argv) { return ireeTuneRunMain(argc, argv); }